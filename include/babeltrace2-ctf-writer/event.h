@@ -72,6 +72,18 @@ enum bt_ctf_event_class_log_level {
 	BT_CTF_EVENT_CLASS_LOG_LEVEL_DEBUG		= 14,
 };
 
+/*
+ * bt_ctf_event_create: create an event of the class "event_class".
+ *
+ * Once an event is released by its owners (including the stream to
+ * which it was appended, when this stream is flushed), its class may
+ * reuse it, with its fields, for a future event instead of allocating
+ * a new one. The fields of a reused event are reset. Therefore, do not
+ * use the fields of an event, including the fields set with
+ * bt_ctf_event_set_payload(), after the event is released.
+ *
+ * Returns an allocated event on success, NULL on error.
+ */
 extern struct bt_ctf_event *bt_ctf_event_create(
 		struct bt_ctf_event_class *event_class);
 
@@ -186,6 +198,42 @@ extern int bt_ctf_event_class_add_field(struct bt_ctf_event_class *event_class,
 extern struct bt_ctf_field_type *bt_ctf_event_class_get_field_by_name(
 		struct bt_ctf_event_class *event_class, const char *name);
 
+/*
+ * bt_ctf_event_class_get_packed_payload_size: get the size of a packed
+ * payload of an event class.
+ *
+ * A packed payload is the payload of an event, laid out as in a CTF
+ * data stream, which you can append with
+ * bt_ctf_stream_append_packed_events() without creating an event.
+ *
+ * An event class has a packed payload layout when it has no context
+ * field type and when each field of its payload field type is a
+ * structure or static array of integers, enumerations, and floating
+ * point numbers which are not mapped to a clock class and which have
+ * sizes that are multiples of 8 bits.
+ *
+ * The event class must be part of a stream class.
+ *
+ * @param event_class Event class.
+ *
+ * Returns the size of a packed payload (bytes), a negative value on
+ * error or if the event class has no packed payload layout.
+ */
+extern int64_t bt_ctf_event_class_get_packed_payload_size(
+		struct bt_ctf_event_class *event_class);
+
+/*
+ * bt_ctf_event_class_get_packed_payload_field_offset: get the offset
+ * of a payload field within a packed payload of an event class.
+ *
+ * @param event_class Event class.
+ * @param name Name of the payload field.
+ *
+ * Returns the offset of the field (bytes), a negative value on error.
+ */
+extern int64_t bt_ctf_event_class_get_packed_payload_field_offset(
+		struct bt_ctf_event_class *event_class, const char *name);
+
 /* Pre-2.0 CTF writer compatibility */
 static inline
 void bt_ctf_event_class_get(struct bt_ctf_event_class *event_class)
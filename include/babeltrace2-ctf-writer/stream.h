@@ -15,6 +15,7 @@ extern "C" {
 
 struct bt_ctf_stream;
 struct bt_ctf_event;
+struct bt_ctf_event_class;
 
 /*
  * bt_ctf_stream_get_discarded_events_count: get the number of discarded
@@ -64,6 +65,55 @@ extern void bt_ctf_stream_append_discarded_events(struct bt_ctf_stream *stream,
 extern int bt_ctf_stream_append_event(struct bt_ctf_stream *stream,
 		struct bt_ctf_event *event);
 
+/*
+ * bt_ctf_stream_append_packed_events: append events from packed
+ * payloads to the stream.
+ *
+ * Append "count" events of the class "event_class" to the stream's
+ * current packet, without creating event objects. "payloads" contains
+ * "count" packed payloads, back to back, each one being
+ * bt_ctf_event_class_get_packed_payload_size() bytes laid out as
+ * follows: each payload field is at the offset which
+ * bt_ctf_event_class_get_packed_payload_field_offset() returns, with
+ * the bytes of its value in the field type's byte order. The stream
+ * copies the payloads.
+ *
+ * The event header fields are set automatically: the stream class'
+ * event header type may only contain the integer fields "id" and
+ * "timestamp". If "timestamps" is not NULL, it contains the
+ * "timestamp" field value of each event; otherwise, the stream's
+ * associated clock is sampled once for all the events.
+ *
+ * The stream class must have no stream event context type. A packed
+ * payload must start on a byte boundary in the packet; this is the
+ * case when the sizes of all the fields before it are multiples of 8
+ * bits.
+ *
+ * Packed events and events which bt_ctf_stream_append_event() appends
+ * are written in order.
+ *
+ * Each thread of a multithreaded tracer may append packed events to
+ * its own stream, for example one stream per thread or per CPU: calling
+ * bt_ctf_stream_append_packed_events() and bt_ctf_stream_flush()
+ * concurrently is safe as long as the calls are on distinct streams
+ * and as long as those streams only contain packed events. In this
+ * case, pass "timestamps" instead of relying on the shared clock, and
+ * create the streams and flush the writer's metadata beforehand, from
+ * a single thread.
+ *
+ * @param stream Stream instance.
+ * @param event_class Event class of the events, part of the stream's
+ *	class.
+ * @param payloads Packed payloads of the events.
+ * @param timestamps Header timestamp of each event, or NULL.
+ * @param count Number of events to append.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_ctf_stream_append_packed_events(struct bt_ctf_stream *stream,
+		struct bt_ctf_event_class *event_class, const void *payloads,
+		const uint64_t *timestamps, uint64_t count);
+
 /*
  * bt_ctf_stream_get_packet_header: get a stream's packet header.
  *
@@ -1335,6 +1335,51 @@ and what you can and cannot do with a configured graph.
 */
 extern bt_graph_run_status bt_graph_run(bt_graph *graph);
 
+/*!
+@brief
+    Runs the trace processing graph \bt_p{graph} like bt_graph_run()
+    does, but for at most about \bt_p{duration_us}&nbsp;microseconds.
+
+This function behaves exactly like bt_graph_run(), except that it also
+returns #BT_GRAPH_RUN_STATUS_AGAIN when \bt_p{duration_us}
+microseconds of monotonic time elapsed since you called it.
+
+This function checks the elapsed time between two calls to
+\bt_sink_comp \ref api-comp-cls-dev-meth-consume "consuming methods":
+a long consuming method call can make this function return after
+\bt_p{duration_us}.
+
+Use this function to run a trace processing graph from an event loop or
+from a thread which also needs to perform other tasks periodically,
+without relying on an \bt_intr.
+
+@param[in] graph
+    Trace processing graph to run.
+@param[in] duration_us
+    Maximum duration, in microseconds, of the run.
+
+@retval #BT_GRAPH_RUN_STATUS_OK
+    Success: all the sink components are ended.
+@retval #BT_GRAPH_RUN_STATUS_AGAIN
+    Try again, \bt_p{duration_us} elapsed, or \bt_p{graph} is
+    interrupted.
+@retval #BT_GRAPH_RUN_STATUS_MEMORY_ERROR
+    Out of memory.
+@retval #BT_GRAPH_RUN_STATUS_ERROR
+    Other error.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_faulty{graph}
+@pre
+    \bt_p{graph} satisfies all the preconditions of bt_graph_run().
+
+@sa bt_graph_run() &mdash;
+    Runs a trace processing graph until all its sink components are
+    ended.
+*/
+extern bt_graph_run_status bt_graph_run_for(bt_graph *graph,
+		uint64_t duration_us);
+
 /*!
 @brief
     Status codes for bt_graph_run().
@@ -1443,6 +1488,61 @@ and what you can and cannot do with a configured graph.
 */
 extern bt_graph_run_once_status bt_graph_run_once(bt_graph *graph);
 
+/*!
+@brief
+    Sets the consume weight of the \bt_sink_comp \bt_p{component}
+    within the trace processing graph \bt_p{graph} to \bt_p{weight}.
+
+When you run \bt_p{graph} with bt_graph_run(), bt_graph_run_for(), or
+bt_graph_run_once(), \bt_p{graph} makes \bt_p{component} consume
+up to \bt_p{weight} consecutive times before it makes the next
+non-ended sink component consume. \bt_p{component} gives its turn
+before that as soon as its
+\ref api-comp-cls-dev-meth-consume "consuming method" returns
+anything else than a success status, for example "try again".
+
+For example, if \bt_p{graph} has two non-ended sink components A and B,
+and the weight of A is&nbsp;2:
+
+- Calling bt_graph_run_once() makes sink component A consume.
+- Calling bt_graph_run_once() again makes sink component A consume.
+- Calling bt_graph_run_once() again makes sink component B consume.
+- Calling bt_graph_run_once() again makes sink component A consume.
+- ...
+
+Give a higher weight to a latency-sensitive sink component than to
+the other ones so that it doesn't wait for many consuming method calls
+of the other sink components between two of its own.
+
+The default weight of a sink component is&nbsp;1, which makes
+\bt_p{graph} consume its sink components in a strict round robin
+fashion.
+
+You can call this function at any time, except while \bt_p{graph} is
+running. The new weight applies from the next turn of
+\bt_p{component}, at the latest.
+
+@param[in] graph
+    Trace processing graph which contains \bt_p{component}.
+@param[in] component
+    Sink component of which to set the consume weight.
+@param[in] weight
+    New consume weight of \bt_p{component}.
+
+@bt_pre_not_null{graph}
+@bt_pre_not_null{component}
+@pre
+    \bt_p{component} was added to \bt_p{graph}.
+@pre
+    \bt_p{weight} is greater than&nbsp;0.
+
+@sa bt_graph_run_once() &mdash;
+    Calls a single trace processing graph's sink component's consuming
+    method once.
+*/
+extern void bt_graph_set_sink_component_consume_weight(bt_graph *graph,
+		const bt_component_sink *component, uint64_t weight);
+
 /*! @} */
 
 /*!
@@ -1541,6 +1641,162 @@ extern bt_interrupter *bt_graph_borrow_default_interrupter(bt_graph *graph);
 
 /*! @} */
 
+/*!
+@name Profiling
+@{
+*/
+
+/*!
+@brief
+    Status codes for bt_graph_enable_profiling().
+*/
+typedef enum bt_graph_enable_profiling_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_GRAPH_ENABLE_PROFILING_STATUS_OK		= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_GRAPH_ENABLE_PROFILING_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_graph_enable_profiling_status;
+
+/*!
+@brief
+    Enables the profiling of the trace processing graph \bt_p{graph}.
+
+When profiling is enabled, \bt_p{graph} records, for each
+\bt_msg_iter and for each \bt_sink_comp:
+
+- The number of calls to its "next" (or "consume") method.
+- For a message iterator, the number of messages it returned.
+- The wall clock and CPU times spent in its method, both cumulative
+  (including the upstream message iterators) and self (excluding them).
+
+To keep the overhead low, \bt_p{graph} only times one top-level call
+(a sink component's "consume" method call, including all the calls it
+leads to) out of \bt_p{sampling_period}: the reported times are
+estimates based on those timed calls. Set \bt_p{sampling_period} to 1
+to time all the calls.
+
+Get the recorded data with bt_graph_get_profile().
+
+@param[in] graph
+    Trace processing graph of which to enable the profiling.
+@param[in] sampling_period
+    Time one top-level call out of \bt_p{sampling_period}.
+
+@retval #BT_GRAPH_ENABLE_PROFILING_STATUS_OK
+    Success.
+@retval #BT_GRAPH_ENABLE_PROFILING_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{graph}
+@pre
+    \bt_p{graph} is not configured yet (you didn't call bt_graph_run()
+    or bt_graph_run_once() with it).
+@pre
+    \bt_p{sampling_period} is greater than 0.
+
+@sa bt_graph_get_profile() &mdash;
+    Returns the profile of a trace processing graph.
+*/
+extern bt_graph_enable_profiling_status bt_graph_enable_profiling(
+		bt_graph *graph, uint64_t sampling_period);
+
+/*!
+@brief
+    Status codes for bt_graph_get_profile().
+*/
+typedef enum bt_graph_get_profile_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_GRAPH_GET_PROFILE_STATUS_OK			= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_GRAPH_GET_PROFILE_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_graph_get_profile_status;
+
+/*!
+@brief
+    Returns the current profile of the trace processing graph
+    \bt_p{graph}.
+
+On success, \bt_p{*profile} is an \bt_array_val which contains one
+\bt_map_val per message iterator and per sink component, in creation
+order. Each map value has the following entries:
+
+<dl>
+  <dt>\c type</dt>
+  <dd>\c message-iterator or \c sink (\bt_string_val).</dd>
+
+  <dt>\c component-name</dt>
+  <dd>
+    Name of the sink component, or of the upstream component of the
+    message iterator (\bt_string_val).
+  </dd>
+
+  <dt>\c port-name (message iterator only)</dt>
+  <dd>
+    Name of the upstream output port of the message iterator
+    (\bt_string_val).
+  </dd>
+
+  <dt>\c call-count</dt>
+  <dd>Number of method calls (\bt_uint_val).</dd>
+
+  <dt>\c message-count (message iterator only)</dt>
+  <dd>Number of returned messages (\bt_uint_val).</dd>
+
+  <dt>\c sampled-call-count</dt>
+  <dd>Number of timed method calls (\bt_uint_val).</dd>
+
+  <dt>\c wall-time-ns, \c cpu-time-ns</dt>
+  <dd>
+    Estimated cumulative wall clock and CPU times, in nanoseconds,
+    spent in the method (\bt_uint_val).
+  </dd>
+
+  <dt>\c self-wall-time-ns, \c self-cpu-time-ns</dt>
+  <dd>
+    Same as \c wall-time-ns and \c cpu-time-ns, excluding the time
+    spent in upstream message iterators (\bt_uint_val).
+  </dd>
+</dl>
+
+@param[in] graph
+    Trace processing graph of which to get the profile.
+@param[out] profile
+    <strong>On success</strong>, \bt_p{*profile} is a \em new reference
+    of the profile of \bt_p{graph}.
+
+@retval #BT_GRAPH_GET_PROFILE_STATUS_OK
+    Success.
+@retval #BT_GRAPH_GET_PROFILE_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{graph}
+@bt_pre_not_null{profile}
+@pre
+    You enabled the profiling of \bt_p{graph} with
+    bt_graph_enable_profiling().
+
+@sa bt_graph_enable_profiling() &mdash;
+    Enables the profiling of a trace processing graph.
+*/
+extern bt_graph_get_profile_status bt_graph_get_profile(
+		const bt_graph *graph, const bt_value **profile);
+
+/*! @} */
+
 /*!
 @name Listeners
 @{
@@ -163,6 +163,15 @@ operations:
     origin level and it is left to the message iterator's implementation
     to seek a message having at least this time.
 
+    If the message iterator cannot seek a given time by itself, but it
+    can seek its beginning and
+    \link bt_message_iterator_can_seek_forward() seek forward\endlink,
+    then the library makes it seek its beginning and skips its messages
+    until the requested time. After such a seek, the library also
+    keeps track of the message iterator's stream states as you get its
+    messages: a subsequent seek of a time after the last message you
+    got only skips messages from the current position.
+
     If the requested time point is \em after the message iterator's
     sequence's last message, then the next call to
     bt_message_iterator_next() returns
@@ -454,6 +463,87 @@ extern bt_message_iterator_next_status
 bt_message_iterator_next(bt_message_iterator *message_iterator,
 		bt_message_array_const *messages, uint64_t *count);
 
+/*!
+@brief
+    Gets the next \bt_p_msg of the message iterator
+    \bt_p{message_iterator} and makes them the output messages of the
+    current \link api-msg-iter-cls-meth-next "next" method\endlink
+    call of the message iterator \bt_p{self_message_iterator},
+    without copying them.
+
+This function is a faster equivalent of calling
+bt_message_iterator_next() and then moving all the returned messages,
+unchanged, to the output message array of the "next" method of
+\bt_p{self_message_iterator}: instead of moving each message
+reference, the library swaps the message arrays of the two message
+iterators.
+
+Use this function from the "next" method of a \bt_flt_comp message
+iterator which forwards a whole batch of messages from an upstream
+message iterator without modifying, adding, or removing any message.
+
+\bt_p{*count} is never greater than the capacity of the current "next"
+method call of \bt_p{self_message_iterator}.
+
+On success, the "next" method of \bt_p{self_message_iterator} must:
+
+- <strong>Not</strong> modify its output message array (its
+  \bt_p{messages} parameter): the library replaced it. In particular,
+  the method must not have put any message in this array before
+  calling this function.
+
+- Set its \bt_p{*count} output parameter to the value of
+  \bt_p{*count} which this function sets.
+
+- Return #BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK.
+
+On failure, the "next" method of \bt_p{self_message_iterator} can
+handle the status as it would handle the status of
+bt_message_iterator_next(), for example try again later or return
+another status.
+
+@param[in] self_message_iterator
+    Message iterator of which the "next" method is currently running.
+@param[in] message_iterator
+    Message iterator from which to get the next messages.
+@param[out] count
+    <strong>On success</strong>, \bt_p{*count} is the number of
+    messages that \bt_p{self_message_iterator} now outputs.
+
+@retval #BT_MESSAGE_ITERATOR_NEXT_STATUS_OK
+    Success.
+@retval #BT_MESSAGE_ITERATOR_NEXT_STATUS_END
+    End of iteration.
+@retval #BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN
+    Try again.
+@retval #BT_MESSAGE_ITERATOR_NEXT_STATUS_MEMORY_ERROR
+    Out of memory.
+@retval #BT_MESSAGE_ITERATOR_NEXT_STATUS_ERROR
+    Other error.
+
+@bt_pre_not_null{self_message_iterator}
+@bt_pre_not_null{message_iterator}
+@bt_pre_not_null{count}
+@pre
+    This function is called from the "next" method of
+    \bt_p{self_message_iterator}, which did not put any message in its
+    output message array yet.
+@pre
+    \bt_p{message_iterator} was created from
+    \bt_p{self_message_iterator} with
+    bt_message_iterator_create_from_message_iterator().
+
+@post
+    <strong>On success</strong>, \bt_p{*count}&nbsp;≥&nbsp;1.
+
+@sa bt_message_iterator_next() &mdash;
+    Returns the next messages of a message iterator.
+*/
+extern bt_message_iterator_next_status
+bt_self_message_iterator_forward_next(
+		bt_self_message_iterator *self_message_iterator,
+		bt_message_iterator *message_iterator, uint64_t *count);
+
 /*! @} */
 
 /*!
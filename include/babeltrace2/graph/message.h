@@ -31,7 +31,7 @@ trace processing job.
 \bt_cp_msg_iter create messages while message iterators \em and
 \bt_p_sink_comp consume messages.
 
-There are eight types of messages:
+There are nine types of messages:
 
 - \bt_c_sb_msg
 - \bt_c_se_msg
@@ -41,6 +41,7 @@ There are eight types of messages:
 - \bt_c_disc_ev_msg
 - \bt_c_disc_pkt_msg
 - \bt_c_inac_msg
+- \bt_c_ev_batch_msg (\ref api-msg-mip "MIP" version&nbsp;1)
 
 The type of a message is #bt_message.
 
@@ -134,6 +135,12 @@ of message:
     <td>\ref api-msg-inac "Message iterator inactivity"
     <td>#BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY
     <td>bt_message_message_iterator_inactivity_create()
+  <tr>
+    <td>\ref api-msg-ev-batch "Event batch"
+    <td>#BT_MESSAGE_TYPE_EVENT_BATCH
+    <td>
+      bt_message_event_batch_create()<br>
+      bt_message_event_batch_create_with_packet()
 </table>
 
 <h2>\anchor api-msg-sb Stream beginning message</h2>
@@ -787,6 +794,122 @@ A message iterator inactivity message has the following property:
   </dd>
 </dl>
 
+<h2>\anchor api-msg-ev-batch Event batch message</h2>
+
+An <strong><em>event batch message</em></strong> transports
+one or more \bt_p_ev of the same \bt_ev_cls, in the same \bt_stream
+(and \bt_pkt, if any), in a columnar form.
+
+An event batch message is equivalent to as many consecutive \bt_p_ev_msg
+within the \ref api-msg-seq "message sequence" of its stream, but
+instead of a \bt_field tree per event, it holds, for all its events:
+
+- An array of default \bt_cs values (clock cycles), if the stream's
+  class has a
+  \ref api-tir-stream-cls-prop-def-clock-cls "default clock class".
+
+- One column of 64-bit items per member of the event class's payload
+  \bt_struct_fc.
+
+A component can only create and receive event batch messages when the
+effective \bt_mip version of its trace processing \bt_graph is 1 or
+more (see bt_self_component_get_graph_mip_version()): downstream
+components that don't support MIP version&nbsp;1 never see event batch
+messages. A producer which only supports some event classes keeps
+creating \bt_p_ev_msg for the other ones.
+
+The event class of an event batch message must be \em supported, that
+is:
+
+- Its stream class has no
+  \ref api-tir-stream-cls-prop-ecc-fc "event common context field class".
+
+- It has no
+  \ref api-tir-ev-cls-prop-sc-fc "specific context field class".
+
+- Each member of its payload field class, if any, is a \bt_bool_fc,
+  an \bt_int_fc (including \bt_p_enum_fc), a \bt_real_fc, or a
+  \bt_string_fc.
+
+Check that an event class is supported with
+bt_message_event_batch_event_class_is_supported().
+
+The type of the items of a payload column depends on the class of the
+corresponding payload member:
+
+<dl>
+  <dt>Boolean field class</dt>
+  <dd>\c uint64_t: 0 (false) or 1 (true).</dd>
+
+  <dt>Unsigned integer/enumeration field class</dt>
+  <dd>\c uint64_t</dd>
+
+  <dt>Signed integer/enumeration field class</dt>
+  <dd>\c int64_t</dd>
+
+  <dt>Real field class</dt>
+  <dd>\c double</dd>
+
+  <dt>String field class</dt>
+  <dd>
+    \c uint64_t: offset of the string within the side buffer of the
+    message. Set a string with
+    bt_message_event_batch_set_payload_string() and get it with
+    bt_message_event_batch_get_payload_string() instead of accessing
+    the column directly.
+  </dd>
+</dl>
+
+Create an event batch message with bt_message_event_batch_create() or
+bt_message_event_batch_create_with_packet(), passing the maximum
+number of events it can hold (its capacity). Then fill the
+default clock snapshot values and payload columns of the first
+\em N events and call bt_message_event_batch_set_event_count() with
+\em N. The default clock snapshot values of an event batch message
+must not decrease.
+
+An event batch message has the following properties:
+
+<dl>
+  <dt>
+    \anchor api-msg-ev-batch-prop-count
+    Event count
+  </dt>
+  <dd>
+    Number of events of the message, which must be at least 1 when
+    the message iterator emits the message.
+
+    Set an event batch message's event count with
+    bt_message_event_batch_set_event_count() and get it with
+    bt_message_event_batch_get_event_count().
+  </dd>
+
+  <dt>
+    \anchor api-msg-ev-batch-prop-cs
+    \bt_dt_opt Default clock snapshot values
+  </dt>
+  <dd>
+    Value (clock cycles) of the default clock snapshot of each event.
+
+    Borrow the default clock snapshot values of an event batch message
+    with bt_message_event_batch_borrow_default_clock_snapshot_values()
+    and
+    bt_message_event_batch_borrow_default_clock_snapshot_values_const().
+  </dd>
+
+  <dt>
+    \anchor api-msg-ev-batch-prop-cols
+    Payload columns
+  </dt>
+  <dd>
+    Payload field value of each event, member by member.
+
+    Borrow the payload column of an event batch message with
+    bt_message_event_batch_borrow_payload_column() and
+    bt_message_event_batch_borrow_payload_column_const().
+  </dd>
+</dl>
+
 <h1>\anchor api-msg-mip Message Interchange Protocol</h1>
 
 The <em>Message Interchange Protocol</em> (MIP) is the system of rules
@@ -808,11 +931,13 @@ For example:
 
 - The available message types are stream beginning and end, event,
   packet beginning and end, discarded events and packets, and message
-  iterator inactivity.
+  iterator inactivity (MIP version&nbsp;0), as well as event batch
+  (MIP version&nbsp;1).
 
 The MIP has a version which is a single major number, independent from
-the \bt_name project's version. As of \bt_name_version_min_maj, the only
-available MIP version is 0.
+the \bt_name project's version. As of \bt_name_version_min_maj, the
+available MIP versions are 0 and 1. MIP version&nbsp;1 only adds the
+\bt_ev_batch_msg type to MIP version&nbsp;0.
 
 If what the MIP covers changes in a breaking or semantical way in the
 future, the MIP and \bt_name's minor versions will be bumped.
@@ -1009,6 +1134,12 @@ typedef enum bt_message_type {
 	    \bt_c_inac_msg.
 	*/
 	BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY	= 1 << 7,
+
+	/*!
+	@brief
+	    \bt_c_ev_batch_msg (MIP version&nbsp;1).
+	*/
+	BT_MESSAGE_TYPE_EVENT_BATCH			= 1 << 8,
 } bt_message_type;
 
 /*!
@@ -3003,6 +3134,411 @@ bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
 
 /*! @} */
 
+/*!
+@name Event batch message
+@{
+*/
+
+/*!
+@brief
+    Returns whether or not you can create an \bt_ev_batch_msg for
+    the \bt_ev_cls \bt_p{event_class}.
+
+See \ref api-msg-ev-batch "Event batch message" for the conditions.
+
+@param[in] event_class
+    Event class to check.
+
+@returns
+    #BT_TRUE if you can create an event batch message for
+    \bt_p{event_class}.
+
+@bt_pre_not_null{event_class}
+*/
+extern bt_bool bt_message_event_batch_event_class_is_supported(
+		const bt_event_class *event_class);
+
+/*!
+@brief
+    Creates an \bt_ev_batch_msg which can hold up to \bt_p{capacity}
+    \bt_p_ev of the class \bt_p{event_class} in the \bt_stream
+    \bt_p{stream} from the \bt_msg_iter \bt_p{self_message_iterator}.
+
+@attention
+    Only use this function if
+    <code>bt_stream_class_supports_packets(bt_stream_borrow_class_const(stream))</code>
+    returns #BT_FALSE.
+
+    Otherwise, use bt_message_event_batch_create_with_packet().
+
+On success, the event count of the returned message is 0 and its
+default clock snapshot values and payload columns are not set.
+
+@param[in] self_message_iterator
+    Self message iterator from which to create the event batch
+    message.
+@param[in] event_class
+    Class of the events of the message to create.
+@param[in] stream
+    Stream conceptually containing the events of the message to
+    create.
+@param[in] capacity
+    Maximum number of events of the message to create.
+
+@returns
+    New event batch message reference, or \c NULL on memory error.
+
+@bt_pre_not_null{self_message_iterator}
+@pre
+    The effective \bt_mip version of the trace processing \bt_graph
+    of \bt_p{self_message_iterator} is 1 or more.
+@bt_pre_not_null{event_class}
+@pre
+    bt_message_event_batch_event_class_is_supported() returns #BT_TRUE
+    for \bt_p{event_class}.
+@bt_pre_not_null{stream}
+@pre
+    The \bt_stream_cls of \bt_p{event_class} is also the class of
+    \bt_p{stream}.
+@pre
+    \bt_p{capacity} ≥ 1.
+
+@bt_post_success_frozen{event_class}
+@bt_post_success_frozen{stream}
+*/
+extern bt_message *bt_message_event_batch_create(
+		bt_self_message_iterator *self_message_iterator,
+		const bt_event_class *event_class, const bt_stream *stream,
+		uint64_t capacity);
+
+/*!
+@brief
+    Creates an \bt_ev_batch_msg which can hold up to \bt_p{capacity}
+    \bt_p_ev of the class \bt_p{event_class} in the \bt_pkt
+    \bt_p{packet} from the \bt_msg_iter \bt_p{self_message_iterator}.
+
+@attention
+    Only use this function if
+    <code>bt_stream_class_supports_packets(bt_stream_borrow_class_const(bt_packet_borrow_stream_const(packet)))</code>
+    returns #BT_TRUE.
+
+    Otherwise, use bt_message_event_batch_create().
+
+See bt_message_event_batch_create().
+
+@bt_pre_not_null{self_message_iterator}
+@pre
+    The effective \bt_mip version of the trace processing \bt_graph
+    of \bt_p{self_message_iterator} is 1 or more.
+@bt_pre_not_null{event_class}
+@pre
+    bt_message_event_batch_event_class_is_supported() returns #BT_TRUE
+    for \bt_p{event_class}.
+@bt_pre_not_null{packet}
+@pre
+    The \bt_stream_cls of \bt_p{event_class} is also the class of
+    the stream of \bt_p{packet}.
+@pre
+    \bt_p{capacity} ≥ 1.
+
+@bt_post_success_frozen{event_class}
+@bt_post_success_frozen{packet}
+*/
+extern bt_message *bt_message_event_batch_create_with_packet(
+		bt_self_message_iterator *self_message_iterator,
+		const bt_event_class *event_class, const bt_packet *packet,
+		uint64_t capacity);
+
+/*!
+@brief
+    Borrows the \bt_ev_cls of the events of the \bt_ev_batch_msg
+    \bt_p{message}.
+
+@param[in] message
+    Event batch message from which to borrow the event class.
+
+@returns
+    \em Borrowed reference of the event class of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+*/
+extern const bt_event_class *bt_message_event_batch_borrow_event_class_const(
+		const bt_message *message);
+
+/*!
+@brief
+    Borrows the \bt_stream of the events of the \bt_ev_batch_msg
+    \bt_p{message}.
+
+@param[in] message
+    Event batch message from which to borrow the stream.
+
+@returns
+    \em Borrowed reference of the stream of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+*/
+extern const bt_stream *bt_message_event_batch_borrow_stream_const(
+		const bt_message *message);
+
+/*!
+@brief
+    Borrows the \bt_pkt of the events of the \bt_ev_batch_msg
+    \bt_p{message}.
+
+@param[in] message
+    Event batch message from which to borrow the packet.
+
+@returns
+    \em Borrowed reference of the packet of \bt_p{message}, or \c NULL
+    if its stream class doesn't support packets.
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+*/
+extern const bt_packet *bt_message_event_batch_borrow_packet_const(
+		const bt_message *message);
+
+/*!
+@brief
+    Returns the maximum number of events of the \bt_ev_batch_msg
+    \bt_p{message}.
+
+@param[in] message
+    Event batch message of which to get the capacity.
+
+@returns
+    Capacity of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+*/
+extern uint64_t bt_message_event_batch_get_capacity(
+		const bt_message *message);
+
+/*!
+@brief
+    Sets the number of events of the \bt_ev_batch_msg
+    \bt_p{message} to \bt_p{count}.
+
+See the \ref api-msg-ev-batch-prop-count "event count" property.
+
+@param[in] message
+    Event batch message of which to set the event count.
+@param[in] count
+    New event count of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_hot{message}
+@bt_pre_is_ev_batch_msg{message}
+@pre
+    \bt_p{count} is less than or equal to the capacity of
+    \bt_p{message}.
+
+@sa bt_message_event_batch_get_event_count() &mdash;
+    Returns the event count of an event batch message.
+*/
+extern void bt_message_event_batch_set_event_count(bt_message *message,
+		uint64_t count);
+
+/*!
+@brief
+    Returns the number of events of the \bt_ev_batch_msg
+    \bt_p{message}.
+
+See the \ref api-msg-ev-batch-prop-count "event count" property.
+
+@param[in] message
+    Event batch message of which to get the event count.
+
+@returns
+    Event count of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+
+@sa bt_message_event_batch_set_event_count() &mdash;
+    Sets the event count of an event batch message.
+*/
+extern uint64_t bt_message_event_batch_get_event_count(
+		const bt_message *message);
+
+/*!
+@brief
+    Borrows the default \bt_cs values (one per event, up to the
+    capacity) of the \bt_ev_batch_msg \bt_p{message}.
+
+See the \ref api-msg-ev-batch-prop-cs "default clock snapshot values"
+property.
+
+@param[in] message
+    Event batch message from which to borrow the default clock
+    snapshot values.
+
+@returns
+    Default clock snapshot values of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_hot{message}
+@bt_pre_is_ev_batch_msg{message}
+@pre
+    The \bt_stream_cls of \bt_p{message} has a
+    \ref api-tir-stream-cls-prop-def-clock-cls "default clock class".
+
+@sa bt_message_event_batch_borrow_default_clock_snapshot_values_const()
+    &mdash; \c const version of this function.
+*/
+extern uint64_t *bt_message_event_batch_borrow_default_clock_snapshot_values(
+		bt_message *message);
+
+/*!
+@brief
+    Borrows the default \bt_cs values of the \bt_ev_batch_msg
+    \bt_p{message} (\c const version).
+
+See bt_message_event_batch_borrow_default_clock_snapshot_values().
+*/
+extern const uint64_t *
+bt_message_event_batch_borrow_default_clock_snapshot_values_const(
+		const bt_message *message);
+
+/*!
+@brief
+    Borrows the column of the payload member at index
+    \bt_p{member_index} (64-bit items, one per event, up to the
+    capacity) of the \bt_ev_batch_msg \bt_p{message}.
+
+See the \ref api-msg-ev-batch-prop-cols "payload columns" property
+and \ref api-msg-ev-batch "Event batch message" for the type of the
+items.
+
+@param[in] message
+    Event batch message from which to borrow the payload column.
+@param[in] member_index
+    Index of the payload member of the column to borrow.
+
+@returns
+    Payload column of \bt_p{message}.
+
+@bt_pre_not_null{message}
+@bt_pre_hot{message}
+@bt_pre_is_ev_batch_msg{message}
+@pre
+    \bt_p{member_index} is less than the number of members of the
+    payload field class of the event class of \bt_p{message}.
+
+@sa bt_message_event_batch_borrow_payload_column_const() &mdash;
+    \c const version of this function.
+*/
+extern void *bt_message_event_batch_borrow_payload_column(
+		bt_message *message, uint64_t member_index);
+
+/*!
+@brief
+    Borrows the column of the payload member at index
+    \bt_p{member_index} of the \bt_ev_batch_msg \bt_p{message}
+    (\c const version).
+
+See bt_message_event_batch_borrow_payload_column().
+*/
+extern const void *bt_message_event_batch_borrow_payload_column_const(
+		const bt_message *message, uint64_t member_index);
+
+/*!
+@brief
+    Status codes for bt_message_event_batch_set_payload_string().
+*/
+typedef enum bt_message_event_batch_set_payload_string_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_MESSAGE_EVENT_BATCH_SET_PAYLOAD_STRING_STATUS_OK		= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_MESSAGE_EVENT_BATCH_SET_PAYLOAD_STRING_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_message_event_batch_set_payload_string_status;
+
+/*!
+@brief
+    Sets the value of the string payload member at index
+    \bt_p{member_index} of the event at index \bt_p{event_index} of
+    the \bt_ev_batch_msg \bt_p{message} to a copy of \bt_p{value}.
+
+@param[in] message
+    Event batch message of which to set a string.
+@param[in] member_index
+    Index of the string payload member.
+@param[in] event_index
+    Index of the event.
+@param[in] value
+    New value (copied).
+
+@retval #BT_MESSAGE_EVENT_BATCH_SET_PAYLOAD_STRING_STATUS_OK
+    Success.
+@retval #BT_MESSAGE_EVENT_BATCH_SET_PAYLOAD_STRING_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{message}
+@bt_pre_hot{message}
+@bt_pre_is_ev_batch_msg{message}
+@pre
+    \bt_p{member_index} is less than the number of members of the
+    payload field class of the event class of \bt_p{message}, and the
+    class of this member is a \bt_string_fc.
+@pre
+    \bt_p{event_index} is less than the capacity of \bt_p{message}.
+@bt_pre_not_null{value}
+*/
+extern bt_message_event_batch_set_payload_string_status
+bt_message_event_batch_set_payload_string(bt_message *message,
+		uint64_t member_index, uint64_t event_index,
+		const char *value);
+
+/*!
+@brief
+    Returns the value of the string payload member at index
+    \bt_p{member_index} of the event at index \bt_p{event_index} of
+    the \bt_ev_batch_msg \bt_p{message}.
+
+@param[in] message
+    Event batch message of which to get a string.
+@param[in] member_index
+    Index of the string payload member.
+@param[in] event_index
+    Index of the event.
+
+@returns
+    @parblock
+    String value.
+
+    The returned pointer remains valid until \bt_p{message} is
+    destroyed or you call bt_message_event_batch_set_payload_string()
+    for it.
+    @endparblock
+
+@bt_pre_not_null{message}
+@bt_pre_is_ev_batch_msg{message}
+@pre
+    \bt_p{member_index} is less than the number of members of the
+    payload field class of the event class of \bt_p{message}, and the
+    class of this member is a \bt_string_fc.
+@pre
+    \bt_p{event_index} is less than the event count of \bt_p{message},
+    and this string was set with
+    bt_message_event_batch_set_payload_string().
+*/
+extern const char *bt_message_event_batch_get_payload_string(
+		const bt_message *message, uint64_t member_index,
+		uint64_t event_index);
+
+/*! @} */
+
 /*!
 @name Message reference count
 @{
@@ -3150,10 +3686,8 @@ If this function does not find an operative MIP version for the
 component descriptors of \bt_p{component_descriptors}, it returns
 #BT_GET_GREATEST_OPERATIVE_MIP_VERSION_STATUS_NO_MATCH.
 
-@note
-    As of \bt_name_version_min_maj, because bt_get_maximal_mip_version()
-    returns 0, this function always sets \bt_p{*mip_version} to
-    0 on success.
+A component class without a "get supported MIP versions" method only
+supports MIP version&nbsp;0.
 
 @param[in] component_descriptors
     Component descriptors for which to get the supported MIP versions
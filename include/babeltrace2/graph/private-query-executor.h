@@ -33,11 +33,18 @@ from within a \bt_comp_cls
 A query method receives a private query executor as its
 \bt_p{query_executor} parameter.
 
-As of \bt_name_version_min_maj, this module only offers the
-bt_private_query_executor_as_query_executor_const() function to
+Use bt_private_query_executor_as_query_executor_const() to
 \ref api-fund-c-typing "upcast" a private query executor to a
 \c const query executor. You need this to get the query executor's
 \ref api-qexec-prop-log-lvl "logging level".
+
+A query method can also declare that the result of the current query
+operation is cacheable with
+bt_private_query_executor_set_result_is_cacheable(), and add the paths
+of the files and directories on which this result depends with
+bt_private_query_executor_add_result_dependency_path(). See the
+\ref api-qexec-prop-result-cache "uses result cache" property of a
+query executor.
 */
 
 /*! @{ */
@@ -84,6 +91,105 @@ bt_private_query_executor_as_query_executor_const(
 
 /*! @} */
 
+/*!
+@name Result cache
+@{
+*/
+
+/*!
+@brief
+    Makes the result of the current query operation of
+    \bt_p{query_executor} cacheable.
+
+Call this function from a query method when the result of the query
+operation only depends on:
+
+- The component class.
+- The object name.
+- The query parameters.
+- The files and directories which you add with
+  bt_private_query_executor_add_result_dependency_path().
+
+If the \ref api-qexec-prop-result-cache "uses result cache" property of
+\bt_p{query_executor} is true and the query method returns
+#BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_OK, the library caches the
+result. A future query operation with the same component class, object
+name, and query parameters, of which the query executor also uses the
+result cache, then returns the cached result without calling the query
+method, as long as the added files and directories keep the same
+existence, modification time, and size.
+
+The library doesn't cache a result of which a dependency was modified
+within the last second.
+
+@param[in] query_executor
+    Private query executor of the current query operation.
+
+@bt_pre_not_null{query_executor}
+
+@sa bt_private_query_executor_add_result_dependency_path() &mdash;
+    Adds a file or directory on which the result of the current query
+    operation depends.
+*/
+extern void bt_private_query_executor_set_result_is_cacheable(
+		bt_private_query_executor *query_executor);
+
+/*!
+@brief
+    Status codes for
+    bt_private_query_executor_add_result_dependency_path().
+*/
+typedef enum bt_private_query_executor_add_result_dependency_path_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_PRIVATE_QUERY_EXECUTOR_ADD_RESULT_DEPENDENCY_PATH_STATUS_OK			= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_PRIVATE_QUERY_EXECUTOR_ADD_RESULT_DEPENDENCY_PATH_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_private_query_executor_add_result_dependency_path_status;
+
+/*!
+@brief
+    Adds the file or directory \bt_p{path} to the dependencies of the
+    result of the current query operation of \bt_p{query_executor}.
+
+If the result is cacheable (see
+bt_private_query_executor_set_result_is_cacheable()), the library
+considers its cached copy stale as soon as \bt_p{path} starts or stops
+existing, or as soon as its modification time or size changes.
+
+For a directory, the modification time changes when you add, remove,
+or rename an entry, but not when you modify the content of an existing
+file: add the paths of the files of which the content matters too.
+
+@param[in] query_executor
+    Private query executor of the current query operation.
+@param[in] path
+    Path of a file or directory on which the result of the current
+    query operation depends (copied).
+
+@retval #BT_PRIVATE_QUERY_EXECUTOR_ADD_RESULT_DEPENDENCY_PATH_STATUS_OK
+    Success.
+@retval #BT_PRIVATE_QUERY_EXECUTOR_ADD_RESULT_DEPENDENCY_PATH_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{query_executor}
+@bt_pre_not_null{path}
+
+@sa bt_private_query_executor_set_result_is_cacheable() &mdash;
+    Makes the result of the current query operation cacheable.
+*/
+extern bt_private_query_executor_add_result_dependency_path_status
+bt_private_query_executor_add_result_dependency_path(
+		bt_private_query_executor *query_executor, const char *path);
+
+/*! @} */
+
 /*! @} */
 
 #ifdef __cplusplus
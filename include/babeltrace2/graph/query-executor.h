@@ -113,6 +113,38 @@ A query executor has the following property:
     Use bt_query_executor_set_logging_level() and
     bt_query_executor_get_logging_level().
   </dd>
+
+  <dt>
+    \anchor api-qexec-prop-result-cache
+    Uses result cache
+  </dt>
+  <dd>
+    Whether or not the query executor's query operations look up and
+    store their results in the result cache of the component class.
+
+    A component class's query method makes the result of a query
+    operation cacheable with
+    bt_private_query_executor_set_result_is_cacheable(): with a query
+    executor which uses the result cache, a query operation with the
+    same object name and query parameters then returns a copy of this
+    result without calling the query method, as long as the files and
+    directories on which the result depends (see
+    bt_private_query_executor_add_result_dependency_path()) don't
+    change.
+
+    A query operation with query user data (see
+    bt_query_executor_create_with_method_data()) never uses the result
+    cache.
+
+    The result cache exists within the current process only. Query
+    executors on different threads can share it: each query operation
+    which uses a cached result gets its own copy.
+
+    The default value is #BT_FALSE.
+
+    Use bt_query_executor_set_uses_result_cache() and
+    bt_query_executor_uses_result_cache().
+  </dd>
 </dl>
 */
 
@@ -352,6 +384,49 @@ See the \ref api-qexec-prop-log-lvl "logging level" property.
 extern bt_logging_level bt_query_executor_get_logging_level(
 		const bt_query_executor *query_executor);
 
+/*!
+@brief
+    Sets whether or not the query executor \bt_p{query_executor} uses
+    the result cache of its component class.
+
+See the \ref api-qexec-prop-result-cache "uses result cache" property.
+
+@param[in] query_executor
+    Query executor of which to set whether or not it uses the result
+    cache.
+@param[in] uses_result_cache
+    #BT_TRUE to make \bt_p{query_executor} use the result cache.
+
+@bt_pre_not_null{query_executor}
+
+@sa bt_query_executor_uses_result_cache() &mdash;
+    Returns whether or not a query executor uses the result cache.
+*/
+extern void bt_query_executor_set_uses_result_cache(
+		bt_query_executor *query_executor, bt_bool uses_result_cache);
+
+/*!
+@brief
+    Returns whether or not the query executor \bt_p{query_executor}
+    uses the result cache of its component class.
+
+See the \ref api-qexec-prop-result-cache "uses result cache" property.
+
+@param[in] query_executor
+    Query executor of which to get whether or not it uses the result
+    cache.
+
+@returns
+    #BT_TRUE if \bt_p{query_executor} uses the result cache.
+
+@bt_pre_not_null{query_executor}
+
+@sa bt_query_executor_set_uses_result_cache() &mdash;
+    Sets whether or not a query executor uses the result cache.
+*/
+extern bt_bool bt_query_executor_uses_result_cache(
+		const bt_query_executor *query_executor);
+
 /*! @} */
 
 /*!
@@ -42,6 +42,10 @@ bt_self_message_iterator_is_interrupted().
 
 Set whether or not a message iterator can seek forward with
 bt_self_message_iterator_configuration_set_can_seek_forward().
+
+Set the maximum number of messages a message iterator can return
+from its \ref api-msg-iter-cls-meth-next "next method" at once with
+bt_self_message_iterator_configuration_set_max_batch_size().
 */
 
 /*! @{ */
@@ -155,6 +159,70 @@ extern
 void *bt_self_message_iterator_get_data(
 		const bt_self_message_iterator *self_message_iterator);
 
+/*!
+@brief
+    Attaches the data \bt_p{data} of the \bt_msg_iter
+    \bt_p{self_message_iterator} to the \bt_stream \bt_p{stream}.
+
+Each message iterator has its own data slot within each stream: use
+this function and bt_self_message_iterator_get_stream_data() to
+associate a per-stream state to the streams of the messages which
+\bt_p{self_message_iterator} handles instead of looking them up in
+your own map. Getting the data of a stream is cheaper than a hash table
+lookup.
+
+The data slot is empty (\c NULL) by default. Set \bt_p{data} to
+\c NULL to empty the data slot of \bt_p{self_message_iterator} within
+\bt_p{stream}.
+
+\bt_p{stream} doesn't own \bt_p{data}: you remain responsible for
+destroying it, and \bt_p{stream} can be destroyed while its data slot
+isn't empty. The data slot of \bt_p{self_message_iterator} within
+\bt_p{stream} cannot be accessed by any other message iterator, even
+after \bt_p{self_message_iterator} is destroyed.
+
+@param[in] self_message_iterator
+    Message iterator instance.
+@param[in] stream
+    Stream to which to attach \bt_p{data}.
+@param[in] data
+    Data of \bt_p{self_message_iterator} to attach to \bt_p{stream},
+    or \c NULL to empty its data slot.
+
+@bt_pre_not_null{self_message_iterator}
+@bt_pre_not_null{stream}
+
+@sa bt_self_message_iterator_get_stream_data() &mdash;
+    Returns the data of a message iterator attached to a stream.
+*/
+extern void bt_self_message_iterator_set_stream_data(
+		bt_self_message_iterator *self_message_iterator,
+		const bt_stream *stream, void *data);
+
+/*!
+@brief
+    Returns the data of the \bt_msg_iter \bt_p{self_message_iterator}
+    attached to the \bt_stream \bt_p{stream}.
+
+@param[in] self_message_iterator
+    Message iterator instance.
+@param[in] stream
+    Stream of which to get the data of \bt_p{self_message_iterator}.
+
+@returns
+    Data of \bt_p{self_message_iterator} attached to \bt_p{stream},
+    or \c NULL if its data slot within \bt_p{stream} is empty.
+
+@bt_pre_not_null{self_message_iterator}
+@bt_pre_not_null{stream}
+
+@sa bt_self_message_iterator_set_stream_data() &mdash;
+    Attaches the data of a message iterator to a stream.
+*/
+extern void *bt_self_message_iterator_get_stream_data(
+		const bt_self_message_iterator *self_message_iterator,
+		const bt_stream *stream);
+
 /*! @} */
 
 /*!
@@ -221,6 +289,45 @@ extern void bt_self_message_iterator_configuration_set_can_seek_forward(
 		bt_self_message_iterator_configuration *configuration,
 		bt_bool can_seek_forward);
 
+/*!
+@brief
+    Sets the maximum batch size of the \bt_msg_iter of which the
+    configuration is \bt_p{configuration} to \bt_p{max_batch_size}.
+
+The maximum batch size of a message iterator is the maximum capacity
+of the message array which the library passes to its
+\ref api-msg-iter-cls-meth-next "next method".
+
+The library initially passes a message array of which the capacity is
+the default maximum batch size (15). Each time the next method
+completely fills the array a few times in a row, the library doubles
+the capacity of the array, up to \bt_p{max_batch_size}.
+
+Set a maximum batch size greater than the default one when your
+message iterator can cheaply produce many messages at once (for
+example, when it decodes them from a memory-mapped file) to reduce
+the per-batch overhead.
+
+@attention
+    You can only call this function during the execution of a
+    message iterator's
+    \ref api-msg-iter-cls-meth-init "initialization method".
+
+@param[in] configuration
+    Configuration of the message iterator of which to set the maximum
+    batch size.
+@param[in] max_batch_size
+    New maximum batch size of the message iterator of which the
+    configuration is \bt_p{configuration}.
+
+@bt_pre_not_null{configuration}
+@pre
+    1&nbsp;≤&nbsp;\bt_p{max_batch_size}&nbsp;≤&nbsp;1024.
+*/
+extern void bt_self_message_iterator_configuration_set_max_batch_size(
+		bt_self_message_iterator_configuration *configuration,
+		uint64_t max_batch_size);
+
 /*! @} */
 
 /*! @} */
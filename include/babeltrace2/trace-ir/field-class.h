@@ -647,6 +647,14 @@ A structure field class has the following specific property:
     bt_field_class_structure_borrow_member_by_index_const(), and
     bt_field_class_structure_borrow_member_by_name_const().
 
+    Get the index of the member having a given name with
+    bt_field_class_structure_get_member_index_by_name(). As a member's
+    index never changes, you can get it once and then borrow a
+    structure field's member field with
+    bt_field_structure_borrow_member_field_by_index() or
+    bt_field_structure_borrow_member_field_by_index_const() instead of
+    looking it up by name for each field.
+
     A structure field class member is a
     \ref api-fund-unique-object "unique object": it
     belongs to the structure field class which contains it.
@@ -3115,6 +3123,47 @@ extern const bt_field_class_structure_member *
 bt_field_class_structure_borrow_member_by_name_const(
     const bt_field_class *field_class, const char *name);
 
+/*!
+@brief
+    Sets \bt_p{*index} to the index of the member having the name
+    \bt_p{name} in the \bt_struct_fc \bt_p{field_class}.
+
+See the \ref api-tir-fc-struct-prop-members "members" property.
+
+If there's no member having the name \bt_p{name} in
+\bt_p{field_class}, this function returns #BT_FALSE and does not
+modify \bt_p{*index}.
+
+The index of a member never changes: you can use it afterwards with
+bt_field_class_structure_borrow_member_by_index_const() or, for any
+instance of \bt_p{field_class}, with
+bt_field_structure_borrow_member_field_by_index().
+
+@param[in] field_class
+    Structure field class in which to look for the member having the
+    name \bt_p{name}.
+@param[in] name
+    Name of the member of which to get the index.
+@param[out] index
+    <strong>On success</strong>, \bt_p{*index} is the index of the
+    member of \bt_p{field_class} having the name \bt_p{name}.
+
+@returns
+    #BT_TRUE if \bt_p{field_class} has a member having the name
+    \bt_p{name}.
+
+@bt_pre_not_null{field_class}
+@bt_pre_is_struct_fc{field_class}
+@bt_pre_not_null{name}
+@bt_pre_not_null{index}
+
+@sa bt_field_class_structure_borrow_member_by_name_const() &mdash;
+    Borrows a member by name.
+*/
+extern bt_bool bt_field_class_structure_get_member_index_by_name(
+    const bt_field_class *field_class, const char *name,
+    uint64_t *index);
+
 /*! @} */
 
 /*!
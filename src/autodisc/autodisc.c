@@ -9,6 +9,9 @@
 #include "logging/log.h"
 
 #include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
 
 #include "autodisc.h"
 #include "common/common.h"
@@ -35,6 +38,14 @@ typedef enum auto_source_discovery_internal_status {
 	AUTO_SOURCE_DISCOVERY_INTERNAL_STATUS_NO_MATCH		= __BT_FUNC_STATUS_NO_MATCH,
 } auto_source_discovery_internal_status;
 
+/* Input type masks of `struct auto_source_discovery::skipped_comp_classes` */
+#define INPUT_TYPE_MASK_STRING		(1U << 0)
+#define INPUT_TYPE_MASK_FILE		(1U << 1)
+#define INPUT_TYPE_MASK_DIRECTORY	(1U << 2)
+#define INPUT_TYPE_MASK_ALL		(INPUT_TYPE_MASK_STRING |	\
+					 INPUT_TYPE_MASK_FILE |		\
+					 INPUT_TYPE_MASK_DIRECTORY)
+
 /* Finalize and free a `struct auto_source_discovery_result`. */
 
 static
@@ -99,6 +110,12 @@ void auto_source_discovery_fini(struct auto_source_discovery *auto_disc)
 {
 	if (auto_disc->results) {
 		g_ptr_array_free(auto_disc->results, TRUE);
+		auto_disc->results = NULL;
+	}
+
+	if (auto_disc->skipped_comp_classes) {
+		g_hash_table_destroy(auto_disc->skipped_comp_classes);
+		auto_disc->skipped_comp_classes = NULL;
 	}
 }
 
@@ -115,6 +132,12 @@ int auto_source_discovery_init(struct auto_source_discovery *auto_disc)
 		goto error;
 	}
 
+	auto_disc->skipped_comp_classes = g_hash_table_new(g_direct_hash,
+		g_direct_equal);
+	if (!auto_disc->skipped_comp_classes) {
+		goto error;
+	}
+
 	status = 0;
 	goto end;
 
@@ -307,6 +330,11 @@ bt_query_executor_query_status simple_query(const bt_component_class *comp_cls,
 		goto end;
 	}
 
+	/*
+	 * The same inputs are often auto-discovered more than once
+	 * within a process.
+	 */
+	bt_query_executor_set_uses_result_cache(query_exec, BT_TRUE);
 	status = bt_query_executor_query(query_exec, result);
 
 end:
@@ -316,6 +344,34 @@ end:
 }
 
 
+static
+unsigned int input_type_mask(const char *input_type)
+{
+	if (strcmp(input_type, "string") == 0) {
+		return INPUT_TYPE_MASK_STRING;
+	} else if (strcmp(input_type, "file") == 0) {
+		return INPUT_TYPE_MASK_FILE;
+	} else {
+		BT_ASSERT(strcmp(input_type, "directory") == 0);
+		return INPUT_TYPE_MASK_DIRECTORY;
+	}
+}
+
+/*
+ * Don't query `cc` again for the input types of `mask` during this
+ * auto-discovery.
+ */
+static
+void skip_comp_class(struct auto_source_discovery *auto_disc,
+		const bt_component_class *cc, unsigned int mask)
+{
+	unsigned int cur_mask = GPOINTER_TO_UINT(g_hash_table_lookup(
+		auto_disc->skipped_comp_classes, cc));
+
+	g_hash_table_insert(auto_disc->skipped_comp_classes, (gpointer) cc,
+		GUINT_TO_POINTER(cur_mask | mask));
+}
+
 /*
  * Query all known source components to see if any of them can handle `input`
  * as the given `type`(arbitrary string, directory or file).
@@ -325,6 +381,10 @@ end:
  *
  * If `component_class_restrict` is non-NULL, only query source component classes
  * with that name.
+ *
+ * Skip the source component classes which previously replied that they don't
+ * support the `babeltrace.support-info` query object, or that they never
+ * support an input of type `type` (`type-is-supported` result entry).
  */
 static
 auto_source_discovery_internal_status support_info_query_all_sources(
@@ -343,6 +403,7 @@ auto_source_discovery_internal_status support_info_query_all_sources(
 	auto_source_discovery_internal_status status;
 	size_t i_plugins;
 	const struct bt_value *query_result = NULL;
+	unsigned int type_mask = input_type_mask(input_type);
 	struct {
 		const bt_component_class_source *source;
 		const bt_plugin *plugin;
@@ -402,6 +463,12 @@ auto_source_discovery_internal_status support_info_query_all_sources(
 				continue;
 			}
 
+			if (GPOINTER_TO_UINT(g_hash_table_lookup(
+					auto_disc->skipped_comp_classes, cc)) &
+					type_mask) {
+				continue;
+			}
+
 			BT_LOGD("babeltrace.support-info query: before: component-class-name=source.%s.%s, input=%s, "
 				"type=%s", plugin_name, source_cc_name, input, input_type);
 
@@ -443,6 +510,28 @@ auto_source_discovery_internal_status support_info_query_all_sources(
 						continue;
 					}
 
+					if (bt_value_map_has_entry(query_result, "type-is-supported")) {
+						const bt_value *type_is_supported_value =
+							bt_value_map_borrow_entry_value_const(
+								query_result, "type-is-supported");
+
+						if (bt_value_get_type(type_is_supported_value) != BT_VALUE_TYPE_BOOL) {
+							BT_LOGW("babeltrace.support-info query: unexpected type for entry `type-is-supported`: "
+								"component-class-name=source.%s.%s, input=%s, input-type=%s, "
+								"expected-entry-type=%s, actual-entry-type=%s",
+								bt_plugin_get_name(plugin),
+								bt_component_class_get_name(cc), input,
+								input_type,
+								bt_common_value_type_string(BT_VALUE_TYPE_BOOL),
+								bt_common_value_type_string(bt_value_get_type(type_is_supported_value)));
+						} else if (!bt_value_bool_get(type_is_supported_value)) {
+							BT_LOGD("babeltrace.support-info query: input type is never supported: "
+								"component-class-name=source.%s.%s, input-type=%s",
+								plugin_name, source_cc_name, input_type);
+							skip_comp_class(auto_disc, cc, type_mask);
+						}
+					}
+
 					if (bt_value_map_has_entry(query_result, "group")) {
 						group_value = bt_value_map_borrow_entry_value_const(query_result, "group");
 						BT_ASSERT(group_value);
@@ -501,6 +590,12 @@ auto_source_discovery_internal_status support_info_query_all_sources(
 					bt_plugin_get_name(plugin), bt_component_class_get_name(cc), input,
 					input_type,
 					bt_common_func_status_string(query_status));
+
+				if (query_status == BT_QUERY_EXECUTOR_QUERY_STATUS_UNKNOWN_OBJECT) {
+					/* No support info at all: don't ask again */
+					skip_comp_class(auto_disc, cc,
+						INPUT_TYPE_MASK_ALL);
+				}
 			}
 		}
 	}
@@ -579,14 +674,23 @@ auto_source_discovery_internal_status auto_discover_source_for_input_as_dir_or_f
 {
 	auto_source_discovery_internal_status status;
 	GError *error = NULL;
+	GStatBuf st;
+	bool is_file = false;
+	bool is_dir = false;
+
+	/* One stat(2) call instead of two g_file_test() ones */
+	if (g_stat(input->str, &st) == 0) {
+		is_file = S_ISREG(st.st_mode);
+		is_dir = S_ISDIR(st.st_mode);
+	}
 
-	if (g_file_test(input->str, G_FILE_TEST_IS_REGULAR)) {
+	if (is_file) {
 		/* It's a file. */
 		status = support_info_query_all_sources(input->str,
 			"file", original_input_index, plugins, plugin_count,
 			component_class_restrict, log_level, auto_disc,
 			interrupter);
-	} else if (g_file_test(input->str, G_FILE_TEST_IS_DIR)) {
+	} else if (is_dir) {
 		GDir *dir;
 		const gchar *dirent;
 		gsize saved_input_len;
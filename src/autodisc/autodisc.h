@@ -18,6 +18,14 @@
 struct auto_source_discovery {
 	/* Array of `struct auto_source_discovery_result *`. */
 	GPtrArray *results;
+
+	/*
+	 * Source component classes not to query again:
+	 * `const bt_component_class *` (borrowed) to a mask of the input
+	 * types (see `autodisc.c`) for which the component class said it
+	 * never supports an input.
+	 */
+	GHashTable *skipped_comp_classes;
 };
 
 /* Value type of the `auto_source_discovery::results` array. */
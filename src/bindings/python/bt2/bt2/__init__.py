@@ -115,6 +115,7 @@ from bt2.field_class import _StaticArrayFieldClassConst
 from bt2.field_class import _DynamicArrayFieldClassConst
 from bt2.field_class import _DynamicArrayWithLengthFieldFieldClassConst
 from bt2.field_path import FieldPathScope
+from bt2.field_path import CompiledFieldPath
 from bt2.field_path import _IndexFieldPathItem
 from bt2.field_path import _CurrentArrayElementFieldPathItem
 from bt2.field_path import _CurrentOptionContentFieldPathItem
@@ -157,6 +158,7 @@ from bt2.plugin import find_plugin
 from bt2.py_plugin import plugin_component_class
 from bt2.py_plugin import register_plugin
 from bt2.query_executor import QueryExecutor
+from bt2.sharding import read_columns_sharded
 from bt2.trace_collection_message_iterator import AutoSourceComponentSpec
 from bt2.trace_collection_message_iterator import ComponentSpec
 from bt2.trace_collection_message_iterator import TraceCollectionMessageIterator
@@ -7,6 +7,7 @@ from bt2 import event_class as bt2_event_class
 from bt2 import packet as bt2_packet
 from bt2 import stream as bt2_stream
 from bt2 import field as bt2_field
+from bt2 import wrapper_cache as bt2_wrapper_cache
 import collections.abc
 
 
@@ -31,7 +32,14 @@ class _EventConst(object._UniqueObject, collections.abc.Mapping):
     def cls(self):
         event_class_ptr = self._borrow_class_ptr(self._ptr)
         assert event_class_ptr is not None
-        return self._event_class_pycls._create_from_ptr_and_get_ref(event_class_ptr)
+        return bt2_wrapper_cache._get(
+            self._event_class_pycls, event_class_ptr, self._borrow_trace_ptr
+        )
+
+    def _borrow_trace_ptr(self):
+        return native_bt.stream_borrow_trace_const(
+            native_bt.event_borrow_stream_const(self._ptr)
+        )
 
     @property
     def name(self):
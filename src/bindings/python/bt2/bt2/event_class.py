@@ -67,8 +67,18 @@ class _EventClassConst(object._SharedObject):
         assert ptr is not None
         return self._create_value_from_ptr_and_get_ref(ptr)
 
+    # Set by _cache_frozen_properties()
+    _has_cached_name = False
+
+    def _cache_frozen_properties(self):
+        self._cached_name = native_bt.event_class_get_name(self._ptr)
+        self._has_cached_name = True
+
     @property
     def name(self):
+        if self._has_cached_name:
+            return self._cached_name
+
         return native_bt.event_class_get_name(self._ptr)
 
     @property
@@ -3,7 +3,13 @@
 # Copyright (c) 2018 Francis Deslauriers <francis.deslauriers@efficios.com>
 
 import collections
-from bt2 import native_bt, object
+from bt2 import native_bt, object, utils
+
+
+def _bt2_field_class():
+    from bt2 import field_class as bt2_field_class
+
+    return bt2_field_class
 
 
 class FieldPathScope:
@@ -68,3 +74,89 @@ _SCOPE_TO_OBJ = {
     native_bt.FIELD_PATH_SCOPE_EVENT_SPECIFIC_CONTEXT: FieldPathScope.EVENT_SPECIFIC_CONTEXT,
     native_bt.FIELD_PATH_SCOPE_EVENT_PAYLOAD: FieldPathScope.EVENT_PAYLOAD,
 }
+
+
+# A path to a boolean, bit array, integer, real, or string field within
+# the events of a given event class, resolved once to structure member
+# indexes.
+#
+# Reading values with a compiled field path creates no field objects:
+# the native part follows the member indexes and only creates the
+# resulting Python `bool`, `int`, `float`, or `str` objects.
+class CompiledFieldPath:
+    def __init__(self, event_class, root_scope, *member_names):
+        bt2_field_class = _bt2_field_class()
+
+        if root_scope == FieldPathScope.EVENT_PAYLOAD:
+            fc = event_class.payload_field_class
+        elif root_scope == FieldPathScope.EVENT_SPECIFIC_CONTEXT:
+            fc = event_class.specific_context_field_class
+        elif root_scope == FieldPathScope.EVENT_COMMON_CONTEXT:
+            fc = event_class.stream_class.event_common_context_field_class
+        elif root_scope == FieldPathScope.PACKET_CONTEXT:
+            fc = event_class.stream_class.packet_context_field_class
+        else:
+            raise ValueError('unknown root scope: {}'.format(root_scope))
+
+        if fc is None:
+            raise ValueError('event class has no such root field class')
+
+        indexes = []
+
+        for name in member_names:
+            utils._check_str(name)
+
+            if not isinstance(fc, bt2_field_class._StructureFieldClassConst):
+                raise TypeError(
+                    "cannot get member '{}' of a non-structure field class".format(
+                        name
+                    )
+                )
+
+            for index, member_name in enumerate(fc):
+                if member_name == name:
+                    break
+            else:
+                raise KeyError(name)
+
+            indexes.append(index)
+            fc = fc.member_at_index(index).field_class
+
+        if not isinstance(
+            fc,
+            (
+                bt2_field_class._BoolFieldClassConst,
+                bt2_field_class._BitArrayFieldClassConst,
+                bt2_field_class._IntegerFieldClassConst,
+                bt2_field_class._RealFieldClassConst,
+                bt2_field_class._StringFieldClassConst,
+            ),
+        ):
+            raise TypeError(
+                "unsupported field class for a compiled field path: '{}'".format(
+                    fc.__class__.__name__
+                )
+            )
+
+        self._event_class = event_class
+        self._root_scope = root_scope
+        self._indexes = tuple(indexes)
+
+    @property
+    def event_class(self):
+        return self._event_class
+
+    # Returns the value of the field of the event message `msg`, or
+    # `None` if `msg` isn't an event message of the event class of this
+    # path.
+    def value(self, msg):
+        return self.values((msg,))[0]
+
+    # Returns a list of the values of the field of the messages of the
+    # sequence `msgs` with a single native call. The value of a message
+    # which isn't an event message of the event class of this path is
+    # `None`.
+    def values(self, msgs):
+        return native_bt.bt2_compiled_field_path_read_values(
+            msgs, self._event_class._ptr, self._root_scope, self._indexes
+        )
@@ -9,6 +9,7 @@ from bt2 import component as bt2_component
 import functools
 from bt2 import port as bt2_port
 from bt2 import logging as bt2_logging
+from bt2 import value as bt2_value
 import bt2
 
 
@@ -43,6 +44,11 @@ class Graph(object._SharedObject):
         # this graph exists
         self._listener_partials = []
 
+        # the library only accepts to enable profiling before the
+        # graph runs for the first time
+        self._has_run = False
+        self._profiling_enabled = False
+
     def add_component(
         self,
         component_class,
@@ -132,13 +138,60 @@ class Graph(object._SharedObject):
         self._listener_partials.append(listener_from_native)
 
     def run_once(self):
-        status = native_bt.graph_run_once(self._ptr)
+        self._has_run = True
+        status = native_bt.bt2_graph_run_once(self._ptr)
         utils._handle_func_status(status, 'graph object could not run once')
 
     def run(self):
-        status = native_bt.graph_run(self._ptr)
+        self._has_run = True
+        status = native_bt.bt2_graph_run(self._ptr)
+        utils._handle_func_status(status, 'graph object stopped running')
+
+    def run_for(self, duration_us):
+        utils._check_uint64(duration_us)
+        self._has_run = True
+        status = native_bt.bt2_graph_run_for(self._ptr, duration_us)
         utils._handle_func_status(status, 'graph object stopped running')
 
+    def set_sink_component_consume_weight(self, component, weight):
+        utils._check_type(component, bt2_component._SinkComponentConst)
+        utils._check_uint64(weight)
+
+        if weight == 0:
+            raise ValueError('consume weight must be greater than 0')
+
+        if isinstance(component, bt2_component._UserSinkComponent):
+            comp_ptr = component._bt_as_not_self_specific_component_ptr(
+                component._bt_ptr
+            )
+        else:
+            comp_ptr = component._ptr
+
+        native_bt.graph_set_sink_component_consume_weight(self._ptr, comp_ptr, weight)
+
+    def enable_profiling(self, sampling_period=1):
+        utils._check_uint64(sampling_period)
+
+        if sampling_period == 0:
+            raise ValueError('sampling period must be greater than 0')
+
+        if self._has_run:
+            raise RuntimeError('cannot enable profiling: graph already ran')
+
+        status = native_bt.graph_enable_profiling(self._ptr, sampling_period)
+        utils._handle_func_status(status, 'cannot enable graph profiling')
+        self._profiling_enabled = True
+
+    @property
+    def profile(self):
+        if not self._profiling_enabled:
+            raise RuntimeError('graph profiling is not enabled')
+
+        status, profile_ptr = native_bt.graph_get_profile(self._ptr)
+        utils._handle_func_status(status, "cannot get graph's profile")
+        assert profile_ptr is not None
+        return bt2_value._create_from_const_ptr(profile_ptr)
+
     def add_interrupter(self, interrupter):
         utils._check_type(interrupter, bt2_interrupter.Interrupter)
         native_bt.graph_add_interrupter(self._ptr, interrupter._ptr)
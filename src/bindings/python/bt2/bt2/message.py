@@ -7,6 +7,8 @@ from bt2 import clock_snapshot as bt2_clock_snapshot
 from bt2 import packet as bt2_packet
 from bt2 import stream as bt2_stream
 from bt2 import event as bt2_event
+from bt2 import event_class as bt2_event_class
+from bt2 import wrapper_cache as bt2_wrapper_cache
 
 
 def _create_from_ptr(ptr):
@@ -288,6 +290,67 @@ class _DiscardedPacketsMessage(_DiscardedPacketsMessageConst, _DiscardedMessage)
     _item_name = 'packet'
 
 
+class _EventBatchMessageConst(_MessageConst):
+    @property
+    def event_class(self):
+        ec_ptr = native_bt.message_event_batch_borrow_event_class_const(self._ptr)
+        assert ec_ptr is not None
+        return bt2_wrapper_cache._get(
+            bt2_event_class._EventClassConst, ec_ptr, self._borrow_trace_ptr
+        )
+
+    def _borrow_trace_ptr(self):
+        return native_bt.stream_borrow_trace_const(
+            native_bt.message_event_batch_borrow_stream_const(self._ptr)
+        )
+
+    @property
+    def stream(self):
+        stream_ptr = native_bt.message_event_batch_borrow_stream_const(self._ptr)
+        assert stream_ptr is not None
+        return bt2_stream._StreamConst._create_from_ptr_and_get_ref(stream_ptr)
+
+    @property
+    def packet(self):
+        packet_ptr = native_bt.message_event_batch_borrow_packet_const(self._ptr)
+
+        if packet_ptr is None:
+            return
+
+        return bt2_packet._PacketConst._create_from_ptr_and_get_ref(packet_ptr)
+
+    @property
+    def capacity(self):
+        return native_bt.message_event_batch_get_capacity(self._ptr)
+
+    @property
+    def event_count(self):
+        return native_bt.message_event_batch_get_event_count(self._ptr)
+
+    def __len__(self):
+        return self.event_count
+
+    # List of the default clock snapshot values (cycles) of the events,
+    # or `None` if the stream class has no default clock class.
+    @property
+    def default_clock_snapshot_values(self):
+        return native_bt.bt2_message_event_batch_get_default_clock_snapshot_values(
+            self._ptr
+        )
+
+    # List of the values of the payload member named `name` of the
+    # events.
+    def payload_column(self, name):
+        utils._check_str(name)
+        payload_fc = self.event_class.payload_field_class
+
+        if payload_fc is None or name not in payload_fc:
+            raise KeyError(name)
+
+        index = list(payload_fc).index(name)
+        return native_bt.bt2_message_event_batch_get_payload_column(self._ptr, index)
+
+
 _MESSAGE_TYPE_TO_CLS = {
     native_bt.MESSAGE_TYPE_EVENT: _EventMessage,
     native_bt.MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY: _MessageIteratorInactivityMessage,
@@ -297,6 +360,7 @@ _MESSAGE_TYPE_TO_CLS = {
     native_bt.MESSAGE_TYPE_PACKET_END: _PacketEndMessage,
     native_bt.MESSAGE_TYPE_DISCARDED_EVENTS: _DiscardedEventsMessage,
     native_bt.MESSAGE_TYPE_DISCARDED_PACKETS: _DiscardedPacketsMessage,
+    native_bt.MESSAGE_TYPE_EVENT_BATCH: _EventBatchMessageConst,
 }
 
 _MESSAGE_TYPE_TO_CLS = {
@@ -308,4 +372,5 @@ _MESSAGE_TYPE_TO_CLS = {
     native_bt.MESSAGE_TYPE_PACKET_END: _PacketEndMessageConst,
     native_bt.MESSAGE_TYPE_DISCARDED_EVENTS: _DiscardedEventsMessageConst,
     native_bt.MESSAGE_TYPE_DISCARDED_PACKETS: _DiscardedPacketsMessageConst,
+    native_bt.MESSAGE_TYPE_EVENT_BATCH: _EventBatchMessageConst,
 }
@@ -18,6 +18,50 @@ class _MessageIterator(collections.abc.Iterator):
         raise NotImplementedError
 
 
+# Sequence of the messages of one batch returned by a message iterator
+# (see _UserComponentInputPortMessageIterator.next_batch()).
+#
+# The batch owns the native messages: it only creates a message object
+# when you get an item. A batch is valid until the next call to
+# next_batch() or to a seeking method of its iterator.
+class _MessageBatchConst(collections.abc.Sequence):
+    def __init__(self, ptr):
+        self._ptr = ptr
+        self._count = native_bt.bt2_message_batch_get_count(ptr)
+
+    def _invalidate(self):
+        if self._ptr is not None:
+            native_bt.bt2_message_batch_destroy(self._ptr)
+            self._ptr = None
+
+    def __del__(self):
+        self._invalidate()
+
+    def __len__(self):
+        return self._count
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(self._count))]
+
+        utils._check_int(index)
+
+        if index < 0:
+            index += self._count
+
+        if index < 0 or index >= self._count:
+            raise IndexError('message batch index out of range: {}'.format(index))
+
+        if self._ptr is None:
+            raise RuntimeError('message batch is not valid anymore')
+
+        msg_ptr = native_bt.bt2_message_batch_borrow_message_by_index(
+            self._ptr, index
+        )
+        native_bt.message_get_ref(msg_ptr)
+        return bt2_message._create_from_ptr(msg_ptr)
+
+
 class _UserComponentInputPortMessageIterator(object._SharedObject, _MessageIterator):
     _get_ref = staticmethod(native_bt.message_iterator_get_ref)
     _put_ref = staticmethod(native_bt.message_iterator_put_ref)
@@ -25,8 +69,33 @@ class _UserComponentInputPortMessageIterator(object._SharedObject, _MessageItera
     def __init__(self, ptr):
         self._current_msgs = []
         self._at = 0
+        self._current_batch = None
         super().__init__(ptr)
 
+    def _invalidate_current_batch(self):
+        if self._current_batch is not None:
+            self._current_batch._invalidate()
+            self._current_batch = None
+
+    # Returns the next batch of messages as a `_MessageBatchConst`
+    # object, without creating any message object until you access an
+    # item.
+    #
+    # Invalidates the batch which the previous call returned.
+    def next_batch(self):
+        if len(self._current_msgs) != self._at:
+            raise RuntimeError(
+                'cannot get a message batch while messages from next() are pending'
+            )
+
+        self._invalidate_current_batch()
+        status, batch_ptr = native_bt.bt2_message_iterator_next_batch(self._ptr)
+        utils._handle_func_status(
+            status, 'unexpected error: cannot advance the message iterator'
+        )
+        self._current_batch = _MessageBatchConst(batch_ptr)
+        return self._current_batch
+
     def __next__(self):
         if len(self._current_msgs) == self._at:
             status, msgs = native_bt.bt2_self_component_port_input_get_msg_range(
@@ -55,6 +124,7 @@ class _UserComponentInputPortMessageIterator(object._SharedObject, _MessageItera
         # Forget about buffered messages, they won't be valid after seeking.
         self._current_msgs.clear()
         self._at = 0
+        self._invalidate_current_batch()
 
         status = native_bt.message_iterator_seek_beginning(self._ptr)
         utils._handle_func_status(status, 'cannot seek message iterator beginning')
@@ -76,6 +146,7 @@ class _UserComponentInputPortMessageIterator(object._SharedObject, _MessageItera
         # Forget about buffered messages, they won't be valid after seeking.
         self._current_msgs.clear()
         self._at = 0
+        self._invalidate_current_batch()
 
         status = native_bt.message_iterator_seek_ns_from_origin(
             self._ptr, ns_from_origin
@@ -101,6 +172,20 @@ class _MessageIteratorConfiguration:
 
     can_seek_forward = property(fset=can_seek_forward)
 
+    def max_batch_size(self, value):
+        utils._check_uint64(value)
+
+        if value < 1 or value > 1024:
+            raise ValueError(
+                'maximum batch size must be between 1 and 1024: {}'.format(value)
+            )
+
+        native_bt.self_message_iterator_configuration_set_max_batch_size(
+            self._ptr, value
+        )
+
+    max_batch_size = property(fset=max_batch_size)
+
 
 # This is extended by the user to implement component classes in Python.  It
 # is created for a given output port when an input port message iterator is
@@ -178,6 +263,23 @@ class _UserMessageIterator(_MessageIterator):
         msg._get_ref(msg._ptr)
         return int(msg._ptr)
 
+    def _bt_next_batch_from_native(self, capacity):
+        # This can raise anything: it's catched by the native part.
+        #
+        # The user iterator has a `_user_next_batch` method which
+        # returns up to `capacity` messages at once. The native part
+        # checks the type of each returned message and acquires the
+        # references to give to the message array itself.
+        try:
+            msgs = self._user_next_batch(capacity)
+        except StopIteration:
+            raise bt2.Stop
+
+        if type(msgs) is not list:
+            msgs = list(msgs)
+
+        return msgs
+
     def _bt_can_seek_beginning_from_native(self):
         # Here, we mimic the behavior of the C API:
         #
@@ -17,6 +17,8 @@ static PyObject *py_mod_bt2_exc_memory_error = NULL;
 static PyObject *py_mod_bt2_exc_try_again_type = NULL;
 static PyObject *py_mod_bt2_exc_stop_type = NULL;
 static PyObject *py_mod_bt2_exc_unknown_object_type = NULL;
+static PyObject *py_mod_bt2_message = NULL;
+static PyObject *py_mod_bt2_message_const_type = NULL;
 
 static
 void bt_bt2_init_from_bt2(void)
@@ -46,6 +48,11 @@ void bt_bt2_init_from_bt2(void)
 	py_mod_bt2_exc_unknown_object_type =
 		PyObject_GetAttrString(py_mod_bt2, "UnknownObject");
 	BT_ASSERT(py_mod_bt2_exc_unknown_object_type);
+	py_mod_bt2_message = PyImport_ImportModule("bt2.message");
+	BT_ASSERT(py_mod_bt2_message);
+	py_mod_bt2_message_const_type =
+		PyObject_GetAttrString(py_mod_bt2_message, "_MessageConst");
+	BT_ASSERT(py_mod_bt2_message_const_type);
 }
 
 static
@@ -69,4 +76,6 @@ void bt_bt2_exit_handler(void)
 	Py_XDECREF(py_mod_bt2_exc_try_again_type);
 	Py_XDECREF(py_mod_bt2_exc_stop_type);
 	Py_XDECREF(py_mod_bt2_exc_unknown_object_type);
+	Py_XDECREF(py_mod_bt2_message);
+	Py_XDECREF(py_mod_bt2_message_const_type);
 }
@@ -195,6 +195,9 @@ bt_component_class_initialize_method_status component_class_init(
 	PyObject *py_comp_ptr = NULL;
 	bt_logging_level log_level = get_self_component_log_level(
 		self_component);
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	BT_ASSERT(self_component);
 	BT_ASSERT(self_component_v);
@@ -277,6 +280,7 @@ end:
 	Py_XDECREF(py_comp);
 	Py_XDECREF(py_params_ptr);
 	Py_XDECREF(py_comp_ptr);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -295,6 +299,9 @@ component_class_get_supported_mip_versions(
 	PyObject *py_range_set_addr = NULL;
 	bt_integer_range_set_unsigned *ret_range_set = NULL;
 	bt_component_class_get_supported_mip_versions_method_status status;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_cls = lookup_cc_ptr_to_py_cls(component_class);
 	if (!py_cls) {
@@ -374,6 +381,7 @@ end:
 	Py_XDECREF(py_params_ptr);
 	Py_XDECREF(py_range_set_addr);
 	bt_integer_range_set_unsigned_put_ref(ret_range_set);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -540,6 +548,9 @@ void component_class_source_finalize(bt_self_component_source *self_component_so
 	uint64_t i;
 	bt_self_component *self_component;
 	const bt_component_source *component_source;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	self_component = bt_self_component_source_as_self_component(
 		self_component_source);
@@ -561,6 +572,8 @@ void component_class_source_finalize(bt_self_component_source *self_component_so
 
 		delete_port_output_user_data(port_output);
 	}
+
+	PyGILState_Release(gil_state);
 }
 
 static
@@ -569,6 +582,9 @@ void component_class_filter_finalize(bt_self_component_filter *self_component_fi
 	uint64_t i;
 	bt_self_component *self_component;
 	const bt_component_filter *component_filter;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	self_component = bt_self_component_filter_as_self_component(
 		self_component_filter);
@@ -599,6 +615,8 @@ void component_class_filter_finalize(bt_self_component_filter *self_component_fi
 
 		delete_port_output_user_data(port_output);
 	}
+
+	PyGILState_Release(gil_state);
 }
 
 static
@@ -607,6 +625,9 @@ void component_class_sink_finalize(bt_self_component_sink *self_component_sink)
 	uint64_t i;
 	bt_self_component *self_component;
 	const bt_component_sink *component_sink;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	self_component = bt_self_component_sink_as_self_component(
 		self_component_sink);
@@ -628,6 +649,8 @@ void component_class_sink_finalize(bt_self_component_sink *self_component_sink)
 
 		delete_port_input_user_data(port_input);
 	}
+
+	PyGILState_Release(gil_state);
 }
 
 static
@@ -638,8 +661,10 @@ component_class_can_seek_beginning(
 	PyObject *py_iter;
 	PyObject *py_result = NULL;
 	bt_message_iterator_class_can_seek_beginning_method_status status;
-	py_iter = bt_self_message_iterator_get_data(self_message_iterator);
+	PyGILState_STATE gil_state;
 
+	gil_state = PyGILState_Ensure();
+	py_iter = bt_self_message_iterator_get_data(self_message_iterator);
 	BT_ASSERT(py_iter);
 
 	py_result = PyObject_CallMethod(py_iter,
@@ -657,6 +682,7 @@ component_class_can_seek_beginning(
 end:
 	Py_XDECREF(py_result);
 
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -667,6 +693,9 @@ component_class_seek_beginning(bt_self_message_iterator *self_message_iterator)
 	PyObject *py_iter;
 	PyObject *py_result;
 	bt_message_iterator_class_seek_beginning_method_status status;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_iter = bt_self_message_iterator_get_data(self_message_iterator);
 	BT_ASSERT(py_iter);
@@ -686,6 +715,7 @@ component_class_seek_beginning(bt_self_message_iterator *self_message_iterator)
 end:
 	Py_XDECREF(py_result);
 
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -698,6 +728,9 @@ component_class_can_seek_ns_from_origin(
 	PyObject *py_iter;
 	PyObject *py_result = NULL;
 	bt_message_iterator_class_can_seek_ns_from_origin_method_status status;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_iter = bt_self_message_iterator_get_data(self_message_iterator);
 	BT_ASSERT(py_iter);
@@ -717,6 +750,7 @@ component_class_can_seek_ns_from_origin(
 end:
 	Py_XDECREF(py_result);
 
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -729,6 +763,9 @@ component_class_seek_ns_from_origin(
 	PyObject *py_iter;
 	PyObject *py_result;
 	bt_message_iterator_class_seek_ns_from_origin_method_status status;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_iter = bt_self_message_iterator_get_data(self_message_iterator);
 	BT_ASSERT(py_iter);
@@ -748,6 +785,7 @@ component_class_seek_ns_from_origin(
 end:
 	Py_XDECREF(py_result);
 
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -767,6 +805,9 @@ bt_component_class_port_connected_method_status component_class_port_connected(
 	PyObject *py_method_result = NULL;
 	bt_logging_level log_level = get_self_component_log_level(
 		self_component);
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_comp = bt_self_component_get_data(self_component);
 	BT_ASSERT(py_comp);
@@ -805,6 +846,7 @@ end:
 	Py_XDECREF(py_other_port_ptr);
 	Py_XDECREF(py_method_result);
 
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -889,6 +931,9 @@ component_class_sink_graph_is_configured(
 	PyObject *py_method_result = NULL;
 	bt_component_class_sink_graph_is_configured_method_status status;
 	bt_self_component *self_component = bt_self_component_sink_as_self_component(self_component_sink);
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_comp = bt_self_component_get_data(self_component);
 
@@ -905,6 +950,7 @@ component_class_sink_graph_is_configured(
 
 end:
 	Py_XDECREF(py_method_result);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -928,6 +974,9 @@ bt_component_class_query_method_status component_class_query(
 			priv_query_executor);
 	bt_logging_level log_level =
 		bt_query_executor_get_logging_level(query_exec);
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	/*
 	 * If there's any `method_data`, assume this component class is
@@ -1014,6 +1063,7 @@ end:
 	Py_XDECREF(py_query_func);
 	Py_XDECREF(py_object);
 	Py_XDECREF(py_results_addr);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -1083,6 +1133,9 @@ component_class_message_iterator_init(
 			self_message_iterator);
 	bt_logging_level log_level = get_self_component_log_level(
 		self_component);
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_comp = bt_self_component_get_data(self_component);
 
@@ -1208,6 +1261,7 @@ end:
 	Py_XDECREF(py_component_port_output_ptr);
 	Py_XDECREF(py_init_method_result);
 	Py_XDECREF(py_iter);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -1218,6 +1272,9 @@ void component_class_message_iterator_finalize(
 	PyObject *py_message_iter = bt_self_message_iterator_get_data(
 		message_iterator);
 	PyObject *py_method_result = NULL;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	BT_ASSERT(py_message_iter);
 
@@ -1244,10 +1301,113 @@ void component_class_message_iterator_finalize(
 
 	Py_XDECREF(py_method_result);
 	Py_DECREF(py_message_iter);
+
+	PyGILState_Release(gil_state);
 }
 
 /* Valid for both sources and filters. */
 
+/*
+ * Calls the `_user_next_batch()` method of the user message iterator
+ * `py_message_iter` and moves the messages of the returned list to
+ * `msgs`.
+ *
+ * The type checks happen here rather than on the Python side so that a
+ * batch costs a single Python method call.
+ */
+static
+bt_message_iterator_class_next_method_status
+component_class_message_iterator_next_batch(
+		bt_self_message_iterator *message_iterator,
+		PyObject *py_message_iter, bt_message_array_const msgs,
+		uint64_t capacity, uint64_t *count)
+{
+	bt_message_iterator_class_next_method_status status;
+	PyObject *py_method_result = NULL;
+	Py_ssize_t len;
+	Py_ssize_t i;
+
+	py_method_result = PyObject_CallMethod(py_message_iter,
+		"_bt_next_batch_from_native", "K",
+		(unsigned long long) capacity);
+	if (!py_method_result) {
+		status = py_exc_to_status_message_iterator_clear(message_iterator);
+		goto end;
+	}
+
+	BT_ASSERT_DBG(PyList_Check(py_method_result));
+	len = PyList_GET_SIZE(py_method_result);
+	if (len == 0 || (uint64_t) len > capacity) {
+		PyErr_Format(PyExc_ValueError,
+			"`_user_next_batch()` returned %zd messages "
+			"(expecting between 1 and %llu)",
+			len, (unsigned long long) capacity);
+		status = py_exc_to_status_message_iterator_clear(message_iterator);
+		goto end;
+	}
+
+	/* Get all the native messages before acquiring any reference */
+	for (i = 0; i < len; i++) {
+		PyObject *py_msg = PyList_GET_ITEM(py_method_result, i);
+		PyObject *py_ptr;
+		PyObject *py_addr;
+		int is_msg = PyObject_IsInstance(py_msg,
+			py_mod_bt2_message_const_type);
+
+		if (is_msg < 0) {
+			status = py_exc_to_status_message_iterator_clear(
+				message_iterator);
+			goto end;
+		} else if (!is_msg) {
+			PyErr_Format(PyExc_TypeError,
+				"`_user_next_batch()` returned a `%s` object "
+				"at index %zd (expecting a message)",
+				Py_TYPE(py_msg)->tp_name, i);
+			status = py_exc_to_status_message_iterator_clear(
+				message_iterator);
+			goto end;
+		}
+
+		/* Same as `int(msg._ptr)` */
+		py_ptr = PyObject_GetAttrString(py_msg, "_ptr");
+		if (!py_ptr) {
+			status = py_exc_to_status_message_iterator_clear(
+				message_iterator);
+			goto end;
+		}
+
+		py_addr = PyNumber_Long(py_ptr);
+		Py_DECREF(py_ptr);
+		if (!py_addr) {
+			status = py_exc_to_status_message_iterator_clear(
+				message_iterator);
+			goto end;
+		}
+
+		msgs[i] = PyLong_AsVoidPtr(py_addr);
+		Py_DECREF(py_addr);
+
+		/* Overflow errors should never happen. */
+		BT_ASSERT_DBG(!PyErr_Occurred());
+	}
+
+	/*
+	 * The references we put in the message array are new ones: the
+	 * Python message objects may stay alive if the user has kept
+	 * references to them.
+	 */
+	for (i = 0; i < len; i++) {
+		bt_message_get_ref(msgs[i]);
+	}
+
+	*count = (uint64_t) len;
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+end:
+	Py_XDECREF(py_method_result);
+	return status;
+}
+
 static
 bt_message_iterator_class_next_method_status
 component_class_message_iterator_next(
@@ -1258,8 +1418,19 @@ component_class_message_iterator_next(
 	bt_message_iterator_class_next_method_status status;
 	PyObject *py_message_iter = bt_self_message_iterator_get_data(message_iterator);
 	PyObject *py_method_result = NULL;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	BT_ASSERT_DBG(py_message_iter);
+
+	if (PyObject_HasAttrString(py_message_iter, "_user_next_batch")) {
+		status = component_class_message_iterator_next_batch(
+			message_iterator, py_message_iter, msgs, capacity,
+			count);
+		goto end;
+	}
+
 	py_method_result = PyObject_CallMethod(py_message_iter,
 		"_bt_next_from_native", NULL);
 	if (!py_method_result) {
@@ -1282,6 +1453,7 @@ component_class_message_iterator_next(
 
 end:
 	Py_XDECREF(py_method_result);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -1293,6 +1465,9 @@ component_class_sink_consume(bt_self_component_sink *self_component_sink)
 	PyObject *py_comp = bt_self_component_get_data(self_component);
 	PyObject *py_method_result = NULL;
 	bt_component_class_sink_consume_method_status status;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	BT_ASSERT_DBG(py_comp);
 
@@ -1307,6 +1482,7 @@ component_class_sink_consume(bt_self_component_sink *self_component_sink)
 
 end:
 	Py_XDECREF(py_method_result);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -5,3 +5,11 @@
  */
 
 %include <babeltrace2/trace-ir/field-path.h>
+
+%{
+#include "native_bt_field_path.i.h"
+%}
+
+PyObject *bt_bt2_compiled_field_path_read_values(PyObject *py_msgs,
+		const bt_event_class *event_class, int root_scope,
+		PyObject *py_indexes);
@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+/*
+ * Returns the root field of the scope `root_scope` of the event of
+ * `msg`, or `NULL` if there's none.
+ */
+static
+const bt_field *compiled_field_path_borrow_root_field(const bt_message *msg,
+		int root_scope)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_field *field = NULL;
+
+	switch (root_scope) {
+	case BT_FIELD_PATH_SCOPE_PACKET_CONTEXT:
+	{
+		const bt_packet *packet = bt_event_borrow_packet_const(event);
+
+		if (packet) {
+			field = bt_packet_borrow_context_field_const(packet);
+		}
+
+		break;
+	}
+	case BT_FIELD_PATH_SCOPE_EVENT_COMMON_CONTEXT:
+		field = bt_event_borrow_common_context_field_const(event);
+		break;
+	case BT_FIELD_PATH_SCOPE_EVENT_SPECIFIC_CONTEXT:
+		field = bt_event_borrow_specific_context_field_const(event);
+		break;
+	case BT_FIELD_PATH_SCOPE_EVENT_PAYLOAD:
+		field = bt_event_borrow_payload_field_const(event);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return field;
+}
+
+/* Returns a new reference to the Python value of the leaf `field` */
+static
+PyObject *compiled_field_path_leaf_value(const bt_field *field)
+{
+	bt_field_class_type type = bt_field_get_class_type(field);
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		return PyBool_FromLong(bt_field_bool_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		return PyLong_FromUnsignedLongLong(
+			bt_field_bit_array_get_value_as_integer(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		return PyLong_FromUnsignedLongLong(
+			bt_field_integer_unsigned_get_value(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		return PyLong_FromLongLong(
+			bt_field_integer_signed_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		return PyFloat_FromDouble(
+			bt_field_real_single_precision_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		return PyFloat_FromDouble(
+			bt_field_real_double_precision_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		return PyUnicode_FromStringAndSize(
+			bt_field_string_get_value(field),
+			bt_field_string_get_length(field));
+	}
+
+	/* The Python side only compiles paths to the types above */
+	bt_common_abort();
+}
+
+/*
+ * Reads the field at the structure member indexes `py_indexes` (tuple
+ * of integers) of the scope `root_scope` of each message of `py_msgs`
+ * (sequence of message objects).
+ *
+ * Returns a new list of values, with `None` for the messages which are
+ * not event messages of `event_class`, or `NULL` with a Python
+ * exception set on error.
+ */
+static
+PyObject *bt_bt2_compiled_field_path_read_values(PyObject *py_msgs,
+		const bt_event_class *event_class, int root_scope,
+		PyObject *py_indexes)
+{
+	PyObject *py_msgs_fast = NULL;
+	PyObject *py_values = NULL;
+	uint64_t *indexes = NULL;
+	Py_ssize_t index_count;
+	Py_ssize_t msg_count;
+	Py_ssize_t i;
+
+	BT_ASSERT(PyTuple_Check(py_indexes));
+	index_count = PyTuple_GET_SIZE(py_indexes);
+	indexes = g_new(uint64_t, index_count);
+
+	for (i = 0; i < index_count; i++) {
+		indexes[i] = PyLong_AsUnsignedLongLong(
+			PyTuple_GET_ITEM(py_indexes, i));
+		if (PyErr_Occurred()) {
+			goto error;
+		}
+	}
+
+	py_msgs_fast = PySequence_Fast(py_msgs,
+		"expecting a sequence of messages");
+	if (!py_msgs_fast) {
+		goto error;
+	}
+
+	msg_count = PySequence_Fast_GET_SIZE(py_msgs_fast);
+	py_values = PyList_New(msg_count);
+	if (!py_values) {
+		goto error;
+	}
+
+	for (i = 0; i < msg_count; i++) {
+		PyObject *py_msg = PySequence_Fast_GET_ITEM(py_msgs_fast, i);
+		PyObject *py_ptr;
+		PyObject *py_value;
+		const bt_message *msg;
+		const bt_field *field;
+		Py_ssize_t j;
+		int ret;
+
+		py_ptr = PyObject_GetAttrString(py_msg, "_ptr");
+		if (!py_ptr) {
+			goto error;
+		}
+
+		ret = SWIG_ConvertPtr(py_ptr, (void **) &msg,
+			SWIGTYPE_p_bt_message, 0);
+		Py_DECREF(py_ptr);
+		if (!SWIG_IsOK(ret)) {
+			PyErr_Format(PyExc_TypeError,
+				"expecting a message object at index %zd, got `%s`",
+				i, Py_TYPE(py_msg)->tp_name);
+			goto error;
+		}
+
+		field = NULL;
+
+		if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_EVENT &&
+				bt_event_borrow_class_const(
+					bt_message_event_borrow_event_const(msg)) ==
+					event_class) {
+			field = compiled_field_path_borrow_root_field(msg,
+				root_scope);
+		}
+
+		for (j = 0; field && j < index_count; j++) {
+			field = bt_field_structure_borrow_member_field_by_index_const(
+				field, indexes[j]);
+		}
+
+		if (field) {
+			py_value = compiled_field_path_leaf_value(field);
+			if (!py_value) {
+				goto error;
+			}
+		} else {
+			py_value = Py_None;
+			Py_INCREF(py_value);
+		}
+
+		/* Steals the reference */
+		PyList_SET_ITEM(py_values, i, py_value);
+	}
+
+	goto end;
+
+error:
+	Py_CLEAR(py_values);
+
+end:
+	Py_XDECREF(py_msgs_fast);
+	g_free(indexes);
+	return py_values;
+}
@@ -117,3 +117,10 @@ bt_bt2_graph_add_sink_component(
 		const char *name, const bt_value *params,
 		PyObject *obj, bt_logging_level log_level,
 		const bt_component_sink **component);
+
+bt_graph_run_status bt_bt2_graph_run(bt_graph *graph);
+
+bt_graph_run_status bt_bt2_graph_run_for(bt_graph *graph,
+		uint64_t duration_us);
+
+bt_graph_run_once_status bt_bt2_graph_run_once(bt_graph *graph);
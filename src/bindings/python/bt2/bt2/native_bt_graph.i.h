@@ -17,7 +17,9 @@ static bt_graph_listener_func_status port_added_listener(
 	PyObject *py_port_ptr = NULL;
 	PyObject *py_res = NULL;
 	bt_graph_listener_func_status status;
+	PyGILState_STATE gil_state;
 
+	gil_state = PyGILState_Ensure();
 	py_component_ptr = SWIG_NewPointerObj(SWIG_as_voidptr(component), component_swig_type, 0);
 	if (!py_component_ptr) {
 		BT_LOGF_STR("Failed to create component SWIG pointer object.");
@@ -49,6 +51,7 @@ end:
 	Py_XDECREF(py_res);
 	Py_XDECREF(py_port_ptr);
 	Py_XDECREF(py_component_ptr);
+	PyGILState_Release(gil_state);
 	return status;
 }
 
@@ -257,3 +260,48 @@ bt_bt2_graph_add_sink_component(
 		component_class, name, params, obj == Py_None ? NULL : obj,
 		log_level, component);
 }
+
+/*
+ * The graph running functions release the GIL while the graph runs so
+ * that other Python threads may run meanwhile (for example, to run
+ * other graphs), given that native components don't need it. The
+ * methods of Python components and Python listeners reacquire it (see
+ * native_bt_component_class.i.h).
+ */
+
+static
+bt_graph_run_status bt_bt2_graph_run(bt_graph *graph)
+{
+	bt_graph_run_status status;
+
+	Py_BEGIN_ALLOW_THREADS
+	status = bt_graph_run(graph);
+	Py_END_ALLOW_THREADS
+
+	return status;
+}
+
+static
+bt_graph_run_status bt_bt2_graph_run_for(bt_graph *graph,
+		uint64_t duration_us)
+{
+	bt_graph_run_status status;
+
+	Py_BEGIN_ALLOW_THREADS
+	status = bt_graph_run_for(graph, duration_us);
+	Py_END_ALLOW_THREADS
+
+	return status;
+}
+
+static
+bt_graph_run_once_status bt_bt2_graph_run_once(bt_graph *graph)
+{
+	bt_graph_run_once_status status;
+
+	Py_BEGIN_ALLOW_THREADS
+	status = bt_graph_run_once(graph);
+	Py_END_ALLOW_THREADS
+
+	return status;
+}
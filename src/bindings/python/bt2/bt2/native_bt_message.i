@@ -27,3 +27,13 @@
 }
 
 %include <babeltrace2/graph/message.h>
+
+/* Helper functions for Python */
+%{
+#include "native_bt_message.i.h"
+%}
+
+PyObject *bt_bt2_message_event_batch_get_default_clock_snapshot_values(
+		const bt_message *msg);
+PyObject *bt_bt2_message_event_batch_get_payload_column(
+		const bt_message *msg, uint64_t member_index);
@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+/*
+ * Returns the default clock snapshot values of the event batch message
+ * `msg` as a new list of integers, or `None` if the stream class of
+ * `msg` has no default clock class.
+ */
+static
+PyObject *bt_bt2_message_event_batch_get_default_clock_snapshot_values(
+		const bt_message *msg)
+{
+	const uint64_t *values =
+		bt_message_event_batch_borrow_default_clock_snapshot_values_const(
+			msg);
+	uint64_t count = bt_message_event_batch_get_event_count(msg);
+	PyObject *py_values;
+	uint64_t i;
+
+	if (!values) {
+		Py_RETURN_NONE;
+	}
+
+	py_values = PyList_New(count);
+	if (!py_values) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		PyObject *py_value = PyLong_FromUnsignedLongLong(values[i]);
+
+		if (!py_value) {
+			Py_CLEAR(py_values);
+			goto end;
+		}
+
+		/* PyList_SET_ITEM() steals `py_value` */
+		PyList_SET_ITEM(py_values, i, py_value);
+	}
+
+end:
+	return py_values;
+}
+
+/*
+ * Returns the payload column `member_index` of the event batch message
+ * `msg` as a new list of Python objects (`bool`, `int`, `float`, or
+ * `str`, depending on the class of the payload member).
+ */
+static
+PyObject *bt_bt2_message_event_batch_get_payload_column(
+		const bt_message *msg, uint64_t member_index)
+{
+	const bt_field_class *member_fc =
+		bt_field_class_structure_member_borrow_field_class_const(
+			bt_field_class_structure_borrow_member_by_index_const(
+				bt_event_class_borrow_payload_field_class_const(
+					bt_message_event_batch_borrow_event_class_const(
+						msg)),
+				member_index));
+	bt_field_class_type fc_type = bt_field_class_get_type(member_fc);
+	const void *column = bt_message_event_batch_borrow_payload_column_const(
+		msg, member_index);
+	uint64_t count = bt_message_event_batch_get_event_count(msg);
+	PyObject *py_column;
+	uint64_t i;
+
+	py_column = PyList_New(count);
+	if (!py_column) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		PyObject *py_item;
+
+		if (fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+			py_item = PyBool_FromLong(
+				(long) ((const uint64_t *) column)[i]);
+		} else if (bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+			py_item = PyLong_FromUnsignedLongLong(
+				((const uint64_t *) column)[i]);
+		} else if (bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+			py_item = PyLong_FromLongLong(
+				((const int64_t *) column)[i]);
+		} else if (bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_REAL)) {
+			py_item = PyFloat_FromDouble(
+				((const double *) column)[i]);
+		} else {
+			BT_ASSERT(fc_type == BT_FIELD_CLASS_TYPE_STRING);
+			py_item = PyUnicode_FromString(
+				bt_message_event_batch_get_payload_string(msg,
+					member_index, i));
+		}
+
+		if (!py_item) {
+			Py_CLEAR(py_column);
+			goto end;
+		}
+
+		/* PyList_SET_ITEM() steals `py_item` */
+		PyList_SET_ITEM(py_column, i, py_item);
+	}
+
+end:
+	return py_column;
+}
@@ -47,3 +47,14 @@ PyObject *bt_bt2_get_user_component_from_user_msg_iter(
 		bt_self_message_iterator *self_message_iterator);
 PyObject *bt_bt2_self_component_port_input_get_msg_range(
 		bt_message_iterator *iter);
+PyObject *bt_bt2_message_iterator_next_batch(bt_message_iterator *iter);
+void bt_bt2_message_batch_destroy(struct bt_bt2_message_batch *batch);
+uint64_t bt_bt2_message_batch_get_count(struct bt_bt2_message_batch *batch);
+const bt_message *bt_bt2_message_batch_borrow_message_by_index(
+		struct bt_bt2_message_batch *batch, uint64_t index);
+PyObject *bt_bt2_column_reader_create(PyObject *py_columns,
+		PyObject *py_event_class_names);
+void bt_bt2_column_reader_destroy(struct bt_bt2_column_reader *reader);
+PyObject *bt_bt2_column_reader_fill(struct bt_bt2_column_reader *reader,
+		bt_message_iterator *iter, PyObject *py_buffers,
+		uint64_t row_offset);
@@ -112,7 +112,684 @@ static PyObject *bt_bt2_self_component_port_input_get_msg_range(
 	uint64_t message_count = 0;
 	bt_message_iterator_next_status status;
 
+	/*
+	 * Release the GIL while upstream native components work; the
+	 * methods of upstream Python components reacquire it.
+	 */
+	Py_BEGIN_ALLOW_THREADS
 	status = bt_message_iterator_next(iter,
 		&messages, &message_count);
+	Py_END_ALLOW_THREADS
+
 	return get_msg_range_common(status, messages, message_count);
 }
+
+/* Batch of messages which a Python message batch object owns */
+struct bt_bt2_message_batch {
+	uint64_t count;
+
+	/* Owned by this */
+	const bt_message *msgs[];
+};
+
+static
+void bt_bt2_message_batch_destroy(struct bt_bt2_message_batch *batch)
+{
+	uint64_t i;
+
+	if (!batch) {
+		return;
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		bt_message_put_ref(batch->msgs[i]);
+	}
+
+	g_free(batch);
+}
+
+static
+uint64_t bt_bt2_message_batch_get_count(struct bt_bt2_message_batch *batch)
+{
+	return batch->count;
+}
+
+static
+const bt_message *bt_bt2_message_batch_borrow_message_by_index(
+		struct bt_bt2_message_batch *batch, uint64_t index)
+{
+	BT_ASSERT_DBG(index < batch->count);
+	return batch->msgs[index];
+}
+
+/*
+ * Like bt_bt2_self_component_port_input_get_msg_range(), but returns
+ * the messages as a single message batch object (to destroy with
+ * bt_bt2_message_batch_destroy()) instead of a list of one Python
+ * object per message.
+ */
+static
+PyObject *bt_bt2_message_iterator_next_batch(bt_message_iterator *iter)
+{
+	bt_message_array_const messages;
+	uint64_t message_count = 0;
+	bt_message_iterator_next_status status;
+	struct bt_bt2_message_batch *batch;
+	PyObject *py_batch = NULL;
+
+	Py_BEGIN_ALLOW_THREADS
+	status = bt_message_iterator_next(iter, &messages, &message_count);
+	Py_END_ALLOW_THREADS
+
+	if (status != __BT_FUNC_STATUS_OK) {
+		return Py_BuildValue("(iO)", (int) status, Py_None);
+	}
+
+	batch = g_malloc(sizeof(*batch) +
+		message_count * sizeof(*batch->msgs));
+	batch->count = message_count;
+	memcpy(batch->msgs, messages, message_count * sizeof(*messages));
+	py_batch = SWIG_NewPointerObj(SWIG_as_voidptr(batch),
+		SWIGTYPE_p_bt_bt2_message_batch, 0);
+	if (!py_batch) {
+		bt_bt2_message_batch_destroy(batch);
+		return NULL;
+	}
+
+	/* `N` steals the reference of `py_batch` */
+	return Py_BuildValue("(iN)", (int) status, py_batch);
+}
+
+/*
+ * Column reader: fills caller-provided 64-bit integer buffers with the
+ * values of selected columns of event messages, pulling messages from
+ * a message iterator without creating any Python object per message.
+ */
+
+enum column_reader_column_kind {
+	COLUMN_READER_COLUMN_KIND_TIMESTAMP	= 0,
+	COLUMN_READER_COLUMN_KIND_EVENT_CLASS_ID	= 1,
+	COLUMN_READER_COLUMN_KIND_STREAM_ID	= 2,
+	COLUMN_READER_COLUMN_KIND_FIELD	= 3,
+};
+
+struct column_reader_column {
+	enum column_reader_column_kind kind;
+
+	/* For `COLUMN_READER_COLUMN_KIND_FIELD` only */
+	int root_scope;
+
+	/* Array of `gchar *` (owned by this), or `NULL` */
+	GPtrArray *member_names;
+};
+
+/* Resolved columns of a given event class */
+struct column_reader_event_class {
+	/* Whether or not the events of this class make rows */
+	bool selected;
+
+	/*
+	 * Array (one per column) of `GArray *` of `uint64_t` structure
+	 * member indexes (owned by this), or `NULL` for a column which
+	 * isn't a field column.
+	 */
+	GPtrArray *member_indexes;
+};
+
+struct bt_bt2_column_reader {
+	/* Array of `struct column_reader_column` */
+	GArray *columns;
+
+	/* Set of `gchar *` selected event class names, or `NULL` for all */
+	GHashTable *event_class_names;
+
+	/*
+	 * Hash table of `const bt_event_class *` (owned) to
+	 * `struct column_reader_event_class *` (owned).
+	 */
+	GHashTable *event_classes;
+
+	/* Last resolved event class, to avoid most hash table lookups */
+	const bt_event_class *last_event_class;
+	struct column_reader_event_class *last_event_class_info;
+
+	/*
+	 * Messages (owned from index `pending_msgs_pos`) of the last
+	 * message iterator batch which didn't fit in the buffers.
+	 */
+	GPtrArray *pending_msgs;
+	guint pending_msgs_pos;
+};
+
+static
+void column_reader_destroy_event_class(gpointer data)
+{
+	struct column_reader_event_class *ec_info = data;
+
+	if (ec_info->member_indexes) {
+		g_ptr_array_free(ec_info->member_indexes, TRUE);
+	}
+
+	g_free(ec_info);
+}
+
+static
+void column_reader_put_event_class(gpointer data)
+{
+	bt_event_class_put_ref(data);
+}
+
+static
+void column_reader_free_indexes(gpointer data)
+{
+	if (data) {
+		g_array_free(data, TRUE);
+	}
+}
+
+static
+void bt_bt2_column_reader_destroy(struct bt_bt2_column_reader *reader)
+{
+	guint i;
+
+	if (!reader) {
+		return;
+	}
+
+	if (reader->columns) {
+		for (i = 0; i < reader->columns->len; i++) {
+			struct column_reader_column *column = &g_array_index(
+				reader->columns, struct column_reader_column, i);
+
+			if (column->member_names) {
+				g_ptr_array_free(column->member_names, TRUE);
+			}
+		}
+
+		g_array_free(reader->columns, TRUE);
+	}
+
+	if (reader->event_class_names) {
+		g_hash_table_destroy(reader->event_class_names);
+	}
+
+	if (reader->event_classes) {
+		g_hash_table_destroy(reader->event_classes);
+	}
+
+	if (reader->pending_msgs) {
+		for (i = reader->pending_msgs_pos; i < reader->pending_msgs->len;
+				i++) {
+			bt_message_put_ref(reader->pending_msgs->pdata[i]);
+		}
+
+		g_ptr_array_free(reader->pending_msgs, TRUE);
+	}
+
+	g_free(reader);
+}
+
+/*
+ * Creates a column reader.
+ *
+ * `py_columns` is a sequence of `(kind, root scope, member names)`
+ * tuples, where `member names` is a tuple of strings (empty for a
+ * column which isn't a field column).
+ *
+ * `py_event_class_names` is a sequence of event class names to select,
+ * or `None` to select all the event classes.
+ *
+ * Returns the new column reader object, to destroy with
+ * bt_bt2_column_reader_destroy(), or `NULL` with a Python exception set
+ * on error.
+ */
+static
+PyObject *bt_bt2_column_reader_create(PyObject *py_columns,
+		PyObject *py_event_class_names)
+{
+	PyObject *py_reader = NULL;
+	struct bt_bt2_column_reader *reader = g_new0(
+		struct bt_bt2_column_reader, 1);
+	PyObject *py_columns_fast = NULL;
+	PyObject *py_names_fast = NULL;
+	Py_ssize_t i;
+
+	reader->columns = g_array_new(FALSE, TRUE,
+		sizeof(struct column_reader_column));
+	reader->event_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, column_reader_put_event_class,
+		column_reader_destroy_event_class);
+	reader->pending_msgs = g_ptr_array_new();
+	py_columns_fast = PySequence_Fast(py_columns,
+		"expecting a sequence of columns");
+	if (!py_columns_fast) {
+		goto error;
+	}
+
+	for (i = 0; i < PySequence_Fast_GET_SIZE(py_columns_fast); i++) {
+		PyObject *py_column = PySequence_Fast_GET_ITEM(py_columns_fast, i);
+		struct column_reader_column column = { 0 };
+		PyObject *py_member_names;
+		Py_ssize_t j;
+		int kind;
+
+		if (!PyArg_ParseTuple(py_column, "iiO!", &kind,
+				&column.root_scope, &PyTuple_Type,
+				&py_member_names)) {
+			goto error;
+		}
+
+		if (kind < COLUMN_READER_COLUMN_KIND_TIMESTAMP ||
+				kind > COLUMN_READER_COLUMN_KIND_FIELD) {
+			PyErr_Format(PyExc_ValueError,
+				"unknown column kind: %d", kind);
+			goto error;
+		}
+
+		column.kind = kind;
+
+		if (column.kind == COLUMN_READER_COLUMN_KIND_FIELD) {
+			column.member_names = g_ptr_array_new_with_free_func(
+				g_free);
+
+			for (j = 0; j < PyTuple_GET_SIZE(py_member_names); j++) {
+				const char *name = PyUnicode_AsUTF8(
+					PyTuple_GET_ITEM(py_member_names, j));
+
+				if (!name) {
+					g_ptr_array_free(column.member_names,
+						TRUE);
+					goto error;
+				}
+
+				g_ptr_array_add(column.member_names,
+					g_strdup(name));
+			}
+		}
+
+		g_array_append_val(reader->columns, column);
+	}
+
+	if (py_event_class_names != Py_None) {
+		reader->event_class_names = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, NULL);
+		py_names_fast = PySequence_Fast(py_event_class_names,
+			"expecting a sequence of event class names");
+		if (!py_names_fast) {
+			goto error;
+		}
+
+		for (i = 0; i < PySequence_Fast_GET_SIZE(py_names_fast); i++) {
+			const char *name = PyUnicode_AsUTF8(
+				PySequence_Fast_GET_ITEM(py_names_fast, i));
+
+			if (!name) {
+				goto error;
+			}
+
+			g_hash_table_add(reader->event_class_names,
+				g_strdup(name));
+		}
+	}
+
+	py_reader = SWIG_NewPointerObj(SWIG_as_voidptr(reader),
+		SWIGTYPE_p_bt_bt2_column_reader, 0);
+	if (py_reader) {
+		goto end;
+	}
+
+error:
+	bt_bt2_column_reader_destroy(reader);
+
+end:
+	Py_XDECREF(py_columns_fast);
+	Py_XDECREF(py_names_fast);
+	return py_reader;
+}
+
+/*
+ * Returns the root field class of the scope `root_scope` of the events
+ * of `ec`, or `NULL` if there's none.
+ */
+static
+const bt_field_class *column_reader_borrow_root_field_class(
+		const bt_event_class *ec, int root_scope)
+{
+	const bt_stream_class *sc = bt_event_class_borrow_stream_class_const(ec);
+
+	switch (root_scope) {
+	case BT_FIELD_PATH_SCOPE_PACKET_CONTEXT:
+		return bt_stream_class_borrow_packet_context_field_class_const(sc);
+	case BT_FIELD_PATH_SCOPE_EVENT_COMMON_CONTEXT:
+		return bt_stream_class_borrow_event_common_context_field_class_const(sc);
+	case BT_FIELD_PATH_SCOPE_EVENT_SPECIFIC_CONTEXT:
+		return bt_event_class_borrow_specific_context_field_class_const(ec);
+	case BT_FIELD_PATH_SCOPE_EVENT_PAYLOAD:
+		return bt_event_class_borrow_payload_field_class_const(ec);
+	default:
+		return NULL;
+	}
+}
+
+/*
+ * Resolves the member names of `column` within the field classes of
+ * `ec` to structure member indexes.
+ *
+ * Returns `NULL` if the event class has no such field or if its field
+ * class isn't a boolean, bit array, or integer field class.
+ */
+static
+GArray *column_reader_resolve_member_indexes(
+		const struct column_reader_column *column,
+		const bt_event_class *ec)
+{
+	const bt_field_class *fc = column_reader_borrow_root_field_class(ec,
+		column->root_scope);
+	GArray *indexes = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	bt_field_class_type type;
+	guint i;
+
+	for (i = 0; fc && i < column->member_names->len; i++) {
+		const char *name = column->member_names->pdata[i];
+		uint64_t member_count;
+		uint64_t index;
+
+		if (bt_field_class_get_type(fc) != BT_FIELD_CLASS_TYPE_STRUCTURE) {
+			goto error;
+		}
+
+		member_count = bt_field_class_structure_get_member_count(fc);
+
+		for (index = 0; index < member_count; index++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, index);
+
+			if (strcmp(bt_field_class_structure_member_get_name(member),
+					name) == 0) {
+				fc = bt_field_class_structure_member_borrow_field_class_const(
+					member);
+				break;
+			}
+		}
+
+		if (index == member_count) {
+			goto error;
+		}
+
+		g_array_append_val(indexes, index);
+	}
+
+	if (!fc) {
+		goto error;
+	}
+
+	type = bt_field_class_get_type(fc);
+
+	if (type != BT_FIELD_CLASS_TYPE_BOOL &&
+			type != BT_FIELD_CLASS_TYPE_BIT_ARRAY &&
+			!bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_INTEGER)) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	g_array_free(indexes, TRUE);
+	indexes = NULL;
+
+end:
+	return indexes;
+}
+
+static
+struct column_reader_event_class *column_reader_resolve_event_class(
+		struct bt_bt2_column_reader *reader, const bt_event_class *ec)
+{
+	struct column_reader_event_class *ec_info;
+	const bt_stream_class *sc;
+	guint i;
+
+	ec_info = g_hash_table_lookup(reader->event_classes, ec);
+	if (ec_info) {
+		goto end;
+	}
+
+	ec_info = g_new0(struct column_reader_event_class, 1);
+	ec_info->member_indexes = g_ptr_array_new_with_free_func(
+		column_reader_free_indexes);
+	g_hash_table_insert(reader->event_classes, (gpointer) ec, ec_info);
+	bt_event_class_get_ref(ec);
+
+	if (reader->event_class_names) {
+		const char *name = bt_event_class_get_name(ec);
+
+		if (!name || !g_hash_table_contains(reader->event_class_names,
+				name)) {
+			goto end;
+		}
+	}
+
+	sc = bt_event_class_borrow_stream_class_const(ec);
+
+	for (i = 0; i < reader->columns->len; i++) {
+		const struct column_reader_column *column = &g_array_index(
+			reader->columns, struct column_reader_column, i);
+		GArray *indexes = NULL;
+
+		if (column->kind == COLUMN_READER_COLUMN_KIND_TIMESTAMP &&
+				!bt_stream_class_borrow_default_clock_class_const(sc)) {
+			goto end;
+		} else if (column->kind == COLUMN_READER_COLUMN_KIND_FIELD) {
+			indexes = column_reader_resolve_member_indexes(column,
+				ec);
+			if (!indexes) {
+				goto end;
+			}
+		}
+
+		g_ptr_array_add(ec_info->member_indexes, indexes);
+	}
+
+	ec_info->selected = true;
+
+end:
+	return ec_info;
+}
+
+/* Returns the value of the boolean, bit array, or integer `field` */
+static
+int64_t column_reader_leaf_value(const bt_field *field)
+{
+	bt_field_class_type type = bt_field_get_class_type(field);
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		return bt_field_bool_get_value(field);
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		return (int64_t) bt_field_bit_array_get_value_as_integer(field);
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		return (int64_t) bt_field_integer_unsigned_get_value(field);
+	} else {
+		return bt_field_integer_signed_get_value(field);
+	}
+}
+
+/*
+ * Writes the columns of the event message `msg` to the row `row` of
+ * the buffers `views`.
+ *
+ * Returns whether or not the message makes a row.
+ */
+static
+bool column_reader_write_row(struct bt_bt2_column_reader *reader,
+		const bt_message *msg, Py_buffer *views, Py_ssize_t row)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_event_class *ec = bt_event_borrow_class_const(event);
+	struct column_reader_event_class *ec_info;
+	guint i;
+
+	if (ec == reader->last_event_class) {
+		ec_info = reader->last_event_class_info;
+	} else {
+		ec_info = column_reader_resolve_event_class(reader, ec);
+		reader->last_event_class = ec;
+		reader->last_event_class_info = ec_info;
+	}
+
+	if (!ec_info->selected) {
+		return false;
+	}
+
+	for (i = 0; i < reader->columns->len; i++) {
+		const struct column_reader_column *column = &g_array_index(
+			reader->columns, struct column_reader_column, i);
+		int64_t *values = views[i].buf;
+
+		switch (column->kind) {
+		case COLUMN_READER_COLUMN_KIND_TIMESTAMP:
+			if (bt_clock_snapshot_get_ns_from_origin(
+					bt_message_event_borrow_default_clock_snapshot_const(msg),
+					&values[row]) !=
+					BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+				/* Not representable: skip the event */
+				return false;
+			}
+
+			break;
+		case COLUMN_READER_COLUMN_KIND_EVENT_CLASS_ID:
+			values[row] = (int64_t) bt_event_class_get_id(ec);
+			break;
+		case COLUMN_READER_COLUMN_KIND_STREAM_ID:
+			values[row] = (int64_t) bt_stream_get_id(
+				bt_event_borrow_stream_const(event));
+			break;
+		case COLUMN_READER_COLUMN_KIND_FIELD:
+		{
+			GArray *indexes = ec_info->member_indexes->pdata[i];
+			const bt_field *field =
+				compiled_field_path_borrow_root_field(msg,
+					column->root_scope);
+			guint j;
+
+			if (!field) {
+				/* No packet context: skip the event */
+				return false;
+			}
+
+			for (j = 0; j < indexes->len; j++) {
+				field = bt_field_structure_borrow_member_field_by_index_const(
+					field, g_array_index(indexes, uint64_t, j));
+			}
+
+			values[row] = column_reader_leaf_value(field);
+			break;
+		}
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Fills the buffers `py_buffers` (sequence of writable, contiguous
+ * buffers of 64-bit integers, one per column) from the row
+ * `row_offset`, pulling messages from `iter` until they're full or
+ * until `iter` returns anything but an OK status.
+ *
+ * Returns a `(status, row count)` tuple, where `row count` is the
+ * total number of rows in the buffers (including the first
+ * `row_offset` ones), or `NULL` with a Python exception set on error.
+ */
+static
+PyObject *bt_bt2_column_reader_fill(struct bt_bt2_column_reader *reader,
+		bt_message_iterator *iter, PyObject *py_buffers,
+		uint64_t row_offset)
+{
+	bt_message_iterator_next_status status =
+		BT_MESSAGE_ITERATOR_NEXT_STATUS_OK;
+	PyObject *py_buffers_fast = NULL;
+	PyObject *py_result = NULL;
+	Py_buffer *views = NULL;
+	Py_ssize_t view_count = 0;
+	Py_ssize_t capacity = PY_SSIZE_T_MAX;
+	Py_ssize_t row = row_offset;
+	Py_ssize_t i;
+
+	py_buffers_fast = PySequence_Fast(py_buffers,
+		"expecting a sequence of buffers");
+	if (!py_buffers_fast) {
+		goto end;
+	}
+
+	if (PySequence_Fast_GET_SIZE(py_buffers_fast) != reader->columns->len) {
+		PyErr_Format(PyExc_ValueError,
+			"expecting %u buffers, got %zd", reader->columns->len,
+			PySequence_Fast_GET_SIZE(py_buffers_fast));
+		goto end;
+	}
+
+	views = g_new0(Py_buffer, reader->columns->len);
+
+	for (i = 0; i < PySequence_Fast_GET_SIZE(py_buffers_fast); i++) {
+		if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(py_buffers_fast, i),
+				&views[i], PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS)) {
+			goto end;
+		}
+
+		view_count++;
+
+		if (views[i].itemsize != sizeof(int64_t)) {
+			PyErr_Format(PyExc_TypeError,
+				"buffer %zd: expecting 64-bit items, got %zd-byte items",
+				i, views[i].itemsize);
+			goto end;
+		}
+
+		capacity = MIN(capacity, views[i].len / views[i].itemsize);
+	}
+
+	while (row < capacity) {
+		const bt_message *msg;
+
+		if (reader->pending_msgs_pos == reader->pending_msgs->len) {
+			bt_message_array_const msgs;
+			uint64_t count;
+
+			g_ptr_array_set_size(reader->pending_msgs, 0);
+			reader->pending_msgs_pos = 0;
+			Py_BEGIN_ALLOW_THREADS
+			status = bt_message_iterator_next(iter, &msgs, &count);
+			Py_END_ALLOW_THREADS
+			if (status != BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
+				break;
+			}
+
+			g_ptr_array_set_size(reader->pending_msgs, count);
+			memcpy(reader->pending_msgs->pdata, msgs,
+				count * sizeof(*msgs));
+		}
+
+		msg = reader->pending_msgs->pdata[reader->pending_msgs_pos];
+		reader->pending_msgs_pos++;
+
+		if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_EVENT &&
+				column_reader_write_row(reader, msg, views, row)) {
+			row++;
+		}
+
+		bt_message_put_ref(msg);
+	}
+
+	py_result = Py_BuildValue("(iL)", (int) status, (long long) row);
+
+end:
+	for (i = 0; i < view_count; i++) {
+		PyBuffer_Release(&views[i]);
+	}
+
+	g_free(views);
+	Py_XDECREF(py_buffers_fast);
+	return py_result;
+}
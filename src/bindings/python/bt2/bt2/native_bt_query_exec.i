@@ -14,3 +14,5 @@
 bt_query_executor *bt_bt2_query_executor_create(
 		const bt_component_class *component_class, const char *object,
 		const bt_value *params, PyObject *py_obj);
+
+PyObject *bt_bt2_trace_infos_compute_intersections(const bt_value *trace_infos);
@@ -12,3 +12,151 @@ bt_query_executor *bt_bt2_query_executor_create(
 	return bt_query_executor_create_with_method_data(component_class,
 		object, params, py_obj == Py_None ? NULL : py_obj);
 }
+
+/*
+ * Borrows the integer entry `key` of the map value `map` as a signed
+ * integer into `*value`.
+ *
+ * Returns -1 with a Python exception set on error.
+ */
+static
+int trace_infos_get_int_entry(const bt_value *map, const char *key,
+		int64_t *value)
+{
+	const bt_value *entry = bt_value_map_borrow_entry_value_const(map, key);
+
+	if (!entry) {
+		PyErr_Format(PyExc_KeyError, "%s", key);
+		return -1;
+	}
+
+	if (bt_value_is_signed_integer(entry)) {
+		*value = bt_value_integer_signed_get(entry);
+	} else if (bt_value_is_unsigned_integer(entry)) {
+		*value = (int64_t) bt_value_integer_unsigned_get(entry);
+	} else {
+		PyErr_Format(PyExc_TypeError,
+			"`%s` entry is not an integer value", key);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Computes, for each trace of the `babeltrace.trace-infos` query
+ * result `trace_infos`, the intersection of the ranges of its streams.
+ *
+ * Returns a new list of `(begin, end, port names)` tuples (one per
+ * trace), where `port names` is a tuple of the port names of the
+ * trace's streams, or `NULL` with a Python exception set on error.
+ */
+static
+PyObject *bt_bt2_trace_infos_compute_intersections(const bt_value *trace_infos)
+{
+	PyObject *py_intersections = NULL;
+	uint64_t trace_count;
+	uint64_t i;
+
+	if (!bt_value_is_array(trace_infos)) {
+		PyErr_SetString(PyExc_TypeError,
+			"trace infos object is not an array value");
+		goto error;
+	}
+
+	trace_count = bt_value_array_get_length(trace_infos);
+	py_intersections = PyList_New(trace_count);
+	if (!py_intersections) {
+		goto error;
+	}
+
+	for (i = 0; i < trace_count; i++) {
+		const bt_value *trace_info =
+			bt_value_array_borrow_element_by_index_const(
+				trace_infos, i);
+		const bt_value *stream_infos;
+		PyObject *py_port_names;
+		PyObject *py_intersection;
+		int64_t begin = INT64_MIN;
+		int64_t end = INT64_MAX;
+		uint64_t stream_count;
+		uint64_t j;
+
+		stream_infos = bt_value_is_map(trace_info) ?
+			bt_value_map_borrow_entry_value_const(trace_info,
+				"stream-infos") : NULL;
+		if (!stream_infos || !bt_value_is_array(stream_infos)) {
+			PyErr_SetString(PyExc_TypeError,
+				"trace info object has no `stream-infos` array value");
+			goto error;
+		}
+
+		stream_count = bt_value_array_get_length(stream_infos);
+		py_port_names = PyTuple_New(stream_count);
+		if (!py_port_names) {
+			goto error;
+		}
+
+		for (j = 0; j < stream_count; j++) {
+			const bt_value *stream_info =
+				bt_value_array_borrow_element_by_index_const(
+					stream_infos, j);
+			const bt_value *range;
+			const bt_value *port_name;
+			int64_t stream_begin, stream_end;
+			PyObject *py_port_name;
+
+			range = bt_value_is_map(stream_info) ?
+				bt_value_map_borrow_entry_value_const(
+					stream_info, "range-ns") : NULL;
+			port_name = bt_value_is_map(stream_info) ?
+				bt_value_map_borrow_entry_value_const(
+					stream_info, "port-name") : NULL;
+			if (!range || !bt_value_is_map(range) || !port_name ||
+					!bt_value_is_string(port_name)) {
+				PyErr_SetString(PyExc_TypeError,
+					"stream info object has no `range-ns` map value or `port-name` string value");
+				Py_DECREF(py_port_names);
+				goto error;
+			}
+
+			if (trace_infos_get_int_entry(range, "begin",
+					&stream_begin) ||
+					trace_infos_get_int_entry(range, "end",
+						&stream_end)) {
+				Py_DECREF(py_port_names);
+				goto error;
+			}
+
+			begin = MAX(begin, stream_begin);
+			end = MIN(end, stream_end);
+			py_port_name = PyUnicode_FromString(
+				bt_value_string_get(port_name));
+			if (!py_port_name) {
+				Py_DECREF(py_port_names);
+				goto error;
+			}
+
+			/* Steals the reference */
+			PyTuple_SET_ITEM(py_port_names, j, py_port_name);
+		}
+
+		/* `N` steals the reference of `py_port_names` */
+		py_intersection = Py_BuildValue("(LLN)", (long long) begin,
+			(long long) end, py_port_names);
+		if (!py_intersection) {
+			goto error;
+		}
+
+		/* Steals the reference */
+		PyList_SET_ITEM(py_intersections, i, py_intersection);
+	}
+
+	goto end;
+
+error:
+	Py_CLEAR(py_intersections);
+
+end:
+	return py_intersections;
+}
@@ -9,6 +9,9 @@ trace_destroyed_listener(const bt_trace *trace, void *py_callable)
 {
 	PyObject *py_trace_ptr = NULL;
 	PyObject *py_res = NULL;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_trace_ptr = SWIG_NewPointerObj(SWIG_as_voidptr(trace),
 		SWIGTYPE_p_bt_trace, 0);
@@ -28,6 +31,7 @@ trace_destroyed_listener(const bt_trace *trace, void *py_callable)
 end:
 	Py_DECREF(py_trace_ptr);
 	Py_XDECREF(py_res);
+	PyGILState_Release(gil_state);
 }
 
 static
@@ -9,6 +9,9 @@ trace_class_destroyed_listener(const bt_trace_class *trace_class, void *py_calla
 {
 	PyObject *py_trace_class_ptr = NULL;
 	PyObject *py_res = NULL;
+	PyGILState_STATE gil_state;
+
+	gil_state = PyGILState_Ensure();
 
 	py_trace_class_ptr = SWIG_NewPointerObj(SWIG_as_voidptr(trace_class),
 		SWIGTYPE_p_bt_trace_class, 0);
@@ -28,6 +31,7 @@ trace_class_destroyed_listener(const bt_trace_class *trace_class, void *py_calla
 end:
 	Py_DECREF(py_trace_class_ptr);
 	Py_XDECREF(py_res);
+	PyGILState_Release(gil_state);
 }
 
 static
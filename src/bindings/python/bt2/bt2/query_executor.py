@@ -105,6 +105,15 @@ class QueryExecutor(object._SharedObject, _QueryExecutorCommon):
         is_interrupted = native_bt.query_executor_is_interrupted(self._ptr)
         return bool(is_interrupted)
 
+    def _uses_result_cache(self):
+        return bool(native_bt.query_executor_uses_result_cache(self._ptr))
+
+    def _set_uses_result_cache(self, uses_result_cache):
+        utils._check_bool(uses_result_cache)
+        native_bt.query_executor_set_uses_result_cache(self._ptr, uses_result_cache)
+
+    uses_result_cache = property(fget=_uses_result_cache, fset=_set_uses_result_cache)
+
     def query(self):
         status, result_ptr = native_bt.query_executor_query(self._ptr)
         utils._handle_func_status(status, 'cannot query component class')
@@ -124,5 +133,19 @@ class _PrivateQueryExecutor(_QueryExecutorCommon):
         self._check_validity()
         return native_bt.private_query_executor_as_query_executor_const(self._ptr)
 
+    def set_result_is_cacheable(self):
+        self._check_validity()
+        native_bt.private_query_executor_set_result_is_cacheable(self._ptr)
+
+    def add_result_dependency_path(self, path):
+        self._check_validity()
+        utils._check_str(path)
+        status = native_bt.private_query_executor_add_result_dependency_path(
+            self._ptr, path
+        )
+        utils._handle_func_status(
+            status, "cannot add query result's dependency path"
+        )
+
     def _invalidate(self):
         self._ptr = None
@@ -0,0 +1,300 @@
+# SPDX-License-Identifier: MIT
+#
+# Copyright (C) 2022 EfficiOS Inc.
+
+from bt2 import utils
+from bt2 import trace_collection_message_iterator as bt2_tcmi
+import bt2
+import array
+import multiprocessing
+import multiprocessing.connection
+import struct
+
+
+# Shard stream protocol (worker to parent, one `send_bytes()` call per
+# item):
+#
+# 1. Row count of the chunk as a signed 64-bit integer.
+#
+#    0 means the shard is done, and -1 means the worker failed: the
+#    next item is then the UTF-8 error message.
+#
+# 2. For a positive row count, one item per column: the raw 64-bit
+#    integers of the column's rows.
+#
+# This avoids pickling anything: a chunk costs one copy on each side.
+_ROW_COUNT_FMT = '=q'
+
+
+# Returns the concrete source component specifications of
+# `source_component_specs` (as accepted by
+# `TraceCollectionMessageIterator`) so that each worker doesn't need to
+# discover them again.
+def _resolve_source_component_specs(source_component_specs, plugin_set):
+    if type(source_component_specs) in (
+        bt2_tcmi.ComponentSpec,
+        bt2_tcmi.AutoSourceComponentSpec,
+        str,
+    ):
+        source_component_specs = [source_component_specs]
+
+    comp_specs = []
+    auto_comp_specs = []
+
+    for spec in source_component_specs:
+        if type(spec) is str:
+            spec = bt2_tcmi.AutoSourceComponentSpec(spec)
+
+        if type(spec) is bt2_tcmi.ComponentSpec:
+            comp_specs.append(spec)
+        elif type(spec) is bt2_tcmi.AutoSourceComponentSpec:
+            auto_comp_specs.append(spec)
+        else:
+            raise TypeError(
+                '"{}" object is not a ComponentSpec or AutoSourceComponentSpec'.format(
+                    type(spec)
+                )
+            )
+
+    return comp_specs + bt2_tcmi._auto_discover_source_component_specs(
+        auto_comp_specs, plugin_set
+    )
+
+
+# Returns the `(begin, end)` time range (nanoseconds from origin,
+# inclusive) which covers all the streams of the source components of
+# `comp_specs`, as per their `babeltrace.trace-infos` query, or `None`
+# if there's no known stream range.
+#
+# A component class which doesn't support the query, or a stream
+# without a time range, makes the whole range unknown.
+def _get_time_range(comp_specs):
+    begin = None
+    end = None
+
+    for comp_spec in comp_specs:
+        try:
+            trace_infos = bt2.QueryExecutor(
+                comp_spec.component_class, 'babeltrace.trace-infos', comp_spec.params
+            ).query()
+        except bt2.UnknownObject:
+            return
+
+        for trace_info in trace_infos:
+            for stream_info in trace_info['stream-infos']:
+                if 'range-ns' not in stream_info:
+                    # No clock: the trimmer can't handle this stream
+                    return
+
+                range_ns = stream_info['range-ns']
+                stream_begin = int(range_ns['begin'])
+                stream_end = int(range_ns['end'])
+
+                if begin is None or stream_begin < begin:
+                    begin = stream_begin
+
+                if end is None or stream_end > end:
+                    end = stream_end
+
+    if begin is None:
+        return
+
+    return begin, end
+
+
+# Splits the inclusive time range `[begin, end]` into at most
+# `shard_count` disjoint, contiguous, non-empty inclusive ranges.
+def _split_time_range(begin, end, shard_count):
+    width = end - begin + 1
+    shard_count = min(shard_count, width)
+    bounds = [begin + width * i // shard_count for i in range(shard_count + 1)]
+    return [(bounds[i], bounds[i + 1] - 1) for i in range(shard_count)]
+
+
+def _send_row_count(conn, row_count):
+    conn.send_bytes(struct.pack(_ROW_COUNT_FMT, row_count))
+
+
+# Body of a shard worker process.
+def _read_shard(
+    conn, comp_specs, time_range, columns, event_class_names, chunk_row_count
+):
+    try:
+        flt_comp_specs = []
+
+        if time_range is not None:
+            # Pass exact nanosecond bounds: the `begin` and `end`
+            # parameters of `TraceCollectionMessageIterator` are
+            # seconds and would make adjacent shards overlap or leave
+            # gaps between them.
+            flt_comp_specs.append(
+                bt2_tcmi.ComponentSpec.from_named_plugin_and_component_class(
+                    'utils',
+                    'trimmer',
+                    {
+                        'begin': bt2_tcmi._ns_to_trimmer_bound(time_range[0]),
+                        'end': bt2_tcmi._ns_to_trimmer_bound(time_range[1]),
+                    },
+                )
+            )
+
+        msg_iter = bt2.TraceCollectionMessageIterator(comp_specs, flt_comp_specs)
+        reader = msg_iter.column_reader(columns, event_class_names)
+        buffers = [
+            array.array('q', bytes(8 * chunk_row_count))
+            for _ in range(reader.column_count)
+        ]
+
+        while True:
+            row_count = reader.read(buffers)
+
+            if row_count == 0:
+                break
+
+            _send_row_count(conn, row_count)
+
+            for buf in buffers:
+                conn.send_bytes(buf, 0, row_count * 8)
+
+        _send_row_count(conn, 0)
+    except Exception as exc:
+        _send_row_count(conn, -1)
+        conn.send_bytes(str(exc).encode())
+    finally:
+        conn.close()
+
+
+# Reads the columns `columns` (see
+# `TraceCollectionMessageIterator.column_reader()`) of the events of
+# the source components `source_component_specs` using up to
+# `shard_count` processes.
+#
+# This function splits the time range of the streams (as reported by
+# the `babeltrace.trace-infos` query, for example the index of a CTF
+# trace) into disjoint ranges and forks one worker process per range.
+# Each worker builds its own trace collection message iterator with a
+# trimmer for its range and sends its rows back as raw 64-bit integers.
+#
+# As the ranges are disjoint and each shard is ordered, this function
+# returns rows in time order, like a single column reader would: it
+# returns one `array.array('q')` object per column.
+#
+# This function uses the `fork` start method: the source component
+# classes (including user ones) are available as is in the workers.
+def read_columns_sharded(
+    source_component_specs,
+    columns,
+    shard_count=None,
+    event_class_names=None,
+    plugin_set=None,
+    chunk_row_count=65536,
+):
+    if shard_count is None:
+        shard_count = multiprocessing.cpu_count()
+
+    utils._check_uint64(shard_count)
+    utils._check_uint64(chunk_row_count)
+
+    if shard_count == 0:
+        raise ValueError('expecting at least one shard')
+
+    if chunk_row_count == 0:
+        raise ValueError('expecting at least one row per chunk')
+
+    columns = list(columns)
+
+    if event_class_names is not None:
+        event_class_names = list(event_class_names)
+
+    comp_specs = _resolve_source_component_specs(source_component_specs, plugin_set)
+    time_range = _get_time_range(comp_specs)
+
+    if time_range is None:
+        # No way to shard by time: read everything in a single worker
+        time_ranges = [None]
+    else:
+        time_ranges = _split_time_range(time_range[0], time_range[1], shard_count)
+
+    ctx = multiprocessing.get_context('fork')
+    procs = []
+    conns = []
+
+    # Per shard: list of lists of column chunks
+    shard_chunks = [[] for _ in time_ranges]
+
+    try:
+        for shard_time_range in time_ranges:
+            parent_conn, child_conn = ctx.Pipe(duplex=False)
+            proc = ctx.Process(
+                target=_read_shard,
+                args=(
+                    child_conn,
+                    comp_specs,
+                    shard_time_range,
+                    columns,
+                    event_class_names,
+                    chunk_row_count,
+                ),
+            )
+            proc.start()
+            child_conn.close()
+            procs.append(proc)
+            conns.append(parent_conn)
+
+        # Drain all the workers concurrently so that none of them
+        # blocks on a full pipe while we wait for another one.
+        conn_to_index = {conn: index for index, conn in enumerate(conns)}
+        pending = list(conns)
+
+        while pending:
+            for conn in multiprocessing.connection.wait(pending):
+                index = conn_to_index[conn]
+
+                try:
+                    (row_count,) = struct.unpack(_ROW_COUNT_FMT, conn.recv_bytes())
+                except EOFError:
+                    raise RuntimeError(
+                        'shard worker {} exited unexpectedly'.format(index)
+                    )
+
+                if row_count == -1:
+                    raise RuntimeError(
+                        'shard worker {} failed: {}'.format(
+                            index, conn.recv_bytes().decode()
+                        )
+                    )
+
+                if row_count == 0:
+                    pending.remove(conn)
+                    continue
+
+                chunk = []
+
+                for _ in columns:
+                    column_chunk = array.array('q')
+                    column_chunk.frombytes(conn.recv_bytes())
+                    assert len(column_chunk) == row_count
+                    chunk.append(column_chunk)
+
+                shard_chunks[index].append(chunk)
+    except BaseException:
+        for proc in procs:
+            proc.terminate()
+
+        raise
+    finally:
+        for conn in conns:
+            conn.close()
+
+        for proc in procs:
+            proc.join()
+
+    # Concatenate the shards in time order
+    result = [array.array('q') for _ in columns]
+
+    for chunks in shard_chunks:
+        for chunk in chunks:
+            for column, column_chunk in zip(result, chunk):
+                column.extend(column_chunk)
+
+    return result
@@ -7,6 +7,7 @@ from bt2 import object as bt2_object
 from bt2 import packet as bt2_packet
 from bt2 import stream_class as bt2_stream_class
 from bt2 import value as bt2_value
+from bt2 import wrapper_cache as bt2_wrapper_cache
 import bt2
 
 
@@ -34,7 +35,12 @@ class _StreamConst(bt2_object._SharedObject):
     def cls(self):
         stream_class_ptr = self._borrow_class_ptr(self._ptr)
         assert stream_class_ptr is not None
-        return self._stream_class_pycls._create_from_ptr_and_get_ref(stream_class_ptr)
+        return bt2_wrapper_cache._get(
+            self._stream_class_pycls, stream_class_ptr, self._borrow_own_trace_ptr
+        )
+
+    def _borrow_own_trace_ptr(self):
+        return native_bt.stream_borrow_trace_const(self._ptr)
 
     @property
     def name(self):
@@ -82,8 +82,18 @@ class _StreamClassConst(object._SharedObject, collections.abc.Mapping):
         assert ptr is not None
         return bt2_value._create_from_ptr_and_get_ref(ptr)
 
+    # Set by _cache_frozen_properties()
+    _has_cached_name = False
+
+    def _cache_frozen_properties(self):
+        self._cached_name = native_bt.stream_class_get_name(self._ptr)
+        self._has_cached_name = True
+
     @property
     def name(self):
+        if self._has_cached_name:
+            return self._cached_name
+
         return native_bt.stream_class_get_name(self._ptr)
 
     @property
@@ -240,20 +240,223 @@ def _get_ns(obj):
     return int(s * 1e9)
 
 
+# Nanoseconds to a `utils.trimmer` bound string (exact, unlike passing
+# seconds as a real number).
+def _ns_to_trimmer_bound(ns):
+    s_part = ns // 1000000000
+    ns_part = ns % 1000000000
+    return '{}.{:09d}'.format(s_part, ns_part)
+
+
+# Single `utils.trimmer` component which trims all the streams of a
+# trace to their intersection, one port pair per stream.
+class _StreamIntersectionTrimmer:
+    def __init__(self, name, begin_ns, end_ns, port_count):
+        self.name = name
+        self.begin_ns = begin_ns
+        self.end_ns = end_ns
+        self.port_count = port_count
+        self.next_port_index = 0
+        self.comp = None
+
+
 class _TraceCollectionMessageIteratorProxySink(bt2_component._UserSinkComponent):
-    def __init__(self, config, params, msg_list):
+    def __init__(self, config, params, obj):
+        msg_list, column_reader_slot = obj
         assert type(msg_list) is list
+        assert type(column_reader_slot) is list
         self._msg_list = msg_list
+        self._column_reader_slot = column_reader_slot
         self._add_input_port('in')
 
     def _user_graph_is_configured(self):
         self._msg_iter = self._create_message_iterator(self._input_ports['in'])
 
     def _user_consume(self):
+        column_reader = self._column_reader_slot[0]
+
+        if column_reader is not None:
+            column_reader._fill(self._msg_iter)
+            return
+
         assert self._msg_list[0] is None
         self._msg_list[0] = next(self._msg_iter)
 
 
+# Column kinds of `_TraceCollectionColumnReader` (see
+# `native_bt_message_iterator.i.h`).
+_COLUMN_KIND_TIMESTAMP = 0
+_COLUMN_KIND_EVENT_CLASS_ID = 1
+_COLUMN_KIND_STREAM_ID = 2
+_COLUMN_KIND_FIELD = 3
+
+_COLUMN_NAME_TO_KIND = {
+    'timestamp': _COLUMN_KIND_TIMESTAMP,
+    'event_class_id': _COLUMN_KIND_EVENT_CLASS_ID,
+    'stream_id': _COLUMN_KIND_STREAM_ID,
+}
+
+
+# Reads the events of a trace collection message iterator as columns of
+# 64-bit integers into caller-provided buffers (for example, NumPy
+# arrays with the `int64` data type or `array.array('q')` objects).
+#
+# Each column is one of:
+#
+# `'timestamp'`:
+#     Value of the default clock snapshot, in nanoseconds from origin.
+#
+# `'event_class_id'`:
+#     Event class ID.
+#
+# `'stream_id'`:
+#     Stream ID.
+#
+# `(root_scope, member_name, ...)`:
+#     Value of the boolean, bit array, or integer field at the member
+#     names `member_name, ...` of the root scope `root_scope` (one of
+#     the `bt2.FieldPathScope` values).
+#
+# The reader only makes rows from the events of which the class is
+# selected (see `event_class_names`) and has all the requested fields
+# (and a default clock class if a timestamp column is requested).
+#
+# The reader pulls and decodes messages natively: there's no Python
+# work per event.
+class _TraceCollectionColumnReader:
+    def __init__(self, graph, slot, columns, event_class_names):
+        native_columns = []
+
+        for column in columns:
+            if type(column) is str:
+                if column not in _COLUMN_NAME_TO_KIND:
+                    raise ValueError("unknown column: '{}'".format(column))
+
+                native_columns.append((_COLUMN_NAME_TO_KIND[column], 0, ()))
+                continue
+
+            if type(column) is not tuple or len(column) < 2:
+                raise TypeError(
+                    "expecting a column name or a (root scope, member name, ...) tuple, got {}".format(
+                        repr(column)
+                    )
+                )
+
+            root_scope = column[0]
+            utils._check_int(root_scope)
+
+            if root_scope not in (
+                bt2.FieldPathScope.PACKET_CONTEXT,
+                bt2.FieldPathScope.EVENT_COMMON_CONTEXT,
+                bt2.FieldPathScope.EVENT_SPECIFIC_CONTEXT,
+                bt2.FieldPathScope.EVENT_PAYLOAD,
+            ):
+                raise ValueError('unknown root scope: {}'.format(root_scope))
+
+            for name in column[1:]:
+                utils._check_str(name)
+
+            native_columns.append((_COLUMN_KIND_FIELD, root_scope, column[1:]))
+
+        if len(native_columns) == 0:
+            raise ValueError('expecting at least one column')
+
+        if event_class_names is not None:
+            event_class_names = list(event_class_names)
+
+            for name in event_class_names:
+                utils._check_str(name)
+
+        self._ptr = native_bt.bt2_column_reader_create(
+            native_columns, event_class_names
+        )
+        self._graph = graph
+        self._slot = slot
+        self._column_count = len(native_columns)
+        self._buffers = None
+        self._row_count = 0
+        self._ended = False
+
+    def __del__(self):
+        ptr = getattr(self, '_ptr', None)
+
+        if ptr is not None:
+            native_bt.bt2_column_reader_destroy(ptr)
+            self._ptr = None
+
+    @property
+    def column_count(self):
+        return self._column_count
+
+    # Fills the buffers `buffers` (one per column, all with the same
+    # number of 64-bit items) with as many rows as possible.
+    #
+    # Returns the number of rows written, which is less than the buffer
+    # length only when there are no more events (returns 0 thereafter).
+    def read(self, buffers):
+        buffers = list(buffers)
+
+        if len(buffers) != self._column_count:
+            raise ValueError(
+                'expecting {} buffers, got {}'.format(self._column_count, len(buffers))
+            )
+
+        for buf in buffers:
+            view = memoryview(buf)
+
+            if view.readonly:
+                raise TypeError('buffer is read-only')
+
+            if not view.c_contiguous:
+                raise TypeError('buffer is not contiguous')
+
+            if view.itemsize != 8 or view.format.lstrip('@=<') not in (
+                'q',
+                'Q',
+                'l',
+                'L',
+            ):
+                raise TypeError(
+                    "expecting a buffer of 64-bit integers, got format '{}'".format(
+                        view.format
+                    )
+                )
+
+        if self._ended:
+            return 0
+
+        self._buffers = buffers
+        self._row_count = 0
+        self._slot[0] = self
+
+        try:
+            capacity = min(memoryview(buf).nbytes // 8 for buf in buffers)
+
+            while self._row_count < capacity:
+                try:
+                    self._graph.run_once()
+                except bt2.TryAgain:
+                    # Return what's available now
+                    break
+                except bt2.Stop:
+                    self._ended = True
+                    break
+        finally:
+            self._slot[0] = None
+            self._buffers = None
+
+        return self._row_count
+
+    # Called by the proxy sink's consuming method.
+    def _fill(self, msg_iter):
+        status, self._row_count = native_bt.bt2_column_reader_fill(
+            self._ptr, msg_iter._ptr, self._buffers, self._row_count
+        )
+        utils._handle_func_status(
+            status, 'unexpected error: cannot advance the message iterator'
+        )
+
+
 class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
     def __init__(
         self,
@@ -269,6 +472,9 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
         self._begin_ns = _get_ns(begin)
         self._end_ns = _get_ns(end)
         self._msg_list = [None]
+        self._column_reader_slot = [None]
+        self._column_reader = None
+        self._iterated = False
 
         # If a single item is provided, convert to a list.
         if type(source_component_specs) in (
@@ -321,9 +527,9 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
         self._build_graph()
 
     def _compute_stream_intersections(self):
-        # Pre-compute the trimmer range to use for each port in the graph, when
+        # Pre-compute the trimmer to use for each port in the graph, when
         # stream intersection mode is enabled.
-        self._stream_inter_port_to_range = {}
+        self._stream_inter_port_to_trimmer = {}
 
         for src_comp_and_spec in self._src_comps_and_specs:
             # Query the port's component for the `babeltrace.trace-infos`
@@ -334,28 +540,32 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
                 'babeltrace.trace-infos',
                 src_comp_and_spec.spec.params,
             )
+            query_exec.uses_result_cache = True
             trace_infos = query_exec.query()
 
-            for trace_info in trace_infos:
-                begin = max(
-                    [
-                        stream['range-ns']['begin']
-                        for stream in trace_info['stream-infos']
-                    ]
-                )
-                end = min(
-                    [stream['range-ns']['end'] for stream in trace_info['stream-infos']]
+            # Compute the intersection of each trace natively: walking
+            # the query result with value wrappers is slow with many
+            # traces and streams.
+            intersections = native_bt.bt2_trace_infos_compute_intersections(
+                trace_infos._ptr
+            )
+
+            for trace_idx, (begin, end, port_names) in enumerate(intersections):
+                # All the ports associated to this trace share a
+                # single trimmer with this computed range.
+                trimmer = _StreamIntersectionTrimmer(
+                    'trimmer-{}-{}'.format(src_comp_and_spec.comp.name, trace_idx),
+                    begin,
+                    end,
+                    len(port_names),
                 )
 
-                # Each port associated to this trace will have this computed
-                # range.
-                for stream in trace_info['stream-infos']:
+                for port_name in port_names:
                     # A port name is unique within a component, but not
                     # necessarily across all components.  Use a component
                     # and port name pair to make it unique across the graph.
-                    port_name = str(stream['port-name'])
                     key = (src_comp_and_spec.comp.addr, port_name)
-                    self._stream_inter_port_to_range[key] = (begin, end)
+                    self._stream_inter_port_to_trimmer[key] = trimmer
 
     def _validate_source_component_specs(self, comp_specs):
         for comp_spec in comp_specs:
@@ -376,7 +586,30 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
                     '"{}" object is not a ComponentSpec'.format(type(comp_spec))
                 )
 
+    # Returns a column reader of the events of this iterator (see
+    # `_TraceCollectionColumnReader`).
+    #
+    # Once you create a column reader, you may not iterate messages
+    # with next() anymore.
+    def column_reader(self, columns, event_class_names=None):
+        if self._column_reader is not None:
+            raise RuntimeError('this iterator already has a column reader')
+
+        if self._iterated:
+            raise RuntimeError(
+                'cannot create a column reader after iterating messages'
+            )
+
+        self._column_reader = _TraceCollectionColumnReader(
+            self._graph, self._column_reader_slot, columns, event_class_names
+        )
+        return self._column_reader
+
     def __next__(self):
+        if self._column_reader is not None:
+            raise RuntimeError('cannot iterate messages with a column reader')
+
+        self._iterated = True
         assert self._msg_list[0] is None
         self._graph.run_once()
         msg = self._msg_list[0]
@@ -384,11 +617,29 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
         self._msg_list[0] = None
         return msg
 
-    def _create_stream_intersection_trimmer(self, component, port):
+    # Returns the input and output ports of the next free port pair of
+    # the stream intersection trimmer of `port`, creating the trimmer
+    # if needed.
+    def _get_stream_intersection_trimmer_ports(self, component, port):
         key = (component.addr, port.name)
-        begin, end = self._stream_inter_port_to_range[key]
-        name = 'trimmer-{}-{}'.format(component.name, port.name)
-        return self._create_trimmer(begin, end, name)
+        trimmer = self._stream_inter_port_to_trimmer[key]
+
+        if trimmer.comp is None:
+            trimmer.comp = self._create_trimmer(
+                trimmer.begin_ns, trimmer.end_ns, trimmer.name, trimmer.port_count
+            )
+
+        assert trimmer.next_port_index < trimmer.port_count
+
+        if trimmer.port_count == 1:
+            in_name = 'in'
+            out_name = 'out'
+        else:
+            in_name = 'in{}'.format(trimmer.next_port_index)
+            out_name = 'out{}'.format(trimmer.next_port_index)
+
+        trimmer.next_port_index += 1
+        return trimmer.comp.input_ports[in_name], trimmer.comp.output_ports[out_name]
 
     def _create_muxer(self):
         plugin = bt2.find_plugin('utils')
@@ -404,7 +655,7 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
         comp_cls = plugin.filter_component_classes['muxer']
         return self._graph.add_component(comp_cls, 'muxer')
 
-    def _create_trimmer(self, begin_ns, end_ns, name):
+    def _create_trimmer(self, begin_ns, end_ns, name, port_count=1):
         plugin = bt2.find_plugin('utils')
 
         if plugin is None:
@@ -417,16 +668,14 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
 
         params = {}
 
-        def ns_to_string(ns):
-            s_part = ns // 1000000000
-            ns_part = ns % 1000000000
-            return '{}.{:09d}'.format(s_part, ns_part)
-
         if begin_ns is not None:
-            params['begin'] = ns_to_string(begin_ns)
+            params['begin'] = _ns_to_trimmer_bound(begin_ns)
 
         if end_ns is not None:
-            params['end'] = ns_to_string(end_ns)
+            params['end'] = _ns_to_trimmer_bound(end_ns)
+
+        if port_count != 1:
+            params['port-count'] = bt2.UnsignedIntegerValue(port_count)
 
         comp_cls = plugin.filter_component_classes['trimmer']
         return self._graph.add_component(comp_cls, name, params)
@@ -466,9 +715,10 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
         #
         #     port -> muxer
         if self._stream_intersection_mode:
-            trimmer_comp = self._create_stream_intersection_trimmer(component, port)
-            self._graph.connect_ports(port, trimmer_comp.input_ports['in'])
-            port_to_muxer = trimmer_comp.output_ports['out']
+            trimmer_in_port, port_to_muxer = self._get_stream_intersection_trimmer_ports(
+                component, port
+            )
+            self._graph.connect_ports(port, trimmer_in_port)
         else:
             port_to_muxer = port
 
@@ -572,9 +822,12 @@ class TraceCollectionMessageIterator(bt2_message_iterator._MessageIterator):
                 self._connect_src_comp_port(comp_and_spec.comp, out_port)
 
         # Add the proxy sink, passing our message list to share consumed
-        # messages with this trace collection message iterator.
+        # messages with this trace collection message iterator, and our
+        # column reader slot to let a column reader take over.
         sink = self._graph.add_component(
-            _TraceCollectionMessageIteratorProxySink, 'proxy-sink', obj=self._msg_list
+            _TraceCollectionMessageIteratorProxySink,
+            'proxy-sink',
+            obj=(self._msg_list, self._column_reader_slot),
         )
         sink_in_port = sink.input_ports['in']
 
@@ -0,0 +1,67 @@
+# SPDX-License-Identifier: MIT
+#
+# Copyright (C) 2022 EfficiOS Inc.
+
+from bt2 import native_bt
+
+
+# Cache of Python wrappers of trace IR class objects (event classes,
+# stream classes) reached from the objects of a trace (events, streams).
+#
+# Code which dispatches on `event.cls` for each event would otherwise
+# create (and get a reference on) a new wrapper each time.  A cached
+# wrapper is identity-stable: `event.cls is other_event.cls` when both
+# events have the same class.
+#
+# `_wrappers` maps `(Python class, native address)` to a wrapper which
+# owns a reference on its native object.  Since this reference keeps the
+# trace class alive, each wrapper is registered with a trace from which
+# it was reached: `_trace_keys` maps a native trace address to the keys
+# of the wrappers it registered, and the cache drops those wrappers when
+# the trace is destroyed.
+_wrappers = {}
+_trace_keys = {}
+
+
+def _trace_destroyed(trace_ptr):
+    for key in _trace_keys.pop(int(trace_ptr), ()):
+        del _wrappers[key]
+
+
+# Returns the cached wrapper of type `pycls` for the native object
+# `ptr`, creating it (and getting a reference) if needed.
+#
+# `borrow_trace_ptr` is a callable which returns the native trace from
+# which `ptr` was reached; it's only called on a cache miss.
+def _get(pycls, ptr, borrow_trace_ptr):
+    key = (pycls, int(ptr))
+    obj = _wrappers.get(key)
+
+    if obj is not None:
+        return obj
+
+    obj = pycls._create_from_ptr_and_get_ref(ptr)
+
+    # An object of a trace requires a frozen class: cache what can't
+    # change anymore.
+    obj._cache_frozen_properties()
+
+    trace_ptr = borrow_trace_ptr()
+    trace_addr = int(trace_ptr)
+    keys = _trace_keys.get(trace_addr)
+
+    if keys is None:
+        status, _ = native_bt.bt2_trace_add_destruction_listener(
+            trace_ptr, _trace_destroyed
+        )
+
+        if status != native_bt.__BT_FUNC_STATUS_OK:
+            # Just don't cache it
+            return obj
+
+        keys = []
+        _trace_keys[trace_addr] = keys
+
+    keys.append(key)
+    _wrappers[key] = obj
+    return obj
@@ -272,51 +272,44 @@ end:
 	return cfg_conn;
 }
 
-static struct bt_config_component *find_component_in_array(GPtrArray *comps,
-		const char *name)
+static void add_components_to_index(GHashTable *comps_by_name,
+		GPtrArray *comps)
 {
 	size_t i;
-	struct bt_config_component *found_comp = NULL;
 
 	for (i = 0; i < comps->len; i++) {
 		struct bt_config_component *comp = g_ptr_array_index(comps, i);
 
-		if (strcmp(name, comp->instance_name->str) == 0) {
-			found_comp = comp;
-			bt_object_get_ref(found_comp);
-			goto end;
-		}
+		g_hash_table_insert(comps_by_name, comp->instance_name->str,
+			comp);
 	}
-
-end:
-	return found_comp;
 }
 
-static struct bt_config_component *find_component(struct bt_config *cfg,
-		const char *name)
+/*
+ * Creates a hash table of component instance names (weak) to
+ * `struct bt_config_component *` (weak) for all the components of
+ * `cfg`.
+ *
+ * The instance names are unique at this point.
+ */
+static GHashTable *create_component_index(struct bt_config *cfg)
 {
-	struct bt_config_component *comp;
+	GHashTable *comps_by_name = g_hash_table_new(g_str_hash, g_str_equal);
 
-	comp = find_component_in_array(cfg->cmd_data.run.sources, name);
-	if (comp) {
+	if (!comps_by_name) {
 		goto end;
 	}
 
-	comp = find_component_in_array(cfg->cmd_data.run.filters, name);
-	if (comp) {
-		goto end;
-	}
-
-	comp = find_component_in_array(cfg->cmd_data.run.sinks, name);
-	if (comp) {
-		goto end;
-	}
+	add_components_to_index(comps_by_name, cfg->cmd_data.run.sources);
+	add_components_to_index(comps_by_name, cfg->cmd_data.run.filters);
+	add_components_to_index(comps_by_name, cfg->cmd_data.run.sinks);
 
 end:
-	return comp;
+	return comps_by_name;
 }
 
-static int validate_all_endpoints_exist(struct bt_config *cfg, char *error_buf,
+static int validate_all_endpoints_exist(struct bt_config *cfg,
+		GHashTable *comps_by_name, char *error_buf,
 		size_t error_buf_size)
 {
 	size_t i;
@@ -325,11 +318,9 @@ static int validate_all_endpoints_exist(struct bt_config *cfg, char *error_buf,
 	for (i = 0; i < cfg->cmd_data.run.connections->len; i++) {
 		struct bt_config_connection *connection =
 			g_ptr_array_index(cfg->cmd_data.run.connections, i);
-		struct bt_config_component *comp;
 
-		comp = find_component(cfg, connection->upstream_comp_name->str);
-		bt_object_put_ref(comp);
-		if (!comp) {
+		if (!g_hash_table_lookup(comps_by_name,
+				connection->upstream_comp_name->str)) {
 			snprintf(error_buf, error_buf_size,
 				"Invalid connection: cannot find upstream component `%s`:\n    %s\n",
 				connection->upstream_comp_name->str,
@@ -338,9 +329,8 @@ static int validate_all_endpoints_exist(struct bt_config *cfg, char *error_buf,
 			goto end;
 		}
 
-		comp = find_component(cfg, connection->downstream_comp_name->str);
-		bt_object_put_ref(comp);
-		if (!comp) {
+		if (!g_hash_table_lookup(comps_by_name,
+				connection->downstream_comp_name->str)) {
 			snprintf(error_buf, error_buf_size,
 				"Invalid connection: cannot find downstream component `%s`:\n    %s\n",
 				connection->downstream_comp_name->str,
@@ -355,21 +345,22 @@ end:
 }
 
 static int validate_connection_directions(struct bt_config *cfg,
-		char *error_buf, size_t error_buf_size)
+		GHashTable *comps_by_name, char *error_buf,
+		size_t error_buf_size)
 {
 	size_t i;
 	int ret = 0;
-	struct bt_config_component *src_comp = NULL;
-	struct bt_config_component *dst_comp = NULL;
 
 	for (i = 0; i < cfg->cmd_data.run.connections->len; i++) {
 		struct bt_config_connection *connection =
 			g_ptr_array_index(cfg->cmd_data.run.connections, i);
+		struct bt_config_component *src_comp;
+		struct bt_config_component *dst_comp;
 
-		src_comp = find_component(cfg,
+		src_comp = g_hash_table_lookup(comps_by_name,
 			connection->upstream_comp_name->str);
 		BT_ASSERT(src_comp);
-		dst_comp = find_component(cfg,
+		dst_comp = g_hash_table_lookup(comps_by_name,
 			connection->downstream_comp_name->str);
 		BT_ASSERT(dst_comp);
 
@@ -402,58 +393,76 @@ static int validate_connection_directions(struct bt_config *cfg,
 			ret = -1;
 			goto end;
 		}
-
-		BT_OBJECT_PUT_REF_AND_RESET(src_comp);
-		BT_OBJECT_PUT_REF_AND_RESET(dst_comp);
 	}
 
 end:
-	bt_object_put_ref(src_comp);
-	bt_object_put_ref(dst_comp);
 	return ret;
 }
 
-static int validate_no_cycles_rec(struct bt_config *cfg, GPtrArray *path,
+enum component_visit_state {
+	COMPONENT_VISIT_STATE_NOT_VISITED = 0,
+
+	/* Component is part of the current path */
+	COMPONENT_VISIT_STATE_IN_PATH,
+
+	/* No cycle is reachable from this component */
+	COMPONENT_VISIT_STATE_DONE,
+};
+
+/*
+ * Depth-first search of a cycle from the component named `comp_name`.
+ *
+ * `conns_by_upstream_name` maps component instance names to arrays of
+ * the connections of which they are the upstream component.
+ * `visit_states` maps component instance names to
+ * `enum component_visit_state` values.
+ */
+static int validate_no_cycles_rec(GHashTable *conns_by_upstream_name,
+		GHashTable *visit_states, const char *comp_name,
 		char *error_buf, size_t error_buf_size)
 {
 	int ret = 0;
 	size_t conn_i;
-	const char *src_comp_name;
+	GPtrArray *conns;
 
-	BT_ASSERT(path && path->len > 0);
-	src_comp_name = g_ptr_array_index(path, path->len - 1);
+	g_hash_table_insert(visit_states, (gpointer) comp_name,
+		GINT_TO_POINTER(COMPONENT_VISIT_STATE_IN_PATH));
+	conns = g_hash_table_lookup(conns_by_upstream_name, comp_name);
+	if (!conns) {
+		goto done;
+	}
 
-	for (conn_i = 0; conn_i < cfg->cmd_data.run.connections->len; conn_i++) {
+	for (conn_i = 0; conn_i < conns->len; conn_i++) {
 		struct bt_config_connection *conn =
-			g_ptr_array_index(cfg->cmd_data.run.connections, conn_i);
-
-		if (strcmp(conn->upstream_comp_name->str, src_comp_name) == 0) {
-			size_t path_i;
-
-			for (path_i = 0; path_i < path->len; path_i++) {
-				const char *comp_name =
-					g_ptr_array_index(path, path_i);
-
-				if (strcmp(comp_name, conn->downstream_comp_name->str) == 0) {
-					snprintf(error_buf, error_buf_size,
-						"Invalid connection: connection forms a cycle:\n    %s\n",
-						conn->arg->str);
-					ret = -1;
-					goto end;
-				}
-			}
-
-			g_ptr_array_add(path, conn->downstream_comp_name->str);
-			ret = validate_no_cycles_rec(cfg, path, error_buf,
-					error_buf_size);
-			if (ret) {
-				goto end;
-			}
+			g_ptr_array_index(conns, conn_i);
+		const char *downstream_comp_name =
+			conn->downstream_comp_name->str;
+		enum component_visit_state state = GPOINTER_TO_INT(
+			g_hash_table_lookup(visit_states,
+				downstream_comp_name));
+
+		if (state == COMPONENT_VISIT_STATE_IN_PATH) {
+			snprintf(error_buf, error_buf_size,
+				"Invalid connection: connection forms a cycle:\n    %s\n",
+				conn->arg->str);
+			ret = -1;
+			goto end;
+		} else if (state == COMPONENT_VISIT_STATE_DONE) {
+			continue;
+		}
 
-			g_ptr_array_remove_index(path, path->len - 1);
+		ret = validate_no_cycles_rec(conns_by_upstream_name,
+			visit_states, downstream_comp_name, error_buf,
+			error_buf_size);
+		if (ret) {
+			goto end;
 		}
 	}
 
+done:
+	g_hash_table_insert(visit_states, (gpointer) comp_name,
+		GINT_TO_POINTER(COMPONENT_VISIT_STATE_DONE));
+
 end:
 	return ret;
 }
@@ -463,22 +472,54 @@ static int validate_no_cycles(struct bt_config *cfg, char *error_buf,
 {
 	size_t i;
 	int ret = 0;
-	GPtrArray *path;
+	GHashTable *conns_by_upstream_name;
+	GHashTable *visit_states = NULL;
 
-	path = g_ptr_array_new();
-	if (!path) {
+	conns_by_upstream_name = g_hash_table_new_full(g_str_hash,
+		g_str_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+	if (!conns_by_upstream_name) {
 		ret = -1;
 		goto end;
 	}
 
-	g_ptr_array_add(path, NULL);
+	visit_states = g_hash_table_new(g_str_hash, g_str_equal);
+	if (!visit_states) {
+		ret = -1;
+		goto end;
+	}
 
 	for (i = 0; i < cfg->cmd_data.run.connections->len; i++) {
 		struct bt_config_connection *conn =
 			g_ptr_array_index(cfg->cmd_data.run.connections, i);
+		GPtrArray *conns = g_hash_table_lookup(conns_by_upstream_name,
+			conn->upstream_comp_name->str);
+
+		if (!conns) {
+			conns = g_ptr_array_new();
+			if (!conns) {
+				ret = -1;
+				goto end;
+			}
+
+			g_hash_table_insert(conns_by_upstream_name,
+				conn->upstream_comp_name->str, conns);
+		}
+
+		g_ptr_array_add(conns, conn);
+	}
 
-		g_ptr_array_index(path, 0) = conn->upstream_comp_name->str;
-		ret = validate_no_cycles_rec(cfg, path,
+	for (i = 0; i < cfg->cmd_data.run.connections->len; i++) {
+		struct bt_config_connection *conn =
+			g_ptr_array_index(cfg->cmd_data.run.connections, i);
+
+		if (g_hash_table_lookup(visit_states,
+				conn->upstream_comp_name->str)) {
+			/* Already visited */
+			continue;
+		}
+
+		ret = validate_no_cycles_rec(conns_by_upstream_name,
+			visit_states, conn->upstream_comp_name->str,
 			error_buf, error_buf_size);
 		if (ret) {
 			goto end;
@@ -486,8 +527,12 @@ static int validate_no_cycles(struct bt_config *cfg, char *error_buf,
 	}
 
 end:
-	if (path) {
-		g_ptr_array_free(path, TRUE);
+	if (visit_states) {
+		g_hash_table_destroy(visit_states);
+	}
+
+	if (conns_by_upstream_name) {
+		g_hash_table_destroy(conns_by_upstream_name);
 	}
 
 	return ret;
@@ -635,13 +680,22 @@ static int validate_connections(struct bt_config *cfg, char *error_buf,
 		size_t error_buf_size)
 {
 	int ret;
+	GHashTable *comps_by_name;
 
-	ret = validate_all_endpoints_exist(cfg, error_buf, error_buf_size);
+	comps_by_name = create_component_index(cfg);
+	if (!comps_by_name) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = validate_all_endpoints_exist(cfg, comps_by_name, error_buf,
+		error_buf_size);
 	if (ret) {
 		goto end;
 	}
 
-	ret = validate_connection_directions(cfg, error_buf, error_buf_size);
+	ret = validate_connection_directions(cfg, comps_by_name, error_buf,
+		error_buf_size);
 	if (ret) {
 		goto end;
 	}
@@ -662,6 +716,10 @@ static int validate_connections(struct bt_config *cfg, char *error_buf,
 	}
 
 end:
+	if (comps_by_name) {
+		g_hash_table_destroy(comps_by_name);
+	}
+
 	return ret;
 }
 
@@ -831,6 +831,7 @@ end:
 /* argpar options */
 enum {
 	OPT_NONE = 0,
+	OPT_ARGS_FILE,
 	OPT_BASE_PARAMS,
 	OPT_BEGIN,
 	OPT_CLOCK_CYCLES,
@@ -851,6 +852,7 @@ enum {
 	OPT_END,
 	OPT_FIELDS,
 	OPT_HELP,
+	OPT_HIERARCHICAL_MUXING,
 	OPT_INPUT_FORMAT,
 	OPT_LIST,
 	OPT_LOG_LEVEL,
@@ -862,6 +864,7 @@ enum {
 	OPT_OUTPUT_FORMAT,
 	OPT_PARAMS,
 	OPT_PLUGIN_PATH,
+	OPT_PROFILE,
 	OPT_RESET_BASE_PARAMS,
 	OPT_RETRY_DURATION,
 	OPT_RUN_ARGS,
@@ -1719,6 +1722,9 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "\n");
 	fprintf(fp, "Options:\n");
 	fprintf(fp, "\n");
+	fprintf(fp, "      --args-file=PATH              Replace this option with the null\n");
+	fprintf(fp, "                                    character-separated arguments of the\n");
+	fprintf(fp, "                                    file PATH (`-` for the standard input)\n");
 	fprintf(fp, "  -b, --base-params=PARAMS          Set PARAMS as the current base parameters\n");
 	fprintf(fp, "                                    for all the following components until\n");
 	fprintf(fp, "                                    --reset-base-params is encountered\n");
@@ -1735,10 +1741,13 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
+	fprintf(fp, "      --profile                     Print the time spent in each message iterator\n");
+	fprintf(fp, "                                    and sink component to the standard error\n");
+	fprintf(fp, "                                    when the graph stops running\n");
 	fprintf(fp, "  -r, --reset-base-params           Reset the current base parameters to an\n");
 	fprintf(fp, "                                    empty map\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
-	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
+	fprintf(fp, "                                    the graph later, retry in at most DUR µs\n");
 	fprintf(fp, "                                    (default: 100000)\n");
 	fprintf(fp, "  -h, --help                        Show this help and quit\n");
 	fprintf(fp, "\n");
@@ -1781,6 +1790,211 @@ void print_run_usage(FILE *fp)
 	print_expected_params_format(fp);
 }
 
+static
+struct bt_config *bt_config_run_from_args_array(const bt_value *run_args,
+		int *retcode, const bt_value *plugin_paths,
+		int default_log_level);
+
+/*
+ * Appends the arguments of the file `path` (the standard input if
+ * `path` is `-`) to the array value `args`.
+ *
+ * The arguments of the file are separated with a null character, the
+ * format of the output of the `convert` command's `--run-args-0`
+ * option.
+ */
+static
+int append_args_from_file(bt_value *args, const char *path)
+{
+	int ret = 0;
+	gchar *contents = NULL;
+	gsize length = 0;
+	const char *at;
+	const char *limit;
+
+	if (strcmp(path, "-") == 0) {
+		GString *gs = g_string_new(NULL);
+		char buf[4096];
+		size_t read_len;
+
+		if (!gs) {
+			BT_CLI_LOGE_APPEND_CAUSE_OOM();
+			goto error;
+		}
+
+		while ((read_len = fread(buf, 1, sizeof(buf), stdin)) > 0) {
+			g_string_append_len(gs, buf, read_len);
+		}
+
+		if (ferror(stdin)) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Cannot read arguments from the standard input.");
+			g_string_free(gs, TRUE);
+			goto error;
+		}
+
+		length = gs->len;
+		contents = g_string_free(gs, FALSE);
+	} else {
+		GError *error = NULL;
+
+		if (!g_file_get_contents(path, &contents, &length, &error)) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Cannot read arguments file: path=\"%s\", error=\"%s\"",
+				path, error->message);
+			g_error_free(error);
+			goto error;
+		}
+	}
+
+	if (length == 0) {
+		goto end;
+	}
+
+	/*
+	 * `contents` is null-terminated: a trailing null character
+	 * doesn't start another argument.
+	 */
+	limit = contents + length;
+
+	if (contents[length - 1] == '\0') {
+		limit--;
+	}
+
+	at = contents;
+
+	while (true) {
+		const char *next;
+
+		if (strcmp(at, "--args-file") == 0 ||
+				g_str_has_prefix(at, "--args-file=")) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Arguments file cannot contain an `--args-file` option: "
+				"path=\"%s\"", path);
+			goto error;
+		}
+
+		if (bt_value_array_append_string_element(args, at)) {
+			BT_CLI_LOGE_APPEND_CAUSE_OOM();
+			goto error;
+		}
+
+		next = memchr(at, '\0', limit - at);
+		if (!next) {
+			break;
+		}
+
+		at = next + 1;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_free(contents);
+	return ret;
+}
+
+/*
+ * Returns whether or not the parsed `run` command arguments contain an
+ * `--args-file` option.
+ */
+static
+bool args_file_option_is_specified(
+		const struct argpar_parse_ret *argpar_parse_ret)
+{
+	int i;
+	bool specified = false;
+
+	for (i = 0; i < argpar_parse_ret->items->n_items; i++) {
+		struct argpar_item *argpar_item =
+			argpar_parse_ret->items->items[i];
+
+		if (argpar_item->type == ARGPAR_ITEM_TYPE_OPT &&
+				((struct argpar_item_opt *) argpar_item)->descr->id ==
+					OPT_ARGS_FILE) {
+			specified = true;
+			break;
+		}
+	}
+
+	return specified;
+}
+
+/*
+ * Returns the arguments of the parsed `run` command arguments, each
+ * `--args-file` option being replaced with the arguments of its file.
+ */
+static
+bt_value *expand_run_args_files(
+		const struct argpar_parse_ret *argpar_parse_ret)
+{
+	bt_value *args = bt_value_array_create();
+	GString *arg_gs = NULL;
+	int i;
+
+	if (!args) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	arg_gs = g_string_new(NULL);
+	if (!arg_gs) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	for (i = 0; i < argpar_parse_ret->items->n_items; i++) {
+		struct argpar_item *argpar_item =
+			argpar_parse_ret->items->items[i];
+		struct argpar_item_opt *argpar_item_opt;
+
+		if (argpar_item->type == ARGPAR_ITEM_TYPE_NON_OPT) {
+			g_string_assign(arg_gs,
+				((struct argpar_item_non_opt *) argpar_item)->arg);
+		} else {
+			argpar_item_opt = (struct argpar_item_opt *) argpar_item;
+
+			if (argpar_item_opt->descr->id == OPT_ARGS_FILE) {
+				if (append_args_from_file(args,
+						argpar_item_opt->arg)) {
+					goto error;
+				}
+
+				continue;
+			}
+
+			BT_ASSERT(argpar_item_opt->descr->long_name);
+			g_string_printf(arg_gs, "--%s",
+				argpar_item_opt->descr->long_name);
+
+			if (argpar_item_opt->arg) {
+				g_string_append_c(arg_gs, '=');
+				g_string_append(arg_gs, argpar_item_opt->arg);
+			}
+		}
+
+		if (bt_value_array_append_string_element(args, arg_gs->str)) {
+			BT_CLI_LOGE_APPEND_CAUSE_OOM();
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_VALUE_PUT_REF_AND_RESET(args);
+
+end:
+	if (arg_gs) {
+		g_string_free(arg_gs, TRUE);
+	}
+
+	return args;
+}
+
 /*
  * Creates a Babeltrace config object from the arguments of a run
  * command.
@@ -1806,12 +2020,14 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 	int i;
 
 	static const struct argpar_opt_descr run_options[] = {
+		{ OPT_ARGS_FILE, '\0', "args-file", true },
 		{ OPT_BASE_PARAMS, 'b', "base-params", true },
 		{ OPT_COMPONENT, 'c', "component", true },
 		{ OPT_CONNECT, 'x', "connect", true },
 		{ OPT_HELP, 'h', "help", false },
 		{ OPT_LOG_LEVEL, 'l', "log-level", true },
 		{ OPT_PARAMS, 'p', "params", true },
+		{ OPT_PROFILE, '\0', "profile", false },
 		{ OPT_RESET_BASE_PARAMS, 'r', "reset-base-params", false },
 		{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
 		ARGPAR_OPT_DESCR_SENTINEL
@@ -1871,6 +2087,25 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 		goto end;
 	}
 
+	if (args_file_option_is_specified(&argpar_parse_ret)) {
+		bt_value *expanded_args =
+			expand_run_args_files(&argpar_parse_ret);
+
+		if (!expanded_args) {
+			goto error;
+		}
+
+		/*
+		 * Start over with the expanded arguments: they don't
+		 * contain any `--args-file` option.
+		 */
+		BT_OBJECT_PUT_REF_AND_RESET(cfg);
+		cfg = bt_config_run_from_args_array(expanded_args, retcode,
+			plugin_paths, default_log_level);
+		bt_value_put_ref(expanded_args);
+		goto end;
+	}
+
 	for (i = 0; i < argpar_parse_ret.items->n_items; i++) {
 		struct argpar_item *argpar_item =
 			argpar_parse_ret.items->items[i];
@@ -2029,6 +2264,9 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 				(uint64_t) retry_duration;
 			break;
 		}
+		case OPT_PROFILE:
+			cfg->cmd_data.run.profile = true;
+			break;
 		default:
 			BT_CLI_LOGE_APPEND_CAUSE("Unknown command-line option specified (option code %d).",
 				argpar_item_opt->descr->id);
@@ -2126,13 +2364,19 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "                                    in the plugin PLUGIN, add it to the\n");
 	fprintf(fp, "                                    conversion graph, and optionally name it\n");
 	fprintf(fp, "                                    NAME\n");
+	fprintf(fp, "      --hierarchical-muxing         Mux the messages of each source component\n");
+	fprintf(fp, "                                    separately before muxing the messages of\n");
+	fprintf(fp, "                                    all the source components\n");
 	fprintf(fp, "  -l, --log-level=LVL               Set the log level of the current component to LVL\n");
 	fprintf(fp, "                                    (`N`, `T`, `D`, `I`, `W`, `E`, or `F`)\n");
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
+	fprintf(fp, "      --profile                     Print the time spent in each message iterator\n");
+	fprintf(fp, "                                    and sink component to the standard error\n");
+	fprintf(fp, "                                    when the graph stops running\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
-	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
+	fprintf(fp, "                                    the graph later, retry in at most DUR µs\n");
 	fprintf(fp, "                                    (default: 100000)\n");
 	fprintf(fp, "                                    dynamic plugins can be loaded\n");
 	fprintf(fp, "      --run-args                    Print the equivalent arguments for the\n");
@@ -2253,6 +2497,7 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_END, 'e', "end", true },
 	{ OPT_FIELDS, 'f', "fields", true },
 	{ OPT_HELP, 'h', "help", false },
+	{ OPT_HIERARCHICAL_MUXING, '\0', "hierarchical-muxing", false },
 	{ OPT_INPUT_FORMAT, 'i', "input-format", true },
 	{ OPT_LOG_LEVEL, 'l', "log-level", true },
 	{ OPT_NAMES, 'n', "names", true },
@@ -2264,6 +2509,7 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_OUTPUT_FORMAT, 'o', "output-format", true },
 	{ OPT_PARAMS, 'p', "params", true },
 	{ OPT_PLUGIN_PATH, '\0', "plugin-path", true },
+	{ OPT_PROFILE, '\0', "profile", false },
 	{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
 	{ OPT_RUN_ARGS, '\0', "run-args", false },
 	{ OPT_RUN_ARGS_0, '\0', "run-args-0", false },
@@ -2273,11 +2519,21 @@ const struct argpar_opt_descr convert_options[] = {
 	ARGPAR_OPT_DESCR_SENTINEL
 };
 
+/*
+ * Returns a component name, made of `prefix` and an optional numeric
+ * suffix, which isn't a key of the map `existing_names`.
+ *
+ * When `prefix` itself exists, this function sets, as the value of its
+ * `existing_names` entry, the suffix which it used. The next call for
+ * the same prefix starts from it instead of probing all the previous
+ * suffixes again: as `existing_names` only grows, they're still taken.
+ */
 static
 GString *get_component_auto_name(const char *prefix,
-		const bt_value *existing_names)
+		bt_value *existing_names)
 {
 	unsigned int i = 0;
+	const bt_value *prefix_value;
 	GString *auto_name = g_string_new(NULL);
 
 	if (!auto_name) {
@@ -2285,16 +2541,29 @@ GString *get_component_auto_name(const char *prefix,
 		goto end;
 	}
 
-	if (!bt_value_map_has_entry(existing_names, prefix)) {
+	prefix_value = bt_value_map_borrow_entry_value_const(existing_names,
+		prefix);
+	if (!prefix_value) {
 		g_string_assign(auto_name, prefix);
 		goto end;
 	}
 
+	if (bt_value_is_unsigned_integer(prefix_value)) {
+		i = (unsigned int) bt_value_integer_unsigned_get(prefix_value);
+	}
+
 	do {
-		g_string_printf(auto_name, "%s-%d", prefix, i);
+		g_string_printf(auto_name, "%s-%u", prefix, i);
 		i++;
 	} while (bt_value_map_has_entry(existing_names, auto_name->str));
 
+	if (bt_value_map_insert_unsigned_integer_entry(existing_names, prefix,
+			i - 1)) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		g_string_free(auto_name, TRUE);
+		auto_name = NULL;
+	}
+
 end:
 	return auto_name;
 }
@@ -2342,7 +2611,8 @@ int assign_name_to_implicit_component(struct implicit_component_args *args,
 	}
 
 	if (append_to_comp_names) {
-		*comp_names = g_list_append(*comp_names, name);
+		/* The caller reverses `*comp_names` when it's complete */
+		*comp_names = g_list_prepend(*comp_names, name);
 		name = NULL;
 	}
 
@@ -2834,10 +3104,90 @@ end:
 /*
  * Appends the run command's --connect options for the convert command.
  */
+/*
+ * Appends the run arguments to create a `filter.utils.muxer` component
+ * dedicated to the source component named `source_name`, to connect
+ * the source component to it, and to connect it to the component named
+ * `downstream_name`.
+ *
+ * This function adds the name of the new muxer component to
+ * `existing_names`.
+ */
+static
+int append_source_muxer(bt_value *run_args, const char *source_name,
+		const char *downstream_name, bt_value *existing_names)
+{
+	int ret = 0;
+	GString *muxer_name;
+	GString *component_arg = NULL;
+
+	muxer_name = get_component_auto_name("source-muxer", existing_names);
+	if (!muxer_name) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_entry(existing_names, muxer_name->str,
+			bt_value_null)) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	component_arg = g_string_new(NULL);
+	if (!component_arg) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	g_string_printf(component_arg, "%s:filter.utils.muxer",
+		muxer_name->str);
+
+	if (bt_value_array_append_string_element(run_args, "--component")) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	if (bt_value_array_append_string_element(run_args,
+			component_arg->str)) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	ret = append_connect_arg(run_args, source_name, muxer_name->str);
+	if (ret) {
+		goto error;
+	}
+
+	ret = append_connect_arg(run_args, muxer_name->str, downstream_name);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (muxer_name) {
+		g_string_free(muxer_name, TRUE);
+	}
+
+	if (component_arg) {
+		g_string_free(component_arg, TRUE);
+	}
+
+	return ret;
+}
+
+/*
+ * If `source_muxer_existing_names` is not `NULL`, connects each source
+ * component to its own muxer (hierarchical muxing), adding the names of
+ * those muxers to `source_muxer_existing_names`.
+ */
 static
 int convert_auto_connect(bt_value *run_args,
 		GList *source_names, GList *filter_names,
-		GList *sink_names)
+		GList *sink_names, bt_value *source_muxer_existing_names)
 {
 	int ret = 0;
 	GList *source_at = source_names;
@@ -2849,13 +3199,28 @@ int convert_auto_connect(bt_value *run_args,
 	BT_ASSERT(filter_names);
 	BT_ASSERT(sink_names);
 
+	/*
+	 * With hierarchical muxing, mux each source component's streams
+	 * with its own muxer first: this is pointless with a single
+	 * source component as the first filter is a muxer.
+	 */
+	if (source_muxer_existing_names && !g_list_next(source_names)) {
+		source_muxer_existing_names = NULL;
+	}
+
 	/* Connect all sources to the first filter */
 	for (source_at = source_names; source_at; source_at = g_list_next(source_at)) {
 		GString *source_name = source_at->data;
 		GString *filter_name = filter_at->data;
 
-		ret = append_connect_arg(run_args, source_name->str,
-			filter_name->str);
+		if (source_muxer_existing_names) {
+			ret = append_source_muxer(run_args, source_name->str,
+				filter_name->str, source_muxer_existing_names);
+		} else {
+			ret = append_connect_arg(run_args, source_name->str,
+				filter_name->str);
+		}
+
 		if (ret) {
 			goto error;
 		}
@@ -3178,6 +3543,7 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 	bool trimmer_has_begin = false;
 	bool trimmer_has_end = false;
 	bool stream_intersection_mode = false;
+	bool hierarchical_muxing = false;
 	bool print_run_args = false;
 	bool print_run_args_0 = false;
 	bool print_ctf_metadata = false;
@@ -3427,16 +3793,20 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 				 * component. This is to create connection arguments.
 				 *
 				 * The list takes ownership of `name_gstr`.
+				 *
+				 * Prepend to keep this linear with many
+				 * components: we reverse the lists once all the
+				 * names are known.
 				 */
 				switch (type) {
 				case BT_COMPONENT_CLASS_TYPE_SOURCE:
-					source_names = g_list_append(source_names, name_gstr);
+					source_names = g_list_prepend(source_names, name_gstr);
 					break;
 				case BT_COMPONENT_CLASS_TYPE_FILTER:
-					filter_names = g_list_append(filter_names, name_gstr);
+					filter_names = g_list_prepend(filter_names, name_gstr);
 					break;
 				case BT_COMPONENT_CLASS_TYPE_SINK:
-					sink_names = g_list_append(sink_names, name_gstr);
+					sink_names = g_list_prepend(sink_names, name_gstr);
 					break;
 				default:
 					bt_common_abort();
@@ -3528,6 +3898,13 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 					goto error;
 				}
 
+				break;
+			case OPT_PROFILE:
+				if (bt_value_array_append_string_element(run_args,
+						"--profile")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
 				break;
 			case OPT_RETRY_DURATION:
 				if (bt_value_array_append_string_element(run_args,
@@ -3567,6 +3944,7 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 			case OPT_STREAM_INTERSECTION:
 			case OPT_TIMERANGE:
 			case OPT_VERBOSE:
+			case OPT_HIERARCHICAL_MUXING:
 				/* Ignore in this pass */
 				break;
 			default:
@@ -3886,6 +4264,9 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 			 */
 			stream_intersection_mode = true;
 			break;
+		case OPT_HIERARCHICAL_MUXING:
+			hierarchical_muxing = true;
+			break;
 		case OPT_VERBOSE:
 			*default_log_level =
 				logging_level_min(*default_log_level, BT_LOG_INFO);
@@ -4080,8 +4461,13 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 				plugin = borrow_loaded_plugin_by_name(auto_source_discovery_restrict_plugin_name);
 				plugins = &plugin;
 			} else {
-				plugin_count = get_loaded_plugins_count();
-				plugins = borrow_loaded_plugins();
+				/*
+				 * Only plugins with source component
+				 * classes can discover sources: don't
+				 * open the other ones.
+				 */
+				plugins = borrow_loaded_source_plugins(
+					&plugin_count);
 			}
 
 			status = auto_discover_source_components(non_opts, plugins, plugin_count,
@@ -4226,6 +4612,11 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 		goto error;
 	}
 
+	/* We prepended the names: restore their specification order */
+	source_names = g_list_reverse(source_names);
+	filter_names = g_list_reverse(filter_names);
+	sink_names = g_list_reverse(sink_names);
+
 	/* Make sure there's at least one source and one sink */
 	if (!source_names) {
 		BT_CLI_LOGE_APPEND_CAUSE("No source component.");
@@ -4328,7 +4719,7 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 
 	/* Auto-connect components */
 	ret = convert_auto_connect(run_args, source_names, filter_names,
-			sink_names);
+			sink_names, hierarchical_muxing ? all_names : NULL);
 	if (ret) {
 		BT_CLI_LOGE_APPEND_CAUSE("Cannot auto-connect components.");
 		goto error;
@@ -80,6 +80,12 @@ struct bt_config {
 			 * intersection of its streams.
 			 */
 			bool stream_intersection_mode;
+
+			/*
+			 * Whether or not to profile the graph and print
+			 * its profile.
+			 */
+			bool profile;
 		} run;
 
 		/* BT_CONFIG_COMMAND_HELP */
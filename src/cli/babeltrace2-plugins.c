@@ -12,38 +12,310 @@
 #include "babeltrace2-plugins.h"
 
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
 #include <babeltrace2/babeltrace.h>
+#include "common/common.h"
 
-/* Array of bt_plugin * */
+#define ENV_BABELTRACE_CLI_PLUGIN_REGISTRY_PATH \
+	"BABELTRACE_CLI_PLUGIN_REGISTRY_PATH"
+
+/* Registry file entry keys */
+#define REGISTRY_KEY_SIZE		"size"
+#define REGISTRY_KEY_MTIME		"mtime"
+#define REGISTRY_KEY_PLUGINS		"plugins"
+#define REGISTRY_KEY_SOURCE_PLUGINS	"source-plugins"
+
+/*
+ * A plugin which the CLI knows about.
+ *
+ * A slot of a dynamic plugin which the plugin registry describes
+ * doesn't have a plugin object until the CLI needs it: the shared
+ * object (or Python file) is only opened at this point.
+ */
+struct plugin_slot {
+	/* Plugin's name */
+	GString *name;
+
+	/* Path of the plugin's file, or `NULL` for a static plugin */
+	GString *path;
+
+	/* Plugin (owned), or `NULL` if not loaded (yet) */
+	const bt_plugin *plugin;
+
+	/* Whether or not the plugin has source component classes */
+	bool has_source_comp_classes;
+
+	/* Whether or not loading the plugin failed */
+	bool load_failed;
+};
+
+/* Array of `struct plugin_slot *`, in discovery order, unique names */
+static GPtrArray *plugin_slots;
+
+/* Array of bt_plugin * (borrowed from the slots) */
 static GPtrArray *loaded_plugins;
 
+/* Array of bt_plugin * (borrowed from the slots) */
+static GPtrArray *loaded_source_plugins;
+
+/*
+ * Plugin registry: cache of the plugins which each file of the plugin
+ * directories provides, keyed on the file's path, size, and
+ * modification time.
+ *
+ * Each group of the key file is the path of a regular file of a plugin
+ * directory, even one without any plugin, so that the CLI doesn't need
+ * to open it again as long as it doesn't change.
+ */
+static struct {
+	/* `NULL` if the registry is disabled */
+	GKeyFile *key_file;
+
+	/* Registry file path (owned) */
+	gchar *path;
+
+	/* Whether or not to save the registry on exit */
+	bool is_dirty;
+} registry;
+
+static
+void destroy_plugin_slot(struct plugin_slot *slot)
+{
+	if (!slot) {
+		goto end;
+	}
+
+	if (slot->name) {
+		g_string_free(slot->name, TRUE);
+	}
+
+	if (slot->path) {
+		g_string_free(slot->path, TRUE);
+	}
+
+	bt_plugin_put_ref(slot->plugin);
+	g_free(slot);
+
+end:
+	return;
+}
+
+static
+void init_registry(void)
+{
+	const char *env_path = getenv(ENV_BABELTRACE_CLI_PLUGIN_REGISTRY_PATH);
+	GError *error = NULL;
+
+	if (env_path) {
+		if (strlen(env_path) == 0) {
+			BT_LOGI_STR("Plugin registry is disabled.");
+			goto end;
+		}
+
+		registry.path = g_strdup(env_path);
+	} else {
+#ifdef BT_SET_DEFAULT_IN_TREE_CONFIGURATION
+		/* Don't mix in-tree plugins with the user's registry */
+		BT_LOGI_STR("Plugin registry is disabled for an in-tree build.");
+		goto end;
+#else
+		registry.path = g_build_filename(g_get_user_cache_dir(),
+			"babeltrace2", "cli-plugin-registry", NULL);
+#endif
+	}
+
+	registry.key_file = g_key_file_new();
+	if (!g_key_file_load_from_file(registry.key_file, registry.path,
+			G_KEY_FILE_NONE, &error)) {
+		if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			BT_LOGW("Cannot read plugin registry: "
+				"starting with an empty one: "
+				"path=\"%s\", error=\"%s\"", registry.path,
+				error->message);
+		}
+
+		g_error_free(error);
+
+		/* Start again with a clean key file */
+		g_key_file_free(registry.key_file);
+		registry.key_file = g_key_file_new();
+	}
+
+	BT_LOGI("Using plugin registry: path=\"%s\"", registry.path);
+
+end:
+	return;
+}
+
+static
+void save_registry(void)
+{
+	gchar *data = NULL;
+	gchar *dir = NULL;
+	gsize size;
+	GError *error = NULL;
+
+	if (!registry.key_file || !registry.is_dirty) {
+		goto end;
+	}
+
+	data = g_key_file_to_data(registry.key_file, &size, NULL);
+	dir = g_path_get_dirname(registry.path);
+
+	if (g_mkdir_with_parents(dir, 0700)) {
+		BT_LOGW_ERRNO("Cannot create plugin registry directory",
+			": path=\"%s\"", dir);
+		goto end;
+	}
+
+	/* g_file_set_contents() replaces the file atomically */
+	if (!g_file_set_contents(registry.path, data, size, &error)) {
+		BT_LOGW("Cannot write plugin registry: path=\"%s\", "
+			"error=\"%s\"", registry.path, error->message);
+		g_error_free(error);
+		goto end;
+	}
+
+	BT_LOGI("Saved plugin registry: path=\"%s\"", registry.path);
+
+end:
+	g_free(data);
+	g_free(dir);
+}
+
+static
+void fini_registry(void)
+{
+	save_registry();
+
+	if (registry.key_file) {
+		g_key_file_free(registry.key_file);
+		registry.key_file = NULL;
+	}
+
+	g_free(registry.path);
+	registry.path = NULL;
+}
+
 void init_loaded_plugins(void)
 {
-	loaded_plugins = g_ptr_array_new_with_free_func(
-		(GDestroyNotify) bt_plugin_put_ref);
+	plugin_slots = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_plugin_slot);
+	loaded_plugins = g_ptr_array_new();
+	loaded_source_plugins = g_ptr_array_new();
+	init_registry();
 }
 
 void fini_loaded_plugins(void)
 {
+	fini_registry();
+	g_ptr_array_free(loaded_source_plugins, TRUE);
 	g_ptr_array_free(loaded_plugins, TRUE);
+	g_ptr_array_free(plugin_slots, TRUE);
 }
 
-const bt_plugin *borrow_loaded_plugin_by_name(const char *name)
+static
+struct plugin_slot *borrow_plugin_slot_by_name(const char *name)
 {
-	int i;
-	const bt_plugin *plugin = NULL;
+	guint i;
 
-	BT_ASSERT(name);
-	BT_LOGI("Finding plugin: name=\"%s\"", name);
+	for (i = 0; i < plugin_slots->len; i++) {
+		struct plugin_slot *slot = g_ptr_array_index(plugin_slots, i);
+
+		if (strcmp(slot->name->str, name) == 0) {
+			return slot;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Makes sure that the plugin of `slot` is loaded, opening its file
+ * if needed.
+ *
+ * Opening a file fills all the slots of the plugins it provides.
+ */
+static
+void load_plugin_slot(struct plugin_slot *slot)
+{
+	const bt_plugin_set *plugin_set = NULL;
+	bt_plugin_find_all_from_file_status status;
+	uint64_t count;
+	uint64_t i;
+	guint j;
 
-	for (i = 0; i < loaded_plugins->len; i++) {
-		plugin = g_ptr_array_index(loaded_plugins, i);
+	if (slot->plugin || slot->load_failed) {
+		goto end;
+	}
+
+	BT_ASSERT(slot->path);
+	BT_LOGI("Loading plugin known from the plugin registry: "
+		"plugin-name=\"%s\", plugin-path=\"%s\"",
+		slot->name->str, slot->path->str);
+	status = bt_plugin_find_all_from_file(slot->path->str,
+		BT_TRUE, &plugin_set);
+	if (status == BT_PLUGIN_FIND_ALL_FROM_FILE_STATUS_OK) {
+		count = bt_plugin_set_get_plugin_count(plugin_set);
+
+		for (i = 0; i < count; i++) {
+			const bt_plugin *plugin =
+				bt_plugin_set_borrow_plugin_by_index_const(
+					plugin_set, i);
+
+			for (j = 0; j < plugin_slots->len; j++) {
+				struct plugin_slot *other_slot =
+					g_ptr_array_index(plugin_slots, j);
+
+				if (!other_slot->plugin && other_slot->path &&
+						strcmp(other_slot->path->str,
+							slot->path->str) == 0 &&
+						strcmp(other_slot->name->str,
+							bt_plugin_get_name(plugin)) == 0) {
+					other_slot->plugin = plugin;
+					bt_plugin_get_ref(plugin);
+				}
+			}
+		}
 
-		if (strcmp(name, bt_plugin_get_name(plugin)) == 0) {
-			break;
+		bt_plugin_set_put_ref(plugin_set);
+	}
+
+	if (!slot->plugin) {
+		BT_LOGW("Cannot load plugin known from the plugin registry: "
+			"plugin-name=\"%s\", plugin-path=\"%s\", status=%s",
+			slot->name->str, slot->path->str,
+			bt_common_func_status_string(status));
+		slot->load_failed = true;
+
+		/* Inspect this file again next time */
+		if (registry.key_file) {
+			g_key_file_remove_group(registry.key_file,
+				slot->path->str, NULL);
+			registry.is_dirty = true;
 		}
+	}
+
+end:
+	return;
+}
+
+const bt_plugin *borrow_loaded_plugin_by_name(const char *name)
+{
+	const bt_plugin *plugin = NULL;
+	struct plugin_slot *slot;
 
-		plugin = NULL;
+	BT_ASSERT(name);
+	BT_LOGI("Finding plugin: name=\"%s\"", name);
+	slot = borrow_plugin_slot_by_name(name);
+	if (slot) {
+		load_plugin_slot(slot);
+		plugin = slot->plugin;
 	}
 
 	if (plugin) {
@@ -56,22 +328,102 @@ const bt_plugin *borrow_loaded_plugin_by_name(const char *name)
 	return plugin;
 }
 
+/*
+ * Loads the plugins of all the slots (only the ones having source
+ * component classes if `sources_only` is true) and updates the
+ * `loaded_plugins` or `loaded_source_plugins` array.
+ */
+static
+void load_all_plugin_slots(bool sources_only)
+{
+	GPtrArray *plugins = sources_only ? loaded_source_plugins :
+		loaded_plugins;
+	guint i;
+
+	g_ptr_array_set_size(plugins, 0);
+
+	for (i = 0; i < plugin_slots->len; i++) {
+		struct plugin_slot *slot = g_ptr_array_index(plugin_slots, i);
+
+		if (sources_only && !slot->has_source_comp_classes) {
+			continue;
+		}
+
+		load_plugin_slot(slot);
+
+		if (slot->plugin) {
+			g_ptr_array_add(plugins, (void *) slot->plugin);
+		}
+	}
+}
+
 size_t get_loaded_plugins_count(void)
 {
+	load_all_plugin_slots(false);
 	return loaded_plugins->len;
 }
 
 const bt_plugin **borrow_loaded_plugins(void)
 {
+	load_all_plugin_slots(false);
 	return (const bt_plugin **) loaded_plugins->pdata;
 }
 
 const bt_plugin *borrow_loaded_plugin_by_index(size_t index)
 {
+	load_all_plugin_slots(false);
 	BT_ASSERT(index < loaded_plugins->len);
 	return g_ptr_array_index(loaded_plugins, index);
 }
 
+const bt_plugin **borrow_loaded_source_plugins(size_t *count)
+{
+	load_all_plugin_slots(true);
+	*count = loaded_source_plugins->len;
+	return (const bt_plugin **) loaded_source_plugins->pdata;
+}
+
+/*
+ * Adds a slot named `name` for the file `path` (`NULL` for a static
+ * plugin) with the plugin `plugin` (`NULL` if not loaded yet) unless
+ * another slot has the same name.
+ */
+static
+void add_plugin_slot(const char *name, const char *path,
+		const bt_plugin *plugin, bool has_source_comp_classes)
+{
+	struct plugin_slot *existing_slot = borrow_plugin_slot_by_name(name);
+	struct plugin_slot *slot;
+
+	if (existing_slot) {
+		BT_LOGI("Not using plugin: another one already exists with the same name: "
+			"plugin-name=\"%s\", plugin-path=\"%s\", "
+			"existing-plugin-path=\"%s\"",
+			name, path ? path : "(static)",
+			existing_slot->path ? existing_slot->path->str :
+				"(static)");
+		goto end;
+	}
+
+	BT_LOGD("Adding plugin to loaded plugins: plugin-name=\"%s\", "
+		"plugin-path=\"%s\", is-loaded=%d",
+		name, path ? path : "(static)", !!plugin);
+	slot = g_new0(struct plugin_slot, 1);
+	slot->name = g_string_new(name);
+
+	if (path) {
+		slot->path = g_string_new(path);
+	}
+
+	slot->plugin = plugin;
+	bt_plugin_get_ref(plugin);
+	slot->has_source_comp_classes = has_source_comp_classes;
+	g_ptr_array_add(plugin_slots, slot);
+
+end:
+	return;
+}
+
 static
 void add_to_loaded_plugins(const bt_plugin_set *plugin_set)
 {
@@ -84,26 +436,243 @@ void add_to_loaded_plugins(const bt_plugin_set *plugin_set)
 	for (i = 0; i < count; i++) {
 		const bt_plugin *plugin =
 			bt_plugin_set_borrow_plugin_by_index_const(plugin_set, i);
-		const bt_plugin *loaded_plugin =
-			borrow_loaded_plugin_by_name(bt_plugin_get_name(plugin));
 
 		BT_ASSERT(plugin);
+		add_plugin_slot(bt_plugin_get_name(plugin),
+			bt_plugin_get_path(plugin), plugin,
+			bt_plugin_get_source_component_class_count(plugin) > 0);
+	}
+}
+
+/*
+ * Adds the slots of the registry entry of `path` if it's up to date
+ * considering `st`.
+ *
+ * Returns whether or not the entry is up to date.
+ */
+static
+bool add_slots_from_registry(const char *path, const GStatBuf *st)
+{
+	bool is_fresh = false;
+	gchar **plugin_names = NULL;
+	gchar **source_plugin_names = NULL;
+	gchar **name;
+	GError *error = NULL;
+
+	if (!g_key_file_has_group(registry.key_file, path)) {
+		goto end;
+	}
 
-		if (loaded_plugin) {
-			BT_LOGI("Not using plugin: another one already exists with the same name: "
-				"plugin-name=\"%s\", plugin-path=\"%s\", "
-				"existing-plugin-path=\"%s\"",
-				bt_plugin_get_name(plugin),
-				bt_plugin_get_path(plugin),
-				bt_plugin_get_path(loaded_plugin));
-		} else {
-			/* Add to global array. */
-			BT_LOGD("Adding plugin to loaded plugins: plugin-path=\"%s\"",
-				bt_plugin_get_name(plugin));
-			bt_plugin_get_ref(plugin);
-			g_ptr_array_add(loaded_plugins, (void *) plugin);
+	if (g_key_file_get_uint64(registry.key_file, path,
+			REGISTRY_KEY_SIZE, &error) != (guint64) st->st_size ||
+			error) {
+		goto end;
+	}
+
+	if (g_key_file_get_int64(registry.key_file, path,
+			REGISTRY_KEY_MTIME, &error) != (gint64) st->st_mtime ||
+			error) {
+		goto end;
+	}
+
+	plugin_names = g_key_file_get_string_list(registry.key_file, path,
+		REGISTRY_KEY_PLUGINS, NULL, &error);
+	if (!plugin_names) {
+		goto end;
+	}
+
+	source_plugin_names = g_key_file_get_string_list(registry.key_file,
+		path, REGISTRY_KEY_SOURCE_PLUGINS, NULL, &error);
+	if (!source_plugin_names) {
+		goto end;
+	}
+
+	for (name = plugin_names; *name; name++) {
+		bool has_source_comp_classes = false;
+		gchar **source_name;
+
+		for (source_name = source_plugin_names; *source_name;
+				source_name++) {
+			if (strcmp(*source_name, *name) == 0) {
+				has_source_comp_classes = true;
+				break;
+			}
 		}
+
+		add_plugin_slot(*name, path, NULL, has_source_comp_classes);
+	}
+
+	is_fresh = true;
+
+end:
+	if (error) {
+		g_error_free(error);
 	}
+
+	g_strfreev(plugin_names);
+	g_strfreev(source_plugin_names);
+	return is_fresh;
+}
+
+/*
+ * Sets the registry entry of `path` from `st` and from the plugins of
+ * `plugin_set` (`NULL` if the file has no plugins).
+ */
+static
+void set_registry_entry(const char *path, const GStatBuf *st,
+		const bt_plugin_set *plugin_set)
+{
+	GPtrArray *plugin_names = g_ptr_array_new();
+	GPtrArray *source_plugin_names = g_ptr_array_new();
+	uint64_t count = 0;
+	uint64_t i;
+
+	if (plugin_set) {
+		count = bt_plugin_set_get_plugin_count(plugin_set);
+	}
+
+	for (i = 0; i < count; i++) {
+		const bt_plugin *plugin =
+			bt_plugin_set_borrow_plugin_by_index_const(
+				plugin_set, i);
+
+		g_ptr_array_add(plugin_names,
+			(gpointer) bt_plugin_get_name(plugin));
+
+		if (bt_plugin_get_source_component_class_count(plugin) > 0) {
+			g_ptr_array_add(source_plugin_names,
+				(gpointer) bt_plugin_get_name(plugin));
+		}
+	}
+
+	g_key_file_remove_group(registry.key_file, path, NULL);
+	g_key_file_set_uint64(registry.key_file, path, REGISTRY_KEY_SIZE,
+		(guint64) st->st_size);
+	g_key_file_set_int64(registry.key_file, path, REGISTRY_KEY_MTIME,
+		(gint64) st->st_mtime);
+	g_key_file_set_string_list(registry.key_file, path,
+		REGISTRY_KEY_PLUGINS,
+		(const gchar * const *) plugin_names->pdata, plugin_names->len);
+	g_key_file_set_string_list(registry.key_file, path,
+		REGISTRY_KEY_SOURCE_PLUGINS,
+		(const gchar * const *) source_plugin_names->pdata,
+		source_plugin_names->len);
+	registry.is_dirty = true;
+	g_ptr_array_free(plugin_names, TRUE);
+	g_ptr_array_free(source_plugin_names, TRUE);
+}
+
+/*
+ * Removes the registry entries of the files of the directory `dir_path`
+ * which aren't in `seen_paths`.
+ */
+static
+void remove_stale_registry_entries(const char *dir_path,
+		GHashTable *seen_paths)
+{
+	gchar **groups = g_key_file_get_groups(registry.key_file, NULL);
+	gchar *dir_file_path = g_build_filename(dir_path, "file", NULL);
+	gchar *dir_dirname = g_path_get_dirname(dir_file_path);
+	gchar **group;
+
+	for (group = groups; *group; group++) {
+		gchar *group_dirname = g_path_get_dirname(*group);
+
+		if (strcmp(group_dirname, dir_dirname) == 0 &&
+				!g_hash_table_lookup_extended(seen_paths,
+					*group, NULL, NULL)) {
+			BT_LOGD("Removing stale plugin registry entry: "
+				"path=\"%s\"", *group);
+			g_key_file_remove_group(registry.key_file, *group,
+				NULL);
+			registry.is_dirty = true;
+		}
+
+		g_free(group_dirname);
+	}
+
+	g_free(dir_dirname);
+	g_free(dir_file_path);
+	g_strfreev(groups);
+}
+
+/*
+ * Like bt_plugin_find_all_from_dir() (without recursion and failing on
+ * load error), but only opens the files which the registry doesn't
+ * describe (or describes with a different size or modification time).
+ */
+static
+int load_dynamic_plugins_from_dir_with_registry(const char *dir_path)
+{
+	int ret = 0;
+	GError *error = NULL;
+	GDir *dir;
+	GHashTable *seen_paths = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, NULL);
+	const gchar *name;
+
+	dir = g_dir_open(dir_path, 0, &error);
+	if (!dir) {
+		BT_CLI_LOGE_APPEND_CAUSE("Cannot open directory: "
+			"path=\"%s\", error=\"%s\"", dir_path, error->message);
+		g_error_free(error);
+		ret = -1;
+		goto end;
+	}
+
+	while ((name = g_dir_read_name(dir))) {
+		gchar *path;
+		GStatBuf st;
+		const bt_plugin_set *plugin_set = NULL;
+		bt_plugin_find_all_from_file_status status;
+
+		if (name[0] == '.') {
+			/* Skip hidden files, like the library does */
+			continue;
+		}
+
+		path = g_build_filename(dir_path, name, NULL);
+
+		/* Only regular files, like nftw(FTW_PHYS) in the library */
+		if (g_lstat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+			g_free(path);
+			continue;
+		}
+
+		/* `seen_paths` owns `path` */
+		g_hash_table_insert(seen_paths, path, path);
+
+		if (add_slots_from_registry(path, &st)) {
+			continue;
+		}
+
+		status = bt_plugin_find_all_from_file(path, BT_TRUE,
+			&plugin_set);
+		if (status < 0) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Unable to load dynamic plugins from file: "
+				"path=\"%s\"", path);
+			ret = status;
+			goto end;
+		}
+
+		set_registry_entry(path, &st, plugin_set);
+
+		if (status == BT_PLUGIN_FIND_ALL_FROM_FILE_STATUS_OK) {
+			add_to_loaded_plugins(plugin_set);
+			bt_plugin_set_put_ref(plugin_set);
+		}
+	}
+
+	remove_stale_registry_entries(dir_path, seen_paths);
+
+end:
+	if (dir) {
+		g_dir_close(dir);
+	}
+
+	g_hash_table_destroy(seen_paths);
+	return ret;
 }
 
 static
@@ -141,6 +710,19 @@ int load_dynamic_plugins(const bt_value *plugin_paths)
 			continue;
 		}
 
+		if (registry.key_file) {
+			ret = load_dynamic_plugins_from_dir_with_registry(
+				plugin_path);
+			if (ret) {
+				BT_CLI_LOGE_APPEND_CAUSE(
+					"Unable to load dynamic plugins from directory: "
+					"path=\"%s\"", plugin_path);
+				goto end;
+			}
+
+			continue;
+		}
+
 		status = bt_plugin_find_all_from_dir(plugin_path, BT_FALSE,
 			BT_TRUE, &plugin_set);
 		if (status < 0) {
@@ -214,7 +796,7 @@ int require_loaded_plugins(const bt_value *plugin_paths)
 		goto end;
 	}
 
-	BT_LOGI("Loaded all plugins: count=%u", loaded_plugins->len);
+	BT_LOGI("Found all plugins: count=%u", plugin_slots->len);
 
 end:
 	return ret;
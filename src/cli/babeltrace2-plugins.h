@@ -22,5 +22,12 @@ BT_HIDDEN const bt_plugin **borrow_loaded_plugins(void);
 BT_HIDDEN const bt_plugin *borrow_loaded_plugin_by_index(size_t index);
 BT_HIDDEN const bt_plugin *borrow_loaded_plugin_by_name(const char *name);
 
+/*
+ * Like borrow_loaded_plugins(), but only loads and returns the plugins
+ * which have source component classes, setting `*count` to their
+ * number.
+ */
+BT_HIDDEN const bt_plugin **borrow_loaded_source_plugins(size_t *count);
+
 
 #endif /* CLI_BABELTRACE_PLUGINS_H */
@@ -22,17 +22,13 @@ void set_fail_reason(const char **fail_reason, const char *reason)
 }
 
 BT_HIDDEN
-bt_query_executor_query_status cli_query(const bt_component_class *comp_cls,
-		const char *obj, const bt_value *params,
-		bt_logging_level log_level, const bt_interrupter *interrupter,
-		const bt_value **user_result, const char **fail_reason)
+bt_query_executor *cli_query_executor_create(
+		const bt_component_class *comp_cls, const char *obj,
+		const bt_value *params, bt_logging_level log_level,
+		const bt_interrupter *interrupter)
 {
-	const bt_value *result = NULL;
-	bt_query_executor_query_status status;
 	bt_query_executor *query_exec;
 
-	set_fail_reason(fail_reason, "unknown error");
-	BT_ASSERT(user_result);
 	query_exec = bt_query_executor_create(comp_cls, obj, params);
 	if (!query_exec) {
 		BT_CLI_LOGE_APPEND_CAUSE("Cannot create a query executor.");
@@ -58,6 +54,28 @@ bt_query_executor_query_status cli_query(const bt_component_class *comp_cls,
 		}
 	}
 
+	goto end;
+
+error:
+	BT_QUERY_EXECUTOR_PUT_REF_AND_RESET(query_exec);
+
+end:
+	return query_exec;
+}
+
+BT_HIDDEN
+bt_query_executor_query_status cli_query_executor_query(
+		bt_query_executor *query_exec,
+		const bt_component_class *comp_cls, const char *obj,
+		const bt_interrupter *interrupter,
+		const bt_value **user_result, const char **fail_reason)
+{
+	const bt_value *result = NULL;
+	bt_query_executor_query_status status;
+
+	set_fail_reason(fail_reason, "unknown error");
+	BT_ASSERT(user_result);
+
 	while (true) {
 		status = bt_query_executor_query(query_exec, &result);
 		switch (status) {
@@ -121,7 +139,32 @@ error:
 	status = BT_QUERY_EXECUTOR_QUERY_STATUS_ERROR;
 
 end:
-	bt_query_executor_put_ref(query_exec);
 	bt_value_put_ref(result);
 	return status;
 }
+
+BT_HIDDEN
+bt_query_executor_query_status cli_query(const bt_component_class *comp_cls,
+		const char *obj, const bt_value *params,
+		bt_logging_level log_level, const bt_interrupter *interrupter,
+		const bt_value **user_result, const char **fail_reason)
+{
+	bt_query_executor_query_status status;
+	bt_query_executor *query_exec;
+
+	set_fail_reason(fail_reason, "unknown error");
+	BT_ASSERT(user_result);
+	query_exec = cli_query_executor_create(comp_cls, obj, params,
+		log_level, interrupter);
+	if (!query_exec) {
+		status = BT_QUERY_EXECUTOR_QUERY_STATUS_ERROR;
+		goto end;
+	}
+
+	status = cli_query_executor_query(query_exec, comp_cls, obj,
+		interrupter, user_result, fail_reason);
+
+end:
+	bt_query_executor_put_ref(query_exec);
+	return status;
+}
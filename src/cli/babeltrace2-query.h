@@ -10,6 +10,34 @@
 #include <babeltrace2/babeltrace.h>
 #include "common/macros.h"
 
+/*
+ * Creates a query executor for the object `obj` of `comp_cls` with
+ * the parameters `params`, logging level `log_level`, and optional
+ * interrupter `interrupter`.
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+bt_query_executor *cli_query_executor_create(
+		const bt_component_class *comp_cls, const char *obj,
+		const bt_value *params, bt_logging_level log_level,
+		const bt_interrupter *interrupter);
+
+/*
+ * Performs the query of `query_exec` (created with
+ * cli_query_executor_create()), retrying while it returns
+ * `BT_QUERY_EXECUTOR_QUERY_STATUS_AGAIN`.
+ *
+ * This function only uses `query_exec`, and reads `comp_cls` and
+ * `interrupter`: a thread which doesn't own them may call it.
+ */
+BT_HIDDEN
+bt_query_executor_query_status cli_query_executor_query(
+		bt_query_executor *query_exec,
+		const bt_component_class *comp_cls, const char *obj,
+		const bt_interrupter *interrupter,
+		const bt_value **user_result, const char **fail_reason);
+
 BT_HIDDEN
 bt_query_executor_query_status cli_query(const bt_component_class *comp_cls,
 		const char *obj, const bt_value *params,
@@ -9,6 +9,7 @@
 
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "compat/glib.h"
 #include "string-format/format-error.h"
 #include "string-format/format-plugin-comp-cls-name.h"
 #include <unistd.h>
@@ -29,6 +30,15 @@
 #define ENV_BABELTRACE_WARN_COMMAND_NAME_DIRECTORY_CLASH "BABELTRACE_CLI_WARN_COMMAND_NAME_DIRECTORY_CLASH"
 #define NSEC_PER_SEC	1000000000LL
 
+/* Initial duration (µs) of the adaptive graph run retry delay */
+#define RUN_RETRY_INITIAL_DURATION_US	UINT64_C(1000)
+
+/*
+ * With `--profile`, time one graph sink consuming call out of this
+ * number.
+ */
+#define RUN_PROFILE_SAMPLING_PERIOD	UINT64_C(16)
+
 enum bt_cmd_status {
 	BT_CMD_STATUS_OK	    = 0,
 	BT_CMD_STATUS_ERROR	    = -1,
@@ -1133,6 +1143,30 @@ struct port_id {
 struct trace_range {
 	uint64_t intersection_range_begin_ns;
 	uint64_t intersection_range_end_ns;
+
+	/* Weak: trimmer of the trace of the stream */
+	struct stream_intersection_trimmer *trimmer;
+};
+
+/*
+ * Single `utils.trimmer` component which trims all the streams of a
+ * trace to its stream intersection, one port pair per stream.
+ */
+struct stream_intersection_trimmer {
+	/* Name of the component within the graph (owned by this) */
+	char *name;
+
+	uint64_t intersection_range_begin_ns;
+	uint64_t intersection_range_end_ns;
+
+	/* Number of port pairs of the component */
+	uint64_t port_count;
+
+	/* Index of the next port pair to connect */
+	uint64_t next_port_index;
+
+	/* Owned by this, `NULL` until the first stream gets connected */
+	const bt_component_filter *comp;
 };
 
 static
@@ -1172,6 +1206,22 @@ void trace_range_destroy(gpointer data)
 	free(data);
 }
 
+static
+void stream_intersection_trimmer_destroy(
+		struct stream_intersection_trimmer *trimmer)
+{
+	if (!trimmer) {
+		goto end;
+	}
+
+	free(trimmer->name);
+	BT_COMPONENT_FILTER_PUT_REF_AND_RESET(trimmer->comp);
+	g_free(trimmer);
+
+end:
+	return;
+}
+
 struct cmd_run_ctx {
 	/* Owned by this */
 	GHashTable *src_components;
@@ -1182,6 +1232,13 @@ struct cmd_run_ctx {
 	/* Owned by this */
 	GHashTable *sink_components;
 
+	/*
+	 * Hash table of upstream component name quarks to arrays of
+	 * `struct bt_config_connection *` (weak), in configuration
+	 * order.
+	 */
+	GHashTable *connections_by_upstream_comp;
+
 	/* Owned by this */
 	bt_graph *graph;
 
@@ -1192,10 +1249,47 @@ struct cmd_run_ctx {
 
 	bool stream_intersection_mode;
 
+	/* Whether or not the graph's profiling is enabled */
+	bool profiling;
+
 	/*
 	 * Association of struct port_id -> struct trace_range.
 	 */
 	GHashTable *intersections;
+
+	/*
+	 * Array of `struct stream_intersection_trimmer *` (owned by
+	 * this), one per trace.
+	 */
+	GPtrArray *intersection_trimmers;
+};
+
+/*
+ * `babeltrace.trace-infos` query job of a source component, used in
+ * stream intersection mode.
+ */
+struct trace_infos_query_job {
+	/* Weak */
+	struct bt_config_component *cfg_comp;
+
+	/* Owned by this */
+	const bt_component_class *comp_cls;
+
+	/* Owned by this */
+	bt_query_executor *query_exec;
+
+	bt_query_executor_query_status status;
+
+	/* Owned by this */
+	const bt_value *result;
+
+	const char *fail_reason;
+
+	/*
+	 * Error of the thread which ran the job on failure, owned by
+	 * this.
+	 */
+	const bt_error *error;
 };
 
 /* Returns a timestamp of the form "(-)s.ns" */
@@ -1269,7 +1363,7 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 	bt_value *trimmer_params = NULL;
 	char *intersection_begin = NULL;
 	char *intersection_end = NULL;
-	const bt_component_filter *trimmer = NULL;
+	struct stream_intersection_trimmer *trimmer = NULL;
 	const bt_component_class_filter *trimmer_class = NULL;
 	const bt_port_input *trimmer_input = NULL;
 	const bt_port_output *trimmer_output = NULL;
@@ -1292,17 +1386,28 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 		if (range) {
 			bt_value_map_insert_entry_status insert_status;
 
+			insert_trimmer = true;
+			trimmer = range->trimmer;
+			BT_ASSERT(trimmer);
+
+			if (trimmer->comp) {
+				/*
+				 * Another stream of the same trace
+				 * already created the trimmer.
+				 */
+				goto trimmer_params_done;
+			}
+
 			intersection_begin = s_from_ns(
-				range->intersection_range_begin_ns);
+				trimmer->intersection_range_begin_ns);
 			intersection_end = s_from_ns(
-				range->intersection_range_end_ns);
+				trimmer->intersection_range_end_ns);
 			if (!intersection_begin || !intersection_end) {
 				BT_CLI_LOGE_APPEND_CAUSE(
 					"Cannot create trimmer argument timestamp string.");
 				goto error;
 			}
 
-			insert_trimmer = true;
 			trimmer_params = bt_value_map_create();
 			if (!trimmer_params) {
 				goto error;
@@ -1319,8 +1424,16 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			if (insert_status < 0) {
 				goto error;
 			}
+
+			insert_status = bt_value_map_insert_unsigned_integer_entry(
+				trimmer_params, "port-count",
+				trimmer->port_count);
+			if (insert_status < 0) {
+				goto error;
+			}
 		}
 
+trimmer_params_done:
 		trimmer_class = find_filter_component_class("utils", "trimmer");
 		if (!trimmer_class) {
 			goto error;
@@ -1407,44 +1520,54 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			 * is connected. We will then establish the
 			 * connection between the original upstream
 			 * source and the trimmer.
+			 *
+			 * All the streams of a trace share the same
+			 * trimmer: each one uses the next port pair of
+			 * the trimmer, which the first one creates.
 			 */
-			char *trimmer_name = NULL;
-			bt_graph_add_component_status add_comp_status;
+			ctx->connect_ports = false;
 
-			ret = asprintf(&trimmer_name,
-				"stream-intersection-trimmer-%s",
-				upstream_port_name);
-			if (ret < 0) {
-				goto error;
+			if (!trimmer->comp) {
+				bt_graph_add_component_status add_comp_status;
+
+				add_comp_status = bt_graph_add_filter_component(
+					ctx->graph, trimmer_class,
+					trimmer->name, trimmer_params,
+					ctx->cfg->log_level, &trimmer->comp);
+				if (add_comp_status !=
+						BT_GRAPH_ADD_COMPONENT_STATUS_OK) {
+					goto error;
+				}
+
+				BT_ASSERT(trimmer->comp);
+				bt_component_filter_get_ref(trimmer->comp);
 			}
-			ret = 0;
 
-			ctx->connect_ports = false;
-			add_comp_status = bt_graph_add_filter_component(
-				ctx->graph, trimmer_class, trimmer_name,
-				trimmer_params, ctx->cfg->log_level,
-				&trimmer);
-			bt_component_filter_get_ref(trimmer);
-			free(trimmer_name);
-			if (add_comp_status !=
-					BT_GRAPH_ADD_COMPONENT_STATUS_OK) {
+			if (trimmer->next_port_index >= trimmer->port_count) {
+				BT_CLI_LOGE_APPEND_CAUSE(
+					"No more stream intersection trimmer ports: "
+					"trimmer-name=\"%s\", port-count=%" PRIu64 ", "
+					"upstream-port-name=\"%s\"",
+					trimmer->name, trimmer->port_count,
+					upstream_port_name);
 				goto error;
 			}
-			BT_ASSERT(trimmer);
 
 			trimmer_input =
 				bt_component_filter_borrow_input_port_by_index_const(
-					trimmer, 0);
+					trimmer->comp, trimmer->next_port_index);
 			if (!trimmer_input) {
 				goto error;
 			}
 			trimmer_output =
 				bt_component_filter_borrow_output_port_by_index_const(
-					trimmer, 0);
+					trimmer->comp, trimmer->next_port_index);
 			if (!trimmer_output) {
 				goto error;
 			}
 
+			trimmer->next_port_index++;
+
 			/*
 			 * Replace the current downstream port by the trimmer's
 			 * upstream port.
@@ -1500,7 +1623,8 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			 */
 			ret = cmd_run_ctx_connect_upstream_port_to_downstream_component(
 				ctx,
-				bt_component_filter_as_component_const(trimmer),
+				bt_component_filter_as_component_const(
+					trimmer->comp),
 				trimmer_output, cfg_conn);
 			if (ret) {
 				goto error;
@@ -1532,7 +1656,6 @@ end:
 	free(intersection_end);
 	BT_VALUE_PUT_REF_AND_RESET(trimmer_params);
 	BT_COMPONENT_CLASS_FILTER_PUT_REF_AND_RESET(trimmer_class);
-	BT_COMPONENT_FILTER_PUT_REF_AND_RESET(trimmer);
 	return ret;
 }
 
@@ -1544,6 +1667,7 @@ int cmd_run_ctx_connect_upstream_port(struct cmd_run_ctx *ctx,
 	const char *upstream_port_name;
 	const char *upstream_comp_name;
 	const bt_component *upstream_comp = NULL;
+	GPtrArray *connections;
 	size_t i;
 
 	BT_ASSERT(ctx);
@@ -1561,15 +1685,12 @@ int cmd_run_ctx_connect_upstream_port(struct cmd_run_ctx *ctx,
 		upstream_comp, upstream_comp_name,
 		upstream_port, upstream_port_name);
 
-	for (i = 0; i < ctx->cfg->cmd_data.run.connections->len; i++) {
-		struct bt_config_connection *cfg_conn =
-			g_ptr_array_index(
-				ctx->cfg->cmd_data.run.connections, i);
+	connections = g_hash_table_lookup(ctx->connections_by_upstream_comp,
+		GUINT_TO_POINTER(g_quark_from_string(upstream_comp_name)));
 
-		if (strcmp(cfg_conn->upstream_comp_name->str,
-				upstream_comp_name)) {
-			continue;
-		}
+	for (i = 0; connections && i < connections->len; i++) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(connections, i);
 
 		if (!bt_common_star_glob_match(
 			    cfg_conn->upstream_port_glob->str,
@@ -1677,11 +1798,21 @@ void cmd_run_ctx_destroy(struct cmd_run_ctx *ctx)
 		ctx->sink_components = NULL;
 	}
 
+	if (ctx->connections_by_upstream_comp) {
+		g_hash_table_destroy(ctx->connections_by_upstream_comp);
+		ctx->connections_by_upstream_comp = NULL;
+	}
+
 	if (ctx->intersections) {
 		g_hash_table_destroy(ctx->intersections);
 		ctx->intersections = NULL;
 	}
 
+	if (ctx->intersection_trimmers) {
+		g_ptr_array_free(ctx->intersection_trimmers, TRUE);
+		ctx->intersection_trimmers = NULL;
+	}
+
 	BT_GRAPH_PUT_REF_AND_RESET(ctx->graph);
 	ctx->cfg = NULL;
 }
@@ -1818,6 +1949,7 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 	bt_graph_add_listener_status add_listener_status;
 	bt_get_greatest_operative_mip_version_status mip_version_status;
 	uint64_t mip_version = UINT64_C(-1);
+	guint i;
 
 	ctx->cfg = cfg;
 	ctx->connect_ports = false;
@@ -1839,6 +1971,34 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 		goto error;
 	}
 
+	ctx->connections_by_upstream_comp = g_hash_table_new_full(
+		g_direct_hash, g_direct_equal, NULL,
+		(GDestroyNotify) g_ptr_array_unref);
+	if (!ctx->connections_by_upstream_comp) {
+		goto error;
+	}
+
+	for (i = 0; i < cfg->cmd_data.run.connections->len; i++) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(cfg->cmd_data.run.connections, i);
+		gpointer key = GUINT_TO_POINTER(g_quark_from_string(
+			cfg_conn->upstream_comp_name->str));
+		GPtrArray *connections = g_hash_table_lookup(
+			ctx->connections_by_upstream_comp, key);
+
+		if (!connections) {
+			connections = g_ptr_array_new();
+			if (!connections) {
+				goto error;
+			}
+
+			g_hash_table_insert(ctx->connections_by_upstream_comp,
+				key, connections);
+		}
+
+		g_ptr_array_add(connections, cfg_conn);
+	}
+
 	if (cfg->cmd_data.run.stream_intersection_mode) {
 		ctx->stream_intersection_mode = true;
 		ctx->intersections = g_hash_table_new_full(port_id_hash,
@@ -1846,6 +2006,12 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 		if (!ctx->intersections) {
 			goto error;
 		}
+
+		ctx->intersection_trimmers = g_ptr_array_new_with_free_func(
+			(GDestroyNotify) stream_intersection_trimmer_destroy);
+		if (!ctx->intersection_trimmers) {
+			goto error;
+		}
 	}
 
 	/*
@@ -1878,6 +2044,18 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 		goto error;
 	}
 
+	if (cfg->cmd_data.run.profile) {
+		if (bt_graph_enable_profiling(ctx->graph,
+				RUN_PROFILE_SAMPLING_PERIOD) !=
+				BT_GRAPH_ENABLE_PROFILING_STATUS_OK) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Cannot enable the graph's profiling.");
+			goto error;
+		}
+
+		ctx->profiling = true;
+	}
+
 	bt_graph_add_interrupter(ctx->graph, the_interrupter);
 	add_listener_status = bt_graph_add_source_component_output_port_added_listener(
 		ctx->graph, graph_source_output_port_added_listener, ctx,
@@ -2020,7 +2198,8 @@ end:
 static
 int set_stream_intersections(struct cmd_run_ctx *ctx,
 		struct bt_config_component *cfg_comp,
-		const bt_component_class_source *src_comp_cls)
+		const bt_component_class_source *src_comp_cls,
+		struct trace_infos_query_job *job)
 {
 	int ret = 0;
 	uint64_t trace_idx;
@@ -2031,13 +2210,22 @@ int set_stream_intersections(struct cmd_run_ctx *ctx,
 	const bt_value *stream_info = NULL;
 	struct port_id *port_id = NULL;
 	struct trace_range *stream_intersection = NULL;
+	struct stream_intersection_trimmer *trimmer = NULL;
 	const char *fail_reason = NULL;
 	const bt_component_class *comp_cls =
 		bt_component_class_source_as_component_class_const(src_comp_cls);
 
-	ret = query(ctx->cfg, comp_cls, "babeltrace.trace-infos",
-		cfg_comp->params, &query_result,
-		&fail_reason);
+	BT_ASSERT(job->cfg_comp == cfg_comp);
+
+	if (job->error) {
+		bt_current_thread_move_error(job->error);
+		job->error = NULL;
+	}
+
+	ret = job->status;
+	query_result = job->result;
+	job->result = NULL;
+	fail_reason = job->fail_reason;
 	if (ret) {
 		BT_CLI_LOGE_APPEND_CAUSE("Failed to execute `babeltrace.trace-infos` query: %s: "
 			"comp-class-name=\"%s\"", fail_reason,
@@ -2115,6 +2303,33 @@ int set_stream_intersections(struct cmd_run_ctx *ctx,
 			goto end;
 		}
 
+		trimmer = g_new0(struct stream_intersection_trimmer, 1);
+		if (!trimmer) {
+			ret = -1;
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Cannot allocate memory for stream_intersection_trimmer structure.");
+			goto end;
+		}
+
+		g_ptr_array_add(ctx->intersection_trimmers, trimmer);
+		ret = asprintf(&trimmer->name,
+			"stream-intersection-trimmer-%s-%" PRIu64,
+			cfg_comp->instance_name->str, trace_idx);
+		if (ret < 0) {
+			trimmer->name = NULL;
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Cannot allocate memory for trimmer name.");
+			goto end;
+		}
+
+		ret = 0;
+		trimmer->intersection_range_begin_ns =
+			trace_intersection.intersection_range_begin_ns;
+		trimmer->intersection_range_end_ns =
+			trace_intersection.intersection_range_end_ns;
+		trimmer->port_count = (uint64_t) stream_count;
+		trace_intersection.trimmer = trimmer;
+
 		for (stream_idx = 0; stream_idx < stream_count; stream_idx++) {
 			const bt_value *port_name;
 
@@ -2201,9 +2416,177 @@ end:
 	return ret;
 }
 
+static
+void trace_infos_query_job_destroy(struct trace_infos_query_job *job)
+{
+	if (!job) {
+		goto end;
+	}
+
+	bt_query_executor_put_ref(job->query_exec);
+	bt_component_class_put_ref(job->comp_cls);
+	bt_value_put_ref(job->result);
+
+	if (job->error) {
+		bt_error_release(job->error);
+	}
+
+	g_free(job);
+
+end:
+	return;
+}
+
+/*
+ * Runs the query of `job`, possibly within a thread of a thread pool.
+ *
+ * This only uses the query executor of `job`, which the thread running
+ * this function exclusively uses: the main thread created it, as well
+ * as the references to its component class and parameters.
+ */
+static
+void run_trace_infos_query_job(struct trace_infos_query_job *job)
+{
+	job->status = cli_query_executor_query(job->query_exec, job->comp_cls,
+		"babeltrace.trace-infos", the_interrupter, &job->result,
+		&job->fail_reason);
+	if (job->status < 0) {
+		/*
+		 * Keep the error of this thread (which possibly is not
+		 * the main thread) with the job.
+		 */
+		job->error = bt_current_thread_take_error();
+	}
+}
+
+/* GThreadPool function */
+static
+void run_trace_infos_query_job_pool_func(gpointer data, gpointer user_data)
+{
+	run_trace_infos_query_job(data);
+}
+
+/*
+ * Creates and runs, concurrently if possible, the
+ * `babeltrace.trace-infos` query jobs of the source components
+ * `cfg_components`, returning an array of
+ * `struct trace_infos_query_job *` having the same indexes.
+ *
+ * Each query executor is independent, so that there's no need to wait
+ * for the query of a source component to complete before starting the
+ * one of the next source component. Creating the query executors and
+ * releasing the jobs must happen within this thread, however, as
+ * the references to the component classes and parameters which the
+ * jobs share aren't thread-safe.
+ *
+ * A job's failure isn't an error for this function:
+ * set_stream_intersections() reports it when it gets to the source
+ * component of the job.
+ */
+static
+GPtrArray *run_trace_infos_query_jobs(struct cmd_run_ctx *ctx,
+		GPtrArray *cfg_components)
+{
+	GPtrArray *jobs;
+	GThreadPool *pool = NULL;
+	guint thread_count;
+	guint i;
+
+	jobs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) trace_infos_query_job_destroy);
+	if (!jobs) {
+		BT_CLI_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
+		goto end;
+	}
+
+	for (i = 0; i < cfg_components->len; i++) {
+		struct bt_config_component *cfg_comp =
+			g_ptr_array_index(cfg_components, i);
+		struct trace_infos_query_job *job =
+			g_new0(struct trace_infos_query_job, 1);
+
+		if (!job) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Failed to allocate a query job.");
+			goto error;
+		}
+
+		g_ptr_array_add(jobs, job);
+		job->cfg_comp = cfg_comp;
+		job->status = BT_QUERY_EXECUTOR_QUERY_STATUS_ERROR;
+		job->fail_reason = "unknown error";
+		BT_ASSERT(cfg_comp->type == BT_COMPONENT_CLASS_TYPE_SOURCE);
+		job->comp_cls = bt_component_class_source_as_component_class_const(
+			find_source_component_class(cfg_comp->plugin_name->str,
+				cfg_comp->comp_cls_name->str));
+		if (!job->comp_cls) {
+			/*
+			 * Creating the component fails before getting to
+			 * its query job.
+			 */
+			continue;
+		}
+
+		job->query_exec = cli_query_executor_create(job->comp_cls,
+			"babeltrace.trace-infos", cfg_comp->params,
+			ctx->cfg->log_level, the_interrupter);
+		if (!job->query_exec) {
+			job->error = bt_current_thread_take_error();
+			continue;
+		}
+
+		bt_query_executor_set_uses_result_cache(job->query_exec,
+			BT_TRUE);
+	}
+
+	thread_count = MIN(bt_g_get_num_processors(), jobs->len);
+	if (thread_count > 1) {
+		pool = g_thread_pool_new(run_trace_infos_query_job_pool_func,
+			NULL, (gint) thread_count, FALSE, NULL);
+		if (!pool) {
+			BT_LOGI("Cannot create thread pool: "
+				"running `babeltrace.trace-infos` queries sequentially: "
+				"job-count=%u, thread-count=%u",
+				jobs->len, thread_count);
+		}
+	}
+
+	for (i = 0; i < jobs->len; i++) {
+		struct trace_infos_query_job *job = g_ptr_array_index(jobs, i);
+
+		if (!job->query_exec) {
+			continue;
+		}
+
+		if (!pool || !g_thread_pool_push(pool, job, NULL)) {
+			run_trace_infos_query_job(job);
+		}
+	}
+
+	if (pool) {
+		/* Wait for all the jobs to complete */
+		g_thread_pool_free(pool, FALSE, TRUE);
+	}
+
+	goto end;
+
+error:
+	g_ptr_array_free(jobs, TRUE);
+	jobs = NULL;
+
+end:
+	return jobs;
+}
+
+/*
+ * `trace_infos_jobs`, if not `NULL`, is an array of
+ * `struct trace_infos_query_job *` created by
+ * run_trace_infos_query_jobs() for `cfg_components`.
+ */
 static
 int cmd_run_ctx_create_components_from_config_components(
-		struct cmd_run_ctx *ctx, GPtrArray *cfg_components)
+		struct cmd_run_ctx *ctx, GPtrArray *cfg_components,
+		GPtrArray *trace_infos_jobs)
 {
 	size_t i;
 	const void *comp_cls = NULL;
@@ -2286,7 +2669,9 @@ int cmd_run_ctx_create_components_from_config_components(
 
 		if (ctx->stream_intersection_mode &&
 				cfg_comp->type == BT_COMPONENT_CLASS_TYPE_SOURCE) {
-			ret = set_stream_intersections(ctx, cfg_comp, comp_cls);
+			BT_ASSERT(trace_infos_jobs);
+			ret = set_stream_intersections(ctx, cfg_comp, comp_cls,
+				g_ptr_array_index(trace_infos_jobs, i));
 			if (ret) {
 				BT_CLI_LOGE_APPEND_CAUSE(
 					"Cannot determine stream intersection of trace.");
@@ -2335,6 +2720,7 @@ static
 int cmd_run_ctx_create_components(struct cmd_run_ctx *ctx)
 {
 	int ret = 0;
+	GPtrArray *trace_infos_jobs = NULL;
 
 	/*
 	 * Make sure that, during this phase, our graph's "port added"
@@ -2344,28 +2730,41 @@ int cmd_run_ctx_create_components(struct cmd_run_ctx *ctx)
 	 */
 	ctx->connect_ports = false;
 
+	if (ctx->stream_intersection_mode) {
+		trace_infos_jobs = run_trace_infos_query_jobs(ctx,
+			ctx->cfg->cmd_data.run.sources);
+		if (!trace_infos_jobs) {
+			ret = -1;
+			goto end;
+		}
+	}
+
 	ret = cmd_run_ctx_create_components_from_config_components(
-		ctx, ctx->cfg->cmd_data.run.sources);
+		ctx, ctx->cfg->cmd_data.run.sources, trace_infos_jobs);
 	if (ret) {
 		ret = -1;
 		goto end;
 	}
 
 	ret = cmd_run_ctx_create_components_from_config_components(
-		ctx, ctx->cfg->cmd_data.run.filters);
+		ctx, ctx->cfg->cmd_data.run.filters, NULL);
 	if (ret) {
 		ret = -1;
 		goto end;
 	}
 
 	ret = cmd_run_ctx_create_components_from_config_components(
-		ctx, ctx->cfg->cmd_data.run.sinks);
+		ctx, ctx->cfg->cmd_data.run.sinks, NULL);
 	if (ret) {
 		ret = -1;
 		goto end;
 	}
 
 end:
+	if (trace_infos_jobs) {
+		g_ptr_array_free(trace_infos_jobs, TRUE);
+	}
+
 	return ret;
 }
 
@@ -2436,11 +2835,103 @@ end:
 	return ret;
 }
 
+static
+double ns_to_ms(uint64_t ns)
+{
+	return (double) ns / 1000000.;
+}
+
+static
+uint64_t profile_entry_uint(const bt_value *entry, const char *key)
+{
+	const bt_value *value = bt_value_map_borrow_entry_value_const(
+		entry, key);
+
+	return value ? bt_value_integer_unsigned_get(value) : 0;
+}
+
+/*
+ * Prints the profile of the graph of `ctx` to the standard error.
+ */
+static
+void print_graph_profile(struct cmd_run_ctx *ctx)
+{
+	const bt_value *profile = NULL;
+	GString *name = NULL;
+	uint64_t count;
+	uint64_t i;
+
+	if (bt_graph_get_profile(ctx->graph, &profile) !=
+			BT_GRAPH_GET_PROFILE_STATUS_OK) {
+		BT_LOGW_STR("Cannot get the graph's profile.");
+		goto end;
+	}
+
+	name = g_string_new(NULL);
+	if (!name) {
+		BT_LOGE_STR("Failed to allocate a GString.");
+		goto end;
+	}
+
+	fprintf(stderr, "\nGraph profile (times in ms, estimated from one "
+		"graph consuming call out of %" PRIu64 "):\n\n",
+		RUN_PROFILE_SAMPLING_PERIOD);
+	fprintf(stderr, "%-40s %12s %12s %12s %12s %12s %12s\n",
+		"Component/port", "Calls", "Messages", "Wall", "Self wall",
+		"CPU", "Self CPU");
+	count = bt_value_array_get_length(profile);
+
+	for (i = 0; i < count; i++) {
+		const bt_value *entry =
+			bt_value_array_borrow_element_by_index_const(
+				profile, i);
+		const bt_value *port_name =
+			bt_value_map_borrow_entry_value_const(entry,
+				"port-name");
+
+		g_string_assign(name, bt_value_string_get(
+			bt_value_map_borrow_entry_value_const(entry,
+				"component-name")));
+
+		if (port_name) {
+			g_string_append_printf(name, "/%s",
+				bt_value_string_get(port_name));
+			fprintf(stderr, "%-40s %12" PRIu64 " %12" PRIu64,
+				name->str,
+				profile_entry_uint(entry, "call-count"),
+				profile_entry_uint(entry, "message-count"));
+		} else {
+			fprintf(stderr, "%-40s %12" PRIu64 " %12s",
+				name->str,
+				profile_entry_uint(entry, "call-count"), "-");
+		}
+
+		fprintf(stderr, " %12.3f %12.3f %12.3f %12.3f\n",
+			ns_to_ms(profile_entry_uint(entry, "wall-time-ns")),
+			ns_to_ms(profile_entry_uint(entry,
+				"self-wall-time-ns")),
+			ns_to_ms(profile_entry_uint(entry, "cpu-time-ns")),
+			ns_to_ms(profile_entry_uint(entry,
+				"self-cpu-time-ns")));
+	}
+
+end:
+	if (name) {
+		g_string_free(name, TRUE);
+	}
+
+	bt_value_put_ref(profile);
+}
+
 static
 enum bt_cmd_status cmd_run(struct bt_config *cfg)
 {
 	enum bt_cmd_status cmd_status;
 	struct cmd_run_ctx ctx = { 0 };
+	const uint64_t max_retry_duration_us =
+		cfg->cmd_data.run.retry_duration_us;
+	uint64_t retry_duration_us = MIN(RUN_RETRY_INITIAL_DURATION_US,
+		max_retry_duration_us);
 
 	/* Initialize the command's context and the graph object */
 	if (cmd_run_ctx_init(&ctx, cfg)) {
@@ -2482,7 +2973,9 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 
 	/* Run the graph */
 	while (true) {
+		gint64 run_begin_us = g_get_monotonic_time();
 		bt_graph_run_status run_status = bt_graph_run(ctx.graph);
+		gint64 run_duration_us = g_get_monotonic_time() - run_begin_us;
 
 		/*
 		 * Reset console in case something messed with console
@@ -2507,12 +3000,34 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 				goto end;
 			}
 
-			if (cfg->cmd_data.run.retry_duration_us > 0) {
+			/*
+			 * Adapt the retry delay: a graph run which lasted
+			 * longer than the current delay had work to do
+			 * (for example, a live source received data), so
+			 * retry soon as more work is probably coming;
+			 * otherwise, back off exponentially, up to the
+			 * `--retry-duration` option's value.
+			 *
+			 * This keeps the latency low while data flows
+			 * without retrying the graph more often than the
+			 * time it spends running.
+			 */
+			if (run_duration_us >= 0 &&
+					(uint64_t) run_duration_us > retry_duration_us) {
+				retry_duration_us = MIN(
+					RUN_RETRY_INITIAL_DURATION_US,
+					max_retry_duration_us);
+			} else {
+				retry_duration_us = MIN(retry_duration_us * 2,
+					max_retry_duration_us);
+			}
+
+			if (retry_duration_us > 0) {
 				BT_LOGT("Got BT_GRAPH_RUN_STATUS_AGAIN: sleeping: "
 					"time-us=%" PRIu64,
-					cfg->cmd_data.run.retry_duration_us);
+					retry_duration_us);
 
-				if (usleep(cfg->cmd_data.run.retry_duration_us)) {
+				if (usleep(retry_duration_us)) {
 					if (bt_interrupter_is_set(the_interrupter)) {
 						cmd_status = BT_CMD_STATUS_INTERRUPTED;
 						goto end;
@@ -2535,6 +3050,10 @@ error:
 	cmd_status = BT_CMD_STATUS_ERROR;
 
 end:
+	if (ctx.profiling) {
+		print_graph_profile(&ctx);
+	}
+
 	cmd_run_ctx_destroy(&ctx);
 	return cmd_status;
 }
@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_COMMON_PROBES_H
+#define BABELTRACE_COMMON_PROBES_H
+
+/*
+ * USDT (SystemTap SDT) probes on the hot paths of the library and of
+ * the plugins.
+ *
+ * With `--enable-usdt-probes` at configuration time, each BT_PROBE*()
+ * statement becomes a no-op instruction and an ELF note which tools
+ * such as perf(1), bpftrace(8), SystemTap, and LTTng can attach to.
+ * Without it, BT_PROBE*() statements are not built at all.
+ *
+ * All the probes belong to the `babeltrace2` provider. List them with:
+ *
+ *     $ perf list 'sdt_babeltrace2:*'
+ *
+ * after adding them with `perf buildid-cache --add`.
+ *
+ * The arguments are always evaluated, even when no tool is attached:
+ * keep them to integers and pointers which are cheap to get.
+ */
+#ifdef BT_USDT_PROBES
+# include <sys/sdt.h>
+
+# define BT_PROBE0(_name) \
+	DTRACE_PROBE(babeltrace2, _name)
+# define BT_PROBE1(_name, _a1) \
+	DTRACE_PROBE1(babeltrace2, _name, _a1)
+# define BT_PROBE2(_name, _a1, _a2) \
+	DTRACE_PROBE2(babeltrace2, _name, _a1, _a2)
+# define BT_PROBE3(_name, _a1, _a2, _a3) \
+	DTRACE_PROBE3(babeltrace2, _name, _a1, _a2, _a3)
+# define BT_PROBE4(_name, _a1, _a2, _a3, _a4) \
+	DTRACE_PROBE4(babeltrace2, _name, _a1, _a2, _a3, _a4)
+#else
+# define BT_PROBE0(_name)				do {} while (0)
+# define BT_PROBE1(_name, _a1)				do {} while (0)
+# define BT_PROBE2(_name, _a1, _a2)			do {} while (0)
+# define BT_PROBE3(_name, _a1, _a2, _a3)		do {} while (0)
+# define BT_PROBE4(_name, _a1, _a2, _a3, _a4)		do {} while (0)
+#endif
+
+#endif /* BABELTRACE_COMMON_PROBES_H */
@@ -59,4 +59,27 @@ end:
 }
 #endif
 
+#if GLIB_CHECK_VERSION(2,36,0)
+
+static inline guint
+bt_g_get_num_processors(void)
+{
+	return g_get_num_processors();
+}
+
+#else
+
+/*
+ * GLib < 2.36.0 doesn't have g_get_num_processors() and needs
+ * g_thread_init() before using threads: report a single processor so
+ * that callers don't try to run things concurrently.
+ */
+static inline guint
+bt_g_get_num_processors(void)
+{
+	return 1;
+}
+
+#endif
+
 #endif /* _BABELTRACE_COMPAT_GLIB_H */
@@ -40,9 +40,28 @@ int bt_munmap(void *addr, size_t length);
  */
 size_t bt_mmap_get_offset_align_size(int log_level);
 
+/*
+ * Not supported on Windows: reading ahead is left to the system.
+ */
+static inline
+void bt_file_prefetch(int fd, off_t offset, off_t length)
+{
+}
+
+static inline
+void bt_mmap_advise_sequential(void *addr, size_t length)
+{
+}
+
+static inline
+void bt_mmap_advise_huge_pages(void *addr, size_t length)
+{
+}
+
 #else /* __MINGW32__ */
 
 #include <sys/mman.h>
+#include <fcntl.h>
 #include "common/common.h"
 
 static inline
@@ -67,6 +86,45 @@ size_t bt_mmap_get_offset_align_size(int log_level)
 {
 	return bt_common_get_page_size(log_level);
 }
+
+/*
+ * Advises the system that the region of `fd` of `length` bytes at
+ * `offset` is about to be read, so that it can start reading it in the
+ * background. This is only a hint.
+ */
+static inline
+void bt_file_prefetch(int fd, off_t offset, off_t length)
+{
+#ifdef POSIX_FADV_WILLNEED
+	(void) posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
+/*
+ * Advises the system that the mapping at `addr` of `length` bytes is
+ * going to be read sequentially, so that it reads ahead more
+ * aggressively and frees the pages behind sooner. This is only a hint.
+ */
+static inline
+void bt_mmap_advise_sequential(void *addr, size_t length)
+{
+#ifdef POSIX_MADV_SEQUENTIAL
+	(void) posix_madvise(addr, length, POSIX_MADV_SEQUENTIAL);
+#endif
+}
+
+/*
+ * Advises the system to back the mapping at `addr` of `length` bytes
+ * with huge pages, if it supports transparent huge pages for this kind
+ * of mapping, to reduce TLB misses. This is only a hint.
+ */
+static inline
+void bt_mmap_advise_huge_pages(void *addr, size_t length)
+{
+#ifdef MADV_HUGEPAGE
+	(void) madvise(addr, length, MADV_HUGEPAGE);
+#endif
+}
 #endif /* __MINGW32__ */
 
 #ifndef MAP_ANONYMOUS
@@ -19,6 +19,7 @@
 #include <babeltrace2-ctf-writer/utils.h>
 #include <babeltrace2/types.h>
 
+#include "common/align.h"
 #include "common/assert.h"
 #include "compat/compiler.h"
 #include "compat/endian.h"
@@ -170,6 +171,14 @@ end:
 static
 void bt_ctf_event_class_destroy(struct bt_ctf_object *obj)
 {
+	struct bt_ctf_event_class *event_class = (void *) obj;
+
+	if (event_class->packed_payload_layout.member_offsets) {
+		g_array_free(event_class->packed_payload_layout.member_offsets,
+			TRUE);
+	}
+
+	bt_ctf_object_pool_finalize(&event_class->event_pool);
 	bt_ctf_event_class_common_finalize(obj);
 	g_free(obj);
 }
@@ -200,6 +209,16 @@ struct bt_ctf_event_class *bt_ctf_event_class_create(const char *name)
 		goto error;
 	}
 
+	ret = bt_ctf_object_pool_initialize(&ctf_event_class->event_pool,
+		(bt_ctf_object_pool_new_object_func) bt_ctf_event_new,
+		(bt_ctf_object_pool_destroy_object_func)
+			bt_ctf_event_destroy_recycled,
+		ctf_event_class);
+	if (ret) {
+		BT_LOGE("Failed to initialize event pool: ret=%d", ret);
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -570,3 +589,279 @@ struct bt_ctf_field_type *bt_ctf_event_class_get_field_by_name(
 end:
 	return field_type;
 }
+
+/*
+ * Adds the size of a field of type `ft` at the offset `*offset_bits`,
+ * after having aligned it like bt_ctf_field_serialize_recursive()
+ * does, to `*offset_bits`.
+ *
+ * Returns a negative value if a field of type `ft` has no fixed,
+ * byte-granular size.
+ */
+static
+int add_packed_field_type_size(struct bt_ctf_field_type_common *ft,
+		uint64_t *offset_bits)
+{
+	int ret = 0;
+	unsigned int size;
+	uint64_t i;
+
+	switch (ft->id) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+	{
+		struct bt_ctf_field_type_common_integer *int_ft =
+			BT_CTF_FROM_COMMON(ft);
+
+		/*
+		 * An integer mapped to a clock class updates the
+		 * packet's clock value, which this layout doesn't track.
+		 */
+		if (int_ft->mapped_clock_class) {
+			ret = -1;
+			goto end;
+		}
+
+		size = int_ft->size;
+		goto add_size;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+	{
+		struct bt_ctf_field_type_common_enumeration *enum_ft =
+			BT_CTF_FROM_COMMON(ft);
+
+		ret = add_packed_field_type_size(
+			(void *) enum_ft->container_ft, offset_bits);
+		goto end;
+	}
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+	{
+		struct bt_ctf_field_type_common_floating_point *flt_ft =
+			BT_CTF_FROM_COMMON(ft);
+
+		size = flt_ft->exp_dig + flt_ft->mant_dig;
+		goto add_size;
+	}
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+	{
+		uint64_t count = (uint64_t)
+			bt_ctf_field_type_common_structure_get_field_count(ft);
+
+		*offset_bits = ALIGN(*offset_bits,
+			bt_ctf_field_type_common_get_alignment(ft));
+
+		for (i = 0; i < count; i++) {
+			struct bt_ctf_field_type_common *member_ft;
+
+			ret = bt_ctf_field_type_common_structure_borrow_field_by_index(
+				ft, NULL, &member_ft, i);
+			BT_ASSERT_DBG(ret == 0);
+			ret = add_packed_field_type_size(member_ft, offset_bits);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+	{
+		struct bt_ctf_field_type_common_array *array_ft =
+			BT_CTF_FROM_COMMON(ft);
+
+		for (i = 0; i < array_ft->length; i++) {
+			ret = add_packed_field_type_size(array_ft->element_ft,
+				offset_bits);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+	default:
+		/* Strings, sequences, and variants have a variable size */
+		ret = -1;
+		goto end;
+	}
+
+add_size:
+	if (size % CHAR_BIT != 0) {
+		ret = -1;
+		goto end;
+	}
+
+	/*
+	 * As all the sizes are multiples of 8, an alignment of less
+	 * than 8 bits never changes the offset.
+	 */
+	*offset_bits = ALIGN(*offset_bits,
+		bt_ctf_field_type_common_get_alignment(ft));
+	*offset_bits += size;
+
+end:
+	return ret;
+}
+
+static
+void compute_packed_payload_layout(struct bt_ctf_event_class *event_class)
+{
+	struct bt_ctf_event_class_packed_payload_layout *layout =
+		&event_class->packed_payload_layout;
+	struct bt_ctf_field_type_common *payload_ft =
+		event_class->common.payload_field_type;
+	uint64_t offset_bits = 0;
+	int64_t count;
+	int64_t i;
+
+	BT_ASSERT_DBG(event_class->common.frozen);
+	layout->is_packable = false;
+
+	/*
+	 * A packed event has no specific context: its fields would
+	 * need to be written for each event.
+	 */
+	if (!payload_ft || event_class->common.context_field_type) {
+		goto end;
+	}
+
+	layout->member_offsets = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	if (!layout->member_offsets) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto end;
+	}
+
+	count = bt_ctf_field_type_common_structure_get_field_count(payload_ft);
+	BT_ASSERT_DBG(count >= 0);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_field_type_common *member_ft;
+		uint64_t offset;
+		int alignment;
+		int ret;
+
+		ret = bt_ctf_field_type_common_structure_borrow_field_by_index(
+			payload_ft, NULL, &member_ft, i);
+		BT_ASSERT_DBG(ret == 0);
+		alignment = bt_ctf_field_type_common_get_alignment(member_ft);
+		if (alignment > 0) {
+			/* Where the member starts */
+			offset_bits = ALIGN(offset_bits, alignment);
+			offset = offset_bits / CHAR_BIT;
+			ret = add_packed_field_type_size(member_ft, &offset_bits);
+		} else {
+			ret = -1;
+		}
+
+		if (ret) {
+			BT_LOGD("Event class's payload field type has no packed layout: "
+				"addr=%p, name=\"%s\", id=%" PRId64 ", "
+				"member-index=%" PRId64,
+				event_class, bt_ctf_event_class_get_name(event_class),
+				bt_ctf_event_class_get_id(event_class), i);
+			goto end;
+		}
+
+		g_array_append_val(layout->member_offsets, offset);
+	}
+
+	layout->size = offset_bits / CHAR_BIT;
+	layout->is_packable = true;
+	BT_LOGD("Computed event class's packed payload layout: "
+		"addr=%p, name=\"%s\", id=%" PRId64 ", size=%" PRIu64,
+		event_class, bt_ctf_event_class_get_name(event_class),
+		bt_ctf_event_class_get_id(event_class), layout->size);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+struct bt_ctf_event_class_packed_payload_layout *
+bt_ctf_event_class_borrow_packed_payload_layout(
+		struct bt_ctf_event_class *event_class)
+{
+	struct bt_ctf_event_class_packed_payload_layout *layout =
+		&event_class->packed_payload_layout;
+
+	if (G_UNLIKELY(g_once_init_enter(&layout->is_computed))) {
+		compute_packed_payload_layout(event_class);
+		g_once_init_leave(&layout->is_computed, 1);
+	}
+
+	return layout->is_packable ? layout : NULL;
+}
+
+int64_t bt_ctf_event_class_get_packed_payload_size(
+		struct bt_ctf_event_class *event_class)
+{
+	struct bt_ctf_event_class_packed_payload_layout *layout;
+	int64_t ret;
+
+	if (!event_class) {
+		BT_LOGW_STR("Invalid parameter: event class is NULL.");
+		ret = (int64_t) -1;
+		goto end;
+	}
+
+	if (!event_class->common.frozen) {
+		BT_LOGW("Invalid parameter: event class is not part of a stream class: "
+			"addr=%p, name=\"%s\", id=%" PRId64,
+			event_class, bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class));
+		ret = (int64_t) -1;
+		goto end;
+	}
+
+	layout = bt_ctf_event_class_borrow_packed_payload_layout(event_class);
+	if (!layout) {
+		BT_LOGW("Event class's payload field type has no packed layout: "
+			"addr=%p, name=\"%s\", id=%" PRId64,
+			event_class, bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class));
+		ret = (int64_t) -1;
+		goto end;
+	}
+
+	ret = (int64_t) layout->size;
+
+end:
+	return ret;
+}
+
+int64_t bt_ctf_event_class_get_packed_payload_field_offset(
+		struct bt_ctf_event_class *event_class, const char *name)
+{
+	struct bt_ctf_field_type_common_structure *payload_ft;
+	int64_t ret = bt_ctf_event_class_get_packed_payload_size(event_class);
+	gpointer orig_key, index;
+
+	if (ret < 0) {
+		/* bt_ctf_event_class_get_packed_payload_size() logs errors */
+		goto end;
+	}
+
+	if (!name) {
+		BT_LOGW_STR("Invalid parameter: name is NULL.");
+		ret = (int64_t) -1;
+		goto end;
+	}
+
+	payload_ft = BT_CTF_FROM_COMMON(event_class->common.payload_field_type);
+	if (!g_hash_table_lookup_extended(payload_ft->field_name_to_index,
+			GUINT_TO_POINTER(g_quark_try_string(name)),
+			&orig_key, &index)) {
+		BT_LOGW("Invalid parameter: no such payload field: "
+			"addr=%p, name=\"%s\", id=%" PRId64 ", field-name=\"%s\"",
+			event_class, bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class), name);
+		ret = (int64_t) -1;
+		goto end;
+	}
+
+	ret = (int64_t) g_array_index(
+		event_class->packed_payload_layout.member_offsets, uint64_t,
+		GPOINTER_TO_UINT(index));
+
+end:
+	return ret;
+}
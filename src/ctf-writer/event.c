@@ -571,26 +571,189 @@ void release_event_header_field(struct bt_ctf_field_wrapper *field_wrapper,
 	bt_ctf_field_wrapper_destroy(field_wrapper);
 }
 
+/*
+ * Returns whether or not `field` is a field which an event would
+ * create for the field type `ft` and which only this event owns.
+ */
+static
+bool field_is_recyclable(struct bt_ctf_field_common *field,
+		struct bt_ctf_field_type_common *ft)
+{
+	if (!field) {
+		return !ft;
+	}
+
+	return field->type == ft &&
+		bt_ctf_object_get_ref_count(&field->base) == 1;
+}
+
+/*
+ * Returns whether or not the event `event`, of which the reference
+ * count is zero, can go back to the event pool of its class.
+ *
+ * This is not the case if its creation failed, or if the user replaced
+ * one of its fields with a field of a copied field type, or with a
+ * field which the user still owns.
+ */
+static
+bool event_is_recyclable(struct bt_ctf_event *event)
+{
+	struct bt_ctf_event_class_common *event_class = event->common.class;
+	struct bt_ctf_stream_class_common *stream_class;
+
+	if (!event_class || !event_class->valid) {
+		return false;
+	}
+
+	stream_class = bt_ctf_event_class_common_borrow_stream_class(
+		event_class);
+	BT_ASSERT_DBG(stream_class);
+
+	if (event->common.header_field) {
+		if (!field_is_recyclable(event->common.header_field->field,
+				stream_class->event_header_field_type)) {
+			return false;
+		}
+	} else if (stream_class->event_header_field_type) {
+		return false;
+	}
+
+	return field_is_recyclable(event->common.stream_event_context_field,
+			stream_class->event_context_field_type) &&
+		field_is_recyclable(event->common.context_field,
+			event_class->context_field_type) &&
+		field_is_recyclable(event->common.payload_field,
+			event_class->payload_field_type);
+}
+
+static
+void reset_event_field(struct bt_ctf_field_common *field)
+{
+	if (field) {
+		bt_ctf_field_common_set_is_frozen_recursive(field, false);
+		_bt_ctf_field_common_reset_recursive(field);
+	}
+}
+
+/*
+ * Puts the event `event`, of which the reference count is zero, back
+ * into the event pool of its class, keeping its fields.
+ *
+ * A recycled event keeps its class pointer, but no reference on it.
+ */
+static
+void recycle_event(struct bt_ctf_event *event)
+{
+	struct bt_ctf_event_class *event_class =
+		BT_CTF_FROM_COMMON(event->common.class);
+
+	/*
+	 * An event without a parent stream keeps a reference on its
+	 * class (see bt_ctf_event_common_finalize()).
+	 */
+	bool put_class = !event->common.base.parent;
+
+	BT_LOGT("Recycling event: addr=%p, event-class-name=\"%s\", "
+		"event-class-id=%" PRId64, event,
+		bt_ctf_event_class_get_name(event_class),
+		bt_ctf_event_class_get_id(event_class));
+
+	if (event->common.header_field) {
+		reset_event_field(event->common.header_field->field);
+	}
+
+	reset_event_field(event->common.stream_event_context_field);
+	reset_event_field(event->common.context_field);
+	reset_event_field(event->common.payload_field);
+	event->common.frozen = 0;
+
+	/* The parent's reference was put when the count reached zero */
+	event->common.base.parent = NULL;
+	bt_ctf_object_pool_recycle_object(&event_class->event_pool, event);
+
+	/*
+	 * Put this reference last: this could destroy the event class,
+	 * and therefore its event pool, including `event`.
+	 */
+	if (put_class) {
+		bt_ctf_object_put_ref(event_class);
+	}
+}
+
 static
 void bt_ctf_event_destroy(struct bt_ctf_object *obj)
 {
+	struct bt_ctf_event *event = (void *) obj;
+
+	if (event_is_recyclable(event)) {
+		recycle_event(event);
+		return;
+	}
+
 	bt_ctf_event_common_finalize(obj, (void *) bt_ctf_object_put_ref,
 		(void *) release_event_header_field);
 	g_free(obj);
 }
 
+BT_HIDDEN
+struct bt_ctf_event *bt_ctf_event_new(struct bt_ctf_event_class *event_class)
+{
+	struct bt_ctf_event *event = g_new0(struct bt_ctf_event, 1);
+
+	if (!event) {
+		BT_LOGE_STR("Failed to allocate one CTF writer event.");
+	}
+
+	return event;
+}
+
+BT_HIDDEN
+void bt_ctf_event_destroy_recycled(struct bt_ctf_event *event,
+		struct bt_ctf_event_class *event_class)
+{
+	/* A recycled event has no reference on its class */
+	event->common.class = NULL;
+	bt_ctf_event_common_finalize(&event->common.base,
+		(void *) bt_ctf_object_put_ref,
+		(void *) release_event_header_field);
+	g_free(event);
+}
+
 struct bt_ctf_event *bt_ctf_event_create(struct bt_ctf_event_class *event_class)
 {
 	int ret;
 	struct bt_ctf_event *event = NULL;
 	struct bt_ctf_clock_class *expected_clock_class = NULL;
 
-	event = g_new0(struct bt_ctf_event, 1);
+	if (event_class) {
+		event = bt_ctf_object_pool_create_object(
+			&event_class->event_pool);
+	} else {
+		event = bt_ctf_event_new(NULL);
+	}
+
 	if (!event) {
-		BT_LOGE_STR("Failed to allocate one CTF writer event.");
 		goto error;
 	}
 
+	if (event->common.class) {
+		/*
+		 * Recycled event: its class is frozen and valid, so
+		 * its fields are still the ones which the class would
+		 * create.
+		 */
+		BT_ASSERT_DBG(event->common.class ==
+			BT_CTF_TO_COMMON(event_class));
+		bt_ctf_object_init_shared_with_parent(&event->common.base,
+			bt_ctf_event_destroy);
+		bt_ctf_object_get_ref(event_class);
+		BT_LOGT("Created event from pool: addr=%p, "
+			"event-class-name=\"%s\", event-class-id=%" PRId64,
+			event, bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class));
+		goto end;
+	}
+
 	if (event_class) {
 		struct bt_ctf_stream_class *stream_class =
 			BT_CTF_FROM_COMMON(bt_ctf_event_class_common_borrow_stream_class(
@@ -234,14 +234,75 @@ struct bt_ctf_event {
 	struct bt_ctf_event_common common;
 };
 
+/*
+ * Layout of the packed payload of an event class (see
+ * bt_ctf_event_class_get_packed_payload_size()).
+ */
+struct bt_ctf_event_class_packed_payload_layout {
+	/*
+	 * Non-zero once the members below are set: guarded with
+	 * g_once_init_enter() and g_once_init_leave() so that
+	 * several threads can borrow the layout concurrently.
+	 */
+	gsize is_computed;
+
+	/* False if the payload field type has no packed layout */
+	bool is_packable;
+
+	/* Size of a packed payload (bytes) */
+	uint64_t size;
+
+	/*
+	 * Array of `uint64_t`: offset (bytes) of each member of the
+	 * payload field type within a packed payload.
+	 */
+	GArray *member_offsets;
+};
+
 struct bt_ctf_event_class {
 	struct bt_ctf_event_class_common common;
+
+	/*
+	 * Computed the first time it's needed: the event class is
+	 * frozen at this point.
+	 */
+	struct bt_ctf_event_class_packed_payload_layout packed_payload_layout;
+
+	/*
+	 * Pool of recycled events of this class, with their fields, so
+	 * that creating an event does not allocate a whole field tree
+	 * (see bt_ctf_event_create()).
+	 */
+	struct bt_ctf_object_pool event_pool;
 };
 
 BT_HIDDEN
 int bt_ctf_event_class_serialize(struct bt_ctf_event_class *event_class,
 		struct metadata_context *context);
 
+/*
+ * Allocates an empty event for the event pool of `event_class`.
+ */
+BT_HIDDEN
+struct bt_ctf_event *bt_ctf_event_new(struct bt_ctf_event_class *event_class);
+
+/*
+ * Destroys the recycled event `event` of the event pool of
+ * `event_class`.
+ */
+BT_HIDDEN
+void bt_ctf_event_destroy_recycled(struct bt_ctf_event *event,
+		struct bt_ctf_event_class *event_class);
+
+/*
+ * Returns the packed payload layout of `event_class`, computing it
+ * if needed, or `NULL` if its payload field type has no packed layout.
+ */
+BT_HIDDEN
+struct bt_ctf_event_class_packed_payload_layout *
+bt_ctf_event_class_borrow_packed_payload_layout(
+		struct bt_ctf_event_class *event_class);
+
 BT_HIDDEN
 int bt_ctf_event_serialize(struct bt_ctf_event *event,
 		struct bt_ctfser *pos,
@@ -378,7 +378,7 @@ void bt_ctf_field_common_structure_reset_recursive(struct bt_ctf_field_common *f
 			continue;
 		}
 
-		bt_ctf_field_common_reset_recursive(member);
+		_bt_ctf_field_common_reset_recursive(member);
 	}
 }
 
@@ -410,7 +410,7 @@ void bt_ctf_field_common_array_reset_recursive(struct bt_ctf_field_common *field
 			continue;
 		}
 
-		bt_ctf_field_common_reset_recursive(member);
+		_bt_ctf_field_common_reset_recursive(member);
 	}
 }
 
@@ -424,7 +424,7 @@ void bt_ctf_field_common_sequence_reset_recursive(struct bt_ctf_field_common *fi
 
 	for (i = 0; i < sequence->elements->len; i++) {
 		if (sequence->elements->pdata[i]) {
-			bt_ctf_field_common_reset_recursive(
+			_bt_ctf_field_common_reset_recursive(
 				sequence->elements->pdata[i]);
 		}
 	}
@@ -673,12 +673,15 @@ static struct bt_ctf_field_common_methods bt_ctf_field_enumeration_methods = {
 	.reset = bt_ctf_field_enumeration_reset_recursive,
 };
 
+static
+void bt_ctf_field_string_reset(struct bt_ctf_field_common *field);
+
 static struct bt_ctf_field_common_methods bt_ctf_field_string_methods = {
 	.set_is_frozen = bt_ctf_field_common_generic_set_is_frozen,
 	.validate = bt_ctf_field_common_generic_validate,
 	.copy = NULL,
 	.is_set = bt_ctf_field_common_generic_is_set,
-	.reset = bt_ctf_field_common_generic_reset,
+	.reset = bt_ctf_field_string_reset,
 };
 
 static struct bt_ctf_field_common_methods bt_ctf_field_structure_methods = {
@@ -1703,7 +1706,7 @@ void bt_ctf_field_enumeration_reset_recursive(struct bt_ctf_field_common *field)
 	struct bt_ctf_field_enumeration *enumeration = (void *) field;
 
 	if (enumeration->container) {
-		bt_ctf_field_common_reset_recursive(
+		_bt_ctf_field_common_reset_recursive(
 			(void *) enumeration->container);
 	}
 
@@ -1765,13 +1768,28 @@ end:
 	return is_set;
 }
 
+static
+void bt_ctf_field_string_reset(struct bt_ctf_field_common *field)
+{
+	struct bt_ctf_field_common_string *string = BT_CTF_FROM_COMMON(field);
+
+	/* Make bt_ctf_field_string_append() start from an empty string */
+	string->size = 0;
+
+	if (string->buf->len > 0) {
+		((char *) string->buf->data)[0] = '\0';
+	}
+
+	bt_ctf_field_common_generic_reset(field);
+}
+
 static
 void bt_ctf_field_variant_reset_recursive(struct bt_ctf_field_common *field)
 {
 	struct bt_ctf_field_variant *variant = (void *) field;
 
 	if (variant->tag) {
-		bt_ctf_field_common_reset_recursive(
+		_bt_ctf_field_common_reset_recursive(
 			(void *) variant->tag);
 	}
 
@@ -295,6 +295,12 @@ end:
 	return ret;
 }
 
+/*
+ * Unlike bt_ctf_field_common_reset_recursive(), which only exists in
+ * developer mode, this resets `field` in all modes: the recursive
+ * reset methods call it directly, so that recycling an event (see
+ * `event.c`) always resets its fields.
+ */
 static inline
 void _bt_ctf_field_common_reset_recursive(struct bt_ctf_field_common *field)
 {
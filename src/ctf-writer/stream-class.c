@@ -895,11 +895,11 @@ end:
 }
 
 BT_HIDDEN
-int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
+int bt_ctf_stream_class_serialize_block(
+		struct bt_ctf_stream_class *stream_class,
 		struct metadata_context *context)
 {
 	int ret = 0;
-	size_t i;
 	struct bt_ctf_trace *trace;
 	struct bt_ctf_field_type *packet_header_type = NULL;
 
@@ -996,6 +996,24 @@ int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 
 	g_string_append(context->string, "\n};\n\n");
 
+end:
+	bt_ctf_object_put_ref(packet_header_type);
+	context->current_indentation_level = 0;
+	return ret;
+}
+
+BT_HIDDEN
+int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
+		struct metadata_context *context)
+{
+	int ret;
+	size_t i;
+
+	ret = bt_ctf_stream_class_serialize_block(stream_class, context);
+	if (ret) {
+		goto end;
+	}
+
 	for (i = 0; i < stream_class->common.event_classes->len; i++) {
 		struct bt_ctf_event_class *event_class =
 			stream_class->common.event_classes->pdata[i];
@@ -1013,7 +1031,6 @@ int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 	}
 
 end:
-	bt_ctf_object_put_ref(packet_header_type);
 	context->current_indentation_level = 0;
 	return ret;
 }
@@ -508,6 +508,15 @@ struct bt_ctf_stream_class {
 
 struct metadata_context;
 
+/*
+ * Serializes the `stream` block of `stream_class`, without its event
+ * classes.
+ */
+BT_HIDDEN
+int bt_ctf_stream_class_serialize_block(
+		struct bt_ctf_stream_class *stream_class,
+		struct metadata_context *context);
+
 BT_HIDDEN
 int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 		struct metadata_context *context);
@@ -11,6 +11,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <babeltrace2-ctf-writer/field-types.h>
@@ -137,7 +138,7 @@ static
 int set_integer_field_value(struct bt_ctf_field* field, uint64_t value)
 {
 	int ret = 0;
-	struct bt_ctf_field_type *field_type = NULL;
+	struct bt_ctf_field_type *field_type;
 
 	if (!field) {
 		BT_LOGW_STR("Invalid parameter: field is NULL.");
@@ -145,7 +146,11 @@ int set_integer_field_value(struct bt_ctf_field* field, uint64_t value)
 		goto end;
 	}
 
-	field_type = bt_ctf_field_get_type(field);
+	/*
+	 * Borrow the field type: several streams, possibly flushed
+	 * from different threads, share it.
+	 */
+	field_type = (void *) bt_ctf_field_common_borrow_type((void *) field);
 	BT_ASSERT_DBG(field_type);
 
 	if (bt_ctf_field_type_get_type_id(field_type) !=
@@ -180,7 +185,6 @@ int set_integer_field_value(struct bt_ctf_field* field, uint64_t value)
 		}
 	}
 end:
-	bt_ctf_object_put_ref(field_type);
 	return ret;
 }
 
@@ -240,8 +244,8 @@ int set_packet_header_uuid(struct bt_ctf_stream *stream)
 		goto end;
 	}
 
-	trace = (struct bt_ctf_trace *)
-		bt_ctf_object_get_parent(&stream->common.base);
+	trace = BT_CTF_FROM_COMMON(bt_ctf_stream_class_common_borrow_trace(
+		stream->common.stream_class));
 
 	for (i = 0; i < 16; i++) {
 		struct bt_ctf_field *uuid_element =
@@ -266,7 +270,6 @@ int set_packet_header_uuid(struct bt_ctf_stream *stream)
 
 end:
 	bt_ctf_object_put_ref(uuid_field);
-	BT_CTF_OBJECT_PUT_REF_AND_RESET(trace);
 	return ret;
 }
 static
@@ -522,17 +525,15 @@ int visit_field_update_clock_value(struct bt_ctf_field *field, uint64_t *val)
 	switch (bt_ctf_field_get_type_id(field)) {
 	case BT_CTF_FIELD_TYPE_ID_INTEGER:
 	{
-		struct bt_ctf_clock_class *cc =
-			bt_ctf_field_type_integer_get_mapped_clock_class(
-				(void *) field_common->type);
+		struct bt_ctf_field_type_common_integer *int_ft =
+			BT_CTF_FROM_COMMON(field_common->type);
 		int val_size;
 		uint64_t uval;
 
-		if (!cc) {
+		if (!int_ft->mapped_clock_class) {
 			goto end;
 		}
 
-		bt_ctf_object_put_ref(cc);
 		val_size = bt_ctf_field_type_integer_get_size(
 			(void *) field_common->type);
 		BT_ASSERT_DBG(val_size >= 1);
@@ -699,6 +700,61 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the integer field type of the `timestamp` field of the event
+ * header field type `event_header_ft`, or `NULL` if there's none.
+ */
+static
+struct bt_ctf_field_type_common_integer *borrow_event_header_timestamp_ft(
+		struct bt_ctf_field_type_common *event_header_ft)
+{
+	struct bt_ctf_field_type_common *ft = NULL;
+
+	if (!event_header_ft) {
+		goto end;
+	}
+
+	ft = bt_ctf_field_type_common_structure_borrow_field_type_by_name(
+		event_header_ft, "timestamp");
+	if (ft && ft->id != BT_CTF_FIELD_TYPE_ID_INTEGER) {
+		ft = NULL;
+	}
+
+end:
+	return (void *) ft;
+}
+
+/*
+ * Updates `*val` with the timestamps of the packed events of `stream`,
+ * from `*packed_event_index`, which precede its event at index
+ * `event_index`, and updates `*packed_event_index` accordingly.
+ */
+static
+void visit_packed_events_update_clock_value(struct bt_ctf_stream *stream,
+		guint event_index, guint *packed_event_index, uint64_t *val)
+{
+	struct bt_ctf_field_type_common_integer *timestamp_ft =
+		borrow_event_header_timestamp_ft(
+			stream->common.stream_class->event_header_field_type);
+
+	for (; *packed_event_index < stream->packed_events->len;
+			(*packed_event_index)++) {
+		struct bt_ctf_stream_packed_event *packed_event =
+			&g_array_index(stream->packed_events,
+				struct bt_ctf_stream_packed_event,
+				*packed_event_index);
+
+		if (packed_event->event_index != event_index) {
+			break;
+		}
+
+		if (timestamp_ft && timestamp_ft->mapped_clock_class) {
+			update_clock_value(val, packed_event->timestamp,
+				timestamp_ft->size);
+		}
+	}
+}
+
 static
 int set_packet_context_timestamps(struct bt_ctf_stream *stream)
 {
@@ -714,6 +770,7 @@ int set_packet_context_timestamps(struct bt_ctf_stream *stream)
 		(void *) stream->packet_context;
 	uint64_t i;
 	int64_t len;
+	guint packed_event_index = 0;
 
 	if (ts_begin_field && bt_ctf_field_is_set_recursive(ts_begin_field)) {
 		/* Use provided `timestamp_begin` value as starting value */
@@ -811,9 +868,18 @@ int set_packet_context_timestamps(struct bt_ctf_stream *stream)
 		}
 	}
 
-	for (i = 0; i < stream->events->len; i++) {
-		struct bt_ctf_event *event = g_ptr_array_index(stream->events, i);
+	for (i = 0; i <= stream->events->len; i++) {
+		struct bt_ctf_event *event;
+
+		/* Visit the packed events which precede this event */
+		visit_packed_events_update_clock_value(stream, i,
+			&packed_event_index, &cur_clock_value);
+
+		if (i == stream->events->len) {
+			break;
+		}
 
+		event = g_ptr_array_index(stream->events, i);
 		BT_ASSERT_DBG(event);
 		ret = visit_event_update_clock_value(event, &cur_clock_value);
 		if (ret) {
@@ -1110,6 +1176,19 @@ struct bt_ctf_stream *bt_ctf_stream_create_with_id(
 		goto error;
 	}
 
+	stream->packed_events = g_array_new(FALSE, FALSE,
+		sizeof(struct bt_ctf_stream_packed_event));
+	if (!stream->packed_events) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	stream->packed_payloads = g_byte_array_new();
+	if (!stream->packed_payloads) {
+		BT_LOGE_STR("Failed to allocate a GByteArray.");
+		goto error;
+	}
+
 	if (trace->common.packet_header_field_type) {
 		BT_LOGD("Creating stream's packet header field: "
 			"ft-addr=%p", trace->common.packet_header_field_type);
@@ -1450,6 +1529,177 @@ error:
 	return ret;
 }
 
+/*
+ * Checks that bt_ctf_stream_append_packed_events() can set all the
+ * fields of the event header field type of the class of `stream`,
+ * setting `*has_timestamp` to whether or not it has a `timestamp`
+ * field.
+ */
+static
+int check_packed_event_header_field_type(struct bt_ctf_stream *stream,
+		bool *has_timestamp)
+{
+	int ret = 0;
+	struct bt_ctf_stream_class *stream_class =
+		BT_CTF_FROM_COMMON(bt_ctf_stream_common_borrow_class(
+			BT_CTF_TO_COMMON(stream)));
+	struct bt_ctf_field_type_common *event_header_ft =
+		stream_class->common.event_header_field_type;
+	int64_t count;
+	int64_t i;
+
+	*has_timestamp = false;
+
+	if (!event_header_ft) {
+		goto end;
+	}
+
+	count = bt_ctf_field_type_common_structure_get_field_count(
+		event_header_ft);
+	BT_ASSERT_DBG(count >= 0);
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+		struct bt_ctf_field_type_common *ft;
+
+		ret = bt_ctf_field_type_common_structure_borrow_field_by_index(
+			event_header_ft, &name, &ft, i);
+		BT_ASSERT_DBG(ret == 0);
+
+		if (ft->id == BT_CTF_FIELD_TYPE_ID_INTEGER) {
+			struct bt_ctf_field_type_common_integer *int_ft =
+				BT_CTF_FROM_COMMON(ft);
+
+			if (strcmp(name, "id") == 0) {
+				continue;
+			}
+
+			if (strcmp(name, "timestamp") == 0 &&
+					stream_class->clock &&
+					int_ft->mapped_clock_class) {
+				*has_timestamp = true;
+				continue;
+			}
+		}
+
+		BT_LOGW("Cannot append packed events: cannot automatically "
+			"set stream class's event header field: "
+			"stream-addr=%p, stream-name=\"%s\", field-name=\"%s\"",
+			stream, bt_ctf_stream_get_name(stream), name);
+		ret = -1;
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
+int bt_ctf_stream_append_packed_events(struct bt_ctf_stream *stream,
+		struct bt_ctf_event_class *event_class, const void *payloads,
+		const uint64_t *timestamps, uint64_t count)
+{
+	int ret = 0;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_event_class_packed_payload_layout *layout;
+	bool has_timestamp;
+	uint64_t timestamp = 0;
+	uint64_t i;
+
+	if (!stream) {
+		BT_LOGW_STR("Invalid parameter: stream is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!event_class) {
+		BT_LOGW_STR("Invalid parameter: event class is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!payloads && count > 0) {
+		BT_LOGW_STR("Invalid parameter: payloads is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	stream_class = BT_CTF_FROM_COMMON(bt_ctf_stream_common_borrow_class(
+		BT_CTF_TO_COMMON(stream)));
+	if (bt_ctf_event_class_borrow_stream_class(event_class) !=
+			stream_class) {
+		BT_LOGW("Invalid parameter: event class is not part of the stream's class: "
+			"stream-addr=%p, stream-name=\"%s\", event-class-addr=%p",
+			stream, bt_ctf_stream_get_name(stream), event_class);
+		ret = -1;
+		goto end;
+	}
+
+	if (stream_class->common.event_context_field_type) {
+		BT_LOGW("Cannot append packed events: stream class has a "
+			"stream event context field type: "
+			"stream-addr=%p, stream-name=\"%s\"",
+			stream, bt_ctf_stream_get_name(stream));
+		ret = -1;
+		goto end;
+	}
+
+	layout = bt_ctf_event_class_borrow_packed_payload_layout(event_class);
+	if (!layout) {
+		BT_LOGW("Cannot append packed events: event class has no "
+			"packed payload layout: "
+			"stream-addr=%p, stream-name=\"%s\", "
+			"event-class-name=\"%s\", event-class-id=%" PRId64,
+			stream, bt_ctf_stream_get_name(stream),
+			bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class));
+		ret = -1;
+		goto end;
+	}
+
+	ret = check_packed_event_header_field_type(stream, &has_timestamp);
+	if (ret) {
+		/* check_packed_event_header_field_type() logs errors */
+		goto end;
+	}
+
+	if (layout->size * count > G_MAXUINT - stream->packed_payloads->len) {
+		BT_LOGW("Cannot append packed events: current packet is too large: "
+			"stream-addr=%p, stream-name=\"%s\", count=%" PRIu64,
+			stream, bt_ctf_stream_get_name(stream), count);
+		ret = -1;
+		goto end;
+	}
+
+	if (has_timestamp && !timestamps) {
+		ret = bt_ctf_clock_get_value(stream_class->clock, &timestamp);
+		BT_ASSERT_DBG(ret == 0);
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_stream_packed_event packed_event;
+
+		packed_event.event_class = event_class;
+		packed_event.timestamp = timestamps ? timestamps[i] : timestamp;
+		packed_event.payload_offset = stream->packed_payloads->len +
+			(guint) (i * layout->size);
+		packed_event.event_index = stream->events->len;
+		g_array_append_val(stream->packed_events, packed_event);
+	}
+
+	g_byte_array_append(stream->packed_payloads, payloads,
+		(guint) (layout->size * count));
+	BT_LOGT("Appended packed events to stream: "
+		"stream-addr=%p, stream-name=\"%s\", "
+		"event-class-name=\"%s\", event-class-id=%" PRId64 ", "
+		"count=%" PRIu64,
+		stream, bt_ctf_stream_get_name(stream),
+		bt_ctf_event_class_get_name(event_class),
+		bt_ctf_event_class_get_id(event_class), count);
+
+end:
+	return ret;
+}
+
 struct bt_ctf_field *bt_ctf_stream_get_packet_context(struct bt_ctf_stream *stream)
 {
 	struct bt_ctf_field *packet_context = NULL;
@@ -1579,6 +1829,136 @@ end:
 	return ret;
 }
 
+static
+int serialize_packed_event(struct bt_ctf_stream *stream,
+		struct bt_ctf_stream_packed_event *packed_event,
+		enum bt_ctf_byte_order native_byte_order)
+{
+	int ret = 0;
+	struct bt_ctf_field_type_common *event_header_ft =
+		stream->common.stream_class->event_header_field_type;
+	struct bt_ctf_event_class *event_class = packed_event->event_class;
+	struct bt_ctf_field_type_common *payload_ft =
+		event_class->common.payload_field_type;
+	uint64_t payload_size = event_class->packed_payload_layout.size;
+
+	if (event_header_ft) {
+		int64_t count =
+			bt_ctf_field_type_common_structure_get_field_count(
+				event_header_ft);
+		int64_t i;
+
+		ret = bt_ctfser_align_offset_in_current_packet(
+			&stream->ctfser, event_header_ft->alignment);
+		if (G_UNLIKELY(ret)) {
+			goto end;
+		}
+
+		/*
+		 * check_packed_event_header_field_type() checked those
+		 * fields when the event was appended.
+		 */
+		for (i = 0; i < count; i++) {
+			const char *name;
+			struct bt_ctf_field_type_common *ft;
+			struct bt_ctf_field_type_common_integer *int_ft;
+			enum bt_ctf_byte_order byte_order;
+			uint64_t value;
+
+			ret = bt_ctf_field_type_common_structure_borrow_field_by_index(
+				event_header_ft, &name, &ft, i);
+			BT_ASSERT_DBG(ret == 0);
+			int_ft = BT_CTF_FROM_COMMON(ft);
+
+			if (strcmp(name, "id") == 0) {
+				value = (uint64_t) event_class->common.id;
+			} else {
+				value = packed_event->timestamp;
+			}
+
+			byte_order = int_ft->user_byte_order;
+			if (byte_order == BT_CTF_BYTE_ORDER_NATIVE) {
+				byte_order = native_byte_order;
+			}
+
+			ret = bt_ctfser_write_unsigned_int(&stream->ctfser,
+				value, ft->alignment, int_ft->size,
+				byte_order == BT_CTF_BYTE_ORDER_LITTLE_ENDIAN ?
+					LITTLE_ENDIAN : BIG_ENDIAN);
+			if (G_UNLIKELY(ret)) {
+				goto end;
+			}
+		}
+	}
+
+	ret = bt_ctfser_align_offset_in_current_packet(&stream->ctfser,
+		payload_ft->alignment);
+	if (G_UNLIKELY(ret)) {
+		goto end;
+	}
+
+	if (bt_ctfser_get_offset_in_current_packet_bits(&stream->ctfser) %
+			CHAR_BIT != 0) {
+		BT_LOGW("Cannot serialize packed event: payload does not start "
+			"on a byte boundary: stream-addr=%p, stream-name=\"%s\", "
+			"ser-offset=%" PRIu64,
+			stream, bt_ctf_stream_get_name(stream),
+			bt_ctfser_get_offset_in_current_packet_bits(
+				&stream->ctfser));
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_ctfser_write_bytes(&stream->ctfser,
+		stream->packed_payloads->data + packed_event->payload_offset,
+		payload_size);
+
+end:
+	return ret;
+}
+
+/*
+ * Serializes the packed events of `stream`, from `*packed_event_index`,
+ * which precede its event at index `event_index`, and updates
+ * `*packed_event_index` accordingly.
+ */
+static
+int serialize_packed_events(struct bt_ctf_stream *stream,
+		guint event_index, guint *packed_event_index,
+		enum bt_ctf_byte_order native_byte_order)
+{
+	int ret = 0;
+
+	for (; *packed_event_index < stream->packed_events->len;
+			(*packed_event_index)++) {
+		struct bt_ctf_stream_packed_event *packed_event =
+			&g_array_index(stream->packed_events,
+				struct bt_ctf_stream_packed_event,
+				*packed_event_index);
+
+		if (packed_event->event_index != event_index) {
+			break;
+		}
+
+		ret = serialize_packed_event(stream, packed_event,
+			native_byte_order);
+		if (G_UNLIKELY(ret)) {
+			BT_LOGW("Cannot serialize packed event: "
+				"index=%u, event-class-name=\"%s\", "
+				"event-class-id=%" PRId64,
+				*packed_event_index,
+				bt_ctf_event_class_get_name(
+					packed_event->event_class),
+				bt_ctf_event_class_get_id(
+					packed_event->event_class));
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static
 void reset_structure_field(struct bt_ctf_field *structure, const char *name)
 {
@@ -1601,6 +1981,7 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 	bool has_packet_size = false;
 	uint64_t packet_size_bits = 0;
 	uint64_t content_size_bits = 0;
+	guint packed_event_index = 0;
 
 	if (!stream) {
 		BT_LOGW_STR("Invalid parameter: stream is NULL.");
@@ -1689,13 +2070,27 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 		}
 	}
 
-	BT_LOGT("Serializing events: count=%u", stream->events->len);
+	BT_LOGT("Serializing events: count=%u, packed-count=%u",
+		stream->events->len, stream->packed_events->len);
 
-	for (i = 0; i < stream->events->len; i++) {
-		struct bt_ctf_event *event = g_ptr_array_index(
-			stream->events, i);
-		struct bt_ctf_event_class *event_class =
-			BT_CTF_FROM_COMMON(bt_ctf_event_common_borrow_class(
+	for (i = 0; i <= stream->events->len; i++) {
+		struct bt_ctf_event *event;
+		struct bt_ctf_event_class *event_class;
+
+		/* Write the packed events which precede this event */
+		ret = serialize_packed_events(stream, i, &packed_event_index,
+			native_byte_order);
+		if (ret) {
+			goto end;
+		}
+
+		if (i == stream->events->len) {
+			break;
+		}
+
+		event = g_ptr_array_index(stream->events, i);
+		event_class = BT_CTF_FROM_COMMON(
+			bt_ctf_event_common_borrow_class(
 				BT_CTF_TO_COMMON(event)));
 
 		BT_LOGT("Serializing event: index=%zu, event-addr=%p, "
@@ -1810,6 +2205,8 @@ int bt_ctf_stream_flush(struct bt_ctf_stream *stream)
 	}
 
 	g_ptr_array_set_size(stream->events, 0);
+	g_array_set_size(stream->packed_events, 0);
+	g_byte_array_set_size(stream->packed_payloads, 0);
 	stream->flushed_packet_count++;
 	bt_ctfser_close_current_packet(&stream->ctfser, packet_size_bits / 8);
 
@@ -1849,6 +2246,14 @@ void bt_ctf_stream_destroy(struct bt_ctf_object *obj)
 		g_ptr_array_free(stream->events, TRUE);
 	}
 
+	if (stream->packed_events) {
+		g_array_free(stream->packed_events, TRUE);
+	}
+
+	if (stream->packed_payloads) {
+		g_byte_array_free(stream->packed_payloads, TRUE);
+	}
+
 	BT_LOGD_STR("Putting packet header field.");
 	bt_ctf_object_put_ref(stream->packet_header);
 	BT_LOGD_STR("Putting packet context field.");
@@ -1861,7 +2266,7 @@ int _set_structure_field_integer(struct bt_ctf_field *structure, const char *nam
 		uint64_t value, bt_ctf_bool force)
 {
 	int ret = 0;
-	struct bt_ctf_field_type *field_type = NULL;
+	struct bt_ctf_field_type *field_type;
 	struct bt_ctf_field *integer;
 
 	BT_ASSERT_DBG(structure);
@@ -1883,7 +2288,8 @@ int _set_structure_field_integer(struct bt_ctf_field *structure, const char *nam
 		goto end;
 	}
 
-	field_type = bt_ctf_field_get_type(integer);
+	/* Borrow the field type: see set_integer_field_value() */
+	field_type = (void *) bt_ctf_field_common_borrow_type((void *) integer);
 	BT_ASSERT_DBG(field_type);
 	if (bt_ctf_field_type_get_type_id(field_type) != BT_CTF_FIELD_TYPE_ID_INTEGER) {
 		/*
@@ -1909,7 +2315,6 @@ int _set_structure_field_integer(struct bt_ctf_field *structure, const char *nam
 	ret = !ret ? 1 : ret;
 end:
 	bt_ctf_object_put_ref(integer);
-	bt_ctf_object_put_ref(field_type);
 	return ret;
 }
 
@@ -69,6 +69,24 @@ int64_t bt_ctf_stream_common_get_id(struct bt_ctf_stream_common *stream)
 	return ret;
 }
 
+/* Event appended with bt_ctf_stream_append_packed_events() */
+struct bt_ctf_stream_packed_event {
+	/* Weak: part of the stream's class */
+	struct bt_ctf_event_class *event_class;
+
+	/* Value of the event header's `timestamp` field, if any */
+	uint64_t timestamp;
+
+	/* Offset of the packed payload within `packed_payloads` (bytes) */
+	guint payload_offset;
+
+	/*
+	 * Number of events of the stream's `events` array to write
+	 * before this packed event
+	 */
+	guint event_index;
+};
+
 struct bt_ctf_stream {
 	struct bt_ctf_stream_common common;
 	struct bt_ctf_field *packet_header;
@@ -76,6 +94,15 @@ struct bt_ctf_stream {
 
 	/* Array of pointers to bt_ctf_event for the current packet */
 	GPtrArray *events;
+
+	/*
+	 * Array of `struct bt_ctf_stream_packed_event` for the current
+	 * packet
+	 */
+	GArray *packed_events;
+
+	/* Packed payloads of `packed_events`, back to back */
+	GByteArray *packed_payloads;
 	struct bt_ctfser ctfser;
 	unsigned int flushed_packet_count;
 	uint64_t discarded_events;
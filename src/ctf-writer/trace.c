@@ -1702,21 +1702,25 @@ end:
 	return ret;
 }
 
+/*
+ * Appends an `env` block with the environment entries of `trace` from
+ * index `first_index`, if any.
+ */
 static
 void append_env_metadata(struct bt_ctf_trace *trace,
-		struct metadata_context *context)
+		struct metadata_context *context, int64_t first_index)
 {
 	int64_t i;
 	int64_t env_size;
 
 	env_size = bt_ctf_attributes_get_count(trace->common.environment);
-	if (env_size <= 0) {
+	if (env_size <= first_index) {
 		return;
 	}
 
 	g_string_append(context->string, "env {\n");
 
-	for (i = 0; i < env_size; i++) {
+	for (i = first_index; i < env_size; i++) {
 		struct bt_ctf_private_value *env_field_value_obj = NULL;
 		const char *entry_name;
 
@@ -1795,7 +1799,7 @@ char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace)
 		/* append_trace_metadata() logs errors */
 		goto error;
 	}
-	append_env_metadata(trace, context);
+	append_env_metadata(trace, context, 0);
 	g_ptr_array_foreach(trace->common.clock_classes,
 		(GFunc) bt_ctf_clock_class_serialize, context);
 
@@ -1820,6 +1824,201 @@ end:
 	return metadata;
 }
 
+BT_HIDDEN
+int bt_ctf_trace_metadata_state_init(struct bt_ctf_trace_metadata_state *state)
+{
+	int ret = 0;
+
+	state->is_incremental = false;
+	state->env_field_count = 0;
+	state->serialized_objects = g_hash_table_new(g_direct_hash,
+		g_direct_equal);
+	if (!state->serialized_objects) {
+		BT_LOGE_STR("Failed to allocate a GHashTable.");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_fini(struct bt_ctf_trace_metadata_state *state)
+{
+	if (state->serialized_objects) {
+		g_hash_table_destroy(state->serialized_objects);
+		state->serialized_objects = NULL;
+	}
+}
+
+/*
+ * Returns whether or not `obj` was already serialized according to
+ * `state`, adding it to `state` if it was not.
+ */
+static
+bool metadata_state_test_and_add(struct bt_ctf_trace_metadata_state *state,
+		void *obj)
+{
+	if (g_hash_table_contains(state->serialized_objects, obj)) {
+		return true;
+	}
+
+	g_hash_table_add(state->serialized_objects, obj);
+	return false;
+}
+
+static
+int append_new_stream_class_metadata(
+		struct bt_ctf_trace_metadata_state *state,
+		struct bt_ctf_stream_class *stream_class,
+		struct metadata_context *context)
+{
+	int ret = 0;
+	size_t i;
+
+	if (!metadata_state_test_and_add(state, stream_class)) {
+		/* bt_ctf_stream_class_serialize_block() logs details */
+		ret = bt_ctf_stream_class_serialize_block(stream_class,
+			context);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	for (i = 0; i < stream_class->common.event_classes->len; i++) {
+		struct bt_ctf_event_class *event_class =
+			stream_class->common.event_classes->pdata[i];
+
+		if (metadata_state_test_and_add(state, event_class)) {
+			continue;
+		}
+
+		ret = bt_ctf_event_class_serialize(event_class, context);
+		if (ret) {
+			BT_LOGW("Cannot serialize event class's metadata: "
+				"event-class-addr=%p, event-class-name=\"%s\", "
+				"event-class-id=%" PRId64,
+				event_class,
+				bt_ctf_event_class_get_name(event_class),
+				bt_ctf_event_class_get_id(event_class));
+			goto end;
+		}
+	}
+
+end:
+	context->current_indentation_level = 0;
+	return ret;
+}
+
+BT_HIDDEN
+char *bt_ctf_trace_get_metadata_string_increment(struct bt_ctf_trace *trace,
+		struct bt_ctf_trace_metadata_state *state, bool *is_full)
+{
+	char *metadata = NULL;
+	struct metadata_context *context = NULL;
+	int err = 0;
+	size_t i;
+
+	BT_ASSERT_DBG(trace);
+	BT_ASSERT_DBG(state);
+	BT_ASSERT_DBG(is_full);
+
+	if (!state->is_incremental) {
+		/*
+		 * The fragments serialized so far (if any) could be
+		 * stale: start over from the whole metadata. Once the
+		 * trace is frozen, the existing declarations cannot
+		 * change anymore, so that what follows is final.
+		 */
+		metadata = bt_ctf_trace_get_metadata_string(trace);
+		if (!metadata) {
+			goto end;
+		}
+
+		*is_full = true;
+		g_hash_table_remove_all(state->serialized_objects);
+		state->is_incremental = trace->common.frozen;
+		if (!state->is_incremental) {
+			goto end;
+		}
+
+		state->env_field_count = bt_ctf_attributes_get_count(
+			trace->common.environment);
+
+		for (i = 0; i < trace->common.clock_classes->len; i++) {
+			g_hash_table_add(state->serialized_objects,
+				trace->common.clock_classes->pdata[i]);
+		}
+
+		for (i = 0; i < trace->common.stream_classes->len; i++) {
+			struct bt_ctf_stream_class_common *stream_class =
+				trace->common.stream_classes->pdata[i];
+			size_t j;
+
+			g_hash_table_add(state->serialized_objects,
+				stream_class);
+
+			for (j = 0; j < stream_class->event_classes->len; j++) {
+				g_hash_table_add(state->serialized_objects,
+					stream_class->event_classes->pdata[j]);
+			}
+		}
+
+		goto end;
+	}
+
+	*is_full = false;
+	context = g_new0(struct metadata_context, 1);
+	if (!context) {
+		BT_LOGE_STR("Failed to allocate one metadata context.");
+		goto end;
+	}
+
+	context->field_name = g_string_sized_new(DEFAULT_IDENTIFIER_SIZE);
+	context->string = g_string_new(NULL);
+
+	/* New environment entries go in an additional `env` block */
+	append_env_metadata(trace, context, state->env_field_count);
+	state->env_field_count = bt_ctf_attributes_get_count(
+		trace->common.environment);
+
+	/*
+	 * New clock classes first, as new stream classes can refer to
+	 * them.
+	 */
+	for (i = 0; i < trace->common.clock_classes->len; i++) {
+		struct bt_ctf_clock_class *clock_class =
+			trace->common.clock_classes->pdata[i];
+
+		if (!metadata_state_test_and_add(state, clock_class)) {
+			bt_ctf_clock_class_serialize(clock_class, context);
+		}
+	}
+
+	for (i = 0; i < trace->common.stream_classes->len; i++) {
+		/* append_new_stream_class_metadata() logs errors */
+		err = append_new_stream_class_metadata(state,
+			trace->common.stream_classes->pdata[i], context);
+		if (err) {
+			/*
+			 * What's in `state` doesn't match what the
+			 * caller got anymore: start over next time.
+			 */
+			state->is_incremental = false;
+			goto error;
+		}
+	}
+
+	metadata = context->string->str;
+
+error:
+	g_string_free(context->string, err ? TRUE : FALSE);
+	g_string_free(context->field_name, TRUE);
+	g_free(context);
+
+end:
+	return metadata;
+}
+
 enum bt_ctf_byte_order bt_ctf_trace_get_native_byte_order(
 		struct bt_ctf_trace *trace)
 {
@@ -333,6 +333,41 @@ struct bt_ctf_trace {
 BT_HIDDEN
 char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace);
 
+struct bt_ctf_trace_metadata_state;
+
+BT_HIDDEN
+int bt_ctf_trace_metadata_state_init(struct bt_ctf_trace_metadata_state *state);
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_fini(struct bt_ctf_trace_metadata_state *state);
+
+/*
+ * bt_ctf_trace_get_metadata_string_increment: get new metadata string.
+ *
+ * Get the TSDL metadata fragments of the trace which `state` doesn't
+ * contain yet, and add them to `state`. The caller assumes the
+ * ownership of the returned string.
+ *
+ * As long as the trace is not frozen, its metadata may change, so
+ * this function returns the whole metadata and sets `*is_full` to
+ * true: the caller must replace what it previously got. Once the trace
+ * is frozen, the fragments it returns are final: the following calls
+ * only return the declarations (clock classes, stream classes, event
+ * classes, and environment entries) which were added since (possibly
+ * an empty string), which the caller must append. The first call
+ * after the trace is frozen returns the full metadata once more.
+ *
+ * @param trace Trace instance.
+ * @param state Serialization state.
+ * @param is_full Set to true if the returned string is the trace's
+ *	whole metadata.
+ *
+ * Returns the metadata string on success, NULL on error.
+ */
+BT_HIDDEN
+char *bt_ctf_trace_get_metadata_string_increment(struct bt_ctf_trace *trace,
+		struct bt_ctf_trace_metadata_state *state, bool *is_full);
+
 BT_HIDDEN
 struct bt_ctf_trace *bt_ctf_trace_create(void);
 
@@ -109,6 +109,10 @@ struct bt_ctf_writer *bt_ctf_writer_create(const char *path)
 		goto error_destroy;
 	}
 
+	if (bt_ctf_trace_metadata_state_init(&writer->metadata_state)) {
+		goto error_destroy;
+	}
+
 	writer->trace = bt_ctf_trace_create();
 	if (!writer->trace) {
 		goto error_destroy;
@@ -168,6 +172,8 @@ void bt_ctf_writer_destroy(struct bt_ctf_object *obj)
 		g_string_free(writer->path, TRUE);
 	}
 
+	bt_ctf_trace_metadata_state_fini(&writer->metadata_state);
+
 	if (writer->metadata_fd > 0) {
 		if (close(writer->metadata_fd)) {
 			perror("close");
@@ -306,37 +312,64 @@ end:
 	return metadata_string;
 }
 
+/*
+ * Once the trace is frozen, its existing metadata declarations cannot
+ * change: only the new ones are appended to the metadata file instead
+ * of rewriting it.
+ */
 void bt_ctf_writer_flush_metadata(struct bt_ctf_writer *writer)
 {
 	int ret;
 	char *metadata_string = NULL;
+	bool is_full;
+	size_t len;
 
 	if (!writer) {
 		goto end;
 	}
 
-	metadata_string = bt_ctf_trace_get_metadata_string(
-		writer->trace);
-	if (!metadata_string) {
+	if (!writer->metadata_state.serialized_objects) {
+		/* bt_ctf_writer_create() failed */
 		goto end;
 	}
 
-	if (lseek(writer->metadata_fd, 0, SEEK_SET) == (off_t)-1) {
-		perror("lseek");
+	metadata_string = bt_ctf_trace_get_metadata_string_increment(
+		writer->trace, &writer->metadata_state, &is_full);
+	if (!metadata_string) {
 		goto end;
 	}
 
-	if (ftruncate(writer->metadata_fd, 0)) {
-		perror("ftruncate");
+	len = strlen(metadata_string);
+	if (is_full) {
+		if (lseek(writer->metadata_fd, 0, SEEK_SET) == (off_t)-1) {
+			perror("lseek");
+			goto error;
+		}
+
+		if (ftruncate(writer->metadata_fd, 0)) {
+			perror("ftruncate");
+			goto error;
+		}
+	} else if (len == 0) {
+		/* Nothing new */
 		goto end;
+	} else if (lseek(writer->metadata_fd, 0, SEEK_END) == (off_t)-1) {
+		perror("lseek");
+		goto error;
 	}
 
-	ret = write(writer->metadata_fd, metadata_string,
-		strlen(metadata_string));
+	ret = write(writer->metadata_fd, metadata_string, len);
 	if (ret < 0) {
 		perror("write");
-		goto end;
+		goto error;
 	}
+
+	goto end;
+
+error:
+	/* Rewrite the whole file next time */
+	writer->metadata_state.is_incremental = false;
+
 end:
 	g_free(metadata_string);
 }
@@ -9,6 +9,8 @@
 
 #include <dirent.h>
 #include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include <babeltrace2-ctf-writer/trace.h>
@@ -24,12 +26,36 @@ struct metadata_context {
 	unsigned int current_indentation_level;
 };
 
+/*
+ * What bt_ctf_trace_get_metadata_string_increment() already serialized
+ * for a given trace.
+ */
+struct bt_ctf_trace_metadata_state {
+	/*
+	 * True if the fragments which were serialized so far are final,
+	 * that is, if the trace was frozen when they were serialized.
+	 */
+	bool is_incremental;
+
+	/* Number of environment entries serialized so far */
+	int64_t env_field_count;
+
+	/*
+	 * Clock classes, stream classes, and event classes (weak) which
+	 * were serialized so far
+	 */
+	GHashTable *serialized_objects;
+};
+
 struct bt_ctf_writer {
 	struct bt_ctf_object base;
 	int frozen; /* Protects attributes that can't be changed mid-trace */
 	struct bt_ctf_trace *trace;
 	GString *path;
 	int metadata_fd;
+
+	/* What's already written to the metadata file */
+	struct bt_ctf_trace_metadata_state metadata_state;
 };
 
 enum field_type_alias {
@@ -27,12 +27,53 @@
 #include "compat/unistd.h"
 #include "compat/fcntl.h"
 
+/*
+ * Maximum packet size increment (bytes): beyond this, the current
+ * packet grows linearly instead of doubling.
+ */
+#define MAX_PACKET_SIZE_INCREMENT_BYTES	(UINT64_C(64) * 1024 * 1024)
+
 static inline
-uint64_t get_packet_size_increment_bytes(struct bt_ctfser *ctfser)
+uint64_t get_min_packet_size_increment_bytes(struct bt_ctfser *ctfser)
 {
 	return bt_common_get_page_size(ctfser->log_level) * 8;
 }
 
+/*
+ * Returns by how much to grow the current packet: its current size,
+ * so that growing a packet to N bytes costs O(log N) remappings
+ * instead of O(N).
+ */
+static inline
+uint64_t get_packet_size_increment_bytes(struct bt_ctfser *ctfser)
+{
+	uint64_t incr = ctfser->cur_packet_size_bytes;
+	const uint64_t min_incr = get_min_packet_size_increment_bytes(ctfser);
+
+	if (incr < min_incr) {
+		incr = min_incr;
+	} else if (incr > MAX_PACKET_SIZE_INCREMENT_BYTES) {
+		incr = MAX_PACKET_SIZE_INCREMENT_BYTES;
+	}
+
+	return incr;
+}
+
+/*
+ * Returns the initial size of a new packet: the size of the previous
+ * packet, rounded up to a multiple of the page size, as consecutive
+ * packets of a stream usually have similar sizes.
+ */
+static inline
+uint64_t get_initial_packet_size_bytes(struct bt_ctfser *ctfser)
+{
+	const uint64_t min_size = get_min_packet_size_increment_bytes(ctfser);
+	uint64_t size = ALIGN(ctfser->prev_packet_size_bytes,
+		(uint64_t) bt_common_get_page_size(ctfser->log_level));
+
+	return size < min_size ? min_size : size;
+}
+
 static inline
 void mmap_align_ctfser(struct bt_ctfser *ctfser)
 {
@@ -123,6 +164,14 @@ int bt_ctfser_fini(struct bt_ctfser *ctfser)
 {
 	int ret = 0;
 
+	if (ctfser->is_suspended) {
+		/* Reopen the stream file to truncate it below */
+		ret = bt_ctfser_resume(ctfser);
+		if (ret) {
+			goto free_path;
+		}
+	}
+
 	if (ctfser->fd == -1) {
 		goto free_path;
 	}
@@ -176,6 +225,99 @@ end:
 	return ret;
 }
 
+BT_HIDDEN
+int bt_ctfser_suspend(struct bt_ctfser *ctfser)
+{
+	int ret = 0;
+
+	BT_ASSERT(ctfser);
+	BT_ASSERT(!ctfser->is_suspended);
+	BT_ASSERT(ctfser->fd >= 0);
+	BT_LOGD("Suspending serializer: path=\"%s\", fd=%d, "
+		"mmap-offset=%jd, cur-packet-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd,
+		(intmax_t) ctfser->mmap_offset,
+		ctfser->cur_packet_size_bytes);
+	ctfser->remap_on_resume = false;
+
+	if (ctfser->base_mma) {
+		/*
+		 * The mapping is shared: the current packet's contents
+		 * remain in the stream file.
+		 */
+		ret = munmap_align(ctfser->base_mma);
+		if (ret) {
+			BT_LOGE_ERRNO("Failed to unmap stream file",
+				": ret=%d, size-bytes=%" PRIu64,
+				ret, ctfser->stream_size_bytes);
+			goto end;
+		}
+
+		ctfser->base_mma = NULL;
+		ctfser->remap_on_resume = true;
+	}
+
+	ret = close(ctfser->fd);
+	if (ret) {
+		BT_LOGE_ERRNO("Failed to close stream file",
+			": ret=%d", ret);
+		goto end;
+	}
+
+	ctfser->fd = -1;
+	ctfser->is_suspended = true;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int bt_ctfser_resume(struct bt_ctfser *ctfser)
+{
+	int ret = 0;
+
+	BT_ASSERT(ctfser);
+	BT_ASSERT(ctfser->is_suspended);
+	BT_ASSERT(ctfser->fd == -1);
+	BT_LOGD("Resuming serializer: path=\"%s\", "
+		"mmap-offset=%jd, cur-packet-size-bytes=%" PRIu64,
+		ctfser->path->str, (intmax_t) ctfser->mmap_offset,
+		ctfser->cur_packet_size_bytes);
+
+	/* Do not truncate: the file contains what was written so far */
+	ctfser->fd = open(ctfser->path->str, O_RDWR);
+	if (ctfser->fd < 0) {
+		BT_LOGE_ERRNO("Failed to reopen stream file for writing",
+			": path=\"%s\", ret=%d",
+			ctfser->path->str, ctfser->fd);
+		ctfser->fd = -1;
+		ret = -1;
+		goto end;
+	}
+
+	ctfser->is_suspended = false;
+
+	if (ctfser->remap_on_resume) {
+		/*
+		 * The current packet's space is already allocated:
+		 * map it again at the same offset.
+		 */
+		mmap_align_ctfser(ctfser);
+		if (ctfser->base_mma == MAP_FAILED) {
+			BT_LOGE_ERRNO("Failed to perform an aligned memory mapping",
+				": ret=%d", ret);
+			ctfser->base_mma = NULL;
+			ret = -1;
+			goto end;
+		}
+
+		ctfser->remap_on_resume = false;
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 int bt_ctfser_open_packet(struct bt_ctfser *ctfser)
 {
@@ -199,16 +341,22 @@ int bt_ctfser_open_packet(struct bt_ctfser *ctfser)
 		ctfser->base_mma = NULL;
 	}
 
+	/* Make initial space for the current packet */
+	ctfser->cur_packet_size_bytes = get_initial_packet_size_bytes(ctfser);
+
 	/*
 	 * Add the previous packet's size to the memory map address
-	 * offset to start writing immediately after it.
+	 * offset to start writing immediately after it, unless it was
+	 * discarded.
 	 */
-	ctfser->mmap_offset += ctfser->prev_packet_size_bytes;
-	ctfser->prev_packet_size_bytes = 0;
+	if (ctfser->prev_packet_discarded) {
+		ctfser->mmap_offset = 0;
+		ctfser->prev_packet_discarded = false;
+	} else {
+		ctfser->mmap_offset += ctfser->prev_packet_size_bytes;
+	}
 
-	/* Make initial space for the current packet */
-	ctfser->cur_packet_size_bytes = get_packet_size_increment_bytes(
-		ctfser);
+	ctfser->prev_packet_size_bytes = 0;
 
 	do {
 		ret = bt_posix_fallocate(ctfser->fd, ctfser->mmap_offset,
@@ -266,3 +414,19 @@ void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		ctfser->path->str, ctfser->fd,
 		ctfser->stream_size_bytes);
 }
+
+BT_HIDDEN
+void bt_ctfser_discard_closed_packets(struct bt_ctfser *ctfser)
+{
+	BT_LOGD("Discarding closed packets: path=\"%s\", fd=%d, "
+		"stream-file-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd, ctfser->stream_size_bytes);
+
+	/*
+	 * Keep `ctfser->prev_packet_size_bytes` as is: the next call to
+	 * bt_ctfser_open_packet() uses it to size the next packet.
+	 */
+	ctfser->discarded_size_bytes += ctfser->stream_size_bytes;
+	ctfser->stream_size_bytes = 0;
+	ctfser->prev_packet_discarded = true;
+}
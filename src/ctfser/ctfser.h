@@ -14,6 +14,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <limits.h>
 #include "compat/mman.h"
@@ -52,10 +53,31 @@ struct bt_ctfser {
 	/* Current stream size (bytes) */
 	uint64_t stream_size_bytes;
 
+	/*
+	 * Total size (bytes) of the packets which
+	 * bt_ctfser_discard_closed_packets() discarded
+	 */
+	uint64_t discarded_size_bytes;
+
+	/*
+	 * True if bt_ctfser_discard_closed_packets() discarded the
+	 * previous packet: the next packet starts at the beginning of
+	 * the stream file.
+	 */
+	bool prev_packet_discarded;
+
 	/* Memory map base address */
 	struct mmap_align *base_mma;
 
-	/* Stream file's path (for debugging) */
+	/*
+	 * True if bt_ctfser_suspend() closed the stream file:
+	 * bt_ctfser_resume() must reopen it (and map the current packet
+	 * again if `remap_on_resume` is true) before writing anything.
+	 */
+	bool is_suspended;
+	bool remap_on_resume;
+
+	/* Stream file's path (for debugging and bt_ctfser_resume()) */
 	GString *path;
 
 	/* Serializer's log level */
@@ -80,6 +102,34 @@ int bt_ctfser_init(struct bt_ctfser *ctfser, const char *path,
 BT_HIDDEN
 int bt_ctfser_fini(struct bt_ctfser *ctfser);
 
+/*
+ * Suspends a CTF serializer.
+ *
+ * This function unmaps the current packet, if any, and closes the
+ * stream file, keeping all the serializer's offsets so that
+ * bt_ctfser_resume() can continue writing where it left off.
+ *
+ * This makes it possible for a user to keep more serializers than the
+ * number of file descriptors and memory maps it can have at once.
+ */
+BT_HIDDEN
+int bt_ctfser_suspend(struct bt_ctfser *ctfser);
+
+/*
+ * Resumes a CTF serializer which bt_ctfser_suspend() suspended.
+ *
+ * This function reopens the stream file, without truncating it, and
+ * maps the current packet again, if any.
+ */
+BT_HIDDEN
+int bt_ctfser_resume(struct bt_ctfser *ctfser);
+
+static inline
+bool bt_ctfser_is_suspended(struct bt_ctfser *ctfser)
+{
+	return ctfser->is_suspended;
+}
+
 /*
  * Opens a new packet.
  *
@@ -95,6 +145,20 @@ BT_HIDDEN
 void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		uint64_t packet_size_bytes);
 
+/*
+ * Discards the contents of the packets which `ctfser` closed so far,
+ * so that the next packet starts at the beginning of the stream file
+ * again.
+ *
+ * This makes the stream file a scratch buffer of which the size is
+ * the one of the largest packet, for a user which copies each closed
+ * packet elsewhere (see bt_ctfser_get_cur_packet_addr()).
+ * bt_ctfser_get_cur_packet_offset_bytes() still counts the discarded
+ * packets.
+ */
+BT_HIDDEN
+void bt_ctfser_discard_closed_packets(struct bt_ctfser *ctfser);
+
 BT_HIDDEN
 int _bt_ctfser_increase_cur_packet_size(struct bt_ctfser *ctfser);
 
@@ -501,42 +565,120 @@ int bt_ctfser_write_float64(struct bt_ctfser *ctfser, double value,
 }
 
 /*
- * Writes a C string, including the terminating null character, at the
- * current offset within the current packet.
+ * Makes sure that the current packet has room for `size_bits` more
+ * bits at the current offset, growing it as many times as needed.
  */
 static inline
-int bt_ctfser_write_string(struct bt_ctfser *ctfser, const char *value)
+int _bt_ctfser_ensure_space_left(struct bt_ctfser *ctfser,
+		uint64_t size_bits)
 {
 	int ret = 0;
-	const char *at = value;
+
+	while (G_UNLIKELY(!_bt_ctfser_has_space_left(ctfser, size_bits))) {
+		ret = _bt_ctfser_increase_cur_packet_size(ctfser);
+		if (G_UNLIKELY(ret)) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Reserves `len` bytes at the current offset, aligned to 8 bits,
+ * within the current packet, setting `*addr` to the address of the
+ * first reserved byte and moving the current offset past them.
+ *
+ * The caller must fill the reserved bytes before calling any other
+ * function on `ctfser`, as growing the current packet can move it in
+ * memory.
+ */
+static inline
+int bt_ctfser_reserve_bytes(struct bt_ctfser *ctfser, uint64_t len,
+		uint8_t **addr)
+{
+	int ret;
 
 	ret = bt_ctfser_align_offset_in_current_packet(ctfser, 8);
 	if (G_UNLIKELY(ret)) {
 		goto end;
 	}
 
-	while (true) {
-		if (G_UNLIKELY(!_bt_ctfser_has_space_left(ctfser, 8))) {
-			ret = _bt_ctfser_increase_cur_packet_size(ctfser);
-			if (G_UNLIKELY(ret)) {
-				goto end;
-			}
-		}
+	if (G_UNLIKELY(len > UINT64_MAX / 8)) {
+		ret = -1;
+		goto end;
+	}
 
-		memcpy(_bt_ctfser_get_addr(ctfser), at, sizeof(*at));
-		_bt_ctfser_incr_offset(ctfser, 8);
+	ret = _bt_ctfser_ensure_space_left(ctfser, len * 8);
+	if (G_UNLIKELY(ret)) {
+		goto end;
+	}
 
-		if (G_UNLIKELY(*at == '\0')) {
-			break;
-		}
+	*addr = _bt_ctfser_get_addr(ctfser);
+	_bt_ctfser_incr_offset(ctfser, len * 8);
+
+end:
+	return ret;
+}
 
-		at++;
+/*
+ * Writes the `len` bytes of `bytes` as is at the current offset,
+ * aligned to 8 bits, within the current packet.
+ */
+static inline
+int bt_ctfser_write_bytes(struct bt_ctfser *ctfser, const uint8_t *bytes,
+		uint64_t len)
+{
+	int ret;
+	uint8_t *addr;
+
+	ret = bt_ctfser_reserve_bytes(ctfser, len, &addr);
+	if (G_UNLIKELY(ret)) {
+		goto end;
 	}
 
+	memcpy(addr, bytes, len);
+
 end:
 	return ret;
 }
 
+/*
+ * Writes a C string, including the terminating null character, at the
+ * current offset within the current packet.
+ */
+static inline
+int bt_ctfser_write_string(struct bt_ctfser *ctfser, const char *value)
+{
+	return bt_ctfser_write_bytes(ctfser, (const uint8_t *) value,
+		strlen(value) + 1);
+}
+
+/*
+ * Returns the offset of the current packet within the stream file
+ * (bytes).
+ */
+static inline
+uint64_t bt_ctfser_get_cur_packet_offset_bytes(struct bt_ctfser *ctfser)
+{
+	return ctfser->discarded_size_bytes + (uint64_t) ctfser->mmap_offset;
+}
+
+/*
+ * Returns the address of the first byte of the current packet.
+ *
+ * After bt_ctfser_close_current_packet(), this remains valid, for the
+ * size which was passed to it, until the next call to
+ * bt_ctfser_open_packet().
+ */
+static inline
+const uint8_t *bt_ctfser_get_cur_packet_addr(struct bt_ctfser *ctfser)
+{
+	BT_ASSERT_DBG(ctfser->base_mma);
+	return ((const uint8_t *) mmap_align_addr(ctfser->base_mma)) +
+		ctfser->mmap_base_offset;
+}
+
 /*
  * Returns the current offset within the current packet (bits).
  */
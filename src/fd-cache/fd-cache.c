@@ -28,6 +28,23 @@ struct fd_handle_internal {
 	struct bt_fd_cache_handle fd_handle;
 	uint64_t ref_count;
 	struct file_key *key;
+
+	/* File size and modification time when the file was opened */
+	uint64_t size;
+	int64_t mtime;
+
+	/* Link within `idle_handles` of the cache, or `NULL` if in use */
+	GList *idle_link;
+};
+
+/*
+ * Identifies a specific version of a file for its memoized checksum: a
+ * file which is modified in place keeps its device and inode numbers.
+ */
+struct checksum_key {
+	struct file_key file_key;
+	uint64_t size;
+	int64_t mtime;
 };
 
 static
@@ -82,18 +99,96 @@ void file_key_destroy(gpointer data)
 	g_free(fk);
 }
 
+static
+guint checksum_key_hash(gconstpointer v)
+{
+	const struct checksum_key *ck = v;
+
+	return file_key_hash(&ck->file_key) ^ hash_uint64_t(ck->size) ^
+		hash_uint64_t((uint64_t) ck->mtime);
+}
+
+static
+gboolean checksum_key_equal(gconstpointer v1, gconstpointer v2)
+{
+	const struct checksum_key *ck1 = v1;
+	const struct checksum_key *ck2 = v2;
+
+	return file_key_equal(&ck1->file_key, &ck2->file_key) &&
+		ck1->size == ck2->size && ck1->mtime == ck2->mtime;
+}
+
+static
+void init_checksum_key(struct checksum_key *ck,
+		const struct fd_handle_internal *fd_internal)
+{
+	ck->file_key = *fd_internal->key;
+	ck->size = fd_internal->size;
+	ck->mtime = fd_internal->mtime;
+}
+
+/*
+ * Closes and removes the least recently used idle handles of `fdc`
+ * until there are no more than `max_idle_count` of them.
+ */
+static
+void evict_idle_handles(struct bt_fd_cache *fdc, uint64_t max_idle_count)
+{
+	while (fdc->idle_handles->length > max_idle_count) {
+		struct fd_handle_internal *fd_internal =
+			g_queue_pop_tail(fdc->idle_handles);
+		gboolean ret;
+
+		BT_ASSERT(fd_internal->ref_count == 0);
+		fd_internal->idle_link = NULL;
+
+		if (close(fd_internal->fd_handle.fd) == -1) {
+			BT_LOGE_ERRNO("Failed to close file descriptor",
+				": fd=%d", fd_internal->fd_handle.fd);
+		}
+
+		fd_internal->fd_handle.fd = -1;
+		ret = g_hash_table_remove(fdc->cache, fd_internal->key);
+		BT_ASSERT(ret);
+	}
+}
+
 BT_HIDDEN
 int bt_fd_cache_init(struct bt_fd_cache *fdc, int log_level)
 {
 	int ret = 0;
 
 	fdc->log_level = log_level;
+	fdc->max_idle_count = BT_FD_CACHE_DEFAULT_MAX_IDLE_COUNT;
+	fdc->revalidate_paths = true;
 	fdc->cache = g_hash_table_new_full(file_key_hash, file_key_equal,
 		file_key_destroy, (GDestroyNotify) fd_cache_handle_internal_destroy);
 	if (!fdc->cache) {
-		ret = -1;
+		goto error;
 	}
 
+	fdc->checksums = g_hash_table_new_full(checksum_key_hash,
+		checksum_key_equal, g_free, g_free);
+	if (!fdc->checksums) {
+		goto error;
+	}
+
+	fdc->idle_handles = g_queue_new();
+	if (!fdc->idle_handles) {
+		goto error;
+	}
+
+	fdc->path_keys = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, file_key_destroy);
+	if (!fdc->path_keys) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+end:
 	return ret;
 }
 
@@ -104,16 +199,52 @@ void bt_fd_cache_fini(struct bt_fd_cache *fdc)
 		goto end;
 	}
 
+	if (fdc->idle_handles) {
+		evict_idle_handles(fdc, 0);
+		g_queue_free(fdc->idle_handles);
+		fdc->idle_handles = NULL;
+	}
+
 	/*
 	 * All handle should have been removed for the hashtable at this point.
 	 */
 	BT_ASSERT(g_hash_table_size(fdc->cache) == 0);
 	g_hash_table_destroy(fdc->cache);
+	fdc->cache = NULL;
+
+	if (fdc->checksums) {
+		g_hash_table_destroy(fdc->checksums);
+		fdc->checksums = NULL;
+	}
+
+	if (fdc->path_keys) {
+		g_hash_table_destroy(fdc->path_keys);
+		fdc->path_keys = NULL;
+	}
 
 end:
 	return;
 }
 
+BT_HIDDEN
+void bt_fd_cache_set_max_idle_count(struct bt_fd_cache *fdc,
+		uint64_t max_idle_count)
+{
+	fdc->max_idle_count = max_idle_count;
+	evict_idle_handles(fdc, max_idle_count);
+}
+
+BT_HIDDEN
+void bt_fd_cache_set_revalidate_paths(struct bt_fd_cache *fdc,
+		bool revalidate_paths)
+{
+	fdc->revalidate_paths = revalidate_paths;
+
+	if (revalidate_paths) {
+		g_hash_table_remove_all(fdc->path_keys);
+	}
+}
+
 BT_HIDDEN
 struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		const char *path)
@@ -123,6 +254,23 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 	struct file_key fk;
 	int ret, fd = -1;
 
+	if (!fdc->revalidate_paths) {
+		const struct file_key *memo_key =
+			g_hash_table_lookup(fdc->path_keys, path);
+
+		/*
+		 * The memoized key of `path` is only useful if its handle
+		 * is still in the cache: otherwise, stat() the path as
+		 * usual.
+		 */
+		if (memo_key) {
+			fd_internal = g_hash_table_lookup(fdc->cache, memo_key);
+			if (fd_internal) {
+				goto found;
+			}
+		}
+	}
+
 	ret = stat(path, &statbuf);
 	if (ret < 0) {
 		/*
@@ -143,8 +291,22 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 	fk.dev = statbuf.st_dev;
 	fk.ino = statbuf.st_ino;
 
+	if (!fdc->revalidate_paths) {
+		struct file_key *memo_key = g_new0(struct file_key, 1);
+
+		*memo_key = fk;
+		g_hash_table_replace(fdc->path_keys, g_strdup(path), memo_key);
+	}
+
 	fd_internal = g_hash_table_lookup(fdc->cache, &fk);
-	if (!fd_internal) {
+	if (fd_internal && fd_internal->ref_count == 0) {
+		/*
+		 * The file of an idle handle may have been modified in
+		 * place since it was opened.
+		 */
+		fd_internal->size = statbuf.st_size;
+		fd_internal->mtime = statbuf.st_mtime;
+	} else if (!fd_internal) {
 		struct file_key *file_key;
 
 		fd = open(path, O_RDONLY);
@@ -159,8 +321,11 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 			goto error;
 		}
 
+		/* Closed by this function's error path, if needed */
+		fd_internal->fd_handle.fd = -1;
+
 		file_key = g_new0(struct file_key, 1);
-		if (!fd_internal) {
+		if (!file_key) {
 			BT_LOGE_STR("Failed to allocate file key.");
 			goto error;
 		}
@@ -170,11 +335,20 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		fd_internal->fd_handle.fd = fd;
 		fd_internal->ref_count = 0;
 		fd_internal->key = file_key;
+		fd_internal->size = statbuf.st_size;
+		fd_internal->mtime = statbuf.st_mtime;
 
 		/* Insert the newly created fd handle. */
 		g_hash_table_insert(fdc->cache, fd_internal->key, fd_internal);
 	}
 
+found:
+	if (fd_internal->idle_link) {
+		BT_ASSERT(fd_internal->ref_count == 0);
+		g_queue_delete_link(fdc->idle_handles, fd_internal->idle_link);
+		fd_internal->idle_link = NULL;
+	}
+
 	fd_internal->ref_count++;
 	goto end;
 
@@ -210,22 +384,53 @@ void bt_fd_cache_put_handle(struct bt_fd_cache *fdc,
 	fd_internal = (struct fd_handle_internal *) handle;
 
 	BT_ASSERT(fd_internal->ref_count > 0);
+	fd_internal->ref_count--;
 
-	if (fd_internal->ref_count > 1) {
-		fd_internal->ref_count--;
-	} else {
-		gboolean ret;
-		int close_ret;
-
-		close_ret = close(fd_internal->fd_handle.fd);
-		if (close_ret == -1) {
-			BT_LOGE_ERRNO("Failed to close file descriptor",
-				": fd=%d", fd_internal->fd_handle.fd);
-		}
-		ret = g_hash_table_remove(fdc->cache, fd_internal->key);
-		BT_ASSERT(ret);
+	if (fd_internal->ref_count == 0) {
+		/*
+		 * Keep the file descriptor open for a subsequent
+		 * bt_fd_cache_get_handle() call with the same file, closing
+		 * the least recently used idle one if there are too many.
+		 */
+		g_queue_push_head(fdc->idle_handles, fd_internal);
+		fd_internal->idle_link = fdc->idle_handles->head;
+		evict_idle_handles(fdc, fdc->max_idle_count);
 	}
 
 end:
 	return;
 }
+
+BT_HIDDEN
+bool bt_fd_cache_handle_get_checksum(struct bt_fd_cache *fdc,
+		struct bt_fd_cache_handle *handle, uint32_t *checksum)
+{
+	struct checksum_key ck;
+	const uint32_t *value;
+
+	BT_ASSERT(handle);
+	BT_ASSERT(checksum);
+	init_checksum_key(&ck, (struct fd_handle_internal *) handle);
+	value = g_hash_table_lookup(fdc->checksums, &ck);
+	if (!value) {
+		return false;
+	}
+
+	*checksum = *value;
+	return true;
+}
+
+BT_HIDDEN
+void bt_fd_cache_handle_set_checksum(struct bt_fd_cache *fdc,
+		struct bt_fd_cache_handle *handle, uint32_t checksum)
+{
+	struct checksum_key *ck;
+	uint32_t *value;
+
+	BT_ASSERT(handle);
+	ck = g_new0(struct checksum_key, 1);
+	value = g_new0(uint32_t, 1);
+	init_checksum_key(ck, (struct fd_handle_internal *) handle);
+	*value = checksum;
+	g_hash_table_insert(fdc->checksums, ck, value);
+}
@@ -9,8 +9,17 @@
 #ifndef BABELTRACE_FD_CACHE_INTERNAL_H
 #define BABELTRACE_FD_CACHE_INTERNAL_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "common/macros.h"
 
+/*
+ * Default maximum number of idle file descriptors (file descriptors
+ * which no handle references) which a cache keeps open.
+ */
+#define BT_FD_CACHE_DEFAULT_MAX_IDLE_COUNT	64
+
 struct bt_fd_cache_handle {
 	int fd;
 };
@@ -18,6 +27,31 @@ struct bt_fd_cache_handle {
 struct bt_fd_cache {
 	int log_level;
 	GHashTable *cache;
+
+	/*
+	 * Memoized checksums of files, kept after their handles are put
+	 * back (see bt_fd_cache_handle_get_checksum()).
+	 */
+	GHashTable *checksums;
+
+	/*
+	 * Internal handles which no handle references anymore, but of
+	 * which the file descriptor is still open, most recently put
+	 * back first.
+	 *
+	 * The cache closes the least recently used idle file descriptor
+	 * when there are more than `max_idle_count` of them.
+	 */
+	GQueue *idle_handles;
+	uint64_t max_idle_count;
+
+	/*
+	 * Path (`gchar *`, owned) to file key (`struct file_key *`, owned)
+	 * memo, used to find the handle of an already opened file without
+	 * stat()'ing its path when `revalidate_paths` is false.
+	 */
+	GHashTable *path_keys;
+	bool revalidate_paths;
 };
 
 static inline
@@ -32,6 +66,30 @@ int bt_fd_cache_init(struct bt_fd_cache *fdc, int log_level);
 BT_HIDDEN
 void bt_fd_cache_fini(struct bt_fd_cache *fdc);
 
+/*
+ * Sets the maximum number of idle file descriptors which `fdc` keeps
+ * open to `max_idle_count`, closing the least recently used ones
+ * beyond this limit.
+ *
+ * 0 means to close a file descriptor as soon as its last handle is put
+ * back.
+ */
+BT_HIDDEN
+void bt_fd_cache_set_max_idle_count(struct bt_fd_cache *fdc,
+		uint64_t max_idle_count);
+
+/*
+ * Sets whether or not bt_fd_cache_get_handle() stat()s the path of a
+ * file which `fdc` already knows to detect that it was replaced
+ * (true by default).
+ *
+ * Only disable this when the files can't be replaced while `fdc`
+ * exists.
+ */
+BT_HIDDEN
+void bt_fd_cache_set_revalidate_paths(struct bt_fd_cache *fdc,
+		bool revalidate_paths);
+
 BT_HIDDEN
 struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		const char *path);
@@ -40,4 +98,24 @@ BT_HIDDEN
 void bt_fd_cache_put_handle(struct bt_fd_cache *fdc,
 		struct bt_fd_cache_handle *handle);
 
+/*
+ * Sets `*checksum` to the checksum which a previous call to
+ * bt_fd_cache_handle_set_checksum() memoized for the file of `handle`,
+ * returning false if there's none.
+ *
+ * A memoized checksum is only valid for a given device number, inode
+ * number, size, and modification time of the file: modifying or
+ * replacing a file invalidates its memoized checksum.
+ */
+BT_HIDDEN
+bool bt_fd_cache_handle_get_checksum(struct bt_fd_cache *fdc,
+		struct bt_fd_cache_handle *handle, uint32_t *checksum);
+
+/*
+ * Memoizes the checksum `checksum` of the file of `handle`.
+ */
+BT_HIDDEN
+void bt_fd_cache_handle_set_checksum(struct bt_fd_cache *fdc,
+		struct bt_fd_cache_handle *handle, uint32_t checksum);
+
 #endif /* BABELTRACE_FD_CACHE_INTERNAL_H */
@@ -9,6 +9,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <pthread.h>
 #include <babeltrace2/babeltrace.h>
 
 #include "error.h"
@@ -26,6 +27,44 @@
 		bt_error_cause_actor_type_string(((const struct bt_error_cause *) (_cause))->actor_type), \
 		bt_error_cause_actor_type_string(_exp_type))
 
+/*
+ * Maximum number of destroyed error causes which a thread keeps, per
+ * actor type, to reuse them.
+ */
+#define ERROR_CAUSE_CACHE_SIZE		8
+
+/*
+ * A cached error cause of which the message buffer is larger than this
+ * is destroyed instead, so that a single huge message doesn't stay
+ * around for the lifetime of the thread.
+ */
+#define ERROR_CAUSE_CACHE_MAX_MSG_LEN	4096
+
+/*
+ * Per-thread cache of released error causes.
+ *
+ * Some components append error causes on expected failure paths and
+ * then clear the current thread's error, possibly once per message.
+ * Without this cache, each such cycle allocates and frees a cause
+ * object and its five to seven `GString` objects.
+ *
+ * A cached error cause keeps its `GString` objects (and therefore
+ * their buffers): creating an error cause from it only needs to assign
+ * its strings again.
+ */
+struct error_cause_cache {
+	/* Indexed with error_cause_cache_index() */
+	struct bt_error_cause *causes[4][ERROR_CAUSE_CACHE_SIZE];
+	unsigned int counts[4];
+};
+
+static __thread struct error_cause_cache *thread_cause_cache;
+
+/* Only used to destroy a thread's cache when the thread exits */
+static pthread_key_t cause_cache_key;
+static pthread_once_t cause_cache_key_once = PTHREAD_ONCE_INIT;
+static bool cause_cache_key_ok;
+
 static
 void fini_component_class_id(
 		struct bt_error_cause_component_class_id *comp_class_id)
@@ -125,6 +164,196 @@ end:
 	return;
 }
 
+static
+unsigned int error_cause_cache_index(enum bt_error_cause_actor_type actor_type)
+{
+	switch (actor_type) {
+	case BT_ERROR_CAUSE_ACTOR_TYPE_UNKNOWN:
+		return 0;
+	case BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT:
+		return 1;
+	case BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT_CLASS:
+		return 2;
+	case BT_ERROR_CAUSE_ACTOR_TYPE_MESSAGE_ITERATOR:
+		return 3;
+	default:
+		bt_common_abort();
+	}
+}
+
+static
+void destroy_error_cause_cache(void *data)
+{
+	struct error_cause_cache *cache = data;
+	unsigned int i, j;
+
+	for (i = 0; i < G_N_ELEMENTS(cache->causes); i++) {
+		for (j = 0; j < cache->counts[i]; j++) {
+			destroy_error_cause(cache->causes[i][j]);
+		}
+	}
+
+	g_free(cache);
+}
+
+static
+void create_cause_cache_key(void)
+{
+	cause_cache_key_ok = pthread_key_create(&cause_cache_key,
+		destroy_error_cause_cache) == 0;
+}
+
+/*
+ * Returns the current thread's error cause cache, creating it if
+ * needed, or `NULL` if it's not available.
+ */
+static
+struct error_cause_cache *borrow_error_cause_cache(void)
+{
+	struct error_cause_cache *cache = thread_cause_cache;
+
+	if (cache) {
+		goto end;
+	}
+
+	pthread_once(&cause_cache_key_once, create_cause_cache_key);
+
+	if (!cause_cache_key_ok) {
+		goto end;
+	}
+
+	cache = g_new0(struct error_cause_cache, 1);
+	if (!cache) {
+		goto end;
+	}
+
+	if (pthread_setspecific(cause_cache_key, cache)) {
+		g_free(cache);
+		cache = NULL;
+		goto end;
+	}
+
+	thread_cause_cache = cache;
+
+end:
+	return cache;
+}
+
+/*
+ * Returns a cached error cause having the actor type `actor_type`, of
+ * which all the strings exist and are empty, or `NULL` if there's none.
+ */
+static
+struct bt_error_cause *take_cached_error_cause(
+		enum bt_error_cause_actor_type actor_type)
+{
+	struct error_cause_cache *cache = thread_cause_cache;
+	struct bt_error_cause *cause = NULL;
+	unsigned int index;
+
+	if (!cache) {
+		goto end;
+	}
+
+	index = error_cause_cache_index(actor_type);
+
+	if (cache->counts[index] == 0) {
+		goto end;
+	}
+
+	cache->counts[index]--;
+	cause = cache->causes[index][cache->counts[index]];
+	BT_ASSERT_DBG(cause->actor_type == actor_type);
+
+end:
+	return cause;
+}
+
+static
+void reset_component_class_id(
+		struct bt_error_cause_component_class_id *comp_class_id)
+{
+	g_string_truncate(comp_class_id->name, 0);
+	g_string_truncate(comp_class_id->plugin_name, 0);
+}
+
+/*
+ * Destroys the complete error cause `cause` or, if possible, puts it
+ * into the current thread's cache for a future error cause to reuse.
+ */
+static
+void release_error_cause(struct bt_error_cause *cause)
+{
+	struct error_cause_cache *cache;
+	unsigned int index;
+
+	if (!cause) {
+		goto end;
+	}
+
+	if (cause->message->allocated_len > ERROR_CAUSE_CACHE_MAX_MSG_LEN) {
+		goto destroy;
+	}
+
+	cache = borrow_error_cause_cache();
+	if (!cache) {
+		goto destroy;
+	}
+
+	index = error_cause_cache_index(cause->actor_type);
+
+	if (cache->counts[index] == ERROR_CAUSE_CACHE_SIZE) {
+		goto destroy;
+	}
+
+	g_string_truncate(cause->module_name, 0);
+	g_string_truncate(cause->message, 0);
+	g_string_truncate(cause->file_name, 0);
+	cause->line_no = 0;
+
+	switch (cause->actor_type) {
+	case BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT:
+	{
+		struct bt_error_cause_component_actor *spec_cause =
+			(void *) cause;
+
+		g_string_truncate(spec_cause->comp_name, 0);
+		reset_component_class_id(&spec_cause->comp_class_id);
+		break;
+	}
+	case BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT_CLASS:
+	{
+		struct bt_error_cause_component_class_actor *spec_cause =
+			(void *) cause;
+
+		reset_component_class_id(&spec_cause->comp_class_id);
+		break;
+	}
+	case BT_ERROR_CAUSE_ACTOR_TYPE_MESSAGE_ITERATOR:
+	{
+		struct bt_error_cause_message_iterator_actor *spec_cause =
+			(void *) cause;
+
+		g_string_truncate(spec_cause->comp_name, 0);
+		g_string_truncate(spec_cause->output_port_name, 0);
+		reset_component_class_id(&spec_cause->comp_class_id);
+		break;
+	}
+	default:
+		break;
+	}
+
+	cache->causes[index][cache->counts[index]] = cause;
+	cache->counts[index]++;
+	goto end;
+
+destroy:
+	destroy_error_cause(cause);
+
+end:
+	return;
+}
+
 static
 int init_error_cause(struct bt_error_cause *cause,
 		enum bt_error_cause_actor_type actor_type)
@@ -163,21 +392,19 @@ end:
 
 static
 int init_component_class_id(
-		struct bt_error_cause_component_class_id *comp_class_id,
-		struct bt_component_class *comp_cls)
+		struct bt_error_cause_component_class_id *comp_class_id)
 {
 	int ret = 0;
 
 	BT_ASSERT(comp_class_id);
-	comp_class_id->type = comp_cls->type;
-	comp_class_id->name = g_string_new(comp_cls->name->str);
+	comp_class_id->name = g_string_new(NULL);
 	if (!comp_class_id->name) {
 		BT_LOGE_STR("Failed to allocate one GString.");
 		ret = -1;
 		goto end;
 	}
 
-	comp_class_id->plugin_name = g_string_new(comp_cls->plugin_name->str);
+	comp_class_id->plugin_name = g_string_new(NULL);
 	if (!comp_class_id->plugin_name) {
 		BT_LOGE_STR("Failed to allocate one GString.");
 		ret = -1;
@@ -188,6 +415,17 @@ end:
 	return ret;
 }
 
+static
+void set_component_class_id(
+		struct bt_error_cause_component_class_id *comp_class_id,
+		struct bt_component_class *comp_cls)
+{
+	BT_ASSERT(comp_class_id);
+	comp_class_id->type = comp_cls->type;
+	g_string_assign(comp_class_id->name, comp_cls->name->str);
+	g_string_assign(comp_class_id->plugin_name, comp_cls->plugin_name->str);
+}
+
 static
 void set_error_cause_props(struct bt_error_cause *cause,
 		const char *file_name, uint64_t line_no)
@@ -201,11 +439,16 @@ static
 struct bt_error_cause *create_error_cause(const char *module_name,
 		const char *file_name, uint64_t line_no)
 {
-	struct bt_error_cause *cause = g_new0(struct bt_error_cause, 1);
+	struct bt_error_cause *cause;
 	int ret;
 
 	BT_LOGD_STR("Creating error cause (unknown actor).");
+	cause = take_cached_error_cause(BT_ERROR_CAUSE_ACTOR_TYPE_UNKNOWN);
+	if (cause) {
+		goto set;
+	}
 
+	cause = g_new0(struct bt_error_cause, 1);
 	if (!cause) {
 		BT_LOGE_STR("Failed to allocate one error cause.");
 		goto error;
@@ -216,6 +459,7 @@ struct bt_error_cause *create_error_cause(const char *module_name,
 		goto error;
 	}
 
+set:
 	g_string_assign(cause->module_name, module_name);
 	set_error_cause_props(cause, file_name, line_no);
 	BT_LIB_LOGD("Created error cause: %!+r", cause);
@@ -264,12 +508,17 @@ struct bt_error_cause_component_actor *create_error_cause_component_actor(
 		struct bt_component *comp, const char *file_name,
 		uint64_t line_no)
 {
-	struct bt_error_cause_component_actor *cause =
-		g_new0(struct bt_error_cause_component_actor, 1);
+	struct bt_error_cause_component_actor *cause;
 	int ret;
 
 	BT_LOGD_STR("Creating error cause object (component actor).");
+	cause = (void *) take_cached_error_cause(
+		BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT);
+	if (cause) {
+		goto set;
+	}
 
+	cause = g_new0(struct bt_error_cause_component_actor, 1);
 	if (!cause) {
 		goto error;
 	}
@@ -280,18 +529,21 @@ struct bt_error_cause_component_actor *create_error_cause_component_actor(
 		goto error;
 	}
 
-	set_error_cause_props(&cause->base, file_name, line_no);
-	cause->comp_name = g_string_new(comp->name->str);
+	cause->comp_name = g_string_new(NULL);
 	if (!cause->comp_name) {
 		BT_LOGE_STR("Failed to allocate one GString.");
 		goto error;
 	}
 
-	ret = init_component_class_id(&cause->comp_class_id, comp->class);
+	ret = init_component_class_id(&cause->comp_class_id);
 	if (ret) {
 		goto error;
 	}
 
+set:
+	set_error_cause_props(&cause->base, file_name, line_no);
+	g_string_assign(cause->comp_name, comp->name->str);
+	set_component_class_id(&cause->comp_class_id, comp->class);
 	g_string_append_printf(cause->base.module_name, "%s: ",
 		comp->name->str);
 	append_component_class_id_str(cause->base.module_name,
@@ -312,12 +564,17 @@ struct bt_error_cause_component_class_actor *
 create_error_cause_component_class_actor(struct bt_component_class *comp_cls,
 		const char *file_name, uint64_t line_no)
 {
-	struct bt_error_cause_component_class_actor *cause =
-		g_new0(struct bt_error_cause_component_class_actor, 1);
+	struct bt_error_cause_component_class_actor *cause;
 	int ret;
 
 	BT_LOGD_STR("Creating error cause object (component class actor).");
+	cause = (void *) take_cached_error_cause(
+		BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT_CLASS);
+	if (cause) {
+		goto set;
+	}
 
+	cause = g_new0(struct bt_error_cause_component_class_actor, 1);
 	if (!cause) {
 		BT_LOGE_STR("Failed to allocate one error cause object.");
 		goto error;
@@ -329,12 +586,14 @@ create_error_cause_component_class_actor(struct bt_component_class *comp_cls,
 		goto error;
 	}
 
-	set_error_cause_props(&cause->base, file_name, line_no);
-	ret = init_component_class_id(&cause->comp_class_id, comp_cls);
+	ret = init_component_class_id(&cause->comp_class_id);
 	if (ret) {
 		goto error;
 	}
 
+set:
+	set_error_cause_props(&cause->base, file_name, line_no);
+	set_component_class_id(&cause->comp_class_id, comp_cls);
 	append_component_class_id_str(cause->base.module_name,
 		&cause->comp_class_id);
 	BT_LIB_LOGD("Created error cause object: %!+r", cause);
@@ -365,6 +624,12 @@ create_error_cause_message_iterator_actor(struct bt_message_iterator *iter,
 	 * message iterator.
 	 */
 	input_port_iter = (void *) iter;
+	cause = (void *) take_cached_error_cause(
+		BT_ERROR_CAUSE_ACTOR_TYPE_MESSAGE_ITERATOR);
+	if (cause) {
+		goto set;
+	}
+
 	cause = g_new0(struct bt_error_cause_message_iterator_actor, 1);
 	if (!cause) {
 		BT_LOGE_STR("Failed to allocate one error cause object.");
@@ -377,27 +642,31 @@ create_error_cause_message_iterator_actor(struct bt_message_iterator *iter,
 		goto error;
 	}
 
-	set_error_cause_props(&cause->base, file_name, line_no);
-	cause->comp_name = g_string_new(
-		input_port_iter->upstream_component->name->str);
+	cause->comp_name = g_string_new(NULL);
 	if (!cause->comp_name) {
 		BT_LOGE_STR("Failed to allocate one GString.");
 		goto error;
 	}
 
-	cause->output_port_name = g_string_new(
-		input_port_iter->upstream_port->name->str);
+	cause->output_port_name = g_string_new(NULL);
 	if (!cause->output_port_name) {
 		BT_LOGE_STR("Failed to allocate one GString.");
 		goto error;
 	}
 
-	ret = init_component_class_id(&cause->comp_class_id,
-		input_port_iter->upstream_component->class);
+	ret = init_component_class_id(&cause->comp_class_id);
 	if (ret) {
 		goto error;
 	}
 
+set:
+	set_error_cause_props(&cause->base, file_name, line_no);
+	g_string_assign(cause->comp_name,
+		input_port_iter->upstream_component->name->str);
+	g_string_assign(cause->output_port_name,
+		input_port_iter->upstream_port->name->str);
+	set_component_class_id(&cause->comp_class_id,
+		input_port_iter->upstream_component->class);
 	g_string_append_printf(cause->base.module_name, "%s (%s): ",
 		input_port_iter->upstream_component->name->str,
 		input_port_iter->upstream_port->name->str);
@@ -427,7 +696,7 @@ struct bt_error *bt_error_create(void)
 	}
 
 	error->causes = g_ptr_array_new_with_free_func(
-		(GDestroyNotify) destroy_error_cause);
+		(GDestroyNotify) release_error_cause);
 	if (!error->causes) {
 		BT_LOGE_STR("Failed to allocate one GPtrArray.");
 		goto error;
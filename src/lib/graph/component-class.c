@@ -16,6 +16,7 @@
 #include <glib.h>
 
 #include "component-class.h"
+#include "query-executor.h"
 #include "lib/func-status.h"
 #include "lib/graph/message-iterator-class.h"
 
@@ -72,6 +73,12 @@ void destroy_component_class(struct bt_object *obj)
 		class->destroy_listeners = NULL;
 	}
 
+	if (class->query_result_cache) {
+		bt_query_executor_destroy_result_cache(
+			class->query_result_cache);
+		class->query_result_cache = NULL;
+	}
+
 	if (bt_component_class_has_message_iterator_class(class)) {
 		struct bt_component_class_with_iterator_class *class_with_iter_class =
 			container_of(class, struct bt_component_class_with_iterator_class, parent);
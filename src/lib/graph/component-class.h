@@ -41,6 +41,12 @@ struct bt_component_class {
 	bool frozen;
 	struct bt_list_head node;
 	struct bt_plugin_so_shared_lib_handle *so_handle;
+
+	/*
+	 * Cached results of query operations (see query-executor.c),
+	 * created on first use; `NULL` if none.
+	 */
+	GHashTable *query_result_cache;
 };
 
 struct bt_component_class_with_iterator_class {
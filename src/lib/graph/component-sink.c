@@ -39,6 +39,9 @@ struct bt_component *bt_component_sink_create(
 		goto end;
 	}
 
+	sink->consume_weight = 1;
+	sink->consume_credit = 1;
+
 end:
 	return (void *) sink;
 }
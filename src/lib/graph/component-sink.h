@@ -9,6 +9,7 @@
 #define BABELTRACE_GRAPH_COMPONENT_SINK_INTERNAL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "common/macros.h"
 #include "compat/compiler.h"
@@ -17,9 +18,30 @@
 #include "component-class.h"
 #include "component.h"
 
+struct bt_graph_profile_entry;
+
 struct bt_component_sink {
 	struct bt_component parent;
 	bool graph_is_configured_method_called;
+
+	/*
+	 * Profile entry (owned by the graph), or `NULL` if the graph's
+	 * profiling is disabled.
+	 */
+	struct bt_graph_profile_entry *profile_entry;
+
+	/*
+	 * Maximum number of consecutive successful "consume" method
+	 * calls the graph makes before moving to the next sink
+	 * component (at least 1).
+	 */
+	uint64_t consume_weight;
+
+	/*
+	 * Number of consecutive "consume" method calls left in the
+	 * current turn of this sink component.
+	 */
+	uint64_t consume_credit;
 };
 
 BT_HIDDEN
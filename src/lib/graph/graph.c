@@ -88,7 +88,7 @@ void destroy_graph(struct bt_object *obj)
 	graph->config_state = BT_GRAPH_CONFIGURATION_STATE_DESTROYING;
 
 	if (graph->messages) {
-		g_ptr_array_free(graph->messages, TRUE);
+		g_hash_table_destroy(graph->messages);
 		graph->messages = NULL;
 	}
 
@@ -137,33 +137,11 @@ void destroy_graph(struct bt_object *obj)
 		graph->listeners.sink_input_port_added = NULL;
 	}
 
-	bt_object_pool_finalize(&graph->event_msg_pool);
-	bt_object_pool_finalize(&graph->packet_begin_msg_pool);
-	bt_object_pool_finalize(&graph->packet_end_msg_pool);
+	/* After the message iterators: they refer to profile entries */
+	bt_graph_profile_fini(&graph->profile);
 	g_free(graph);
 }
 
-static
-void destroy_message_event(struct bt_message *msg,
-		struct bt_graph *graph)
-{
-	bt_message_event_destroy(msg);
-}
-
-static
-void destroy_message_packet_begin(struct bt_message *msg,
-		struct bt_graph *graph)
-{
-	bt_message_packet_destroy(msg);
-}
-
-static
-void destroy_message_packet_end(struct bt_message *msg,
-		struct bt_graph *graph)
-{
-	bt_message_packet_destroy(msg);
-}
-
 static
 void notify_message_graph_is_destroyed(struct bt_message *msg)
 {
@@ -173,7 +151,6 @@ void notify_message_graph_is_destroyed(struct bt_message *msg)
 struct bt_graph *bt_graph_create(uint64_t mip_version)
 {
 	struct bt_graph *graph;
-	int ret;
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE("valid-mip-version",
@@ -252,41 +229,14 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 	}
 
 	bt_graph_add_interrupter(graph, graph->default_interrupter);
-	ret = bt_object_pool_initialize(&graph->event_msg_pool,
-		(bt_object_pool_new_object_func) bt_message_event_new,
-		(bt_object_pool_destroy_object_func) destroy_message_event,
-		graph);
-	if (ret) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to initialize event message pool: ret=%d",
-			ret);
-		goto error;
-	}
-
-	ret = bt_object_pool_initialize(&graph->packet_begin_msg_pool,
-		(bt_object_pool_new_object_func) bt_message_packet_beginning_new,
-		(bt_object_pool_destroy_object_func) destroy_message_packet_begin,
-		graph);
-	if (ret) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to initialize packet beginning message pool: ret=%d",
-			ret);
-		goto error;
-	}
-
-	ret = bt_object_pool_initialize(&graph->packet_end_msg_pool,
-		(bt_object_pool_new_object_func) bt_message_packet_end_new,
-		(bt_object_pool_destroy_object_func) destroy_message_packet_end,
-		graph);
-	if (ret) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to initialize packet end message pool: ret=%d",
-			ret);
+	graph->messages = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal,
+		(GDestroyNotify) notify_message_graph_is_destroyed, NULL);
+	if (!graph->messages) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one GHashTable.");
 		goto error;
 	}
 
-	graph->messages = g_ptr_array_new_with_free_func(
-		(GDestroyNotify) notify_message_graph_is_destroyed);
 	BT_LIB_LOGI("Created graph object: %!+g", graph);
 
 end:
@@ -444,7 +394,20 @@ int consume_graph_sink(struct bt_component_sink *comp)
 	sink_class = (void *) comp->parent.class;
 	BT_ASSERT_DBG(sink_class->methods.consume);
 	BT_LIB_LOGD("Calling user's consume method: %!+c", comp);
-	consume_status = sink_class->methods.consume((void *) comp);
+
+	if (G_UNLIKELY(comp->profile_entry)) {
+		struct bt_graph_profile *profile =
+			&bt_component_borrow_graph((void *) comp)->profile;
+		struct bt_graph_profile_frame frame;
+		bool is_timed = bt_graph_profile_begin_call(profile, &frame);
+
+		consume_status = sink_class->methods.consume((void *) comp);
+		bt_graph_profile_end_call(profile, comp->profile_entry,
+			&frame, is_timed, 0);
+	} else {
+		consume_status = sink_class->methods.consume((void *) comp);
+	}
+
 	BT_LOGD("User method returned: status=%s",
 		bt_common_func_status_string(consume_status));
 	BT_ASSERT_POST_DEV(CONSUME_METHOD_NAME, "valid-status",
@@ -480,6 +443,11 @@ end:
  * `node` is removed from the queue of sinks to consume when passed to
  * this function. This function adds it back to the queue if there's
  * still something to consume afterwards.
+ *
+ * The sink keeps its place at the head of the queue until it has
+ * successfully consumed `consume_weight` consecutive times: it goes
+ * to the tail of the queue once its credit is exhausted or as soon as
+ * it returns anything else than `BT_FUNC_STATUS_OK`.
  */
 static inline
 int consume_sink_node(struct bt_graph *graph, GList *node)
@@ -490,7 +458,16 @@ int consume_sink_node(struct bt_graph *graph, GList *node)
 	sink = node->data;
 	status = consume_graph_sink(sink);
 	if (G_UNLIKELY(status != BT_FUNC_STATUS_END)) {
-		g_queue_push_tail_link(graph->sinks_to_consume, node);
+		BT_ASSERT_DBG(sink->consume_credit > 0);
+		sink->consume_credit--;
+
+		if (status == BT_FUNC_STATUS_OK && sink->consume_credit > 0) {
+			g_queue_push_head_link(graph->sinks_to_consume, node);
+		} else {
+			sink->consume_credit = sink->consume_weight;
+			g_queue_push_tail_link(graph->sinks_to_consume, node);
+		}
+
 		goto end;
 	}
 
@@ -601,6 +578,16 @@ int configure_graph(struct bt_graph *graph, const char *api_func)
 			continue;
 		}
 
+		if (graph->profile.enabled && !comp_sink->profile_entry) {
+			comp_sink->profile_entry =
+				bt_graph_profile_create_entry(&graph->profile,
+					comp->name->str, NULL);
+			if (!comp_sink->profile_entry) {
+				status = BT_FUNC_STATUS_MEMORY_ERROR;
+				goto end;
+			}
+		}
+
 		if (comp_sink->graph_is_configured_method_called) {
 			continue;
 		}
@@ -673,25 +660,29 @@ end:
 	return status;
 }
 
-enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
+/*
+ * Runs `graph` until all its sinks are ended, an error occurs, a sink
+ * returns "try again" while it's the only one left, the graph is
+ * interrupted, or the monotonic time reaches `deadline_us` (if not
+ * negative).
+ *
+ * The caller checks the preconditions and makes sure that the graph
+ * can't be consumed recursively.
+ */
+static
+int run_graph(struct bt_graph *graph, gint64 deadline_us,
+		const char *api_func)
 {
-	enum bt_graph_run_status status;
+	int status;
 
-	BT_ASSERT_PRE_NO_ERROR();
-	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
-	BT_ASSERT_PRE("graph-can-consume", graph->can_consume,
-		"Cannot consume graph in its current state: %!+g", graph);
-	BT_ASSERT_PRE("graph-is-not-faulty",
-		graph->config_state != BT_GRAPH_CONFIGURATION_STATE_FAULTY,
-		"Graph is in a faulty state: %!+g", graph);
-	bt_graph_set_can_consume(graph, false);
-	status = configure_graph(graph, __func__);
+	status = configure_graph(graph, api_func);
 	if (G_UNLIKELY(status)) {
 		/* configure_graph() logs errors */
 		goto end;
 	}
 
-	BT_LIB_LOGI("Running graph: %!+g", graph);
+	BT_LIB_LOGI("Running graph: %![graph-]+g, deadline-us=%" PRId64,
+		graph, (int64_t) deadline_us);
 
 	do {
 		/*
@@ -707,7 +698,7 @@ enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
 			goto end;
 		}
 
-		status = consume_no_check(graph, __func__);
+		status = consume_no_check(graph, api_func);
 		if (G_UNLIKELY(status == BT_FUNC_STATUS_AGAIN)) {
 			/*
 			 * If AGAIN is received and there are multiple
@@ -724,6 +715,14 @@ enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
 				status = BT_FUNC_STATUS_OK;
 			}
 		}
+
+		if (deadline_us >= 0 && status == BT_FUNC_STATUS_OK &&
+				g_get_monotonic_time() >= deadline_us) {
+			BT_LIB_LOGI("Stopping the graph: "
+				"run duration elapsed: %!+g", graph);
+			status = BT_FUNC_STATUS_AGAIN;
+			goto end;
+		}
 	} while (status == BT_FUNC_STATUS_OK);
 
 	if (status == BT_FUNC_STATUS_END) {
@@ -740,10 +739,78 @@ enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
 end:
 	BT_LIB_LOGI("Graph ran: %![graph-]+g, status=%s", graph,
 		bt_common_func_status_string(status));
+	return status;
+}
+
+enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
+{
+	enum bt_graph_run_status status;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-can-consume", graph->can_consume,
+		"Cannot consume graph in its current state: %!+g", graph);
+	BT_ASSERT_PRE("graph-is-not-faulty",
+		graph->config_state != BT_GRAPH_CONFIGURATION_STATE_FAULTY,
+		"Graph is in a faulty state: %!+g", graph);
+	bt_graph_set_can_consume(graph, false);
+	status = run_graph(graph, -1, __func__);
+	bt_graph_set_can_consume(graph, true);
+	return status;
+}
+
+enum bt_graph_run_status bt_graph_run_for(struct bt_graph *graph,
+		uint64_t duration_us)
+{
+	enum bt_graph_run_status status;
+	gint64 deadline_us;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-can-consume", graph->can_consume,
+		"Cannot consume graph in its current state: %!+g", graph);
+	BT_ASSERT_PRE("graph-is-not-faulty",
+		graph->config_state != BT_GRAPH_CONFIGURATION_STATE_FAULTY,
+		"Graph is in a faulty state: %!+g", graph);
+	deadline_us = g_get_monotonic_time();
+
+	if (duration_us > (uint64_t) (G_MAXINT64 - deadline_us)) {
+		deadline_us = G_MAXINT64;
+	} else {
+		deadline_us += (gint64) duration_us;
+	}
+
+	bt_graph_set_can_consume(graph, false);
+	status = run_graph(graph, deadline_us, __func__);
 	bt_graph_set_can_consume(graph, true);
 	return status;
 }
 
+void bt_graph_set_sink_component_consume_weight(struct bt_graph *graph,
+		const struct bt_component_sink *sink, uint64_t weight)
+{
+	struct bt_component_sink *mut_sink = (void *) sink;
+
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE_COMP_NON_NULL(sink);
+	BT_ASSERT_PRE("sink-component-belongs-to-graph",
+		bt_component_borrow_graph((void *) sink) == graph,
+		"Sink component does not belong to the graph: "
+		"%![graph-]+g, %![comp-]+c", graph, sink);
+	BT_ASSERT_PRE("weight-is-not-zero", weight > 0,
+		"Consume weight is 0: %![comp-]+c", sink);
+	mut_sink->consume_weight = weight;
+
+	/* Apply the new weight from the sink's next turn */
+	if (mut_sink->consume_credit > weight) {
+		mut_sink->consume_credit = weight;
+	}
+
+	BT_LIB_LOGD("Set sink component's consume weight: "
+		"%![graph-]+g, %![comp-]+c, weight=%" PRIu64,
+		graph, sink, weight);
+}
+
 enum bt_graph_add_listener_status
 bt_graph_add_source_component_output_port_added_listener(
 		struct bt_graph *graph,
@@ -1288,18 +1355,38 @@ void bt_graph_add_message(struct bt_graph *graph,
 	 * It's okay not to take a reference because, when a
 	 * message's reference count drops to 0, either:
 	 *
-	 * * It is recycled back to one of this graph's pool.
+	 * * It is recycled back to the pools of its message iterator.
 	 * * It is destroyed because it doesn't have any link to any
 	 *   graph, which means the original graph is already destroyed.
 	 */
-	g_ptr_array_add(graph->messages, msg);
+	g_hash_table_insert(graph->messages, msg, msg);
+}
+
+/*
+ * Called when message pools destroy a message instead of recycling it
+ * (see `struct bt_message_pools`), possibly during graph destruction
+ * (in which case `graph->messages` is already gone).
+ */
+BT_HIDDEN
+void bt_graph_remove_message(struct bt_graph *graph,
+		struct bt_message *msg)
+{
+	BT_ASSERT(graph);
+	BT_ASSERT(msg);
+
+	if (graph->messages) {
+		g_hash_table_remove(graph->messages, msg);
+	}
 }
 
 BT_HIDDEN
 bool bt_graph_is_interrupted(const struct bt_graph *graph)
 {
+	struct bt_graph *mut_graph = (void *) graph;
+
 	BT_ASSERT_DBG(graph);
-	return bt_interrupter_array_any_is_set(graph->interrupters);
+	return bt_interrupter_array_any_is_set_cached(graph->interrupters,
+		&mut_graph->interrupters_cache);
 }
 
 enum bt_graph_add_interrupter_status bt_graph_add_interrupter(
@@ -1310,6 +1397,7 @@ enum bt_graph_add_interrupter_status bt_graph_add_interrupter(
 	BT_ASSERT_PRE_INTR_NON_NULL(intr);
 	g_ptr_array_add(graph->interrupters, (void *) intr);
 	bt_object_get_ref_no_null_check(intr);
+	bt_interrupter_array_cache_invalidate(&graph->interrupters_cache);
 	BT_LIB_LOGD("Added interrupter to graph: %![graph-]+g, %![intr-]+z",
 		graph, intr);
 	return BT_FUNC_STATUS_OK;
@@ -1321,6 +1409,55 @@ struct bt_interrupter *bt_graph_borrow_default_interrupter(bt_graph *graph)
 	return graph->default_interrupter;
 }
 
+enum bt_graph_enable_profiling_status bt_graph_enable_profiling(
+		struct bt_graph *graph, uint64_t sampling_period)
+{
+	enum bt_graph_enable_profiling_status status;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-is-not-configured",
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	BT_ASSERT_PRE("sampling-period-is-not-zero", sampling_period > 0,
+		"Sampling period is 0.");
+
+	if (bt_graph_profile_enable(&graph->profile, sampling_period)) {
+		status = BT_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	BT_LIB_LOGI("Enabled graph profiling: %![graph-]+g, "
+		"sampling-period=%" PRIu64, graph, sampling_period);
+	status = BT_FUNC_STATUS_OK;
+
+end:
+	return status;
+}
+
+enum bt_graph_get_profile_status bt_graph_get_profile(
+		const struct bt_graph *graph, const struct bt_value **profile)
+{
+	enum bt_graph_get_profile_status status;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE_NON_NULL("profile-output", profile,
+		"Profile (output)");
+	BT_ASSERT_PRE("graph-profiling-is-enabled", graph->profile.enabled,
+		"Graph profiling is not enabled: %!+g", graph);
+	*profile = bt_graph_profile_to_value(&graph->profile);
+	if (!*profile) {
+		status = BT_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	status = BT_FUNC_STATUS_OK;
+
+end:
+	return status;
+}
+
 void bt_graph_get_ref(const struct bt_graph *graph)
 {
 	bt_object_get_ref(graph);
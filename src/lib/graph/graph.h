@@ -27,6 +27,8 @@
 #include "component.h"
 #include "component-sink.h"
 #include "connection.h"
+#include "interrupter.h"
+#include "profile.h"
 #include "lib/func-status.h"
 
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
@@ -82,6 +84,12 @@ struct bt_graph {
 	 */
 	GPtrArray *interrupters;
 
+	/*
+	 * Cached result of checking whether or not any interrupter of
+	 * `interrupters` is set (see bt_graph_is_interrupted()).
+	 */
+	struct bt_interrupter_array_cache interrupters_cache;
+
 	/*
 	 * Default interrupter, owned by this.
 	 */
@@ -110,30 +118,30 @@ struct bt_graph {
 		GArray *sink_input_port_added;
 	} listeners;
 
-	/* Pool of `struct bt_message_event *` */
-	struct bt_object_pool event_msg_pool;
-
-	/* Pool of `struct bt_message_packet_beginning *` */
-	struct bt_object_pool packet_begin_msg_pool;
-
-	/* Pool of `struct bt_message_packet_end *` */
-	struct bt_object_pool packet_end_msg_pool;
-
 	/*
-	 * Array of `struct bt_message *` (weak).
+	 * Set of `struct bt_message *` (weak).
 	 *
-	 * This is an array of all the messages ever created from
-	 * this graph. Some of them can be in one of the pools above,
-	 * some of them can be at large. Because each message has a
-	 * weak pointer to the graph containing its pool, we need to
-	 * notify each message that the graph is gone on graph
-	 * destruction.
+	 * This is a set of all the existing messages created from
+	 * this graph. Some of them can be in the message pools of a
+	 * message iterator (see `struct bt_message_pools`), some of
+	 * them can be at large. Because each message has a weak pointer
+	 * to its graph, we need to notify each message that the graph
+	 * is gone on graph destruction.
 	 *
-	 * TODO: When we support a maximum size for object pools,
-	 * add a way for a message to remove itself from this
-	 * array (on destruction).
+	 * When message pools destroy a message instead of recycling it
+	 * (the pool is at its high-water mark, or its message iterator
+	 * is finalized), the message is removed from this set.
 	 */
-	GPtrArray *messages;
+	GHashTable *messages;
+
+	/* See bt_graph_enable_profiling() */
+	struct bt_graph_profile profile;
+
+	/*
+	 * Next stream data key to assign to a message iterator (see
+	 * `struct bt_message_iterator`).
+	 */
+	uint64_t next_msg_iter_stream_data_key;
 };
 
 static inline
@@ -159,6 +167,10 @@ BT_HIDDEN
 void bt_graph_add_message(struct bt_graph *graph,
 		struct bt_message *msg);
 
+BT_HIDDEN
+void bt_graph_remove_message(struct bt_graph *graph,
+		struct bt_message *msg);
+
 BT_HIDDEN
 bool bt_graph_is_interrupted(const struct bt_graph *graph);
 
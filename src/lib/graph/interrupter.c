@@ -14,6 +14,9 @@
 #include "interrupter.h"
 #include "lib/assert-cond.h"
 
+BT_HIDDEN
+gint bt_interrupter_generation;
+
 static
 void destroy_interrupter(struct bt_object *obj)
 {
@@ -45,12 +48,14 @@ void bt_interrupter_set(struct bt_interrupter *intr)
 {
 	BT_ASSERT_PRE_INTR_NON_NULL(intr);
 	intr->is_set = true;
+	g_atomic_int_inc(&bt_interrupter_generation);
 }
 
 void bt_interrupter_reset(struct bt_interrupter *intr)
 {
 	BT_ASSERT_PRE_INTR_NON_NULL(intr);
 	intr->is_set = false;
+	g_atomic_int_inc(&bt_interrupter_generation);
 }
 
 bt_bool bt_interrupter_is_set(const struct bt_interrupter *intr)
@@ -19,6 +19,39 @@ struct bt_interrupter {
 	bool is_set;
 };
 
+/*
+ * Incremented (atomically) each time any interrupter is set or reset.
+ *
+ * This makes it possible to cache the result of
+ * bt_interrupter_array_any_is_set() until any interrupter changes
+ * without each interrupter knowing which arrays contain it: an
+ * interrupter may belong to many graphs and query executors, and
+ * bt_interrupter_set() must remain async-signal-safe.
+ */
+BT_HIDDEN
+extern gint bt_interrupter_generation;
+
+/*
+ * Cached result of bt_interrupter_array_any_is_set() for a given
+ * interrupter array.
+ */
+struct bt_interrupter_array_cache {
+	/* Value of `bt_interrupter_generation` when `is_set` was computed */
+	gint generation;
+
+	/* False if `is_set` needs to be recomputed anyway */
+	bool valid;
+
+	bool is_set;
+};
+
+static inline
+void bt_interrupter_array_cache_invalidate(
+		struct bt_interrupter_array_cache *cache)
+{
+	cache->valid = false;
+}
+
 static inline
 bool bt_interrupter_array_any_is_set(const GPtrArray *interrupters)
 {
@@ -40,4 +73,31 @@ end:
 	return is_set;
 }
 
+/*
+ * Like bt_interrupter_array_any_is_set(), but only iterates
+ * `interrupters` when any interrupter was set or reset since the last
+ * call with `cache`.
+ *
+ * The generation is read before iterating `interrupters`: if an
+ * interrupter is set while iterating, the next call sees a new
+ * generation and iterates again.
+ */
+static inline
+bool bt_interrupter_array_any_is_set_cached(const GPtrArray *interrupters,
+		struct bt_interrupter_array_cache *cache)
+{
+	gint generation = g_atomic_int_get(&bt_interrupter_generation);
+
+	if (G_LIKELY(cache->valid && cache->generation == generation)) {
+		goto end;
+	}
+
+	cache->is_set = bt_interrupter_array_any_is_set(interrupters);
+	cache->generation = generation;
+	cache->valid = true;
+
+end:
+	return cache->is_set;
+}
+
 #endif /* BABELTRACE_GRAPH_INTERRUPTER_INTERNAL_H */
@@ -18,6 +18,8 @@
 #include <babeltrace2/trace-ir/packet.h>
 #include "lib/trace-ir/packet.h"
 #include "lib/trace-ir/stream.h"
+#include "lib/trace-ir/stream-class.h"
+#include "lib/trace-ir/utils.h"
 #include <babeltrace2/trace-ir/clock-class.h>
 #include <babeltrace2/trace-ir/stream-class.h>
 #include <babeltrace2/trace-ir/stream.h>
@@ -30,6 +32,7 @@
 #include <babeltrace2/graph/message-iterator.h>
 #include <babeltrace2/types.h>
 #include "common/assert.h"
+#include "common/probes.h"
 #include "lib/assert-cond.h"
 #include <stdint.h>
 #include <inttypes.h>
@@ -45,19 +48,15 @@
 #include "message-iterator-class.h"
 #include "message/discarded-items.h"
 #include "message/event.h"
+#include "message/event-batch.h"
 #include "message/iterator.h"
 #include "message/message.h"
 #include "message/message-iterator-inactivity.h"
 #include "message/stream.h"
 #include "message/packet.h"
+#include "message/pools.h"
 #include "lib/func-status.h"
 
-/*
- * TODO: Use graph's state (number of active iterators, etc.) and
- * possibly system specifications to make a better guess than this.
- */
-#define MSG_BATCH_SIZE	15
-
 #define BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(_iter)			\
 	BT_ASSERT_PRE("has-state-to-seek",				\
 		(_iter)->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE ||	\
@@ -120,6 +119,11 @@ void bt_message_iterator_destroy(struct bt_object *obj)
 		iterator->auto_seek.msgs = NULL;
 	}
 
+	if (iterator->seek_checkpoint.stream_states) {
+		g_hash_table_destroy(iterator->seek_checkpoint.stream_states);
+		iterator->seek_checkpoint.stream_states = NULL;
+	}
+
 	if (iterator->upstream_msg_iters) {
 		/*
 		 * At this point the message iterator is finalized, so
@@ -229,6 +233,15 @@ void bt_message_iterator_try_finalize(
 		BT_ASSERT(existed);
 	}
 
+	/*
+	 * Orphan the message pools: the messages still at large are
+	 * destroyed instead of being recycled from now on.
+	 */
+	if (iterator->msg_pools) {
+		bt_message_pools_orphan(iterator->msg_pools);
+		iterator->msg_pools = NULL;
+	}
+
 	iterator->upstream_component = NULL;
 	iterator->upstream_port = NULL;
 	set_msg_iterator_state(iterator,
@@ -339,7 +352,11 @@ int create_self_component_input_port_message_iterator(
 		goto error;
 	}
 
-	g_ptr_array_set_size(iterator->msgs, MSG_BATCH_SIZE);
+	g_ptr_array_set_size(iterator->msgs,
+		BT_MESSAGE_ITERATOR_DEFAULT_BATCH_SIZE);
+	iterator->batch.size = BT_MESSAGE_ITERATOR_DEFAULT_BATCH_SIZE;
+	iterator->config.max_batch_size =
+		BT_MESSAGE_ITERATOR_DEFAULT_BATCH_SIZE;
 	iterator->last_ns_from_origin = INT64_MIN;
 	iterator->auto_seek.msgs = g_queue_new();
 	if (!iterator->auto_seek.msgs) {
@@ -359,6 +376,25 @@ int create_self_component_input_port_message_iterator(
 	iterator->upstream_port = upstream_port;
 	iterator->connection = iterator->upstream_port->connection;
 	iterator->graph = bt_component_borrow_graph(upstream_comp);
+	iterator->stream_data_key =
+		++iterator->graph->next_msg_iter_stream_data_key;
+	iterator->msg_pools = bt_message_pools_create(iterator->graph);
+	if (!iterator->msg_pools) {
+		/* bt_message_pools_create() logs errors */
+		status = BT_FUNC_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	if (iterator->graph->profile.enabled) {
+		iterator->profile_entry = bt_graph_profile_create_entry(
+			&iterator->graph->profile, upstream_comp->name->str,
+			upstream_port->name->str);
+		if (!iterator->profile_entry) {
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+	}
+
 	set_msg_iterator_state(iterator,
 		BT_MESSAGE_ITERATOR_STATE_NON_INITIALIZED);
 
@@ -502,6 +538,35 @@ void bt_self_message_iterator_set_data(
 		"%!+i, user-data-addr=%p", iterator, data);
 }
 
+void bt_self_message_iterator_set_stream_data(
+		struct bt_self_message_iterator *self_iterator,
+		const struct bt_stream *stream, void *data)
+{
+	struct bt_message_iterator *iterator =
+		(void *) self_iterator;
+
+	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
+	BT_ASSERT_PRE_DEV_STREAM_NON_NULL(stream);
+	bt_stream_set_msg_iter_data((void *) stream,
+		iterator->stream_data_key, data);
+	BT_LIB_LOGD("Set message iterator's stream data: "
+		"%![msg-iter-]+i, %![stream-]+s, data-addr=%p",
+		iterator, stream, data);
+}
+
+void *bt_self_message_iterator_get_stream_data(
+		const struct bt_self_message_iterator *self_iterator,
+		const struct bt_stream *stream)
+{
+	const struct bt_message_iterator *iterator =
+		(const void *) self_iterator;
+
+	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
+	BT_ASSERT_PRE_DEV_STREAM_NON_NULL(stream);
+	return bt_stream_get_msg_iter_data(stream,
+		iterator->stream_data_key);
+}
+
 void bt_self_message_iterator_configuration_set_can_seek_forward(
 		bt_self_message_iterator_configuration *config,
 		bt_bool can_seek_forward)
@@ -514,6 +579,24 @@ void bt_self_message_iterator_configuration_set_can_seek_forward(
 	config->can_seek_forward = can_seek_forward;
 }
 
+void bt_self_message_iterator_configuration_set_max_batch_size(
+		bt_self_message_iterator_configuration *config,
+		uint64_t max_batch_size)
+{
+	BT_ASSERT_PRE_NON_NULL("message-iterator-configuration", config,
+		"Message iterator configuration");
+	BT_ASSERT_PRE_DEV_HOT("message-iterator-configuration", config,
+		"Message iterator configuration", "");
+	BT_ASSERT_PRE("max-batch-size-is-valid",
+		max_batch_size >= 1 &&
+			max_batch_size <= BT_MESSAGE_ITERATOR_MAX_BATCH_SIZE,
+		"Invalid maximum batch size: max-batch-size=%" PRIu64 ", "
+		"absolute-max-batch-size=%d",
+		max_batch_size, BT_MESSAGE_ITERATOR_MAX_BATCH_SIZE);
+
+	config->max_batch_size = max_batch_size;
+}
+
 /*
  * Validate that the default clock snapshot in `msg` doesn't make us go back in
  * time.
@@ -577,6 +660,36 @@ bool clock_snapshots_are_monotonic_one(
 		clock_snapshot = discarded_msg->default_begin_cs;
 		break;
 	}
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+	{
+		struct bt_message_event_batch *batch_msg =
+			(struct bt_message_event_batch *) msg;
+		uint64_t i;
+
+		if (!batch_msg->default_cs_values) {
+			goto end;
+		}
+
+		/* Check each event of the batch */
+		for (i = 0; i < batch_msg->count; i++) {
+			if (bt_util_ns_from_origin_clock_class(
+					batch_msg->stream->class->default_clock_class,
+					batch_msg->default_cs_values[i],
+					&ns_from_origin)) {
+				/* Overflow: assume it's fine (see below) */
+				goto end;
+			}
+
+			if (ns_from_origin < iterator->last_ns_from_origin) {
+				result = false;
+				goto end;
+			}
+
+			iterator->last_ns_from_origin = ns_from_origin;
+		}
+
+		goto end;
+	}
 	}
 
 	if (!clock_snapshot) {
@@ -799,12 +912,35 @@ call_iterator_next_method(
 	enum bt_message_iterator_class_next_method_status status;
 
 	BT_ASSERT_DBG(iterator->methods.next);
-	BT_LOGD_STR("Calling user's \"next\" method.");
-	status = iterator->methods.next(iterator, msgs, capacity, user_count);
-	BT_LOGD("User method returned: status=%s, msg-count=%" PRIu64,
+	BT_LOGD_STR_FP("Calling user's \"next\" method.");
+	iterator->next_capacity = capacity;
+
+	if (G_UNLIKELY(iterator->profile_entry)) {
+		struct bt_graph_profile_frame frame;
+		bool is_timed = bt_graph_profile_begin_call(
+			&iterator->graph->profile, &frame);
+
+		status = iterator->methods.next(iterator, msgs, capacity,
+			user_count);
+		bt_graph_profile_end_call(&iterator->graph->profile,
+			iterator->profile_entry, &frame, is_timed,
+			status == BT_FUNC_STATUS_OK ? *user_count : 0);
+	} else {
+		status = iterator->methods.next(iterator, msgs, capacity,
+			user_count);
+	}
+
+	BT_LOGD_FP("User method returned: status=%s, msg-count=%" PRIu64,
 		bt_common_func_status_string(status), *user_count);
 
 	if (status == BT_FUNC_STATUS_OK) {
+		/*
+		 * The "next" method could have replaced the message
+		 * array of `iterator` with
+		 * bt_self_message_iterator_forward_next(): check the
+		 * current one.
+		 */
+		msgs = (void *) iterator->msgs->pdata;
 		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
 			"message-clock-classes-are-compatible",
 			clock_classes_are_compatible(iterator, msgs,
@@ -823,13 +959,64 @@ call_iterator_next_method(
 	return status;
 }
 
+/*
+ * Grows the message array of `iterator` if its "next" method filled
+ * its whole capacity `BT_MESSAGE_ITERATOR_BATCH_GROW_THRESHOLD` times
+ * in a row, without exceeding the configured maximum batch size.
+ *
+ * This is done _before_ the next call to the "next" method so that the
+ * array which the caller borrowed remains valid until then.
+ */
+static inline
+void grow_batch_if_needed(struct bt_message_iterator *iterator)
+{
+	uint64_t new_size;
+
+	if (iterator->batch.consecutive_full_count <
+			BT_MESSAGE_ITERATOR_BATCH_GROW_THRESHOLD) {
+		return;
+	}
+
+	iterator->batch.consecutive_full_count = 0;
+
+	if (iterator->batch.size >= iterator->config.max_batch_size) {
+		return;
+	}
+
+	new_size = MIN(iterator->batch.size * 2,
+		iterator->config.max_batch_size);
+	g_ptr_array_set_size(iterator->msgs, (gint) new_size);
+	BT_LIB_LOGD("Grew message iterator's batch size: "
+		"%!+i, old-batch-size=%" PRIu64 ", new-batch-size=%" PRIu64,
+		iterator, iterator->batch.size, new_size);
+	iterator->batch.size = new_size;
+}
+
+static inline
+void update_batch_full_count(struct bt_message_iterator *iterator,
+		uint64_t count)
+{
+	if (count == iterator->batch.size) {
+		iterator->batch.consecutive_full_count++;
+	} else {
+		iterator->batch.consecutive_full_count = 0;
+	}
+}
+
+static
+void update_seek_checkpoint(struct bt_message_iterator *iterator,
+		bt_message_array_const msgs, uint64_t count);
+
+static inline
+enum bt_message_iterator_next_status get_next_messages(
+		struct bt_message_iterator *iterator, uint64_t capacity,
+		bt_message_array_const *msgs, uint64_t *user_count);
+
 enum bt_message_iterator_next_status
 bt_message_iterator_next(
 		struct bt_message_iterator *iterator,
 		bt_message_array_const *msgs, uint64_t *user_count)
 {
-	enum bt_message_iterator_next_status status = BT_FUNC_STATUS_OK;
-
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
 	BT_ASSERT_PRE_DEV_NON_NULL("message-array-output", msgs,
@@ -847,9 +1034,27 @@ bt_message_iterator_next(
 			BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
 		"Graph is not configured: %!+g",
 		bt_component_borrow_graph(iterator->upstream_component));
-	BT_LIB_LOGD("Getting next self component input port "
-		"message iterator's messages: %!+i, batch-size=%u",
-		iterator, MSG_BATCH_SIZE);
+	grow_batch_if_needed(iterator);
+	return get_next_messages(iterator, iterator->batch.size, msgs,
+		user_count);
+}
+
+/*
+ * Calls the "next" method of `iterator` with a capacity of `capacity`
+ * (at most `iterator->batch.size`) messages.
+ */
+static inline
+enum bt_message_iterator_next_status get_next_messages(
+		struct bt_message_iterator *iterator, uint64_t capacity,
+		bt_message_array_const *msgs, uint64_t *user_count)
+{
+	enum bt_message_iterator_next_status status;
+
+	BT_ASSERT_DBG(capacity <= iterator->batch.size);
+	BT_LIB_LOGD_FP("Getting next self component input port "
+		"message iterator's messages: %!+i, capacity=%" PRIu64,
+		iterator, capacity);
+	BT_PROBE2(msg_iter_next_begin, iterator, capacity);
 
 	/*
 	 * Call the user's "next" method to get the next messages
@@ -857,10 +1062,10 @@ bt_message_iterator_next(
 	 */
 	*user_count = 0;
 	status = (int) call_iterator_next_method(iterator,
-		(void *) iterator->msgs->pdata, MSG_BATCH_SIZE,
-		user_count);
-	BT_LOGD("User method returned: status=%s, msg-count=%" PRIu64,
+		(void *) iterator->msgs->pdata, capacity, user_count);
+	BT_LOGD_FP("User method returned: status=%s, msg-count=%" PRIu64,
 		bt_common_func_status_string(status), *user_count);
+	BT_PROBE3(msg_iter_next_end, iterator, (int) status, *user_count);
 	if (status < 0) {
 		BT_LIB_LOGW_APPEND_CAUSE(
 			"Component input port message iterator's \"next\" method failed: "
@@ -884,11 +1089,23 @@ bt_message_iterator_next(
 	switch (status) {
 	case BT_FUNC_STATUS_OK:
 		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME, "count-lteq-capacity",
-			*user_count <= MSG_BATCH_SIZE,
+			*user_count <= capacity,
 			"Invalid returned message count: greater than "
-			"batch size: count=%" PRIu64 ", batch-size=%u",
-			*user_count, MSG_BATCH_SIZE);
+			"capacity: count=%" PRIu64 ", capacity=%" PRIu64,
+			*user_count, capacity);
+		update_batch_full_count(iterator, *user_count);
+
+		/*
+		 * Not the array passed to the "next" method: it could
+		 * have forwarded the messages of an upstream message
+		 * iterator with bt_self_message_iterator_forward_next().
+		 */
 		*msgs = (void *) iterator->msgs->pdata;
+
+		if (G_UNLIKELY(iterator->seek_checkpoint.stream_states)) {
+			update_seek_checkpoint(iterator, *msgs, *user_count);
+		}
+
 		break;
 	case BT_FUNC_STATUS_AGAIN:
 		goto end;
@@ -905,6 +1122,89 @@ end:
 	return status;
 }
 
+/*
+ * Makes sure that the message array of `iterator` can contain at least
+ * `iterator->batch.size` messages after
+ * bt_self_message_iterator_forward_next() swapped it.
+ */
+static inline
+void ensure_batch_capacity(struct bt_message_iterator *iterator)
+{
+	if (G_UNLIKELY(iterator->msgs->len < iterator->batch.size)) {
+		g_ptr_array_set_size(iterator->msgs,
+			(gint) iterator->batch.size);
+	}
+}
+
+enum bt_message_iterator_next_status
+bt_self_message_iterator_forward_next(
+		struct bt_self_message_iterator *self_iterator,
+		struct bt_message_iterator *upstream_iterator,
+		uint64_t *count)
+{
+	struct bt_message_iterator *iterator = (void *) self_iterator;
+	enum bt_message_iterator_next_status status;
+	bt_message_array_const upstream_msgs;
+	GPtrArray *msgs;
+
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
+	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(upstream_iterator);
+	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count,
+		"Message count (output)");
+	BT_ASSERT_PRE_DEV("message-iterator-is-active",
+		iterator->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE,
+		"Message iterator is in the wrong state: %!+i", iterator);
+	BT_ASSERT_PRE_DEV("upstream-message-iterator-is-active",
+		upstream_iterator->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE,
+		"Upstream message iterator's \"next\" called, but "
+		"message iterator is in the wrong state: %!+i",
+		upstream_iterator);
+	BT_ASSERT_PRE_DEV("upstream-message-iterator-is-upstream",
+		upstream_iterator->downstream_msg_iter == iterator,
+		"Message iterator was not created from the self message "
+		"iterator: %![self-msg-iter-]+i, %![upstream-msg-iter-]+i",
+		iterator, upstream_iterator);
+	grow_batch_if_needed(upstream_iterator);
+
+	/*
+	 * Limit the capacity to the one of the current "next" method
+	 * call of `iterator` so that the forwarded messages fit in its
+	 * output.
+	 */
+	status = get_next_messages(upstream_iterator,
+		MIN(upstream_iterator->batch.size, iterator->next_capacity),
+		&upstream_msgs, count);
+	if (status != BT_FUNC_STATUS_OK) {
+		goto end;
+	}
+
+	BT_ASSERT_DBG(upstream_msgs ==
+		(void *) upstream_iterator->msgs->pdata);
+
+	/*
+	 * Swap the message arrays: the messages of the upstream
+	 * message iterator become the messages of `iterator` without
+	 * copying them or touching their reference counts.
+	 *
+	 * The previous array of `iterator` only contains messages
+	 * which its downstream actor already took (it called the
+	 * "next" method of `iterator` again), so the upstream message
+	 * iterator can fill it on its next "next" method call.
+	 */
+	msgs = iterator->msgs;
+	iterator->msgs = upstream_iterator->msgs;
+	upstream_iterator->msgs = msgs;
+	ensure_batch_capacity(iterator);
+	ensure_batch_capacity(upstream_iterator);
+	BT_LIB_LOGD_FP("Forwarded upstream message iterator's messages: "
+		"%![self-msg-iter-]+i, %![upstream-msg-iter-]+i, "
+		"count=%" PRIu64, iterator, upstream_iterator, *count);
+
+end:
+	return status;
+}
+
 struct bt_component *
 bt_message_iterator_borrow_component(
 		struct bt_message_iterator *iterator)
@@ -1093,6 +1393,69 @@ void reset_iterator_expectations(
 	iterator->clock_expectation.type = CLOCK_EXPECTATION_UNSET;
 }
 
+/*
+ * Resets the auto-seek checkpoint of `iterator`, if it records one,
+ * after a successful seeking operation: the upstream message iterator
+ * won't return any message before `min_ns_from_origin`.
+ */
+static
+void reset_seek_checkpoint(struct bt_message_iterator *iterator,
+		int64_t min_ns_from_origin)
+{
+	if (!iterator->seek_checkpoint.stream_states) {
+		goto end;
+	}
+
+	g_hash_table_remove_all(iterator->seek_checkpoint.stream_states);
+	iterator->seek_checkpoint.last_stream = NULL;
+	iterator->seek_checkpoint.last_stream_state = NULL;
+	iterator->seek_checkpoint.min_ns_from_origin = min_ns_from_origin;
+	iterator->seek_checkpoint.valid = true;
+
+end:
+	return;
+}
+
+/*
+ * Makes the auto-seek checkpoint of `iterator` unusable until the next
+ * successful seeking operation.
+ */
+static
+void invalidate_seek_checkpoint(struct bt_message_iterator *iterator)
+{
+	if (!iterator->seek_checkpoint.stream_states) {
+		goto end;
+	}
+
+	g_hash_table_remove_all(iterator->seek_checkpoint.stream_states);
+	iterator->seek_checkpoint.last_stream = NULL;
+	iterator->seek_checkpoint.last_stream_state = NULL;
+	iterator->seek_checkpoint.valid = false;
+
+end:
+	return;
+}
+
+/*
+ * Discards the messages of the auto-seek message queue of `iterator`
+ * which it didn't return yet and restores the user's "next" method (see
+ * post_auto_seek_next()).
+ */
+static
+void discard_auto_seek_msgs(struct bt_message_iterator *iterator)
+{
+	while (!g_queue_is_empty(iterator->auto_seek.msgs)) {
+		bt_object_put_ref_no_null_check(
+			g_queue_pop_tail(iterator->auto_seek.msgs));
+	}
+
+	if (iterator->auto_seek.original_next_callback) {
+		iterator->methods.next =
+			iterator->auto_seek.original_next_callback;
+		iterator->auto_seek.original_next_callback = NULL;
+	}
+}
+
 static
 bool message_iterator_can_seek_beginning(
 		struct bt_message_iterator *iterator)
@@ -1135,6 +1498,7 @@ bt_message_iterator_seek_beginning(struct bt_message_iterator *iterator)
 	 */
 	reset_iterator_expectations(iterator);
 
+	discard_auto_seek_msgs(iterator);
 	BT_LIB_LOGD("Calling user's \"seek beginning\" method: %!+i", iterator);
 	set_msg_iterator_state(iterator,
 		BT_MESSAGE_ITERATOR_STATE_SEEKING);
@@ -1157,6 +1521,12 @@ bt_message_iterator_seek_beginning(struct bt_message_iterator *iterator)
 			iterator, bt_common_func_status_string(status));
 	}
 
+	if (status == BT_FUNC_STATUS_OK) {
+		reset_seek_checkpoint(iterator, INT64_MIN);
+	} else {
+		invalidate_seek_checkpoint(iterator);
+	}
+
 	set_iterator_state_after_seeking(iterator, status);
 	return status;
 }
@@ -1196,8 +1566,7 @@ struct auto_seek_stream_state {
 
 	/*
 	 * If `state` is AUTO_SEEK_STREAM_STATE_PACKET_BEGAN, the packet we are
-	 * in.  This is a weak reference, since the packet will always be
-	 * alive by the time we use it.
+	 * in (strong reference).
 	 */
 	struct bt_packet *packet;
 
@@ -1214,14 +1583,27 @@ struct auto_seek_stream_state *create_auto_seek_stream_state(void)
 static
 void destroy_auto_seek_stream_state(void *ptr)
 {
-	g_free(ptr);
+	struct auto_seek_stream_state *stream_state = ptr;
+
+	BT_OBJECT_PUT_REF_AND_RESET(stream_state->packet);
+	g_free(stream_state);
+}
+
+static
+void put_auto_seek_stream(void *ptr)
+{
+	bt_object_put_ref_no_null_check(ptr);
 }
 
+/*
+ * Creates a hash table of `const bt_stream *` (strong reference) to
+ * `struct auto_seek_stream_state *` (owned by the table).
+ */
 static
 GHashTable *create_auto_seek_stream_states(void)
 {
-	return g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
-		destroy_auto_seek_stream_state);
+	return g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		put_auto_seek_stream, destroy_auto_seek_stream_state);
 }
 
 static
@@ -1231,70 +1613,213 @@ void destroy_auto_seek_stream_states(GHashTable *stream_states)
 }
 
 /*
- * Handle one message while we are in the fast-forward phase of an auto-seek.
- *
- * Sets `*got_first` to true if the message's timestamp is greater or equal to
- * `ns_from_origin`.  In other words, if this is the first message after our
- * seek point.
- *
- * `stream_states` is an hash table of `bt_stream *` (weak reference) to
- * `struct auto_seek_stream_state` used to keep the state of each stream
- * during the fast-forward.
+ * Updates the stream states `stream_states` (see
+ * auto_seek_handle_message()) with the message `msg`, which comes after
+ * all the messages which the current stream states reflect.
  */
-
-static inline
-int auto_seek_handle_message(
-		struct bt_message_iterator *iterator,
-		int64_t ns_from_origin, const struct bt_message *msg,
-		bool *got_first, GHashTable *stream_states)
+static
+int update_auto_seek_stream_states(GHashTable *stream_states,
+		const struct bt_message *msg)
 {
 	int status = BT_FUNC_STATUS_OK;
-	int64_t msg_ns_from_origin;
-	const struct bt_clock_snapshot *clk_snapshot = NULL;
-	int ret;
-
-	BT_ASSERT_DBG(msg);
-	BT_ASSERT_DBG(got_first);
 
 	switch (msg->type) {
-	case BT_MESSAGE_TYPE_EVENT:
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
 	{
-		const struct bt_message_event *event_msg =
-			(const void *) msg;
+		const struct bt_message_stream *stream_msg = (const void *) msg;
+		struct auto_seek_stream_state *stream_state;
 
-		clk_snapshot = event_msg->default_cs;
-		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
-			"event-message-has-default-clock-snapshot",
-			clk_snapshot,
-			"Event message has no default clock snapshot: %!+n",
-			event_msg);
-		break;
-	}
-	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
-	{
-		const struct bt_message_message_iterator_inactivity *inactivity_msg =
-			(const void *) msg;
+		/* Update stream's state: stream began. */
+		stream_state = create_auto_seek_stream_state();
+		if (!stream_state) {
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto end;
+		}
 
-		clk_snapshot = inactivity_msg->cs;
-		BT_ASSERT_DBG(clk_snapshot);
+		stream_state->state = AUTO_SEEK_STREAM_STATE_STREAM_BEGAN;
+
+		if (stream_msg->default_cs_state == BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
+			stream_state->seen_clock_snapshot = true;
+		}
+
+		BT_ASSERT_DBG(!bt_g_hash_table_contains(stream_states, stream_msg->stream));
+		g_hash_table_insert(stream_states, stream_msg->stream,
+			stream_state);
+		bt_object_get_ref_no_null_check(stream_msg->stream);
 		break;
 	}
 	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
-	case BT_MESSAGE_TYPE_PACKET_END:
 	{
 		const struct bt_message_packet *packet_msg =
 			(const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		/* Update stream's state: packet began. */
+		stream_state = g_hash_table_lookup(stream_states, packet_msg->packet->stream);
+		BT_ASSERT_DBG(stream_state);
+		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_STREAM_BEGAN);
+		stream_state->state = AUTO_SEEK_STREAM_STATE_PACKET_BEGAN;
+		BT_ASSERT_DBG(!stream_state->packet);
+		stream_state->packet = packet_msg->packet;
+		bt_object_get_ref_no_null_check(stream_state->packet);
+
+		if (packet_msg->packet->stream->class->packets_have_beginning_default_clock_snapshot) {
+			stream_state->seen_clock_snapshot = true;
+		}
 
-		clk_snapshot = packet_msg->default_cs;
-		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
-			"packet-message-has-default-clock-snapshot",
-			clk_snapshot,
-			"Packet message has no default clock snapshot: %!+n",
-			packet_msg);
 		break;
 	}
-	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
-	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+	case BT_MESSAGE_TYPE_EVENT:
+	{
+		const struct bt_message_event *event_msg = (const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		stream_state = g_hash_table_lookup(stream_states,
+			event_msg->event->stream);
+		BT_ASSERT_DBG(stream_state);
+
+		// HELPME: are we sure that event messages have clock snapshots at this point?
+		stream_state->seen_clock_snapshot = true;
+
+		break;
+	}
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+	{
+		const struct bt_message_event_batch *batch_msg =
+			(const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		stream_state = g_hash_table_lookup(stream_states,
+			batch_msg->stream);
+		BT_ASSERT_DBG(stream_state);
+		stream_state->seen_clock_snapshot = true;
+		break;
+	}
+	case BT_MESSAGE_TYPE_PACKET_END:
+	{
+		const struct bt_message_packet *packet_msg =
+			(const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		/* Update stream's state: packet ended. */
+		stream_state = g_hash_table_lookup(stream_states, packet_msg->packet->stream);
+		BT_ASSERT_DBG(stream_state);
+		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_PACKET_BEGAN);
+		stream_state->state = AUTO_SEEK_STREAM_STATE_STREAM_BEGAN;
+		BT_ASSERT_DBG(stream_state->packet);
+		BT_OBJECT_PUT_REF_AND_RESET(stream_state->packet);
+
+		if (packet_msg->packet->stream->class->packets_have_end_default_clock_snapshot) {
+			stream_state->seen_clock_snapshot = true;
+		}
+
+		break;
+	}
+	case BT_MESSAGE_TYPE_STREAM_END:
+	{
+		const struct bt_message_stream *stream_msg = (const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		stream_state = g_hash_table_lookup(stream_states, stream_msg->stream);
+		BT_ASSERT_DBG(stream_state);
+		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_STREAM_BEGAN);
+		BT_ASSERT_DBG(!stream_state->packet);
+
+		/* Update stream's state: this stream doesn't exist anymore. */
+		g_hash_table_remove(stream_states, stream_msg->stream);
+		break;
+	}
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+	{
+		const struct bt_message_discarded_items *discarded_msg =
+			(const void *) msg;
+		struct auto_seek_stream_state *stream_state;
+
+		stream_state = g_hash_table_lookup(stream_states, discarded_msg->stream);
+		BT_ASSERT_DBG(stream_state);
+
+		if ((msg->type == BT_MESSAGE_TYPE_DISCARDED_EVENTS && discarded_msg->stream->class->discarded_events_have_default_clock_snapshots) ||
+			(msg->type == BT_MESSAGE_TYPE_DISCARDED_PACKETS && discarded_msg->stream->class->discarded_packets_have_default_clock_snapshots)) {
+			stream_state->seen_clock_snapshot = true;
+		}
+
+		break;
+	}
+	default:
+		break;
+	}
+
+
+end:
+	return status;
+}
+
+/*
+ * Handle one message while we are in the fast-forward phase of an auto-seek.
+ *
+ * Sets `*got_first` to true if the message's timestamp is greater or equal to
+ * `ns_from_origin`.  In other words, if this is the first message after our
+ * seek point.
+ *
+ * `stream_states` is an hash table of `bt_stream *` (weak reference) to
+ * `struct auto_seek_stream_state` used to keep the state of each stream
+ * during the fast-forward.
+ */
+
+static inline
+int auto_seek_handle_message(
+		struct bt_message_iterator *iterator,
+		int64_t ns_from_origin, const struct bt_message *msg,
+		bool *got_first, GHashTable *stream_states)
+{
+	int status = BT_FUNC_STATUS_OK;
+	int64_t msg_ns_from_origin;
+	const struct bt_clock_snapshot *clk_snapshot = NULL;
+	int ret;
+
+	BT_ASSERT_DBG(msg);
+	BT_ASSERT_DBG(got_first);
+
+	switch (msg->type) {
+	case BT_MESSAGE_TYPE_EVENT:
+	{
+		const struct bt_message_event *event_msg =
+			(const void *) msg;
+
+		clk_snapshot = event_msg->default_cs;
+		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
+			"event-message-has-default-clock-snapshot",
+			clk_snapshot,
+			"Event message has no default clock snapshot: %!+n",
+			event_msg);
+		break;
+	}
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+	{
+		const struct bt_message_message_iterator_inactivity *inactivity_msg =
+			(const void *) msg;
+
+		clk_snapshot = inactivity_msg->cs;
+		BT_ASSERT_DBG(clk_snapshot);
+		break;
+	}
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+	case BT_MESSAGE_TYPE_PACKET_END:
+	{
+		const struct bt_message_packet *packet_msg =
+			(const void *) msg;
+
+		clk_snapshot = packet_msg->default_cs;
+		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
+			"packet-message-has-default-clock-snapshot",
+			clk_snapshot,
+			"Packet message has no default clock snapshot: %!+n",
+			packet_msg);
+		break;
+	}
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
 	{
 		struct bt_message_discarded_items *msg_disc_items =
 			(void *) msg;
@@ -1375,135 +1900,89 @@ int auto_seek_handle_message(
 		clk_snapshot = stream_msg->default_cs;
 		break;
 	}
-	default:
-		bt_common_abort();
-	}
-
-	BT_ASSERT_DBG(clk_snapshot);
-	ret = bt_clock_snapshot_get_ns_from_origin(clk_snapshot,
-		&msg_ns_from_origin);
-	if (ret) {
-		status = BT_FUNC_STATUS_ERROR;
-		goto end;
-	}
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+	{
+		struct bt_message_event_batch *batch_msg = (void *) msg;
+		uint64_t i;
 
-	if (msg_ns_from_origin >= ns_from_origin) {
-		*got_first = true;
-		goto push_msg;
-	}
+		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
+			"event-batch-message-has-default-clock-snapshots",
+			batch_msg->default_cs_values,
+			"Event batch message has no default clock snapshots: %!+n",
+			batch_msg);
+
+		/* Find the first event at or after the seeking time */
+		for (i = 0; i < batch_msg->count; i++) {
+			ret = bt_util_ns_from_origin_clock_class(
+				batch_msg->stream->class->default_clock_class,
+				batch_msg->default_cs_values[i],
+				&msg_ns_from_origin);
+			if (ret) {
+				status = BT_FUNC_STATUS_ERROR;
+				goto end;
+			}
 
-skip_msg:
-	/* This message won't be sent downstream. */
-	switch (msg->type) {
-	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
-	{
-		const struct bt_message_stream *stream_msg = (const void *) msg;
-		struct auto_seek_stream_state *stream_state;
+			if (msg_ns_from_origin >= ns_from_origin) {
+				break;
+			}
+		}
 
-		/* Update stream's state: stream began. */
-		stream_state = create_auto_seek_stream_state();
-		if (!stream_state) {
-			status = BT_FUNC_STATUS_MEMORY_ERROR;
-			goto end;
+		if (i == batch_msg->count) {
+			goto skip_msg;
 		}
 
-		stream_state->state = AUTO_SEEK_STREAM_STATE_STREAM_BEGAN;
+		*got_first = true;
 
-		if (stream_msg->default_cs_state == BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
-			stream_state->seen_clock_snapshot = true;
+		if (i == 0) {
+			goto push_msg;
 		}
 
-		BT_ASSERT_DBG(!bt_g_hash_table_contains(stream_states, stream_msg->stream));
-		g_hash_table_insert(stream_states, stream_msg->stream, stream_state);
-		break;
-	}
-	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
-	{
-		const struct bt_message_packet *packet_msg =
-			(const void *) msg;
-		struct auto_seek_stream_state *stream_state;
+		/*
+		 * Only keep the events at or after the seeking time.
+		 * Modify the message in place if nobody else has a
+		 * reference to it.
+		 */
+		if (bt_object_get_ref_count(&msg->base) == 1) {
+			bt_message_event_batch_remove_first_events(batch_msg,
+				i);
+		} else {
+			const struct bt_message *copy =
+				bt_message_event_batch_copy_without_first_events(
+					iterator, batch_msg, i);
 
-		/* Update stream's state: packet began. */
-		stream_state = g_hash_table_lookup(stream_states, packet_msg->packet->stream);
-		BT_ASSERT_DBG(stream_state);
-		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_STREAM_BEGAN);
-		stream_state->state = AUTO_SEEK_STREAM_STATE_PACKET_BEGAN;
-		BT_ASSERT_DBG(!stream_state->packet);
-		stream_state->packet = packet_msg->packet;
+			if (!copy) {
+				status = BT_FUNC_STATUS_MEMORY_ERROR;
+				goto end;
+			}
 
-		if (packet_msg->packet->stream->class->packets_have_beginning_default_clock_snapshot) {
-			stream_state->seen_clock_snapshot = true;
+			bt_object_put_ref_no_null_check(msg);
+			msg = copy;
 		}
 
-		break;
+		goto push_msg;
 	}
-	case BT_MESSAGE_TYPE_EVENT:
-	{
-		const struct bt_message_event *event_msg = (const void *) msg;
-		struct auto_seek_stream_state *stream_state;
-
-		stream_state = g_hash_table_lookup(stream_states,
-			event_msg->event->stream);
-		BT_ASSERT_DBG(stream_state);
-
-		// HELPME: are we sure that event messages have clock snapshots at this point?
-		stream_state->seen_clock_snapshot = true;
-
-		break;
+	default:
+		bt_common_abort();
 	}
-	case BT_MESSAGE_TYPE_PACKET_END:
-	{
-		const struct bt_message_packet *packet_msg =
-			(const void *) msg;
-		struct auto_seek_stream_state *stream_state;
 
-		/* Update stream's state: packet ended. */
-		stream_state = g_hash_table_lookup(stream_states, packet_msg->packet->stream);
-		BT_ASSERT_DBG(stream_state);
-		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_PACKET_BEGAN);
-		stream_state->state = AUTO_SEEK_STREAM_STATE_STREAM_BEGAN;
-		BT_ASSERT_DBG(stream_state->packet);
-		stream_state->packet = NULL;
-
-		if (packet_msg->packet->stream->class->packets_have_end_default_clock_snapshot) {
-			stream_state->seen_clock_snapshot = true;
-		}
-
-		break;
+	BT_ASSERT_DBG(clk_snapshot);
+	ret = bt_clock_snapshot_get_ns_from_origin(clk_snapshot,
+		&msg_ns_from_origin);
+	if (ret) {
+		status = BT_FUNC_STATUS_ERROR;
+		goto end;
 	}
-	case BT_MESSAGE_TYPE_STREAM_END:
-	{
-		const struct bt_message_stream *stream_msg = (const void *) msg;
-		struct auto_seek_stream_state *stream_state;
-
-		stream_state = g_hash_table_lookup(stream_states, stream_msg->stream);
-		BT_ASSERT_DBG(stream_state);
-		BT_ASSERT_DBG(stream_state->state == AUTO_SEEK_STREAM_STATE_STREAM_BEGAN);
-		BT_ASSERT_DBG(!stream_state->packet);
 
-		/* Update stream's state: this stream doesn't exist anymore. */
-		g_hash_table_remove(stream_states, stream_msg->stream);
-		break;
+	if (msg_ns_from_origin >= ns_from_origin) {
+		*got_first = true;
+		goto push_msg;
 	}
-	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
-	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
-	{
-		const struct bt_message_discarded_items *discarded_msg =
-			(const void *) msg;
-		struct auto_seek_stream_state *stream_state;
-
-		stream_state = g_hash_table_lookup(stream_states, discarded_msg->stream);
-		BT_ASSERT_DBG(stream_state);
 
-		if ((msg->type == BT_MESSAGE_TYPE_DISCARDED_EVENTS && discarded_msg->stream->class->discarded_events_have_default_clock_snapshots) ||
-			(msg->type == BT_MESSAGE_TYPE_DISCARDED_PACKETS && discarded_msg->stream->class->discarded_packets_have_default_clock_snapshots)) {
-			stream_state->seen_clock_snapshot = true;
-		}
-
-		break;
-	}
-	default:
-		break;
+skip_msg:
+	/* This message won't be sent downstream. */
+	status = update_auto_seek_stream_states(stream_states, msg);
+	if (status) {
+		goto end;
 	}
 
 	bt_object_put_ref_no_null_check(msg);
@@ -1527,13 +2006,47 @@ int find_message_ge_ns_from_origin(
 	int status = BT_FUNC_STATUS_OK;
 	enum bt_message_iterator_state init_state =
 		iterator->state;
-	const struct bt_message *messages[MSG_BATCH_SIZE];
+	const struct bt_message **messages;
 	uint64_t user_count = 0;
+	uint64_t pending_count;
 	uint64_t i;
 	bool got_first = false;
 
 	BT_ASSERT_DBG(iterator);
-	memset(&messages[0], 0, sizeof(messages[0]) * MSG_BATCH_SIZE);
+
+	/*
+	 * Use this iterator's own message array: its content belongs to
+	 * the downstream actor only until the next call to
+	 * bt_message_iterator_next() or to a seeking function.
+	 */
+	messages = (void *) iterator->msgs->pdata;
+	memset(&messages[0], 0, sizeof(messages[0]) * iterator->batch.size);
+
+	/*
+	 * When resuming from the auto-seek checkpoint, the auto-seek
+	 * message queue can still contain messages which this iterator
+	 * didn't return yet: they come before the next messages of the
+	 * upstream message iterator.
+	 */
+	pending_count = g_queue_get_length(iterator->auto_seek.msgs);
+
+	for (i = 0; i < pending_count; i++) {
+		const struct bt_message *msg =
+			g_queue_pop_head(iterator->auto_seek.msgs);
+
+		if (got_first) {
+			g_queue_push_tail(iterator->auto_seek.msgs,
+				(void *) msg);
+			continue;
+		}
+
+		status = auto_seek_handle_message(iterator,
+			ns_from_origin, msg, &got_first, stream_states);
+		if (status != BT_FUNC_STATUS_OK) {
+			bt_object_put_ref_no_null_check(msg);
+			goto end;
+		}
+	}
 
 	/*
 	 * Make this iterator temporarily active (not seeking) to call
@@ -1550,9 +2063,12 @@ int find_message_ge_ns_from_origin(
 		 * messages and status.
 		 */
 		status = call_iterator_next_method(iterator,
-			&messages[0], MSG_BATCH_SIZE, &user_count);
+			&messages[0], iterator->batch.size, &user_count);
 		BT_LOGD("User method returned: status=%s",
 			bt_common_func_status_string(status));
+
+		/* See bt_self_message_iterator_forward_next() */
+		messages = (void *) iterator->msgs->pdata;
 		if (status < 0) {
 			BT_LIB_LOGW_APPEND_CAUSE(
 				"Component input port message iterator's \"next\" method failed: "
@@ -1571,10 +2087,10 @@ int find_message_ge_ns_from_origin(
 		case BT_FUNC_STATUS_OK:
 			BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
 				"count-lteq-capacity",
-				user_count <= MSG_BATCH_SIZE,
+				user_count <= iterator->batch.size,
 				"Invalid returned message count: greater than "
-				"batch size: count=%" PRIu64 ", batch-size=%u",
-				user_count, MSG_BATCH_SIZE);
+				"batch size: count=%" PRIu64 ", batch-size=%" PRIu64,
+				user_count, iterator->batch.size);
 			break;
 		case BT_FUNC_STATUS_AGAIN:
 		case BT_FUNC_STATUS_ERROR:
@@ -1616,6 +2132,159 @@ end:
 	return status;
 }
 
+/*
+ * Sets `*ns_from_origin` to the latest time of the message `msg` and
+ * returns `true`, or returns `false` if `msg` has no known time.
+ */
+static inline
+bool get_msg_latest_ns_from_origin(const struct bt_message *msg,
+		int64_t *ns_from_origin)
+{
+	const struct bt_clock_snapshot *clk_snapshot = NULL;
+	bool ret = false;
+
+	switch (msg->type) {
+	case BT_MESSAGE_TYPE_EVENT:
+		clk_snapshot = ((const struct bt_message_event *) msg)->default_cs;
+		break;
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+		clk_snapshot =
+			((const struct bt_message_message_iterator_inactivity *) msg)->cs;
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+	case BT_MESSAGE_TYPE_PACKET_END:
+		clk_snapshot = ((const struct bt_message_packet *) msg)->default_cs;
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+	case BT_MESSAGE_TYPE_STREAM_END:
+	{
+		const struct bt_message_stream *stream_msg = (const void *) msg;
+
+		if (stream_msg->default_cs_state ==
+				BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
+			clk_snapshot = stream_msg->default_cs;
+		}
+
+		break;
+	}
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		clk_snapshot =
+			((const struct bt_message_discarded_items *) msg)->default_end_cs;
+		break;
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+	{
+		const struct bt_message_event_batch *batch_msg =
+			(const void *) msg;
+
+		if (batch_msg->count > 0 && batch_msg->default_cs_values) {
+			ret = bt_util_ns_from_origin_clock_class(
+				batch_msg->stream->class->default_clock_class,
+				batch_msg->default_cs_values[batch_msg->count - 1],
+				ns_from_origin) == 0;
+		}
+
+		goto end;
+	}
+	default:
+		break;
+	}
+
+	if (clk_snapshot && !clk_snapshot->ns_from_origin_overflows) {
+		*ns_from_origin = clk_snapshot->ns_from_origin;
+		ret = true;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Updates the auto-seek checkpoint of `iterator` with the `count`
+ * messages `msgs` which it returns.
+ */
+static
+void update_seek_checkpoint(struct bt_message_iterator *iterator,
+		bt_message_array_const msgs, uint64_t count)
+{
+	uint64_t i;
+
+	if (!iterator->seek_checkpoint.valid) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		const struct bt_message *msg = msgs[i];
+		int64_t msg_ns_from_origin;
+
+		if (msg->type == BT_MESSAGE_TYPE_EVENT) {
+			/*
+			 * Fast path: consecutive event messages usually
+			 * belong to the same stream.
+			 */
+			const struct bt_stream *stream =
+				((const struct bt_message_event *) msg)->event->stream;
+
+			if (stream != iterator->seek_checkpoint.last_stream) {
+				iterator->seek_checkpoint.last_stream_state =
+					g_hash_table_lookup(
+						iterator->seek_checkpoint.stream_states,
+						stream);
+				if (!iterator->seek_checkpoint.last_stream_state) {
+					invalidate_seek_checkpoint(iterator);
+					goto end;
+				}
+
+				iterator->seek_checkpoint.last_stream = stream;
+			}
+
+			iterator->seek_checkpoint.last_stream_state->seen_clock_snapshot =
+				true;
+		} else {
+			iterator->seek_checkpoint.last_stream = NULL;
+			iterator->seek_checkpoint.last_stream_state = NULL;
+
+			if (update_auto_seek_stream_states(
+					iterator->seek_checkpoint.stream_states,
+					msg)) {
+				invalidate_seek_checkpoint(iterator);
+				goto end;
+			}
+		}
+
+		if (get_msg_latest_ns_from_origin(msg, &msg_ns_from_origin)) {
+			if (msg_ns_from_origin == INT64_MAX) {
+				invalidate_seek_checkpoint(iterator);
+				goto end;
+			}
+
+			/*
+			 * Another message could have the same time:
+			 * resuming is only possible after it.
+			 */
+			iterator->seek_checkpoint.min_ns_from_origin =
+				msg_ns_from_origin + 1;
+		}
+	}
+
+end:
+	return;
+}
+
+/*
+ * Returns whether or not `iterator` can auto-seek `ns_from_origin` from
+ * its checkpoint instead of seeking the beginning.
+ */
+static
+bool can_resume_from_seek_checkpoint(struct bt_message_iterator *iterator,
+		int64_t ns_from_origin)
+{
+	return iterator->seek_checkpoint.stream_states &&
+		iterator->seek_checkpoint.valid &&
+		iterator->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE &&
+		ns_from_origin >= iterator->seek_checkpoint.min_ns_from_origin;
+}
+
 /*
  * This function is installed as the iterator's next callback after we have
  * auto-seeked (seeked to the beginning and fast-forwarded) to send the
@@ -1684,6 +2353,55 @@ bool message_iterator_can_seek_ns_from_origin(
 	return can_seek;
 }
 
+/*
+ * Seeks the beginning of `iterator` through the user's "seek beginning"
+ * method, as the first step of an auto-seek.
+ */
+static
+int auto_seek_beginning(struct bt_message_iterator *iterator)
+{
+	enum bt_message_iterator_class_can_seek_beginning_method_status can_seek_status;
+	bt_bool can_seek_beginning;
+	int status;
+
+	can_seek_status = iterator->methods.can_seek_beginning(iterator,
+		&can_seek_beginning);
+	BT_ASSERT(can_seek_status == BT_FUNC_STATUS_OK);
+	BT_ASSERT(can_seek_beginning);
+	BT_ASSERT(iterator->methods.seek_beginning);
+	discard_auto_seek_msgs(iterator);
+	BT_LIB_LOGD("Calling user's \"seek beginning\" method: %!+i",
+		iterator);
+	status = iterator->methods.seek_beginning(iterator);
+	BT_LOGD("User method returned: status=%s",
+		bt_common_func_status_string(status));
+	BT_ASSERT_POST(SEEK_BEGINNING_METHOD_NAME, "valid-status",
+		status == BT_FUNC_STATUS_OK ||
+		status == BT_FUNC_STATUS_ERROR ||
+		status == BT_FUNC_STATUS_MEMORY_ERROR ||
+		status == BT_FUNC_STATUS_AGAIN,
+		"Unexpected status: %![iter-]+i, status=%s",
+		iterator, bt_common_func_status_string(status));
+	if (status < 0) {
+		BT_LIB_LOGW_APPEND_CAUSE(
+			"Component input port message iterator's \"seek beginning\" method failed: "
+			"%![iter-]+i, status=%s",
+			iterator, bt_common_func_status_string(status));
+	}
+
+	switch (status) {
+	case BT_FUNC_STATUS_OK:
+	case BT_FUNC_STATUS_ERROR:
+	case BT_FUNC_STATUS_MEMORY_ERROR:
+	case BT_FUNC_STATUS_AGAIN:
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return status;
+}
+
 #define SEEK_NS_FROM_ORIGIN_METHOD_NAME					\
 	"bt_message_iterator_class_seek_ns_from_origin_method"
 
@@ -1696,6 +2414,7 @@ bt_message_iterator_seek_ns_from_origin(
 	int status;
 	GHashTable *stream_states = NULL;
 	bt_bool can_seek_by_itself;
+	bool resume_from_checkpoint;
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
@@ -1710,6 +2429,8 @@ bt_message_iterator_seek_ns_from_origin(
 		message_iterator_can_seek_ns_from_origin(iterator, ns_from_origin),
 		"Message iterator cannot seek nanoseconds from origin: %!+i, "
 		"ns-from-origin=%" PRId64, iterator, ns_from_origin);
+	resume_from_checkpoint = can_resume_from_seek_checkpoint(iterator,
+		ns_from_origin);
 	set_msg_iterator_state(iterator,
 		BT_MESSAGE_ITERATOR_STATE_SEEKING);
 
@@ -1738,6 +2459,7 @@ bt_message_iterator_seek_ns_from_origin(
 	if (can_seek_by_itself) {
 		/* The iterator knows how to seek to a particular time, let it handle this. */
 		BT_ASSERT(iterator->methods.seek_ns_from_origin);
+		discard_auto_seek_msgs(iterator);
 		BT_LIB_LOGD("Calling user's \"seek nanoseconds from origin\" method: "
 			"%![iter-]+i, ns=%" PRId64, iterator, ns_from_origin);
 		status = iterator->methods.seek_ns_from_origin(iterator,
@@ -1763,44 +2485,40 @@ bt_message_iterator_seek_ns_from_origin(
 		/*
 		 * The iterator doesn't know how to seek by itself to a
 		 * particular time.  We will seek to the beginning and fast
-		 * forward to the right place.
+		 * forward to the right place or, if the seeking time is
+		 * after its current position, fast-forward from there,
+		 * starting with the stream states of its checkpoint.
 		 */
-		enum bt_message_iterator_class_can_seek_beginning_method_status can_seek_status;
-		bt_bool can_seek_beginning;
-
-		can_seek_status = iterator->methods.can_seek_beginning(iterator,
-			&can_seek_beginning);
-		BT_ASSERT(can_seek_status == BT_FUNC_STATUS_OK);
-		BT_ASSERT(can_seek_beginning);
-		BT_ASSERT(iterator->methods.seek_beginning);
-		BT_LIB_LOGD("Calling user's \"seek beginning\" method: %!+i",
-			iterator);
-		status = iterator->methods.seek_beginning(iterator);
-		BT_LOGD("User method returned: status=%s",
-			bt_common_func_status_string(status));
-		BT_ASSERT_POST(SEEK_BEGINNING_METHOD_NAME, "valid-status",
-			status == BT_FUNC_STATUS_OK ||
-			status == BT_FUNC_STATUS_ERROR ||
-			status == BT_FUNC_STATUS_MEMORY_ERROR ||
-			status == BT_FUNC_STATUS_AGAIN,
-			"Unexpected status: %![iter-]+i, status=%s",
-			iterator, bt_common_func_status_string(status));
-		if (status < 0) {
-			BT_LIB_LOGW_APPEND_CAUSE(
-				"Component input port message iterator's \"seek beginning\" method failed: "
-				"%![iter-]+i, status=%s",
-				iterator, bt_common_func_status_string(status));
-		}
+		if (resume_from_checkpoint) {
+			BT_LIB_LOGD("Auto-seeking from message iterator's checkpoint: "
+				"%![iter-]+i, ns=%" PRId64 ", checkpoint-min-ns=%" PRId64,
+				iterator, ns_from_origin,
+				iterator->seek_checkpoint.min_ns_from_origin);
+			stream_states = iterator->seek_checkpoint.stream_states;
+			iterator->seek_checkpoint.stream_states = NULL;
 
-		switch (status) {
-		case BT_FUNC_STATUS_OK:
-			break;
-		case BT_FUNC_STATUS_ERROR:
-		case BT_FUNC_STATUS_MEMORY_ERROR:
-		case BT_FUNC_STATUS_AGAIN:
-			goto end;
-		default:
-			bt_common_abort();
+			/*
+			 * find_message_ge_ns_from_origin() calls the
+			 * user's "next" method directly.
+			 */
+			if (iterator->auto_seek.original_next_callback) {
+				iterator->methods.next =
+					iterator->auto_seek.original_next_callback;
+				iterator->auto_seek.original_next_callback = NULL;
+			}
+		} else {
+			status = auto_seek_beginning(iterator);
+			if (status != BT_FUNC_STATUS_OK) {
+				goto end;
+			}
+
+			stream_states = create_auto_seek_stream_states();
+			if (!stream_states) {
+				BT_LIB_LOGE_APPEND_CAUSE(
+					"Failed to allocate one GHashTable.");
+				status = BT_FUNC_STATUS_MEMORY_ERROR;
+				goto end;
+			}
 		}
 
 		/*
@@ -1810,19 +2528,6 @@ bt_message_iterator_seek_ns_from_origin(
 		 * this point in the batch to this iterator's auto-seek
 		 * message queue.
 		 */
-		while (!g_queue_is_empty(iterator->auto_seek.msgs)) {
-			bt_object_put_ref_no_null_check(
-				g_queue_pop_tail(iterator->auto_seek.msgs));
-		}
-
-		stream_states = create_auto_seek_stream_states();
-		if (!stream_states) {
-			BT_LIB_LOGE_APPEND_CAUSE(
-				"Failed to allocate one GHashTable.");
-			status = BT_FUNC_STATUS_MEMORY_ERROR;
-			goto end;
-		}
-
 		status = find_message_ge_ns_from_origin(iterator,
 			ns_from_origin, stream_states);
 		switch (status) {
@@ -1960,6 +2665,22 @@ end:
 		stream_states = NULL;
 	}
 
+	if (status == BT_FUNC_STATUS_OK) {
+		/*
+		 * Start recording the auto-seek checkpoint after the
+		 * first successful auto-seek.
+		 */
+		if (!can_seek_by_itself &&
+				!iterator->seek_checkpoint.stream_states) {
+			iterator->seek_checkpoint.stream_states =
+				create_auto_seek_stream_states();
+		}
+
+		reset_seek_checkpoint(iterator, ns_from_origin);
+	} else {
+		invalidate_seek_checkpoint(iterator);
+	}
+
 	set_iterator_state_after_seeking(iterator, status);
 	return status;
 }
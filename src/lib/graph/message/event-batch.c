@@ -0,0 +1,454 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_LOG_TAG "LIB/MSG-EVENT-BATCH"
+#include "lib/logging.h"
+
+#include "common/assert.h"
+#include "lib/assert-cond.h"
+#include "compat/compiler.h"
+#include "lib/object.h"
+#include "lib/trace-ir/event-class.h"
+#include "lib/trace-ir/field-class.h"
+#include "lib/trace-ir/packet.h"
+#include "lib/trace-ir/stream.h"
+#include "lib/trace-ir/stream-class.h"
+#include "lib/graph/graph.h"
+#include <babeltrace2/graph/message.h>
+#include <babeltrace2/trace-ir/field-class.h>
+#include <babeltrace2/types.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "event-batch.h"
+#include "iterator.h"
+
+#define BT_ASSERT_PRE_DEV_MSG_IS_EVENT_BATCH(_msg)			\
+	BT_ASSERT_PRE_DEV_MSG_HAS_TYPE("message", (_msg), "event-batch",	\
+		BT_MESSAGE_TYPE_EVENT_BATCH)
+
+#define BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(_msg)				\
+	do {								\
+		BT_ASSERT_PRE_DEV_MSG_NON_NULL(_msg);			\
+		BT_ASSERT_PRE_DEV_MSG_IS_EVENT_BATCH(_msg);		\
+	} while (0)
+
+static
+bool field_class_is_supported(const struct bt_field_class *fc)
+{
+	return fc->type == BT_FIELD_CLASS_TYPE_BOOL ||
+		bt_field_class_type_is(fc->type,
+			BT_FIELD_CLASS_TYPE_INTEGER) ||
+		bt_field_class_type_is(fc->type,
+			BT_FIELD_CLASS_TYPE_REAL) ||
+		fc->type == BT_FIELD_CLASS_TYPE_STRING;
+}
+
+static
+bool event_class_is_supported(const struct bt_event_class *event_class)
+{
+	const struct bt_stream_class *stream_class =
+		bt_event_class_borrow_stream_class_inline(event_class);
+	const struct bt_field_class_structure *payload_fc =
+		(const void *) event_class->payload_fc;
+	bool is_supported = false;
+	uint64_t i;
+
+	BT_ASSERT(stream_class);
+
+	if (stream_class->event_common_context_fc ||
+			event_class->specific_context_fc) {
+		goto end;
+	}
+
+	if (payload_fc) {
+		for (i = 0; i < payload_fc->common.named_fcs->len; i++) {
+			const struct bt_named_field_class *named_fc =
+				payload_fc->common.named_fcs->pdata[i];
+
+			if (!field_class_is_supported(named_fc->fc)) {
+				goto end;
+			}
+		}
+	}
+
+	is_supported = true;
+
+end:
+	return is_supported;
+}
+
+bt_bool bt_message_event_batch_event_class_is_supported(
+		const struct bt_event_class *event_class)
+{
+	BT_ASSERT_PRE_EC_NON_NULL(event_class);
+	return (bt_bool) event_class_is_supported(event_class);
+}
+
+static
+void destroy_event_batch_message(struct bt_object *obj)
+{
+	struct bt_message_event_batch *message = (void *) obj;
+
+	BT_LIB_LOGD("Destroying event batch message: %!+n", message);
+	BT_LIB_LOGD("Putting event class: %!+E", message->event_class);
+	BT_OBJECT_PUT_REF_AND_RESET(message->event_class);
+	BT_LIB_LOGD("Putting stream: %!+s", message->stream);
+	BT_OBJECT_PUT_REF_AND_RESET(message->stream);
+
+	if (message->packet) {
+		BT_LIB_LOGD("Putting packet: %!+a", message->packet);
+		BT_OBJECT_PUT_REF_AND_RESET(message->packet);
+	}
+
+	g_free(message->default_cs_values);
+	g_free(message->columns);
+
+	if (message->strings) {
+		g_string_free(message->strings, TRUE);
+	}
+
+	g_free(message);
+}
+
+static
+struct bt_message *create_event_batch_message(
+		struct bt_self_message_iterator *self_msg_iter,
+		const struct bt_event_class *c_event_class,
+		const struct bt_packet *c_packet,
+		const struct bt_stream *c_stream, uint64_t capacity,
+		const char *api_func)
+{
+	struct bt_message_iterator *msg_iter = (void *) self_msg_iter;
+	struct bt_message_event_batch *message = NULL;
+	struct bt_event_class *event_class = (void *) c_event_class;
+	struct bt_packet *packet = (void *) c_packet;
+	struct bt_stream *stream = (void *) c_stream;
+	struct bt_stream_class *stream_class;
+
+	BT_ASSERT_DBG(stream);
+	BT_ASSERT_PRE_MSG_ITER_NON_NULL_FROM_FUNC(api_func, msg_iter);
+	BT_ASSERT_PRE_FROM_FUNC(api_func, "graph-mip-version-is-at-least-1",
+		msg_iter->graph->mip_version >= 1,
+		"Graph's MIP version doesn't support event batch messages: "
+		"%![graph-]+g", msg_iter->graph);
+	BT_ASSERT_PRE_EC_NON_NULL_FROM_FUNC(api_func, event_class);
+	BT_ASSERT_PRE_FROM_FUNC(api_func, "event-class-is-supported",
+		event_class_is_supported(event_class),
+		"Event class isn't supported by event batch messages: "
+		"%![ec-]+E", event_class);
+	stream_class = bt_event_class_borrow_stream_class_inline(event_class);
+	BT_ASSERT_DBG(stream_class);
+	BT_ASSERT_PRE_FROM_FUNC(api_func,
+		"stream-class-is-event-class-stream-class",
+		stream_class == stream->class,
+		"Stream's class and event's stream class differ: "
+		"%![ec-]+E, %![stream-]+s", event_class, stream);
+	BT_ASSERT_PRE_FROM_FUNC(api_func, "capacity-is-not-zero",
+		capacity > 0, "Event batch message capacity is zero.");
+	BT_LIB_LOGD("Creating event batch message object: "
+		"%![ec-]+E, %![stream-]+s, capacity=%" PRIu64,
+		event_class, stream, capacity);
+	message = g_new0(struct bt_message_event_batch, 1);
+	if (!message) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one event batch message.");
+		goto error;
+	}
+
+	bt_message_init(&message->parent, BT_MESSAGE_TYPE_EVENT_BATCH,
+		destroy_event_batch_message, NULL);
+	message->event_class = event_class;
+	bt_object_get_ref_no_null_check(&event_class->base);
+	message->stream = stream;
+	bt_object_get_ref_no_null_check_no_parent_check(&stream->base);
+
+	if (packet) {
+		BT_ASSERT_DBG(stream_class->supports_packets);
+		message->packet = packet;
+		bt_object_get_ref_no_null_check_no_parent_check(
+			&packet->base);
+	}
+
+	message->capacity = capacity;
+
+	if (stream_class->default_clock_class) {
+		message->default_cs_values = g_new(uint64_t, capacity);
+		if (!message->default_cs_values) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Failed to allocate default clock snapshot values: "
+				"capacity=%" PRIu64, capacity);
+			goto error;
+		}
+	}
+
+	if (event_class->payload_fc) {
+		const struct bt_field_class_structure *payload_fc =
+			(const void *) event_class->payload_fc;
+
+		message->column_count = payload_fc->common.named_fcs->len;
+	}
+
+	if (message->column_count > 0) {
+		message->columns = g_new0(uint64_t,
+			message->column_count * capacity);
+		if (!message->columns) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Failed to allocate payload columns: "
+				"column-count=%" PRIu64 ", capacity=%" PRIu64,
+				message->column_count, capacity);
+			goto error;
+		}
+	}
+
+	message->strings = g_string_new(NULL);
+	if (!message->strings) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GString.");
+		goto error;
+	}
+
+	if (packet) {
+		bt_packet_set_is_frozen(packet, true);
+	}
+
+	bt_stream_freeze(stream);
+	bt_event_class_freeze(event_class);
+	BT_LIB_LOGD("Created event batch message object: %!+n", message);
+	goto end;
+
+error:
+	BT_OBJECT_PUT_REF_AND_RESET(message);
+
+end:
+	return (void *) message;
+}
+
+struct bt_message *bt_message_event_batch_create(
+		struct bt_self_message_iterator *self_msg_iter,
+		const struct bt_event_class *event_class,
+		const struct bt_stream *stream, uint64_t capacity)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_STREAM_NON_NULL(stream);
+	return create_event_batch_message(self_msg_iter, event_class, NULL,
+		stream, capacity, __func__);
+}
+
+struct bt_message *bt_message_event_batch_create_with_packet(
+		struct bt_self_message_iterator *self_msg_iter,
+		const struct bt_event_class *event_class,
+		const struct bt_packet *packet, uint64_t capacity)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_PACKET_NON_NULL(packet);
+	return create_event_batch_message(self_msg_iter, event_class, packet,
+		packet->stream, capacity, __func__);
+}
+
+const struct bt_event_class *bt_message_event_batch_borrow_event_class_const(
+		const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	return ((const struct bt_message_event_batch *) msg)->event_class;
+}
+
+const struct bt_stream *bt_message_event_batch_borrow_stream_const(
+		const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	return ((const struct bt_message_event_batch *) msg)->stream;
+}
+
+const struct bt_packet *bt_message_event_batch_borrow_packet_const(
+		const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	return ((const struct bt_message_event_batch *) msg)->packet;
+}
+
+uint64_t bt_message_event_batch_get_capacity(const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	return ((const struct bt_message_event_batch *) msg)->capacity;
+}
+
+void bt_message_event_batch_set_event_count(struct bt_message *msg,
+		uint64_t count)
+{
+	struct bt_message_event_batch *batch_msg = (void *) msg;
+
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_HOT("message", msg, "Message", ": %!+n", msg);
+	BT_ASSERT_PRE_DEV("count-is-valid", count <= batch_msg->capacity,
+		"Event count is greater than the capacity: "
+		"count=%" PRIu64 ", %![msg-]+n", count, msg);
+	batch_msg->count = count;
+}
+
+uint64_t bt_message_event_batch_get_event_count(const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	return ((const struct bt_message_event_batch *) msg)->count;
+}
+
+#define BT_ASSERT_PRE_DEV_EVENT_BATCH_HAS_DEF_CLK_CLS(_msg)		\
+	BT_ASSERT_PRE_DEV("message-stream-class-has-default-clock-class", \
+		((const struct bt_message_event_batch *) (_msg))->default_cs_values, \
+		"Message's stream's class has no default clock class: "	\
+		"%![msg-]+n", (_msg))
+
+uint64_t *bt_message_event_batch_borrow_default_clock_snapshot_values(
+		struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_HOT("message", msg, "Message", ": %!+n", msg);
+	BT_ASSERT_PRE_DEV_EVENT_BATCH_HAS_DEF_CLK_CLS(msg);
+	return ((struct bt_message_event_batch *) msg)->default_cs_values;
+}
+
+const uint64_t *
+bt_message_event_batch_borrow_default_clock_snapshot_values_const(
+		const struct bt_message *msg)
+{
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_EVENT_BATCH_HAS_DEF_CLK_CLS(msg);
+	return ((const struct bt_message_event_batch *) msg)->default_cs_values;
+}
+
+void *bt_message_event_batch_borrow_payload_column(struct bt_message *msg,
+		uint64_t member_index)
+{
+	struct bt_message_event_batch *batch_msg = (void *) msg;
+
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_HOT("message", msg, "Message", ": %!+n", msg);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(member_index, batch_msg->column_count);
+	return bt_message_event_batch_column(batch_msg, member_index);
+}
+
+const void *bt_message_event_batch_borrow_payload_column_const(
+		const struct bt_message *msg, uint64_t member_index)
+{
+	const struct bt_message_event_batch *batch_msg = (const void *) msg;
+
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(member_index, batch_msg->column_count);
+	return bt_message_event_batch_column(batch_msg, member_index);
+}
+
+#define BT_ASSERT_PRE_DEV_EVENT_BATCH_MEMBER_IS_STRING(_msg, _index)	\
+	BT_ASSERT_PRE_DEV("payload-member-is-string",			\
+		((const struct bt_named_field_class *)			\
+			((const struct bt_field_class_structure *)	\
+				(_msg)->event_class->payload_fc)->common.named_fcs->pdata[_index])->fc->type == \
+			BT_FIELD_CLASS_TYPE_STRING,			\
+		"Payload member's class isn't a string field class: "	\
+		"index=%" PRIu64 ", %![msg-]+n", (_index), (_msg))
+
+enum bt_message_event_batch_set_payload_string_status
+bt_message_event_batch_set_payload_string(struct bt_message *msg,
+		uint64_t member_index, uint64_t event_index,
+		const char *value)
+{
+	struct bt_message_event_batch *batch_msg = (void *) msg;
+
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_HOT("message", msg, "Message", ": %!+n", msg);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(member_index, batch_msg->column_count);
+	BT_ASSERT_PRE_DEV_EVENT_BATCH_MEMBER_IS_STRING(batch_msg,
+		member_index);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(event_index, batch_msg->capacity);
+	BT_ASSERT_PRE_DEV_NON_NULL("value", value, "Value");
+	bt_message_event_batch_column(batch_msg, member_index)[event_index] =
+		batch_msg->strings->len;
+
+	/* Include the null character */
+	g_string_append_len(batch_msg->strings, value, strlen(value) + 1);
+	return BT_FUNC_STATUS_OK;
+}
+
+const char *bt_message_event_batch_get_payload_string(
+		const struct bt_message *msg, uint64_t member_index,
+		uint64_t event_index)
+{
+	const struct bt_message_event_batch *batch_msg = (const void *) msg;
+	uint64_t offset;
+
+	BT_ASSERT_PRE_DEV_FOR_EVENT_BATCH(msg);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(member_index, batch_msg->column_count);
+	BT_ASSERT_PRE_DEV_EVENT_BATCH_MEMBER_IS_STRING(batch_msg,
+		member_index);
+	BT_ASSERT_PRE_DEV_VALID_INDEX(event_index, batch_msg->count);
+	offset = bt_message_event_batch_column(batch_msg,
+		member_index)[event_index];
+	BT_ASSERT_DBG(offset < batch_msg->strings->len);
+	return &batch_msg->strings->str[offset];
+}
+
+BT_HIDDEN
+void bt_message_event_batch_remove_first_events(
+		struct bt_message_event_batch *msg, uint64_t count)
+{
+	uint64_t new_count;
+	uint64_t i;
+
+	BT_ASSERT(count <= msg->count);
+	new_count = msg->count - count;
+
+	if (msg->default_cs_values) {
+		memmove(msg->default_cs_values, &msg->default_cs_values[count],
+			new_count * sizeof(*msg->default_cs_values));
+	}
+
+	/* String offsets remain valid: the side buffer doesn't change */
+	for (i = 0; i < msg->column_count; i++) {
+		uint64_t *column = bt_message_event_batch_column(msg, i);
+
+		memmove(column, &column[count], new_count * sizeof(*column));
+	}
+
+	msg->count = new_count;
+}
+
+BT_HIDDEN
+struct bt_message *bt_message_event_batch_copy_without_first_events(
+		struct bt_message_iterator *msg_iter,
+		const struct bt_message_event_batch *msg, uint64_t count)
+{
+	struct bt_message_event_batch *copy;
+	uint64_t new_count;
+	uint64_t i;
+
+	BT_ASSERT(count < msg->count);
+	new_count = msg->count - count;
+	copy = (void *) create_event_batch_message((void *) msg_iter,
+		msg->event_class, msg->packet, msg->stream, new_count,
+		__func__);
+	if (!copy) {
+		goto end;
+	}
+
+	if (msg->default_cs_values) {
+		memcpy(copy->default_cs_values, &msg->default_cs_values[count],
+			new_count * sizeof(*copy->default_cs_values));
+	}
+
+	for (i = 0; i < msg->column_count; i++) {
+		memcpy(bt_message_event_batch_column(copy, i),
+			&bt_message_event_batch_column(msg, i)[count],
+			new_count * sizeof(*copy->columns));
+	}
+
+	/* Copy the whole side buffer to keep the string offsets valid */
+	g_string_append_len(copy->strings, msg->strings->str,
+		msg->strings->len);
+	copy->count = new_count;
+
+end:
+	return (void *) copy;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_GRAPH_MESSAGE_EVENT_BATCH_INTERNAL_H
+#define BABELTRACE_GRAPH_MESSAGE_EVENT_BATCH_INTERNAL_H
+
+#include <glib.h>
+#include <stdint.h>
+#include "common/macros.h"
+#include "lib/trace-ir/event-class.h"
+#include "lib/trace-ir/packet.h"
+#include "lib/trace-ir/stream.h"
+
+#include "message.h"
+
+struct bt_message_iterator;
+
+struct bt_message_event_batch {
+	struct bt_message parent;
+
+	/* Owned by this */
+	struct bt_event_class *event_class;
+
+	/* Owned by this */
+	struct bt_stream *stream;
+
+	/* Owned by this, `NULL` if the stream class doesn't support packets */
+	struct bt_packet *packet;
+
+	uint64_t capacity;
+	uint64_t count;
+
+	/*
+	 * Default clock snapshot values (`capacity` items), or `NULL`
+	 * if the stream class has no default clock class.
+	 */
+	uint64_t *default_cs_values;
+
+	/* Number of payload members */
+	uint64_t column_count;
+
+	/*
+	 * Payload columns: `column_count` × `capacity` 64-bit items,
+	 * column by column.
+	 */
+	uint64_t *columns;
+
+	/*
+	 * Side buffer of the string payload members: the item of such a
+	 * column is the offset of a null-terminated string within this.
+	 */
+	GString *strings;
+};
+
+static inline
+uint64_t *bt_message_event_batch_column(
+		const struct bt_message_event_batch *msg, uint64_t index)
+{
+	return &msg->columns[index * msg->capacity];
+}
+
+/*
+ * Removes the first `count` events of the event batch message `msg`,
+ * which must not be shared.
+ */
+BT_HIDDEN
+void bt_message_event_batch_remove_first_events(
+		struct bt_message_event_batch *msg, uint64_t count);
+
+/*
+ * Creates, from the message iterator `msg_iter`, a copy of the event
+ * batch message `msg` without its first `count` events.
+ *
+ * `count` must be less than the event count of `msg`.
+ */
+BT_HIDDEN
+struct bt_message *bt_message_event_batch_copy_without_first_events(
+		struct bt_message_iterator *msg_iter,
+		const struct bt_message_event_batch *msg, uint64_t count);
+
+#endif /* BABELTRACE_GRAPH_MESSAGE_EVENT_BATCH_INTERNAL_H */
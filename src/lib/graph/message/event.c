@@ -45,6 +45,7 @@ struct bt_message *bt_message_event_new(
 
 	bt_message_init(&message->parent, BT_MESSAGE_TYPE_EVENT,
 		(bt_object_release_func) bt_message_event_recycle, graph);
+	bt_clock_snapshot_init_inline(&message->default_cs_storage);
 	goto end;
 
 error:
@@ -160,11 +161,12 @@ struct bt_message *create_event_message(
 	 *   object could be unset).
 	 *
 	 * * We cannot destroy the message because we would need
-	 *   to notify the graph (pool owner) so that it removes the
-	 *   message from its message array.
+	 *   to notify the graph so that it removes the message from
+	 *   its message array, and to drop its reference on the pools
+	 *   of the message iterator.
 	 */
-	message = (void *) bt_message_create_from_pool(
-		&msg_iter->graph->event_msg_pool, msg_iter->graph);
+	message = (void *) bt_message_create_from_pool(msg_iter->msg_pools,
+		&msg_iter->msg_pools->event_msg_pool, msg_iter->graph);
 	if (G_UNLIKELY(!message)) {
 		/* bt_message_create_from_pool() logs errors */
 		goto error;
@@ -172,13 +174,9 @@ struct bt_message *create_event_message(
 
 	if (with_cs) {
 		BT_ASSERT_DBG(stream_class->default_clock_class);
-		message->default_cs = bt_clock_snapshot_create(
-			stream_class->default_clock_class);
-		if (!message->default_cs) {
-			goto error;
-		}
-
-		bt_clock_snapshot_set_raw_value(message->default_cs, raw_value);
+		message->default_cs = &message->default_cs_storage;
+		bt_clock_snapshot_set_inline(message->default_cs,
+			stream_class->default_clock_class, raw_value);
 	}
 
 	BT_ASSERT_DBG(!message->event);
@@ -263,7 +261,7 @@ void bt_message_event_destroy(struct bt_message *msg)
 	}
 
 	if (event_msg->default_cs) {
-		bt_clock_snapshot_recycle(event_msg->default_cs);
+		bt_clock_snapshot_reset_inline(event_msg->default_cs);
 		event_msg->default_cs = NULL;
 	}
 
@@ -274,12 +272,14 @@ BT_HIDDEN
 void bt_message_event_recycle(struct bt_message *msg)
 {
 	struct bt_message_event *event_msg = (void *) msg;
-	struct bt_graph *graph;
+	struct bt_message_pools *pools;
 
 	BT_ASSERT_DBG(event_msg);
+	BT_ASSERT_DBG(msg->pools);
 
-	if (G_UNLIKELY(!msg->graph)) {
-		bt_message_event_destroy(msg);
+	if (G_UNLIKELY(!msg->graph || msg->pools->is_orphaned)) {
+		bt_message_pools_destroy_message(msg,
+			bt_message_event_destroy);
 		return;
 	}
 
@@ -291,13 +291,15 @@ void bt_message_event_recycle(struct bt_message *msg)
 	event_msg->event = NULL;
 
 	if (event_msg->default_cs) {
-		bt_clock_snapshot_recycle(event_msg->default_cs);
+		bt_clock_snapshot_reset_inline(event_msg->default_cs);
 		event_msg->default_cs = NULL;
 	}
 
-	graph = msg->graph;
+	pools = msg->pools;
 	msg->graph = NULL;
-	bt_object_pool_recycle_object(&graph->event_msg_pool, msg);
+	msg->pools = NULL;
+	bt_object_pool_recycle_object(&pools->event_msg_pool, msg);
+	bt_message_pools_put(pools);
 }
 
 #define BT_ASSERT_PRE_DEV_FOR_BORROW_EVENTS(_msg)			\
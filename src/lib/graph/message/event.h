@@ -13,6 +13,7 @@
 #include <babeltrace2/trace-ir/event.h>
 #include "common/assert.h"
 #include "common/macros.h"
+#include "lib/trace-ir/clock-snapshot.h"
 
 #include "message.h"
 
@@ -23,7 +24,20 @@ extern "C" {
 struct bt_message_event {
 	struct bt_message parent;
 	struct bt_event *event;
+
+	/*
+	 * Points to `default_cs_storage` if this message has a default
+	 * clock snapshot, or `NULL` otherwise.
+	 */
 	struct bt_clock_snapshot *default_cs;
+
+	/*
+	 * Inline storage of the default clock snapshot, so that
+	 * creating this message doesn't need a clock snapshot from the
+	 * clock class's pool. The event's stream class keeps its clock
+	 * class alive.
+	 */
+	struct bt_clock_snapshot default_cs_storage;
 };
 
 BT_HIDDEN
@@ -15,10 +15,25 @@
 #include <babeltrace2/types.h>
 #include "common/assert.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include "common/uuid.h"
 
 struct bt_port;
 struct bt_graph;
+struct bt_graph_profile_entry;
+struct bt_message_pools;
+
+/* Initial (and, by default, maximum) message batch capacity */
+#define BT_MESSAGE_ITERATOR_DEFAULT_BATCH_SIZE		15
+
+/* Absolute maximum message batch capacity */
+#define BT_MESSAGE_ITERATOR_MAX_BATCH_SIZE		1024
+
+/*
+ * Number of consecutive full batches after which the message iterator
+ * doubles its batch capacity.
+ */
+#define BT_MESSAGE_ITERATOR_BATCH_GROW_THRESHOLD	4
 
 enum bt_message_iterator_state {
 	/* Iterator is not initialized */
@@ -72,6 +87,13 @@ typedef enum bt_message_iterator_class_can_seek_beginning_method_status
 struct bt_self_message_iterator_configuration {
 	bool frozen;
 	bool can_seek_forward;
+
+	/*
+	 * Maximum capacity of the message array passed to the "next"
+	 * method, as requested by the message iterator during its
+	 * initialization.
+	 */
+	uint64_t max_batch_size;
 };
 
 struct bt_message_iterator {
@@ -83,6 +105,41 @@ struct bt_message_iterator {
 	struct bt_graph *graph; /* Weak */
 	struct bt_self_message_iterator_configuration config;
 
+	/*
+	 * Adaptive batch state.
+	 *
+	 * `size` is the current capacity passed to the "next" method
+	 * (at most `msgs->len`: bt_self_message_iterator_forward_next()
+	 * can swap `msgs` with a larger array). It starts at
+	 * `BT_MESSAGE_ITERATOR_DEFAULT_BATCH_SIZE` and doubles, up to
+	 * `config.max_batch_size`, every time the "next" method fills
+	 * `BT_MESSAGE_ITERATOR_BATCH_GROW_THRESHOLD` consecutive full
+	 * batches.
+	 */
+	struct {
+		uint64_t size;
+		uint64_t consecutive_full_count;
+	} batch;
+
+	/*
+	 * Capacity passed to the current (or last) "next" method call
+	 * (see bt_self_message_iterator_forward_next()).
+	 */
+	uint64_t next_capacity;
+
+	/*
+	 * Profile entry (owned by the graph), or `NULL` if the graph's
+	 * profiling is disabled.
+	 */
+	struct bt_graph_profile_entry *profile_entry;
+
+	/*
+	 * Pools of the event and packet messages which this iterator
+	 * creates (owned by this until this iterator is finalized; see
+	 * `struct bt_message_pools`).
+	 */
+	struct bt_message_pools *msg_pools;
+
 	/*
 	 * Array of
 	 * `struct bt_message_iterator *`
@@ -180,7 +237,49 @@ struct bt_message_iterator {
 		void *original_next_callback;
 	} auto_seek;
 
+	/*
+	 * Auto-seek checkpoint: the state of the streams after the last
+	 * message which this iterator returned.
+	 *
+	 * When this checkpoint is valid, an auto-seek to a time greater
+	 * than or equal to `min_ns_from_origin` fast-forwards from the
+	 * current position of the upstream message iterator instead of
+	 * seeking its beginning and replaying all its messages.
+	 *
+	 * This iterator only starts recording the checkpoint after its
+	 * first successful auto-seek (`stream_states` is `NULL` until
+	 * then), so that iterators which never auto-seek don't pay for
+	 * it.
+	 */
+	struct {
+		/*
+		 * Hash table of `const bt_stream *` (strong reference)
+		 * to `struct auto_seek_stream_state *` (owned by this
+		 * table).
+		 */
+		GHashTable *stream_states;
+
+		/*
+		 * The upstream message iterator skipped or this
+		 * iterator returned all the messages before this time.
+		 */
+		int64_t min_ns_from_origin;
+
+		bool valid;
+
+		/* Last stream state which an event message updated */
+		const struct bt_stream *last_stream; /* Weak */
+		struct auto_seek_stream_state *last_stream_state;
+	} seek_checkpoint;
+
 	void *user_data;
+
+	/*
+	 * Key of the data this message iterator attaches to streams
+	 * (see bt_self_message_iterator_set_stream_data()), unique
+	 * within its graph and never reused.
+	 */
+	uint64_t stream_data_key;
 };
 
 BT_HIDDEN
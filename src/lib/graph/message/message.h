@@ -22,6 +22,8 @@
 #include "lib/object-pool.h"
 #include <babeltrace2/types.h>
 
+#include "pools.h"
+
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
 #ifndef BT_LIB_LOG_SUPPORTED
 # error Please include "lib/logging.h" before including this file.
@@ -37,6 +39,15 @@ struct bt_message {
 
 	/* Owned by this; keeps the graph alive while the msg. is alive */
 	struct bt_graph *graph;
+
+	/*
+	 * Pools of the message iterator which created this message, if
+	 * it comes from one of them (see `struct bt_message_pools`).
+	 *
+	 * A message at large owns a reference on its pools; a recycled
+	 * message doesn't.
+	 */
+	struct bt_message_pools *pools;
 };
 
 BT_HIDDEN
@@ -57,7 +68,8 @@ void bt_message_reset(struct bt_message *message)
 
 static inline
 struct bt_message *bt_message_create_from_pool(
-		struct bt_object_pool *pool, struct bt_graph *graph)
+		struct bt_message_pools *pools, struct bt_object_pool *pool,
+		struct bt_graph *graph)
 {
 	struct bt_message *msg = bt_object_pool_create_object(pool);
 
@@ -72,6 +84,10 @@ struct bt_message *bt_message_create_from_pool(
 		msg->graph = graph;
 	}
 
+	BT_ASSERT_DBG(!msg->pools);
+	msg->pools = pools;
+	bt_message_pools_get(pools);
+
 	goto end;
 
 error:
@@ -113,6 +129,8 @@ const char *bt_message_type_string(enum bt_message_type type)
 		return "PACKET_END";
 	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
 		return "DISCARDED_EVENTS";
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+		return "EVENT_BATCH";
 	default:
 		return "(unknown)";
 	}
@@ -48,6 +48,7 @@ struct bt_message *new_packet_message(struct bt_graph *graph,
 	}
 
 	bt_message_init(&message->parent, type, recycle_func, graph);
+	bt_clock_snapshot_init_inline(&message->default_cs_storage);
 	goto end;
 
 error:
@@ -74,12 +75,13 @@ struct bt_message *bt_message_packet_end_new(struct bt_graph *graph)
 static inline
 struct bt_message *create_packet_message(
 		struct bt_message_iterator *msg_iter,
-		struct bt_packet *packet, struct bt_object_pool *pool,
+		struct bt_packet *packet, enum bt_message_type type,
 		bool with_cs, uint64_t raw_value, const char *api_func)
 {
 	struct bt_message_packet *message = NULL;
 	struct bt_stream *stream;
 	struct bt_stream_class *stream_class;
+	struct bt_object_pool *pool;
 	bool need_cs;
 
 	BT_ASSERT(msg_iter);
@@ -95,9 +97,11 @@ struct bt_message *create_packet_message(
 	 */
 	BT_ASSERT(stream_class->supports_packets);
 
-	if (pool == &msg_iter->graph->packet_begin_msg_pool) {
+	if (type == BT_MESSAGE_TYPE_PACKET_BEGINNING) {
+		pool = &msg_iter->msg_pools->packet_begin_msg_pool;
 		need_cs = stream_class->packets_have_beginning_default_clock_snapshot;
 	} else {
+		pool = &msg_iter->msg_pools->packet_end_msg_pool;
 		need_cs = stream_class->packets_have_end_default_clock_snapshot;
 	}
 
@@ -124,7 +128,8 @@ struct bt_message *create_packet_message(
 	BT_LIB_LOGD("Creating packet message object: "
 		"%![packet-]+a, %![stream-]+s, %![sc-]+S",
 		packet, stream, stream_class);
-	message = (void *) bt_message_create_from_pool(pool, msg_iter->graph);
+	message = (void *) bt_message_create_from_pool(msg_iter->msg_pools,
+		pool, msg_iter->graph);
 	if (!message) {
 		/* bt_message_create_from_pool() logs errors */
 		goto end;
@@ -132,15 +137,9 @@ struct bt_message *create_packet_message(
 
 	if (with_cs) {
 		BT_ASSERT(stream_class->default_clock_class);
-		message->default_cs = bt_clock_snapshot_create(
-			stream_class->default_clock_class);
-		if (!message->default_cs) {
-			bt_object_put_ref_no_null_check(message);
-			message = NULL;
-			goto end;
-		}
-
-		bt_clock_snapshot_set_raw_value(message->default_cs, raw_value);
+		message->default_cs = &message->default_cs_storage;
+		bt_clock_snapshot_set_inline(message->default_cs,
+			stream_class->default_clock_class, raw_value);
 	}
 
 	BT_ASSERT(!message->packet);
@@ -167,7 +166,7 @@ struct bt_message *bt_message_packet_beginning_create(
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(msg_iter);
 	return create_packet_message(msg_iter, (void *) packet,
-		&msg_iter->graph->packet_begin_msg_pool, false, 0, __func__);
+		BT_MESSAGE_TYPE_PACKET_BEGINNING, false, 0, __func__);
 }
 
 struct bt_message *bt_message_packet_beginning_create_with_default_clock_snapshot(
@@ -180,7 +179,7 @@ struct bt_message *bt_message_packet_beginning_create_with_default_clock_snapsho
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(msg_iter);
 	return create_packet_message(msg_iter, (void *) packet,
-		&msg_iter->graph->packet_begin_msg_pool, true, raw_value,
+		BT_MESSAGE_TYPE_PACKET_BEGINNING, true, raw_value,
 		__func__);
 }
 
@@ -194,7 +193,7 @@ struct bt_message *bt_message_packet_end_create(
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(msg_iter);
 	return create_packet_message(msg_iter, (void *) packet,
-		&msg_iter->graph->packet_end_msg_pool, false, 0, __func__);
+		BT_MESSAGE_TYPE_PACKET_END, false, 0, __func__);
 }
 
 struct bt_message *bt_message_packet_end_create_with_default_clock_snapshot(
@@ -207,7 +206,7 @@ struct bt_message *bt_message_packet_end_create_with_default_clock_snapshot(
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(msg_iter);
 	return create_packet_message(msg_iter, (void *) packet,
-		&msg_iter->graph->packet_end_msg_pool, true, raw_value,
+		BT_MESSAGE_TYPE_PACKET_END, true, raw_value,
 		__func__);
 }
 
@@ -221,7 +220,7 @@ void bt_message_packet_destroy(struct bt_message *msg)
 	BT_OBJECT_PUT_REF_AND_RESET(packet_msg->packet);
 
 	if (packet_msg->default_cs) {
-		bt_clock_snapshot_recycle(packet_msg->default_cs);
+		bt_clock_snapshot_reset_inline(packet_msg->default_cs);
 		packet_msg->default_cs = NULL;
 	}
 
@@ -232,45 +231,52 @@ static inline
 void recycle_packet_message(struct bt_message *msg, struct bt_object_pool *pool)
 {
 	struct bt_message_packet *packet_msg = (void *) msg;
+	struct bt_message_pools *pools = msg->pools;
 
 	BT_LIB_LOGD("Recycling packet message: %!+n", msg);
 	bt_message_reset(msg);
 	bt_object_put_ref_no_null_check(&packet_msg->packet->base);
 
 	if (packet_msg->default_cs) {
-		bt_clock_snapshot_recycle(packet_msg->default_cs);
+		bt_clock_snapshot_reset_inline(packet_msg->default_cs);
 		packet_msg->default_cs = NULL;
 	}
 
 	packet_msg->packet = NULL;
 	msg->graph = NULL;
+	msg->pools = NULL;
 	bt_object_pool_recycle_object(pool, msg);
+	bt_message_pools_put(pools);
 }
 
 BT_HIDDEN
 void bt_message_packet_beginning_recycle(struct bt_message *msg)
 {
 	BT_ASSERT(msg);
+	BT_ASSERT(msg->pools);
 
-	if (G_UNLIKELY(!msg->graph)) {
-		bt_message_packet_destroy(msg);
+	if (G_UNLIKELY(!msg->graph || msg->pools->is_orphaned)) {
+		bt_message_pools_destroy_message(msg,
+			bt_message_packet_destroy);
 		return;
 	}
 
-	recycle_packet_message(msg, &msg->graph->packet_begin_msg_pool);
+	recycle_packet_message(msg, &msg->pools->packet_begin_msg_pool);
 }
 
 BT_HIDDEN
 void bt_message_packet_end_recycle(struct bt_message *msg)
 {
 	BT_ASSERT(msg);
+	BT_ASSERT(msg->pools);
 
-	if (G_UNLIKELY(!msg->graph)) {
-		bt_message_packet_destroy(msg);
+	if (G_UNLIKELY(!msg->graph || msg->pools->is_orphaned)) {
+		bt_message_pools_destroy_message(msg,
+			bt_message_packet_destroy);
 		return;
 	}
 
-	recycle_packet_message(msg, &msg->graph->packet_end_msg_pool);
+	recycle_packet_message(msg, &msg->pools->packet_end_msg_pool);
 }
 
 struct bt_packet *bt_message_packet_beginning_borrow_packet(
@@ -19,7 +19,20 @@
 struct bt_message_packet {
 	struct bt_message parent;
 	struct bt_packet *packet;
+
+	/*
+	 * Points to `default_cs_storage` if this message has a default
+	 * clock snapshot, or `NULL` otherwise.
+	 */
 	struct bt_clock_snapshot *default_cs;
+
+	/*
+	 * Inline storage of the default clock snapshot, so that
+	 * creating this message doesn't need a clock snapshot from the
+	 * clock class's pool. The packet's stream class keeps its clock
+	 * class alive.
+	 */
+	struct bt_clock_snapshot default_cs_storage;
 };
 
 BT_HIDDEN
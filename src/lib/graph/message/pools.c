@@ -0,0 +1,166 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_LOG_TAG "LIB/MSG-POOLS"
+#include "lib/logging.h"
+
+#include <glib.h>
+#include <inttypes.h>
+#include "common/assert.h"
+#include "lib/assert-cond.h"
+#include "lib/graph/graph.h"
+#include "lib/object-pool.h"
+
+#include "event.h"
+#include "message.h"
+#include "packet.h"
+#include "pools.h"
+
+static
+void *new_event_message(struct bt_message_pools *pools)
+{
+	return bt_message_event_new(pools->graph);
+}
+
+static
+void *new_packet_beginning_message(struct bt_message_pools *pools)
+{
+	return bt_message_packet_beginning_new(pools->graph);
+}
+
+static
+void *new_packet_end_message(struct bt_message_pools *pools)
+{
+	return bt_message_packet_end_new(pools->graph);
+}
+
+/*
+ * Called when a pool destroys a recycled message, either because the
+ * pool is at its high-water mark or when the pools become orphaned.
+ *
+ * In both cases, the graph of `pools` still exists.
+ */
+static
+void destroy_event_message(struct bt_message *msg,
+		struct bt_message_pools *pools)
+{
+	bt_graph_remove_message(pools->graph, msg);
+	bt_message_event_destroy(msg);
+}
+
+static
+void destroy_packet_message(struct bt_message *msg,
+		struct bt_message_pools *pools)
+{
+	bt_graph_remove_message(pools->graph, msg);
+	bt_message_packet_destroy(msg);
+}
+
+BT_HIDDEN
+struct bt_message_pools *bt_message_pools_create(struct bt_graph *graph)
+{
+	struct bt_message_pools *pools;
+	int ret;
+
+	BT_ASSERT(graph);
+	pools = g_new0(struct bt_message_pools, 1);
+	if (!pools) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one message pool set.");
+		goto error;
+	}
+
+	pools->ref_count = 1;
+	pools->graph = graph;
+	ret = bt_object_pool_initialize(&pools->event_msg_pool,
+		(bt_object_pool_new_object_func) new_event_message,
+		(bt_object_pool_destroy_object_func) destroy_event_message,
+		pools);
+	if (ret) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to initialize event message pool: ret=%d",
+			ret);
+		goto error;
+	}
+
+	ret = bt_object_pool_initialize(&pools->packet_begin_msg_pool,
+		(bt_object_pool_new_object_func) new_packet_beginning_message,
+		(bt_object_pool_destroy_object_func) destroy_packet_message,
+		pools);
+	if (ret) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to initialize packet beginning message pool: ret=%d",
+			ret);
+		goto error;
+	}
+
+	ret = bt_object_pool_initialize(&pools->packet_end_msg_pool,
+		(bt_object_pool_new_object_func) new_packet_end_message,
+		(bt_object_pool_destroy_object_func) destroy_packet_message,
+		pools);
+	if (ret) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to initialize packet end message pool: ret=%d",
+			ret);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	if (pools) {
+		bt_message_pools_orphan(pools);
+		pools = NULL;
+	}
+
+end:
+	return pools;
+}
+
+BT_HIDDEN
+void bt_message_pools_orphan(struct bt_message_pools *pools)
+{
+	BT_ASSERT(pools);
+	BT_ASSERT(!pools->is_orphaned);
+	BT_LOGD("Orphaning message pools: addr=%p, "
+		"msgs-at-large=%" PRIu64, pools, pools->ref_count - 1);
+	pools->is_orphaned = true;
+	bt_object_pool_finalize(&pools->event_msg_pool);
+	bt_object_pool_finalize(&pools->packet_begin_msg_pool);
+	bt_object_pool_finalize(&pools->packet_end_msg_pool);
+	bt_message_pools_put(pools);
+}
+
+BT_HIDDEN
+void bt_message_pools_destroy_message(struct bt_message *msg,
+		void (*destroy_func)(struct bt_message *))
+{
+	struct bt_message_pools *pools;
+
+	BT_ASSERT(msg);
+	pools = msg->pools;
+	BT_ASSERT(pools);
+
+	/*
+	 * If the graph of `msg` is already destroyed, then it already
+	 * forgot `msg`.
+	 */
+	if (msg->graph) {
+		bt_graph_remove_message(msg->graph, msg);
+	}
+
+	destroy_func(msg);
+	bt_message_pools_put(pools);
+}
+
+BT_HIDDEN
+void _bt_message_pools_destroy(struct bt_message_pools *pools)
+{
+	BT_ASSERT(pools);
+	BT_ASSERT(pools->is_orphaned);
+	BT_LOGD("Destroying message pools: addr=%p", pools);
+	g_free(pools);
+}
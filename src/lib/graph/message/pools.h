@@ -0,0 +1,116 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_GRAPH_MESSAGE_POOLS_INTERNAL_H
+#define BABELTRACE_GRAPH_MESSAGE_POOLS_INTERNAL_H
+
+/* Protection: this file uses BT_LIB_LOG*() macros directly */
+#ifndef BT_LIB_LOG_SUPPORTED
+# error Please include "lib/logging.h" before including this file.
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "common/assert.h"
+#include "common/macros.h"
+#include "lib/object-pool.h"
+
+struct bt_graph;
+struct bt_message;
+
+/*
+ * Message pools of a message iterator.
+ *
+ * Each message iterator owns its own set of pools so that the event
+ * and packet messages which it creates come from, and go back to, a
+ * set of recycled objects which only this iterator uses: with many
+ * decoding iterators in a graph (for example, one per data stream
+ * file), the objects of one iterator remain hot instead of being
+ * shared with all the others.
+ *
+ * A message created from those pools keeps a reference on them
+ * (`struct bt_message::pools`) so that it always goes back to the
+ * pools of its creating iterator, even when a downstream component
+ * puts it.
+ *
+ * When its message iterator is finalized, the pools become orphaned:
+ * they destroy their recycled messages, and each message still at
+ * large is destroyed instead of being recycled when its reference
+ * count drops to 0. The pools are freed when their last reference
+ * is dropped.
+ *
+ * Like the messages themselves, the pools are not thread-safe: a
+ * message must be put from the thread of its graph.
+ */
+struct bt_message_pools {
+	/*
+	 * Number of owners: the message iterator, until it's
+	 * finalized, and the messages at large which come from those
+	 * pools.
+	 */
+	uint64_t ref_count;
+
+	/* Graph of the message iterator (weak) */
+	struct bt_graph *graph;
+
+	/* True once the message iterator is finalized */
+	bool is_orphaned;
+
+	/* Pool of `struct bt_message_event *` */
+	struct bt_object_pool event_msg_pool;
+
+	/* Pool of `struct bt_message_packet_beginning *` */
+	struct bt_object_pool packet_begin_msg_pool;
+
+	/* Pool of `struct bt_message_packet_end *` */
+	struct bt_object_pool packet_end_msg_pool;
+};
+
+/*
+ * Creates message pools for a message iterator of `graph`, with a
+ * single reference.
+ */
+BT_HIDDEN
+struct bt_message_pools *bt_message_pools_create(struct bt_graph *graph);
+
+/*
+ * Drops the reference of the message iterator on `pools` after
+ * destroying their recycled messages.
+ */
+BT_HIDDEN
+void bt_message_pools_orphan(struct bt_message_pools *pools);
+
+/*
+ * Destroys the message `msg`, which comes from the pools `msg->pools`,
+ * with `destroy_func` instead of recycling it, and drops its reference
+ * on those pools.
+ */
+BT_HIDDEN
+void bt_message_pools_destroy_message(struct bt_message *msg,
+		void (*destroy_func)(struct bt_message *));
+
+BT_HIDDEN
+void _bt_message_pools_destroy(struct bt_message_pools *pools);
+
+static inline
+void bt_message_pools_get(struct bt_message_pools *pools)
+{
+	BT_ASSERT_DBG(pools);
+	pools->ref_count++;
+}
+
+static inline
+void bt_message_pools_put(struct bt_message_pools *pools)
+{
+	BT_ASSERT_DBG(pools);
+	BT_ASSERT_DBG(pools->ref_count > 0);
+
+	if (G_UNLIKELY(--pools->ref_count == 0)) {
+		_bt_message_pools_destroy(pools);
+	}
+}
+
+#endif /* BABELTRACE_GRAPH_MESSAGE_POOLS_INTERNAL_H */
@@ -20,6 +20,9 @@
 #include "component-descriptor-set.h"
 #include "lib/integer-range-set.h"
 
+/* Greatest MIP version which this library supports */
+#define MAX_MIP_VERSION	1
+
 static
 bool unsigned_integer_range_set_contains(
 		const struct bt_integer_range_set *range_set, uint64_t value)
@@ -44,16 +47,16 @@ end:
 }
 
 /*
- * As of this version, this function only validates that all the
- * component descriptors in `descriptors` support MIP version 0, which
- * is the only version supported by this library.
+ * Removes, from `*versions` (a bit per MIP version which this library
+ * supports), the MIP versions which any component descriptor in
+ * `descriptors` does not support.
  *
- * If any component descriptor does not support MIP version 0, then this
- * function returns `BT_FUNC_STATUS_NO_MATCH`.
+ * A component class without a "get supported MIP versions" method only
+ * supports MIP version 0.
  */
 static
-int validate_operative_mip_version_in_array(GPtrArray *descriptors,
-		enum bt_logging_level log_level)
+int narrow_operative_mip_versions_in_array(GPtrArray *descriptors,
+		enum bt_logging_level log_level, uint64_t *versions)
 {
 	typedef bt_component_class_get_supported_mip_versions_method_status
 		(*method_t)(
@@ -65,6 +68,7 @@ int validate_operative_mip_version_in_array(GPtrArray *descriptors,
 
 	int status = BT_FUNC_STATUS_OK;
 	uint64_t i;
+	uint64_t version;
 	struct bt_integer_range_set *range_set = NULL;
 
 	for (i = 0; i < descriptors->len; i++) {
@@ -108,6 +112,7 @@ int validate_operative_mip_version_in_array(GPtrArray *descriptors,
 
 		if (!method) {
 			/* Assume 0 */
+			*versions &= UINT64_C(1);
 			continue;
 		}
 
@@ -148,14 +153,11 @@ int validate_operative_mip_version_in_array(GPtrArray *descriptors,
 			goto end;
 		}
 
-		if (!unsigned_integer_range_set_contains(range_set, 0)) {
-			/*
-			 * Supported MIP versions do not include 0,
-			 * which is the only MIP versions currently
-			 * supported by the library itself.
-			 */
-			status = BT_FUNC_STATUS_NO_MATCH;
-			goto end;
+		for (version = 0; version <= MAX_MIP_VERSION; version++) {
+			if (!unsigned_integer_range_set_contains(range_set,
+					version)) {
+				*versions &= ~(UINT64_C(1) << version);
+			}
 		}
 
 		BT_OBJECT_PUT_REF_AND_RESET(range_set);
@@ -167,14 +169,11 @@ end:
 }
 
 /*
- * The purpose of this function is eventually to find the greatest
- * common supported MIP version amongst all the component descriptors.
- * But as of this version of the library, only MIP version 0 is
- * supported, so it only checks that they all support MIP version 0 and
- * always sets `*operative_mip_version` to 0.
+ * Finds the greatest common supported MIP version, amongst the ones
+ * which this library supports, of all the component descriptors.
  *
- * When any component descriptor does not support MIP version 0, this
- * function returns `BT_FUNC_STATUS_NO_MATCH`.
+ * When there's no such version, this function returns
+ * `BT_FUNC_STATUS_NO_MATCH`.
  */
 enum bt_get_greatest_operative_mip_version_status
 bt_get_greatest_operative_mip_version(
@@ -183,6 +182,8 @@ bt_get_greatest_operative_mip_version(
 		uint64_t *operative_mip_version)
 {
 	int status = BT_FUNC_STATUS_OK;
+	uint64_t versions = (UINT64_C(1) << (MAX_MIP_VERSION + 1)) - 1;
+	int64_t version;
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_COMP_DESCR_SET_NON_NULL(comp_descr_set);
@@ -194,25 +195,32 @@ bt_get_greatest_operative_mip_version(
 		comp_descr_set->filters->len +
 		comp_descr_set->sinks->len > 0,
 		"Component descriptor set is empty: addr=%p", comp_descr_set);
-	status = validate_operative_mip_version_in_array(
-		comp_descr_set->sources, log_level);
+	status = narrow_operative_mip_versions_in_array(
+		comp_descr_set->sources, log_level, &versions);
 	if (status) {
 		goto end;
 	}
 
-	status = validate_operative_mip_version_in_array(
-		comp_descr_set->filters, log_level);
+	status = narrow_operative_mip_versions_in_array(
+		comp_descr_set->filters, log_level, &versions);
 	if (status) {
 		goto end;
 	}
 
-	status = validate_operative_mip_version_in_array(
-		comp_descr_set->sinks, log_level);
+	status = narrow_operative_mip_versions_in_array(
+		comp_descr_set->sinks, log_level, &versions);
 	if (status) {
 		goto end;
 	}
 
-	*operative_mip_version = 0;
+	for (version = MAX_MIP_VERSION; version >= 0; version--) {
+		if (versions & (UINT64_C(1) << version)) {
+			*operative_mip_version = (uint64_t) version;
+			goto end;
+		}
+	}
+
+	status = BT_FUNC_STATUS_NO_MATCH;
 
 end:
 	return status;
@@ -220,5 +228,5 @@ end:
 
 uint64_t bt_get_maximal_mip_version(void)
 {
-	return 0;
+	return MAX_MIP_VERSION;
 }
@@ -0,0 +1,271 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_LOG_TAG "LIB/GRAPH-PROFILE"
+#include "lib/logging.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <glib.h>
+#include <babeltrace2/babeltrace.h>
+
+#include "common/assert.h"
+#include "profile.h"
+
+static
+void destroy_entry(struct bt_graph_profile_entry *entry)
+{
+	if (!entry) {
+		goto end;
+	}
+
+	if (entry->comp_name) {
+		g_string_free(entry->comp_name, TRUE);
+	}
+
+	if (entry->port_name) {
+		g_string_free(entry->port_name, TRUE);
+	}
+
+	g_free(entry);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int bt_graph_profile_enable(struct bt_graph_profile *profile,
+		uint64_t sampling_period)
+{
+	int ret = 0;
+
+	BT_ASSERT(sampling_period > 0);
+
+	if (!profile->entries) {
+		profile->entries = g_ptr_array_new_with_free_func(
+			(GDestroyNotify) destroy_entry);
+		if (!profile->entries) {
+			BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	profile->sampling_period = sampling_period;
+	profile->enabled = true;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void bt_graph_profile_fini(struct bt_graph_profile *profile)
+{
+	if (profile->entries) {
+		g_ptr_array_free(profile->entries, TRUE);
+		profile->entries = NULL;
+	}
+
+	profile->enabled = false;
+}
+
+BT_HIDDEN
+struct bt_graph_profile_entry *bt_graph_profile_create_entry(
+		struct bt_graph_profile *profile, const char *comp_name,
+		const char *port_name)
+{
+	struct bt_graph_profile_entry *entry;
+
+	BT_ASSERT(profile->enabled);
+	BT_ASSERT(comp_name);
+	entry = g_new0(struct bt_graph_profile_entry, 1);
+	if (!entry) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one graph profile entry.");
+		goto error;
+	}
+
+	entry->is_sink = !port_name;
+	entry->comp_name = g_string_new(comp_name);
+	if (!entry->comp_name) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GString.");
+		goto error;
+	}
+
+	if (port_name) {
+		entry->port_name = g_string_new(port_name);
+		if (!entry->port_name) {
+			BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GString.");
+			goto error;
+		}
+	}
+
+	g_ptr_array_add(profile->entries, entry);
+	BT_LOGD("Created graph profile entry: comp-name=\"%s\", "
+		"port-name=\"%s\"", comp_name, port_name ? port_name : "");
+	goto end;
+
+error:
+	destroy_entry(entry);
+	entry = NULL;
+
+end:
+	return entry;
+}
+
+static inline
+uint64_t timespec_to_ns(const struct timespec *ts)
+{
+	return (uint64_t) ts->tv_sec * UINT64_C(1000000000) +
+		(uint64_t) ts->tv_nsec;
+}
+
+BT_HIDDEN
+void bt_graph_profile_get_times(uint64_t *wall_ns, uint64_t *cpu_ns)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+		*wall_ns = timespec_to_ns(&ts);
+	} else {
+		*wall_ns = 0;
+	}
+
+	/*
+	 * The CPU time of the current thread: all the calls of a graph
+	 * run on the same thread.
+	 */
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+		*cpu_ns = timespec_to_ns(&ts);
+	} else {
+		*cpu_ns = 0;
+	}
+}
+
+/*
+ * Estimates the total time of all the calls of `entry` from the time
+ * `sampled_ns` of its timed calls.
+ */
+static
+uint64_t estimate_ns(const struct bt_graph_profile_entry *entry,
+		uint64_t sampled_ns)
+{
+	if (entry->sampled_call_count == 0) {
+		return 0;
+	}
+
+	if (entry->sampled_call_count == entry->call_count) {
+		return sampled_ns;
+	}
+
+	return (uint64_t) ((double) sampled_ns *
+		(double) entry->call_count /
+		(double) entry->sampled_call_count);
+}
+
+static
+int append_entry_value(struct bt_value *array,
+		const struct bt_graph_profile_entry *entry)
+{
+	int ret = 0;
+	struct bt_value *map;
+
+	if (bt_value_array_append_empty_map_element(array, &map)) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_string_entry(map, "type",
+			entry->is_sink ? "sink" : "message-iterator")) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_string_entry(map, "component-name",
+			entry->comp_name->str)) {
+		goto error;
+	}
+
+	if (!entry->is_sink) {
+		if (bt_value_map_insert_string_entry(map, "port-name",
+				entry->port_name->str)) {
+			goto error;
+		}
+
+		if (bt_value_map_insert_unsigned_integer_entry(map,
+				"message-count", entry->msg_count)) {
+			goto error;
+		}
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map, "call-count",
+			entry->call_count)) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map,
+			"sampled-call-count", entry->sampled_call_count)) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map, "wall-time-ns",
+			estimate_ns(entry, entry->wall_ns))) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map,
+			"self-wall-time-ns",
+			estimate_ns(entry, entry->self_wall_ns))) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map, "cpu-time-ns",
+			estimate_ns(entry, entry->cpu_ns))) {
+		goto error;
+	}
+
+	if (bt_value_map_insert_unsigned_integer_entry(map,
+			"self-cpu-time-ns",
+			estimate_ns(entry, entry->self_cpu_ns))) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_LIB_LOGE_APPEND_CAUSE("Failed to append a graph profile entry value.");
+	ret = -1;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct bt_value *bt_graph_profile_to_value(
+		const struct bt_graph_profile *profile)
+{
+	struct bt_value *array;
+	uint64_t i;
+
+	BT_ASSERT(profile->enabled);
+	array = bt_value_array_create();
+	if (!array) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to create an array value.");
+		goto error;
+	}
+
+	for (i = 0; i < profile->entries->len; i++) {
+		if (append_entry_value(array, profile->entries->pdata[i])) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_VALUE_PUT_REF_AND_RESET(array);
+
+end:
+	return array;
+}
@@ -0,0 +1,194 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_GRAPH_PROFILE_INTERNAL_H
+#define BABELTRACE_GRAPH_PROFILE_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+
+#include "common/macros.h"
+
+struct bt_value;
+
+/*
+ * Profile of a message iterator or of a sink component.
+ *
+ * The graph owns all its entries: an entry remains valid after its
+ * message iterator is destroyed so that its data is still available
+ * to bt_graph_get_profile().
+ */
+struct bt_graph_profile_entry {
+	/* `true` for a sink component, `false` for a message iterator */
+	bool is_sink;
+
+	/* Name of the (upstream, for a message iterator) component */
+	GString *comp_name;
+
+	/* Name of the upstream output port (message iterator only) */
+	GString *port_name;
+
+	/* Number of "next" (or "consume") method calls */
+	uint64_t call_count;
+
+	/* Number of returned messages (message iterator only) */
+	uint64_t msg_count;
+
+	/* Number of timed calls amongst `call_count` */
+	uint64_t sampled_call_count;
+
+	/*
+	 * Cumulative (including the upstream message iterators) and
+	 * self (excluding them) wall clock and CPU times, in
+	 * nanoseconds, of the timed calls only.
+	 */
+	uint64_t wall_ns;
+	uint64_t self_wall_ns;
+	uint64_t cpu_ns;
+	uint64_t self_cpu_ns;
+};
+
+/*
+ * Timed call currently in progress.
+ *
+ * A frame lives on the stack of the function which calls the user
+ * method. As calls nest (a sink calls its upstream message iterator's
+ * "next" method, which calls its own upstream message iterator's
+ * "next" method, and so on), each frame accumulates the times of its
+ * child frames to compute its self times.
+ */
+struct bt_graph_profile_frame {
+	struct bt_graph_profile_frame *parent;
+	uint64_t begin_wall_ns;
+	uint64_t begin_cpu_ns;
+	uint64_t child_wall_ns;
+	uint64_t child_cpu_ns;
+};
+
+struct bt_graph_profile {
+	bool enabled;
+
+	/*
+	 * Time one top-level call (usually a sink's "consume" method
+	 * call) out of `sampling_period`, including all the calls it
+	 * nests.
+	 */
+	uint64_t sampling_period;
+	uint64_t top_level_call_count;
+
+	/* Current call nesting level */
+	uint64_t depth;
+
+	/* Whether or not the current top-level call is timed */
+	bool is_sampling;
+
+	/* Innermost timed call, or `NULL` if none */
+	struct bt_graph_profile_frame *cur_frame;
+
+	/* Array of `struct bt_graph_profile_entry *` (owned by this) */
+	GPtrArray *entries;
+};
+
+BT_HIDDEN
+int bt_graph_profile_enable(struct bt_graph_profile *profile,
+		uint64_t sampling_period);
+
+BT_HIDDEN
+void bt_graph_profile_fini(struct bt_graph_profile *profile);
+
+/*
+ * Creates an entry within `profile`.
+ *
+ * `port_name` is `NULL` for a sink component.
+ */
+BT_HIDDEN
+struct bt_graph_profile_entry *bt_graph_profile_create_entry(
+		struct bt_graph_profile *profile, const char *comp_name,
+		const char *port_name);
+
+/*
+ * Returns a new array value with one map value per entry of `profile`
+ * (see bt_graph_get_profile()), or `NULL` on memory error.
+ */
+BT_HIDDEN
+struct bt_value *bt_graph_profile_to_value(
+		const struct bt_graph_profile *profile);
+
+BT_HIDDEN
+void bt_graph_profile_get_times(uint64_t *wall_ns, uint64_t *cpu_ns);
+
+/*
+ * Call before calling a profiled user method.
+ *
+ * Returns whether or not this call is timed: pass this to
+ * bt_graph_profile_end_call().
+ */
+static inline
+bool bt_graph_profile_begin_call(struct bt_graph_profile *profile,
+		struct bt_graph_profile_frame *frame)
+{
+	if (profile->depth == 0) {
+		profile->is_sampling = profile->top_level_call_count %
+			profile->sampling_period == 0;
+		profile->top_level_call_count++;
+	}
+
+	profile->depth++;
+
+	if (!profile->is_sampling) {
+		return false;
+	}
+
+	frame->parent = profile->cur_frame;
+	frame->child_wall_ns = 0;
+	frame->child_cpu_ns = 0;
+	profile->cur_frame = frame;
+	bt_graph_profile_get_times(&frame->begin_wall_ns,
+		&frame->begin_cpu_ns);
+	return true;
+}
+
+/*
+ * Call after the user method which `entry` profiles returns.
+ *
+ * `msg_count` is the number of messages which the user method
+ * returned.
+ */
+static inline
+void bt_graph_profile_end_call(struct bt_graph_profile *profile,
+		struct bt_graph_profile_entry *entry,
+		struct bt_graph_profile_frame *frame, bool is_timed,
+		uint64_t msg_count)
+{
+	entry->call_count++;
+	entry->msg_count += msg_count;
+	profile->depth--;
+
+	if (is_timed) {
+		uint64_t end_wall_ns, end_cpu_ns;
+		uint64_t wall_ns, cpu_ns;
+
+		bt_graph_profile_get_times(&end_wall_ns, &end_cpu_ns);
+		wall_ns = end_wall_ns - frame->begin_wall_ns;
+		cpu_ns = end_cpu_ns - frame->begin_cpu_ns;
+		entry->sampled_call_count++;
+		entry->wall_ns += wall_ns;
+		entry->cpu_ns += cpu_ns;
+		entry->self_wall_ns += wall_ns - MIN(wall_ns,
+			frame->child_wall_ns);
+		entry->self_cpu_ns += cpu_ns - MIN(cpu_ns,
+			frame->child_cpu_ns);
+		profile->cur_frame = frame->parent;
+
+		if (frame->parent) {
+			frame->parent->child_wall_ns += wall_ns;
+			frame->parent->child_cpu_ns += cpu_ns;
+		}
+	}
+}
+
+#endif /* BABELTRACE_GRAPH_PROFILE_INTERNAL_H */
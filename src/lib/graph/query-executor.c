@@ -12,15 +12,64 @@
 #include "lib/assert-cond.h"
 #include <babeltrace2/graph/query-executor.h>
 #include <babeltrace2/graph/component-class.h>
+#include <babeltrace2/graph/private-query-executor.h>
 #include <babeltrace2/graph/query-executor.h>
 #include <babeltrace2/value.h>
 #include "lib/object.h"
 #include "compat/compiler.h"
 
+#include <glib/gstdio.h>
+#include <stdbool.h>
+#include <string.h>
+
 #include "component-class.h"
 #include "query-executor.h"
 #include "interrupter.h"
 #include "lib/func-status.h"
+#include "lib/value.h"
+
+/*
+ * Maximum number of entries in the query result cache of a component
+ * class: when it's full, the cache is emptied before adding an entry.
+ */
+#define MAX_QUERY_RESULT_CACHE_ENTRIES	64
+
+/*
+ * Protects the query result caches of all the component classes, as
+ * query executors of the same component class can run on different
+ * threads.
+ */
+static GMutex query_result_cache_lock;
+
+/* State of a file or directory on which a cached result depends */
+struct query_result_dep {
+	/* Owned by this */
+	gchar *path;
+
+	bool exists;
+	gint64 mtime;
+	gint64 size;
+};
+
+/*
+ * Entry of a query result cache: object name and parameters (key), and
+ * result.
+ */
+struct query_result_cache_entry {
+	/* Owned by this */
+	gchar *object;
+
+	/* Copy of the query parameters, owned by this */
+	const struct bt_value *params;
+
+	guint params_hash;
+
+	/* Copy of the result, owned by this; `NULL` for a lookup key */
+	const struct bt_value *result;
+
+	/* Array of `struct query_result_dep` */
+	GArray *deps;
+};
 
 static
 void bt_query_executor_destroy(struct bt_object *obj)
@@ -36,6 +85,11 @@ void bt_query_executor_destroy(struct bt_object *obj)
 		query_exec->interrupters = NULL;
 	}
 
+	if (query_exec->result_dep_paths) {
+		g_ptr_array_free(query_exec->result_dep_paths, TRUE);
+		query_exec->result_dep_paths = NULL;
+	}
+
 	BT_LOGD_STR("Putting component class.");
 	BT_OBJECT_PUT_REF_AND_RESET(query_exec->comp_cls);
 
@@ -77,6 +131,13 @@ struct bt_query_executor *bt_query_executor_create_with_method_data(
 		goto end;
 	}
 
+	query_exec->result_dep_paths = g_ptr_array_new_with_free_func(g_free);
+	if (!query_exec->result_dep_paths) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one GPtrArray.");
+		BT_OBJECT_PUT_REF_AND_RESET(query_exec);
+		goto end;
+	}
+
 	query_exec->default_interrupter = bt_interrupter_create();
 	if (!query_exec->default_interrupter) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -125,6 +186,287 @@ struct bt_query_executor *bt_query_executor_create(
 		object, params, NULL);
 }
 
+static
+void destroy_query_result_cache_entry(
+		struct query_result_cache_entry *entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	if (entry->deps) {
+		guint i;
+
+		for (i = 0; i < entry->deps->len; i++) {
+			g_free(g_array_index(entry->deps,
+				struct query_result_dep, i).path);
+		}
+
+		g_array_free(entry->deps, TRUE);
+	}
+
+	g_free(entry->object);
+	BT_OBJECT_PUT_REF_AND_RESET(entry->params);
+	BT_OBJECT_PUT_REF_AND_RESET(entry->result);
+	g_free(entry);
+}
+
+static
+guint query_result_cache_entry_hash(gconstpointer data)
+{
+	const struct query_result_cache_entry *entry = data;
+
+	return g_str_hash(entry->object) * 31 + entry->params_hash;
+}
+
+static
+gboolean query_result_cache_entry_equal(gconstpointer data_a,
+		gconstpointer data_b)
+{
+	const struct query_result_cache_entry *entry_a = data_a;
+	const struct query_result_cache_entry *entry_b = data_b;
+
+	return entry_a->params_hash == entry_b->params_hash &&
+		strcmp(entry_a->object, entry_b->object) == 0 &&
+		bt_value_is_equal(entry_a->params, entry_b->params);
+}
+
+BT_HIDDEN
+void bt_query_executor_destroy_result_cache(GHashTable *result_cache)
+{
+	g_hash_table_destroy(result_cache);
+}
+
+/* Sets the current state of the file or directory `dep->path` */
+static
+void stat_query_result_dep(struct query_result_dep *dep)
+{
+	GStatBuf st;
+
+	if (g_stat(dep->path, &st) == 0) {
+		dep->exists = true;
+		dep->mtime = (gint64) st.st_mtime;
+		dep->size = (gint64) st.st_size;
+	} else {
+		dep->exists = false;
+		dep->mtime = 0;
+		dep->size = 0;
+	}
+}
+
+/*
+ * Returns whether or not the files and directories on which the result
+ * of `entry` depends are still in the state they were when the
+ * result was cached.
+ */
+static
+bool query_result_cache_entry_is_valid(
+		const struct query_result_cache_entry *entry)
+{
+	bool is_valid = true;
+	guint i;
+
+	for (i = 0; i < entry->deps->len; i++) {
+		const struct query_result_dep *dep = &g_array_index(
+			entry->deps, struct query_result_dep, i);
+		struct query_result_dep cur_dep = { .path = dep->path };
+
+		stat_query_result_dep(&cur_dep);
+
+		if (cur_dep.exists != dep->exists ||
+				cur_dep.mtime != dep->mtime ||
+				cur_dep.size != dep->size) {
+			BT_LOGD("Cached query result is stale: "
+				"path=\"%s\", "
+				"cached-exists=%d, cached-mtime=%" PRId64 ", "
+				"cached-size=%" PRId64 ", "
+				"exists=%d, mtime=%" PRId64 ", size=%" PRId64,
+				dep->path, dep->exists, dep->mtime, dep->size,
+				cur_dep.exists, cur_dep.mtime, cur_dep.size);
+			is_valid = false;
+			break;
+		}
+	}
+
+	return is_valid;
+}
+
+/*
+ * Returns a copy of the cached result of the query operation of
+ * `query_exec`, or `NULL` if there's no valid cached result.
+ *
+ * The cached result itself never leaves the cache: value reference
+ * counts are not atomic, and the query executors of a component class
+ * can run on different threads, so each hit gets its own copy, made
+ * while holding `query_result_cache_lock`.
+ */
+static
+const struct bt_value *get_cached_query_result(
+		struct bt_query_executor *query_exec)
+{
+	struct bt_component_class *comp_cls = (void *) query_exec->comp_cls;
+	struct bt_value *result = NULL;
+	struct query_result_cache_entry key = {
+		.object = query_exec->object->str,
+		.params = query_exec->params,
+		.params_hash = bt_value_hash(query_exec->params),
+	};
+	struct query_result_cache_entry *entry;
+
+	g_mutex_lock(&query_result_cache_lock);
+
+	if (!comp_cls->query_result_cache) {
+		goto end;
+	}
+
+	entry = g_hash_table_lookup(comp_cls->query_result_cache, &key);
+	if (!entry) {
+		goto end;
+	}
+
+	if (!query_result_cache_entry_is_valid(entry)) {
+		g_hash_table_remove(comp_cls->query_result_cache, entry);
+		goto end;
+	}
+
+	if (bt_value_copy(entry->result, &result) !=
+			BT_VALUE_COPY_STATUS_OK) {
+		/* Act as if there was no cached result */
+		BT_LOGW("Failed to copy cached query result: "
+			"query-exec-addr=%p", query_exec);
+		bt_current_thread_clear_error();
+		result = NULL;
+	}
+
+end:
+	g_mutex_unlock(&query_result_cache_lock);
+	return result;
+}
+
+/*
+ * Adds `result` to the result cache of the component class of
+ * `query_exec`.
+ *
+ * Caching is best effort: this function doesn't fail.
+ */
+static
+void cache_query_result(struct bt_query_executor *query_exec,
+		const struct bt_value *result)
+{
+	struct bt_component_class *comp_cls = (void *) query_exec->comp_cls;
+	struct query_result_cache_entry *entry;
+	struct bt_value *params_copy;
+	struct bt_value *result_copy;
+	gint64 now_s = g_get_real_time() / G_USEC_PER_SEC;
+	guint i;
+
+	entry = g_new0(struct query_result_cache_entry, 1);
+	if (!entry) {
+		goto error;
+	}
+
+	entry->object = g_strdup(query_exec->object->str);
+	entry->deps = g_array_sized_new(FALSE, TRUE,
+		sizeof(struct query_result_dep),
+		query_exec->result_dep_paths->len);
+	if (!entry->object || !entry->deps) {
+		goto error;
+	}
+
+	for (i = 0; i < query_exec->result_dep_paths->len; i++) {
+		struct query_result_dep *dep;
+
+		g_array_set_size(entry->deps, i + 1);
+		dep = &g_array_index(entry->deps, struct query_result_dep, i);
+		dep->path = g_strdup(g_ptr_array_index(
+			query_exec->result_dep_paths, i));
+		if (!dep->path) {
+			goto error;
+		}
+
+		stat_query_result_dep(dep);
+
+		/*
+		 * Modification times have a one-second resolution: a
+		 * dependency which was modified within the last second
+		 * could be modified again without changing its state.
+		 */
+		if (dep->mtime >= now_s - 1) {
+			BT_LOGD("Not caching query result: dependency "
+				"was recently modified: path=\"%s\"",
+				dep->path);
+			goto end;
+		}
+	}
+
+	/*
+	 * Copy the parameters: the user could modify them after the
+	 * query operation.
+	 */
+	if (bt_value_copy(query_exec->params, &params_copy) !=
+			BT_VALUE_COPY_STATUS_OK) {
+		goto error;
+	}
+
+	entry->params = params_copy;
+	entry->params_hash = bt_value_hash(entry->params);
+
+	/*
+	 * Copy the result too: the cache must be the only owner of its
+	 * values (see get_cached_query_result()).
+	 */
+	if (bt_value_copy(result, &result_copy) !=
+			BT_VALUE_COPY_STATUS_OK) {
+		goto error;
+	}
+
+	entry->result = result_copy;
+	bt_value_freeze(entry->result);
+
+	g_mutex_lock(&query_result_cache_lock);
+
+	if (!comp_cls->query_result_cache) {
+		comp_cls->query_result_cache = g_hash_table_new_full(
+			query_result_cache_entry_hash,
+			query_result_cache_entry_equal,
+			(GDestroyNotify) destroy_query_result_cache_entry,
+			NULL);
+	}
+
+	if (comp_cls->query_result_cache) {
+		if (g_hash_table_size(comp_cls->query_result_cache) >=
+				MAX_QUERY_RESULT_CACHE_ENTRIES) {
+			g_hash_table_remove_all(comp_cls->query_result_cache);
+		}
+
+		/* Replaces any existing entry with the same key */
+		g_hash_table_replace(comp_cls->query_result_cache, entry,
+			entry);
+		entry = NULL;
+	}
+
+	g_mutex_unlock(&query_result_cache_lock);
+
+	if (entry) {
+		goto error;
+	}
+
+	BT_LIB_LOGD("Cached query result: "
+		"query-exec-addr=%p, %![cc-]+C, object=\"%s\", "
+		"%![params-]+v, dep-count=%u",
+		query_exec, query_exec->comp_cls, query_exec->object->str,
+		query_exec->params, query_exec->result_dep_paths->len);
+	goto end;
+
+error:
+	BT_LOGW("Failed to cache query result: query-exec-addr=%p",
+		query_exec);
+	bt_current_thread_clear_error();
+
+end:
+	destroy_query_result_cache_entry(entry);
+}
+
 enum bt_query_executor_query_status bt_query_executor_query(
 		struct bt_query_executor *query_exec,
 		const struct bt_value **user_result)
@@ -141,6 +483,7 @@ enum bt_query_executor_query_status bt_query_executor_query(
 	enum bt_component_class_query_method_status query_status;
 	method_t method = NULL;
 	const char *method_name = NULL;
+	bool use_result_cache;
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_QUERY_EXEC_NON_NULL(query_exec);
@@ -209,6 +552,28 @@ enum bt_query_executor_query_status bt_query_executor_query(
 		goto end;
 	}
 
+	/*
+	 * The result of a query operation with query user data can
+	 * depend on it: don't cache it.
+	 */
+	use_result_cache = query_exec->uses_result_cache &&
+		!query_exec->method_data;
+	if (use_result_cache) {
+		*user_result = get_cached_query_result(query_exec);
+		if (*user_result) {
+			BT_LIB_LOGD("Using cached query result: "
+				"query-exec-addr=%p, %![cc-]+C, object=\"%s\", "
+				"%![params-]+v, %![res-]+v",
+				query_exec, query_exec->comp_cls,
+				query_exec->object->str, query_exec->params,
+				*user_result);
+			status = BT_FUNC_STATUS_OK;
+			goto end;
+		}
+	}
+
+	query_exec->result_is_cacheable = false;
+	g_ptr_array_set_size(query_exec->result_dep_paths, 0);
 	BT_LIB_LOGD("Calling user's query method: "
 		"query-exec-addr=%p, %![cc-]+C, object=\"%s\", %![params-]+v, "
 		"log-level=%s",
@@ -238,6 +603,11 @@ enum bt_query_executor_query_status bt_query_executor_query(
 		goto end;
 	}
 
+	if (status == BT_FUNC_STATUS_OK && use_result_cache &&
+			query_exec->result_is_cacheable) {
+		cache_query_result(query_exec, *user_result);
+	}
+
 end:
 	return status;
 }
@@ -287,6 +657,58 @@ enum bt_logging_level bt_query_executor_get_logging_level(
 	return query_exec->log_level;
 }
 
+void bt_query_executor_set_uses_result_cache(
+		struct bt_query_executor *query_exec, bt_bool uses_result_cache)
+{
+	BT_ASSERT_PRE_QUERY_EXEC_NON_NULL(query_exec);
+	query_exec->uses_result_cache = (bool) uses_result_cache;
+	BT_LIB_LOGD("Set whether or not query executor uses the result cache: "
+		"query-exec-addr=%p, uses-result-cache=%d",
+		query_exec, uses_result_cache);
+}
+
+bt_bool bt_query_executor_uses_result_cache(
+		const struct bt_query_executor *query_exec)
+{
+	BT_ASSERT_PRE_QUERY_EXEC_NON_NULL(query_exec);
+	return (bt_bool) query_exec->uses_result_cache;
+}
+
+void bt_private_query_executor_set_result_is_cacheable(
+		struct bt_private_query_executor *priv_query_exec)
+{
+	struct bt_query_executor *query_exec = (void *) priv_query_exec;
+
+	BT_ASSERT_PRE_QUERY_EXEC_NON_NULL(query_exec);
+	query_exec->result_is_cacheable = true;
+}
+
+enum bt_private_query_executor_add_result_dependency_path_status
+bt_private_query_executor_add_result_dependency_path(
+		struct bt_private_query_executor *priv_query_exec,
+		const char *path)
+{
+	struct bt_query_executor *query_exec = (void *) priv_query_exec;
+	gchar *path_copy;
+	enum bt_private_query_executor_add_result_dependency_path_status status;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_QUERY_EXEC_NON_NULL(query_exec);
+	BT_ASSERT_PRE_NON_NULL("path", path, "Path");
+	path_copy = g_strdup(path);
+	if (!path_copy) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one string.");
+		status = BT_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	g_ptr_array_add(query_exec->result_dep_paths, path_copy);
+	status = BT_FUNC_STATUS_OK;
+
+end:
+	return status;
+}
+
 void bt_query_executor_get_ref(const struct bt_query_executor *query_executor)
 {
 	bt_object_get_ref(query_executor);
@@ -8,11 +8,13 @@
 #define BABELTRACE_GRAPH_QUERY_EXECUTOR_INTERNAL_H
 
 #include <glib.h>
+#include <stdbool.h>
 
 #include <babeltrace2/types.h>
 #include <babeltrace2/graph/query-executor.h>
 #include <babeltrace2/graph/component-class.h>
 
+#include "common/macros.h"
 #include "lib/object.h"
 #include "lib/value.h"
 
@@ -42,6 +44,28 @@ struct bt_query_executor {
 
 	void *method_data;
 	enum bt_logging_level log_level;
+
+	/*
+	 * True to look up the results of query operations in the
+	 * result cache of `comp_cls` and to store them there.
+	 */
+	bool uses_result_cache;
+
+	/*
+	 * Set by the query method, through the private query executor,
+	 * during a query operation: whether or not its result is
+	 * cacheable, and the paths of the files and directories on
+	 * which it depends (array of `gchar *`, owned by this).
+	 */
+	bool result_is_cacheable;
+	GPtrArray *result_dep_paths;
 };
 
+/*
+ * Destroys the query result cache of a component class (see
+ * `struct bt_component_class`).
+ */
+BT_HIDDEN
+void bt_query_executor_destroy_result_cache(GHashTable *result_cache);
+
 #endif /* BABELTRACE_GRAPH_QUERY_EXECUTOR_INTERNAL_H */
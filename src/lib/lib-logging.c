@@ -35,6 +35,7 @@
 #include "graph/graph.h"
 #include "graph/message/discarded-items.h"
 #include "graph/message/event.h"
+#include "graph/message/event-batch.h"
 #include "graph/message/iterator.h"
 #include "graph/message/message.h"
 #include "graph/message/message-iterator-inactivity.h"
@@ -62,6 +63,24 @@
 
 static __thread char lib_logging_buf[LIB_LOGGING_BUF_SIZE];
 
+/*
+ * True to format objects with their address and main properties only,
+ * even with the `+` (extended) flag.
+ *
+ * Extended object descriptions (a whole event or message, for example)
+ * can cost more than the operation which is logged, making verbose
+ * logging change the timing of what it's meant to diagnose.
+ */
+static bool compact_objects;
+
+static
+void __attribute__((constructor)) lib_logging_ctor(void)
+{
+	const char *val = getenv("LIBBABELTRACE2_LOG_COMPACT_OBJECTS");
+
+	compact_objects = val && strcmp(val, "1") == 0;
+}
+
 #define BUF_APPEND(_fmt, ...)						\
 	do {								\
 		int _count;						\
@@ -133,6 +152,21 @@ static inline void format_object_pool(char **buf_ch, bool extended,
 	if (pool->objects) {
 		BUF_APPEND(", %scap=%u", PRFIELD(pool->objects->len));
 	}
+
+	if (extended) {
+		if (pool->max_size != SIZE_MAX) {
+			BUF_APPEND(", %smax-size=%zu", PRFIELD(pool->max_size));
+		}
+
+		BUF_APPEND(", %shits=%" PRIu64 ", %smisses=%" PRIu64
+			", %sdiscarded=%" PRIu64 ", %sdecayed=%" PRIu64
+			", %speak-size=%zu",
+			PRFIELD(pool->stats.hits),
+			PRFIELD(pool->stats.misses),
+			PRFIELD(pool->stats.discarded),
+			PRFIELD(pool->stats.decayed),
+			PRFIELD(pool->stats.peak_size));
+	}
 }
 
 static inline void format_integer_field_class(char **buf_ch,
@@ -406,10 +440,9 @@ static inline void format_field(char **buf_ch, bool extended,
 	{
 		const struct bt_field_string *str = (const void *) field;
 
-		if (str->buf) {
-			BT_ASSERT(str->buf->data);
+		if (str->data) {
 			BUF_APPEND(", %spartial-value=\"%.32s\"",
-				PRFIELD(str->buf->data));
+				PRFIELD(str->data));
 		}
 
 		break;
@@ -1034,6 +1067,35 @@ static inline void format_message(char **buf_ch, bool extended,
 
 		break;
 	}
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+	{
+		const struct bt_message_event_batch *msg_event_batch =
+			(const void *) msg;
+
+		BUF_APPEND(", %scount=%" PRIu64 ", %scapacity=%" PRIu64,
+			PRFIELD(msg_event_batch->count),
+			PRFIELD(msg_event_batch->capacity));
+
+		if (msg_event_batch->event_class) {
+			SET_TMP_PREFIX("ec-");
+			format_event_class(buf_ch, false, tmp_prefix,
+				msg_event_batch->event_class);
+		}
+
+		if (msg_event_batch->stream) {
+			SET_TMP_PREFIX("stream-");
+			format_stream(buf_ch, true, tmp_prefix,
+				msg_event_batch->stream);
+		}
+
+		if (msg_event_batch->packet) {
+			SET_TMP_PREFIX("packet-");
+			format_packet(buf_ch, false, tmp_prefix,
+				msg_event_batch->packet);
+		}
+
+		break;
+	}
 	default:
 		break;
 	}
@@ -1152,8 +1214,6 @@ static inline void format_connection(char **buf_ch, bool extended,
 static inline void format_graph(char **buf_ch, bool extended,
 		const char *prefix, const struct bt_graph *graph)
 {
-	char tmp_prefix[TMP_PREFIX_LEN];
-
 	BUF_APPEND(", %scan-consume=%d, %sconfig-state=%s",
 		PRFIELD(graph->can_consume),
 		PRFIELD(bt_graph_configuration_state_string(graph->config_state)));
@@ -1171,16 +1231,6 @@ static inline void format_graph(char **buf_ch, bool extended,
 		BUF_APPEND(", %sconn-count=%u",
 			PRFIELD(graph->connections->len));
 	}
-
-	SET_TMP_PREFIX("en-pool-");
-	format_object_pool(buf_ch, extended, tmp_prefix,
-		&graph->event_msg_pool);
-	SET_TMP_PREFIX("pbn-pool-");
-	format_object_pool(buf_ch, extended, tmp_prefix,
-		&graph->packet_begin_msg_pool);
-	SET_TMP_PREFIX("pen-pool-");
-	format_object_pool(buf_ch, extended, tmp_prefix,
-		&graph->packet_end_msg_pool);
 }
 
 static inline void format_message_iterator_class(char **buf_ch,
@@ -1220,6 +1270,18 @@ static inline void format_message_iterator(char **buf_ch,
 			port_in_iter->connection);
 	}
 
+	if (port_in_iter->msg_pools) {
+		SET_TMP_PREFIX("en-pool-");
+		format_object_pool(buf_ch, extended, tmp_prefix,
+			&port_in_iter->msg_pools->event_msg_pool);
+		SET_TMP_PREFIX("pbn-pool-");
+		format_object_pool(buf_ch, extended, tmp_prefix,
+			&port_in_iter->msg_pools->packet_begin_msg_pool);
+		SET_TMP_PREFIX("pen-pool-");
+		format_object_pool(buf_ch, extended, tmp_prefix,
+			&port_in_iter->msg_pools->packet_end_msg_pool);
+	}
+
 end:
 	return;
 }
@@ -1382,7 +1444,7 @@ static inline void handle_conversion_specifier_bt(void *priv_data,
 	*prefix_ch = '\0';
 
 	if (*fmt_ch == '+') {
-		extended = true;
+		extended = !compact_objects;
 		fmt_ch++;
 	}
 
@@ -39,6 +39,10 @@ int bt_lib_log_level;
 #define BT_LIB_LOGI(_fmt, ...)	BT_LIB_LOG(BT_LOG_INFO, _fmt, ##__VA_ARGS__)
 #define BT_LIB_LOGD(_fmt, ...)	BT_LIB_LOG(BT_LOG_DEBUG, _fmt, ##__VA_ARGS__)
 #define BT_LIB_LOGT(_fmt, ...)	BT_LIB_LOG(BT_LOG_TRACE, _fmt, ##__VA_ARGS__)
+#define BT_LIB_LOGD_FP(_fmt, ...) \
+	BT_LOG_FAST_PATH(BT_LOG_DEBUG, BT_LIB_LOGD(_fmt, ##__VA_ARGS__))
+#define BT_LIB_LOGT_FP(_fmt, ...) \
+	BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_LIB_LOGT(_fmt, ##__VA_ARGS__))
 
 /*
  * Log statement, specialized for the Babeltrace library.
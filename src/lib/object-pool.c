@@ -7,11 +7,53 @@
 #define BT_LOG_TAG "LIB/OBJECT-POOL"
 #include "lib/logging.h"
 
+#include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "common/assert.h"
 #include "lib/assert-cond.h"
 #include "lib/object-pool.h"
 
+/*
+ * Default high-water mark of the object pools; SIZE_MAX means
+ * unlimited.
+ *
+ * Set at library loading time, but pools are initialized from any
+ * thread (each graph and message iterator has its own pools): always
+ * access it atomically.
+ */
+static size_t default_max_size = SIZE_MAX;
+
+static
+void __attribute__((constructor)) bt_object_pool_ctor(void)
+{
+	const char *var;
+	char *endptr;
+	unsigned long long value;
+
+	var = getenv("LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE");
+	if (!var || var[0] == '\0') {
+		goto end;
+	}
+
+	errno = 0;
+	value = strtoull(var, &endptr, 10);
+	if (errno != 0 || *endptr != '\0' || value > SIZE_MAX) {
+		BT_LOGW("Invalid `LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE` environment variable value: "
+			"value=\"%s\"", var);
+		goto end;
+	}
+
+	__atomic_store_n(&default_max_size, (size_t) value, __ATOMIC_RELAXED);
+	BT_LOGI("Using object pool high-water mark from environment: "
+		"max-size=%zu", (size_t) value);
+
+end:
+	return;
+}
+
 int bt_object_pool_initialize(struct bt_object_pool *pool,
 		bt_object_pool_new_object_func new_object_func,
 		bt_object_pool_destroy_object_func destroy_object_func,
@@ -34,6 +76,10 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 	pool->funcs.destroy_object = destroy_object_func;
 	pool->data = data;
 	pool->size = 0;
+	pool->max_size = __atomic_load_n(&default_max_size, __ATOMIC_RELAXED);
+	pool->low_size = 0;
+	pool->creations_since_decay = 0;
+	memset(&pool->stats, 0, sizeof(pool->stats));
 	BT_LIB_LOGD("Initialized object pool: %!+o", pool);
 	goto end;
 
@@ -65,3 +111,83 @@ void bt_object_pool_finalize(struct bt_object_pool *pool)
 		pool->objects = NULL;
 	}
 }
+
+void bt_object_pool_grow(struct bt_object_pool *pool)
+{
+	size_t new_cap;
+
+	BT_ASSERT(pool);
+	BT_ASSERT(pool->size == pool->objects->len);
+	BT_ASSERT(pool->size < pool->max_size);
+	new_cap = MAX((size_t) pool->objects->len * 2,
+		(size_t) BT_OBJECT_POOL_MIN_CAPACITY);
+	new_cap = MIN(new_cap, pool->max_size);
+	BT_LOGD("Object pool is full: increasing object pool capacity: "
+		"pool-addr=%p, old-pool-cap=%u, new-pool-cap=%zu",
+		pool, pool->objects->len, new_cap);
+	g_ptr_array_set_size(pool->objects, new_cap);
+}
+
+void bt_object_pool_decay(struct bt_object_pool *pool)
+{
+	size_t count;
+
+	BT_ASSERT(pool);
+	BT_ASSERT(pool->low_size <= pool->size);
+	count = (pool->low_size + 1) / 2;
+	BT_LOGD("Decaying object pool: pool-addr=%p, pool-size=%zu, "
+		"pool-cap=%u, low-size=%zu, count=%zu",
+		pool, pool->size, pool->objects->len, pool->low_size, count);
+
+	while (count > 0) {
+		void *obj;
+
+		pool->size--;
+		obj = pool->objects->pdata[pool->size];
+		pool->objects->pdata[pool->size] = NULL;
+		pool->funcs.destroy_object(obj, pool->data);
+		pool->stats.decayed++;
+		count--;
+	}
+
+	/*
+	 * Shrink the backing array if less than a quarter of it is in
+	 * use, keeping room to grow the pool back to twice its size.
+	 */
+	if (pool->objects->len > BT_OBJECT_POOL_MIN_CAPACITY &&
+			pool->size < pool->objects->len / 4) {
+		g_ptr_array_set_size(pool->objects,
+			MAX(pool->size * 2,
+				(size_t) BT_OBJECT_POOL_MIN_CAPACITY));
+	}
+
+	pool->low_size = pool->size;
+	pool->creations_since_decay = 0;
+}
+
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size)
+{
+	BT_ASSERT(pool);
+	BT_LIB_LOGD("Setting object pool's high-water mark: %!+o, "
+		"max-size=%zu", pool, max_size);
+	pool->max_size = max_size;
+
+	while (pool->size > max_size) {
+		void *obj;
+
+		pool->size--;
+		obj = pool->objects->pdata[pool->size];
+		pool->objects->pdata[pool->size] = NULL;
+		pool->funcs.destroy_object(obj, pool->data);
+		pool->stats.discarded++;
+	}
+
+	if (pool->objects->len > max_size) {
+		g_ptr_array_set_size(pool->objects, max_size);
+	}
+
+	if (pool->low_size > pool->size) {
+		pool->low_size = pool->size;
+	}
+}
@@ -30,9 +30,18 @@
  *   bt_*_recycle() function which does the necessary before calling
  *   bt_object_pool_recycle_object() with an object ready to be reused
  *   at any time.
+ *
+ * A pool keeps at most `max_size` recycled objects (its high-water
+ * mark): bt_object_pool_recycle_object() destroys an object to recycle
+ * when the pool is already at its high-water mark, so that a burst of
+ * objects doesn't keep memory pinned for the whole lifetime of the
+ * pool. The default high-water mark of a pool is unlimited, unless the
+ * `LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE` environment variable is set.
  */
 
+#include <stdint.h>
 #include <glib.h>
+#include "common/probes.h"
 #include "lib/object.h"
 
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
@@ -43,6 +52,35 @@
 typedef void *(*bt_object_pool_new_object_func)(void *data);
 typedef void (*bt_object_pool_destroy_object_func)(void *obj, void *data);
 
+/* Minimal capacity of a non-empty pool's backing array */
+#define BT_OBJECT_POOL_MIN_CAPACITY	8
+
+/*
+ * Number of object creations between two decays of an object pool (see
+ * bt_object_pool_decay()).
+ */
+#define BT_OBJECT_POOL_DECAY_PERIOD	4096
+
+struct bt_object_pool_stats {
+	/* Number of objects created from recycled objects */
+	uint64_t hits;
+
+	/* Number of objects created with the "new" user function */
+	uint64_t misses;
+
+	/*
+	 * Number of objects destroyed instead of being recycled because
+	 * the pool was at its high-water mark
+	 */
+	uint64_t discarded;
+
+	/* Maximum size the pool ever reached */
+	size_t peak_size;
+
+	/* Number of recycled objects destroyed by decays */
+	uint64_t decayed;
+};
+
 struct bt_object_pool {
 	/*
 	 * Container of recycled objects, owned by this. The array's size
@@ -56,6 +94,23 @@ struct bt_object_pool {
 	 */
 	size_t size;
 
+	/*
+	 * Pool's high-water mark: maximum number of recycled objects
+	 * which this pool keeps.
+	 */
+	size_t max_size;
+
+	/*
+	 * Minimum size of the pool since its last decay: that many
+	 * recycled objects were not needed during the last decay period.
+	 */
+	size_t low_size;
+
+	/* Number of object creations since the pool's last decay */
+	uint64_t creations_since_decay;
+
+	struct bt_object_pool_stats stats;
+
 	/* User functions */
 	struct {
 		/* Allocate a new object in memory */
@@ -84,6 +139,31 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 BT_HIDDEN
 void bt_object_pool_finalize(struct bt_object_pool *pool);
 
+/*
+ * Sets the high-water mark of an object pool to `max_size`, destroying
+ * the recycled objects in excess and shrinking the pool's capacity if
+ * needed.
+ */
+BT_HIDDEN
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size);
+
+/*
+ * Grows the capacity of an object pool, which must be full,
+ * geometrically, without exceeding its high-water mark.
+ */
+BT_HIDDEN
+void bt_object_pool_grow(struct bt_object_pool *pool);
+
+/*
+ * Destroys half of the recycled objects of an object pool which were
+ * not needed since its last decay, and shrinks its capacity if it's
+ * mostly unused, so that a pool doesn't keep the memory of a burst of
+ * objects forever.
+ */
+BT_HIDDEN
+void bt_object_pool_decay(struct bt_object_pool *pool);
+
 /*
  * Creates an object from an object pool. If the pool is empty, this
  * function calls the "new" user function to allocate a new object
@@ -98,24 +178,37 @@ void *bt_object_pool_create_object(struct bt_object_pool *pool)
 	struct bt_object *obj;
 
 	BT_ASSERT_DBG(pool);
-	BT_LOGT("Creating object from pool: pool-addr=%p, pool-size=%zu, pool-cap=%u",
+	BT_LOGT_FP("Creating object from pool: pool-addr=%p, pool-size=%zu, pool-cap=%u",
 		pool, pool->size, pool->objects->len);
 
+	if (G_UNLIKELY(++pool->creations_since_decay ==
+			BT_OBJECT_POOL_DECAY_PERIOD)) {
+		bt_object_pool_decay(pool);
+	}
+
 	if (pool->size > 0) {
 		/* Pick one from the pool */
 		pool->size--;
 		obj = pool->objects->pdata[pool->size];
 		pool->objects->pdata[pool->size] = NULL;
+		pool->stats.hits++;
+
+		if (pool->size < pool->low_size) {
+			pool->low_size = pool->size;
+		}
+
 		goto end;
 	}
 
 	/* Pool is empty: create a brand new object */
-	BT_LOGD("Pool is empty: allocating new object: pool-addr=%p",
+	BT_LOGD_FP("Pool is empty: allocating new object: pool-addr=%p",
 		pool);
 	obj = pool->funcs.new_object(pool->data);
+	pool->stats.misses++;
+	BT_PROBE2(object_pool_miss, pool, pool->stats.misses);
 
 end:
-	BT_LOGT("Created one object from pool: pool-addr=%p, obj-addr=%p",
+	BT_LOGT_FP("Created one object from pool: pool-addr=%p, obj-addr=%p",
 		pool, obj);
 	return obj;
 }
@@ -132,15 +225,23 @@ void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 
 	BT_ASSERT_DBG(pool);
 	BT_ASSERT_DBG(obj);
-	BT_LOGT("Recycling object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
+	BT_LOGT_FP("Recycling object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
 		pool, pool->size, pool->objects->len, obj);
 
-	if (pool->size == pool->objects->len) {
+	if (G_UNLIKELY(pool->size >= pool->max_size)) {
+		/* Pool is at its high-water mark: destroy object */
+		BT_LOGD_FP("Object pool is at its high-water mark: destroying object: "
+			"pool-addr=%p, pool-max-size=%zu, obj-addr=%p",
+			pool, pool->max_size, obj);
+		pool->funcs.destroy_object(obj, pool->data);
+		pool->stats.discarded++;
+		BT_PROBE2(object_pool_discard, pool, pool->stats.discarded);
+		return;
+	}
+
+	if (G_UNLIKELY(pool->size == pool->objects->len)) {
 		/* Backing array is full: make place for recycled object */
-		BT_LOGD("Object pool is full: increasing object pool capacity: "
-			"pool-addr=%p, old-pool-cap=%u, new-pool-cap=%u",
-			pool, pool->objects->len, pool->objects->len + 1);
-		g_ptr_array_set_size(pool->objects, pool->size + 1);
+		bt_object_pool_grow(pool);
 	}
 
 	/* Reset reference count to 1 since it could be 0 now */
@@ -149,7 +250,11 @@ void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 	/* Back to the pool */
 	pool->objects->pdata[pool->size] = obj;
 	pool->size++;
-	BT_LOGT("Recycled object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
+
+	if (pool->size > pool->stats.peak_size) {
+		pool->stats.peak_size = pool->size;
+	}
+	BT_LOGT_FP("Recycled object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
 		pool, pool->size, pool->objects->len, obj);
 }
 
@@ -37,6 +37,20 @@ struct bt_object {
 	 */
 	bool is_shared;
 
+	/*
+	 * True if this object's reference count is updated with atomic
+	 * operations, that is, if references to this object may be
+	 * acquired and released concurrently by different threads.
+	 *
+	 * This is only set for objects which are meant to be shared
+	 * between threads (trace IR metadata objects and streams, which
+	 * messages refer to): the reference count of all the other
+	 * objects is thread-local and uses plain operations.
+	 *
+	 * See bt_object_set_ref_count_is_atomic().
+	 */
+	bool ref_count_is_atomic;
+
 	/*
 	 * Current reference count.
 	 */
@@ -78,6 +92,11 @@ unsigned long long bt_object_get_ref_count(const struct bt_object *c_obj)
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
+
+	if (G_UNLIKELY(obj->ref_count_is_atomic)) {
+		return __atomic_load_n(&obj->ref_count, __ATOMIC_ACQUIRE);
+	}
+
 	return obj->ref_count;
 }
 
@@ -192,6 +211,7 @@ void bt_object_init(struct bt_object *obj, bool is_shared,
 	obj->parent_is_owner_listener_func = NULL;
 	obj->spec_release_func = NULL;
 	obj->parent = NULL;
+	obj->ref_count_is_atomic = false;
 	obj->ref_count = 1;
 }
 
@@ -228,15 +248,71 @@ void bt_object_set_parent_is_owner_listener_func(struct bt_object *obj,
 	((struct bt_object *) obj)->parent_is_owner_listener_func = func;
 }
 
+/*
+ * Makes the reference count of the shared object `obj` atomic.
+ *
+ * Call this right after initializing `obj`, before any other thread
+ * can reach it.
+ *
+ * Only the reference count itself becomes thread-safe: the object's
+ * other members still need external synchronization, which is why
+ * this is meant for objects which are frozen (immutable) when they
+ * cross threads.
+ *
+ * If `obj` has a parent, the parent's reference count must also
+ * be atomic.
+ */
 static inline
-void bt_object_inc_ref_count(const struct bt_object *c_obj)
+void bt_object_set_ref_count_is_atomic(struct bt_object *obj)
+{
+	BT_ASSERT_DBG(obj);
+	BT_ASSERT_DBG(obj->is_shared);
+	obj->ref_count_is_atomic = true;
+}
+
+/*
+ * Increments the reference count of `obj`, returning its value before
+ * the increment.
+ */
+static inline
+unsigned long long bt_object_inc_ref_count(const struct bt_object *c_obj)
 {
 	struct bt_object *obj = (void *) c_obj;
+	unsigned long long old_ref_count;
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
-	obj->ref_count++;
-	BT_ASSERT_DBG(obj->ref_count != 0);
+
+	if (G_UNLIKELY(obj->ref_count_is_atomic)) {
+		old_ref_count = __atomic_fetch_add(&obj->ref_count, 1,
+			__ATOMIC_RELAXED);
+	} else {
+		old_ref_count = obj->ref_count++;
+	}
+
+	BT_ASSERT_DBG(old_ref_count + 1 != 0);
+	return old_ref_count;
+}
+
+/*
+ * Decrements the reference count of `obj`, returning its new value.
+ *
+ * For an atomic reference count, the acquire/release ordering makes
+ * all the accesses of other threads to `obj`, before they put their
+ * reference, happen before its release function runs.
+ */
+static inline
+unsigned long long bt_object_dec_ref_count(struct bt_object *obj)
+{
+	BT_ASSERT_DBG(obj);
+	BT_ASSERT_DBG(obj->is_shared);
+
+	if (G_UNLIKELY(obj->ref_count_is_atomic)) {
+		return __atomic_sub_fetch(&obj->ref_count, 1,
+			__ATOMIC_ACQ_REL);
+	}
+
+	return --obj->ref_count;
 }
 
 static inline
@@ -265,6 +341,36 @@ void bt_object_get_ref_no_null_check(const void *c_obj)
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
 
+	if (G_UNLIKELY(obj->ref_count_is_atomic)) {
+		/*
+		 * With an atomic reference count, only the thread which
+		 * makes the count go from 0 to 1 may acquire a reference
+		 * on the parent: increment first, then check the
+		 * previous value.
+		 *
+		 * A parented object with a reference count of 0 is
+		 * kept alive by its parent, so the caller, which
+		 * borrowed it, already guarantees that the parent
+		 * exists.
+		 */
+#ifdef BT_LOGT
+		BT_LOGT("Incrementing object's reference count atomically: "
+			"addr=%p", obj);
+#endif
+
+		if (G_UNLIKELY(bt_object_inc_ref_count(obj) == 0 &&
+				obj->parent)) {
+#ifdef BT_LOGT
+			BT_LOGT("Incrementing object's parent's reference count: "
+				"addr=%p, parent-addr=%p", obj, obj->parent);
+#endif
+
+			bt_object_get_ref_no_null_check(obj->parent);
+		}
+
+		return;
+	}
+
 	if (G_UNLIKELY(obj->parent && bt_object_get_ref_count(obj) == 0)) {
 #ifdef BT_LOGT
 		BT_LOGT("Incrementing object's parent's reference count: "
@@ -300,9 +406,7 @@ void bt_object_put_ref_no_null_check(const void *c_obj)
 		obj, obj->ref_count, obj->ref_count - 1);
 #endif
 
-	obj->ref_count--;
-
-	if (obj->ref_count == 0) {
+	if (bt_object_dec_ref_count(obj) == 0) {
 		BT_ASSERT_DBG(obj->release_func);
 		obj->release_func(obj);
 	}
@@ -25,7 +25,6 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <sys/stat.h>
-#include <ftw.h>
 #include <pthread.h>
 
 #include "plugin.h"
@@ -37,8 +36,6 @@
 #define PYTHON_PLUGIN_PROVIDER_SYM_NAME	bt_plugin_python_create_all_from_file
 #define PYTHON_PLUGIN_PROVIDER_SYM_NAME_STR	G_STRINGIFY(PYTHON_PLUGIN_PROVIDER_SYM_NAME)
 
-#define APPEND_ALL_FROM_DIR_NFDOPEN_MAX	8
-
 /* Declare here to make sure definition in both ifdef branches are in sync. */
 static
 int init_python_plugin_provider(void);
@@ -62,6 +59,9 @@ int init_python_plugin_provider(void)
 #else /* BT_BUILT_IN_PYTHON_PLUGIN_SUPPORT */
 static GModule *python_plugin_provider_module;
 
+/* Protects the Python plugin provider loading */
+static pthread_mutex_t python_plugin_provider_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static
 create_all_from_file_sym_type bt_plugin_python_create_all_from_file_sym;
 
@@ -72,6 +72,8 @@ int init_python_plugin_provider(void) {
 	static const char * const provider_dir_envvar_name = "LIBBABELTRACE2_PLUGIN_PROVIDER_DIR";
 	char *provider_path = NULL;
 
+	pthread_mutex_lock(&python_plugin_provider_lock);
+
 	if (bt_plugin_python_create_all_from_file_sym) {
 		goto end;
 	}
@@ -128,6 +130,7 @@ int init_python_plugin_provider(void) {
 		python_plugin_provider_module);
 
 end:
+	pthread_mutex_unlock(&python_plugin_provider_lock);
 	g_free(provider_path);
 
 	return status;
@@ -496,113 +499,136 @@ end:
 	return status;
 }
 
-static struct {
-	pthread_mutex_t lock;
+/*
+ * Context of a plugin directory walk.
+ *
+ * Each bt_plugin_create_append_all_from_dir() call has its own context
+ * (on its stack) instead of sharing a global, lock-protected one, so
+ * that threads can find plugins in parallel.
+ */
+struct append_all_from_dir_ctx {
 	struct bt_plugin_set *plugin_set;
 	bool recurse;
 	bool fail_on_load_error;
-	int status;
-} append_all_from_dir_info = {
-	.lock = PTHREAD_MUTEX_INITIALIZER
 };
 
 static
-int nftw_append_all_from_dir(const char *file,
-		const struct stat *sb, int flag, struct FTW *s)
+int append_all_from_file(struct append_all_from_dir_ctx *ctx,
+		const char *file)
 {
-	int ret = 0;
-	const char *name = file + s->base;
-
-	/* Check for recursion */
-	if (!append_all_from_dir_info.recurse && s->level > 1) {
-		goto end;
-	}
+	int status;
+	const struct bt_plugin_set *plugins_from_file = NULL;
 
-	switch (flag) {
-	case FTW_F:
-	{
-		const struct bt_plugin_set *plugins_from_file = NULL;
+	status = bt_plugin_find_all_from_file(file, ctx->fail_on_load_error,
+		&plugins_from_file);
+	if (status == BT_FUNC_STATUS_OK) {
+		size_t j;
 
-		if (name[0] == '.') {
-			/* Skip hidden files */
-			BT_LOGI("Skipping hidden file: path=\"%s\"", file);
-			goto end;
-		}
+		BT_ASSERT(plugins_from_file);
 
-		append_all_from_dir_info.status =
-			bt_plugin_find_all_from_file(file,
-				append_all_from_dir_info.fail_on_load_error,
-				&plugins_from_file);
-		if (append_all_from_dir_info.status == BT_FUNC_STATUS_OK) {
-			size_t j;
-
-			BT_ASSERT(plugins_from_file);
-
-			for (j = 0; j < plugins_from_file->plugins->len; j++) {
-				struct bt_plugin *plugin =
-					g_ptr_array_index(plugins_from_file->plugins, j);
-
-				BT_LIB_LOGI("Adding plugin to plugin set: "
-					"plugin-path=\"%s\", %![plugin-]+l",
-					file, plugin);
-				bt_plugin_set_add_plugin(
-					append_all_from_dir_info.plugin_set,
-					plugin);
-			}
+		for (j = 0; j < plugins_from_file->plugins->len; j++) {
+			struct bt_plugin *plugin =
+				g_ptr_array_index(plugins_from_file->plugins, j);
 
-			bt_object_put_ref(plugins_from_file);
-			goto end;
-		} else if (append_all_from_dir_info.status < 0) {
-			/* bt_plugin_find_all_from_file() logs errors */
-			BT_ASSERT(!plugins_from_file);
-			ret = -1;
-			goto end;
+			BT_LIB_LOGI("Adding plugin to plugin set: "
+				"plugin-path=\"%s\", %![plugin-]+l",
+				file, plugin);
+			bt_plugin_set_add_plugin(ctx->plugin_set, plugin);
 		}
 
+		bt_object_put_ref(plugins_from_file);
+	} else if (status < 0) {
+		/* bt_plugin_find_all_from_file() logs errors */
+		BT_ASSERT(!plugins_from_file);
+	} else {
 		/*
 		 * Not found in this file: this is no an error; continue
 		 * walking the directories.
 		 */
 		BT_ASSERT(!plugins_from_file);
-		BT_ASSERT(append_all_from_dir_info.status ==
-			BT_FUNC_STATUS_NOT_FOUND);
-		break;
+		BT_ASSERT(status == BT_FUNC_STATUS_NOT_FOUND);
+		status = BT_FUNC_STATUS_OK;
 	}
-	case FTW_DNR:
-		/* Continue to next file / directory. */
-		BT_LOGI("Cannot enter directory: continuing: path=\"%s\"", file);
-		break;
-	case FTW_NS:
+
+	return status;
+}
+
+/*
+ * Appends the plugins of all the files of the directory `dir_path`,
+ * recursing into its subdirectories if `ctx->recurse` is true.
+ *
+ * Like a physical walk, this ignores symbolic links within the
+ * directory, as well as hidden files.
+ */
+static
+int append_all_from_dir(struct append_all_from_dir_ctx *ctx,
+		const char *dir_path)
+{
+	int status = BT_FUNC_STATUS_OK;
+	GError *gerror = NULL;
+	GDir *dir;
+	const char *name;
+
+	dir = g_dir_open(dir_path, 0, &gerror);
+	if (!dir) {
 		/* Continue to next file / directory. */
-		BT_LOGI("Cannot get file information: continuing: path=\"%s\"", file);
-		break;
+		BT_LOGI("Cannot enter directory: continuing: path=\"%s\", "
+			"error=\"%s\"", dir_path, gerror->message);
+		g_error_free(gerror);
+		goto end;
+	}
+
+	while ((name = g_dir_read_name(dir))) {
+		char *path = g_build_filename(dir_path, name, NULL);
+
+		if (g_file_test(path, G_FILE_TEST_IS_SYMLINK)) {
+			BT_LOGI("Skipping symbolic link: path=\"%s\"", path);
+		} else if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+			if (ctx->recurse) {
+				status = append_all_from_dir(ctx, path);
+			}
+		} else if (g_file_test(path, G_FILE_TEST_IS_REGULAR)) {
+			if (name[0] == '.') {
+				/* Skip hidden files */
+				BT_LOGI("Skipping hidden file: path=\"%s\"",
+					path);
+			} else {
+				status = append_all_from_file(ctx, path);
+			}
+		}
+
+		g_free(path);
+
+		if (status < 0) {
+			goto end;
+		}
 	}
 
 end:
-	return ret;
+	if (dir) {
+		g_dir_close(dir);
+	}
+
+	return status;
 }
 
 static
 int bt_plugin_create_append_all_from_dir(struct bt_plugin_set *plugin_set,
 		const char *path, bt_bool recurse, bt_bool fail_on_load_error)
 {
-	int nftw_flags = FTW_PHYS;
-	int ret;
 	int status;
 	struct stat sb;
+	struct append_all_from_dir_ctx ctx = {
+		.plugin_set = plugin_set,
+		.recurse = recurse,
+		.fail_on_load_error = fail_on_load_error,
+	};
 
 	BT_ASSERT(plugin_set);
 	BT_ASSERT(path);
 	BT_ASSERT(strlen(path) < PATH_MAX);
 
-	/*
-	 * Make sure that path exists and is accessible.
-	 * This is necessary since Cygwin implementation of nftw() is not POSIX
-	 * compliant. Cygwin nftw() implementation does not fail on non-existent
-	 * path with ENOENT. Instead, it flags the directory as FTW_NS. FTW_NS during
-	 * nftw_append_all_from_dir is not treated as an error since we are
-	 * traversing the tree for plugin discovery.
-	 */
+	/* Make sure that path exists and is accessible. */
 	if (stat(path, &sb)) {
 		BT_LOGW_ERRNO("Cannot open directory",
 			": path=\"%s\", recurse=%d",
@@ -615,32 +641,25 @@ int bt_plugin_create_append_all_from_dir(struct bt_plugin_set *plugin_set,
 		goto end;
 	}
 
-	pthread_mutex_lock(&append_all_from_dir_info.lock);
-	append_all_from_dir_info.plugin_set = plugin_set;
-	append_all_from_dir_info.recurse = recurse;
-	append_all_from_dir_info.status = BT_FUNC_STATUS_OK;
-	append_all_from_dir_info.fail_on_load_error = fail_on_load_error;
-	ret = nftw(path, nftw_append_all_from_dir,
-		APPEND_ALL_FROM_DIR_NFDOPEN_MAX, nftw_flags);
-	append_all_from_dir_info.plugin_set = NULL;
-	status = append_all_from_dir_info.status;
-	pthread_mutex_unlock(&append_all_from_dir_info.lock);
-	if (ret) {
-		BT_LIB_LOGW_APPEND_CAUSE("Failed to walk directory",
-			": path=\"%s\", recurse=%d",
+	if (S_ISDIR(sb.st_mode)) {
+		status = append_all_from_dir(&ctx, path);
+	} else {
+		status = append_all_from_file(&ctx, path);
+	}
+
+	if (status < 0) {
+		BT_LIB_LOGW_APPEND_CAUSE("Failed to walk directory: "
+			"path=\"%s\", recurse=%d",
 			path, recurse);
 		status = BT_FUNC_STATUS_ERROR;
 		goto end;
 	}
 
-	if (status == BT_FUNC_STATUS_NOT_FOUND) {
-		/*
-		 * We're just appending in this function; even if
-		 * nothing was found, it's still okay from the caller's
-		 * perspective.
-		 */
-		status = BT_FUNC_STATUS_OK;
-	}
+	/*
+	 * We're just appending in this function; even if nothing was
+	 * found, it's still okay from the caller's perspective.
+	 */
+	BT_ASSERT(status == BT_FUNC_STATUS_OK);
 
 end:
 	return status;
@@ -67,6 +67,25 @@ void set_base_offset(struct bt_clock_class *clock_class)
 		clock_class->frequency, &clock_class->base_offset.value_ns);
 }
 
+static inline
+void set_cycles_to_ns(struct bt_clock_class *clock_class)
+{
+	int shift;
+
+	if (clock_class->frequency == UINT64_C(1000000000)) {
+		clock_class->cycles_to_ns.method =
+			BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_IDENTITY;
+	} else if ((shift = bt_util_frequency_shift(
+			clock_class->frequency)) >= 0) {
+		clock_class->cycles_to_ns.method =
+			BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_SHIFT;
+		clock_class->cycles_to_ns.shift = (unsigned int) shift;
+	} else {
+		clock_class->cycles_to_ns.method =
+			BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_GENERIC;
+	}
+}
+
 struct bt_clock_class *bt_clock_class_create(bt_self_component *self_comp)
 {
 	int ret;
@@ -83,6 +102,7 @@ struct bt_clock_class *bt_clock_class_create(bt_self_component *self_comp)
 	}
 
 	bt_object_init_shared(&clock_class->base, destroy_clock_class);
+	bt_object_set_ref_count_is_atomic(&clock_class->base);
 
 	clock_class->user_attributes = bt_value_map_create();
 	if (!clock_class->user_attributes) {
@@ -106,6 +126,7 @@ struct bt_clock_class *bt_clock_class_create(bt_self_component *self_comp)
 	clock_class->frequency = UINT64_C(1000000000);
 	clock_class->origin_is_unix_epoch = BT_TRUE;
 	set_base_offset(clock_class);
+	set_cycles_to_ns(clock_class);
 	ret = bt_object_pool_initialize(&clock_class->cs_pool,
 		(bt_object_pool_new_object_func) bt_clock_snapshot_new,
 		(bt_object_pool_destroy_object_func)
@@ -189,6 +210,7 @@ void bt_clock_class_set_frequency(struct bt_clock_class *clock_class,
 		"%![cc-]+K, new-freq=%" PRIu64, clock_class, frequency);
 	clock_class->frequency = frequency;
 	set_base_offset(clock_class);
+	set_cycles_to_ns(clock_class);
 	BT_LIB_LOGD("Set clock class's frequency: %!+K", clock_class);
 }
 
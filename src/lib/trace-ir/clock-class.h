@@ -23,6 +23,18 @@
 
 #include "lib/func-status.h"
 
+/* Method to convert a value in cycles to nanoseconds */
+enum bt_clock_class_cycles_to_ns_method {
+	/* 1 GHz: one cycle is one nanosecond */
+	BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_IDENTITY,
+
+	/* Power of two frequency: bt_util_ns_from_value_shift() */
+	BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_SHIFT,
+
+	/* Any other frequency: bt_util_ns_from_value() */
+	BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_GENERIC,
+};
+
 struct bt_clock_class {
 	struct bt_object base;
 
@@ -75,6 +87,20 @@ struct bt_clock_class {
 		bool overflows;
 	} base_offset;
 
+	/*
+	 * Converter of values in cycles to nanoseconds, chosen every
+	 * time you call bt_clock_class_set_frequency(), as well as
+	 * initially, so that converting a clock snapshot doesn't need
+	 * to check the frequency.
+	 *
+	 * `shift` is only valid with
+	 * `BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_SHIFT`.
+	 */
+	struct {
+		enum bt_clock_class_cycles_to_ns_method method;
+		unsigned int shift;
+	} cycles_to_ns;
+
 	/* Pool of `struct bt_clock_snapshot *` */
 	struct bt_object_pool cs_pool;
 
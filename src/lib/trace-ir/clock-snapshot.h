@@ -43,11 +43,11 @@ void bt_clock_snapshot_reset(struct bt_clock_snapshot *clock_snapshot)
 static inline
 void set_ns_from_origin(struct bt_clock_snapshot *clock_snapshot)
 {
-	if (bt_util_ns_from_origin_clock_class(clock_snapshot->clock_class,
+	/* Reset the flag: this clock snapshot is possibly recycled */
+	clock_snapshot->ns_from_origin_overflows =
+		bt_util_ns_from_origin_clock_class(clock_snapshot->clock_class,
 			clock_snapshot->value_cycles,
-			&clock_snapshot->ns_from_origin)) {
-		clock_snapshot->ns_from_origin_overflows = true;
-	}
+			&clock_snapshot->ns_from_origin) != 0;
 }
 
 static inline
@@ -60,6 +60,45 @@ void bt_clock_snapshot_set_raw_value(struct bt_clock_snapshot *clock_snapshot,
 	bt_clock_snapshot_set(clock_snapshot);
 }
 
+/*
+ * Initializes the clock snapshot `clock_snapshot` which is part of
+ * another object (for example, an event message) instead of coming from
+ * the clock snapshot pool of a clock class.
+ *
+ * Such a clock snapshot doesn't hold a reference on its clock class:
+ * its containing object must keep the clock class alive.
+ */
+static inline
+void bt_clock_snapshot_init_inline(struct bt_clock_snapshot *clock_snapshot)
+{
+	BT_ASSERT_DBG(clock_snapshot);
+	bt_object_init_unique(&clock_snapshot->base);
+}
+
+/*
+ * Sets the clock class (weak) and the raw value of the inline clock
+ * snapshot `clock_snapshot` (see bt_clock_snapshot_init_inline()).
+ */
+static inline
+void bt_clock_snapshot_set_inline(struct bt_clock_snapshot *clock_snapshot,
+		struct bt_clock_class *clock_class, uint64_t cycles)
+{
+	BT_ASSERT_DBG(clock_class);
+	clock_snapshot->clock_class = clock_class;
+	bt_clock_snapshot_set_raw_value(clock_snapshot, cycles);
+}
+
+/*
+ * Resets the inline clock snapshot `clock_snapshot` (see
+ * bt_clock_snapshot_init_inline()).
+ */
+static inline
+void bt_clock_snapshot_reset_inline(struct bt_clock_snapshot *clock_snapshot)
+{
+	bt_clock_snapshot_reset(clock_snapshot);
+	clock_snapshot->clock_class = NULL;
+}
+
 BT_HIDDEN
 void bt_clock_snapshot_destroy(struct bt_clock_snapshot *clock_snapshot);
 
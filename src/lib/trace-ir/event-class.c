@@ -75,21 +75,7 @@ static
 bool event_class_id_is_unique(const struct bt_stream_class *stream_class,
 		uint64_t id)
 {
-	uint64_t i;
-	bool is_unique = true;
-
-	for (i = 0; i < stream_class->event_classes->len; i++) {
-		const struct bt_event_class *ec =
-			stream_class->event_classes->pdata[i];
-
-		if (ec->id == id) {
-			is_unique = false;
-			goto end;
-		}
-	}
-
-end:
-	return is_unique;
+	return !g_hash_table_lookup(stream_class->event_classes_by_id, &id);
 }
 
 static
@@ -114,6 +100,7 @@ struct bt_event_class *create_event_class_with_id(
 
 	bt_object_init_shared_with_parent(&event_class->base,
 		destroy_event_class);
+	bt_object_set_ref_count_is_atomic(&event_class->base);
 	event_class->user_attributes = bt_value_map_create();
 	if (!event_class->user_attributes) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -149,6 +136,8 @@ struct bt_event_class *create_event_class_with_id(
 
 	bt_object_set_parent(&event_class->base, &stream_class->base);
 	g_ptr_array_add(stream_class->event_classes, event_class);
+	g_hash_table_insert(stream_class->event_classes_by_id,
+		&event_class->id, event_class);
 	bt_stream_class_freeze(stream_class);
 	BT_LIB_LOGD("Created event class object: %!+E", event_class);
 	goto end;
@@ -47,6 +47,7 @@ int init_field_class(struct bt_field_class *fc, enum bt_field_class_type type,
 	BT_ASSERT(fc);
 	BT_ASSERT(release_func);
 	bt_object_init_shared(&fc->base, release_func);
+	bt_object_set_ref_count_is_atomic(&fc->base);
 	fc->type = type;
 	fc->user_attributes = bt_value_map_create();
 	if (!fc->user_attributes) {
@@ -313,6 +314,29 @@ void finalize_enumeration_field_class_mapping(
 	BT_OBJECT_PUT_REF_AND_RESET(mapping->range_set);
 }
 
+static
+void reset_enumeration_field_class_label_index(
+		struct bt_field_class_enumeration *fc)
+{
+	if (fc->label_index.interval_starts) {
+		g_array_free(fc->label_index.interval_starts, TRUE);
+		fc->label_index.interval_starts = NULL;
+	}
+
+	if (fc->label_index.label_offsets) {
+		g_array_free(fc->label_index.label_offsets, TRUE);
+		fc->label_index.label_offsets = NULL;
+	}
+
+	if (fc->label_index.labels) {
+		g_ptr_array_free(fc->label_index.labels, TRUE);
+		fc->label_index.labels = NULL;
+	}
+
+	fc->label_index.is_built = false;
+	fc->label_index.is_usable = false;
+}
+
 static
 void destroy_enumeration_field_class(struct bt_object *obj)
 {
@@ -339,6 +363,7 @@ void destroy_enumeration_field_class(struct bt_object *obj)
 		fc->label_buf = NULL;
 	}
 
+	reset_enumeration_field_class_label_index(fc);
 	g_free(fc);
 }
 
@@ -521,64 +546,262 @@ bt_field_class_enumeration_signed_mapping_borrow_ranges_const(
 	return (const void *) mapping->range_set;
 }
 
-enum bt_field_class_enumeration_get_mapping_labels_for_value_status
-bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
-		const struct bt_field_class *fc, uint64_t value,
-		bt_field_class_enumeration_mapping_label_array *label_array,
-		uint64_t *count)
+/*
+ * Maximum total number of labels (over all the intervals) of an
+ * enumeration field class's label index.
+ */
+#define ENUM_LABEL_INDEX_MAX_LABEL_COUNT	65536
+
+/* Order-preserving unsigned index value of a range set value */
+static inline
+uint64_t enum_label_index_value(uint64_t value, bool is_signed)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
-	uint64_t i;
+	return is_signed ? value ^ (UINT64_C(1) << 63) : value;
+}
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
-	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
-		"Label array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
-	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "unsigned-enumeration",
-		BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION, "Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
+/* A range boundary while building an enumeration label index */
+struct enum_label_index_event {
+	/* Index value at which the mapping starts or stops to apply */
+	uint64_t at;
+
+	uint64_t mapping_index;
+
+	/* 1 if the mapping starts to apply, -1 if it stops */
+	int delta;
+};
+
+static
+gint compare_enum_label_index_events(gconstpointer a, gconstpointer b)
+{
+	const struct enum_label_index_event *event_a = a;
+	const struct enum_label_index_event *event_b = b;
+
+	if (event_a->at < event_b->at) {
+		return -1;
+	} else if (event_a->at > event_b->at) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Builds the label index of `enum_fc` with a sweep over the sorted
+ * boundaries of all the ranges of its mappings.
+ *
+ * On allocation failure or if the index would be too large, the index
+ * is marked as not usable and the caller looks up the mappings
+ * linearly.
+ */
+static
+void build_enumeration_field_class_label_index(
+		struct bt_field_class_enumeration *enum_fc, bool is_signed)
+{
+	GArray *events = NULL;
+	uint64_t *active_counts = NULL;
+	guint i;
+
+	reset_enumeration_field_class_label_index(enum_fc);
+	enum_fc->label_index.is_built = true;
+	events = g_array_new(FALSE, FALSE,
+		sizeof(struct enum_label_index_event));
+	active_counts = g_new0(uint64_t, enum_fc->mappings->len);
+	enum_fc->label_index.interval_starts = g_array_new(FALSE, FALSE,
+		sizeof(uint64_t));
+	enum_fc->label_index.label_offsets = g_array_new(FALSE, FALSE,
+		sizeof(guint));
+	enum_fc->label_index.labels = g_ptr_array_new();
+
+	if (!events || (!active_counts && enum_fc->mappings->len > 0) ||
+			!enum_fc->label_index.interval_starts ||
+			!enum_fc->label_index.label_offsets ||
+			!enum_fc->label_index.labels) {
+		BT_LOGW_STR("Failed to allocate enumeration field class's "
+			"label index: looking up mappings linearly.");
+		goto error;
+	}
 
 	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
 		const struct bt_field_class_enumeration_mapping *mapping =
 			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+		guint j;
 
 		for (j = 0; j < mapping->range_set->ranges->len; j++) {
 			const struct bt_integer_range *range = (const void *)
 				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
 					mapping->range_set, j);
+			struct enum_label_index_event event = {
+				.at = enum_label_index_value(range->lower.u,
+					is_signed),
+				.mapping_index = i,
+				.delta = 1,
+			};
+			uint64_t upper = enum_label_index_value(
+				range->upper.u, is_signed);
+
+			g_array_append_val(events, event);
+
+			if (upper != UINT64_MAX) {
+				event.at = upper + 1;
+				event.delta = -1;
+				g_array_append_val(events, event);
+			}
+		}
+	}
 
-			if (value >= range->lower.u &&
-					value <= range->upper.u) {
-				g_ptr_array_add(enum_fc->label_buf,
-					mapping->label->str);
+	g_array_sort(events, compare_enum_label_index_events);
+
+	for (i = 0; i < events->len;) {
+		uint64_t at = g_array_index(events,
+			struct enum_label_index_event, i).at;
+		guint offset = enum_fc->label_index.labels->len;
+		guint prev_offset, label_count;
+		guint j;
+
+		/* Apply all the events at this value */
+		for (; i < events->len; i++) {
+			struct enum_label_index_event *event =
+				&g_array_index(events,
+					struct enum_label_index_event, i);
+
+			if (event->at != at) {
 				break;
 			}
+
+			active_counts[event->mapping_index] += event->delta;
+		}
+
+		for (j = 0; j < enum_fc->mappings->len; j++) {
+			if (active_counts[j] > 0) {
+				g_ptr_array_add(enum_fc->label_index.labels,
+					BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(
+						enum_fc, j)->label->str);
+			}
+		}
+
+		label_count = enum_fc->label_index.labels->len - offset;
+
+		if (enum_fc->label_index.labels->len >
+				ENUM_LABEL_INDEX_MAX_LABEL_COUNT) {
+			BT_LOGD_STR("Enumeration field class's label index "
+				"would be too large: looking up mappings "
+				"linearly.");
+			goto error;
+		}
+
+		/*
+		 * Merge this interval with the previous one if they
+		 * have the same labels.
+		 */
+		if (enum_fc->label_index.interval_starts->len > 0) {
+			prev_offset = g_array_index(
+				enum_fc->label_index.label_offsets, guint,
+				enum_fc->label_index.label_offsets->len - 1);
+
+			if (offset - prev_offset == label_count &&
+					memcmp(&enum_fc->label_index.labels->pdata[prev_offset],
+						&enum_fc->label_index.labels->pdata[offset],
+						sizeof(const char *) * label_count) == 0) {
+				g_ptr_array_set_size(
+					enum_fc->label_index.labels,
+					(gint) offset);
+				continue;
+			}
 		}
+
+		g_array_append_val(enum_fc->label_index.interval_starts, at);
+		g_array_append_val(enum_fc->label_index.label_offsets, offset);
 	}
 
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
-	return BT_FUNC_STATUS_OK;
+	i = enum_fc->label_index.labels->len;
+	g_array_append_val(enum_fc->label_index.label_offsets, i);
+	enum_fc->label_index.is_usable = true;
+	goto end;
+
+error:
+	reset_enumeration_field_class_label_index(enum_fc);
+	enum_fc->label_index.is_built = true;
+
+end:
+	if (events) {
+		g_array_free(events, TRUE);
+	}
+
+	g_free(active_counts);
 }
 
-enum bt_field_class_enumeration_get_mapping_labels_for_value_status
-bt_field_class_enumeration_signed_get_mapping_labels_for_value(
-		const struct bt_field_class *fc, int64_t value,
+/*
+ * Sets `*label_array` and `*count` to the labels of the interval of
+ * the label index of `enum_fc` which contains `value`.
+ */
+static inline
+void borrow_enumeration_field_class_labels_from_index(
+		const struct bt_field_class_enumeration *enum_fc,
+		uint64_t value,
 		bt_field_class_enumeration_mapping_label_array *label_array,
 		uint64_t *count)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
+	const GArray *starts = enum_fc->label_index.interval_starts;
+	guint lo = 0;
+	guint hi = starts->len;
+	guint offset, next_offset;
+
+	/* Find the last interval which starts at or before `value` */
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+
+		if (g_array_index(starts, uint64_t, mid) <= value) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	*label_array = (void *) enum_fc->label_index.labels->pdata;
+
+	if (lo == 0) {
+		/* Before the first interval: no labels */
+		*count = 0;
+		goto end;
+	}
+
+	offset = g_array_index(enum_fc->label_index.label_offsets, guint,
+		lo - 1);
+	next_offset = g_array_index(enum_fc->label_index.label_offsets,
+		guint, lo);
+	*label_array = (void *) &enum_fc->label_index.labels->pdata[offset];
+	*count = (uint64_t) (next_offset - offset);
+
+end:
+	return;
+}
+
+/*
+ * Looks up the labels of the mappings of `c_enum_fc` which contain
+ * `value` (a signed value cast to `uint64_t` if `is_signed` is true),
+ * using its label index if possible.
+ */
+static
+void get_enumeration_field_class_mapping_labels_for_value(
+		const struct bt_field_class_enumeration *c_enum_fc,
+		uint64_t value, bool is_signed,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	struct bt_field_class_enumeration *enum_fc = (void *) c_enum_fc;
 	uint64_t i;
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
-	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
-		"Label array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
-	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "signed-enumeration",
-		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION, "Field class");
+	if (G_UNLIKELY(!enum_fc->label_index.is_built)) {
+		build_enumeration_field_class_label_index(enum_fc, is_signed);
+	}
+
+	if (G_LIKELY(enum_fc->label_index.is_usable)) {
+		borrow_enumeration_field_class_labels_from_index(enum_fc,
+			enum_label_index_value(value, is_signed),
+			label_array, count);
+		goto end;
+	}
+
 	g_ptr_array_set_size(enum_fc->label_buf, 0);
 
 	for (i = 0; i < enum_fc->mappings->len; i++) {
@@ -590,9 +813,17 @@ bt_field_class_enumeration_signed_get_mapping_labels_for_value(
 			const struct bt_integer_range *range = (const void *)
 				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
 					mapping->range_set, j);
+			bool contains;
+
+			if (is_signed) {
+				contains = (int64_t) value >= range->lower.i &&
+					(int64_t) value <= range->upper.i;
+			} else {
+				contains = value >= range->lower.u &&
+					value <= range->upper.u;
+			}
 
-			if (value >= range->lower.i &&
-					value <= range->upper.i) {
+			if (contains) {
 				g_ptr_array_add(enum_fc->label_buf,
 					mapping->label->str);
 				break;
@@ -602,6 +833,45 @@ bt_field_class_enumeration_signed_get_mapping_labels_for_value(
 
 	*label_array = (void *) enum_fc->label_buf->pdata;
 	*count = (uint64_t) enum_fc->label_buf->len;
+
+end:
+	return;
+}
+
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+		const struct bt_field_class *fc, uint64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
+	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
+		"Label array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
+	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "unsigned-enumeration",
+		BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION, "Field class");
+	get_enumeration_field_class_mapping_labels_for_value(
+		(const void *) fc, value, false, label_array, count);
+	return BT_FUNC_STATUS_OK;
+}
+
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+bt_field_class_enumeration_signed_get_mapping_labels_for_value(
+		const struct bt_field_class *fc, int64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
+	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
+		"Label array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
+	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "signed-enumeration",
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION, "Field class");
+	get_enumeration_field_class_mapping_labels_for_value(
+		(const void *) fc, (uint64_t) value, true, label_array,
+		count);
 	return BT_FUNC_STATUS_OK;
 }
 
@@ -661,6 +931,7 @@ add_mapping_to_enumeration_field_class(struct bt_field_class *fc,
 	}
 
 	g_array_append_val(enum_fc->mappings, mapping);
+	reset_enumeration_field_class_label_index(enum_fc);
 	BT_LIB_LOGD("Added mapping to enumeration field class: "
 		"%![fc-]+F, label=\"%s\"", fc, label);
 
@@ -1129,6 +1400,33 @@ bt_field_class_structure_borrow_member_by_name(
 			(void *) fc, name, __func__);
 }
 
+bt_bool bt_field_class_structure_get_member_index_by_name(
+		const struct bt_field_class *fc, const char *name,
+		uint64_t *index)
+{
+	const struct bt_field_class_named_field_class_container *container_fc =
+		(const void *) fc;
+	gpointer orig_key;
+	gpointer value;
+	bt_bool found = BT_FALSE;
+
+	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
+	BT_ASSERT_PRE_FC_IS_STRUCT("field-class", fc, "Field class");
+	BT_ASSERT_PRE_DEV_NAME_NON_NULL(name);
+	BT_ASSERT_PRE_DEV_NON_NULL("index-output", index,
+		"Index (output)");
+	if (!g_hash_table_lookup_extended(container_fc->name_to_index, name,
+			&orig_key, &value)) {
+		goto end;
+	}
+
+	*index = (uint64_t) GPOINTER_TO_UINT(value);
+	found = BT_TRUE;
+
+end:
+	return found;
+}
+
 const char *bt_field_class_structure_member_get_name(
 		const struct bt_field_class_structure_member *member)
 {
@@ -96,6 +96,50 @@ struct bt_field_class_enumeration {
 	 * The actual strings are owned by the mappings above.
 	 */
 	GPtrArray *label_buf;
+
+	/*
+	 * Index of the labels for each value, built on the first call
+	 * to
+	 * bt_field_class_enumeration_unsigned_get_mapping_labels_for_value()
+	 * or
+	 * bt_field_class_enumeration_signed_get_mapping_labels_for_value()
+	 * and reset when adding a mapping.
+	 *
+	 * The value domain is split into intervals, each one mapping to
+	 * the same set of labels. Signed values are indexed with their
+	 * sign bit flipped so that their order is the unsigned order.
+	 */
+	struct {
+		/* True if the members below are valid */
+		bool is_built;
+
+		/*
+		 * False if the index would be too large: look up the
+		 * mappings linearly instead.
+		 */
+		bool is_usable;
+
+		/*
+		 * Array of `uint64_t`: sorted first (index) value of
+		 * each interval; an interval ends where the next one
+		 * begins.
+		 */
+		GArray *interval_starts;
+
+		/*
+		 * Array of `guint`: index, within `labels`, of the
+		 * first label of each interval, followed by the total
+		 * number of labels.
+		 */
+		GArray *label_offsets;
+
+		/*
+		 * Array of `const char *` (owned by the mappings
+		 * above): labels of all the intervals, in mapping
+		 * order within an interval.
+		 */
+		GPtrArray *labels;
+	} label_index;
 };
 
 struct bt_field_class_real {
@@ -46,6 +46,7 @@ struct bt_field_path *bt_field_path_create(void)
 	}
 
 	bt_object_init_shared(&field_path->base, destroy_field_path);
+	bt_object_set_ref_count_is_atomic(&field_path->base);
 	field_path->items = g_array_new(FALSE, FALSE,
 		sizeof(struct bt_field_path_item));
 	if (!field_path->items) {
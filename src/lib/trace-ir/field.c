@@ -26,6 +26,19 @@
 	BT_ASSERT_PRE_DEV_HOT("field",					\
 		(const struct bt_field *) (_field), "Field", ": %!+f", (_field))
 
+/* Alignment of each field object within a field arena */
+#define FIELD_ARENA_ALIGN	8
+
+/*
+ * Bump allocator from which bt_field_create() creates a whole field
+ * tree (the field and all the fields it contains, except the elements
+ * of dynamic array fields) within a single memory block.
+ */
+struct field_arena {
+	char *cur;
+	char *end;
+};
+
 static
 void reset_single_field(struct bt_field *field);
 
@@ -135,34 +148,44 @@ struct bt_field_methods variant_field_methods = {
 };
 
 static
-struct bt_field *create_bool_field(struct bt_field_class *);
+struct bt_field *create_bool_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_bit_array_field(struct bt_field_class *);
+struct bt_field *create_bit_array_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_integer_field(struct bt_field_class *);
+struct bt_field *create_integer_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_real_field(struct bt_field_class *);
+struct bt_field *create_real_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_string_field(struct bt_field_class *);
+struct bt_field *create_string_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_structure_field(struct bt_field_class *);
+struct bt_field *create_structure_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_static_array_field(struct bt_field_class *);
+struct bt_field *create_static_array_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *);
+struct bt_field *create_dynamic_array_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_option_field(struct bt_field_class *);
+struct bt_field *create_option_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *);
+struct bt_field *create_variant_field(struct bt_field_class *,
+		struct field_arena *);
 
 static
 void destroy_bool_field(struct bt_field *field);
@@ -210,8 +233,9 @@ enum bt_field_class_type bt_field_get_class_type(const struct bt_field *field)
 	return field->class->type;
 }
 
-BT_HIDDEN
-struct bt_field *bt_field_create(struct bt_field_class *fc)
+static
+struct bt_field *create_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field *field = NULL;
 
@@ -219,44 +243,44 @@ struct bt_field *bt_field_create(struct bt_field_class *fc)
 
 	switch (fc->type) {
 	case BT_FIELD_CLASS_TYPE_BOOL:
-		field = create_bool_field(fc);
+		field = create_bool_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
-		field = create_bit_array_field(fc);
+		field = create_bit_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		field = create_integer_field(fc);
+		field = create_integer_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
 	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
-		field = create_real_field(fc);
+		field = create_real_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRING:
-		field = create_string_field(fc);
+		field = create_string_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRUCTURE:
-		field = create_structure_field(fc);
+		field = create_structure_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
-		field = create_static_array_field(fc);
+		field = create_static_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
-		field = create_dynamic_array_field(fc);
+		field = create_dynamic_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_option_field(fc);
+		field = create_option_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_variant_field(fc);
+		field = create_variant_field(fc, arena);
 		break;
 	default:
 		bt_common_abort();
@@ -284,119 +308,244 @@ void init_field(struct bt_field *field, struct bt_field_class *fc,
 	bt_object_get_ref_no_null_check(fc);
 }
 
+/*
+ * Allocates `size` zeroed bytes for one field object from `arena`.
+ *
+ * The returned field object is an arena member: freeing the arena's
+ * block, which is the tree's root field object, frees it.
+ */
+static inline
+void *alloc_field(struct field_arena *arena, size_t size)
+{
+	struct bt_field *field;
+
+	BT_ASSERT(arena);
+	size = ALIGN(size, FIELD_ARENA_ALIGN);
+	BT_ASSERT(arena->cur + size <= arena->end);
+	field = (void *) arena->cur;
+	arena->cur += size;
+	field->in_arena = true;
+	return field;
+}
+
+/*
+ * Returns the size of the memory block needed to create a field tree
+ * of which the root field class is `fc` within a field arena.
+ *
+ * This must match what create_field() allocates.
+ */
 static
-struct bt_field *create_bool_field(struct bt_field_class *fc)
+size_t get_field_arena_size(const struct bt_field_class *fc)
 {
-	struct bt_field_bool *bool_field;
+	size_t size;
 
-	BT_LIB_LOGD("Creating boolean field object: %![fc-]+F", fc);
-	bool_field = g_new0(struct bt_field_bool, 1);
-	if (!bool_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one boolean field.");
+	switch (fc->type) {
+	case BT_FIELD_CLASS_TYPE_BOOL:
+		size = ALIGN(sizeof(struct bt_field_bool), FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
+		size = ALIGN(sizeof(struct bt_field_bit_array),
+			FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		size = ALIGN(sizeof(struct bt_field_integer),
+			FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+		size = ALIGN(sizeof(struct bt_field_real), FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRING:
+		size = ALIGN(sizeof(struct bt_field_string),
+			FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRUCTURE:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+	{
+		const struct bt_field_class_named_field_class_container *container_fc =
+			(const void *) fc;
+		uint64_t i;
+
+		if (fc->type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+			size = ALIGN(sizeof(struct bt_field_structure),
+				FIELD_ARENA_ALIGN);
+		} else {
+			size = ALIGN(sizeof(struct bt_field_variant),
+				FIELD_ARENA_ALIGN);
+		}
+
+		for (i = 0; i < container_fc->named_fcs->len; i++) {
+			const struct bt_named_field_class *named_fc =
+				container_fc->named_fcs->pdata[i];
+
+			size += get_field_arena_size(named_fc->fc);
+		}
+
+		break;
+	}
+	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
+	{
+		const struct bt_field_class_array_static *array_fc =
+			(const void *) fc;
+
+		size = ALIGN(sizeof(struct bt_field_array), FIELD_ARENA_ALIGN) +
+			array_fc->length *
+				get_field_arena_size(array_fc->common.element_fc);
+		break;
+	}
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
+		/* Element fields are created on demand, out of the arena */
+		size = ALIGN(sizeof(struct bt_field_array), FIELD_ARENA_ALIGN);
+		break;
+	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+	{
+		const struct bt_field_class_option *opt_fc = (const void *) fc;
+
+		size = ALIGN(sizeof(struct bt_field_option),
+			FIELD_ARENA_ALIGN) +
+			get_field_arena_size(opt_fc->content_fc);
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+	return size;
+}
+
+/*
+ * Frees the memory of a field object, unless it's an arena member.
+ */
+static inline
+void free_field(struct bt_field *field)
+{
+	if (!field->in_arena) {
+		g_free(field);
+	}
+}
+
+BT_HIDDEN
+struct bt_field *bt_field_create(struct bt_field_class *fc)
+{
+	struct bt_field *field;
+	struct field_arena arena;
+	size_t size;
+
+	BT_ASSERT(fc);
+
+	/*
+	 * Create the whole field tree within a single memory block to
+	 * avoid one allocation per field and to keep an event's fields
+	 * contiguous in memory, in field class order.
+	 */
+	size = get_field_arena_size(fc);
+	arena.cur = g_malloc0(size);
+	if (!arena.cur) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate field arena: "
+			"size=%zu, %![fc-]+F", size, fc);
+		field = NULL;
 		goto end;
 	}
 
-	init_field((void *) bool_field, fc, &bool_field_methods);
-	BT_LIB_LOGD("Created boolean field object: %!+f", bool_field);
+	arena.end = arena.cur + size;
+	field = create_field(fc, &arena);
+	if (!field) {
+		/* Partially created fields are already destroyed */
+		g_free((void *) (arena.end - size));
+		goto end;
+	}
+
+	BT_ASSERT(arena.cur == arena.end);
+
+	/* The root field object owns the block */
+	BT_ASSERT((void *) field == (void *) (arena.end - size));
+	field->in_arena = false;
 
 end:
+	return field;
+}
+
+static
+struct bt_field *create_bool_field(struct bt_field_class *fc,
+		struct field_arena *arena)
+{
+	struct bt_field_bool *bool_field;
+
+	BT_LIB_LOGD("Creating boolean field object: %![fc-]+F", fc);
+	bool_field = alloc_field(arena, sizeof(struct bt_field_bool));
+	init_field((void *) bool_field, fc, &bool_field_methods);
+	BT_LIB_LOGD("Created boolean field object: %!+f", bool_field);
 	return (void *) bool_field;
 }
 
 static
-struct bt_field *create_bit_array_field(struct bt_field_class *fc)
+struct bt_field *create_bit_array_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_bit_array *ba_field;
 
 	BT_LIB_LOGD("Creating bit array field object: %![fc-]+F", fc);
-	ba_field = g_new0(struct bt_field_bit_array, 1);
-	if (!ba_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one bit array field.");
-		goto end;
-	}
-
+	ba_field = alloc_field(arena, sizeof(struct bt_field_bit_array));
 	init_field((void *) ba_field, fc, &bit_array_field_methods);
 	BT_LIB_LOGD("Created bit array field object: %!+f", ba_field);
-
-end:
 	return (void *) ba_field;
 }
 
 static
-struct bt_field *create_integer_field(struct bt_field_class *fc)
+struct bt_field *create_integer_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_integer *int_field;
 
 	BT_LIB_LOGD("Creating integer field object: %![fc-]+F", fc);
-	int_field = g_new0(struct bt_field_integer, 1);
-	if (!int_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one integer field.");
-		goto end;
-	}
-
+	int_field = alloc_field(arena, sizeof(struct bt_field_integer));
 	init_field((void *) int_field, fc, &integer_field_methods);
 	BT_LIB_LOGD("Created integer field object: %!+f", int_field);
-
-end:
 	return (void *) int_field;
 }
 
 static
-struct bt_field *create_real_field(struct bt_field_class *fc)
+struct bt_field *create_real_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_real *real_field;
 
 	BT_LIB_LOGD("Creating real field object: %![fc-]+F", fc);
-	real_field = g_new0(struct bt_field_real, 1);
-	if (!real_field) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one real field.");
-		goto end;
-	}
-
+	real_field = alloc_field(arena, sizeof(struct bt_field_real));
 	init_field((void *) real_field, fc, &real_field_methods);
 	BT_LIB_LOGD("Created real field object: %!+f", real_field);
-
-end:
 	return (void *) real_field;
 }
 
 static
-struct bt_field *create_string_field(struct bt_field_class *fc)
+struct bt_field *create_string_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_string *string_field;
 
 	BT_LIB_LOGD("Creating string field object: %![fc-]+F", fc);
-	string_field = g_new0(struct bt_field_string, 1);
-	if (!string_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one string field.");
-		goto end;
-	}
-
+	string_field = alloc_field(arena, sizeof(struct bt_field_string));
 	init_field((void *) string_field, fc, &string_field_methods);
-	string_field->buf = g_array_sized_new(FALSE, FALSE,
-		sizeof(char), 1);
-	if (!string_field->buf) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GArray.");
-		bt_field_destroy((void *) string_field);
-		string_field = NULL;
-		goto end;
-	}
-
-	g_array_index(string_field->buf, char, 0) = '\0';
+	string_field->data = string_field->inline_buf;
+	string_field->capacity = sizeof(string_field->inline_buf);
+	string_field->data[0] = '\0';
 	BT_LIB_LOGD("Created string field object: %!+f", string_field);
-
-end:
 	return (void *) string_field;
 }
 
 static inline
 int create_fields_from_named_field_classes(
 		struct bt_field_class_named_field_class_container *fc,
-		GPtrArray **fields)
+		GPtrArray **fields, struct field_arena *arena)
 {
 	int ret = 0;
 	uint64_t i;
@@ -415,7 +564,7 @@ int create_fields_from_named_field_classes(
 		struct bt_field *field;
 		struct bt_named_field_class *named_fc = fc->named_fcs->pdata[i];
 
-		field = bt_field_create(named_fc->fc);
+		field = create_field(named_fc->fc, arena);
 		if (!field) {
 			BT_LIB_LOGE_APPEND_CAUSE(
 				"Failed to create structure member or variant option field: "
@@ -433,22 +582,17 @@ end:
 }
 
 static
-struct bt_field *create_structure_field(struct bt_field_class *fc)
+struct bt_field *create_structure_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_structure *struct_field;
 
 	BT_LIB_LOGD("Creating structure field object: %![fc-]+F", fc);
-	struct_field = g_new0(struct bt_field_structure, 1);
-	if (!struct_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one structure field.");
-		goto end;
-	}
-
+	struct_field = alloc_field(arena, sizeof(struct bt_field_structure));
 	init_field((void *) struct_field, fc, &structure_field_methods);
 
 	if (create_fields_from_named_field_classes((void *) fc,
-			&struct_field->fields)) {
+			&struct_field->fields, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Cannot create structure member fields: %![fc-]+F", fc);
 		bt_field_destroy((void *) struct_field);
@@ -463,21 +607,16 @@ end:
 }
 
 static
-struct bt_field *create_option_field(struct bt_field_class *fc)
+struct bt_field *create_option_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_option *opt_field;
 	struct bt_field_class_option *opt_fc = (void *) fc;
 
 	BT_LIB_LOGD("Creating option field object: %![fc-]+F", fc);
-	opt_field = g_new0(struct bt_field_option, 1);
-	if (!opt_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one option field.");
-		goto end;
-	}
-
+	opt_field = alloc_field(arena, sizeof(struct bt_field_option));
 	init_field((void *) opt_field, fc, &option_field_methods);
-	opt_field->content_field = bt_field_create(opt_fc->content_fc);
+	opt_field->content_field = create_field(opt_fc->content_fc, arena);
 	if (!opt_field->content_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to create option field's content field: "
@@ -495,22 +634,17 @@ end:
 }
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *fc)
+struct bt_field *create_variant_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_variant *var_field;
 
 	BT_LIB_LOGD("Creating variant field object: %![fc-]+F", fc);
-	var_field = g_new0(struct bt_field_variant, 1);
-	if (!var_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one variant field.");
-		goto end;
-	}
-
+	var_field = alloc_field(arena, sizeof(struct bt_field_variant));
 	init_field((void *) var_field, fc, &variant_field_methods);
 
 	if (create_fields_from_named_field_classes((void *) fc,
-			&var_field->fields)) {
+			&var_field->fields, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create variant member fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) var_field);
@@ -525,7 +659,8 @@ end:
 }
 
 static inline
-int init_array_field_fields(struct bt_field_array *array_field)
+int init_array_field_fields(struct bt_field_array *array_field,
+		struct field_arena *arena)
 {
 	int ret = 0;
 	uint64_t i;
@@ -545,8 +680,8 @@ int init_array_field_fields(struct bt_field_array *array_field)
 	g_ptr_array_set_size(array_field->fields, array_field->length);
 
 	for (i = 0; i < array_field->length; i++) {
-		array_field->fields->pdata[i] = bt_field_create(
-			array_fc->element_fc);
+		array_field->fields->pdata[i] = create_field(
+			array_fc->element_fc, arena);
 		if (!array_field->fields->pdata[i]) {
 			BT_LIB_LOGE_APPEND_CAUSE(
 				"Cannot create array field's element field: "
@@ -561,23 +696,18 @@ end:
 }
 
 static
-struct bt_field *create_static_array_field(struct bt_field_class *fc)
+struct bt_field *create_static_array_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_class_array_static *array_fc = (void *) fc;
 	struct bt_field_array *array_field;
 
 	BT_LIB_LOGD("Creating static array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
-	if (!array_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one static array field.");
-		goto end;
-	}
-
+	array_field = alloc_field(arena, sizeof(struct bt_field_array));
 	init_field((void *) array_field, fc, &array_field_methods);
 	array_field->length = array_fc->length;
 
-	if (init_array_field_fields(array_field)) {
+	if (init_array_field_fields(array_field, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create static array fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) array_field);
@@ -592,21 +722,16 @@ end:
 }
 
 static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *fc)
+struct bt_field *create_dynamic_array_field(struct bt_field_class *fc,
+		struct field_arena *arena)
 {
 	struct bt_field_array *array_field;
 
 	BT_LIB_LOGD("Creating dynamic array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
-	if (!array_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one dynamic array field.");
-		goto end;
-	}
-
+	array_field = alloc_field(arena, sizeof(struct bt_field_array));
 	init_field((void *) array_field, fc, &array_field_methods);
 
-	if (init_array_field_fields(array_field)) {
+	if (init_array_field_fields(array_field, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create dynamic array fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) array_field);
@@ -835,7 +960,7 @@ const char *bt_field_string_get_value(const struct bt_field *field)
 	BT_ASSERT_PRE_DEV_FIELD_IS_SET("field", field);
 	BT_ASSERT_PRE_DEV_FIELD_HAS_CLASS_TYPE("field", field, "string-field",
 		BT_FIELD_CLASS_TYPE_STRING, "Field");
-	return (const char *) string_field->buf->data;
+	return string_field->data;
 }
 
 uint64_t bt_field_string_get_length(const struct bt_field *field)
@@ -856,6 +981,7 @@ void clear_string_field(struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 	string_field->length = 0;
+	string_field->data[0] = '\0';
 	bt_field_set_single(field, true);
 }
 
@@ -894,20 +1020,31 @@ enum bt_field_string_append_status append_to_string_field_with_length(
 		struct bt_field *field, const char *value, uint64_t length)
 {
 	struct bt_field_string *string_field = (void *) field;
-	char *data;
 	uint64_t new_length;
 
 	BT_ASSERT_DBG(field);
 	BT_ASSERT_DBG(value);
 	new_length = length + string_field->length;
 
-	if (G_UNLIKELY(new_length + 1 > string_field->buf->len)) {
-		g_array_set_size(string_field->buf, new_length + 1);
+	if (G_UNLIKELY(new_length + 1 > string_field->capacity)) {
+		uint64_t new_capacity = MAX(new_length + 1,
+			string_field->capacity * 2);
+
+		if (string_field->data == string_field->inline_buf) {
+			/* Spill the current value to the heap */
+			string_field->data = g_malloc(new_capacity);
+			memcpy(string_field->data, string_field->inline_buf,
+				string_field->length);
+		} else {
+			string_field->data = g_realloc(string_field->data,
+				new_capacity);
+		}
+
+		string_field->capacity = new_capacity;
 	}
 
-	data = string_field->buf->data;
-	memcpy(data + string_field->length, value, length);
-	((char *) string_field->buf->data)[new_length] = '\0';
+	memcpy(string_field->data + string_field->length, value, length);
+	string_field->data[new_length] = '\0';
 	string_field->length = new_length;
 	bt_field_set_single(field, true);
 	return BT_FUNC_STATUS_OK;
@@ -949,6 +1086,87 @@ uint64_t bt_field_array_get_length(const struct bt_field *field)
 	return array_field->length;
 }
 
+/*
+ * Creates element fields for the dynamic array field `array_field` so
+ * that it has at least `length` of them.
+ *
+ * The new element fields are created together within a single memory
+ * block, like the fields of a field tree, instead of one field tree
+ * per element. As a field keeps its element fields when its length
+ * decreases, growing geometrically makes a pooled event field reach
+ * its steady state after a few events.
+ */
+static
+int grow_dynamic_array_field(struct bt_field_array *array_field,
+		uint64_t length)
+{
+	struct bt_field_class_array *array_fc =
+		(void *) array_field->common.class;
+	uint64_t cur_len = array_field->fields->len;
+	uint64_t count = MAX(length, cur_len * 2) - cur_len;
+	size_t size = count * get_field_arena_size(array_fc->element_fc);
+	struct field_arena arena;
+	char *block = NULL;
+	int ret = 0;
+	uint64_t i;
+
+	BT_ASSERT_DBG(length > cur_len);
+
+	if (!array_field->element_blocks) {
+		array_field->element_blocks =
+			g_ptr_array_new_with_free_func(g_free);
+		if (!array_field->element_blocks) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Failed to allocate a GPtrArray.");
+			goto error;
+		}
+	}
+
+	block = g_malloc0(size);
+	if (!block) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate dynamic array field's element fields: "
+			"size=%zu, %![array-field-]+f", size, array_field);
+		goto error;
+	}
+
+	arena.cur = block;
+	arena.end = block + size;
+
+	for (i = 0; i < count; i++) {
+		struct bt_field *elem_field = create_field(
+			array_fc->element_fc, &arena);
+
+		if (!elem_field) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create element field for "
+				"dynamic array field: "
+				"index=%" PRIu64 ", "
+				"%![array-field-]+f", cur_len + i,
+				array_field);
+			goto error;
+		}
+
+		g_ptr_array_add(array_field->fields, elem_field);
+	}
+
+	BT_ASSERT(arena.cur == arena.end);
+	g_ptr_array_add(array_field->element_blocks, block);
+	goto end;
+
+error:
+	if (block) {
+		/* Destroy the element fields created within `block` */
+		g_ptr_array_set_size(array_field->fields, cur_len);
+		g_free(block);
+	}
+
+	ret = -1;
+
+end:
+	return ret;
+}
+
 enum bt_field_array_dynamic_set_length_status bt_field_array_dynamic_set_length(
 		struct bt_field *field, uint64_t length)
 {
@@ -962,29 +1180,9 @@ enum bt_field_array_dynamic_set_length_status bt_field_array_dynamic_set_length(
 
 	if (G_UNLIKELY(length > array_field->fields->len)) {
 		/* Make more room */
-		struct bt_field_class_array *array_fc;
-		uint64_t cur_len = array_field->fields->len;
-		uint64_t i;
-
-		g_ptr_array_set_size(array_field->fields, length);
-		array_fc = (void *) field->class;
-
-		for (i = cur_len; i < array_field->fields->len; i++) {
-			struct bt_field *elem_field = bt_field_create(
-				array_fc->element_fc);
-
-			if (!elem_field) {
-				BT_LIB_LOGE_APPEND_CAUSE(
-					"Cannot create element field for "
-					"dynamic array field: "
-					"index=%" PRIu64 ", "
-					"%![array-field-]+f", i, field);
-				ret = BT_FUNC_STATUS_MEMORY_ERROR;
-				goto end;
-			}
-
-			BT_ASSERT_DBG(!array_field->fields->pdata[i]);
-			array_field->fields->pdata[i] = elem_field;
+		if (grow_dynamic_array_field(array_field, length)) {
+			ret = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto end;
 		}
 	}
 
@@ -1253,7 +1451,7 @@ void destroy_bool_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying boolean field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1262,7 +1460,7 @@ void destroy_bit_array_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying bit array field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1271,7 +1469,7 @@ void destroy_integer_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying integer field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1280,7 +1478,7 @@ void destroy_real_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying real field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1297,7 +1495,7 @@ void destroy_structure_field(struct bt_field *field)
 		struct_field->fields = NULL;
 	}
 
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1313,7 +1511,7 @@ void destroy_option_field(struct bt_field *field)
 		bt_field_destroy(opt_field->content_field);
 	}
 
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1330,7 +1528,7 @@ void destroy_variant_field(struct bt_field *field)
 		var_field->fields = NULL;
 	}
 
-	g_free(field);
+	free_field(field);
 }
 
 static
@@ -1347,7 +1545,13 @@ void destroy_array_field(struct bt_field *field)
 		array_field->fields = NULL;
 	}
 
-	g_free(field);
+	/* After destroying the element fields they contain */
+	if (array_field->element_blocks) {
+		g_ptr_array_free(array_field->element_blocks, TRUE);
+		array_field->element_blocks = NULL;
+	}
+
+	free_field(field);
 }
 
 static
@@ -1359,12 +1563,13 @@ void destroy_string_field(struct bt_field *field)
 	BT_LIB_LOGD("Destroying string field object: %!+f", field);
 	bt_field_finalize(field);
 
-	if (string_field->buf) {
-		g_array_free(string_field->buf, TRUE);
-		string_field->buf = NULL;
+	if (string_field->data != string_field->inline_buf) {
+		g_free(string_field->data);
 	}
 
-	g_free(field);
+	string_field->data = NULL;
+
+	free_field(field);
 }
 
 BT_HIDDEN
@@ -46,6 +46,12 @@ struct bt_field {
 
 	bool is_set;
 	bool frozen;
+
+	/*
+	 * True if this field object belongs to the memory block of the
+	 * field tree's root field object (see bt_field_create()).
+	 */
+	bool in_arena;
 };
 
 struct bt_field_bool {
@@ -108,14 +114,39 @@ struct bt_field_array {
 	/* Array of `struct bt_field *`, owned by this */
 	GPtrArray *fields;
 
+	/*
+	 * Array of memory blocks (owned by this) containing the element
+	 * fields of `fields` of a dynamic array field, each one created
+	 * when growing it, or `NULL` if it never grew.
+	 */
+	GPtrArray *element_blocks;
+
 	/* Current effective length */
 	uint64_t length;
 };
 
+/*
+ * Size (bytes) of the inline buffer of a string field, including the
+ * terminating null byte: most string values are short enough to fit.
+ */
+#define BT_FIELD_STRING_INLINE_BUF_SIZE	32
+
 struct bt_field_string {
 	struct bt_field common;
-	GArray *buf;
+
+	/*
+	 * Null-terminated value: `inline_buf`, or, when the value
+	 * doesn't fit it, a heap buffer owned by this.
+	 */
+	char *data;
+
+	/* Size (bytes) of `data`, including the terminating null byte */
+	uint64_t capacity;
+
+	/* Current length, excluding the terminating null byte */
 	uint64_t length;
+
+	char inline_buf[BT_FIELD_STRING_INLINE_BUF_SIZE];
 };
 
 #ifdef BT_DEV_MODE
@@ -45,6 +45,11 @@ void destroy_stream_class(struct bt_object *obj)
 	BT_OBJECT_PUT_REF_AND_RESET(stream_class->user_attributes);
 	BT_OBJECT_PUT_REF_AND_RESET(stream_class->default_clock_class);
 
+	if (stream_class->event_classes_by_id) {
+		g_hash_table_destroy(stream_class->event_classes_by_id);
+		stream_class->event_classes_by_id = NULL;
+	}
+
 	if (stream_class->event_classes) {
 		BT_LOGD_STR("Destroying event classes.");
 		g_ptr_array_free(stream_class->event_classes, TRUE);
@@ -75,21 +80,7 @@ void free_field_wrapper(struct bt_field_wrapper *field_wrapper,
 static
 bool stream_class_id_is_unique(const struct bt_trace_class *tc, uint64_t id)
 {
-	uint64_t i;
-	bool is_unique = true;
-
-	for (i = 0; i < tc->stream_classes->len; i++) {
-		const struct bt_stream_class *sc =
-			tc->stream_classes->pdata[i];
-
-		if (sc->id == id) {
-			is_unique = false;
-			goto end;
-		}
-	}
-
-end:
-	return is_unique;
+	return !g_hash_table_lookup(tc->stream_classes_by_id, &id);
 }
 
 static
@@ -114,6 +105,7 @@ struct bt_stream_class *create_stream_class_with_id(
 
 	bt_object_init_shared_with_parent(&stream_class->base,
 		destroy_stream_class);
+	bt_object_set_ref_count_is_atomic(&stream_class->base);
 	stream_class->user_attributes = bt_value_map_create();
 	if (!stream_class->user_attributes) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -137,6 +129,13 @@ struct bt_stream_class *create_stream_class_with_id(
 		goto error;
 	}
 
+	stream_class->event_classes_by_id = g_hash_table_new(g_int64_hash,
+		g_int64_equal);
+	if (!stream_class->event_classes_by_id) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GHashTable.");
+		goto error;
+	}
+
 	ret = bt_object_pool_initialize(&stream_class->packet_context_field_pool,
 		(bt_object_pool_new_object_func) bt_field_wrapper_new,
 		(bt_object_pool_destroy_object_func) free_field_wrapper,
@@ -150,6 +149,8 @@ struct bt_stream_class *create_stream_class_with_id(
 
 	bt_object_set_parent(&stream_class->base, &tc->base);
 	g_ptr_array_add(tc->stream_classes, stream_class);
+	g_hash_table_insert(tc->stream_classes_by_id, &stream_class->id,
+		stream_class);
 	bt_trace_class_freeze(tc);
 	BT_LIB_LOGD("Created stream class object: %!+S", stream_class);
 	goto end;
@@ -251,23 +252,8 @@ bt_stream_class_borrow_event_class_by_index_const(
 struct bt_event_class *bt_stream_class_borrow_event_class_by_id(
 		struct bt_stream_class *stream_class, uint64_t id)
 {
-	struct bt_event_class *event_class = NULL;
-	uint64_t i;
-
 	BT_ASSERT_PRE_DEV_SC_NON_NULL(stream_class);
-
-	for (i = 0; i < stream_class->event_classes->len; i++) {
-		struct bt_event_class *event_class_candidate =
-			g_ptr_array_index(stream_class->event_classes, i);
-
-		if (event_class_candidate->id == id) {
-			event_class = event_class_candidate;
-			goto end;
-		}
-	}
-
-end:
-	return event_class;
+	return g_hash_table_lookup(stream_class->event_classes_by_id, &id);
 }
 
 const struct bt_event_class *
@@ -51,6 +51,13 @@ struct bt_stream_class {
 	/* Array of `struct bt_event_class *` */
 	GPtrArray *event_classes;
 
+	/*
+	 * Event class ID (`uint64_t *`, weak, points to the `id` member
+	 * of the event class) -> `struct bt_event_class *` (weak),
+	 * to look up an event class by ID in constant time.
+	 */
+	GHashTable *event_classes_by_id;
+
 	/* Pool of `struct bt_field_wrapper *` */
 	struct bt_object_pool packet_context_field_pool;
 
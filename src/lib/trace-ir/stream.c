@@ -48,6 +48,12 @@ void destroy_stream(struct bt_object *obj)
 	BT_LOGD_STR("Putting stream's class.");
 	bt_object_put_ref(stream->class);
 	bt_object_pool_finalize(&stream->packet_pool);
+
+	if (stream->msg_iter_data) {
+		g_array_free(stream->msg_iter_data, TRUE);
+		stream->msg_iter_data = NULL;
+	}
+
 	g_free(stream);
 }
 
@@ -108,6 +114,7 @@ struct bt_stream *create_stream_with_id(struct bt_stream_class *stream_class,
 	}
 
 	bt_object_init_shared_with_parent(&stream->base, destroy_stream);
+	bt_object_set_ref_count_is_atomic(&stream->base);
 	stream->user_attributes = bt_value_map_create();
 	if (!stream->user_attributes) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -238,6 +245,53 @@ void _bt_stream_freeze(const struct bt_stream *stream)
 	((struct bt_stream *) stream)->frozen = true;
 }
 
+BT_HIDDEN
+void bt_stream_set_msg_iter_data(struct bt_stream *stream, uint64_t key,
+		void *data)
+{
+	guint i;
+
+	BT_ASSERT_DBG(stream);
+
+	if (!stream->msg_iter_data) {
+		if (!data) {
+			goto end;
+		}
+
+		stream->msg_iter_data = g_array_sized_new(FALSE, FALSE,
+			sizeof(struct bt_stream_msg_iter_data), 2);
+	}
+
+	for (i = 0; i < stream->msg_iter_data->len; i++) {
+		struct bt_stream_msg_iter_data *entry =
+			&g_array_index(stream->msg_iter_data,
+				struct bt_stream_msg_iter_data, i);
+
+		if (entry->key == key) {
+			if (data) {
+				entry->data = data;
+			} else {
+				g_array_remove_index_fast(
+					stream->msg_iter_data, i);
+			}
+
+			goto end;
+		}
+	}
+
+	if (data) {
+		struct bt_stream_msg_iter_data entry = {
+			.key = key,
+			.data = data,
+		};
+
+		g_array_append_val(stream->msg_iter_data, entry);
+	}
+
+end:
+	return;
+}
+
 const struct bt_value *bt_stream_borrow_user_attributes_const(
 		const struct bt_stream *stream)
 {
@@ -41,9 +41,28 @@ struct bt_stream {
 	/* Pool of `struct bt_packet *` */
 	struct bt_object_pool packet_pool;
 
+	/*
+	 * Array of `struct bt_stream_msg_iter_data`, or `NULL` if no
+	 * message iterator attached data to this stream yet (see
+	 * bt_self_message_iterator_set_stream_data()).
+	 *
+	 * There's usually one entry per filter message iterator in the
+	 * graph, so a linear search is cheaper than a hash table
+	 * lookup.
+	 */
+	GArray *msg_iter_data;
+
 	bool frozen;
 };
 
+struct bt_stream_msg_iter_data {
+	/* Stream data key of the message iterator */
+	uint64_t key;
+
+	/* Not owned by this */
+	void *data;
+};
+
 BT_HIDDEN
 void _bt_stream_freeze(const struct bt_stream *stream);
 
@@ -60,4 +79,36 @@ struct bt_trace *bt_stream_borrow_trace_inline(const struct bt_stream *stream)
 	return (void *) bt_object_borrow_parent(&stream->base);
 }
 
+static inline
+void *bt_stream_get_msg_iter_data(const struct bt_stream *stream,
+		uint64_t key)
+{
+	void *data = NULL;
+	guint i;
+
+	BT_ASSERT_DBG(stream);
+
+	if (!stream->msg_iter_data) {
+		goto end;
+	}
+
+	for (i = 0; i < stream->msg_iter_data->len; i++) {
+		struct bt_stream_msg_iter_data *entry =
+			&g_array_index(stream->msg_iter_data,
+				struct bt_stream_msg_iter_data, i);
+
+		if (entry->key == key) {
+			data = entry->data;
+			goto end;
+		}
+	}
+
+end:
+	return data;
+}
+
+BT_HIDDEN
+void bt_stream_set_msg_iter_data(struct bt_stream *stream, uint64_t key,
+		void *data);
+
 #endif /* BABELTRACE_TRACE_IR_STREAM_INTERNAL_H */
@@ -112,6 +112,11 @@ void destroy_trace_class(struct bt_object *obj)
 		}
 	}
 
+	if (tc->stream_classes_by_id) {
+		g_hash_table_destroy(tc->stream_classes_by_id);
+		tc->stream_classes_by_id = NULL;
+	}
+
 	if (tc->stream_classes) {
 		BT_LOGD_STR("Destroying stream classes.");
 		g_ptr_array_free(tc->stream_classes, TRUE);
@@ -135,6 +140,7 @@ struct bt_trace_class *bt_trace_class_create(bt_self_component *self_comp)
 	}
 
 	bt_object_init_shared_with_parent(&tc->base, destroy_trace_class);
+	bt_object_set_ref_count_is_atomic(&tc->base);
 	tc->user_attributes = bt_value_map_create();
 	if (!tc->user_attributes) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -149,6 +155,13 @@ struct bt_trace_class *bt_trace_class_create(bt_self_component *self_comp)
 		goto error;
 	}
 
+	tc->stream_classes_by_id = g_hash_table_new(g_int64_hash,
+		g_int64_equal);
+	if (!tc->stream_classes_by_id) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one GHashTable.");
+		goto error;
+	}
+
 	tc->destruction_listeners = g_array_new(FALSE, TRUE,
 		sizeof(struct bt_trace_class_destruction_listener_elem));
 	if (!tc->destruction_listeners) {
@@ -268,23 +281,8 @@ bt_trace_class_borrow_stream_class_by_index_const(
 struct bt_stream_class *bt_trace_class_borrow_stream_class_by_id(
 		struct bt_trace_class *tc, uint64_t id)
 {
-	struct bt_stream_class *stream_class = NULL;
-	uint64_t i;
-
 	BT_ASSERT_PRE_DEV_TC_NON_NULL(tc);
-
-	for (i = 0; i < tc->stream_classes->len; i++) {
-		struct bt_stream_class *stream_class_candidate =
-			g_ptr_array_index(tc->stream_classes, i);
-
-		if (stream_class_candidate->id == id) {
-			stream_class = stream_class_candidate;
-			goto end;
-		}
-	}
-
-end:
-	return stream_class;
+	return g_hash_table_lookup(tc->stream_classes_by_id, &id);
 }
 
 const struct bt_stream_class *
@@ -34,6 +34,13 @@ struct bt_trace_class {
 	/* Array of `struct bt_stream_class *` */
 	GPtrArray *stream_classes;
 
+	/*
+	 * Stream class ID (`uint64_t *`, weak, points to the `id` member
+	 * of the stream class) -> `struct bt_stream_class *` (weak),
+	 * to look up a stream class by ID in constant time.
+	 */
+	GHashTable *stream_classes_by_id;
+
 	bool assigns_automatic_stream_class_id;
 	GArray *destruction_listeners;
 	bool frozen;
@@ -126,6 +126,11 @@ void destroy_trace(struct bt_object *obj)
 		trace->environment = NULL;
 	}
 
+	if (trace->streams_by_id) {
+		g_hash_table_destroy(trace->streams_by_id);
+		trace->streams_by_id = NULL;
+	}
+
 	if (trace->streams) {
 		BT_LOGD_STR("Destroying streams.");
 		g_ptr_array_free(trace->streams, TRUE);
@@ -157,6 +162,7 @@ struct bt_trace *bt_trace_create(struct bt_trace_class *tc)
 	}
 
 	bt_object_init_shared(&trace->base, destroy_trace);
+	bt_object_set_ref_count_is_atomic(&trace->base);
 	trace->user_attributes = bt_value_map_create();
 	if (!trace->user_attributes) {
 		BT_LIB_LOGE_APPEND_CAUSE(
@@ -171,6 +177,12 @@ struct bt_trace *bt_trace_create(struct bt_trace_class *tc)
 		goto error;
 	}
 
+	trace->streams_by_id = g_hash_table_new(g_int64_hash, g_int64_equal);
+	if (!trace->streams_by_id) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one GHashTable.");
+		goto error;
+	}
+
 	trace->stream_classes_stream_count = g_hash_table_new(g_direct_hash,
 		g_direct_equal);
 	if (!trace->stream_classes_stream_count) {
@@ -393,23 +405,8 @@ const struct bt_stream *bt_trace_borrow_stream_by_index_const(
 struct bt_stream *bt_trace_borrow_stream_by_id(struct bt_trace *trace,
 		uint64_t id)
 {
-	struct bt_stream *stream = NULL;
-	uint64_t i;
-
 	BT_ASSERT_PRE_DEV_TRACE_NON_NULL(trace);
-
-	for (i = 0; i < trace->streams->len; i++) {
-		struct bt_stream *stream_candidate =
-			g_ptr_array_index(trace->streams, i);
-
-		if (stream_candidate->id == id) {
-			stream = stream_candidate;
-			goto end;
-		}
-	}
-
-end:
-	return stream;
+	return g_hash_table_lookup(trace->streams_by_id, &id);
 }
 
 const struct bt_stream *bt_trace_borrow_stream_by_id_const(
@@ -516,6 +513,11 @@ void bt_trace_add_stream(struct bt_trace *trace, struct bt_stream *stream)
 	g_ptr_array_add(trace->streams, stream);
 	bt_trace_freeze(trace);
 
+	/* Keep the first stream having this ID */
+	if (!g_hash_table_lookup(trace->streams_by_id, &stream->id)) {
+		g_hash_table_insert(trace->streams_by_id, &stream->id, stream);
+	}
+
 	if (bt_g_hash_table_contains(trace->stream_classes_stream_count,
 			stream->class)) {
 		count = GPOINTER_TO_UINT(g_hash_table_lookup(
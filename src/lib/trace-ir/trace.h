@@ -55,6 +55,16 @@ struct bt_trace {
 	/* Array of `struct bt_stream *` */
 	GPtrArray *streams;
 
+	/*
+	 * Stream ID (`uint64_t *`, weak, points to the `id` member of
+	 * the stream) -> `struct bt_stream *` (weak).
+	 *
+	 * Stream IDs are only unique per stream class: for a given ID,
+	 * this maps to the first stream (in `streams` order) having
+	 * this ID.
+	 */
+	GHashTable *streams_by_id;
+
 	/*
 	 * Stream class (weak, owned by owned trace class) to number of
 	 * instantiated streams, used to automatically assign stream IDs
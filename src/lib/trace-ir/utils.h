@@ -19,13 +19,70 @@ struct search_query {
 	int found;
 };
 
+/*
+ * Converts `value_cycles` to nanoseconds for a clock of which the
+ * frequency is 2^`shift` Hz, `shift` being at most
+ * `BT_UTIL_NS_FROM_VALUE_MAX_SHIFT`.
+ *
+ * Returns `UINT64_C(-1)` if the result overflows `uint64_t`.
+ */
+#define BT_UTIL_NS_FROM_VALUE_MAX_SHIFT	34
+
+static inline
+uint64_t bt_util_ns_from_value_shift(unsigned int shift, uint64_t value_cycles)
+{
+	uint64_t value_s = value_cycles >> shift;
+	uint64_t rem_cycles = value_cycles & ((UINT64_C(1) << shift) - 1);
+
+	BT_ASSERT_DBG(shift <= BT_UTIL_NS_FROM_VALUE_MAX_SHIFT);
+
+	if (value_s > (UINT64_MAX - UINT64_C(999999999)) /
+			UINT64_C(1000000000)) {
+		/* Overflows uint64_t */
+		return UINT64_C(-1);
+	}
+
+	/*
+	 * `rem_cycles` is less than 2^`shift`: multiplying it by 10^9
+	 * cannot overflow with `shift` <= 34.
+	 */
+	return value_s * UINT64_C(1000000000) +
+		((rem_cycles * UINT64_C(1000000000)) >> shift);
+}
+
+/*
+ * Returns the shift to use with bt_util_ns_from_value_shift() for the
+ * frequency `frequency`, or -1 if `frequency` is not a power of two
+ * small enough.
+ */
+static inline
+int bt_util_frequency_shift(uint64_t frequency)
+{
+	int shift = 0;
+
+	if (frequency == 0 || (frequency & (frequency - 1)) != 0) {
+		return -1;
+	}
+
+	while (frequency > 1) {
+		frequency >>= 1;
+		shift++;
+	}
+
+	return shift <= BT_UTIL_NS_FROM_VALUE_MAX_SHIFT ? shift : -1;
+}
+
 static inline
 uint64_t bt_util_ns_from_value(uint64_t frequency, uint64_t value_cycles)
 {
 	uint64_t ns;
+	int shift;
 
 	if (frequency == UINT64_C(1000000000)) {
 		ns = value_cycles;
+	} else if ((shift = bt_util_frequency_shift(frequency)) >= 0) {
+		ns = bt_util_ns_from_value_shift((unsigned int) shift,
+			value_cycles);
 	} else {
 		double dblres = ((1e9 * (double) value_cycles) / (double) frequency);
 
@@ -77,20 +134,23 @@ end:
 	return overflows;
 }
 
+/*
+ * Sets `*ns_from_origin` to `base_offset_ns` plus `value_ns_unsigned`
+ * (result of bt_util_ns_from_value()).
+ *
+ * Returns -1 if the result overflows `int64_t`.
+ */
 static inline
-int bt_util_ns_from_origin_inline(int64_t base_offset_ns,
-		int64_t offset_seconds, uint64_t offset_cycles,
-		uint64_t frequency, uint64_t value, int64_t *ns_from_origin)
+int bt_util_ns_from_origin_add_value_ns(int64_t base_offset_ns,
+		uint64_t value_ns_unsigned, int64_t *ns_from_origin)
 {
 	int ret = 0;
-	uint64_t value_ns_unsigned;
 	int64_t value_ns_signed;
 
 	/* Initialize to clock class's base offset */
 	*ns_from_origin = base_offset_ns;
 
-	/* Add given value in cycles */
-	value_ns_unsigned = bt_util_ns_from_value(frequency, value);
+	/* Add given value */
 	if (value_ns_unsigned >= (uint64_t) INT64_MAX) {
 		/*
 		 * FIXME: `value_ns_unsigned` could be greater than
@@ -123,20 +183,44 @@ end:
 	return ret;
 }
 
+static inline
+int bt_util_ns_from_origin_inline(int64_t base_offset_ns,
+		int64_t offset_seconds, uint64_t offset_cycles,
+		uint64_t frequency, uint64_t value, int64_t *ns_from_origin)
+{
+	return bt_util_ns_from_origin_add_value_ns(base_offset_ns,
+		bt_util_ns_from_value(frequency, value), ns_from_origin);
+}
+
 static inline
 int bt_util_ns_from_origin_clock_class(const struct bt_clock_class *clock_class,
 		uint64_t value, int64_t *ns_from_origin)
 {
 	int ret = 0;
+	uint64_t value_ns;
 
 	if (clock_class->base_offset.overflows) {
 		ret = -1;
 		goto end;
 	}
 
-	ret = bt_util_ns_from_origin_inline(clock_class->base_offset.value_ns,
-		clock_class->offset_seconds, clock_class->offset_cycles,
-		clock_class->frequency, value, ns_from_origin);
+	/* Converter which bt_clock_class_set_frequency() chose */
+	switch (clock_class->cycles_to_ns.method) {
+	case BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_IDENTITY:
+		value_ns = value;
+		break;
+	case BT_CLOCK_CLASS_CYCLES_TO_NS_METHOD_SHIFT:
+		value_ns = bt_util_ns_from_value_shift(
+			clock_class->cycles_to_ns.shift, value);
+		break;
+	default:
+		value_ns = bt_util_ns_from_value(clock_class->frequency,
+			value);
+		break;
+	}
+
+	ret = bt_util_ns_from_origin_add_value_ns(
+		clock_class->base_offset.value_ns, value_ns, ns_from_origin);
 
 end:
 	return ret;
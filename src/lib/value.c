@@ -47,6 +47,8 @@ struct bt_value bt_value_null_instance = {
 	.base = {
 		.is_shared = true,
 		.ref_count = 1,
+		/* Any thread can get and put the singleton */
+		.ref_count_is_atomic = true,
 		.release_func = bt_value_null_instance_release_func,
 		.spec_release_func = NULL,
 		.parent_is_owner_listener_func = NULL,
@@ -219,7 +221,7 @@ struct bt_value *bt_value_map_copy(const struct bt_value *map_obj)
 	g_hash_table_iter_init(&iter, typed_map_obj->ght);
 
 	while (g_hash_table_iter_next(&iter, &key, &element_obj)) {
-		const char *key_str = g_quark_to_string(GPOINTER_TO_UINT(key));
+		const char *key_str = key;
 
 		BT_ASSERT(key_str);
 		BT_LOGD("Copying map value's element: element-addr=%p, "
@@ -417,7 +419,7 @@ bt_bool bt_value_map_is_equal(const struct bt_value *object_a,
 
 	while (g_hash_table_iter_next(&iter, &key, &element_obj_a)) {
 		const struct bt_value *element_obj_b;
-		const char *key_str = g_quark_to_string(GPOINTER_TO_UINT(key));
+		const char *key_str = key;
 
 		element_obj_b = bt_value_map_borrow_entry_value_const(object_b,
 			key_str);
@@ -763,8 +765,8 @@ struct bt_value *bt_value_map_create(void)
 	}
 
 	map_obj->base = bt_value_create_base(BT_VALUE_TYPE_MAP);
-	map_obj->ght = g_hash_table_new_full(g_direct_hash, g_direct_equal,
-		NULL, (GDestroyNotify) bt_object_put_ref);
+	map_obj->ght = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify) bt_object_put_ref);
 	if (!map_obj->ght) {
 		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GHashTable.");
 		g_free(map_obj);
@@ -1092,8 +1094,7 @@ struct bt_value *bt_value_map_borrow_entry_value(struct bt_value *map_obj,
 	BT_ASSERT_PRE_DEV_VALUE_NON_NULL(map_obj);
 	BT_ASSERT_PRE_DEV_KEY_NON_NULL(key);
 	BT_ASSERT_PRE_DEV_VALUE_IS_MAP(map_obj);
-	return g_hash_table_lookup(BT_VALUE_TO_MAP(map_obj)->ght,
-		GUINT_TO_POINTER(g_quark_from_string(key)));
+	return g_hash_table_lookup(BT_VALUE_TO_MAP(map_obj)->ght, key);
 }
 
 const struct bt_value *bt_value_map_borrow_entry_value_const(
@@ -1107,8 +1108,7 @@ bt_bool bt_value_map_has_entry(const struct bt_value *map_obj, const char *key)
 	BT_ASSERT_PRE_DEV_VALUE_NON_NULL(map_obj);
 	BT_ASSERT_PRE_DEV_KEY_NON_NULL(key);
 	BT_ASSERT_PRE_DEV_VALUE_IS_MAP(map_obj);
-	return bt_g_hash_table_contains(BT_VALUE_TO_MAP(map_obj)->ght,
-		GUINT_TO_POINTER(g_quark_from_string(key)));
+	return bt_g_hash_table_contains(BT_VALUE_TO_MAP(map_obj)->ght, key);
 }
 
 static
@@ -1125,8 +1125,8 @@ enum bt_value_map_insert_entry_status insert_map_value_entry(
 	BT_ASSERT_PRE_VALUE_HAS_TYPE_FROM_FUNC(api_func, "value-object",
 		map_obj, "map", BT_VALUE_TYPE_MAP);
 	BT_ASSERT_PRE_DEV_VALUE_HOT_FROM_FUNC(api_func, map_obj);
-	g_hash_table_insert(BT_VALUE_TO_MAP(map_obj)->ght,
-		GUINT_TO_POINTER(g_quark_from_string(key)), element_obj);
+	g_hash_table_insert(BT_VALUE_TO_MAP(map_obj)->ght, g_strdup(key),
+		element_obj);
 	bt_object_get_ref(element_obj);
 	BT_LOGT("Inserted value into map value: map-value-addr=%p, "
 		"key=\"%s\", element-value-addr=%p",
@@ -1282,7 +1282,7 @@ enum bt_value_map_foreach_entry_status foreach_map_entry(
 	g_hash_table_iter_init(&iter, typed_map_obj->ght);
 
 	while (g_hash_table_iter_next(&iter, &key, &element_obj)) {
-		const char *key_str = g_quark_to_string(GPOINTER_TO_UINT(key));
+		const char *key_str = key;
 
 		status = func(key_str, element_obj, data);
 		BT_ASSERT_POST_NO_ERROR_IF_NO_ERROR_STATUS(user_func_name,
@@ -1472,6 +1472,83 @@ end:
 	return ret;
 }
 
+static inline
+guint hash_uint64(uint64_t v)
+{
+	return (guint) (v ^ (v >> 32));
+}
+
+BT_HIDDEN
+guint bt_value_hash(const struct bt_value *value)
+{
+	guint hash;
+
+	BT_ASSERT(value);
+	hash = (guint) value->type * 31;
+
+	switch (value->type) {
+	case BT_VALUE_TYPE_NULL:
+		break;
+	case BT_VALUE_TYPE_BOOL:
+		hash = hash * 31 + (BT_VALUE_TO_BOOL(value)->value ? 1 : 0);
+		break;
+	case BT_VALUE_TYPE_UNSIGNED_INTEGER:
+	case BT_VALUE_TYPE_SIGNED_INTEGER:
+		hash = hash * 31 +
+			hash_uint64(BT_VALUE_TO_INTEGER(value)->value.i);
+		break;
+	case BT_VALUE_TYPE_REAL:
+	{
+		double real = BT_VALUE_TO_REAL(value)->value;
+		uint64_t bits = 0;
+
+		/* -0.0 is equal to 0.0 */
+		if (real != 0) {
+			memcpy(&bits, &real, sizeof(bits));
+		}
+
+		hash = hash * 31 + hash_uint64(bits);
+		break;
+	}
+	case BT_VALUE_TYPE_STRING:
+		hash = hash * 31 + g_string_hash(BT_VALUE_TO_STRING(value)->gstr);
+		break;
+	case BT_VALUE_TYPE_ARRAY:
+	{
+		const GPtrArray *garray = BT_VALUE_TO_ARRAY(value)->garray;
+		guint i;
+
+		for (i = 0; i < garray->len; i++) {
+			hash = hash * 31 +
+				bt_value_hash(g_ptr_array_index(garray, i));
+		}
+
+		break;
+	}
+	case BT_VALUE_TYPE_MAP:
+	{
+		GHashTableIter iter;
+		gpointer key, element_obj;
+		guint entries_hash = 0;
+
+		/* Independent of the iteration order */
+		g_hash_table_iter_init(&iter, BT_VALUE_TO_MAP(value)->ght);
+
+		while (g_hash_table_iter_next(&iter, &key, &element_obj)) {
+			entries_hash += g_str_hash(key) * 31 +
+				bt_value_hash(element_obj);
+		}
+
+		hash = hash * 31 + entries_hash;
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+	return hash;
+}
+
 void bt_value_get_ref(const struct bt_value *value)
 {
 	bt_object_get_ref(value);
@@ -49,12 +49,28 @@ struct bt_value_array {
 
 struct bt_value_map {
 	struct bt_value base;
+
+	/*
+	 * `char *` (owned by this) to `struct bt_value *` (owned by
+	 * this).
+	 *
+	 * The keys are strings rather than `GQuark` values to avoid
+	 * GLib's global quark table, which is protected by a global mutex
+	 * and never frees its strings.
+	 */
 	GHashTable *ght;
 };
 
 BT_HIDDEN
 void _bt_value_freeze(const struct bt_value *object);
 
+/*
+ * Returns a hash of `value` which is consistent with
+ * bt_value_is_equal(): equal values have the same hash.
+ */
+BT_HIDDEN
+guint bt_value_hash(const struct bt_value *value);
+
 #ifdef BT_DEV_MODE
 # define bt_value_freeze	_bt_value_freeze
 #else
@@ -95,6 +95,14 @@
 	BT_COMP_LOG(BT_LOG_DEBUG, (BT_COMP_LOG_SELF_COMP), "%s", (_str))
 #define BT_COMP_LOGT_STR(_str) \
 	BT_COMP_LOG(BT_LOG_TRACE, (BT_COMP_LOG_SELF_COMP), "%s", (_str))
+#define BT_COMP_LOGD_FP(_fmt, ...) \
+	BT_LOG_FAST_PATH(BT_LOG_DEBUG, BT_COMP_LOGD(_fmt, ##__VA_ARGS__))
+#define BT_COMP_LOGT_FP(_fmt, ...) \
+	BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_COMP_LOGT(_fmt, ##__VA_ARGS__))
+#define BT_COMP_LOGD_STR_FP(_str) \
+	BT_LOG_FAST_PATH(BT_LOG_DEBUG, BT_COMP_LOGD_STR(_str))
+#define BT_COMP_LOGT_STR_FP(_str) \
+	BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_COMP_LOGT_STR(_str))
 #define BT_COMP_LOGF_ERRNO(_msg, _fmt, ...) \
 	BT_COMP_LOG_ERRNO(BT_LOG_FATAL, (BT_COMP_LOG_SELF_COMP), _msg, _fmt, ##__VA_ARGS__)
 #define BT_COMP_LOGE_ERRNO(_msg, _fmt, ...) \
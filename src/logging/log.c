@@ -298,6 +298,8 @@ extern unsigned long pthread_getsequence_np(pthread_t *);
 #include <time.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -643,6 +645,10 @@ static INSTRUMENTED_CONST buffer_cb g_buffer_cb = buffer_callback;
 	#define OUT_DEBUGSTRING OUT_DEBUGSTRING_MASK, 0, out_debugstring_callback
 #endif
 
+#if !defined(_WIN32) && !defined(_WIN64)
+static int async_output_put(const char *buf, size_t len);
+#endif
+
 BT_HIDDEN
 void bt_log_out_stderr_callback(const bt_log_message *const msg, void *arg)
 {
@@ -655,6 +661,13 @@ void bt_log_out_stderr_callback(const bt_log_message *const msg, void *arg)
 	WriteFile(GetStdHandle(STD_ERROR_HANDLE), msg->buf,
 			  (DWORD)(msg->p - msg->buf + eol_len), 0, 0);
 #else
+	/* Fatal messages are written immediately: the process is about to abort. */
+	if (msg->lvl < BT_LOG_FATAL &&
+			async_output_put(msg->buf, (size_t)(msg->p - msg->buf) + eol_len))
+	{
+		return;
+	}
+
 	/* write() is atomic for buffers less than or equal to PIPE_BUF. */
 	RETVAL_UNUSED(write(STDERR_FILENO, msg->buf,
 						(size_t)(msg->p - msg->buf) + eol_len));
@@ -740,6 +753,307 @@ static char lvl_char(const int lvl)
 		__sync_bool_compare_and_swap(vp, *(ep), d)
 #endif
 
+#if !defined(_WIN32) && !defined(_WIN64)
+/*
+ * Asynchronous output to the standard error stream, enabled when the
+ * `BABELTRACE_LOG_ASYNC` environment variable is `1`.
+ *
+ * Each logging thread copies its formatted messages to its own ring
+ * buffer, without any lock, and a writer thread writes the content of
+ * all the rings to the standard error stream. A thread drops a message
+ * instead of waiting when its ring is full, and the writer thread
+ * reports how many messages were dropped. The messages of a given
+ * thread keep their order, but the messages of different threads can
+ * appear out of order.
+ *
+ * The writer thread writes the remaining messages when the module
+ * containing this logging code is unloaded, including when the process
+ * exits normally.
+ */
+
+/* Size (bytes) of the ring of each logging thread (power of two) */
+#define ASYNC_RING_SIZE (1 << 20)
+
+/* Time (ns) during which the writer thread sleeps when all rings are empty */
+#define ASYNC_WRITER_IDLE_NS (10 * 1000 * 1000)
+
+struct async_ring
+{
+	/* Total number of bytes put, only written by the logging thread */
+	uint64_t head;
+	/* Total number of bytes written, only written by the writer thread */
+	uint64_t tail;
+	/* Number of dropped messages, only written by the logging thread */
+	uint64_t dropped;
+	/* Number of dropped messages which the writer thread reported */
+	uint64_t reported_dropped;
+	/* Non-zero once the logging thread exited */
+	unsigned orphaned;
+	/* Next ring of `g_async_rings`, protected by `g_async_rings_lock` */
+	struct async_ring *next;
+	char data[ASYNC_RING_SIZE];
+};
+
+static pthread_once_t g_async_once = PTHREAD_ONCE_INIT;
+static int g_async_enabled;
+static unsigned g_async_stopping;
+static pthread_t g_async_writer;
+static pthread_key_t g_async_ring_key;
+static pthread_mutex_t g_async_rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct async_ring *g_async_rings;
+static __thread struct async_ring *g_async_thread_ring;
+
+static void async_write_all(const char *buf, size_t len)
+{
+	while (len > 0)
+	{
+		const ssize_t ret = write(STDERR_FILENO, buf, len);
+
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			/* Nothing else to do with this output */
+			break;
+		}
+
+		buf += ret;
+		len -= (size_t)ret;
+	}
+}
+
+/*
+ * Writes the content of `ring` and reports its new dropped messages.
+ * Only called by the writer thread.
+ *
+ * Returns the number of written bytes.
+ */
+static uint64_t async_ring_drain(struct async_ring *const ring)
+{
+	const uint64_t tail = ring->tail;
+	const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	const uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+	const uint64_t len = head - tail;
+
+	if (len > 0)
+	{
+		const uint64_t at = tail & (ASYNC_RING_SIZE - 1);
+		const uint64_t first_len = len < ASYNC_RING_SIZE - at ?
+			len : ASYNC_RING_SIZE - at;
+
+		async_write_all(&ring->data[at], (size_t)first_len);
+		async_write_all(&ring->data[0], (size_t)(len - first_len));
+		__atomic_fetch_add(&ring->tail, len, __ATOMIC_RELEASE);
+	}
+
+	if (dropped != ring->reported_dropped)
+	{
+		char buf[128];
+		const int n = snprintf(buf, sizeof(buf),
+			"[babeltrace2 logging] Dropped %" PRIu64
+			" log messages: logging thread is too fast" BT_LOG_EOL,
+			dropped - ring->reported_dropped);
+
+		if (n > 0)
+		{
+			async_write_all(buf, (size_t)n < sizeof(buf) ?
+				(size_t)n : sizeof(buf) - 1);
+		}
+
+		ring->reported_dropped = dropped;
+	}
+
+	return len;
+}
+
+/*
+ * Writes the content of all the rings, freeing the rings of exited
+ * logging threads.
+ *
+ * Returns the number of written bytes.
+ */
+static uint64_t async_drain_all(void)
+{
+	struct async_ring **ring_p;
+	uint64_t len = 0;
+
+	pthread_mutex_lock(&g_async_rings_lock);
+	ring_p = &g_async_rings;
+
+	while (*ring_p)
+	{
+		struct async_ring *const ring = *ring_p;
+		const unsigned orphaned =
+			__atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+
+		len += async_ring_drain(ring);
+
+		if (orphaned)
+		{
+			/* Nothing will be put anymore */
+			*ring_p = ring->next;
+			free(ring);
+		}
+		else
+		{
+			ring_p = &ring->next;
+		}
+	}
+
+	pthread_mutex_unlock(&g_async_rings_lock);
+	return len;
+}
+
+static void *async_writer_main(void *arg)
+{
+	VAR_UNUSED(arg);
+
+	while (!__atomic_load_n(&g_async_stopping, __ATOMIC_ACQUIRE))
+	{
+		if (async_drain_all() == 0)
+		{
+			const struct timespec ts = {0, ASYNC_WRITER_IDLE_NS};
+
+			nanosleep(&ts, NULL);
+		}
+	}
+
+	/* Final drain */
+	async_drain_all();
+	return NULL;
+}
+
+/* Called when a logging thread exits */
+static void async_ring_release(void *data)
+{
+	struct async_ring *const ring = data;
+
+	__atomic_fetch_add(&ring->orphaned, 1, __ATOMIC_RELEASE);
+}
+
+static void async_init(void)
+{
+	const char *const val = getenv("BABELTRACE_LOG_ASYNC");
+
+	if (!val || strcmp(val, "1") != 0)
+	{
+		return;
+	}
+
+	if (pthread_key_create(&g_async_ring_key, async_ring_release))
+	{
+		return;
+	}
+
+	if (pthread_create(&g_async_writer, NULL, async_writer_main, NULL))
+	{
+		pthread_key_delete(g_async_ring_key);
+		return;
+	}
+
+	g_async_enabled = 1;
+}
+
+static void __attribute__((destructor)) async_fini(void)
+{
+	if (!g_async_enabled)
+	{
+		return;
+	}
+
+	/* From now on, logging threads write synchronously */
+	__atomic_fetch_add(&g_async_stopping, 1, __ATOMIC_RELEASE);
+	pthread_join(g_async_writer, NULL);
+
+	/* This module's thread exit destructor could be unloaded */
+	pthread_key_delete(g_async_ring_key);
+	g_async_enabled = 0;
+}
+
+static struct async_ring *async_borrow_thread_ring(void)
+{
+	struct async_ring *ring = g_async_thread_ring;
+
+	if (ring)
+	{
+		return ring;
+	}
+
+	ring = malloc(sizeof(*ring));
+	if (!ring)
+	{
+		return NULL;
+	}
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->dropped = 0;
+	ring->reported_dropped = 0;
+	ring->orphaned = 0;
+
+	if (pthread_setspecific(g_async_ring_key, ring))
+	{
+		free(ring);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_async_rings_lock);
+	ring->next = g_async_rings;
+	g_async_rings = ring;
+	pthread_mutex_unlock(&g_async_rings_lock);
+	g_async_thread_ring = ring;
+	return ring;
+}
+
+/*
+ * Puts the formatted message `buf` of `len` bytes into the current
+ * thread's ring, or drops it if the ring is full.
+ *
+ * Returns 0 if the caller must write the message itself (asynchronous
+ * output disabled or stopped, or out of memory).
+ */
+static int async_output_put(const char *const buf, const size_t len)
+{
+	struct async_ring *ring;
+	uint64_t head, tail, at, first_len;
+
+	pthread_once(&g_async_once, async_init);
+
+	if (!g_async_enabled ||
+			__atomic_load_n(&g_async_stopping, __ATOMIC_ACQUIRE))
+	{
+		return 0;
+	}
+
+	ring = async_borrow_thread_ring();
+	if (!ring)
+	{
+		return 0;
+	}
+
+	head = ring->head;
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (len > ASYNC_RING_SIZE - (head - tail))
+	{
+		__atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+		return 1;
+	}
+
+	at = head & (ASYNC_RING_SIZE - 1);
+	first_len = len < ASYNC_RING_SIZE - at ? len : ASYNC_RING_SIZE - at;
+	memcpy(&ring->data[at], buf, (size_t)first_len);
+	memcpy(&ring->data[0], buf + first_len, len - (size_t)first_len);
+
+	/* Publish the message to the writer thread */
+	__atomic_fetch_add(&ring->head, len, __ATOMIC_RELEASE);
+	return 1;
+}
+#endif
+
 #if !BT_LOG_OPTIMIZE_SIZE && !defined(_WIN32) && !defined(_WIN64)
 #define TCACHE
 #define TCACHE_STALE (0x40000000)
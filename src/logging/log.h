@@ -108,6 +108,23 @@
 	#endif
 #endif
 
+/* "Fast path" log level is the minimal log level of the log statements
+ * which are in hot paths (for example, once per message or per field).
+ * Those statements use the BT_LOGT_FP() and BT_LOGD_FP() family of
+ * macros, and they're compiled out when their level is below:
+ *
+ * - BT_MINIMAL_FAST_PATH_LOG_LEVEL, if it's defined.
+ * - The minimal log level (see BT_MINIMAL_LOG_LEVEL) otherwise.
+ *
+ * A fast path log level which is below the minimal log level has no
+ * effect.
+ */
+#if defined(BT_MINIMAL_FAST_PATH_LOG_LEVEL)
+	#define _BT_MINIMAL_FAST_PATH_LOG_LEVEL BT_MINIMAL_FAST_PATH_LOG_LEVEL
+#else
+	#define _BT_MINIMAL_FAST_PATH_LOG_LEVEL _BT_MINIMAL_LOG_LEVEL
+#endif
+
 /* "Output" log level is a runtime check. When log level is below output log
  * level it said to be "turned off" (or just "off" for short). Otherwise
  * it's "turned on" (or just "on"). Log levels that were "disabled" (see
@@ -607,6 +624,16 @@ bt_log_spec;
  */
 #define BT_LOG_SECRET(f) BT_LOG_IF(BT_LOG_SECRETS, f)
 
+/* Mark log statement as being in a fast path. Log statements that are
+ * marked as such are compiled out when their level is below the fast
+ * path log level (see _BT_MINIMAL_FAST_PATH_LOG_LEVEL). Example:
+ *
+ *   BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_LOGT("Decoding field: index=%u", i));
+ *
+ * Prefer the BT_LOGT_FP() and BT_LOGD_FP() shorthands.
+ */
+#define BT_LOG_FAST_PATH(lvl, f) BT_LOG_IF(BT_LOG_FAST_PATH_ENABLED(lvl), f)
+
 /* Check "current" log level at compile time (ignoring "output" log level).
  * Evaluates to true when specified log level is enabled. For example:
  *
@@ -630,6 +657,12 @@ bt_log_spec;
 #define BT_LOG_ENABLED_ERROR    BT_LOG_ENABLED(BT_LOG_ERROR)
 #define BT_LOG_ENABLED_FATAL    BT_LOG_ENABLED(BT_LOG_FATAL)
 
+/* Check whether a fast path log level is enabled at compile time. See
+ * _BT_MINIMAL_FAST_PATH_LOG_LEVEL.
+ */
+#define BT_LOG_FAST_PATH_ENABLED(lvl) \
+		(BT_LOG_ENABLED((lvl)) && (lvl) >= _BT_MINIMAL_FAST_PATH_LOG_LEVEL)
+
 /* Check "output" log level at run time (taking into account "current" log
  * level as well). Evaluates to true when specified log level is turned on AND
  * enabled. For example:
@@ -973,6 +1006,11 @@ static _BT_LOG_INLINE void _bt_log_unused(const int dummy, ...) {(void)dummy;}
 
 #define BT_LOGT_STR(s) BT_LOGT("%s", (s))
 #define BT_LOGD_STR(s) BT_LOGD("%s", (s))
+
+#define BT_LOGT_FP(...) BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_LOGT(__VA_ARGS__))
+#define BT_LOGD_FP(...) BT_LOG_FAST_PATH(BT_LOG_DEBUG, BT_LOGD(__VA_ARGS__))
+#define BT_LOGT_STR_FP(s) BT_LOG_FAST_PATH(BT_LOG_TRACE, BT_LOGT_STR(s))
+#define BT_LOGD_STR_FP(s) BT_LOG_FAST_PATH(BT_LOG_DEBUG, BT_LOGD_STR(s))
 #define BT_LOGI_STR(s) BT_LOGI("%s", (s))
 #define BT_LOGW_STR(s) BT_LOGW("%s", (s))
 #define BT_LOGE_STR(s) BT_LOGE("%s", (s))
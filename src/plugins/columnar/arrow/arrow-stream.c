@@ -0,0 +1,856 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (stream->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (stream->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.COLUMNAR.ARROW/STREAM"
+#include "logging/comp-logging.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+
+#include "arrow-stream.h"
+#include "flatbuf.h"
+
+/*
+ * Arrow metadata version 5 (`MetadataVersion::V5` in `Schema.fbs`)
+ */
+#define METADATA_VERSION_V5		4
+
+/* `MessageHeader` union types (`Message.fbs`) */
+#define MESSAGE_HEADER_SCHEMA		1
+#define MESSAGE_HEADER_DICTIONARY_BATCH	2
+#define MESSAGE_HEADER_RECORD_BATCH	3
+
+/* `Type` union types (`Schema.fbs`) */
+#define TYPE_INT			2
+#define TYPE_FLOATING_POINT		3
+#define TYPE_UTF8			5
+#define TYPE_BOOL			6
+#define TYPE_TIMESTAMP			10
+
+/* `Precision` enumeration (`Schema.fbs`) */
+#define PRECISION_SINGLE		1
+#define PRECISION_DOUBLE		2
+
+/* `TimeUnit` enumeration (`Schema.fbs`) */
+#define TIME_UNIT_NANOSECOND		3
+
+/* Prefix of each encapsulated message */
+#define CONTINUATION_MARKER		UINT32_C(0xffffffff)
+
+/* Alignment of the metadata and of each body buffer */
+#define ALIGNMENT			8
+
+/*
+ * Maximum number of entries of a dictionary: once a dictionary reaches
+ * this size, the next record batch replaces it (the IPC streaming
+ * format allows it) instead of extending it, so that the memory of a
+ * column with many distinct strings remains bounded.
+ */
+#define MAX_DICTIONARY_ENTRIES		(1U << 16)
+
+struct arrow_dictionary {
+	/* Unique within the stream */
+	int64_t id;
+
+	/* `char *` (owned by this) to index + 1 */
+	GHashTable *indexes;
+
+	/* Number of entries */
+	uint32_t count;
+
+	/* Number of entries which are already written */
+	uint32_t written_count;
+
+	/*
+	 * 32-bit offsets of the entries which are not written yet within
+	 * `new_data`, starting with 0
+	 */
+	GArray *new_offsets;
+
+	/* UTF-8 data of the entries which are not written yet */
+	GByteArray *new_data;
+
+	/*
+	 * True if the next dictionary batch must replace the dictionary
+	 * instead of extending it (always the case for the first one)
+	 */
+	bool replace;
+};
+
+struct arrow_column {
+	GString *name;
+	enum arrow_column_type type;
+	unsigned int bit_width;
+	bool is_signed;
+	bool is_nullable;
+
+	/* Validity bitmap of the buffered rows */
+	GByteArray *validity;
+	uint64_t null_count;
+
+	/*
+	 * Values of the buffered rows (bitmap for a boolean column,
+	 * 32-bit indexes for a dictionary-encoded string column)
+	 */
+	GByteArray *values;
+
+	/* Number of values (including nulls) */
+	uint64_t length;
+
+	/* Dictionary-encoded string column only */
+	struct arrow_dictionary dict;
+};
+
+struct arrow_stream {
+	bt_logging_level log_level;
+
+	/* Weak */
+	bt_self_component *self_comp;
+
+	GString *path;
+	FILE *fp;
+
+	/* Array of `struct arrow_column *` (owned by this) */
+	GPtrArray *columns;
+
+	/* Number of buffered rows */
+	uint64_t row_count;
+
+	bool schema_is_written;
+
+	/* Next dictionary ID */
+	int64_t next_dict_id;
+
+	/* True if writing the file failed */
+	bool failed;
+
+	/* Reused for each message */
+	struct flatbuf_builder fb;
+	GByteArray *body;
+
+	/* Pairs of 64-bit integers (`FieldNode` and `Buffer` structures) */
+	GArray *nodes;
+	GArray *buffers;
+};
+
+static
+void destroy_column(struct arrow_column *column)
+{
+	if (!column) {
+		return;
+	}
+
+	if (column->name) {
+		g_string_free(column->name, TRUE);
+	}
+
+	if (column->validity) {
+		g_byte_array_free(column->validity, TRUE);
+	}
+
+	if (column->values) {
+		g_byte_array_free(column->values, TRUE);
+	}
+
+	if (column->dict.indexes) {
+		g_hash_table_destroy(column->dict.indexes);
+	}
+
+	if (column->dict.new_offsets) {
+		g_array_free(column->dict.new_offsets, TRUE);
+	}
+
+	if (column->dict.new_data) {
+		g_byte_array_free(column->dict.new_data, TRUE);
+	}
+
+	g_free(column);
+}
+
+static
+void reset_dict_new_entries(struct arrow_dictionary *dict)
+{
+	int32_t zero = 0;
+
+	g_array_set_size(dict->new_offsets, 0);
+	g_array_append_val(dict->new_offsets, zero);
+	g_byte_array_set_size(dict->new_data, 0);
+}
+
+BT_HIDDEN
+struct arrow_stream *arrow_stream_create(const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct arrow_stream *stream = g_new0(struct arrow_stream, 1);
+
+	if (!stream) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+			"Failed to allocate one Arrow stream.");
+		goto error;
+	}
+
+	stream->log_level = log_level;
+	stream->self_comp = self_comp;
+	stream->path = g_string_new(path);
+	stream->columns = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_column);
+	stream->body = g_byte_array_new();
+	stream->nodes = g_array_new(FALSE, FALSE, sizeof(int64_t));
+	stream->buffers = g_array_new(FALSE, FALSE, sizeof(int64_t));
+	flatbuf_builder_init(&stream->fb);
+	stream->fp = fopen(path, "wb");
+	if (!stream->fp) {
+		BT_COMP_LOGE_ERRNO("Cannot open Arrow stream file for writing",
+			": path=\"%s\"", path);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	(void) arrow_stream_destroy(stream);
+	stream = NULL;
+
+end:
+	return stream;
+}
+
+BT_HIDDEN
+struct arrow_column *arrow_stream_add_column(struct arrow_stream *stream,
+		const char *name, enum arrow_column_type type,
+		unsigned int bit_width, bool is_signed, bool is_nullable)
+{
+	struct arrow_column *column = g_new0(struct arrow_column, 1);
+
+	BT_ASSERT(stream->row_count == 0);
+	BT_ASSERT(!stream->schema_is_written);
+	BT_ASSERT(type != ARROW_COLUMN_TYPE_INT || bit_width == 8 ||
+		bit_width == 16 || bit_width == 32 || bit_width == 64);
+	BT_ASSERT(type != ARROW_COLUMN_TYPE_FLOAT || bit_width == 32 ||
+		bit_width == 64);
+	column->name = g_string_new(name);
+	column->type = type;
+	column->is_signed = is_signed;
+	column->is_nullable = is_nullable;
+	column->validity = g_byte_array_new();
+	column->values = g_byte_array_new();
+
+	switch (type) {
+	case ARROW_COLUMN_TYPE_BOOL:
+		column->bit_width = 1;
+		break;
+	case ARROW_COLUMN_TYPE_INT:
+	case ARROW_COLUMN_TYPE_FLOAT:
+		column->bit_width = bit_width;
+		break;
+	case ARROW_COLUMN_TYPE_TIMESTAMP:
+		column->bit_width = 64;
+		break;
+	case ARROW_COLUMN_TYPE_DICT_STRING:
+		column->bit_width = 32;
+		column->dict.id = stream->next_dict_id++;
+		column->dict.indexes = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, NULL);
+		column->dict.new_offsets = g_array_new(FALSE, FALSE,
+			sizeof(int32_t));
+		column->dict.new_data = g_byte_array_new();
+		column->dict.replace = true;
+		reset_dict_new_entries(&column->dict);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	g_ptr_array_add(stream->columns, column);
+	return column;
+}
+
+static inline
+void append_bit(GByteArray *bitmap, uint64_t index, bool value)
+{
+	if (index % 8 == 0) {
+		uint8_t zero = 0;
+
+		g_byte_array_append(bitmap, &zero, 1);
+	}
+
+	if (value) {
+		bitmap->data[index / 8] |= (uint8_t) (1U << (index % 8));
+	}
+}
+
+static inline
+void append_value(struct arrow_column *column, const void *le_value)
+{
+	append_bit(column->validity, column->length, true);
+	g_byte_array_append(column->values, le_value, column->bit_width / 8);
+	column->length++;
+}
+
+BT_HIDDEN
+void arrow_column_append_null(struct arrow_column *column)
+{
+	static const uint8_t zeros[8];
+
+	BT_ASSERT_DBG(column->is_nullable);
+	append_bit(column->validity, column->length, false);
+	column->null_count++;
+
+	if (column->type == ARROW_COLUMN_TYPE_BOOL) {
+		append_bit(column->values, column->length, false);
+	} else {
+		g_byte_array_append(column->values, zeros,
+			column->bit_width / 8);
+	}
+
+	column->length++;
+}
+
+BT_HIDDEN
+void arrow_column_append_bool(struct arrow_column *column, bool value)
+{
+	BT_ASSERT_DBG(column->type == ARROW_COLUMN_TYPE_BOOL);
+	append_bit(column->validity, column->length, true);
+	append_bit(column->values, column->length, value);
+	column->length++;
+}
+
+BT_HIDDEN
+void arrow_column_append_int(struct arrow_column *column, uint64_t value)
+{
+	BT_ASSERT_DBG(column->type == ARROW_COLUMN_TYPE_INT ||
+		column->type == ARROW_COLUMN_TYPE_TIMESTAMP);
+
+	/* Little-endian: the first bytes are the least significant ones */
+	value = GUINT64_TO_LE(value);
+	append_value(column, &value);
+}
+
+BT_HIDDEN
+void arrow_column_append_float(struct arrow_column *column, double value)
+{
+	BT_ASSERT_DBG(column->type == ARROW_COLUMN_TYPE_FLOAT);
+
+	if (column->bit_width == 32) {
+		float fvalue = (float) value;
+		uint32_t bits;
+
+		memcpy(&bits, &fvalue, sizeof(bits));
+		bits = GUINT32_TO_LE(bits);
+		append_value(column, &bits);
+	} else {
+		uint64_t bits;
+
+		memcpy(&bits, &value, sizeof(bits));
+		bits = GUINT64_TO_LE(bits);
+		append_value(column, &bits);
+	}
+}
+
+BT_HIDDEN
+void arrow_column_append_string(struct arrow_column *column,
+		const char *value)
+{
+	struct arrow_dictionary *dict = &column->dict;
+	gpointer index_p;
+	int32_t index;
+
+	BT_ASSERT_DBG(column->type == ARROW_COLUMN_TYPE_DICT_STRING);
+
+	if (G_LIKELY(g_hash_table_lookup_extended(dict->indexes, value, NULL,
+			&index_p))) {
+		index = (int32_t) (GPOINTER_TO_UINT(index_p) - 1);
+	} else {
+		size_t len = strlen(value);
+		int32_t offset;
+
+		index = (int32_t) dict->count;
+		dict->count++;
+		g_hash_table_insert(dict->indexes, g_strdup(value),
+			GUINT_TO_POINTER((guint) index + 1));
+		g_byte_array_append(dict->new_data, (const guint8 *) value,
+			len);
+		offset = GINT32_TO_LE((int32_t) dict->new_data->len);
+		g_array_append_val(dict->new_offsets, offset);
+	}
+
+	index = GINT32_TO_LE(index);
+	append_value(column, &index);
+}
+
+BT_HIDDEN
+uint64_t arrow_stream_end_row(struct arrow_stream *stream)
+{
+#ifdef BT_DEBUG_MODE
+	guint i;
+
+	for (i = 0; i < stream->columns->len; i++) {
+		struct arrow_column *column =
+			g_ptr_array_index(stream->columns, i);
+
+		BT_ASSERT_DBG(column->length == stream->row_count + 1);
+	}
+#endif
+
+	stream->row_count++;
+	return stream->row_count;
+}
+
+static
+int write_bytes(struct arrow_stream *stream, const void *data, size_t len)
+{
+	int ret = 0;
+
+	if (len == 0) {
+		goto end;
+	}
+
+	if (fwrite(data, len, 1, stream->fp) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write Arrow stream file",
+			": path=\"%s\", size=%zu", stream->path->str, len);
+		stream->failed = true;
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
+
+static inline
+size_t padding(size_t len)
+{
+	return (ALIGNMENT - (len % ALIGNMENT)) % ALIGNMENT;
+}
+
+/*
+ * Appends `len` bytes of `data` to the message body as a new buffer.
+ */
+static
+void append_body_buffer(struct arrow_stream *stream, const void *data,
+		size_t len)
+{
+	static const uint8_t zeros[ALIGNMENT];
+	int64_t offset = (int64_t) stream->body->len;
+	int64_t length = (int64_t) len;
+
+	if (len > 0) {
+		g_byte_array_append(stream->body, data, len);
+		g_byte_array_append(stream->body, zeros, padding(len));
+	}
+
+	g_array_append_val(stream->buffers, offset);
+	g_array_append_val(stream->buffers, length);
+}
+
+static
+void append_node(struct arrow_stream *stream, int64_t length,
+		int64_t null_count)
+{
+	g_array_append_val(stream->nodes, length);
+	g_array_append_val(stream->nodes, null_count);
+}
+
+static
+void reset_message(struct arrow_stream *stream)
+{
+	flatbuf_builder_reset(&stream->fb);
+	g_byte_array_set_size(stream->body, 0);
+	g_array_set_size(stream->nodes, 0);
+	g_array_set_size(stream->buffers, 0);
+}
+
+/*
+ * Writes the message having the header `header` of type `header_type`
+ * (built with `stream->fb`), followed with the body `stream->body`.
+ */
+static
+int write_message(struct arrow_stream *stream, uint8_t header_type,
+		flatbuf_ref header)
+{
+	static const uint8_t zeros[ALIGNMENT];
+	struct flatbuf_builder *fb = &stream->fb;
+	const uint8_t *metadata;
+	size_t metadata_size;
+	uint32_t prefix[2];
+	int ret;
+
+	flatbuf_start_table(fb);
+	flatbuf_add_i16(fb, 0, METADATA_VERSION_V5);
+	flatbuf_add_u8(fb, 1, header_type);
+	flatbuf_add_ref(fb, 2, header);
+	flatbuf_add_i64(fb, 3, (int64_t) stream->body->len);
+	flatbuf_finish(fb, flatbuf_end_table(fb), &metadata, &metadata_size);
+
+	/* The size includes the padding which aligns the body */
+	prefix[0] = GUINT32_TO_LE(CONTINUATION_MARKER);
+	prefix[1] = GUINT32_TO_LE(
+		(uint32_t) (metadata_size + padding(metadata_size)));
+	ret = write_bytes(stream, prefix, sizeof(prefix));
+	if (ret) {
+		goto end;
+	}
+
+	ret = write_bytes(stream, metadata, metadata_size);
+	if (ret) {
+		goto end;
+	}
+
+	ret = write_bytes(stream, zeros, padding(metadata_size));
+	if (ret) {
+		goto end;
+	}
+
+	ret = write_bytes(stream, stream->body->data, stream->body->len);
+
+end:
+	return ret;
+}
+
+static
+flatbuf_ref build_int_type(struct flatbuf_builder *fb, int32_t bit_width,
+		bool is_signed)
+{
+	flatbuf_start_table(fb);
+	flatbuf_add_i32(fb, 0, bit_width);
+	flatbuf_add_bool(fb, 1, is_signed);
+	return flatbuf_end_table(fb);
+}
+
+static
+flatbuf_ref build_field(struct arrow_stream *stream,
+		const struct arrow_column *column)
+{
+	struct flatbuf_builder *fb = &stream->fb;
+	flatbuf_ref name_ref, type_ref, children_ref, dict_ref = 0;
+	flatbuf_ref timezone_ref = 0;
+	uint8_t type_type;
+
+	name_ref = flatbuf_create_string(fb, column->name->str);
+
+	if (column->type == ARROW_COLUMN_TYPE_TIMESTAMP && column->is_signed) {
+		timezone_ref = flatbuf_create_string(fb, "UTC");
+	}
+
+	switch (column->type) {
+	case ARROW_COLUMN_TYPE_BOOL:
+		type_type = TYPE_BOOL;
+		flatbuf_start_table(fb);
+		type_ref = flatbuf_end_table(fb);
+		break;
+	case ARROW_COLUMN_TYPE_INT:
+		type_type = TYPE_INT;
+		type_ref = build_int_type(fb, (int32_t) column->bit_width,
+			column->is_signed);
+		break;
+	case ARROW_COLUMN_TYPE_FLOAT:
+		type_type = TYPE_FLOATING_POINT;
+		flatbuf_start_table(fb);
+		flatbuf_add_i16(fb, 0, column->bit_width == 32 ?
+			PRECISION_SINGLE : PRECISION_DOUBLE);
+		type_ref = flatbuf_end_table(fb);
+		break;
+	case ARROW_COLUMN_TYPE_TIMESTAMP:
+		type_type = TYPE_TIMESTAMP;
+		flatbuf_start_table(fb);
+		flatbuf_add_i16(fb, 0, TIME_UNIT_NANOSECOND);
+
+		if (timezone_ref) {
+			flatbuf_add_ref(fb, 1, timezone_ref);
+		}
+
+		type_ref = flatbuf_end_table(fb);
+		break;
+	case ARROW_COLUMN_TYPE_DICT_STRING:
+	{
+		flatbuf_ref index_type_ref;
+
+		/* The field type is the type of the dictionary values */
+		type_type = TYPE_UTF8;
+		flatbuf_start_table(fb);
+		type_ref = flatbuf_end_table(fb);
+		index_type_ref = build_int_type(fb, 32, true);
+		flatbuf_start_table(fb);
+		flatbuf_add_i64(fb, 0, column->dict.id);
+		flatbuf_add_ref(fb, 1, index_type_ref);
+		flatbuf_add_bool(fb, 2, false);
+		dict_ref = flatbuf_end_table(fb);
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+	/* Readers require the children vector, even if it's empty */
+	children_ref = flatbuf_create_ref_vector(fb, NULL, 0);
+
+	flatbuf_start_table(fb);
+	flatbuf_add_ref(fb, 0, name_ref);
+	flatbuf_add_bool(fb, 1, column->is_nullable);
+	flatbuf_add_u8(fb, 2, type_type);
+	flatbuf_add_ref(fb, 3, type_ref);
+
+	if (dict_ref) {
+		flatbuf_add_ref(fb, 4, dict_ref);
+	}
+
+	flatbuf_add_ref(fb, 5, children_ref);
+	return flatbuf_end_table(fb);
+}
+
+static
+int write_schema(struct arrow_stream *stream)
+{
+	struct flatbuf_builder *fb = &stream->fb;
+	flatbuf_ref *field_refs = g_new0(flatbuf_ref, stream->columns->len);
+	flatbuf_ref fields_ref;
+	guint i;
+	int ret;
+
+	reset_message(stream);
+
+	for (i = 0; i < stream->columns->len; i++) {
+		field_refs[i] = build_field(stream,
+			g_ptr_array_index(stream->columns, i));
+	}
+
+	fields_ref = flatbuf_create_ref_vector(fb, field_refs,
+		stream->columns->len);
+	g_free(field_refs);
+	flatbuf_start_table(fb);
+
+	/* Little-endian */
+	flatbuf_add_i16(fb, 0, 0);
+
+	flatbuf_add_ref(fb, 1, fields_ref);
+	ret = write_message(stream, MESSAGE_HEADER_SCHEMA,
+		flatbuf_end_table(fb));
+	if (ret) {
+		goto end;
+	}
+
+	stream->schema_is_written = true;
+
+end:
+	return ret;
+}
+
+/*
+ * Builds a `RecordBatch` table of `length` rows from `stream->nodes`
+ * and `stream->buffers`.
+ */
+static
+flatbuf_ref build_record_batch(struct arrow_stream *stream, int64_t length)
+{
+	struct flatbuf_builder *fb = &stream->fb;
+	flatbuf_ref nodes_ref, buffers_ref;
+
+	nodes_ref = flatbuf_create_i64_pair_vector(fb,
+		(const int64_t *) stream->nodes->data,
+		stream->nodes->len / 2);
+	buffers_ref = flatbuf_create_i64_pair_vector(fb,
+		(const int64_t *) stream->buffers->data,
+		stream->buffers->len / 2);
+	flatbuf_start_table(fb);
+	flatbuf_add_i64(fb, 0, length);
+	flatbuf_add_ref(fb, 1, nodes_ref);
+	flatbuf_add_ref(fb, 2, buffers_ref);
+	return flatbuf_end_table(fb);
+}
+
+static
+int write_dictionary_batch(struct arrow_stream *stream,
+		struct arrow_column *column)
+{
+	struct arrow_dictionary *dict = &column->dict;
+	struct flatbuf_builder *fb = &stream->fb;
+	uint32_t new_count = dict->count - dict->written_count;
+	flatbuf_ref data_ref;
+	int ret = 0;
+
+	if (new_count == 0 && !dict->replace) {
+		goto end;
+	}
+
+	BT_ASSERT_DBG(dict->new_offsets->len == new_count + 1);
+	reset_message(stream);
+	append_node(stream, new_count, 0);
+
+	/* No validity bitmap: no nulls */
+	append_body_buffer(stream, NULL, 0);
+
+	append_body_buffer(stream, dict->new_offsets->data,
+		dict->new_offsets->len * sizeof(int32_t));
+	append_body_buffer(stream, dict->new_data->data, dict->new_data->len);
+	data_ref = build_record_batch(stream, new_count);
+	flatbuf_start_table(fb);
+	flatbuf_add_i64(fb, 0, dict->id);
+	flatbuf_add_ref(fb, 1, data_ref);
+	flatbuf_add_bool(fb, 2, !dict->replace);
+	ret = write_message(stream, MESSAGE_HEADER_DICTIONARY_BATCH,
+		flatbuf_end_table(fb));
+	if (ret) {
+		goto end;
+	}
+
+	dict->written_count = dict->count;
+	dict->replace = false;
+	reset_dict_new_entries(dict);
+
+end:
+	return ret;
+}
+
+static
+void reset_column(struct arrow_column *column)
+{
+	g_byte_array_set_size(column->validity, 0);
+	g_byte_array_set_size(column->values, 0);
+	column->null_count = 0;
+	column->length = 0;
+
+	if (column->type == ARROW_COLUMN_TYPE_DICT_STRING &&
+			column->dict.count >= MAX_DICTIONARY_ENTRIES) {
+		/*
+		 * All the entries are written: the next dictionary
+		 * batch starts over.
+		 */
+		g_hash_table_remove_all(column->dict.indexes);
+		column->dict.count = 0;
+		column->dict.written_count = 0;
+		column->dict.replace = true;
+	}
+}
+
+BT_HIDDEN
+int arrow_stream_flush(struct arrow_stream *stream)
+{
+	guint i;
+	int ret = 0;
+
+	if (stream->row_count == 0) {
+		goto end;
+	}
+
+	if (stream->failed) {
+		/* Already reported */
+		ret = -1;
+		goto end;
+	}
+
+	if (!stream->schema_is_written) {
+		ret = write_schema(stream);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	/* Dictionary entries first: the record batch refers to them */
+	for (i = 0; i < stream->columns->len; i++) {
+		struct arrow_column *column =
+			g_ptr_array_index(stream->columns, i);
+
+		if (column->type == ARROW_COLUMN_TYPE_DICT_STRING) {
+			ret = write_dictionary_batch(stream, column);
+			if (ret) {
+				goto end;
+			}
+		}
+	}
+
+	reset_message(stream);
+
+	for (i = 0; i < stream->columns->len; i++) {
+		struct arrow_column *column =
+			g_ptr_array_index(stream->columns, i);
+
+		BT_ASSERT_DBG(column->length == stream->row_count);
+		append_node(stream, (int64_t) column->length,
+			(int64_t) column->null_count);
+
+		if (column->null_count > 0) {
+			append_body_buffer(stream, column->validity->data,
+				column->validity->len);
+		} else {
+			/* All valid: no validity bitmap */
+			append_body_buffer(stream, NULL, 0);
+		}
+
+		append_body_buffer(stream, column->values->data,
+			column->values->len);
+		reset_column(column);
+	}
+
+	ret = write_message(stream, MESSAGE_HEADER_RECORD_BATCH,
+		build_record_batch(stream, (int64_t) stream->row_count));
+	stream->row_count = 0;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int arrow_stream_destroy(struct arrow_stream *stream)
+{
+	int ret = 0;
+
+	if (!stream) {
+		goto end;
+	}
+
+	if (stream->fp) {
+		/* End-of-stream marker */
+		const uint32_t eos[2] = {
+			GUINT32_TO_LE(CONTINUATION_MARKER), 0,
+		};
+
+		ret = arrow_stream_flush(stream);
+
+		if (!ret && stream->schema_is_written) {
+			ret = write_bytes(stream, eos, sizeof(eos));
+		}
+
+		if (fclose(stream->fp)) {
+			BT_COMP_LOGE_ERRNO("Cannot close Arrow stream file",
+				": path=\"%s\"", stream->path->str);
+			ret = -1;
+		}
+
+		stream->fp = NULL;
+	}
+
+	flatbuf_builder_fini(&stream->fb);
+
+	if (stream->columns) {
+		g_ptr_array_free(stream->columns, TRUE);
+	}
+
+	if (stream->body) {
+		g_byte_array_free(stream->body, TRUE);
+	}
+
+	if (stream->nodes) {
+		g_array_free(stream->nodes, TRUE);
+	}
+
+	if (stream->buffers) {
+		g_array_free(stream->buffers, TRUE);
+	}
+
+	if (stream->path) {
+		g_string_free(stream->path, TRUE);
+	}
+
+	g_free(stream);
+
+end:
+	return ret;
+}
@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_STREAM_H
+#define BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/*
+ * Arrow IPC stream (see the "IPC Streaming Format" section of the
+ * Arrow columnar format specification) being written to a file.
+ *
+ * The stream has a fixed set of columns (its schema). You append one
+ * value (or null) to each column, in order, for each row, and then call
+ * arrow_stream_end_row(). arrow_stream_flush() writes the buffered rows
+ * as one record batch, preceded with the new entries of the
+ * dictionaries of the dictionary-encoded columns.
+ */
+struct arrow_stream;
+
+enum arrow_column_type {
+	/* Bit-packed boolean */
+	ARROW_COLUMN_TYPE_BOOL,
+
+	/* 8-bit, 16-bit, 32-bit or 64-bit integer */
+	ARROW_COLUMN_TYPE_INT,
+
+	/* 32-bit or 64-bit floating point number */
+	ARROW_COLUMN_TYPE_FLOAT,
+
+	/* Nanoseconds (64-bit signed integer) */
+	ARROW_COLUMN_TYPE_TIMESTAMP,
+
+	/* Dictionary-encoded UTF-8 string (32-bit signed indexes) */
+	ARROW_COLUMN_TYPE_DICT_STRING,
+};
+
+struct arrow_column;
+
+/*
+ * Creates an Arrow IPC stream file `path` without columns.
+ */
+BT_HIDDEN
+struct arrow_stream *arrow_stream_create(const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+/*
+ * Writes the buffered rows of `stream`, ends and closes its file, and
+ * destroys it.
+ */
+BT_HIDDEN
+int arrow_stream_destroy(struct arrow_stream *stream);
+
+/*
+ * Adds a column named `name` to `stream`, which must have no rows yet.
+ *
+ * `bit_width` is 8, 16, 32, or 64 for an integer column, or 32 or 64
+ * for a floating point number column, and ignored otherwise.
+ *
+ * `is_signed` is only meaningful for an integer column.
+ *
+ * For a timestamp column, `is_signed` means the timestamps are
+ * relative to the Unix epoch (UTC time zone).
+ */
+BT_HIDDEN
+struct arrow_column *arrow_stream_add_column(struct arrow_stream *stream,
+		const char *name, enum arrow_column_type type,
+		unsigned int bit_width, bool is_signed, bool is_nullable);
+
+BT_HIDDEN
+void arrow_column_append_null(struct arrow_column *column);
+
+BT_HIDDEN
+void arrow_column_append_bool(struct arrow_column *column, bool value);
+
+/*
+ * Appends `value` to an integer or timestamp column, truncating it to
+ * the column width.
+ */
+BT_HIDDEN
+void arrow_column_append_int(struct arrow_column *column, uint64_t value);
+
+BT_HIDDEN
+void arrow_column_append_float(struct arrow_column *column, double value);
+
+BT_HIDDEN
+void arrow_column_append_string(struct arrow_column *column,
+		const char *value);
+
+/*
+ * Ends the current row of `stream`, after a value was appended to each
+ * of its columns.
+ *
+ * Returns the number of buffered rows.
+ */
+BT_HIDDEN
+uint64_t arrow_stream_end_row(struct arrow_stream *stream);
+
+/*
+ * Writes the buffered rows of `stream`, if any, as one record batch.
+ */
+BT_HIDDEN
+int arrow_stream_flush(struct arrow_stream *stream);
+
+#endif /* BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_STREAM_H */
@@ -0,0 +1,1032 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (arrow_sink->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (arrow_sink->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.COLUMNAR.ARROW"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "arrow.h"
+#include "arrow-stream.h"
+
+/* Default value of the `batch-size` parameter */
+#define DEFAULT_BATCH_SIZE	(16 * 1024)
+
+/* Separator of the labels of an enumeration field */
+#define ENUM_LABEL_SEP		","
+
+static
+const char * const in_port_name = "in";
+
+/*
+ * Output of the events of one trace: one directory containing one Arrow
+ * IPC stream file per event class.
+ */
+struct arrow_sink_trace {
+	/* Weak */
+	struct arrow_sink_comp *arrow_sink;
+
+	/* Weak */
+	const bt_trace *ir_trace;
+
+	bt_listener_id ir_trace_destruction_listener_id;
+
+	/* Output directory; `NULL` until it exists */
+	GString *path;
+
+	/*
+	 * Hash table of `const bt_event_class *` (weak; the writer
+	 * owns it) to `struct arrow_sink_writer *` (owned by hash
+	 * table).
+	 */
+	GHashTable *writers;
+};
+
+/*
+ * Writer of the events of one event class of a trace, one row per
+ * event.
+ */
+struct arrow_sink_writer {
+	/* Weak */
+	struct arrow_sink_comp *arrow_sink;
+
+	/* Owned by this */
+	const bt_event_class *ir_ec;
+
+	/* Owned by this */
+	struct arrow_stream *stream;
+
+	/*
+	 * Columns of `stream` (weak), in the order in which
+	 * write_event() appends their values
+	 */
+	GPtrArray *columns;
+
+	/* True if the first column contains the event timestamps */
+	bool has_timestamp;
+
+	/* Joined enumeration field labels; reused for each field */
+	GString *labels;
+};
+
+static
+void destroy_writer(struct arrow_sink_writer *writer)
+{
+	struct arrow_sink_comp *arrow_sink;
+
+	if (!writer) {
+		goto end;
+	}
+
+	arrow_sink = writer->arrow_sink;
+
+	if (arrow_stream_destroy(writer->stream)) {
+		BT_COMP_LOGW("Cannot complete Arrow stream file: "
+			"event-class-name=\"%s\", event-class-id=%" PRIu64,
+			bt_event_class_get_name(writer->ir_ec),
+			bt_event_class_get_id(writer->ir_ec));
+	}
+
+	writer->stream = NULL;
+
+	if (writer->columns) {
+		g_ptr_array_free(writer->columns, TRUE);
+	}
+
+	if (writer->labels) {
+		g_string_free(writer->labels, TRUE);
+	}
+
+	bt_event_class_put_ref(writer->ir_ec);
+	g_free(writer);
+
+end:
+	return;
+}
+
+/*
+ * Appends `name` to `str`, replacing each character which could make
+ * it an unsafe file name with `_`.
+ */
+static
+void append_sanitized_file_name(GString *str, const char *name)
+{
+	const char *ch;
+	size_t start = str->len;
+
+	for (ch = name; *ch != '\0'; ch++) {
+		if (g_ascii_isalnum(*ch) || *ch == '-' || *ch == '_' ||
+				*ch == '.') {
+			g_string_append_c(str, *ch);
+		} else {
+			g_string_append_c(str, '_');
+		}
+	}
+
+	/* Avoid hidden files as well as `.` and `..` */
+	if (str->str[start] == '.') {
+		str->str[start] = '_';
+	}
+}
+
+static
+int ensure_trace_dir_exists(struct arrow_sink_trace *trace)
+{
+	struct arrow_sink_comp *arrow_sink = trace->arrow_sink;
+	const char *trace_name = bt_trace_get_name(trace->ir_trace);
+	GString *base_path;
+	unsigned int suffix = 0;
+	int ret = 0;
+
+	if (trace->path) {
+		goto end;
+	}
+
+	base_path = g_string_new(arrow_sink->output_dir_path->str);
+	g_string_append(base_path, G_DIR_SEPARATOR_S);
+
+	if (trace_name && trace_name[0] != '\0') {
+		append_sanitized_file_name(base_path, trace_name);
+	} else {
+		g_string_append(base_path, "trace");
+	}
+
+	/* Find a path which doesn't exist yet */
+	trace->path = g_string_new(base_path->str);
+
+	while (g_file_test(trace->path->str, G_FILE_TEST_EXISTS)) {
+		g_string_printf(trace->path, "%s-%u", base_path->str, suffix);
+		suffix++;
+	}
+
+	g_string_free(base_path, TRUE);
+	ret = g_mkdir_with_parents(trace->path->str, 0755);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(arrow_sink->self_comp,
+			"Cannot create directories for trace directory",
+			": path=\"%s\"", trace->path->str);
+		g_string_free(trace->path, TRUE);
+		trace->path = NULL;
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
+static
+unsigned int int_column_bit_width(uint64_t bit_count)
+{
+	if (bit_count <= 8) {
+		return 8;
+	} else if (bit_count <= 16) {
+		return 16;
+	} else if (bit_count <= 32) {
+		return 32;
+	}
+
+	return 64;
+}
+
+static
+void add_column(struct arrow_sink_writer *writer, const char *name,
+		enum arrow_column_type type, unsigned int bit_width,
+		bool is_signed, bool is_nullable)
+{
+	g_ptr_array_add(writer->columns,
+		arrow_stream_add_column(writer->stream, name, type, bit_width,
+			is_signed, is_nullable));
+}
+
+/*
+ * Adds the columns of the fields of class `fc` named `name`, recursing
+ * into structure and option field classes.
+ *
+ * append_field_values() must visit the field classes exactly like this
+ * function.
+ */
+static
+void add_field_columns(struct arrow_sink_writer *writer,
+		const bt_field_class *fc, GString *name, bool is_nullable)
+{
+	struct arrow_sink_comp *arrow_sink = writer->arrow_sink;
+	bt_field_class_type fc_type = bt_field_class_get_type(fc);
+	size_t orig_name_len = name->len;
+
+	if (fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_BOOL, 0, false,
+			is_nullable);
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_INT,
+			int_column_bit_width(
+				bt_field_class_bit_array_get_length(fc)),
+			false, is_nullable);
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_INTEGER)) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_INT,
+			int_column_bit_width(
+				bt_field_class_integer_get_field_value_range(fc)),
+			bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_SIGNED_INTEGER),
+			is_nullable);
+
+		if (bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_ENUMERATION)) {
+			/* Null when no mapping contains the value */
+			g_string_append(name, ".label");
+			add_column(writer, name->str,
+				ARROW_COLUMN_TYPE_DICT_STRING, 0, false, true);
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_FLOAT, 32,
+			false, is_nullable);
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_FLOAT, 64,
+			false, is_nullable);
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRING) {
+		add_column(writer, name->str, ARROW_COLUMN_TYPE_DICT_STRING, 0,
+			false, is_nullable);
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		uint64_t i;
+
+		for (i = 0; i < bt_field_class_structure_get_member_count(fc);
+				i++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, i);
+
+			g_string_append_c(name, '.');
+			g_string_append(name,
+				bt_field_class_structure_member_get_name(member));
+			add_field_columns(writer,
+				bt_field_class_structure_member_borrow_field_class_const(
+					member),
+				name, is_nullable);
+			g_string_truncate(name, orig_name_len);
+		}
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_OPTION)) {
+		add_field_columns(writer,
+			bt_field_class_option_borrow_field_class_const(fc),
+			name, true);
+	} else {
+		/* Arrays and variants */
+		BT_COMP_LOGI("Not writing field: unsupported field class type: "
+			"event-class-name=\"%s\", field-name=\"%s\", "
+			"fc-type=%s",
+			bt_event_class_get_name(writer->ir_ec), name->str,
+			bt_common_field_class_type_string(fc_type));
+	}
+
+	g_string_truncate(name, orig_name_len);
+}
+
+static
+void add_scope_columns(struct arrow_sink_writer *writer,
+		const bt_field_class *fc, const char *scope_name,
+		GString *name)
+{
+	if (!fc) {
+		return;
+	}
+
+	g_string_assign(name, scope_name);
+	add_field_columns(writer, fc, name, false);
+}
+
+static
+struct arrow_sink_writer *create_writer(struct arrow_sink_trace *trace,
+		const bt_event_class *ir_ec)
+{
+	struct arrow_sink_comp *arrow_sink = trace->arrow_sink;
+	const bt_stream_class *ir_sc =
+		bt_event_class_borrow_stream_class_const(ir_ec);
+	const bt_clock_class *ir_cc =
+		bt_stream_class_borrow_default_clock_class_const(ir_sc);
+	const char *ec_name = bt_event_class_get_name(ir_ec);
+	struct arrow_sink_writer *writer = NULL;
+	GString *path = NULL;
+	GString *name = NULL;
+
+	if (ensure_trace_dir_exists(trace)) {
+		goto error;
+	}
+
+	path = g_string_new(trace->path->str);
+	g_string_append(path, G_DIR_SEPARATOR_S);
+
+	if (ec_name && ec_name[0] != '\0') {
+		append_sanitized_file_name(path, ec_name);
+	} else {
+		g_string_append(path, "event");
+	}
+
+	g_string_append_printf(path, "-%" PRIu64 "-%" PRIu64 ".arrows",
+		bt_stream_class_get_id(ir_sc), bt_event_class_get_id(ir_ec));
+	writer = g_new0(struct arrow_sink_writer, 1);
+	writer->arrow_sink = arrow_sink;
+	writer->ir_ec = ir_ec;
+	bt_event_class_get_ref(ir_ec);
+	writer->columns = g_ptr_array_new();
+	writer->labels = g_string_new(NULL);
+	writer->stream = arrow_stream_create(path->str, arrow_sink->log_level,
+		arrow_sink->self_comp);
+	if (!writer->stream) {
+		BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp,
+			"Cannot create Arrow stream file: path=\"%s\"",
+			path->str);
+		goto error;
+	}
+
+	if (ir_cc) {
+		/* Null if the timestamp doesn't fit */
+		writer->has_timestamp = true;
+		add_column(writer, "timestamp", ARROW_COLUMN_TYPE_TIMESTAMP,
+			0, bt_clock_class_origin_is_unix_epoch(ir_cc), true);
+	}
+
+	add_column(writer, "stream_id", ARROW_COLUMN_TYPE_INT, 64, false,
+		false);
+	name = g_string_new(NULL);
+	add_scope_columns(writer,
+		bt_stream_class_borrow_packet_context_field_class_const(ir_sc),
+		"packet_context", name);
+	add_scope_columns(writer,
+		bt_stream_class_borrow_event_common_context_field_class_const(
+			ir_sc),
+		"common_context", name);
+	add_scope_columns(writer,
+		bt_event_class_borrow_specific_context_field_class_const(ir_ec),
+		"specific_context", name);
+	add_scope_columns(writer,
+		bt_event_class_borrow_payload_field_class_const(ir_ec),
+		"payload", name);
+	g_hash_table_insert(trace->writers, (gpointer) ir_ec, writer);
+	BT_COMP_LOGI("Created Arrow stream file: path=\"%s\", "
+		"event-class-name=\"%s\", column-count=%u",
+		path->str, ec_name, writer->columns->len);
+	goto end;
+
+error:
+	destroy_writer(writer);
+	writer = NULL;
+
+end:
+	if (path) {
+		g_string_free(path, TRUE);
+	}
+
+	if (name) {
+		g_string_free(name, TRUE);
+	}
+
+	return writer;
+}
+
+static
+void append_enum_labels(struct arrow_sink_writer *writer,
+		struct arrow_column *column, const bt_field *field,
+		bool is_signed)
+{
+	bt_field_class_enumeration_mapping_label_array labels;
+	uint64_t count;
+	uint64_t i;
+	int ret;
+
+	if (is_signed) {
+		ret = bt_field_enumeration_signed_get_mapping_labels(field,
+			&labels, &count);
+	} else {
+		ret = bt_field_enumeration_unsigned_get_mapping_labels(field,
+			&labels, &count);
+	}
+
+	if (ret || count == 0) {
+		arrow_column_append_null(column);
+		return;
+	}
+
+	g_string_assign(writer->labels, labels[0]);
+
+	for (i = 1; i < count; i++) {
+		g_string_append(writer->labels, ENUM_LABEL_SEP);
+		g_string_append(writer->labels, labels[i]);
+	}
+
+	arrow_column_append_string(column, writer->labels->str);
+}
+
+static inline
+struct arrow_column *next_column(struct arrow_sink_writer *writer,
+		guint *index)
+{
+	BT_ASSERT_DBG(*index < writer->columns->len);
+	return g_ptr_array_index(writer->columns, (*index)++);
+}
+
+/*
+ * Appends the values of `field`, of class `fc`, to the columns of
+ * `writer` from the column at `*index`, updating `*index`.
+ *
+ * `field` is `NULL` for an option field without content: this function
+ * then appends nulls.
+ */
+static
+void append_field_values(struct arrow_sink_writer *writer,
+		const bt_field_class *fc, const bt_field *field, guint *index)
+{
+	bt_field_class_type fc_type = bt_field_class_get_type(fc);
+
+	if (fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		struct arrow_column *column = next_column(writer, index);
+
+		if (field) {
+			arrow_column_append_bool(column,
+				(bool) bt_field_bool_get_value(field));
+		} else {
+			arrow_column_append_null(column);
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		struct arrow_column *column = next_column(writer, index);
+
+		if (field) {
+			arrow_column_append_int(column,
+				bt_field_bit_array_get_value_as_integer(field));
+		} else {
+			arrow_column_append_null(column);
+		}
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_INTEGER)) {
+		bool is_signed = bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER);
+		struct arrow_column *column = next_column(writer, index);
+
+		if (!field) {
+			arrow_column_append_null(column);
+		} else if (is_signed) {
+			arrow_column_append_int(column,
+				(uint64_t) bt_field_integer_signed_get_value(field));
+		} else {
+			arrow_column_append_int(column,
+				bt_field_integer_unsigned_get_value(field));
+		}
+
+		if (bt_field_class_type_is(fc_type,
+				BT_FIELD_CLASS_TYPE_ENUMERATION)) {
+			column = next_column(writer, index);
+
+			if (field) {
+				append_enum_labels(writer, column, field,
+					is_signed);
+			} else {
+				arrow_column_append_null(column);
+			}
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		struct arrow_column *column = next_column(writer, index);
+
+		if (field) {
+			arrow_column_append_float(column,
+				bt_field_real_single_precision_get_value(field));
+		} else {
+			arrow_column_append_null(column);
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		struct arrow_column *column = next_column(writer, index);
+
+		if (field) {
+			arrow_column_append_float(column,
+				bt_field_real_double_precision_get_value(field));
+		} else {
+			arrow_column_append_null(column);
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRING) {
+		struct arrow_column *column = next_column(writer, index);
+
+		if (field) {
+			arrow_column_append_string(column,
+				bt_field_string_get_value(field));
+		} else {
+			arrow_column_append_null(column);
+		}
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		uint64_t i;
+
+		for (i = 0; i < bt_field_class_structure_get_member_count(fc);
+				i++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, i);
+
+			append_field_values(writer,
+				bt_field_class_structure_member_borrow_field_class_const(
+					member),
+				field ?
+					bt_field_structure_borrow_member_field_by_index_const(
+						field, i) :
+					NULL,
+				index);
+		}
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_OPTION)) {
+		append_field_values(writer,
+			bt_field_class_option_borrow_field_class_const(fc),
+			field ? bt_field_option_borrow_field_const(field) : NULL,
+			index);
+	}
+
+	/* Arrays and variants have no columns */
+}
+
+static
+void append_scope_values(struct arrow_sink_writer *writer,
+		const bt_field *field, guint *index)
+{
+	if (!field) {
+		return;
+	}
+
+	append_field_values(writer, bt_field_borrow_class_const(field), field,
+		index);
+}
+
+static
+struct arrow_sink_trace *create_trace(struct arrow_sink_comp *arrow_sink,
+		const bt_trace *ir_trace);
+
+static
+int write_event(struct arrow_sink_comp *arrow_sink, const bt_message *msg)
+{
+	const bt_event *ir_event = bt_message_event_borrow_event_const(msg);
+	const bt_event_class *ir_ec = bt_event_borrow_class_const(ir_event);
+	const bt_stream *ir_stream = bt_event_borrow_stream_const(ir_event);
+	const bt_packet *ir_packet = bt_event_borrow_packet_const(ir_event);
+	const bt_trace *ir_trace = bt_stream_borrow_trace_const(ir_stream);
+	struct arrow_sink_trace *trace;
+	struct arrow_sink_writer *writer;
+	guint index = 0;
+	int ret = 0;
+
+	trace = g_hash_table_lookup(arrow_sink->traces, ir_trace);
+	if (G_UNLIKELY(!trace)) {
+		trace = create_trace(arrow_sink, ir_trace);
+		if (!trace) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+	writer = g_hash_table_lookup(trace->writers, ir_ec);
+	if (G_UNLIKELY(!writer)) {
+		writer = create_writer(trace, ir_ec);
+		if (!writer) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+	if (writer->has_timestamp) {
+		struct arrow_column *column = next_column(writer, &index);
+		int64_t ns_from_origin;
+
+		if (bt_clock_snapshot_get_ns_from_origin(
+				bt_message_event_borrow_default_clock_snapshot_const(msg),
+				&ns_from_origin) ==
+				BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+			arrow_column_append_int(column,
+				(uint64_t) ns_from_origin);
+		} else {
+			arrow_column_append_null(column);
+		}
+	}
+
+	arrow_column_append_int(next_column(writer, &index),
+		bt_stream_get_id(ir_stream));
+
+	if (ir_packet) {
+		append_scope_values(writer,
+			bt_packet_borrow_context_field_const(ir_packet),
+			&index);
+	}
+
+	append_scope_values(writer,
+		bt_event_borrow_common_context_field_const(ir_event), &index);
+	append_scope_values(writer,
+		bt_event_borrow_specific_context_field_const(ir_event), &index);
+	append_scope_values(writer,
+		bt_event_borrow_payload_field_const(ir_event), &index);
+	BT_ASSERT_DBG(index == writer->columns->len);
+
+	if (arrow_stream_end_row(writer->stream) >= arrow_sink->batch_size) {
+		ret = arrow_stream_flush(writer->stream);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp,
+				"Cannot write record batch: "
+				"trace-path=\"%s\", event-class-name=\"%s\"",
+				trace->path->str,
+				bt_event_class_get_name(ir_ec));
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+void destroy_trace(struct arrow_sink_trace *trace)
+{
+	if (!trace) {
+		goto end;
+	}
+
+	if (trace->ir_trace_destruction_listener_id != UINT64_C(-1)) {
+		/*
+		 * Remove the destruction listener, otherwise it could
+		 * be called in the future, and its private data is this
+		 * trace object which won't exist anymore.
+		 */
+		(void) bt_trace_remove_destruction_listener(trace->ir_trace,
+			trace->ir_trace_destruction_listener_id);
+		trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	}
+
+	/* Flushes and closes the Arrow stream files */
+	if (trace->writers) {
+		g_hash_table_destroy(trace->writers);
+		trace->writers = NULL;
+	}
+
+	if (trace->path) {
+		g_string_free(trace->path, TRUE);
+		trace->path = NULL;
+	}
+
+	g_free(trace);
+
+end:
+	return;
+}
+
+static
+void ir_trace_destruction_listener(const bt_trace *ir_trace, void *data)
+{
+	struct arrow_sink_trace *trace = data;
+
+	/*
+	 * Prevent bt_trace_remove_destruction_listener() from being
+	 * called in destroy_trace(), which is called by
+	 * g_hash_table_remove() below.
+	 */
+	trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	g_hash_table_remove(trace->arrow_sink->traces, ir_trace);
+}
+
+static
+struct arrow_sink_trace *create_trace(struct arrow_sink_comp *arrow_sink,
+		const bt_trace *ir_trace)
+{
+	struct arrow_sink_trace *trace = g_new0(struct arrow_sink_trace, 1);
+	bt_trace_add_listener_status trace_status;
+
+	trace->arrow_sink = arrow_sink;
+	trace->ir_trace = ir_trace;
+	trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	trace->writers = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		NULL, (GDestroyNotify) destroy_writer);
+	trace_status = bt_trace_add_destruction_listener(ir_trace,
+		ir_trace_destruction_listener, trace,
+		&trace->ir_trace_destruction_listener_id);
+	if (trace_status) {
+		BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp,
+			"Cannot add trace destruction listener.");
+		goto error;
+	}
+
+	g_hash_table_insert(arrow_sink->traces, (gpointer) ir_trace, trace);
+	goto end;
+
+error:
+	destroy_trace(trace);
+	trace = NULL;
+
+end:
+	return trace;
+}
+
+/*
+ * Writes the buffered rows of all the writers.
+ */
+static
+int flush_all(struct arrow_sink_comp *arrow_sink)
+{
+	GHashTableIter trace_iter;
+	gpointer trace_p;
+	int ret = 0;
+
+	g_hash_table_iter_init(&trace_iter, arrow_sink->traces);
+
+	while (g_hash_table_iter_next(&trace_iter, NULL, &trace_p)) {
+		struct arrow_sink_trace *trace = trace_p;
+		GHashTableIter writer_iter;
+		gpointer writer_p;
+
+		g_hash_table_iter_init(&writer_iter, trace->writers);
+
+		while (g_hash_table_iter_next(&writer_iter, NULL, &writer_p)) {
+			struct arrow_sink_writer *writer = writer_p;
+
+			if (arrow_stream_flush(writer->stream)) {
+				BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp,
+					"Cannot write record batch: "
+					"trace-path=\"%s\", "
+					"event-class-name=\"%s\"",
+					trace->path->str,
+					bt_event_class_get_name(writer->ir_ec));
+				ret = -1;
+			}
+		}
+	}
+
+	return ret;
+}
+
+static
+void destroy_arrow_sink_comp(struct arrow_sink_comp *arrow_sink)
+{
+	if (!arrow_sink) {
+		goto end;
+	}
+
+	if (arrow_sink->traces) {
+		g_hash_table_destroy(arrow_sink->traces);
+		arrow_sink->traces = NULL;
+	}
+
+	if (arrow_sink->output_dir_path) {
+		g_string_free(arrow_sink->output_dir_path, TRUE);
+		arrow_sink->output_dir_path = NULL;
+	}
+
+	BT_MESSAGE_ITERATOR_PUT_REF_AND_RESET(arrow_sink->upstream_iter);
+	g_free(arrow_sink);
+
+end:
+	return;
+}
+
+static struct bt_param_validation_map_value_entry_descr arrow_sink_params_descr[] = {
+	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { .type = BT_VALUE_TYPE_STRING } },
+	{ "batch-size", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+bt_component_class_initialize_method_status configure_component(
+		struct arrow_sink_comp *arrow_sink, const bt_value *params)
+{
+	bt_component_class_initialize_method_status status;
+	const bt_value *value;
+	enum bt_param_validation_status validation_status;
+	gchar *validation_error = NULL;
+
+	validation_status = bt_param_validation_validate(params,
+		arrow_sink_params_descr, &validation_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp, "%s",
+			validation_error);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "path");
+	g_string_assign(arrow_sink->output_dir_path,
+		bt_value_string_get(value));
+	arrow_sink->batch_size = DEFAULT_BATCH_SIZE;
+	value = bt_value_map_borrow_entry_value_const(params, "batch-size");
+	if (value) {
+		arrow_sink->batch_size = bt_value_integer_unsigned_get(value);
+
+		if (arrow_sink->batch_size == 0) {
+			BT_COMP_LOGE_APPEND_CAUSE(arrow_sink->self_comp,
+				"Invalid `batch-size` parameter: "
+				"value must be greater than 0.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	g_free(validation_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status arrow_sink_init(
+		bt_self_component_sink *self_comp_sink,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params,
+		void *init_method_data)
+{
+	bt_component_class_initialize_method_status status =
+		BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	bt_self_component_add_port_status add_port_status;
+	struct arrow_sink_comp *arrow_sink = NULL;
+	bt_self_component *self_comp =
+		bt_self_component_sink_as_self_component(self_comp_sink);
+	bt_logging_level log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(self_comp));
+
+	arrow_sink = g_new0(struct arrow_sink_comp, 1);
+	if (!arrow_sink) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+			"Failed to allocate one Arrow sink structure.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	arrow_sink->log_level = log_level;
+	arrow_sink->self_comp = self_comp;
+	arrow_sink->output_dir_path = g_string_new(NULL);
+	status = configure_component(arrow_sink, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		/* configure_component() logs errors */
+		goto end;
+	}
+
+	if (g_mkdir_with_parents(arrow_sink->output_dir_path->str, 0755)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(self_comp,
+			"Cannot create directories for output directory",
+			": output-dir-path=\"%s\"",
+			arrow_sink->output_dir_path->str);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	arrow_sink->traces = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, (GDestroyNotify) destroy_trace);
+	add_port_status = bt_self_component_sink_add_input_port(
+		self_comp_sink, in_port_name, NULL, NULL);
+	switch (add_port_status) {
+	case BT_SELF_COMPONENT_ADD_PORT_STATUS_ERROR:
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	case BT_SELF_COMPONENT_ADD_PORT_STATUS_MEMORY_ERROR:
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	default:
+		break;
+	}
+
+	bt_self_component_set_data(self_comp, arrow_sink);
+
+end:
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		destroy_arrow_sink_comp(arrow_sink);
+	}
+
+	return status;
+}
+
+static inline
+void put_messages(bt_message_array_const msgs, uint64_t count)
+{
+	uint64_t i;
+
+	for (i = 0; i < count; i++) {
+		BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
+	}
+}
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status arrow_sink_consume(
+		bt_self_component_sink *self_comp)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	struct arrow_sink_comp *arrow_sink;
+	bt_message_iterator_next_status next_status;
+	uint64_t msg_count = 0;
+	bt_message_array_const msgs;
+
+	arrow_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+	BT_ASSERT_DBG(arrow_sink);
+	BT_ASSERT_DBG(arrow_sink->upstream_iter);
+
+	/* Consume messages */
+	next_status = bt_message_iterator_next(
+		arrow_sink->upstream_iter, &msgs, &msg_count);
+	if (next_status < 0) {
+		status = (int) next_status;
+		goto end;
+	}
+
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+	{
+		uint64_t i;
+
+		for (i = 0; i < msg_count; i++) {
+			const bt_message *msg = msgs[i];
+
+			BT_ASSERT_DBG(msg);
+
+			/* Only event messages have rows */
+			if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_EVENT &&
+					write_event(arrow_sink, msg)) {
+				status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			}
+
+			BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
+
+			if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+				BT_COMP_LOGE("Failed to handle message: "
+					"generated Arrow stream files could be incomplete: "
+					"output-dir-path=\"%s\"",
+					arrow_sink->output_dir_path->str);
+				goto error;
+			}
+		}
+
+		break;
+	}
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_AGAIN;
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		if (flush_all(arrow_sink)) {
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_MEMORY_ERROR:
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_MEMORY_ERROR;
+		break;
+	default:
+		break;
+	}
+
+	goto end;
+
+error:
+	BT_ASSERT(status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK);
+	put_messages(msgs, msg_count);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+arrow_sink_graph_is_configured(bt_self_component_sink *self_comp)
+{
+	bt_component_class_sink_graph_is_configured_method_status status;
+	bt_message_iterator_create_from_sink_component_status
+		msg_iter_status;
+	struct arrow_sink_comp *arrow_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+
+	msg_iter_status =
+		bt_message_iterator_create_from_sink_component(
+			self_comp,
+			bt_self_component_sink_borrow_input_port_by_name(
+				self_comp, in_port_name), &arrow_sink->upstream_iter);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_SINK_COMPONENT_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto end;
+	}
+
+	status = BT_COMPONENT_CLASS_SINK_GRAPH_IS_CONFIGURED_METHOD_STATUS_OK;
+end:
+	return status;
+}
+
+BT_HIDDEN
+void arrow_sink_finalize(bt_self_component_sink *self_comp)
+{
+	struct arrow_sink_comp *arrow_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+
+	destroy_arrow_sink_comp(arrow_sink);
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_H
+#define BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_H
+
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+
+struct arrow_sink_comp {
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+
+	/* Owned by this */
+	bt_message_iterator *upstream_iter;
+
+	/* Base output directory path */
+	GString *output_dir_path;
+
+	/* Maximum number of rows of a record batch */
+	uint64_t batch_size;
+
+	/*
+	 * Hash table of `const bt_trace *` (weak) to
+	 * `struct arrow_sink_trace *` (owned by hash table).
+	 */
+	GHashTable *traces;
+};
+
+BT_HIDDEN
+bt_component_class_initialize_method_status arrow_sink_init(
+		bt_self_component_sink *component,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params,
+		void *init_method_data);
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status arrow_sink_consume(
+		bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+arrow_sink_graph_is_configured(bt_self_component_sink *component);
+
+BT_HIDDEN
+void arrow_sink_finalize(bt_self_component_sink *component);
+
+#endif /* BABELTRACE_PLUGIN_COLUMNAR_ARROW_ARROW_H */
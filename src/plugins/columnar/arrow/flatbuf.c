@@ -0,0 +1,305 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "common/assert.h"
+
+#include "flatbuf.h"
+
+#define INITIAL_CAPACITY	1024
+
+static inline
+uint32_t built_size(const struct flatbuf_builder *builder)
+{
+	return (uint32_t) (builder->capacity - builder->head);
+}
+
+/*
+ * Makes sure that there's room for `len` more bytes before the built
+ * data.
+ */
+static
+void ensure_room(struct flatbuf_builder *builder, size_t len)
+{
+	size_t size = built_size(builder);
+	size_t new_capacity;
+	uint8_t *new_buf;
+
+	if (G_LIKELY(builder->head >= len)) {
+		return;
+	}
+
+	new_capacity = MAX(builder->capacity * 2, INITIAL_CAPACITY);
+
+	while (new_capacity - size < len) {
+		new_capacity *= 2;
+	}
+
+	/* The built data stays at the end of the buffer */
+	new_buf = g_malloc(new_capacity);
+	if (size > 0) {
+		memcpy(&new_buf[new_capacity - size],
+			&builder->buf[builder->head], size);
+	}
+
+	g_free(builder->buf);
+	builder->buf = new_buf;
+	builder->capacity = new_capacity;
+	builder->head = new_capacity - size;
+}
+
+static
+void push(struct flatbuf_builder *builder, const void *data, size_t len)
+{
+	ensure_room(builder, len);
+	builder->head -= len;
+	memcpy(&builder->buf[builder->head], data, len);
+}
+
+/*
+ * Pads the built data with zeros so that it's aligned on `align` bytes
+ * once `additional` more bytes are pushed.
+ */
+static
+void prep(struct flatbuf_builder *builder, size_t align, size_t additional)
+{
+	static const uint8_t zeros[8];
+	size_t pad;
+
+	BT_ASSERT_DBG(align <= sizeof(zeros));
+
+	if (align > builder->min_align) {
+		builder->min_align = align;
+	}
+
+	pad = (~(built_size(builder) + additional) + 1) & (align - 1);
+	push(builder, zeros, pad);
+}
+
+static
+void push_u16(struct flatbuf_builder *builder, uint16_t value)
+{
+	value = GUINT16_TO_LE(value);
+	push(builder, &value, sizeof(value));
+}
+
+static
+void push_u32(struct flatbuf_builder *builder, uint32_t value)
+{
+	value = GUINT32_TO_LE(value);
+	push(builder, &value, sizeof(value));
+}
+
+static
+void push_i64(struct flatbuf_builder *builder, int64_t value)
+{
+	value = GINT64_TO_LE(value);
+	push(builder, &value, sizeof(value));
+}
+
+/*
+ * Pushes an offset to `ref`, relative to the offset itself.
+ */
+static
+void push_offset(struct flatbuf_builder *builder, flatbuf_ref ref)
+{
+	prep(builder, sizeof(uint32_t), 0);
+	BT_ASSERT_DBG(ref <= built_size(builder));
+	push_u32(builder, built_size(builder) - ref + sizeof(uint32_t));
+}
+
+BT_HIDDEN
+void flatbuf_builder_init(struct flatbuf_builder *builder)
+{
+	memset(builder, 0, sizeof(*builder));
+	builder->min_align = 1;
+}
+
+BT_HIDDEN
+void flatbuf_builder_fini(struct flatbuf_builder *builder)
+{
+	g_free(builder->buf);
+	builder->buf = NULL;
+}
+
+BT_HIDDEN
+void flatbuf_builder_reset(struct flatbuf_builder *builder)
+{
+	builder->head = builder->capacity;
+	builder->min_align = 1;
+	builder->table.in_progress = false;
+}
+
+BT_HIDDEN
+flatbuf_ref flatbuf_create_string(struct flatbuf_builder *builder,
+		const char *str)
+{
+	static const uint8_t nul = 0;
+	size_t len = strlen(str);
+
+	BT_ASSERT_DBG(!builder->table.in_progress);
+	prep(builder, sizeof(uint32_t), len + 1);
+	push(builder, &nul, 1);
+	push(builder, str, len);
+	push_u32(builder, (uint32_t) len);
+	return built_size(builder);
+}
+
+BT_HIDDEN
+flatbuf_ref flatbuf_create_ref_vector(struct flatbuf_builder *builder,
+		const flatbuf_ref *refs, size_t count)
+{
+	size_t i;
+
+	BT_ASSERT_DBG(!builder->table.in_progress);
+	prep(builder, sizeof(uint32_t), sizeof(uint32_t) * count);
+
+	for (i = count; i > 0; i--) {
+		push_offset(builder, refs[i - 1]);
+	}
+
+	push_u32(builder, (uint32_t) count);
+	return built_size(builder);
+}
+
+BT_HIDDEN
+flatbuf_ref flatbuf_create_i64_pair_vector(struct flatbuf_builder *builder,
+		const int64_t *values, size_t count)
+{
+	size_t i;
+
+	BT_ASSERT_DBG(!builder->table.in_progress);
+	prep(builder, sizeof(uint32_t), 2 * sizeof(int64_t) * count);
+	prep(builder, sizeof(int64_t), 2 * sizeof(int64_t) * count);
+
+	for (i = count; i > 0; i--) {
+		push_i64(builder, values[2 * (i - 1) + 1]);
+		push_i64(builder, values[2 * (i - 1)]);
+	}
+
+	push_u32(builder, (uint32_t) count);
+	return built_size(builder);
+}
+
+BT_HIDDEN
+void flatbuf_start_table(struct flatbuf_builder *builder)
+{
+	BT_ASSERT_DBG(!builder->table.in_progress);
+	memset(&builder->table, 0, sizeof(builder->table));
+	builder->table.in_progress = true;
+	builder->table.start = built_size(builder);
+}
+
+static
+void set_field(struct flatbuf_builder *builder, unsigned int index)
+{
+	BT_ASSERT_DBG(builder->table.in_progress);
+	BT_ASSERT_DBG(index < FLATBUF_MAX_TABLE_FIELDS);
+	builder->table.fields[index] = built_size(builder);
+
+	if (index >= builder->table.field_count) {
+		builder->table.field_count = index + 1;
+	}
+}
+
+BT_HIDDEN
+void flatbuf_add_bool(struct flatbuf_builder *builder, unsigned int index,
+		bool value)
+{
+	flatbuf_add_u8(builder, index, value ? 1 : 0);
+}
+
+BT_HIDDEN
+void flatbuf_add_u8(struct flatbuf_builder *builder, unsigned int index,
+		uint8_t value)
+{
+	push(builder, &value, sizeof(value));
+	set_field(builder, index);
+}
+
+BT_HIDDEN
+void flatbuf_add_i16(struct flatbuf_builder *builder, unsigned int index,
+		int16_t value)
+{
+	prep(builder, sizeof(value), 0);
+	push_u16(builder, (uint16_t) value);
+	set_field(builder, index);
+}
+
+BT_HIDDEN
+void flatbuf_add_i32(struct flatbuf_builder *builder, unsigned int index,
+		int32_t value)
+{
+	prep(builder, sizeof(value), 0);
+	push_u32(builder, (uint32_t) value);
+	set_field(builder, index);
+}
+
+BT_HIDDEN
+void flatbuf_add_i64(struct flatbuf_builder *builder, unsigned int index,
+		int64_t value)
+{
+	prep(builder, sizeof(value), 0);
+	push_i64(builder, value);
+	set_field(builder, index);
+}
+
+BT_HIDDEN
+void flatbuf_add_ref(struct flatbuf_builder *builder, unsigned int index,
+		flatbuf_ref ref)
+{
+	push_offset(builder, ref);
+	set_field(builder, index);
+}
+
+BT_HIDDEN
+flatbuf_ref flatbuf_end_table(struct flatbuf_builder *builder)
+{
+	uint32_t table_ref;
+	uint32_t vtable_ref;
+	int32_t soffset;
+	unsigned int i;
+
+	BT_ASSERT_DBG(builder->table.in_progress);
+
+	/* Offset to the vtable, set below */
+	prep(builder, sizeof(int32_t), 0);
+	push_u32(builder, 0);
+	table_ref = built_size(builder);
+
+	/* Field offsets, relative to the beginning of the table */
+	for (i = builder->table.field_count; i > 0; i--) {
+		uint32_t field_ref = builder->table.fields[i - 1];
+
+		push_u16(builder,
+			field_ref ? (uint16_t) (table_ref - field_ref) : 0);
+	}
+
+	push_u16(builder, (uint16_t) (table_ref - builder->table.start));
+	push_u16(builder,
+		(uint16_t) ((builder->table.field_count + 2) * sizeof(uint16_t)));
+	vtable_ref = built_size(builder);
+
+	/* The vtable precedes the table */
+	soffset = GINT32_TO_LE((int32_t) (vtable_ref - table_ref));
+	memcpy(&builder->buf[builder->capacity - table_ref], &soffset,
+		sizeof(soffset));
+	builder->table.in_progress = false;
+	return table_ref;
+}
+
+BT_HIDDEN
+void flatbuf_finish(struct flatbuf_builder *builder, flatbuf_ref root,
+		const uint8_t **data, size_t *size)
+{
+	BT_ASSERT_DBG(!builder->table.in_progress);
+	prep(builder, builder->min_align, sizeof(uint32_t));
+	push_offset(builder, root);
+	*data = &builder->buf[builder->head];
+	*size = built_size(builder);
+}
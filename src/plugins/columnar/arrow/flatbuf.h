@@ -0,0 +1,135 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_COLUMNAR_ARROW_FLATBUF_H
+#define BABELTRACE_PLUGIN_COLUMNAR_ARROW_FLATBUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common/macros.h"
+
+/*
+ * Minimal FlatBuffers builder, enough to encode the metadata of Arrow
+ * IPC messages.
+ *
+ * Like the reference implementation, the builder writes the buffer
+ * from its end to its beginning: you build the children of an object
+ * (strings, vectors, tables) before the object itself. A reference to
+ * an object (`flatbuf_ref`) is its distance from the end of the
+ * buffer, which doesn't change when the buffer grows.
+ *
+ * The builder doesn't share identical vtables: the result is bigger,
+ * but still valid.
+ */
+
+/* Maximum number of fields of a table */
+#define FLATBUF_MAX_TABLE_FIELDS	16
+
+typedef uint32_t flatbuf_ref;
+
+struct flatbuf_builder {
+	/* `buf[head]` to `buf[capacity - 1]`: built data (owned by this) */
+	uint8_t *buf;
+	size_t capacity;
+	size_t head;
+
+	/* Largest alignment requirement of the built data */
+	size_t min_align;
+
+	/* Table being built */
+	struct {
+		bool in_progress;
+
+		/* Size of the built data when the table started */
+		uint32_t start;
+
+		/*
+		 * Reference of each field (0: not set), by field index
+		 * (vtable slot)
+		 */
+		uint32_t fields[FLATBUF_MAX_TABLE_FIELDS];
+
+		/* One more than the greatest index of a set field */
+		unsigned int field_count;
+	} table;
+};
+
+BT_HIDDEN
+void flatbuf_builder_init(struct flatbuf_builder *builder);
+
+BT_HIDDEN
+void flatbuf_builder_fini(struct flatbuf_builder *builder);
+
+/*
+ * Resets `builder` to build a new buffer, keeping its memory.
+ */
+BT_HIDDEN
+void flatbuf_builder_reset(struct flatbuf_builder *builder);
+
+BT_HIDDEN
+flatbuf_ref flatbuf_create_string(struct flatbuf_builder *builder,
+		const char *str);
+
+/*
+ * Creates a vector of the `count` object references `refs`.
+ */
+BT_HIDDEN
+flatbuf_ref flatbuf_create_ref_vector(struct flatbuf_builder *builder,
+		const flatbuf_ref *refs, size_t count);
+
+/*
+ * Creates a vector of `count` structures of two 64-bit signed integers
+ * (`values[0]`, `values[1]`, `values[2]`, and so on), like the
+ * `FieldNode` and `Buffer` structures of Arrow.
+ */
+BT_HIDDEN
+flatbuf_ref flatbuf_create_i64_pair_vector(struct flatbuf_builder *builder,
+		const int64_t *values, size_t count);
+
+BT_HIDDEN
+void flatbuf_start_table(struct flatbuf_builder *builder);
+
+BT_HIDDEN
+void flatbuf_add_bool(struct flatbuf_builder *builder, unsigned int index,
+		bool value);
+
+BT_HIDDEN
+void flatbuf_add_u8(struct flatbuf_builder *builder, unsigned int index,
+		uint8_t value);
+
+BT_HIDDEN
+void flatbuf_add_i16(struct flatbuf_builder *builder, unsigned int index,
+		int16_t value);
+
+BT_HIDDEN
+void flatbuf_add_i32(struct flatbuf_builder *builder, unsigned int index,
+		int32_t value);
+
+BT_HIDDEN
+void flatbuf_add_i64(struct flatbuf_builder *builder, unsigned int index,
+		int64_t value);
+
+BT_HIDDEN
+void flatbuf_add_ref(struct flatbuf_builder *builder, unsigned int index,
+		flatbuf_ref ref);
+
+BT_HIDDEN
+flatbuf_ref flatbuf_end_table(struct flatbuf_builder *builder);
+
+/*
+ * Finishes the buffer of `builder` with the root table `root`.
+ *
+ * Sets `*data` and `*size` to the finished buffer, which belongs to
+ * `builder` until the next reset. Its size is a multiple of the
+ * largest alignment requirement of its content, so that the content is
+ * aligned when the buffer is.
+ */
+BT_HIDDEN
+void flatbuf_finish(struct flatbuf_builder *builder, flatbuf_ref root,
+		const uint8_t **data, size_t *size);
+
+#endif /* BABELTRACE_PLUGIN_COLUMNAR_ARROW_FLATBUF_H */
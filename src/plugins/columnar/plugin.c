@@ -0,0 +1,28 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "arrow/arrow.h"
+
+#ifndef BT_BUILT_IN_PLUGINS
+BT_PLUGIN_MODULE();
+#endif
+
+BT_PLUGIN(columnar);
+BT_PLUGIN_DESCRIPTION("Columnar output for analytics");
+BT_PLUGIN_AUTHOR("EfficiOS <https://www.efficios.com/>");
+BT_PLUGIN_LICENSE("MIT");
+
+/* arrow sink */
+BT_PLUGIN_SINK_COMPONENT_CLASS(arrow, arrow_sink_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_INITIALIZE_METHOD(arrow, arrow_sink_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(arrow, arrow_sink_finalize);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(arrow,
+	arrow_sink_graph_is_configured);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(arrow,
+	"Write events as Apache Arrow IPC streams, one per event class.");
+BT_PLUGIN_SINK_COMPONENT_CLASS_HELP(arrow,
+	"See the babeltrace2-sink.columnar.arrow(7) manual page.");
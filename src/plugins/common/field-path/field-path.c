@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "common/macros.h"
+
+#include "field-path.h"
+
+BT_HIDDEN
+bool common_field_path_parse(const char *str,
+		struct common_field_path *field_path)
+{
+	static const struct {
+		const char *name;
+		enum common_field_path_scope scope;
+	} scopes[] = {
+		{ "common-context", COMMON_FIELD_PATH_SCOPE_COMMON_CONTEXT },
+		{ "specific-context", COMMON_FIELD_PATH_SCOPE_SPECIFIC_CONTEXT },
+		{ "payload", COMMON_FIELD_PATH_SCOPE_PAYLOAD },
+	};
+	gchar **parts = g_strsplit(str, ".", 0);
+	bool found_scope = false;
+	size_t i;
+
+	if (!parts[0] || !parts[1]) {
+		goto error;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(scopes); i++) {
+		if (strcmp(parts[0], scopes[i].name) == 0) {
+			field_path->scope = scopes[i].scope;
+			found_scope = true;
+			break;
+		}
+	}
+
+	if (!found_scope) {
+		goto error;
+	}
+
+	for (i = 1; parts[i]; i++) {
+		if (parts[i][0] == '\0') {
+			goto error;
+		}
+	}
+
+	/* Keep the member names only */
+	field_path->str = g_strdup(str);
+	field_path->names = g_strdupv(&parts[1]);
+	g_strfreev(parts);
+	return true;
+
+error:
+	g_strfreev(parts);
+	return false;
+}
+
+BT_HIDDEN
+void common_field_path_fini(struct common_field_path *field_path)
+{
+	g_free(field_path->str);
+	field_path->str = NULL;
+	g_strfreev(field_path->names);
+	field_path->names = NULL;
+}
+
+static
+const bt_field_class *borrow_scope_field_class(const bt_event_class *ec,
+		enum common_field_path_scope scope)
+{
+	switch (scope) {
+	case COMMON_FIELD_PATH_SCOPE_COMMON_CONTEXT:
+		return bt_stream_class_borrow_event_common_context_field_class_const(
+			bt_event_class_borrow_stream_class_const(ec));
+	case COMMON_FIELD_PATH_SCOPE_SPECIFIC_CONTEXT:
+		return bt_event_class_borrow_specific_context_field_class_const(
+			ec);
+	case COMMON_FIELD_PATH_SCOPE_PAYLOAD:
+		return bt_event_class_borrow_payload_field_class_const(ec);
+	default:
+		bt_common_abort();
+	}
+}
+
+static
+const bt_field *borrow_scope_field(const bt_event *event,
+		enum common_field_path_scope scope)
+{
+	switch (scope) {
+	case COMMON_FIELD_PATH_SCOPE_COMMON_CONTEXT:
+		return bt_event_borrow_common_context_field_const(event);
+	case COMMON_FIELD_PATH_SCOPE_SPECIFIC_CONTEXT:
+		return bt_event_borrow_specific_context_field_const(event);
+	case COMMON_FIELD_PATH_SCOPE_PAYLOAD:
+		return bt_event_borrow_payload_field_const(event);
+	default:
+		bt_common_abort();
+	}
+}
+
+BT_HIDDEN
+bool common_field_path_resolve(const struct common_field_path *field_path,
+		const bt_event_class *ec,
+		struct common_resolved_field_path *resolved_path)
+{
+	const bt_field_class *fc = borrow_scope_field_class(ec,
+		field_path->scope);
+	gchar **name;
+
+	resolved_path->scope = field_path->scope;
+	resolved_path->indexes = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+
+	for (name = field_path->names; *name; name++) {
+		uint64_t index, count;
+
+		if (!fc || bt_field_class_get_type(fc) !=
+				BT_FIELD_CLASS_TYPE_STRUCTURE) {
+			break;
+		}
+
+		count = bt_field_class_structure_get_member_count(fc);
+
+		for (index = 0; index < count; index++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, index);
+
+			if (strcmp(bt_field_class_structure_member_get_name(
+					member), *name) == 0) {
+				fc = bt_field_class_structure_member_borrow_field_class_const(
+					member);
+				break;
+			}
+		}
+
+		if (index == count) {
+			break;
+		}
+
+		g_array_append_val(resolved_path->indexes, index);
+	}
+
+	return !*name;
+}
+
+BT_HIDDEN
+void common_resolved_field_path_fini(
+		struct common_resolved_field_path *resolved_path)
+{
+	if (resolved_path->indexes) {
+		g_array_free(resolved_path->indexes, TRUE);
+		resolved_path->indexes = NULL;
+	}
+}
+
+BT_HIDDEN
+const bt_field *common_field_path_borrow_field(const bt_event *event,
+		const struct common_resolved_field_path *resolved_path)
+{
+	const bt_field *field = borrow_scope_field(event, resolved_path->scope);
+	guint i;
+
+	for (i = 0; i < resolved_path->indexes->len; i++) {
+		BT_ASSERT_DBG(field);
+		field = bt_field_structure_borrow_member_field_by_index_const(
+			field, g_array_index(resolved_path->indexes, uint64_t,
+				i));
+	}
+
+	return field;
+}
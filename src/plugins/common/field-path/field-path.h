@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_COMMON_FIELD_PATH_H
+#define BABELTRACE_PLUGIN_COMMON_FIELD_PATH_H
+
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+#include <stdbool.h>
+#include "common/macros.h"
+
+enum common_field_path_scope {
+	COMMON_FIELD_PATH_SCOPE_COMMON_CONTEXT,
+	COMMON_FIELD_PATH_SCOPE_SPECIFIC_CONTEXT,
+	COMMON_FIELD_PATH_SCOPE_PAYLOAD,
+};
+
+/*
+ * Event field path, as given with a component parameter
+ * (`SCOPE.NAME[.NAME]...`)
+ */
+struct common_field_path {
+	/* Original string */
+	gchar *str;
+
+	enum common_field_path_scope scope;
+
+	/* Null-terminated array of structure member names */
+	gchar **names;
+};
+
+/* Field path of `struct common_field_path` for a given event class */
+struct common_resolved_field_path {
+	enum common_field_path_scope scope;
+
+	/* Array of `uint64_t` structure member indexes */
+	GArray *indexes;
+};
+
+/*
+ * Parses the field path `str` into `field_path`.
+ *
+ * Returns false if `str` is not a valid field path.
+ */
+BT_HIDDEN
+bool common_field_path_parse(const char *str,
+		struct common_field_path *field_path);
+
+BT_HIDDEN
+void common_field_path_fini(struct common_field_path *field_path);
+
+/*
+ * Resolves `field_path` for the event class `ec` into structure
+ * member indexes, so that reading a field of an event is a few index
+ * lookups.
+ *
+ * Returns false if `field_path` doesn't exist for `ec`. In both cases,
+ * call common_resolved_field_path_fini() on `resolved_path` when done.
+ */
+BT_HIDDEN
+bool common_field_path_resolve(const struct common_field_path *field_path,
+		const bt_event_class *ec,
+		struct common_resolved_field_path *resolved_path);
+
+BT_HIDDEN
+void common_resolved_field_path_fini(
+		struct common_resolved_field_path *resolved_path);
+
+/*
+ * Borrows the field of `event` at `resolved_path`, which must exist
+ * for the class of `event`.
+ */
+BT_HIDDEN
+const bt_field *common_field_path_borrow_field(const bt_event *event,
+		const struct common_resolved_field_path *resolved_path);
+
+#endif /* BABELTRACE_PLUGIN_COMMON_FIELD_PATH_H */
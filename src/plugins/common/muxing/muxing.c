@@ -841,6 +841,21 @@ int common_muxing_compare_messages(const bt_message *left_msg,
 	msgs.right.trace = borrow_trace(right_msg);
 	msgs.right.stream = borrow_stream(right_msg);
 
+	/*
+	 * Messages of the same stream (or without streams) have the same
+	 * trace UUID, trace name, stream class ID, and stream ID: skip
+	 * those comparisons. This is the common case when one upstream
+	 * message iterator sends many messages with the same timestamp.
+	 */
+	if (msgs.left.stream == msgs.right.stream) {
+		goto compare_types;
+	}
+
+	/* Same trace: same trace UUID and name */
+	if (msgs.left.trace == msgs.right.trace) {
+		goto compare_stream_classes;
+	}
+
 	/* Same timestamp: compare trace UUIDs. */
 	ret = compare_messages_by_trace_uuid(&msgs);
 	if (ret) {
@@ -853,6 +868,8 @@ int common_muxing_compare_messages(const bt_message *left_msg,
 		goto end;
 	}
 
+compare_stream_classes:
+
 	/*
 	 * Same timestamp, trace name, and trace UUID: compare stream class
 	 * IDs.
@@ -871,6 +888,7 @@ int common_muxing_compare_messages(const bt_message *left_msg,
 		goto end;
 	}
 
+compare_types:
 	if (bt_message_get_type(msgs.left.msg) !=
 			bt_message_get_type(msgs.right.msg)) {
 		/*
@@ -141,6 +141,13 @@ struct bt_bfcr {
 		size_t buf_sz;
 	} buf;
 
+	/*
+	 * Scratch buffer (`uint64_t` elements) in which
+	 * read_int_array_elems() decodes a run of integer array
+	 * elements in bulk.
+	 */
+	GArray *int_array_values;
+
 	/* User stuff */
 	struct {
 		/* Callback functions */
@@ -447,17 +454,65 @@ void stitch_set_from_remaining_buf(struct bt_bfcr *bfcr)
 	stitch_append_from_remaining_buf(bfcr);
 }
 
+/*
+ * Reads the `field_size`-bit unsigned bit array at the bit offset `at`
+ * within `buf` with a single 64-bit load, shift, and mask.
+ *
+ * A bit array which doesn't cross a 64-bit window starting at its first
+ * byte is the common case: this covers all the bit-packed fields of an
+ * event header (an LTTng compact event header, for example) as well as
+ * all the byte-aligned integer fields.
+ *
+ * Returns false without reading anything if the bit array crosses the
+ * window or if there are fewer than eight bytes from its first byte to
+ * the end of `buf` (`buf_sz` bytes).
+ */
 static inline
-void read_unsigned_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf, size_t at,
-		unsigned int field_size, enum ctf_byte_order bo,
+bool read_unsigned_bitfield_fast(const uint8_t *buf, size_t buf_sz,
+		size_t at, unsigned int field_size, enum ctf_byte_order bo,
 		uint64_t *v)
+{
+	const size_t byte_at = at / 8;
+	const unsigned int bit_at = at % 8;
+	uint64_t word;
+
+	if (G_UNLIKELY(bit_at + field_size > 64 || byte_at + 8 > buf_sz)) {
+		return false;
+	}
+
+	memcpy(&word, &buf[byte_at], sizeof(word));
+
+	if (bo == CTF_BYTE_ORDER_BIG) {
+		word = GUINT64_FROM_BE(word) >> (64 - bit_at - field_size);
+	} else {
+		word = GUINT64_FROM_LE(word) >> bit_at;
+	}
+
+	if (field_size < 64) {
+		word &= (UINT64_C(1) << field_size) - 1;
+	}
+
+	*v = word;
+	return true;
+}
+
+static inline
+void read_unsigned_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf,
+		size_t buf_sz, size_t at, unsigned int field_size,
+		enum ctf_byte_order bo, uint64_t *v)
 {
 	switch (bo) {
 	case CTF_BYTE_ORDER_BIG:
-		bt_bitfield_read_be(buf, uint8_t, at, field_size, v);
+		if (!read_unsigned_bitfield_fast(buf, buf_sz, at, field_size,
+				CTF_BYTE_ORDER_BIG, v)) {
+			bt_bitfield_read_be(buf, uint8_t, at, field_size, v);
+		}
 		break;
 	case CTF_BYTE_ORDER_LITTLE:
-		bt_bitfield_read_le(buf, uint8_t, at, field_size, v);
+		if (!read_unsigned_bitfield_fast(buf, buf_sz, at, field_size,
+				CTF_BYTE_ORDER_LITTLE, v)) {
+			bt_bitfield_read_le(buf, uint8_t, at, field_size, v);
+		}
 		break;
 	default:
 		bt_common_abort();
@@ -468,26 +523,49 @@ void read_unsigned_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf, size_t at,
 }
 
 static inline
-void read_signed_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf, size_t at,
-		unsigned int field_size, enum ctf_byte_order bo, int64_t *v)
+void read_signed_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf,
+		size_t buf_sz, size_t at, unsigned int field_size,
+		enum ctf_byte_order bo, int64_t *v)
 {
+	uint64_t uv;
+
 	switch (bo) {
 	case CTF_BYTE_ORDER_BIG:
+		if (read_unsigned_bitfield_fast(buf, buf_sz, at, field_size,
+				CTF_BYTE_ORDER_BIG, &uv)) {
+			goto sign_extend;
+		}
+
 		bt_bitfield_read_be(buf, uint8_t, at, field_size, v);
 		break;
 	case CTF_BYTE_ORDER_LITTLE:
+		if (read_unsigned_bitfield_fast(buf, buf_sz, at, field_size,
+				CTF_BYTE_ORDER_LITTLE, &uv)) {
+			goto sign_extend;
+		}
+
 		bt_bitfield_read_le(buf, uint8_t, at, field_size, v);
 		break;
 	default:
 		bt_common_abort();
 	}
 
+	goto end;
+
+sign_extend:
+	if (field_size < 64 && (uv & (UINT64_C(1) << (field_size - 1)))) {
+		uv |= ~UINT64_C(0) << field_size;
+	}
+
+	*v = (int64_t) uv;
+
+end:
 	BT_COMP_LOGT("Read signed bit array: cur=%zu, size=%u, "
 		"bo=%d, val=%" PRId64, at, field_size, bo, *v);
 }
 
 typedef enum bt_bfcr_status (* read_basic_and_call_cb_t)(struct bt_bfcr *,
-		const uint8_t *, size_t);
+		const uint8_t *, size_t, size_t);
 
 static inline
 enum bt_bfcr_status validate_contiguous_bo(struct bt_bfcr *bfcr,
@@ -538,7 +616,7 @@ end:
 
 static
 enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
-		const uint8_t *buf, size_t at)
+		const uint8_t *buf, size_t buf_sz, size_t at)
 {
 	double dblval;
 	unsigned int field_size;
@@ -560,7 +638,8 @@ enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
 			float f;
 		} f32;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_unsigned_bitfield(bfcr, buf, buf_sz, at, field_size, bo,
+			&v);
 		f32.u = (uint32_t) v;
 		dblval = (double) f32.f;
 		break;
@@ -572,7 +651,8 @@ enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
 			double d;
 		} f64;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &f64.u);
+		read_unsigned_bitfield(bfcr, buf, buf_sz, at, field_size, bo,
+			&f64.u);
 		dblval = f64.d;
 		break;
 	}
@@ -601,7 +681,7 @@ enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
 
 static inline
 enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
-		const uint8_t *buf, size_t at)
+		const uint8_t *buf, size_t buf_sz, size_t at)
 {
 	unsigned int field_size;
 	enum ctf_byte_order bo;
@@ -621,7 +701,8 @@ enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
 	if (fc->is_signed) {
 		int64_t v;
 
-		read_signed_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_signed_bitfield(bfcr, buf, buf_sz, at, field_size, bo,
+			&v);
 
 		if (bfcr->user.cbs.classes.signed_int) {
 			BT_COMP_LOGT("Calling user function (signed integer).");
@@ -638,7 +719,8 @@ enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
 	} else {
 		uint64_t v;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_unsigned_bitfield(bfcr, buf, buf_sz, at, field_size, bo,
+			&v);
 
 		if (bfcr->user.cbs.classes.unsigned_int) {
 			BT_COMP_LOGT("Calling user function (unsigned integer).");
@@ -683,7 +765,7 @@ enum bt_bfcr_status read_bit_array_class_and_call_continue(struct bt_bfcr *bfcr,
 		/* We have all the bits; append to stitch, then decode */
 		stitch_append_from_buf(bfcr, needed_bits);
 		status = read_basic_and_call_cb(bfcr, bfcr->stitch.buf,
-			bfcr->stitch.offset);
+			sizeof(bfcr->stitch.buf), bfcr->stitch.offset);
 		if (status != BT_BFCR_STATUS_OK) {
 			BT_COMP_LOGW("Cannot read basic field: "
 				"bfcr-addr=%p, fc-addr=%p, status=%s",
@@ -740,7 +822,7 @@ enum bt_bfcr_status read_bit_array_class_and_call_begin(struct bt_bfcr *bfcr,
 		/* We have all the bits; decode and set now */
 		BT_ASSERT_DBG(bfcr->buf.addr);
 		status = read_basic_and_call_cb(bfcr, bfcr->buf.addr,
-			buf_at_from_addr(bfcr));
+			bfcr->buf.buf_sz, buf_at_from_addr(bfcr));
 		if (status != BT_BFCR_STATUS_OK) {
 			BT_COMP_LOGW("Cannot read basic field: "
 				"bfcr-addr=%p, fc-addr=%p, status=%s",
@@ -1023,6 +1105,339 @@ end:
 	return status;
 }
 
+static inline
+void decode_int_array_elems(const uint8_t *buf, uint64_t count,
+		unsigned int size, enum ctf_byte_order bo, bool is_signed,
+		uint64_t *values)
+{
+	uint64_t i;
+
+	/*
+	 * Those are plain loops on purpose: the compiler can vectorize
+	 * them, including the byte swapping.
+	 */
+	switch (size) {
+	case 8:
+		if (is_signed) {
+			for (i = 0; i < count; i++) {
+				values[i] = (uint64_t) (int64_t) (int8_t) buf[i];
+			}
+		} else {
+			for (i = 0; i < count; i++) {
+				values[i] = buf[i];
+			}
+		}
+
+		break;
+	case 16:
+		for (i = 0; i < count; i++) {
+			uint16_t v;
+
+			memcpy(&v, &buf[i * 2], sizeof(v));
+			v = bo == CTF_BYTE_ORDER_BIG ?
+				GUINT16_FROM_BE(v) : GUINT16_FROM_LE(v);
+			values[i] = is_signed ?
+				(uint64_t) (int64_t) (int16_t) v : v;
+		}
+
+		break;
+	case 32:
+		for (i = 0; i < count; i++) {
+			uint32_t v;
+
+			memcpy(&v, &buf[i * 4], sizeof(v));
+			v = bo == CTF_BYTE_ORDER_BIG ?
+				GUINT32_FROM_BE(v) : GUINT32_FROM_LE(v);
+			values[i] = is_signed ?
+				(uint64_t) (int64_t) (int32_t) v : v;
+		}
+
+		break;
+	case 64:
+		for (i = 0; i < count; i++) {
+			uint64_t v;
+
+			memcpy(&v, &buf[i * 8], sizeof(v));
+			values[i] = bo == CTF_BYTE_ORDER_BIG ?
+				GUINT64_FROM_BE(v) : GUINT64_FROM_LE(v);
+		}
+
+		break;
+	default:
+		bt_common_abort();
+	}
+}
+
+/*
+ * Tries to decode, in one go, as many elements as possible of the
+ * current array or sequence field (top of the stack) starting at its
+ * current index, and to pass them to the user's integer array
+ * callback.
+ *
+ * This only applies when the elements are byte-aligned integers of
+ * 8, 16, 32, or 64 bits and when at least two of them are
+ * completely available in the current buffer. Sets `*done` to
+ * `false` when not applicable, in which case the caller reads the
+ * next element the regular way.
+ */
+static inline
+enum bt_bfcr_status read_int_array_elems(struct bt_bfcr *bfcr,
+		struct stack_entry *top, bool *done)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_array_base *array_fc = (void *) top->base_class;
+	struct ctf_field_class_int *int_fc = (void *) array_fc->elem_fc;
+	unsigned int size;
+	uint64_t count;
+	uint64_t *values;
+	const uint8_t *first;
+
+	*done = false;
+
+	if (array_fc->is_text) {
+		/* read_text_array_chars() handles text arrays */
+		goto end;
+	}
+
+	if (array_fc->elem_fc->type != CTF_FIELD_CLASS_TYPE_INT &&
+			array_fc->elem_fc->type != CTF_FIELD_CLASS_TYPE_ENUM) {
+		goto end;
+	}
+
+	if (int_fc->is_signed ? !bfcr->user.cbs.classes.signed_int_array :
+			!bfcr->user.cbs.classes.unsigned_int_array) {
+		goto end;
+	}
+
+	size = int_fc->base.size;
+
+	if (size != 8 && size != 16 && size != 32 && size != 64) {
+		goto end;
+	}
+
+	/*
+	 * With an alignment which is not greater than the element size,
+	 * the elements are contiguous once the first one is aligned.
+	 */
+	if (int_fc->base.base.alignment > size ||
+			packet_at(bfcr) % 8 != 0 ||
+			packet_at(bfcr) % int_fc->base.base.alignment != 0) {
+		goto end;
+	}
+
+	count = MIN((uint64_t) (top->base_len - top->index),
+		(uint64_t) (available_bits(bfcr) / size));
+	if (count < 2) {
+		goto end;
+	}
+
+	g_array_set_size(bfcr->int_array_values, count);
+	values = (uint64_t *) bfcr->int_array_values->data;
+	BT_ASSERT_DBG(bfcr->buf.addr);
+	first = &bfcr->buf.addr[BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr))];
+	decode_int_array_elems(first, count, size, int_fc->base.byte_order,
+		int_fc->is_signed, values);
+	BT_COMP_LOGT("Decoded integer array elements: bfcr-addr=%p, "
+		"fc-addr=%p, index=%" PRId64 ", count=%" PRIu64 ", size=%u",
+		bfcr, top->base_class, top->index, count, size);
+	bfcr->cur_basic_field_class = array_fc->elem_fc;
+	bfcr->cur_bo = int_fc->base.byte_order;
+
+	if (int_fc->is_signed) {
+		BT_COMP_LOGT("Calling user function (signed integer array).");
+		status = bfcr->user.cbs.classes.signed_int_array(
+			(const int64_t *) values, count, array_fc->elem_fc,
+			bfcr->user.data);
+	} else {
+		BT_COMP_LOGT("Calling user function (unsigned integer array).");
+		status = bfcr->user.cbs.classes.unsigned_int_array(values,
+			count, array_fc->elem_fc, bfcr->user.data);
+	}
+
+	BT_COMP_LOGT("User function returned: status=%s",
+		bt_bfcr_status_string(status));
+	if (status != BT_BFCR_STATUS_OK) {
+		BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+			bfcr, bt_bfcr_status_string(status));
+		goto end;
+	}
+
+	consume_bits(bfcr, count * size);
+	top->index += (int64_t) count;
+	bfcr->last_bo = bfcr->cur_bo;
+	*done = true;
+
+end:
+	return status;
+}
+
+/*
+ * Passes, in one go, as many characters as possible of the current
+ * text array or sequence field (top of the stack) starting at its
+ * current index to the user's text array callback, borrowing them
+ * directly from the user buffer.
+ *
+ * Sets `*done` to `false` when not applicable, in which case the
+ * caller reads the next character as a regular integer.
+ */
+static inline
+enum bt_bfcr_status read_text_array_chars(struct bt_bfcr *bfcr,
+		struct stack_entry *top, bool *done)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_array_base *array_fc = (void *) top->base_class;
+	struct ctf_field_class_int *int_fc = (void *) array_fc->elem_fc;
+	uint64_t count;
+
+	*done = false;
+
+	if (!array_fc->is_text || !bfcr->user.cbs.classes.text_array) {
+		goto end;
+	}
+
+	/* A text array's elements are always 8-bit, byte-aligned */
+	BT_ASSERT_DBG(int_fc->base.size == 8);
+	BT_ASSERT_DBG(int_fc->base.base.alignment == 8);
+
+	if (packet_at(bfcr) % 8 != 0) {
+		goto end;
+	}
+
+	count = MIN((uint64_t) (top->base_len - top->index),
+		(uint64_t) BITS_TO_BYTES_FLOOR(available_bits(bfcr)));
+	if (count == 0) {
+		goto end;
+	}
+
+	BT_ASSERT_DBG(bfcr->buf.addr);
+	bfcr->cur_basic_field_class = array_fc->elem_fc;
+	bfcr->cur_bo = int_fc->base.byte_order;
+	BT_COMP_LOGT("Calling user function (text array).");
+	status = bfcr->user.cbs.classes.text_array(
+		(const char *) &bfcr->buf.addr[
+			BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr))],
+		count, top->base_class, bfcr->user.data);
+	BT_COMP_LOGT("User function returned: status=%s",
+		bt_bfcr_status_string(status));
+	if (status != BT_BFCR_STATUS_OK) {
+		BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+			bfcr, bt_bfcr_status_string(status));
+		goto end;
+	}
+
+	consume_bits(bfcr, BYTES_TO_BITS(count));
+	top->index += (int64_t) count;
+	bfcr->last_bo = bfcr->cur_bo;
+	*done = true;
+
+end:
+	return status;
+}
+
+/*
+ * Reads, in one go, as many consecutive string members of the current
+ * structure field (top of the stack) as possible, starting at its
+ * current index, as long as each one is completely within the user
+ * buffer. This avoids going through all the states for each string of
+ * string-heavy payloads.
+ *
+ * Sets `*done` to `false` when the member at the current index is not
+ * a string which is completely available, in which case the caller
+ * reads it through the regular states.
+ */
+static inline
+enum bt_bfcr_status read_struct_string_members(struct bt_bfcr *bfcr,
+		struct stack_entry *top, bool *done)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_struct *struct_fc = (void *) top->base_class;
+
+	*done = false;
+
+	if (packet_at(bfcr) % 8 != 0) {
+		goto end;
+	}
+
+	while (top->index < top->base_len) {
+		struct ctf_field_class *member_fc =
+			ctf_field_class_struct_borrow_member_by_index(
+				struct_fc, (uint64_t) top->index)->fc;
+		const char *first_chr;
+		const char *result;
+		size_t len;
+
+		if (member_fc->type != CTF_FIELD_CLASS_TYPE_STRING ||
+				!at_least_one_bit_left(bfcr)) {
+			goto end;
+		}
+
+		/* A string is always byte-aligned */
+		BT_ASSERT_DBG(member_fc->alignment == 8);
+		BT_ASSERT_DBG(buf_at_from_addr(bfcr) % 8 == 0);
+		BT_ASSERT_DBG(bfcr->buf.addr);
+		first_chr = (const char *) &bfcr->buf.addr[
+			BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr))];
+		result = memchr(first_chr, '\0',
+			BITS_TO_BYTES_FLOOR(available_bits(bfcr)));
+		if (!result) {
+			/* Let the regular states handle a partial string */
+			goto end;
+		}
+
+		len = (size_t) (result - first_chr);
+		bfcr->cur_basic_field_class = member_fc;
+
+		if (bfcr->user.cbs.classes.string_begin) {
+			BT_COMP_LOGT("Calling user function (string, beginning).");
+			status = bfcr->user.cbs.classes.string_begin(
+				member_fc, bfcr->user.data);
+			BT_COMP_LOGT("User function returned: status=%s",
+				bt_bfcr_status_string(status));
+			if (status != BT_BFCR_STATUS_OK) {
+				BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+					bfcr, bt_bfcr_status_string(status));
+				goto end;
+			}
+		}
+
+		if (bfcr->user.cbs.classes.string && len) {
+			BT_COMP_LOGT("Calling user function (substring).");
+			status = bfcr->user.cbs.classes.string(first_chr, len,
+				member_fc, bfcr->user.data);
+			BT_COMP_LOGT("User function returned: status=%s",
+				bt_bfcr_status_string(status));
+			if (status != BT_BFCR_STATUS_OK) {
+				BT_COMP_LOGW("User function failed: "
+					"bfcr-addr=%p, status=%s",
+					bfcr, bt_bfcr_status_string(status));
+				goto end;
+			}
+		}
+
+		if (bfcr->user.cbs.classes.string_end) {
+			BT_COMP_LOGT("Calling user function (string, end).");
+			status = bfcr->user.cbs.classes.string_end(
+				member_fc, bfcr->user.data);
+			BT_COMP_LOGT("User function returned: status=%s",
+				bt_bfcr_status_string(status));
+			if (status != BT_BFCR_STATUS_OK) {
+				BT_COMP_LOGW("User function failed: "
+					"bfcr-addr=%p, status=%s",
+					bfcr, bt_bfcr_status_string(status));
+				goto end;
+			}
+		}
+
+		consume_bits(bfcr, BYTES_TO_BITS(len + 1));
+		top->index++;
+		bfcr->last_bo = bfcr->cur_bo;
+		*done = true;
+	}
+
+end:
+	return status;
+}
+
 static inline
 enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 {
@@ -1067,14 +1482,46 @@ enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 	/* Get next field's class */
 	switch (top->base_class->type) {
 	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		bool done;
+
+		status = read_struct_string_members(bfcr, top, &done);
+		if (status != BT_BFCR_STATUS_OK) {
+			/* read_struct_string_members() logs errors */
+			goto end;
+		}
+
+		if (done) {
+			/* Stay in this state: maybe there's more */
+			goto end;
+		}
+
 		next_field_class = ctf_field_class_struct_borrow_member_by_index(
 			(void *) top->base_class, (uint64_t) top->index)->fc;
 		break;
+	}
 	case CTF_FIELD_CLASS_TYPE_ARRAY:
 	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
 	{
 		struct ctf_field_class_array_base *array_fc =
 			(void *) top->base_class;
+		bool done;
+
+		if (array_fc->is_text) {
+			status = read_text_array_chars(bfcr, top, &done);
+		} else {
+			status = read_int_array_elems(bfcr, top, &done);
+		}
+
+		if (status != BT_BFCR_STATUS_OK) {
+			/* read_*() logs errors */
+			goto end;
+		}
+
+		if (done) {
+			/* Stay in this state: maybe there's more */
+			goto end;
+		}
 
 		next_field_class = array_fc->elem_fc;
 		break;
@@ -1198,6 +1645,14 @@ struct bt_bfcr *bt_bfcr_create(struct bt_bfcr_cbs cbs, void *data,
 		goto end;
 	}
 
+	bfcr->int_array_values = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	if (!bfcr->int_array_values) {
+		BT_COMP_LOGE_STR("Failed to allocate a GArray.");
+		bt_bfcr_destroy(bfcr);
+		bfcr = NULL;
+		goto end;
+	}
+
 	bfcr->state = BFCR_STATE_NEXT_FIELD;
 	bfcr->user.cbs = cbs;
 	bfcr->user.data = data;
@@ -1214,6 +1669,10 @@ void bt_bfcr_destroy(struct bt_bfcr *bfcr)
 		stack_destroy(bfcr->stack);
 	}
 
+	if (bfcr->int_array_values) {
+		g_array_free(bfcr->int_array_values, TRUE);
+	}
+
 	BT_COMP_LOGD("Destroying BFCR: addr=%p", bfcr);
 	g_free(bfcr);
 }
@@ -128,6 +128,72 @@ struct bt_bfcr_cbs {
 		 */
 		bt_bfcr_unsigned_int_cb_func unsigned_int;
 
+		/**
+		 * Called when a contiguous run of elements of an
+		 * array or sequence class is completely decoded, when
+		 * the elements are byte-aligned, signed integers of 8,
+		 * 16, 32, or 64 bits which are all available in the
+		 * current buffer.
+		 *
+		 * If this is \c NULL, bt_bfcr_cbs::classes::signed_int()
+		 * is called for each element instead.
+		 *
+		 * @param values	Signed integer values
+		 * @param count		Number of values in \p values
+		 * @param class		Integer or enumeration class of
+		 *			the elements
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* signed_int_array)(
+				const int64_t *values, uint64_t count,
+				struct ctf_field_class *cls, void *data);
+
+		/**
+		 * Unsigned integer version of
+		 * bt_bfcr_cbs::classes::signed_int_array().
+		 *
+		 * If this is \c NULL,
+		 * bt_bfcr_cbs::classes::unsigned_int() is called for
+		 * each element instead.
+		 *
+		 * @param values	Unsigned integer values
+		 * @param count		Number of values in \p values
+		 * @param class		Integer or enumeration class of
+		 *			the elements
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* unsigned_int_array)(
+				const uint64_t *values, uint64_t count,
+				struct ctf_field_class *cls, void *data);
+
+		/**
+		 * Called when a contiguous run of characters of a text
+		 * array or sequence class is available in the current
+		 * buffer.
+		 *
+		 * \p chars points directly within the user buffer and
+		 * is only valid during this call. It can contain null
+		 * characters.
+		 *
+		 * If this is \c NULL,
+		 * bt_bfcr_cbs::classes::unsigned_int() is called for
+		 * each character instead.
+		 *
+		 * @param chars		Characters
+		 * @param count		Number of characters in \p chars
+		 * @param class		Text array or sequence class
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* text_array)(const char *chars,
+				uint64_t count, struct ctf_field_class *cls,
+				void *data);
+
 		/**
 		 * Called when a floating point number class is
 		 * completely decoded.
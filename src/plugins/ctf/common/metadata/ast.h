@@ -323,6 +323,35 @@ BT_HIDDEN
 struct ctf_trace_class *ctf_visitor_generate_ir_borrow_ctf_trace_class(
 		struct ctf_visitor_generate_ir *visitor);
 
+/*
+ * Replaces the empty CTF IR trace class of `visitor` with `ctf_tc`
+ * (taking its ownership), for example as read from a snapshot, as if
+ * ctf_visitor_generate_ir_visit_ast() had just created it.
+ */
+BT_HIDDEN
+void ctf_visitor_generate_ir_set_ctf_trace_class(
+		struct ctf_visitor_generate_ir *visitor,
+		struct ctf_trace_class *ctf_tc);
+
+/*
+ * Visits the AST `node`, adding the classes it declares to the CTF IR
+ * trace class of `visitor` without updating nor translating them.
+ */
+BT_HIDDEN
+int ctf_visitor_generate_ir_visit_ast(struct ctf_visitor_generate_ir *visitor,
+		struct ctf_node *node);
+
+/*
+ * Updates, validates, and translates the new classes of the CTF IR
+ * trace class of `visitor`.
+ */
+BT_HIDDEN
+int ctf_visitor_generate_ir_finish(struct ctf_visitor_generate_ir *visitor);
+
+/*
+ * Calls ctf_visitor_generate_ir_visit_ast(), and then
+ * ctf_visitor_generate_ir_finish().
+ */
 BT_HIDDEN
 int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		struct ctf_node *node);
@@ -0,0 +1,953 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (log_cfg->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (log_cfg->log_level)
+#define BT_LOG_TAG "PLUGIN/CTF/META/SNAPSHOT"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ctf-meta-visitors.h"
+#include "logging.h"
+
+/*
+ * A metadata snapshot is the content of a CTF IR trace class, as the
+ * metadata AST visitor fills it, before the update passes.
+ *
+ * All the values are in the native byte order: a snapshot written on a
+ * machine with another byte order has an unexpected magic number and
+ * is ignored.
+ *
+ * The snapshot only contains what the AST visitor sets; what the
+ * update passes compute (meanings, "in IR" flags, resolved field
+ * paths, stored value indexes, default clock classes, and so on) is
+ * computed again after reading it.
+ */
+#define SNAPSHOT_MAGIC		0xc1fc5a9e
+#define SNAPSHOT_VERSION	1
+
+/* Field class type tag of an absent field class */
+#define SNAPSHOT_NO_FC		UINT8_C(0xff)
+
+/* String length of an absent string */
+#define SNAPSHOT_NO_STR		UINT32_MAX
+
+/*
+ * Maximum nesting level of field classes, to protect the reader
+ * against a corrupted snapshot.
+ */
+#define SNAPSHOT_MAX_FC_DEPTH	256
+
+struct snapshot_writer {
+	GByteArray *buf;
+
+	/* Weak */
+	struct ctf_trace_class *tc;
+};
+
+struct snapshot_reader {
+	const uint8_t *buf;
+	size_t len;
+	size_t at;
+
+	/* True if the snapshot is truncated or invalid */
+	bool error;
+
+	/* Weak */
+	struct ctf_trace_class *tc;
+};
+
+static inline
+void write_bytes(struct snapshot_writer *writer, const void *data,
+		size_t len)
+{
+	g_byte_array_append(writer->buf, data, (guint) len);
+}
+
+static inline
+void write_u8(struct snapshot_writer *writer, uint8_t val)
+{
+	write_bytes(writer, &val, sizeof(val));
+}
+
+static inline
+void write_u32(struct snapshot_writer *writer, uint32_t val)
+{
+	write_bytes(writer, &val, sizeof(val));
+}
+
+static inline
+void write_u64(struct snapshot_writer *writer, uint64_t val)
+{
+	write_bytes(writer, &val, sizeof(val));
+}
+
+static inline
+void write_i64(struct snapshot_writer *writer, int64_t val)
+{
+	write_bytes(writer, &val, sizeof(val));
+}
+
+static inline
+void write_bool(struct snapshot_writer *writer, bool val)
+{
+	write_u8(writer, val ? 1 : 0);
+}
+
+static inline
+void write_str(struct snapshot_writer *writer, const GString *str)
+{
+	if (!str) {
+		write_u32(writer, SNAPSHOT_NO_STR);
+		return;
+	}
+
+	write_u32(writer, (uint32_t) str->len);
+	write_bytes(writer, str->str, str->len);
+}
+
+static inline
+bool read_bytes(struct snapshot_reader *reader, void *data, size_t len)
+{
+	if (reader->error || reader->len - reader->at < len) {
+		reader->error = true;
+		memset(data, 0, len);
+		goto end;
+	}
+
+	memcpy(data, &reader->buf[reader->at], len);
+	reader->at += len;
+
+end:
+	return !reader->error;
+}
+
+static inline
+uint8_t read_u8(struct snapshot_reader *reader)
+{
+	uint8_t val;
+
+	read_bytes(reader, &val, sizeof(val));
+	return val;
+}
+
+static inline
+uint32_t read_u32(struct snapshot_reader *reader)
+{
+	uint32_t val;
+
+	read_bytes(reader, &val, sizeof(val));
+	return val;
+}
+
+static inline
+uint64_t read_u64(struct snapshot_reader *reader)
+{
+	uint64_t val;
+
+	read_bytes(reader, &val, sizeof(val));
+	return val;
+}
+
+static inline
+int64_t read_i64(struct snapshot_reader *reader)
+{
+	int64_t val;
+
+	read_bytes(reader, &val, sizeof(val));
+	return val;
+}
+
+static inline
+bool read_bool(struct snapshot_reader *reader)
+{
+	return read_u8(reader) != 0;
+}
+
+/*
+ * Reads a string into `str` (which must exist). An absent string reads
+ * as an empty one.
+ */
+static
+void read_str(struct snapshot_reader *reader, GString *str)
+{
+	uint32_t len = read_u32(reader);
+
+	g_string_truncate(str, 0);
+
+	if (reader->error || len == SNAPSHOT_NO_STR) {
+		goto end;
+	}
+
+	if (reader->len - reader->at < len) {
+		reader->error = true;
+		goto end;
+	}
+
+	g_string_append_len(str, (const char *) &reader->buf[reader->at],
+		(gssize) len);
+	reader->at += len;
+
+end:
+	return;
+}
+
+/*
+ * Returns the index of the clock class `cc` within the trace class of
+ * `writer`, or -1 if `cc` is `NULL`.
+ */
+static
+int64_t clock_class_index(struct snapshot_writer *writer,
+		struct ctf_clock_class *cc)
+{
+	int64_t index = -1;
+	guint i;
+
+	if (!cc) {
+		goto end;
+	}
+
+	for (i = 0; i < writer->tc->clock_classes->len; i++) {
+		if (writer->tc->clock_classes->pdata[i] == cc) {
+			index = (int64_t) i;
+			goto end;
+		}
+	}
+
+	bt_common_abort();
+
+end:
+	return index;
+}
+
+static
+struct ctf_clock_class *borrow_clock_class(struct snapshot_reader *reader,
+		int64_t index)
+{
+	struct ctf_clock_class *cc = NULL;
+
+	if (index == -1) {
+		goto end;
+	}
+
+	if (index < 0 || (uint64_t) index >= reader->tc->clock_classes->len) {
+		reader->error = true;
+		goto end;
+	}
+
+	cc = reader->tc->clock_classes->pdata[index];
+
+end:
+	return cc;
+}
+
+static
+void write_fc(struct snapshot_writer *writer, struct ctf_field_class *fc);
+
+static
+void write_named_fcs(struct snapshot_writer *writer, GArray *named_fcs)
+{
+	guint i;
+
+	write_u32(writer, named_fcs->len);
+
+	for (i = 0; i < named_fcs->len; i++) {
+		struct ctf_named_field_class *named_fc =
+			&g_array_index(named_fcs,
+				struct ctf_named_field_class, i);
+
+		write_str(writer, named_fc->orig_name);
+		write_fc(writer, named_fc->fc);
+	}
+}
+
+static
+void write_bit_array_fc(struct snapshot_writer *writer,
+		struct ctf_field_class_bit_array *fc)
+{
+	write_u32(writer, fc->byte_order);
+	write_u32(writer, fc->size);
+}
+
+static
+void write_int_fc(struct snapshot_writer *writer,
+		struct ctf_field_class_int *fc)
+{
+	write_bit_array_fc(writer, &fc->base);
+	write_bool(writer, fc->is_signed);
+	write_u32(writer, fc->disp_base);
+	write_u32(writer, fc->encoding);
+	write_i64(writer, clock_class_index(writer, fc->mapped_clock_class));
+}
+
+static
+void write_fc(struct snapshot_writer *writer, struct ctf_field_class *fc)
+{
+	if (!fc) {
+		write_u8(writer, SNAPSHOT_NO_FC);
+		return;
+	}
+
+	write_u8(writer, (uint8_t) fc->type);
+	write_u32(writer, fc->alignment);
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+		write_int_fc(writer, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_enum *enum_fc = (void *) fc;
+		guint i;
+
+		write_int_fc(writer, &enum_fc->base);
+		write_u32(writer, enum_fc->mappings->len);
+
+		for (i = 0; i < enum_fc->mappings->len; i++) {
+			struct ctf_field_class_enum_mapping *mapping =
+				&g_array_index(enum_fc->mappings,
+					struct ctf_field_class_enum_mapping, i);
+			guint j;
+
+			write_str(writer, mapping->label);
+			write_u32(writer, mapping->ranges->len);
+
+			for (j = 0; j < mapping->ranges->len; j++) {
+				struct ctf_range *range = &g_array_index(
+					mapping->ranges, struct ctf_range, j);
+
+				write_u64(writer, range->lower.u);
+				write_u64(writer, range->upper.u);
+			}
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+		write_bit_array_fc(writer, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_STRING:
+	{
+		struct ctf_field_class_string *string_fc = (void *) fc;
+
+		write_u32(writer, string_fc->encoding);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+
+		write_named_fcs(writer, struct_fc->members);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc = (void *) fc;
+
+		write_fc(writer, array_fc->base.elem_fc);
+		write_u64(writer, array_fc->length);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_sequence *seq_fc = (void *) fc;
+
+		write_fc(writer, seq_fc->base.elem_fc);
+		write_str(writer, seq_fc->length_ref);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc = (void *) fc;
+
+		write_str(writer, var_fc->tag_ref);
+		write_named_fcs(writer, var_fc->options);
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+}
+
+static
+struct ctf_field_class *read_fc(struct snapshot_reader *reader,
+		unsigned int depth);
+
+static
+void read_bit_array_fc(struct snapshot_reader *reader,
+		struct ctf_field_class_bit_array *fc)
+{
+	fc->byte_order = read_u32(reader);
+	fc->size = read_u32(reader);
+
+	if (fc->byte_order != CTF_BYTE_ORDER_LITTLE &&
+			fc->byte_order != CTF_BYTE_ORDER_BIG &&
+			fc->byte_order != CTF_BYTE_ORDER_DEFAULT) {
+		reader->error = true;
+	}
+
+	if (fc->size == 0 || fc->size > 64) {
+		reader->error = true;
+	}
+}
+
+static
+void read_int_fc(struct snapshot_reader *reader,
+		struct ctf_field_class_int *fc)
+{
+	read_bit_array_fc(reader, &fc->base);
+	fc->is_signed = read_bool(reader);
+	fc->disp_base = read_u32(reader);
+	fc->encoding = read_u32(reader);
+	fc->mapped_clock_class = borrow_clock_class(reader,
+		read_i64(reader));
+}
+
+static
+struct ctf_field_class *read_fc(struct snapshot_reader *reader,
+		unsigned int depth)
+{
+	struct ctf_field_class *fc = NULL;
+	uint8_t type = read_u8(reader);
+	unsigned int alignment;
+	uint32_t count;
+	uint32_t i;
+
+	if (reader->error || type == SNAPSHOT_NO_FC) {
+		goto end;
+	}
+
+	if (depth > SNAPSHOT_MAX_FC_DEPTH) {
+		reader->error = true;
+		goto end;
+	}
+
+	alignment = read_u32(reader);
+
+	switch (type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct ctf_field_class_int *int_fc =
+			ctf_field_class_int_create();
+
+		fc = (void *) int_fc;
+		read_int_fc(reader, int_fc);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_enum *enum_fc =
+			ctf_field_class_enum_create();
+
+		fc = (void *) enum_fc;
+		read_int_fc(reader, &enum_fc->base);
+		count = read_u32(reader);
+
+		for (i = 0; i < count && !reader->error; i++) {
+			struct ctf_field_class_enum_mapping *mapping;
+			uint32_t range_count;
+			uint32_t j;
+
+			g_array_set_size(enum_fc->mappings,
+				enum_fc->mappings->len + 1);
+			mapping = &g_array_index(enum_fc->mappings,
+				struct ctf_field_class_enum_mapping,
+				enum_fc->mappings->len - 1);
+			_ctf_field_class_enum_mapping_init(mapping);
+			read_str(reader, mapping->label);
+			range_count = read_u32(reader);
+
+			for (j = 0; j < range_count && !reader->error; j++) {
+				struct ctf_range range;
+
+				range.lower.u = read_u64(reader);
+				range.upper.u = read_u64(reader);
+				g_array_append_val(mapping->ranges, range);
+			}
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct ctf_field_class_float *float_fc =
+			ctf_field_class_float_create();
+
+		fc = (void *) float_fc;
+		read_bit_array_fc(reader, &float_fc->base);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRING:
+	{
+		struct ctf_field_class_string *string_fc =
+			ctf_field_class_string_create();
+
+		fc = (void *) string_fc;
+		string_fc->encoding = read_u32(reader);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc =
+			ctf_field_class_struct_create();
+		GString *orig_name = g_string_new(NULL);
+
+		BT_ASSERT(orig_name);
+		fc = (void *) struct_fc;
+		count = read_u32(reader);
+
+		for (i = 0; i < count && !reader->error; i++) {
+			struct ctf_field_class *member_fc;
+
+			read_str(reader, orig_name);
+			member_fc = read_fc(reader, depth + 1);
+			if (!member_fc) {
+				reader->error = true;
+				break;
+			}
+
+			ctf_field_class_struct_append_member(struct_fc,
+				orig_name->str, member_fc);
+		}
+
+		g_string_free(orig_name, TRUE);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc =
+			ctf_field_class_array_create();
+
+		fc = (void *) array_fc;
+		array_fc->base.elem_fc = read_fc(reader, depth + 1);
+		array_fc->length = read_u64(reader);
+
+		if (!array_fc->base.elem_fc) {
+			reader->error = true;
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_sequence *seq_fc =
+			ctf_field_class_sequence_create();
+
+		fc = (void *) seq_fc;
+		seq_fc->base.elem_fc = read_fc(reader, depth + 1);
+		read_str(reader, seq_fc->length_ref);
+
+		if (!seq_fc->base.elem_fc) {
+			reader->error = true;
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc =
+			ctf_field_class_variant_create();
+		GString *orig_name = g_string_new(NULL);
+
+		BT_ASSERT(orig_name);
+		fc = (void *) var_fc;
+		read_str(reader, var_fc->tag_ref);
+		count = read_u32(reader);
+
+		for (i = 0; i < count && !reader->error; i++) {
+			struct ctf_field_class *option_fc;
+
+			read_str(reader, orig_name);
+			option_fc = read_fc(reader, depth + 1);
+			if (!option_fc) {
+				reader->error = true;
+				break;
+			}
+
+			ctf_field_class_variant_append_option(var_fc,
+				orig_name->str, option_fc);
+		}
+
+		g_string_free(orig_name, TRUE);
+		break;
+	}
+	default:
+		reader->error = true;
+		goto end;
+	}
+
+	/*
+	 * Set the alignment last: appending members to a structure
+	 * field class updates its alignment.
+	 */
+	fc->alignment = alignment;
+
+end:
+	if (reader->error) {
+		ctf_field_class_destroy(fc);
+		fc = NULL;
+	}
+
+	return fc;
+}
+
+static
+void write_clock_class(struct snapshot_writer *writer,
+		struct ctf_clock_class *cc)
+{
+	write_str(writer, cc->name);
+	write_str(writer, cc->description);
+	write_u64(writer, cc->frequency);
+	write_u64(writer, cc->precision);
+	write_i64(writer, cc->offset_seconds);
+	write_u64(writer, cc->offset_cycles);
+	write_bytes(writer, cc->uuid, BT_UUID_LEN);
+	write_bool(writer, cc->has_uuid);
+	write_bool(writer, cc->is_absolute);
+}
+
+static
+struct ctf_clock_class *read_clock_class(struct snapshot_reader *reader)
+{
+	struct ctf_clock_class *cc = ctf_clock_class_create();
+
+	read_str(reader, cc->name);
+	read_str(reader, cc->description);
+	cc->frequency = read_u64(reader);
+	cc->precision = read_u64(reader);
+	cc->offset_seconds = read_i64(reader);
+	cc->offset_cycles = read_u64(reader);
+	read_bytes(reader, cc->uuid, BT_UUID_LEN);
+	cc->has_uuid = read_bool(reader);
+	cc->is_absolute = read_bool(reader);
+
+	if (reader->error) {
+		ctf_clock_class_destroy(cc);
+		cc = NULL;
+	}
+
+	return cc;
+}
+
+static
+void write_event_class(struct snapshot_writer *writer,
+		struct ctf_event_class *ec)
+{
+	write_str(writer, ec->name);
+	write_u64(writer, ec->id);
+	write_str(writer, ec->emf_uri);
+	write_bool(writer, ec->is_log_level_set);
+	write_u32(writer, ec->log_level);
+	write_fc(writer, ec->spec_context_fc);
+	write_fc(writer, ec->payload_fc);
+}
+
+static
+struct ctf_event_class *read_event_class(struct snapshot_reader *reader)
+{
+	struct ctf_event_class *ec = ctf_event_class_create();
+	uint32_t log_level;
+
+	read_str(reader, ec->name);
+	ec->id = read_u64(reader);
+	read_str(reader, ec->emf_uri);
+
+	if (read_bool(reader)) {
+		log_level = read_u32(reader);
+		ctf_event_class_set_log_level(ec, log_level);
+	} else {
+		(void) read_u32(reader);
+	}
+
+	ec->spec_context_fc = read_fc(reader, 0);
+	ec->payload_fc = read_fc(reader, 0);
+
+	if (reader->error) {
+		ctf_event_class_destroy(ec);
+		ec = NULL;
+	}
+
+	return ec;
+}
+
+static
+void write_stream_class(struct snapshot_writer *writer,
+		struct ctf_stream_class *sc)
+{
+	guint i;
+
+	write_u64(writer, sc->id);
+	write_fc(writer, sc->packet_context_fc);
+	write_fc(writer, sc->event_header_fc);
+	write_fc(writer, sc->event_common_context_fc);
+	write_u32(writer, sc->event_classes->len);
+
+	for (i = 0; i < sc->event_classes->len; i++) {
+		write_event_class(writer, sc->event_classes->pdata[i]);
+	}
+}
+
+static
+struct ctf_stream_class *read_stream_class(struct snapshot_reader *reader)
+{
+	struct ctf_stream_class *sc = ctf_stream_class_create();
+	uint32_t count;
+	uint32_t i;
+
+	sc->id = read_u64(reader);
+	sc->packet_context_fc = read_fc(reader, 0);
+	sc->event_header_fc = read_fc(reader, 0);
+	sc->event_common_context_fc = read_fc(reader, 0);
+	count = read_u32(reader);
+
+	for (i = 0; i < count && !reader->error; i++) {
+		struct ctf_event_class *ec = read_event_class(reader);
+
+		if (!ec) {
+			break;
+		}
+
+		ctf_stream_class_append_event_class(sc, ec);
+	}
+
+	if (reader->error) {
+		ctf_stream_class_destroy(sc);
+		sc = NULL;
+	}
+
+	return sc;
+}
+
+static
+void write_trace_class(struct snapshot_writer *writer,
+		struct ctf_trace_class *tc)
+{
+	guint i;
+
+	write_u32(writer, tc->major);
+	write_u32(writer, tc->minor);
+	write_bytes(writer, tc->uuid, BT_UUID_LEN);
+	write_bool(writer, tc->is_uuid_set);
+	write_u32(writer, tc->default_byte_order);
+
+	/* Clock classes first: integer field classes refer to them */
+	write_u32(writer, tc->clock_classes->len);
+
+	for (i = 0; i < tc->clock_classes->len; i++) {
+		write_clock_class(writer, tc->clock_classes->pdata[i]);
+	}
+
+	write_fc(writer, tc->packet_header_fc);
+	write_u32(writer, tc->stream_classes->len);
+
+	for (i = 0; i < tc->stream_classes->len; i++) {
+		write_stream_class(writer, tc->stream_classes->pdata[i]);
+	}
+
+	write_u32(writer, tc->env_entries->len);
+
+	for (i = 0; i < tc->env_entries->len; i++) {
+		struct ctf_trace_class_env_entry *entry =
+			&g_array_index(tc->env_entries,
+				struct ctf_trace_class_env_entry, i);
+
+		write_u32(writer, entry->type);
+		write_str(writer, entry->name);
+		write_str(writer, entry->value.str);
+		write_i64(writer, entry->value.i);
+	}
+}
+
+static
+void read_trace_class(struct snapshot_reader *reader)
+{
+	struct ctf_trace_class *tc = reader->tc;
+	GString *name = g_string_new(NULL);
+	GString *str_value = g_string_new(NULL);
+	uint32_t count;
+	uint32_t i;
+
+	BT_ASSERT(name);
+	BT_ASSERT(str_value);
+	tc->major = read_u32(reader);
+	tc->minor = read_u32(reader);
+	read_bytes(reader, tc->uuid, BT_UUID_LEN);
+	tc->is_uuid_set = read_bool(reader);
+	tc->default_byte_order = read_u32(reader);
+
+	if (tc->default_byte_order > CTF_BYTE_ORDER_BIG) {
+		reader->error = true;
+		goto end;
+	}
+
+	count = read_u32(reader);
+
+	for (i = 0; i < count && !reader->error; i++) {
+		struct ctf_clock_class *cc = read_clock_class(reader);
+
+		if (!cc) {
+			goto end;
+		}
+
+		g_ptr_array_add(tc->clock_classes, cc);
+	}
+
+	tc->packet_header_fc = read_fc(reader, 0);
+	count = read_u32(reader);
+
+	for (i = 0; i < count && !reader->error; i++) {
+		struct ctf_stream_class *sc = read_stream_class(reader);
+
+		if (!sc) {
+			goto end;
+		}
+
+		g_ptr_array_add(tc->stream_classes, sc);
+	}
+
+	count = read_u32(reader);
+
+	for (i = 0; i < count && !reader->error; i++) {
+		enum ctf_trace_class_env_entry_type type = read_u32(reader);
+		int64_t i_value;
+
+		read_str(reader, name);
+		read_str(reader, str_value);
+		i_value = read_i64(reader);
+
+		if (type != CTF_TRACE_CLASS_ENV_ENTRY_TYPE_INT &&
+				type != CTF_TRACE_CLASS_ENV_ENTRY_TYPE_STR) {
+			reader->error = true;
+			goto end;
+		}
+
+		ctf_trace_class_append_env_entry(tc, name->str, type,
+			str_value->str, i_value);
+	}
+
+end:
+	g_string_free(name, TRUE);
+	g_string_free(str_value, TRUE);
+}
+
+BT_HIDDEN
+int ctf_trace_class_write_snapshot(struct ctf_trace_class *tc,
+		const char *path, const char *key,
+		struct meta_log_config *log_cfg)
+{
+	struct snapshot_writer writer = {
+		.tc = tc,
+	};
+	GError *gerror = NULL;
+	GString *key_str = NULL;
+	int ret = 0;
+
+	BT_ASSERT(tc);
+	BT_ASSERT(path);
+	BT_ASSERT(key);
+	key_str = g_string_new(key);
+	writer.buf = g_byte_array_new();
+	if (!key_str || !writer.buf) {
+		BT_COMP_LOGW_STR("Failed to allocate metadata snapshot buffer.");
+		ret = -1;
+		goto end;
+	}
+
+	write_u32(&writer, SNAPSHOT_MAGIC);
+	write_u32(&writer, SNAPSHOT_VERSION);
+	write_str(&writer, key_str);
+	write_trace_class(&writer, tc);
+
+	if (!g_file_set_contents(path, (const gchar *) writer.buf->data,
+			(gssize) writer.buf->len, &gerror)) {
+		BT_COMP_LOGW("Cannot write metadata snapshot file: "
+			"path=\"%s\", msg=\"%s\"", path, gerror->message);
+		g_error_free(gerror);
+		ret = -1;
+		goto end;
+	}
+
+	BT_COMP_LOGI("Wrote metadata snapshot file: path=\"%s\", size=%u",
+		path, writer.buf->len);
+
+end:
+	if (writer.buf) {
+		g_byte_array_free(writer.buf, TRUE);
+	}
+
+	if (key_str) {
+		g_string_free(key_str, TRUE);
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+struct ctf_trace_class *ctf_trace_class_read_snapshot(const char *path,
+		const char *key, struct meta_log_config *log_cfg)
+{
+	struct snapshot_reader reader = { 0 };
+	struct ctf_trace_class *tc = NULL;
+	gchar *contents = NULL;
+	gsize len;
+	GString *file_key = g_string_new(NULL);
+
+	BT_ASSERT(path);
+	BT_ASSERT(key);
+	BT_ASSERT(file_key);
+
+	if (!g_file_get_contents(path, &contents, &len, NULL)) {
+		BT_COMP_LOGD("No readable metadata snapshot file: path=\"%s\"",
+			path);
+		goto end;
+	}
+
+	reader.buf = (const uint8_t *) contents;
+	reader.len = len;
+
+	if (read_u32(&reader) != SNAPSHOT_MAGIC ||
+			read_u32(&reader) != SNAPSHOT_VERSION) {
+		BT_COMP_LOGI("Ignoring metadata snapshot file with an "
+			"unexpected magic number or version: path=\"%s\"",
+			path);
+		goto end;
+	}
+
+	read_str(&reader, file_key);
+
+	if (reader.error || strcmp(file_key->str, key) != 0) {
+		BT_COMP_LOGI("Ignoring metadata snapshot file with an "
+			"unexpected key: path=\"%s\"", path);
+		goto end;
+	}
+
+	tc = ctf_trace_class_create();
+	reader.tc = tc;
+	read_trace_class(&reader);
+
+	if (reader.error || reader.at != reader.len) {
+		BT_COMP_LOGW("Ignoring invalid metadata snapshot file: "
+			"path=\"%s\"", path);
+		ctf_trace_class_destroy(tc);
+		tc = NULL;
+		goto end;
+	}
+
+	BT_COMP_LOGI("Read metadata snapshot file: path=\"%s\", size=%zu",
+		path, (size_t) len);
+
+end:
+	g_free(contents);
+	g_string_free(file_key, TRUE);
+	return tc;
+}
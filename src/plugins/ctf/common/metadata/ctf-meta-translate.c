@@ -23,6 +23,9 @@ struct ctx {
 	struct ctf_stream_class *sc;
 	struct ctf_event_class *ec;
 	enum ctf_scope scope;
+
+	/* True to create stream classes which don't support packets */
+	bool no_packets;
 };
 
 static inline
@@ -573,21 +576,32 @@ void ctf_stream_class_to_ir(struct ctx *ctx)
 		BT_ASSERT(ret == 0);
 	}
 
-	bt_stream_class_set_supports_packets(ctx->ir_sc, BT_TRUE,
-		ctx->sc->packets_have_ts_begin, ctx->sc->packets_have_ts_end);
 	bt_stream_class_set_supports_discarded_events(ctx->ir_sc,
 		ctx->sc->has_discarded_events,
 		ctx->sc->discarded_events_have_default_cs);
-	bt_stream_class_set_supports_discarded_packets(ctx->ir_sc,
-		ctx->sc->has_discarded_packets,
-		ctx->sc->discarded_packets_have_default_cs);
-	ctx->scope = CTF_SCOPE_PACKET_CONTEXT;
-	ir_fc = scope_ctf_field_class_to_ir(ctx);
-	if (ir_fc) {
-		ret = bt_stream_class_set_packet_context_field_class(
-			ctx->ir_sc, ir_fc);
-		BT_ASSERT(ret == 0);
-		bt_field_class_put_ref(ir_fc);
+
+	if (ctx->no_packets) {
+		/*
+		 * Packets still exist in the data stream, but not in
+		 * the IR stream: no packet context field class and no
+		 * discarded packets.
+		 */
+		ctx->sc->ir_sc_has_no_packets = true;
+	} else {
+		bt_stream_class_set_supports_packets(ctx->ir_sc, BT_TRUE,
+			ctx->sc->packets_have_ts_begin,
+			ctx->sc->packets_have_ts_end);
+		bt_stream_class_set_supports_discarded_packets(ctx->ir_sc,
+			ctx->sc->has_discarded_packets,
+			ctx->sc->discarded_packets_have_default_cs);
+		ctx->scope = CTF_SCOPE_PACKET_CONTEXT;
+		ir_fc = scope_ctf_field_class_to_ir(ctx);
+		if (ir_fc) {
+			ret = bt_stream_class_set_packet_context_field_class(
+				ctx->ir_sc, ir_fc);
+			BT_ASSERT(ret == 0);
+			bt_field_class_put_ref(ir_fc);
+		}
 	}
 
 	ctx->scope = CTF_SCOPE_EVENT_COMMON_CONTEXT;
@@ -667,7 +681,8 @@ end:
 
 BT_HIDDEN
 int ctf_trace_class_translate(bt_self_component *self_comp,
-		bt_trace_class *ir_tc, struct ctf_trace_class *tc)
+		bt_trace_class *ir_tc, struct ctf_trace_class *tc,
+		bool no_packets)
 {
 	int ret = 0;
 	uint64_t i;
@@ -676,6 +691,7 @@ int ctf_trace_class_translate(bt_self_component *self_comp,
 	ctx.self_comp = self_comp;
 	ctx.tc = tc;
 	ctx.ir_tc = ir_tc;
+	ctx.no_packets = no_packets;
 	ret = ctf_trace_class_to_ir(&ctx);
 	if (ret) {
 		goto end;
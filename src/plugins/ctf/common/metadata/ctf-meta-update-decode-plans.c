@@ -0,0 +1,265 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/align.h"
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ctf-meta-visitors.h"
+
+/*
+ * Returns whether or not the member field class `fc` can be part of a
+ * decoding plan, that is, whether or not the message iterator can
+ * decode it without any BFCR callback special case.
+ */
+static inline
+bool fc_is_plannable(struct ctf_field_class *fc)
+{
+	bool plannable = false;
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_int *int_fc = (void *) fc;
+
+		/*
+		 * The message iterator handles the meaning of an
+		 * unsigned integer, storing the value, and updating
+		 * the default clock itself. Meaningful integers are
+		 * always unsigned.
+		 */
+		plannable = int_fc->base.size <= 64 &&
+			(int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE ||
+			!int_fc->is_signed);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct ctf_field_class_float *float_fc = (void *) fc;
+
+		plannable = float_fc->base.size == 32 ||
+			float_fc->base.size == 64;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc = (void *) fc;
+		struct ctf_field_class_int *elem_fc =
+			(void *) array_fc->base.elem_fc;
+
+		/*
+		 * A static array which isn't in IR and of which
+		 * decoding the elements has no effect (the message
+		 * iterator doesn't check a packet header's UUID) is
+		 * skipped as a whole. Keep it simple: byte-aligned
+		 * elements of which the size is a multiple of 8.
+		 */
+		if (fc->in_ir || (elem_fc->base.base.type !=
+				CTF_FIELD_CLASS_TYPE_INT &&
+				elem_fc->base.base.type !=
+				CTF_FIELD_CLASS_TYPE_ENUM)) {
+			break;
+		}
+
+		plannable = elem_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE &&
+			elem_fc->storing_index < 0 &&
+			!elem_fc->mapped_clock_class &&
+			elem_fc->base.size % 8 == 0 &&
+			elem_fc->base.base.alignment % 8 == 0;
+		break;
+	}
+	default:
+		break;
+	}
+
+	return plannable;
+}
+
+/*
+ * Returns the size (bits) of the plannable field class `fc`.
+ */
+static inline
+uint64_t plannable_fc_size(struct ctf_field_class *fc)
+{
+	uint64_t size;
+
+	if (fc->type == CTF_FIELD_CLASS_TYPE_ARRAY) {
+		struct ctf_field_class_array *array_fc = (void *) fc;
+		struct ctf_field_class_bit_array *elem_fc =
+			(void *) array_fc->base.elem_fc;
+
+		size = array_fc->length == 0 ? 0 :
+			(array_fc->length - 1) *
+				ALIGN((uint64_t) elem_fc->size,
+					(uint64_t) elem_fc->base.alignment) +
+				elem_fc->size;
+	} else {
+		struct ctf_field_class_bit_array *ba_fc = (void *) fc;
+
+		size = ba_fc->size;
+	}
+
+	return size;
+}
+
+/*
+ * Builds and returns the decoding plan of the structure field class
+ * `fc`, or returns `NULL` if it's not possible.
+ */
+static
+struct ctf_decode_plan *build_decode_plan(struct ctf_field_class *fc)
+{
+	struct ctf_decode_plan *plan = NULL;
+	struct ctf_field_class_struct *struct_fc = (void *) fc;
+	enum ctf_byte_order last_bo = CTF_BYTE_ORDER_UNKNOWN;
+	uint64_t at = 0;
+	int64_t ir_index = 0;
+	uint64_t i;
+
+	if (!fc || fc->type != CTF_FIELD_CLASS_TYPE_STRUCT) {
+		goto end;
+	}
+
+	for (i = 0; i < struct_fc->members->len; i++) {
+		struct ctf_named_field_class *named_fc =
+			ctf_field_class_struct_borrow_member_by_index(
+				struct_fc, i);
+
+		if (!fc_is_plannable(named_fc->fc)) {
+			goto error;
+		}
+	}
+
+	plan = ctf_decode_plan_create(fc->alignment);
+
+	for (i = 0; i < struct_fc->members->len; i++) {
+		struct ctf_named_field_class *named_fc =
+			ctf_field_class_struct_borrow_member_by_index(
+				struct_fc, i);
+		struct ctf_field_class_bit_array *ba_fc;
+		struct ctf_decode_plan_entry entry;
+
+		/*
+		 * The structure's alignment is the greatest of its
+		 * members, so once the beginning of the structure is
+		 * aligned, all the member offsets are fixed.
+		 */
+		BT_ASSERT(named_fc->fc->alignment <= plan->alignment);
+		at = ALIGN(at, (uint64_t) named_fc->fc->alignment);
+
+		if (named_fc->fc->type == CTF_FIELD_CLASS_TYPE_ARRAY) {
+			struct ctf_field_class_array *array_fc =
+				(void *) named_fc->fc;
+
+			ba_fc = (void *) array_fc->base.elem_fc;
+		} else {
+			ba_fc = (void *) named_fc->fc;
+		}
+
+		/*
+		 * Let the BFCR report two contiguous bit arrays with
+		 * different byte orders not at a byte boundary.
+		 */
+		if (at % 8 != 0 && last_bo != CTF_BYTE_ORDER_UNKNOWN &&
+				last_bo != ba_fc->byte_order) {
+			goto error;
+		}
+
+		entry.fc = named_fc->fc;
+		entry.offset = at;
+
+		if (named_fc->fc->in_ir) {
+			entry.ir_index = ir_index;
+			ir_index++;
+		} else {
+			entry.ir_index = -1;
+		}
+
+		if (named_fc->fc->type == CTF_FIELD_CLASS_TYPE_INT ||
+				named_fc->fc->type == CTF_FIELD_CLASS_TYPE_ENUM) {
+			struct ctf_field_class_int *int_fc =
+				(void *) named_fc->fc;
+
+			if (int_fc->storing_index >= 0 ||
+					int_fc->mapped_clock_class ||
+					int_fc->meaning !=
+						CTF_FIELD_CLASS_MEANING_NONE) {
+				plan->is_skippable = false;
+			}
+		}
+
+		g_array_append_val(plan->entries, entry);
+		at += plannable_fc_size(named_fc->fc);
+		last_bo = ba_fc->byte_order;
+	}
+
+	plan->size = at;
+	goto end;
+
+error:
+	ctf_decode_plan_destroy(plan);
+	plan = NULL;
+
+end:
+	return plan;
+}
+
+BT_HIDDEN
+int ctf_trace_class_update_decode_plans(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	/*
+	 * Decoding plans of the packet header and packet context field
+	 * classes make reading the properties of a packet (for example,
+	 * when building a data stream file index) a few reads at fixed
+	 * offsets.
+	 */
+	if (!ctf_tc->is_translated) {
+		ctf_decode_plan_destroy(ctf_tc->packet_header_decode_plan);
+		ctf_tc->packet_header_decode_plan =
+			build_decode_plan(ctf_tc->packet_header_fc);
+	}
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		if (!sc->is_translated) {
+			ctf_decode_plan_destroy(sc->packet_context_decode_plan);
+			sc->packet_context_decode_plan =
+				build_decode_plan(sc->packet_context_fc);
+			ctf_decode_plan_destroy(
+				sc->event_common_context_decode_plan);
+			sc->event_common_context_decode_plan =
+				build_decode_plan(sc->event_common_context_fc);
+		}
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			if (ec->is_translated) {
+				continue;
+			}
+
+			ctf_decode_plan_destroy(ec->spec_context_decode_plan);
+			ec->spec_context_decode_plan =
+				build_decode_plan(ec->spec_context_fc);
+			ctf_decode_plan_destroy(ec->payload_decode_plan);
+			ec->payload_decode_plan =
+				build_decode_plan(ec->payload_fc);
+		}
+	}
+
+	return 0;
+}
@@ -122,28 +122,39 @@ int update_stream_class_default_clock_class(
 		stream_class->default_clock_class;
 	uint64_t i;
 
-	ret = find_mapped_clock_class(stream_class->packet_context_fc,
-		&clock_class, log_cfg);
-	if (ret) {
-		goto end;
-	}
+	/*
+	 * The field classes of an already translated stream class
+	 * cannot change: only check them the first time.
+	 */
+	if (!stream_class->is_translated) {
+		ret = find_mapped_clock_class(stream_class->packet_context_fc,
+			&clock_class, log_cfg);
+		if (ret) {
+			goto end;
+		}
 
-	ret = find_mapped_clock_class(stream_class->event_header_fc,
-		&clock_class, log_cfg);
-	if (ret) {
-		goto end;
-	}
+		ret = find_mapped_clock_class(stream_class->event_header_fc,
+			&clock_class, log_cfg);
+		if (ret) {
+			goto end;
+		}
 
-	ret = find_mapped_clock_class(stream_class->event_common_context_fc,
-		&clock_class, log_cfg);
-	if (ret) {
-		goto end;
+		ret = find_mapped_clock_class(
+			stream_class->event_common_context_fc,
+			&clock_class, log_cfg);
+		if (ret) {
+			goto end;
+		}
 	}
 
 	for (i = 0; i < stream_class->event_classes->len; i++) {
 		struct ctf_event_class *event_class =
 			stream_class->event_classes->pdata[i];
 
+		if (event_class->is_translated) {
+			continue;
+		}
+
 		ret = find_mapped_clock_class(event_class->spec_context_fc,
 			&clock_class, log_cfg);
 		if (ret) {
@@ -173,15 +184,17 @@ int ctf_trace_class_update_default_clock_classes(struct ctf_trace_class *ctf_tc,
 	int ret = 0;
 	struct ctf_clock_class *clock_class = NULL;
 
-	ret = find_mapped_clock_class(ctf_tc->packet_header_fc, &clock_class,
-		log_cfg);
-	if (ret) {
-		goto end;
-	}
+	if (!ctf_tc->is_translated) {
+		ret = find_mapped_clock_class(ctf_tc->packet_header_fc,
+			&clock_class, log_cfg);
+		if (ret) {
+			goto end;
+		}
 
-	if (clock_class) {
-		ret = -1;
-		goto end;
+		if (clock_class) {
+			ret = -1;
+			goto end;
+		}
 	}
 
 	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
@@ -0,0 +1,340 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ctf-meta-visitors.h"
+
+/*
+ * Maximum number of entries of a variant field class's direct option
+ * index table.
+ */
+#define MAX_TABLE_LEN	256
+
+static
+gint compare_variant_ranges_signed(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_field_class_variant_range *range_a = a;
+	const struct ctf_field_class_variant_range *range_b = b;
+
+	if (range_a->range.lower.i < range_b->range.lower.i) {
+		return -1;
+	} else if (range_a->range.lower.i > range_b->range.lower.i) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static
+gint compare_variant_ranges_unsigned(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_field_class_variant_range *range_a = a;
+	const struct ctf_field_class_variant_range *range_b = b;
+
+	if (range_a->range.lower.u < range_b->range.lower.u) {
+		return -1;
+	} else if (range_a->range.lower.u > range_b->range.lower.u) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Returns the offset of the lower or upper value of `range` from the
+ * smallest tag value `min`, computed with unsigned integers so that a
+ * signed tag domain is handled like an unsigned one.
+ */
+static inline
+uint64_t range_value_offset(const struct ctf_range *range, bool upper,
+		bool is_signed, uint64_t min)
+{
+	if (is_signed) {
+		return (upper ? (uint64_t) range->upper.i :
+			(uint64_t) range->lower.i) - min;
+	} else {
+		return (upper ? range->upper.u : range->lower.u) - min;
+	}
+}
+
+/*
+ * Builds a direct option index table for the variant field class
+ * `var_fc` if its tag domain is small enough.
+ *
+ * Returns whether or not a table was built.
+ */
+static
+bool try_build_table(struct ctf_field_class_variant *var_fc, bool is_signed)
+{
+	bool built = false;
+	uint64_t min = 0, max = 0;
+	guint i;
+
+	for (i = 0; i < var_fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(
+				var_fc, i);
+
+		if (is_signed) {
+			if (i == 0 || range->range.lower.i < (int64_t) min) {
+				min = (uint64_t) range->range.lower.i;
+			}
+
+			if (i == 0 || range->range.upper.i > (int64_t) max) {
+				max = (uint64_t) range->range.upper.i;
+			}
+		} else {
+			if (i == 0 || range->range.lower.u < min) {
+				min = range->range.lower.u;
+			}
+
+			if (i == 0 || range->range.upper.u > max) {
+				max = range->range.upper.u;
+			}
+		}
+	}
+
+	if (max - min >= MAX_TABLE_LEN) {
+		goto end;
+	}
+
+	var_fc->lookup.table = g_array_sized_new(FALSE, FALSE,
+		sizeof(int64_t), (guint) (max - min + 1));
+	BT_ASSERT(var_fc->lookup.table);
+	g_array_set_size(var_fc->lookup.table, (guint) (max - min + 1));
+	memset(var_fc->lookup.table->data, 0xff,
+		sizeof(int64_t) * var_fc->lookup.table->len);
+
+	/*
+	 * Fill the table from the last range to the first one so that,
+	 * like with a linear scan, the first matching range wins when
+	 * ranges overlap.
+	 */
+	for (i = var_fc->ranges->len; i > 0; i--) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(
+				var_fc, i - 1);
+		uint64_t lower = range_value_offset(&range->range, false,
+			is_signed, min);
+		uint64_t upper = range_value_offset(&range->range, true,
+			is_signed, min);
+		uint64_t v;
+
+		for (v = lower; v <= upper; v++) {
+			g_array_index(var_fc->lookup.table, int64_t, v) =
+				(int64_t) range->option_index;
+		}
+	}
+
+	if (is_signed) {
+		var_fc->lookup.table_min.i = (int64_t) min;
+	} else {
+		var_fc->lookup.table_min.u = min;
+	}
+
+	var_fc->lookup.type = CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_TABLE;
+	built = true;
+
+end:
+	return built;
+}
+
+/*
+ * Builds a sorted, merged range array for the variant field class
+ * `var_fc` if its ranges don't overlap.
+ *
+ * With overlapping ranges, the first matching range in `ranges` wins,
+ * which a binary search can't honour: keep the linear scan in that
+ * case.
+ */
+static
+void try_build_sorted_ranges(struct ctf_field_class_variant *var_fc,
+		bool is_signed)
+{
+	GArray *sorted;
+	GArray *merged = NULL;
+	guint i;
+
+	sorted = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct ctf_field_class_variant_range),
+		var_fc->ranges->len);
+	BT_ASSERT(sorted);
+	g_array_append_vals(sorted, var_fc->ranges->data,
+		var_fc->ranges->len);
+	g_array_sort(sorted, is_signed ? compare_variant_ranges_signed :
+		compare_variant_ranges_unsigned);
+	merged = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct ctf_field_class_variant_range), sorted->len);
+	BT_ASSERT(merged);
+
+	for (i = 0; i < sorted->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			&g_array_index(sorted,
+				struct ctf_field_class_variant_range, i);
+		struct ctf_field_class_variant_range *last;
+		bool overlaps, is_contiguous;
+
+		if (merged->len == 0) {
+			g_array_append_val(merged, *range);
+			continue;
+		}
+
+		last = &g_array_index(merged,
+			struct ctf_field_class_variant_range, merged->len - 1);
+
+		if (is_signed) {
+			overlaps = range->range.lower.i <= last->range.upper.i;
+			is_contiguous = last->range.upper.i != INT64_MAX &&
+				range->range.lower.i == last->range.upper.i + 1;
+		} else {
+			overlaps = range->range.lower.u <= last->range.upper.u;
+			is_contiguous = last->range.upper.u != UINT64_MAX &&
+				range->range.lower.u == last->range.upper.u + 1;
+		}
+
+		if (overlaps) {
+			g_array_free(merged, TRUE);
+			merged = NULL;
+			goto end;
+		}
+
+		if (is_contiguous &&
+				range->option_index == last->option_index) {
+			last->range.upper = range->range.upper;
+		} else {
+			g_array_append_val(merged, *range);
+		}
+	}
+
+	var_fc->lookup.sorted_ranges = merged;
+	var_fc->lookup.type = CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_SORTED_RANGES;
+
+end:
+	g_array_free(sorted, TRUE);
+}
+
+static
+void build_variant_lookup(struct ctf_field_class_variant *var_fc)
+{
+	bool is_signed;
+
+	ctf_field_class_variant_reset_lookup(var_fc);
+
+	if (!var_fc->tag_fc || var_fc->ranges->len == 0) {
+		goto end;
+	}
+
+	is_signed = var_fc->tag_fc->base.is_signed;
+
+	if (try_build_table(var_fc, is_signed)) {
+		goto end;
+	}
+
+	try_build_sorted_ranges(var_fc, is_signed);
+
+end:
+	return;
+}
+
+static
+void update_field_class_variant_lookups(struct ctf_field_class *fc)
+{
+	uint64_t i;
+
+	if (!fc) {
+		goto end;
+	}
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+
+			update_field_class_variant_lookups(named_fc->fc);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc = (void *) fc;
+
+		build_variant_lookup(var_fc);
+
+		for (i = 0; i < var_fc->options->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_variant_borrow_option_by_index(
+					var_fc, i);
+
+			update_field_class_variant_lookups(named_fc->fc);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_array_base *array_fc = (void *) fc;
+
+		update_field_class_variant_lookups(array_fc->elem_fc);
+		break;
+	}
+	default:
+		break;
+	}
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int ctf_trace_class_update_variant_lookups(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	if (!ctf_tc->is_translated) {
+		update_field_class_variant_lookups(ctf_tc->packet_header_fc);
+	}
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		if (!sc->is_translated) {
+			update_field_class_variant_lookups(
+				sc->packet_context_fc);
+			update_field_class_variant_lookups(sc->event_header_fc);
+			update_field_class_variant_lookups(
+				sc->event_common_context_fc);
+		}
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			if (ec->is_translated) {
+				continue;
+			}
+
+			update_field_class_variant_lookups(ec->spec_context_fc);
+			update_field_class_variant_lookups(ec->payload_fc);
+		}
+	}
+
+	return 0;
+}
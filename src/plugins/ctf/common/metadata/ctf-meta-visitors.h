@@ -20,7 +20,8 @@ int ctf_trace_class_resolve_field_classes(struct ctf_trace_class *tc,
 
 BT_HIDDEN
 int ctf_trace_class_translate(bt_self_component *self_comp,
-		bt_trace_class *ir_tc, struct ctf_trace_class *tc);
+		bt_trace_class *ir_tc, struct ctf_trace_class *tc,
+		bool no_packets);
 
 BT_HIDDEN
 int ctf_trace_class_update_default_clock_classes(
@@ -42,6 +43,12 @@ int ctf_trace_class_update_value_storing_indexes(struct ctf_trace_class *ctf_tc)
 BT_HIDDEN
 int ctf_trace_class_update_stream_class_config(struct ctf_trace_class *ctf_tc);
 
+BT_HIDDEN
+int ctf_trace_class_update_decode_plans(struct ctf_trace_class *ctf_tc);
+
+BT_HIDDEN
+int ctf_trace_class_update_variant_lookups(struct ctf_trace_class *ctf_tc);
+
 BT_HIDDEN
 int ctf_trace_class_validate(struct ctf_trace_class *ctf_tc,
 		struct meta_log_config *log_cfg);
@@ -51,4 +58,23 @@ void ctf_trace_class_warn_meaningless_header_fields(
 		struct ctf_trace_class *ctf_tc,
 		struct meta_log_config *log_cfg);
 
+/*
+ * Writes a snapshot of the not-yet-updated trace class `tc`, identified
+ * by `key`, to the file `path`.
+ */
+BT_HIDDEN
+int ctf_trace_class_write_snapshot(struct ctf_trace_class *tc,
+		const char *path, const char *key,
+		struct meta_log_config *log_cfg);
+
+/*
+ * Reads the trace class snapshot file `path`.
+ *
+ * Returns `NULL` if there's no such file, or if it's not a valid
+ * snapshot identified by `key`.
+ */
+BT_HIDDEN
+struct ctf_trace_class *ctf_trace_class_read_snapshot(const char *path,
+		const char *key, struct meta_log_config *log_cfg);
+
 #endif /* _CTF_META_VISITORS_H */
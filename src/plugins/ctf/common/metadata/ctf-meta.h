@@ -158,6 +158,14 @@ struct ctf_field_class_struct {
 
 	/* Array of `struct ctf_named_field_class` */
 	GArray *members;
+
+	/*
+	 * Member name (`const char *`, weak, belongs to the member's
+	 * `name`) -> member index (`guint`, stored with
+	 * GUINT_TO_POINTER() after adding one, so that 0 means "not
+	 * found")
+	 */
+	GHashTable *name_to_index;
 };
 
 struct ctf_field_path {
@@ -172,6 +180,17 @@ struct ctf_field_class_variant_range {
 	uint64_t option_index;
 };
 
+enum ctf_field_class_variant_lookup_type {
+	/* Scan `ranges` in order */
+	CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_LINEAR = 0,
+
+	/* Index `lookup.table` with the tag minus `lookup.table_min` */
+	CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_TABLE,
+
+	/* Binary search `lookup.sorted_ranges` */
+	CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_SORTED_RANGES,
+};
+
 struct ctf_field_class_variant {
 	struct ctf_field_class base;
 	GString *tag_ref;
@@ -186,6 +205,35 @@ struct ctf_field_class_variant {
 
 	/* Weak */
 	struct ctf_field_class_enum *tag_fc;
+
+	/*
+	 * Option index lookup structure, built from `ranges` by
+	 * ctf_trace_class_update_variant_lookups().
+	 */
+	struct {
+		enum ctf_field_class_variant_lookup_type type;
+
+		/* Smallest tag value of `table` */
+		union {
+			uint64_t u;
+			int64_t i;
+		} table_min;
+
+		/*
+		 * Array of `int64_t`: option index for each tag value
+		 * from `table_min`, or -1 (`NULL` if not a table
+		 * lookup)
+		 */
+		GArray *table;
+
+		/*
+		 * Array of `struct ctf_field_class_variant_range`:
+		 * `ranges` sorted by lower value, without overlaps, and
+		 * with contiguous ranges of the same option merged
+		 * (`NULL` if not a sorted range lookup)
+		 */
+		GArray *sorted_ranges;
+	} lookup;
 };
 
 struct ctf_field_class_array_base {
@@ -210,6 +258,49 @@ struct ctf_field_class_sequence {
 	struct ctf_field_class_int *length_fc;
 };
 
+/*
+ * Flat decoding plan of a structure field class of which all the
+ * members are fixed-size integer, enumeration, or floating point number
+ * field classes, or static arrays which aren't in IR and of which the
+ * elements have no effect (for example, a packet header's UUID).
+ *
+ * The message iterator uses it to decode such a structure in one go,
+ * without the BFCR, when it's completely available in the current
+ * buffer.
+ */
+struct ctf_decode_plan_entry {
+	/*
+	 * Weak: integer, enumeration, floating point number, or static
+	 * array (skipped)
+	 */
+	struct ctf_field_class *fc;
+
+	/* Offset (bits) from the beginning of the aligned structure */
+	uint64_t offset;
+
+	/* IR structure field member index, or -1 if not in IR */
+	int64_t ir_index;
+};
+
+struct ctf_decode_plan {
+	/* Array of `struct ctf_decode_plan_entry` */
+	GArray *entries;
+
+	/* Alignment (bits) of the structure */
+	unsigned int alignment;
+
+	/* Total size (bits) of the structure, from its aligned beginning */
+	uint64_t size;
+
+	/*
+	 * True if decoding the structure has no effect other than
+	 * setting IR fields (no stored value, no default clock update,
+	 * no meaningful integer),
+	 * that is, if it can be skipped when there's no IR field to set.
+	 */
+	bool is_skippable;
+};
+
 struct ctf_event_class {
 	GString *name;
 	uint64_t id;
@@ -218,12 +309,24 @@ struct ctf_event_class {
 	bool is_translated;
 	bool is_log_level_set;
 
+	/*
+	 * True if the message iterator must decode the event records of
+	 * this event class without creating event messages.
+	 */
+	bool is_excluded;
+
 	/* Owned by this */
 	struct ctf_field_class *spec_context_fc;
 
 	/* Owned by this */
 	struct ctf_field_class *payload_fc;
 
+	/* Owned by this, `NULL` if `spec_context_fc` has no decoding plan */
+	struct ctf_decode_plan *spec_context_decode_plan;
+
+	/* Owned by this, `NULL` if `payload_fc` has no decoding plan */
+	struct ctf_decode_plan *payload_decode_plan;
+
 	/* Weak, set during translation */
 	bt_event_class *ir_ec;
 };
@@ -241,12 +344,21 @@ struct ctf_stream_class {
 	/* Owned by this */
 	struct ctf_field_class *packet_context_fc;
 
+	/* Owned by this, `NULL` if `packet_context_fc` has no decoding plan */
+	struct ctf_decode_plan *packet_context_decode_plan;
+
 	/* Owned by this */
 	struct ctf_field_class *event_header_fc;
 
 	/* Owned by this */
 	struct ctf_field_class *event_common_context_fc;
 
+	/*
+	 * Owned by this, `NULL` if `event_common_context_fc` has no
+	 * decoding plan
+	 */
+	struct ctf_decode_plan *event_common_context_decode_plan;
+
 	/* Array of `struct ctf_event_class *`, owned by this */
 	GPtrArray *event_classes;
 
@@ -261,6 +373,13 @@ struct ctf_stream_class {
 
 	/* Weak, set during translation */
 	bt_stream_class *ir_sc;
+
+	/*
+	 * True if `ir_sc` doesn't support packets, in which case no
+	 * packet objects and messages exist for this stream class (set
+	 * during translation).
+	 */
+	bool ir_sc_has_no_packets;
 };
 
 enum ctf_trace_class_env_entry_type {
@@ -288,6 +407,9 @@ struct ctf_trace_class {
 	/* Owned by this */
 	struct ctf_field_class *packet_header_fc;
 
+	/* Owned by this, `NULL` if `packet_header_fc` has no decoding plan */
+	struct ctf_decode_plan *packet_header_decode_plan;
+
 	uint64_t stored_value_count;
 
 	/* Array of `struct ctf_clock_class *` (owned by this) */
@@ -466,6 +588,8 @@ struct ctf_field_class_struct *ctf_field_class_struct_create(void)
 	fc->members = g_array_new(FALSE, TRUE,
 		sizeof(struct ctf_named_field_class));
 	BT_ASSERT(fc->members);
+	fc->name_to_index = g_hash_table_new(g_str_hash, g_str_equal);
+	BT_ASSERT(fc->name_to_index);
 	fc->base.is_compound = true;
 	return fc;
 }
@@ -566,6 +690,10 @@ void _ctf_field_class_struct_destroy(struct ctf_field_class_struct *fc)
 {
 	BT_ASSERT(fc);
 
+	if (fc->name_to_index) {
+		g_hash_table_destroy(fc->name_to_index);
+	}
+
 	if (fc->members) {
 		uint64_t i;
 
@@ -612,6 +740,24 @@ void _ctf_field_class_sequence_destroy(struct ctf_field_class_sequence *fc)
 	g_free(fc);
 }
 
+static inline
+void ctf_field_class_variant_reset_lookup(struct ctf_field_class_variant *fc)
+{
+	BT_ASSERT(fc);
+
+	if (fc->lookup.table) {
+		g_array_free(fc->lookup.table, TRUE);
+		fc->lookup.table = NULL;
+	}
+
+	if (fc->lookup.sorted_ranges) {
+		g_array_free(fc->lookup.sorted_ranges, TRUE);
+		fc->lookup.sorted_ranges = NULL;
+	}
+
+	fc->lookup.type = CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_LINEAR;
+}
+
 static inline
 void _ctf_field_class_variant_destroy(struct ctf_field_class_variant *fc)
 {
@@ -635,6 +781,8 @@ void _ctf_field_class_variant_destroy(struct ctf_field_class_variant *fc)
 		g_array_free(fc->ranges, TRUE);
 	}
 
+	ctf_field_class_variant_reset_lookup(fc);
+
 	if (fc->tag_ref) {
 		g_string_free(fc->tag_ref, TRUE);
 	}
@@ -775,22 +923,20 @@ static inline
 struct ctf_named_field_class *ctf_field_class_struct_borrow_member_by_name(
 		struct ctf_field_class_struct *fc, const char *name)
 {
-	uint64_t i;
+	guint index_plus_one;
 	struct ctf_named_field_class *ret_named_fc = NULL;
 
 	BT_ASSERT_DBG(fc);
 	BT_ASSERT_DBG(name);
-
-	for (i = 0; i < fc->members->len; i++) {
-		struct ctf_named_field_class *named_fc =
-			ctf_field_class_struct_borrow_member_by_index(fc, i);
-
-		if (strcmp(name, named_fc->name->str) == 0) {
-			ret_named_fc = named_fc;
-			goto end;
-		}
+	index_plus_one = GPOINTER_TO_UINT(
+		g_hash_table_lookup(fc->name_to_index, name));
+	if (index_plus_one == 0) {
+		goto end;
 	}
 
+	ret_named_fc = ctf_field_class_struct_borrow_member_by_index(fc,
+		index_plus_one - 1);
+
 end:
 	return ret_named_fc;
 }
@@ -871,6 +1017,12 @@ void ctf_field_class_struct_append_member(struct ctf_field_class_struct *fc,
 	_ctf_named_field_class_unescape_orig_name(named_fc);
 	named_fc->fc = member_fc;
 
+	/* Keep the first member having this name */
+	if (!g_hash_table_lookup(fc->name_to_index, named_fc->name->str)) {
+		g_hash_table_insert(fc->name_to_index, named_fc->name->str,
+			GUINT_TO_POINTER(fc->members->len));
+	}
+
 	if (member_fc->alignment > fc->base.alignment) {
 		fc->base.alignment = member_fc->alignment;
 	}
@@ -939,6 +1091,114 @@ void ctf_field_class_variant_append_option(struct ctf_field_class_variant *fc,
 	named_fc->fc = option_fc;
 }
 
+/*
+ * Returns the index of the option of `fc` which the tag value `tag`
+ * selects, or -1 if there's none.
+ */
+static inline
+int64_t ctf_field_class_variant_find_option_index(
+		struct ctf_field_class_variant *fc, uint64_t tag)
+{
+	int64_t option_index = -1;
+	bool is_signed;
+
+	BT_ASSERT_DBG(fc);
+	BT_ASSERT_DBG(fc->tag_fc);
+	is_signed = fc->tag_fc->base.is_signed;
+
+	switch (fc->lookup.type) {
+	case CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_TABLE:
+	{
+		uint64_t offset;
+
+		if (is_signed) {
+			if ((int64_t) tag < fc->lookup.table_min.i) {
+				goto end;
+			}
+
+			offset = tag - (uint64_t) fc->lookup.table_min.i;
+		} else {
+			if (tag < fc->lookup.table_min.u) {
+				goto end;
+			}
+
+			offset = tag - fc->lookup.table_min.u;
+		}
+
+		if (offset < fc->lookup.table->len) {
+			option_index = g_array_index(fc->lookup.table,
+				int64_t, offset);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_SORTED_RANGES:
+	{
+		guint lo = 0;
+		guint hi = fc->lookup.sorted_ranges->len;
+
+		while (lo < hi) {
+			guint mid = lo + (hi - lo) / 2;
+			struct ctf_field_class_variant_range *range =
+				&g_array_index(fc->lookup.sorted_ranges,
+					struct ctf_field_class_variant_range,
+					mid);
+			bool below, above;
+
+			if (is_signed) {
+				below = (int64_t) tag < range->range.lower.i;
+				above = (int64_t) tag > range->range.upper.i;
+			} else {
+				below = tag < range->range.lower.u;
+				above = tag > range->range.upper.u;
+			}
+
+			if (below) {
+				hi = mid;
+			} else if (above) {
+				lo = mid + 1;
+			} else {
+				option_index = (int64_t) range->option_index;
+				break;
+			}
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_VARIANT_LOOKUP_TYPE_LINEAR:
+	{
+		uint64_t i;
+
+		for (i = 0; i < fc->ranges->len; i++) {
+			struct ctf_field_class_variant_range *range =
+				ctf_field_class_variant_borrow_range_by_index(
+					fc, i);
+
+			if (is_signed) {
+				if ((int64_t) tag >= range->range.lower.i &&
+						(int64_t) tag <= range->range.upper.i) {
+					option_index = (int64_t) range->option_index;
+					break;
+				}
+			} else {
+				if (tag >= range->range.lower.u &&
+						tag <= range->range.upper.u) {
+					option_index = (int64_t) range->option_index;
+					break;
+				}
+			}
+		}
+
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+end:
+	return option_index;
+}
+
 static inline
 void ctf_field_class_variant_set_tag_field_class(
 		struct ctf_field_class_variant *fc,
@@ -1477,6 +1737,34 @@ end:
 	return copy_fc;
 }
 
+static inline
+struct ctf_decode_plan *ctf_decode_plan_create(unsigned int alignment)
+{
+	struct ctf_decode_plan *plan = g_new0(struct ctf_decode_plan, 1);
+
+	BT_ASSERT(plan);
+	plan->entries = g_array_new(FALSE, TRUE,
+		sizeof(struct ctf_decode_plan_entry));
+	BT_ASSERT(plan->entries);
+	plan->alignment = alignment;
+	plan->is_skippable = true;
+	return plan;
+}
+
+static inline
+void ctf_decode_plan_destroy(struct ctf_decode_plan *plan)
+{
+	if (!plan) {
+		return;
+	}
+
+	if (plan->entries) {
+		g_array_free(plan->entries, TRUE);
+	}
+
+	g_free(plan);
+}
+
 static inline
 struct ctf_event_class *ctf_event_class_create(void)
 {
@@ -1517,6 +1805,8 @@ void ctf_event_class_destroy(struct ctf_event_class *ec)
 
 	ctf_field_class_destroy(ec->spec_context_fc);
 	ctf_field_class_destroy(ec->payload_fc);
+	ctf_decode_plan_destroy(ec->spec_context_decode_plan);
+	ctf_decode_plan_destroy(ec->payload_decode_plan);
 	g_free(ec);
 }
 
@@ -1551,6 +1841,8 @@ void ctf_stream_class_destroy(struct ctf_stream_class *sc)
 	}
 
 	ctf_field_class_destroy(sc->packet_context_fc);
+	ctf_decode_plan_destroy(sc->packet_context_decode_plan);
+	ctf_decode_plan_destroy(sc->event_common_context_decode_plan);
 	ctf_field_class_destroy(sc->event_header_fc);
 	ctf_field_class_destroy(sc->event_common_context_fc);
 	g_free(sc);
@@ -1656,6 +1948,7 @@ void ctf_trace_class_destroy(struct ctf_trace_class *tc)
 	}
 
 	ctf_field_class_destroy(tc->packet_header_fc);
+	ctf_decode_plan_destroy(tc->packet_header_decode_plan);
 
 	if (tc->clock_classes) {
 		g_ptr_array_free(tc->clock_classes, TRUE);
@@ -51,14 +51,20 @@ struct packet_header {
 	uint8_t  minor;
 } __attribute__((__packed__));
 
+/*
+ * Reads and validates the header of the next metadata packet of
+ * `in_fp`, setting `*content_size` and `*padding_size` to the sizes
+ * (bytes) of its text content and of its padding after the content.
+ *
+ * Returns 1 at the end of `in_fp`.
+ */
 static
-int decode_packet(FILE *in_fp, FILE *out_fp,
-		int byte_order, bool *is_uuid_set, uint8_t *uuid,
+int read_packet_header(FILE *in_fp, int byte_order, bool *is_uuid_set,
+		uint8_t *uuid, size_t *content_size, size_t *padding_size,
 		bt_logging_level log_level, bt_self_component *self_comp)
 {
 	struct packet_header header;
-	size_t readlen, writelen, toread;
-	uint8_t buf[512 + 1];	/* + 1 for debug-mode \0 */
+	size_t readlen;
 	int ret = 0;
 	const long offset = ftell(in_fp);
 
@@ -71,6 +77,7 @@ int decode_packet(FILE *in_fp, FILE *out_fp,
 	readlen = fread(&header, sizeof(header), 1, in_fp);
 	if (feof(in_fp) != 0) {
 		BT_COMP_LOGI("Reached end of file: offset=%ld", ftell(in_fp));
+		ret = 1;
 		goto end;
 	}
 	if (readlen < 1) {
@@ -138,7 +145,36 @@ int decode_packet(FILE *in_fp, FILE *out_fp,
 		goto error;
 	}
 
-	toread = header.content_size / CHAR_BIT - sizeof(header);
+	*content_size = header.content_size / CHAR_BIT - sizeof(header);
+	*padding_size = (header.packet_size - header.content_size) / CHAR_BIT;
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	return ret;
+}
+
+static
+int decode_packet(FILE *in_fp, FILE *out_fp,
+		int byte_order, bool *is_uuid_set, uint8_t *uuid,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	size_t readlen, writelen, toread, padding_size;
+	uint8_t buf[512 + 1];	/* + 1 for debug-mode \0 */
+	int ret;
+
+	ret = read_packet_header(in_fp, byte_order, is_uuid_set, uuid,
+		&toread, &padding_size, log_level, self_comp);
+	if (ret) {
+		if (ret == 1) {
+			/* End of file */
+			ret = 0;
+		}
+
+		goto end;
+	}
 
 	for (;;) {
 		size_t loop_read;
@@ -171,9 +207,7 @@ int decode_packet(FILE *in_fp, FILE *out_fp,
 			int fseek_ret;
 
 			/* Read leftover padding */
-			toread = (header.packet_size - header.content_size) /
-				CHAR_BIT;
-			fseek_ret = fseek(in_fp, toread, SEEK_CUR);
+			fseek_ret = fseek(in_fp, padding_size, SEEK_CUR);
 			if (fseek_ret < 0) {
 				BT_COMP_LOGW_STR("Missing padding at the end of the metadata stream.");
 			}
@@ -266,3 +300,117 @@ error:
 end:
 	return ret;
 }
+
+BT_HIDDEN
+void ctf_metadata_decoder_packetized_reader_init(
+		struct ctf_metadata_decoder_packetized_reader *reader,
+		FILE *fp, int byte_order, bool *is_uuid_set, uint8_t *uuid,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->fp = fp;
+	reader->byte_order = byte_order;
+	reader->is_uuid_set = is_uuid_set;
+	reader->uuid = uuid;
+	reader->log_level = log_level;
+	reader->self_comp = self_comp;
+}
+
+/*
+ * Makes the current packet of `reader` have remaining content, reading
+ * the next packet headers as needed.
+ *
+ * Returns 1 at the end of the packetized stream.
+ */
+static
+int reader_ensure_content(
+		struct ctf_metadata_decoder_packetized_reader *reader)
+{
+	bt_logging_level log_level = reader->log_level;
+	bt_self_component *self_comp = reader->self_comp;
+	int ret = 0;
+
+	if (reader->failed) {
+		ret = -1;
+		goto end;
+	}
+
+	while (reader->content_left == 0) {
+		if (reader->packet_index > 0 && reader->padding_size > 0) {
+			/* Skip the padding of the previous packet */
+			if (fseek(reader->fp, reader->padding_size, SEEK_CUR) < 0) {
+				BT_COMP_LOGW_STR("Missing padding at the end of the metadata stream.");
+			}
+
+			reader->padding_size = 0;
+		}
+
+		if (feof(reader->fp) != 0) {
+			ret = 1;
+			goto end;
+		}
+
+		ret = read_packet_header(reader->fp, reader->byte_order,
+			reader->is_uuid_set, reader->uuid,
+			&reader->content_left, &reader->padding_size,
+			log_level, self_comp);
+		if (ret) {
+			if (ret < 0) {
+				BT_COMP_LOGE("Cannot decode packet: index=%zu",
+					reader->packet_index);
+				reader->failed = true;
+			}
+
+			goto end;
+		}
+
+		reader->packet_index++;
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_metadata_decoder_packetized_reader_has_content(
+		struct ctf_metadata_decoder_packetized_reader *reader,
+		bool *has_content)
+{
+	int ret = reader_ensure_content(reader);
+
+	*has_content = ret == 0;
+	return ret < 0 ? -1 : 0;
+}
+
+BT_HIDDEN
+size_t ctf_metadata_decoder_packetized_reader_read(char *buf,
+		size_t max_size, void *data)
+{
+	struct ctf_metadata_decoder_packetized_reader *reader = data;
+	bt_logging_level log_level = reader->log_level;
+	bt_self_component *self_comp = reader->self_comp;
+	size_t readlen = 0;
+	size_t toread;
+
+	if (reader_ensure_content(reader)) {
+		/* End of stream or error */
+		goto end;
+	}
+
+	toread = MIN(max_size, reader->content_left);
+	readlen = fread(buf, 1, toread, reader->fp);
+	if (readlen < toread) {
+		BT_COMP_LOGE("Cannot read metadata packet content: "
+			"index=%zu, offset=%ld, read-size=%zu, "
+			"read-size-returned=%zu", reader->packet_index - 1,
+			ftell(reader->fp), toread, readlen);
+		reader->failed = true;
+		readlen = 0;
+		goto end;
+	}
+
+	reader->content_left -= readlen;
+
+end:
+	return readlen;
+}
@@ -8,7 +8,9 @@
 #define SRC_PLUGINS_CTF_COMMON_METADATA_DECODER_PACKETIZED_FILE_STREAM_TO_BUF
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include <babeltrace2/babeltrace.h>
 
@@ -18,4 +20,59 @@ int ctf_metadata_decoder_packetized_file_stream_to_buf(FILE *fp,
 		uint8_t *uuid, bt_logging_level log_level,
 		bt_self_component *self_comp);
 
+/*
+ * Reader of the metadata text of a packetized metadata file stream,
+ * which unwraps the packets as the lexer needs the text instead of
+ * copying all of it to a buffer first (see
+ * ctf_scanner_append_ast_from_func()).
+ */
+struct ctf_metadata_decoder_packetized_reader {
+	/* Weak */
+	FILE *fp;
+
+	int byte_order;
+	bool *is_uuid_set;
+	uint8_t *uuid;
+
+	/* Sizes (bytes) of what's left of the current packet */
+	size_t content_left;
+	size_t padding_size;
+
+	/* Number of packet headers read so far */
+	size_t packet_index;
+
+	/*
+	 * True if reading or decoding a packet failed: this reader then
+	 * behaves as if its stream ended.
+	 */
+	bool failed;
+
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+};
+
+BT_HIDDEN
+void ctf_metadata_decoder_packetized_reader_init(
+		struct ctf_metadata_decoder_packetized_reader *reader,
+		FILE *fp, int byte_order, bool *is_uuid_set, uint8_t *uuid,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+/*
+ * Sets `*has_content` to whether or not the rest of the packetized
+ * stream of `reader` contains metadata text, reading the next packet
+ * headers as needed.
+ */
+BT_HIDDEN
+int ctf_metadata_decoder_packetized_reader_has_content(
+		struct ctf_metadata_decoder_packetized_reader *reader,
+		bool *has_content);
+
+/*
+ * `ctf_scanner_read_func` which reads the metadata text of the reader
+ * `data`.
+ */
+BT_HIDDEN
+size_t ctf_metadata_decoder_packetized_reader_read(char *buf,
+		size_t max_size, void *data);
+
 #endif /* SRC_PLUGINS_CTF_COMMON_METADATA_DECODER_PACKETIZED_FILE_STREAM_TO_BUF */
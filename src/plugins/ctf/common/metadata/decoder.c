@@ -23,12 +23,16 @@
 
 #include "ast.h"
 #include "decoder.h"
+#include "decoder-packetized-file-stream-to-buf.h"
 #include "scanner.h"
 #include "logging.h"
 #include "parser-wrap.h"
+#include "ctf-meta-visitors.h"
 
 #define TSDL_MAGIC	0x75d11d57
 
+#define METADATA_SNAPSHOT_FILE_EXT	".metadata-snapshot"
+
 struct ctf_metadata_decoder {
 	struct ctf_scanner *scanner;
 	GString *text;
@@ -38,6 +42,9 @@ struct ctf_metadata_decoder {
 	int bo;
 	struct ctf_metadata_decoder_config config;
 	struct meta_log_config log_cfg;
+
+	/* True if content was appended successfully at least once */
+	bool has_content;
 };
 
 struct packet_header {
@@ -53,12 +60,6 @@ struct packet_header {
 	uint8_t  minor;
 } __attribute__((__packed__));
 
-BT_HIDDEN
-int ctf_metadata_decoder_packetized_file_stream_to_buf(FILE *fp,
-		char **buf, int byte_order, bool *is_uuid_set,
-		uint8_t *uuid, bt_logging_level log_level,
-		bt_self_component *self_comp);
-
 BT_HIDDEN
 int ctf_metadata_decoder_is_packetized(FILE *fp, bool *is_packetized,
 		int *byte_order, bt_logging_level log_level,
@@ -175,6 +176,94 @@ void ctf_metadata_decoder_destroy(struct ctf_metadata_decoder *mdec)
 	g_free(mdec);
 }
 
+/*
+ * Returns the key of the metadata snapshot of the metadata text `text`
+ * with the configuration of `mdec`: the SHA-256 digest of the text and
+ * of the configuration parameters which the AST visitor uses.
+ *
+ * Free the returned string with g_free().
+ */
+static
+gchar *metadata_snapshot_key(struct ctf_metadata_decoder *mdec,
+		const GString *text)
+{
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	gchar *config_str;
+	gchar *key;
+
+	BT_ASSERT(checksum);
+	g_checksum_update(checksum, (const guchar *) text->str, text->len);
+	config_str = g_strdup_printf("\n%" PRId64 ":%" PRId64 ":%d",
+		mdec->config.clock_class_offset_s,
+		mdec->config.clock_class_offset_ns,
+		(int) mdec->config.force_clock_class_origin_unix_epoch);
+	BT_ASSERT(config_str);
+	g_checksum_update(checksum, (const guchar *) config_str,
+		strlen(config_str));
+	key = g_strdup(g_checksum_get_string(checksum));
+	BT_ASSERT(key);
+	g_free(config_str);
+	g_checksum_free(checksum);
+	return key;
+}
+
+static
+gchar *metadata_snapshot_path(struct ctf_metadata_decoder *mdec,
+		const gchar *key)
+{
+	gchar *basename = g_strconcat(key, METADATA_SNAPSHOT_FILE_EXT, NULL);
+	gchar *path;
+
+	BT_ASSERT(basename);
+	path = g_build_filename(mdec->config.snapshot_dir, basename, NULL);
+	BT_ASSERT(path);
+	g_free(basename);
+	return path;
+}
+
+/*
+ * Writes a snapshot of the visited, but not finished, CTF IR trace
+ * class of `mdec` to `path`.
+ *
+ * Failing to write a snapshot isn't an error.
+ */
+static
+void write_metadata_snapshot(struct ctf_metadata_decoder *mdec,
+		const gchar *path, const gchar *key)
+{
+	if (g_mkdir_with_parents(mdec->config.snapshot_dir, 0755)) {
+		BT_COMP_LOGW("Cannot create metadata snapshot directory: "
+			"path=\"%s\", msg=\"%s\"", mdec->config.snapshot_dir,
+			g_strerror(errno));
+		goto end;
+	}
+
+	(void) ctf_trace_class_write_snapshot(
+		ctf_visitor_generate_ir_borrow_ctf_trace_class(mdec->visitor),
+		path, key, &mdec->log_cfg);
+
+end:
+	return;
+}
+
+static
+enum ctf_metadata_decoder_status finish_visitor(
+		struct ctf_metadata_decoder *mdec)
+{
+	enum ctf_metadata_decoder_status status =
+		CTF_METADATA_DECODER_STATUS_OK;
+	int ret;
+
+	ret = ctf_visitor_generate_ir_finish(mdec->visitor);
+	if (ret) {
+		BT_COMP_LOGE("Failed to update and translate CTF IR objects: "
+			"mdec-addr=%p, ret=%d", mdec, ret);
+		status = CTF_METADATA_DECODER_STATUS_IR_VISITOR_ERROR;
+	}
+
+	return status;
+}
+
 BT_HIDDEN
 enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 		struct ctf_metadata_decoder *mdec, FILE *fp)
@@ -186,6 +275,11 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 	bool close_fp = false;
 	long start_pos = -1;
 	bool is_packetized;
+	GString *snapshot_text = NULL;
+	gchar *snapshot_key = NULL;
+	gchar *snapshot_path = NULL;
+	struct ctf_metadata_decoder_packetized_reader reader;
+	bool use_reader = false;
 
 	BT_ASSERT(mdec);
 	ret = ctf_metadata_decoder_is_packetized(fp, &is_packetized, &mdec->bo,
@@ -197,6 +291,38 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 
 	if (is_packetized) {
 		BT_COMP_LOGI("Metadata stream is packetized: mdec-addr=%p", mdec);
+
+		if (!mdec->config.keep_plain_text && !mdec->config.snapshot_dir) {
+			bool has_content;
+
+			/*
+			 * Nothing needs the whole metadata text: unwrap
+			 * the packets as the lexer reads the text
+			 * instead of copying all of it to a buffer
+			 * first.
+			 */
+			ctf_metadata_decoder_packetized_reader_init(&reader,
+				fp, mdec->bo, &mdec->is_uuid_set, mdec->uuid,
+				mdec->config.log_level,
+				mdec->config.self_comp);
+			ret = ctf_metadata_decoder_packetized_reader_has_content(
+				&reader, &has_content);
+			if (ret) {
+				BT_COMP_LOGE("Cannot decode packetized metadata packets to metadata text: "
+					"mdec-addr=%p, ret=%d", mdec, ret);
+				status = CTF_METADATA_DECODER_STATUS_ERROR;
+				goto end;
+			}
+
+			if (!has_content) {
+				/* An empty metadata packet is OK. */
+				goto end;
+			}
+
+			use_reader = true;
+			goto parse;
+		}
+
 		ret = ctf_metadata_decoder_packetized_file_stream_to_buf(fp,
 			&buf, mdec->bo, &mdec->is_uuid_set,
 			mdec->uuid, mdec->config.log_level,
@@ -261,6 +387,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 		}
 	}
 
+parse:
 #if YYDEBUG
 	if (BT_LOG_ON_TRACE) {
 		yydebug = 1;
@@ -270,12 +397,62 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 	/* Save the file's position: we'll seek back to append the plain text */
 	BT_ASSERT(fp);
 
-	if (mdec->config.keep_plain_text) {
+	if (mdec->config.keep_plain_text || mdec->config.snapshot_dir) {
 		start_pos = ftell(fp);
 	}
 
+	if (mdec->config.snapshot_dir && mdec->config.create_trace_class &&
+			!mdec->has_content) {
+		struct ctf_trace_class *snapshot_tc;
+
+		/*
+		 * Read the whole metadata text to find its snapshot: if
+		 * there's one, then skip parsing and visiting the AST.
+		 */
+		snapshot_text = g_string_new(NULL);
+		BT_ASSERT(snapshot_text);
+		BT_ASSERT(start_pos != -1);
+		ret = bt_common_append_file_content_to_g_string(snapshot_text,
+			fp);
+		if (ret || fseek(fp, start_pos, SEEK_SET)) {
+			BT_COMP_LOGE("Failed to read metadata text: "
+				"mdec-addr=%p", mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+
+		snapshot_key = metadata_snapshot_key(mdec, snapshot_text);
+		snapshot_path = metadata_snapshot_path(mdec, snapshot_key);
+		snapshot_tc = ctf_trace_class_read_snapshot(snapshot_path,
+			snapshot_key, &mdec->log_cfg);
+		if (snapshot_tc) {
+			if (mdec->config.keep_plain_text) {
+				g_string_append_len(mdec->text,
+					snapshot_text->str,
+					snapshot_text->len);
+			}
+
+			ctf_visitor_generate_ir_set_ctf_trace_class(
+				mdec->visitor, snapshot_tc);
+			status = finish_visitor(mdec);
+			goto end;
+		}
+	}
+
 	/* Append the metadata text content */
-	ret = ctf_scanner_append_ast(mdec->scanner, fp);
+	if (use_reader) {
+		ret = ctf_scanner_append_ast_from_func(mdec->scanner,
+			ctf_metadata_decoder_packetized_reader_read, &reader);
+		if (reader.failed) {
+			BT_COMP_LOGE("Cannot decode packetized metadata packets to metadata text: "
+				"mdec-addr=%p", mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+	} else {
+		ret = ctf_scanner_append_ast(mdec->scanner, fp);
+	}
+
 	if (ret) {
 		BT_COMP_LOGE("Cannot create the metadata AST out of the metadata text: "
 			"mdec-addr=%p", mdec);
@@ -313,7 +490,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 	}
 
 	if (mdec->config.create_trace_class) {
-		ret = ctf_visitor_generate_ir_visit_node(mdec->visitor,
+		ret = ctf_visitor_generate_ir_visit_ast(mdec->visitor,
 			&mdec->scanner->ast->root);
 		switch (ret) {
 		case 0:
@@ -330,6 +507,16 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 			status = CTF_METADATA_DECODER_STATUS_IR_VISITOR_ERROR;
 			goto end;
 		}
+
+		if (snapshot_path) {
+			write_metadata_snapshot(mdec, snapshot_path,
+				snapshot_key);
+		}
+
+		status = finish_visitor(mdec);
+		if (status) {
+			goto end;
+		}
 	}
 
 end:
@@ -337,6 +524,17 @@ end:
 	yydebug = 0;
 #endif
 
+	if (status == CTF_METADATA_DECODER_STATUS_OK) {
+		mdec->has_content = true;
+	}
+
+	if (snapshot_text) {
+		g_string_free(snapshot_text, TRUE);
+	}
+
+	g_free(snapshot_key);
+	g_free(snapshot_path);
+
 	if (fp && close_fp) {
 		if (fclose(fp)) {
 			BT_COMP_LOGE("Cannot close metadata file stream: "
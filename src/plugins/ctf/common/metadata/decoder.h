@@ -46,11 +46,26 @@ struct ctf_metadata_decoder_config {
 	/* True to create trace class objects */
 	bool create_trace_class;
 
+	/*
+	 * True to create stream classes which don't support packets
+	 * (only used when `create_trace_class` is true).
+	 */
+	bool no_packets;
+
 	/*
 	 * True to keep the plain text when content is appended with
 	 * ctf_metadata_decoder_append_content().
 	 */
 	bool keep_plain_text;
+
+	/*
+	 * Directory of the metadata snapshot files, or `NULL` to disable
+	 * snapshots (weak, must exist as long as the decoder exists).
+	 *
+	 * Only used when `create_trace_class` is true and the whole
+	 * metadata is appended at once.
+	 */
+	const char *snapshot_dir;
 };
 
 /*
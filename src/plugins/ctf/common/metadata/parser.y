@@ -958,6 +958,21 @@ int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input)
 	return yyparse(scanner, scanner->scanner);
 }
 
+int ctf_scanner_append_ast_from_func(struct ctf_scanner *scanner,
+		ctf_scanner_read_func read_func, void *read_data)
+{
+	int ret;
+
+	/* Start processing new stream: `YY_INPUT` calls `read_func` */
+	scanner->read_func = read_func;
+	scanner->read_data = read_data;
+	yyrestart(NULL, scanner->scanner);
+	ret = yyparse(scanner, scanner->scanner);
+	scanner->read_func = NULL;
+	scanner->read_data = NULL;
+	return ret;
+}
+
 struct ctf_scanner *ctf_scanner_alloc(void)
 {
 	struct ctf_scanner *scanner;
@@ -22,12 +22,27 @@ struct ctf_scanner_scope {
 	GHashTable *classes;
 };
 
+/*
+ * Function which reads at most `max_size` bytes of metadata text into
+ * `buf`, returning the number of bytes read, or 0 at the end of the
+ * input (including on error).
+ */
+typedef size_t (*ctf_scanner_read_func)(char *buf, size_t max_size,
+		void *data);
+
 struct ctf_scanner {
 	yyscan_t scanner;
 	struct ctf_ast *ast;
 	struct ctf_scanner_scope root_scope;
 	struct ctf_scanner_scope *cs;
 	struct objstack *objstack;
+
+	/*
+	 * Input function of the lexer, or `NULL` to read its input
+	 * file stream (see ctf_scanner_append_ast_from_func())
+	 */
+	ctf_scanner_read_func read_func;
+	void *read_data;
 };
 
 BT_HIDDEN
@@ -39,6 +54,14 @@ void ctf_scanner_free(struct ctf_scanner *scanner);
 BT_HIDDEN
 int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input);
 
+/*
+ * Like ctf_scanner_append_ast(), but the lexer reads its input with
+ * `read_func`, as it needs it, instead of from a file stream.
+ */
+BT_HIDDEN
+int ctf_scanner_append_ast_from_func(struct ctf_scanner *scanner,
+		ctf_scanner_read_func read_func, void *read_data);
+
 static inline
 struct ctf_ast *ctf_scanner_get_ast(struct ctf_scanner *scanner)
 {
@@ -248,35 +248,92 @@ end:
 	return;
 }
 
+/* Maximum length of a prefixed alias name built on the stack */
+#define _PREFIXED_NAME_STACK_LEN	128
+
 /**
  * Returns the GQuark of a prefixed alias.
  *
+ * If \p create is false, this function doesn't add the prefixed name
+ * to the quark table: it returns 0 if no quark exists for it, in which
+ * case no alias with this name can exist either.
+ *
  * @param prefix	Prefix character
  * @param name		Name
- * @returns		Associated GQuark, or 0 on error
+ * @param create	True to create the quark if it doesn't exist
+ * @returns		Associated GQuark, or 0 on error or if
+ *			\p create is false and there's no such quark
  */
 static
-GQuark get_prefixed_named_quark(struct ctx *ctx, char prefix, const char *name)
+GQuark get_prefixed_named_quark(struct ctx *ctx, char prefix, const char *name,
+		bool create)
 {
 	GQuark qname = 0;
+	char stack_prname[_PREFIXED_NAME_STACK_LEN];
+	char *prname = stack_prname;
+	size_t len;
 
 	BT_ASSERT(name);
+	len = strlen(name);
 
 	/* Prefix character + original string + '\0' */
-	char *prname = g_new(char, strlen(name) + 2);
-	if (!prname) {
-		BT_COMP_LOGE_STR("Failed to allocate a string.");
-		goto end;
+	if (len + 2 > sizeof(stack_prname)) {
+		prname = g_new(char, len + 2);
+		if (!prname) {
+			BT_COMP_LOGE_STR("Failed to allocate a string.");
+			goto end;
+		}
 	}
 
-	sprintf(prname, "%c%s", prefix, name);
-	qname = g_quark_from_string(prname);
-	g_free(prname);
+	prname[0] = prefix;
+	memcpy(&prname[1], name, len + 1);
+
+	if (create) {
+		qname = g_quark_from_string(prname);
+	} else {
+		qname = g_quark_try_string(prname);
+	}
+
+	if (prname != stack_prname) {
+		g_free(prname);
+	}
 
 end:
 	return qname;
 }
 
+/*
+ * Looks up the class alias having the quark `qname` within the
+ * declaration scope `scope` and its `levels` parents (-1 means
+ * infinite).
+ */
+static
+struct ctf_field_class *ctx_decl_scope_lookup_quark(
+		struct ctx_decl_scope *scope, GQuark qname, int levels)
+{
+	int cur_levels = 0;
+	struct ctf_field_class *decl = NULL;
+	struct ctx_decl_scope *cur_scope = scope;
+
+	if (levels < 0) {
+		levels = INT_MAX;
+	}
+
+	while (cur_scope && cur_levels < levels) {
+		decl = g_hash_table_lookup(cur_scope->decl_map,
+			(gconstpointer) GUINT_TO_POINTER(qname));
+		if (decl) {
+			goto end;
+		}
+
+		cur_scope = cur_scope->parent_scope;
+		cur_levels++;
+	}
+
+end:
+	return decl;
+}
+
 /**
  * Looks up a prefixed class alias within a declaration scope.
  *
@@ -294,36 +351,20 @@ struct ctf_field_class *ctx_decl_scope_lookup_prefix_alias(
 		const char *name, int levels, bool copy)
 {
 	GQuark qname = 0;
-	int cur_levels = 0;
 	struct ctf_field_class *decl = NULL;
-	struct ctx_decl_scope *cur_scope = scope;
 
 	BT_ASSERT(scope);
 	BT_ASSERT(name);
-	qname = get_prefixed_named_quark(ctx, prefix, name);
+	qname = get_prefixed_named_quark(ctx, prefix, name, false);
 	if (!qname) {
 		goto end;
 	}
 
-	if (levels < 0) {
-		levels = INT_MAX;
-	}
-
-	while (cur_scope && cur_levels < levels) {
-		decl = g_hash_table_lookup(cur_scope->decl_map,
-			(gconstpointer) GUINT_TO_POINTER(qname));
-		if (decl) {
-			/* Caller's reference */
-			if (copy) {
-				decl = ctf_field_class_copy(decl);
-				BT_ASSERT(decl);
-			}
-
-			goto end;
-		}
-
-		cur_scope = cur_scope->parent_scope;
-		cur_levels++;
+	decl = ctx_decl_scope_lookup_quark(scope, qname, levels);
+	if (decl && copy) {
+		/* Caller's reference */
+		decl = ctf_field_class_copy(decl);
+		BT_ASSERT(decl);
 	}
 
 end:
@@ -426,15 +467,14 @@ int ctx_decl_scope_register_prefix_alias(struct ctx *ctx,
 	BT_ASSERT(scope);
 	BT_ASSERT(name);
 	BT_ASSERT(decl);
-	qname = get_prefixed_named_quark(ctx, prefix, name);
+	qname = get_prefixed_named_quark(ctx, prefix, name, true);
 	if (!qname) {
 		ret = -ENOMEM;
 		goto end;
 	}
 
 	/* Make sure alias does not exist in local scope */
-	if (ctx_decl_scope_lookup_prefix_alias(ctx, scope, prefix, name, 1,
-			false)) {
+	if (ctx_decl_scope_lookup_quark(scope, qname, 1)) {
 		ret = -EEXIST;
 		goto end;
 	}
@@ -4676,8 +4716,54 @@ struct ctf_trace_class *ctf_visitor_generate_ir_borrow_ctf_trace_class(
 	return ctx->ctf_tc;
 }
 
+/*
+ * Marks all the CTF IR classes of `ctf_tc` as translated without
+ * creating any trace IR object.
+ *
+ * When there's no IR trace class, nothing ever sets the
+ * `is_translated` members otherwise, and each appended metadata chunk
+ * would make the update passes process all the existing classes again.
+ */
+static
+void mark_ctf_classes_as_translated(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			ec->is_translated = true;
+		}
+
+		sc->is_translated = true;
+	}
+
+	ctf_tc->is_translated = true;
+}
+
 BT_HIDDEN
-int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
+void ctf_visitor_generate_ir_set_ctf_trace_class(
+		struct ctf_visitor_generate_ir *visitor,
+		struct ctf_trace_class *ctf_tc)
+{
+	struct ctx *ctx = (void *) visitor;
+
+	BT_ASSERT(ctx);
+	BT_ASSERT(ctf_tc);
+	BT_ASSERT(!ctx->is_trace_visited);
+	BT_ASSERT(ctx->ctf_tc->stream_classes->len == 0);
+	ctf_trace_class_destroy(ctx->ctf_tc);
+	ctx->ctf_tc = ctf_tc;
+	ctx->is_trace_visited = true;
+}
+
+BT_HIDDEN
+int ctf_visitor_generate_ir_visit_ast(struct ctf_visitor_generate_ir *visitor,
 		struct ctf_node *node)
 {
 	int ret = 0;
@@ -4838,6 +4924,16 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_visitor_generate_ir_finish(struct ctf_visitor_generate_ir *visitor)
+{
+	int ret;
+	struct ctx *ctx = (void *) visitor;
+
 	/* Update default clock classes */
 	ret = ctf_trace_class_update_default_clock_classes(ctx->ctf_tc,
 		&ctx->log_cfg);
@@ -4903,6 +4999,20 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
+	/* Build decoding plans of event classes */
+	ret = ctf_trace_class_update_decode_plans(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Build option lookup structures of variant field classes */
+	ret = ctf_trace_class_update_variant_lookups(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
 	/*
 	 * If there are fields which are not related to the CTF format
 	 * itself in the packet header and in event header field
@@ -4914,13 +5024,33 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 	if (ctx->trace_class) {
 		/* Copy new CTF metadata -> new IR metadata */
 		ret = ctf_trace_class_translate(ctx->log_cfg.self_comp,
-				ctx->trace_class, ctx->ctf_tc);
+				ctx->trace_class, ctx->ctf_tc,
+				ctx->decoder_config.no_packets);
 		if (ret) {
 			ret = -EINVAL;
 			goto end;
 		}
+	} else {
+		mark_ctf_classes_as_translated(ctx->ctf_tc);
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
+		struct ctf_node *node)
+{
+	int ret;
+
+	ret = ctf_visitor_generate_ir_visit_ast(visitor, node);
+	if (ret) {
+		goto end;
 	}
 
+	ret = ctf_visitor_generate_ir_finish(visitor);
+
 end:
 	return ret;
 }
@@ -21,6 +21,9 @@
 #include <string.h>
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "common/align.h"
+#include "common/probes.h"
+#include "compat/bitfield.h"
 #include <glib.h>
 #include <stdlib.h>
 
@@ -88,6 +91,7 @@ enum state {
 	STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE,
 	STATE_EMIT_MSG_EVENT,
 	STATE_EMIT_QUEUED_MSG_EVENT,
+	STATE_SKIP_EXCLUDED_EVENT,
 	STATE_SKIP_PACKET_PADDING,
 	STATE_EMIT_MSG_PACKET_END_MULTI,
 	STATE_EMIT_MSG_PACKET_END_SINGLE,
@@ -118,6 +122,28 @@ struct ctf_msg_iter {
 	 */
 	bool dry_run;
 
+	/*
+	 * True if the current event record is being skipped because its
+	 * event class is excluded: `dry_run` is temporarily true while
+	 * decoding it.
+	 */
+	bool skipping_event;
+
+	/*
+	 * True if the current packet context is being decoded while its
+	 * stream class has no IR packets: `dry_run` is temporarily true
+	 * while decoding it.
+	 */
+	bool skipping_packet_context;
+
+	/*
+	 * True to emit no event messages: skip the event records of
+	 * each packet as a whole when the packet's content size is
+	 * known, or decode them like the ones of excluded event classes
+	 * otherwise.
+	 */
+	bool skip_event_records;
+
 	/*
 	 * Current dynamic scope field pointer.
 	 *
@@ -303,6 +329,8 @@ const char *state_string(enum state state)
 		return "EMIT_MSG_EVENT";
 	case STATE_EMIT_QUEUED_MSG_EVENT:
 		return "EMIT_QUEUED_MSG_EVENT";
+	case STATE_SKIP_EXCLUDED_EVENT:
+		return "SKIP_EXCLUDED_EVENT";
 	case STATE_SKIP_PACKET_PADDING:
 		return "SKIP_PACKET_PADDING";
 	case STATE_EMIT_MSG_PACKET_END_MULTI:
@@ -379,7 +407,7 @@ void stack_push(struct stack *stack, bt_field *base)
 	BT_ASSERT_DBG(stack);
 	msg_it = stack->msg_it;
 	BT_ASSERT_DBG(base);
-	BT_COMP_LOGT("Pushing base field on stack: stack-addr=%p, "
+	BT_COMP_LOGT_FP("Pushing base field on stack: stack-addr=%p, "
 		"stack-size-before=%zu, stack-size-after=%zu",
 		stack, stack->size, stack->size + 1);
 
@@ -408,7 +436,7 @@ void stack_pop(struct stack *stack)
 	BT_ASSERT_DBG(stack);
 	BT_ASSERT_DBG(stack_size(stack));
 	msg_it = stack->msg_it;
-	BT_COMP_LOGT("Popping from stack: "
+	BT_COMP_LOGT_FP("Popping from stack: "
 		"stack-addr=%p, stack-size-before=%zu, stack-size-after=%zu",
 		stack, stack->size, stack->size - 1);
 	stack->size--;
@@ -465,7 +493,7 @@ size_t packet_at(struct ctf_msg_iter *msg_it)
 static inline
 void buf_consume_bits(struct ctf_msg_iter *msg_it, size_t incr)
 {
-	BT_COMP_LOGT("Advancing cursor: msg-it-addr=%p, cur-before=%zu, cur-after=%zu",
+	BT_COMP_LOGT_FP("Advancing cursor: msg-it-addr=%p, cur-before=%zu, cur-after=%zu",
 		msg_it, msg_it->buf.at, msg_it->buf.at + incr);
 	msg_it->buf.at += incr;
 }
@@ -479,12 +507,12 @@ enum ctf_msg_iter_status request_medium_bytes(
 	size_t buffer_sz = 0;
 	enum ctf_msg_iter_medium_status m_status;
 
-	BT_COMP_LOGD("Calling user function (request bytes): msg-it-addr=%p, "
+	BT_COMP_LOGD_FP("Calling user function (request bytes): msg-it-addr=%p, "
 		"request-size=%zu", msg_it, msg_it->medium.max_request_sz);
 	m_status = msg_it->medium.medops.request_bytes(
 		msg_it->medium.max_request_sz, &buffer_addr,
 		&buffer_sz, msg_it->medium.data);
-	BT_COMP_LOGD("User function returned: status=%s, buf-addr=%p, buf-size=%zu",
+	BT_COMP_LOGD_FP("User function returned: status=%s, buf-addr=%p, buf-size=%zu",
 		ctf_msg_iter_medium_status_string(m_status),
 		buffer_addr, buffer_sz);
 	if (m_status == CTF_MSG_ITER_MEDIUM_STATUS_OK) {
@@ -503,7 +531,7 @@ enum ctf_msg_iter_status request_medium_bytes(
 		/* New medium buffer address */
 		msg_it->buf.addr = buffer_addr;
 
-		BT_COMP_LOGD("User function returned new bytes: "
+		BT_COMP_LOGD_FP("User function returned new bytes: "
 			"packet-offset=%zu, cur=%zu, size=%zu, addr=%p",
 			msg_it->buf.packet_offset, msg_it->buf.at,
 			msg_it->buf.sz, msg_it->buf.addr);
@@ -568,10 +596,281 @@ enum ctf_msg_iter_status buf_ensure_available_bits(
 	return status;
 }
 
+/*
+ * Updates the default clock value of `msg_it` from the `new_val_size`
+ * low bits `new_val`, assuming that the clock value wrapped at most one
+ * time on this number of bits since the last update.
+ *
+ * This is branchless: this is called for each event record having a
+ * timestamp. With a 64-bit value, `new_val_mask + 1` is 0 and the
+ * cleared bits are all the bits, so that the new value replaces the
+ * current one.
+ */
+static inline
+void update_default_clock(struct ctf_msg_iter *msg_it, uint64_t new_val,
+		uint64_t new_val_size)
+{
+	uint64_t new_val_mask;
+	uint64_t cur_value_masked;
+
+	BT_ASSERT_DBG(new_val_size > 0 && new_val_size <= 64);
+	new_val_mask = UINT64_MAX >> (64 - new_val_size);
+	cur_value_masked = msg_it->default_clock_snapshot & new_val_mask;
+
+	/*
+	 * If the new value is less than the low bits of the current
+	 * value, then it wrapped on the number of bits of the new
+	 * value.
+	 */
+	msg_it->default_clock_snapshot +=
+		(new_val_mask + 1) & -(uint64_t) (new_val < cur_value_masked);
+
+	/* Replace the low bits of the current clock value */
+	msg_it->default_clock_snapshot =
+		(msg_it->default_clock_snapshot & ~new_val_mask) | new_val;
+	BT_COMP_LOGT_FP("Updated default clock's value from integer field's value: "
+		"value=%" PRIu64, msg_it->default_clock_snapshot);
+}
+
+/*
+ * Handles the value `value` of the meaningful unsigned integer field
+ * of which the class is `int_fc`.
+ *
+ * Returns 0 on success, or -1 if the value is invalid.
+ */
+static inline
+int set_meaningful_unsigned_int_value(struct ctf_msg_iter *msg_it,
+		struct ctf_field_class_int *int_fc, uint64_t value)
+{
+	bt_self_component *self_comp = msg_it->self_comp;
+	int ret = 0;
+
+	switch (int_fc->meaning) {
+	case CTF_FIELD_CLASS_MEANING_EVENT_CLASS_ID:
+		msg_it->cur_event_class_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_DATA_STREAM_ID:
+		msg_it->cur_data_stream_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_BEGINNING_TIME:
+		msg_it->snapshots.beginning_clock = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_END_TIME:
+		msg_it->snapshots.end_clock = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_STREAM_CLASS_ID:
+		msg_it->cur_stream_class_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_MAGIC:
+		if (value != 0xc1fc1fc1) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Invalid CTF magic number: msg-it-addr=%p, "
+				"magic=%" PRIx64, msg_it, value);
+			ret = -1;
+			goto end;
+		}
+
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_COUNTER_SNAPSHOT:
+		msg_it->snapshots.packets = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_DISC_EV_REC_COUNTER_SNAPSHOT:
+		msg_it->snapshots.discarded_events = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_TOTAL_SIZE:
+		msg_it->cur_exp_packet_total_size = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_CONTENT_SIZE:
+		msg_it->cur_exp_packet_content_size = value;
+		break;
+	default:
+		bt_common_abort();
+	}
+
+end:
+	return ret;
+}
+
+static inline
+uint64_t read_plan_unsigned_bitfield(struct ctf_msg_iter *msg_it,
+		struct ctf_field_class_bit_array *ba_fc, size_t at)
+{
+	uint64_t v;
+
+	if (ba_fc->byte_order == CTF_BYTE_ORDER_BIG) {
+		bt_bitfield_read_be(msg_it->buf.addr, uint8_t, at,
+			ba_fc->size, &v);
+	} else {
+		bt_bitfield_read_le(msg_it->buf.addr, uint8_t, at,
+			ba_fc->size, &v);
+	}
+
+	return v;
+}
+
+static inline
+int64_t read_plan_signed_bitfield(struct ctf_msg_iter *msg_it,
+		struct ctf_field_class_bit_array *ba_fc, size_t at)
+{
+	int64_t v;
+
+	if (ba_fc->byte_order == CTF_BYTE_ORDER_BIG) {
+		bt_bitfield_read_be(msg_it->buf.addr, uint8_t, at,
+			ba_fc->size, &v);
+	} else {
+		bt_bitfield_read_le(msg_it->buf.addr, uint8_t, at,
+			ba_fc->size, &v);
+	}
+
+	return v;
+}
+
+/*
+ * Decodes the structure field `dscope_field` (which may be `NULL` if
+ * it's not in IR or during a dry run) following the decoding plan
+ * `plan` if the whole structure is available in the current buffer.
+ *
+ * Sets `*decoded` to whether or not the field was decoded; if not, and
+ * if the returned status is `CTF_MSG_ITER_STATUS_OK`, the caller needs
+ * to use the BFCR.
+ */
+static
+enum ctf_msg_iter_status read_dscope_with_decode_plan(
+		struct ctf_msg_iter *msg_it,
+		const struct ctf_decode_plan *plan, bt_field *dscope_field,
+		bool *decoded)
+{
+	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
+	size_t skip_bits;
+	size_t start;
+	uint64_t i;
+
+	*decoded = false;
+
+	skip_bits = ALIGN(packet_at(msg_it), (size_t) plan->alignment) -
+		packet_at(msg_it);
+	if (skip_bits + plan->size > buf_available_bits(msg_it)) {
+		goto end;
+	}
+
+	if (!dscope_field && plan->is_skippable) {
+		/*
+		 * Nothing to set (dry run or not in IR) and nothing to
+		 * record: skip the whole structure.
+		 */
+		BT_COMP_LOGT_FP("Skipping field with decoding plan: "
+			"msg-it-addr=%p, size=%" PRIu64, msg_it, plan->size);
+		goto consume;
+	}
+
+	start = msg_it->buf.at + skip_bits;
+
+	for (i = 0; i < plan->entries->len; i++) {
+		const struct ctf_decode_plan_entry *entry =
+			&g_array_index(plan->entries,
+				struct ctf_decode_plan_entry, i);
+		struct ctf_field_class_bit_array *ba_fc = (void *) entry->fc;
+		size_t at = start + entry->offset;
+		bt_field *field = NULL;
+		uint64_t uval;
+
+		if (entry->fc->type == CTF_FIELD_CLASS_TYPE_ARRAY) {
+			/* Nothing to decode */
+			continue;
+		}
+
+		if (dscope_field && entry->ir_index >= 0) {
+			field = bt_field_structure_borrow_member_field_by_index(
+				dscope_field, (uint64_t) entry->ir_index);
+			BT_ASSERT_DBG(field);
+			BT_ASSERT_DBG(bt_field_borrow_class_const(field) ==
+				entry->fc->ir_fc);
+		}
+
+		if (entry->fc->type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+			uval = read_plan_unsigned_bitfield(msg_it, ba_fc, at);
+
+			if (!field) {
+				continue;
+			}
+
+			if (ba_fc->size == 32) {
+				union {
+					uint32_t u;
+					float f;
+				} f32;
+
+				f32.u = (uint32_t) uval;
+				bt_field_real_single_precision_set_value(field,
+					f32.f);
+			} else {
+				union {
+					uint64_t u;
+					double d;
+				} f64;
+
+				f64.u = uval;
+				bt_field_real_double_precision_set_value(field,
+					f64.d);
+			}
+		} else {
+			struct ctf_field_class_int *int_fc = (void *) entry->fc;
+
+			if (int_fc->is_signed) {
+				int64_t sval;
+
+				sval = read_plan_signed_bitfield(msg_it, ba_fc, at);
+				uval = (uint64_t) sval;
+
+				if (field) {
+					bt_field_integer_signed_set_value(field,
+						sval);
+				}
+			} else {
+				uval = read_plan_unsigned_bitfield(msg_it, ba_fc, at);
+
+				if (G_UNLIKELY(int_fc->meaning !=
+						CTF_FIELD_CLASS_MEANING_NONE) &&
+						set_meaningful_unsigned_int_value(
+							msg_it, int_fc, uval)) {
+					status = CTF_MSG_ITER_STATUS_ERROR;
+					goto end;
+				}
+
+				if (G_UNLIKELY(int_fc->mapped_clock_class)) {
+					update_default_clock(msg_it, uval,
+						ba_fc->size);
+				}
+
+				if (field) {
+					bt_field_integer_unsigned_set_value(
+						field, uval);
+				}
+			}
+
+			if (G_UNLIKELY(int_fc->storing_index >= 0)) {
+				g_array_index(msg_it->stored_values, uint64_t,
+					(uint64_t) int_fc->storing_index) = uval;
+			}
+		}
+	}
+
+	BT_COMP_LOGT_FP("Decoded field with decoding plan: "
+		"msg-it-addr=%p, size=%" PRIu64, msg_it, plan->size);
+
+consume:
+	buf_consume_bits(msg_it, skip_bits + plan->size);
+	*decoded = true;
+
+end:
+	return status;
+}
+
 static
 enum ctf_msg_iter_status read_dscope_begin_state(
 		struct ctf_msg_iter *msg_it,
 		struct ctf_field_class *dscope_fc,
+		const struct ctf_decode_plan *decode_plan,
 		enum state done_state, enum state continue_state,
 		bt_field *dscope_field)
 {
@@ -581,21 +880,37 @@ enum ctf_msg_iter_status read_dscope_begin_state(
 	size_t consumed_bits;
 
 	msg_it->cur_dscope_field = dscope_field;
-	BT_COMP_LOGT("Starting BFCR: msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p",
+
+	if (decode_plan) {
+		bool decoded;
+
+		status = read_dscope_with_decode_plan(msg_it, decode_plan,
+			dscope_field, &decoded);
+		if (status != CTF_MSG_ITER_STATUS_OK) {
+			goto end;
+		}
+
+		if (decoded) {
+			msg_it->state = done_state;
+			goto end;
+		}
+	}
+
+	BT_COMP_LOGT_FP("Starting BFCR: msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p",
 		msg_it, msg_it->bfcr, dscope_fc);
 	consumed_bits = bt_bfcr_start(msg_it->bfcr, dscope_fc,
 		msg_it->buf.addr, msg_it->buf.at, packet_at(msg_it),
 		msg_it->buf.sz, &bfcr_status);
-	BT_COMP_LOGT("BFCR consumed bits: size=%zu", consumed_bits);
+	BT_COMP_LOGT_FP("BFCR consumed bits: size=%zu", consumed_bits);
 
 	switch (bfcr_status) {
 	case BT_BFCR_STATUS_OK:
 		/* Field class was read completely */
-		BT_COMP_LOGT_STR("Field was completely decoded.");
+		BT_COMP_LOGT_STR_FP("Field was completely decoded.");
 		msg_it->state = done_state;
 		break;
 	case BT_BFCR_STATUS_EOF:
-		BT_COMP_LOGT_STR("BFCR needs more data to decode field completely.");
+		BT_COMP_LOGT_STR_FP("BFCR needs more data to decode field completely.");
 		msg_it->state = continue_state;
 		break;
 	default:
@@ -623,7 +938,7 @@ enum ctf_msg_iter_status read_dscope_continue_state(
 	enum bt_bfcr_status bfcr_status;
 	size_t consumed_bits;
 
-	BT_COMP_LOGT("Continuing BFCR: msg-it-addr=%p, bfcr-addr=%p",
+	BT_COMP_LOGT_FP("Continuing BFCR: msg-it-addr=%p, bfcr-addr=%p",
 		msg_it, msg_it->bfcr);
 
 	status = buf_ensure_available_bits(msg_it);
@@ -644,17 +959,17 @@ enum ctf_msg_iter_status read_dscope_continue_state(
 
 	consumed_bits = bt_bfcr_continue(msg_it->bfcr, msg_it->buf.addr,
 		msg_it->buf.sz, &bfcr_status);
-	BT_COMP_LOGT("BFCR consumed bits: size=%zu", consumed_bits);
+	BT_COMP_LOGT_FP("BFCR consumed bits: size=%zu", consumed_bits);
 
 	switch (bfcr_status) {
 	case BT_BFCR_STATUS_OK:
 		/* Type was read completely. */
-		BT_COMP_LOGT_STR("Field was completely decoded.");
+		BT_COMP_LOGT_STR_FP("Field was completely decoded.");
 		msg_it->state = done_state;
 		break;
 	case BT_BFCR_STATUS_EOF:
 		/* Stay in this continue state. */
-		BT_COMP_LOGT_STR("BFCR needs more data to decode field completely.");
+		BT_COMP_LOGT_STR_FP("BFCR needs more data to decode field completely.");
 		break;
 	default:
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -707,8 +1022,17 @@ enum ctf_msg_iter_status switch_packet_state(struct ctf_msg_iter *msg_it)
 	BT_COMP_LOGD("Switching packet: msg-it-addr=%p, cur=%zu, "
 		"packet-offset=%" PRId64, msg_it, msg_it->buf.at,
 		msg_it->cur_packet_offset);
+	BT_PROBE2(ctf_msg_iter_switch_packet, msg_it,
+		msg_it->cur_packet_offset);
 	stack_clear(msg_it->stack);
 	msg_it->meta.ec = NULL;
+
+	/*
+	 * Put the current packet before set_current_packet() creates
+	 * the next one: if nothing else references it, it goes back to
+	 * its stream's packet pool, with its context field, and
+	 * bt_packet_create() gets the same object back.
+	 */
 	BT_PACKET_PUT_REF_AND_RESET(msg_it->packet);
 	BT_MESSAGE_PUT_REF_AND_RESET(msg_it->event_msg);
 	release_all_dscopes(msg_it);
@@ -818,6 +1142,7 @@ enum ctf_msg_iter_status read_packet_header_begin_state(
 		"msg-it-addr=%p, trace-class-addr=%p, fc-addr=%p",
 		msg_it, msg_it->meta.tc, packet_header_fc);
 	status = read_dscope_begin_state(msg_it, packet_header_fc,
+		msg_it->meta.tc->packet_header_decode_plan,
 		STATE_AFTER_TRACE_PACKET_HEADER,
 		STATE_DSCOPE_TRACE_PACKET_HEADER_CONTINUE, NULL);
 	if (status < 0) {
@@ -1000,9 +1325,11 @@ enum ctf_msg_iter_status after_packet_header_state(
 			goto end;
 		}
 
-		status = set_current_packet(msg_it);
-		if (status != CTF_MSG_ITER_STATUS_OK) {
-			goto end;
+		if (!msg_it->meta.sc->ir_sc_has_no_packets) {
+			status = set_current_packet(msg_it);
+			if (status != CTF_MSG_ITER_STATUS_OK) {
+				goto end;
+			}
 		}
 	}
 
@@ -1035,11 +1362,22 @@ enum ctf_msg_iter_status read_packet_context_begin_state(
 	}
 
 	if (packet_context_fc->in_ir && !msg_it->dry_run) {
-		BT_ASSERT(!msg_it->dscopes.stream_packet_context);
-		BT_ASSERT(msg_it->packet);
-		msg_it->dscopes.stream_packet_context =
-			bt_packet_borrow_context_field(msg_it->packet);
-		BT_ASSERT(msg_it->dscopes.stream_packet_context);
+		if (G_UNLIKELY(msg_it->meta.sc->ir_sc_has_no_packets)) {
+			/*
+			 * No packet object to hold the packet context
+			 * field: decode it without creating any field,
+			 * only keeping the stored values and the
+			 * snapshots.
+			 */
+			msg_it->skipping_packet_context = true;
+			msg_it->dry_run = true;
+		} else {
+			BT_ASSERT(!msg_it->dscopes.stream_packet_context);
+			BT_ASSERT(msg_it->packet);
+			msg_it->dscopes.stream_packet_context =
+				bt_packet_borrow_context_field(msg_it->packet);
+			BT_ASSERT(msg_it->dscopes.stream_packet_context);
+		}
 	}
 
 	BT_COMP_LOGD("Decoding packet context field: "
@@ -1048,6 +1386,7 @@ enum ctf_msg_iter_status read_packet_context_begin_state(
 		msg_it, msg_it->meta.sc,
 		msg_it->meta.sc->id, packet_context_fc);
 	status = read_dscope_begin_state(msg_it, packet_context_fc,
+		msg_it->meta.sc->packet_context_decode_plan,
 		STATE_AFTER_STREAM_PACKET_CONTEXT,
 		STATE_DSCOPE_STREAM_PACKET_CONTEXT_CONTINUE,
 		msg_it->dscopes.stream_packet_context);
@@ -1125,6 +1464,11 @@ enum ctf_msg_iter_status after_packet_context_state(struct ctf_msg_iter *msg_it)
 {
 	enum ctf_msg_iter_status status;
 
+	if (G_UNLIKELY(msg_it->skipping_packet_context)) {
+		msg_it->skipping_packet_context = false;
+		msg_it->dry_run = false;
+	}
+
 	status = set_current_packet_content_sizes(msg_it);
 	if (status != CTF_MSG_ITER_STATUS_OK) {
 		goto end;
@@ -1171,6 +1515,18 @@ enum ctf_msg_iter_status read_event_header_begin_state(struct ctf_msg_iter *msg_
 			status = CTF_MSG_ITER_STATUS_ERROR;
 			goto end;
 		}
+
+		if (G_UNLIKELY(msg_it->skip_event_records)) {
+			/*
+			 * Skip the remaining content of this packet
+			 * without decoding it.
+			 */
+			BT_COMP_LOGD("Skipping event records of packet: "
+				"msg-it-addr=%p, cur=%zu", msg_it,
+				packet_at(msg_it));
+			msg_it->state = STATE_EMIT_MSG_PACKET_END_MULTI;
+			goto end;
+		}
 	} else {
 		/*
 		 * "Infinite" content: we're done when the medium has
@@ -1197,7 +1553,7 @@ enum ctf_msg_iter_status read_event_header_begin_state(struct ctf_msg_iter *msg_
 		goto end;
 	}
 
-	BT_COMP_LOGD("Decoding event header field: "
+	BT_COMP_LOGD_FP("Decoding event header field: "
 		"msg-it-addr=%p, stream-class-addr=%p, "
 		"stream-class-id=%" PRId64 ", "
 		"fc-addr=%p",
@@ -1205,6 +1561,7 @@ enum ctf_msg_iter_status read_event_header_begin_state(struct ctf_msg_iter *msg_
 		msg_it->meta.sc->id,
 		event_header_fc);
 	status = read_dscope_begin_state(msg_it, event_header_fc,
+		NULL,
 		STATE_AFTER_EVENT_HEADER,
 		STATE_DSCOPE_EVENT_HEADER_CONTINUE, NULL);
 	if (status < 0) {
@@ -1269,7 +1626,7 @@ enum ctf_msg_iter_status set_current_event_class(struct ctf_msg_iter *msg_it)
 	}
 
 	msg_it->meta.ec = new_event_class;
-	BT_COMP_LOGD("Set current event class: "
+	BT_COMP_LOGD_FP("Set current event class: "
 		"msg-it-addr=%p, event-class-addr=%p, "
 		"event-class-id=%" PRId64 ", "
 		"event-class-name=\"%s\"",
@@ -1289,8 +1646,8 @@ enum ctf_msg_iter_status set_current_event_message(
 	bt_message *msg = NULL;
 
 	BT_ASSERT_DBG(msg_it->meta.ec);
-	BT_ASSERT_DBG(msg_it->packet);
-	BT_COMP_LOGD("Creating event message from event class and packet: "
+	BT_ASSERT_DBG(msg_it->packet || msg_it->meta.sc->ir_sc_has_no_packets);
+	BT_COMP_LOGD_FP("Creating event message from event class and packet: "
 		"msg-it-addr=%p, ec-addr=%p, ec-name=\"%s\", packet-addr=%p",
 		msg_it, msg_it->meta.ec,
 		msg_it->meta.ec->name->str,
@@ -1298,7 +1655,18 @@ enum ctf_msg_iter_status set_current_event_message(
 	BT_ASSERT_DBG(msg_it->self_msg_iter);
 	BT_ASSERT_DBG(msg_it->meta.sc);
 
-	if (bt_stream_class_borrow_default_clock_class(msg_it->meta.sc->ir_sc)) {
+	if (G_UNLIKELY(!msg_it->packet)) {
+		/* The stream class doesn't support packets */
+		if (bt_stream_class_borrow_default_clock_class(
+				msg_it->meta.sc->ir_sc)) {
+			msg = bt_message_event_create_with_default_clock_snapshot(
+				msg_it->self_msg_iter, msg_it->meta.ec->ir_ec,
+				msg_it->stream, msg_it->default_clock_snapshot);
+		} else {
+			msg = bt_message_event_create(msg_it->self_msg_iter,
+				msg_it->meta.ec->ir_ec, msg_it->stream);
+		}
+	} else if (bt_stream_class_borrow_default_clock_class(msg_it->meta.sc->ir_sc)) {
 		msg = bt_message_event_create_with_packet_and_default_clock_snapshot(
 			msg_it->self_msg_iter, msg_it->meta.ec->ir_ec,
 			msg_it->packet, msg_it->default_clock_snapshot);
@@ -1344,6 +1712,19 @@ enum ctf_msg_iter_status after_event_header_state(
 		goto next_state;
 	}
 
+	if (G_UNLIKELY(msg_it->meta.ec->is_excluded ||
+			msg_it->skip_event_records)) {
+		/*
+		 * Decode the rest of this event record without creating
+		 * any field: the decoding plans skip what they can and
+		 * the BFCR callbacks only keep the stored values and
+		 * the default clock value.
+		 */
+		msg_it->skipping_event = true;
+		msg_it->dry_run = true;
+		goto next_state;
+	}
+
 	status = set_current_event_message(msg_it);
 	if (status != CTF_MSG_ITER_STATUS_OK) {
 		goto end;
@@ -1382,7 +1763,7 @@ enum ctf_msg_iter_status read_event_common_context_begin_state(
 		BT_ASSERT_DBG(msg_it->dscopes.event_common_context);
 	}
 
-	BT_COMP_LOGT("Decoding event common context field: "
+	BT_COMP_LOGT_FP("Decoding event common context field: "
 		"msg-it-addr=%p, stream-class-addr=%p, "
 		"stream-class-id=%" PRId64 ", "
 		"fc-addr=%p",
@@ -1390,6 +1771,7 @@ enum ctf_msg_iter_status read_event_common_context_begin_state(
 		msg_it->meta.sc->id,
 		event_common_context_fc);
 	status = read_dscope_begin_state(msg_it, event_common_context_fc,
+		msg_it->meta.sc->event_common_context_decode_plan,
 		STATE_DSCOPE_EVENT_SPEC_CONTEXT_BEGIN,
 		STATE_DSCOPE_EVENT_COMMON_CONTEXT_CONTINUE,
 		msg_it->dscopes.event_common_context);
@@ -1437,7 +1819,7 @@ enum ctf_msg_iter_status read_event_spec_context_begin_state(
 		BT_ASSERT_DBG(msg_it->dscopes.event_spec_context);
 	}
 
-	BT_COMP_LOGT("Decoding event specific context field: "
+	BT_COMP_LOGT_FP("Decoding event specific context field: "
 		"msg-it-addr=%p, event-class-addr=%p, "
 		"event-class-name=\"%s\", event-class-id=%" PRId64 ", "
 		"fc-addr=%p",
@@ -1446,6 +1828,7 @@ enum ctf_msg_iter_status read_event_spec_context_begin_state(
 		msg_it->meta.ec->id,
 		event_spec_context_fc);
 	status = read_dscope_begin_state(msg_it, event_spec_context_fc,
+		msg_it->meta.ec->spec_context_decode_plan,
 		STATE_DSCOPE_EVENT_PAYLOAD_BEGIN,
 		STATE_DSCOPE_EVENT_SPEC_CONTEXT_CONTINUE,
 		msg_it->dscopes.event_spec_context);
@@ -1473,6 +1856,17 @@ enum ctf_msg_iter_status read_event_spec_context_continue_state(
 		STATE_DSCOPE_EVENT_PAYLOAD_BEGIN);
 }
 
+/*
+ * Returns the state which follows the decoding of the current event
+ * record's payload.
+ */
+static inline
+enum state after_event_payload_state(struct ctf_msg_iter *msg_it)
+{
+	return G_UNLIKELY(msg_it->skipping_event) ?
+		STATE_SKIP_EXCLUDED_EVENT : STATE_EMIT_MSG_EVENT;
+}
+
 static
 enum ctf_msg_iter_status read_event_payload_begin_state(
 		struct ctf_msg_iter *msg_it)
@@ -1483,7 +1877,7 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 
 	event_payload_fc = msg_it->meta.ec->payload_fc;
 	if (!event_payload_fc) {
-		msg_it->state = STATE_EMIT_MSG_EVENT;
+		msg_it->state = after_event_payload_state(msg_it);
 		goto end;
 	}
 
@@ -1495,7 +1889,7 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 		BT_ASSERT_DBG(msg_it->dscopes.event_payload);
 	}
 
-	BT_COMP_LOGT("Decoding event payload field: "
+	BT_COMP_LOGT_FP("Decoding event payload field: "
 		"msg-it-addr=%p, event-class-addr=%p, "
 		"event-class-name=\"%s\", event-class-id=%" PRId64 ", "
 		"fc-addr=%p",
@@ -1504,7 +1898,8 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 		msg_it->meta.ec->id,
 		event_payload_fc);
 	status = read_dscope_begin_state(msg_it, event_payload_fc,
-		STATE_EMIT_MSG_EVENT,
+		msg_it->meta.ec->payload_decode_plan,
+		after_event_payload_state(msg_it),
 		STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE,
 		msg_it->dscopes.event_payload);
 	if (status < 0) {
@@ -1527,7 +1922,8 @@ static
 enum ctf_msg_iter_status read_event_payload_continue_state(
 		struct ctf_msg_iter *msg_it)
 {
-	return read_dscope_continue_state(msg_it, STATE_EMIT_MSG_EVENT);
+	return read_dscope_continue_state(msg_it,
+		after_event_payload_state(msg_it));
 }
 
 static
@@ -1616,7 +2012,8 @@ enum ctf_msg_iter_status check_emit_msg_discarded_packets(
 {
 	msg_it->state = STATE_EMIT_MSG_DISCARDED_PACKETS;
 
-	if (!msg_it->meta.sc->has_discarded_packets) {
+	if (!msg_it->meta.sc->has_discarded_packets ||
+			msg_it->meta.sc->ir_sc_has_no_packets) {
 		msg_it->state = STATE_EMIT_MSG_PACKET_BEGINNING;
 		goto end;
 	}
@@ -1672,7 +2069,7 @@ enum ctf_msg_iter_status handle_state(struct ctf_msg_iter *msg_it)
 	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
 	const enum state state = msg_it->state;
 
-	BT_COMP_LOGT("Handling state: msg-it-addr=%p, state=%s",
+	BT_COMP_LOGT_FP("Handling state: msg-it-addr=%p, state=%s",
 		msg_it, state_string(state));
 
 	// TODO: optimalize!
@@ -1749,6 +2146,11 @@ enum ctf_msg_iter_status handle_state(struct ctf_msg_iter *msg_it)
 	case STATE_EMIT_MSG_EVENT:
 		msg_it->state = STATE_DSCOPE_EVENT_HEADER_BEGIN;
 		break;
+	case STATE_SKIP_EXCLUDED_EVENT:
+		msg_it->skipping_event = false;
+		msg_it->dry_run = false;
+		msg_it->state = STATE_DSCOPE_EVENT_HEADER_BEGIN;
+		break;
 	case STATE_EMIT_QUEUED_MSG_EVENT:
 		msg_it->state = STATE_EMIT_MSG_EVENT;
 		break;
@@ -1778,7 +2180,7 @@ enum ctf_msg_iter_status handle_state(struct ctf_msg_iter *msg_it)
 		bt_common_abort();
 	}
 
-	BT_COMP_LOGT("Handled state: msg-it-addr=%p, status=%s, "
+	BT_COMP_LOGT_FP("Handled state: msg-it-addr=%p, status=%s, "
 		"prev-state=%s, cur-state=%s",
 		msg_it, ctf_msg_iter_status_string(status),
 		state_string(state), state_string(msg_it->state));
@@ -1799,6 +2201,16 @@ void ctf_msg_iter_reset_for_next_stream_file(struct ctf_msg_iter *msg_it)
 	release_all_dscopes(msg_it);
 	msg_it->cur_dscope_field = NULL;
 
+	if (msg_it->skipping_event) {
+		msg_it->skipping_event = false;
+		msg_it->dry_run = false;
+	}
+
+	if (msg_it->skipping_packet_context) {
+		msg_it->skipping_packet_context = false;
+		msg_it->dry_run = false;
+	}
+
 	msg_it->buf.addr = NULL;
 	msg_it->buf.sz = 0;
 	msg_it->buf.at = 0;
@@ -1875,111 +2287,28 @@ bt_field *borrow_next_field(struct ctf_msg_iter *msg_it)
 	return next_field;
 }
 
-static
-void update_default_clock(struct ctf_msg_iter *msg_it, uint64_t new_val,
-		uint64_t new_val_size)
-{
-	uint64_t new_val_mask;
-	uint64_t cur_value_masked;
-
-	BT_ASSERT_DBG(new_val_size > 0);
-
-	/*
-	 * Special case for a 64-bit new value, which is the limit
-	 * of a clock value as of this version: overwrite the
-	 * current value directly.
-	 */
-	if (new_val_size == 64) {
-		msg_it->default_clock_snapshot = new_val;
-		goto end;
-	}
-
-	new_val_mask = (1ULL << new_val_size) - 1;
-	cur_value_masked = msg_it->default_clock_snapshot & new_val_mask;
-
-	if (new_val < cur_value_masked) {
-		/*
-		 * It looks like a wrap happened on the number of bits
-		 * of the requested new value. Assume that the clock
-		 * value wrapped only one time.
-		 */
-		msg_it->default_clock_snapshot += new_val_mask + 1;
-	}
-
-	/* Clear the low bits of the current clock value. */
-	msg_it->default_clock_snapshot &= ~new_val_mask;
-
-	/* Set the low bits of the current clock value. */
-	msg_it->default_clock_snapshot |= new_val;
-
-end:
-	BT_COMP_LOGT("Updated default clock's value from integer field's value: "
-		"value=%" PRIu64, msg_it->default_clock_snapshot);
-}
-
 static
 enum bt_bfcr_status bfcr_unsigned_int_cb(uint64_t value,
 		struct ctf_field_class *fc, void *data)
 {
 	struct ctf_msg_iter *msg_it = data;
-	bt_self_component *self_comp = msg_it->self_comp;
 	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
 
 	bt_field *field = NULL;
 	struct ctf_field_class_int *int_fc = (void *) fc;
 
-	BT_COMP_LOGT("Unsigned integer function called from BFCR: "
+	BT_COMP_LOGT_FP("Unsigned integer function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, value=%" PRIu64,
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
 
-	if (G_LIKELY(int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE)) {
-		goto update_def_clock;
-	}
-
-	switch (int_fc->meaning) {
-	case CTF_FIELD_CLASS_MEANING_EVENT_CLASS_ID:
-		msg_it->cur_event_class_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_DATA_STREAM_ID:
-		msg_it->cur_data_stream_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_BEGINNING_TIME:
-		msg_it->snapshots.beginning_clock = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_END_TIME:
-		msg_it->snapshots.end_clock = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_STREAM_CLASS_ID:
-		msg_it->cur_stream_class_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_MAGIC:
-		if (value != 0xc1fc1fc1) {
-			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-				"Invalid CTF magic number: msg-it-addr=%p, "
-				"magic=%" PRIx64, msg_it, value);
-			status = BT_BFCR_STATUS_ERROR;
-			goto end;
-		}
-
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_COUNTER_SNAPSHOT:
-		msg_it->snapshots.packets = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_DISC_EV_REC_COUNTER_SNAPSHOT:
-		msg_it->snapshots.discarded_events = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_TOTAL_SIZE:
-		msg_it->cur_exp_packet_total_size = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_CONTENT_SIZE:
-		msg_it->cur_exp_packet_content_size = value;
-		break;
-	default:
-		bt_common_abort();
+	if (G_UNLIKELY(int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE) &&
+			set_meaningful_unsigned_int_value(msg_it, int_fc,
+				value)) {
+		status = BT_BFCR_STATUS_ERROR;
+		goto end;
 	}
 
-update_def_clock:
 	if (G_UNLIKELY(int_fc->mapped_clock_class)) {
 		update_default_clock(msg_it, value, int_fc->base.size);
 	}
@@ -2017,7 +2346,7 @@ enum bt_bfcr_status bfcr_unsigned_int_char_cb(uint64_t value,
 	struct ctf_field_class_int *int_fc = (void *) fc;
 	char str[2] = {'\0', '\0'};
 
-	BT_COMP_LOGT("Unsigned integer character function called from BFCR: "
+	BT_COMP_LOGT_FP("Unsigned integer character function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, value=%" PRIu64,
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
@@ -2058,6 +2387,61 @@ end:
 	return status;
 }
 
+static
+enum bt_bfcr_status bfcr_text_array_cb(const char *chars, uint64_t count,
+		struct ctf_field_class *fc, void *data)
+{
+	int ret;
+	struct ctf_msg_iter *msg_it = data;
+	bt_self_component *self_comp = msg_it->self_comp;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	bt_field *string_field = NULL;
+	const char *nul;
+	uint64_t len = count;
+
+	BT_COMP_LOGT_FP("Text array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%" PRIu64,
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	if (msg_it->done_filling_string) {
+		goto end;
+	}
+
+	/* Stop at the first null character, if any */
+	nul = memchr(chars, '\0', count);
+	if (nul) {
+		len = (uint64_t) (nul - chars);
+		msg_it->done_filling_string = true;
+	}
+
+	if (len == 0) {
+		goto end;
+	}
+
+	string_field = stack_top(msg_it->stack)->base;
+	BT_ASSERT_DBG(bt_field_get_class_type(string_field) ==
+		BT_FIELD_CLASS_TYPE_STRING);
+
+	/* Append characters */
+	ret = bt_field_string_append_with_length(string_field, chars, len);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot append characters to string field's value: "
+			"msg-it-addr=%p, field-addr=%p, length=%" PRIu64 ", "
+			"ret=%d", msg_it, string_field, len, ret);
+		status = BT_BFCR_STATUS_ERROR;
+		goto end;
+	}
+
+end:
+	return status;
+}
+
 static
 enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 		struct ctf_field_class *fc, void *data)
@@ -2067,7 +2451,7 @@ enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 	struct ctf_msg_iter *msg_it = data;
 	struct ctf_field_class_int *int_fc = (void *) fc;
 
-	BT_COMP_LOGT("Signed integer function called from BFCR: "
+	BT_COMP_LOGT_FP("Signed integer function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, value=%" PRId64,
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
@@ -2094,6 +2478,113 @@ end:
 	return status;
 }
 
+static
+enum bt_bfcr_status bfcr_unsigned_int_array_cb(const uint64_t *values,
+		uint64_t count, struct ctf_field_class *fc, void *data)
+{
+	struct ctf_msg_iter *msg_it = data;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_int *int_fc = (void *) fc;
+	struct stack_entry *top;
+	uint64_t i;
+
+	BT_COMP_LOGT_FP("Unsigned integer array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%" PRIu64,
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+
+	if (G_UNLIKELY(int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+			int_fc->mapped_clock_class ||
+			int_fc->storing_index >= 0)) {
+		/* Special element: handle each value individually */
+		for (i = 0; i < count; i++) {
+			status = bfcr_unsigned_int_cb(values[i], fc, data);
+			if (status != BT_BFCR_STATUS_OK) {
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	top = stack_top(msg_it->stack);
+	BT_ASSERT_DBG(bt_field_class_type_is(
+		bt_field_get_class_type(top->base),
+		BT_FIELD_CLASS_TYPE_ARRAY));
+	BT_ASSERT_DBG(top->index + count <=
+		bt_field_array_get_length(top->base));
+
+	for (i = 0; i < count; i++) {
+		bt_field *field = bt_field_array_borrow_element_field_by_index(
+			top->base, top->index + i);
+
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		bt_field_integer_unsigned_set_value(field, values[i]);
+	}
+
+	top->index += count;
+
+end:
+	return status;
+}
+
+static
+enum bt_bfcr_status bfcr_signed_int_array_cb(const int64_t *values,
+		uint64_t count, struct ctf_field_class *fc, void *data)
+{
+	struct ctf_msg_iter *msg_it = data;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_int *int_fc = (void *) fc;
+	struct stack_entry *top;
+	uint64_t i;
+
+	BT_COMP_LOGT_FP("Signed integer array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%" PRIu64,
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+	BT_ASSERT_DBG(int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE);
+
+	if (G_UNLIKELY(int_fc->storing_index >= 0)) {
+		/* Stored element: handle each value individually */
+		for (i = 0; i < count; i++) {
+			status = bfcr_signed_int_cb(values[i], fc, data);
+			if (status != BT_BFCR_STATUS_OK) {
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	top = stack_top(msg_it->stack);
+	BT_ASSERT_DBG(bt_field_class_type_is(
+		bt_field_get_class_type(top->base),
+		BT_FIELD_CLASS_TYPE_ARRAY));
+	BT_ASSERT_DBG(top->index + count <=
+		bt_field_array_get_length(top->base));
+
+	for (i = 0; i < count; i++) {
+		bt_field *field = bt_field_array_borrow_element_field_by_index(
+			top->base, top->index + i);
+
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		bt_field_integer_signed_set_value(field, values[i]);
+	}
+
+	top->index += count;
+
+end:
+	return status;
+}
+
 static
 enum bt_bfcr_status bfcr_floating_point_cb(double value,
 		struct ctf_field_class *fc, void *data)
@@ -2103,7 +2594,7 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 	struct ctf_msg_iter *msg_it = data;
 	bt_field_class_type type;
 
-	BT_COMP_LOGT("Floating point number function called from BFCR: "
+	BT_COMP_LOGT_FP("Floating point number function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, value=%f",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
@@ -2136,7 +2627,7 @@ enum bt_bfcr_status bfcr_string_begin_cb(
 	bt_field *field = NULL;
 	struct ctf_msg_iter *msg_it = data;
 
-	BT_COMP_LOGT("String (beginning) function called from BFCR: "
+	BT_COMP_LOGT_FP("String (beginning) function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
@@ -2173,7 +2664,7 @@ enum bt_bfcr_status bfcr_string_cb(const char *value,
 	bt_self_component *self_comp = msg_it->self_comp;
 	int ret;
 
-	BT_COMP_LOGT("String (substring) function called from BFCR: "
+	BT_COMP_LOGT_FP("String (substring) function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, string-length=%zu",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir,
@@ -2207,7 +2698,7 @@ enum bt_bfcr_status bfcr_string_end_cb(
 {
 	struct ctf_msg_iter *msg_it = data;
 
-	BT_COMP_LOGT("String (end) function called from BFCR: "
+	BT_COMP_LOGT_FP("String (end) function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
@@ -2233,7 +2724,7 @@ enum bt_bfcr_status bfcr_compound_begin_cb(
 	struct ctf_msg_iter *msg_it = data;
 	bt_field *field;
 
-	BT_COMP_LOGT("Compound (beginning) function called from BFCR: "
+	BT_COMP_LOGT_FP("Compound (beginning) function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
@@ -2284,7 +2775,7 @@ enum bt_bfcr_status bfcr_compound_end_cb(
 {
 	struct ctf_msg_iter *msg_it = data;
 
-	BT_COMP_LOGT("Compound (end) function called from BFCR: "
+	BT_COMP_LOGT_FP("Compound (end) function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
@@ -2376,7 +2867,6 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 		struct ctf_field_class *fc, void *data)
 {
 	int ret;
-	uint64_t i;
 	int64_t option_index = -1;
 	struct ctf_msg_iter *msg_it = data;
 	struct ctf_field_class_variant *var_fc = (void *) fc;
@@ -2392,34 +2882,9 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 	tag.u = g_array_index(msg_it->stored_values, uint64_t,
 		var_fc->stored_tag_index);
 
-	/*
-	 * Check each range to find the selected option's index.
-	 */
-	if (var_fc->tag_fc->base.is_signed) {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.i >= range->range.lower.i &&
-					tag.i <= range->range.upper.i) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	} else {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.u >= range->range.lower.u &&
-					tag.u <= range->range.upper.u) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	}
+	/* Find the selected option's index */
+	option_index = ctf_field_class_variant_find_option_index(var_fc,
+		tag.u);
 
 	if (option_index < 0) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -2570,28 +3035,15 @@ bt_message *emit_delayed_packet_beg_msg(struct ctf_msg_iter *msg_it)
 }
 
 
+/*
+ * Updates the default clock snapshot of `msg_it` from the end time of
+ * the current packet, unless a known tracer quirk makes this end time
+ * wrong.
+ */
 static
-bt_message *create_msg_packet_end(struct ctf_msg_iter *msg_it)
+void update_default_clock_snapshot_at_packet_end(struct ctf_msg_iter *msg_it)
 {
-	bt_message *msg;
 	bool update_default_cs = true;
-	bt_self_component *self_comp = msg_it->self_comp;
-
-	if (!msg_it->packet) {
-		msg = NULL;
-		goto end;
-	}
-
-	/*
-	 * Check if we need to emit the delayed packet
-	 * beginning message instead of the packet end message.
-	 */
-	if (G_UNLIKELY(msg_it->emit_delayed_packet_beginning_msg)) {
-		msg = emit_delayed_packet_beg_msg(msg_it);
-		/* Don't forget to emit the packet end message. */
-		msg_it->state = STATE_EMIT_QUEUED_MSG_PACKET_END;
-		goto end;
-	}
 
 	/* Check if may be affected by lttng-crash timestamp_end quirk. */
 	if (G_UNLIKELY(msg_it->meta.tc->quirks.lttng_crash)) {
@@ -2630,7 +3082,31 @@ bt_message *create_msg_packet_end(struct ctf_msg_iter *msg_it)
 	if (msg_it->snapshots.end_clock != UINT64_C(-1) && update_default_cs) {
 		msg_it->default_clock_snapshot = msg_it->snapshots.end_clock;
 	}
+}
+
+static
+bt_message *create_msg_packet_end(struct ctf_msg_iter *msg_it)
+{
+	bt_message *msg;
+	bt_self_component *self_comp = msg_it->self_comp;
+
+	if (!msg_it->packet) {
+		msg = NULL;
+		goto end;
+	}
+
+	/*
+	 * Check if we need to emit the delayed packet
+	 * beginning message instead of the packet end message.
+	 */
+	if (G_UNLIKELY(msg_it->emit_delayed_packet_beginning_msg)) {
+		msg = emit_delayed_packet_beg_msg(msg_it);
+		/* Don't forget to emit the packet end message. */
+		msg_it->state = STATE_EMIT_QUEUED_MSG_PACKET_END;
+		goto end;
+	}
 
+	update_default_clock_snapshot_at_packet_end(msg_it);
 	BT_ASSERT(msg_it->self_msg_iter);
 
 	if (msg_it->meta.sc->packets_have_ts_end) {
@@ -2766,6 +3242,9 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 		.classes = {
 			.signed_int = bfcr_signed_int_cb,
 			.unsigned_int = bfcr_unsigned_int_cb,
+			.signed_int_array = bfcr_signed_int_array_cb,
+			.unsigned_int_array = bfcr_unsigned_int_array_cb,
+			.text_array = bfcr_text_array_cb,
 			.floating_point = bfcr_floating_point_cb,
 			.string_begin = bfcr_string_begin_cb,
 			.string = bfcr_string_cb,
@@ -2861,17 +3340,13 @@ void ctf_msg_iter_destroy(struct ctf_msg_iter *msg_it)
 	g_free(msg_it);
 }
 
-enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
-		struct ctf_msg_iter *msg_it,
+static inline
+enum ctf_msg_iter_status get_next_message(struct ctf_msg_iter *msg_it,
 		const bt_message **message)
 {
 	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
 	bt_self_component *self_comp = msg_it->self_comp;
 
-	BT_ASSERT_DBG(msg_it);
-	BT_ASSERT_DBG(message);
-	BT_COMP_LOGD("Getting next message: msg-it-addr=%p", msg_it);
-
 	while (true) {
 		status = handle_state(msg_it);
 		if (G_UNLIKELY(status == CTF_MSG_ITER_STATUS_AGAIN)) {
@@ -2928,7 +3403,10 @@ enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 
 			goto end;
 		case STATE_EMIT_MSG_PACKET_BEGINNING:
-			if (G_UNLIKELY(msg_it->meta.tc->quirks.barectf_event_before_packet)) {
+			if (G_UNLIKELY(msg_it->meta.sc->ir_sc_has_no_packets)) {
+				/* No packet beginning message to return */
+				break;
+			} else if (G_UNLIKELY(msg_it->meta.tc->quirks.barectf_event_before_packet)) {
 				msg_it->emit_delayed_packet_beginning_msg = true;
 				/*
 				 * There is no message to return yet as this
@@ -2948,6 +3426,17 @@ enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 			goto end;
 		case STATE_EMIT_MSG_PACKET_END_SINGLE:
 		case STATE_EMIT_MSG_PACKET_END_MULTI:
+			if (G_UNLIKELY(msg_it->meta.sc->ir_sc_has_no_packets)) {
+				/*
+				 * No packet end message to return, but
+				 * the next messages still need the
+				 * packet's end time.
+				 */
+				update_default_clock_snapshot_at_packet_end(
+					msg_it);
+				break;
+			}
+
 			/* create_msg_packet_end() logs errors */
 			*message = create_msg_packet_end(msg_it);
 
@@ -2990,6 +3479,44 @@ end:
 	return status;
 }
 
+enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
+		struct ctf_msg_iter *msg_it,
+		const bt_message **message)
+{
+	BT_ASSERT_DBG(msg_it);
+	BT_ASSERT_DBG(message);
+	BT_COMP_LOGD_FP("Getting next message: msg-it-addr=%p", msg_it);
+	return get_next_message(msg_it, message);
+}
+
+enum ctf_msg_iter_status ctf_msg_iter_get_next_messages(
+		struct ctf_msg_iter *msg_it,
+		const bt_message **messages, uint64_t capacity,
+		uint64_t *count)
+{
+	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
+	uint64_t i = 0;
+
+	BT_ASSERT_DBG(msg_it);
+	BT_ASSERT_DBG(messages);
+	BT_ASSERT_DBG(capacity > 0);
+	BT_ASSERT_DBG(count);
+	BT_COMP_LOGD_FP("Getting next messages: msg-it-addr=%p, capacity=%" PRIu64,
+		msg_it, capacity);
+
+	while (i < capacity) {
+		status = get_next_message(msg_it, &messages[i]);
+		if (status != CTF_MSG_ITER_STATUS_OK) {
+			break;
+		}
+
+		i++;
+	}
+
+	*count = i;
+	return status;
+}
+
 static
 enum ctf_msg_iter_status decode_until_state( struct ctf_msg_iter *msg_it,
 		enum state target_state_1, enum state target_state_2)
@@ -3046,6 +3573,7 @@ enum ctf_msg_iter_status decode_until_state( struct ctf_msg_iter *msg_it,
 		case STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE:
 		case STATE_EMIT_MSG_EVENT:
 		case STATE_EMIT_QUEUED_MSG_EVENT:
+		case STATE_SKIP_EXCLUDED_EVENT:
 		case STATE_SKIP_PACKET_PADDING:
 		case STATE_EMIT_MSG_PACKET_END_MULTI:
 		case STATE_EMIT_MSG_PACKET_END_SINGLE:
@@ -3179,9 +3707,59 @@ end:
 	return status;
 }
 
+BT_HIDDEN
+enum ctf_msg_iter_status ctf_msg_iter_get_packet_event_class_bits(
+		struct ctf_msg_iter *msg_it, uint64_t *event_class_bits)
+{
+	enum ctf_msg_iter_status status;
+	bt_self_component *self_comp = msg_it->self_comp;
+
+	BT_ASSERT_DBG(msg_it);
+	BT_ASSERT_DBG(msg_it->dry_run);
+	BT_ASSERT_DBG(event_class_bits);
+	*event_class_bits = 0;
+
+	/*
+	 * Not decode_until_state(): the packet may end in any of two
+	 * states, and we also need to stop after each event header.
+	 */
+	while (msg_it->state != STATE_EMIT_MSG_PACKET_END_MULTI &&
+			msg_it->state != STATE_EMIT_MSG_PACKET_END_SINGLE) {
+		const bool after_event_header =
+			msg_it->state == STATE_AFTER_EVENT_HEADER;
+
+		BT_ASSERT_DBG(msg_it->state != STATE_DONE);
+		status = handle_state(msg_it);
+		if (status != CTF_MSG_ITER_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot handle state: msg-it-addr=%p, state=%s",
+				msg_it, state_string(msg_it->state));
+			goto end;
+		}
+
+		if (after_event_header) {
+			/* handle_state() set the current event class */
+			*event_class_bits |= ctf_msg_iter_event_class_id_bit(
+				(uint64_t) msg_it->meta.ec->id);
+		}
+	}
+
+	status = CTF_MSG_ITER_STATUS_OK;
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 		bool val)
 {
 	msg_it->dry_run = val;
 }
+
+BT_HIDDEN
+void ctf_msg_iter_set_skip_event_records(struct ctf_msg_iter *msg_it,
+		bool val)
+{
+	msg_it->skip_event_records = val;
+}
@@ -266,6 +266,33 @@ enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 		struct ctf_msg_iter *msg_it,
 		const bt_message **message);
 
+/**
+ * Returns up to \p capacity next messages.
+ *
+ * This is equivalent to calling ctf_msg_iter_get_next_message() until
+ * it returns something else than #CTF_MSG_ITER_STATUS_OK or until
+ * \p messages contains \p capacity messages, but without leaving the
+ * decoding loop between messages.
+ *
+ * In all cases, \p count is set to the number of messages written to
+ * \p messages, which the caller owns. #CTF_MSG_ITER_STATUS_OK is
+ * returned if \p messages is full; otherwise, the returned status is
+ * the one which stopped the decoding (#CTF_MSG_ITER_STATUS_EOF,
+ * #CTF_MSG_ITER_STATUS_AGAIN, or an error).
+ *
+ * @param msg_iter		CTF message iterator
+ * @param messages		Returned messages
+ * @param capacity		Capacity of \p messages (greater than 0)
+ * @param count			Returned number of messages written to
+ *				\p messages
+ * @returns			One of #ctf_msg_iter_status values
+ */
+BT_HIDDEN
+enum ctf_msg_iter_status ctf_msg_iter_get_next_messages(
+		struct ctf_msg_iter *msg_it,
+		const bt_message **messages, uint64_t capacity,
+		uint64_t *count);
+
 struct ctf_msg_iter_packet_properties {
 	int64_t exp_packet_total_size;
 	int64_t exp_packet_content_size;
@@ -293,6 +320,29 @@ BT_HIDDEN
 enum ctf_msg_iter_status ctf_msg_iter_curr_packet_last_event_clock_snapshot(
 		struct ctf_msg_iter *msg_it, uint64_t *last_event_cs);
 
+/*
+ * Decodes the current packet until its end, in dry-run mode, and sets
+ * `*event_class_bits` to the bitwise OR of
+ * ctf_msg_iter_event_class_id_bit() for the IDs of the event classes
+ * of its event records.
+ */
+BT_HIDDEN
+enum ctf_msg_iter_status ctf_msg_iter_get_packet_event_class_bits(
+		struct ctf_msg_iter *msg_it, uint64_t *event_class_bits);
+
+/*
+ * Bit of a packet's event class bit set for the event class ID `id`.
+ *
+ * Such a bit set is a single-hash Bloom filter: with dense event class
+ * IDs, as all known tracers produce, it's exact for stream classes
+ * having up to 64 event classes.
+ */
+static inline
+uint64_t ctf_msg_iter_event_class_id_bit(uint64_t id)
+{
+	return UINT64_C(1) << (id % 64);
+}
+
 BT_HIDDEN
 enum ctf_msg_iter_status ctf_msg_iter_seek(
 		struct ctf_msg_iter *msg_it, off_t offset);
@@ -317,6 +367,17 @@ BT_HIDDEN
 void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 		bool val);
 
+/*
+ * Makes the iterator emit no event messages, only stream, packet, and
+ * discarded item messages.
+ *
+ * When a packet's content size is known, the iterator skips its event
+ * records without decoding them.
+ */
+BT_HIDDEN
+void ctf_msg_iter_set_skip_event_records(struct ctf_msg_iter *msg_it,
+		bool val);
+
 static inline
 const char *ctf_msg_iter_medium_status_string(
 		enum ctf_msg_iter_medium_status status)
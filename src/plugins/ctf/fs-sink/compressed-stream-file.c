@@ -0,0 +1,385 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (cfile->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (cfile->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.CTF.FS/COMPRESSED"
+#include "logging/comp-logging.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "compat/endian.h"
+#include "compressed-stream-file.h"
+
+#ifdef ENABLE_ZSTD
+# include <zstd.h>
+#endif
+
+BT_HIDDEN
+bool fs_sink_compressed_stream_file_is_supported(void)
+{
+#ifdef ENABLE_ZSTD
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef ENABLE_ZSTD
+
+/*
+ * zstd seekable format (see `contrib/seekable_format` in the zstd
+ * repository): the seek table is a skippable frame with this magic
+ * number, containing one entry per frame, followed by a footer.
+ */
+#define SEEK_TABLE_SKIPPABLE_MAGIC	UINT32_C(0x184D2A5E)
+#define SEEK_TABLE_FOOTER_MAGIC		UINT32_C(0x8F92EAB1)
+
+struct seek_table_entry {
+	uint32_t compressed_size;
+	uint32_t decompressed_size;
+} __attribute__((__packed__));
+
+struct seek_table_footer {
+	uint32_t frame_count;
+
+	/* Bit 7: entries have a checksum (never set here) */
+	uint8_t descriptor;
+
+	uint32_t magic;
+} __attribute__((__packed__));
+
+struct fs_sink_compressed_stream_file {
+	bt_logging_level log_level;
+
+	/* Weak */
+	bt_self_component *self_comp;
+
+	GString *path;
+	FILE *fp;
+
+	/* Owned by this */
+	ZSTD_CCtx *cctx;
+
+	/* Compressed frame buffer (owned by this) */
+	uint8_t *buf;
+	size_t buf_size;
+
+	/*
+	 * Array of `struct seek_table_entry` (little-endian), one per
+	 * written frame.
+	 */
+	GArray *seek_table;
+
+	/*
+	 * False if a frame or its content is too large for a seek
+	 * table entry: the file then has no seek table.
+	 */
+	bool has_seek_table;
+
+	/* True if writing the file failed */
+	bool failed;
+
+	/*
+	 * True if fs_sink_compressed_stream_file_suspend() closed `fp`
+	 * without finishing the file.
+	 */
+	bool is_suspended;
+};
+
+BT_HIDDEN
+struct fs_sink_compressed_stream_file *fs_sink_compressed_stream_file_create(
+		const char *path, guint thread_count,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct fs_sink_compressed_stream_file *cfile =
+		g_new0(struct fs_sink_compressed_stream_file, 1);
+	size_t zret;
+
+	if (!cfile) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+			"Failed to allocate one compressed stream file.");
+		goto error;
+	}
+
+	cfile->log_level = log_level;
+	cfile->self_comp = self_comp;
+	cfile->has_seek_table = true;
+	cfile->path = g_string_new(path);
+	BT_ASSERT(cfile->path);
+	cfile->seek_table = g_array_new(FALSE, FALSE,
+		sizeof(struct seek_table_entry));
+	BT_ASSERT(cfile->seek_table);
+	cfile->cctx = ZSTD_createCCtx();
+	if (!cfile->cctx) {
+		BT_COMP_LOGE_STR("Failed to create zstd compression context.");
+		goto error;
+	}
+
+	if (thread_count > 0) {
+		zret = ZSTD_CCtx_setParameter(cfile->cctx, ZSTD_c_nbWorkers,
+			(int) thread_count);
+		if (ZSTD_isError(zret)) {
+			/* libzstd built without multithreading support */
+			BT_COMP_LOGI("Cannot compress with worker threads: "
+				"compressing on the component's thread: "
+				"path=\"%s\", error=\"%s\"", path,
+				ZSTD_getErrorName(zret));
+		}
+	}
+
+	cfile->fp = fopen(path, "wb");
+	if (!cfile->fp) {
+		BT_COMP_LOGE_ERRNO("Cannot open compressed stream file for writing",
+			": path=\"%s\"", path);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	fs_sink_compressed_stream_file_destroy(cfile);
+	cfile = NULL;
+
+end:
+	return cfile;
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_write_frame(
+		struct fs_sink_compressed_stream_file *cfile,
+		const uint8_t *data, size_t len)
+{
+	size_t bound = ZSTD_compressBound(len);
+	size_t frame_size;
+	int ret = 0;
+
+	if (bound > cfile->buf_size) {
+		g_free(cfile->buf);
+		cfile->buf = g_malloc(bound);
+		if (!cfile->buf) {
+			BT_COMP_LOGE("Failed to allocate compressed frame buffer: "
+				"size=%zu", bound);
+			cfile->buf_size = 0;
+			goto error;
+		}
+
+		cfile->buf_size = bound;
+	}
+
+	/* This also writes the content size in the frame header */
+	frame_size = ZSTD_compress2(cfile->cctx, cfile->buf, cfile->buf_size,
+		data, len);
+	if (ZSTD_isError(frame_size)) {
+		BT_COMP_LOGE("Cannot compress packet: path=\"%s\", "
+			"size=%zu, error=\"%s\"", cfile->path->str, len,
+			ZSTD_getErrorName(frame_size));
+		goto error;
+	}
+
+	if (fwrite(cfile->buf, frame_size, 1, cfile->fp) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write compressed stream file",
+			": path=\"%s\", size=%zu", cfile->path->str,
+			frame_size);
+		goto error;
+	}
+
+	if (frame_size > UINT32_MAX || len > UINT32_MAX) {
+		cfile->has_seek_table = false;
+	}
+
+	if (cfile->has_seek_table) {
+		struct seek_table_entry entry;
+
+		entry.compressed_size = htole32((uint32_t) frame_size);
+		entry.decompressed_size = htole32((uint32_t) len);
+		g_array_append_val(cfile->seek_table, entry);
+	}
+
+	goto end;
+
+error:
+	cfile->failed = true;
+	ret = -1;
+
+end:
+	return ret;
+}
+
+static
+int write_seek_table(struct fs_sink_compressed_stream_file *cfile)
+{
+	uint32_t hdr[2];
+	struct seek_table_footer footer;
+	size_t entries_size = cfile->seek_table->len *
+		sizeof(struct seek_table_entry);
+	int ret = 0;
+
+	hdr[0] = htole32(SEEK_TABLE_SKIPPABLE_MAGIC);
+	hdr[1] = htole32((uint32_t) (entries_size + sizeof(footer)));
+	footer.frame_count = htole32(cfile->seek_table->len);
+	footer.descriptor = 0;
+	footer.magic = htole32(SEEK_TABLE_FOOTER_MAGIC);
+
+	if (fwrite(hdr, sizeof(hdr), 1, cfile->fp) != 1 ||
+			(entries_size > 0 &&
+				fwrite(cfile->seek_table->data, entries_size, 1,
+					cfile->fp) != 1) ||
+			fwrite(&footer, sizeof(footer), 1, cfile->fp) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write compressed stream file's seek table",
+			": path=\"%s\"", cfile->path->str);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_suspend(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	int ret = 0;
+
+	BT_ASSERT(cfile->fp);
+	BT_ASSERT(!cfile->is_suspended);
+
+	if (fclose(cfile->fp)) {
+		BT_COMP_LOGE_ERRNO("Cannot close compressed stream file",
+			": path=\"%s\"", cfile->path->str);
+		cfile->failed = true;
+		ret = -1;
+	}
+
+	cfile->fp = NULL;
+	cfile->is_suspended = true;
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_resume(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	int ret = 0;
+
+	BT_ASSERT(!cfile->fp);
+	BT_ASSERT(cfile->is_suspended);
+
+	/* Keep the frames written so far */
+	cfile->fp = fopen(cfile->path->str, "ab");
+	if (!cfile->fp) {
+		BT_COMP_LOGE_ERRNO("Cannot reopen compressed stream file for writing",
+			": path=\"%s\"", cfile->path->str);
+		cfile->failed = true;
+		ret = -1;
+		goto end;
+	}
+
+	cfile->is_suspended = false;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void fs_sink_compressed_stream_file_destroy(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	if (!cfile) {
+		goto end;
+	}
+
+	if (cfile->is_suspended) {
+		/* Reopen the file to append its seek table below */
+		(void) fs_sink_compressed_stream_file_resume(cfile);
+	}
+
+	if (cfile->fp) {
+		if (!cfile->failed && cfile->has_seek_table) {
+			(void) write_seek_table(cfile);
+		}
+
+		if (fclose(cfile->fp)) {
+			BT_COMP_LOGE_ERRNO("Cannot close compressed stream file",
+				": path=\"%s\"", cfile->path->str);
+		}
+
+		cfile->fp = NULL;
+	}
+
+	ZSTD_freeCCtx(cfile->cctx);
+	cfile->cctx = NULL;
+	g_free(cfile->buf);
+	cfile->buf = NULL;
+
+	if (cfile->seek_table) {
+		g_array_free(cfile->seek_table, TRUE);
+		cfile->seek_table = NULL;
+	}
+
+	if (cfile->path) {
+		g_string_free(cfile->path, TRUE);
+		cfile->path = NULL;
+	}
+
+	g_free(cfile);
+
+end:
+	return;
+}
+
+#else /* ENABLE_ZSTD */
+
+struct fs_sink_compressed_stream_file {
+	int unused;
+};
+
+BT_HIDDEN
+struct fs_sink_compressed_stream_file *fs_sink_compressed_stream_file_create(
+		const char *path, guint thread_count,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+		"Cannot write compressed data stream file: "
+		"Babeltrace was built without zstd support "
+		"(see the `--enable-zstd` configuration option): path=\"%s\"",
+		path);
+	return NULL;
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_write_frame(
+		struct fs_sink_compressed_stream_file *cfile,
+		const uint8_t *data, size_t len)
+{
+	bt_common_abort();
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_suspend(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	bt_common_abort();
+}
+
+BT_HIDDEN
+int fs_sink_compressed_stream_file_resume(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	bt_common_abort();
+}
+
+BT_HIDDEN
+void fs_sink_compressed_stream_file_destroy(
+		struct fs_sink_compressed_stream_file *cfile)
+{
+	BT_ASSERT(!cfile);
+}
+
+#endif /* ENABLE_ZSTD */
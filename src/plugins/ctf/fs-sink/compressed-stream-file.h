@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_CTF_FS_SINK_COMPRESSED_STREAM_FILE_H
+#define BABELTRACE_PLUGIN_CTF_FS_SINK_COMPRESSED_STREAM_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/* Suffix of the name of a zstd-compressed data stream file */
+#define FS_SINK_COMPRESSED_STREAM_FILE_ZSTD_SUFFIX	".zst"
+
+/*
+ * zstd-compressed data stream file being written.
+ *
+ * Each packet becomes one zstd frame, so that `src.ctf.fs` can read
+ * the file at any packet by decompressing a single frame. Closing the
+ * file appends a seek table in the zstd seekable format, a skippable
+ * frame which maps each frame to its compressed and decompressed sizes.
+ */
+struct fs_sink_compressed_stream_file;
+
+/*
+ * Returns whether or not Babeltrace was built with zstd support.
+ */
+BT_HIDDEN
+bool fs_sink_compressed_stream_file_is_supported(void);
+
+/*
+ * Creates the compressed data stream file `path`.
+ *
+ * If `thread_count` is greater than 0, libzstd compresses each frame
+ * with `thread_count` worker threads, if it supports them.
+ */
+BT_HIDDEN
+struct fs_sink_compressed_stream_file *fs_sink_compressed_stream_file_create(
+		const char *path, guint thread_count,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+/*
+ * Compresses the `len` bytes of `data` (one packet) as a new frame of
+ * `cfile`.
+ */
+BT_HIDDEN
+int fs_sink_compressed_stream_file_write_frame(
+		struct fs_sink_compressed_stream_file *cfile,
+		const uint8_t *data, size_t len);
+
+/*
+ * Closes the underlying file of `cfile` without finishing it, keeping
+ * its compression state and seek table in memory, so that the
+ * component does not keep a file descriptor open for an idle stream.
+ */
+BT_HIDDEN
+int fs_sink_compressed_stream_file_suspend(
+		struct fs_sink_compressed_stream_file *cfile);
+
+/*
+ * Reopens the underlying file of `cfile`, which
+ * fs_sink_compressed_stream_file_suspend() closed, to append new
+ * frames to it.
+ */
+BT_HIDDEN
+int fs_sink_compressed_stream_file_resume(
+		struct fs_sink_compressed_stream_file *cfile);
+
+/*
+ * Writes the seek table of `cfile`, closes it, and destroys it.
+ */
+BT_HIDDEN
+void fs_sink_compressed_stream_file_destroy(
+		struct fs_sink_compressed_stream_file *cfile);
+
+#endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_COMPRESSED_STREAM_FILE_H */
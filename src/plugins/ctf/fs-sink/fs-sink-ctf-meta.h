@@ -123,6 +123,15 @@ struct fs_sink_ctf_event_class {
 
 	/* Owned by this */
 	struct fs_sink_ctf_field_class *payload_fc;
+
+	/*
+	 * Serialization programs of `spec_context_fc` and `payload_fc`
+	 * (arrays of `struct fs_sink_write_op`, owned by this), built
+	 * by `fs-sink-stream.c` when it first writes an event of this
+	 * class, or `NULL` if not built yet.
+	 */
+	GArray *spec_context_write_ops;
+	GArray *payload_write_ops;
 };
 
 struct fs_sink_ctf_trace;
@@ -151,9 +160,22 @@ struct fs_sink_ctf_stream_class {
 	/* Owned by this */
 	struct fs_sink_ctf_field_class *event_common_context_fc;
 
+	/*
+	 * Serialization program of `event_common_context_fc` (see
+	 * `struct fs_sink_ctf_event_class`)
+	 */
+	GArray *event_common_context_write_ops;
+
 	/* Array of `struct fs_sink_ctf_event_class *` (owned by this) */
 	GPtrArray *event_classes;
 
+	/*
+	 * Number of event classes of `event_classes`, from the first
+	 * one, which `fs-sink-trace.c` already wrote to the metadata
+	 * file.
+	 */
+	guint metadata_event_class_count;
+
 	/*
 	 * `const bt_event_class *` (weak) ->
 	 * `struct fs_sink_ctf_event_class *` (weak)
@@ -172,6 +194,13 @@ struct fs_sink_ctf_trace {
 
 	/* Array of `struct fs_sink_ctf_stream_class *` (owned by this) */
 	GPtrArray *stream_classes;
+
+	/*
+	 * Number of stream classes of `stream_classes`, from the first
+	 * one, which `fs-sink-trace.c` already wrote to the metadata
+	 * file.
+	 */
+	guint metadata_stream_class_count;
 };
 
 static inline
@@ -815,6 +844,17 @@ void fs_sink_ctf_event_class_destroy(struct fs_sink_ctf_event_class *ec)
 	ec->spec_context_fc = NULL;
 	fs_sink_ctf_field_class_destroy(ec->payload_fc);
 	ec->payload_fc = NULL;
+
+	if (ec->spec_context_write_ops) {
+		g_array_free(ec->spec_context_write_ops, TRUE);
+		ec->spec_context_write_ops = NULL;
+	}
+
+	if (ec->payload_write_ops) {
+		g_array_free(ec->payload_write_ops, TRUE);
+		ec->payload_write_ops = NULL;
+	}
+
 	g_free(ec);
 }
 
@@ -892,6 +932,12 @@ void fs_sink_ctf_stream_class_destroy(struct fs_sink_ctf_stream_class *sc)
 	sc->packet_context_fc = NULL;
 	fs_sink_ctf_field_class_destroy(sc->event_common_context_fc);
 	sc->event_common_context_fc = NULL;
+
+	if (sc->event_common_context_write_ops) {
+		g_array_free(sc->event_common_context_write_ops, TRUE);
+		sc->event_common_context_write_ops = NULL;
+	}
+
 	g_free(sc);
 }
 
@@ -11,17 +11,52 @@
 
 #include <babeltrace2/babeltrace.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <stdbool.h>
 #include <glib.h>
 #include "common/assert.h"
 #include "ctfser/ctfser.h"
 #include "compat/endian.h"
+#include "plugins/ctf/fs-src/lttng-index.h"
 
 #include "fs-sink.h"
 #include "fs-sink-trace.h"
 #include "fs-sink-stream.h"
+#include "compressed-stream-file.h"
 #include "translate-trace-ir-to-ctf-ir.h"
 
+/*
+ * Closes the packet index file of `stream`, if any, removing it if
+ * writing it failed at some point.
+ */
+static
+void close_index_file(struct fs_sink_stream *stream)
+{
+	if (stream->index_file) {
+		if (fclose(stream->index_file)) {
+			BT_COMP_LOGW_ERRNO("Cannot close packet index file",
+				": path=\"%s\"", stream->index_file_path->str);
+			stream->index_file_failed = true;
+		}
+
+		stream->index_file = NULL;
+	}
+
+	if (stream->index_file_path) {
+		if (stream->index_file_failed) {
+			/*
+			 * An incomplete index is worse than no index:
+			 * without one, a reader indexes the stream file
+			 * itself.
+			 */
+			(void) unlink(stream->index_file_path->str);
+		}
+
+		g_string_free(stream->index_file_path, TRUE);
+		stream->index_file_path = NULL;
+	}
+}
+
 BT_HIDDEN
 void fs_sink_stream_destroy(struct fs_sink_stream *stream)
 {
@@ -29,7 +64,28 @@ void fs_sink_stream_destroy(struct fs_sink_stream *stream)
 		goto end;
 	}
 
+	if (stream->open_streams_link.data) {
+		g_queue_unlink(&stream->trace->fs_sink->open_streams,
+			&stream->open_streams_link);
+		stream->open_streams_link.data = NULL;
+	}
+
+	/* This also reopens the files of a suspended stream to finish them */
 	bt_ctfser_fini(&stream->ctfser);
+	fs_sink_compressed_stream_file_destroy(stream->cfile);
+	stream->cfile = NULL;
+	close_index_file(stream);
+
+	if (stream->scratch_file_path) {
+		if (unlink(stream->scratch_file_path->str)) {
+			BT_COMP_LOGW_ERRNO("Cannot remove scratch stream file",
+				": path=\"%s\"",
+				stream->scratch_file_path->str);
+		}
+
+		g_string_free(stream->scratch_file_path, TRUE);
+		stream->scratch_file_path = NULL;
+	}
 
 	if (stream->file_name) {
 		g_string_free(stream->file_name, TRUE);
@@ -94,19 +150,25 @@ GString *sanitize_stream_file_name(const char *file_name)
 	return san_file_name;
 }
 
+/*
+ * Makes a stream file name, unique within `trace`, from `base`,
+ * followed with the extension `ext`.
+ */
 static
 GString *make_unique_stream_file_name(struct fs_sink_trace *trace,
-		const char *base)
+		const char *base, const char *ext)
 {
 	GString *san_base = sanitize_stream_file_name(base);
-	GString *name = g_string_new(san_base->str);
+	GString *name = g_string_new(NULL);
 	unsigned int suffix = 0;
 
 	BT_ASSERT(name);
+	g_string_printf(name, "%s%s", san_base->str, ext);
 
-	while (stream_file_name_exists(trace, name->str) &&
-			strcmp(name->str, "metadata") == 0) {
-		g_string_printf(name, "%s-%u", san_base->str, suffix);
+	while (stream_file_name_exists(trace, name->str) ||
+			strcmp(name->str, "metadata") == 0 ||
+			strcmp(name->str, "index") == 0) {
+		g_string_printf(name, "%s-%u%s", san_base->str, suffix, ext);
 		suffix++;
 	}
 
@@ -114,6 +176,181 @@ GString *make_unique_stream_file_name(struct fs_sink_trace *trace,
 	return name;
 }
 
+/*
+ * Creates the LTTng packet index file `index/NAME.idx`, where `NAME`
+ * is the name of the stream file, within the trace directory, and
+ * writes its header.
+ *
+ * The index entries hold the beginning and end times of the packets,
+ * so this only creates an index file if the packets have both.
+ *
+ * Failing to create the index file is not an error.
+ */
+static
+void create_index_file(struct fs_sink_stream *stream)
+{
+	struct ctf_packet_index_file_hdr hdr;
+	GString *index_dir_path = NULL;
+
+	if (!stream->sc->default_clock_class ||
+			!stream->sc->packets_have_ts_begin ||
+			!stream->sc->packets_have_ts_end) {
+		goto end;
+	}
+
+	index_dir_path = g_string_new(stream->trace->path->str);
+	BT_ASSERT(index_dir_path);
+	g_string_append(index_dir_path, "/index");
+
+	if (g_mkdir_with_parents(index_dir_path->str, 0755)) {
+		BT_COMP_LOGW_ERRNO("Cannot create packet index directory",
+			": path=\"%s\"", index_dir_path->str);
+		goto end;
+	}
+
+	stream->index_file_path = g_string_new(NULL);
+	BT_ASSERT(stream->index_file_path);
+	g_string_printf(stream->index_file_path, "%s/%s.idx",
+		index_dir_path->str, stream->file_name->str);
+	stream->index_file = fopen(stream->index_file_path->str, "wb");
+	if (!stream->index_file) {
+		BT_COMP_LOGW_ERRNO("Cannot create packet index file",
+			": path=\"%s\"", stream->index_file_path->str);
+		g_string_free(stream->index_file_path, TRUE);
+		stream->index_file_path = NULL;
+		goto end;
+	}
+
+	hdr.magic = htobe32(CTF_INDEX_MAGIC);
+	hdr.index_major = htobe32(CTF_INDEX_MAJOR);
+	hdr.index_minor = htobe32(CTF_INDEX_MINOR);
+	hdr.packet_index_len = htobe32(sizeof(struct ctf_packet_index));
+
+	if (fwrite(&hdr, sizeof(hdr), 1, stream->index_file) != 1) {
+		BT_COMP_LOGW_ERRNO("Cannot write packet index file header",
+			": path=\"%s\"", stream->index_file_path->str);
+		stream->index_file_failed = true;
+		close_index_file(stream);
+	}
+
+end:
+	if (index_dir_path) {
+		g_string_free(index_dir_path, TRUE);
+	}
+}
+
+/*
+ * Appends the entry of the packet which `stream` is closing, which
+ * starts at `offset_bytes` within the stream file, to the packet index
+ * file of `stream`, if any.
+ */
+static
+void write_index_entry(struct fs_sink_stream *stream, uint64_t offset_bytes)
+{
+	struct ctf_packet_index entry;
+
+	if (!stream->index_file) {
+		goto end;
+	}
+
+	entry.offset = htobe64(offset_bytes);
+	entry.packet_size = htobe64(stream->packet_state.total_size);
+	entry.content_size = htobe64(stream->packet_state.content_size);
+	entry.timestamp_begin = htobe64(stream->packet_state.beginning_cs);
+	entry.timestamp_end = htobe64(stream->packet_state.end_cs);
+	entry.events_discarded = htobe64(stream->sc->has_discarded_events ?
+		stream->packet_state.discarded_events_counter : 0);
+	entry.stream_id = htobe64(bt_stream_class_get_id(stream->sc->ir_sc));
+	entry.stream_instance_id = htobe64(bt_stream_get_id(stream->ir_stream));
+	entry.packet_seq_num = htobe64(stream->packet_state.seq_num);
+
+	if (fwrite(&entry, sizeof(entry), 1, stream->index_file) != 1) {
+		BT_COMP_LOGW_ERRNO("Cannot write packet index file entry",
+			": path=\"%s\"", stream->index_file_path->str);
+		stream->index_file_failed = true;
+		close_index_file(stream);
+	}
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int fs_sink_stream_suspend(struct fs_sink_stream *stream)
+{
+	int ret;
+
+	BT_ASSERT(!stream->is_suspended);
+	BT_COMP_LOGD("Suspending stream: file-name=\"%s\"",
+		stream->file_name->str);
+	ret = bt_ctfser_suspend(&stream->ctfser);
+	if (ret) {
+		BT_COMP_LOGE("Cannot suspend stream file: file-name=\"%s\"",
+			stream->file_name->str);
+		goto end;
+	}
+
+	if (stream->cfile) {
+		ret = fs_sink_compressed_stream_file_suspend(stream->cfile);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	if (stream->index_file) {
+		if (fclose(stream->index_file)) {
+			BT_COMP_LOGW_ERRNO("Cannot close packet index file",
+				": path=\"%s\"", stream->index_file_path->str);
+			stream->index_file_failed = true;
+		}
+
+		stream->index_file = NULL;
+	}
+
+	stream->is_suspended = true;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_stream_resume(struct fs_sink_stream *stream)
+{
+	int ret;
+
+	BT_ASSERT(stream->is_suspended);
+	BT_COMP_LOGD("Resuming stream: file-name=\"%s\"",
+		stream->file_name->str);
+	ret = bt_ctfser_resume(&stream->ctfser);
+	if (ret) {
+		BT_COMP_LOGE("Cannot resume stream file: file-name=\"%s\"",
+			stream->file_name->str);
+		goto end;
+	}
+
+	if (stream->cfile) {
+		ret = fs_sink_compressed_stream_file_resume(stream->cfile);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	if (stream->index_file_path && !stream->index_file_failed) {
+		stream->index_file = fopen(stream->index_file_path->str, "ab");
+		if (!stream->index_file) {
+			/* close_index_file() removes it */
+			BT_COMP_LOGW_ERRNO("Cannot reopen packet index file",
+				": path=\"%s\"", stream->index_file_path->str);
+			stream->index_file_failed = true;
+		}
+	}
+
+	stream->is_suspended = false;
+
+end:
+	return ret;
+}
+
 static
 void set_stream_file_name(struct fs_sink_stream *stream)
 {
@@ -125,7 +362,8 @@ void set_stream_file_name(struct fs_sink_stream *stream)
 
 	BT_ASSERT(!stream->file_name);
 	stream->file_name = make_unique_stream_file_name(stream->trace,
-		base_name);
+		base_name, stream->trace->fs_sink->compress ?
+			FS_SINK_COMPRESSED_STREAM_FILE_ZSTD_SUFFIX : "");
 }
 
 BT_HIDDEN
@@ -156,13 +394,59 @@ struct fs_sink_stream *fs_sink_stream_create(struct fs_sink_trace *trace,
 	}
 
 	set_stream_file_name(stream);
-	g_string_append_printf(path, "/%s", stream->file_name->str);
+
+	if (trace->fs_sink->compress) {
+		GString *cfile_path = g_string_new(trace->path->str);
+
+		BT_ASSERT(cfile_path);
+		g_string_append_printf(cfile_path, "/%s",
+			stream->file_name->str);
+		stream->cfile = fs_sink_compressed_stream_file_create(
+			cfile_path->str,
+			trace->fs_sink->compression_thread_count,
+			stream->log_level, trace->fs_sink->self_comp);
+		g_string_free(cfile_path, TRUE);
+		if (!stream->cfile) {
+			goto error;
+		}
+
+		/*
+		 * The serializer writes each packet to a hidden
+		 * scratch file, which holds a single packet at a time,
+		 * before the component compresses it.
+		 */
+		g_string_append_printf(path, "/.%s.tmp",
+			stream->file_name->str);
+	} else {
+		g_string_append_printf(path, "/%s", stream->file_name->str);
+	}
+
 	ret = bt_ctfser_init(&stream->ctfser, path->str,
 		stream->log_level);
 	if (ret) {
 		goto error;
 	}
 
+	if (stream->cfile && trace->fs_sink->max_open_streams > 0) {
+		/*
+		 * fs_sink_stream_resume() needs to reopen the scratch
+		 * file: remove it when destroying the stream instead.
+		 */
+		stream->scratch_file_path = g_string_new(path->str);
+		BT_ASSERT(stream->scratch_file_path);
+	} else if (stream->cfile) {
+		/*
+		 * Only keep the file descriptor of the scratch file:
+		 * its blocks are freed when the serializer closes it.
+		 */
+		if (unlink(path->str)) {
+			BT_COMP_LOGW_ERRNO("Cannot remove scratch stream file",
+				": path=\"%s\"", path->str);
+		}
+	}
+
+	create_index_file(stream);
+
 	g_hash_table_insert(trace->streams, (gpointer) ir_stream, stream);
 	goto end;
 
@@ -257,6 +541,57 @@ int write_string_field(struct fs_sink_stream *stream,
 		bt_field_string_get_value(field));
 }
 
+/*
+ * Returns whether or not `fc` is an 8-bit, byte-aligned integer field
+ * class, that is, one of which the fields of an array field make a
+ * contiguous run of bytes.
+ */
+static inline
+bool is_byte_int_field_class(struct fs_sink_ctf_field_class *fc)
+{
+	struct fs_sink_ctf_field_class_int *int_fc = (void *) fc;
+
+	return fc->type == FS_SINK_CTF_FIELD_CLASS_TYPE_INT &&
+		int_fc->base.size == 8 && int_fc->base.base.alignment == 8;
+}
+
+/*
+ * Writes the elements of the array field `field` of which the element
+ * field class is an 8-bit, byte-aligned integer field class (see
+ * is_byte_int_field_class()) as a single run of bytes.
+ */
+static inline
+int write_byte_array_field_elements(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_field_class_int *elem_fc,
+		const bt_field *field, uint64_t len)
+{
+	uint64_t i;
+	uint8_t *addr;
+	int ret;
+
+	ret = bt_ctfser_reserve_bytes(&stream->ctfser, len, &addr);
+	if (G_UNLIKELY(ret)) {
+		goto end;
+	}
+
+	for (i = 0; i < len; i++) {
+		const bt_field *elem_field =
+			bt_field_array_borrow_element_field_by_index_const(
+				field, i);
+
+		if (elem_fc->is_signed) {
+			addr[i] = (uint8_t)
+				bt_field_integer_signed_get_value(elem_field);
+		} else {
+			addr[i] = (uint8_t)
+				bt_field_integer_unsigned_get_value(elem_field);
+		}
+	}
+
+end:
+	return ret;
+}
+
 static inline
 int write_array_field_elements(struct fs_sink_stream *stream,
 		struct fs_sink_ctf_field_class_array_base *fc,
@@ -266,6 +601,12 @@ int write_array_field_elements(struct fs_sink_stream *stream,
 	uint64_t len = bt_field_array_get_length(field);
 	int ret = 0;
 
+	if (is_byte_int_field_class(fc->elem_fc)) {
+		ret = write_byte_array_field_elements(stream,
+			(void *) fc->elem_fc, field, len);
+		goto end;
+	}
+
 	for (i = 0; i < len; i++) {
 		const bt_field *elem_field =
 			bt_field_array_borrow_element_field_by_index_const(
@@ -439,6 +780,281 @@ int write_field(struct fs_sink_stream *stream,
 	return ret;
 }
 
+/*
+ * Maximum structure field nesting level which a serialization program
+ * flattens: a deeper structure field is written with write_field().
+ */
+#define MAX_WRITE_PROG_STRUCT_DEPTH	16
+
+enum fs_sink_write_op_type {
+	/* Align the current offset to `alignment` */
+	FS_SINK_WRITE_OP_TYPE_ALIGN,
+
+	/* Write the member field at `index` as such */
+	FS_SINK_WRITE_OP_TYPE_BOOL,
+	FS_SINK_WRITE_OP_TYPE_BIT_ARRAY,
+	FS_SINK_WRITE_OP_TYPE_UINT,
+	FS_SINK_WRITE_OP_TYPE_SINT,
+	FS_SINK_WRITE_OP_TYPE_FLOAT32,
+	FS_SINK_WRITE_OP_TYPE_FLOAT64,
+	FS_SINK_WRITE_OP_TYPE_STRING,
+
+	/*
+	 * Align the current offset to `alignment` and make the member
+	 * structure field at `index` the current structure field.
+	 */
+	FS_SINK_WRITE_OP_TYPE_ENTER_STRUCT,
+
+	/* Make the parent structure field the current one again */
+	FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT,
+
+	/* Write the member field at `index` with write_field() */
+	FS_SINK_WRITE_OP_TYPE_FIELD,
+};
+
+/*
+ * Operation of a serialization program.
+ *
+ * A serialization program is a flat list of operations which writes a
+ * structure field. All the operations, except
+ * `FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT`, apply to a member of the
+ * current structure field: nested structure fields are flattened with
+ * `FS_SINK_WRITE_OP_TYPE_ENTER_STRUCT` and
+ * `FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT` operations, while array,
+ * sequence, option, and variant fields, of which the layout depends on
+ * the field itself, are written with write_field().
+ */
+struct fs_sink_write_op {
+	enum fs_sink_write_op_type type;
+
+	/* Index of the member field within the current structure field */
+	uint64_t index;
+
+	unsigned int alignment;
+	unsigned int size;
+
+	/* Field class of the member (`FS_SINK_WRITE_OP_TYPE_FIELD`) */
+	struct fs_sink_ctf_field_class *fc;
+};
+
+static inline
+void append_write_op(GArray *ops, enum fs_sink_write_op_type type,
+		uint64_t index, unsigned int alignment, unsigned int size,
+		struct fs_sink_ctf_field_class *fc)
+{
+	struct fs_sink_write_op op = {
+		.type = type,
+		.index = index,
+		.alignment = alignment,
+		.size = size,
+		.fc = fc,
+	};
+
+	g_array_append_val(ops, op);
+}
+
+static
+void append_struct_write_ops(GArray *ops,
+		struct fs_sink_ctf_field_class_struct *fc, unsigned int depth)
+{
+	uint64_t i;
+
+	for (i = 0; i < fc->members->len; i++) {
+		struct fs_sink_ctf_field_class *member_fc =
+			fs_sink_ctf_field_class_struct_borrow_member_by_index(
+				fc, i)->fc;
+		struct fs_sink_ctf_field_class_bit_array *bit_array_fc =
+			(void *) member_fc;
+
+		switch (member_fc->type) {
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_BOOL:
+			append_write_op(ops, FS_SINK_WRITE_OP_TYPE_BOOL, i,
+				member_fc->alignment, bit_array_fc->size,
+				NULL);
+			break;
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_BIT_ARRAY:
+			append_write_op(ops, FS_SINK_WRITE_OP_TYPE_BIT_ARRAY,
+				i, member_fc->alignment, bit_array_fc->size,
+				NULL);
+			break;
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+		{
+			struct fs_sink_ctf_field_class_int *int_fc =
+				(void *) member_fc;
+
+			append_write_op(ops, int_fc->is_signed ?
+					FS_SINK_WRITE_OP_TYPE_SINT :
+					FS_SINK_WRITE_OP_TYPE_UINT,
+				i, member_fc->alignment, bit_array_fc->size,
+				NULL);
+			break;
+		}
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+			append_write_op(ops, bit_array_fc->size == 32 ?
+					FS_SINK_WRITE_OP_TYPE_FLOAT32 :
+					FS_SINK_WRITE_OP_TYPE_FLOAT64,
+				i, member_fc->alignment, bit_array_fc->size,
+				NULL);
+			break;
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_STRING:
+			append_write_op(ops, FS_SINK_WRITE_OP_TYPE_STRING, i,
+				8, 8, NULL);
+			break;
+		case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+			if (depth < MAX_WRITE_PROG_STRUCT_DEPTH) {
+				append_write_op(ops,
+					FS_SINK_WRITE_OP_TYPE_ENTER_STRUCT, i,
+					member_fc->alignment, 0, NULL);
+				append_struct_write_ops(ops, (void *) member_fc,
+					depth + 1);
+				append_write_op(ops,
+					FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT, 0,
+					0, 0, NULL);
+				break;
+			}
+
+			/* fall-through */
+		default:
+			append_write_op(ops, FS_SINK_WRITE_OP_TYPE_FIELD, i,
+				member_fc->alignment, 0, member_fc);
+			break;
+		}
+	}
+}
+
+/*
+ * Creates the serialization program of the root structure field class
+ * `fc`.
+ */
+static
+GArray *create_write_ops(struct fs_sink_ctf_field_class_struct *fc)
+{
+	GArray *ops = g_array_new(FALSE, FALSE,
+		sizeof(struct fs_sink_write_op));
+
+	BT_ASSERT(ops);
+	append_write_op(ops, FS_SINK_WRITE_OP_TYPE_ALIGN, 0,
+		fc->base.alignment, 0, NULL);
+	append_struct_write_ops(ops, fc, 0);
+	return ops;
+}
+
+static inline
+void ensure_write_ops(GArray **ops, struct fs_sink_ctf_field_class *fc)
+{
+	if (fc && G_UNLIKELY(!*ops)) {
+		*ops = create_write_ops((void *) fc);
+	}
+}
+
+BT_HIDDEN
+void fs_sink_stream_ensure_write_ops(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_event_class *ec)
+{
+	ensure_write_ops(&stream->sc->event_common_context_write_ops,
+		stream->sc->event_common_context_fc);
+	ensure_write_ops(&ec->spec_context_write_ops, ec->spec_context_fc);
+	ensure_write_ops(&ec->payload_write_ops, ec->payload_fc);
+}
+
+/*
+ * Writes the root structure field `field` with the serialization
+ * program `ops`.
+ */
+static inline
+int write_struct_field_with_ops(struct fs_sink_stream *stream,
+		GArray *ops, const bt_field *field)
+{
+	const bt_field *struct_fields[MAX_WRITE_PROG_STRUCT_DEPTH + 1];
+	unsigned int depth = 0;
+	guint i;
+	int ret = 0;
+
+	BT_ASSERT_DBG(ops);
+	struct_fields[0] = field;
+
+	for (i = 0; i < ops->len; i++) {
+		const struct fs_sink_write_op *op =
+			&g_array_index(ops, struct fs_sink_write_op, i);
+		const bt_field *member_field = NULL;
+
+		if (op->type != FS_SINK_WRITE_OP_TYPE_ALIGN &&
+				op->type != FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT) {
+			member_field =
+				bt_field_structure_borrow_member_field_by_index_const(
+					struct_fields[depth], op->index);
+		}
+
+		switch (op->type) {
+		case FS_SINK_WRITE_OP_TYPE_ALIGN:
+			ret = bt_ctfser_align_offset_in_current_packet(
+				&stream->ctfser, op->alignment);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_BOOL:
+			ret = bt_ctfser_write_unsigned_int(&stream->ctfser,
+				bt_field_bool_get_value(member_field) ? 1 : 0,
+				op->alignment, op->size, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_BIT_ARRAY:
+			ret = bt_ctfser_write_unsigned_int(&stream->ctfser,
+				bt_field_bit_array_get_value_as_integer(
+					member_field),
+				op->alignment, op->size, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_UINT:
+			ret = bt_ctfser_write_unsigned_int(&stream->ctfser,
+				bt_field_integer_unsigned_get_value(
+					member_field),
+				op->alignment, op->size, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_SINT:
+			ret = bt_ctfser_write_signed_int(&stream->ctfser,
+				bt_field_integer_signed_get_value(member_field),
+				op->alignment, op->size, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_FLOAT32:
+			ret = bt_ctfser_write_float32(&stream->ctfser,
+				(double) bt_field_real_single_precision_get_value(
+					member_field),
+				op->alignment, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_FLOAT64:
+			ret = bt_ctfser_write_float64(&stream->ctfser,
+				bt_field_real_double_precision_get_value(
+					member_field),
+				op->alignment, BYTE_ORDER);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_STRING:
+			ret = bt_ctfser_write_string(&stream->ctfser,
+				bt_field_string_get_value(member_field));
+			break;
+		case FS_SINK_WRITE_OP_TYPE_ENTER_STRUCT:
+			BT_ASSERT_DBG(depth < MAX_WRITE_PROG_STRUCT_DEPTH);
+			depth++;
+			struct_fields[depth] = member_field;
+			ret = bt_ctfser_align_offset_in_current_packet(
+				&stream->ctfser, op->alignment);
+			break;
+		case FS_SINK_WRITE_OP_TYPE_LEAVE_STRUCT:
+			BT_ASSERT_DBG(depth > 0);
+			depth--;
+			break;
+		case FS_SINK_WRITE_OP_TYPE_FIELD:
+			ret = write_field(stream, op->fc, member_field);
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		if (G_UNLIKELY(ret)) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static inline
 int write_event_header(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs, struct fs_sink_ctf_event_class *ec)
@@ -474,6 +1090,8 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 	int ret;
 	const bt_field *field;
 
+	fs_sink_stream_ensure_write_ops(stream, ec);
+
 	/* Header */
 	ret = write_event_header(stream, cs, ec);
 	if (G_UNLIKELY(ret)) {
@@ -484,9 +1102,8 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 	if (stream->sc->event_common_context_fc) {
 		field = bt_event_borrow_common_context_field_const(event);
 		BT_ASSERT_DBG(field);
-		ret = write_struct_field(stream,
-			(void *) stream->sc->event_common_context_fc,
-			field, true);
+		ret = write_struct_field_with_ops(stream,
+			stream->sc->event_common_context_write_ops, field);
 		if (G_UNLIKELY(ret)) {
 			goto end;
 		}
@@ -496,8 +1113,8 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 	if (ec->spec_context_fc) {
 		field = bt_event_borrow_specific_context_field_const(event);
 		BT_ASSERT_DBG(field);
-		ret = write_struct_field(stream, (void *) ec->spec_context_fc,
-			field, true);
+		ret = write_struct_field_with_ops(stream,
+			ec->spec_context_write_ops, field);
 		if (G_UNLIKELY(ret)) {
 			goto end;
 		}
@@ -507,8 +1124,8 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 	if (ec->payload_fc) {
 		field = bt_event_borrow_payload_field_const(event);
 		BT_ASSERT_DBG(field);
-		ret = write_struct_field(stream, (void *) ec->payload_fc,
-			field, true);
+		ret = write_struct_field_with_ops(stream,
+			ec->payload_write_ops, field);
 		if (G_UNLIKELY(ret)) {
 			goto end;
 		}
@@ -701,6 +1318,21 @@ int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 	/* Close packet */
 	bt_ctfser_close_current_packet(&stream->ctfser,
 		stream->packet_state.total_size / 8);
+	write_index_entry(stream,
+		bt_ctfser_get_cur_packet_offset_bytes(&stream->ctfser));
+
+	if (stream->cfile) {
+		/* Compress the closed packet and discard it */
+		ret = fs_sink_compressed_stream_file_write_frame(
+			stream->cfile,
+			bt_ctfser_get_cur_packet_addr(&stream->ctfser),
+			stream->packet_state.total_size / 8);
+		if (ret) {
+			goto end;
+		}
+
+		bt_ctfser_discard_closed_packets(&stream->ctfser);
+	}
 
 	/* Partially copy current packet state to previous packet state */
 	stream->prev_packet_state.end_cs = stream->packet_state.end_cs;
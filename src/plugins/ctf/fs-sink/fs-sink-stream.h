@@ -13,10 +13,13 @@
 #include <glib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "fs-sink-ctf-meta.h"
 
 struct fs_sink_trace;
+struct fs_sink_writer_shard;
+struct fs_sink_compressed_stream_file;
 
 struct fs_sink_stream {
 	bt_logging_level log_level;
@@ -26,11 +29,67 @@ struct fs_sink_stream {
 	/* Stream's file name */
 	GString *file_name;
 
+	/*
+	 * LTTng packet index file (`index/NAME.idx` within the trace
+	 * directory) and its path, or `NULL` if this stream has no
+	 * packet index file.
+	 */
+	FILE *index_file;
+	GString *index_file_path;
+
+	/* True if writing the packet index file failed */
+	bool index_file_failed;
+
+	/*
+	 * Path of the scratch stream file to remove when destroying
+	 * this stream, or `NULL` if there's none to remove (see
+	 * fs_sink_stream_create()).
+	 */
+	GString *scratch_file_path;
+
+	/*
+	 * True if fs_sink_stream_suspend() closed the files of this
+	 * stream.
+	 */
+	bool is_suspended;
+
+	/*
+	 * Link of this stream within the component's queue of open
+	 * streams (`open_streams` member of `struct fs_sink_comp`),
+	 * of which `data` is `NULL` if this stream is not in the queue.
+	 */
+	GList open_streams_link;
+
+	/*
+	 * Compressed data stream file (owned by this), or `NULL` if
+	 * `ctfser` writes the data stream file itself.
+	 */
+	struct fs_sink_compressed_stream_file *cfile;
+
 	/* Weak */
 	const bt_stream *ir_stream;
 
 	struct fs_sink_ctf_stream_class *sc;
 
+	/*
+	 * Writer thread shard which writes the events of this stream
+	 * (weak), or `NULL` to write them on the component's thread
+	 * (see `fs-sink-writer.h`).
+	 */
+	struct fs_sink_writer_shard *writer_shard;
+
+	/*
+	 * Number of events of this stream which are queued to its
+	 * writer thread (protected by the lock of `writer_shard`).
+	 */
+	uint64_t writer_pending_jobs;
+
+	/*
+	 * True if the writer thread failed to write an event of this
+	 * stream (protected by the lock of `writer_shard`).
+	 */
+	bool writer_failed;
+
 	/* Current packet's state */
 	struct {
 		/*
@@ -163,6 +222,36 @@ struct fs_sink_stream *fs_sink_stream_create(struct fs_sink_trace *trace,
 BT_HIDDEN
 void fs_sink_stream_destroy(struct fs_sink_stream *stream);
 
+/*
+ * Closes the files of `stream`, keeping its state, so that the
+ * component does not keep file descriptors and memory maps for idle
+ * streams.
+ *
+ * Nothing may write to `stream` until fs_sink_stream_resume() reopens
+ * its files.
+ */
+BT_HIDDEN
+int fs_sink_stream_suspend(struct fs_sink_stream *stream);
+
+/*
+ * Reopens the files of `stream`, which fs_sink_stream_suspend()
+ * closed, to continue writing where it left off.
+ */
+BT_HIDDEN
+int fs_sink_stream_resume(struct fs_sink_stream *stream);
+
+/*
+ * Builds the serialization programs which fs_sink_stream_write_event()
+ * needs to write the events of the class `ec` to `stream`, if not
+ * already done.
+ *
+ * The component's thread must call this before queueing an event to a
+ * writer thread, as the programs are shared between streams.
+ */
+BT_HIDDEN
+void fs_sink_stream_ensure_write_ops(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_event_class *ec);
+
 BT_HIDDEN
 int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs, const bt_event *event,
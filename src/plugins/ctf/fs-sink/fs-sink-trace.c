@@ -467,13 +467,63 @@ end:
 	return unique_full_path;
 }
 
+/*
+ * Writes the content of `trace->metadata_tsdl` to the metadata file
+ * and then clears it.
+ */
+static
+int write_metadata_tsdl(struct fs_sink_trace *trace)
+{
+	int ret = 0;
+
+	if (trace->metadata_tsdl->len == 0) {
+		goto end;
+	}
+
+	if (fwrite(trace->metadata_tsdl->str, trace->metadata_tsdl->len, 1,
+			trace->metadata_fh) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write metadata file",
+			": path=\"%s\"", trace->metadata_path->str);
+		ret = -1;
+	}
+
+	g_string_truncate(trace->metadata_tsdl, 0);
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
-void fs_sink_trace_destroy(struct fs_sink_trace *trace)
+int fs_sink_trace_write_new_metadata(struct fs_sink_trace *trace)
 {
-	GString *tsdl = NULL;
-	FILE *fh = NULL;
-	size_t len;
+	struct fs_sink_ctf_trace *ctf_trace = trace->trace;
+	guint i;
+
+	for (i = 0; i < ctf_trace->stream_classes->len; i++) {
+		struct fs_sink_ctf_stream_class *sc =
+			ctf_trace->stream_classes->pdata[i];
 
+		if (i >= ctf_trace->metadata_stream_class_count) {
+			translate_stream_class_ctf_ir_to_tsdl(sc,
+				trace->metadata_tsdl);
+			ctf_trace->metadata_stream_class_count++;
+		}
+
+		for (; sc->metadata_event_class_count < sc->event_classes->len;
+				sc->metadata_event_class_count++) {
+			translate_event_class_ctf_ir_to_tsdl(
+				sc->event_classes->pdata[
+					sc->metadata_event_class_count],
+				trace->metadata_tsdl);
+		}
+	}
+
+	return write_metadata_tsdl(trace);
+}
+
+BT_HIDDEN
+void fs_sink_trace_destroy(struct fs_sink_trace *trace)
+{
 	if (!trace) {
 		goto end;
 	}
@@ -494,29 +544,18 @@ void fs_sink_trace_destroy(struct fs_sink_trace *trace)
 		trace->streams = NULL;
 	}
 
-	tsdl = g_string_new(NULL);
-	BT_ASSERT(tsdl);
-	translate_trace_ctf_ir_to_tsdl(trace->trace, tsdl);
-
-	BT_ASSERT(trace->metadata_path);
-	fh = fopen(trace->metadata_path->str, "wb");
-	if (!fh) {
-		BT_COMP_LOGF_ERRNO("In trace destruction listener: "
-			"cannot open metadata file for writing",
-			": path=\"%s\"", trace->metadata_path->str);
-		bt_common_abort();
-	}
+	if (trace->metadata_fh) {
+		if (fclose(trace->metadata_fh) != 0) {
+			BT_COMP_LOGW_ERRNO("In trace destruction listener: "
+				"cannot close metadata file",
+				": path=\"%s\"", trace->metadata_path->str);
+		}
 
-	len = fwrite(tsdl->str, sizeof(*tsdl->str), tsdl->len, fh);
-	if (len != tsdl->len) {
-		BT_COMP_LOGF_ERRNO("In trace destruction listener: "
-			"cannot write metadata file",
-			": path=\"%s\"", trace->metadata_path->str);
-		bt_common_abort();
-	}
+		trace->metadata_fh = NULL;
 
-	if (!trace->fs_sink->quiet) {
-		printf("Created CTF trace `%s`.\n", trace->path->str);
+		if (!trace->fs_sink->quiet) {
+			printf("Created CTF trace `%s`.\n", trace->path->str);
+		}
 	}
 
 	if (trace->path) {
@@ -524,25 +563,20 @@ void fs_sink_trace_destroy(struct fs_sink_trace *trace)
 		trace->path = NULL;
 	}
 
-	if (fh) {
-		int ret = fclose(fh);
-
-		if (ret != 0) {
-			BT_COMP_LOGW_ERRNO("In trace destruction listener: "
-				"cannot close metadata file",
-				": path=\"%s\"", trace->metadata_path->str);
-		}
+	if (trace->metadata_path) {
+		g_string_free(trace->metadata_path, TRUE);
+		trace->metadata_path = NULL;
 	}
 
-	g_string_free(trace->metadata_path, TRUE);
-	trace->metadata_path = NULL;
+	if (trace->metadata_tsdl) {
+		g_string_free(trace->metadata_tsdl, TRUE);
+		trace->metadata_tsdl = NULL;
+	}
 
 	fs_sink_ctf_trace_destroy(trace->trace);
 	trace->trace = NULL;
 	g_free(trace);
 
-	g_string_free(tsdl, TRUE);
-
 end:
 	return;
 }
@@ -594,6 +628,22 @@ struct fs_sink_trace *fs_sink_trace_create(struct fs_sink_comp *fs_sink,
 	trace->metadata_path = g_string_new(trace->path->str);
 	BT_ASSERT(trace->metadata_path);
 	g_string_append(trace->metadata_path, "/metadata");
+	trace->metadata_tsdl = g_string_new(NULL);
+	BT_ASSERT(trace->metadata_tsdl);
+	trace->metadata_fh = fopen(trace->metadata_path->str, "wb");
+	if (!trace->metadata_fh) {
+		BT_COMP_LOGE_ERRNO("Cannot open metadata file for writing",
+			": path=\"%s\"", trace->metadata_path->str);
+		goto error;
+	}
+
+	translate_trace_ctf_ir_to_tsdl_preamble(trace->trace,
+		trace->metadata_tsdl);
+	ret = write_metadata_tsdl(trace);
+	if (ret) {
+		goto error;
+	}
+
 	trace->streams = g_hash_table_new_full(g_direct_hash, g_direct_equal,
 		NULL, (GDestroyNotify) fs_sink_stream_destroy);
 	BT_ASSERT(trace->streams);
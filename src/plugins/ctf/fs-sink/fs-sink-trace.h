@@ -12,6 +12,7 @@
 #include "ctfser/ctfser.h"
 #include <glib.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "fs-sink-ctf-meta.h"
 
@@ -46,6 +47,15 @@ struct fs_sink_trace {
 	/* `metadata` file path */
 	GString *metadata_path;
 
+	/*
+	 * `metadata` file, to which fs_sink_trace_write_new_metadata()
+	 * appends the TSDL of the new stream and event classes
+	 */
+	FILE *metadata_fh;
+
+	/* TSDL not written to `metadata_fh` yet */
+	GString *metadata_tsdl;
+
 	/*
 	 * Hash table of `const bt_stream *` (weak) to
 	 * `struct fs_sink_stream *` (owned by hash table).
@@ -60,4 +70,11 @@ struct fs_sink_trace *fs_sink_trace_create(struct fs_sink_comp *fs_sink,
 BT_HIDDEN
 void fs_sink_trace_destroy(struct fs_sink_trace *trace);
 
+/*
+ * Appends the TSDL of the stream classes and event classes of `trace`
+ * which aren't in its metadata file yet to this file.
+ */
+BT_HIDDEN
+int fs_sink_trace_write_new_metadata(struct fs_sink_trace *trace);
+
 #endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_TRACE_H */
@@ -0,0 +1,348 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (writers->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (writers->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.CTF.FS/WRITER"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <stdbool.h>
+#include <glib.h>
+#include "common/assert.h"
+
+#include "fs-sink.h"
+#include "fs-sink-trace.h"
+#include "fs-sink-stream.h"
+#include "fs-sink-writer.h"
+
+/*
+ * Maximum number of queued events per writer thread: pushing an event
+ * to a full queue blocks the component's thread until the writer
+ * thread catches up.
+ */
+#define MAX_QUEUED_JOBS_PER_SHARD	4096
+
+struct fs_sink_writer_job {
+	/* Weak */
+	struct fs_sink_stream *stream;
+
+	/* Weak */
+	struct fs_sink_ctf_event_class *ec;
+
+	/* Owned by this (put by the component's thread) */
+	const bt_message *msg;
+
+	/* Weak (belongs to `msg`) */
+	const bt_clock_snapshot *cs;
+
+	/* Result of fs_sink_stream_write_event() */
+	int ret;
+};
+
+struct fs_sink_writer_shard {
+	/* Weak */
+	struct fs_sink_writers *writers;
+
+	GThread *thread;
+
+	/* Protects all the members below */
+	GMutex lock;
+
+	/*
+	 * Signaled when a job is queued, when a job is completed, and
+	 * when `stop` becomes true.
+	 */
+	GCond cond;
+
+	/* Queue of `struct fs_sink_writer_job *` (owned by this) */
+	GQueue jobs;
+
+	/* True to make the writer thread exit once `jobs` is empty */
+	bool stop;
+};
+
+static
+gpointer writer_thread_func(gpointer data)
+{
+	struct fs_sink_writer_shard *shard = data;
+	struct fs_sink_writers *writers = shard->writers;
+
+	g_mutex_lock(&shard->lock);
+
+	while (true) {
+		struct fs_sink_writer_job *job;
+		bool stream_failed;
+
+		while (!shard->stop && g_queue_is_empty(&shard->jobs)) {
+			g_cond_wait(&shard->cond, &shard->lock);
+		}
+
+		job = g_queue_pop_head(&shard->jobs);
+		if (!job) {
+			/* Stopping and no more jobs */
+			break;
+		}
+
+		stream_failed = job->stream->writer_failed;
+		g_mutex_unlock(&shard->lock);
+
+		/*
+		 * Once writing an event of a stream fails, the stream
+		 * file is in an unknown state: skip the following
+		 * events of this stream. The failed job reports the
+		 * error.
+		 */
+		if (G_LIKELY(!stream_failed)) {
+			job->ret = fs_sink_stream_write_event(job->stream,
+				job->cs,
+				bt_message_event_borrow_event_const(job->msg),
+				job->ec);
+		}
+
+		g_mutex_lock(&shard->lock);
+
+		if (G_UNLIKELY(job->ret)) {
+			job->stream->writer_failed = true;
+		}
+
+		BT_ASSERT_DBG(job->stream->writer_pending_jobs > 0);
+		job->stream->writer_pending_jobs--;
+		g_cond_broadcast(&shard->cond);
+		g_async_queue_push(writers->done_jobs, job);
+	}
+
+	g_mutex_unlock(&shard->lock);
+	return NULL;
+}
+
+static
+void destroy_job(struct fs_sink_writer_job *job)
+{
+	if (!job) {
+		return;
+	}
+
+	bt_message_put_ref(job->msg);
+	g_free(job);
+}
+
+static
+void destroy_shard(struct fs_sink_writer_shard *shard)
+{
+	if (!shard) {
+		return;
+	}
+
+	if (shard->thread) {
+		g_mutex_lock(&shard->lock);
+		shard->stop = true;
+		g_cond_broadcast(&shard->cond);
+		g_mutex_unlock(&shard->lock);
+		g_thread_join(shard->thread);
+		shard->thread = NULL;
+	}
+
+	BT_ASSERT(g_queue_is_empty(&shard->jobs));
+	g_cond_clear(&shard->cond);
+	g_mutex_clear(&shard->lock);
+	g_free(shard);
+}
+
+BT_HIDDEN
+struct fs_sink_writers *fs_sink_writers_create(struct fs_sink_comp *fs_sink,
+		guint thread_count)
+{
+	struct fs_sink_writers *writers = g_new0(struct fs_sink_writers, 1);
+	guint i;
+
+	BT_ASSERT(thread_count > 0);
+
+	if (!writers) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, fs_sink->log_level,
+			fs_sink->self_comp,
+			"Failed to allocate one writer threads structure.");
+		goto error;
+	}
+
+	writers->log_level = fs_sink->log_level;
+	writers->self_comp = fs_sink->self_comp;
+	writers->done_jobs = g_async_queue_new();
+	if (!writers->done_jobs) {
+		BT_COMP_LOGE_STR("Failed to allocate one GAsyncQueue.");
+		goto error;
+	}
+
+	writers->shards = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_shard);
+	if (!writers->shards) {
+		BT_COMP_LOGE_STR("Failed to allocate one GPtrArray.");
+		goto error;
+	}
+
+	for (i = 0; i < thread_count; i++) {
+		GError *error = NULL;
+		struct fs_sink_writer_shard *shard =
+			g_new0(struct fs_sink_writer_shard, 1);
+
+		if (!shard) {
+			BT_COMP_LOGE_STR("Failed to allocate one writer shard.");
+			goto error;
+		}
+
+		shard->writers = writers;
+		g_mutex_init(&shard->lock);
+		g_cond_init(&shard->cond);
+		g_queue_init(&shard->jobs);
+		g_ptr_array_add(writers->shards, shard);
+		shard->thread = g_thread_try_new("sink.ctf.fs writer",
+			writer_thread_func, shard, &error);
+		if (!shard->thread) {
+			BT_COMP_LOGE("Failed to create writer thread: "
+				"index=%u, error=\"%s\"", i, error->message);
+			g_error_free(error);
+			goto error;
+		}
+	}
+
+	BT_COMP_LOGI("Created writer threads: count=%u", thread_count);
+	goto end;
+
+error:
+	fs_sink_writers_destroy(writers);
+	writers = NULL;
+
+end:
+	return writers;
+}
+
+BT_HIDDEN
+void fs_sink_writers_destroy(struct fs_sink_writers *writers)
+{
+	if (!writers) {
+		goto end;
+	}
+
+	if (writers->shards) {
+		/* This joins the writer threads */
+		g_ptr_array_free(writers->shards, TRUE);
+		writers->shards = NULL;
+	}
+
+	if (writers->done_jobs) {
+		struct fs_sink_writer_job *job;
+
+		while ((job = g_async_queue_try_pop(writers->done_jobs))) {
+			destroy_job(job);
+		}
+
+		g_async_queue_unref(writers->done_jobs);
+		writers->done_jobs = NULL;
+	}
+
+	g_free(writers);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void fs_sink_writers_assign_stream(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream)
+{
+	BT_ASSERT(stream->sc->has_packets);
+	BT_ASSERT(!stream->writer_shard);
+	stream->writer_shard = g_ptr_array_index(writers->shards,
+		writers->next_shard_index);
+	writers->next_shard_index = (writers->next_shard_index + 1) %
+		writers->shards->len;
+}
+
+BT_HIDDEN
+int fs_sink_writers_push_event(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream, const bt_message *msg,
+		const bt_clock_snapshot *cs,
+		struct fs_sink_ctf_event_class *ec)
+{
+	struct fs_sink_writer_shard *shard = stream->writer_shard;
+	struct fs_sink_writer_job *job = g_new0(struct fs_sink_writer_job, 1);
+	int ret = 0;
+
+	BT_ASSERT_DBG(shard);
+
+	if (G_UNLIKELY(!job)) {
+		BT_COMP_LOGE_STR("Failed to allocate one writer job.");
+		ret = -1;
+		goto end;
+	}
+
+	job->stream = stream;
+	job->ec = ec;
+	job->msg = msg;
+	bt_message_get_ref(job->msg);
+	job->cs = cs;
+	g_mutex_lock(&shard->lock);
+
+	while (shard->jobs.length >= MAX_QUEUED_JOBS_PER_SHARD) {
+		g_cond_wait(&shard->cond, &shard->lock);
+	}
+
+	g_queue_push_tail(&shard->jobs, job);
+	stream->writer_pending_jobs++;
+	g_cond_broadcast(&shard->cond);
+	g_mutex_unlock(&shard->lock);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_writers_wait_stream(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream)
+{
+	struct fs_sink_writer_shard *shard = stream->writer_shard;
+
+	if (!shard) {
+		goto end;
+	}
+
+	g_mutex_lock(&shard->lock);
+
+	while (stream->writer_pending_jobs > 0) {
+		g_cond_wait(&shard->cond, &shard->lock);
+	}
+
+	g_mutex_unlock(&shard->lock);
+
+end:
+	return fs_sink_writers_reap(writers);
+}
+
+BT_HIDDEN
+int fs_sink_writers_reap(struct fs_sink_writers *writers)
+{
+	struct fs_sink_writer_job *job;
+	int ret = 0;
+
+	while ((job = g_async_queue_try_pop(writers->done_jobs))) {
+		if (G_UNLIKELY(job->ret)) {
+			const bt_stream *ir_stream = job->stream->ir_stream;
+
+			BT_COMP_LOGE("Failed to write event: "
+				"stream-id=%" PRIu64 ", stream-name=\"%s\", "
+				"path=\"%s/%s\"",
+				bt_stream_get_id(ir_stream),
+				bt_stream_get_name(ir_stream),
+				job->stream->trace->path->str,
+				job->stream->file_name->str);
+			ret = -1;
+		}
+
+		destroy_job(job);
+	}
+
+	return ret;
+}
@@ -0,0 +1,108 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_WRITER_H
+#define BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_WRITER_H
+
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fs-sink-ctf-meta.h"
+
+struct fs_sink_comp;
+struct fs_sink_stream;
+struct fs_sink_writer_shard;
+
+/*
+ * Writer threads of a `sink.ctf.fs` component.
+ *
+ * Each writer thread owns a shard of the component's data streams which
+ * support packets and writes the events of those streams, in order,
+ * into their stream files.
+ *
+ * A writer thread only ever borrows the fields of the event messages
+ * it receives: the component's thread keeps a reference on each queued
+ * message and puts it once the writer thread is done with it (see
+ * fs_sink_writers_reap()), as trace IR objects have a non-atomic
+ * reference count.
+ *
+ * The component's thread must call fs_sink_writers_wait_stream()
+ * before it uses the serializer of a stream for anything else than
+ * queueing an event, for example to open or close a packet.
+ */
+struct fs_sink_writers {
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+
+	/* Array of `struct fs_sink_writer_shard *` (owned by this) */
+	GPtrArray *shards;
+
+	/* Index of the shard to assign to the next stream */
+	guint next_shard_index;
+
+	/*
+	 * Queue of `struct fs_sink_writer_job *` (owned by this) which
+	 * the writer threads are done with.
+	 */
+	GAsyncQueue *done_jobs;
+};
+
+/*
+ * Creates `thread_count` writer threads for the component `fs_sink`.
+ */
+BT_HIDDEN
+struct fs_sink_writers *fs_sink_writers_create(struct fs_sink_comp *fs_sink,
+		guint thread_count);
+
+/*
+ * Makes the writer threads of `writers` write all their queued events,
+ * joins them, and destroys `writers`.
+ */
+BT_HIDDEN
+void fs_sink_writers_destroy(struct fs_sink_writers *writers);
+
+/*
+ * Assigns the stream `stream`, which must support packets, to one
+ * of the writer threads of `writers`.
+ */
+BT_HIDDEN
+void fs_sink_writers_assign_stream(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream);
+
+/*
+ * Queues the event message `msg` of the class `ec` to be written to
+ * the stream `stream` by its writer thread, taking a reference on it.
+ *
+ * Blocks while the queue of the writer thread of `stream` is full.
+ */
+BT_HIDDEN
+int fs_sink_writers_push_event(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream, const bt_message *msg,
+		const bt_clock_snapshot *cs,
+		struct fs_sink_ctf_event_class *ec);
+
+/*
+ * Waits until the writer thread of `stream` has written all the
+ * queued events of `stream`, and then reaps the completed jobs (see
+ * fs_sink_writers_reap()).
+ */
+BT_HIDDEN
+int fs_sink_writers_wait_stream(struct fs_sink_writers *writers,
+		struct fs_sink_stream *stream);
+
+/*
+ * Puts the messages of the jobs which the writer threads of `writers`
+ * are done with.
+ *
+ * Returns a negative value if writing any of those events failed.
+ */
+BT_HIDDEN
+int fs_sink_writers_reap(struct fs_sink_writers *writers);
+
+#endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_WRITER_H */
@@ -11,6 +11,7 @@
 
 #include <babeltrace2/babeltrace.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 #include <glib.h>
 #include "common/assert.h"
@@ -20,10 +21,18 @@
 #include "fs-sink.h"
 #include "fs-sink-trace.h"
 #include "fs-sink-stream.h"
+#include "fs-sink-writer.h"
+#include "compressed-stream-file.h"
 #include "fs-sink-ctf-meta.h"
 #include "translate-trace-ir-to-ctf-ir.h"
 #include "translate-ctf-ir-to-tsdl.h"
 
+/*
+ * Maximum value of the `writer-threads` and `compression-threads`
+ * parameters
+ */
+#define MAX_WRITER_THREADS	64U
+
 static
 const char * const in_port_name = "in";
 
@@ -49,12 +58,20 @@ end:
 	return status;
 }
 
+static const char *compression_choices[] = { "none", "zstd", NULL };
+
 static struct bt_param_validation_map_value_entry_descr fs_sink_params_descr[] = {
 	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { .type = BT_VALUE_TYPE_STRING } },
 	{ "assume-single-trace", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "compression", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
+		.choices = compression_choices,
+	} } },
+	{ "compression-threads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	{ "ignore-discarded-events", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "ignore-discarded-packets", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "max-open-streams", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	{ "quiet", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "writer-threads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -87,6 +104,37 @@ configure_component(struct fs_sink_comp *fs_sink, const bt_value *params)
 		fs_sink->assume_single_trace = (bool) bt_value_bool_get(value);
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params, "compression");
+	if (value && strcmp(bt_value_string_get(value), "zstd") == 0) {
+		if (!fs_sink_compressed_stream_file_is_supported()) {
+			BT_COMP_LOGE("Invalid `compression` parameter: "
+				"Babeltrace was built without zstd support "
+				"(see the `--enable-zstd` configuration option).");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		fs_sink->compress = true;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		"compression-threads");
+	if (value) {
+		uint64_t thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (thread_count > MAX_WRITER_THREADS) {
+			BT_COMP_LOGE("Invalid `compression-threads` parameter: "
+				"value is too large: "
+				"value=%" PRIu64 ", max-value=%u",
+				thread_count, MAX_WRITER_THREADS);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		fs_sink->compression_thread_count = (guint) thread_count;
+	}
+
 	value = bt_value_map_borrow_entry_value_const(params,
 		"ignore-discarded-events");
 	if (value) {
@@ -101,12 +149,37 @@ configure_component(struct fs_sink_comp *fs_sink, const bt_value *params)
 			(bool) bt_value_bool_get(value);
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		"max-open-streams");
+	if (value) {
+		fs_sink->max_open_streams =
+			bt_value_integer_unsigned_get(value);
+	}
+
 	value = bt_value_map_borrow_entry_value_const(params,
 		"quiet");
 	if (value) {
 		fs_sink->quiet = (bool) bt_value_bool_get(value);
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		"writer-threads");
+	if (value) {
+		uint64_t thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (thread_count > MAX_WRITER_THREADS) {
+			BT_COMP_LOGE("Invalid `writer-threads` parameter: "
+				"value is too large: "
+				"value=%" PRIu64 ", max-value=%u",
+				thread_count, MAX_WRITER_THREADS);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		fs_sink->writer_thread_count = (guint) thread_count;
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
 end:
@@ -121,6 +194,13 @@ void destroy_fs_sink_comp(struct fs_sink_comp *fs_sink)
 		goto end;
 	}
 
+	/*
+	 * Join the writer threads before destroying the streams which
+	 * they write to.
+	 */
+	fs_sink_writers_destroy(fs_sink->writers);
+	fs_sink->writers = NULL;
+
 	if (fs_sink->output_dir_path) {
 		g_string_free(fs_sink->output_dir_path, TRUE);
 		fs_sink->output_dir_path = NULL;
@@ -166,6 +246,7 @@ bt_component_class_initialize_method_status ctf_fs_sink_init(
 	fs_sink->log_level = log_level;
 	fs_sink->self_comp = self_comp;
 	fs_sink->output_dir_path = g_string_new(NULL);
+	g_queue_init(&fs_sink->open_streams);
 	status = configure_component(fs_sink, params);
 	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
 		/* configure_component() logs errors */
@@ -195,6 +276,15 @@ bt_component_class_initialize_method_status ctf_fs_sink_init(
 		goto end;
 	}
 
+	if (fs_sink->writer_thread_count > 0) {
+		fs_sink->writers = fs_sink_writers_create(fs_sink,
+			fs_sink->writer_thread_count);
+		if (!fs_sink->writers) {
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	add_port_status = bt_self_component_sink_add_input_port(
 		self_comp_sink, in_port_name, NULL, NULL);
 	switch (add_port_status) {
@@ -218,6 +308,73 @@ end:
 	return status;
 }
 
+/*
+ * Waits until the writer thread of `stream`, if any, has written all
+ * the queued events of `stream`, so that the component's thread can
+ * use its serializer.
+ */
+static inline
+int wait_stream_writer(struct fs_sink_comp *fs_sink,
+		struct fs_sink_stream *stream)
+{
+	int ret = 0;
+
+	if (fs_sink->writers) {
+		ret = fs_sink_writers_wait_stream(fs_sink->writers, stream);
+	}
+
+	return ret;
+}
+
+/*
+ * Makes `stream` the most recently used open stream, reopening its
+ * files if they're closed, and then closes the files of the least
+ * recently used streams beyond the `max-open-streams` limit.
+ */
+static
+int use_open_stream(struct fs_sink_comp *fs_sink,
+		struct fs_sink_stream *stream)
+{
+	int ret = 0;
+
+	if (stream->is_suspended) {
+		ret = fs_sink_stream_resume(stream);
+		if (ret) {
+			goto end;
+		}
+	} else if (stream->open_streams_link.data) {
+		g_queue_unlink(&fs_sink->open_streams,
+			&stream->open_streams_link);
+	}
+
+	stream->open_streams_link.data = stream;
+	g_queue_push_head_link(&fs_sink->open_streams,
+		&stream->open_streams_link);
+
+	while (fs_sink->open_streams.length > fs_sink->max_open_streams) {
+		GList *link = g_queue_peek_tail_link(&fs_sink->open_streams);
+		struct fs_sink_stream *victim = link->data;
+
+		BT_ASSERT(victim != stream);
+
+		/* The writer thread of `victim` must not use its files */
+		ret = wait_stream_writer(fs_sink, victim);
+		if (ret) {
+			goto end;
+		}
+
+		g_queue_unlink(&fs_sink->open_streams, link);
+		link->data = NULL;
+		ret = fs_sink_stream_suspend(victim);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static inline
 struct fs_sink_stream *borrow_stream(struct fs_sink_comp *fs_sink,
 		const bt_stream *ir_stream)
@@ -248,6 +405,32 @@ struct fs_sink_stream *borrow_stream(struct fs_sink_comp *fs_sink,
 		if (!stream) {
 			goto end;
 		}
+
+		/* Write the TSDL of a new stream class, if any */
+		if (fs_sink_trace_write_new_metadata(trace)) {
+			stream = NULL;
+			goto end;
+		}
+
+		/*
+		 * The component's thread needs the serializer of a
+		 * stream which doesn't support packets to decide when
+		 * to close its artificial packets: write its events
+		 * on the component's thread.
+		 */
+		if (fs_sink->writers && stream->sc->has_packets) {
+			fs_sink_writers_assign_stream(fs_sink->writers,
+				stream);
+		}
+	}
+
+	if (G_UNLIKELY(fs_sink->max_open_streams > 0) &&
+			fs_sink->open_streams.head !=
+				&stream->open_streams_link) {
+		if (use_open_stream(fs_sink, stream)) {
+			stream = NULL;
+			goto end;
+		}
 	}
 
 end:
@@ -282,6 +465,16 @@ bt_component_class_sink_consume_method_status handle_event_msg(
 
 	BT_ASSERT_DBG(ec);
 
+	if (G_UNLIKELY(stream->sc->metadata_event_class_count <
+			stream->sc->event_classes->len)) {
+		/* Write the TSDL of the new event class */
+		ret = fs_sink_trace_write_new_metadata(stream->trace);
+		if (ret) {
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	if (stream->sc->default_clock_class) {
 		cs = bt_message_event_borrow_default_clock_snapshot_const(
 			msg);
@@ -323,7 +516,15 @@ bt_component_class_sink_consume_method_status handle_event_msg(
 	}
 
 	BT_ASSERT_DBG(stream->packet_state.is_open);
-	ret = fs_sink_stream_write_event(stream, cs, ir_event, ec);
+
+	if (stream->writer_shard) {
+		fs_sink_stream_ensure_write_ops(stream, ec);
+		ret = fs_sink_writers_push_event(fs_sink->writers, stream,
+			msg, cs, ec);
+	} else {
+		ret = fs_sink_stream_write_event(stream, cs, ir_event, ec);
+	}
+
 	if (G_UNLIKELY(ret)) {
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
 		goto end;
@@ -511,6 +712,12 @@ bt_component_class_sink_consume_method_status handle_packet_beginning_msg(
 	 */
 	stream->discarded_packets_state.in_range = false;
 
+	ret = wait_stream_writer(fs_sink, stream);
+	if (ret) {
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
 	ret = fs_sink_stream_open_packet(stream, cs, ir_packet);
 	if (ret) {
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
@@ -593,6 +800,12 @@ bt_component_class_sink_consume_method_status handle_packet_end_msg(
 		}
 	}
 
+	ret = wait_stream_writer(fs_sink, stream);
+	if (ret) {
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
 	ret = fs_sink_stream_close_packet(stream, cs);
 	if (ret) {
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
@@ -721,6 +934,11 @@ bt_component_class_sink_consume_method_status handle_stream_end_msg(
 		goto end;
 	}
 
+	if (wait_stream_writer(fs_sink, stream)) {
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
 	if (G_UNLIKELY(!stream->sc->has_packets &&
 			stream->packet_state.is_open)) {
 		/* Close stream's current artificial packet */
@@ -1039,6 +1257,20 @@ bt_component_class_sink_consume_method_status ctf_fs_sink_consume(
 			}
 		}
 
+		/*
+		 * Put the messages of the events which the writer
+		 * threads are done with.
+		 */
+		if (fs_sink->writers &&
+				fs_sink_writers_reap(fs_sink->writers)) {
+			BT_COMP_LOGE("Failed to write events: "
+				"generated CTF traces could be incomplete: "
+				"output-dir-path=\"%s\"",
+				fs_sink->output_dir_path->str);
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
 		break;
 	}
 	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
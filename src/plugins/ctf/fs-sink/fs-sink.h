@@ -12,6 +12,8 @@
 #include <stdbool.h>
 #include <glib.h>
 
+struct fs_sink_writers;
+
 struct fs_sink_comp {
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
@@ -30,6 +32,15 @@ struct fs_sink_comp {
 	 */
 	bool assume_single_trace;
 
+	/* True to write zstd-compressed data stream files */
+	bool compress;
+
+	/*
+	 * Number of libzstd worker threads which compress each data
+	 * stream file (0: compress on the component's thread).
+	 */
+	guint compression_thread_count;
+
 	/* True to completely ignore discarded events messages */
 	bool ignore_discarded_events;
 
@@ -42,6 +53,31 @@ struct fs_sink_comp {
 	 */
 	bool quiet;
 
+	/*
+	 * Number of writer threads, or 0 to write the events on the
+	 * component's thread.
+	 */
+	guint writer_thread_count;
+
+	/* Owned by this; `NULL` if `writer_thread_count` is 0 */
+	struct fs_sink_writers *writers;
+
+	/*
+	 * Maximum number of streams of which the files are open at the
+	 * same time, or 0 for no limit.
+	 */
+	guint64 max_open_streams;
+
+	/*
+	 * Queue of the streams (`struct fs_sink_stream *`, weak) of
+	 * which the files are open, most recently used first, when
+	 * `max_open_streams` is not 0.
+	 *
+	 * The links are the `open_streams_link` members of the
+	 * streams.
+	 */
+	GQueue open_streams;
+
 	/*
 	 * Hash table of `const bt_trace *` (weak) to
 	 * `struct fs_sink_trace *` (owned by hash table).
@@ -696,8 +696,6 @@ static
 void append_stream_class(struct ctx *ctx,
 		struct fs_sink_ctf_stream_class *sc)
 {
-	uint64_t i;
-
 	/* Default clock class */
 	if (sc->default_clock_class) {
 		const char *descr;
@@ -857,15 +855,10 @@ void append_stream_class(struct ctx *ctx,
 
 	/* End stream class */
 	append_end_block_semi_nl_nl(ctx);
-
-	/* Event classes */
-	for (i = 0; i < sc->event_classes->len; i++) {
-		append_event_class(ctx, sc->event_classes->pdata[i]);
-	}
 }
 
 BT_HIDDEN
-void translate_trace_ctf_ir_to_tsdl(struct fs_sink_ctf_trace *trace,
+void translate_trace_ctf_ir_to_tsdl_preamble(struct fs_sink_ctf_trace *trace,
 		GString *tsdl)
 {
 	struct ctx ctx = {
@@ -875,7 +868,7 @@ void translate_trace_ctf_ir_to_tsdl(struct fs_sink_ctf_trace *trace,
 	uint64_t i;
 	uint64_t count;
 
-	g_string_assign(tsdl, "/* CTF 1.8 */\n\n");
+	g_string_append(tsdl, "/* CTF 1.8 */\n\n");
 	g_string_append(tsdl, "/* This was generated by a Babeltrace `sink.ctf.fs` component. */\n\n");
 
 	/* Trace class */
@@ -969,9 +962,28 @@ void translate_trace_ctf_ir_to_tsdl(struct fs_sink_ctf_trace *trace,
 		/* End trace class environment */
 		append_end_block_semi_nl_nl(&ctx);
 	}
+}
 
-	/* Stream classes and their event classes */
-	for (i = 0; i < trace->stream_classes->len; i++) {
-		append_stream_class(&ctx, trace->stream_classes->pdata[i]);
-	}
+BT_HIDDEN
+void translate_stream_class_ctf_ir_to_tsdl(
+		struct fs_sink_ctf_stream_class *sc, GString *tsdl)
+{
+	struct ctx ctx = {
+		.indent_level = 0,
+		.tsdl = tsdl,
+	};
+
+	append_stream_class(&ctx, sc);
+}
+
+BT_HIDDEN
+void translate_event_class_ctf_ir_to_tsdl(
+		struct fs_sink_ctf_event_class *ec, GString *tsdl)
+{
+	struct ctx ctx = {
+		.indent_level = 0,
+		.tsdl = tsdl,
+	};
+
+	append_event_class(&ctx, ec);
 }
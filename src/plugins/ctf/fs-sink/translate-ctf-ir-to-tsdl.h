@@ -12,8 +12,26 @@
 #include "common/macros.h"
 #include "fs-sink-ctf-meta.h"
 
+/*
+ * The TSDL metadata of a trace is its preamble (trace class and
+ * environment), followed with the TSDL of each stream class, each
+ * one followed, anywhere after it, with the TSDL of its event classes.
+ *
+ * This makes it possible to append the TSDL of each new stream class
+ * and event class to the metadata file as it appears.
+ *
+ * Each function below appends to `tsdl`.
+ */
 BT_HIDDEN
-void translate_trace_ctf_ir_to_tsdl(struct fs_sink_ctf_trace *trace,
+void translate_trace_ctf_ir_to_tsdl_preamble(struct fs_sink_ctf_trace *trace,
 		GString *tsdl);
 
+BT_HIDDEN
+void translate_stream_class_ctf_ir_to_tsdl(
+		struct fs_sink_ctf_stream_class *sc, GString *tsdl);
+
+BT_HIDDEN
+void translate_event_class_ctf_ir_to_tsdl(
+		struct fs_sink_ctf_event_class *ec, GString *tsdl);
+
 #endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_TRANSLATE_CTF_IR_TO_TSDL_H */
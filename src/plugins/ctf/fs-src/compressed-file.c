@@ -0,0 +1,535 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (self_comp)
+#define BT_LOG_OUTPUT_LEVEL (log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/COMPRESSED"
+#include "logging/comp-logging.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "compat/mman.h"
+#include "fs.h"
+#include "compressed-file.h"
+
+#ifdef ENABLE_ZSTD
+# include <zstd.h>
+#endif
+
+BT_HIDDEN
+bool ctf_fs_compressed_file_path_is_compressed(const char *path)
+{
+	return g_str_has_suffix(path, CTF_FS_COMPRESSED_FILE_ZSTD_SUFFIX);
+}
+
+#ifdef ENABLE_ZSTD
+
+struct compressed_frame {
+	/* Offset and size (bytes) of the frame within the file */
+	uint64_t offset;
+	uint64_t size;
+
+	/* Offset and size (bytes) of the frame's decompressed content */
+	uint64_t content_offset;
+	uint64_t content_size;
+};
+
+struct ctf_fs_compressed_file {
+	bt_logging_level log_level;
+
+	/* Weak */
+	bt_self_component *self_comp;
+
+	/* Weak */
+	struct ctf_fs_file *file;
+
+	/* Mapping of the whole compressed file */
+	const uint8_t *addr;
+	size_t size;
+
+	/*
+	 * Array of `struct compressed_frame`, in file order, excluding
+	 * the frames without content (skippable and empty frames).
+	 */
+	GArray *frames;
+
+	/* Size (bytes) of the whole decompressed content */
+	uint64_t content_size;
+
+	/* Owned by this */
+	ZSTD_DStream *dstream;
+
+	/*
+	 * Index, within `frames`, of the frame which `dstream`
+	 * decompresses, or `G_MAXUINT` if none.
+	 */
+	guint cur_frame_index;
+
+	/* Remaining input of `dstream`, within the current frame */
+	ZSTD_inBuffer in;
+
+	/* Offset of the next content byte which `dstream` produces */
+	uint64_t pos;
+
+	/* Buffer to decompress content to skip (owned by this) */
+	uint8_t *skip_buf;
+	size_t skip_buf_size;
+};
+
+static inline
+struct compressed_frame *borrow_frame(struct ctf_fs_compressed_file *cfile,
+		guint index)
+{
+	return &g_array_index(cfile->frames, struct compressed_frame, index);
+}
+
+static
+int start_frame(struct ctf_fs_compressed_file *cfile, guint index)
+{
+	bt_logging_level log_level = cfile->log_level;
+	bt_self_component *self_comp = cfile->self_comp;
+	struct compressed_frame *frame = borrow_frame(cfile, index);
+	size_t zret;
+	int ret = 0;
+
+	zret = ZSTD_initDStream(cfile->dstream);
+	if (ZSTD_isError(zret)) {
+		BT_COMP_LOGE("Cannot initialize zstd decompression stream: "
+			"path=\"%s\", error=\"%s\"", cfile->file->path->str,
+			ZSTD_getErrorName(zret));
+		ret = -1;
+		goto end;
+	}
+
+	cfile->in.src = cfile->addr + frame->offset;
+	cfile->in.size = frame->size;
+	cfile->in.pos = 0;
+	cfile->pos = frame->content_offset;
+	cfile->cur_frame_index = index;
+
+end:
+	return ret;
+}
+
+/*
+ * Decompresses exactly `len` bytes of content, from the current
+ * position, into `dst`, going on with the next frames if needed.
+ */
+static
+int decompress(struct ctf_fs_compressed_file *cfile, uint8_t *dst,
+		size_t len)
+{
+	bt_logging_level log_level = cfile->log_level;
+	bt_self_component *self_comp = cfile->self_comp;
+	ZSTD_outBuffer out = { dst, len, 0 };
+	int ret = 0;
+
+	BT_ASSERT_DBG(cfile->cur_frame_index != G_MAXUINT);
+
+	while (out.pos < out.size) {
+		struct compressed_frame *frame =
+			borrow_frame(cfile, cfile->cur_frame_index);
+		uint64_t frame_content_end =
+			frame->content_offset + frame->content_size;
+		size_t pos_before = out.pos;
+		size_t zret;
+
+		if (cfile->pos == frame_content_end) {
+			/* Done with this frame: go on with the next one */
+			if (cfile->cur_frame_index + 1 >= cfile->frames->len) {
+				BT_COMP_LOGE("Unexpected end of compressed content: "
+					"path=\"%s\", offset=%" PRIu64,
+					cfile->file->path->str, cfile->pos);
+				ret = -1;
+				goto end;
+			}
+
+			ret = start_frame(cfile, cfile->cur_frame_index + 1);
+			if (ret) {
+				goto end;
+			}
+
+			continue;
+		}
+
+		zret = ZSTD_decompressStream(cfile->dstream, &out, &cfile->in);
+		if (ZSTD_isError(zret)) {
+			BT_COMP_LOGE("Cannot decompress zstd frame: "
+				"path=\"%s\", frame-offset=%" PRIu64 ", "
+				"error=\"%s\"", cfile->file->path->str,
+				frame->offset, ZSTD_getErrorName(zret));
+			ret = -1;
+			goto end;
+		}
+
+		cfile->pos += out.pos - pos_before;
+
+		if (cfile->pos > frame_content_end ||
+				(out.pos == pos_before &&
+				cfile->in.pos == cfile->in.size)) {
+			BT_COMP_LOGE("Corrupted or truncated zstd frame: "
+				"path=\"%s\", frame-offset=%" PRIu64,
+				cfile->file->path->str, frame->offset);
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Returns the index of the frame which contains the content offset
+ * `offset`.
+ */
+static
+guint find_frame(struct ctf_fs_compressed_file *cfile, uint64_t offset)
+{
+	guint low = 0;
+	guint high = cfile->frames->len;
+
+	BT_ASSERT_DBG(cfile->frames->len > 0);
+
+	/* Find the last frame which begins at or before `offset` */
+	while (high - low > 1) {
+		guint mid = low + (high - low) / 2;
+
+		if (borrow_frame(cfile, mid)->content_offset <= offset) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Computes the content size of the frame of `frame_size` bytes at
+ * `offset` in `cfile` by decompressing it, for a frame header which
+ * doesn't contain it.
+ */
+static
+int count_frame_content_size(struct ctf_fs_compressed_file *cfile,
+		uint64_t offset, size_t frame_size, uint64_t *content_size)
+{
+	bt_logging_level log_level = cfile->log_level;
+	bt_self_component *self_comp = cfile->self_comp;
+	ZSTD_inBuffer in = { cfile->addr + offset, frame_size, 0 };
+	size_t zret;
+	int ret = 0;
+
+	*content_size = 0;
+	zret = ZSTD_initDStream(cfile->dstream);
+
+	while (!ZSTD_isError(zret)) {
+		ZSTD_outBuffer out = { cfile->skip_buf, cfile->skip_buf_size, 0 };
+
+		zret = ZSTD_decompressStream(cfile->dstream, &out, &in);
+		if (ZSTD_isError(zret)) {
+			break;
+		}
+
+		*content_size += out.pos;
+
+		if (zret == 0) {
+			/* End of frame */
+			goto end;
+		}
+
+		if (out.pos == 0 && in.pos == in.size) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Truncated zstd frame: path=\"%s\", "
+				"frame-offset=%" PRIu64,
+				cfile->file->path->str, offset);
+			ret = -1;
+			goto end;
+		}
+	}
+
+	BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		"Cannot decompress zstd frame: path=\"%s\", "
+		"frame-offset=%" PRIu64 ", error=\"%s\"",
+		cfile->file->path->str, offset, ZSTD_getErrorName(zret));
+	ret = -1;
+
+end:
+	return ret;
+}
+
+static
+int build_frame_table(struct ctf_fs_compressed_file *cfile)
+{
+	bt_logging_level log_level = cfile->log_level;
+	bt_self_component *self_comp = cfile->self_comp;
+	uint64_t offset = 0;
+	int ret = 0;
+
+	cfile->content_size = 0;
+
+	while (offset < cfile->size) {
+		struct compressed_frame frame;
+		unsigned long long frame_content_size;
+		size_t frame_size = ZSTD_findFrameCompressedSize(
+			cfile->addr + offset, cfile->size - offset);
+
+		if (ZSTD_isError(frame_size)) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Invalid zstd frame: path=\"%s\", "
+				"frame-offset=%" PRIu64 ", error=\"%s\"",
+				cfile->file->path->str, offset,
+				ZSTD_getErrorName(frame_size));
+			ret = -1;
+			goto end;
+		}
+
+		/* This is 0 for a skippable frame */
+		frame_content_size = ZSTD_getFrameContentSize(
+			cfile->addr + offset, frame_size);
+		if (frame_content_size == ZSTD_CONTENTSIZE_ERROR) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Invalid zstd frame header: path=\"%s\", "
+				"frame-offset=%" PRIu64,
+				cfile->file->path->str, offset);
+			ret = -1;
+			goto end;
+		} else if (frame_content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+			uint64_t counted_size;
+
+			ret = count_frame_content_size(cfile, offset,
+				frame_size, &counted_size);
+			if (ret) {
+				goto end;
+			}
+
+			frame_content_size = counted_size;
+		}
+
+		if (frame_content_size > 0) {
+			frame.offset = offset;
+			frame.size = frame_size;
+			frame.content_offset = cfile->content_size;
+			frame.content_size = frame_content_size;
+			g_array_append_val(cfile->frames, frame);
+			cfile->content_size += frame_content_size;
+		}
+
+		offset += frame_size;
+	}
+
+	BT_COMP_LOGI("Built zstd frame table: path=\"%s\", frame-count=%u, "
+		"size=%zu, content-size=%" PRIu64, cfile->file->path->str,
+		cfile->frames->len, cfile->size, cfile->content_size);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct ctf_fs_compressed_file *ctf_fs_compressed_file_create(
+		struct ctf_fs_file *file, bt_logging_level log_level,
+		bt_self_component *self_comp)
+{
+	struct ctf_fs_compressed_file *cfile =
+		g_new0(struct ctf_fs_compressed_file, 1);
+	void *addr;
+
+	if (!cfile) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a compressed file object.");
+		goto error;
+	}
+
+	cfile->log_level = log_level;
+	cfile->self_comp = self_comp;
+	cfile->file = file;
+	cfile->cur_frame_index = G_MAXUINT;
+
+	if (file->size <= 0 || (uint64_t) file->size > SIZE_MAX) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Invalid compressed data stream file size: "
+			"path=\"%s\", size=%jd", file->path->str,
+			(intmax_t) file->size);
+		goto error;
+	}
+
+	cfile->size = (size_t) file->size;
+	addr = bt_mmap((void *) 0, cfile->size, PROT_READ, MAP_PRIVATE,
+		fileno(file->fp), 0, log_level);
+	if (addr == MAP_FAILED) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot memory-map compressed data stream file: "
+			"path=\"%s\", size=%zu: %s", file->path->str,
+			cfile->size, strerror(errno));
+		goto error;
+	}
+
+	cfile->addr = addr;
+	bt_mmap_advise_sequential(addr, cfile->size);
+	cfile->dstream = ZSTD_createDStream();
+	if (!cfile->dstream) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to create a zstd decompression stream.");
+		goto error;
+	}
+
+	cfile->skip_buf_size = ZSTD_DStreamOutSize();
+	cfile->skip_buf = g_malloc(cfile->skip_buf_size);
+	if (!cfile->skip_buf) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a buffer.");
+		goto error;
+	}
+
+	cfile->frames = g_array_new(FALSE, FALSE,
+		sizeof(struct compressed_frame));
+	if (!cfile->frames) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a GArray.");
+		goto error;
+	}
+
+	if (build_frame_table(cfile)) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ctf_fs_compressed_file_destroy(cfile);
+	cfile = NULL;
+
+end:
+	return cfile;
+}
+
+BT_HIDDEN
+void ctf_fs_compressed_file_destroy(struct ctf_fs_compressed_file *cfile)
+{
+	if (!cfile) {
+		return;
+	}
+
+	if (cfile->addr) {
+		bt_logging_level log_level = cfile->log_level;
+		bt_self_component *self_comp = cfile->self_comp;
+
+		if (bt_munmap((void *) cfile->addr, cfile->size)) {
+			BT_COMP_LOGE("Cannot unmap compressed data stream file: "
+				"path=\"%s\": %s", cfile->file->path->str,
+				strerror(errno));
+		}
+	}
+
+	if (cfile->dstream) {
+		ZSTD_freeDStream(cfile->dstream);
+	}
+
+	if (cfile->frames) {
+		g_array_free(cfile->frames, TRUE);
+	}
+
+	g_free(cfile->skip_buf);
+	g_free(cfile);
+}
+
+BT_HIDDEN
+off_t ctf_fs_compressed_file_get_size(struct ctf_fs_compressed_file *cfile)
+{
+	BT_ASSERT_DBG(cfile);
+	return (off_t) cfile->content_size;
+}
+
+BT_HIDDEN
+int ctf_fs_compressed_file_read(struct ctf_fs_compressed_file *cfile,
+		off_t offset, uint8_t *buf, size_t len)
+{
+	uint64_t u_offset = (uint64_t) offset;
+	guint frame_index;
+	int ret = 0;
+
+	BT_ASSERT(offset >= 0);
+	BT_ASSERT(u_offset + len <= cfile->content_size);
+
+	if (len == 0) {
+		goto end;
+	}
+
+	frame_index = find_frame(cfile, u_offset);
+
+	/*
+	 * Restart from the beginning of the frame which contains
+	 * `offset` unless the current decompression stream is already
+	 * within this frame, before `offset`.
+	 */
+	if (cfile->cur_frame_index != frame_index || cfile->pos > u_offset) {
+		ret = start_frame(cfile, frame_index);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	/* Skip the content before `offset` */
+	while (cfile->pos < u_offset) {
+		ret = decompress(cfile, cfile->skip_buf,
+			MIN(cfile->skip_buf_size,
+				(size_t) (u_offset - cfile->pos)));
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ret = decompress(cfile, buf, len);
+
+end:
+	return ret;
+}
+
+#else /* ENABLE_ZSTD */
+
+struct ctf_fs_compressed_file {
+	int unused;
+};
+
+BT_HIDDEN
+struct ctf_fs_compressed_file *ctf_fs_compressed_file_create(
+		struct ctf_fs_file *file, bt_logging_level log_level,
+		bt_self_component *self_comp)
+{
+	BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		"Cannot read compressed data stream file: "
+		"Babeltrace was built without zstd support "
+		"(see the `--enable-zstd` configuration option): path=\"%s\"",
+		file->path->str);
+	return NULL;
+}
+
+BT_HIDDEN
+void ctf_fs_compressed_file_destroy(struct ctf_fs_compressed_file *cfile)
+{
+	BT_ASSERT(!cfile);
+}
+
+BT_HIDDEN
+off_t ctf_fs_compressed_file_get_size(struct ctf_fs_compressed_file *cfile)
+{
+	bt_common_abort();
+}
+
+BT_HIDDEN
+int ctf_fs_compressed_file_read(struct ctf_fs_compressed_file *cfile,
+		off_t offset, uint8_t *buf, size_t len)
+{
+	bt_common_abort();
+}
+
+#endif /* ENABLE_ZSTD */
@@ -0,0 +1,70 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef CTF_FS_COMPRESSED_FILE_H
+#define CTF_FS_COMPRESSED_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/* Suffix of the name of a zstd-compressed data stream file */
+#define CTF_FS_COMPRESSED_FILE_ZSTD_SUFFIX	".zst"
+
+struct ctf_fs_file;
+
+/*
+ * Decompressed view of a compressed data stream file.
+ *
+ * A compressed data stream file is a sequence of zstd frames, possibly
+ * with skippable frames. Reading at some offset decompresses from the
+ * beginning of the frame which contains it, so that a file made of
+ * many frames (for example one frame per packet, or a seekable zstd
+ * file) is also cheap to read at random offsets.
+ */
+struct ctf_fs_compressed_file;
+
+/*
+ * Returns whether or not the data stream file `path` is compressed,
+ * based on its name.
+ */
+BT_HIDDEN
+bool ctf_fs_compressed_file_path_is_compressed(const char *path);
+
+/*
+ * Creates a decompressed view of the open file `file`.
+ *
+ * Logs and appends an error cause on error, including when the
+ * component was built without compressed file support.
+ */
+BT_HIDDEN
+struct ctf_fs_compressed_file *ctf_fs_compressed_file_create(
+		struct ctf_fs_file *file, bt_logging_level log_level,
+		bt_self_component *self_comp);
+
+BT_HIDDEN
+void ctf_fs_compressed_file_destroy(struct ctf_fs_compressed_file *cfile);
+
+/*
+ * Returns the size (bytes) of the decompressed content of `cfile`.
+ */
+BT_HIDDEN
+off_t ctf_fs_compressed_file_get_size(struct ctf_fs_compressed_file *cfile);
+
+/*
+ * Decompresses exactly `len` bytes of the content of `cfile` at the
+ * offset `offset` into `buf`.
+ *
+ * Returns 0 on success.
+ */
+BT_HIDDEN
+int ctf_fs_compressed_file_read(struct ctf_fs_compressed_file *cfile,
+		off_t offset, uint8_t *buf, size_t len);
+
+#endif /* CTF_FS_COMPRESSED_FILE_H */
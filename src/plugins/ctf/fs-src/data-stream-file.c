@@ -17,17 +17,35 @@
 #include <stdlib.h>
 #include <glib.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "compat/mman.h"
 #include "compat/endian.h"
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "common/align.h"
+#include "common/probes.h"
 #include "file.h"
 #include "metadata.h"
 #include "../common/msg-iter/msg-iter.h"
 #include "common/assert.h"
 #include "data-stream-file.h"
+#include "index-cache.h"
+#include "compressed-file.h"
 #include <string.h>
 
+/*
+ * Maximum length (bytes) of a mapping which ds_file_mmap() makes larger
+ * than the mapping window to contain a whole packet.
+ */
+#define MAX_PACKET_MAPPING_LEN	(64 * 1024 * 1024)
+
+/*
+ * Number of packets, following the one being read, of a data stream
+ * file group which ctf_fs_ds_group_medops prefetches.
+ */
+#define GROUP_PREFETCH_PACKET_COUNT	4
+
 static inline
 size_t remaining_mmap_bytes(struct ctf_fs_ds_file *ds_file)
 {
@@ -61,6 +79,13 @@ enum ctf_msg_iter_medium_status ds_file_munmap(
 		goto end;
 	}
 
+	if (ds_file->compressed_file) {
+		/* Keep the window buffer for the next window */
+		ds_file->mmap_addr = NULL;
+		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+		goto end;
+	}
+
 	if (bt_munmap(ds_file->mmap_addr, ds_file->mmap_len)) {
 		BT_COMP_LOGE_ERRNO("Cannot memory-unmap file",
 			": address=%p, size=%zu, file_path=\"%s\", file=%p",
@@ -83,6 +108,11 @@ end:
  * mapping.  If the currently mmap-ed region already contains
  * `requested_offset_in_file`, the mapping is kept.
  *
+ * If `min_len` isn't 0, the mapping also contains the `min_len` bytes
+ * which follow `requested_offset_in_file` (for example, a whole
+ * packet), even if this makes it larger than `ds_file->mmap_max_len`,
+ * so that the message iterator reads them as a single buffer.
+ *
  * Set `ds_file->requested_offset_in_mapping` based on `request_offset_in_file`,
  * such that the next call to `request_bytes` will return bytes starting at that
  * position.
@@ -91,7 +121,8 @@ end:
  */
 static
 enum ctf_msg_iter_medium_status ds_file_mmap(
-		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file)
+		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file,
+		size_t min_len)
 {
 	enum ctf_msg_iter_medium_status status;
 	bt_self_component *self_comp = ds_file->self_comp;
@@ -102,10 +133,25 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 	BT_ASSERT(requested_offset_in_file < ds_file->file->size);
 
 	/*
-	 * If the mapping already contains the requested offset, just adjust
-	 * requested_offset_in_mapping.
+	 * A decompressed window has a fixed size, and a huge packet
+	 * isn't worth a huge mapping: use regular windows then.
 	 */
-	if (offset_ist_mapped(ds_file, requested_offset_in_file)) {
+	if (ds_file->compressed_file ||
+			min_len > MAX_PACKET_MAPPING_LEN) {
+		min_len = 0;
+	}
+
+	min_len = MIN(min_len,
+		(size_t) (ds_file->file->size - requested_offset_in_file));
+
+	/*
+	 * If the mapping already contains the requested region, just
+	 * adjust requested_offset_in_mapping.
+	 */
+	if (offset_ist_mapped(ds_file, requested_offset_in_file) &&
+			requested_offset_in_file + (off_t) min_len <=
+				ds_file->mmap_offset_in_file +
+				(off_t) ds_file->mmap_len) {
 		ds_file->request_offset_in_mapping =
 			requested_offset_in_file - ds_file->mmap_offset_in_file;
 		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
@@ -127,9 +173,29 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 	ds_file->mmap_offset_in_file =
 		requested_offset_in_file - ds_file->request_offset_in_mapping;
 	ds_file->mmap_len = MIN(ds_file->file->size - ds_file->mmap_offset_in_file,
-		ds_file->mmap_max_len);
+		MAX(ds_file->mmap_max_len,
+			(size_t) ds_file->request_offset_in_mapping + min_len));
 
 	BT_ASSERT(ds_file->mmap_len > 0);
+	BT_PROBE3(ctf_fs_ds_file_mmap, ds_file,
+		(int64_t) ds_file->mmap_offset_in_file, ds_file->mmap_len);
+
+	if (ds_file->compressed_file) {
+		/* Decompress the window instead of mapping it */
+		if (ctf_fs_compressed_file_read(ds_file->compressed_file,
+				ds_file->mmap_offset_in_file,
+				ds_file->compressed_window, ds_file->mmap_len)) {
+			BT_COMP_LOGE("Cannot decompress region (size %zu) of file \"%s\" at offset %jd",
+				ds_file->mmap_len, ds_file->file->path->str,
+				(intmax_t) ds_file->mmap_offset_in_file);
+			status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+			goto end;
+		}
+
+		ds_file->mmap_addr = ds_file->compressed_window;
+		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+		goto end;
+	}
 
 	ds_file->mmap_addr = bt_mmap((void *) 0, ds_file->mmap_len,
 			PROT_READ, MAP_PRIVATE, fileno(ds_file->file->fp),
@@ -143,6 +209,27 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 		goto end;
 	}
 
+	/*
+	 * Data is mostly read forward: have the system read the next
+	 * region in the background while we decode this one.
+	 */
+	if (ds_file->mmap_offset_in_file + ds_file->mmap_len <
+			ds_file->file->size) {
+		off_t next_offset = ds_file->mmap_offset_in_file +
+			ds_file->mmap_len;
+
+		bt_file_prefetch(fileno(ds_file->file->fp), next_offset,
+			(off_t) MIN((size_t) (ds_file->file->size - next_offset),
+				ds_file->mmap_max_len));
+	}
+
+	/* Mappings are mostly read forward */
+	bt_mmap_advise_sequential(ds_file->mmap_addr, ds_file->mmap_len);
+
+	if (ds_file->huge_pages) {
+		bt_mmap_advise_huge_pages(ds_file->mmap_addr,
+			ds_file->mmap_len);
+	}
 	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
 
 end:
@@ -182,7 +269,7 @@ enum ctf_msg_iter_medium_status ds_file_mmap_next(
 	}
 
 	status = ds_file_mmap(ds_file,
-		ds_file->mmap_offset_in_file + ds_file->mmap_len);
+		ds_file->mmap_offset_in_file + ds_file->mmap_len, 0);
 
 end:
 	return status;
@@ -277,7 +364,7 @@ enum ctf_msg_iter_medium_status medop_seek(off_t offset, void *data)
 	BT_ASSERT(offset >= 0);
 	BT_ASSERT(offset < ds_file->file->size);
 
-	return ds_file_mmap(ds_file, offset);
+	return ds_file_mmap(ds_file, offset, 0);
 }
 
 BT_HIDDEN
@@ -298,6 +385,12 @@ struct ctf_fs_ds_group_medops_data {
 	 */
 	guint next_index_entry_index;
 
+	/*
+	 * Index of the first index entry of ds_file_groups' index which
+	 * wasn't prefetched yet.
+	 */
+	guint next_prefetch_index_entry_index;
+
 	/*
 	 * File we are currently reading.  Changes whenever we switch to
 	 * reading another data file.
@@ -306,6 +399,20 @@ struct ctf_fs_ds_group_medops_data {
 	 */
 	struct ctf_fs_ds_file *file;
 
+	/*
+	 * Message iterator to make skip the event records of the packets
+	 * which contain none of the event classes of
+	 * `wanted_event_class_bits`, or `NULL` (weak).
+	 */
+	struct ctf_msg_iter *msg_iter;
+
+	/*
+	 * Bitwise OR of ctf_msg_iter_event_class_id_bit() for the IDs
+	 * of the event classes of which `msg_iter` creates event
+	 * messages.
+	 */
+	uint64_t wanted_event_class_bits;
+
 	/* Weak, for context / logging / appending causes. */
 	bt_self_message_iterator *self_msg_iter;
 	bt_logging_level log_level;
@@ -374,9 +481,12 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_set_file(
 
 	/*
 	 * Ensure the right portion of the file will be returned on the next
-	 * request_bytes call.
+	 * request_bytes call, as a single buffer containing the whole
+	 * packet if possible: then no field of this packet crosses a
+	 * buffer boundary.
 	 */
-	status = ds_file_mmap(data->file, index_entry->offset);
+	status = ds_file_mmap(data->file, index_entry->offset,
+		(size_t) MIN(index_entry->packet_size, (uint64_t) SIZE_MAX));
 	if (status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
 		goto end;
 	}
@@ -387,6 +497,100 @@ end:
 	return status;
 }
 
+/*
+ * Advises the system that the packet described by `index_entry`, which
+ * is in another data stream file than the one being read, is about
+ * to be read.
+ *
+ * The file isn't kept open: the hint only fills the page cache.
+ */
+static
+void prefetch_packet_in_other_file(
+		struct ctf_fs_ds_index_entry *index_entry)
+{
+	int fd;
+
+	if (ctf_fs_compressed_file_path_is_compressed(index_entry->path)) {
+		goto end;
+	}
+
+	fd = open(index_entry->path, O_RDONLY);
+	if (fd < 0) {
+		/* Only a hint: the actual read reports any error */
+		goto end;
+	}
+
+	bt_file_prefetch(fd, index_entry->offset,
+		(off_t) index_entry->packet_size);
+	(void) close(fd);
+
+end:
+	return;
+}
+
+/*
+ * Returns whether or not the packet of `index_entry` may contain an
+ * event record of which `data->msg_iter` creates an event message.
+ */
+static inline
+bool packet_may_contain_wanted_events(
+		struct ctf_fs_ds_group_medops_data *data,
+		struct ctf_fs_ds_index_entry *index_entry)
+{
+	return !data->msg_iter || (index_entry->event_class_bits &
+		data->wanted_event_class_bits);
+}
+
+/*
+ * Advises the system that the next packets of the data stream file
+ * group, following the one which `data->file` is about to read, are
+ * about to be read, so that it reads them in the background while we
+ * decode this one and the packets of the other streams.
+ *
+ * The muxer consumes the streams in time order, and the index gives,
+ * for each stream, the next packets in time order: each message
+ * iterator prefetching the next few packets of its own stream makes
+ * all the streams progress ahead of the consumer.
+ */
+static
+void prefetch_next_packets(struct ctf_fs_ds_group_medops_data *data)
+{
+	GPtrArray *entries = data->ds_file_group->index->entries;
+	guint end = MIN(entries->len,
+		data->next_index_entry_index + 1 + GROUP_PREFETCH_PACKET_COUNT);
+	guint i;
+
+	i = MAX(data->next_prefetch_index_entry_index,
+		data->next_index_entry_index + 1);
+
+	for (; i < end; i++) {
+		struct ctf_fs_ds_index_entry *index_entry =
+			g_ptr_array_index(entries, i);
+
+		if (!packet_may_contain_wanted_events(data, index_entry)) {
+			/* Only its header and context will be read */
+			continue;
+		}
+
+		if (strcmp(index_entry->path,
+				data->file->file->path->str) != 0) {
+			prefetch_packet_in_other_file(index_entry);
+		} else if (!data->file->compressed_file &&
+				!(offset_ist_mapped(data->file,
+					index_entry->offset) &&
+				offset_ist_mapped(data->file,
+					index_entry->offset +
+					(off_t) index_entry->packet_size - 1))) {
+			bt_file_prefetch(fileno(data->file->file->fp),
+				index_entry->offset,
+				(off_t) index_entry->packet_size);
+		}
+	}
+
+	data->next_prefetch_index_entry_index = MAX(
+		data->next_prefetch_index_entry_index, end);
+}
+
 static
 enum ctf_msg_iter_medium_status medop_group_switch_packet(void *void_data)
 {
@@ -394,6 +598,9 @@ enum ctf_msg_iter_medium_status medop_group_switch_packet(void *void_data)
 	struct ctf_fs_ds_index_entry *index_entry;
 	enum ctf_msg_iter_medium_status status;
 
+	/* The user of `data` acquired the index of the group */
+	BT_ASSERT(data->ds_file_group->index);
+
 	/* If we have gone through all index entries, we are done. */
 	if (data->next_index_entry_index >=
 		data->ds_file_group->index->entries->len) {
@@ -415,6 +622,17 @@ enum ctf_msg_iter_medium_status medop_group_switch_packet(void *void_data)
 		goto end;
 	}
 
+	if (data->msg_iter) {
+		/*
+		 * The message iterator still reads the header and
+		 * context of the packet to emit its beginning and end
+		 * messages.
+		 */
+		ctf_msg_iter_set_skip_event_records(data->msg_iter,
+			!packet_may_contain_wanted_events(data, index_entry));
+	}
+
+	prefetch_next_packets(data);
 	data->next_index_entry_index++;
 
 	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
@@ -449,8 +667,6 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 
 	BT_ASSERT(self_msg_iter);
 	BT_ASSERT(ds_file_group);
-	BT_ASSERT(ds_file_group->index);
-	BT_ASSERT(ds_file_group->index->entries->len > 0);
 
 	data = g_new0(struct ctf_fs_ds_group_medops_data, 1);
 	if (!data) {
@@ -484,6 +700,32 @@ end:
 void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data)
 {
 	data->next_index_entry_index = 0;
+	data->next_prefetch_index_entry_index = 0;
+}
+
+void ctf_fs_ds_group_medops_data_release_file(
+		struct ctf_fs_ds_group_medops_data *data)
+{
+	ctf_fs_ds_file_destroy(data->file);
+	data->file = NULL;
+}
+
+void ctf_fs_ds_group_medops_data_set_event_class_filter(
+		struct ctf_fs_ds_group_medops_data *data,
+		struct ctf_msg_iter *msg_iter,
+		uint64_t wanted_event_class_bits)
+{
+	data->msg_iter = msg_iter;
+	data->wanted_event_class_bits = wanted_event_class_bits;
+}
+
+void ctf_fs_ds_group_medops_data_seek_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index)
+{
+	BT_ASSERT(index_entry_index < data->ds_file_group->index->entries->len);
+	data->next_index_entry_index = index_entry_index;
+	data->next_prefetch_index_entry_index = 0;
 }
 
 struct ctf_msg_iter_medium_ops ctf_fs_ds_group_medops = {
@@ -511,6 +753,7 @@ struct ctf_fs_ds_index_entry *ctf_fs_ds_index_entry_create(
 	}
 
 	entry->packet_seq_num = UINT64_MAX;
+	entry->event_class_bits = UINT64_MAX;
 
 end:
 	return entry;
@@ -525,6 +768,123 @@ int convert_cycles_to_ns(struct ctf_clock_class *clock_class,
 			clock_class->offset_cycles, ns);
 }
 
+/*
+ * Converter of clock values to nanoseconds from origin for many values
+ * of the same clock class.
+ *
+ * When the frequency of the clock class is 1 GHz (for example, LTTng
+ * clock classes), a conversion is a checked addition to the nanoseconds
+ * from origin of the clock value 0, computed once. This gives the same
+ * results as convert_cycles_to_ns().
+ */
+struct cycles_to_ns_converter {
+	/* Weak */
+	struct ctf_clock_class *clock_class;
+
+	/* Nanoseconds from origin of the clock value 0 */
+	int64_t base_ns;
+
+	/* True if the fast path above applies */
+	bool is_1_ghz;
+};
+
+static
+void cycles_to_ns_converter_init(struct cycles_to_ns_converter *converter,
+		struct ctf_clock_class *clock_class)
+{
+	converter->clock_class = clock_class;
+	converter->is_1_ghz = clock_class->frequency == UINT64_C(1000000000) &&
+		convert_cycles_to_ns(clock_class, 0, &converter->base_ns) == 0;
+}
+
+static inline
+int cycles_to_ns_converter_convert(
+		const struct cycles_to_ns_converter *converter,
+		uint64_t cycles, int64_t *ns)
+{
+	if (G_UNLIKELY(!converter->is_1_ghz)) {
+		return convert_cycles_to_ns(converter->clock_class, cycles, ns);
+	}
+
+	if (cycles >= (uint64_t) INT64_MAX) {
+		return -1;
+	}
+
+	if (converter->base_ns > 0 &&
+			(int64_t) cycles > INT64_MAX - converter->base_ns) {
+		return -1;
+	}
+
+	*ns = converter->base_ns + (int64_t) cycles;
+	return 0;
+}
+
+/*
+ * Validates the `entry_count` big-endian LTTng index entries of
+ * `entry_size` bytes each at `entries` against a data stream file of
+ * `ds_file_size` bytes.
+ *
+ * This pass doesn't allocate anything, so that the caller doesn't
+ * create millions of index entries only to find out that the LTTng
+ * index file is invalid.
+ */
+static
+bool lttng_index_entries_are_valid(struct ctf_fs_ds_file *ds_file,
+		const char *entries, size_t entry_size, size_t entry_count,
+		uint64_t ds_file_size)
+{
+	bool is_valid = false;
+	uint64_t total_packets_size = 0;
+	uint64_t prev_offset = 0;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+	size_t i;
+
+	for (i = 0; i < entry_count; i++) {
+		const struct ctf_packet_index *file_index =
+			(const void *) (entries + i * entry_size);
+		uint64_t packet_size = be64toh(file_index->packet_size);
+		uint64_t offset = be64toh(file_index->offset);
+		uint64_t timestamp_begin = be64toh(file_index->timestamp_begin);
+		uint64_t timestamp_end = be64toh(file_index->timestamp_end);
+
+		if (packet_size % CHAR_BIT) {
+			BT_COMP_LOGW("Invalid packet size encountered in LTTng trace index file");
+			goto end;
+		}
+
+		if (offset < prev_offset) {
+			BT_COMP_LOGW("Invalid, non-monotonic, packet offset encountered in LTTng trace index file: "
+				"previous offset=%" PRIu64 ", current offset=%" PRIu64,
+				prev_offset, offset);
+			goto end;
+		}
+
+		if (timestamp_end < timestamp_begin) {
+			BT_COMP_LOGW("Invalid packet time bounds encountered in LTTng trace index file (begin > end): "
+				"timestamp_begin=%" PRIu64 "timestamp_end=%" PRIu64,
+				timestamp_begin, timestamp_end);
+			goto end;
+		}
+
+		total_packets_size += packet_size / CHAR_BIT;
+		prev_offset = offset;
+	}
+
+	/* Validate that the index addresses the complete stream. */
+	if (ds_file_size != total_packets_size) {
+		BT_COMP_LOGW("Invalid LTTng trace index file; indexed size != stream file size: "
+			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
+			ds_file_size, total_packets_size);
+		goto end;
+	}
+
+	is_valid = true;
+
+end:
+	return is_valid;
+}
+
 static
 struct ctf_fs_ds_index *build_index_from_idx_file(
 		struct ctf_fs_ds_file *ds_file,
@@ -541,8 +901,8 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 	const char *mmap_begin = NULL, *file_pos = NULL;
 	const struct ctf_packet_index_file_hdr *header = NULL;
 	struct ctf_fs_ds_index *index = NULL;
-	struct ctf_fs_ds_index_entry *index_entry = NULL, *prev_index_entry = NULL;
-	uint64_t total_packets_size = 0;
+	struct ctf_fs_ds_index_entry *index_entry = NULL;
+	struct cycles_to_ns_converter converter;
 	size_t file_index_entry_size;
 	size_t file_entry_count;
 	size_t i;
@@ -641,20 +1001,22 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 		goto error;
 	}
 
+	if (!lttng_index_entries_are_valid(ds_file, file_pos,
+			file_index_entry_size, file_entry_count,
+			(uint64_t) ds_file->file->size)) {
+		goto error;
+	}
+
 	index = ctf_fs_ds_index_create(ds_file->log_level, ds_file->self_comp);
 	if (!index) {
 		goto error;
 	}
 
+	cycles_to_ns_converter_init(&converter, sc->default_clock_class);
+
 	for (i = 0; i < file_entry_count; i++) {
 		struct ctf_packet_index *file_index =
 				(struct ctf_packet_index *) file_pos;
-		uint64_t packet_size = be64toh(file_index->packet_size);
-
-		if (packet_size % CHAR_BIT) {
-			BT_COMP_LOGW("Invalid packet size encountered in LTTng trace index file");
-			goto error;
-		}
 
 		index_entry = ctf_fs_ds_index_entry_create(
 			ds_file->self_comp, ds_file->log_level);
@@ -668,36 +1030,21 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 		index_entry->path = file_info->path->str;
 
 		/* Convert size in bits to bytes. */
-		packet_size /= CHAR_BIT;
-		index_entry->packet_size = packet_size;
-
+		index_entry->packet_size =
+			be64toh(file_index->packet_size) / CHAR_BIT;
 		index_entry->offset = be64toh(file_index->offset);
-		if (i != 0 && index_entry->offset < prev_index_entry->offset) {
-			BT_COMP_LOGW("Invalid, non-monotonic, packet offset encountered in LTTng trace index file: "
-				"previous offset=%" PRIu64 ", current offset=%" PRIu64,
-				prev_index_entry->offset, index_entry->offset);
-			goto error;
-		}
-
 		index_entry->timestamp_begin = be64toh(file_index->timestamp_begin);
 		index_entry->timestamp_end = be64toh(file_index->timestamp_end);
-		if (index_entry->timestamp_end < index_entry->timestamp_begin) {
-			BT_COMP_LOGW("Invalid packet time bounds encountered in LTTng trace index file (begin > end): "
-				"timestamp_begin=%" PRIu64 "timestamp_end=%" PRIu64,
-				index_entry->timestamp_begin,
-				index_entry->timestamp_end);
-			goto error;
-		}
 
 		/* Convert the packet's bound to nanoseconds since Epoch. */
-		ret = convert_cycles_to_ns(sc->default_clock_class,
+		ret = cycles_to_ns_converter_convert(&converter,
 				index_entry->timestamp_begin,
 				&index_entry->timestamp_begin_ns);
 		if (ret) {
 			BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch during index parsing");
 			goto error;
 		}
-		ret = convert_cycles_to_ns(sc->default_clock_class,
+		ret = cycles_to_ns_converter_convert(&converter,
 				index_entry->timestamp_end,
 				&index_entry->timestamp_end_ns);
 		if (ret) {
@@ -709,23 +1056,13 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 			index_entry->packet_seq_num = be64toh(file_index->packet_seq_num);
 		}
 
-		total_packets_size += packet_size;
 		file_pos += file_index_entry_size;
 
-		prev_index_entry = index_entry;
-
 		/* Give ownership of `index_entry` to `index->entries`. */
 		g_ptr_array_add(index->entries, index_entry);
 		index_entry = NULL;
 	}
 
-	/* Validate that the index addresses the complete stream. */
-	if (ds_file->file->size != total_packets_size) {
-		BT_COMP_LOGW("Invalid LTTng trace index file; indexed size != stream file size: "
-			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
-			ds_file->file->size, total_packets_size);
-		goto error;
-	}
 end:
 	g_free(directory);
 	g_free(basename);
@@ -902,6 +1239,381 @@ error:
 	goto end;
 }
 
+/*
+ * Returns the path of the index cache file of `ds_file` within
+ * `cache_dir`.
+ *
+ * The cache file name is the SHA-1 digest of the absolute path of the
+ * data stream file, so that data stream files of different traces
+ * sharing the same cache directory never collide.
+ */
+static
+gchar *get_index_cache_file_path(struct ctf_fs_ds_file *ds_file,
+		const char *cache_dir)
+{
+	gchar *digest;
+	gchar *basename = NULL;
+	gchar *path = NULL;
+
+	digest = g_compute_checksum_for_string(G_CHECKSUM_SHA1,
+		ds_file->file->path->str, -1);
+	if (!digest) {
+		goto end;
+	}
+
+	basename = g_strconcat(digest, CTF_FS_INDEX_CACHE_SUFFIX, NULL);
+	path = g_build_filename(cache_dir, basename, NULL);
+
+end:
+	g_free(digest);
+	g_free(basename);
+	return path;
+}
+
+static
+void get_index_cache_trace_uuid(struct ctf_fs_ds_file *ds_file,
+		bt_uuid_t uuid)
+{
+	struct ctf_trace_class *tc = ds_file->metadata->tc;
+
+	if (tc->is_uuid_set) {
+		bt_uuid_copy(uuid, tc->uuid);
+	} else {
+		memset(uuid, 0, BT_UUID_LEN);
+	}
+}
+
+static
+struct ctf_fs_ds_index *build_index_from_cache_file(
+		struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_file_info *file_info,
+		struct ctf_msg_iter *msg_iter,
+		const char *cache_dir, bool index_event_classes)
+{
+	int ret;
+	gchar *cache_file_path = NULL;
+	gchar *contents = NULL;
+	gsize filesize;
+	const struct ctf_fs_index_cache_file_hdr *header;
+	const char *file_entries;
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_index_entry *index_entry = NULL;
+	struct cycles_to_ns_converter converter;
+	uint64_t total_packets_size = 0;
+	uint64_t i;
+	bt_uuid_t trace_uuid;
+	struct ctf_stream_class *sc;
+	struct ctf_msg_iter_packet_properties props;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	cache_file_path = get_index_cache_file_path(ds_file, cache_dir);
+	if (!cache_file_path) {
+		BT_COMP_LOGE("Cannot build index cache file path: "
+			"stream-file-path=\"%s\", cache-dir=\"%s\"",
+			ds_file->file->path->str, cache_dir);
+		goto error;
+	}
+
+	BT_COMP_LOGI("Building index from cache file of stream file %s: "
+		"cache-file-path=\"%s\"", ds_file->file->path->str,
+		cache_file_path);
+
+	if (!g_file_get_contents(cache_file_path, &contents, &filesize,
+			NULL)) {
+		BT_COMP_LOGD("Cannot read index cache file %s",
+			cache_file_path);
+		goto error;
+	}
+
+	if (filesize < sizeof(*header)) {
+		BT_COMP_LOGW("Invalid index cache file: "
+			"file size (%zu bytes) < header size (%zu bytes)",
+			filesize, sizeof(*header));
+		goto error;
+	}
+
+	header = (const struct ctf_fs_index_cache_file_hdr *) contents;
+	if (header->magic != CTF_FS_INDEX_CACHE_MAGIC) {
+		BT_COMP_LOGW_STR("Invalid index cache file: \"magic\" field validation failed");
+		goto error;
+	}
+
+	if (header->version != CTF_FS_INDEX_CACHE_VERSION ||
+			header->entry_len !=
+				sizeof(struct ctf_fs_index_cache_entry)) {
+		BT_COMP_LOGI("Unsupported index cache file version: "
+			"version=%" PRIu32 ", entry-len=%" PRIu32,
+			header->version, header->entry_len);
+		goto error;
+	}
+
+	if (filesize - sizeof(*header) < header->path_len ||
+			(filesize - sizeof(*header) - header->path_len) /
+				sizeof(struct ctf_fs_index_cache_entry) !=
+				header->entry_count ||
+			(filesize - sizeof(*header) - header->path_len) %
+				sizeof(struct ctf_fs_index_cache_entry)) {
+		BT_COMP_LOGW("Invalid index cache file: "
+			"unexpected file size: file-size=%zu, entry-count=%" PRIu64,
+			filesize, header->entry_count);
+		goto error;
+	}
+
+	/* Validate that the cache file belongs to this stream file. */
+	if (header->path_len != ds_file->file->path->len ||
+			memcmp(contents + sizeof(*header),
+				ds_file->file->path->str, header->path_len) != 0) {
+		BT_COMP_LOGI_STR("Stale index cache file: stream file path mismatch.");
+		goto error;
+	}
+
+	if (header->ds_file_size != (uint64_t) ds_file->file->size ||
+			header->ds_file_mtime != ds_file->file->mtime) {
+		BT_COMP_LOGI("Stale index cache file: stream file changed: "
+			"cached-size=%" PRIu64 ", size=%jd, "
+			"cached-mtime=%" PRId64 ", mtime=%" PRId64,
+			header->ds_file_size, (intmax_t) ds_file->file->size,
+			header->ds_file_mtime, ds_file->file->mtime);
+		goto error;
+	}
+
+	get_index_cache_trace_uuid(ds_file, trace_uuid);
+	if (bt_uuid_compare(header->trace_uuid, trace_uuid) != 0) {
+		BT_COMP_LOGI_STR("Stale index cache file: trace UUID mismatch.");
+		goto error;
+	}
+
+	if (index_event_classes &&
+			!(header->flags & CTF_FS_INDEX_CACHE_FLAG_EVENT_CLASS_BITS)) {
+		BT_COMP_LOGI_STR("Index cache file has no event class bits.");
+		goto error;
+	}
+
+	ret = ctf_msg_iter_get_packet_properties(msg_iter, &props);
+	if (ret) {
+		BT_COMP_LOGI_STR("Cannot read first packet's header and context fields.");
+		goto error;
+	}
+
+	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+		props.stream_class_id);
+	BT_ASSERT(sc);
+
+	index = ctf_fs_ds_index_create(ds_file->log_level, ds_file->self_comp);
+	if (!index) {
+		goto error;
+	}
+
+	/*
+	 * The entries follow the stream file path, so they're not
+	 * necessarily aligned: copy each one before reading it.
+	 */
+	file_entries = contents + sizeof(*header) + header->path_len;
+
+	if (sc->default_clock_class) {
+		cycles_to_ns_converter_init(&converter,
+			sc->default_clock_class);
+	}
+
+	for (i = 0; i < header->entry_count; i++) {
+		struct ctf_fs_index_cache_entry file_entry;
+
+		memcpy(&file_entry, file_entries + i * sizeof(file_entry),
+			sizeof(file_entry));
+
+		if (file_entry.offset != total_packets_size) {
+			BT_COMP_LOGW("Invalid index cache file: unexpected packet offset: "
+				"expected-offset=%" PRIu64 ", offset=%" PRIu64,
+				total_packets_size, file_entry.offset);
+			goto error;
+		}
+
+		index_entry = ctf_fs_ds_index_entry_create(
+			ds_file->self_comp, ds_file->log_level);
+		if (!index_entry) {
+			BT_COMP_LOGE_APPEND_CAUSE(ds_file->self_comp,
+				"Failed to create a ctf_fs_ds_index_entry.");
+			goto error;
+		}
+
+		/* Set path to stream file. */
+		index_entry->path = file_info->path->str;
+		index_entry->offset = file_entry.offset;
+		index_entry->packet_size = file_entry.packet_size;
+		index_entry->timestamp_begin = file_entry.timestamp_begin;
+		index_entry->timestamp_end = file_entry.timestamp_end;
+		index_entry->timestamp_begin_ns = UINT64_C(-1);
+		index_entry->timestamp_end_ns = UINT64_C(-1);
+		index_entry->packet_seq_num = file_entry.packet_seq_num;
+
+		if (header->flags & CTF_FS_INDEX_CACHE_FLAG_EVENT_CLASS_BITS) {
+			index_entry->event_class_bits =
+				file_entry.event_class_bits;
+		}
+
+		/*
+		 * Nanosecond values are not cached: they depend on the
+		 * clock class offset parameters of this component.
+		 */
+		if (index_entry->timestamp_begin != UINT64_C(-1) ||
+				index_entry->timestamp_end != UINT64_C(-1)) {
+			if (!sc->default_clock_class) {
+				BT_COMP_LOGW_STR("Invalid index cache file: "
+					"packet has timestamps, but stream class has no default clock class.");
+				goto error;
+			}
+		}
+
+		if (index_entry->timestamp_begin != UINT64_C(-1)) {
+			ret = cycles_to_ns_converter_convert(&converter,
+				index_entry->timestamp_begin,
+				&index_entry->timestamp_begin_ns);
+			if (ret) {
+				BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch during index cache parsing");
+				goto error;
+			}
+		}
+
+		if (index_entry->timestamp_end != UINT64_C(-1)) {
+			ret = cycles_to_ns_converter_convert(&converter,
+				index_entry->timestamp_end,
+				&index_entry->timestamp_end_ns);
+			if (ret) {
+				BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch during index cache parsing");
+				goto error;
+			}
+		}
+
+		total_packets_size += index_entry->packet_size;
+
+		/* Give ownership of `index_entry` to `index->entries`. */
+		g_ptr_array_add(index->entries, index_entry);
+		index_entry = NULL;
+	}
+
+	/* Validate that the index addresses the complete stream. */
+	if (ds_file->file->size != total_packets_size) {
+		BT_COMP_LOGW("Invalid index cache file; indexed size != stream file size: "
+			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
+			ds_file->file->size, total_packets_size);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ctf_fs_ds_index_destroy(index);
+	g_free(index_entry);
+	index = NULL;
+
+end:
+	g_free(cache_file_path);
+	g_free(contents);
+	return index;
+}
+
+/*
+ * Writes the index cache file of `ds_file` within `cache_dir`.
+ *
+ * Failing to write the cache file is not an error: the next run simply
+ * indexes the stream file again.
+ */
+static
+void write_index_cache_file(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index *index, const char *cache_dir,
+		bool index_event_classes)
+{
+	gchar *cache_file_path = NULL;
+	GByteArray *contents = NULL;
+	GError *gerror = NULL;
+	struct ctf_fs_index_cache_file_hdr header = { 0 };
+	guint i;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	if (g_mkdir_with_parents(cache_dir, 0755)) {
+		BT_COMP_LOGW_ERRNO("Cannot create index cache directory",
+			": cache-dir=\"%s\"", cache_dir);
+		goto end;
+	}
+
+	cache_file_path = get_index_cache_file_path(ds_file, cache_dir);
+	if (!cache_file_path) {
+		BT_COMP_LOGW("Cannot build index cache file path: "
+			"stream-file-path=\"%s\", cache-dir=\"%s\"",
+			ds_file->file->path->str, cache_dir);
+		goto end;
+	}
+
+	contents = g_byte_array_new();
+	if (!contents) {
+		BT_COMP_LOGW_STR("Failed to allocate a GByteArray.");
+		goto end;
+	}
+
+	header.magic = CTF_FS_INDEX_CACHE_MAGIC;
+	header.version = CTF_FS_INDEX_CACHE_VERSION;
+	header.entry_len = sizeof(struct ctf_fs_index_cache_entry);
+	header.path_len = ds_file->file->path->len;
+
+	if (index_event_classes) {
+		header.flags |= CTF_FS_INDEX_CACHE_FLAG_EVENT_CLASS_BITS;
+	}
+
+	header.ds_file_size = ds_file->file->size;
+	header.ds_file_mtime = ds_file->file->mtime;
+	get_index_cache_trace_uuid(ds_file, header.trace_uuid);
+	header.entry_count = index->entries->len;
+	g_byte_array_append(contents, (const guint8 *) &header,
+		sizeof(header));
+	g_byte_array_append(contents,
+		(const guint8 *) ds_file->file->path->str,
+		ds_file->file->path->len);
+
+	for (i = 0; i < index->entries->len; i++) {
+		const struct ctf_fs_ds_index_entry *index_entry =
+			g_ptr_array_index(index->entries, i);
+		const struct ctf_fs_index_cache_entry file_entry = {
+			.offset = index_entry->offset,
+			.packet_size = index_entry->packet_size,
+			.timestamp_begin = index_entry->timestamp_begin,
+			.timestamp_end = index_entry->timestamp_end,
+			.packet_seq_num = index_entry->packet_seq_num,
+			.event_class_bits = index_entry->event_class_bits,
+		};
+
+		g_byte_array_append(contents, (const guint8 *) &file_entry,
+			sizeof(file_entry));
+	}
+
+	/*
+	 * g_file_set_contents() writes to a temporary file and renames
+	 * it, so that a concurrent reader never sees a partial file.
+	 */
+	if (!g_file_set_contents(cache_file_path,
+			(const gchar *) contents->data, contents->len, &gerror)) {
+		BT_COMP_LOGW("Cannot write index cache file: "
+			"cache-file-path=\"%s\", error=\"%s\"",
+			cache_file_path, gerror->message);
+		goto end;
+	}
+
+	BT_COMP_LOGI("Wrote index cache file of stream file %s: "
+		"cache-file-path=\"%s\", entry-count=%u",
+		ds_file->file->path->str, cache_file_path,
+		index->entries->len);
+
+end:
+	g_free(cache_file_path);
+	if (contents) {
+		g_byte_array_free(contents, TRUE);
+	}
+	if (gerror) {
+		g_error_free(gerror);
+	}
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -919,6 +1631,7 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 
 	ds_file->log_level = log_level;
 	ds_file->self_comp = ctf_fs_trace->self_comp;
+	ds_file->huge_pages = ctf_fs_trace->huge_pages;
 	ds_file->self_msg_iter = self_msg_iter;
 	ds_file->file = ctf_fs_file_create(log_level, ds_file->self_comp);
 	if (!ds_file->file) {
@@ -934,7 +1647,39 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		goto error;
 	}
 
-	ds_file->mmap_max_len = offset_align * 2048;
+	if (ctf_fs_trace->mmap_window_size == SIZE_MAX) {
+		/* Map whole files (64-bit hosts only) */
+		ds_file->mmap_max_len = SIZE_MAX;
+	} else if (ctf_fs_trace->mmap_window_size > 0) {
+		ds_file->mmap_max_len = ALIGN(ctf_fs_trace->mmap_window_size,
+			offset_align);
+	} else {
+		ds_file->mmap_max_len = offset_align * 2048;
+	}
+
+	if (ctf_fs_compressed_file_path_is_compressed(path)) {
+		ds_file->compressed_file = ctf_fs_compressed_file_create(
+			ds_file->file, log_level, ds_file->self_comp);
+		if (!ds_file->compressed_file) {
+			goto error;
+		}
+
+		/*
+		 * From now on, the packet offsets and sizes refer to the
+		 * decompressed content.
+		 */
+		ds_file->file->size = ctf_fs_compressed_file_get_size(
+			ds_file->compressed_file);
+
+		/* Never hold a whole decompressed file in memory */
+		if (ds_file->mmap_max_len == SIZE_MAX) {
+			ds_file->mmap_max_len = offset_align * 2048;
+		}
+
+		ds_file->compressed_window = g_malloc(
+			MIN((size_t) ds_file->file->size,
+				ds_file->mmap_max_len));
+	}
 
 	goto end;
 
@@ -947,24 +1692,110 @@ end:
 	return ds_file;
 }
 
+/*
+ * Sets the event class bits of each entry of `index` by decoding the
+ * event headers of its packet.
+ */
+static
+int set_index_event_class_bits(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index *index, struct ctf_msg_iter *msg_iter)
+{
+	int ret = 0;
+	guint i;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	BT_COMP_LOGI("Indexing event classes of stream file %s",
+		ds_file->file->path->str);
+
+	for (i = 0; i < index->entries->len; i++) {
+		struct ctf_fs_ds_index_entry *index_entry =
+			g_ptr_array_index(index->entries, i);
+		enum ctf_msg_iter_status iter_status;
+
+		iter_status = ctf_msg_iter_seek(msg_iter,
+			(off_t) index_entry->offset);
+		if (iter_status != CTF_MSG_ITER_STATUS_OK) {
+			ret = -1;
+			goto end;
+		}
+
+		iter_status = ctf_msg_iter_get_packet_event_class_bits(
+			msg_iter, &index_entry->event_class_bits);
+		if (iter_status != CTF_MSG_ITER_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot decode the event headers of packet: "
+				"stream-file-path=\"%s\", packet-offset=%" PRIu64,
+				ds_file->file->path->str, index_entry->offset);
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *file_info,
-		struct ctf_msg_iter *msg_iter)
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir, bool index_event_classes)
 {
-	struct ctf_fs_ds_index *index;
+	struct ctf_fs_ds_index *index = NULL;
 	bt_self_component *self_comp = ds_file->self_comp;
 	bt_logging_level log_level = ds_file->log_level;
 
-	index = build_index_from_idx_file(ds_file, file_info, msg_iter);
-	if (index) {
-		goto end;
+	/*
+	 * LTTng index files don't record event classes: when we need
+	 * them, a cache file having them is better than an LTTng index
+	 * file.
+	 */
+	if (!index_event_classes) {
+		index = build_index_from_idx_file(ds_file, file_info,
+			msg_iter);
+		if (index) {
+			goto end;
+		}
+	}
+
+	if (index_cache_dir) {
+		index = build_index_from_cache_file(ds_file, file_info,
+			msg_iter, index_cache_dir, index_event_classes);
+		if (index) {
+			goto end;
+		}
+	}
+
+	if (index_event_classes) {
+		index = build_index_from_idx_file(ds_file, file_info,
+			msg_iter);
+	}
+
+	if (!index) {
+		BT_COMP_LOGI("Failed to build index from .index file; "
+			"falling back to stream indexing.");
+		index = build_index_from_stream_file(ds_file, file_info,
+			msg_iter);
+		if (!index) {
+			goto end;
+		}
+	}
+
+	if (index_event_classes) {
+		if (set_index_event_class_bits(ds_file, index, msg_iter)) {
+			ctf_fs_ds_index_destroy(index);
+			index = NULL;
+			goto end;
+		}
+	}
+
+	if (index_cache_dir) {
+		write_index_cache_file(ds_file, index, index_cache_dir,
+			index_event_classes);
 	}
 
-	BT_COMP_LOGI("Failed to build index from .index file; "
-		"falling back to stream indexing.");
-	index = build_index_from_stream_file(ds_file, file_info, msg_iter);
 end:
 	return index;
 }
@@ -1006,6 +1837,8 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 
 	bt_stream_put_ref(ds_file->stream);
 	(void) ds_file_munmap(ds_file);
+	ctf_fs_compressed_file_destroy(ds_file->compressed_file);
+	g_free(ds_file->compressed_window);
 
 	if (ds_file->file) {
 		ctf_fs_file_destroy(ds_file->file);
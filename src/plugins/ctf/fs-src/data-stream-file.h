@@ -17,6 +17,7 @@
 #include "lttng-index.h"
 
 struct ctf_fs_component;
+struct ctf_fs_compressed_file;
 struct ctf_fs_file;
 struct ctf_fs_trace;
 struct ctf_fs_ds_file;
@@ -51,6 +52,19 @@ struct ctf_fs_ds_file {
 	/* Owned by this */
 	bt_stream *stream;
 
+	/*
+	 * Decompressed view of `file`, or `NULL` if the file isn't
+	 * compressed (owned by this).
+	 *
+	 * For a compressed file, `file->size` is the size of the
+	 * decompressed content, and the "mapping" members below describe
+	 * a decompressed window held by `compressed_window`.
+	 */
+	struct ctf_fs_compressed_file *compressed_file;
+
+	/* Owned by this */
+	uint8_t *compressed_window;
+
 	void *mmap_addr;
 
 	/*
@@ -59,6 +73,9 @@ struct ctf_fs_ds_file {
 	 */
 	size_t mmap_max_len;
 
+	/* True to advise the system to back mappings with huge pages */
+	bool huge_pages;
+
 	/* Length of the current mapping. Never exceeds the file's length. */
 	size_t mmap_len;
 
@@ -86,7 +103,8 @@ BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *ds_file_info,
-		struct ctf_msg_iter *msg_iter);
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir, bool index_event_classes);
 
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_index_create(bt_logging_level log_level,
@@ -123,6 +141,35 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data);
 
+/*
+ * Closes the data stream file which `data` is currently reading, if
+ * any: the next switch_packet operation opens the needed one again.
+ */
+BT_HIDDEN
+void ctf_fs_ds_group_medops_data_release_file(
+		struct ctf_fs_ds_group_medops_data *data);
+
+/*
+ * Makes the switch_packet operation of `data` make `msg_iter` skip the
+ * event records of the packets which, according to their index entry,
+ * contain no event class of `wanted_event_class_bits` (bitwise OR of
+ * ctf_msg_iter_event_class_id_bit()).
+ */
+BT_HIDDEN
+void ctf_fs_ds_group_medops_data_set_event_class_filter(
+		struct ctf_fs_ds_group_medops_data *data,
+		struct ctf_msg_iter *msg_iter,
+		uint64_t wanted_event_class_bits);
+
+/*
+ * Makes the next switch_packet operation of `data` switch to the packet
+ * of the index entry having the index `index_entry_index`.
+ */
+BT_HIDDEN
+void ctf_fs_ds_group_medops_data_seek_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index);
+
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_destroy(
 		struct ctf_fs_ds_group_medops_data *data);
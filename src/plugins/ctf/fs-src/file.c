@@ -93,6 +93,7 @@ int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode)
 	}
 
 	file->size = stat.st_size;
+	file->mtime = stat.st_mtime;
 	BT_COMP_LOGI("File is %jd bytes", (intmax_t) file->size);
 	goto end;
 
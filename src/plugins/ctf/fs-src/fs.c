@@ -15,7 +15,7 @@
 #include "common/common.h"
 #include <babeltrace2/babeltrace.h>
 #include "common/uuid.h"
-#include <glib.h>
+#include "compat/glib.h"
 #include "common/assert.h"
 #include <inttypes.h>
 #include <stdbool.h>
@@ -36,6 +36,23 @@ struct tracer_info {
 	int64_t patch;
 };
 
+static
+void ctf_fs_msg_iter_data_reset_seek(
+		struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	msg_iter_data->seek.skipping = false;
+	msg_iter_data->seek.stream_began = false;
+	msg_iter_data->seek.seen_clock_snapshot = false;
+	BT_PACKET_PUT_REF_AND_RESET(msg_iter_data->seek.packet);
+
+	if (msg_iter_data->seek.msgs) {
+		while (!g_queue_is_empty(msg_iter_data->seek.msgs)) {
+			bt_message_put_ref(
+				g_queue_pop_head(msg_iter_data->seek.msgs));
+		}
+	}
+}
+
 static
 void ctf_fs_msg_iter_data_destroy(
 		struct ctf_fs_msg_iter_data *msg_iter_data)
@@ -44,6 +61,12 @@ void ctf_fs_msg_iter_data_destroy(
 		return;
 	}
 
+	ctf_fs_msg_iter_data_reset_seek(msg_iter_data);
+
+	if (msg_iter_data->seek.msgs) {
+		g_queue_free(msg_iter_data->seek.msgs);
+	}
+
 	if (msg_iter_data->msg_iter) {
 		ctf_msg_iter_destroy(msg_iter_data->msg_iter);
 	}
@@ -53,21 +76,73 @@ void ctf_fs_msg_iter_data_destroy(
 			msg_iter_data->msg_iter_medops_data);
 	}
 
+	if (msg_iter_data->holds_index) {
+		ctf_fs_ds_file_group_release_index(
+			msg_iter_data->ds_file_group);
+	}
+
 	g_free(msg_iter_data);
 }
 
 static
-bt_message_iterator_class_next_method_status ctf_fs_iterator_next_one(
+int ctf_fs_msg_iter_data_acquire_index(
+		struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	int ret = 0;
+	bt_logging_level log_level = msg_iter_data->log_level;
+
+	if (msg_iter_data->holds_index) {
+		goto end;
+	}
+
+	ret = ctf_fs_ds_file_group_acquire_index(msg_iter_data->ds_file_group);
+	if (ret) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+			"Failed to load the index of a data stream file group.");
+		goto end;
+	}
+
+	msg_iter_data->holds_index = true;
+
+end:
+	return ret;
+}
+
+/*
+ * Releases what `msg_iter_data` only needs to read its stream, once
+ * the stream ended, when its trace loads indexes lazily: this keeps
+ * the memory usage and the number of open files proportional to the
+ * number of streams which are still being read.
+ *
+ * A subsequent seeking operation acquires the index and opens the
+ * needed data stream file again.
+ */
+static
+void ctf_fs_msg_iter_data_release_stream(
+		struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	if (!msg_iter_data->ds_file_group->ctf_fs_trace->lazy_index_loading) {
+		return;
+	}
+
+	ctf_fs_ds_group_medops_data_release_file(
+		msg_iter_data->msg_iter_medops_data);
+
+	if (msg_iter_data->holds_index) {
+		ctf_fs_ds_file_group_release_index(
+			msg_iter_data->ds_file_group);
+		msg_iter_data->holds_index = false;
+	}
+}
+
+static
+bt_message_iterator_class_next_method_status next_method_status_from_msg_iter_status(
 		struct ctf_fs_msg_iter_data *msg_iter_data,
-		const bt_message **out_msg)
+		enum ctf_msg_iter_status msg_iter_status)
 {
 	bt_message_iterator_class_next_method_status status;
-	enum ctf_msg_iter_status msg_iter_status;
 	bt_logging_level log_level = msg_iter_data->log_level;
 
-	msg_iter_status = ctf_msg_iter_get_next_message(
-		msg_iter_data->msg_iter, out_msg);
-
 	switch (msg_iter_status) {
 	case CTF_MSG_ITER_STATUS_OK:
 		/* Cool, message has been written to *out_msg. */
@@ -105,6 +180,363 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next_one(
 	return status;
 }
 
+static
+bt_message_iterator_class_next_method_status ctf_fs_iterator_read_one(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		const bt_message **out_msg)
+{
+	return next_method_status_from_msg_iter_status(msg_iter_data,
+		ctf_msg_iter_get_next_message(msg_iter_data->msg_iter,
+			out_msg));
+}
+
+/*
+ * Reads up to `capacity` messages into `msgs`, setting `*count` to the
+ * number of read messages in all cases.
+ */
+static
+bt_message_iterator_class_next_method_status ctf_fs_iterator_read_many(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return next_method_status_from_msg_iter_status(msg_iter_data,
+		ctf_msg_iter_get_next_messages(msg_iter_data->msg_iter,
+			msgs, capacity, count));
+}
+
+static
+int ns_from_origin_to_raw_value(struct ctf_fs_msg_iter_data *msg_iter_data,
+		int64_t ns_from_origin, uint64_t *raw_value)
+{
+	const bt_clock_class *clock_class =
+		bt_stream_class_borrow_default_clock_class_const(
+			bt_stream_borrow_class_const(
+				msg_iter_data->ds_file_group->stream));
+	int64_t offset_seconds;
+	uint64_t offset_cycles;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	int ret;
+
+	BT_ASSERT(clock_class);
+	bt_clock_class_get_offset(clock_class, &offset_seconds,
+		&offset_cycles);
+	ret = bt_common_clock_value_from_ns_from_origin(offset_seconds,
+		offset_cycles, bt_clock_class_get_frequency(clock_class),
+		ns_from_origin, raw_value);
+	if (ret) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+			"Cannot convert nanoseconds from origin to clock value: "
+			"ns-from-origin=%" PRId64, ns_from_origin);
+	}
+
+	return ret;
+}
+
+/*
+ * Handles the message `msg`, read while skipping the messages before
+ * the seeking time, replicating what the library does when it
+ * auto-seeks.
+ *
+ * On success, sets `*first_msg` to the message to return first (`msg`
+ * itself or a replacement), or to `NULL` if `msg` is skipped. In both
+ * cases, the function takes ownership of `msg`.
+ */
+static
+bt_message_iterator_class_next_method_status handle_msg_while_skipping(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		const bt_message *msg, const bt_message **first_msg)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	struct ctf_stream_class *sc = msg_iter_data->ds_file_group->sc;
+	int64_t ns_from_origin = msg_iter_data->seek.ns_from_origin;
+	const bt_clock_snapshot *cs = NULL;
+	const bt_clock_snapshot *end_cs = NULL;
+	int64_t msg_ns;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+
+	*first_msg = NULL;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		if (sc->packets_have_ts_begin) {
+			cs = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		if (sc->packets_have_ts_end) {
+			cs = bt_message_packet_end_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		if (sc->discarded_events_have_default_cs) {
+			cs = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+				msg);
+			end_cs = bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		if (sc->discarded_packets_have_default_cs) {
+			cs = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+				msg);
+			end_cs = bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		if (bt_message_stream_beginning_borrow_default_clock_snapshot_const(
+				msg, &cs) !=
+				BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
+			cs = NULL;
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		if (bt_message_stream_end_borrow_default_clock_snapshot_const(
+				msg, &cs) !=
+				BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
+			cs = NULL;
+		}
+
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	if (cs) {
+		if (bt_clock_snapshot_get_ns_from_origin(cs, &msg_ns)) {
+			BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+				"Cannot get message's nanoseconds from origin.");
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (msg_ns >= ns_from_origin) {
+			/* First message at or after the seeking time */
+			*first_msg = msg;
+			msg = NULL;
+			goto end;
+		}
+	}
+
+	if (end_cs) {
+		if (bt_clock_snapshot_get_ns_from_origin(end_cs, &msg_ns)) {
+			BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+				"Cannot get message's nanoseconds from origin.");
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (msg_ns >= ns_from_origin) {
+			/*
+			 * The discarded items message's time range
+			 * contains the seeking time: replace it with a
+			 * message beginning exactly at the seeking time
+			 * and having an unknown item count.
+			 */
+			uint64_t begin_raw;
+			uint64_t end_raw = bt_clock_snapshot_get_value(end_cs);
+			bt_message *new_msg;
+
+			if (ns_from_origin_to_raw_value(msg_iter_data,
+					ns_from_origin, &begin_raw)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (bt_message_get_type(msg) ==
+					BT_MESSAGE_TYPE_DISCARDED_EVENTS) {
+				new_msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+					msg_iter_data->self_msg_iter,
+					msg_iter_data->ds_file_group->stream,
+					begin_raw, end_raw);
+			} else {
+				new_msg = bt_message_discarded_packets_create_with_default_clock_snapshots(
+					msg_iter_data->self_msg_iter,
+					msg_iter_data->ds_file_group->stream,
+					begin_raw, end_raw);
+			}
+
+			if (!new_msg) {
+				BT_MSG_ITER_LOGE_APPEND_CAUSE(
+					msg_iter_data->self_msg_iter,
+					"Cannot create discarded items message.");
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+				goto end;
+			}
+
+			*first_msg = new_msg;
+			goto end;
+		}
+	}
+
+	/* Skip this message, updating the stream's state */
+	BT_COMP_LOGT("Skipping message before seeking time: "
+		"msg-addr=%p, ns-from-origin=%" PRId64, msg, ns_from_origin);
+
+	if (cs) {
+		msg_iter_data->seek.seen_clock_snapshot = true;
+	}
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		msg_iter_data->seek.stream_began = true;
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		msg_iter_data->seek.stream_began = false;
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		BT_ASSERT(!msg_iter_data->seek.packet);
+		msg_iter_data->seek.packet =
+			bt_message_packet_beginning_borrow_packet_const(msg);
+		bt_packet_get_ref(msg_iter_data->seek.packet);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		BT_PACKET_PUT_REF_AND_RESET(msg_iter_data->seek.packet);
+		break;
+	default:
+		break;
+	}
+
+end:
+	bt_message_put_ref(msg);
+	return status;
+}
+
+/*
+ * Reads and skips the messages before the seeking time. On success,
+ * the messages to return first are in `msg_iter_data->seek.msgs`:
+ * the messages putting the stream in its state at the seeking time,
+ * followed with the first message at or after the seeking time.
+ */
+static
+bt_message_iterator_class_next_method_status ctf_fs_iterator_skip_to_seek_time(
+		struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	bt_message_iterator_class_next_method_status status;
+	const bt_message *msg;
+	const bt_message *first_msg = NULL;
+	uint64_t raw_value = 0;
+	bt_logging_level log_level = msg_iter_data->log_level;
+
+	while (!first_msg) {
+		status = ctf_fs_iterator_read_one(msg_iter_data, &msg);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			/*
+			 * The stream ended before the seeking time
+			 * (its "stream end" message was skipped), or
+			 * this is an error.
+			 */
+			goto end;
+		}
+
+		status = handle_msg_while_skipping(msg_iter_data, msg,
+			&first_msg);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			goto end;
+		}
+	}
+
+	if (msg_iter_data->seek.seen_clock_snapshot &&
+			ns_from_origin_to_raw_value(msg_iter_data,
+				msg_iter_data->seek.ns_from_origin,
+				&raw_value)) {
+		bt_message_put_ref(first_msg);
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (msg_iter_data->seek.stream_began) {
+		bt_message *msg = bt_message_stream_beginning_create(
+			msg_iter_data->self_msg_iter,
+			msg_iter_data->ds_file_group->stream);
+
+		if (!msg) {
+			goto memory_error;
+		}
+
+		if (msg_iter_data->seek.seen_clock_snapshot) {
+			bt_message_stream_beginning_set_default_clock_snapshot(
+				msg, raw_value);
+		}
+
+		g_queue_push_tail(msg_iter_data->seek.msgs, msg);
+	}
+
+	if (msg_iter_data->seek.packet) {
+		bt_message *msg;
+
+		if (msg_iter_data->ds_file_group->sc->packets_have_ts_begin) {
+			msg = bt_message_packet_beginning_create_with_default_clock_snapshot(
+				msg_iter_data->self_msg_iter,
+				msg_iter_data->seek.packet, raw_value);
+		} else {
+			msg = bt_message_packet_beginning_create(
+				msg_iter_data->self_msg_iter,
+				msg_iter_data->seek.packet);
+		}
+
+		if (!msg) {
+			goto memory_error;
+		}
+
+		g_queue_push_tail(msg_iter_data->seek.msgs, msg);
+	}
+
+	g_queue_push_tail(msg_iter_data->seek.msgs, (void *) first_msg);
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	goto end;
+
+memory_error:
+	BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+		"Failed to create a message.");
+	bt_message_put_ref(first_msg);
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+
+end:
+	msg_iter_data->seek.skipping = false;
+	BT_PACKET_PUT_REF_AND_RESET(msg_iter_data->seek.packet);
+	return status;
+}
+
+static
+bt_message_iterator_class_next_method_status ctf_fs_iterator_next_one(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		const bt_message **out_msg)
+{
+	bt_message_iterator_class_next_method_status status;
+
+	if (G_UNLIKELY(msg_iter_data->seek.skipping)) {
+		status = ctf_fs_iterator_skip_to_seek_time(msg_iter_data);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			goto end;
+		}
+	}
+
+	if (G_UNLIKELY(!g_queue_is_empty(msg_iter_data->seek.msgs))) {
+		*out_msg = g_queue_pop_head(msg_iter_data->seek.msgs);
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+		goto end;
+	}
+
+	status = ctf_fs_iterator_read_one(msg_iter_data, out_msg);
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		bt_self_message_iterator *iterator,
@@ -127,10 +559,35 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		goto end;
 	}
 
+	/*
+	 * Load the index of the data stream file group only when it's
+	 * needed to read the first packet (lazy index loading).
+	 */
+	if (G_UNLIKELY(!msg_iter_data->holds_index)) {
+		if (ctf_fs_msg_iter_data_acquire_index(msg_iter_data)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	do {
-		status = ctf_fs_iterator_next_one(msg_iter_data, &msgs[i]);
-		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
-			i++;
+		if (G_UNLIKELY(msg_iter_data->seek.skipping ||
+				!g_queue_is_empty(msg_iter_data->seek.msgs))) {
+			status = ctf_fs_iterator_next_one(msg_iter_data,
+				&msgs[i]);
+			if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+				i++;
+			}
+		} else {
+			uint64_t read_count;
+
+			/*
+			 * Common case: have the CTF message iterator
+			 * fill the rest of the array in one call.
+			 */
+			status = ctf_fs_iterator_read_many(msg_iter_data,
+				&msgs[i], capacity - i, &read_count);
+			i += read_count;
 		}
 	} while (i < capacity &&
 			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
@@ -161,6 +618,8 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 
 		*count = i;
 		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	} else if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END) {
+		ctf_fs_msg_iter_data_release_stream(msg_iter_data);
 	}
 
 end:
@@ -178,46 +637,159 @@ ctf_fs_iterator_seek_beginning(bt_self_message_iterator *it)
 
 	ctf_msg_iter_reset(msg_iter_data->msg_iter);
 	ctf_fs_ds_group_medops_data_reset(msg_iter_data->msg_iter_medops_data);
+	ctf_fs_msg_iter_data_reset_seek(msg_iter_data);
 
 	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
 }
 
 BT_HIDDEN
-void ctf_fs_iterator_finalize(bt_self_message_iterator *it)
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+ctf_fs_iterator_can_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin, bt_bool *can_seek)
 {
-	ctf_fs_msg_iter_data_destroy(
-		bt_self_message_iterator_get_data(it));
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+	struct ctf_stream_class *sc = msg_iter_data->ds_file_group->sc;
+
+	/*
+	 * Finding the right packet requires index entries with both
+	 * timestamps. Otherwise, let the library seek the beginning
+	 * and skip messages itself.
+	 */
+	*can_seek = sc->default_clock_class && sc->packets_have_ts_begin &&
+		sc->packets_have_ts_end;
+	return BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
 }
 
+/*
+ * Seeks the first packet which could contain messages at or after
+ * `ns_from_origin` using the stream's packet index, and then skips
+ * the messages before `ns_from_origin` (on the next call to the "next"
+ * method), like the library's auto-seeking does, but without decoding
+ * all the previous packets.
+ */
 BT_HIDDEN
-bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
-		bt_self_message_iterator *self_msg_iter,
-		bt_self_message_iterator_configuration *config,
-		bt_self_component_port_output *self_port)
+bt_message_iterator_class_seek_ns_from_origin_method_status
+ctf_fs_iterator_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin)
 {
-	struct ctf_fs_port_data *port_data;
-	struct ctf_fs_msg_iter_data *msg_iter_data = NULL;
-	bt_message_iterator_class_initialize_method_status status;
-	bt_logging_level log_level;
-	enum ctf_msg_iter_medium_status medium_status;
-	bt_self_component *self_comp =
-		bt_self_message_iterator_borrow_component(self_msg_iter);
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+	GPtrArray *entries;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+	guint low = 0;
+	guint high;
 
-	port_data = bt_self_component_port_get_data(
-		bt_self_component_port_output_as_self_component_port(
-			self_port));
-	BT_ASSERT(port_data);
-	log_level = port_data->ctf_fs->log_level;
-	msg_iter_data = g_new0(struct ctf_fs_msg_iter_data, 1);
-	if (!msg_iter_data) {
-		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
-		goto error;
+	if (ctf_fs_msg_iter_data_acquire_index(msg_iter_data)) {
+		return BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
 	}
 
-	msg_iter_data->log_level = log_level;
-	msg_iter_data->self_comp = self_comp;
+	entries = msg_iter_data->ds_file_group->index->entries;
+	high = entries->len;
+	BT_ASSERT(entries->len > 0);
+
+	/* Find the first packet which ends at or after the seeking time */
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		struct ctf_fs_ds_index_entry *entry =
+			g_ptr_array_index(entries, mid);
+
+		if (entry->timestamp_end_ns < ns_from_origin) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	/*
+	 * Start with the packet before, so that the message iterator
+	 * knows the previous packet's snapshots and emits the same
+	 * discarded events/packets messages as when reading the stream
+	 * from its beginning. All the messages of this previous packet
+	 * are before the seeking time anyway.
+	 */
+	if (low > 0) {
+		low--;
+	}
+
+	BT_COMP_LOGD("Seeking packet before seeking time: "
+		"ns-from-origin=%" PRId64 ", index-entry-index=%u",
+		ns_from_origin, low);
+	ctf_msg_iter_reset(msg_iter_data->msg_iter);
+	ctf_fs_ds_group_medops_data_seek_index_entry(
+		msg_iter_data->msg_iter_medops_data, low);
+	ctf_fs_msg_iter_data_reset_seek(msg_iter_data);
+	msg_iter_data->seek.skipping = true;
+	msg_iter_data->seek.ns_from_origin = ns_from_origin;
+	return BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+}
+
+BT_HIDDEN
+void ctf_fs_iterator_finalize(bt_self_message_iterator *it)
+{
+	ctf_fs_msg_iter_data_destroy(
+		bt_self_message_iterator_get_data(it));
+}
+
+/*
+ * Returns the bitwise OR of ctf_msg_iter_event_class_id_bit() for the
+ * IDs of the event classes of `sc` which aren't excluded.
+ */
+static
+uint64_t wanted_event_class_bits(struct ctf_stream_class *sc)
+{
+	uint64_t bits = 0;
+	guint i;
+
+	for (i = 0; i < sc->event_classes->len; i++) {
+		struct ctf_event_class *ec = sc->event_classes->pdata[i];
+
+		if (!ec->is_excluded) {
+			bits |= ctf_msg_iter_event_class_id_bit(
+				(uint64_t) ec->id);
+		}
+	}
+
+	return bits;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *self_port)
+{
+	struct ctf_fs_port_data *port_data;
+	struct ctf_fs_msg_iter_data *msg_iter_data = NULL;
+	bt_message_iterator_class_initialize_method_status status;
+	bt_logging_level log_level;
+	enum ctf_msg_iter_medium_status medium_status;
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+
+	port_data = bt_self_component_port_get_data(
+		bt_self_component_port_output_as_self_component_port(
+			self_port));
+	BT_ASSERT(port_data);
+	log_level = port_data->ctf_fs->log_level;
+	msg_iter_data = g_new0(struct ctf_fs_msg_iter_data, 1);
+	if (!msg_iter_data) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	msg_iter_data->log_level = log_level;
+	msg_iter_data->self_comp = self_comp;
 	msg_iter_data->self_msg_iter = self_msg_iter;
 	msg_iter_data->ds_file_group = port_data->ds_file_group;
+	msg_iter_data->seek.msgs = g_queue_new();
+	if (!msg_iter_data->seek.msgs) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"Failed to allocate a GQueue.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
 
 	medium_status = ctf_fs_ds_group_medops_data_create(
 		msg_iter_data->ds_file_group, self_msg_iter, log_level,
@@ -233,10 +805,15 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 		goto error;
 	}
 
+	/*
+	 * Request whatever remains of the current mapping: the group
+	 * medium maps whole packets when it can, and then the message
+	 * iterator decodes each packet from a single buffer, without
+	 * ever stitching a field which crosses a buffer boundary.
+	 */
 	msg_iter_data->msg_iter = ctf_msg_iter_create(
 		msg_iter_data->ds_file_group->ctf_fs_trace->metadata->tc,
-		bt_common_get_page_size(msg_iter_data->log_level) * 8,
-		ctf_fs_ds_group_medops,
+		SIZE_MAX, ctf_fs_ds_group_medops,
 		msg_iter_data->msg_iter_medops_data,
 		msg_iter_data->log_level,
 		self_comp, self_msg_iter);
@@ -246,6 +823,17 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 		goto error;
 	}
 
+	ctf_msg_iter_set_skip_event_records(msg_iter_data->msg_iter,
+		port_data->ctf_fs->skip_event_records);
+
+	if (port_data->ctf_fs->event_class_names &&
+			!port_data->ctf_fs->skip_event_records) {
+		ctf_fs_ds_group_medops_data_set_event_class_filter(
+			msg_iter_data->msg_iter_medops_data,
+			msg_iter_data->msg_iter,
+			wanted_event_class_bits(msg_iter_data->ds_file_group->sc));
+	}
+
 	/*
 	 * This iterator can seek forward if its stream class has a default
 	 * clock class.
@@ -255,6 +843,13 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 			config, true);
 	}
 
+	/*
+	 * Decoding messages from a memory-mapped data stream file is
+	 * cheap: accept large batches.
+	 */
+	bt_self_message_iterator_configuration_set_max_batch_size(config,
+		CTF_FS_MSG_ITER_MAX_BATCH_SIZE);
+
 	bt_self_message_iterator_set_data(self_msg_iter,
 		msg_iter_data);
 	msg_iter_data = NULL;
@@ -277,6 +872,10 @@ void ctf_fs_trace_destroy(struct ctf_fs_trace *ctf_fs_trace)
 		return;
 	}
 
+	if (ctf_fs_trace->ds_file_groups_by_id) {
+		g_hash_table_destroy(ctf_fs_trace->ds_file_groups_by_id);
+	}
+
 	if (ctf_fs_trace->ds_file_groups) {
 		g_ptr_array_free(ctf_fs_trace->ds_file_groups, TRUE);
 	}
@@ -303,11 +902,24 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 	}
 
 	ctf_fs_trace_destroy(ctf_fs->trace);
+	ctf_fs_metadata_cache_destroy(ctf_fs->metadata_cache);
 
 	if (ctf_fs->port_data) {
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	if (ctf_fs->index_cache_dir) {
+		g_string_free(ctf_fs->index_cache_dir, TRUE);
+	}
+
+	if (ctf_fs->metadata_cache_dir) {
+		g_string_free(ctf_fs->metadata_cache_dir, TRUE);
+	}
+
+	if (ctf_fs->event_class_names) {
+		g_hash_table_destroy(ctf_fs->event_class_names);
+	}
+
 	g_free(ctf_fs);
 }
 
@@ -350,6 +962,11 @@ struct ctf_fs_component *ctf_fs_component_create(bt_logging_level log_level,
 		goto error;
 	}
 
+	ctf_fs->metadata_cache = ctf_fs_metadata_cache_create();
+	if (!ctf_fs->metadata_cache) {
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -578,49 +1195,81 @@ end:
 	return ds_file_group;
 }
 
-/* Replace by g_ptr_array_insert when we depend on glib >= 2.40. */
+struct stable_sort_elem {
+	gpointer ptr;
+	guint pos;
+};
+
 static
-void array_insert(GPtrArray *array, gpointer element, size_t pos)
+gint compare_stable_sort_elems(gconstpointer a, gconstpointer b,
+		gpointer user_data)
 {
-	size_t original_array_len = array->len;
-
-	/* Allocate an unused element at the end of the array. */
-	g_ptr_array_add(array, NULL);
+	const struct stable_sort_elem *elem_a = a;
+	const struct stable_sort_elem *elem_b = b;
+	const GCompareFunc *compare_func = user_data;
+	gint ret;
 
-	/* If we are not inserting at the end, move the elements by one. */
-	if (pos < original_array_len) {
-		memmove(&(array->pdata[pos + 1]),
-			&(array->pdata[pos]),
-			(original_array_len - pos) * sizeof(gpointer));
+	ret = (*compare_func)(elem_a->ptr, elem_b->ptr);
+	if (ret == 0) {
+		ret = elem_a->pos < elem_b->pos ? -1 : 1;
 	}
 
-	/* Insert the value. */
-	array->pdata[pos] = element;
+	return ret;
 }
 
 /*
- * Insert ds_file_info in ds_file_group's list of ds_file_infos at the right
- * place to keep it sorted.
+ * Sorts the pointers of `array` with `compare_func`, which receives two
+ * elements of `array`, keeping the current order of equal elements.
+ *
+ * g_ptr_array_sort() only guarantees a stable sort as of GLib 2.32.
  */
-
 static
-void ds_file_group_insert_ds_file_info_sorted(
-		struct ctf_fs_ds_file_group *ds_file_group,
-		struct ctf_fs_ds_file_info *ds_file_info)
+int ptr_array_sort_stable(GPtrArray *array, GCompareFunc compare_func)
 {
+	struct stable_sort_elem *elems;
+	int ret = 0;
 	guint i;
 
-	/* Find the spot where to insert this ds_file_info. */
-	for (i = 0; i < ds_file_group->ds_file_infos->len; i++) {
-		struct ctf_fs_ds_file_info *other_ds_file_info =
-			g_ptr_array_index(ds_file_group->ds_file_infos, i);
+	if (array->len < 2) {
+		goto end;
+	}
 
-		if (ds_file_info->begin_ns < other_ds_file_info->begin_ns) {
-			break;
-		}
+	elems = g_new(struct stable_sort_elem, array->len);
+	if (!elems) {
+		ret = -1;
+		goto end;
 	}
 
-	array_insert(ds_file_group->ds_file_infos, ds_file_info, i);
+	for (i = 0; i < array->len; i++) {
+		elems[i].ptr = array->pdata[i];
+		elems[i].pos = i;
+	}
+
+	g_qsort_with_data(elems, array->len, sizeof(*elems),
+		compare_stable_sort_elems, &compare_func);
+
+	for (i = 0; i < array->len; i++) {
+		array->pdata[i] = elems[i].ptr;
+	}
+
+	g_free(elems);
+
+end:
+	return ret;
+}
+
+/*
+ * Adds `ds_file_info` to the data stream file infos of `ds_file_group`.
+ *
+ * Call sort_ds_file_group() once all the data stream files of the
+ * group are added.
+ */
+static
+void ds_file_group_add_ds_file_info(
+		struct ctf_fs_ds_file_group *ds_file_group,
+		struct ctf_fs_ds_file_info *ds_file_info)
+{
+	g_ptr_array_add(ds_file_group->ds_file_infos, ds_file_info);
 }
 
 static
@@ -648,79 +1297,552 @@ bool ds_index_entries_equal(
 }
 
 /*
- * Insert `entry` into `index`, without duplication.
+ * Moves the entries of `src` to `dest`.
  *
- * The entry is inserted only if there isn't an identical entry already.
+ * Call sort_ds_index() on `dest` once all the indexes are merged.
+ */
+static
+void merge_ctf_fs_ds_indexes(struct ctf_fs_ds_index *dest, struct ctf_fs_ds_index *src)
+{
+	guint i;
+
+	for (i = 0; i < src->entries->len; i++) {
+		struct ctf_fs_ds_index_entry *entry =
+			g_ptr_array_index(src->entries, i);
+
+		/*
+		* Ownership of the ctf_fs_ds_index_entry is transferred to
+		* `dest`.
+		*/
+		g_ptr_array_index(src->entries, i) = NULL;
+		g_ptr_array_add(dest->entries, entry);
+	}
+}
+
+static
+gint compare_ds_index_entries_by_begin_ns(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_fs_ds_index_entry *entry_a = a;
+	const struct ctf_fs_ds_index_entry *entry_b = b;
+
+	if (entry_a->timestamp_begin_ns < entry_b->timestamp_begin_ns) {
+		return -1;
+	} else if (entry_a->timestamp_begin_ns > entry_b->timestamp_begin_ns) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Sorts the entries of `index` by beginning time, keeping the merge
+ * order of entries having the same beginning time, and removes
+ * duplicate entries.
  *
- * In any case, the ownership of `entry` is transferred to this function.  So if
- * the entry is not inserted, it is freed.
+ * There can be duplicate packets if reading multiple overlapping
+ * snapshots of the same trace.  We then want the index to contain a
+ * reference to only one copy of that packet.
  */
+static
+int sort_ds_index(struct ctf_fs_ds_index *index)
+{
+	GPtrArray *entries = index->entries;
+	guint run_begin = 0;
+	guint kept = 0;
+	guint i;
+	int ret;
+
+	ret = ptr_array_sort_stable(entries,
+		compare_ds_index_entries_by_begin_ns);
+	if (ret) {
+		goto end;
+	}
+
+	for (i = 0; i < entries->len; i++) {
+		struct ctf_fs_ds_index_entry *entry = entries->pdata[i];
+		bool is_duplicate = false;
+		guint j;
+
+		if (kept > 0 && compare_ds_index_entries_by_begin_ns(
+				entries->pdata[kept - 1], entry) != 0) {
+			/* New run of entries having the same beginning time */
+			run_begin = kept;
+		}
+
+		for (j = run_begin; j < kept; j++) {
+			if (ds_index_entries_equal(entries->pdata[j], entry)) {
+				is_duplicate = true;
+				break;
+			}
+		}
+
+		if (is_duplicate) {
+			g_free(entry);
+		} else {
+			entries->pdata[kept] = entry;
+			kept++;
+		}
+	}
+
+	/* The remaining slots don't own anything */
+	for (i = kept; i < entries->len; i++) {
+		entries->pdata[i] = NULL;
+	}
+
+	g_ptr_array_set_size(entries, kept);
+
+end:
+	return ret;
+}
+
+static
+gint compare_ds_file_infos_by_begin_ns(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_fs_ds_file_info *ds_file_info_a = a;
+	const struct ctf_fs_ds_file_info *ds_file_info_b = b;
+
+	if (ds_file_info_a->begin_ns < ds_file_info_b->begin_ns) {
+		return -1;
+	} else if (ds_file_info_a->begin_ns > ds_file_info_b->begin_ns) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Sorts the data stream file infos of `ds_file_group` by beginning
+ * time, keeping the addition order of files having the same beginning
+ * time, and then sorts its index, if it's loaded.
+ *
+ * Adding all the data stream files of a group and then sorting once is
+ * linearithmic, while inserting each one at its place is quadratic
+ * with many files per group (rotated sessions, for example).
+ */
+static
+int sort_ds_file_group(struct ctf_fs_ds_file_group *ds_file_group)
+{
+	int ret;
+
+	ret = ptr_array_sort_stable(ds_file_group->ds_file_infos,
+		compare_ds_file_infos_by_begin_ns);
+	if (ret) {
+		goto end;
+	}
+
+	if (ds_file_group->index) {
+		ret = sort_ds_index(ds_file_group->index);
+	}
+
+end:
+	return ret;
+}
+
+static
+int sort_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
+{
+	int ret = 0;
+	guint i;
+
+	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
+		ret = sort_ds_file_group(
+			g_ptr_array_index(ctf_fs_trace->ds_file_groups, i));
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Hash and equality functions of the `ds_file_groups_by_id` hash table
+ * of a trace: data stream file groups match when their stream classes
+ * have the same ID and they have the same stream instance ID.
+ */
+static
+guint ds_file_group_id_hash(gconstpointer v)
+{
+	const struct ctf_fs_ds_file_group *ds_file_group = v;
+
+	return g_int64_hash(&ds_file_group->sc->id) ^
+		g_int64_hash(&ds_file_group->stream_id);
+}
+
+static
+gboolean ds_file_group_id_equal(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_fs_ds_file_group *ds_file_group_a = a;
+	const struct ctf_fs_ds_file_group *ds_file_group_b = b;
+
+	return ds_file_group_a->sc->id == ds_file_group_b->sc->id &&
+		ds_file_group_a->stream_id == ds_file_group_b->stream_id;
+}
+
+/*
+ * Adds `ds_file_group` to the data stream file groups of
+ * `ctf_fs_trace`, indexing it by ID if it has a stream instance ID.
+ */
+static
+void add_ds_file_group_to_trace(struct ctf_fs_trace *ctf_fs_trace,
+		struct ctf_fs_ds_file_group *ds_file_group)
+{
+	g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
+
+	if (ds_file_group->stream_id != UINT64_C(-1)) {
+		g_hash_table_insert(ctf_fs_trace->ds_file_groups_by_id,
+			ds_file_group, ds_file_group);
+	}
+}
+
+/*
+ * Builds the index of the data stream file of `ds_file_info`, which
+ * is part of `ctf_fs_trace`.
+ */
+static
+struct ctf_fs_ds_index *build_ds_file_info_index(
+		struct ctf_fs_trace *ctf_fs_trace,
+		struct ctf_fs_ds_file_info *ds_file_info)
+{
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_file *ds_file = NULL;
+	struct ctf_msg_iter *msg_iter = NULL;
+	bt_logging_level log_level = ctf_fs_trace->log_level;
+	bt_self_component *self_comp = ctf_fs_trace->self_comp;
+	bt_self_component_class *self_comp_class = ctf_fs_trace->self_comp_class;
+
+	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL, NULL,
+		ds_file_info->path->str, log_level);
+	if (!ds_file) {
+		goto end;
+	}
+
+	msg_iter = ctf_msg_iter_create(ctf_fs_trace->metadata->tc,
+		bt_common_get_page_size(log_level) * 8,
+		ctf_fs_ds_file_medops, ds_file, log_level, self_comp, NULL);
+	if (!msg_iter) {
+		BT_COMP_LOGE_STR("Cannot create a CTF message iterator.");
+		goto end;
+	}
+
+	ctf_msg_iter_set_dry_run(msg_iter, true);
+	index = ctf_fs_ds_file_build_index(ds_file, ds_file_info, msg_iter,
+		ctf_fs_trace->index_cache_dir,
+		ctf_fs_trace->index_event_classes);
+	if (!index) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
+			self_comp, self_comp_class,
+			"Failed to index CTF stream file \'%s\'",
+			ds_file_info->path->str);
+		goto end;
+	}
+
+end:
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (msg_iter) {
+		ctf_msg_iter_destroy(msg_iter);
+	}
+
+	return index;
+}
+
+/*
+ * Builds the index of `ds_file_group` from the indexes of its data
+ * stream files, like create_ds_file_groups() and
+ * merge_ctf_fs_ds_file_groups() do when the trace doesn't load indexes
+ * lazily.
+ */
+static
+int load_ds_file_group_index(struct ctf_fs_ds_file_group *ds_file_group)
+{
+	struct ctf_fs_trace *ctf_fs_trace = ds_file_group->ctf_fs_trace;
+	struct ctf_fs_ds_index *index = NULL;
+	bt_logging_level log_level = ctf_fs_trace->log_level;
+	bt_self_component *self_comp = ctf_fs_trace->self_comp;
+	int ret = 0;
+	guint i;
+
+	BT_ASSERT(!ds_file_group->index);
+
+	for (i = 0; i < ds_file_group->ds_file_infos->len; i++) {
+		struct ctf_fs_ds_file_info *ds_file_info =
+			g_ptr_array_index(ds_file_group->ds_file_infos, i);
+		struct ctf_fs_ds_index *file_index;
+
+		file_index = build_ds_file_info_index(ctf_fs_trace,
+			ds_file_info);
+		if (!file_index) {
+			ret = -1;
+			goto end;
+		}
+
+		if (!index) {
+			index = file_index;
+		} else {
+			merge_ctf_fs_ds_indexes(index, file_index);
+			ctf_fs_ds_index_destroy(file_index);
+		}
+	}
+
+	BT_ASSERT(index);
+
+	if (sort_ds_index(index)) {
+		ret = -1;
+		goto end;
+	}
+
+	BT_COMP_LOGD("Loaded data stream file group's index: "
+		"first-path=\"%s\", file-count=%u, entry-count=%u",
+		((struct ctf_fs_ds_file_info *)
+			ds_file_group->ds_file_infos->pdata[0])->path->str,
+		ds_file_group->ds_file_infos->len, index->entries->len);
+	ds_file_group->index = index;
+	index = NULL;
+
+end:
+	ctf_fs_ds_index_destroy(index);
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_group_acquire_index(
+		struct ctf_fs_ds_file_group *ds_file_group)
+{
+	int ret = 0;
+
+	if (!ds_file_group->index) {
+		BT_ASSERT(ds_file_group->ctf_fs_trace->lazy_index_loading);
+		BT_ASSERT(ds_file_group->index_users == 0);
+		ret = load_ds_file_group_index(ds_file_group);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ds_file_group->index_users++;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void ctf_fs_ds_file_group_release_index(
+		struct ctf_fs_ds_file_group *ds_file_group)
+{
+	BT_ASSERT(ds_file_group->index_users > 0);
+	ds_file_group->index_users--;
+
+	if (ds_file_group->index_users == 0 &&
+			ds_file_group->ctf_fs_trace->lazy_index_loading) {
+		ctf_fs_ds_index_destroy(ds_file_group->index);
+		ds_file_group->index = NULL;
+	}
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_group_get_range(
+		struct ctf_fs_ds_file_group *ds_file_group,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	struct ctf_fs_ds_index *first_index = NULL;
+	struct ctf_fs_ds_index *last_index = NULL;
+	const struct ctf_fs_ds_index_entry *entry;
+	GPtrArray *ds_file_infos = ds_file_group->ds_file_infos;
+	int ret = 0;
+
+	if (ds_file_group->index) {
+		first_index = ds_file_group->index;
+		last_index = ds_file_group->index;
+		goto set_range;
+	}
+
+	/*
+	 * The data stream files of a group are sorted by beginning
+	 * time: only index the first and the last ones.
+	 */
+	BT_ASSERT(ds_file_infos->len > 0);
+	first_index = build_ds_file_info_index(ds_file_group->ctf_fs_trace,
+		g_ptr_array_index(ds_file_infos, 0));
+	if (!first_index) {
+		ret = -1;
+		goto end;
+	}
+
+	if (ds_file_infos->len == 1) {
+		last_index = first_index;
+	} else {
+		last_index = build_ds_file_info_index(
+			ds_file_group->ctf_fs_trace,
+			g_ptr_array_index(ds_file_infos,
+				ds_file_infos->len - 1));
+		if (!last_index) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+set_range:
+	BT_ASSERT(first_index->entries->len > 0);
+	BT_ASSERT(last_index->entries->len > 0);
+	entry = g_ptr_array_index(first_index->entries, 0);
+	*begin_ns = entry->timestamp_begin_ns;
+	entry = g_ptr_array_index(last_index->entries,
+		last_index->entries->len - 1);
+	*end_ns = entry->timestamp_end_ns;
+
+end:
+	if (first_index != ds_file_group->index) {
+		if (last_index != first_index) {
+			ctf_fs_ds_index_destroy(last_index);
+		}
+
+		ctf_fs_ds_index_destroy(first_index);
+	}
+
+	return ret;
+}
+
+/*
+ * Loads the indexes of all the data stream file groups of `trace`, and
+ * then disables lazy index loading for this trace.
+ *
+ * The tracer bug fixes below need all the indexes, and releasing their
+ * fixed indexes would lose the fixes.
+ */
+static
+int load_all_ds_file_group_indexes(struct ctf_fs_trace *trace)
+{
+	int ret = 0;
+	guint i;
+
+	if (!trace->lazy_index_loading) {
+		goto end;
+	}
+
+	for (i = 0; i < trace->ds_file_groups->len; i++) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(trace->ds_file_groups, i);
+
+		if (ds_file_group->index) {
+			continue;
+		}
+
+		ret = load_ds_file_group_index(ds_file_group);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	trace->lazy_index_loading = false;
+
+end:
+	return ret;
+}
+
+/*
+ * Data stream file indexing job.
+ *
+ * index_ds_file() fills the result members of such a job without
+ * modifying the trace, so that the jobs of different data stream files
+ * can run concurrently. add_indexed_ds_file_to_ds_file_group() then
+ * adds the result to the data stream file groups of the trace.
+ */
+struct ds_file_index_job {
+	/* Weak */
+	struct ctf_fs_trace *ctf_fs_trace;
+
+	/* Owned by this */
+	GString *path;
+
+	/* Weak, result */
+	struct ctf_stream_class *sc;
+
+	/* Result */
+	int64_t stream_instance_id;
+
+	/* Owned by this, result */
+	struct ctf_fs_ds_file_info *ds_file_info;
+
+	/* Owned by this, result */
+	struct ctf_fs_ds_index *index;
+
+	/* 0 if the results are valid */
+	int ret;
+
+	/*
+	 * Error of the thread which ran this job, if `ret` is not 0
+	 * (owned by this).
+	 */
+	const bt_error *error;
+};
 
 static
-void ds_index_insert_ds_index_entry_sorted(
-	struct ctf_fs_ds_index *index,
-	struct ctf_fs_ds_index_entry *entry)
+void ds_file_index_job_destroy(struct ds_file_index_job *job)
 {
-	guint i;
-	struct ctf_fs_ds_index_entry *other_entry = NULL;
-
-	/* Find the spot where to insert this index entry. */
-	for (i = 0; i < index->entries->len; i++) {
-		other_entry = g_ptr_array_index(index->entries, i);
+	if (!job) {
+		return;
+	}
 
-		if (entry->timestamp_begin_ns <= other_entry->timestamp_begin_ns) {
-			break;
-		}
+	if (job->path) {
+		g_string_free(job->path, TRUE);
 	}
 
-	/*
-	 * Insert the entry only if a duplicate doesn't already exist.
-	 *
-	 * There can be duplicate packets if reading multiple overlapping
-	 * snapshots of the same trace.  We then want the index to contain
-	 * a reference to only one copy of that packet.
-	 */
-	if (i == index->entries->len ||
-			!ds_index_entries_equal(entry, other_entry)) {
-		array_insert(index->entries, entry, i);
-	} else {
-		g_free(entry);
+	ctf_fs_ds_file_info_destroy(job->ds_file_info);
+	ctf_fs_ds_index_destroy(job->index);
+
+	if (job->error) {
+		bt_error_release(job->error);
 	}
+
+	g_free(job);
 }
 
 static
-void merge_ctf_fs_ds_indexes(struct ctf_fs_ds_index *dest, struct ctf_fs_ds_index *src)
+struct ds_file_index_job *ds_file_index_job_create(
+		struct ctf_fs_trace *ctf_fs_trace, const char *path)
 {
-	guint i;
+	struct ds_file_index_job *job = g_new0(struct ds_file_index_job, 1);
 
-	for (i = 0; i < src->entries->len; i++) {
-		struct ctf_fs_ds_index_entry *entry =
-			g_ptr_array_index(src->entries, i);
+	if (!job) {
+		goto error;
+	}
 
-		/*
-		* Ownership of the ctf_fs_ds_index_entry is transferred to
-		* ds_index_insert_ds_index_entry_sorted.
-		*/
-		g_ptr_array_index(src->entries, i) = NULL;
-		ds_index_insert_ds_index_entry_sorted(dest, entry);
+	job->ctf_fs_trace = ctf_fs_trace;
+	job->stream_instance_id = -1;
+	job->path = g_string_new(path);
+	if (!job->path) {
+		goto error;
 	}
+
+	goto end;
+
+error:
+	ds_file_index_job_destroy(job);
+	job = NULL;
+
+end:
+	return job;
 }
 
+/*
+ * Reads the properties of the first packet of the data stream file of
+ * `job` and builds its index.
+ *
+ * This function only reads the (frozen) CTF IR trace class of the
+ * trace, so it's safe to call it concurrently for different jobs of
+ * the same trace.
+ */
 static
-int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
-		const char *path)
+void index_ds_file(struct ds_file_index_job *job)
 {
-	int64_t stream_instance_id = -1;
+	struct ctf_fs_trace *ctf_fs_trace = job->ctf_fs_trace;
+	const char *path = job->path->str;
 	int64_t begin_ns = -1;
-	struct ctf_fs_ds_file_group *ds_file_group = NULL;
-	bool add_group = false;
 	int ret;
-	size_t i;
 	struct ctf_fs_ds_file *ds_file = NULL;
-	struct ctf_fs_ds_file_info *ds_file_info = NULL;
-	struct ctf_fs_ds_index *index = NULL;
 	struct ctf_msg_iter *msg_iter = NULL;
-	struct ctf_stream_class *sc = NULL;
 	struct ctf_msg_iter_packet_properties props;
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 	bt_self_component *self_comp = ctf_fs_trace->self_comp;
@@ -755,18 +1877,18 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
-	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
-		props.stream_class_id);
-	BT_ASSERT(sc);
-	stream_instance_id = props.data_stream_id;
+	job->sc = ctf_trace_class_borrow_stream_class_by_id(
+		ds_file->metadata->tc, props.stream_class_id);
+	BT_ASSERT(job->sc);
+	job->stream_instance_id = props.data_stream_id;
 
 	if (props.snapshots.beginning_clock != UINT64_C(-1)) {
-		BT_ASSERT(sc->default_clock_class);
+		BT_ASSERT(job->sc->default_clock_class);
 		ret = bt_util_clock_cycles_to_ns_from_origin(
 			props.snapshots.beginning_clock,
-			sc->default_clock_class->frequency,
-			sc->default_clock_class->offset_seconds,
-			sc->default_clock_class->offset_cycles, &begin_ns);
+			job->sc->default_clock_class->frequency,
+			job->sc->default_clock_class->offset_seconds,
+			job->sc->default_clock_class->offset_cycles, &begin_ns);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 				"Cannot convert clock cycles to nanoseconds from origin (`%s`).",
@@ -775,13 +1897,20 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 	}
 
-	ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
-	if (!ds_file_info) {
+	job->ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
+	if (!job->ds_file_info) {
 		goto error;
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file, ds_file_info, msg_iter);
-	if (!index) {
+	if (ctf_fs_trace->lazy_index_loading) {
+		/* Index this file when a message iterator needs it */
+		goto skip_index;
+	}
+
+	job->index = ctf_fs_ds_file_build_index(ds_file, job->ds_file_info,
+		msg_iter, job->ctf_fs_trace->index_cache_dir,
+		job->ctf_fs_trace->index_event_classes);
+	if (!job->index) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 			self_comp, self_comp_class,
 			"Failed to index CTF stream file \'%s\'",
@@ -789,16 +1918,98 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
+skip_index:
 	if (begin_ns == -1) {
 		/*
 		 * No beginning timestamp to sort the stream files
 		 * within a stream file group, so consider that this
 		 * file must be the only one within its group.
 		 */
-		stream_instance_id = -1;
+		job->stream_instance_id = -1;
+	}
+
+	job->ret = 0;
+	goto end;
+
+error:
+	job->ret = -1;
+
+	/*
+	 * Keep the error of this thread (which possibly is not the
+	 * component's thread) with the job.
+	 */
+	job->error = bt_current_thread_take_error();
+
+end:
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (msg_iter) {
+		ctf_msg_iter_destroy(msg_iter);
+	}
+}
+
+/* GThreadPool function */
+static
+void index_ds_file_pool_func(gpointer data, gpointer user_data)
+{
+	index_ds_file(data);
+}
+
+/*
+ * Runs all the indexing jobs of `jobs` (array of
+ * `struct ds_file_index_job *`), concurrently if possible.
+ *
+ * The jobs may belong to different traces.
+ */
+static
+void run_ds_file_index_jobs(GPtrArray *jobs, bt_logging_level log_level,
+		bt_self_component *self_comp)
+{
+	GThreadPool *pool = NULL;
+	guint thread_count = MIN(bt_g_get_num_processors(), jobs->len);
+	guint i;
+
+	if (thread_count > 1) {
+		pool = g_thread_pool_new(index_ds_file_pool_func, NULL,
+			(gint) thread_count, FALSE, NULL);
+		if (!pool) {
+			BT_COMP_LOGI("Cannot create thread pool: "
+				"indexing stream files sequentially: "
+				"job-count=%u, thread-count=%u",
+				jobs->len, thread_count);
+		}
+	}
+
+	for (i = 0; i < jobs->len; i++) {
+		struct ds_file_index_job *job = g_ptr_array_index(jobs, i);
+
+		if (!pool || !g_thread_pool_push(pool, job, NULL)) {
+			index_ds_file(job);
+		}
+	}
+
+	if (pool) {
+		/* Wait for all the jobs to complete */
+		g_thread_pool_free(pool, FALSE, TRUE);
 	}
+}
 
-	if (stream_instance_id == -1) {
+/*
+ * Adds the data stream file of the successful indexing job `job` to
+ * the right data stream file group of `ctf_fs_trace`, creating it if
+ * needed.
+ */
+static
+int add_indexed_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
+		struct ds_file_index_job *job)
+{
+	struct ctf_fs_ds_file_group *ds_file_group = NULL;
+	bool add_group = false;
+	int ret = 0;
+
+	BT_ASSERT(job->ret == 0);
+
+	if (job->stream_instance_id == -1) {
 		/*
 		 * No stream instance ID or no beginning timestamp:
 		 * create a unique stream file group for this stream
@@ -807,54 +2018,50 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		 * group.
 		 */
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			sc, UINT64_C(-1), index);
+			job->sc, UINT64_C(-1), job->index);
 		/* Ownership of index is transferred. */
-		index = NULL;
+		job->index = NULL;
 
 		if (!ds_file_group) {
 			goto error;
 		}
 
-		ds_file_group_insert_ds_file_info_sorted(ds_file_group,
-			BT_MOVE_REF(ds_file_info));
+		ds_file_group_add_ds_file_info(ds_file_group,
+			BT_MOVE_REF(job->ds_file_info));
 
 		add_group = true;
 		goto end;
 	}
 
-	BT_ASSERT(stream_instance_id != -1);
-	BT_ASSERT(begin_ns != -1);
+	BT_ASSERT(job->ds_file_info->begin_ns != -1);
 
 	/* Find an existing stream file group with this ID */
-	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
-		ds_file_group = g_ptr_array_index(
-			ctf_fs_trace->ds_file_groups, i);
-
-		if (ds_file_group->sc == sc &&
-				ds_file_group->stream_id ==
-				stream_instance_id) {
-			break;
-		}
+	{
+		struct ctf_fs_ds_file_group key = {
+			.sc = job->sc,
+			.stream_id = job->stream_instance_id,
+		};
 
-		ds_file_group = NULL;
+		ds_file_group = g_hash_table_lookup(
+			ctf_fs_trace->ds_file_groups_by_id, &key);
 	}
 
 	if (!ds_file_group) {
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			sc, stream_instance_id, index);
+			job->sc, job->stream_instance_id, job->index);
 		/* Ownership of index is transferred. */
-		index = NULL;
+		job->index = NULL;
 		if (!ds_file_group) {
 			goto error;
 		}
 
 		add_group = true;
-	} else {
-		merge_ctf_fs_ds_indexes(ds_file_group->index, index);
+	} else if (job->index) {
+		merge_ctf_fs_ds_indexes(ds_file_group->index, job->index);
 	}
 
-	ds_file_group_insert_ds_file_info_sorted(ds_file_group,
-		BT_MOVE_REF(ds_file_info));
+	ds_file_group_add_ds_file_info(ds_file_group,
+		BT_MOVE_REF(job->ds_file_info));
 
 	goto end;
 
@@ -865,22 +2072,19 @@ error:
 
 end:
 	if (add_group && ds_file_group) {
-		g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
-	}
-
-	ctf_fs_ds_file_destroy(ds_file);
-	ctf_fs_ds_file_info_destroy(ds_file_info);
-
-	if (msg_iter) {
-		ctf_msg_iter_destroy(msg_iter);
+		add_ds_file_group_to_trace(ctf_fs_trace, ds_file_group);
 	}
 
-	ctf_fs_ds_index_destroy(index);
 	return ret;
 }
 
+/*
+ * Appends to `jobs` one indexing job for each data stream file of
+ * `ctf_fs_trace`.
+ */
 static
-int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
+int create_ds_file_index_jobs(struct ctf_fs_trace *ctf_fs_trace,
+		GPtrArray *jobs)
 {
 	int ret = 0;
 	const char *basename;
@@ -902,6 +2106,7 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 
 	while ((basename = g_dir_read_name(dir))) {
 		struct ctf_fs_file *file;
+		struct ds_file_index_job *job;
 
 		if (strcmp(basename, CTF_FS_METADATA_FILENAME) == 0) {
 			/* Ignore the metadata stream. */
@@ -941,6 +2146,7 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 				"Cannot open stream file `%s`",
 				file->path->str);
+			ctf_fs_file_destroy(file);
 			goto error;
 		}
 
@@ -951,17 +2157,15 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			continue;
 		}
 
-		ret = add_ds_file_to_ds_file_group(ctf_fs_trace,
-			file->path->str);
-		if (ret) {
+		job = ds_file_index_job_create(ctf_fs_trace, file->path->str);
+		ctf_fs_file_destroy(file);
+		if (!job) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
-				"Cannot add stream file `%s` to stream file group",
-				file->path->str);
-			ctf_fs_file_destroy(file);
+				"Failed to allocate a stream file indexing job.");
 			goto error;
 		}
 
-		ctf_fs_file_destroy(file);
+		g_ptr_array_add(jobs, job);
 	}
 
 	goto end;
@@ -982,6 +2186,92 @@ end:
 	return ret;
 }
 
+/*
+ * Creates the data stream file groups of all the traces of `traces`
+ * (array of `struct ctf_fs_trace *`).
+ *
+ * The data stream files of all the traces are indexed together so
+ * that, when there are many traces with few data stream files each,
+ * the files of different traces are also indexed concurrently.
+ */
+static
+int create_ds_file_groups(GPtrArray *traces, bt_logging_level log_level,
+		bt_self_component *self_comp,
+		bt_self_component_class *self_comp_class)
+{
+	int ret = 0;
+	GPtrArray *jobs = NULL;
+	guint i;
+
+	jobs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) ds_file_index_job_destroy);
+	if (!jobs) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
+	for (i = 0; i < traces->len; i++) {
+		ret = create_ds_file_index_jobs(g_ptr_array_index(traces, i),
+			jobs);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	/*
+	 * Index the stream files, possibly concurrently, and then add
+	 * them to their stream file groups in trace and directory order
+	 * so that the resulting groups and merged indexes are
+	 * deterministic.
+	 */
+	run_ds_file_index_jobs(jobs, log_level, self_comp);
+
+	for (i = 0; i < jobs->len; i++) {
+		struct ds_file_index_job *job = g_ptr_array_index(jobs, i);
+
+		if (job->ret == 0) {
+			ret = add_indexed_ds_file_to_ds_file_group(
+				job->ctf_fs_trace, job);
+		} else {
+			ret = job->ret;
+
+			if (job->error) {
+				BT_CURRENT_THREAD_MOVE_ERROR_AND_RESET(
+					job->error);
+			}
+		}
+
+		if (ret) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+				"Cannot add stream file `%s` to stream file group",
+				job->path->str);
+			goto error;
+		}
+	}
+
+	for (i = 0; i < traces->len; i++) {
+		ret = sort_ds_file_groups(g_ptr_array_index(traces, i));
+		if (ret) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+				"Failed to sort the data stream file groups of a trace.");
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (jobs) {
+		g_ptr_array_free(jobs, TRUE);
+	}
+
+	return ret;
+}
+
 static
 int set_trace_name(bt_trace *trace, const char *name_suffix,
 		bt_logging_level log_level, bt_self_component *self_comp)
@@ -1036,6 +2326,10 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 		bt_self_component_class *self_comp_class,
 		const char *path, const char *name,
 		struct ctf_fs_metadata_config *metadata_config,
+		const char *index_cache_dir,
+		struct ctf_fs_metadata_cache *metadata_cache,
+		size_t mmap_window_size, bool lazy_index_loading,
+		bool huge_pages, bool index_event_classes,
 		bt_logging_level log_level)
 {
 	struct ctf_fs_trace *ctf_fs_trace;
@@ -1052,6 +2346,11 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 	ctf_fs_trace->log_level = log_level;
 	ctf_fs_trace->self_comp = self_comp;
 	ctf_fs_trace->self_comp_class = self_comp_class;
+	ctf_fs_trace->index_cache_dir = index_cache_dir;
+	ctf_fs_trace->mmap_window_size = mmap_window_size;
+	ctf_fs_trace->lazy_index_loading = lazy_index_loading;
+	ctf_fs_trace->huge_pages = huge_pages;
+	ctf_fs_trace->index_event_classes = index_event_classes;
 	ctf_fs_trace->path = g_string_new(path);
 	if (!ctf_fs_trace->path) {
 		goto error;
@@ -1069,8 +2368,14 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 		goto error;
 	}
 
+	ctf_fs_trace->ds_file_groups_by_id = g_hash_table_new(
+		ds_file_group_id_hash, ds_file_group_id_equal);
+	if (!ctf_fs_trace->ds_file_groups_by_id) {
+		goto error;
+	}
+
 	ret = ctf_fs_metadata_set_trace_class(self_comp, ctf_fs_trace,
-		metadata_config);
+		metadata_config, metadata_cache);
 	if (ret) {
 		goto error;
 	}
@@ -1097,11 +2402,6 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 		}
 	}
 
-	ret = create_ds_file_groups(ctf_fs_trace);
-	if (ret) {
-		goto error;
-	}
-
 	goto end;
 
 error:
@@ -1181,7 +2481,11 @@ int ctf_fs_component_create_ctf_fs_trace_one_path(
 	}
 
 	ctf_fs_trace = ctf_fs_trace_create(self_comp, self_comp_class, norm_path->str,
-		trace_name, &ctf_fs->metadata_config, log_level);
+		trace_name, &ctf_fs->metadata_config,
+		ctf_fs->index_cache_dir ? ctf_fs->index_cache_dir->str : NULL,
+		ctf_fs->metadata_cache, ctf_fs->mmap_window_size,
+		ctf_fs->lazy_index_loading, ctf_fs->huge_pages,
+		ctf_fs->index_event_classes, log_level);
 	if (!ctf_fs_trace) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 			"Cannot create trace for `%s`.",
@@ -1231,7 +2535,9 @@ unsigned int metadata_count_stream_and_event_classes(struct ctf_fs_trace *trace)
 
 /*
  * Merge the src ds_file_group into dest.  This consists of merging their
- * ds_file_infos, making sure to keep the result sorted.
+ * ds_file_infos and their indexes.
+ *
+ * Call sort_ds_file_group() on `dest` once all the groups are merged.
  */
 
 static
@@ -1246,11 +2552,14 @@ void merge_ctf_fs_ds_file_groups(struct ctf_fs_ds_file_group *dest, struct ctf_f
 		/* Ownership of the ds_file_info is transferred to dest. */
 		g_ptr_array_index(src->ds_file_infos, i) = NULL;
 
-		ds_file_group_insert_ds_file_info_sorted(dest, ds_file_info);
+		ds_file_group_add_ds_file_info(dest, ds_file_info);
 	}
 
-	/* Merge both indexes. */
-	merge_ctf_fs_ds_indexes(dest->index, src->index);
+	/* Merge both indexes, unless they're loaded lazily. */
+	if (src->index) {
+		BT_ASSERT(dest->index);
+		merge_ctf_fs_ds_indexes(dest->index, src->index);
+	}
 }
 /* Merge src_trace's data stream file groups into dest_trace's. */
 
@@ -1259,49 +2568,26 @@ int merge_matching_ctf_fs_ds_file_groups(
 		struct ctf_fs_trace *dest_trace,
 		struct ctf_fs_trace *src_trace)
 {
-
-	GPtrArray *dest = dest_trace->ds_file_groups;
 	GPtrArray *src = src_trace->ds_file_groups;
 	guint s_i;
 	int ret = 0;
 
-	/*
-	 * Save the initial length of dest: we only want to check against the
-	 * original elements in the inner loop.
-	 */
-	const guint dest_len = dest->len;
-
 	for (s_i = 0; s_i < src->len; s_i++) {
 		struct ctf_fs_ds_file_group *src_group = g_ptr_array_index(src, s_i);
 		struct ctf_fs_ds_file_group *dest_group = NULL;
 
-		/* A stream instance without ID can't match a stream in the other trace.  */
-		if (src_group->stream_id != -1) {
-			guint d_i;
-
-			/* Let's search for a matching ds_file_group in the destination.  */
-			for (d_i = 0; d_i < dest_len; d_i++) {
-				struct ctf_fs_ds_file_group *candidate_dest = g_ptr_array_index(dest, d_i);
-
-				/* Can't match a stream instance without ID.  */
-				if (candidate_dest->stream_id == -1) {
-					continue;
-				}
-
-				/*
-				 * If the two groups have the same stream instance id
-				 * and belong to the same stream class (stream instance
-				 * ids are per-stream class), they represent the same
-				 * stream instance.
-				 */
-				if (candidate_dest->stream_id != src_group->stream_id ||
-						candidate_dest->sc->id != src_group->sc->id) {
-					continue;
-				}
-
-				dest_group = candidate_dest;
-				break;
-			}
+		/*
+		 * A stream instance without ID can't match a stream in the
+		 * other trace.
+		 *
+		 * If the two groups have the same stream instance id and
+		 * belong to the same stream class (stream instance ids are
+		 * per-stream class), they represent the same stream
+		 * instance.
+		 */
+		if (src_group->stream_id != UINT64_C(-1)) {
+			dest_group = g_hash_table_lookup(
+				dest_trace->ds_file_groups_by_id, src_group);
 		}
 
 		/*
@@ -1312,17 +2598,20 @@ int merge_matching_ctf_fs_ds_file_groups(
 		 */
 		if (!dest_group) {
 			struct ctf_stream_class *sc;
-			struct ctf_fs_ds_index *index;
+			struct ctf_fs_ds_index *index = NULL;
 
 			sc = ctf_trace_class_borrow_stream_class_by_id(
 				dest_trace->metadata->tc, src_group->sc->id);
 			BT_ASSERT(sc);
 
-			index = ctf_fs_ds_index_create(dest_trace->log_level,
-				dest_trace->self_comp);
-			if (!index) {
-				ret = -1;
-				goto end;
+			if (!dest_trace->lazy_index_loading) {
+				index = ctf_fs_ds_index_create(
+					dest_trace->log_level,
+					dest_trace->self_comp);
+				if (!index) {
+					ret = -1;
+					goto end;
+				}
 			}
 
 			dest_group = ctf_fs_ds_file_group_create(dest_trace, sc,
@@ -1334,7 +2623,7 @@ int merge_matching_ctf_fs_ds_file_groups(
 				goto end;
 			}
 
-			g_ptr_array_add(dest_trace->ds_file_groups, dest_group);
+			add_ds_file_group_to_trace(dest_trace, dest_group);
 		}
 
 		BT_ASSERT(dest_group);
@@ -1405,6 +2694,12 @@ int merge_ctf_fs_traces(struct ctf_fs_trace **traces, unsigned int num_traces,
 		}
 	}
 
+	/* Sort the merged data stream file groups once */
+	ret = sort_ds_file_groups(winner);
+	if (ret) {
+		goto end;
+	}
+
 	/*
 	 * Move the winner out of the array, into `*out_trace`.
 	 */
@@ -1420,51 +2715,119 @@ enum target_event {
 	LAST_EVENT,
 };
 
+/*
+ * Decoder of the clock snapshot of the first or last event of packets,
+ * for the index fixups below.
+ *
+ * It keeps the data stream file and the message iterator of the last
+ * decoded packet so that decoding many packets of the same data stream
+ * file (for example, to fix the barectf "event-before-packet" bug)
+ * doesn't open the file and create a message iterator for each packet.
+ */
+struct packet_event_decoder {
+	/* Weak */
+	struct ctf_fs_trace *ctf_fs_trace;
+
+	/* Owned by this */
+	struct ctf_fs_ds_file *ds_file;
+
+	/* Owned by this */
+	struct ctf_msg_iter *msg_iter;
+
+	/* Weak: path of the data stream file of `ds_file` */
+	const char *path;
+};
+
 static
-int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
-	struct ctf_clock_class *default_cc,
-	struct ctf_fs_ds_index_entry *index_entry,
-	enum target_event target_event, uint64_t *cs, int64_t *ts_ns)
+void packet_event_decoder_fini(struct packet_event_decoder *decoder)
 {
-	enum ctf_msg_iter_status iter_status = CTF_MSG_ITER_STATUS_OK;
-	struct ctf_fs_ds_file *ds_file = NULL;
-	struct ctf_msg_iter *msg_iter = NULL;
+	if (decoder->ds_file) {
+		ctf_fs_ds_file_destroy(decoder->ds_file);
+		decoder->ds_file = NULL;
+	}
+
+	if (decoder->msg_iter) {
+		ctf_msg_iter_destroy(decoder->msg_iter);
+		decoder->msg_iter = NULL;
+	}
+
+	decoder->path = NULL;
+}
+
+/*
+ * Makes the data stream file and message iterator of `decoder` read
+ * the data stream file `path`.
+ */
+static
+int packet_event_decoder_set_path(struct packet_event_decoder *decoder,
+		const char *path)
+{
+	struct ctf_fs_trace *ctf_fs_trace = decoder->ctf_fs_trace;
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 	bt_self_component *self_comp = ctf_fs_trace->self_comp;
 	int ret = 0;
 
-	BT_ASSERT(ctf_fs_trace);
-	BT_ASSERT(index_entry);
-	BT_ASSERT(index_entry->path);
+	if (decoder->path && strcmp(decoder->path, path) == 0) {
+		goto end;
+	}
 
-	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL,
-		NULL, index_entry->path, log_level);
-	if (!ds_file) {
+	packet_event_decoder_fini(decoder);
+	decoder->ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL,
+		NULL, path, log_level);
+	if (!decoder->ds_file) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to create a ctf_fs_ds_file");
-		ret = -1;
-		goto end;
+		goto error;
 	}
 
 	BT_ASSERT(ctf_fs_trace->metadata);
 	BT_ASSERT(ctf_fs_trace->metadata->tc);
 
-	msg_iter = ctf_msg_iter_create(ctf_fs_trace->metadata->tc,
+	decoder->msg_iter = ctf_msg_iter_create(ctf_fs_trace->metadata->tc,
 		bt_common_get_page_size(log_level) * 8, ctf_fs_ds_file_medops,
-		ds_file, log_level, self_comp, NULL);
-	if (!msg_iter) {
+		decoder->ds_file, log_level, self_comp, NULL);
+	if (!decoder->msg_iter) {
 		/* ctf_msg_iter_create() logs errors. */
-		ret = -1;
+		goto error;
+	}
+
+	/*
+	 * Turn on dry run mode to prevent the creation and usage of Babeltrace
+	 * library objects (bt_field, bt_message_*, etc.).
+	 */
+	ctf_msg_iter_set_dry_run(decoder->msg_iter, true);
+	decoder->path = path;
+	goto end;
+
+error:
+	packet_event_decoder_fini(decoder);
+	ret = -1;
+
+end:
+	return ret;
+}
+
+static
+int decode_clock_snapshot_after_event(struct packet_event_decoder *decoder,
+	struct ctf_clock_class *default_cc,
+	struct ctf_fs_ds_index_entry *index_entry,
+	enum target_event target_event, uint64_t *cs, int64_t *ts_ns)
+{
+	enum ctf_msg_iter_status iter_status = CTF_MSG_ITER_STATUS_OK;
+	bt_logging_level log_level = decoder->ctf_fs_trace->log_level;
+	bt_self_component *self_comp = decoder->ctf_fs_trace->self_comp;
+	int ret = 0;
+
+	BT_ASSERT(index_entry);
+	BT_ASSERT(index_entry->path);
+
+	ret = packet_event_decoder_set_path(decoder, index_entry->path);
+	if (ret) {
 		goto end;
 	}
 
-	/*
-	 * Turn on dry run mode to prevent the creation and usage of Babeltrace
-	 * library objects (bt_field, bt_message_*, etc.).
-	 */
-	ctf_msg_iter_set_dry_run(msg_iter, true);
-
 	/* Seek to the beginning of the target packet. */
-	iter_status = ctf_msg_iter_seek(msg_iter, index_entry->offset);
+	iter_status = ctf_msg_iter_seek(decoder->msg_iter,
+		index_entry->offset);
 	if (iter_status) {
 		/* ctf_msg_iter_seek() logs errors. */
 		ret = -1;
@@ -1479,12 +2842,12 @@ int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
 		 * snapshot.
 		 */
 		iter_status = ctf_msg_iter_curr_packet_first_event_clock_snapshot(
-			msg_iter, cs);
+			decoder->msg_iter, cs);
 		break;
 	case LAST_EVENT:
 		/* Decode the packet to extract the last event's clock snapshot. */
 		iter_status = ctf_msg_iter_curr_packet_last_event_clock_snapshot(
-			msg_iter, cs);
+			decoder->msg_iter, cs);
 		break;
 	default:
 		bt_common_abort();
@@ -1505,34 +2868,165 @@ int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
 	}
 
 end:
-	if (ds_file) {
-		ctf_fs_ds_file_destroy(ds_file);
-	}
-	if (msg_iter) {
-		ctf_msg_iter_destroy(msg_iter);
-	}
-
 	return ret;
 }
 
 static
-int decode_packet_first_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
+int decode_packet_first_event_timestamp(struct packet_event_decoder *decoder,
 	struct ctf_clock_class *default_cc,
 	struct ctf_fs_ds_index_entry *index_entry, uint64_t *cs, int64_t *ts_ns)
 {
-	return decode_clock_snapshot_after_event(ctf_fs_trace, default_cc,
+	return decode_clock_snapshot_after_event(decoder, default_cc,
 		index_entry, FIRST_EVENT, cs, ts_ns);
 }
 
 static
-int decode_packet_last_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
+int decode_packet_last_event_timestamp(struct packet_event_decoder *decoder,
 	struct ctf_clock_class *default_cc,
 	struct ctf_fs_ds_index_entry *index_entry, uint64_t *cs, int64_t *ts_ns)
 {
-	return decode_clock_snapshot_after_event(ctf_fs_trace, default_cc,
+	return decode_clock_snapshot_after_event(decoder, default_cc,
 		index_entry, LAST_EVENT, cs, ts_ns);
 }
 
+/*
+ * Function which fixes the index of a single data stream file group,
+ * decoding packets with `decoder` if needed.
+ *
+ * Such a function only modifies the index of `ds_file_group`, so that
+ * the data stream file groups of a trace can be fixed concurrently.
+ */
+typedef int (*ds_file_group_index_fix_func)(struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group,
+		struct packet_event_decoder *decoder);
+
+struct ds_file_group_index_fix_job {
+	/* Weak */
+	struct ctf_fs_trace *trace;
+
+	/* Weak */
+	struct ctf_fs_ds_file_group *ds_file_group;
+
+	ds_file_group_index_fix_func func;
+
+	/* Result */
+	int ret;
+
+	/*
+	 * Error of the thread which ran this job, if `ret` is not 0
+	 * (owned by this).
+	 */
+	const bt_error *error;
+};
+
+static
+void run_ds_file_group_index_fix_job(struct ds_file_group_index_fix_job *job)
+{
+	struct packet_event_decoder decoder = {
+		.ctf_fs_trace = job->trace,
+	};
+
+	job->ret = job->func(job->trace, job->ds_file_group, &decoder);
+	packet_event_decoder_fini(&decoder);
+
+	if (job->ret) {
+		/*
+		 * Keep the error of this thread (which possibly is not
+		 * the component's thread) with the job.
+		 */
+		job->error = bt_current_thread_take_error();
+	}
+}
+
+/* GThreadPool function */
+static
+void fix_ds_file_group_index_pool_func(gpointer data, gpointer user_data)
+{
+	run_ds_file_group_index_fix_job(data);
+}
+
+/*
+ * Fixes the indexes of all the data stream file groups of `trace` with
+ * `func`, concurrently if possible.
+ *
+ * Fixing an index may need to decode one or more packets: with many
+ * data stream file groups, this is the expensive part of opening a
+ * trace produced by a buggy tracer.
+ */
+static
+int fix_ds_file_group_indexes(struct ctf_fs_trace *trace,
+		ds_file_group_index_fix_func func)
+{
+	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	bt_logging_level log_level = trace->log_level;
+	bt_self_component *self_comp = trace->self_comp;
+	struct ds_file_group_index_fix_job *jobs;
+	GThreadPool *pool = NULL;
+	guint thread_count = MIN(bt_g_get_num_processors(),
+		ds_file_groups->len);
+	int ret = 0;
+	guint i;
+
+	jobs = g_new0(struct ds_file_group_index_fix_job,
+		ds_file_groups->len);
+	if (!jobs && ds_file_groups->len > 0) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate index fixing jobs.");
+		ret = -1;
+		goto end;
+	}
+
+	if (thread_count > 1) {
+		pool = g_thread_pool_new(fix_ds_file_group_index_pool_func,
+			NULL, (gint) thread_count, FALSE, NULL);
+		if (!pool) {
+			BT_COMP_LOGI("Cannot create thread pool: "
+				"fixing stream file group indexes sequentially: "
+				"group-count=%u, thread-count=%u",
+				ds_file_groups->len, thread_count);
+		}
+	}
+
+	for (i = 0; i < ds_file_groups->len; i++) {
+		struct ds_file_group_index_fix_job *job = &jobs[i];
+
+		job->trace = trace;
+		job->ds_file_group = g_ptr_array_index(ds_file_groups, i);
+		job->func = func;
+
+		if (!pool || !g_thread_pool_push(pool, job, NULL)) {
+			run_ds_file_group_index_fix_job(job);
+		}
+	}
+
+	if (pool) {
+		/* Wait for all the jobs to complete */
+		g_thread_pool_free(pool, FALSE, TRUE);
+	}
+
+	/* Report the error of the first failed job, if any */
+	for (i = 0; i < ds_file_groups->len; i++) {
+		struct ds_file_group_index_fix_job *job = &jobs[i];
+
+		if (job->ret && ret == 0) {
+			ret = job->ret;
+
+			if (job->error) {
+				BT_CURRENT_THREAD_MOVE_ERROR_AND_RESET(
+					job->error);
+			}
+		}
+
+		if (job->error) {
+			bt_error_release(job->error);
+		}
+	}
+
+end:
+	g_free(jobs);
+	return ret;
+}
+
 /*
  * Fix up packet index entries for lttng's "event-after-packet" bug.
  * Some buggy lttng tracer versions may emit events with a timestamp that is
@@ -1552,78 +3046,79 @@ int decode_packet_last_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
  *  - before lttng-module 2.9.13
  */
 static
-int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_event_after_packet_bug(
+		struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group,
+		struct packet_event_decoder *decoder)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
 	bt_logging_level log_level = trace->log_level;
+	guint entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index_entry *last_entry;
+	struct ctf_fs_ds_index *index;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	BT_ASSERT(ds_file_group);
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
+	/*
+	 * Iterate over all entries but the last one. The last one is
+	 * fixed differently after.
+	 */
+	for (entry_i = 0; entry_i < index->entries->len - 1;
+			entry_i++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
+		curr_entry = g_ptr_array_index(index->entries, entry_i);
+		next_entry = g_ptr_array_index(index->entries, entry_i + 1);
 
 		/*
-		 * Iterate over all entries but the last one. The last one is
-		 * fixed differently after.
+		 * 1. Set the current index entry `end` timestamp to
+		 * the next index entry `begin` timestamp.
 		 */
-		for (entry_i = 0; entry_i < index->entries->len - 1;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			next_entry = g_ptr_array_index(index->entries, entry_i + 1);
-
-			/*
-			 * 1. Set the current index entry `end` timestamp to
-			 * the next index entry `begin` timestamp.
-			 */
-			curr_entry->timestamp_end = next_entry->timestamp_begin;
-			curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-		}
+		curr_entry->timestamp_end = next_entry->timestamp_begin;
+		curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
+	}
 
-		/*
-		 * 2. Fix the last entry by decoding the last event of the last
-		 * packet.
-		 */
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	/*
+	 * 2. Fix the last entry by decoding the last event of the last
+	 * packet.
+	 */
+	last_entry = g_ptr_array_index(index->entries,
+		index->entries->len - 1);
+	BT_ASSERT(last_entry);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		/*
-		 * Decode packet to read the timestamp of the last event of the
-		 * entry.
-		 */
-		ret = decode_packet_last_event_timestamp(trace, default_cc,
-			last_entry, &last_entry->timestamp_end,
-			&last_entry->timestamp_end_ns);
-		if (ret) {
-			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-				"Failed to decode stream's last packet to get its last event's clock snapshot.");
-			goto end;
-		}
+	/*
+	 * Decode packet to read the timestamp of the last event of the
+	 * entry.
+	 */
+	ret = decode_packet_last_event_timestamp(decoder, default_cc,
+		last_entry, &last_entry->timestamp_end,
+		&last_entry->timestamp_end_ns);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+			"Failed to decode stream's last packet to get its last event's clock snapshot.");
+		goto end;
 	}
 
 end:
 	return ret;
 }
 
+static
+int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_lttng_event_after_packet_bug);
+}
+
 /*
  * Fix up packet index entries for barectf's "event-before-packet" bug.
  * Some buggy barectf tracer versions may emit events with a timestamp that is
@@ -1639,63 +3134,65 @@ end:
  *  - before barectf 2.3.1
  */
 static
-int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_barectf_event_before_packet_bug(
+		struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group,
+		struct packet_event_decoder *decoder)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
 	bt_logging_level log_level = trace->log_level;
+	guint entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index *index = ds_file_group->index;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
-
-		struct ctf_fs_ds_index *index = ds_file_group->index;
-
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
+	/*
+	 * 1. Iterate over the index, starting from the second entry
+	 * (index = 1).
+	 */
+	for (entry_i = 1; entry_i < index->entries->len;
+			entry_i++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *prev_entry;
+		prev_entry = g_ptr_array_index(index->entries, entry_i - 1);
+		curr_entry = g_ptr_array_index(index->entries, entry_i);
 		/*
-		 * 1. Iterate over the index, starting from the second entry
-		 * (index = 1).
+		 * 2. Set the current entry `begin` timestamp to the
+		 * timestamp of the first event of the current packet.
 		 */
-		for (entry_i = 1; entry_i < index->entries->len;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *prev_entry;
-			prev_entry = g_ptr_array_index(index->entries, entry_i - 1);
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			/*
-			 * 2. Set the current entry `begin` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			ret = decode_packet_first_event_timestamp(trace, default_cc,
-				curr_entry, &curr_entry->timestamp_begin,
-				&curr_entry->timestamp_begin_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode first event's clock snapshot");
-				goto end;
-			}
-
-			/*
-			 * 3. Set the previous entry `end` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			prev_entry->timestamp_end = curr_entry->timestamp_begin;
-			prev_entry->timestamp_end_ns = curr_entry->timestamp_begin_ns;
+		ret = decode_packet_first_event_timestamp(decoder, default_cc,
+			curr_entry, &curr_entry->timestamp_begin,
+			&curr_entry->timestamp_begin_ns);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode first event's clock snapshot");
+			goto end;
 		}
+
+		/*
+		 * 3. Set the previous entry `end` timestamp to the
+		 * timestamp of the first event of the current packet.
+		 */
+		prev_entry->timestamp_end = curr_entry->timestamp_begin;
+		prev_entry->timestamp_end_ns = curr_entry->timestamp_begin_ns;
 	}
+
 end:
 	return ret;
 }
 
+static
+int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_barectf_event_before_packet_bug);
+}
+
 /*
  * When using the lttng-crash feature it's likely that the last packets of each
  * stream have their timestamp_end set to zero. This is caused by the fact that
@@ -1714,72 +3211,65 @@ end:
  * - All current and future lttng-ust and lttng-modules versions.
  */
 static
-int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_crash_quirk(struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group,
+		struct packet_event_decoder *decoder)
 {
 	int ret = 0;
-	guint ds_file_group_idx;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
 	bt_logging_level log_level = trace->log_level;
+	guint entry_idx;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index_entry *last_entry;
+	struct ctf_fs_ds_index *index;
 
-	for (ds_file_group_idx = 0; ds_file_group_idx < ds_file_groups->len;
-			ds_file_group_idx++) {
-		guint entry_idx;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	BT_ASSERT(ds_file_group);
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_idx);
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	last_entry = g_ptr_array_index(index->entries,
+		index->entries->len - 1);
+	BT_ASSERT(last_entry);
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
 
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	/* 1. Fix the last entry first. */
+	if (last_entry->timestamp_end == 0 &&
+			last_entry->timestamp_begin != 0) {
+		/*
+		 * Decode packet to read the timestamp of the
+		 * last event of the stream file.
+		 */
+		ret = decode_packet_last_event_timestamp(decoder,
+			default_cc, last_entry,
+			&last_entry->timestamp_end,
+			&last_entry->timestamp_end_ns);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode last event's clock snapshot");
+			goto end;
+		}
+	}
 
+	/* Iterate over all entries but the last one. */
+	for (entry_idx = 0; entry_idx < index->entries->len - 1;
+			entry_idx++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
+		curr_entry = g_ptr_array_index(index->entries, entry_idx);
+		next_entry = g_ptr_array_index(index->entries, entry_idx + 1);
 
-		/* 1. Fix the last entry first. */
-		if (last_entry->timestamp_end == 0 &&
-				last_entry->timestamp_begin != 0) {
+		if (curr_entry->timestamp_end == 0 &&
+				curr_entry->timestamp_begin != 0) {
 			/*
-			 * Decode packet to read the timestamp of the
-			 * last event of the stream file.
+			 * 2. Set the current index entry `end` timestamp to
+			 * the next index entry `begin` timestamp.
 			 */
-			ret = decode_packet_last_event_timestamp(trace,
-				default_cc, last_entry,
-				&last_entry->timestamp_end,
-				&last_entry->timestamp_end_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode last event's clock snapshot");
-				goto end;
-			}
-		}
-
-		/* Iterate over all entries but the last one. */
-		for (entry_idx = 0; entry_idx < index->entries->len - 1;
-				entry_idx++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-			curr_entry = g_ptr_array_index(index->entries, entry_idx);
-			next_entry = g_ptr_array_index(index->entries, entry_idx + 1);
-
-			if (curr_entry->timestamp_end == 0 &&
-					curr_entry->timestamp_begin != 0) {
-				/*
-				 * 2. Set the current index entry `end` timestamp to
-				 * the next index entry `begin` timestamp.
-				 */
-				curr_entry->timestamp_end = next_entry->timestamp_begin;
-				curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-			}
+			curr_entry->timestamp_end = next_entry->timestamp_begin;
+			curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
 		}
 	}
 
@@ -1787,6 +3277,13 @@ end:
 	return ret;
 }
 
+static
+int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_lttng_crash_quirk);
+}
+
 /*
  * Extract the tracer information necessary to compare versions.
  * Returns 0 on success, and -1 if the extraction is not successful because the
@@ -1971,6 +3468,11 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 	if (is_tracer_affected_by_lttng_event_after_packet_bug(
 			&current_tracer_info)) {
 		BT_LOGI_STR("Trace may be affected by LTTng tracer packet timestamp bug. Fixing up.");
+		ret = load_all_ds_file_group_indexes(ctf_fs->trace);
+		if (ret) {
+			goto end;
+		}
+
 		ret = fix_index_lttng_event_after_packet_bug(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
@@ -1984,6 +3486,11 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 	if (is_tracer_affected_by_barectf_event_before_packet_bug(
 			&current_tracer_info)) {
 		BT_LOGI_STR("Trace may be affected by barectf tracer packet timestamp bug. Fixing up.");
+		ret = load_all_ds_file_group_indexes(ctf_fs->trace);
+		if (ret) {
+			goto end;
+		}
+
 		ret = fix_index_barectf_event_before_packet_bug(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
@@ -1996,6 +3503,11 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 
 	if (is_tracer_affected_by_lttng_crash_quirk(
 			&current_tracer_info)) {
+		ret = load_all_ds_file_group_indexes(ctf_fs->trace);
+		if (ret) {
+			goto end;
+		}
+
 		ret = fix_index_lttng_crash_quirk(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
@@ -2101,6 +3613,14 @@ int ctf_fs_component_create_ctf_fs_trace(
 		}
 	}
 
+	ret = create_ds_file_groups(traces, log_level, self_comp,
+		self_comp_class);
+	if (ret) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Failed to create the data stream file groups of the traces.");
+		goto end;
+	}
+
 	if (traces->len > 1) {
 		struct ctf_fs_trace *first_trace = (struct ctf_fs_trace *) traces->pdata[0];
 		const uint8_t *first_trace_uuid = first_trace->metadata->tc->uuid;
@@ -2295,6 +3815,10 @@ static const struct bt_param_validation_value_descr inputs_elem_descr = {
 	.type = BT_VALUE_TYPE_STRING,
 };
 
+static const struct bt_param_validation_value_descr event_class_names_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
 static const struct bt_param_validation_map_value_entry_descr fs_params_entries_descr[] = {
 	{ "inputs", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, {
 		BT_VALUE_TYPE_ARRAY,
@@ -2308,6 +3832,22 @@ static const struct bt_param_validation_map_value_entry_descr fs_params_entries_
 	{ "clock-class-offset-s", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
 	{ "clock-class-offset-ns", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
 	{ "force-clock-class-origin-unix-epoch", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "huge-pages", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "index-cache-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "index-event-classes", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "mmap-window-size", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "skip-event-records", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "skip-packets", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "lazy-index-loading", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "metadata-cache-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "event-class-names", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, {
+		BT_VALUE_TYPE_ARRAY,
+		.array = {
+			.min_length = 0,
+			.max_length = BT_PARAM_VALIDATION_INFINITE,
+			.element_type = &event_class_names_elem_descr,
+		}
+	}},
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -2360,6 +3900,119 @@ bool read_src_fs_parameters(const bt_value *params,
 			bt_value_bool_get(value);
 	}
 
+	/* index-cache-dir parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"index-cache-dir");
+	if (value) {
+		ctf_fs->index_cache_dir =
+			g_string_new(bt_value_string_get(value));
+		if (!ctf_fs->index_cache_dir) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class, "Failed to allocate a GString.");
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* metadata-cache-dir parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"metadata-cache-dir");
+	if (value) {
+		ctf_fs->metadata_cache_dir =
+			g_string_new(bt_value_string_get(value));
+		if (!ctf_fs->metadata_cache_dir) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class, "Failed to allocate a GString.");
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->metadata_config.snapshot_dir =
+			ctf_fs->metadata_cache_dir->str;
+	}
+
+	/* mmap-window-size parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"mmap-window-size");
+	if (value) {
+		uint64_t size = bt_value_integer_unsigned_get(value);
+
+		if (size == 0) {
+			if (SIZE_MAX <= UINT32_MAX) {
+				BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+					self_comp_class,
+					"Mapping whole data stream files (`mmap-window-size` parameter is 0) "
+					"is only supported on 64-bit hosts.");
+				ret = false;
+				goto end;
+			}
+
+			ctf_fs->mmap_window_size = SIZE_MAX;
+		} else if (size > SIZE_MAX / 2) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `mmap-window-size` parameter: value is too large: "
+				"value=%" PRIu64, size);
+			ret = false;
+			goto end;
+		} else {
+			ctf_fs->mmap_window_size = (size_t) size;
+		}
+	}
+
+	/* lazy-index-loading parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"lazy-index-loading");
+	if (value) {
+		ctf_fs->lazy_index_loading = bt_value_bool_get(value);
+	}
+
+	/* huge-pages parameter */
+	value = bt_value_map_borrow_entry_value_const(params, "huge-pages");
+	if (value) {
+		ctf_fs->huge_pages = bt_value_bool_get(value);
+	}
+
+	/* index-event-classes parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"index-event-classes");
+	if (value) {
+		ctf_fs->index_event_classes = bt_value_bool_get(value);
+	}
+
+	/* skip-event-records parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"skip-event-records");
+	if (value) {
+		ctf_fs->skip_event_records = bt_value_bool_get(value);
+	}
+
+	/* skip-packets parameter */
+	value = bt_value_map_borrow_entry_value_const(params, "skip-packets");
+	if (value) {
+		ctf_fs->metadata_config.no_packets = bt_value_bool_get(value);
+	}
+
+	/* event-class-names parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"event-class-names");
+	if (value) {
+		uint64_t i;
+
+		ctf_fs->event_class_names = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, NULL);
+		BT_ASSERT(ctf_fs->event_class_names);
+
+		for (i = 0; i < bt_value_array_get_length(value); i++) {
+			const bt_value *name_value =
+				bt_value_array_borrow_element_by_index_const(
+					value, i);
+
+			g_hash_table_add(ctf_fs->event_class_names,
+				g_strdup(bt_value_string_get(name_value)));
+		}
+	}
+
 	/* trace-name parameter */
 	*trace_name = bt_value_map_borrow_entry_value_const(params, "trace-name");
 
@@ -2370,6 +4023,36 @@ end:
 	return ret;
 }
 
+/*
+ * Marks the event classes of the trace of `ctf_fs` which the
+ * `event-class-names` parameter doesn't name as excluded so that the
+ * message iterators skip their event records.
+ */
+static
+void exclude_event_classes(struct ctf_fs_component *ctf_fs)
+{
+	struct ctf_trace_class *tc;
+	uint64_t i;
+
+	if (!ctf_fs->event_class_names) {
+		return;
+	}
+
+	tc = ctf_fs->trace->metadata->tc;
+
+	for (i = 0; i < tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec = sc->event_classes->pdata[j];
+
+			ec->is_excluded = !g_hash_table_contains(
+				ctf_fs->event_class_names, ec->name->str);
+		}
+	}
+}
+
 static
 struct ctf_fs_component *ctf_fs_create(
 	const bt_value *params,
@@ -2399,6 +4082,8 @@ struct ctf_fs_component *ctf_fs_create(
 		goto error;
 	}
 
+	exclude_event_classes(ctf_fs);
+
 	if (create_streams_for_trace(ctf_fs->trace)) {
 		goto error;
 	}
@@ -2454,10 +4139,11 @@ bt_component_class_query_method_status ctf_fs_query(
 		status = metadata_info_query(comp_class, params, log_level,
 			result);
 	} else if (strcmp(object, "babeltrace.trace-infos") == 0) {
-		status = trace_infos_query(comp_class, params, log_level,
-			result);
+		status = trace_infos_query(comp_class, priv_query_exec,
+			params, log_level, result);
 	} else if (!strcmp(object, "babeltrace.support-info")) {
-		status = support_info_query(comp_class, params, log_level, result);
+		status = support_info_query(comp_class, priv_query_exec,
+			params, log_level, result);
 	} else {
 		BT_LOGE("Unknown query object `%s`", object);
 		status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_UNKNOWN_OBJECT;
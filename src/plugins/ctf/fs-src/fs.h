@@ -20,6 +20,9 @@
 BT_HIDDEN
 extern bool ctf_fs_debug;
 
+/* Maximum message batch size requested by a `src.ctf.fs` iterator */
+#define CTF_FS_MSG_ITER_MAX_BATCH_SIZE	1024
+
 struct ctf_fs_file {
 	bt_logging_level log_level;
 
@@ -33,16 +36,25 @@ struct ctf_fs_file {
 	FILE *fp;
 
 	off_t size;
+
+	/* Modification time (seconds since Epoch) */
+	int64_t mtime;
 };
 
 struct ctf_fs_metadata {
-	/* Owned by this */
+	/*
+	 * Owned by this, `NULL` if the decoder is owned by the
+	 * component's metadata cache
+	 */
 	struct ctf_metadata_decoder *decoder;
 
 	/* Owned by this */
 	bt_trace_class *trace_class;
 
-	/* Weak (owned by `decoder` above) */
+	/*
+	 * Weak (owned by `decoder` above or by the component's metadata
+	 * cache): may be shared with other traces of the same component
+	 */
 	struct ctf_trace_class *tc;
 
 	/* Owned by this */
@@ -61,6 +73,63 @@ struct ctf_fs_component {
 	struct ctf_fs_trace *trace;
 
 	struct ctf_fs_metadata_config metadata_config;
+
+	/*
+	 * Directory of the packet index cache files, or `NULL` to
+	 * disable the cache (owned by this).
+	 */
+	GString *index_cache_dir;
+
+	/*
+	 * Directory of the metadata snapshot files, or `NULL` to disable
+	 * snapshots (owned by this).
+	 */
+	GString *metadata_cache_dir;
+
+	/*
+	 * Decoded metadata shared between the traces of this component
+	 * which have identical metadata files (owned by this).
+	 */
+	struct ctf_fs_metadata_cache *metadata_cache;
+
+	/*
+	 * Size (bytes) of the data stream file mapping windows: 0 for
+	 * the default size, `SIZE_MAX` to map whole files.
+	 */
+	size_t mmap_window_size;
+
+	/*
+	 * True to load the index of a data stream file group when a
+	 * message iterator first needs it, and to release it, as well
+	 * as the open data stream file, once no message iterator needs
+	 * it anymore.
+	 */
+	bool lazy_index_loading;
+
+	/*
+	 * True to advise the system to back the data stream file
+	 * mappings with huge pages.
+	 */
+	bool huge_pages;
+
+	/*
+	 * True to record, in the packet indexes, the event classes of
+	 * the event records of each packet.
+	 */
+	bool index_event_classes;
+
+	/*
+	 * True to emit no event messages, skipping the event records of
+	 * the packets.
+	 */
+	bool skip_event_records;
+
+	/*
+	 * Set of the names (`gchar *`, owned by this) of the event
+	 * classes of which to create event messages, or `NULL` for all
+	 * the event classes.
+	 */
+	GHashTable *event_class_names;
 };
 
 struct ctf_fs_trace {
@@ -83,11 +152,36 @@ struct ctf_fs_trace {
 	/* Array of struct ctf_fs_ds_file_group *, owned by this */
 	GPtrArray *ds_file_groups;
 
+	/*
+	 * Hash table of the groups of `ds_file_groups` having a stream
+	 * instance ID, keyed by their stream class ID and stream
+	 * instance ID (keys and values are weak).
+	 */
+	GHashTable *ds_file_groups_by_id;
+
 	/* Owned by this */
 	GString *path;
 
 	/* Next automatic stream ID when not provided by packet header */
 	uint64_t next_stream_id;
+
+	/* Weak, belongs to component; `NULL` if disabled */
+	const char *index_cache_dir;
+
+	/* Copy of the component's `mmap_window_size` */
+	size_t mmap_window_size;
+
+	/*
+	 * Copy of the component's `lazy_index_loading`, unless a tracer
+	 * bug fix needed all the indexes of this trace
+	 */
+	bool lazy_index_loading;
+
+	/* Copy of the component's `huge_pages` */
+	bool huge_pages;
+
+	/* Copy of the component's `index_event_classes` */
+	bool index_event_classes;
 };
 
 struct ctf_fs_ds_index_entry {
@@ -116,6 +210,13 @@ struct ctf_fs_ds_index_entry {
 	 * Packet sequence number, or UINT64_MAX if not present in the index.
 	 */
 	uint64_t packet_seq_num;
+
+	/*
+	 * Bitwise OR of ctf_msg_iter_event_class_id_bit() for the IDs
+	 * of the event classes of the event records of the packet, or
+	 * UINT64_MAX if unknown.
+	 */
+	uint64_t event_class_bits;
 };
 
 struct ctf_fs_ds_index {
@@ -148,9 +249,16 @@ struct ctf_fs_ds_file_group {
 	struct ctf_fs_trace *ctf_fs_trace;
 
 	/*
-	 * Owned by this.
+	 * Owned by this; `NULL` if not loaded yet or released (lazy
+	 * index loading).
+	 *
+	 * Use ctf_fs_ds_file_group_acquire_index() and
+	 * ctf_fs_ds_file_group_release_index() to access it.
 	 */
 	struct ctf_fs_ds_index *index;
+
+	/* Number of acquisitions of `index` */
+	unsigned int index_users;
 };
 
 struct ctf_fs_port_data {
@@ -185,6 +293,35 @@ struct ctf_fs_msg_iter_data {
 	const struct bt_error *next_saved_error;
 
 	struct ctf_fs_ds_group_medops_data *msg_iter_medops_data;
+
+	/* True if this iterator acquired the index of `ds_file_group` */
+	bool holds_index;
+
+	/*
+	 * State of the last "seek nanoseconds from origin" operation,
+	 * see ctf_fs_iterator_seek_ns_from_origin().
+	 */
+	struct {
+		/* True while skipping messages before `ns_from_origin` */
+		bool skipping;
+
+		int64_t ns_from_origin;
+
+		/* True if the stream began while skipping */
+		bool stream_began;
+
+		/* True if a skipped message had a default clock snapshot */
+		bool seen_clock_snapshot;
+
+		/* Packet which began while skipping, if any (owned) */
+		const bt_packet *packet;
+
+		/*
+		 * Messages to return before reading from `msg_iter`
+		 * again (`const bt_message *`, owned).
+		 */
+		GQueue *msgs;
+	} seek;
 };
 
 BT_HIDDEN
@@ -222,6 +359,17 @@ BT_HIDDEN
 bt_message_iterator_class_seek_beginning_method_status ctf_fs_iterator_seek_beginning(
 		bt_self_message_iterator *message_iterator);
 
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+ctf_fs_iterator_seek_ns_from_origin(bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+ctf_fs_iterator_can_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin, bt_bool *can_seek);
+
 /* Create and initialize a new, empty ctf_fs_component. */
 
 BT_HIDDEN
@@ -248,6 +396,41 @@ int ctf_fs_component_create_ctf_fs_trace(
 		bt_self_component *self_comp,
 		bt_self_component_class *self_comp_class);
 
+/*
+ * Makes sure the index of `ds_file_group` is loaded and keeps it loaded
+ * until a matching ctf_fs_ds_file_group_release_index() call.
+ *
+ * Returns 0 on success.
+ */
+
+BT_HIDDEN
+int ctf_fs_ds_file_group_acquire_index(
+		struct ctf_fs_ds_file_group *ds_file_group);
+
+/*
+ * Releases an acquisition of the index of `ds_file_group`, freeing it
+ * on the last one if its trace loads indexes lazily.
+ */
+
+BT_HIDDEN
+void ctf_fs_ds_file_group_release_index(
+		struct ctf_fs_ds_file_group *ds_file_group);
+
+/*
+ * Sets `*begin_ns` and `*end_ns` to the beginning time of the first
+ * packet and to the end time of the last packet of `ds_file_group`.
+ *
+ * If the index of `ds_file_group` isn't loaded, this function only
+ * indexes its first and last data stream files.
+ *
+ * Returns 0 on success.
+ */
+
+BT_HIDDEN
+int ctf_fs_ds_file_group_get_range(
+		struct ctf_fs_ds_file_group *ds_file_group,
+		int64_t *begin_ns, int64_t *end_ns);
+
 /* Free `ctf_fs` and everything it owns. */
 
 BT_HIDDEN
@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef CTF_FS_INDEX_CACHE_H
+#define CTF_FS_INDEX_CACHE_H
+
+#include <stdint.h>
+#include "common/uuid.h"
+
+/*
+ * Packet index cache file written by `src.ctf.fs` in the directory
+ * given by its `index-cache-dir` parameter.
+ *
+ * A cache file is a local, host-specific artifact: all integer fields
+ * are stored in native byte order, so that a cache file written on a
+ * host with a different byte order fails the magic number check.
+ */
+#define CTF_FS_INDEX_CACHE_MAGIC	0xB7C1DCAC
+#define CTF_FS_INDEX_CACHE_VERSION	2
+#define CTF_FS_INDEX_CACHE_SUFFIX	".btidx"
+
+/* The `event_class_bits` fields of the entries are known */
+#define CTF_FS_INDEX_CACHE_FLAG_EVENT_CLASS_BITS	(UINT32_C(1) << 0)
+
+/*
+ * Header at the beginning of each cache file.
+ *
+ * The header is followed by `path_len` bytes (absolute path of the
+ * data stream file, not null-terminated), and then by `entry_count`
+ * instances of `struct ctf_fs_index_cache_entry`.
+ */
+struct ctf_fs_index_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+
+	/* Size of `struct ctf_fs_index_cache_entry`, in bytes */
+	uint32_t entry_len;
+	uint32_t path_len;
+
+	/* `CTF_FS_INDEX_CACHE_FLAG_*` flags */
+	uint32_t flags;
+
+	/* Size (bytes) and modification time (s) of the data stream file */
+	uint64_t ds_file_size;
+	int64_t ds_file_mtime;
+
+	/* Trace UUID, all zeros if the trace has none */
+	bt_uuid_t trace_uuid;
+
+	uint64_t entry_count;
+} __attribute__((__packed__));
+
+struct ctf_fs_index_cache_entry {
+	uint64_t offset;		/* offset of the packet in the file, in bytes */
+	uint64_t packet_size;		/* packet size, in bytes */
+	uint64_t timestamp_begin;	/* in cycles, UINT64_C(-1) if none */
+	uint64_t timestamp_end;		/* in cycles, UINT64_C(-1) if none */
+	uint64_t packet_seq_num;	/* UINT64_MAX if none */
+	uint64_t event_class_bits;	/* UINT64_MAX if unknown, see ctf_msg_iter_event_class_id_bit() */
+} __attribute__((__packed__));
+
+#endif /* CTF_FS_INDEX_CACHE_H */
@@ -70,11 +70,135 @@ end:
 	return file;
 }
 
+struct ctf_fs_metadata_cache {
+	/*
+	 * Key: `GString *` (content of a metadata file, owned by the
+	 * value)
+	 *
+	 * Value: `struct ctf_fs_metadata_cache_entry *` (owned by this)
+	 */
+	GHashTable *entries;
+};
+
+struct ctf_fs_metadata_cache_entry {
+	/* Owned by this */
+	GString *content;
+
+	/* Owned by this */
+	struct ctf_metadata_decoder *decoder;
+};
+
+static
+void metadata_cache_entry_destroy(struct ctf_fs_metadata_cache_entry *entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	if (entry->content) {
+		g_string_free(entry->content, TRUE);
+	}
+
+	if (entry->decoder) {
+		ctf_metadata_decoder_destroy(entry->decoder);
+	}
+
+	g_free(entry);
+}
+
+BT_HIDDEN
+struct ctf_fs_metadata_cache *ctf_fs_metadata_cache_create(void)
+{
+	struct ctf_fs_metadata_cache *cache =
+		g_new0(struct ctf_fs_metadata_cache, 1);
+
+	if (!cache) {
+		goto end;
+	}
+
+	cache->entries = g_hash_table_new_full(
+		(GHashFunc) g_string_hash, (GEqualFunc) g_string_equal,
+		NULL, (GDestroyNotify) metadata_cache_entry_destroy);
+	if (!cache->entries) {
+		g_free(cache);
+		cache = NULL;
+	}
+
+end:
+	return cache;
+}
+
+BT_HIDDEN
+void ctf_fs_metadata_cache_destroy(struct ctf_fs_metadata_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	if (cache->entries) {
+		g_hash_table_destroy(cache->entries);
+	}
+
+	g_free(cache);
+}
+
+/*
+ * Reads the whole content of `file` and rewinds it.
+ */
+static
+GString *read_file_content(struct ctf_fs_file *file,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	GString *content = g_string_sized_new(file->size);
+	char buf[4096];
+	size_t len;
+
+	if (!content) {
+		BT_COMP_LOGE_STR("Failed to allocate a GString.");
+		goto error;
+	}
+
+	while ((len = fread(buf, 1, sizeof(buf), file->fp)) > 0) {
+		g_string_append_len(content, buf, len);
+	}
+
+	if (ferror(file->fp)) {
+		BT_COMP_LOGE("Cannot read metadata file: path=\"%s\"",
+			file->path->str);
+		goto error;
+	}
+
+	rewind(file->fp);
+	goto end;
+
+error:
+	if (content) {
+		g_string_free(content, TRUE);
+		content = NULL;
+	}
+
+end:
+	return content;
+}
+
+static
+void set_trace_class_from_decoder(struct ctf_fs_metadata *metadata,
+		struct ctf_metadata_decoder *decoder,
+		bt_self_component *self_comp)
+{
+	metadata->trace_class =
+		ctf_metadata_decoder_get_ir_trace_class(decoder);
+	BT_ASSERT(!self_comp || metadata->trace_class);
+	metadata->tc = ctf_metadata_decoder_borrow_ctf_trace_class(decoder);
+	BT_ASSERT(metadata->tc);
+}
+
 BT_HIDDEN
 int ctf_fs_metadata_set_trace_class(
 		bt_self_component *self_comp,
 		struct ctf_fs_trace *ctf_fs_trace,
-		struct ctf_fs_metadata_config *config)
+		struct ctf_fs_metadata_config *config,
+		struct ctf_fs_metadata_cache *cache)
 {
 	int ret = 0;
 	struct ctf_fs_file *file = NULL;
@@ -86,8 +210,13 @@ int ctf_fs_metadata_set_trace_class(
 		.force_clock_class_origin_unix_epoch =
 			config ? config->force_clock_class_origin_unix_epoch : false,
 		.create_trace_class = true,
+		.no_packets = config ? config->no_packets : false,
+		.snapshot_dir = config ? config->snapshot_dir : NULL,
 	};
 	bt_logging_level log_level = ctf_fs_trace->log_level;
+	struct ctf_metadata_decoder *decoder = NULL;
+	struct ctf_fs_metadata_cache_entry *entry = NULL;
+	GString *content = NULL;
 
 	file = get_file(ctf_fs_trace->path->str, log_level, self_comp);
 	if (!file) {
@@ -96,31 +225,71 @@ int ctf_fs_metadata_set_trace_class(
 		goto end;
 	}
 
-	ctf_fs_trace->metadata->decoder = ctf_metadata_decoder_create(
-		&decoder_config);
-	if (!ctf_fs_trace->metadata->decoder) {
+	if (cache) {
+		content = read_file_content(file, log_level, self_comp);
+		if (!content) {
+			ret = -1;
+			goto end;
+		}
+
+		entry = g_hash_table_lookup(cache->entries, content);
+		if (entry) {
+			/*
+			 * Another trace of this component has the exact
+			 * same metadata: share its decoded classes.
+			 */
+			BT_COMP_LOGI("Reusing decoded metadata of an identical "
+				"metadata file: path=\"%s\"", file->path->str);
+			set_trace_class_from_decoder(ctf_fs_trace->metadata,
+				entry->decoder, self_comp);
+			goto end;
+		}
+	}
+
+	decoder = ctf_metadata_decoder_create(&decoder_config);
+	if (!decoder) {
 		BT_COMP_LOGE("Cannot create metadata decoder object.");
 		ret = -1;
 		goto end;
 	}
 
-	ret = ctf_metadata_decoder_append_content(
-		ctf_fs_trace->metadata->decoder, file->fp);
+	ret = ctf_metadata_decoder_append_content(decoder, file->fp);
 	if (ret) {
 		BT_COMP_LOGE("Cannot update metadata decoder's content.");
 		goto end;
 	}
 
-	ctf_fs_trace->metadata->trace_class =
-		ctf_metadata_decoder_get_ir_trace_class(
-			ctf_fs_trace->metadata->decoder);
-	BT_ASSERT(!self_comp || ctf_fs_trace->metadata->trace_class);
-	ctf_fs_trace->metadata->tc =
-		ctf_metadata_decoder_borrow_ctf_trace_class(
-			ctf_fs_trace->metadata->decoder);
-	BT_ASSERT(ctf_fs_trace->metadata->tc);
+	set_trace_class_from_decoder(ctf_fs_trace->metadata, decoder,
+		self_comp);
+
+	if (cache) {
+		/* The cache entry owns the decoder and the content */
+		entry = g_new0(struct ctf_fs_metadata_cache_entry, 1);
+		if (!entry) {
+			BT_COMP_LOGE_STR("Failed to allocate a metadata cache entry.");
+			ret = -1;
+			goto end;
+		}
+
+		entry->content = content;
+		content = NULL;
+		entry->decoder = decoder;
+		decoder = NULL;
+		g_hash_table_insert(cache->entries, entry->content, entry);
+	} else {
+		ctf_fs_trace->metadata->decoder = decoder;
+		decoder = NULL;
+	}
 
 end:
+	if (content) {
+		g_string_free(content, TRUE);
+	}
+
+	if (decoder) {
+		ctf_metadata_decoder_destroy(decoder);
+	}
+
 	ctf_fs_file_destroy(file);
 	return ret;
 }
@@ -17,11 +17,21 @@
 
 struct ctf_fs_trace;
 struct ctf_fs_metadata;
+struct ctf_fs_metadata_cache;
 
 struct ctf_fs_metadata_config {
 	bool force_clock_class_origin_unix_epoch;
 	int64_t clock_class_offset_s;
 	int64_t clock_class_offset_ns;
+
+	/* True to create stream classes which don't support packets */
+	bool no_packets;
+
+	/*
+	 * Directory of the metadata snapshot files, or `NULL` to disable
+	 * snapshots (weak).
+	 */
+	const char *snapshot_dir;
 };
 
 BT_HIDDEN
@@ -33,7 +43,21 @@ void ctf_fs_metadata_fini(struct ctf_fs_metadata *metadata);
 BT_HIDDEN
 int ctf_fs_metadata_set_trace_class(bt_self_component *self_comp,
 		struct ctf_fs_trace *ctf_fs_trace,
-		struct ctf_fs_metadata_config *config);
+		struct ctf_fs_metadata_config *config,
+		struct ctf_fs_metadata_cache *cache);
+
+/*
+ * Creates a cache of decoded metadata, keyed by the exact content of
+ * metadata files.
+ *
+ * All the traces which use the same cache must be decoded with the
+ * same metadata configuration.
+ */
+BT_HIDDEN
+struct ctf_fs_metadata_cache *ctf_fs_metadata_cache_create(void);
+
+BT_HIDDEN
+void ctf_fs_metadata_cache_destroy(struct ctf_fs_metadata_cache *cache);
 
 BT_HIDDEN
 FILE *ctf_fs_metadata_open_file(const char *trace_path);
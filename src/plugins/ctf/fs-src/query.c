@@ -208,29 +208,19 @@ int populate_stream_info(struct ctf_fs_ds_file_group *group,
 {
 	int ret = 0;
 	bt_value_map_insert_entry_status insert_status;
-	struct ctf_fs_ds_index_entry *first_ds_index_entry, *last_ds_index_entry;
 	gchar *port_name = NULL;
 
 	/*
-	 * Since each `struct ctf_fs_ds_file_group` has a sorted array of
-	 * `struct ctf_fs_ds_index_entry`, we can compute the stream range from
-	 * the timestamp_begin of the first index entry and the timestamp_end
-	 * of the last index entry.
+	 * Since the packets of a `struct ctf_fs_ds_file_group` are
+	 * sorted, we can compute the stream range from the
+	 * timestamp_begin of its first packet and the timestamp_end of
+	 * its last packet.
 	 */
-	BT_ASSERT(group->index);
-	BT_ASSERT(group->index->entries);
-	BT_ASSERT(group->index->entries->len > 0);
-
-	/* First entry. */
-	first_ds_index_entry = (struct ctf_fs_ds_index_entry *) g_ptr_array_index(
-		group->index->entries, 0);
-
-	/* Last entry. */
-	last_ds_index_entry = (struct ctf_fs_ds_index_entry *) g_ptr_array_index(
-		group->index->entries, group->index->entries->len - 1);
-
-	stream_range->begin_ns = first_ds_index_entry->timestamp_begin_ns;
-	stream_range->end_ns = last_ds_index_entry->timestamp_end_ns;
+	ret = ctf_fs_ds_file_group_get_range(group, &stream_range->begin_ns,
+		&stream_range->end_ns);
+	if (ret) {
+		goto end;
+	}
 
 	/*
 	 * If any of the begin and end timestamps is not set it means that
@@ -315,9 +305,64 @@ end:
 	return ret;
 }
 
+/*
+ * Makes the `babeltrace.trace-infos` query result of `trace` cacheable,
+ * adding its dependencies: the input directories, their metadata
+ * files, and the data stream files (of which the sizes change when
+ * they get more packets).
+ */
+static
+int add_trace_infos_result_deps(bt_private_query_executor *priv_query_exec,
+		const bt_value *inputs_value, const struct ctf_fs_trace *trace)
+{
+	int ret = 0;
+	guint i, j;
+
+	for (i = 0; i < bt_value_array_get_length(inputs_value); i++) {
+		const char *input = bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(
+				inputs_value, i));
+		gchar *metadata_path = g_build_filename(input,
+			CTF_FS_METADATA_FILENAME, NULL);
+
+		if (bt_private_query_executor_add_result_dependency_path(
+				priv_query_exec, input) ||
+				bt_private_query_executor_add_result_dependency_path(
+					priv_query_exec, metadata_path)) {
+			g_free(metadata_path);
+			ret = -1;
+			goto end;
+		}
+
+		g_free(metadata_path);
+	}
+
+	for (i = 0; i < trace->ds_file_groups->len; i++) {
+		const struct ctf_fs_ds_file_group *group =
+			g_ptr_array_index(trace->ds_file_groups, i);
+
+		for (j = 0; j < group->ds_file_infos->len; j++) {
+			const struct ctf_fs_ds_file_info *info =
+				g_ptr_array_index(group->ds_file_infos, j);
+
+			if (bt_private_query_executor_add_result_dependency_path(
+					priv_query_exec, info->path->str)) {
+				ret = -1;
+				goto end;
+			}
+		}
+	}
+
+	bt_private_query_executor_set_result_is_cacheable(priv_query_exec);
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 bt_component_class_query_method_status trace_infos_query(
 		bt_self_component_class_source *self_comp_class_src,
+		bt_private_query_executor *priv_query_exec,
 		const bt_value *params, bt_logging_level log_level,
 		const bt_value **user_result)
 {
@@ -354,6 +399,12 @@ bt_component_class_query_method_status trace_infos_query(
 		goto error;
 	}
 
+	/*
+	 * The stream ranges only need the first and last packets of each
+	 * stream: don't index all the data stream files of the trace.
+	 */
+	ctf_fs->lazy_index_loading = true;
+
 	if (ctf_fs_component_create_ctf_fs_trace(ctf_fs, inputs_value,
 			trace_name_value, NULL, self_comp_class)) {
 		goto error;
@@ -379,6 +430,12 @@ bt_component_class_query_method_status trace_infos_query(
 		goto error;
 	}
 
+	if (add_trace_infos_result_deps(priv_query_exec, inputs_value,
+			ctf_fs->trace)) {
+		status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -401,6 +458,7 @@ end:
 BT_HIDDEN
 bt_component_class_query_method_status support_info_query(
 		bt_self_component_class_source *comp_class,
+		bt_private_query_executor *priv_query_exec,
 		const bt_value *params, bt_logging_level log_level,
 		const bt_value **user_result)
 {
@@ -488,6 +546,19 @@ create_result:
 		goto end;
 	}
 
+	if (strcmp(input_type, "directory") != 0) {
+		/*
+		 * A CTF trace is always a directory: tell the querier
+		 * not to ask again for other inputs of this type.
+		 */
+		insert_entry_status = bt_value_map_insert_bool_entry(result,
+			"type-is-supported", BT_FALSE);
+		if (insert_entry_status != BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK) {
+			status = (int) insert_entry_status;
+			goto end;
+		}
+	}
+
 	/* We are not supposed to have weight == 0 and a UUID. */
 	BT_ASSERT(weight > 0 || !has_uuid);
 
@@ -499,6 +570,21 @@ create_result:
 		}
 	}
 
+	/*
+	 * The result only depends on the input type and, for a
+	 * directory, on the directory and its metadata file.
+	 */
+	if (metadata_path) {
+		if (bt_private_query_executor_add_result_dependency_path(
+				priv_query_exec, input) ||
+				bt_private_query_executor_add_result_dependency_path(
+					priv_query_exec, metadata_path)) {
+			status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+	}
+
+	bt_private_query_executor_set_result_is_cacheable(priv_query_exec);
 	*user_result = result;
 	result = NULL;
 	status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_OK;
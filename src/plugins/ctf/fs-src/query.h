@@ -21,12 +21,14 @@ bt_component_class_query_method_status metadata_info_query(
 BT_HIDDEN
 bt_component_class_query_method_status trace_infos_query(
 		bt_self_component_class_source *comp_class,
+		bt_private_query_executor *priv_query_exec,
 		const bt_value *params, bt_logging_level log_level,
 		const bt_value **result);
 
 BT_HIDDEN
 bt_component_class_query_method_status support_info_query(
 		bt_self_component_class_source *comp_class,
+		bt_private_query_executor *priv_query_exec,
 		const bt_value *params, bt_logging_level log_level,
 		const bt_value **result);
 
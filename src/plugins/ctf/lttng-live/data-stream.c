@@ -24,6 +24,7 @@
 #include "common/assert.h"
 #include "compat/mman.h"
 #include "data-stream.h"
+#include "metadata.h"
 
 #define STREAM_NAME_PREFIX	"stream-"
 
@@ -56,8 +57,19 @@ enum ctf_msg_iter_medium_status medop_request_bytes(
 		goto end;
 	}
 
-	read_len = MIN(request_sz, stream->buflen);
+	read_len = MIN(request_sz, live_msg_iter->lttng_live_comp->max_query_size);
 	read_len = MIN(read_len, len_left);
+
+	/*
+	 * Grow the buffer on demand: with many streams, most packets
+	 * are much smaller than the maximum request size.
+	 */
+	if (read_len > stream->buflen) {
+		g_free(stream->buf);
+		stream->buf = g_malloc(read_len);
+		stream->buflen = read_len;
+	}
+
 	status = lttng_live_get_stream_bytes(live_msg_iter,
 			stream, stream->buf, stream->offset,
 			read_len, &recv_len);
@@ -156,8 +168,8 @@ enum lttng_live_iterator_status lttng_live_lazy_msg_init(
 			if (stream_iter->msg_iter) {
 				continue;
 			}
-			ctf_tc = ctf_metadata_decoder_borrow_ctf_trace_class(
-				trace->metadata->decoder);
+			ctf_tc = lttng_live_metadata_borrow_ctf_trace_class(
+				trace);
 			BT_COMP_LOGD("Creating CTF message iterator: "
 				"session-id=%"PRIu64", ctf-tc-addr=%p, "
 				"stream-iter-name=%s, self-msg-iter-addr=%p",
@@ -226,8 +238,7 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 
 	if (trace->trace) {
 		struct ctf_trace_class *ctf_tc =
-			ctf_metadata_decoder_borrow_ctf_trace_class(
-				trace->metadata->decoder);
+			lttng_live_metadata_borrow_ctf_trace_class(trace);
 		BT_ASSERT(!stream_iter->msg_iter);
 		stream_iter->msg_iter = ctf_msg_iter_create(ctf_tc,
 			lttng_live->max_query_size, medops, stream_iter,
@@ -238,14 +249,6 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 			goto error;
 		}
 	}
-	stream_iter->buf = g_new0(uint8_t, lttng_live->max_query_size);
-	if (!stream_iter->buf) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-			"Failed to allocate live stream iterator buffer");
-		goto error;
-	}
-
-	stream_iter->buflen = lttng_live->max_query_size;
 	stream_iter->name = g_string_new(NULL);
 	if (!stream_iter->name) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
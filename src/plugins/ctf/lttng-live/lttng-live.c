@@ -35,9 +35,14 @@
 #define URL_PARAM			    "url"
 #define INPUTS_PARAM			    "inputs"
 #define SESS_NOT_FOUND_ACTION_PARAM	    "session-not-found-action"
+#define DATA_BUFFER_SIZE_PARAM		    "data-buffer-size"
+#define SHARE_TRACE_CLASSES_PARAM	    "share-trace-classes"
+#define SEEK_PARAM			    "seek"
 #define SESS_NOT_FOUND_ACTION_CONTINUE_STR  "continue"
 #define SESS_NOT_FOUND_ACTION_FAIL_STR	    "fail"
 #define SESS_NOT_FOUND_ACTION_END_STR	    "end"
+#define SEEK_BEGINNING_STR		    "beginning"
+#define SEEK_LAST_STR			    "last"
 
 #define print_dbg(fmt, ...)	BT_COMP_LOGD(fmt, ## __VA_ARGS__)
 
@@ -132,6 +137,31 @@ end:
 	return ret_trace;
 }
 
+/*
+ * Heap comparison function: returns whether or not the current message
+ * of the live stream iterator `a` must go before the current message of
+ * the live stream iterator `b`.
+ *
+ * When both current messages have the same timestamp, this function
+ * orders them in an arbitrary but deterministic way with
+ * common_muxing_compare_messages().
+ */
+static
+int stream_iter_gt(void *a, void *b)
+{
+	const struct lttng_live_stream_iterator *stream_iter_a = a;
+	const struct lttng_live_stream_iterator *stream_iter_b = b;
+
+	if (stream_iter_a->current_msg_ts_ns !=
+			stream_iter_b->current_msg_ts_ns) {
+		return stream_iter_a->current_msg_ts_ns <
+			stream_iter_b->current_msg_ts_ns;
+	}
+
+	return common_muxing_compare_messages(stream_iter_a->current_msg,
+		stream_iter_b->current_msg) < 0;
+}
+
 static
 void lttng_live_destroy_trace(struct lttng_live_trace *trace)
 {
@@ -141,6 +171,7 @@ void lttng_live_destroy_trace(struct lttng_live_trace *trace)
 	BT_COMP_LOGD("Destroying live trace: trace-id=%"PRIu64, trace->id);
 
 	BT_ASSERT(trace->stream_iterators);
+	bt_heap_free(&trace->stream_iter_heap);
 	g_ptr_array_free(trace->stream_iterators, TRUE);
 
 	BT_TRACE_PUT_REF_AND_RESET(trace->trace);
@@ -176,6 +207,14 @@ struct lttng_live_trace *lttng_live_create_trace(struct lttng_live_session *sess
 	trace->stream_iterators = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) lttng_live_stream_iterator_destroy);
 	BT_ASSERT(trace->stream_iterators);
+
+	if (bt_heap_init(&trace->stream_iter_heap, 0, stream_iter_gt)) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to initialize a priority heap.");
+		g_ptr_array_free(trace->stream_iterators, TRUE);
+		goto error;
+	}
+
 	trace->metadata_stream_state = LTTNG_LIVE_METADATA_STREAM_STATE_NEEDED;
 	g_ptr_array_add(session->traces, trace);
 
@@ -232,6 +271,8 @@ int lttng_live_add_session(struct lttng_live_msg_iter *lttng_live_msg_iter,
 	session->traces = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) lttng_live_destroy_trace);
 	BT_ASSERT(session->traces);
+	session->shared_metadata = g_ptr_array_new();
+	BT_ASSERT(session->shared_metadata);
 	session->lttng_live_msg_iter = lttng_live_msg_iter;
 	session->new_streams_needed = true;
 	session->hostname = g_string_new(hostname);
@@ -280,6 +321,12 @@ void lttng_live_destroy_session(struct lttng_live_session *session)
 		g_ptr_array_free(session->traces, TRUE);
 	}
 
+	if (session->shared_metadata) {
+		/* Destroying the traces emptied it */
+		BT_ASSERT(session->shared_metadata->len == 0);
+		g_ptr_array_free(session->shared_metadata, TRUE);
+	}
+
 	if (session->hostname) {
 		g_string_free(session->hostname, TRUE);
 	}
@@ -356,6 +403,56 @@ enum lttng_live_iterator_status lttng_live_iterator_next_check_stream_state(
 	return LTTNG_LIVE_ITERATOR_STATUS_OK;
 }
 
+/*
+ * Minimum and maximum delays (µs) between two
+ * `LTTNG_VIEWER_GET_NEXT_INDEX` commands for an idle stream.
+ *
+ * The Relay Daemon only gets new data or inactivity for a stream when
+ * the live timer of the tracer fires (every second by default), so
+ * polling an idle stream more often is mostly wasted round trips.
+ */
+#define POLL_BACKOFF_MIN_US	(G_USEC_PER_SEC / 100)
+#define POLL_BACKOFF_MAX_US	G_USEC_PER_SEC
+
+/*
+ * Returns whether or not it's too early to send a
+ * `LTTNG_VIEWER_GET_NEXT_INDEX` command for the stream `stream_iter`
+ * again (see `next_poll_time` in `struct lttng_live_stream_iterator`).
+ */
+static inline
+bool stream_poll_is_backed_off(
+		struct lttng_live_stream_iterator *stream_iter)
+{
+	return stream_iter->poll_backoff > 0 &&
+		g_get_monotonic_time() < stream_iter->next_poll_time;
+}
+
+/*
+ * Updates the polling backoff of `stream_iter` after a
+ * `LTTNG_VIEWER_GET_NEXT_INDEX` command, depending on whether or not
+ * the Relay Daemon gave something new.
+ */
+static inline
+void update_stream_poll_backoff(
+		struct lttng_live_stream_iterator *stream_iter, bool got_new)
+{
+	if (got_new) {
+		stream_iter->poll_backoff = 0;
+		stream_iter->next_poll_time = 0;
+		return;
+	}
+
+	if (stream_iter->poll_backoff == 0) {
+		stream_iter->poll_backoff = POLL_BACKOFF_MIN_US;
+	} else {
+		stream_iter->poll_backoff = MIN(stream_iter->poll_backoff * 2,
+			POLL_BACKOFF_MAX_US);
+	}
+
+	stream_iter->next_poll_time = g_get_monotonic_time() +
+		stream_iter->poll_backoff;
+}
+
 /*
  * For active no data stream, fetch next data. It can be either:
  * - quiescent: need to put it in the prio heap at quiescent end
@@ -388,8 +485,22 @@ enum lttng_live_iterator_status lttng_live_iterator_next_handle_one_no_data_stre
 			lttng_live_stream->state != LTTNG_LIVE_STREAM_QUIESCENT_NO_DATA) {
 		goto end;
 	}
+	if (!lttng_live_stream->has_prefetched_index &&
+			stream_poll_is_backed_off(lttng_live_stream)) {
+		BT_COMP_LOGD("Not polling idle stream yet: "
+			"stream-name=\"%s\", backoff-us=%" PRId64,
+			lttng_live_stream->name->str,
+			lttng_live_stream->poll_backoff);
+		ret = LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
+		goto end;
+	}
 	ret = lttng_live_get_next_index(lttng_live_msg_iter, lttng_live_stream,
 		&index);
+	if (ret == LTTNG_LIVE_ITERATOR_STATUS_AGAIN) {
+		/* `LTTNG_VIEWER_INDEX_RETRY`, or interrupted */
+		update_stream_poll_backoff(lttng_live_stream, false);
+		goto end;
+	}
 	if (ret != LTTNG_LIVE_ITERATOR_STATUS_OK) {
 		goto end;
 	}
@@ -402,11 +513,14 @@ enum lttng_live_iterator_status lttng_live_iterator_next_handle_one_no_data_stre
 				last_inact_ts == curr_inact_ts) {
 			ret = LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
 			LTTNG_LIVE_LOGD_STREAM_ITER(lttng_live_stream);
+			update_stream_poll_backoff(lttng_live_stream, false);
 		} else {
 			ret = LTTNG_LIVE_ITERATOR_STATUS_CONTINUE;
+			update_stream_poll_backoff(lttng_live_stream, true);
 		}
 		goto end;
 	}
+	update_stream_poll_backoff(lttng_live_stream, true);
 	lttng_live_stream->base_offset = index.offset;
 	lttng_live_stream->offset = index.offset;
 	lttng_live_stream->len = index.packet_size / CHAR_BIT;
@@ -467,6 +581,12 @@ enum lttng_live_iterator_status lttng_live_get_session(
 			status != LTTNG_LIVE_ITERATOR_STATUS_END) {
 		goto end;
 	}
+
+	status = lttng_live_prefetch_metadata_packets(session);
+	if (status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
+		goto end;
+	}
+
 	trace_idx = 0;
 	while (trace_idx < session->traces->len) {
 		struct lttng_live_trace *trace =
@@ -981,6 +1101,71 @@ end:
 	return live_status;
 }
 
+/*
+ * Maximum number of `LTTNG_VIEWER_GET_NEXT_INDEX` commands to have in
+ * flight at once: the Relay Daemon doesn't read the next commands while
+ * it can't write a reply, so the replies must fit in the socket
+ * buffers.
+ */
+#define PREFETCH_NEXT_INDEXES_MAX_COUNT	64
+
+/*
+ * Sends the `LTTNG_VIEWER_GET_NEXT_INDEX` commands of all the streams
+ * of `live_trace` which need a new index at once instead of one round
+ * trip per stream.
+ */
+static
+enum lttng_live_iterator_status prefetch_trace_next_indexes(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_trace *live_trace)
+{
+	enum lttng_live_iterator_status status = LTTNG_LIVE_ITERATOR_STATUS_OK;
+	struct lttng_live_stream_iterator *streams[PREFETCH_NEXT_INDEXES_MAX_COUNT];
+	guint count = 0;
+	guint i;
+
+	if (live_trace->metadata_stream_state ==
+			LTTNG_LIVE_METADATA_STREAM_STATE_NEEDED ||
+			live_trace->session->new_streams_needed) {
+		goto end;
+	}
+
+	for (i = 0; i < live_trace->stream_iterators->len; i++) {
+		struct lttng_live_stream_iterator *stream_iter =
+			g_ptr_array_index(live_trace->stream_iterators, i);
+
+		if (stream_iter->current_msg ||
+				stream_iter->has_prefetched_index) {
+			continue;
+		}
+
+		if (stream_iter->state != LTTNG_LIVE_STREAM_ACTIVE_NO_DATA &&
+				stream_iter->state != LTTNG_LIVE_STREAM_QUIESCENT_NO_DATA) {
+			continue;
+		}
+
+		if (stream_poll_is_backed_off(stream_iter)) {
+			continue;
+		}
+
+		streams[count] = stream_iter;
+		count++;
+
+		if (count == PREFETCH_NEXT_INDEXES_MAX_COUNT) {
+			break;
+		}
+	}
+
+	/* A single stream needs a single round trip anyway */
+	if (count >= 2) {
+		status = lttng_live_prefetch_next_indexes(lttng_live_msg_iter,
+			streams, count);
+	}
+
+end:
+	return status;
+}
+
 static
 enum lttng_live_iterator_status next_stream_iterator_for_trace(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
@@ -991,7 +1176,6 @@ enum lttng_live_iterator_status next_stream_iterator_for_trace(
 	bt_logging_level log_level = lttng_live_msg_iter->log_level;
 	bt_self_component *self_comp = lttng_live_msg_iter->self_comp;
 	enum lttng_live_iterator_status stream_iter_status;;
-	int64_t youngest_candidate_msg_ts = INT64_MAX;
 	uint64_t stream_iter_idx;
 
 	BT_ASSERT_DBG(live_trace);
@@ -999,6 +1183,13 @@ enum lttng_live_iterator_status next_stream_iterator_for_trace(
 
 	BT_COMP_LOGD("Finding the next stream iterator for trace: "
 		"trace-id=%"PRIu64, live_trace->id);
+
+	stream_iter_status = prefetch_trace_next_indexes(lttng_live_msg_iter,
+		live_trace);
+	if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
+		goto end;
+	}
+
 	/*
 	 * Update the current message of every stream iterators of this trace.
 	 * The current msg of every stream must have a timestamp equal or
@@ -1052,6 +1243,15 @@ enum lttng_live_iterator_status next_stream_iterator_for_trace(
 			if (curr_msg_ts_ns >= lttng_live_msg_iter->last_msg_ts_ns) {
 				stream_iter->current_msg = msg;
 				stream_iter->current_msg_ts_ns = curr_msg_ts_ns;
+
+				if (bt_heap_insert(&live_trace->stream_iter_heap,
+						stream_iter)) {
+					BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+						"Failed to insert live stream iterator into priority heap: "
+						"stream-iter-addr=%p", stream_iter);
+					stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
+					goto end;
+				}
 			} else {
 				/*
 				 * We received a message in the past. To ensure
@@ -1070,48 +1270,7 @@ enum lttng_live_iterator_status next_stream_iterator_for_trace(
 			}
 		}
 
-		BT_ASSERT_DBG(stream_iter != youngest_candidate_stream_iter);
-
 		if (!stream_iter_is_ended) {
-			if (G_UNLIKELY(youngest_candidate_stream_iter == NULL) ||
-					stream_iter->current_msg_ts_ns < youngest_candidate_msg_ts) {
-				/*
-				 * Update the current best candidate message
-				 * for the stream iterator of this live trace
-				 * to be forwarded downstream.
-				 */
-				youngest_candidate_msg_ts = stream_iter->current_msg_ts_ns;
-				youngest_candidate_stream_iter = stream_iter;
-			} else if (stream_iter->current_msg_ts_ns == youngest_candidate_msg_ts) {
-				/*
-				 * Order the messages in an arbitrary but
-				 * deterministic way.
-				 */
-				BT_ASSERT_DBG(stream_iter != youngest_candidate_stream_iter);
-				int ret = common_muxing_compare_messages(
-					stream_iter->current_msg,
-					youngest_candidate_stream_iter->current_msg);
-				if (ret < 0) {
-					/*
-					 * The `youngest_candidate_stream_iter->current_msg`
-					 * should go first. Update the next
-					 * iterator and the current timestamp.
-					 */
-					youngest_candidate_msg_ts = stream_iter->current_msg_ts_ns;
-					youngest_candidate_stream_iter = stream_iter;
-				} else if (ret == 0) {
-					/*
-					 * Unable to pick which one should go
-					 * first.
-					 */
-					BT_COMP_LOGW("Cannot deterministically pick next live stream message iterator because they have identical next messages: "
-						"stream-iter-addr=%p"
-						"stream-iter-addr=%p",
-						stream_iter,
-						youngest_candidate_stream_iter);
-				}
-			}
-
 			stream_iter_idx++;
 		} else {
 			/*
@@ -1129,6 +1288,12 @@ enum lttng_live_iterator_status next_stream_iterator_for_trace(
 		}
 	}
 
+	/* All the stream iterators now have a current message */
+	BT_ASSERT_DBG(live_trace->stream_iter_heap.len ==
+		live_trace->stream_iterators->len);
+	youngest_candidate_stream_iter =
+		bt_heap_maximum(&live_trace->stream_iter_heap);
+
 	if (youngest_candidate_stream_iter) {
 		*youngest_trace_stream_iter = youngest_candidate_stream_iter;
 		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_OK;
@@ -1450,6 +1615,22 @@ bt_message_iterator_class_next_method_status lttng_live_msg_iter_next(
 		BT_ASSERT_DBG(lttng_live_msg_iter->last_msg_ts_ns <=
 			youngest_stream_iter->current_msg_ts_ns);
 
+		if (*count > 0 &&
+				bt_message_get_type(msgs[*count - 1]) ==
+					BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY &&
+				bt_message_get_type(youngest_stream_iter->current_msg) ==
+					BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY) {
+			/*
+			 * Coalesce consecutive inactivity messages: the
+			 * next one, which can't be older, means that there's
+			 * no message before its time, including the time of
+			 * the previous one. This avoids sending one
+			 * inactivity message per idle stream downstream.
+			 */
+			(*count)--;
+			BT_MESSAGE_PUT_REF_AND_RESET(msgs[*count]);
+		}
+
 		/*
 		 * Insert the next message to the message batch. This will set
 		 * stream iterator current messsage to NULL so that next time
@@ -1458,6 +1639,15 @@ bt_message_iterator_class_next_method_status lttng_live_msg_iter_next(
 		BT_MESSAGE_MOVE_REF(msgs[*count], youngest_stream_iter->current_msg);
 		(*count)++;
 
+		/*
+		 * The stream iterator was the youngest of its trace: it's at
+		 * the top of the priority heap of its trace.
+		 */
+		BT_ASSERT_DBG(bt_heap_maximum(
+			&youngest_stream_iter->trace->stream_iter_heap) ==
+			youngest_stream_iter);
+		(void) bt_heap_remove(&youngest_stream_iter->trace->stream_iter_heap);
+
 		/* Update the last timestamp in nanoseconds sent downstream. */
 		lttng_live_msg_iter->last_msg_ts_ns = youngest_msg_ts_ns;
 		youngest_stream_iter->current_msg_ts_ns = INT64_MAX;
@@ -1761,8 +1951,28 @@ bt_component_class_query_method_status lttng_live_query_support_info(
 	}
 
 	if (strcmp(bt_value_string_get(input_type_value), "string") != 0) {
-		/* We don't handle file system paths */
-		goto create_result;
+		bt_value *map_result;
+
+		/*
+		 * We don't handle file system paths: tell the querier not
+		 * to ask again for other paths.
+		 */
+		map_result = bt_value_map_create();
+		if (!map_result) {
+			status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+
+		if (bt_value_map_insert_real_entry(map_result, "weight", 0) ||
+				bt_value_map_insert_bool_entry(map_result,
+					"type-is-supported", BT_FALSE)) {
+			bt_value_put_ref(map_result);
+			status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+
+		*result = map_result;
+		goto end;
 	}
 
 	input_value = bt_value_map_borrow_entry_value_const(params, "input");
@@ -1788,7 +1998,6 @@ bt_component_class_query_method_status lttng_live_query_support_info(
 		weight = .75;
 	}
 
-create_result:
 	*result = bt_value_real_create_init(weight);
 	if (!*result) {
 		status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
@@ -1895,6 +2104,12 @@ static const char *sess_not_found_action_choices[] = {
 	SESS_NOT_FOUND_ACTION_END_STR,
 };
 
+static const char *seek_choices[] = {
+	SEEK_BEGINNING_STR,
+	SEEK_LAST_STR,
+	NULL,
+};
+
 static struct bt_param_validation_map_value_entry_descr params_descr[] = {
 	{ INPUTS_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { BT_VALUE_TYPE_ARRAY, .array = {
 		.min_length = 1,
@@ -1904,6 +2119,11 @@ static struct bt_param_validation_map_value_entry_descr params_descr[] = {
 	{ SESS_NOT_FOUND_ACTION_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
 		.choices = sess_not_found_action_choices,
 	} } },
+	{ DATA_BUFFER_SIZE_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ SHARE_TRACE_CLASSES_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ SEEK_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
+		.choices = seek_choices,
+	} } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -1970,6 +2190,39 @@ bt_component_class_initialize_method_status lttng_live_component_create(
 			SESSION_NOT_FOUND_ACTION_CONTINUE;
 	}
 
+	lttng_live->params.seek = LTTNG_VIEWER_SEEK_LAST;
+	value = bt_value_map_borrow_entry_value_const(params, SEEK_PARAM);
+	if (value && strcmp(bt_value_string_get(value),
+			SEEK_BEGINNING_STR) == 0) {
+		lttng_live->params.seek = LTTNG_VIEWER_SEEK_BEGINNING;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		DATA_BUFFER_SIZE_PARAM);
+	if (value) {
+		uint64_t size = bt_value_integer_unsigned_get(value);
+
+		/*
+		 * The length of a `LTTNG_VIEWER_GET_PACKET` request is
+		 * a 32-bit field.
+		 */
+		if (size == 0 || size > UINT32_MAX) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Invalid `%s` parameter: value is out of range: "
+				"value=%" PRIu64, DATA_BUFFER_SIZE_PARAM, size);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto error;
+		}
+
+		lttng_live->max_query_size = (size_t) size;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		SHARE_TRACE_CLASSES_PARAM);
+	if (value) {
+		lttng_live->share_trace_classes = bt_value_bool_get(value);
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 	goto end;
 
@@ -22,6 +22,8 @@
 #include "../common/metadata/decoder.h"
 #include "../common/msg-iter/msg-iter.h"
 #include "viewer-connection.h"
+#include "lttng-viewer-abi.h"
+#include "lib/prio-heap/prio-heap.h"
 
 struct lttng_live_component;
 struct lttng_live_session;
@@ -97,7 +99,12 @@ struct lttng_live_stream_iterator {
 	/* Timestamp in nanoseconds of the current message (current_msg). */
 	int64_t current_msg_ts_ns;
 
-	/* Owned by this. */
+	/*
+	 * Owned by this.
+	 *
+	 * Allocated and grown on demand, up to the component's
+	 * `max_query_size`, by the medium's "request bytes" operation.
+	 */
 	uint8_t *buf;
 	size_t buflen;
 
@@ -105,6 +112,53 @@ struct lttng_live_stream_iterator {
 	GString *name;
 
 	bool has_stream_hung_up;
+
+	/*
+	 * Reply to a pipelined `LTTNG_VIEWER_GET_NEXT_INDEX` command
+	 * (see lttng_live_prefetch_next_indexes()) which the next
+	 * lttng_live_get_next_index() call for this stream uses instead
+	 * of sending a command, if `has_prefetched_index` is true.
+	 */
+	struct lttng_viewer_index prefetched_index;
+	bool has_prefetched_index;
+
+	/*
+	 * Polling backoff of an idle stream: after a
+	 * `LTTNG_VIEWER_GET_NEXT_INDEX` command which gives no new
+	 * data nor inactivity (monotonic time, µs), the component
+	 * doesn't send this command again for this stream before
+	 * `next_poll_time`.
+	 *
+	 * `poll_backoff` is the current delay (µs), doubling with each
+	 * consecutive unfruitful command, or 0 if the last command
+	 * gave something new.
+	 */
+	int64_t next_poll_time;
+	int64_t poll_backoff;
+};
+
+/*
+ * Metadata decoder, and therefore CTF IR and trace IR trace classes,
+ * which one or more traces of a session use.
+ */
+struct lttng_live_shared_metadata {
+	/* Owned by this. */
+	struct ctf_metadata_decoder *decoder;
+
+	/*
+	 * Metadata text which was successfully appended to `decoder`
+	 * so far, or `NULL` if other traces may not use this (the
+	 * `share-trace-classes` parameter is false).
+	 *
+	 * The metadata text which each trace using this received so far
+	 * is a prefix of this.
+	 *
+	 * Owned by this.
+	 */
+	GByteArray *content;
+
+	/* Number of traces using this. */
+	unsigned int ref_count;
 };
 
 struct lttng_live_metadata {
@@ -112,8 +166,34 @@ struct lttng_live_metadata {
 	bt_self_component *self_comp;
 
 	uint64_t stream_id;
-	/* Weak reference. */
-	struct ctf_metadata_decoder *decoder;
+
+	/*
+	 * Metadata decoder of this trace, possibly used by other traces,
+	 * or `NULL` if none yet.
+	 *
+	 * Shared with other traces.
+	 */
+	struct lttng_live_shared_metadata *shared;
+
+	/*
+	 * Length of the metadata text of this trace which was
+	 * successfully decoded so far.
+	 */
+	uint64_t len;
+
+	/*
+	 * Reply to a pipelined `LTTNG_VIEWER_GET_METADATA` command (see
+	 * lttng_live_prefetch_metadata_packets()) which the next
+	 * lttng_live_get_one_metadata_packet() call for this trace uses
+	 * instead of sending a command, if `has_prefetched_packet` is
+	 * true.
+	 */
+	bool has_prefetched_packet;
+	enum lttng_live_get_one_metadata_status prefetched_packet_status;
+
+	/* Owned by this */
+	gchar *prefetched_packet_data;
+	uint64_t prefetched_packet_len;
 };
 
 enum lttng_live_metadata_stream_state {
@@ -161,6 +241,13 @@ struct lttng_live_trace {
 	/* Owned by this. */
 	GPtrArray *stream_iterators;
 
+	/*
+	 * Priority heap of struct lttng_live_stream_iterator * (weak),
+	 * the ones of `stream_iterators` which have a current message,
+	 * the oldest current message first (see stream_iter_gt()).
+	 */
+	struct ptr_heap stream_iter_heap;
+
 	enum lttng_live_metadata_stream_state metadata_stream_state;
 };
 
@@ -182,6 +269,12 @@ struct lttng_live_session {
 	/* Array of pointers to struct lttng_live_trace. */
 	GPtrArray *traces;
 
+	/*
+	 * Array of pointers to struct lttng_live_shared_metadata (weak)
+	 * which other traces may use (`share-trace-classes` parameter).
+	 */
+	GPtrArray *shared_metadata;
+
 	bool attached;
 	bool new_streams_needed;
 	bool lazy_stream_msg_init;
@@ -206,10 +299,28 @@ struct lttng_live_component {
 	struct {
 		GString *url;
 		enum session_not_found_action sess_not_found_act;
+
+		/*
+		 * Where to start receiving the packets of each stream
+		 * when attaching to a session (`seek` parameter).
+		 */
+		enum lttng_viewer_seek seek;
 	} params;
 
+	/*
+	 * Maximum size (bytes) of a `LTTNG_VIEWER_GET_PACKET` request
+	 * and of the data buffer of a stream iterator
+	 * (`data-buffer-size` parameter).
+	 */
 	size_t max_query_size;
 
+	/*
+	 * Whether or not the traces of a session which receive the same
+	 * metadata share their trace classes (`share-trace-classes`
+	 * parameter).
+	 */
+	bool share_trace_classes;
+
 	/*
 	 * Keeps track of whether the downstream component already has a
 	 * message iterator on this component.
@@ -316,11 +427,35 @@ int lttng_live_add_session(struct lttng_live_msg_iter *lttng_live_msg_iter,
 enum lttng_live_get_one_metadata_status lttng_live_get_one_metadata_packet(
 		struct lttng_live_trace *trace, FILE *fp, size_t *reply_len);
 
+/*
+ * lttng_live_prefetch_metadata_packets() sends the
+ * `LTTNG_VIEWER_GET_METADATA` commands of all the traces of `session`
+ * which need a metadata update at once, and then receives all their
+ * replies, so that updating the metadata of many traces costs a single
+ * round trip to the Relay Daemon. The replies are kept in the traces
+ * until the next lttng_live_get_one_metadata_packet() call for each of
+ * them.
+ */
+enum lttng_live_iterator_status lttng_live_prefetch_metadata_packets(
+		struct lttng_live_session *session);
+
 enum lttng_live_iterator_status lttng_live_get_next_index(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
 		struct lttng_live_stream_iterator *stream,
 		struct packet_index *index);
 
+/*
+ * lttng_live_prefetch_next_indexes() sends the
+ * `LTTNG_VIEWER_GET_NEXT_INDEX` commands of the `count` streams of
+ * `streams` at once, and then receives all their replies, so that
+ * getting the next index of many streams costs a single round trip
+ * to the Relay Daemon. The replies are kept in the streams until the
+ * next lttng_live_get_next_index() call for each of them.
+ */
+enum lttng_live_iterator_status lttng_live_prefetch_next_indexes(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator **streams, guint count);
+
 enum ctf_msg_iter_medium_status lttng_live_get_stream_bytes(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
 		struct lttng_live_stream_iterator *stream, uint8_t *buf,
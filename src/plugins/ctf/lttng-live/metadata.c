@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <glib.h>
 #include "compat/memstream.h"
 #include <babeltrace2/babeltrace.h>
@@ -97,6 +98,262 @@ end:
 	return cc;
 }
 
+static
+struct lttng_live_shared_metadata *shared_metadata_create(
+		struct lttng_live_session *session, bool shareable)
+{
+	bt_self_component *self_comp = session->self_comp;
+	bt_logging_level log_level = session->log_level;
+	struct lttng_live_shared_metadata *shared;
+	struct ctf_metadata_decoder_config cfg = {
+		.log_level = session->log_level,
+		.self_comp = session->self_comp,
+		.clock_class_offset_s = 0,
+		.clock_class_offset_ns = 0,
+		.create_trace_class = true,
+	};
+
+	shared = g_new0(struct lttng_live_shared_metadata, 1);
+	if (!shared) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a shared metadata decoder.");
+		goto error;
+	}
+
+	shared->decoder = ctf_metadata_decoder_create(&cfg);
+	if (!shared->decoder) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to create CTF metadata decoder");
+		goto error;
+	}
+
+	if (shareable) {
+		shared->content = g_byte_array_new();
+		if (!shared->content) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to allocate a GByteArray.");
+			goto error;
+		}
+
+		g_ptr_array_add(session->shared_metadata, shared);
+	}
+
+	shared->ref_count = 1;
+	goto end;
+
+error:
+	if (shared) {
+		ctf_metadata_decoder_destroy(shared->decoder);
+		g_free(shared);
+		shared = NULL;
+	}
+
+end:
+	return shared;
+}
+
+static
+void shared_metadata_put(struct lttng_live_session *session,
+		struct lttng_live_shared_metadata *shared)
+{
+	if (!shared) {
+		return;
+	}
+
+	BT_ASSERT(shared->ref_count > 0);
+	shared->ref_count--;
+	if (shared->ref_count > 0) {
+		return;
+	}
+
+	if (shared->content) {
+		g_ptr_array_remove_fast(session->shared_metadata, shared);
+		g_byte_array_free(shared->content, TRUE);
+	}
+
+	ctf_metadata_decoder_destroy(shared->decoder);
+	g_free(shared);
+}
+
+/*
+ * Returns whether or not the metadata text of `shared`, from `offset`,
+ * starts with `buf`.
+ */
+static
+bool shared_metadata_has_content(struct lttng_live_shared_metadata *shared,
+		uint64_t offset, const char *buf, size_t len)
+{
+	BT_ASSERT_DBG(shared->content);
+	return offset + len <= shared->content->len &&
+		memcmp(shared->content->data + offset, buf, len) == 0;
+}
+
+/*
+ * Appends the metadata text `buf` to the metadata decoder `decoder`,
+ * setting `*decoder_status` to the status of the decoder on success.
+ */
+static
+enum lttng_live_iterator_status decode_metadata(
+		struct lttng_live_trace *trace,
+		struct ctf_metadata_decoder *decoder, const char *buf,
+		size_t len, enum ctf_metadata_decoder_status *decoder_status)
+{
+	struct lttng_live_session *session = trace->session;
+	bt_logging_level log_level = trace->log_level;
+	bt_self_component *self_comp = trace->self_comp;
+	enum lttng_live_iterator_status status =
+		LTTNG_LIVE_ITERATOR_STATUS_OK;
+	FILE *fp;
+
+	/*
+	 * Open a new reading file handle on `buf` and pass it to the
+	 * metadata decoder.
+	 */
+	fp = bt_fmemopen((void *) buf, len, "rb");
+	if (!fp) {
+		if (errno == EINTR &&
+				lttng_live_graph_is_canceled(session->lttng_live_msg_iter)) {
+			session->lttng_live_msg_iter->was_interrupted = true;
+			status = LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
+		} else {
+			BT_COMP_LOGE_APPEND_CAUSE_ERRNO(self_comp,
+				"Cannot memory-open metadata buffer", ".");
+			status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
+		}
+		goto end;
+	}
+
+	/*
+	 * The call to ctf_metadata_decoder_append_content() will append
+	 * new metadata to our current trace class.
+	 */
+	BT_COMP_LOGD("Appending new metadata to the ctf_trace class");
+	*decoder_status = ctf_metadata_decoder_append_content(decoder, fp);
+
+	if (fclose(fp)) {
+		BT_COMP_LOGW_ERRNO("Error on fclose", ".");
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Makes the metadata decoder of `trace` decode the new metadata text
+ * `buf` of `trace`.
+ *
+ * With the `share-trace-classes` parameter, the traces of a session
+ * which receive the same metadata text use the same decoder: for a
+ * given decoder, only the first trace which receives some metadata
+ * text decodes it.
+ */
+static
+enum lttng_live_iterator_status append_metadata(
+		struct lttng_live_trace *trace, const char *buf, size_t len,
+		enum ctf_metadata_decoder_status *decoder_status)
+{
+	struct lttng_live_session *session = trace->session;
+	struct lttng_live_metadata *metadata = trace->metadata;
+	struct lttng_live_shared_metadata *shared = metadata->shared;
+	bt_logging_level log_level = trace->log_level;
+	bt_self_component *self_comp = trace->self_comp;
+	enum lttng_live_iterator_status status =
+		LTTNG_LIVE_ITERATOR_STATUS_OK;
+	guint i;
+
+	if (shared && !shared->content) {
+		/* Not shared */
+		status = decode_metadata(trace, shared->decoder, buf, len,
+			decoder_status);
+		goto end;
+	}
+
+	if (shared) {
+		if (shared_metadata_has_content(shared, metadata->len,
+				buf, len)) {
+			/*
+			 * Another trace using the same decoder already
+			 * received and decoded this metadata text.
+			 */
+			BT_COMP_LOGD("Metadata text is already decoded by a shared decoder: "
+				"trace-id=%" PRIu64 ", offset=%" PRIu64
+				", len=%zu", trace->id, metadata->len, len);
+			metadata->len += len;
+			*decoder_status = CTF_METADATA_DECODER_STATUS_OK;
+			goto end;
+		}
+
+		if (metadata->len != shared->content->len) {
+			/*
+			 * The streams of this trace already belong to
+			 * the trace class of this decoder, which
+			 * already contains the different classes of
+			 * another trace.
+			 */
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Metadata of trace diverges from the metadata of the other traces sharing its trace class: "
+				"trace-id=%" PRIu64 ", offset=%" PRIu64,
+				trace->id, metadata->len);
+			status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		/* This trace is the first one to receive this text */
+		status = decode_metadata(trace, shared->decoder, buf, len,
+			decoder_status);
+		if (status == LTTNG_LIVE_ITERATOR_STATUS_OK &&
+				*decoder_status == CTF_METADATA_DECODER_STATUS_OK) {
+			g_byte_array_append(shared->content,
+				(const guint8 *) buf, len);
+			metadata->len += len;
+		}
+
+		goto end;
+	}
+
+	/*
+	 * First metadata text of this trace: look for a decoder which
+	 * already decoded it.
+	 */
+	BT_ASSERT(metadata->len == 0);
+
+	for (i = 0; i < session->shared_metadata->len; i++) {
+		struct lttng_live_shared_metadata *other =
+			g_ptr_array_index(session->shared_metadata, i);
+
+		if (shared_metadata_has_content(other, 0, buf, len)) {
+			BT_COMP_LOGD("Sharing the trace class of another trace: "
+				"trace-id=%" PRIu64, trace->id);
+			other->ref_count++;
+			metadata->shared = other;
+			metadata->len = len;
+			*decoder_status = CTF_METADATA_DECODER_STATUS_OK;
+			goto end;
+		}
+	}
+
+	shared = shared_metadata_create(session, true);
+	if (!shared) {
+		status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	status = decode_metadata(trace, shared->decoder, buf, len,
+		decoder_status);
+	if (status != LTTNG_LIVE_ITERATOR_STATUS_OK ||
+			*decoder_status != CTF_METADATA_DECODER_STATUS_OK) {
+		shared_metadata_put(session, shared);
+		goto end;
+	}
+
+	g_byte_array_append(shared->content, (const guint8 *) buf, len);
+	metadata->shared = shared;
+	metadata->len = len;
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 enum lttng_live_iterator_status lttng_live_metadata_update(
 		struct lttng_live_trace *trace)
@@ -216,41 +473,22 @@ enum lttng_live_iterator_status lttng_live_metadata_update(
 		goto end;
 	}
 
-	/*
-	 * Open a new reading file handle on the `metadata_buf` and pass it to
-	 * the metadata decoder.
-	 */
-	fp = bt_fmemopen(metadata_buf, len_read, "rb");
-	if (!fp) {
-		if (errno == EINTR &&
-				lttng_live_graph_is_canceled(session->lttng_live_msg_iter)) {
-			session->lttng_live_msg_iter->was_interrupted = true;
-			status = LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
-		} else {
-			BT_COMP_LOGE_APPEND_CAUSE_ERRNO(self_comp,
-				"Cannot memory-open metadata buffer", ".");
-			status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
-		}
+	status = append_metadata(trace, metadata_buf, len_read,
+		&decoder_status);
+	if (status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
 		goto end;
 	}
 
-	/*
-	 * The call to ctf_metadata_decoder_append_content() will append
-	 * new metadata to our current trace class.
-	 */
-	BT_COMP_LOGD("Appending new metadata to the ctf_trace class");
-	decoder_status = ctf_metadata_decoder_append_content(
-		metadata->decoder, fp);
 	switch (decoder_status) {
 	case CTF_METADATA_DECODER_STATUS_OK:
 		if (!trace->trace_class) {
 			struct ctf_trace_class *tc =
 				ctf_metadata_decoder_borrow_ctf_trace_class(
-					metadata->decoder);
+					metadata->shared->decoder);
 
 			trace->trace_class =
 				ctf_metadata_decoder_get_ir_trace_class(
-						metadata->decoder);
+						metadata->shared->decoder);
 			trace->trace = bt_trace_create(trace->trace_class);
 			if (!trace->trace) {
 				BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -310,13 +548,6 @@ int lttng_live_metadata_create_stream(struct lttng_live_session *session,
 	bt_logging_level log_level = session->log_level;
 	struct lttng_live_metadata *metadata = NULL;
 	struct lttng_live_trace *trace;
-	struct ctf_metadata_decoder_config cfg = {
-		.log_level = session->log_level,
-		.self_comp = session->self_comp,
-		.clock_class_offset_s = 0,
-		.clock_class_offset_ns = 0,
-		.create_trace_class = true,
-	};
 
 	metadata = g_new0(struct lttng_live_metadata, 1);
 	if (!metadata) {
@@ -326,12 +557,18 @@ int lttng_live_metadata_create_stream(struct lttng_live_session *session,
 	metadata->self_comp = session->self_comp;
 	metadata->stream_id = stream_id;
 
-	metadata->decoder = ctf_metadata_decoder_create(&cfg);
-	if (!metadata->decoder) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-			"Failed to create CTF metadata decoder");
-		goto error;
+	/*
+	 * With the `share-trace-classes` parameter, the decoder is
+	 * chosen when the first metadata text of the trace is received
+	 * (see append_metadata()).
+	 */
+	if (!session->lttng_live_msg_iter->lttng_live_comp->share_trace_classes) {
+		metadata->shared = shared_metadata_create(session, false);
+		if (!metadata->shared) {
+			goto error;
+		}
 	}
+
 	trace = lttng_live_session_borrow_or_create_trace_by_id(session,
 		ctf_trace_id);
 	if (!trace) {
@@ -343,7 +580,7 @@ int lttng_live_metadata_create_stream(struct lttng_live_session *session,
 	return 0;
 
 error:
-	ctf_metadata_decoder_destroy(metadata->decoder);
+	shared_metadata_put(session, metadata->shared);
 	g_free(metadata);
 	return -1;
 }
@@ -356,7 +593,22 @@ void lttng_live_metadata_fini(struct lttng_live_trace *trace)
 	if (!metadata) {
 		return;
 	}
-	ctf_metadata_decoder_destroy(metadata->decoder);
+	shared_metadata_put(trace->session, metadata->shared);
+	g_free(metadata->prefetched_packet_data);
 	trace->metadata = NULL;
 	g_free(metadata);
 }
+
+BT_HIDDEN
+struct ctf_trace_class *lttng_live_metadata_borrow_ctf_trace_class(
+		struct lttng_live_trace *trace)
+{
+	struct lttng_live_metadata *metadata = trace->metadata;
+
+	if (!metadata || !metadata->shared) {
+		return NULL;
+	}
+
+	return ctf_metadata_decoder_borrow_ctf_trace_class(
+		metadata->shared->decoder);
+}
@@ -21,4 +21,11 @@ enum lttng_live_iterator_status lttng_live_metadata_update(
 
 void lttng_live_metadata_fini(struct lttng_live_trace *trace);
 
+/*
+ * Returns the CTF IR trace class of `trace`, or `NULL` if there's none
+ * yet.
+ */
+struct ctf_trace_class *lttng_live_metadata_borrow_ctf_trace_class(
+		struct lttng_live_trace *trace);
+
 #endif /* LTTNG_LIVE_METADATA_H */
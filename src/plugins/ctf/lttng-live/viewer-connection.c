@@ -24,6 +24,7 @@
 #include "compat/endian.h"
 #include "compat/compiler.h"
 #include "common/common.h"
+#include "common/probes.h"
 #include <babeltrace2/babeltrace.h>
 
 #include "lttng-live.h"
@@ -195,6 +196,8 @@ enum lttng_live_viewer_status lttng_live_recv(
 	status = LTTNG_LIVE_VIEWER_STATUS_OK;
 
 end:
+	BT_PROBE3(lttng_live_viewer_recv, viewer_connection, len,
+		(int) status);
 	return status;
 }
 
@@ -220,6 +223,8 @@ enum lttng_live_viewer_status lttng_live_send(
 	size_t to_send = len;
 	ssize_t total_sent = 0;
 
+	BT_PROBE2(lttng_live_viewer_send, viewer_connection, len);
+
 	do {
 		ssize_t sent = bt_socket_send_nosigpipe(sock, buf + total_sent,
 			to_send);
@@ -1067,9 +1072,7 @@ enum lttng_live_viewer_status lttng_live_session_attach(
 
 	memset(&rq, 0, sizeof(rq));
 	rq.session_id = htobe64(session_id);
-	// TODO: add cmd line parameter to select seek beginning
-	// rq.seek = htobe32(LTTNG_VIEWER_SEEK_BEGINNING);
-	rq.seek = htobe32(LTTNG_VIEWER_SEEK_LAST);
+	rq.seek = htobe32(lttng_live_msg_iter->lttng_live_comp->params.seek);
 
 	/*
 	 * Merge the cmd and connection request to prevent a write-write
@@ -1221,51 +1224,24 @@ end:
 	return status;
 }
 
-BT_HIDDEN
-enum lttng_live_get_one_metadata_status lttng_live_get_one_metadata_packet(
-		struct lttng_live_trace *trace, FILE *fp, size_t *reply_len)
+/*
+ * Receives the reply to a `LTTNG_VIEWER_GET_METADATA` command for
+ * `trace`. On success, sets `*data` to the received metadata packet
+ * (owned by the caller) and `*len` to its length.
+ */
+static
+enum lttng_live_get_one_metadata_status recv_one_metadata_packet(
+		struct lttng_live_trace *trace, gchar **data, uint64_t *len)
 {
-	uint64_t len = 0;
 	enum lttng_live_get_one_metadata_status status;
 	enum lttng_live_viewer_status viewer_status;
-	struct lttng_viewer_cmd cmd;
-	struct lttng_viewer_get_metadata rq;
 	struct lttng_viewer_metadata_packet rp;
-	gchar *data = NULL;
-	ssize_t writelen;
 	struct lttng_live_session *session = trace->session;
-	struct lttng_live_msg_iter *lttng_live_msg_iter =
-		session->lttng_live_msg_iter;
-	struct lttng_live_metadata *metadata = trace->metadata;
 	struct live_viewer_connection *viewer_connection =
-		lttng_live_msg_iter->viewer_connection;
+		session->lttng_live_msg_iter->viewer_connection;
 	bt_self_component *self_comp = viewer_connection->self_comp;
-	const size_t cmd_buf_len = sizeof(cmd) + sizeof(rq);
-	char cmd_buf[cmd_buf_len];
-
-	BT_COMP_LOGD("Requesting new metadata for trace: "
-		"trace-id=%"PRIu64", metadata-stream-id=%"PRIu64,
-		trace->id, metadata->stream_id);
-
-	rq.stream_id = htobe64(metadata->stream_id);
-	cmd.cmd = htobe32(LTTNG_VIEWER_GET_METADATA);
-	cmd.data_size = htobe64((uint64_t) sizeof(rq));
-	cmd.cmd_version = htobe32(0);
 
-	/*
-	 * Merge the cmd and connection request to prevent a write-write
-	 * sequence on the TCP socket. Otherwise, a delayed ACK will prevent the
-	 * second write to be performed quickly in presence of Nagle's algorithm.
-	 */
-	memcpy(cmd_buf, &cmd, sizeof(cmd));
-	memcpy(cmd_buf + sizeof(cmd), &rq, sizeof(rq));
-	viewer_status = lttng_live_send(viewer_connection, &cmd_buf, cmd_buf_len);
-	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
-		viewer_handle_send_status(self_comp, NULL,
-			viewer_status, "get metadata command");
-		status = (enum lttng_live_get_one_metadata_status) viewer_status;
-		goto end;
-	}
+	*data = NULL;
 
 	viewer_status = lttng_live_recv(viewer_connection, &rp, sizeof(rp));
 	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
@@ -1299,34 +1275,117 @@ enum lttng_live_get_one_metadata_status lttng_live_get_one_metadata_packet(
 			goto end;
 	}
 
-	len = be64toh(rp.len);
-	BT_COMP_LOGD("Writing %" PRIu64" bytes to metadata", len);
-	if (len <= 0) {
+	*len = be64toh(rp.len);
+	if (*len <= 0) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
 			"Erroneous response length");
 		status = LTTNG_LIVE_GET_ONE_METADATA_STATUS_ERROR;
 		goto end;
 	}
 
-	data = g_new0(gchar, len);
-	if (!data) {
+	*data = g_new0(gchar, *len);
+	if (!*data) {
 		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(self_comp,
 			"Failed to allocate data buffer", ".");
 		status = LTTNG_LIVE_GET_ONE_METADATA_STATUS_ERROR;
 		goto end;
 	}
 
-	viewer_status = lttng_live_recv(viewer_connection, data, len);
+	viewer_status = lttng_live_recv(viewer_connection, *data, *len);
 	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
 		viewer_handle_recv_status(self_comp, NULL,
 			viewer_status, "get metadata packet");
 		status = (enum lttng_live_get_one_metadata_status) viewer_status;
+		g_free(*data);
+		*data = NULL;
+		goto end;
+	}
+
+	status = LTTNG_LIVE_GET_ONE_METADATA_STATUS_OK;
+
+end:
+	return status;
+}
+
+static
+void init_get_metadata_cmd(struct lttng_live_trace *trace, char *cmd_buf)
+{
+	struct lttng_viewer_cmd cmd;
+	struct lttng_viewer_get_metadata rq;
+
+	memset(&rq, 0, sizeof(rq));
+	rq.stream_id = htobe64(trace->metadata->stream_id);
+	cmd.cmd = htobe32(LTTNG_VIEWER_GET_METADATA);
+	cmd.data_size = htobe64((uint64_t) sizeof(rq));
+	cmd.cmd_version = htobe32(0);
+
+	/*
+	 * Merge the cmd and connection request to prevent a write-write
+	 * sequence on the TCP socket. Otherwise, a delayed ACK will prevent the
+	 * second write to be performed quickly in presence of Nagle's algorithm.
+	 */
+	memcpy(cmd_buf, &cmd, sizeof(cmd));
+	memcpy(cmd_buf + sizeof(cmd), &rq, sizeof(rq));
+}
+
+#define GET_METADATA_CMD_BUF_LEN	\
+	(sizeof(struct lttng_viewer_cmd) + sizeof(struct lttng_viewer_get_metadata))
+
+BT_HIDDEN
+enum lttng_live_get_one_metadata_status lttng_live_get_one_metadata_packet(
+		struct lttng_live_trace *trace, FILE *fp, size_t *reply_len)
+{
+	uint64_t len = 0;
+	enum lttng_live_get_one_metadata_status status;
+	enum lttng_live_viewer_status viewer_status;
+	gchar *data = NULL;
+	ssize_t writelen;
+	struct lttng_live_session *session = trace->session;
+	struct lttng_live_msg_iter *lttng_live_msg_iter =
+		session->lttng_live_msg_iter;
+	struct lttng_live_metadata *metadata = trace->metadata;
+	struct live_viewer_connection *viewer_connection =
+		lttng_live_msg_iter->viewer_connection;
+	bt_self_component *self_comp = viewer_connection->self_comp;
+	char cmd_buf[GET_METADATA_CMD_BUF_LEN];
+
+	if (metadata->has_prefetched_packet) {
+		BT_COMP_LOGD("Using prefetched metadata for trace: "
+			"trace-id=%"PRIu64", metadata-stream-id=%"PRIu64,
+			trace->id, metadata->stream_id);
+		status = metadata->prefetched_packet_status;
+		data = metadata->prefetched_packet_data;
+		len = metadata->prefetched_packet_len;
+		metadata->has_prefetched_packet = false;
+		metadata->prefetched_packet_data = NULL;
+		goto handle_packet;
+	}
+
+	BT_COMP_LOGD("Requesting new metadata for trace: "
+		"trace-id=%"PRIu64", metadata-stream-id=%"PRIu64,
+		trace->id, metadata->stream_id);
+
+	init_get_metadata_cmd(trace, cmd_buf);
+	viewer_status = lttng_live_send(viewer_connection, &cmd_buf,
+		sizeof(cmd_buf));
+	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
+		viewer_handle_send_status(self_comp, NULL,
+			viewer_status, "get metadata command");
+		status = (enum lttng_live_get_one_metadata_status) viewer_status;
+		goto end;
+	}
+
+	status = recv_one_metadata_packet(trace, &data, &len);
+
+handle_packet:
+	if (status != LTTNG_LIVE_GET_ONE_METADATA_STATUS_OK) {
 		goto end;
 	}
 
 	/*
 	 * Write the metadata to the file handle.
 	 */
+	BT_COMP_LOGD("Writing %" PRIu64" bytes to metadata", len);
 	writelen = fwrite(data, sizeof(uint8_t), len, fp);
 	if (writelen != len) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -1343,6 +1402,108 @@ end:
 	return status;
 }
 
+/*
+ * Maximum number of `LTTNG_VIEWER_GET_METADATA` commands to have in
+ * flight at once: the Relay Daemon doesn't read the next commands while
+ * it can't write a reply, so the replies must mostly fit in the socket
+ * buffers.
+ */
+#define PREFETCH_METADATA_PACKETS_MAX_COUNT	64
+
+BT_HIDDEN
+enum lttng_live_iterator_status lttng_live_prefetch_metadata_packets(
+		struct lttng_live_session *session)
+{
+	enum lttng_live_viewer_status viewer_status;
+	enum lttng_live_iterator_status status = LTTNG_LIVE_ITERATOR_STATUS_OK;
+	struct live_viewer_connection *viewer_connection =
+		session->lttng_live_msg_iter->viewer_connection;
+	bt_self_component *self_comp = viewer_connection->self_comp;
+	struct lttng_live_trace *traces[PREFETCH_METADATA_PACKETS_MAX_COUNT];
+	char cmd_buf[GET_METADATA_CMD_BUF_LEN * PREFETCH_METADATA_PACKETS_MAX_COUNT];
+	guint trace_idx = 0;
+
+	while (trace_idx < session->traces->len) {
+		guint count = 0;
+		guint i;
+
+		/* Collect the next batch of traces */
+		for (; trace_idx < session->traces->len &&
+				count < PREFETCH_METADATA_PACKETS_MAX_COUNT;
+				trace_idx++) {
+			struct lttng_live_trace *trace =
+				g_ptr_array_index(session->traces, trace_idx);
+
+			if (!trace->metadata ||
+					trace->metadata->has_prefetched_packet ||
+					trace->metadata_stream_state !=
+						LTTNG_LIVE_METADATA_STREAM_STATE_NEEDED) {
+				continue;
+			}
+
+			init_get_metadata_cmd(trace,
+				&cmd_buf[count * GET_METADATA_CMD_BUF_LEN]);
+			traces[count] = trace;
+			count++;
+		}
+
+		/* A single trace needs a single round trip anyway */
+		if (count < 2) {
+			continue;
+		}
+
+		BT_COMP_LOGD("Requesting new metadata for %u traces at once",
+			count);
+
+		/*
+		 * A single write for all the commands: the Relay Daemon
+		 * replies to the commands of a connection in order.
+		 */
+		viewer_status = lttng_live_send(viewer_connection, cmd_buf,
+			count * GET_METADATA_CMD_BUF_LEN);
+		if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
+			viewer_handle_send_status(self_comp, NULL,
+				viewer_status, "get metadata commands");
+			goto error;
+		}
+
+		for (i = 0; i < count; i++) {
+			struct lttng_live_metadata *metadata =
+				traces[i]->metadata;
+
+			metadata->prefetched_packet_status =
+				recv_one_metadata_packet(traces[i],
+					&metadata->prefetched_packet_data,
+					&metadata->prefetched_packet_len);
+
+			switch (metadata->prefetched_packet_status) {
+			case LTTNG_LIVE_GET_ONE_METADATA_STATUS_ERROR:
+			case LTTNG_LIVE_GET_ONE_METADATA_STATUS_INTERRUPTED:
+				/*
+				 * The connection is unusable or the
+				 * graph is being torn down: drop the
+				 * next replies.
+				 */
+				viewer_status = (enum lttng_live_viewer_status)
+					metadata->prefetched_packet_status;
+				goto error;
+			default:
+				break;
+			}
+
+			metadata->has_prefetched_packet = true;
+		}
+	}
+
+	goto end;
+
+error:
+	status = viewer_status_to_live_iterator_status(viewer_status);
+
+end:
+	return status;
+}
+
 /*
  * Assign the fields from a lttng_viewer_index to a packet_index.
  */
@@ -1393,6 +1554,14 @@ enum lttng_live_iterator_status lttng_live_get_next_index(
 	char cmd_buf[cmd_buf_len];
 	uint32_t flags, rp_status;
 
+	if (stream->has_prefetched_index) {
+		BT_COMP_LOGD("Using prefetched next index for stream: "
+			"stream-id=%"PRIu64, stream->viewer_stream_id);
+		rp = stream->prefetched_index;
+		stream->has_prefetched_index = false;
+		goto handle_reply;
+	}
+
 	BT_COMP_LOGD("Requesting next index for stream: "
 		"stream-id=%"PRIu64, stream->viewer_stream_id);
 
@@ -1425,6 +1594,7 @@ enum lttng_live_iterator_status lttng_live_get_next_index(
 		goto error;
 	}
 
+handle_reply:
 	flags = be32toh(rp.flags);
 	rp_status = be32toh(rp.status);
 
@@ -1510,6 +1680,74 @@ end:
 	return status;
 }
 
+BT_HIDDEN
+enum lttng_live_iterator_status lttng_live_prefetch_next_indexes(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator **streams, guint count)
+{
+	enum lttng_live_viewer_status viewer_status;
+	enum lttng_live_iterator_status status = LTTNG_LIVE_ITERATOR_STATUS_OK;
+	struct live_viewer_connection *viewer_connection =
+		lttng_live_msg_iter->viewer_connection;
+	bt_self_component *self_comp = viewer_connection->self_comp;
+	const size_t one_cmd_buf_len = sizeof(struct lttng_viewer_cmd) +
+		sizeof(struct lttng_viewer_get_next_index);
+	char *cmd_buf;
+	guint i;
+
+	BT_COMP_LOGD("Requesting next index for %u streams at once", count);
+	cmd_buf = g_malloc(one_cmd_buf_len * count);
+
+	for (i = 0; i < count; i++) {
+		struct lttng_viewer_cmd cmd;
+		struct lttng_viewer_get_next_index rq;
+		char *cmd_buf_pos = cmd_buf + i * one_cmd_buf_len;
+
+		BT_ASSERT(!streams[i]->has_prefetched_index);
+		cmd.cmd = htobe32(LTTNG_VIEWER_GET_NEXT_INDEX);
+		cmd.data_size = htobe64((uint64_t) sizeof(rq));
+		cmd.cmd_version = htobe32(0);
+		memset(&rq, 0, sizeof(rq));
+		rq.stream_id = htobe64(streams[i]->viewer_stream_id);
+		memcpy(cmd_buf_pos, &cmd, sizeof(cmd));
+		memcpy(cmd_buf_pos + sizeof(cmd), &rq, sizeof(rq));
+	}
+
+	/*
+	 * A single write for all the commands: the Relay Daemon replies
+	 * to the commands of a connection in order.
+	 */
+	viewer_status = lttng_live_send(viewer_connection, cmd_buf,
+		one_cmd_buf_len * count);
+	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
+		viewer_handle_send_status(self_comp, NULL,
+			viewer_status, "get next index commands");
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		viewer_status = lttng_live_recv(viewer_connection,
+			&streams[i]->prefetched_index,
+			sizeof(streams[i]->prefetched_index));
+		if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
+			viewer_handle_recv_status(self_comp, NULL,
+				viewer_status, "get next index reply");
+			goto error;
+		}
+
+		streams[i]->has_prefetched_index = true;
+	}
+
+	goto end;
+
+error:
+	status = viewer_status_to_live_iterator_status(viewer_status);
+
+end:
+	g_free(cmd_buf);
+	return status;
+}
+
 BT_HIDDEN
 enum ctf_msg_iter_medium_status lttng_live_get_stream_bytes(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
@@ -1566,11 +1804,31 @@ enum ctf_msg_iter_medium_status lttng_live_get_stream_bytes(
 
 	switch (rp_status) {
 	case LTTNG_VIEWER_GET_PACKET_OK:
-		req_len = be32toh(rp.len);
+	{
+		uint64_t rp_len = be32toh(rp.len);
+
 		BT_COMP_LOGD("Received get_data_packet response: Ok, "
-			"packet size : %" PRIu64 "", req_len);
+			"packet size : %" PRIu64 "", rp_len);
+
+		/*
+		 * The packet data is received directly into `buf`, the
+		 * buffer which the CTF message iterator decodes in
+		 * place, which is only `req_len` bytes large.
+		 */
+		if (rp_len > req_len) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Received get_data_packet response with a length "
+				"greater than the requested one: "
+				"req-len=%" PRIu64 ", rp-len=%" PRIu64,
+				req_len, rp_len);
+			status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+			goto end;
+		}
+
+		req_len = rp_len;
 		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
 		break;
+	}
 	case LTTNG_VIEWER_GET_PACKET_RETRY:
 		/* Unimplemented by relay daemon */
 		BT_COMP_LOGD("Received get_data_packet response: retry");
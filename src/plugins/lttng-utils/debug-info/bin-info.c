@@ -56,8 +56,245 @@ int bin_info_init(bt_logging_level log_level, bt_self_component *self_comp)
 	return ret;
 }
 
+struct bin_info_image {
+	uint64_t ref_count;
+
+	/* Key within `registry`, or `NULL` if not registered */
+	gchar *key;
+
+	/* Weak refs */
+	struct bin_info_registry *registry;
+	struct bt_fd_cache *fd_cache;
+
+	/* Path to DWARF file. */
+	gchar *dwarf_path;
+	/* libelf and libdw objects representing the files. */
+	Elf *elf_file;
+	Dwarf *dwarf_info;
+	/* fd cache handles to ELF and DWARF files. */
+	struct bt_fd_cache_handle *elf_handle;
+	struct bt_fd_cache_handle *dwarf_handle;
+	/* Whether the DWARF info lookup was done, successfully or not. */
+	bool dwarf_info_looked_up:1;
+	/* Whether the build ID check was done, and its result. */
+	bool build_id_checked:1;
+	bool build_id_matches:1;
+	/*
+	 * Function symbols of the ELF file sorted by address (array of
+	 * `struct bin_info_elf_func_sym`), built on the first ELF
+	 * function name lookup, or `NULL` before.
+	 */
+	GArray *elf_func_syms;
+	/*
+	 * Address ranges of the DWARF compile units sorted by low
+	 * address (array of `struct bin_info_cu_range`) and compile
+	 * units without any address range (array of
+	 * `struct bt_dwarf_cu`), built on the first DWARF lookup, or
+	 * `NULL` before.
+	 */
+	GArray *dwarf_cu_ranges;
+	GArray *dwarf_unranged_cus;
+};
+
+struct bin_info_registry {
+	/*
+	 * Hash table: key (string) to (struct bin_info_image *); weak
+	 * refs: an image removes itself when its last bin info puts it.
+	 */
+	GHashTable *images;
+};
+
+BT_HIDDEN
+struct bin_info_registry *bin_info_registry_create(void)
+{
+	struct bin_info_registry *registry = g_new0(struct bin_info_registry, 1);
+
+	if (!registry) {
+		goto error;
+	}
+
+	registry->images = g_hash_table_new(g_str_hash, g_str_equal);
+	if (!registry->images) {
+		goto error;
+	}
+
+	return registry;
+
+error:
+	bin_info_registry_destroy(registry);
+	return NULL;
+}
+
+BT_HIDDEN
+void bin_info_registry_destroy(struct bin_info_registry *registry)
+{
+	if (!registry) {
+		return;
+	}
+
+	if (registry->images) {
+		BT_ASSERT(g_hash_table_size(registry->images) == 0);
+		g_hash_table_destroy(registry->images);
+	}
+
+	g_free(registry);
+}
+
+static
+void bin_info_image_destroy(struct bin_info_image *image)
+{
+	if (!image) {
+		return;
+	}
+
+	if (image->key) {
+		gboolean removed = g_hash_table_remove(image->registry->images,
+			image->key);
+
+		BT_ASSERT(removed);
+		g_free(image->key);
+	}
+
+	dwarf_end(image->dwarf_info);
+	g_free(image->dwarf_path);
+
+	if (image->elf_func_syms) {
+		g_array_free(image->elf_func_syms, TRUE);
+	}
+
+	if (image->dwarf_cu_ranges) {
+		g_array_free(image->dwarf_cu_ranges, TRUE);
+	}
+
+	if (image->dwarf_unranged_cus) {
+		g_array_free(image->dwarf_unranged_cus, TRUE);
+	}
+
+	elf_end(image->elf_file);
+
+	bt_fd_cache_put_handle(image->fd_cache, image->elf_handle);
+	bt_fd_cache_put_handle(image->fd_cache, image->dwarf_handle);
+
+	g_free(image);
+}
+
+/*
+ * Returns the registry key of the image of `bin`: the parsed files
+ * only depend on the path of the executable and on the build ID and
+ * debug link information which lead to its separate debug info.
+ */
+static
+gchar *bin_info_image_key(struct bin_info *bin)
+{
+	GString *key = g_string_new(bin->elf_path);
+	size_t i;
+
+	if (!key) {
+		return NULL;
+	}
+
+	g_string_append_c(key, '\n');
+
+	for (i = 0; i < bin->build_id_len; i++) {
+		g_string_append_printf(key, "%02x", bin->build_id[i]);
+	}
+
+	if (bin->dbg_link_filename) {
+		g_string_append_printf(key, "\n%s\n%08" PRIx32,
+			bin->dbg_link_filename, bin->dbg_link_crc);
+	}
+
+	return g_string_free(key, FALSE);
+}
+
+/**
+ * Acquires the image of a given bin_info instance if it has none yet,
+ * sharing the one of another bin_info instance of the same executable
+ * through its registry if possible.
+ *
+ * @param bin	bin_info instance
+ * @returns	0 on success, -1 on failure
+ */
+static
+int bin_info_acquire_image(struct bin_info *bin)
+{
+	struct bin_info_image *image = NULL;
+	gchar *key = NULL;
+
+	if (bin->image) {
+		goto end;
+	}
+
+	if (bin->registry) {
+		key = bin_info_image_key(bin);
+		if (!key) {
+			goto error;
+		}
+
+		image = g_hash_table_lookup(bin->registry->images, key);
+		if (image) {
+			BT_COMP_LOGD("Sharing parsed executable: path=\"%s\", "
+				"ref-count=%" PRIu64, bin->elf_path,
+				image->ref_count);
+			image->ref_count++;
+			g_free(key);
+			goto set_image;
+		}
+	}
+
+	image = g_new0(struct bin_info_image, 1);
+	if (!image) {
+		goto error;
+	}
+
+	image->ref_count = 1;
+	image->fd_cache = bin->fd_cache;
+
+	if (key) {
+		image->registry = bin->registry;
+		image->key = key;
+		key = NULL;
+		g_hash_table_insert(image->registry->images, image->key, image);
+	}
+
+set_image:
+	bin->image = image;
+
+end:
+	return 0;
+
+error:
+	g_free(key);
+	return -1;
+}
+
+/**
+ * Puts the image of a given bin_info instance, if any, for example
+ * because its build ID or debug link changes the image it needs.
+ *
+ * @param bin	bin_info instance
+ */
+static
+void bin_info_put_image(struct bin_info *bin)
+{
+	struct bin_info_image *image = bin->image;
+
+	if (!image) {
+		return;
+	}
+
+	bin->image = NULL;
+	BT_ASSERT(image->ref_count > 0);
+	image->ref_count--;
+
+	if (image->ref_count == 0) {
+		bin_info_image_destroy(image);
+	}
+}
+
 BT_HIDDEN
-struct bin_info *bin_info_create(struct bt_fd_cache *fdc, const char *path,
+struct bin_info *bin_info_create(struct bt_fd_cache *fdc,
+		struct bin_info_registry *registry, const char *path,
 		uint64_t low_addr, uint64_t memsz, bool is_pic,
 		const char *debug_info_dir, const char *target_prefix,
 		bt_logging_level log_level, bt_self_component *self_comp)
@@ -102,6 +339,7 @@ struct bin_info *bin_info_create(struct bt_fd_cache *fdc, const char *path,
 	bin->build_id_len = 0;
 	bin->file_build_id_matches = false;
 	bin->fd_cache = fdc;
+	bin->registry = registry;
 
 	return bin;
 
@@ -117,19 +355,13 @@ void bin_info_destroy(struct bin_info *bin)
 		return;
 	}
 
-	dwarf_end(bin->dwarf_info);
+	bin_info_put_image(bin);
 
 	g_free(bin->debug_info_dir);
 	g_free(bin->elf_path);
-	g_free(bin->dwarf_path);
 	g_free(bin->build_id);
+	g_free(bin->deferred_build_id);
 	g_free(bin->dbg_link_filename);
-
-	elf_end(bin->elf_file);
-
-	bt_fd_cache_put_handle(bin->fd_cache, bin->elf_handle);
-	bt_fd_cache_put_handle(bin->fd_cache, bin->dwarf_handle);
-
 	g_free(bin);
 }
 
@@ -153,9 +385,8 @@ int bin_info_set_elf_file(struct bin_info *bin)
 		BT_COMP_LOGI("Failed to open %s", bin->elf_path);
 		goto error;
 	}
-	bin->elf_handle = elf_handle;
 
-	elf_file = elf_begin(bt_fd_cache_handle_get_fd(bin->elf_handle),
+	elf_file = elf_begin(bt_fd_cache_handle_get_fd(elf_handle),
 		ELF_C_READ, NULL);
 	if (!elf_file) {
 		BT_COMP_LOGE_APPEND_CAUSE(bin->self_comp,
@@ -163,14 +394,14 @@ int bin_info_set_elf_file(struct bin_info *bin)
 		goto error;
 	}
 
-	bin->elf_file = elf_file;
-
 	if (elf_kind(elf_file) != ELF_K_ELF) {
 		BT_COMP_LOGE_APPEND_CAUSE(bin->self_comp,
 			"Error: %s is not an ELF object", bin->elf_path);
 		goto error;
 	}
 
+	bin->image->elf_handle = elf_handle;
+	bin->image->elf_file = elf_file;
 
 	ret = 0;
 	goto end;
@@ -272,7 +503,7 @@ end:
 
 /**
  * Checks if the build id stored in `bin` (bin->build_id) is matching the build
- * id of the ondisk file (bin->elf_file).
+ * id of the ondisk file (bin->image->elf_file).
  *
  * @param bin			bin_info instance
  * @param build_id		build id to compare ot the on disk file
@@ -293,8 +524,18 @@ int is_build_id_matching(struct bin_info *bin)
 		goto error;
 	}
 
+	if (bin_info_acquire_image(bin)) {
+		goto error;
+	}
+
+	/* Another bin_info instance may have checked the shared image. */
+	if (bin->image->build_id_checked) {
+		is_matching = bin->image->build_id_matches;
+		goto error;
+	}
+
 	/* Set ELF file if it hasn't been accessed yet. */
-	if (!bin->elf_file) {
+	if (!bin->image->elf_file) {
 		ret = bin_info_set_elf_file(bin);
 		if (ret) {
 			/* Failed to set ELF file. */
@@ -302,7 +543,7 @@ int is_build_id_matching(struct bin_info *bin)
 		}
 	}
 
-	next_section = elf_nextscn(bin->elf_file, curr_section);
+	next_section = elf_nextscn(bin->image->elf_file, curr_section);
 	if (!next_section) {
 		goto error;
 	}
@@ -311,7 +552,7 @@ int is_build_id_matching(struct bin_info *bin)
 		Elf_Data *note_data = NULL;
 
 		curr_section = next_section;
-		next_section = elf_nextscn(bin->elf_file, curr_section);
+		next_section = elf_nextscn(bin->image->elf_file, curr_section);
 
 		if (!gelf_getshdr(curr_section, &curr_section_hdr)) {
 			goto error;
@@ -345,6 +586,10 @@ int is_build_id_matching(struct bin_info *bin)
 			break;
 		}
 	}
+
+	bin->image->build_id_checked = true;
+	bin->image->build_id_matches = is_matching;
+
 error:
 	return is_matching;
 }
@@ -357,6 +602,9 @@ int bin_info_set_build_id(struct bin_info *bin, uint8_t *build_id,
 		goto error;
 	}
 
+	/* The image to use depends on the build id. */
+	bin_info_put_image(bin);
+
 	/* Free any previously set build id. */
 	g_free(bin->build_id);
 
@@ -393,6 +641,48 @@ error:
 	return -1;
 }
 
+BT_HIDDEN
+int bin_info_set_build_id_deferred(struct bin_info *bin, uint8_t *build_id,
+		size_t build_id_len)
+{
+	if (!bin || !build_id) {
+		goto error;
+	}
+
+	/* Free any previously deferred build id. */
+	g_free(bin->deferred_build_id);
+
+	bin->deferred_build_id = g_new0(uint8_t, build_id_len);
+	if (!bin->deferred_build_id) {
+		goto error;
+	}
+
+	memcpy(bin->deferred_build_id, build_id, build_id_len);
+	bin->deferred_build_id_len = build_id_len;
+	return 0;
+
+error:
+	return -1;
+}
+
+BT_HIDDEN
+void bin_info_apply_deferred_build_id(struct bin_info *bin)
+{
+	uint8_t *build_id;
+
+	if (G_LIKELY(!bin->deferred_build_id)) {
+		return;
+	}
+
+	build_id = bin->deferred_build_id;
+	bin->deferred_build_id = NULL;
+
+	/* bin_info_set_build_id() logs the mismatch, if any */
+	(void) bin_info_set_build_id(bin, build_id,
+		bin->deferred_build_id_len);
+	g_free(build_id);
+}
+
 BT_HIDDEN
 int bin_info_set_debug_link(struct bin_info *bin, const char *filename,
 		uint32_t crc)
@@ -401,6 +691,9 @@ int bin_info_set_debug_link(struct bin_info *bin, const char *filename,
 		goto error;
 	}
 
+	/* The image to use depends on the debug link. */
+	bin_info_put_image(bin);
+
 	bin->dbg_link_filename = g_strdup(filename);
 	if (!bin->dbg_link_filename) {
 		goto error;
@@ -467,12 +760,12 @@ int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 		goto error;
 	}
 
-	bin->dwarf_handle = dwarf_handle;
-	bin->dwarf_path = g_strdup(path);
-	if (!bin->dwarf_path) {
+	bin->image->dwarf_path = g_strdup(path);
+	if (!bin->image->dwarf_path) {
 		goto error;
 	}
-	bin->dwarf_info = dwarf_info;
+	bin->image->dwarf_handle = dwarf_handle;
+	bin->image->dwarf_info = dwarf_info;
 	free(cu);
 
 	return 0;
@@ -604,10 +897,21 @@ int is_valid_debug_file(struct bin_info *bin, char *path, uint32_t crc)
 		goto end;
 	}
 
-	ret = crc32(bt_fd_cache_handle_get_fd(debug_handle), &_crc);
-	if (ret) {
-		ret = 0;
-		goto end;
+	/*
+	 * Computing the checksum of a large debug file is expensive, and
+	 * many binaries can link to the same one: memoize it.
+	 */
+	if (!bt_fd_cache_handle_get_checksum(bin->fd_cache, debug_handle,
+			&_crc)) {
+		ret = crc32(bt_fd_cache_handle_get_fd(debug_handle), &_crc,
+			bin->log_level);
+		if (ret) {
+			ret = 0;
+			goto end;
+		}
+
+		bt_fd_cache_handle_set_checksum(bin->fd_cache, debug_handle,
+			_crc);
 	}
 
 	ret = (crc == _crc);
@@ -695,6 +999,17 @@ int bin_info_set_dwarf_info(struct bin_info *bin)
 		goto end;
 	}
 
+	/*
+	 * Another bin_info instance sharing the image may already have
+	 * looked for its DWARF info.
+	 */
+	if (bin->image->dwarf_info_looked_up) {
+		ret = bin->image->dwarf_info ? 0 : -1;
+		goto end;
+	}
+
+	bin->image->dwarf_info_looked_up = true;
+
 	/* First try to set the DWARF info from the ELF file */
 	ret = bin_info_set_dwarf_info_from_path(bin, bin->elf_path);
 	if (!ret) {
@@ -772,49 +1087,64 @@ error:
 	return -1;
 }
 
+/*
+ * Function symbol entry of the sorted ELF symbol index of a bin_info
+ * (`struct bin_info::elf_func_syms`).
+ */
+struct bin_info_elf_func_sym {
+	/* Value (address) of the symbol */
+	uint64_t addr;
+
+	/* Index of the string table section containing the name */
+	uint32_t strtab_index;
+
+	/* Offset of the name within the string table */
+	uint32_t name_offset;
+
+	/* Order of the symbol within the ELF file */
+	uint64_t order;
+};
+
+static
+gint compare_elf_func_syms(gconstpointer a, gconstpointer b)
+{
+	const struct bin_info_elf_func_sym *sym_a = a;
+	const struct bin_info_elf_func_sym *sym_b = b;
+
+	if (sym_a->addr != sym_b->addr) {
+		return sym_a->addr < sym_b->addr ? -1 : 1;
+	}
+
+	if (sym_a->order != sym_b->order) {
+		return sym_a->order < sym_b->order ? -1 : 1;
+	}
+
+	return 0;
+}
+
 /**
- * Try to find the symbol closest to an address within a given ELF
- * section.
+ * Append the function symbols of a given ELF symbol table section to
+ * an array of `struct bin_info_elf_func_sym`.
  *
- * Only function symbols are taken into account. The symbol's address
- * must precede `addr`. A symbol with a closer address might exist
- * after `addr` but is irrelevant because it cannot encompass `addr`.
+ * Sections which aren't symbol table (symtab) sections are ignored.
  *
- * On success, if found, the out parameters `sym` and `shdr` are
- * set. On failure or if none are found, they remain unchanged.
- *
- * @param scn		ELF section in which to look for the address
- * @param addr		Virtual memory address for which to find the
- *			nearest function symbol
- * @param sym		Out parameter, the nearest function symbol
- * @param shdr		Out parameter, the section header for scn
+ * @param scn		ELF section from which to read the symbols
+ * @param syms		Array of symbols to which to append
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_get_nearest_symbol_from_section(Elf_Scn *scn, uint64_t addr,
-		GElf_Sym **sym, GElf_Shdr **shdr)
+int bin_info_append_elf_func_syms_from_section(Elf_Scn *scn, GArray *syms)
 {
-	int i;
+	size_t i;
 	size_t symbol_count;
 	Elf_Data *data = NULL;
-	GElf_Shdr *_shdr = NULL;
-	GElf_Sym *nearest_sym = NULL;
+	GElf_Shdr shdr;
 
-	if (!scn || !sym || !shdr) {
+	if (!gelf_getshdr(scn, &shdr)) {
 		goto error;
 	}
 
-	_shdr = g_new0(GElf_Shdr, 1);
-	if (!_shdr) {
-		goto error;
-	}
-
-	_shdr = gelf_getshdr(scn, _shdr);
-	if (!_shdr) {
-		goto error;
-	}
-
-	if (_shdr->sh_type != SHT_SYMTAB) {
+	if (shdr.sh_type != SHT_SYMTAB) {
 		/*
 		 * We are only interested in symbol table (symtab)
 		 * sections, skip this one.
@@ -827,51 +1157,113 @@ int bin_info_get_nearest_symbol_from_section(Elf_Scn *scn, uint64_t addr,
 		goto error;
 	}
 
-	symbol_count = _shdr->sh_size / _shdr->sh_entsize;
+	symbol_count = shdr.sh_size / shdr.sh_entsize;
 
 	for (i = 0; i < symbol_count; ++i) {
-		GElf_Sym *cur_sym = NULL;
+		struct bin_info_elf_func_sym func_sym;
+		GElf_Sym sym;
 
-		cur_sym = g_new0(GElf_Sym, 1);
-		if (!cur_sym) {
-			goto error;
-		}
-		cur_sym = gelf_getsym(data, i, cur_sym);
-		if (!cur_sym) {
+		if (!gelf_getsym(data, i, &sym)) {
 			goto error;
 		}
-		if (GELF_ST_TYPE(cur_sym->st_info) != STT_FUNC) {
+
+		if (GELF_ST_TYPE(sym.st_info) != STT_FUNC) {
 			/* We're only interested in the functions. */
-			g_free(cur_sym);
 			continue;
 		}
 
-		if (cur_sym->st_value <= addr &&
-				(!nearest_sym ||
-				cur_sym->st_value > nearest_sym->st_value)) {
-			g_free(nearest_sym);
-			nearest_sym = cur_sym;
-		} else {
-			g_free(cur_sym);
-		}
+		func_sym.addr = sym.st_value;
+		func_sym.strtab_index = shdr.sh_link;
+		func_sym.name_offset = sym.st_name;
+		func_sym.order = syms->len;
+		g_array_append_val(syms, func_sym);
 	}
 
 end:
-	if (nearest_sym) {
-		*sym = nearest_sym;
-		*shdr = _shdr;
-	} else {
-		g_free(_shdr);
-	}
-
 	return 0;
 
 error:
-	g_free(nearest_sym);
-	g_free(_shdr);
 	return -1;
 }
 
+/**
+ * Build the sorted function symbol index of a given executable, if
+ * it's not already done.
+ *
+ * The index only keeps, for a given address, the first function
+ * symbol of the ELF file having this address.
+ *
+ * @param bin		bin_info instance for the executable
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_build_elf_func_syms(struct bin_info *bin)
+{
+	int ret = 0;
+	Elf_Scn *scn = NULL;
+	GArray *syms = NULL;
+	guint i, len = 0;
+
+	if (bin->image->elf_func_syms) {
+		goto end;
+	}
+
+	/* Set ELF file if it hasn't been accessed yet. */
+	if (!bin->image->elf_file) {
+		ret = bin_info_set_elf_file(bin);
+		if (ret) {
+			/* Failed to set ELF file. */
+			goto error;
+		}
+	}
+
+	syms = g_array_new(FALSE, FALSE,
+		sizeof(struct bin_info_elf_func_sym));
+	if (!syms) {
+		goto error;
+	}
+
+	while ((scn = elf_nextscn(bin->image->elf_file, scn))) {
+		ret = bin_info_append_elf_func_syms_from_section(scn, syms);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	g_array_sort(syms, compare_elf_func_syms);
+
+	/* Only keep the first symbol of each address */
+	for (i = 0; i < syms->len; i++) {
+		struct bin_info_elf_func_sym *sym = &g_array_index(syms,
+			struct bin_info_elf_func_sym, i);
+
+		if (len > 0 && g_array_index(syms,
+				struct bin_info_elf_func_sym, len - 1).addr ==
+				sym->addr) {
+			continue;
+		}
+
+		g_array_index(syms, struct bin_info_elf_func_sym, len) = *sym;
+		len++;
+	}
+
+	g_array_set_size(syms, len);
+	bin->image->elf_func_syms = syms;
+	BT_COMP_LOGD("Built sorted ELF function symbol index: "
+		"path=\"%s\", count=%u", bin->elf_path, len);
+	goto end;
+
+error:
+	if (syms) {
+		g_array_free(syms, TRUE);
+	}
+
+	ret = -1;
+
+end:
+	return ret;
+}
+
 /**
  * Get the name of the function containing a given address within an
  * executable using ELF symbols.
@@ -880,6 +1272,10 @@ error:
  * followed by the offset in bytes between the address and the symbol
  * (in hex), separated by a '+' character.
  *
+ * Only function symbols are taken into account. The symbol's address
+ * must precede `addr`. A symbol with a closer address might exist
+ * after `addr` but is irrelevant because it cannot encompass `addr`.
+ *
  * If found, the out parameter `func_name` is set on success. On failure,
  * it remains unchanged.
  *
@@ -894,64 +1290,54 @@ static
 int bin_info_lookup_elf_function_name(struct bin_info *bin, uint64_t addr,
 		char **func_name)
 {
-	/*
-	 * TODO (possible optimisation): if an ELF has no symtab
-	 * section, it has been stripped. Therefore, it would be wise
-	 * to store a flag indicating the stripped status after the
-	 * first iteration to prevent subsequent ones.
-	 */
 	int ret = 0;
-	Elf_Scn *scn = NULL;
-	GElf_Sym *sym = NULL;
-	GElf_Shdr *shdr = NULL;
+	const struct bin_info_elf_func_sym *sym = NULL;
 	char *sym_name = NULL;
+	guint low = 0;
+	guint high;
 
-	/* Set ELF file if it hasn't been accessed yet. */
-	if (!bin->elf_file) {
-		ret = bin_info_set_elf_file(bin);
-		if (ret) {
-			/* Failed to set ELF file. */
-			goto error;
-		}
-	}
-
-	scn = elf_nextscn(bin->elf_file, scn);
-	if (!scn) {
+	ret = bin_info_build_elf_func_syms(bin);
+	if (ret) {
 		goto error;
 	}
 
-	while (scn && !sym) {
-		ret = bin_info_get_nearest_symbol_from_section(
-				scn, addr, &sym, &shdr);
-		if (ret) {
-			goto error;
+	/* Find the last symbol of which the address is at most `addr` */
+	high = bin->image->elf_func_syms->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (g_array_index(bin->image->elf_func_syms,
+				struct bin_info_elf_func_sym, mid).addr <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
 		}
+	}
 
-		scn = elf_nextscn(bin->elf_file, scn);
+	if (low > 0) {
+		sym = &g_array_index(bin->image->elf_func_syms,
+			struct bin_info_elf_func_sym, low - 1);
 	}
 
 	if (sym) {
-		sym_name = elf_strptr(bin->elf_file, shdr->sh_link,
-				sym->st_name);
+		sym_name = elf_strptr(bin->image->elf_file, sym->strtab_index,
+				sym->name_offset);
 		if (!sym_name) {
 			goto error;
 		}
 
-		ret = bin_info_append_offset_str(sym_name, sym->st_value, addr,
+		ret = bin_info_append_offset_str(sym_name, sym->addr, addr,
 						func_name);
 		if (ret) {
 			goto error;
 		}
 	}
 
-	g_free(shdr);
-	g_free(sym);
 	return 0;
 
 error:
-	g_free(shdr);
-	g_free(sym);
-	return ret;
+	return -1;
 }
 
 /**
@@ -973,27 +1359,27 @@ int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
 {
 	int ret = 0;
 	bool found = false;
-	struct bt_dwarf_die *die = NULL;
+	struct bt_dwarf_die die;
 
 	if (!cu || !func_name) {
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	ret = bt_dwarf_die_init(&die, cu);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_die_next(die) == 0) {
+	while (bt_dwarf_die_next(&die) == 0) {
 		int tag;
 
-		ret = bt_dwarf_die_get_tag(die, &tag);
+		ret = bt_dwarf_die_get_tag(&die, &tag);
 		if (ret) {
 			goto error;
 		}
 
 		if (tag == DW_TAG_subprogram) {
-			ret = bt_dwarf_die_contains_addr(die, addr, &found);
+			ret = bt_dwarf_die_contains_addr(&die, addr, &found);
 			if (ret) {
 				goto error;
 			}
@@ -1008,12 +1394,12 @@ int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
 		uint64_t low_addr = 0;
 		char *die_name = NULL;
 
-		ret = bt_dwarf_die_get_name(die, &die_name);
+		ret = bt_dwarf_die_get_name(&die, &die_name);
 		if (ret) {
 			goto error;
 		}
 
-		ret = dwarf_lowpc(die->dwarf_die, &low_addr);
+		ret = dwarf_lowpc(&die.dwarf_die, &low_addr);
 		if (ret) {
 			free(die_name);
 			goto error;
@@ -1027,11 +1413,9 @@ int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
 		}
 	}
 
-	bt_dwarf_die_destroy(die);
 	return 0;
 
 error:
-	bt_dwarf_die_destroy(die);
 	return -1;
 }
 
@@ -1049,32 +1433,265 @@ error:
  * @param func_name	Out parameter, the function name
  * @returns		0 on success, -1 on failure
  */
+/*
+ * Entry of the compile unit (CU) address range index of a bin_info
+ * (`struct bin_info::dwarf_cu_ranges`).
+ */
+struct bin_info_cu_range {
+	/* Address range [low, high) */
+	uint64_t low;
+	uint64_t high;
+
+	/*
+	 * Greatest `high` value of this entry and of all the entries
+	 * before it in the index.
+	 */
+	uint64_t max_high;
+
+	struct bt_dwarf_cu cu;
+};
+
+static
+gint compare_cu_ranges(gconstpointer a, gconstpointer b)
+{
+	const struct bin_info_cu_range *range_a = a;
+	const struct bin_info_cu_range *range_b = b;
+
+	if (range_a->low != range_b->low) {
+		return range_a->low < range_b->low ? -1 : 1;
+	}
+
+	if (range_a->cu.offset != range_b->cu.offset) {
+		return range_a->cu.offset < range_b->cu.offset ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Build the compile unit (CU) address range index of a given
+ * executable, if it's not already done.
+ *
+ * The index contains the address ranges of each CU from its
+ * `DW_AT_low_pc`/`DW_AT_high_pc` or `DW_AT_ranges` attributes, sorted
+ * by low address. The CUs without any address range are kept apart
+ * (`struct bin_info::dwarf_unranged_cus`) as they can contain any
+ * address.
+ *
+ * @param bin		bin_info instance for the executable
+ * @returns		0 on success, -1 on failure
+ */
 static
-int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
-		char **func_name)
+int bin_info_build_dwarf_cu_ranges(struct bin_info *bin)
 {
-	int ret = 0;
-	char *_func_name = NULL;
 	struct bt_dwarf_cu *cu = NULL;
+	GArray *ranges = NULL;
+	GArray *unranged_cus = NULL;
+	uint64_t max_high = 0;
+	guint i;
 
-	if (!bin || !func_name) {
-		goto error;
+	if (bin->image->dwarf_cu_ranges) {
+		goto end;
 	}
 
-	cu = bt_dwarf_cu_create(bin->dwarf_info);
+	cu = bt_dwarf_cu_create(bin->image->dwarf_info);
 	if (!cu) {
 		goto error;
 	}
 
+	ranges = g_array_new(FALSE, FALSE, sizeof(struct bin_info_cu_range));
+	if (!ranges) {
+		goto error;
+	}
+
+	unranged_cus = g_array_new(FALSE, FALSE, sizeof(struct bt_dwarf_cu));
+	if (!unranged_cus) {
+		goto error;
+	}
+
 	while (bt_dwarf_cu_next(cu) == 0) {
-		ret = bin_info_lookup_cu_function_name(cu, addr, &_func_name);
-		if (ret) {
+		Dwarf_Die cu_die;
+		Dwarf_Addr base, start, end;
+		ptrdiff_t offset = 0;
+		bool has_range = false;
+
+		if (!dwarf_offdie(cu->dwarf_info, cu->offset + cu->header_size,
+				&cu_die)) {
 			goto error;
 		}
 
-		if (_func_name) {
+		while ((offset = dwarf_ranges(&cu_die, offset, &base, &start,
+				&end)) > 0) {
+			struct bin_info_cu_range range;
+
+			if (start >= end) {
+				continue;
+			}
+
+			range.low = start;
+			range.high = end;
+			range.cu = *cu;
+			g_array_append_val(ranges, range);
+			has_range = true;
+		}
+
+		if (offset < 0 || !has_range) {
+			/*
+			 * Without a reliable address range, this CU
+			 * needs to be searched for any address.
+			 */
+			g_array_append_val(unranged_cus, *cu);
+		}
+	}
+
+	g_array_sort(ranges, compare_cu_ranges);
+
+	for (i = 0; i < ranges->len; i++) {
+		struct bin_info_cu_range *range = &g_array_index(ranges,
+			struct bin_info_cu_range, i);
+
+		if (range->high > max_high) {
+			max_high = range->high;
+		}
+
+		range->max_high = max_high;
+	}
+
+	BT_COMP_LOGD("Built DWARF CU address range index: "
+		"path=\"%s\", range-count=%u, unranged-cu-count=%u",
+		bin->image->dwarf_path, ranges->len, unranged_cus->len);
+	bin->image->dwarf_cu_ranges = ranges;
+	bin->image->dwarf_unranged_cus = unranged_cus;
+	bt_dwarf_cu_destroy(cu);
+
+end:
+	return 0;
+
+error:
+	if (ranges) {
+		g_array_free(ranges, TRUE);
+	}
+
+	if (unranged_cus) {
+		g_array_free(unranged_cus, TRUE);
+	}
+
+	bt_dwarf_cu_destroy(cu);
+	return -1;
+}
+
+/*
+ * Function which looks for something at a given address within a
+ * given compile unit (CU), setting `*found` to true if it finds it.
+ */
+typedef int (*bin_info_cu_lookup_func)(struct bt_dwarf_cu *cu,
+		uint64_t addr, void *data, bool *found);
+
+/**
+ * Call a given lookup function for each compile unit (CU) of a given
+ * executable which could contain a given address, until it finds
+ * what it's looking for.
+ *
+ * The function first tries the CUs of which an address range contains
+ * `addr`, using the CU address range index, and then the CUs without
+ * any address range.
+ *
+ * @param bin		bin_info instance for the executable
+ * @param addr		Virtual memory address to look for
+ * @param func		Lookup function to call for each CU
+ * @param data		User data to pass to `func`
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_lookup_dwarf_cus(struct bin_info *bin, uint64_t addr,
+		bin_info_cu_lookup_func func, void *data)
+{
+	int ret;
+	bool found = false;
+	guint low = 0;
+	guint high;
+	guint i;
+
+	ret = bin_info_build_dwarf_cu_ranges(bin);
+	if (ret) {
+		goto end;
+	}
+
+	/* Find the last range of which the low address is at most `addr` */
+	high = bin->image->dwarf_cu_ranges->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (g_array_index(bin->image->dwarf_cu_ranges,
+				struct bin_info_cu_range, mid).low <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	/*
+	 * Walk back the ranges which could still contain `addr`:
+	 * `max_high` is the greatest high address so far.
+	 */
+	for (i = low; i > 0; i--) {
+		struct bin_info_cu_range *range = &g_array_index(
+			bin->image->dwarf_cu_ranges, struct bin_info_cu_range, i - 1);
+
+		if (range->max_high <= addr) {
 			break;
 		}
+
+		if (addr >= range->high) {
+			continue;
+		}
+
+		ret = func(&range->cu, addr, data, &found);
+		if (ret || found) {
+			goto end;
+		}
+	}
+
+	for (i = 0; i < bin->image->dwarf_unranged_cus->len; i++) {
+		ret = func(&g_array_index(bin->image->dwarf_unranged_cus,
+			struct bt_dwarf_cu, i), addr, data, &found);
+		if (ret || found) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+int lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
+		void *data, bool *found)
+{
+	char **func_name = data;
+	int ret;
+
+	ret = bin_info_lookup_cu_function_name(cu, addr, func_name);
+	*found = *func_name;
+	return ret;
+}
+
+static
+int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
+		char **func_name)
+{
+	int ret = 0;
+	char *_func_name = NULL;
+
+	if (!bin || !func_name) {
+		goto error;
+	}
+
+	ret = bin_info_lookup_dwarf_cus(bin, addr, lookup_cu_function_name,
+		&_func_name);
+	if (ret) {
+		goto error;
 	}
 
 	if (_func_name) {
@@ -1083,11 +1700,10 @@ int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
 		goto error;
 	}
 
-	bt_dwarf_cu_destroy(cu);
 	return 0;
 
 error:
-	bt_dwarf_cu_destroy(cu);
+	g_free(_func_name);
 	return -1;
 }
 
@@ -1102,6 +1718,8 @@ int bin_info_lookup_function_name(struct bin_info *bin,
 		goto error;
 	}
 
+	bin_info_apply_deferred_build_id(bin);
+
 	/*
 	 * If the bin_info has a build id but it does not match the build id
 	 * that was found on the file system, return an error.
@@ -1110,8 +1728,12 @@ int bin_info_lookup_function_name(struct bin_info *bin,
 		goto error;
 	}
 
+	if (bin_info_acquire_image(bin)) {
+		goto error;
+	}
+
 	/* Set DWARF info if it hasn't been accessed yet. */
-	if (!bin->dwarf_info && !bin->is_elf_only) {
+	if (!bin->image->dwarf_info && !bin->is_elf_only) {
 		ret = bin_info_set_dwarf_info(bin);
 		if (ret) {
 			BT_COMP_LOGI_STR("Failed to set bin dwarf info, falling "
@@ -1165,6 +1787,8 @@ int bin_info_get_bin_loc(struct bin_info *bin, uint64_t addr, char **bin_loc)
 		goto error;
 	}
 
+	bin_info_apply_deferred_build_id(bin);
+
 	/*
 	 * If the bin_info has a build id but it does not match the build id
 	 * that was found on the file system, return an error.
@@ -1291,22 +1915,22 @@ int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 {
 	int ret = 0;
 	bool found = false;
-	struct bt_dwarf_die *die = NULL;
+	struct bt_dwarf_die die;
 	struct source_location *_src_loc = NULL;
 
 	if (!cu || !src_loc) {
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	ret = bt_dwarf_die_init(&die, cu);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_die_next(die) == 0) {
+	while (bt_dwarf_die_next(&die) == 0) {
 		int tag;
 
-		ret = bt_dwarf_die_get_tag(die, &tag);
+		ret = bt_dwarf_die_get_tag(&die, &tag);
 		if (ret) {
 			goto error;
 		}
@@ -1314,7 +1938,7 @@ int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 		if (tag == DW_TAG_subprogram) {
 			bool contains = false;
 
-			ret = bt_dwarf_die_contains_addr(die, addr, &contains);
+			ret = bt_dwarf_die_contains_addr(&die, addr, &contains);
 			if (ret) {
 				goto error;
 			}
@@ -1324,7 +1948,7 @@ int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 				 * Try to find an inlined subroutine
 				 * child of this DIE containing addr.
 				 */
-				ret = bin_info_child_die_has_address(die, addr,
+				ret = bin_info_child_die_has_address(&die, addr,
 						&found);
 				if(ret) {
 					goto error;
@@ -1345,11 +1969,11 @@ end:
 			goto error;
 		}
 
-		ret = bt_dwarf_die_get_call_file(die, &filename);
+		ret = bt_dwarf_die_get_call_file(&die, &filename);
 		if (ret) {
 			goto error;
 		}
-		ret = bt_dwarf_die_get_call_line(die, &line_no);
+		ret = bt_dwarf_die_get_call_line(&die, &line_no);
 		if (ret) {
 			free(filename);
 			goto error;
@@ -1360,12 +1984,10 @@ end:
 		*src_loc = _src_loc;
 	}
 
-	bt_dwarf_die_destroy(die);
 	return 0;
 
 error:
 	source_location_destroy(_src_loc);
-	bt_dwarf_die_destroy(die);
 	return -1;
 }
 
@@ -1391,7 +2013,7 @@ int bin_info_lookup_cu_src_loc_no_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 		struct source_location **src_loc)
 {
 	struct source_location *_src_loc = NULL;
-	struct bt_dwarf_die *die = NULL;
+	struct bt_dwarf_die die;
 	const char *filename = NULL;
 	Dwarf_Line *line = NULL;
 	Dwarf_Addr line_addr;
@@ -1401,12 +2023,12 @@ int bin_info_lookup_cu_src_loc_no_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	ret = bt_dwarf_die_init(&die, cu);
+	if (ret) {
 		goto error;
 	}
 
-	line = dwarf_getsrc_die(die->dwarf_die, addr);
+	line = dwarf_getsrc_die(&die.dwarf_die, addr);
 	if (!line) {
 		/* This is not an error. The caller needs to keep looking. */
 		goto end;
@@ -1447,7 +2069,6 @@ error:
 	source_location_destroy(_src_loc);
 	ret = -1;
 end:
-	bt_dwarf_die_destroy(die);
 	return ret;
 }
 
@@ -1506,17 +2127,30 @@ error:
 	return -1;
 }
 
+static
+int lookup_cu_src_loc(struct bt_dwarf_cu *cu, uint64_t addr, void *data,
+		bool *found)
+{
+	struct source_location **src_loc = data;
+	int ret;
+
+	ret = bin_info_lookup_cu_src_loc(cu, addr, src_loc);
+	*found = *src_loc;
+	return ret;
+}
+
 BT_HIDDEN
 int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		struct source_location **src_loc)
 {
-	struct bt_dwarf_cu *cu = NULL;
 	struct source_location *_src_loc = NULL;
 
 	if (!bin || !src_loc) {
 		goto error;
 	}
 
+	bin_info_apply_deferred_build_id(bin);
+
 	/*
 	 * If the bin_info has a build id but it does not match the build id
 	 * that was found on the file system, return an error.
@@ -1525,8 +2159,12 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		goto error;
 	}
 
+	if (bin_info_acquire_image(bin)) {
+		goto error;
+	}
+
 	/* Set DWARF info if it hasn't been accessed yet. */
-	if (!bin->dwarf_info && !bin->is_elf_only) {
+	if (!bin->image->dwarf_info && !bin->is_elf_only) {
 		if (bin_info_set_dwarf_info(bin)) {
 			/* Failed to set DWARF info. */
 			bin->is_elf_only = true;
@@ -1550,25 +2188,11 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		addr -= bin->low_addr;
 	}
 
-	cu = bt_dwarf_cu_create(bin->dwarf_info);
-	if (!cu) {
+	if (bin_info_lookup_dwarf_cus(bin, addr, lookup_cu_src_loc,
+			&_src_loc)) {
 		goto error;
 	}
 
-	while (bt_dwarf_cu_next(cu) == 0) {
-		int ret;
-
-		ret = bin_info_lookup_cu_src_loc(cu, addr, &_src_loc);
-		if (ret) {
-			goto error;
-		}
-
-		if (_src_loc) {
-			break;
-		}
-	}
-
-	bt_dwarf_cu_destroy(cu);
 	if (_src_loc) {
 		*src_loc = _src_loc;
 	}
@@ -1577,6 +2201,5 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 
 error:
 	source_location_destroy(_src_loc);
-	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
@@ -23,6 +23,23 @@
 #define BUILD_ID_SUFFIX ".debug"
 #define BUILD_ID_PREFIX_DIR_LEN 2
 
+/*
+ * Parsed ELF and DWARF files of an executable, which the bin infos of
+ * the same executable in different processes share (see
+ * `struct bin_info_registry`).
+ */
+struct bin_info_image;
+
+/*
+ * Registry of the images of the executables which the bin infos
+ * created with it look up, keyed by path, build ID, and debug link.
+ *
+ * An image is parsed and indexed once, the first time a bin info
+ * needs it, and then shared by all the bin infos of the same
+ * executable, whatever their process and base address.
+ */
+struct bin_info_registry;
+
 struct bin_info {
 	bt_logging_level log_level;
 
@@ -35,22 +52,28 @@ struct bin_info {
 	uint64_t high_addr;
 	/* Size of exec address space. */
 	uint64_t memsz;
-	/* Paths to ELF and DWARF files. */
+	/* Path to ELF file. */
 	gchar *elf_path;
-	gchar *dwarf_path;
-	/* libelf and libdw objects representing the files. */
-	Elf *elf_file;
-	Dwarf *dwarf_info;
+	/*
+	 * Parsed ELF and DWARF files, acquired on first use, or `NULL`
+	 * before (owned by this).
+	 */
+	struct bin_info_image *image;
+	/* Weak ref: registry from which to acquire `image`, or `NULL`. */
+	struct bin_info_registry *registry;
 	/* Optional build ID info. */
 	uint8_t *build_id;
 	size_t build_id_len;
+	/*
+	 * Build ID set with bin_info_set_build_id_deferred() which is
+	 * not checked against the file yet, or `NULL`.
+	 */
+	uint8_t *deferred_build_id;
+	size_t deferred_build_id_len;
 
 	/* Optional debug link info. */
 	gchar *dbg_link_filename;
 	uint32_t dbg_link_crc;
-	/* fd cache handles to ELF and DWARF files. */
-	struct bt_fd_cache_handle *elf_handle;
-	struct bt_fd_cache_handle *dwarf_handle;
 	/* Configuration. */
 	gchar *debug_info_dir;
 	/* Denotes whether the executable is position independent code. */
@@ -81,10 +104,34 @@ BT_HIDDEN
 int bin_info_init(bt_logging_level log_level,
 		bt_self_component *self_comp);
 
+/**
+ * Creates an empty bin info image registry.
+ *
+ * @returns		Pointer to the new registry on success,
+ *			NULL on failure.
+ */
+BT_HIDDEN
+struct bin_info_registry *bin_info_registry_create(void);
+
+/**
+ * Destroys the given bin info image registry.
+ *
+ * All the bin infos created with \p registry must be destroyed
+ * before.
+ *
+ * @param registry	Registry to destroy
+ */
+BT_HIDDEN
+void bin_info_registry_destroy(struct bin_info_registry *registry);
+
 /**
  * Instantiate a structure representing an ELF executable, possibly
  * with DWARF info, located at the given path.
  *
+ * @param fdc		fd cache from which to open the files
+ * @param registry	Registry from which to acquire the parsed files of
+ *			the executable, or NULL to parse them for this
+ *			bin_info only
  * @param path		Path to the ELF file
  * @param low_addr	Base address of the executable
  * @param memsz	In-memory size of the executable
@@ -97,7 +144,8 @@ int bin_info_init(bt_logging_level log_level,
  *			NULL on failure.
  */
 BT_HIDDEN
-struct bin_info *bin_info_create(struct bt_fd_cache *fdc, const char *path,
+struct bin_info *bin_info_create(struct bt_fd_cache *fdc,
+		struct bin_info_registry *registry, const char *path,
 		uint64_t low_addr, uint64_t memsz, bool is_pic,
 		const char *debug_info_dir, const char *target_prefix,
 		bt_logging_level log_level, bt_self_component *self_comp);
@@ -123,6 +171,32 @@ BT_HIDDEN
 int bin_info_set_build_id(struct bin_info *bin, uint8_t *build_id,
 		size_t build_id_len);
 
+/**
+ * Sets the build ID information for a given bin_info instance like
+ * bin_info_set_build_id() does, but only when a lookup first needs it
+ * (or when calling bin_info_apply_deferred_build_id()), so that the
+ * file of an executable of which no address is looked up is never
+ * opened.
+ *
+ * @param bin		The bin_info instance for which to set
+ *			the build ID
+ * @param build_id	Array of bytes containing the actual ID
+ * @param build_id_len	Length in bytes of the build_id
+ * @returns		0 on success, -1 on failure
+ */
+BT_HIDDEN
+int bin_info_set_build_id_deferred(struct bin_info *bin, uint8_t *build_id,
+		size_t build_id_len);
+
+/**
+ * Sets the build ID which bin_info_set_build_id_deferred() deferred,
+ * if any, checking it against the file found on the file system.
+ *
+ * @param bin		bin_info instance
+ */
+BT_HIDDEN
+void bin_info_apply_deferred_build_id(struct bin_info *bin);
+
 /**
  * Sets the debug link information for a given bin_info instance.
  *
@@ -4,8 +4,17 @@
  * Copyright (c) 1991, 1993 The Regents of the University of California.
  */
 
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <glib.h>
+
+#include "compat/mman.h"
 #include "crc32.h"
 
+/* Size of the buffer used when the file can't be memory-mapped */
+#define CRC_READ_BUF_LEN	(64 * 1024)
+
 #define CRC(crc, ch)	 (crc = (crc >> 8) ^ crctab[(crc ^ (ch)) & 0xff])
 
 /* generated using the AUTODIN II polynomial
@@ -79,29 +88,170 @@ static const uint32_t crctab[256] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
 };
 
-int crc32(int fd, uint32_t *crc)
+/*
+ * Tables for the slicing-by-8 algorithm: `crc_slice_tabs[k][i]` is the
+ * CRC of byte `i` followed by `k` zero bytes, `crc_slice_tabs[0]` being
+ * `crctab`.
+ */
+static uint32_t crc_slice_tabs[8][256];
+
+static
+void init_crc_slice_tabs(void)
 {
-	int nr;
-	uint32_t _crc = ~0;
-	char buf[BUFSIZ], *p;
+	static gsize initialized = 0;
+	unsigned int i, k;
 
-	if (fd < 0 || !crc) {
-		goto error;
+	if (!g_once_init_enter(&initialized)) {
+		return;
 	}
 
-	while ((nr = read(fd, buf, sizeof(buf))) > 0) {
-		for (p = buf; nr--; ++p) {
-			CRC(_crc, *p);
+	for (i = 0; i < 256; i++) {
+		crc_slice_tabs[0][i] = crctab[i];
+	}
+
+	for (k = 1; k < 8; k++) {
+		for (i = 0; i < 256; i++) {
+			uint32_t prev = crc_slice_tabs[k - 1][i];
+
+			crc_slice_tabs[k][i] = (prev >> 8) ^ crctab[prev & 0xff];
 		}
 	}
 
+	g_once_init_leave(&initialized, 1);
+}
+
+static inline
+uint32_t load_le32(const uint8_t *p)
+{
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+		((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/*
+ * Updates `crc` with the `len` bytes at `buf`, eight bytes at a time.
+ */
+static
+uint32_t crc_update(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	const uint8_t *p = buf;
+
+	while (len >= 8) {
+		const uint32_t lo = crc ^ load_le32(p);
+		const uint32_t hi = load_le32(p + 4);
+
+		crc = crc_slice_tabs[7][lo & 0xff] ^
+			crc_slice_tabs[6][(lo >> 8) & 0xff] ^
+			crc_slice_tabs[5][(lo >> 16) & 0xff] ^
+			crc_slice_tabs[4][lo >> 24] ^
+			crc_slice_tabs[3][hi & 0xff] ^
+			crc_slice_tabs[2][(hi >> 8) & 0xff] ^
+			crc_slice_tabs[1][(hi >> 16) & 0xff] ^
+			crc_slice_tabs[0][hi >> 24];
+		p += 8;
+		len -= 8;
+	}
+
+	while (len--) {
+		CRC(crc, *p);
+		p++;
+	}
+
+	return crc;
+}
+
+/*
+ * Updates `*crc` with the contents of the file `fd` using a
+ * memory mapping of the whole file.
+ *
+ * Returns 0 on success, or -1 if the file can't be mapped.
+ */
+static
+int crc_update_mmap(int fd, size_t len, uint32_t *crc, int log_level)
+{
+	void *addr;
+
+	addr = bt_mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0, log_level);
+	if (addr == MAP_FAILED) {
+		return -1;
+	}
+
+	bt_mmap_advise_sequential(addr, len);
+	*crc = crc_update(*crc, addr, len);
+	(void) bt_munmap(addr, len);
+	return 0;
+}
+
+/*
+ * Updates `*crc` with the contents of the file `fd`, reading it
+ * from its beginning.
+ */
+static
+int crc_update_read(int fd, uint32_t *crc)
+{
+	int ret = 0;
+	uint8_t *buf;
+	ssize_t nr;
+
+	buf = malloc(CRC_READ_BUF_LEN);
+	if (!buf) {
+		goto error;
+	}
+
+	if (lseek(fd, 0, SEEK_SET) < 0) {
+		goto error;
+	}
+
+	while ((nr = read(fd, buf, CRC_READ_BUF_LEN)) > 0) {
+		*crc = crc_update(*crc, buf, nr);
+	}
+
 	if (nr < 0) {
 		goto error;
 	}
 
+	goto end;
+
+error:
+	ret = -1;
+end:
+	free(buf);
+	return ret;
+}
+
+int crc32(int fd, uint32_t *crc, int log_level)
+{
+	int ret = 0;
+	struct stat statbuf;
+	uint32_t _crc = ~0;
+
+	if (fd < 0 || !crc) {
+		goto error;
+	}
+
+	init_crc_slice_tabs();
+
+	if (fstat(fd, &statbuf) < 0) {
+		goto error;
+	}
+
+	/*
+	 * Prefer a memory mapping of the whole file, falling back to
+	 * reading it, for example if it's too large for the address
+	 * space.
+	 */
+	if (statbuf.st_size == 0 || (uint64_t) statbuf.st_size > SIZE_MAX ||
+			crc_update_mmap(fd, statbuf.st_size, &_crc, log_level)) {
+		ret = crc_update_read(fd, &_crc);
+		if (ret) {
+			goto error;
+		}
+	}
+
 	*crc = ~_crc;
-	return 0;
+	goto end;
 
 error:
-	return -1;
+	ret = -1;
+end:
+	return ret;
 }
@@ -18,11 +18,16 @@
  * On success, the out parameter crc is set with the computed checksum
  * value,
  *
- * @param fd	File descriptor for the file for which to compute the CRC
- * @param crc	Out parameter, the computed checksum
- * @returns	0 on success, -1 on failure.
+ * The checksum covers the whole file, whatever the current offset of
+ * fd.
+ *
+ * @param fd		File descriptor for the file for which to compute
+ *			the CRC
+ * @param crc		Out parameter, the computed checksum
+ * @param log_level	Logging level
+ * @returns		0 on success, -1 on failure.
  */
 BT_HIDDEN
-int crc32(int fd, uint32_t *crc);
+int crc32(int fd, uint32_t *crc, int log_level);
 
 #endif	/* _BABELTRACE_CRC32_H */
@@ -25,6 +25,7 @@
 
 #include "bin-info.h"
 #include "debug-info.h"
+#include "symbol-cache.h"
 #include "trace-ir-data-copy.h"
 #include "trace-ir-mapping.h"
 #include "trace-ir-metadata-copy.h"
@@ -43,6 +44,19 @@
 #define MEMSZ_FIELD_NAME		"memsz"
 #define PATH_FIELD_NAME			"path"
 
+/* Fields of the debug info structure field to compute */
+enum debug_info_fields {
+	DEBUG_INFO_FIELDS_BIN	= 1 << 0,
+	DEBUG_INFO_FIELDS_FUNC	= 1 << 1,
+	DEBUG_INFO_FIELDS_SRC	= 1 << 2,
+	DEBUG_INFO_FIELDS_ALL	= DEBUG_INFO_FIELDS_BIN |
+				  DEBUG_INFO_FIELDS_FUNC |
+				  DEBUG_INFO_FIELDS_SRC,
+};
+
+/* Maximum number of entries of the IP cache of a process */
+#define PROC_IP_CACHE_MAX_ENTRIES	4096
+
 struct debug_info_component {
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
@@ -50,7 +64,30 @@ struct debug_info_component {
 	gchar *arg_debug_dir;
 	gchar *arg_debug_info_field_name;
 	gchar *arg_target_prefix;
+	gchar *arg_symbol_cache_dir;
 	bt_bool arg_full_path;
+
+	/* Fields to compute (mask of `enum debug_info_fields`) */
+	unsigned int arg_fields;
+};
+
+/*
+ * Debug info query of an event message of the current run of
+ * debug_info_msg_iter_next() (see prefetch_debug_info_sources()).
+ */
+struct debug_info_batch_query {
+	/* Index of the event message within the received message array */
+	uint64_t msg_idx;
+
+	/* Weak refs */
+	struct debug_info *debug_info;
+	struct proc_debug_info_sources *proc_dbg_info_src;
+	struct bin_info *bin;
+
+	uint64_t ip;
+
+	/* Resolved debug info source, or `NULL` if none; weak ref */
+	struct debug_info_source *debug_info_src;
 };
 
 struct debug_info_msg_iter {
@@ -64,7 +101,30 @@ struct debug_info_msg_iter {
 	/* in_trace -> debug_info_mapping. */
 	GHashTable *debug_info_map;
 
+	/*
+	 * in_trace -> (struct trace_pass_through *): whether or not this
+	 * iterator forwards the messages of an input trace as is.
+	 */
+	GHashTable *pass_through_map;
+
 	struct bt_fd_cache fd_cache;
+
+	/*
+	 * Parsed executables shared by the bin infos of all the traces
+	 * and processes of `debug_info_map`.
+	 */
+	struct bin_info_registry *bin_registry;
+
+	/*
+	 * Queries (array of `struct debug_info_batch_query`) of the
+	 * current run of event messages of debug_info_msg_iter_next(),
+	 * sorted by message index, and index of the next one to use.
+	 */
+	GArray *batch_queries;
+	guint next_batch_query_idx;
+
+	/* Query of the event message being handled, or `NULL` */
+	const struct debug_info_batch_query *cur_batch_query;
 };
 
 struct debug_info_source {
@@ -88,6 +148,17 @@ struct debug_info_source {
 	gchar *bin_loc;
 };
 
+/* Entry of the IP cache of a process */
+struct ip_cache_entry {
+	uint64_t ip;
+
+	/* Owned by this */
+	struct debug_info_source *debug_info_src;
+
+	/* Link within `proc_debug_info_sources::ip_cache_lru` */
+	GList link;
+};
+
 struct proc_debug_info_sources {
 	/*
 	 * Hash table: base address (pointer to uint64_t) to bin info; owned by
@@ -96,10 +167,23 @@ struct proc_debug_info_sources {
 	GHashTable *baddr_to_bin_info;
 
 	/*
-	 * Hash table: IP (pointer to uint64_t) to (struct debug_info_source *);
+	 * Array of (struct bin_info *), the bin infos of
+	 * `baddr_to_bin_info` sorted by low address, to find the
+	 * executable containing an address with a binary search.
+	 */
+	GArray *bin_infos_by_addr;
+
+	/*
+	 * Hash table: IP (pointer to uint64_t) to (struct ip_cache_entry *);
 	 * owned by proc_debug_info_sources.
+	 *
+	 * Contains at most `PROC_IP_CACHE_MAX_ENTRIES` entries: when it's
+	 * full, adding an entry evicts the least recently used one.
 	 */
 	GHashTable *ip_to_debug_info_src;
+
+	/* Entries of `ip_to_debug_info_src`, most recently used first */
+	GQueue ip_cache_lru;
 };
 
 struct debug_info {
@@ -122,6 +206,14 @@ struct debug_info {
 	GQuark q_lib_load;
 	GQuark q_lib_unload;
 	struct bt_fd_cache *fd_cache; /* Weak ref. Owned by the iterator. */
+	struct bin_info_registry *bin_registry; /* Weak ref. Owned by the iterator. */
+
+	/*
+	 * Hash table of hexadecimal build IDs (gchar *) to
+	 * (struct debug_info_symbol_cache *); owned by debug_info.
+	 * `NULL` without a symbolization cache directory.
+	 */
+	GHashTable *build_id_to_symbol_cache;
 };
 
 static
@@ -157,14 +249,72 @@ void debug_info_source_destroy(struct debug_info_source *debug_info_src)
 	g_free(debug_info_src);
 }
 
+/*
+ * Returns the symbolization cache to use for the executable `bin`, or
+ * `NULL` if none.
+ */
+static
+struct debug_info_symbol_cache *borrow_bin_symbol_cache(
+		struct debug_info *debug_info, struct bin_info *bin)
+{
+	struct debug_info_symbol_cache *cache = NULL;
+	GString *build_id;
+	size_t i;
+
+	if (!debug_info->build_id_to_symbol_cache) {
+		goto end;
+	}
+
+	bin_info_apply_deferred_build_id(bin);
+
+	/*
+	 * Only trust a build ID which matches the file found on the file
+	 * system: the lookups fail otherwise.
+	 */
+	if (!debug_info->build_id_to_symbol_cache || !bin->build_id ||
+			!bin->file_build_id_matches) {
+		goto end;
+	}
+
+	build_id = g_string_new(NULL);
+
+	for (i = 0; i < bin->build_id_len; i++) {
+		g_string_append_printf(build_id, "%02x", bin->build_id[i]);
+	}
+
+	cache = g_hash_table_lookup(debug_info->build_id_to_symbol_cache,
+		build_id->str);
+	if (cache) {
+		g_string_free(build_id, TRUE);
+		goto end;
+	}
+
+	cache = debug_info_symbol_cache_create(
+		debug_info->comp->arg_symbol_cache_dir, bin->build_id,
+		bin->build_id_len, debug_info->log_level,
+		debug_info->self_comp);
+
+	/* Ownership of the string of `build_id` passed to ht. */
+	g_hash_table_insert(debug_info->build_id_to_symbol_cache,
+		g_string_free(build_id, FALSE), cache);
+
+end:
+	return cache;
+}
+
 static
 struct debug_info_source *debug_info_source_create_from_bin(
 		struct bin_info *bin, uint64_t ip,
-		bt_self_component *self_comp)
+		struct debug_info_symbol_cache *symbol_cache,
+		unsigned int fields, bt_self_component *self_comp)
 {
 	int ret;
 	struct debug_info_source *debug_info_src = NULL;
 	struct source_location *src_loc = NULL;
+	const char *func = NULL;
+	const char *src_path = NULL;
+	uint64_t line_no = DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO;
+	uint64_t cache_addr;
 	bt_logging_level log_level;
 
 	BT_ASSERT(bin);
@@ -177,32 +327,64 @@ struct debug_info_source *debug_info_source_create_from_bin(
 		goto end;
 	}
 
-	/* Lookup function name */
-	ret = bin_info_lookup_function_name(bin, ip, &debug_info_src->func);
-	if (ret) {
-		goto error;
-	}
+	/* Same address as the ELF and DWARF lookups use */
+	cache_addr = bin->is_pic ? ip - bin->low_addr : ip;
 
-	/* Can't retrieve src_loc from ELF, or could not find binary, skip. */
-	if (!bin->is_elf_only || !debug_info_src->func) {
-		/* Lookup source location */
-		ret = bin_info_lookup_source_location(bin, ip, &src_loc);
-		if (ret) {
-			BT_COMP_LOGI("Failed to lookup source location: ret=%d", ret);
+	if (symbol_cache && debug_info_symbol_cache_lookup(symbol_cache,
+			cache_addr, &func, &src_path, &line_no)) {
+		if (func) {
+			debug_info_src->func = g_strdup(func);
+			if (!debug_info_src->func) {
+				goto error;
+			}
+		}
+	} else {
+		if (fields & DEBUG_INFO_FIELDS_FUNC) {
+			/* Lookup function name */
+			ret = bin_info_lookup_function_name(bin, ip,
+				&debug_info_src->func);
+			if (ret) {
+				goto error;
+			}
+		}
+
+		/*
+		 * Can't retrieve src_loc from ELF, or could not find
+		 * binary, skip.
+		 */
+		if ((fields & DEBUG_INFO_FIELDS_SRC) &&
+				(!bin->is_elf_only || !debug_info_src->func)) {
+			/* Lookup source location */
+			ret = bin_info_lookup_source_location(bin, ip, &src_loc);
+			if (ret) {
+				BT_COMP_LOGI("Failed to lookup source location: ret=%d", ret);
+			}
+		}
+
+		if (src_loc) {
+			line_no = src_loc->line_no;
+			src_path = src_loc->filename;
+		}
+
+		/* A cache entry needs the results of both lookups */
+		if (symbol_cache && (fields & DEBUG_INFO_FIELDS_FUNC) &&
+				(fields & DEBUG_INFO_FIELDS_SRC)) {
+			debug_info_symbol_cache_add(symbol_cache, cache_addr,
+				debug_info_src->func, src_path, line_no);
 		}
 	}
 
-	if (src_loc) {
+	if (line_no != DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO) {
 		debug_info_src->line_no =
-			g_strdup_printf("%"PRId64, src_loc->line_no);
+			g_strdup_printf("%"PRId64, line_no);
 		if (!debug_info_src->line_no) {
 			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
 				"Error occurred when setting `line_no` field.");
 			goto error;
 		}
 
-		if (src_loc->filename) {
-			debug_info_src->src_path = g_strdup(src_loc->filename);
+		if (src_path) {
+			debug_info_src->src_path = g_strdup(src_path);
 			if (!debug_info_src->src_path) {
 				goto error;
 			}
@@ -210,9 +392,11 @@ struct debug_info_source *debug_info_source_create_from_bin(
 			debug_info_src->short_src_path = get_filename_from_path(
 				debug_info_src->src_path);
 		}
-		source_location_destroy(src_loc);
 	}
 
+	source_location_destroy(src_loc);
+	src_loc = NULL;
+
 	if (bin->elf_path) {
 		debug_info_src->bin_path = g_strdup(bin->elf_path);
 		if (!debug_info_src->bin_path) {
@@ -222,9 +406,12 @@ struct debug_info_source *debug_info_source_create_from_bin(
 		debug_info_src->short_bin_path = get_filename_from_path(
 			debug_info_src->bin_path);
 
-		ret = bin_info_get_bin_loc(bin, ip, &(debug_info_src->bin_loc));
-		if (ret) {
-			goto error;
+		if (fields & DEBUG_INFO_FIELDS_BIN) {
+			ret = bin_info_get_bin_loc(bin, ip,
+				&(debug_info_src->bin_loc));
+			if (ret) {
+				goto error;
+			}
 		}
 	}
 
@@ -232,10 +419,22 @@ end:
 	return debug_info_src;
 
 error:
+	source_location_destroy(src_loc);
 	debug_info_source_destroy(debug_info_src);
 	return NULL;
 }
 
+static
+void ip_cache_entry_destroy(struct ip_cache_entry *entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	debug_info_source_destroy(entry->debug_info_src);
+	g_free(entry);
+}
+
 static
 void proc_debug_info_sources_destroy(
 		struct proc_debug_info_sources *proc_dbg_info_src)
@@ -244,6 +443,10 @@ void proc_debug_info_sources_destroy(
 		return;
 	}
 
+	if (proc_dbg_info_src->bin_infos_by_addr) {
+		g_array_free(proc_dbg_info_src->bin_infos_by_addr, TRUE);
+	}
+
 	if (proc_dbg_info_src->baddr_to_bin_info) {
 		g_hash_table_destroy(proc_dbg_info_src->baddr_to_bin_info);
 	}
@@ -272,13 +475,22 @@ struct proc_debug_info_sources *proc_debug_info_sources_create(void)
 		goto error;
 	}
 
+	proc_dbg_info_src->bin_infos_by_addr = g_array_new(FALSE, FALSE,
+		sizeof(struct bin_info *));
+	if (!proc_dbg_info_src->bin_infos_by_addr) {
+		goto error;
+	}
+
+	/* Keys are owned by the entries */
 	proc_dbg_info_src->ip_to_debug_info_src = g_hash_table_new_full(
-		g_int64_hash, g_int64_equal, (GDestroyNotify) g_free,
-		(GDestroyNotify) debug_info_source_destroy);
+		g_int64_hash, g_int64_equal, NULL,
+		(GDestroyNotify) ip_cache_entry_destroy);
 	if (!proc_dbg_info_src->ip_to_debug_info_src) {
 		goto error;
 	}
 
+	g_queue_init(&proc_dbg_info_src->ip_cache_lru);
+
 end:
 	return proc_dbg_info_src;
 
@@ -435,61 +647,193 @@ bool event_has_payload_field(const bt_event *event,
 	return event_borrow_payload_field(event, field_name);
 }
 
+/*
+ * Returns the index, within `proc_dbg_info_src->bin_infos_by_addr`, of
+ * the first bin info of which the low address is greater than `addr`.
+ */
+static
+guint proc_debug_info_sources_bin_upper_bound(
+		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t addr)
+{
+	GArray *bins = proc_dbg_info_src->bin_infos_by_addr;
+	guint low = 0, high = bins->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		struct bin_info *bin = g_array_index(bins, struct bin_info *, mid);
+
+		if (bin->low_addr <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+static
+void proc_debug_info_sources_add_bin(
+		struct proc_debug_info_sources *proc_dbg_info_src,
+		struct bin_info *bin)
+{
+	guint i = proc_debug_info_sources_bin_upper_bound(proc_dbg_info_src,
+		bin->low_addr);
+
+	g_array_insert_val(proc_dbg_info_src->bin_infos_by_addr, i, bin);
+}
+
+static
+void proc_debug_info_sources_remove_bin(
+		struct proc_debug_info_sources *proc_dbg_info_src,
+		struct bin_info *bin)
+{
+	GArray *bins = proc_dbg_info_src->bin_infos_by_addr;
+	guint i = proc_debug_info_sources_bin_upper_bound(proc_dbg_info_src,
+		bin->low_addr);
+
+	/* Bin infos having the same low address are contiguous */
+	while (i > 0) {
+		i--;
+
+		if (g_array_index(bins, struct bin_info *, i) == bin) {
+			g_array_remove_index(bins, i);
+			break;
+		}
+	}
+}
+
+/*
+ * Returns the bin info of which the address range contains `addr`, or
+ * `NULL` if none.
+ *
+ * The mappings of a process don't overlap: only the bin info having
+ * the greatest low address which is less than or equal to `addr` can
+ * contain it.
+ */
+static
+struct bin_info *proc_debug_info_sources_find_bin(
+		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t addr)
+{
+	struct bin_info *bin = NULL;
+	guint i = proc_debug_info_sources_bin_upper_bound(proc_dbg_info_src,
+		addr);
+
+	if (i == 0) {
+		goto end;
+	}
+
+	bin = g_array_index(proc_dbg_info_src->bin_infos_by_addr,
+		struct bin_info *, i - 1);
+	if (!bin_info_has_address(bin, addr)) {
+		bin = NULL;
+	}
+
+end:
+	return bin;
+}
+
+static
+void proc_debug_info_sources_remove_ip_cache_entry(
+		struct proc_debug_info_sources *proc_dbg_info_src,
+		struct ip_cache_entry *entry)
+{
+	gboolean ret;
+
+	g_queue_unlink(&proc_dbg_info_src->ip_cache_lru, &entry->link);
+	ret = g_hash_table_remove(proc_dbg_info_src->ip_to_debug_info_src,
+		&entry->ip);
+	BT_ASSERT(ret);
+}
+
+/*
+ * Removes the IP cache entries of the addresses which `bin` contains,
+ * for example because it's unloaded.
+ */
+static
+void proc_debug_info_sources_purge_ip_cache(
+		struct proc_debug_info_sources *proc_dbg_info_src,
+		struct bin_info *bin)
+{
+	GList *link = proc_dbg_info_src->ip_cache_lru.head;
+
+	while (link) {
+		struct ip_cache_entry *entry = link->data;
+
+		link = link->next;
+
+		if (bin_info_has_address(bin, entry->ip)) {
+			proc_debug_info_sources_remove_ip_cache_entry(
+				proc_dbg_info_src, entry);
+		}
+	}
+}
+
+static
+void proc_debug_info_sources_clear(
+		struct proc_debug_info_sources *proc_dbg_info_src)
+{
+	g_hash_table_remove_all(proc_dbg_info_src->ip_to_debug_info_src);
+	g_queue_init(&proc_dbg_info_src->ip_cache_lru);
+	g_array_set_size(proc_dbg_info_src->bin_infos_by_addr, 0);
+	g_hash_table_remove_all(proc_dbg_info_src->baddr_to_bin_info);
+}
+
 static
 struct debug_info_source *proc_debug_info_sources_get_entry(
 		struct debug_info *debug_info,
 		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t ip)
 {
 	struct debug_info_source *debug_info_src = NULL;
-	gpointer key = g_new0(uint64_t, 1);
-	GHashTableIter iter;
-	gpointer baddr, value;
+	struct ip_cache_entry *entry;
+	struct bin_info *bin;
 
-	if (!key) {
+	/* Look in IP cache first. */
+	entry = g_hash_table_lookup(proc_dbg_info_src->ip_to_debug_info_src,
+		&ip);
+	if (entry) {
+		/* Now the most recently used entry */
+		g_queue_unlink(&proc_dbg_info_src->ip_cache_lru, &entry->link);
+		g_queue_push_head_link(&proc_dbg_info_src->ip_cache_lru,
+			&entry->link);
+		debug_info_src = entry->debug_info_src;
 		goto end;
 	}
 
-	*((uint64_t *) key) = ip;
-
-	/* Look in IP to debug infos hash table first. */
-	debug_info_src = g_hash_table_lookup(
-		proc_dbg_info_src->ip_to_debug_info_src, key);
-	if (debug_info_src) {
+	bin = proc_debug_info_sources_find_bin(proc_dbg_info_src, ip);
+	if (!bin) {
 		goto end;
 	}
 
-	/* Check in all bin_infos. */
-	g_hash_table_iter_init(&iter, proc_dbg_info_src->baddr_to_bin_info);
-
-	while (g_hash_table_iter_next(&iter, &baddr, &value))
-	{
-		struct bin_info *bin = value;
+	debug_info_src = debug_info_source_create_from_bin(bin, ip,
+		borrow_bin_symbol_cache(debug_info, bin),
+		debug_info->comp->arg_fields, debug_info->self_comp);
+	if (!debug_info_src) {
+		goto end;
+	}
 
-		if (!bin_info_has_address(value, ip)) {
-			continue;
-		}
+	/* Found; add it to cache, evicting the least recently used entry. */
+	if (g_queue_get_length(&proc_dbg_info_src->ip_cache_lru) >=
+			PROC_IP_CACHE_MAX_ENTRIES) {
+		proc_debug_info_sources_remove_ip_cache_entry(proc_dbg_info_src,
+			proc_dbg_info_src->ip_cache_lru.tail->data);
+	}
 
-		/*
-		 * Found; add it to cache.
-		 *
-		 * FIXME: this should be bounded in size (and implement
-		 * a caching policy), and entries should be prunned when
-		 * libraries are unmapped.
-		 */
-		debug_info_src = debug_info_source_create_from_bin(bin, ip,
-			debug_info->self_comp);
-		if (debug_info_src) {
-			g_hash_table_insert(
-				proc_dbg_info_src->ip_to_debug_info_src, key,
-				debug_info_src);
-			/* Ownership passed to ht. */
-			key = NULL;
-		}
-		break;
+	entry = g_new0(struct ip_cache_entry, 1);
+	if (!entry) {
+		debug_info_source_destroy(debug_info_src);
+		debug_info_src = NULL;
+		goto end;
 	}
 
+	entry->ip = ip;
+	entry->debug_info_src = debug_info_src;
+	entry->link.data = entry;
+	g_hash_table_insert(proc_dbg_info_src->ip_to_debug_info_src,
+		&entry->ip, entry);
+	g_queue_push_head_link(&proc_dbg_info_src->ip_cache_lru, &entry->link);
+
 end:
-	free(key);
 	return debug_info_src;
 }
 
@@ -515,7 +859,8 @@ end:
 
 static
 struct debug_info *debug_info_create(struct debug_info_component *comp,
-		const bt_trace *trace, struct bt_fd_cache *fdc)
+		const bt_trace *trace, struct bt_fd_cache *fdc,
+		struct bin_info_registry *bin_registry)
 {
 	int ret;
 	struct debug_info *debug_info;
@@ -538,6 +883,15 @@ struct debug_info *debug_info_create(struct debug_info_component *comp,
 		goto error;
 	}
 
+	if (comp->arg_symbol_cache_dir) {
+		debug_info->build_id_to_symbol_cache = g_hash_table_new_full(
+			g_str_hash, g_str_equal, (GDestroyNotify) g_free,
+			(GDestroyNotify) debug_info_symbol_cache_destroy);
+		if (!debug_info->build_id_to_symbol_cache) {
+			goto error;
+		}
+	}
+
 	debug_info->comp = comp;
 	ret = debug_info_init(debug_info);
 	if (ret) {
@@ -546,6 +900,7 @@ struct debug_info *debug_info_create(struct debug_info_component *comp,
 
 	debug_info->input_trace = trace;
 	debug_info->fd_cache = fdc;
+	debug_info->bin_registry = bin_registry;
 
 end:
 	return debug_info;
@@ -571,6 +926,10 @@ void debug_info_destroy(struct debug_info *debug_info)
 		g_hash_table_destroy(debug_info->vpid_to_proc_dbg_info_src);
 	}
 
+	if (debug_info->build_id_to_symbol_cache) {
+		g_hash_table_destroy(debug_info->build_id_to_symbol_cache);
+	}
+
 	remove_listener_status = bt_trace_remove_destruction_listener(
 		debug_info->input_trace,
 		debug_info->destruction_listener_id);
@@ -626,7 +985,12 @@ void handle_event_statedump_build_id(struct debug_info *debug_info,
 
 	event_get_payload_build_id_value(event, BUILD_ID_FIELD_NAME, build_id);
 
-	ret = bin_info_set_build_id(bin, build_id, build_id_len);
+	/*
+	 * Only check the build ID against the file when an address of
+	 * this executable is first looked up: a state dump can report
+	 * many more executables than the traced addresses need.
+	 */
+	ret = bin_info_set_build_id_deferred(bin, build_id, build_id_len);
 	if (ret) {
 		goto end;
 	}
@@ -757,7 +1121,8 @@ void handle_bin_info_event(struct debug_info *debug_info,
 		goto end;
 	}
 
-	bin = bin_info_create(debug_info->fd_cache, path, baddr, memsz, is_pic,
+	bin = bin_info_create(debug_info->fd_cache, debug_info->bin_registry,
+		path, baddr, memsz, is_pic,
 		debug_info->comp->arg_debug_dir,
 		debug_info->comp->arg_target_prefix,
 		debug_info->log_level, debug_info->self_comp);
@@ -768,6 +1133,7 @@ void handle_bin_info_event(struct debug_info *debug_info,
 	g_hash_table_insert(proc_dbg_info_src->baddr_to_bin_info, key, bin);
 	/* Ownership passed to ht. */
 	key = NULL;
+	proc_debug_info_sources_add_bin(proc_dbg_info_src, bin);
 
 end:
 	g_free(key);
@@ -794,6 +1160,7 @@ void handle_event_lib_unload(struct debug_info *debug_info,
 {
 	gboolean ret;
 	struct proc_debug_info_sources *proc_dbg_info_src;
+	struct bin_info *bin;
 	uint64_t baddr;
 	int64_t vpid;
 
@@ -813,6 +1180,13 @@ void handle_event_lib_unload(struct debug_info *debug_info,
 		goto end;
 	}
 
+	bin = g_hash_table_lookup(proc_dbg_info_src->baddr_to_bin_info,
+		(gpointer) &baddr);
+	if (bin) {
+		proc_debug_info_sources_remove_bin(proc_dbg_info_src, bin);
+		proc_debug_info_sources_purge_ip_cache(proc_dbg_info_src, bin);
+	}
+
 	ret = g_hash_table_remove(proc_dbg_info_src->baddr_to_bin_info,
 		(gpointer) &baddr);
 	BT_ASSERT(ret);
@@ -836,8 +1210,7 @@ void handle_event_statedump_start(struct debug_info *debug_info,
 		goto end;
 	}
 
-	g_hash_table_remove_all(proc_dbg_info_src->baddr_to_bin_info);
-	g_hash_table_remove_all(proc_dbg_info_src->ip_to_debug_info_src);
+	proc_debug_info_sources_clear(proc_dbg_info_src);
 
 end:
 	return;
@@ -880,7 +1253,7 @@ void handle_event_statedump(struct debug_info_msg_iter *debug_it,
 		bt_trace_add_listener_status add_listener_status;
 
 		debug_info = debug_info_create(debug_it->debug_info_component,
-			trace, &debug_it->fd_cache);
+			trace, &debug_it->fd_cache, debug_it->bin_registry);
 		g_hash_table_insert(debug_it->debug_info_map, (gpointer) trace,
 			debug_info);
 		add_listener_status = bt_trace_add_destruction_listener(
@@ -932,6 +1305,7 @@ void destroy_debug_info_comp(struct debug_info_component *debug_info)
 	g_free(debug_info->arg_debug_dir);
 	g_free(debug_info->arg_debug_info_field_name);
 	g_free(debug_info->arg_target_prefix);
+	g_free(debug_info->arg_symbol_cache_dir);
 	g_free(debug_info);
 }
 
@@ -1100,10 +1474,10 @@ void fill_debug_info_field_empty(bt_field *debug_info_field,
 	}
 }
 static
-void fill_debug_info_field(struct debug_info *debug_info, int64_t vpid,
-		uint64_t ip, bt_field *debug_info_field)
+void fill_debug_info_field(struct debug_info *debug_info,
+		struct debug_info_source *dbg_info_src,
+		bt_field *debug_info_field)
 {
-	struct debug_info_source *dbg_info_src;
 	const bt_field_class *debug_info_fc;
 
 	BT_ASSERT_DBG(bt_field_get_class_type(debug_info_field) ==
@@ -1114,18 +1488,22 @@ void fill_debug_info_field(struct debug_info *debug_info, int64_t vpid,
 	BT_ASSERT_DBG(bt_field_class_structure_get_member_count(
 		debug_info_fc) == 3);
 
-	dbg_info_src = debug_info_query(debug_info, vpid, ip);
+	unsigned int fields = debug_info->comp->arg_fields;
 
-	fill_debug_info_bin_field(dbg_info_src,
+	/* Leave the fields which aren't computed empty. */
+	fill_debug_info_bin_field(
+		fields & DEBUG_INFO_FIELDS_BIN ? dbg_info_src : NULL,
 		debug_info->comp->arg_full_path,
 		bt_field_structure_borrow_member_field_by_name(
 			debug_info_field, "bin"),
 		debug_info->log_level, debug_info->self_comp);
-	fill_debug_info_func_field(dbg_info_src,
+	fill_debug_info_func_field(
+		fields & DEBUG_INFO_FIELDS_FUNC ? dbg_info_src : NULL,
 		bt_field_structure_borrow_member_field_by_name(
 			debug_info_field, "func"),
 		debug_info->log_level, debug_info->self_comp);
-	fill_debug_info_src_field(dbg_info_src,
+	fill_debug_info_src_field(
+		fields & DEBUG_INFO_FIELDS_SRC ? dbg_info_src : NULL,
 		debug_info->comp->arg_full_path,
 		bt_field_structure_borrow_member_field_by_name(
 			debug_info_field, "src"),
@@ -1193,11 +1571,22 @@ void fill_debug_info_event_if_needed(struct debug_info_msg_iter *debug_it,
 			bt_event_borrow_stream_const(in_event)));
 
 	if (debug_info) {
+		struct debug_info_source *dbg_info_src;
+
 		/*
-		 * Perform the debug-info resolving and set the event fields
-		 * accordingly.
+		 * Perform the debug-info resolving, unless
+		 * prefetch_debug_info_sources() already did, and set
+		 * the event fields accordingly.
 		 */
-		fill_debug_info_field(debug_info, vpid, ip, out_debug_info_field);
+		if (debug_it->cur_batch_query) {
+			BT_ASSERT_DBG(debug_it->cur_batch_query->ip == ip);
+			dbg_info_src = debug_it->cur_batch_query->debug_info_src;
+		} else {
+			dbg_info_src = debug_info_query(debug_info, vpid, ip);
+		}
+
+		fill_debug_info_field(debug_info, dbg_info_src,
+			out_debug_info_field);
 	} else {
 		BT_COMP_LOGD("No debug information for this trace. Setting debug "
 			"info fields to empty strings.");
@@ -1208,36 +1597,53 @@ end:
 	return;
 }
 
+/*
+ * Returns whether or not `in_event` is an LTTng-UST state dump (or
+ * dynamic linker) event of which the event common context has the
+ * fields to update the debug-info view of its process.
+ */
 static
-void update_event_statedump_if_needed(struct debug_info_msg_iter *debug_it,
+bool is_event_statedump(struct debug_info_msg_iter *debug_it,
 		const bt_event *in_event)
 {
 	const bt_field *event_common_ctx;
 	const bt_field_class *event_common_ctx_fc;
 	const bt_event_class *in_event_class = bt_event_borrow_class_const(in_event);
+	const char *in_event_name;
+	bool is_statedump = false;
 
-	/*
-	 * If the event is an lttng_ust_statedump event AND has the right event
-	 * common context fields update the debug-info view for this process.
-	 */
 	event_common_ctx = bt_event_borrow_common_context_field_const(in_event);
 	if (!event_common_ctx) {
 		goto end;
 	}
 
 	event_common_ctx_fc = bt_field_borrow_class_const(event_common_ctx);
-	if (is_event_common_ctx_dbg_info_compatible(event_common_ctx_fc,
+	if (!is_event_common_ctx_dbg_info_compatible(event_common_ctx_fc,
 			debug_it->ir_maps->debug_info_field_class_name)) {
-		/* Checkout if it might be a one of lttng ust statedump events. */
-		const char *in_event_name = bt_event_class_get_name(in_event_class);
-		if (strncmp(in_event_name, LTTNG_UST_STATEDUMP_PREFIX,
-				strlen(LTTNG_UST_STATEDUMP_PREFIX)) == 0) {
-			/* Handle statedump events. */
-			handle_event_statedump(debug_it, in_event);
-		}
+		goto end;
 	}
+
+	/* Checkout if it might be a one of lttng ust statedump events. */
+	in_event_name = bt_event_class_get_name(in_event_class);
+	is_statedump = strncmp(in_event_name, LTTNG_UST_STATEDUMP_PREFIX,
+		strlen(LTTNG_UST_STATEDUMP_PREFIX)) == 0;
+
 end:
-	return;
+	return is_statedump;
+}
+
+static
+void update_event_statedump_if_needed(struct debug_info_msg_iter *debug_it,
+		const bt_event *in_event)
+{
+	/*
+	 * If the event is an lttng_ust_statedump event AND has the right event
+	 * common context fields update the debug-info view for this process.
+	 */
+	if (is_event_statedump(debug_it, in_event)) {
+		/* Handle statedump events. */
+		handle_event_statedump(debug_it, in_event);
+	}
 }
 
 static
@@ -1650,11 +2056,154 @@ error:
 	return out_message;
 }
 
+/*
+ * Pass-through decision of a message iterator for an input trace.
+ */
+struct trace_pass_through {
+	struct debug_info_msg_iter *debug_it;
+	const bt_trace *input_trace;
+	bt_listener_id destruction_listener_id;
+
+	/*
+	 * True if no stream class of the input trace has an event
+	 * common context field class to which this component adds the
+	 * debug info field.
+	 */
+	bool pass_through;
+};
+
+static
+void trace_pass_through_destroy(struct trace_pass_through *trace_pt)
+{
+	bt_trace_remove_listener_status remove_listener_status;
+	bt_logging_level log_level = trace_pt->debug_it->log_level;
+	bt_self_component *self_comp = trace_pt->debug_it->self_comp;
+
+	remove_listener_status = bt_trace_remove_destruction_listener(
+		trace_pt->input_trace, trace_pt->destruction_listener_id);
+	if (remove_listener_status != BT_TRACE_REMOVE_LISTENER_STATUS_OK) {
+		BT_COMP_LOGD_STR("Trace destruction listener removal failed.");
+		bt_current_thread_clear_error();
+	}
+
+	g_free(trace_pt);
+}
+
+static
+void trace_pass_through_remove_func(const bt_trace *in_trace, void *data)
+{
+	struct debug_info_msg_iter *debug_it = data;
+
+	if (debug_it->pass_through_map) {
+		gboolean ret;
+
+		ret = g_hash_table_remove(debug_it->pass_through_map,
+			(gpointer) in_trace);
+		BT_ASSERT(ret);
+	}
+}
+
+/*
+ * Returns whether or not the messages of the input trace `in_trace`
+ * can be forwarded as is, that is, whether or not no event of this
+ * trace can get a debug info field.
+ *
+ * The decision is made when the iterator first sees a message of
+ * `in_trace`, considering its stream classes at this point.
+ */
+static
+bool trace_is_passed_through(struct debug_info_msg_iter *debug_it,
+		const bt_trace *in_trace)
+{
+	struct trace_pass_through *trace_pt;
+	const bt_trace_class *in_trace_class;
+	bt_trace_add_listener_status add_listener_status;
+	uint64_t i;
+
+	trace_pt = g_hash_table_lookup(debug_it->pass_through_map, in_trace);
+	if (G_LIKELY(trace_pt)) {
+		goto end;
+	}
+
+	trace_pt = g_new0(struct trace_pass_through, 1);
+	trace_pt->debug_it = debug_it;
+	trace_pt->input_trace = in_trace;
+	trace_pt->pass_through = true;
+	in_trace_class = bt_trace_borrow_class_const(in_trace);
+
+	for (i = 0; i < bt_trace_class_get_stream_class_count(in_trace_class);
+			i++) {
+		const bt_stream_class *in_sc =
+			bt_trace_class_borrow_stream_class_by_index_const(
+				in_trace_class, i);
+		const bt_field_class *in_common_ctx_fc =
+			bt_stream_class_borrow_event_common_context_field_class_const(
+				in_sc);
+
+		if (in_common_ctx_fc && is_event_common_ctx_dbg_info_compatible(
+				in_common_ctx_fc,
+				debug_it->debug_info_component->arg_debug_info_field_name)) {
+			trace_pt->pass_through = false;
+			break;
+		}
+	}
+
+	g_hash_table_insert(debug_it->pass_through_map, (gpointer) in_trace,
+		trace_pt);
+	add_listener_status = bt_trace_add_destruction_listener(
+		in_trace, trace_pass_through_remove_func, debug_it,
+		&trace_pt->destruction_listener_id);
+	BT_ASSERT(add_listener_status == BT_TRACE_ADD_LISTENER_STATUS_OK);
+
+end:
+	return trace_pt->pass_through;
+}
+
+/*
+ * Returns the stream of the message `msg`, or `NULL` if it has none.
+ */
+static
+const bt_stream *borrow_message_stream(const bt_message *msg)
+{
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		return bt_event_borrow_stream_const(
+			bt_message_event_borrow_event_const(msg));
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		return bt_packet_borrow_stream_const(
+			bt_message_packet_beginning_borrow_packet_const(msg));
+	case BT_MESSAGE_TYPE_PACKET_END:
+		return bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg));
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		return bt_message_stream_beginning_borrow_stream_const(msg);
+	case BT_MESSAGE_TYPE_STREAM_END:
+		return bt_message_stream_end_borrow_stream_const(msg);
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		return bt_message_discarded_events_borrow_stream_const(msg);
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		return bt_message_discarded_packets_borrow_stream_const(msg);
+	default:
+		return NULL;
+	}
+}
+
 static
 const bt_message *handle_message(struct debug_info_msg_iter *debug_it,
 		const bt_message *in_message)
 {
 	bt_message *out_message = NULL;
+	const bt_stream *in_stream = borrow_message_stream(in_message);
+
+	/*
+	 * Forward the messages of a trace of which no event gets a
+	 * debug info field as is instead of copying them.
+	 */
+	if (in_stream && trace_is_passed_through(debug_it,
+			bt_stream_borrow_trace_const(in_stream))) {
+		bt_message_get_ref(in_message);
+		return in_message;
+	}
 
 	switch (bt_message_get_type(in_message)) {
 	case BT_MESSAGE_TYPE_EVENT:
@@ -1689,12 +2238,35 @@ const bt_message *handle_message(struct debug_info_msg_iter *debug_it,
 	return out_message;
 }
 
+static const char *debug_info_field_choices[] = {
+	"bin",
+	"func",
+	"src",
+	NULL,
+};
+
+static const struct bt_param_validation_value_descr debug_info_fields_elem_descr = {
+	BT_VALUE_TYPE_STRING,
+	.string = {
+		.choices = debug_info_field_choices,
+	},
+};
+
 static
 struct bt_param_validation_map_value_entry_descr debug_info_params[] = {
 	{ "debug-info-field-name", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "debug-info-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "target-prefix", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "full-path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "symbol-cache-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "fields", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, {
+		BT_VALUE_TYPE_ARRAY,
+		.array = {
+			.min_length = 0,
+			.max_length = BT_PARAM_VALIDATION_INFINITE,
+			.element_type = &debug_info_fields_elem_descr,
+		}
+	}},
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -1750,6 +2322,15 @@ bt_component_class_initialize_method_status init_from_params(
 		debug_info_component->arg_target_prefix = NULL;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+			"symbol-cache-dir");
+	if (value) {
+		debug_info_component->arg_symbol_cache_dir =
+			g_strdup(bt_value_string_get(value));
+	} else {
+		debug_info_component->arg_symbol_cache_dir = NULL;
+	}
+
 	value = bt_value_map_borrow_entry_value_const(params, "full-path");
 	if (value) {
 		debug_info_component->arg_full_path = bt_value_bool_get(value);
@@ -1757,6 +2338,33 @@ bt_component_class_initialize_method_status init_from_params(
 		debug_info_component->arg_full_path = BT_FALSE;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params, "fields");
+	if (value) {
+		uint64_t i;
+
+		debug_info_component->arg_fields = 0;
+
+		for (i = 0; i < bt_value_array_get_length(value); i++) {
+			const char *field = bt_value_string_get(
+				bt_value_array_borrow_element_by_index_const(
+					value, i));
+
+			if (strcmp(field, "bin") == 0) {
+				debug_info_component->arg_fields |=
+					DEBUG_INFO_FIELDS_BIN;
+			} else if (strcmp(field, "func") == 0) {
+				debug_info_component->arg_fields |=
+					DEBUG_INFO_FIELDS_FUNC;
+			} else {
+				BT_ASSERT(strcmp(field, "src") == 0);
+				debug_info_component->arg_fields |=
+					DEBUG_INFO_FIELDS_SRC;
+			}
+		}
+	} else {
+		debug_info_component->arg_fields = DEBUG_INFO_FIELDS_ALL;
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
 end:
@@ -1847,6 +2455,220 @@ void debug_info_comp_finalize(bt_self_component_filter *self_comp_flt)
 	destroy_debug_info_comp(debug_info);
 }
 
+static
+gint compare_batch_queries_by_bin(gconstpointer a, gconstpointer b)
+{
+	const struct debug_info_batch_query *query_a = a;
+	const struct debug_info_batch_query *query_b = b;
+	uint64_t bin_addr_a = query_a->bin ? query_a->bin->low_addr : 0;
+	uint64_t bin_addr_b = query_b->bin ? query_b->bin->low_addr : 0;
+
+	if (query_a->proc_dbg_info_src != query_b->proc_dbg_info_src) {
+		return (uintptr_t) query_a->proc_dbg_info_src <
+			(uintptr_t) query_b->proc_dbg_info_src ? -1 : 1;
+	}
+
+	if (bin_addr_a != bin_addr_b) {
+		return bin_addr_a < bin_addr_b ? -1 : 1;
+	}
+
+	if (query_a->ip != query_b->ip) {
+		return query_a->ip < query_b->ip ? -1 : 1;
+	}
+
+	return query_a->msg_idx < query_b->msg_idx ? -1 :
+		query_a->msg_idx > query_b->msg_idx;
+}
+
+static
+gint compare_batch_queries_by_msg_idx(gconstpointer a, gconstpointer b)
+{
+	const struct debug_info_batch_query *query_a = a;
+	const struct debug_info_batch_query *query_b = b;
+
+	return query_a->msg_idx < query_b->msg_idx ? -1 :
+		query_a->msg_idx > query_b->msg_idx;
+}
+
+/*
+ * Appends the query of the event message `msg`, at index `msg_idx`,
+ * to `debug_it->batch_queries` if it needs debug info.
+ */
+static
+void add_batch_query(struct debug_info_msg_iter *debug_it,
+		const bt_message *msg, uint64_t msg_idx)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_field *common_ctx_field;
+	struct debug_info *debug_info;
+	struct debug_info_batch_query query;
+	int64_t vpid;
+
+	common_ctx_field = bt_event_borrow_common_context_field_const(event);
+	if (!common_ctx_field) {
+		goto end;
+	}
+
+	if (!is_event_common_ctx_dbg_info_compatible(
+			bt_field_borrow_class_const(common_ctx_field),
+			debug_it->ir_maps->debug_info_field_class_name)) {
+		goto end;
+	}
+
+	debug_info = g_hash_table_lookup(debug_it->debug_info_map,
+		bt_stream_borrow_trace_const(
+			bt_event_borrow_stream_const(event)));
+	if (!debug_info) {
+		goto end;
+	}
+
+	vpid = bt_field_integer_signed_get_value(
+		bt_field_structure_borrow_member_field_by_name_const(
+			common_ctx_field, VPID_FIELD_NAME));
+	query.msg_idx = msg_idx;
+	query.debug_info = debug_info;
+	query.ip = bt_field_integer_unsigned_get_value(
+		bt_field_structure_borrow_member_field_by_name_const(
+			common_ctx_field, IP_FIELD_NAME));
+	query.proc_dbg_info_src = proc_debug_info_sources_ht_get_entry(
+		debug_info->vpid_to_proc_dbg_info_src, vpid);
+	if (!query.proc_dbg_info_src) {
+		goto end;
+	}
+
+	query.bin = proc_debug_info_sources_find_bin(query.proc_dbg_info_src,
+		query.ip);
+	query.debug_info_src = NULL;
+	g_array_append_val(debug_it->batch_queries, query);
+
+end:
+	return;
+}
+
+/*
+ * Resolves, in one pass, the debug info sources of the event messages
+ * of the run of `msgs` (of which the length is `count`) starting at
+ * index `start`, the run ending at the next state dump event.
+ *
+ * The unique (process, IP) pairs of the run are resolved sorted by
+ * executable and address for better locality within libdw and the
+ * symbolization caches. handle_message() then uses the resulting
+ * `debug_it->batch_queries` instead of looking up each event message.
+ *
+ * Returns the index of the first message after the run.
+ */
+static
+uint64_t prefetch_debug_info_sources(struct debug_info_msg_iter *debug_it,
+		bt_message_array_const msgs, uint64_t start, uint64_t count)
+{
+	GArray *queries = debug_it->batch_queries;
+	uint64_t end, unique_count = 0;
+	guint i;
+
+	g_array_set_size(queries, 0);
+	debug_it->next_batch_query_idx = 0;
+
+	for (end = start; end < count; end++) {
+		const bt_message *msg = msgs[end];
+
+		if (bt_message_get_type(msg) != BT_MESSAGE_TYPE_EVENT) {
+			continue;
+		}
+
+		/*
+		 * A state dump event changes the debug-info view of its
+		 * process: it ends the run. Its own address is resolved
+		 * after handling it, as usual.
+		 */
+		if (is_event_statedump(debug_it,
+				bt_message_event_borrow_event_const(msg))) {
+			if (end == start) {
+				end++;
+			}
+
+			break;
+		}
+
+		add_batch_query(debug_it, msg, end);
+	}
+
+	if (queries->len == 0) {
+		goto end;
+	}
+
+	g_array_sort(queries, compare_batch_queries_by_bin);
+
+	for (i = 0; i < queries->len; i++) {
+		struct debug_info_batch_query *query = &g_array_index(queries,
+			struct debug_info_batch_query, i);
+
+		if (i == 0 || query->proc_dbg_info_src !=
+				(query - 1)->proc_dbg_info_src ||
+				query->ip != (query - 1)->ip) {
+			unique_count++;
+		}
+	}
+
+	/*
+	 * Resolving more unique addresses than the IP cache of a process
+	 * can hold could evict the debug info sources of earlier queries:
+	 * let handle_message() look them up one by one instead.
+	 */
+	if (unique_count > PROC_IP_CACHE_MAX_ENTRIES) {
+		g_array_set_size(queries, 0);
+		goto end;
+	}
+
+	for (i = 0; i < queries->len; i++) {
+		struct debug_info_batch_query *query = &g_array_index(queries,
+			struct debug_info_batch_query, i);
+
+		if (i > 0 && query->proc_dbg_info_src ==
+				(query - 1)->proc_dbg_info_src &&
+				query->ip == (query - 1)->ip) {
+			/* Same process and address: reuse */
+			query->debug_info_src = (query - 1)->debug_info_src;
+			continue;
+		}
+
+		if (!query->bin) {
+			continue;
+		}
+
+		query->debug_info_src = proc_debug_info_sources_get_entry(
+			query->debug_info, query->proc_dbg_info_src, query->ip);
+	}
+
+	g_array_sort(queries, compare_batch_queries_by_msg_idx);
+
+end:
+	return end;
+}
+
+/*
+ * Returns the query which prefetch_debug_info_sources() resolved for
+ * the message at index `msg_idx`, or `NULL` if none.
+ */
+static
+const struct debug_info_batch_query *borrow_batch_query(
+		struct debug_info_msg_iter *debug_it, uint64_t msg_idx)
+{
+	const struct debug_info_batch_query *query = NULL;
+
+	if (debug_it->next_batch_query_idx < debug_it->batch_queries->len) {
+		query = &g_array_index(debug_it->batch_queries,
+			struct debug_info_batch_query,
+			debug_it->next_batch_query_idx);
+		if (query->msg_idx == msg_idx) {
+			debug_it->next_batch_query_idx++;
+		} else {
+			query = NULL;
+		}
+	}
+
+	return query;
+}
+
 BT_HIDDEN
 bt_message_iterator_class_next_method_status debug_info_msg_iter_next(
 		bt_self_message_iterator *self_msg_iter,
@@ -1861,7 +2683,7 @@ bt_message_iterator_class_next_method_status debug_info_msg_iter_next(
 	bt_self_component *self_comp = NULL;
 	bt_message_array_const input_msgs;
 	const bt_message *out_message;
-	uint64_t curr_msg_idx, i;
+	uint64_t curr_msg_idx, run_end_msg_idx = 0, i;
 
 	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
@@ -1898,8 +2720,17 @@ bt_message_iterator_class_next_method_status debug_info_msg_iter_next(
 	BT_ASSERT_DBG(*count <= capacity);
 
 	for (curr_msg_idx = 0; curr_msg_idx < *count; curr_msg_idx++) {
+		if (curr_msg_idx == run_end_msg_idx) {
+			run_end_msg_idx = prefetch_debug_info_sources(
+				debug_info_msg_iter, input_msgs, curr_msg_idx,
+				*count);
+		}
+
+		debug_info_msg_iter->cur_batch_query = borrow_batch_query(
+			debug_info_msg_iter, curr_msg_idx);
 		out_message = handle_message(debug_info_msg_iter,
 			input_msgs[curr_msg_idx]);
+		debug_info_msg_iter->cur_batch_query = NULL;
 		if (!out_message) {
 			goto handle_msg_error;
 		}
@@ -1957,6 +2788,15 @@ void debug_info_msg_iter_destroy(struct debug_info_msg_iter *debug_info_msg_iter
 		g_hash_table_destroy(debug_info_msg_iter->debug_info_map);
 	}
 
+	if (debug_info_msg_iter->pass_through_map) {
+		g_hash_table_destroy(debug_info_msg_iter->pass_through_map);
+	}
+
+	if (debug_info_msg_iter->batch_queries) {
+		g_array_free(debug_info_msg_iter->batch_queries, TRUE);
+	}
+
+	bin_info_registry_destroy(debug_info_msg_iter->bin_registry);
 	bt_fd_cache_fini(&debug_info_msg_iter->fd_cache);
 	g_free(debug_info_msg_iter);
 
@@ -2024,6 +2864,14 @@ bt_message_iterator_class_initialize_method_status debug_info_msg_iter_init(
 		goto error;
 	}
 
+	debug_info_msg_iter->pass_through_map = g_hash_table_new_full(
+		g_direct_hash, g_direct_equal, (GDestroyNotify) NULL,
+		(GDestroyNotify) trace_pass_through_destroy);
+	if (!debug_info_msg_iter->pass_through_map) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	debug_info_field_name =
 		debug_info_msg_iter->debug_info_component->arg_debug_info_field_name;
 
@@ -2040,6 +2888,19 @@ bt_message_iterator_class_initialize_method_status debug_info_msg_iter_init(
 		goto error;
 	}
 
+	debug_info_msg_iter->bin_registry = bin_info_registry_create();
+	if (!debug_info_msg_iter->bin_registry) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	debug_info_msg_iter->batch_queries = g_array_new(FALSE, FALSE,
+		sizeof(struct debug_info_batch_query));
+	if (!debug_info_msg_iter->batch_queries) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	bt_self_message_iterator_configuration_set_can_seek_forward(config,
 		bt_message_iterator_can_seek_forward(
 			debug_info_msg_iter->msg_iter));
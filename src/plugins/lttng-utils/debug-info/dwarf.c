@@ -66,23 +66,31 @@ end:
 }
 
 BT_HIDDEN
-struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
+int bt_dwarf_die_init(struct bt_dwarf_die *die, struct bt_dwarf_cu *cu)
 {
-	Dwarf_Die *dwarf_die = NULL;
-	struct bt_dwarf_die *die = NULL;
-
-	if (!cu) {
+	if (!die || !cu) {
 		goto error;
 	}
 
-	dwarf_die = g_new0(Dwarf_Die, 1);
-	if (!dwarf_die) {
+	if (!dwarf_offdie(cu->dwarf_info, cu->offset + cu->header_size,
+			&die->dwarf_die)) {
 		goto error;
 	}
 
-	dwarf_die = dwarf_offdie(cu->dwarf_info, cu->offset + cu->header_size,
-			dwarf_die);
-	if (!dwarf_die) {
+	die->cu = cu;
+	die->depth = 0;
+	return 0;
+
+error:
+	return -1;
+}
+
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
+{
+	struct bt_dwarf_die *die = NULL;
+
+	if (!cu) {
 		goto error;
 	}
 
@@ -91,14 +99,13 @@ struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
 		goto error;
 	}
 
-	die->cu = cu;
-	die->dwarf_die = dwarf_die;
-	die->depth = 0;
+	if (bt_dwarf_die_init(die, cu)) {
+		goto error;
+	}
 
 	return die;
 
 error:
-	g_free(dwarf_die);
 	g_free(die);
 	return NULL;
 }
@@ -106,50 +113,36 @@ error:
 BT_HIDDEN
 void bt_dwarf_die_destroy(struct bt_dwarf_die *die)
 {
-	if (!die) {
-		return;
-	}
-
-	g_free(die->dwarf_die);
 	g_free(die);
 }
 
 BT_HIDDEN
 int bt_dwarf_die_has_children(struct bt_dwarf_die *die)
 {
-	return dwarf_haschildren(die->dwarf_die);
+	return dwarf_haschildren(&die->dwarf_die);
 }
 
 BT_HIDDEN
 int bt_dwarf_die_child(struct bt_dwarf_die *die)
 {
 	int ret;
-	Dwarf_Die *child_die = NULL;
+	Dwarf_Die child_die;
 
 	if (!die) {
 		ret = -1;
-		goto error;
-	}
-
-	child_die = g_new0(Dwarf_Die, 1);
-	if (!child_die) {
-		ret = -1;
-		goto error;
+		goto end;
 	}
 
-	ret = dwarf_child(die->dwarf_die, child_die);
+	ret = dwarf_child(&die->dwarf_die, &child_die);
 	if (ret) {
 		/* ret is -1 on error, 1 if no child DIE. */
-		goto error;
+		goto end;
 	}
 
-	g_free(die->dwarf_die);
 	die->dwarf_die = child_die;
 	die->depth++;
-	return 0;
 
-error:
-	g_free(child_die);
+end:
 	return ret;
 }
 
@@ -157,42 +150,33 @@ BT_HIDDEN
 int bt_dwarf_die_next(struct bt_dwarf_die *die)
 {
 	int ret;
-	Dwarf_Die *next_die = NULL;
+	Dwarf_Die next_die;
 
 	if (!die) {
 		ret = -1;
-		goto error;
-	}
-
-	next_die = g_new0(Dwarf_Die, 1);
-	if (!next_die) {
-		ret = -1;
-		goto error;
+		goto end;
 	}
 
 	if (die->depth == 0) {
-		ret = dwarf_child(die->dwarf_die, next_die);
+		ret = dwarf_child(&die->dwarf_die, &next_die);
 		if (ret) {
 			/* ret is -1 on error, 1 if no child DIE. */
-			goto error;
+			goto end;
 		}
 
 		die->depth = 1;
 	} else {
-		ret = dwarf_siblingof(die->dwarf_die, next_die);
+		ret = dwarf_siblingof(&die->dwarf_die, &next_die);
 		if (ret) {
 			/* ret is -1 on error, 1 if we reached end of
 			 * DIEs at this depth. */
-			goto error;
+			goto end;
 		}
 	}
 
-	g_free(die->dwarf_die);
 	die->dwarf_die = next_die;
-	return 0;
 
-error:
-	g_free(next_die);
+end:
 	return ret;
 }
 
@@ -205,7 +189,7 @@ int bt_dwarf_die_get_tag(struct bt_dwarf_die *die, int *tag)
 		goto error;
 	}
 
-	_tag = dwarf_tag(die->dwarf_die);
+	_tag = dwarf_tag(&die->dwarf_die);
 	if (_tag == DW_TAG_invalid) {
 		goto error;
 	}
@@ -226,7 +210,7 @@ int bt_dwarf_die_get_name(struct bt_dwarf_die *die, char **name)
 		goto error;
 	}
 
-	_name = dwarf_diename(die->dwarf_die);
+	_name = dwarf_diename(&die->dwarf_die);
 	if (!_name) {
 		goto error;
 	}
@@ -249,34 +233,28 @@ int bt_dwarf_die_get_call_file(struct bt_dwarf_die *die, char **filename)
 	Dwarf_Sword file_no;
 	const char *_filename = NULL;
 	Dwarf_Files *src_files = NULL;
-	Dwarf_Attribute *file_attr = NULL;
-	struct bt_dwarf_die *cu_die = NULL;
+	Dwarf_Attribute file_attr;
+	struct bt_dwarf_die cu_die;
 
 	if (!die || !filename) {
 		goto error;
 	}
 
-	file_attr = g_new0(Dwarf_Attribute, 1);
-	if (!file_attr) {
+	if (!dwarf_attr(&die->dwarf_die, DW_AT_call_file, &file_attr)) {
 		goto error;
 	}
 
-	file_attr = dwarf_attr(die->dwarf_die, DW_AT_call_file, file_attr);
-	if (!file_attr) {
-		goto error;
-	}
-
-	ret = dwarf_formsdata(file_attr, &file_no);
+	ret = dwarf_formsdata(&file_attr, &file_no);
 	if (ret) {
 		goto error;
 	}
 
-	cu_die = bt_dwarf_die_create(die->cu);
-	if (!cu_die) {
+	ret = bt_dwarf_die_init(&cu_die, die->cu);
+	if (ret) {
 		goto error;
 	}
 
-	ret = dwarf_getsrcfiles(cu_die->dwarf_die, &src_files, NULL);
+	ret = dwarf_getsrcfiles(&cu_die.dwarf_die, &src_files, NULL);
 	if (ret) {
 		goto error;
 	}
@@ -287,16 +265,9 @@ int bt_dwarf_die_get_call_file(struct bt_dwarf_die *die, char **filename)
 	}
 
 	*filename = g_strdup(_filename);
-
-	bt_dwarf_die_destroy(cu_die);
-	g_free(file_attr);
-
 	return 0;
 
 error:
-	bt_dwarf_die_destroy(cu_die);
-	g_free(file_attr);
-
 	return -1;
 }
 
@@ -305,36 +276,26 @@ int bt_dwarf_die_get_call_line(struct bt_dwarf_die *die,
 		uint64_t *line_no)
 {
 	int ret = 0;
-	Dwarf_Attribute *line_attr = NULL;
+	Dwarf_Attribute line_attr;
 	uint64_t _line_no;
 
 	if (!die || !line_no) {
 		goto error;
 	}
 
-	line_attr = g_new0(Dwarf_Attribute, 1);
-	if (!line_attr) {
+	if (!dwarf_attr(&die->dwarf_die, DW_AT_call_line, &line_attr)) {
 		goto error;
 	}
 
-	line_attr = dwarf_attr(die->dwarf_die, DW_AT_call_line, line_attr);
-	if (!line_attr) {
-		goto error;
-	}
-
-	ret = dwarf_formudata(line_attr, &_line_no);
+	ret = dwarf_formudata(&line_attr, &_line_no);
 	if (ret) {
 		goto error;
 	}
 
 	*line_no = _line_no;
-	g_free(line_attr);
-
 	return 0;
 
 error:
-	g_free(line_attr);
-
 	return -1;
 }
 
@@ -344,7 +305,7 @@ int bt_dwarf_die_contains_addr(struct bt_dwarf_die *die, uint64_t addr,
 {
 	int ret;
 
-	ret = dwarf_haspc(die->dwarf_die, addr);
+	ret = dwarf_haspc(&die->dwarf_die, addr);
 	if (ret == -1) {
 		goto error;
 	}
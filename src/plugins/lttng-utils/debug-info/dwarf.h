@@ -38,10 +38,14 @@ struct bt_dwarf_cu {
 /*
  * This structure represents a single debug information entry (DIE),
  * within a compilation unit (CU).
+ *
+ * It's a cursor: moving it to a child or to a sibling DIE overwrites
+ * `dwarf_die` in place, so that walking DIEs doesn't allocate. It can
+ * live on the stack (see bt_dwarf_die_init()).
  */
 struct bt_dwarf_die {
 	struct bt_dwarf_cu *cu;
-	Dwarf_Die *dwarf_die;
+	Dwarf_Die dwarf_die;
 	/*
 	 * A depth of 0 represents a root DIE, located in the DWARF
 	 * layout on the same level as its corresponding CU entry. Its
@@ -82,6 +86,20 @@ void bt_dwarf_cu_destroy(struct bt_dwarf_cu *cu);
 BT_HIDDEN
 int bt_dwarf_cu_next(struct bt_dwarf_cu *cu);
 
+/**
+ * Initialize the caller-allocated `die` to access debug information
+ * entries (DIE) for the given compile unit `cu`, positioning it on the
+ * root DIE of `cu`.
+ *
+ * A bt_dwarf_die initialized this way doesn't need to be destroyed.
+ *
+ * @param die	bt_dwarf_die to initialize
+ * @param cu	bt_dwarf_cu instance
+ * @returns	0 on success, -1 on failure
+ */
+BT_HIDDEN
+int bt_dwarf_die_init(struct bt_dwarf_die *die, struct bt_dwarf_cu *cu);
+
 /**
  * Instantiate a structure to access debug information entries (DIE)
  * for the given compile unit `cu`.
@@ -0,0 +1,476 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ *
+ * Babeltrace - Debug Info Persistent Symbolization Cache
+ */
+
+#define BT_COMP_LOG_SELF_COMP (cache->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (cache->log_level)
+#define BT_LOG_TAG "PLUGIN/FLT.LTTNG-UTILS.DEBUG-INFO/SYMBOL-CACHE"
+#include "logging/comp-logging.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "common/assert.h"
+
+#include "symbol-cache.h"
+
+struct debug_info_symbol_cache {
+	bt_logging_level log_level;
+
+	/* Used for logging; can be `NULL` */
+	bt_self_component *self_comp;
+
+	/* Path of the cache file (owned by this) */
+	gchar *path;
+
+	/* Mapped existing cache file, `NULL` if none or invalid */
+	GMappedFile *mapped_file;
+
+	/* Entries and strings of `mapped_file` */
+	const struct debug_info_symbol_cache_entry *file_entries;
+	uint64_t file_entry_count;
+	const char *file_strings;
+	uint32_t file_strings_len;
+
+	/*
+	 * Hash table: address (pointer to uint64_t) to
+	 * (struct new_entry *), owned by this: entries which lookups
+	 * added during this run.
+	 */
+	GHashTable *new_entries;
+};
+
+struct new_entry {
+	uint64_t addr;
+	gchar *func;
+	gchar *src_path;
+	uint64_t line_no;
+};
+
+/* Entry to write, its strings belonging to the cache */
+struct write_entry {
+	uint64_t addr;
+	const char *func;
+	const char *src_path;
+	uint64_t line_no;
+};
+
+static
+void new_entry_destroy(gpointer data)
+{
+	struct new_entry *entry = data;
+
+	g_free(entry->func);
+	g_free(entry->src_path);
+	g_free(entry);
+}
+
+static
+gchar *get_cache_file_path(const char *cache_dir, const uint8_t *build_id,
+		size_t build_id_len)
+{
+	GString *basename;
+	gchar *path;
+	size_t i;
+
+	basename = g_string_new(NULL);
+
+	for (i = 0; i < build_id_len; i++) {
+		g_string_append_printf(basename, "%02x", build_id[i]);
+	}
+
+	g_string_append(basename, DEBUG_INFO_SYMBOL_CACHE_SUFFIX);
+	path = g_build_filename(cache_dir, basename->str, NULL);
+	g_string_free(basename, TRUE);
+	return path;
+}
+
+/*
+ * Memory-maps and validates the existing cache file of `cache`, if any.
+ */
+static
+void map_cache_file(struct debug_info_symbol_cache *cache)
+{
+	const struct debug_info_symbol_cache_file_hdr *header;
+	const char *contents;
+	gsize filesize;
+	GError *gerror = NULL;
+
+	cache->mapped_file = g_mapped_file_new(cache->path, FALSE, &gerror);
+	if (!cache->mapped_file) {
+		BT_COMP_LOGD("Cannot map symbolization cache file: "
+			"path=\"%s\", error=\"%s\"", cache->path,
+			gerror->message);
+		goto end;
+	}
+
+	contents = g_mapped_file_get_contents(cache->mapped_file);
+	filesize = g_mapped_file_get_length(cache->mapped_file);
+
+	if (filesize < sizeof(*header)) {
+		BT_COMP_LOGW("Invalid symbolization cache file: "
+			"file size (%zu bytes) < header size (%zu bytes)",
+			filesize, sizeof(*header));
+		goto error;
+	}
+
+	header = (const struct debug_info_symbol_cache_file_hdr *) contents;
+	if (header->magic != DEBUG_INFO_SYMBOL_CACHE_MAGIC) {
+		BT_COMP_LOGW_STR("Invalid symbolization cache file: \"magic\" field validation failed");
+		goto error;
+	}
+
+	if (header->version != DEBUG_INFO_SYMBOL_CACHE_VERSION ||
+			header->entry_len !=
+				sizeof(struct debug_info_symbol_cache_entry)) {
+		BT_COMP_LOGI("Unsupported symbolization cache file version: "
+			"version=%" PRIu32 ", entry-len=%" PRIu32,
+			header->version, header->entry_len);
+		goto error;
+	}
+
+	if ((filesize - sizeof(*header)) /
+			sizeof(struct debug_info_symbol_cache_entry) <
+				header->entry_count ||
+			filesize - sizeof(*header) - header->entry_count *
+				sizeof(struct debug_info_symbol_cache_entry) !=
+				header->strings_len) {
+		BT_COMP_LOGW("Invalid symbolization cache file: "
+			"unexpected file size: file-size=%zu, entry-count=%" PRIu64,
+			filesize, header->entry_count);
+		goto error;
+	}
+
+	cache->file_entries = (const void *) (contents + sizeof(*header));
+	cache->file_entry_count = header->entry_count;
+	cache->file_strings = (const char *) &cache->file_entries[
+		header->entry_count];
+	cache->file_strings_len = header->strings_len;
+
+	/* Any string offset within the strings now ends with a null byte */
+	if (cache->file_strings_len > 0 &&
+			cache->file_strings[cache->file_strings_len - 1] != '\0') {
+		BT_COMP_LOGW_STR("Invalid symbolization cache file: "
+			"strings aren't null-terminated.");
+		goto error;
+	}
+
+	BT_COMP_LOGI("Mapped symbolization cache file: path=\"%s\", "
+		"entry-count=%" PRIu64, cache->path, cache->file_entry_count);
+	goto end;
+
+error:
+	g_mapped_file_unref(cache->mapped_file);
+	cache->mapped_file = NULL;
+	cache->file_entries = NULL;
+	cache->file_entry_count = 0;
+	cache->file_strings = NULL;
+	cache->file_strings_len = 0;
+
+end:
+	if (gerror) {
+		g_error_free(gerror);
+	}
+}
+
+BT_HIDDEN
+struct debug_info_symbol_cache *debug_info_symbol_cache_create(
+		const char *cache_dir, const uint8_t *build_id,
+		size_t build_id_len, bt_logging_level log_level,
+		bt_self_component *self_comp)
+{
+	struct debug_info_symbol_cache *cache;
+
+	BT_ASSERT(cache_dir);
+	BT_ASSERT(build_id);
+
+	cache = g_new0(struct debug_info_symbol_cache, 1);
+	cache->log_level = log_level;
+	cache->self_comp = self_comp;
+	cache->path = get_cache_file_path(cache_dir, build_id,
+		build_id_len);
+	cache->new_entries = g_hash_table_new_full(g_int64_hash,
+		g_int64_equal, NULL, new_entry_destroy);
+	map_cache_file(cache);
+	return cache;
+}
+
+/*
+ * Returns the string at the offset `offset` within the strings of the
+ * mapped cache file of `cache`, or `NULL` if none.
+ */
+static inline
+const char *borrow_file_string(struct debug_info_symbol_cache *cache,
+		uint32_t offset)
+{
+	if (offset == DEBUG_INFO_SYMBOL_CACHE_NO_STR ||
+			offset >= cache->file_strings_len) {
+		return NULL;
+	}
+
+	return &cache->file_strings[offset];
+}
+
+static
+const struct debug_info_symbol_cache_entry *find_file_entry(
+		struct debug_info_symbol_cache *cache, uint64_t addr)
+{
+	uint64_t low = 0;
+	uint64_t high = cache->file_entry_count;
+
+	while (low < high) {
+		uint64_t mid = low + (high - low) / 2;
+		const struct debug_info_symbol_cache_entry *entry =
+			&cache->file_entries[mid];
+
+		if (entry->addr == addr) {
+			return entry;
+		} else if (entry->addr < addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return NULL;
+}
+
+BT_HIDDEN
+bool debug_info_symbol_cache_lookup(struct debug_info_symbol_cache *cache,
+		uint64_t addr, const char **func, const char **src_path,
+		uint64_t *line_no)
+{
+	const struct debug_info_symbol_cache_entry *file_entry;
+	const struct new_entry *entry;
+
+	entry = g_hash_table_lookup(cache->new_entries, &addr);
+	if (entry) {
+		*func = entry->func;
+		*src_path = entry->src_path;
+		*line_no = entry->line_no;
+		return true;
+	}
+
+	file_entry = find_file_entry(cache, addr);
+	if (file_entry) {
+		*func = borrow_file_string(cache, file_entry->func_offset);
+		*src_path = borrow_file_string(cache,
+			file_entry->src_path_offset);
+		*line_no = file_entry->line_no;
+		return true;
+	}
+
+	return false;
+}
+
+BT_HIDDEN
+void debug_info_symbol_cache_add(struct debug_info_symbol_cache *cache,
+		uint64_t addr, const char *func, const char *src_path,
+		uint64_t line_no)
+{
+	struct new_entry *entry = g_new0(struct new_entry, 1);
+
+	entry->addr = addr;
+	entry->func = g_strdup(func);
+	entry->src_path = g_strdup(src_path);
+	entry->line_no = line_no;
+	g_hash_table_replace(cache->new_entries, &entry->addr, entry);
+}
+
+static
+gint compare_write_entries(gconstpointer a, gconstpointer b)
+{
+	const struct write_entry *entry_a = a;
+	const struct write_entry *entry_b = b;
+
+	if (entry_a->addr != entry_b->addr) {
+		return entry_a->addr < entry_b->addr ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Appends the string `str` to `strings` unless it's already there
+ * (`offsets` maps strings to their offset plus one) and returns its
+ * offset.
+ */
+static
+uint32_t add_string(GByteArray *strings, GHashTable *offsets,
+		const char *str)
+{
+	uint32_t offset;
+
+	if (!str) {
+		return DEBUG_INFO_SYMBOL_CACHE_NO_STR;
+	}
+
+	offset = GPOINTER_TO_UINT(g_hash_table_lookup(offsets, str));
+	if (offset > 0) {
+		return offset - 1;
+	}
+
+	offset = strings->len;
+	g_byte_array_append(strings, (const guint8 *) str, strlen(str) + 1);
+	g_hash_table_insert(offsets, (gpointer) str,
+		GUINT_TO_POINTER(offset + 1));
+	return offset;
+}
+
+static
+void write_cache_file(struct debug_info_symbol_cache *cache)
+{
+	GArray *entries = NULL;
+	GByteArray *strings = NULL;
+	GHashTable *offsets = NULL;
+	GByteArray *contents = NULL;
+	GError *gerror = NULL;
+	struct debug_info_symbol_cache_file_hdr header = { 0 };
+	GHashTableIter iter;
+	gpointer value;
+	gchar *cache_dir = NULL;
+	uint64_t i;
+
+	entries = g_array_new(FALSE, FALSE, sizeof(struct write_entry));
+
+	for (i = 0; i < cache->file_entry_count; i++) {
+		const struct debug_info_symbol_cache_entry *file_entry =
+			&cache->file_entries[i];
+		struct write_entry entry = {
+			.addr = file_entry->addr,
+			.func = borrow_file_string(cache,
+				file_entry->func_offset),
+			.src_path = borrow_file_string(cache,
+				file_entry->src_path_offset),
+			.line_no = file_entry->line_no,
+		};
+
+		if (g_hash_table_contains(cache->new_entries, &entry.addr)) {
+			continue;
+		}
+
+		g_array_append_val(entries, entry);
+	}
+
+	g_hash_table_iter_init(&iter, cache->new_entries);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		const struct new_entry *new_entry = value;
+		struct write_entry entry = {
+			.addr = new_entry->addr,
+			.func = new_entry->func,
+			.src_path = new_entry->src_path,
+			.line_no = new_entry->line_no,
+		};
+
+		g_array_append_val(entries, entry);
+	}
+
+	g_array_sort(entries, compare_write_entries);
+	strings = g_byte_array_new();
+	offsets = g_hash_table_new(g_str_hash, g_str_equal);
+	contents = g_byte_array_new();
+	header.magic = DEBUG_INFO_SYMBOL_CACHE_MAGIC;
+	header.version = DEBUG_INFO_SYMBOL_CACHE_VERSION;
+	header.entry_len = sizeof(struct debug_info_symbol_cache_entry);
+	header.entry_count = entries->len;
+	g_byte_array_append(contents, (const guint8 *) &header,
+		sizeof(header));
+
+	for (i = 0; i < entries->len; i++) {
+		const struct write_entry *entry = &g_array_index(entries,
+			struct write_entry, i);
+		struct debug_info_symbol_cache_entry file_entry = {
+			.addr = entry->addr,
+			.line_no = entry->line_no,
+			.func_offset = add_string(strings, offsets,
+				entry->func),
+			.src_path_offset = add_string(strings, offsets,
+				entry->src_path),
+		};
+
+		if (strings->len >= DEBUG_INFO_SYMBOL_CACHE_NO_STR) {
+			BT_COMP_LOGW("Too many strings to write symbolization cache file: "
+				"path=\"%s\"", cache->path);
+			goto end;
+		}
+
+		g_byte_array_append(contents, (const guint8 *) &file_entry,
+			sizeof(file_entry));
+	}
+
+	g_byte_array_append(contents, strings->data, strings->len);
+	((struct debug_info_symbol_cache_file_hdr *) contents->data)->strings_len =
+		strings->len;
+
+	cache_dir = g_path_get_dirname(cache->path);
+	if (g_mkdir_with_parents(cache_dir, 0755)) {
+		BT_COMP_LOGW_ERRNO("Cannot create symbolization cache directory",
+			": cache-dir=\"%s\"", cache_dir);
+		goto end;
+	}
+
+	/*
+	 * g_file_set_contents() writes to a temporary file and renames
+	 * it, so that a concurrent reader never sees a partial file.
+	 */
+	if (!g_file_set_contents(cache->path, (const gchar *) contents->data,
+			contents->len, &gerror)) {
+		BT_COMP_LOGW("Cannot write symbolization cache file: "
+			"path=\"%s\", error=\"%s\"", cache->path,
+			gerror->message);
+		goto end;
+	}
+
+	BT_COMP_LOGI("Wrote symbolization cache file: path=\"%s\", "
+		"entry-count=%u", cache->path, entries->len);
+
+end:
+	g_free(cache_dir);
+	g_array_free(entries, TRUE);
+
+	if (strings) {
+		g_byte_array_free(strings, TRUE);
+	}
+
+	if (offsets) {
+		g_hash_table_destroy(offsets);
+	}
+
+	if (contents) {
+		g_byte_array_free(contents, TRUE);
+	}
+
+	if (gerror) {
+		g_error_free(gerror);
+	}
+}
+
+BT_HIDDEN
+void debug_info_symbol_cache_destroy(struct debug_info_symbol_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	if (g_hash_table_size(cache->new_entries) > 0) {
+		write_cache_file(cache);
+	}
+
+	g_hash_table_destroy(cache->new_entries);
+
+	if (cache->mapped_file) {
+		g_mapped_file_unref(cache->mapped_file);
+	}
+
+	g_free(cache->path);
+	g_free(cache);
+}
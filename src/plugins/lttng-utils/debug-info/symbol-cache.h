@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_DEBUG_INFO_SYMBOL_CACHE_H
+#define BABELTRACE_PLUGIN_DEBUG_INFO_SYMBOL_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <babeltrace2/babeltrace.h>
+
+#include "common/macros.h"
+
+/*
+ * Symbolization cache file written by `flt.lttng-utils.debug-info` in
+ * the directory given by its `symbol-cache-dir` parameter.
+ *
+ * There's one cache file per build ID, named after the hexadecimal
+ * build ID. A cache file maps addresses within the executable (offsets
+ * for position-independent code) to the function name and source
+ * location which the ELF and DWARF lookups found.
+ *
+ * Like the `src.ctf.fs` packet index cache, a cache file is a local,
+ * host-specific artifact: all integer fields are stored in native byte
+ * order, so that a cache file written on a host with a different byte
+ * order fails the magic number check.
+ */
+#define DEBUG_INFO_SYMBOL_CACHE_MAGIC		0xB75C0DE5
+#define DEBUG_INFO_SYMBOL_CACHE_VERSION		1
+#define DEBUG_INFO_SYMBOL_CACHE_SUFFIX		".btsym"
+
+/* String offset meaning "no string" within a cache entry */
+#define DEBUG_INFO_SYMBOL_CACHE_NO_STR		UINT32_C(-1)
+
+/* Line number meaning "no source location" within a cache entry */
+#define DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO	UINT64_C(-1)
+
+/*
+ * Header at the beginning of each cache file.
+ *
+ * The header is followed by `entry_count` instances of
+ * `struct debug_info_symbol_cache_entry`, sorted by address, and
+ * then by `strings_len` bytes of null-terminated strings.
+ */
+struct debug_info_symbol_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+
+	/* Size of `struct debug_info_symbol_cache_entry`, in bytes */
+	uint32_t entry_len;
+	uint32_t strings_len;
+	uint64_t entry_count;
+} __attribute__((__packed__));
+
+struct debug_info_symbol_cache_entry {
+	uint64_t addr;
+	uint64_t line_no;		/* DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO if none */
+	uint32_t func_offset;		/* DEBUG_INFO_SYMBOL_CACHE_NO_STR if none */
+	uint32_t src_path_offset;	/* DEBUG_INFO_SYMBOL_CACHE_NO_STR if none */
+} __attribute__((__packed__));
+
+struct debug_info_symbol_cache;
+
+/*
+ * Creates a symbolization cache for the executable having the build ID
+ * `build_id`, memory-mapping its existing cache file within `cache_dir`
+ * if any.
+ */
+BT_HIDDEN
+struct debug_info_symbol_cache *debug_info_symbol_cache_create(
+		const char *cache_dir, const uint8_t *build_id,
+		size_t build_id_len, bt_logging_level log_level,
+		bt_self_component *self_comp);
+
+/*
+ * Writes the cache file of `cache` if lookups added entries to it, and
+ * then destroys it.
+ *
+ * Failing to write the cache file is not an error: the next run simply
+ * looks up the addresses again.
+ */
+BT_HIDDEN
+void debug_info_symbol_cache_destroy(struct debug_info_symbol_cache *cache);
+
+/*
+ * Looks up the address `addr` in `cache`.
+ *
+ * On hit, returns true and sets `*func` and `*src_path` (`NULL` if
+ * none; owned by `cache`) and `*line_no`
+ * (`DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO` if none).
+ */
+BT_HIDDEN
+bool debug_info_symbol_cache_lookup(struct debug_info_symbol_cache *cache,
+		uint64_t addr, const char **func, const char **src_path,
+		uint64_t *line_no);
+
+/*
+ * Adds the result of the lookups of the address `addr` to `cache`.
+ *
+ * `func` and `src_path` may be `NULL`; `line_no` may be
+ * `DEBUG_INFO_SYMBOL_CACHE_NO_LINE_NO`.
+ */
+BT_HIDDEN
+void debug_info_symbol_cache_add(struct debug_info_symbol_cache *cache,
+		uint64_t addr, const char *func, const char *src_path,
+		uint64_t line_no);
+
+#endif	/* BABELTRACE_PLUGIN_DEBUG_INFO_SYMBOL_CACHE_H */
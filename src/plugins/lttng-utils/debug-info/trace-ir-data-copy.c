@@ -14,6 +14,7 @@
 
 #include <inttypes.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "common/assert.h"
 #include "common/common.h"
@@ -297,20 +298,28 @@ enum debug_info_trace_ir_mapping_status copy_field_content(
 			goto end;
 		}
 	} else if (in_fc_type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
-		uint64_t i, nb_member_struct;
+		uint64_t i, nb_member_struct, nb_out_member_struct;
 		const bt_field *in_member_field;
 		bt_field *out_member_field;
 		const bt_field_class *in_field_class;
+		const bt_field_class *out_field_class;
 		const char *in_member_name;
 
 		in_field_class = bt_field_borrow_class_const(in_field);
+		out_field_class = bt_field_borrow_class_const(out_field);
 		nb_member_struct = bt_field_class_structure_get_member_count(
 			in_field_class);
+		nb_out_member_struct = bt_field_class_structure_get_member_count(
+			out_field_class);
 
 		/*
-		 * Iterate over the fields by names in the input field to avoid
-		 * problem if the struct fields are not in the same order after
-		 * the debug-info was added.
+		 * The output structure field class is a copy of the input
+		 * one, possibly with the debug-info member appended, so
+		 * members usually have the same index in both. Borrow them
+		 * by index when their names match to avoid two hash table
+		 * lookups per member and per event, and fall back to
+		 * borrowing by name otherwise in case the struct fields are
+		 * not in the same order after the debug-info was added.
 		 */
 		for (i = 0; i < nb_member_struct; i++) {
 			const bt_field_class_structure_member *member =
@@ -321,11 +330,22 @@ enum debug_info_trace_ir_mapping_status copy_field_content(
 				bt_field_class_structure_member_get_name(
 					member);
 			in_member_field =
-				bt_field_structure_borrow_member_field_by_name_const(
-					in_field, in_member_name);
-			out_member_field =
-				bt_field_structure_borrow_member_field_by_name(
-					out_field, in_member_name);
+				bt_field_structure_borrow_member_field_by_index_const(
+					in_field, i);
+
+			if (i < nb_out_member_struct &&
+					strcmp(in_member_name,
+						bt_field_class_structure_member_get_name(
+							bt_field_class_structure_borrow_member_by_index_const(
+								out_field_class, i))) == 0) {
+				out_member_field =
+					bt_field_structure_borrow_member_field_by_index(
+						out_field, i);
+			} else {
+				out_member_field =
+					bt_field_structure_borrow_member_field_by_name(
+						out_field, in_member_name);
+			}
 
 			status = copy_field_content(in_member_field,
 				out_member_field, log_level, self_comp);
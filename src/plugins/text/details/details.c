@@ -30,6 +30,52 @@
 #define WITH_UUID_PARAM_NAME "with-uuid"
 #define COMPACT_PARAM_NAME "compact"
 
+static
+void destroy_gstring(void *data)
+{
+	g_string_free(data, TRUE);
+}
+
+static
+void destroy_details_struct_member_names(void *data)
+{
+	struct details_struct_member_names *member_names = data;
+
+	if (!member_names) {
+		goto end;
+	}
+
+	if (member_names->lines) {
+		g_ptr_array_free(member_names->lines, TRUE);
+	}
+
+	g_free(member_names);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+struct details_struct_member_names *details_create_details_struct_member_names(
+		void)
+{
+	struct details_struct_member_names *member_names =
+		g_new0(struct details_struct_member_names, 1);
+
+	if (!member_names) {
+		goto end;
+	}
+
+	member_names->lines = g_ptr_array_new_with_free_func(destroy_gstring);
+	if (!member_names->lines) {
+		destroy_details_struct_member_names(member_names);
+		member_names = NULL;
+	}
+
+end:
+	return member_names;
+}
+
 BT_HIDDEN
 void details_destroy_details_trace_class_meta(
 		struct details_trace_class_meta *details_tc_meta)
@@ -43,6 +89,11 @@ void details_destroy_details_trace_class_meta(
 		details_tc_meta->objects = NULL;
 	}
 
+	if (details_tc_meta->struct_member_names) {
+		g_hash_table_destroy(details_tc_meta->struct_member_names);
+		details_tc_meta->struct_member_names = NULL;
+	}
+
 	g_free(details_tc_meta);
 
 end:
@@ -67,6 +118,15 @@ struct details_trace_class_meta *details_create_details_trace_class_meta(void)
 		goto end;
 	}
 
+	details_tc_meta->struct_member_names = g_hash_table_new_full(
+		g_direct_hash, g_direct_equal, NULL,
+		destroy_details_struct_member_names);
+	if (!details_tc_meta->struct_member_names) {
+		details_destroy_details_trace_class_meta(details_tc_meta);
+		details_tc_meta = NULL;
+		goto end;
+	}
+
 	details_tc_meta->tc_destruction_listener_id = UINT64_C(-1);
 
 end:
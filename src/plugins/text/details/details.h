@@ -11,6 +11,21 @@
 #include <babeltrace2/babeltrace.h>
 #include <stdbool.h>
 
+/*
+ * Pre-rendered member name lines of a structure field class, as
+ * written when writing the members of a structure field.
+ */
+struct details_struct_member_names {
+	/* Indentation level with which `lines` were rendered */
+	unsigned int indent_level;
+
+	/*
+	 * `GString *` (owned by this), one per member: newline,
+	 * indentation, colored member name, and `:`.
+	 */
+	GPtrArray *lines;
+};
+
 /*
  * This structure contains a hash table which maps trace IR stream class
  * and event class addresses to whether or not they have been printed
@@ -34,6 +49,18 @@ struct details_trace_class_meta {
 	 */
 	GHashTable *objects;
 
+	/*
+	 * Structure field class address (`const bt_field_class *`) ->
+	 * `struct details_struct_member_names *` (owned by this)
+	 *
+	 * Like for `objects` above, the keys are safe to keep as long
+	 * as the trace class exists.
+	 */
+	GHashTable *struct_member_names;
+
+	/* True if the trace class itself was written */
+	bool written;
+
 	/*
 	 * Trace class destruction listener ID (`UINT64_C(-1)` if
 	 * there's no listener ID.
@@ -101,10 +128,11 @@ struct details_comp {
 	 * `const bt_trace_class *` (weak) ->
 	 * `struct details_trace_class_meta *` (owned by this)
 	 *
-	 * The key (trace class object) is weak. An entry is added, if
-	 * `cfg.with_meta` above is true, when first encountering a
-	 * trace class. An entry is removed when a trace class is
-	 * destroyed or when the component is finalized.
+	 * The key (trace class object) is weak. An entry is added when
+	 * first encountering a trace class (when writing it, if
+	 * `cfg.with_meta` above is true, or when writing structure
+	 * fields). An entry is removed when a trace class is destroyed
+	 * or when the component is finalized.
 	 */
 	GHashTable *meta;
 
@@ -167,4 +195,8 @@ void details_destroy_details_trace_class_meta(
 BT_HIDDEN
 struct details_trace_class_meta *details_create_details_trace_class_meta(void);
 
+BT_HIDDEN
+struct details_struct_member_names *details_create_details_struct_member_names(
+		void);
+
 #endif /* BABELTRACE_PLUGINS_TEXT_DETAILS_DETAILS_H */
@@ -28,13 +28,12 @@ void trace_class_destruction_listener(const bt_trace_class *tc, void *data)
 	g_hash_table_remove(details_comp->meta, tc);
 }
 
-static
-struct details_trace_class_meta *borrow_trace_class_meta(
+BT_HIDDEN
+struct details_trace_class_meta *details_borrow_trace_class_meta(
 		struct details_write_ctx *ctx, const bt_trace_class *tc)
 {
 	struct details_trace_class_meta *details_tc_meta;
 
-	BT_ASSERT_DBG(ctx->details_comp->cfg.with_meta);
 	BT_ASSERT_DBG(ctx->details_comp->meta);
 	details_tc_meta = g_hash_table_lookup(ctx->details_comp->meta, tc);
 	if (!details_tc_meta) {
@@ -96,7 +95,7 @@ void details_did_write_meta_object(struct details_write_ctx *ctx,
 	struct details_trace_class_meta *details_tc_meta;
 
 	BT_ASSERT(ctx->details_comp->cfg.with_meta);
-	details_tc_meta = borrow_trace_class_meta(ctx, tc);
+	details_tc_meta = details_borrow_trace_class_meta(ctx, tc);
 	BT_ASSERT(details_tc_meta);
 	g_hash_table_insert(details_tc_meta->objects, (gpointer) obj,
 		GUINT_TO_POINTER(1));
@@ -116,7 +115,7 @@ bool details_need_to_write_trace_class(struct details_write_ctx *ctx,
 
 	BT_ASSERT_DBG(ctx->details_comp->meta);
 	details_tc_meta = g_hash_table_lookup(ctx->details_comp->meta, tc);
-	need_to_write = !details_tc_meta;
+	need_to_write = !details_tc_meta || !details_tc_meta->written;
 
 end:
 	return need_to_write;
@@ -131,12 +130,16 @@ int details_did_write_trace_class(struct details_write_ctx *ctx,
 
 	BT_ASSERT(ctx->details_comp->cfg.with_meta);
 
-	/* borrow_trace_class_meta() creates an entry if none exists */
-	details_tc_meta = borrow_trace_class_meta(ctx, tc);
+	/* details_borrow_trace_class_meta() creates an entry if none exists */
+	details_tc_meta = details_borrow_trace_class_meta(ctx, tc);
 	if (!details_tc_meta) {
 		ret = -1;
+		goto end;
 	}
 
+	details_tc_meta->written = true;
+
+end:
 	return ret;
 }
 
@@ -49,6 +49,10 @@ int details_did_write_trace_class(struct details_write_ctx *ctx,
  * new unique ID if none exists.
  */
 BT_HIDDEN
+struct details_trace_class_meta *details_borrow_trace_class_meta(
+		struct details_write_ctx *ctx, const bt_trace_class *tc);
+
+BT_HIDDEN
 int details_trace_unique_id(struct details_write_ctx *ctx,
 		const bt_trace *trace, uint64_t *unique_id);
 
@@ -172,21 +172,42 @@ void write_sp(struct details_write_ctx *ctx)
 static inline
 void write_indent(struct details_write_ctx *ctx)
 {
-	uint64_t i;
+	/* Appended in as few spans as possible */
+	static const char spaces[] =
+		"                                "
+		"                                ";
+	unsigned int rem;
 
 	BT_ASSERT_DBG(ctx);
+	rem = ctx->indent_level;
 
-	for (i = 0; i < ctx->indent_level; i++) {
-		write_sp(ctx);
+	while (rem > 0) {
+		unsigned int len = MIN(rem, sizeof(spaces) - 1);
+
+		g_string_append_len(ctx->str, spaces, len);
+		rem -= len;
 	}
 }
 
+/*
+ * Appends `str` between `color` and the color reset sequence: cheaper
+ * than going through g_string_append_printf().
+ */
+static inline
+void write_colored(struct details_write_ctx *ctx, const char *color,
+		const char *str)
+{
+	g_string_append(ctx->str, color);
+	g_string_append(ctx->str, str);
+	g_string_append(ctx->str, color_reset(ctx));
+}
+
 static inline
 void write_compound_member_name(struct details_write_ctx *ctx, const char *name)
 {
 	write_indent(ctx);
-	g_string_append_printf(ctx->str, "%s%s%s:",
-		color_fg_cyan(ctx), name, color_reset(ctx));
+	write_colored(ctx, color_fg_cyan(ctx), name);
+	g_string_append_c(ctx->str, ':');
 }
 
 static inline
@@ -197,46 +218,46 @@ void write_array_index(struct details_write_ctx *ctx, uint64_t index,
 
 	write_indent(ctx);
 	format_uint(buf, index, 10);
-	g_string_append_printf(ctx->str, "%s[%s]%s:",
-		color, buf, color_reset(ctx));
+	g_string_append(ctx->str, color);
+	g_string_append_c(ctx->str, '[');
+	g_string_append(ctx->str, buf);
+	g_string_append_c(ctx->str, ']');
+	g_string_append(ctx->str, color_reset(ctx));
+	g_string_append_c(ctx->str, ':');
 }
 
 static inline
 void write_obj_type_name(struct details_write_ctx *ctx, const char *name)
 {
-	g_string_append_printf(ctx->str, "%s%s%s%s",
-		color_bold(ctx), color_fg_bright_yellow(ctx), name,
-		color_reset(ctx));
+	g_string_append(ctx->str, color_bold(ctx));
+	write_colored(ctx, color_fg_bright_yellow(ctx), name);
 }
 
 static inline
 void write_prop_name(struct details_write_ctx *ctx, const char *prop_name)
 {
-	g_string_append_printf(ctx->str, "%s%s%s",
-		color_fg_magenta(ctx), prop_name, color_reset(ctx));
+	write_colored(ctx, color_fg_magenta(ctx), prop_name);
 }
 
 static inline
 void write_prop_name_line(struct details_write_ctx *ctx, const char *prop_name)
 {
 	write_indent(ctx);
-	g_string_append_printf(ctx->str, "%s%s%s:",
-		color_fg_magenta(ctx), prop_name, color_reset(ctx));
+	write_prop_name(ctx, prop_name);
+	g_string_append_c(ctx->str, ':');
 }
 
 static inline
 void write_str_prop_value(struct details_write_ctx *ctx, const char *value)
 {
-	g_string_append_printf(ctx->str, "%s%s%s",
-		color_bold(ctx), value, color_reset(ctx));
+	write_colored(ctx, color_bold(ctx), value);
 }
 
 static inline
 void write_none_prop_value(struct details_write_ctx *ctx, const char *value)
 {
-	g_string_append_printf(ctx->str, "%s%s%s%s",
-		color_bold(ctx), color_fg_bright_magenta(ctx),
-		value, color_reset(ctx));
+	g_string_append(ctx->str, color_bold(ctx));
+	write_colored(ctx, color_fg_bright_magenta(ctx), value);
 }
 
 static inline
@@ -325,7 +346,8 @@ void write_bool_prop_value(struct details_write_ctx *ctx, bt_bool prop_value)
 		str = "No";
 	}
 
-	g_string_append_printf(ctx->str, "%s%s", str, color_reset(ctx));
+	g_string_append(ctx->str, str);
+	g_string_append(ctx->str, color_reset(ctx));
 }
 
 static inline
@@ -1773,6 +1795,65 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the pre-rendered member name lines of the structure field
+ * class `fc` for the current indentation level, rendering them first
+ * if needed, or `NULL` if they're not available.
+ */
+static
+const GPtrArray *borrow_struct_member_names(struct details_write_ctx *ctx,
+		const bt_field_class *fc)
+{
+	struct details_struct_member_names *member_names = NULL;
+	uint64_t member_count;
+	uint64_t i;
+
+	if (!ctx->tc_meta) {
+		goto end;
+	}
+
+	member_names = g_hash_table_lookup(ctx->tc_meta->struct_member_names,
+		fc);
+	if (member_names) {
+		if (member_names->indent_level == ctx->indent_level) {
+			goto end;
+		}
+
+		/* Same class at another level: render again */
+		g_ptr_array_set_size(member_names->lines, 0);
+	} else {
+		member_names = details_create_details_struct_member_names();
+		if (!member_names) {
+			goto end;
+		}
+
+		g_hash_table_insert(ctx->tc_meta->struct_member_names,
+			(gpointer) fc, member_names);
+	}
+
+	member_names->indent_level = ctx->indent_level;
+	member_count = bt_field_class_structure_get_member_count(fc);
+
+	for (i = 0; i < member_count; i++) {
+		const bt_field_class_structure_member *member =
+			bt_field_class_structure_borrow_member_by_index_const(
+				fc, i);
+		struct details_write_ctx line_ctx = {
+			.details_comp = ctx->details_comp,
+			.str = g_string_new(NULL),
+			.indent_level = ctx->indent_level,
+		};
+
+		write_nl(&line_ctx);
+		write_compound_member_name(&line_ctx,
+			bt_field_class_structure_member_get_name(member));
+		g_ptr_array_add(member_names->lines, line_ctx.str);
+	}
+
+end:
+	return member_names ? member_names->lines : NULL;
+}
+
 static
 void write_field(struct details_write_ctx *ctx, const bt_field *field,
 		const char *name)
@@ -1851,19 +1932,32 @@ void write_field(struct details_write_ctx *ctx, const bt_field *field,
 		member_count = bt_field_class_structure_get_member_count(fc);
 
 		if (member_count > 0) {
+			const GPtrArray *member_names;
+
 			incr_indent(ctx);
+			member_names = borrow_struct_member_names(ctx, fc);
 
 			for (i = 0; i < member_count; i++) {
-				const bt_field_class_structure_member *member =
-					bt_field_class_structure_borrow_member_by_index_const(
-						fc, i);
 				const bt_field *member_field =
 					bt_field_structure_borrow_member_field_by_index_const(
 						field, i);
 
-				write_nl(ctx);
-				write_field(ctx, member_field,
-					bt_field_class_structure_member_get_name(member));
+				if (member_names) {
+					const GString *line =
+						member_names->pdata[i];
+
+					g_string_append_len(ctx->str,
+						line->str, line->len);
+					write_field(ctx, member_field, NULL);
+				} else {
+					const bt_field_class_structure_member *member =
+						bt_field_class_structure_borrow_member_by_index_const(
+							fc, i);
+
+					write_nl(ctx);
+					write_field(ctx, member_field,
+						bt_field_class_structure_member_get_name(member));
+				}
 			}
 
 			decr_indent(ctx);
@@ -1996,6 +2090,7 @@ int write_event_message(struct details_write_ctx *ctx,
 	}
 
 	/* Write fields */
+	ctx->tc_meta = details_borrow_trace_class_meta(ctx, tc);
 	g_string_append(ctx->str, ":\n");
 	incr_indent(ctx);
 	field = bt_event_borrow_common_context_field_const(event);
@@ -2338,6 +2433,8 @@ int write_packet_beginning_message(struct details_write_ctx *ctx,
 	/* Write field */
 	field = bt_packet_borrow_context_field_const(packet);
 	if (field) {
+		ctx->tc_meta = details_borrow_trace_class_meta(ctx,
+			bt_stream_class_borrow_trace_class_const(sc));
 		g_string_append(ctx->str, ":\n");
 		incr_indent(ctx);
 		write_root_field(ctx, "Context", field);
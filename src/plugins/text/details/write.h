@@ -23,6 +23,13 @@ struct details_write_ctx {
 
 	/* Current indentation level (number of actual spaces) */
 	unsigned int indent_level;
+
+	/*
+	 * Weak (belongs to `details_comp` above): metadata of the
+	 * trace class of the current message, if any, for cached
+	 * structure member names.
+	 */
+	struct details_trace_class_meta *tc_meta;
 };
 
 /*
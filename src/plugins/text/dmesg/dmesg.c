@@ -15,12 +15,13 @@
 #include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
 #include <stdio.h>
+#include <unistd.h>
 #include "common/common.h"
 #include "common/assert.h"
 #include <babeltrace2/babeltrace.h>
 #include "compat/utc.h"
-#include "compat/stdio.h"
 #include <glib.h>
 #include "plugins/common/param-validation/param-validation.h"
 
@@ -29,6 +30,9 @@
 #define NSEC_PER_SEC 1000000000ULL
 #define USEC_PER_SEC 1000000UL
 
+/* Initial size of the input buffer (grows to contain the longest line) */
+#define INPUT_BUF_INIT_SIZE (256 * 1024)
+
 struct dmesg_component;
 
 struct dmesg_msg_iter {
@@ -37,9 +41,27 @@ struct dmesg_msg_iter {
 	/* Weak */
 	bt_self_message_iterator *self_msg_iter;
 
-	char *linebuf;
-	size_t linebuf_len;
 	FILE *fp;
+
+	/*
+	 * Input buffer: lines are read from `fp` in large chunks and
+	 * split in place.
+	 *
+	 * `buf` has room for `buf_size + 1` bytes so that a last line
+	 * without a newline character can be null-terminated too.
+	 */
+	char *buf;
+	size_t buf_size;
+
+	/* Number of valid bytes in `buf` */
+	size_t buf_len;
+
+	/* Offset of the next line within `buf` */
+	size_t buf_pos;
+
+	/* True when reading `fp` reached the end of file */
+	bool eof;
+
 	bt_message *tmp_event_msg;
 	uint64_t last_clock_value;
 
@@ -444,6 +466,72 @@ void dmesg_finalize(bt_self_component_source *self_comp)
 		bt_self_component_source_as_self_component(self_comp)));
 }
 
+/*
+ * Parses the unsigned decimal integer at `*pos`, after optional
+ * whitespaces, like the `%lu` conversion of sscanf() does (without a
+ * sign), and sets `*pos` to the first character after it.
+ *
+ * Returns false if there's no digit.
+ */
+static inline
+bool parse_uint(const char **pos, uint64_t *value)
+{
+	const char *ch = *pos;
+	uint64_t val = 0;
+
+	while (*ch == ' ' || *ch == '\t') {
+		ch++;
+	}
+
+	if (*ch < '0' || *ch > '9') {
+		return false;
+	}
+
+	for (; *ch >= '0' && *ch <= '9'; ch++) {
+		val = val * 10 + (uint64_t) (*ch - '0');
+	}
+
+	*value = val;
+	*pos = ch;
+	return true;
+}
+
+/*
+ * Parses the usual `[seconds.microseconds]` prefix of `line`, setting
+ * `*ts` to the corresponding time in nanoseconds.
+ *
+ * Returns false if `line` doesn't start with such a prefix.
+ */
+static
+bool parse_sec_usec_ts(const char *line, uint64_t *ts)
+{
+	const char *ch = line;
+	uint64_t sec, usec;
+
+	if (*ch != '[') {
+		return false;
+	}
+
+	ch++;
+
+	if (!parse_uint(&ch, &sec) || *ch != '.') {
+		return false;
+	}
+
+	ch++;
+
+	if (!parse_uint(&ch, &usec) || *ch != ']') {
+		return false;
+	}
+
+	/*
+	 * The clock class we use has a 1 GHz frequency: convert from
+	 * µs to ns.
+	 */
+	*ts = (sec * USEC_PER_SEC + usec) * NSEC_PER_USEC;
+	return true;
+}
+
 static
 bt_message *create_init_event_msg_from_line(
 		struct dmesg_msg_iter *msg_iter,
@@ -452,7 +540,7 @@ bt_message *create_init_event_msg_from_line(
 	bt_event *event;
 	bt_message *msg = NULL;
 	bool has_timestamp = false;
-	unsigned long sec, usec, msec;
+	unsigned long sec, msec;
 	unsigned int year, mon, mday, hour, min;
 	uint64_t ts = 0;
 	int ret = 0;
@@ -465,16 +553,10 @@ bt_message *create_init_event_msg_from_line(
 	}
 
 	/* Extract time from input line */
-	if (sscanf(line, "[%lu.%lu] ", &sec, &usec) == 2) {
-		ts = (uint64_t) sec * USEC_PER_SEC + (uint64_t) usec;
-
-		/*
-		 * The clock class we use has a 1 GHz frequency: convert
-		 * from µs to ns.
-		 */
-		ts *= NSEC_PER_USEC;
+	if (parse_sec_usec_ts(line, &ts)) {
 		has_timestamp = true;
-	} else if (sscanf(line, "[%u-%u-%u %u:%u:%lu.%lu] ",
+	} else if (line[0] == '[' &&
+			sscanf(line, "[%u-%u-%u %u:%u:%lu.%lu] ",
 			&year, &mon, &mday, &hour, &min,
 			&sec, &msec) == 7) {
 		time_t ep_sec;
@@ -500,7 +582,12 @@ bt_message *create_init_event_msg_from_line(
 	if (has_timestamp) {
 		/* Set new start for the message portion of the line */
 		*new_start = strchr(line, ']');
-		BT_ASSERT_DBG(*new_start);
+		if (!*new_start) {
+			/* Unterminated prefix: keep the whole line */
+			*new_start = line;
+			goto skip_ts;
+		}
+
 		(*new_start)++;
 
 		if ((*new_start)[0] == ' ') {
@@ -549,11 +636,10 @@ end:
 
 static
 int fill_event_payload_from_line(struct dmesg_component *dmesg_comp,
-		const char *line, bt_event *event)
+		const char *line, size_t len, bt_event *event)
 {
 	bt_field *ep_field = NULL;
 	bt_field *str_field = NULL;
-	size_t len;
 	int ret;
 
 	ep_field = bt_event_borrow_payload_field(event);
@@ -566,12 +652,6 @@ int fill_event_payload_from_line(struct dmesg_component *dmesg_comp,
 		goto error;
 	}
 
-	len = strlen(line);
-	if (line[len - 1] == '\n') {
-		/* Do not include the newline character in the payload */
-		len--;
-	}
-
 	bt_field_string_clear(str_field);
 	ret = bt_field_string_append_with_length(str_field, line, len);
 	if (ret) {
@@ -589,9 +669,14 @@ end:
 	return ret;
 }
 
+/*
+ * `line` is null-terminated and its `len` characters don't include the
+ * newline character.
+ */
 static
 bt_message *create_msg_from_line(
-		struct dmesg_msg_iter *dmesg_msg_iter, const char *line)
+		struct dmesg_msg_iter *dmesg_msg_iter, const char *line,
+		size_t len)
 {
 	struct dmesg_component *dmesg_comp = dmesg_msg_iter->dmesg_comp;
 	bt_event *event = NULL;
@@ -609,7 +694,8 @@ bt_message *create_msg_from_line(
 
 	event = bt_message_event_borrow_event(msg);
 	BT_ASSERT_DBG(event);
-	ret = fill_event_payload_from_line(dmesg_comp, new_start, event);
+	ret = fill_event_payload_from_line(dmesg_comp, new_start,
+		len - (size_t) (new_start - line), event);
 	if (ret) {
 		BT_COMP_LOGE_APPEND_CAUSE(dmesg_comp->self_comp,
 			"Cannot fill event payload field from line: ret=%d", ret);
@@ -644,10 +730,92 @@ void destroy_dmesg_msg_iter(struct dmesg_msg_iter *dmesg_msg_iter)
 	}
 
 	bt_message_put_ref(dmesg_msg_iter->tmp_event_msg);
-	free(dmesg_msg_iter->linebuf);
+	g_free(dmesg_msg_iter->buf);
 	g_free(dmesg_msg_iter);
 }
 
+/*
+ * Sets `*line` to the next line of the input buffer, reading more of
+ * the input file as needed, and `*len` to its length, excluding the
+ * newline character (replaced with a null character).
+ *
+ * Returns 0 on success, 1 at the end of the input file, or -1 on
+ * error.
+ */
+static
+int read_line(struct dmesg_msg_iter *dmesg_msg_iter, char **line,
+		size_t *len)
+{
+	struct dmesg_component *dmesg_comp = dmesg_msg_iter->dmesg_comp;
+	int ret;
+
+	while (true) {
+		char *start = dmesg_msg_iter->buf + dmesg_msg_iter->buf_pos;
+		size_t avail = dmesg_msg_iter->buf_len -
+			dmesg_msg_iter->buf_pos;
+		char *nl = avail > 0 ? memchr(start, '\n', avail) : NULL;
+		ssize_t read_len;
+
+		if (nl) {
+			*nl = '\0';
+			*line = start;
+			*len = (size_t) (nl - start);
+			dmesg_msg_iter->buf_pos += *len + 1;
+			ret = 0;
+			goto end;
+		}
+
+		if (dmesg_msg_iter->eof) {
+			if (avail == 0) {
+				ret = 1;
+				goto end;
+			}
+
+			/* Last line without a newline character */
+			start[avail] = '\0';
+			*line = start;
+			*len = avail;
+			dmesg_msg_iter->buf_pos = dmesg_msg_iter->buf_len;
+			ret = 0;
+			goto end;
+		}
+
+		/* Move the partial line to the beginning of the buffer */
+		if (dmesg_msg_iter->buf_pos > 0) {
+			memmove(dmesg_msg_iter->buf, start, avail);
+			dmesg_msg_iter->buf_len = avail;
+			dmesg_msg_iter->buf_pos = 0;
+		}
+
+		/* Partial line fills the whole buffer: grow it */
+		if (dmesg_msg_iter->buf_len == dmesg_msg_iter->buf_size) {
+			dmesg_msg_iter->buf_size *= 2;
+			dmesg_msg_iter->buf = g_realloc(dmesg_msg_iter->buf,
+				dmesg_msg_iter->buf_size + 1);
+		}
+
+		do {
+			read_len = read(fileno(dmesg_msg_iter->fp),
+				dmesg_msg_iter->buf + dmesg_msg_iter->buf_len,
+				dmesg_msg_iter->buf_size -
+					dmesg_msg_iter->buf_len);
+		} while (read_len < 0 && errno == EINTR);
+
+		if (read_len < 0) {
+			BT_COMP_LOGE_APPEND_CAUSE_ERRNO(dmesg_comp->self_comp,
+				"Cannot read input file", ".");
+			ret = -1;
+			goto end;
+		} else if (read_len == 0) {
+			dmesg_msg_iter->eof = true;
+		} else {
+			dmesg_msg_iter->buf_len += (size_t) read_len;
+		}
+	}
+
+end:
+	return ret;
+}
 
 
 BT_HIDDEN
@@ -687,6 +855,8 @@ bt_message_iterator_class_initialize_method_status dmesg_msg_iter_init(
 		}
 	}
 
+	dmesg_msg_iter->buf_size = INPUT_BUF_INIT_SIZE;
+	dmesg_msg_iter->buf = g_malloc(dmesg_msg_iter->buf_size + 1);
 	bt_self_message_iterator_set_data(self_msg_iter,
 		dmesg_msg_iter);
 
@@ -714,7 +884,8 @@ bt_message_iterator_class_next_method_status dmesg_msg_iter_next_one(
 		struct dmesg_msg_iter *dmesg_msg_iter,
 		bt_message **msg)
 {
-	ssize_t len;
+	char *line;
+	size_t len;
 	struct dmesg_component *dmesg_comp;
 	bt_message_iterator_class_next_method_status status;
 
@@ -733,18 +904,14 @@ bt_message_iterator_class_next_method_status dmesg_msg_iter_next_one(
 	}
 
 	while (true) {
-		const char *ch;
+		size_t i;
 		bool only_spaces = true;
+		int ret = read_line(dmesg_msg_iter, &line, &len);
 
-		len = bt_getline(&dmesg_msg_iter->linebuf,
-			&dmesg_msg_iter->linebuf_len, dmesg_msg_iter->fp);
-		if (len < 0) {
-			if (errno == EINVAL) {
+		if (ret) {
+			if (ret < 0) {
 				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
 				goto end;
-			} else if (errno == ENOMEM) {
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
-				goto end;
 			} else {
 				if (dmesg_msg_iter->state == STATE_EMIT_STREAM_BEGINNING) {
 					/* Stream did not even begin */
@@ -759,11 +926,9 @@ bt_message_iterator_class_next_method_status dmesg_msg_iter_next_one(
 			}
 		}
 
-		BT_ASSERT_DBG(dmesg_msg_iter->linebuf);
-
 		/* Ignore empty lines, once trimmed */
-		for (ch = dmesg_msg_iter->linebuf; *ch != '\0'; ch++) {
-			if (!isspace((unsigned char) *ch)) {
+		for (i = 0; i < len; i++) {
+			if (!isspace((unsigned char) line[i])) {
 				only_spaces = false;
 				break;
 			}
@@ -775,12 +940,12 @@ bt_message_iterator_class_next_method_status dmesg_msg_iter_next_one(
 	}
 
 	dmesg_msg_iter->tmp_event_msg = create_msg_from_line(
-		dmesg_msg_iter, dmesg_msg_iter->linebuf);
+		dmesg_msg_iter, line, len);
 	if (!dmesg_msg_iter->tmp_event_msg) {
 		BT_COMP_LOGE_APPEND_CAUSE(dmesg_comp->self_comp,
 			"Cannot create event message from line: "
 			"dmesg-comp-addr=%p, line=\"%s\"", dmesg_comp,
-			dmesg_msg_iter->linebuf);
+			line);
 		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
 		goto end;
 	}
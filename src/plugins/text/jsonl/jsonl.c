@@ -0,0 +1,260 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (jsonl->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (jsonl->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.TEXT.JSONL"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <stdio.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "jsonl.h"
+#include "write.h"
+
+/* Default value of the `output-buffer-size` parameter (bytes) */
+#define DEFAULT_OUTPUT_BUFFER_SIZE	(64 * 1024)
+
+static
+const char * const in_port_name = "in";
+
+static
+void destroy_jsonl_comp(struct jsonl_comp *jsonl)
+{
+	if (!jsonl) {
+		goto end;
+	}
+
+	bt_message_iterator_put_ref(jsonl->msg_iter);
+
+	if (jsonl->str && jsonl->out) {
+		if (jsonl_flush(jsonl)) {
+			BT_COMP_LOGW_STR("Cannot write the last lines.");
+		}
+	}
+
+	jsonl_write_fini(jsonl);
+
+	if (jsonl->str) {
+		g_string_free(jsonl->str, TRUE);
+	}
+
+	if (jsonl->out && jsonl->out != stdout) {
+		if (fclose(jsonl->out)) {
+			BT_COMP_LOGW_ERRNO("Cannot close output file",
+				": path=\"%s\"", jsonl->output_path);
+		}
+	}
+
+	g_free(jsonl->output_path);
+	g_free(jsonl);
+
+end:
+	return;
+}
+
+static
+struct bt_param_validation_map_value_entry_descr jsonl_params[] = {
+	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "output-buffer-size", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+bt_component_class_initialize_method_status configure_jsonl_comp(
+		struct jsonl_comp *jsonl, const bt_value *params)
+{
+	bt_component_class_initialize_method_status status;
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+	const bt_value *value;
+
+	validation_status = bt_param_validation_validate(params,
+		jsonl_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(jsonl->self_comp, "%s",
+			validate_error);
+		goto end;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "path");
+	if (value) {
+		jsonl->output_path = g_strdup(bt_value_string_get(value));
+		jsonl->out = fopen(jsonl->output_path, "w");
+		if (!jsonl->out) {
+			BT_COMP_LOGE_APPEND_CAUSE_ERRNO(jsonl->self_comp,
+				"Cannot open output file for writing",
+				": path=\"%s\"", jsonl->output_path);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	} else {
+		jsonl->out = stdout;
+	}
+
+	jsonl->output_buffer_size = DEFAULT_OUTPUT_BUFFER_SIZE;
+	value = bt_value_map_borrow_entry_value_const(params,
+		"output-buffer-size");
+	if (value) {
+		jsonl->output_buffer_size =
+			bt_value_integer_unsigned_get(value);
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status jsonl_init(
+		bt_self_component_sink *self_comp_sink,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params,
+		__attribute__((unused)) void *init_method_data)
+{
+	bt_component_class_initialize_method_status status;
+	bt_self_component_add_port_status add_port_status;
+	struct jsonl_comp *jsonl = g_new0(struct jsonl_comp, 1);
+	bt_self_component *self_comp =
+		bt_self_component_sink_as_self_component(self_comp_sink);
+
+	jsonl->self_comp = self_comp;
+	jsonl->log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(self_comp));
+	jsonl->str = g_string_new(NULL);
+	jsonl_write_init(jsonl);
+	add_port_status = bt_self_component_sink_add_input_port(
+		self_comp_sink, in_port_name, NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	status = configure_jsonl_comp(jsonl, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
+	bt_self_component_set_data(self_comp, jsonl);
+	goto end;
+
+error:
+	destroy_jsonl_comp(jsonl);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void jsonl_finalize(bt_self_component_sink *comp)
+{
+	destroy_jsonl_comp(bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp)));
+}
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+jsonl_graph_is_configured(bt_self_component_sink *self_comp_sink)
+{
+	bt_component_class_sink_graph_is_configured_method_status status;
+	bt_message_iterator_create_from_sink_component_status
+		msg_iter_status;
+	bt_self_component *self_comp =
+		bt_self_component_sink_as_self_component(self_comp_sink);
+	struct jsonl_comp *jsonl = bt_self_component_get_data(self_comp);
+	bt_self_component_port_input *in_port;
+
+	BT_ASSERT(jsonl);
+	BT_ASSERT(!jsonl->msg_iter);
+	in_port = bt_self_component_sink_borrow_input_port_by_name(
+		self_comp_sink, in_port_name);
+	if (!bt_port_is_connected(bt_port_input_as_port_const(
+			bt_self_component_port_input_as_port_input(in_port)))) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Single input port is not connected: "
+			"port-name=\"%s\"", in_port_name);
+		status = BT_COMPONENT_CLASS_SINK_GRAPH_IS_CONFIGURED_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	msg_iter_status = bt_message_iterator_create_from_sink_component(
+		self_comp_sink, in_port, &jsonl->msg_iter);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_SINK_COMPONENT_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto end;
+	}
+
+	status = BT_COMPONENT_CLASS_SINK_GRAPH_IS_CONFIGURED_METHOD_STATUS_OK;
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status jsonl_consume(
+		bt_self_component_sink *comp)
+{
+	bt_component_class_sink_consume_method_status status;
+	struct jsonl_comp *jsonl = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	bt_message_iterator_next_status next_status;
+	bt_message_array_const msgs;
+	uint64_t count = 0;
+	uint64_t i = 0;
+
+	BT_ASSERT_DBG(jsonl);
+	next_status = bt_message_iterator_next(jsonl->msg_iter, &msgs, &count);
+	if (next_status != BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
+		status = (int) next_status;
+
+		/*
+		 * Nothing more to write for now (or ever): write what's
+		 * buffered so that a live reader sees it immediately.
+		 */
+		if (next_status == BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN ||
+				next_status == BT_MESSAGE_ITERATOR_NEXT_STATUS_END) {
+			if (jsonl_flush(jsonl)) {
+				status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			}
+		}
+
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		const bt_message *msg = msgs[i];
+
+		/* Only event messages have lines */
+		if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_EVENT &&
+				jsonl_write_event(jsonl, msg)) {
+			BT_COMP_LOGE_APPEND_CAUSE(jsonl->self_comp,
+				"Failed to write one event.");
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		bt_message_put_ref(msg);
+	}
+
+	status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+
+end:
+	for (; i < count; i++) {
+		bt_message_put_ref(msgs[i]);
+	}
+
+	return status;
+}
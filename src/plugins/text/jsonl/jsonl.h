@@ -0,0 +1,72 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_TEXT_JSONL_JSONL_H
+#define BABELTRACE_PLUGINS_TEXT_JSONL_JSONL_H
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+
+/* A `sink.text.jsonl` component */
+struct jsonl_comp {
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+
+	/* Upstream message iterator (owned by this) */
+	bt_message_iterator *msg_iter;
+
+	/* Output file path; `NULL` means the standard output */
+	gchar *output_path;
+
+	/* Output file */
+	FILE *out;
+
+	/*
+	 * Write the buffered lines to `out` once there are at least
+	 * this many bytes of them.
+	 */
+	uint64_t output_buffer_size;
+
+	/* Buffered lines */
+	GString *str;
+
+	/*
+	 * Event class (`const bt_event_class *`, owned by the value)
+	 * to pre-rendered beginning of its event objects (`GString *`,
+	 * owned by the hash table).
+	 */
+	GHashTable *event_class_prefixes;
+
+	/*
+	 * Structure or variant field class (`const bt_field_class *`,
+	 * weak: an event class of `event_class_prefixes` owns it) to
+	 * pre-escaped keys of its members or options (`GPtrArray *` of
+	 * `GString *`, owned by the hash table).
+	 */
+	GHashTable *field_class_keys;
+};
+
+BT_HIDDEN
+bt_component_class_initialize_method_status jsonl_init(
+		bt_self_component_sink *self_comp,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void jsonl_finalize(bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+jsonl_graph_is_configured(bt_self_component_sink *comp);
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status jsonl_consume(
+		bt_self_component_sink *component);
+
+#endif /* BABELTRACE_PLUGINS_TEXT_JSONL_JSONL_H */
@@ -0,0 +1,462 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (jsonl->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (jsonl->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.TEXT.JSONL/WRITE"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "common/common.h"
+
+#include "write.h"
+
+/*
+ * Escape sequence of each byte within a JSON string (`NULL`: written
+ * as is).
+ *
+ * JSON only requires to escape `"`, `\`, and the control characters
+ * U+0000 to U+001F: all the other bytes, including the ones of UTF-8
+ * multibyte sequences, are written as is.
+ */
+static const char *escapes[256] = {
+	"\\u0000", "\\u0001", "\\u0002", "\\u0003",
+	"\\u0004", "\\u0005", "\\u0006", "\\u0007",
+	"\\b",     "\\t",     "\\n",     "\\u000b",
+	"\\f",     "\\r",     "\\u000e", "\\u000f",
+	"\\u0010", "\\u0011", "\\u0012", "\\u0013",
+	"\\u0014", "\\u0015", "\\u0016", "\\u0017",
+	"\\u0018", "\\u0019", "\\u001a", "\\u001b",
+	"\\u001c", "\\u001d", "\\u001e", "\\u001f",
+	['"'] = "\\\"",
+	['\\'] = "\\\\",
+};
+
+/*
+ * Appends `str` as a JSON string (with the double quotes) to `out`.
+ *
+ * Copies the longest runs of bytes which don't need to be escaped at
+ * once: most strings have no such byte.
+ */
+static inline
+void append_json_string(GString *out, const char *str)
+{
+	const char *run = str;
+	const char *ch;
+
+	g_string_append_c(out, '"');
+
+	for (ch = str; *ch != '\0'; ch++) {
+		const char *escape = escapes[(unsigned char) *ch];
+
+		if (G_LIKELY(!escape)) {
+			continue;
+		}
+
+		g_string_append_len(out, run, ch - run);
+		g_string_append(out, escape);
+		run = ch + 1;
+	}
+
+	g_string_append_len(out, run, ch - run);
+	g_string_append_c(out, '"');
+}
+
+/*
+ * Appends `value` in base 10 to `str`.
+ *
+ * This is much faster than g_string_append_printf() for the numbers
+ * which this component writes for each event.
+ */
+static inline
+void append_uint(GString *str, uint64_t value)
+{
+	/* Enough for the digits of any 64-bit value */
+	char buf[20];
+	char *end = buf + sizeof(buf);
+	char *p = end;
+
+	do {
+		*--p = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	g_string_append_len(str, p, end - p);
+}
+
+static inline
+void append_int(GString *str, int64_t value)
+{
+	if (value < 0) {
+		g_string_append_c(str, '-');
+
+		/* Also valid for `INT64_MIN` */
+		append_uint(str, (uint64_t) 0 - (uint64_t) value);
+	} else {
+		append_uint(str, (uint64_t) value);
+	}
+}
+
+/*
+ * Appends the real number `value` to `str` with the printf() format
+ * `format`, or `null` if JSON can't represent it.
+ */
+static
+void append_real(GString *str, double value, const char *format)
+{
+	char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	if (!isfinite(value)) {
+		g_string_append(str, "null");
+		return;
+	}
+
+	/* Locale-independent, unlike printf() */
+	g_string_append(str, g_ascii_formatd(buf, sizeof(buf), format,
+		value));
+}
+
+static
+void destroy_gstring(GString *str)
+{
+	g_string_free(str, TRUE);
+}
+
+static
+void destroy_keys(GPtrArray *keys)
+{
+	g_ptr_array_free(keys, TRUE);
+}
+
+BT_HIDDEN
+void jsonl_write_init(struct jsonl_comp *jsonl)
+{
+	jsonl->event_class_prefixes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_event_class_put_ref,
+		(GDestroyNotify) destroy_gstring);
+	jsonl->field_class_keys = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, (GDestroyNotify) destroy_keys);
+}
+
+BT_HIDDEN
+void jsonl_write_fini(struct jsonl_comp *jsonl)
+{
+	/* Field class keys first: the event classes own the field classes */
+	if (jsonl->field_class_keys) {
+		g_hash_table_destroy(jsonl->field_class_keys);
+		jsonl->field_class_keys = NULL;
+	}
+
+	if (jsonl->event_class_prefixes) {
+		g_hash_table_destroy(jsonl->event_class_prefixes);
+		jsonl->event_class_prefixes = NULL;
+	}
+}
+
+static
+GString *create_key(const char *name)
+{
+	GString *key = g_string_new(NULL);
+
+	append_json_string(key, name);
+	g_string_append_c(key, ':');
+	return key;
+}
+
+/*
+ * Returns the pre-escaped keys (`"name":`) of the members or options of
+ * the structure or variant field class `fc`, creating them the first
+ * time.
+ */
+static
+GPtrArray *borrow_field_class_keys(struct jsonl_comp *jsonl,
+		const bt_field_class *fc)
+{
+	GPtrArray *keys = g_hash_table_lookup(jsonl->field_class_keys, fc);
+	uint64_t i;
+
+	if (G_LIKELY(keys)) {
+		goto end;
+	}
+
+	keys = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_gstring);
+
+	if (bt_field_class_get_type(fc) == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		for (i = 0; i < bt_field_class_structure_get_member_count(fc);
+				i++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, i);
+
+			g_ptr_array_add(keys, create_key(
+				bt_field_class_structure_member_get_name(member)));
+		}
+	} else {
+		for (i = 0; i < bt_field_class_variant_get_option_count(fc);
+				i++) {
+			const bt_field_class_variant_option *option =
+				bt_field_class_variant_borrow_option_by_index_const(
+					fc, i);
+			const char *name =
+				bt_field_class_variant_option_get_name(option);
+
+			g_ptr_array_add(keys, create_key(name ? name : ""));
+		}
+	}
+
+	g_hash_table_insert(jsonl->field_class_keys, (gpointer) fc, keys);
+
+end:
+	return keys;
+}
+
+/*
+ * Returns the pre-rendered beginning of the objects of the events of
+ * class `ec`, creating it the first time.
+ */
+static
+GString *borrow_event_class_prefix(struct jsonl_comp *jsonl,
+		const bt_event_class *ec)
+{
+	GString *prefix = g_hash_table_lookup(jsonl->event_class_prefixes, ec);
+	const char *name;
+
+	if (G_LIKELY(prefix)) {
+		goto end;
+	}
+
+	prefix = g_string_new("{\"name\":");
+	name = bt_event_class_get_name(ec);
+
+	if (name) {
+		append_json_string(prefix, name);
+	} else {
+		g_string_append(prefix, "null");
+	}
+
+	g_string_append(prefix, ",\"stream_class_id\":");
+	append_uint(prefix, bt_stream_class_get_id(
+		bt_event_class_borrow_stream_class_const(ec)));
+	g_string_append(prefix, ",\"id\":");
+	append_uint(prefix, bt_event_class_get_id(ec));
+	bt_event_class_get_ref(ec);
+	g_hash_table_insert(jsonl->event_class_prefixes, (gpointer) ec,
+		prefix);
+
+end:
+	return prefix;
+}
+
+static
+void append_field(struct jsonl_comp *jsonl, const bt_field *field)
+{
+	const bt_field_class *fc = bt_field_borrow_class_const(field);
+	bt_field_class_type fc_type = bt_field_class_get_type(fc);
+	GString *out = jsonl->str;
+
+	/* Enumeration fields are written as their integer value */
+	if (fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		g_string_append(out,
+			bt_field_bool_get_value(field) ? "true" : "false");
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		append_uint(out, bt_field_bit_array_get_value_as_integer(field));
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		append_int(out, bt_field_integer_signed_get_value(field));
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		append_uint(out, bt_field_integer_unsigned_get_value(field));
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		append_real(out,
+			(double) bt_field_real_single_precision_get_value(field),
+			"%.9g");
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		append_real(out,
+			bt_field_real_double_precision_get_value(field), "%.17g");
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRING) {
+		append_json_string(out, bt_field_string_get_value(field));
+	} else if (fc_type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		GPtrArray *keys = borrow_field_class_keys(jsonl, fc);
+		guint i;
+
+		g_string_append_c(out, '{');
+
+		for (i = 0; i < keys->len; i++) {
+			const GString *key = g_ptr_array_index(keys, i);
+
+			if (i > 0) {
+				g_string_append_c(out, ',');
+			}
+
+			g_string_append_len(out, key->str, key->len);
+			append_field(jsonl,
+				bt_field_structure_borrow_member_field_by_index_const(
+					field, i));
+		}
+
+		g_string_append_c(out, '}');
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_ARRAY)) {
+		uint64_t length = bt_field_array_get_length(field);
+		uint64_t i;
+
+		g_string_append_c(out, '[');
+
+		for (i = 0; i < length; i++) {
+			if (i > 0) {
+				g_string_append_c(out, ',');
+			}
+
+			append_field(jsonl,
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i));
+		}
+
+		g_string_append_c(out, ']');
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_OPTION)) {
+		const bt_field *content = bt_field_option_borrow_field_const(
+			field);
+
+		if (content) {
+			append_field(jsonl, content);
+		} else {
+			g_string_append(out, "null");
+		}
+	} else if (bt_field_class_type_is(fc_type,
+			BT_FIELD_CLASS_TYPE_VARIANT)) {
+		/* Object with a single entry: the selected option */
+		GPtrArray *keys = borrow_field_class_keys(jsonl, fc);
+		const GString *key = g_ptr_array_index(keys,
+			bt_field_variant_get_selected_option_index(field));
+
+		g_string_append_c(out, '{');
+		g_string_append_len(out, key->str, key->len);
+		append_field(jsonl,
+			bt_field_variant_borrow_selected_option_field_const(
+				field));
+		g_string_append_c(out, '}');
+	} else {
+		bt_common_abort();
+	}
+}
+
+static inline
+void append_scope(struct jsonl_comp *jsonl, const char *key,
+		const bt_field *field)
+{
+	if (!field) {
+		return;
+	}
+
+	g_string_append(jsonl->str, key);
+	append_field(jsonl, field);
+}
+
+static
+int write_buffered_lines(struct jsonl_comp *jsonl)
+{
+	int ret = 0;
+
+	if (jsonl->str->len == 0) {
+		goto end;
+	}
+
+	if (fwrite(jsonl->str->str, jsonl->str->len, 1, jsonl->out) != 1) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(jsonl->self_comp,
+			"Cannot write to output file",
+			": path=\"%s\"", jsonl->output_path ? jsonl->output_path :
+				"(standard output)");
+		ret = -1;
+	}
+
+	g_string_truncate(jsonl->str, 0);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int jsonl_write_event(struct jsonl_comp *jsonl, const bt_message *msg)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_stream *stream = bt_event_borrow_stream_const(event);
+	const bt_packet *packet = bt_event_borrow_packet_const(event);
+	const GString *prefix = borrow_event_class_prefix(jsonl,
+		bt_event_borrow_class_const(event));
+	GString *out = jsonl->str;
+	int ret = 0;
+
+	g_string_append_len(out, prefix->str, prefix->len);
+
+	if (bt_stream_class_borrow_default_clock_class_const(
+			bt_stream_borrow_class_const(stream))) {
+		int64_t ns_from_origin;
+
+		g_string_append(out, ",\"timestamp\":");
+
+		if (bt_clock_snapshot_get_ns_from_origin(
+				bt_message_event_borrow_default_clock_snapshot_const(
+					msg),
+				&ns_from_origin) ==
+				BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+			append_int(out, ns_from_origin);
+		} else {
+			g_string_append(out, "null");
+		}
+	}
+
+	g_string_append(out, ",\"stream_id\":");
+	append_uint(out, bt_stream_get_id(stream));
+
+	if (packet) {
+		append_scope(jsonl, ",\"packet_context\":",
+			bt_packet_borrow_context_field_const(packet));
+	}
+
+	append_scope(jsonl, ",\"common_context\":",
+		bt_event_borrow_common_context_field_const(event));
+	append_scope(jsonl, ",\"specific_context\":",
+		bt_event_borrow_specific_context_field_const(event));
+	append_scope(jsonl, ",\"payload\":",
+		bt_event_borrow_payload_field_const(event));
+	g_string_append(out, "}\n");
+
+	if (out->len >= jsonl->output_buffer_size) {
+		ret = write_buffered_lines(jsonl);
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+int jsonl_flush(struct jsonl_comp *jsonl)
+{
+	int ret = write_buffered_lines(jsonl);
+
+	if (ret) {
+		goto end;
+	}
+
+	if (fflush(jsonl->out)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(jsonl->self_comp,
+			"Cannot flush output file",
+			": path=\"%s\"", jsonl->output_path ? jsonl->output_path :
+				"(standard output)");
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_TEXT_JSONL_WRITE_H
+#define BABELTRACE_PLUGINS_TEXT_JSONL_WRITE_H
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+
+#include "jsonl.h"
+
+/*
+ * Creates the class caches of `jsonl`.
+ */
+BT_HIDDEN
+void jsonl_write_init(struct jsonl_comp *jsonl);
+
+/*
+ * Destroys the class caches of `jsonl`.
+ */
+BT_HIDDEN
+void jsonl_write_fini(struct jsonl_comp *jsonl);
+
+/*
+ * Appends the line (JSON object) of the event message `msg` to the
+ * buffered lines of `jsonl`, writing them to its output file if there
+ * are enough of them.
+ */
+BT_HIDDEN
+int jsonl_write_event(struct jsonl_comp *jsonl, const bt_message *msg);
+
+/*
+ * Writes the buffered lines of `jsonl` to its output file and flushes
+ * it.
+ */
+BT_HIDDEN
+int jsonl_flush(struct jsonl_comp *jsonl);
+
+#endif /* BABELTRACE_PLUGINS_TEXT_JSONL_WRITE_H */
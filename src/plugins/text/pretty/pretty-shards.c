@@ -0,0 +1,834 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (shards->pretty->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (shards->pretty->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.TEXT.PRETTY/SHARDS"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "common/assert.h"
+
+#include "pretty.h"
+#include "pretty-shards.h"
+#include "pretty-workers.h"
+
+/* Number of event messages per job */
+#define MAX_EVENTS_PER_JOB	256
+
+/*
+ * Maximum number of queued jobs per writer thread: queueing one more
+ * job blocks the component's thread until a writer thread is done with
+ * a job.
+ */
+#define MAX_QUEUED_JOBS_PER_THREAD	2
+
+struct pretty_shard_writer;
+
+struct pretty_shard {
+	/* Output file path (owned by this) and stream */
+	gchar *path;
+	FILE *out;
+
+	/* Formatted events which are not written yet (owned by this) */
+	GString *buf;
+
+	/*
+	 * Time delta state (see `struct pretty_component`) of the
+	 * events of this shard
+	 */
+	uint64_t last_cycles_timestamp;
+	uint64_t delta_cycles;
+	uint64_t last_real_timestamp;
+	uint64_t delta_real_timestamp;
+
+	/*
+	 * Writer thread which formats and writes the events of this
+	 * shard (weak), or `NULL` to format and write them on the
+	 * component's thread
+	 */
+	struct pretty_shard_writer *writer;
+};
+
+/* State of an event message computed by pretty_prepare_event() */
+struct event_state {
+	/* Weak */
+	struct pretty_shard *shard;
+
+	uint64_t delta_cycles;
+	uint64_t delta_real_timestamp;
+	bool fallback_to_seconds;
+};
+
+struct pretty_shards_job {
+	/*
+	 * Array of `const bt_message *` (event messages, owned by this,
+	 * put by the component's thread)
+	 */
+	GPtrArray *msgs;
+
+	/* Array of `struct event_state`, one per message of `msgs` */
+	GArray *states;
+
+	/* Result of formatting and writing the events */
+	int ret;
+};
+
+struct pretty_shard_writer {
+	/* Weak */
+	struct pretty_shards *shards;
+
+	/* Formatting context of this writer thread (owned by this) */
+	struct pretty_component *ctx;
+
+	/*
+	 * Queue of `struct pretty_shards_job *` to format and write
+	 * (owned by the queue until this writer thread pushes them to
+	 * `shards->done_jobs`)
+	 */
+	GAsyncQueue *todo_jobs;
+
+	/* Job being filled (owned by this) */
+	struct pretty_shards_job *cur_job;
+
+	GThread *thread;
+};
+
+struct pretty_shards {
+	/* Weak */
+	struct pretty_component *pretty;
+
+	/*
+	 * `const bt_trace *` or `const bt_stream *` (owned key,
+	 * depending on the `shard-by` parameter) to
+	 * `struct pretty_shard *` (owned by this)
+	 */
+	GHashTable *shards;
+
+	/*
+	 * `const bt_trace *` (owned key) to its index + 1
+	 * (`GUINT_TO_POINTER()`), which the shard file names contain
+	 */
+	GHashTable *trace_indexes;
+
+	/* Last looked up key (weak) and its shard (weak) */
+	const void *last_key;
+	struct pretty_shard *last_shard;
+
+	/* Array of `struct pretty_shard_writer *` (owned by this) */
+	GPtrArray *writers;
+
+	/* Index, within `writers`, of the writer of the next shard */
+	guint next_writer_index;
+
+	/*
+	 * Queue of `struct pretty_shards_job *` (owned by the queue)
+	 * which the writer threads are done with
+	 */
+	GAsyncQueue *done_jobs;
+
+	/* Number of queued jobs which are not in `done_jobs` yet */
+	guint queued_job_count;
+
+	guint max_queued_job_count;
+};
+
+/* Makes a writer thread exit */
+static struct pretty_shards_job stop_job;
+
+static
+void destroy_job(struct pretty_shards_job *job)
+{
+	if (!job) {
+		return;
+	}
+
+	if (job->msgs) {
+		guint i;
+
+		for (i = 0; i < job->msgs->len; i++) {
+			bt_message_put_ref(g_ptr_array_index(job->msgs, i));
+		}
+
+		g_ptr_array_free(job->msgs, TRUE);
+	}
+
+	if (job->states) {
+		g_array_free(job->states, TRUE);
+	}
+
+	g_free(job);
+}
+
+static
+struct pretty_shards_job *create_job(void)
+{
+	struct pretty_shards_job *job = g_new0(struct pretty_shards_job, 1);
+
+	if (!job) {
+		goto end;
+	}
+
+	job->msgs = g_ptr_array_sized_new(MAX_EVENTS_PER_JOB);
+	job->states = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct event_state), MAX_EVENTS_PER_JOB);
+	if (!job->msgs || !job->states) {
+		destroy_job(job);
+		job = NULL;
+	}
+
+end:
+	return job;
+}
+
+static
+gpointer writer_thread_func(gpointer data)
+{
+	struct pretty_shard_writer *writer = data;
+	struct pretty_shards *shards = writer->shards;
+	struct pretty_component *ctx = writer->ctx;
+
+	while (true) {
+		struct pretty_shards_job *job =
+			g_async_queue_pop(writer->todo_jobs);
+		guint i;
+		int ret = 0;
+
+		if (job == &stop_job) {
+			break;
+		}
+
+		for (i = 0; i < job->msgs->len; i++) {
+			const struct event_state *state =
+				&g_array_index(job->states, struct event_state, i);
+
+			ctx->string = state->shard->buf;
+			ctx->out = state->shard->out;
+			ctx->delta_cycles = state->delta_cycles;
+			ctx->delta_real_timestamp = state->delta_real_timestamp;
+			ctx->fallback_to_seconds = state->fallback_to_seconds;
+			ret = pretty_format_event(ctx,
+				g_ptr_array_index(job->msgs, i));
+			if (G_UNLIKELY(ret)) {
+				break;
+			}
+
+			ret = pretty_flush_if_full(ctx);
+			if (G_UNLIKELY(ret)) {
+				break;
+			}
+		}
+
+		ctx->string = NULL;
+		ctx->out = NULL;
+		job->ret = ret;
+		g_async_queue_push(shards->done_jobs, job);
+	}
+
+	return NULL;
+}
+
+static
+void destroy_writer(struct pretty_shard_writer *writer)
+{
+	if (!writer) {
+		return;
+	}
+
+	/* pretty_shards_destroy() joined the thread */
+	BT_ASSERT(!writer->thread);
+	destroy_job(writer->cur_job);
+
+	if (writer->todo_jobs) {
+		g_async_queue_unref(writer->todo_jobs);
+	}
+
+	pretty_destroy_format_ctx(writer->ctx);
+	g_free(writer);
+}
+
+static
+void destroy_shard(struct pretty_shard *shard)
+{
+	if (!shard) {
+		return;
+	}
+
+	if (shard->out && fclose(shard->out)) {
+		perror("close output file");
+	}
+
+	if (shard->buf) {
+		g_string_free(shard->buf, TRUE);
+	}
+
+	g_free(shard->path);
+	g_free(shard);
+}
+
+static
+void put_trace_key(gpointer data)
+{
+	bt_trace_put_ref(data);
+}
+
+static
+void put_stream_key(gpointer data)
+{
+	bt_stream_put_ref(data);
+}
+
+BT_HIDDEN
+struct pretty_shards *pretty_shards_create(struct pretty_component *pretty,
+		guint thread_count)
+{
+	struct pretty_shards *shards = g_new0(struct pretty_shards, 1);
+	guint i;
+
+	BT_ASSERT(pretty->options.shard_by != PRETTY_SHARD_BY_NONE);
+	BT_ASSERT(pretty->options.output_path);
+
+	if (!shards) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, pretty->log_level,
+			pretty->self_comp,
+			"Failed to allocate one shards structure.");
+		goto error;
+	}
+
+	shards->pretty = pretty;
+
+	if (g_mkdir_with_parents(pretty->options.output_path, 0755)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(pretty->self_comp,
+			"Cannot create output directory", ": path=\"%s\"",
+			pretty->options.output_path);
+		goto error;
+	}
+
+	shards->shards = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		pretty->options.shard_by == PRETTY_SHARD_BY_STREAM ?
+			put_stream_key : put_trace_key,
+		(GDestroyNotify) destroy_shard);
+	if (!shards->shards) {
+		BT_COMP_LOGE_STR("Failed to allocate one GHashTable.");
+		goto error;
+	}
+
+	shards->trace_indexes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, put_trace_key, NULL);
+	if (!shards->trace_indexes) {
+		BT_COMP_LOGE_STR("Failed to allocate one GHashTable.");
+		goto error;
+	}
+
+	shards->done_jobs = g_async_queue_new();
+	if (!shards->done_jobs) {
+		BT_COMP_LOGE_STR("Failed to allocate one GAsyncQueue.");
+		goto error;
+	}
+
+	shards->writers = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_writer);
+	if (!shards->writers) {
+		BT_COMP_LOGE_STR("Failed to allocate one GPtrArray.");
+		goto error;
+	}
+
+	shards->max_queued_job_count = thread_count * MAX_QUEUED_JOBS_PER_THREAD;
+
+	for (i = 0; i < thread_count; i++) {
+		GError *error = NULL;
+		struct pretty_shard_writer *writer =
+			g_new0(struct pretty_shard_writer, 1);
+
+		if (!writer) {
+			BT_COMP_LOGE_STR("Failed to allocate one shard writer.");
+			goto error;
+		}
+
+		writer->shards = shards;
+		g_ptr_array_add(shards->writers, writer);
+		writer->ctx = pretty_create_format_ctx(pretty);
+		if (!writer->ctx) {
+			BT_COMP_LOGE_STR("Failed to allocate one formatting context.");
+			goto error;
+		}
+
+		writer->todo_jobs = g_async_queue_new();
+		if (!writer->todo_jobs) {
+			BT_COMP_LOGE_STR("Failed to allocate one GAsyncQueue.");
+			goto error;
+		}
+
+		writer->thread = g_thread_try_new("sink.text.pretty writer",
+			writer_thread_func, writer, &error);
+		if (!writer->thread) {
+			BT_COMP_LOGE("Failed to create shard writer thread: "
+				"index=%u, error=\"%s\"", i, error->message);
+			g_error_free(error);
+			goto error;
+		}
+	}
+
+	BT_COMP_LOGI("Created shards: output-dir-path=\"%s\", "
+		"writer-thread-count=%u", pretty->options.output_path,
+		thread_count);
+	goto end;
+
+error:
+	pretty_shards_destroy(shards);
+	shards = NULL;
+
+end:
+	return shards;
+}
+
+BT_HIDDEN
+void pretty_shards_destroy(struct pretty_shards *shards)
+{
+	struct pretty_shards_job *job;
+
+	if (!shards) {
+		goto end;
+	}
+
+	if (shards->writers) {
+		guint i;
+
+		/* The writer threads first finish their queued jobs */
+		for (i = 0; i < shards->writers->len; i++) {
+			struct pretty_shard_writer *writer =
+				g_ptr_array_index(shards->writers, i);
+
+			if (writer->thread) {
+				g_async_queue_push(writer->todo_jobs,
+					&stop_job);
+			}
+		}
+
+		for (i = 0; i < shards->writers->len; i++) {
+			struct pretty_shard_writer *writer =
+				g_ptr_array_index(shards->writers, i);
+
+			if (writer->thread) {
+				g_thread_join(writer->thread);
+				writer->thread = NULL;
+			}
+		}
+
+		g_ptr_array_free(shards->writers, TRUE);
+		shards->writers = NULL;
+	}
+
+	if (shards->done_jobs) {
+		while ((job = g_async_queue_try_pop(shards->done_jobs))) {
+			destroy_job(job);
+		}
+
+		g_async_queue_unref(shards->done_jobs);
+		shards->done_jobs = NULL;
+	}
+
+	if (shards->shards) {
+		g_hash_table_destroy(shards->shards);
+		shards->shards = NULL;
+	}
+
+	if (shards->trace_indexes) {
+		g_hash_table_destroy(shards->trace_indexes);
+		shards->trace_indexes = NULL;
+	}
+
+	g_free(shards);
+
+end:
+	return;
+}
+
+/*
+ * Appends `str` to `name`, replacing the characters which don't belong
+ * in a portable file name with `_`.
+ */
+static
+void append_sanitized_name(GString *name, const char *str)
+{
+	for (; *str != '\0'; str++) {
+		if (g_ascii_isalnum(*str) || *str == '-' || *str == '_' ||
+				*str == '.') {
+			g_string_append_c(name, *str);
+		} else {
+			g_string_append_c(name, '_');
+		}
+	}
+}
+
+/*
+ * Returns the index of `trace` (in order of appearance), which the
+ * names of its shard files contain.
+ */
+static
+guint get_trace_index(struct pretty_shards *shards, const bt_trace *trace)
+{
+	gpointer index = g_hash_table_lookup(shards->trace_indexes, trace);
+
+	if (!index) {
+		index = GUINT_TO_POINTER(
+			g_hash_table_size(shards->trace_indexes) + 1);
+		bt_trace_get_ref(trace);
+		g_hash_table_insert(shards->trace_indexes, (gpointer) trace,
+			index);
+	}
+
+	return GPOINTER_TO_UINT(index) - 1;
+}
+
+/*
+ * Creates the shard of `stream` (`shard-by=stream`) or of `trace`
+ * (`shard-by=trace`), opening its output file:
+ *
+ * `trace-TRACE-INDEX.txt`:
+ *     Shard of a trace.
+ *
+ * `trace-TRACE-INDEX-stream-STREAM-CLASS-ID-STREAM-ID[-NAME].txt`:
+ *     Shard of a stream, `NAME` being the stream's name, if any.
+ */
+static
+struct pretty_shard *create_shard(struct pretty_shards *shards,
+		const bt_trace *trace, const bt_stream *stream)
+{
+	struct pretty_component *pretty = shards->pretty;
+	struct pretty_shard *shard = g_new0(struct pretty_shard, 1);
+	GString *name = NULL;
+
+	if (!shard) {
+		BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+			"Failed to allocate one shard.");
+		goto error;
+	}
+
+	name = g_string_new(NULL);
+	shard->buf = g_string_new(NULL);
+	if (!name || !shard->buf) {
+		BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+			"Failed to allocate one GString.");
+		goto error;
+	}
+
+	g_string_printf(name, "trace-%u", get_trace_index(shards, trace));
+
+	if (stream) {
+		const char *stream_name = bt_stream_get_name(stream);
+
+		g_string_append_printf(name, "-stream-%" PRIu64 "-%" PRIu64,
+			bt_stream_class_get_id(bt_stream_borrow_class_const(stream)),
+			bt_stream_get_id(stream));
+
+		if (stream_name) {
+			g_string_append_c(name, '-');
+			append_sanitized_name(name, stream_name);
+		}
+	}
+
+	g_string_append(name, ".txt");
+	shard->path = g_build_filename(pretty->options.output_path, name->str,
+		NULL);
+	shard->out = g_fopen(shard->path, "w");
+	if (!shard->out) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(pretty->self_comp,
+			"Cannot open shard file", ": path=\"%s\"",
+			shard->path);
+		goto error;
+	}
+
+	shard->last_cycles_timestamp = -1ULL;
+	shard->delta_cycles = -1ULL;
+	shard->last_real_timestamp = -1ULL;
+	shard->delta_real_timestamp = -1ULL;
+
+	if (shards->writers->len > 0) {
+		shard->writer = g_ptr_array_index(shards->writers,
+			shards->next_writer_index);
+		shards->next_writer_index = (shards->next_writer_index + 1) %
+			shards->writers->len;
+	}
+
+	BT_COMP_LOGI("Created shard: path=\"%s\"", shard->path);
+	goto end;
+
+error:
+	destroy_shard(shard);
+	shard = NULL;
+
+end:
+	if (name) {
+		g_string_free(name, TRUE);
+	}
+
+	return shard;
+}
+
+static inline
+struct pretty_shard *borrow_shard(struct pretty_shards *shards,
+		const bt_message *msg)
+{
+	const bt_stream *stream = bt_event_borrow_stream_const(
+		bt_message_event_borrow_event_const(msg));
+	const bt_trace *trace = bt_stream_borrow_trace_const(stream);
+	const void *key;
+	struct pretty_shard *shard;
+
+	if (shards->pretty->options.shard_by == PRETTY_SHARD_BY_STREAM) {
+		key = stream;
+	} else {
+		key = trace;
+		stream = NULL;
+	}
+
+	if (G_LIKELY(key == shards->last_key)) {
+		shard = shards->last_shard;
+		goto end;
+	}
+
+	shard = g_hash_table_lookup(shards->shards, key);
+	if (!shard) {
+		shard = create_shard(shards, trace, stream);
+		if (!shard) {
+			goto end;
+		}
+
+		if (stream) {
+			bt_stream_get_ref(stream);
+		} else {
+			bt_trace_get_ref(trace);
+		}
+
+		g_hash_table_insert(shards->shards, (gpointer) key, shard);
+	}
+
+	shards->last_key = key;
+	shards->last_shard = shard;
+
+end:
+	return shard;
+}
+
+/*
+ * Calls `func` with the component's context writing to the buffer
+ * and file of `shard`.
+ */
+static
+int with_shard_output(struct pretty_shards *shards,
+		struct pretty_shard *shard,
+		int (*func)(struct pretty_component *, const bt_message *),
+		const bt_message *msg)
+{
+	struct pretty_component *pretty = shards->pretty;
+	GString *string = pretty->string;
+	FILE *out = pretty->out;
+	int ret;
+
+	pretty->string = shard->buf;
+	pretty->out = shard->out;
+	ret = func(pretty, msg);
+	pretty->string = string;
+	pretty->out = out;
+	return ret;
+}
+
+static
+int format_and_write_event(struct pretty_component *pretty,
+		const bt_message *msg)
+{
+	int ret;
+
+	ret = pretty_format_event(pretty, msg);
+	if (ret) {
+		goto end;
+	}
+
+	ret = pretty_flush_if_full(pretty);
+
+end:
+	return ret;
+}
+
+static
+int flush(struct pretty_component *pretty,
+		__attribute__((unused)) const bt_message *msg)
+{
+	return pretty_flush(pretty);
+}
+
+static
+void queue_cur_job(struct pretty_shards *shards,
+		struct pretty_shard_writer *writer)
+{
+	struct pretty_shards_job *job = writer->cur_job;
+
+	BT_ASSERT_DBG(job);
+	BT_ASSERT_DBG(job->msgs->len > 0);
+	g_async_queue_push(writer->todo_jobs, job);
+	shards->queued_job_count++;
+	writer->cur_job = NULL;
+}
+
+/*
+ * Destroys the jobs which the writer threads are done with.
+ *
+ * If `wait_all` is true, waits until the writer threads are done with
+ * all the queued jobs. Otherwise, only waits while there are more
+ * queued jobs than `shards->max_queued_job_count`.
+ */
+static
+int put_done_jobs(struct pretty_shards *shards, bool wait_all)
+{
+	struct pretty_component *pretty = shards->pretty;
+	int ret = 0;
+
+	while (shards->queued_job_count > 0) {
+		struct pretty_shards_job *job;
+
+		if (wait_all ||
+				shards->queued_job_count >
+				shards->max_queued_job_count) {
+			job = g_async_queue_pop(shards->done_jobs);
+		} else {
+			job = g_async_queue_try_pop(shards->done_jobs);
+			if (!job) {
+				break;
+			}
+		}
+
+		shards->queued_job_count--;
+
+		if (G_UNLIKELY(job->ret)) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to format or write one event.");
+			ret = -1;
+		}
+
+		destroy_job(job);
+
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_shards_push_event(struct pretty_shards *shards,
+		const bt_message *msg)
+{
+	struct pretty_component *pretty = shards->pretty;
+	struct pretty_shard *shard;
+	struct pretty_shard_writer *writer;
+	struct event_state state;
+	int ret;
+
+	shard = borrow_shard(shards, msg);
+	if (!shard) {
+		ret = -1;
+		goto end;
+	}
+
+	/* Time deltas are between the events of the same shard */
+	pretty->last_cycles_timestamp = shard->last_cycles_timestamp;
+	pretty->delta_cycles = shard->delta_cycles;
+	pretty->last_real_timestamp = shard->last_real_timestamp;
+	pretty->delta_real_timestamp = shard->delta_real_timestamp;
+	ret = pretty_prepare_event(pretty, msg);
+	shard->last_cycles_timestamp = pretty->last_cycles_timestamp;
+	shard->delta_cycles = pretty->delta_cycles;
+	shard->last_real_timestamp = pretty->last_real_timestamp;
+	shard->delta_real_timestamp = pretty->delta_real_timestamp;
+	if (ret) {
+		goto end;
+	}
+
+	writer = shard->writer;
+	if (!writer) {
+		ret = with_shard_output(shards, shard,
+			format_and_write_event, msg);
+		goto end;
+	}
+
+	if (!writer->cur_job) {
+		writer->cur_job = create_job();
+		if (!writer->cur_job) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to allocate one shard job.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	state.shard = shard;
+	state.delta_cycles = pretty->delta_cycles;
+	state.delta_real_timestamp = pretty->delta_real_timestamp;
+	state.fallback_to_seconds = pretty->fallback_to_seconds;
+	g_array_append_val(writer->cur_job->states, state);
+	bt_message_get_ref(msg);
+	g_ptr_array_add(writer->cur_job->msgs, (gpointer) msg);
+
+	if (writer->cur_job->msgs->len >= MAX_EVENTS_PER_JOB) {
+		queue_cur_job(shards, writer);
+	}
+
+	ret = put_done_jobs(shards, false);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_shards_flush(struct pretty_shards *shards)
+{
+	struct pretty_component *pretty = shards->pretty;
+	GHashTableIter iter;
+	gpointer key, shard;
+	guint i;
+	int ret;
+
+	for (i = 0; i < shards->writers->len; i++) {
+		struct pretty_shard_writer *writer =
+			g_ptr_array_index(shards->writers, i);
+
+		if (writer->cur_job && writer->cur_job->msgs->len > 0) {
+			queue_cur_job(shards, writer);
+		}
+	}
+
+	ret = put_done_jobs(shards, true);
+	if (ret) {
+		goto end;
+	}
+
+	/* The writer threads are idle now */
+	g_hash_table_iter_init(&iter, shards->shards);
+
+	while (g_hash_table_iter_next(&iter, &key, &shard)) {
+		ret = with_shard_output(shards, shard, flush, NULL);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to write to shard file: path=\"%s\"",
+				((struct pretty_shard *) shard)->path);
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_SHARDS_H
+#define BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_SHARDS_H
+
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+
+#include "pretty.h"
+
+/*
+ * Sharded output of a `sink.text.pretty` component (`shard-by`
+ * parameter).
+ *
+ * The component writes the events of each trace or stream to its own
+ * file, a shard, within the output directory, with its own output
+ * buffer and its own time deltas. The events of a shard are in message
+ * order, but there's no global order between the shards.
+ *
+ * Without writer threads, the component's thread formats and writes
+ * the events. Otherwise, each shard belongs to one writer thread which
+ * formats its events and writes them, with its own formatting context:
+ * the component's thread only groups the events of each writer thread
+ * into jobs.
+ *
+ * Like with the formatting worker threads (see pretty-workers.h), the
+ * component's thread prepares each event (see pretty_prepare_event())
+ * and keeps a reference on each queued message, putting it once its
+ * writer thread is done with the job.
+ *
+ * The number of queued jobs is bounded: queueing an event can block
+ * until a writer thread is done with a job.
+ */
+
+/*
+ * Creates the shards of the component `pretty`, once its options are
+ * set, with `thread_count` writer threads (none if 0).
+ *
+ * Creates the output directory if needed.
+ */
+BT_HIDDEN
+struct pretty_shards *pretty_shards_create(struct pretty_component *pretty,
+		guint thread_count);
+
+/*
+ * Joins the writer threads of `shards`, drops the events of the jobs
+ * which are not written yet, closes the shard files, and destroys
+ * `shards`.
+ */
+BT_HIDDEN
+void pretty_shards_destroy(struct pretty_shards *shards);
+
+/*
+ * Formats and writes the event message `msg` to its shard, possibly
+ * queueing it, taking a reference on it, for a writer thread.
+ */
+BT_HIDDEN
+int pretty_shards_push_event(struct pretty_shards *shards,
+		const bt_message *msg);
+
+/*
+ * Waits until the writer threads are done with all the queued events,
+ * and then writes the buffered output of each shard and flushes its
+ * file.
+ */
+BT_HIDDEN
+int pretty_shards_flush(struct pretty_shards *shards);
+
+#endif /* BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_SHARDS_H */
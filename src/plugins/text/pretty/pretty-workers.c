@@ -0,0 +1,491 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (workers->pretty->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (workers->pretty->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.TEXT.PRETTY/WORKERS"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+#include "common/assert.h"
+
+#include "pretty.h"
+#include "pretty-workers.h"
+
+/* Number of event messages per job */
+#define MAX_EVENTS_PER_JOB	256
+
+/*
+ * Maximum number of queued jobs per worker thread: queueing one more
+ * job blocks the component's thread until the oldest one is formatted.
+ */
+#define MAX_QUEUED_JOBS_PER_THREAD	2
+
+/* State of an event message computed by pretty_prepare_event() */
+struct event_state {
+	uint64_t delta_cycles;
+	uint64_t delta_real_timestamp;
+	bool fallback_to_seconds;
+};
+
+struct pretty_workers_job {
+	/*
+	 * Array of `const bt_message *` (event messages, owned by this,
+	 * put by the component's thread)
+	 */
+	GPtrArray *msgs;
+
+	/* Array of `struct event_state`, one per message of `msgs` */
+	GArray *states;
+
+	/* Text of the formatted events (owned by this) */
+	GString *output;
+
+	/* Protected by `workers->lock` */
+	bool done;
+
+	/* Result of pretty_format_event() */
+	int ret;
+};
+
+struct pretty_worker {
+	/* Weak */
+	struct pretty_workers *workers;
+
+	/* Formatting context of this worker thread (owned by this) */
+	struct pretty_component *ctx;
+
+	GThread *thread;
+};
+
+struct pretty_workers {
+	/* Weak */
+	struct pretty_component *pretty;
+
+	/* Array of `struct pretty_worker *` (owned by this) */
+	GPtrArray *workers;
+
+	/*
+	 * Queue of `struct pretty_workers_job *` (weak: `pending_jobs`
+	 * owns them) to format
+	 */
+	GAsyncQueue *todo_jobs;
+
+	/*
+	 * Queue of `struct pretty_workers_job *` (owned by this), in
+	 * message order, which the component's thread didn't write yet
+	 */
+	GQueue pending_jobs;
+
+	/* Job being filled (owned by this) */
+	struct pretty_workers_job *cur_job;
+
+	guint max_pending_jobs;
+
+	/* Protects the `done` and `ret` members of the jobs */
+	GMutex lock;
+
+	/* Signaled when a job is done */
+	GCond cond;
+};
+
+/* Makes a worker thread exit */
+static struct pretty_workers_job stop_job;
+
+static
+void destroy_job(struct pretty_workers_job *job)
+{
+	if (!job) {
+		return;
+	}
+
+	if (job->msgs) {
+		guint i;
+
+		for (i = 0; i < job->msgs->len; i++) {
+			bt_message_put_ref(g_ptr_array_index(job->msgs, i));
+		}
+
+		g_ptr_array_free(job->msgs, TRUE);
+	}
+
+	if (job->states) {
+		g_array_free(job->states, TRUE);
+	}
+
+	if (job->output) {
+		g_string_free(job->output, TRUE);
+	}
+
+	g_free(job);
+}
+
+static
+struct pretty_workers_job *create_job(void)
+{
+	struct pretty_workers_job *job = g_new0(struct pretty_workers_job, 1);
+
+	if (!job) {
+		goto end;
+	}
+
+	job->msgs = g_ptr_array_sized_new(MAX_EVENTS_PER_JOB);
+	job->states = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct event_state), MAX_EVENTS_PER_JOB);
+	job->output = g_string_new(NULL);
+	if (!job->msgs || !job->states || !job->output) {
+		destroy_job(job);
+		job = NULL;
+	}
+
+end:
+	return job;
+}
+
+static
+gpointer worker_thread_func(gpointer data)
+{
+	struct pretty_worker *worker = data;
+	struct pretty_workers *workers = worker->workers;
+	struct pretty_component *ctx = worker->ctx;
+
+	while (true) {
+		struct pretty_workers_job *job =
+			g_async_queue_pop(workers->todo_jobs);
+		guint i;
+		int ret = 0;
+
+		if (job == &stop_job) {
+			break;
+		}
+
+		ctx->string = job->output;
+
+		for (i = 0; i < job->msgs->len; i++) {
+			const struct event_state *state =
+				&g_array_index(job->states, struct event_state, i);
+
+			ctx->delta_cycles = state->delta_cycles;
+			ctx->delta_real_timestamp = state->delta_real_timestamp;
+			ctx->fallback_to_seconds = state->fallback_to_seconds;
+			ret = pretty_format_event(ctx,
+				g_ptr_array_index(job->msgs, i));
+			if (G_UNLIKELY(ret)) {
+				break;
+			}
+		}
+
+		ctx->string = NULL;
+		g_mutex_lock(&workers->lock);
+		job->ret = ret;
+		job->done = true;
+		g_cond_broadcast(&workers->cond);
+		g_mutex_unlock(&workers->lock);
+	}
+
+	return NULL;
+}
+
+static
+void destroy_worker(struct pretty_worker *worker)
+{
+	if (!worker) {
+		return;
+	}
+
+	/* pretty_workers_destroy() joined the thread */
+	BT_ASSERT(!worker->thread);
+
+	pretty_destroy_format_ctx(worker->ctx);
+	g_free(worker);
+}
+
+BT_HIDDEN
+struct pretty_component *pretty_create_format_ctx(
+		struct pretty_component *pretty)
+{
+	struct pretty_component *ctx = g_new0(struct pretty_component, 1);
+
+	if (!ctx) {
+		goto end;
+	}
+
+	ctx->options = pretty->options;
+
+	/* Owned by `pretty` */
+	ctx->options.output_path = NULL;
+
+	ctx->err = pretty->err;
+	ctx->use_colors = pretty->use_colors;
+	ctx->is_format_worker = true;
+	ctx->log_level = pretty->log_level;
+	ctx->self_comp = pretty->self_comp;
+	pretty_print_init_templates(ctx);
+
+end:
+	return ctx;
+}
+
+BT_HIDDEN
+void pretty_destroy_format_ctx(struct pretty_component *ctx)
+{
+	if (!ctx) {
+		return;
+	}
+
+	pretty_print_fini_templates(ctx);
+	g_free(ctx);
+}
+
+BT_HIDDEN
+struct pretty_workers *pretty_workers_create(struct pretty_component *pretty,
+		guint thread_count)
+{
+	struct pretty_workers *workers = g_new0(struct pretty_workers, 1);
+	guint i;
+
+	BT_ASSERT(thread_count > 0);
+
+	if (!workers) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, pretty->log_level,
+			pretty->self_comp,
+			"Failed to allocate one formatting worker threads structure.");
+		goto error;
+	}
+
+	workers->pretty = pretty;
+	workers->max_pending_jobs = thread_count * MAX_QUEUED_JOBS_PER_THREAD;
+	g_mutex_init(&workers->lock);
+	g_cond_init(&workers->cond);
+	g_queue_init(&workers->pending_jobs);
+	workers->todo_jobs = g_async_queue_new();
+	if (!workers->todo_jobs) {
+		BT_COMP_LOGE_STR("Failed to allocate one GAsyncQueue.");
+		goto error;
+	}
+
+	workers->workers = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_worker);
+	if (!workers->workers) {
+		BT_COMP_LOGE_STR("Failed to allocate one GPtrArray.");
+		goto error;
+	}
+
+	for (i = 0; i < thread_count; i++) {
+		GError *error = NULL;
+		struct pretty_worker *worker = g_new0(struct pretty_worker, 1);
+
+		if (!worker) {
+			BT_COMP_LOGE_STR("Failed to allocate one formatting worker.");
+			goto error;
+		}
+
+		worker->workers = workers;
+		g_ptr_array_add(workers->workers, worker);
+		worker->ctx = pretty_create_format_ctx(pretty);
+		if (!worker->ctx) {
+			BT_COMP_LOGE_STR("Failed to allocate one formatting context.");
+			goto error;
+		}
+
+		worker->thread = g_thread_try_new("sink.text.pretty formatter",
+			worker_thread_func, worker, &error);
+		if (!worker->thread) {
+			BT_COMP_LOGE("Failed to create formatting worker thread: "
+				"index=%u, error=\"%s\"", i, error->message);
+			g_error_free(error);
+			goto error;
+		}
+	}
+
+	BT_COMP_LOGI("Created formatting worker threads: count=%u",
+		thread_count);
+	goto end;
+
+error:
+	pretty_workers_destroy(workers);
+	workers = NULL;
+
+end:
+	return workers;
+}
+
+BT_HIDDEN
+void pretty_workers_destroy(struct pretty_workers *workers)
+{
+	struct pretty_workers_job *job;
+
+	if (!workers) {
+		goto end;
+	}
+
+	if (workers->workers) {
+		guint i;
+
+		for (i = 0; i < workers->workers->len; i++) {
+			struct pretty_worker *worker =
+				g_ptr_array_index(workers->workers, i);
+
+			if (worker->thread) {
+				g_async_queue_push(workers->todo_jobs,
+					&stop_job);
+			}
+		}
+
+		for (i = 0; i < workers->workers->len; i++) {
+			struct pretty_worker *worker =
+				g_ptr_array_index(workers->workers, i);
+
+			if (worker->thread) {
+				g_thread_join(worker->thread);
+				worker->thread = NULL;
+			}
+		}
+
+		g_ptr_array_free(workers->workers, TRUE);
+		workers->workers = NULL;
+	}
+
+	while ((job = g_queue_pop_head(&workers->pending_jobs))) {
+		destroy_job(job);
+	}
+
+	destroy_job(workers->cur_job);
+	workers->cur_job = NULL;
+
+	if (workers->todo_jobs) {
+		g_async_queue_unref(workers->todo_jobs);
+		workers->todo_jobs = NULL;
+	}
+
+	g_cond_clear(&workers->cond);
+	g_mutex_clear(&workers->lock);
+	g_free(workers);
+
+end:
+	return;
+}
+
+static
+void queue_cur_job(struct pretty_workers *workers)
+{
+	struct pretty_workers_job *job = workers->cur_job;
+
+	BT_ASSERT_DBG(job);
+	BT_ASSERT_DBG(job->msgs->len > 0);
+	g_queue_push_tail(&workers->pending_jobs, job);
+	g_async_queue_push(workers->todo_jobs, job);
+	workers->cur_job = NULL;
+}
+
+/*
+ * Appends the text of the formatted pending jobs, in order, to the
+ * output buffer of the component.
+ *
+ * If `wait_all` is true, waits until all the pending jobs are
+ * formatted. Otherwise, only waits while there are more pending jobs
+ * than `workers->max_pending_jobs`.
+ */
+static
+int write_pending_jobs(struct pretty_workers *workers, bool wait_all)
+{
+	struct pretty_component *pretty = workers->pretty;
+	struct pretty_workers_job *job;
+	int ret = 0;
+
+	while ((job = g_queue_peek_head(&workers->pending_jobs))) {
+		bool must_wait = wait_all ||
+			workers->pending_jobs.length > workers->max_pending_jobs;
+		bool done;
+
+		g_mutex_lock(&workers->lock);
+
+		while (must_wait && !job->done) {
+			g_cond_wait(&workers->cond, &workers->lock);
+		}
+
+		done = job->done;
+		g_mutex_unlock(&workers->lock);
+
+		if (!done) {
+			break;
+		}
+
+		(void) g_queue_pop_head(&workers->pending_jobs);
+
+		if (G_UNLIKELY(job->ret)) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to format one event.");
+			destroy_job(job);
+			ret = -1;
+			goto end;
+		}
+
+		g_string_append_len(pretty->string, job->output->str,
+			job->output->len);
+		destroy_job(job);
+		ret = pretty_flush_if_full(pretty);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_workers_push_event(struct pretty_workers *workers,
+		const bt_message *msg)
+{
+	struct pretty_component *pretty = workers->pretty;
+	struct event_state state;
+	int ret;
+
+	if (!workers->cur_job) {
+		workers->cur_job = create_job();
+		if (!workers->cur_job) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to allocate one formatting job.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	ret = pretty_prepare_event(pretty, msg);
+	if (ret) {
+		goto end;
+	}
+
+	state.delta_cycles = pretty->delta_cycles;
+	state.delta_real_timestamp = pretty->delta_real_timestamp;
+	state.fallback_to_seconds = pretty->fallback_to_seconds;
+	g_array_append_val(workers->cur_job->states, state);
+	bt_message_get_ref(msg);
+	g_ptr_array_add(workers->cur_job->msgs, (gpointer) msg);
+
+	if (workers->cur_job->msgs->len >= MAX_EVENTS_PER_JOB) {
+		queue_cur_job(workers);
+	}
+
+	ret = write_pending_jobs(workers, false);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_workers_drain(struct pretty_workers *workers)
+{
+	if (workers->cur_job && workers->cur_job->msgs->len > 0) {
+		queue_cur_job(workers);
+	}
+
+	return write_pending_jobs(workers, true);
+}
@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_WORKERS_H
+#define BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_WORKERS_H
+
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+
+#include "pretty.h"
+
+/*
+ * Formatting worker threads of a `sink.text.pretty` component.
+ *
+ * The component's thread groups consecutive event messages into jobs.
+ * A worker thread formats all the events of a job into the job's own
+ * buffer, with its own formatting context (a copy of the component's
+ * options), and the component's thread then appends the job buffers to
+ * the output buffer in job order, so that the output is identical to
+ * formatting the events on the component's thread.
+ *
+ * What depends on the previous events (time deltas, negative timestamp
+ * warning) is computed on the component's thread when queueing each
+ * event (see pretty_prepare_event()).
+ *
+ * A worker thread only ever borrows the trace IR objects of the
+ * messages it formats: the component's thread keeps a reference on
+ * each queued message and puts it once the job is written, as trace IR
+ * objects have a non-atomic reference count.
+ *
+ * The number of queued jobs is bounded: queueing an event can block
+ * until the oldest job is formatted.
+ */
+
+/*
+ * Creates a formatting context for a worker thread: a copy of the
+ * options of `pretty`, with its own templates, which never modifies any
+ * trace IR object (see `is_format_worker`).
+ *
+ * The trace IR objects which a formatting context borrows must remain
+ * alive while it uses them: pretty_prepare_event() on `pretty` keeps
+ * the event classes alive.
+ */
+BT_HIDDEN
+struct pretty_component *pretty_create_format_ctx(
+		struct pretty_component *pretty);
+
+BT_HIDDEN
+void pretty_destroy_format_ctx(struct pretty_component *ctx);
+
+/*
+ * Creates `thread_count` formatting worker threads for the component
+ * `pretty`, once its options are set.
+ */
+BT_HIDDEN
+struct pretty_workers *pretty_workers_create(struct pretty_component *pretty,
+		guint thread_count);
+
+/*
+ * Joins the worker threads of `workers`, drops the jobs which are not
+ * written yet, and destroys `workers`.
+ */
+BT_HIDDEN
+void pretty_workers_destroy(struct pretty_workers *workers);
+
+/*
+ * Queues the event message `msg` to be formatted, taking a reference
+ * on it, and appends the text of the formatted jobs, in order, to the
+ * output buffer of the component.
+ */
+BT_HIDDEN
+int pretty_workers_push_event(struct pretty_workers *workers,
+		const bt_message *msg);
+
+/*
+ * Waits until all the queued events are formatted and appends their
+ * text, in order, to the output buffer of the component.
+ */
+BT_HIDDEN
+int pretty_workers_drain(struct pretty_workers *workers);
+
+#endif /* BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_WORKERS_H */
@@ -21,6 +21,14 @@
 #include "plugins/common/param-validation/param-validation.h"
 
 #include "pretty.h"
+#include "pretty-shards.h"
+#include "pretty-workers.h"
+
+/* Default value of the `output-buffer-size` parameter (bytes) */
+#define DEFAULT_OUTPUT_BUFFER_SIZE	(64 * 1024)
+
+/* Maximum value of the `format-threads` parameter */
+#define MAX_FORMAT_THREADS	64U
 
 static
 const char * const in_port_name = "in";
@@ -34,6 +42,32 @@ void destroy_pretty_data(struct pretty_component *pretty)
 
 	bt_message_iterator_put_ref(pretty->iterator);
 
+	if (pretty->workers) {
+		if (pretty->string && pretty->out) {
+			(void) pretty_workers_drain(pretty->workers);
+		}
+
+		pretty_workers_destroy(pretty->workers);
+		pretty->workers = NULL;
+	}
+
+	if (pretty->shards) {
+		if (pretty_shards_flush(pretty->shards)) {
+			perror("write output file");
+		}
+
+		pretty_shards_destroy(pretty->shards);
+		pretty->shards = NULL;
+	}
+
+	if (pretty->string && pretty->out) {
+		if (pretty_flush(pretty)) {
+			perror("write output file");
+		}
+	}
+
+	pretty_print_fini_templates(pretty);
+
 	if (pretty->string) {
 		(void) g_string_free(pretty->string, TRUE);
 	}
@@ -51,6 +85,11 @@ void destroy_pretty_data(struct pretty_component *pretty)
 		}
 	}
 	g_free(pretty->options.output_path);
+
+	if (pretty->options.fields) {
+		g_ptr_array_free(pretty->options.fields, TRUE);
+	}
+
 	g_free(pretty);
 
 end:
@@ -102,7 +141,21 @@ bt_message_iterator_class_next_method_status handle_message(
 
 	switch (bt_message_get_type(message)) {
 	case BT_MESSAGE_TYPE_EVENT:
-		if (pretty_print_event(pretty, message)) {
+		if (pretty->shards) {
+			if (pretty_shards_push_event(pretty->shards,
+					message)) {
+				BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+					"Failed to print one event.");
+				ret = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			}
+		} else if (pretty->workers) {
+			if (pretty_workers_push_event(pretty->workers,
+					message)) {
+				BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+					"Failed to queue one event.");
+				ret = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			}
+		} else if (pretty_print_event(pretty, message)) {
 			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
 				"Failed to print one event.");
 			ret = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
@@ -110,6 +163,14 @@ bt_message_iterator_class_next_method_status handle_message(
 		break;
 	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
 	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		/* The warning follows the preceding events */
+		if (pretty->workers && pretty_workers_drain(pretty->workers)) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Failed to print events.");
+			ret = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			break;
+		}
+
 		if (pretty_print_discarded_items(pretty, message)) {
 			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
 				"Failed to print discarded items.");
@@ -180,6 +241,24 @@ bt_component_class_sink_consume_method_status pretty_consume(
 		&msgs, &count);
 	if (next_status != BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
 		status = (int) next_status;
+
+		/*
+		 * Nothing more to print for now (or ever): write what's
+		 * buffered so that a live reader sees it immediately.
+		 */
+		if (next_status == BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN ||
+				next_status == BT_MESSAGE_ITERATOR_NEXT_STATUS_END) {
+			if ((pretty->workers &&
+					pretty_workers_drain(pretty->workers)) ||
+					(pretty->shards &&
+					pretty_shards_flush(pretty->shards)) ||
+					pretty_flush(pretty)) {
+				BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+					"Failed to write to output stream.");
+				status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			}
+		}
+
 		goto end;
 	}
 
@@ -259,7 +338,8 @@ int open_output_file(struct pretty_component *pretty)
 {
 	int ret = 0;
 
-	if (!pretty->options.output_path) {
+	if (!pretty->options.output_path ||
+			pretty->options.shard_by != PRETTY_SHARD_BY_NONE) {
 		goto end;
 	}
 
@@ -277,8 +357,78 @@ end:
 	return ret;
 }
 
+static
+void destroy_field_projection(struct pretty_field_projection *proj)
+{
+	g_free(proj->event_class_name);
+	g_free(proj->path);
+	g_strfreev(proj->path_names);
+	g_free(proj);
+}
+
+/*
+ * Parses the entries of the `fields` parameter, `[EVENT-CLASS-NAME:]PATH`.
+ *
+ * The event class name, if any, is everything before the last colon,
+ * as event class names often contain colons.
+ */
+static
+int parse_fields_param(struct pretty_component *pretty,
+		const bt_value *value)
+{
+	uint64_t i;
+	int ret = 0;
+
+	pretty->options.fields = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_field_projection);
+
+	for (i = 0; i < bt_value_array_get_length(value); i++) {
+		const char *entry = bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(value, i));
+		const char *colon = strrchr(entry, ':');
+		const char *path = colon ? colon + 1 : entry;
+		struct pretty_field_projection *proj =
+			g_new0(struct pretty_field_projection, 1);
+		gchar **name;
+
+		if (colon) {
+			proj->event_class_name = g_strndup(entry,
+				colon - entry);
+		}
+
+		proj->path = g_strdup(path);
+		proj->path_names = g_strsplit(path, ".", 0);
+		g_ptr_array_add(pretty->options.fields, proj);
+
+		for (name = proj->path_names; *name; name++) {
+			if (strlen(*name) == 0) {
+				break;
+			}
+		}
+
+		if (name == proj->path_names || *name ||
+				(colon && colon == entry)) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Invalid `fields` parameter entry: "
+				"expecting `[EVENT-CLASS-NAME:]NAME[.NAME...]`: "
+				"entry=\"%s\"", entry);
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static const char *color_choices[] = { "never", "auto", "always", NULL };
 static const char *show_hide_choices[] = { "show", "hide", NULL };
+static const char *shard_by_choices[] = { "trace", "stream", NULL };
+
+static
+struct bt_param_validation_value_descr fields_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
 
 static
 struct bt_param_validation_map_value_entry_descr pretty_params[] = {
@@ -292,6 +442,11 @@ struct bt_param_validation_map_value_entry_descr pretty_params[] = {
 	{ "clock-date", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "clock-gmt", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "verbose", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "output-buffer-size", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "format-threads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "shard-by", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
+		.choices = shard_by_choices,
+	} } },
 
 	{ "name-default", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
 		.choices = show_hide_choices,
@@ -312,6 +467,11 @@ struct bt_param_validation_map_value_entry_descr pretty_params[] = {
 	{ "field-loglevel", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "field-emf", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "field-callsite", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "fields", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &fields_elem_descr,
+	} } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -352,7 +512,32 @@ bt_component_class_initialize_method_status apply_params(
 		}
 	}
 
+	pretty->options.shard_by = PRETTY_SHARD_BY_NONE;
+	value = bt_value_map_borrow_entry_value_const(params, "shard-by");
+	if (value) {
+		const char *shard_by = bt_value_string_get(value);
+
+		if (strcmp(shard_by, "trace") == 0) {
+			pretty->options.shard_by = PRETTY_SHARD_BY_TRACE;
+		} else {
+			BT_ASSERT(strcmp(shard_by, "stream") == 0);
+			pretty->options.shard_by = PRETTY_SHARD_BY_STREAM;
+		}
+	}
+
 	apply_one_string("path", params, &pretty->options.output_path);
+
+	if (pretty->options.shard_by != PRETTY_SHARD_BY_NONE) {
+		/* `path` is the directory of the shard files */
+		if (!pretty->options.output_path) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Missing `path` parameter: "
+				"`shard-by` parameter requires an output directory.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	ret = open_output_file(pretty);
 	if (ret) {
 		BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
@@ -381,6 +566,32 @@ bt_component_class_initialize_method_status apply_params(
 	apply_one_bool_with_default("verbose", params,
 		&pretty->options.verbose, false);
 
+	pretty->options.output_buffer_size = DEFAULT_OUTPUT_BUFFER_SIZE;
+	value = bt_value_map_borrow_entry_value_const(params,
+		"output-buffer-size");
+	if (value) {
+		pretty->options.output_buffer_size =
+			bt_value_integer_unsigned_get(value);
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		"format-threads");
+	if (value) {
+		pretty->options.format_thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (pretty->options.format_thread_count > MAX_FORMAT_THREADS) {
+			BT_COMP_LOGE_APPEND_CAUSE(pretty->self_comp,
+				"Invalid `format-threads` parameter: "
+				"value is too large: "
+				"value=%" PRIu64 ", max-value=%u",
+				pretty->options.format_thread_count,
+				MAX_FORMAT_THREADS);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	/* Names. */
 	value = bt_value_map_borrow_entry_value_const(params, "name-default");
 	if (value) {
@@ -505,6 +716,14 @@ bt_component_class_initialize_method_status apply_params(
 	apply_one_bool_if_specified("field-callsite", params,
 		&pretty->options.print_callsite_field);
 
+	value = bt_value_map_borrow_entry_value_const(params, "fields");
+	if (value) {
+		if (parse_fields_param(pretty, value)) {
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	pretty_print_init();
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
@@ -523,6 +742,7 @@ void set_use_colors(struct pretty_component *pretty)
 		break;
 	case PRETTY_COLOR_OPT_AUTO:
 		pretty->use_colors = pretty->out == stdout &&
+			pretty->options.shard_by == PRETTY_SHARD_BY_NONE &&
 			bt_common_colors_supported();
 		break;
 	case PRETTY_COLOR_OPT_NEVER:
@@ -584,6 +804,25 @@ bt_component_class_initialize_method_status pretty_init(
 	}
 
 	set_use_colors(pretty);
+	pretty_print_init_templates(pretty);
+
+	if (pretty->options.shard_by != PRETTY_SHARD_BY_NONE) {
+		/* The formatting threads write the shard files */
+		pretty->shards = pretty_shards_create(pretty,
+			(guint) pretty->options.format_thread_count);
+		if (!pretty->shards) {
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto error;
+		}
+	} else if (pretty->options.format_thread_count > 0) {
+		pretty->workers = pretty_workers_create(pretty,
+			(guint) pretty->options.format_thread_count);
+		if (!pretty->workers) {
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto error;
+		}
+	}
+
 	bt_self_component_set_data(self_comp, pretty);
 
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
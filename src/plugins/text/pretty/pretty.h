@@ -25,9 +25,36 @@ enum pretty_color_option {
 	PRETTY_COLOR_OPT_ALWAYS,
 };
 
+enum pretty_shard_by {
+	PRETTY_SHARD_BY_NONE,
+	PRETTY_SHARD_BY_TRACE,
+	PRETTY_SHARD_BY_STREAM,
+};
+
+/* Entry of the `fields` parameter */
+struct pretty_field_projection {
+	/*
+	 * Name of the event classes to which this entry applies, or
+	 * `NULL` for all the event classes
+	 */
+	gchar *event_class_name;
+
+	/* Path of the payload member, as given (`NAME.NAME...`) */
+	gchar *path;
+
+	/* Member names of `path`, `NULL`-terminated */
+	gchar **path_names;
+};
+
 struct pretty_options {
 	char *output_path;
 
+	/*
+	 * Array of `struct pretty_field_projection *` (owned by the
+	 * component), or `NULL` to print all the payload members
+	 */
+	GPtrArray *fields;
+
 	enum pretty_default name_default;
 	enum pretty_default field_default;
 
@@ -52,8 +79,26 @@ struct pretty_options {
 	bool clock_gmt;
 	enum pretty_color_option color;
 	bool verbose;
+
+	/*
+	 * Number of printed bytes to accumulate before writing them to
+	 * the output stream
+	 */
+	uint64_t output_buffer_size;
+
+	/* Number of formatting worker threads (0: none) */
+	uint64_t format_thread_count;
+
+	/*
+	 * How to split the events into output files (`output_path` is
+	 * then their directory)
+	 */
+	enum pretty_shard_by shard_by;
 };
 
+struct pretty_workers;
+struct pretty_shards;
+
 struct pretty_component {
 	struct pretty_options options;
 	bt_message_iterator *iterator;
@@ -72,6 +117,59 @@ struct pretty_component {
 
 	bool negative_timestamp_warning_done;
 
+	/*
+	 * True if the current event's timestamp is the first negative
+	 * one, which is printed in seconds (set by
+	 * pretty_prepare_event()).
+	 */
+	bool fallback_to_seconds;
+
+	/*
+	 * Date and time which print_timestamp_wall() last formatted: it
+	 * only formats them again when the seconds change.
+	 */
+	struct {
+		bool is_valid;
+
+		/* Absolute number of seconds from the Unix epoch */
+		uint64_t sec;
+
+		/* `YYYY-MM-DD HH:MM:SS` or `HH:MM:SS` */
+		char str[32];
+	} last_wall_time;
+
+	/*
+	 * `const bt_event_class *` (borrowed key) to
+	 * `struct event_class_template *` (owned by this, see print.c)
+	 */
+	GHashTable *event_class_templates;
+
+	/*
+	 * `const bt_field_class *` (borrowed key) to
+	 * `struct field_class_template *` (owned by this, see print.c)
+	 */
+	GHashTable *field_class_templates;
+
+	/*
+	 * Formatting worker threads, or `NULL` to format the events on
+	 * the component's thread (owned by this)
+	 */
+	struct pretty_workers *workers;
+
+	/*
+	 * Output files of the `shard-by` parameter, or `NULL` to write the
+	 * events to `out` (owned by this)
+	 */
+	struct pretty_shards *shards;
+
+	/*
+	 * True if this is the formatting context of a worker thread
+	 * (see pretty-workers.h): it must not modify any trace IR
+	 * object, including its reference count, and it only uses
+	 * pretty_format_event().
+	 */
+	bool is_format_worker;
+
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
 };
@@ -94,10 +192,47 @@ bt_component_class_sink_graph_is_configured_method_status pretty_graph_is_config
 BT_HIDDEN
 void pretty_finalize(bt_self_component_sink *component);
 
+/*
+ * Prepares `pretty`, on the component's thread, to format the event
+ * message `event_msg`: updates what depends on the previous events
+ * (time deltas, negative timestamp warning).
+ *
+ * Must be called for each event message, in order, before
+ * pretty_format_event().
+ */
+BT_HIDDEN
+int pretty_prepare_event(struct pretty_component *pretty,
+		const bt_message *event_msg);
+
+/*
+ * Appends the text of the event message `event_msg` to
+ * `pretty->string`.
+ */
+BT_HIDDEN
+int pretty_format_event(struct pretty_component *pretty,
+		const bt_message *event_msg);
+
+/*
+ * Prepares, formats, and buffers the event message `event_msg`.
+ */
 BT_HIDDEN
 int pretty_print_event(struct pretty_component *pretty,
 		const bt_message *event_msg);
 
+/*
+ * Writes the buffered output of `pretty` if its size reached the
+ * `output-buffer-size` parameter.
+ */
+BT_HIDDEN
+int pretty_flush_if_full(struct pretty_component *pretty);
+
+/*
+ * Writes the events which `pretty` printed but didn't write yet to its
+ * output stream, and flushes the latter.
+ */
+BT_HIDDEN
+int pretty_flush(struct pretty_component *pretty);
+
 BT_HIDDEN
 int pretty_print_discarded_items(struct pretty_component *pretty,
 		const bt_message *msg);
@@ -105,4 +240,14 @@ int pretty_print_discarded_items(struct pretty_component *pretty,
 BT_HIDDEN
 void pretty_print_init(void);
 
+/*
+ * Creates the per-class text templates of `pretty`, once its options
+ * are set.
+ */
+BT_HIDDEN
+void pretty_print_init_templates(struct pretty_component *pretty);
+
+BT_HIDDEN
+void pretty_print_fini_templates(struct pretty_component *pretty);
+
 #endif /* BABELTRACE_PLUGIN_TEXT_PRETTY_PRETTY_H */
@@ -34,57 +34,628 @@ struct timestamp {
 	uint64_t clock_snapshot;	/* In cycles. */
 };
 
+/*
+ * Appends `value` in base `base` (8, 10, or 16, with uppercase
+ * digits), padded with zeros to at least `min_digits` digits, to `str`.
+ *
+ * This is much faster than bt_common_g_string_append_printf() for the
+ * numbers which this component prints for each event.
+ */
+static inline
+void append_uint(GString *str, uint64_t value, unsigned int base,
+		unsigned int min_digits)
+{
+	static const char digits[] = "0123456789ABCDEF";
+
+	/* Enough for the octal digits of any 64-bit value */
+	char buf[22];
+	char *end = buf + sizeof(buf);
+	char *p = end;
+
+	BT_ASSERT_DBG(base >= 2 && base <= 16);
+	BT_ASSERT_DBG(min_digits <= sizeof(buf));
+
+	do {
+		*--p = digits[value % base];
+		value /= base;
+	} while (value > 0);
+
+	while ((unsigned int) (end - p) < min_digits) {
+		*--p = '0';
+	}
+
+	g_string_append_len(str, p, end - p);
+}
+
+static inline
+void append_int(GString *str, int64_t value)
+{
+	if (value < 0) {
+		bt_common_g_string_append_c(str, '-');
+
+		/* Also valid for `INT64_MIN` */
+		append_uint(str, (uint64_t) 0 - (uint64_t) value, 10, 1);
+	} else {
+		append_uint(str, (uint64_t) value, 10, 1);
+	}
+}
+
 static
 int print_field(struct pretty_component *pretty,
 		const bt_field *field, bool print_names);
 
 static
-void print_name_equal(struct pretty_component *pretty, const char *name)
+void append_name_equal(struct pretty_component *pretty, GString *str,
+		const char *color, const char *name)
 {
 	if (pretty->use_colors) {
-		bt_common_g_string_append(pretty->string, color_name);
-		bt_common_g_string_append(pretty->string, name);
-		bt_common_g_string_append(pretty->string, color_rst);
+		bt_common_g_string_append(str, color);
+		bt_common_g_string_append(str, name);
+		bt_common_g_string_append(str, color_rst);
 	} else {
-		bt_common_g_string_append(pretty->string, name);
+		bt_common_g_string_append(str, name);
 	}
-	bt_common_g_string_append(pretty->string, " = ");
+	bt_common_g_string_append(str, " = ");
+}
+
+static
+void print_name_equal(struct pretty_component *pretty, const char *name)
+{
+	append_name_equal(pretty, pretty->string, color_name, name);
 }
 
+/*
+ * Text which doesn't depend on the field values, computed once per
+ * event class.
+ */
+struct event_class_template {
+	/*
+	 * Owned by this, or `NULL` for a formatting worker: the
+	 * component's template keeps the event class alive (see
+	 * pretty_prepare_event()).
+	 */
+	const bt_event_class *event_class;
+
+	/* `LEVEL (VALUE)`, or `NULL` if the event class has no log level */
+	GString *log_level;
+
+	/*
+	 * Event name part of the header, including the name of the field
+	 * if needed and the following separator
+	 */
+	GString *name;
+
+	/*
+	 * Payload members to print, in order, when the `fields`
+	 * parameter is set (array of `struct projected_member *`,
+	 * owned by this), or `NULL` to print all of them
+	 */
+	GPtrArray *payload_members;
+};
+
+/* Payload member selected by the `fields` parameter */
+struct projected_member {
+	/*
+	 * Member indexes (`uint64_t`) to follow from the payload
+	 * structure field, one per level
+	 */
+	GArray *indexes;
+
+	/* Separator and path of the member, if printed */
+	GString *prefix;
+};
+
+/* Enumeration field value and its mapping labels */
+struct enum_template_entry {
+	uint64_t value;
+
+	/* `( LABEL, LABEL : container = ` */
+	GString *prefix;
+};
+
+/*
+ * Text which doesn't depend on the field values, computed once per
+ * field class.
+ *
+ * The event classes which `pretty->event_class_templates` owns keep
+ * the field classes alive.
+ */
+struct field_class_template {
+	/*
+	 * Structure field class: array of `GString *` (owned by this),
+	 * the separator and name of each member, in order.
+	 */
+	GPtrArray *member_prefixes;
+
+	/*
+	 * Enumeration field class: `uint64_t *` (value, possibly cast
+	 * from a signed integer) to `struct enum_template_entry *`
+	 * (owned by this), filled as values appear.
+	 */
+	GHashTable *enum_entries;
+};
+
+/*
+ * Maximum number of distinct values of an enumeration field class for
+ * which to keep the mapping labels: enumerations are often flags or
+ * ranges, in which case caching all the values would only waste
+ * memory.
+ */
+#define MAX_ENUM_TEMPLATE_ENTRIES	1024
+
 static
-void print_field_name_equal(struct pretty_component *pretty, const char *name)
+void destroy_event_class_template(struct event_class_template *template)
 {
+	if (!template) {
+		return;
+	}
+
+	if (template->log_level) {
+		g_string_free(template->log_level, TRUE);
+	}
+
+	if (template->name) {
+		g_string_free(template->name, TRUE);
+	}
+
+	if (template->payload_members) {
+		g_ptr_array_free(template->payload_members, TRUE);
+	}
+
+	bt_event_class_put_ref(template->event_class);
+	g_free(template);
+}
+
+static
+void destroy_gstring(GString *str)
+{
+	g_string_free(str, TRUE);
+}
+
+static
+void destroy_projected_member(struct projected_member *member)
+{
+	g_array_free(member->indexes, TRUE);
+	g_string_free(member->prefix, TRUE);
+	g_free(member);
+}
+
+static
+void destroy_enum_template_entry(struct enum_template_entry *entry)
+{
+	g_string_free(entry->prefix, TRUE);
+	g_free(entry);
+}
+
+static
+void destroy_field_class_template(struct field_class_template *template)
+{
+	if (!template) {
+		return;
+	}
+
+	if (template->member_prefixes) {
+		g_ptr_array_free(template->member_prefixes, TRUE);
+	}
+
+	if (template->enum_entries) {
+		g_hash_table_destroy(template->enum_entries);
+	}
+
+	g_free(template);
+}
+
+static
+void append_escape_string(GString *gstr, const char *str);
+
+/*
+ * Resolves the entries of the `fields` parameter which apply to the
+ * event class `event_class` to member indexes within its payload field
+ * class, so that printing an event doesn't need to look up any member
+ * by name.
+ *
+ * An entry of which the path doesn't exist in the payload field class
+ * is ignored for this event class.
+ */
+static
+GPtrArray *create_payload_members(struct pretty_component *pretty,
+		const bt_event_class *event_class, const char *ev_name)
+{
+	GPtrArray *members = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_projected_member);
+	const bt_field_class *payload_fc =
+		bt_event_class_borrow_payload_field_class_const(event_class);
+	guint i;
+
+	if (!payload_fc) {
+		goto end;
+	}
+
+	for (i = 0; i < pretty->options.fields->len; i++) {
+		const struct pretty_field_projection *proj =
+			g_ptr_array_index(pretty->options.fields, i);
+		const bt_field_class *fc = payload_fc;
+		struct projected_member *member;
+		GArray *indexes;
+		gchar **name;
+
+		if (proj->event_class_name && (!ev_name ||
+				strcmp(proj->event_class_name, ev_name) != 0)) {
+			continue;
+		}
+
+		indexes = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+
+		for (name = proj->path_names; *name; name++) {
+			uint64_t member_count, index;
+
+			if (bt_field_class_get_type(fc) !=
+					BT_FIELD_CLASS_TYPE_STRUCTURE) {
+				break;
+			}
+
+			member_count =
+				bt_field_class_structure_get_member_count(fc);
+
+			for (index = 0; index < member_count; index++) {
+				const bt_field_class_structure_member *fc_member =
+					bt_field_class_structure_borrow_member_by_index_const(
+						fc, index);
+
+				if (strcmp(bt_field_class_structure_member_get_name(
+						fc_member), *name) == 0) {
+					fc = bt_field_class_structure_member_borrow_field_class_const(
+						fc_member);
+					break;
+				}
+			}
+
+			if (index == member_count) {
+				break;
+			}
+
+			g_array_append_val(indexes, index);
+		}
+
+		if (*name) {
+			/* No such member */
+			g_array_free(indexes, TRUE);
+			continue;
+		}
+
+		member = g_new0(struct projected_member, 1);
+		member->indexes = indexes;
+		member->prefix = g_string_new(members->len > 0 ? ", " : " ");
+
+		if (pretty->options.print_payload_field_names) {
+			append_name_equal(pretty, member->prefix,
+				color_field_name, proj->path);
+		}
+
+		g_ptr_array_add(members, member);
+	}
+
+end:
+	return members;
+}
+
+static
+struct event_class_template *borrow_event_class_template(
+		struct pretty_component *pretty,
+		const bt_event_class *event_class)
+{
+	static const char *log_level_names[] = {
+		[ BT_EVENT_CLASS_LOG_LEVEL_EMERGENCY ] = "TRACE_EMERG",
+		[ BT_EVENT_CLASS_LOG_LEVEL_ALERT ] = "TRACE_ALERT",
+		[ BT_EVENT_CLASS_LOG_LEVEL_CRITICAL ] = "TRACE_CRIT",
+		[ BT_EVENT_CLASS_LOG_LEVEL_ERROR ] = "TRACE_ERR",
+		[ BT_EVENT_CLASS_LOG_LEVEL_WARNING ] = "TRACE_WARNING",
+		[ BT_EVENT_CLASS_LOG_LEVEL_NOTICE ] = "TRACE_NOTICE",
+		[ BT_EVENT_CLASS_LOG_LEVEL_INFO ] = "TRACE_INFO",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_SYSTEM ] = "TRACE_DEBUG_SYSTEM",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_PROGRAM ] = "TRACE_DEBUG_PROGRAM",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_PROCESS ] = "TRACE_DEBUG_PROCESS",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_MODULE ] = "TRACE_DEBUG_MODULE",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_UNIT ] = "TRACE_DEBUG_UNIT",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_FUNCTION ] = "TRACE_DEBUG_FUNCTION",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_LINE ] = "TRACE_DEBUG_LINE",
+		[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG ] = "TRACE_DEBUG",
+	};
+	struct event_class_template *template;
+	bt_event_class_log_level log_level;
+	const char *ev_name;
+
+	template = g_hash_table_lookup(pretty->event_class_templates,
+		event_class);
+	if (G_LIKELY(template)) {
+		goto end;
+	}
+
+	template = g_new0(struct event_class_template, 1);
+	if (!template) {
+		goto end;
+	}
+
+	if (!pretty->is_format_worker) {
+		template->event_class = event_class;
+		bt_event_class_get_ref(template->event_class);
+	}
+
+	if (bt_event_class_get_log_level(event_class, &log_level) ==
+			BT_PROPERTY_AVAILABILITY_AVAILABLE) {
+		BT_ASSERT_DBG(log_level_names[log_level]);
+		template->log_level = g_string_new(log_level_names[log_level]);
+		bt_common_g_string_append(template->log_level, " (");
+		append_uint(template->log_level, (uint64_t) log_level, 10, 1);
+		bt_common_g_string_append_c(template->log_level, ')');
+	}
+
+	template->name = g_string_new(NULL);
+
+	if (pretty->options.print_header_field_names) {
+		append_name_equal(pretty, template->name, color_name, "name");
+	}
+
+	ev_name = bt_event_class_get_name(event_class);
 	if (pretty->use_colors) {
-		bt_common_g_string_append(pretty->string, color_field_name);
-		bt_common_g_string_append(pretty->string, name);
-		bt_common_g_string_append(pretty->string, color_rst);
+		if (ev_name) {
+			bt_common_g_string_append(template->name,
+				color_event_name);
+		} else {
+			bt_common_g_string_append(template->name,
+				color_unknown);
+		}
+	}
+	if (ev_name) {
+		bt_common_g_string_append(template->name, ev_name);
 	} else {
-		bt_common_g_string_append(pretty->string, name);
+		bt_common_g_string_append(template->name, "<unknown>");
+	}
+	if (pretty->use_colors) {
+		bt_common_g_string_append(template->name, color_rst);
+	}
+	if (!pretty->options.print_header_field_names) {
+		bt_common_g_string_append(template->name, ": ");
+	} else {
+		bt_common_g_string_append(template->name, ", ");
+	}
+
+	if (pretty->options.fields) {
+		template->payload_members = create_payload_members(pretty,
+			event_class, ev_name);
+	}
+
+	g_hash_table_insert(pretty->event_class_templates,
+		(gpointer) event_class, template);
+
+end:
+	return template;
+}
+
+static
+struct field_class_template *borrow_field_class_template(
+		struct pretty_component *pretty,
+		const bt_field_class *field_class)
+{
+	struct field_class_template *template;
+
+	template = g_hash_table_lookup(pretty->field_class_templates,
+		field_class);
+	if (G_LIKELY(template)) {
+		goto end;
+	}
+
+	template = g_new0(struct field_class_template, 1);
+	if (!template) {
+		goto end;
+	}
+
+	if (bt_field_class_get_type(field_class) ==
+			BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		uint64_t member_count =
+			bt_field_class_structure_get_member_count(field_class);
+		uint64_t i;
+
+		template->member_prefixes = g_ptr_array_new_full(member_count,
+			(GDestroyNotify) destroy_gstring);
+
+		for (i = 0; i < member_count; i++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					field_class, i);
+			GString *prefix = g_string_new(i > 0 ? ", " : " ");
+
+			append_name_equal(pretty, prefix, color_field_name,
+				bt_field_class_structure_member_get_name(member));
+			g_ptr_array_add(template->member_prefixes, prefix);
+		}
+	} else {
+		BT_ASSERT_DBG(bt_field_class_type_is(
+			bt_field_class_get_type(field_class),
+			BT_FIELD_CLASS_TYPE_ENUMERATION));
+		template->enum_entries = g_hash_table_new_full(g_int64_hash,
+			g_int64_equal, NULL,
+			(GDestroyNotify) destroy_enum_template_entry);
+	}
+
+	g_hash_table_insert(pretty->field_class_templates,
+		(gpointer) field_class, template);
+
+end:
+	return template;
+}
+
+BT_HIDDEN
+void pretty_print_init_templates(struct pretty_component *pretty)
+{
+	pretty->event_class_templates = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL,
+		(GDestroyNotify) destroy_event_class_template);
+	pretty->field_class_templates = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL,
+		(GDestroyNotify) destroy_field_class_template);
+}
+
+BT_HIDDEN
+void pretty_print_fini_templates(struct pretty_component *pretty)
+{
+	/* Field class templates first: the event classes own their classes */
+	if (pretty->field_class_templates) {
+		g_hash_table_destroy(pretty->field_class_templates);
+		pretty->field_class_templates = NULL;
+	}
+
+	if (pretty->event_class_templates) {
+		g_hash_table_destroy(pretty->event_class_templates);
+		pretty->event_class_templates = NULL;
 	}
-	bt_common_g_string_append(pretty->string, " = ");
 }
 
 static
 void print_timestamp_cycles(struct pretty_component *pretty,
-		const bt_clock_snapshot *clock_snapshot, bool update_last)
+		const bt_clock_snapshot *clock_snapshot)
+{
+	append_uint(pretty->string, bt_clock_snapshot_get_value(clock_snapshot),
+		10, 20);
+}
+
+/*
+ * Prints the warning about negative timestamps if it's not done yet.
+ *
+ * Returns whether or not it printed the warning: the timestamp which
+ * triggers it is printed in seconds.
+ */
+static
+bool warn_negative_timestamp(struct pretty_component *pretty)
+{
+	if (pretty->negative_timestamp_warning_done) {
+		return false;
+	}
+
+	// TODO: log instead
+	fprintf(stderr, "[warning] Fallback to [sec.ns] to print negative time value. Use --clock-seconds.\n");
+	pretty->negative_timestamp_warning_done = true;
+	return true;
+}
+
+BT_HIDDEN
+int pretty_prepare_event(struct pretty_component *pretty,
+		const bt_message *event_msg)
 {
-	uint64_t cycles;
+	const bt_event *event = bt_message_event_borrow_event_const(event_msg);
+	const bt_clock_snapshot *clock_snapshot;
+	int ret = 0;
+
+	BT_ASSERT_DBG(!pretty->is_format_worker);
 
-	cycles = bt_clock_snapshot_get_value(clock_snapshot);
-	bt_common_g_string_append_printf(pretty->string, "%020" PRIu64, cycles);
+	/* This also keeps the event class alive */
+	if (!borrow_event_class_template(pretty,
+			bt_event_borrow_class_const(event))) {
+		ret = -1;
+		goto end;
+	}
+
+	pretty->fallback_to_seconds = false;
+
+	if (!bt_message_event_borrow_stream_class_default_clock_class_const(
+			event_msg)) {
+		goto end;
+	}
+
+	clock_snapshot = bt_message_event_borrow_default_clock_snapshot_const(
+		event_msg);
+
+	if (pretty->options.print_timestamp_cycles) {
+		uint64_t cycles = bt_clock_snapshot_get_value(clock_snapshot);
 
-	if (update_last) {
 		if (pretty->last_cycles_timestamp != -1ULL) {
 			pretty->delta_cycles = cycles - pretty->last_cycles_timestamp;
 		}
 
 		pretty->last_cycles_timestamp = cycles;
+	} else {
+		int64_t ts_nsec;
+
+		if (bt_clock_snapshot_get_ns_from_origin(clock_snapshot,
+				&ts_nsec)) {
+			/* print_timestamp_wall() prints `Error` */
+			goto end;
+		}
+
+		if (pretty->last_real_timestamp != -1ULL) {
+			pretty->delta_real_timestamp = ts_nsec - pretty->last_real_timestamp;
+		}
+
+		pretty->last_real_timestamp = ts_nsec;
+
+		if (!pretty->options.clock_seconds && ts_nsec < 0) {
+			pretty->fallback_to_seconds =
+				warn_negative_timestamp(pretty);
+		}
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Formats the date (if needed) and time of `sec` seconds from the Unix
+ * epoch into `pretty->last_wall_time`.
+ *
+ * Returns a negative value if the time cannot be formatted.
+ */
+static
+int format_wall_time(struct pretty_component *pretty, uint64_t sec)
+{
+	struct tm tm;
+	time_t time_s = (time_t) sec;
+	int ret = 0;
+
+	pretty->last_wall_time.is_valid = false;
+
+	if (!pretty->options.clock_gmt) {
+		struct tm *res;
+
+		res = bt_localtime_r(&time_s, &tm);
+		if (!res) {
+			// TODO: log instead
+			fprintf(stderr, "[warning] Unable to get localtime.\n");
+			goto error;
+		}
+	} else {
+		struct tm *res;
+
+		res = bt_gmtime_r(&time_s, &tm);
+		if (!res) {
+			// TODO: log instead
+			fprintf(stderr, "[warning] Unable to get gmtime.\n");
+			goto error;
+		}
+	}
+
+	if (!strftime(pretty->last_wall_time.str,
+			sizeof(pretty->last_wall_time.str),
+			pretty->options.clock_date ? "%Y-%m-%d %H:%M:%S" :
+				"%H:%M:%S", &tm)) {
+		// TODO: log instead
+		fprintf(stderr, "[warning] Unable to print ascii time.\n");
+		goto error;
 	}
+
+	pretty->last_wall_time.sec = sec;
+	pretty->last_wall_time.is_valid = true;
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	return ret;
 }
 
 static
 void print_timestamp_wall(struct pretty_component *pretty,
-		const bt_clock_snapshot *clock_snapshot, bool update_last)
+		const bt_clock_snapshot *clock_snapshot, bool is_event)
 {
 	int ret;
 	int64_t ts_nsec = 0;	/* add configurable offset */
@@ -104,14 +675,6 @@ void print_timestamp_wall(struct pretty_component *pretty,
 		return;
 	}
 
-	if (update_last) {
-		if (pretty->last_real_timestamp != -1ULL) {
-			pretty->delta_real_timestamp = ts_nsec - pretty->last_real_timestamp;
-		}
-
-		pretty->last_real_timestamp = ts_nsec;
-	}
-
 	ts_sec += ts_nsec / NSEC_PER_SEC;
 	ts_nsec = ts_nsec % NSEC_PER_SEC;
 
@@ -142,60 +705,42 @@ void print_timestamp_wall(struct pretty_component *pretty,
 	}
 
 	if (!pretty->options.clock_seconds) {
-		struct tm tm;
-		time_t time_s = (time_t) ts_sec_abs;
-
-		if (is_negative && !pretty->negative_timestamp_warning_done) {
-			// TODO: log instead
-			fprintf(stderr, "[warning] Fallback to [sec.ns] to print negative time value. Use --clock-seconds.\n");
-			pretty->negative_timestamp_warning_done = true;
+		/*
+		 * For an event, pretty_prepare_event() already decided,
+		 * in order.
+		 */
+		if (is_negative && (is_event ? pretty->fallback_to_seconds :
+				warn_negative_timestamp(pretty))) {
 			goto seconds;
 		}
 
-		if (!pretty->options.clock_gmt) {
-			struct tm *res;
-
-			res = bt_localtime_r(&time_s, &tm);
-			if (!res) {
-				// TODO: log instead
-				fprintf(stderr, "[warning] Unable to get localtime.\n");
-				goto seconds;
-			}
-		} else {
-			struct tm *res;
-
-			res = bt_gmtime_r(&time_s, &tm);
-			if (!res) {
-				// TODO: log instead
-				fprintf(stderr, "[warning] Unable to get gmtime.\n");
-				goto seconds;
-			}
-		}
-		if (pretty->options.clock_date) {
-			char timestr[26];
-			size_t res;
-
-			/* Print date and time */
-			res = strftime(timestr, sizeof(timestr),
-					"%Y-%m-%d ", &tm);
-			if (!res) {
-				// TODO: log instead
-				fprintf(stderr, "[warning] Unable to print ascii time.\n");
+		/*
+		 * Consecutive events are typically within the same
+		 * second: only format the date and time again when the
+		 * seconds change.
+		 */
+		if (!pretty->last_wall_time.is_valid ||
+				pretty->last_wall_time.sec != ts_sec_abs) {
+			if (format_wall_time(pretty, ts_sec_abs)) {
 				goto seconds;
 			}
-
-			bt_common_g_string_append(pretty->string, timestr);
 		}
 
-		/* Print time in HH:MM:SS.ns */
-		bt_common_g_string_append_printf(pretty->string,
-			"%02d:%02d:%02d.%09" PRIu64, tm.tm_hour, tm.tm_min,
-			tm.tm_sec, ts_nsec_abs);
+		/* Print time in [YYYY-MM-DD ]HH:MM:SS.ns */
+		bt_common_g_string_append(pretty->string,
+			pretty->last_wall_time.str);
+		bt_common_g_string_append_c(pretty->string, '.');
+		append_uint(pretty->string, ts_nsec_abs, 10, 9);
 		goto end;
 	}
 seconds:
-	bt_common_g_string_append_printf(pretty->string, "%s%" PRId64 ".%09" PRIu64,
-		is_negative ? "-" : "", ts_sec_abs, ts_nsec_abs);
+	if (is_negative) {
+		bt_common_g_string_append_c(pretty->string, '-');
+	}
+
+	append_uint(pretty->string, ts_sec_abs, 10, 1);
+	bt_common_g_string_append_c(pretty->string, '.');
+	append_uint(pretty->string, ts_nsec_abs, 10, 9);
 end:
 	return;
 }
@@ -225,7 +770,7 @@ int print_event_timestamp(struct pretty_component *pretty,
 		bt_common_g_string_append(pretty->string, color_timestamp);
 	}
 	if (pretty->options.print_timestamp_cycles) {
-		print_timestamp_cycles(pretty, clock_snapshot, true);
+		print_timestamp_cycles(pretty, clock_snapshot);
 	} else {
 		print_timestamp_wall(pretty, clock_snapshot, true);
 	}
@@ -248,8 +793,9 @@ int print_event_timestamp(struct pretty_component *pretty,
 				bt_common_g_string_append(pretty->string,
 					"+??????????\?\?"); /* Not a trigraph. */
 			} else {
-				bt_common_g_string_append_printf(pretty->string,
-					"+%012" PRIu64, pretty->delta_cycles);
+				bt_common_g_string_append_c(pretty->string, '+');
+				append_uint(pretty->string,
+					pretty->delta_cycles, 10, 12);
 			}
 		} else {
 			if (pretty->delta_real_timestamp != -1ULL) {
@@ -258,9 +804,10 @@ int print_event_timestamp(struct pretty_component *pretty,
 				delta = pretty->delta_real_timestamp;
 				delta_sec = delta / NSEC_PER_SEC;
 				delta_nsec = delta % NSEC_PER_SEC;
-				bt_common_g_string_append_printf(pretty->string,
-					"+%" PRIu64 ".%09" PRIu64,
-					delta_sec, delta_nsec);
+				bt_common_g_string_append_c(pretty->string, '+');
+				append_uint(pretty->string, delta_sec, 10, 1);
+				bt_common_g_string_append_c(pretty->string, '.');
+				append_uint(pretty->string, delta_nsec, 10, 9);
 			} else {
 				bt_common_g_string_append(pretty->string, "+?.?????????");
 			}
@@ -285,13 +832,18 @@ int print_event_header(struct pretty_component *pretty,
 	const bt_stream *stream = NULL;
 	const bt_trace *trace = NULL;
 	const bt_event *event = bt_message_event_borrow_event_const(event_msg);
-	const char *ev_name;
+	struct event_class_template *template;
 	int dom_print = 0;
-	bt_property_availability prop_avail;
 
 	event_class = bt_event_borrow_class_const(event);
 	stream = bt_event_borrow_stream_const(event);
 	trace = bt_stream_borrow_trace_const(stream);
+	template = borrow_event_class_template(pretty, event_class);
+	if (!template) {
+		ret = -1;
+		goto end;
+	}
+
 	ret = print_event_timestamp(pretty, event_msg, &pretty->start_line);
 	if (ret) {
 		goto end;
@@ -393,52 +945,25 @@ int print_event_header(struct pretty_component *pretty,
 				bt_common_g_string_append(pretty->string, ":");
 			}
 			value = bt_value_integer_signed_get(vpid_value);
-			bt_common_g_string_append_printf(pretty->string,
-				"(%" PRId64 ")", value);
+			bt_common_g_string_append_c(pretty->string, '(');
+			append_int(pretty->string, value);
+			bt_common_g_string_append_c(pretty->string, ')');
 			dom_print = 1;
 		}
 	}
-	if (pretty->options.print_loglevel_field) {
-		static const char *log_level_names[] = {
-			[ BT_EVENT_CLASS_LOG_LEVEL_EMERGENCY ] = "TRACE_EMERG",
-			[ BT_EVENT_CLASS_LOG_LEVEL_ALERT ] = "TRACE_ALERT",
-			[ BT_EVENT_CLASS_LOG_LEVEL_CRITICAL ] = "TRACE_CRIT",
-			[ BT_EVENT_CLASS_LOG_LEVEL_ERROR ] = "TRACE_ERR",
-			[ BT_EVENT_CLASS_LOG_LEVEL_WARNING ] = "TRACE_WARNING",
-			[ BT_EVENT_CLASS_LOG_LEVEL_NOTICE ] = "TRACE_NOTICE",
-			[ BT_EVENT_CLASS_LOG_LEVEL_INFO ] = "TRACE_INFO",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_SYSTEM ] = "TRACE_DEBUG_SYSTEM",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_PROGRAM ] = "TRACE_DEBUG_PROGRAM",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_PROCESS ] = "TRACE_DEBUG_PROCESS",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_MODULE ] = "TRACE_DEBUG_MODULE",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_UNIT ] = "TRACE_DEBUG_UNIT",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_FUNCTION ] = "TRACE_DEBUG_FUNCTION",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG_LINE ] = "TRACE_DEBUG_LINE",
-			[ BT_EVENT_CLASS_LOG_LEVEL_DEBUG ] = "TRACE_DEBUG",
-		};
-		bt_event_class_log_level log_level;
-		const char *log_level_str = NULL;
-
-		prop_avail = bt_event_class_get_log_level(event_class,
-			&log_level);
-		if (prop_avail == BT_PROPERTY_AVAILABILITY_AVAILABLE) {
-			log_level_str = log_level_names[log_level];
-			BT_ASSERT_DBG(log_level_str);
-
-			if (!pretty->start_line) {
-				bt_common_g_string_append(pretty->string, ", ");
-			}
-			if (print_names) {
-				print_name_equal(pretty, "loglevel");
-			} else if (dom_print) {
-				bt_common_g_string_append(pretty->string, ":");
-			}
-
-			bt_common_g_string_append(pretty->string, log_level_str);
-			bt_common_g_string_append_printf(
-				pretty->string, " (%d)", (int) log_level);
-			dom_print = 1;
+	if (pretty->options.print_loglevel_field && template->log_level) {
+		if (!pretty->start_line) {
+			bt_common_g_string_append(pretty->string, ", ");
 		}
+		if (print_names) {
+			print_name_equal(pretty, "loglevel");
+		} else if (dom_print) {
+			bt_common_g_string_append(pretty->string, ":");
+		}
+
+		g_string_append_len(pretty->string, template->log_level->str,
+			template->log_level->len);
+		dom_print = 1;
 	}
 	if (pretty->options.print_emf_field) {
 		const char *uri_str;
@@ -465,32 +990,8 @@ int print_event_header(struct pretty_component *pretty,
 		bt_common_g_string_append(pretty->string, ", ");
 	}
 	pretty->start_line = true;
-	if (print_names) {
-		print_name_equal(pretty, "name");
-	}
-	ev_name = bt_event_class_get_name(event_class);
-	if (pretty->use_colors) {
-		if (ev_name) {
-			bt_common_g_string_append(pretty->string,
-				color_event_name);
-		} else {
-			bt_common_g_string_append(pretty->string,
-				color_unknown);
-		}
-	}
-	if (ev_name) {
-		bt_common_g_string_append(pretty->string, ev_name);
-	} else {
-		bt_common_g_string_append(pretty->string, "<unknown>");
-	}
-	if (pretty->use_colors) {
-		bt_common_g_string_append(pretty->string, color_rst);
-	}
-	if (!print_names) {
-		bt_common_g_string_append(pretty->string, ": ");
-	} else {
-		bt_common_g_string_append(pretty->string, ", ");
-	}
+	g_string_append_len(pretty->string, template->name->str,
+		template->name->len);
 
 end:
 	return ret;
@@ -559,15 +1060,16 @@ int print_integer(struct pretty_component *pretty,
 			}
 		}
 
-		bt_common_g_string_append_printf(pretty->string, "0%" PRIo64, v.u);
+		bt_common_g_string_append_c(pretty->string, '0');
+		append_uint(pretty->string, v.u, 8, 1);
 		break;
 	}
 	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_DECIMAL:
 		if (bt_field_class_type_is(ft_type,
 				BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
-			bt_common_g_string_append_printf(pretty->string, "%" PRIu64, v.u);
+			append_uint(pretty->string, v.u, 10, 1);
 		} else {
-			bt_common_g_string_append_printf(pretty->string, "%" PRId64, v.s);
+			append_int(pretty->string, v.s);
 		}
 		break;
 	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_HEXADECIMAL:
@@ -582,7 +1084,8 @@ int print_integer(struct pretty_component *pretty,
 			v.u &= ((uint64_t) 1 << rounded_len) - 1;
 		}
 
-		bt_common_g_string_append_printf(pretty->string, "0x%" PRIX64, v.u);
+		bt_common_g_string_append(pretty->string, "0x");
+		append_uint(pretty->string, v.u, 16, 1);
 		break;
 	}
 	default:
@@ -597,127 +1100,264 @@ end:
 }
 
 static
-void print_escape_string(struct pretty_component *pretty, const char *str)
+void append_escape_string(GString *gstr, const char *str)
 {
 	int i;
 
-	bt_common_g_string_append_c(pretty->string, '"');
+	bt_common_g_string_append_c(gstr, '"');
 
 	for (i = 0; i < strlen(str); i++) {
 		/* Escape sequences not recognized by iscntrl(). */
 		switch (str[i]) {
 		case '\\':
-			bt_common_g_string_append(pretty->string, "\\\\");
+			bt_common_g_string_append(gstr, "\\\\");
 			continue;
 		case '\'':
-			bt_common_g_string_append(pretty->string, "\\\'");
+			bt_common_g_string_append(gstr, "\\\'");
 			continue;
 		case '\"':
-			bt_common_g_string_append(pretty->string, "\\\"");
+			bt_common_g_string_append(gstr, "\\\"");
 			continue;
 		case '\?':
-			bt_common_g_string_append(pretty->string, "\\\?");
+			bt_common_g_string_append(gstr, "\\\?");
 			continue;
 		}
 
 		/* Standard characters. */
 		if (!iscntrl((unsigned char) str[i])) {
-			bt_common_g_string_append_c(pretty->string, str[i]);
+			bt_common_g_string_append_c(gstr, str[i]);
 			continue;
 		}
 
 		switch (str[i]) {
 		case '\0':
-			bt_common_g_string_append(pretty->string, "\\0");
+			bt_common_g_string_append(gstr, "\\0");
 			break;
 		case '\a':
-			bt_common_g_string_append(pretty->string, "\\a");
+			bt_common_g_string_append(gstr, "\\a");
 			break;
 		case '\b':
-			bt_common_g_string_append(pretty->string, "\\b");
+			bt_common_g_string_append(gstr, "\\b");
 			break;
 		case '\e':
-			bt_common_g_string_append(pretty->string, "\\e");
+			bt_common_g_string_append(gstr, "\\e");
 			break;
 		case '\f':
-			bt_common_g_string_append(pretty->string, "\\f");
+			bt_common_g_string_append(gstr, "\\f");
 			break;
 		case '\n':
-			bt_common_g_string_append(pretty->string, "\\n");
+			bt_common_g_string_append(gstr, "\\n");
 			break;
 		case '\r':
-			bt_common_g_string_append(pretty->string, "\\r");
+			bt_common_g_string_append(gstr, "\\r");
 			break;
 		case '\t':
-			bt_common_g_string_append(pretty->string, "\\t");
+			bt_common_g_string_append(gstr, "\\t");
 			break;
 		case '\v':
-			bt_common_g_string_append(pretty->string, "\\v");
+			bt_common_g_string_append(gstr, "\\v");
 			break;
 		default:
 			/* Unhandled control-sequence, print as hex. */
-			bt_common_g_string_append_printf(pretty->string, "\\x%02x", str[i]);
+			bt_common_g_string_append_printf(gstr, "\\x%02x", str[i]);
 			break;
 		}
 	}
 
-	bt_common_g_string_append_c(pretty->string, '"');
+	bt_common_g_string_append_c(gstr, '"');
 }
 
 static
-int print_enum(struct pretty_component *pretty,
-		const bt_field *field)
+void print_escape_string(struct pretty_component *pretty, const char *str)
 {
-	int ret = 0;
-	bt_field_class_enumeration_mapping_label_array label_array;
-	uint64_t label_count;
+	append_escape_string(pretty->string, str);
+}
+
+/*
+ * Returns whether or not the unsigned enumeration field class mapping
+ * `mapping` maps `value`.
+ */
+static
+bool unsigned_mapping_maps(
+		const bt_field_class_enumeration_unsigned_mapping *mapping,
+		uint64_t value)
+{
+	const bt_integer_range_set_unsigned *ranges =
+		bt_field_class_enumeration_unsigned_mapping_borrow_ranges_const(
+			mapping);
+	uint64_t range_count = bt_integer_range_set_get_range_count(
+		bt_integer_range_set_unsigned_as_range_set_const(ranges));
 	uint64_t i;
 
-	switch (bt_field_get_class_type(field)) {
-	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
-		ret = bt_field_enumeration_unsigned_get_mapping_labels(field,
-			&label_array, &label_count);
-		break;
-	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		ret = bt_field_enumeration_signed_get_mapping_labels(field,
-			&label_array, &label_count);
-		break;
-	default:
-		bt_common_abort();
+	for (i = 0; i < range_count; i++) {
+		const bt_integer_range_unsigned *range =
+			bt_integer_range_set_unsigned_borrow_range_by_index_const(
+				ranges, i);
+
+		if (value >= bt_integer_range_unsigned_get_lower(range) &&
+				value <= bt_integer_range_unsigned_get_upper(range)) {
+			return true;
+		}
 	}
 
-	if (ret) {
-		ret = -1;
-		goto end;
+	return false;
+}
+
+/*
+ * Returns whether or not the signed enumeration field class mapping
+ * `mapping` maps `value`.
+ */
+static
+bool signed_mapping_maps(
+		const bt_field_class_enumeration_signed_mapping *mapping,
+		int64_t value)
+{
+	const bt_integer_range_set_signed *ranges =
+		bt_field_class_enumeration_signed_mapping_borrow_ranges_const(
+			mapping);
+	uint64_t range_count = bt_integer_range_set_get_range_count(
+		bt_integer_range_set_signed_as_range_set_const(ranges));
+	uint64_t i;
+
+	for (i = 0; i < range_count; i++) {
+		const bt_integer_range_signed *range =
+			bt_integer_range_set_signed_borrow_range_by_index_const(
+				ranges, i);
+
+		if (value >= bt_integer_range_signed_get_lower(range) &&
+				value <= bt_integer_range_signed_get_upper(range)) {
+			return true;
+		}
 	}
 
-	bt_common_g_string_append(pretty->string, "( ");
-	if (label_count == 0) {
+	return false;
+}
+
+/*
+ * Appends `( LABEL, LABEL : container = ` for the enumeration field
+ * `field` to `str`.
+ *
+ * This finds the mapping labels without
+ * bt_field_enumeration_unsigned_get_mapping_labels() and
+ * bt_field_enumeration_signed_get_mapping_labels(), which fill a
+ * buffer of the field class: formatting workers (see
+ * pretty-workers.h) may print fields of the same class in parallel.
+ */
+static
+void append_enum_labels(struct pretty_component *pretty, GString *str,
+		const bt_field *field)
+{
+	const bt_field_class *fc = bt_field_borrow_class_const(field);
+	bool is_unsigned = bt_field_get_class_type(field) ==
+		BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION;
+	uint64_t mapping_count = bt_field_class_enumeration_get_mapping_count(fc);
+	uint64_t label_count = 0;
+	uint64_t i;
+
+	bt_common_g_string_append(str, "( ");
+
+	for (i = 0; i < mapping_count; i++) {
+		const bt_field_class_enumeration_mapping *mapping;
+
+		if (is_unsigned) {
+			const bt_field_class_enumeration_unsigned_mapping *umapping =
+				bt_field_class_enumeration_unsigned_borrow_mapping_by_index_const(
+					fc, i);
+
+			if (!unsigned_mapping_maps(umapping,
+					bt_field_integer_unsigned_get_value(field))) {
+				continue;
+			}
+
+			mapping = bt_field_class_enumeration_unsigned_mapping_as_mapping_const(
+				umapping);
+		} else {
+			const bt_field_class_enumeration_signed_mapping *smapping =
+				bt_field_class_enumeration_signed_borrow_mapping_by_index_const(
+					fc, i);
+
+			if (!signed_mapping_maps(smapping,
+					bt_field_integer_signed_get_value(field))) {
+				continue;
+			}
+
+			mapping = bt_field_class_enumeration_signed_mapping_as_mapping_const(
+				smapping);
+		}
+
+		if (label_count != 0) {
+			bt_common_g_string_append(str, ", ");
+		}
 		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_unknown);
+			bt_common_g_string_append(str, color_enum_mapping_name);
 		}
-		bt_common_g_string_append(pretty->string, "<unknown>");
+		append_escape_string(str,
+			bt_field_class_enumeration_mapping_get_label(mapping));
 		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_rst);
+			bt_common_g_string_append(str, color_rst);
 		}
-		goto skip_loop;
+		label_count++;
 	}
-	for (i = 0; i < label_count; i++) {
-		const char *mapping_name = label_array[i];
 
-		if (i != 0) {
-			bt_common_g_string_append(pretty->string, ", ");
-		}
+	if (label_count == 0) {
 		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_enum_mapping_name);
+			bt_common_g_string_append(str, color_unknown);
 		}
-		print_escape_string(pretty, mapping_name);
+		bt_common_g_string_append(str, "<unknown>");
 		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_rst);
+			bt_common_g_string_append(str, color_rst);
+		}
+	}
+
+	bt_common_g_string_append(str, " : container = ");
+}
+
+static
+int print_enum(struct pretty_component *pretty,
+		const bt_field *field)
+{
+	int ret = 0;
+	struct field_class_template *template;
+	struct enum_template_entry *entry;
+	uint64_t value;
+
+	template = borrow_field_class_template(pretty,
+		bt_field_borrow_class_const(field));
+	if (!template) {
+		ret = -1;
+		goto end;
+	}
+
+	if (bt_field_get_class_type(field) ==
+			BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION) {
+		value = bt_field_integer_unsigned_get_value(field);
+	} else {
+		value = (uint64_t) bt_field_integer_signed_get_value(field);
+	}
+
+	entry = g_hash_table_lookup(template->enum_entries, &value);
+	if (G_LIKELY(entry)) {
+		g_string_append_len(pretty->string, entry->prefix->str,
+			entry->prefix->len);
+	} else if (g_hash_table_size(template->enum_entries) <
+			MAX_ENUM_TEMPLATE_ENTRIES) {
+		entry = g_new0(struct enum_template_entry, 1);
+		if (!entry) {
+			ret = -1;
+			goto end;
 		}
+
+		entry->value = value;
+		entry->prefix = g_string_new(NULL);
+		append_enum_labels(pretty, entry->prefix, field);
+		g_hash_table_insert(template->enum_entries, &entry->value,
+			entry);
+		g_string_append_len(pretty->string, entry->prefix->str,
+			entry->prefix->len);
+	} else {
+		append_enum_labels(pretty, pretty->string, field);
 	}
-skip_loop:
-	bt_common_g_string_append(pretty->string, " : container = ");
+
 	ret = print_integer(pretty, field);
 	if (ret != 0) {
 		goto end;
@@ -734,9 +1374,7 @@ int print_struct_field(struct pretty_component *pretty,
 		uint64_t i, bool print_names, uint64_t *nr_printed_fields)
 {
 	int ret = 0;
-	const char *field_name;
 	const bt_field *field = NULL;
-	const bt_field_class_structure_member *member;
 
 	field = bt_field_structure_borrow_member_field_by_index_const(_struct, i);
 	if (!field) {
@@ -744,18 +1382,25 @@ int print_struct_field(struct pretty_component *pretty,
 		goto end;
 	}
 
-	member = bt_field_class_structure_borrow_member_by_index_const(
-		struct_class, i);
-	field_name = bt_field_class_structure_member_get_name(member);
+	if (print_names) {
+		struct field_class_template *template;
+		const GString *prefix;
+
+		/* Member `i` is the `*nr_printed_fields`th one */
+		BT_ASSERT_DBG(*nr_printed_fields == i);
+		template = borrow_field_class_template(pretty, struct_class);
+		if (!template) {
+			ret = -1;
+			goto end;
+		}
 
-	if (*nr_printed_fields > 0) {
+		prefix = g_ptr_array_index(template->member_prefixes, i);
+		g_string_append_len(pretty->string, prefix->str, prefix->len);
+	} else if (*nr_printed_fields > 0) {
 		bt_common_g_string_append(pretty->string, ", ");
 	} else {
 		bt_common_g_string_append(pretty->string, " ");
 	}
-	if (print_names) {
-		print_field_name_equal(pretty, field_name);
-	}
 	ret = print_field(pretty, field, print_names);
 	*nr_printed_fields += 1;
 
@@ -803,7 +1448,9 @@ int print_array_field(struct pretty_component *pretty,
 		bt_common_g_string_append(pretty->string, " ");
 	}
 	if (print_names) {
-		bt_common_g_string_append_printf(pretty->string, "[%" PRIu64 "] = ", i);
+		bt_common_g_string_append_c(pretty->string, '[');
+		append_uint(pretty->string, i, 10, 1);
+		bt_common_g_string_append(pretty->string, "] = ");
 	}
 
 	field = bt_field_array_borrow_element_field_by_index_const(array, i);
@@ -847,7 +1494,9 @@ int print_sequence_field(struct pretty_component *pretty,
 		bt_common_g_string_append(pretty->string, " ");
 	}
 	if (print_names) {
-		bt_common_g_string_append_printf(pretty->string, "[%" PRIu64 "] = ", i);
+		bt_common_g_string_append_c(pretty->string, '[');
+		append_uint(pretty->string, i, 10, 1);
+		bt_common_g_string_append(pretty->string, "] = ");
 	}
 
 	field = bt_field_array_borrow_element_field_by_index_const(seq, i);
@@ -967,8 +1616,8 @@ int print_field(struct pretty_component *pretty,
 			bt_common_g_string_append(pretty->string,
 				color_number_value);
 		}
-		bt_common_g_string_append_printf(pretty->string, "0x%" PRIX64,
-			v);
+		bt_common_g_string_append(pretty->string, "0x");
+		append_uint(pretty->string, v, 16, 1);
 		if (pretty->use_colors) {
 			bt_common_g_string_append(pretty->string, color_rst);
 		}
@@ -1113,17 +1762,78 @@ end:
 	return ret;
 }
 
+/*
+ * Prints the members of the payload field `main_field` which the
+ * `fields` parameter selects, as a structure.
+ */
+static
+int print_payload_members(struct pretty_component *pretty,
+		const bt_field *main_field, const GPtrArray *members)
+{
+	int ret = 0;
+	guint i;
+
+	bt_common_g_string_append(pretty->string, "{");
+	pretty->depth++;
+
+	for (i = 0; i < members->len; i++) {
+		const struct projected_member *member =
+			g_ptr_array_index(members, i);
+		const bt_field *field = main_field;
+		guint level;
+
+		for (level = 0; level < member->indexes->len; level++) {
+			field = bt_field_structure_borrow_member_field_by_index_const(
+				field, g_array_index(member->indexes,
+					uint64_t, level));
+		}
+
+		g_string_append_len(pretty->string, member->prefix->str,
+			member->prefix->len);
+		ret = print_field(pretty, field,
+			pretty->options.print_payload_field_names);
+		if (ret != 0) {
+			goto end;
+		}
+	}
+
+	pretty->depth--;
+	bt_common_g_string_append(pretty->string, " }");
+
+end:
+	return ret;
+}
+
 static
 int print_event_payload(struct pretty_component *pretty,
 		const bt_event *event)
 {
 	int ret = 0;
 	const bt_field *main_field = NULL;
+	const GPtrArray *members = NULL;
 
 	main_field = bt_event_borrow_payload_field_const(event);
 	if (!main_field) {
 		goto end;
 	}
+
+	if (pretty->options.fields) {
+		struct event_class_template *template =
+			borrow_event_class_template(pretty,
+				bt_event_borrow_class_const(event));
+
+		if (!template) {
+			ret = -1;
+			goto end;
+		}
+
+		members = template->payload_members;
+		if (members->len == 0) {
+			/* Nothing selected for this event class */
+			goto end;
+		}
+	}
+
 	if (!pretty->start_line) {
 		bt_common_g_string_append(pretty->string, ", ");
 	}
@@ -1131,8 +1841,13 @@ int print_event_payload(struct pretty_component *pretty,
 	if (pretty->options.print_scope_field_names) {
 		print_name_equal(pretty, "event.fields");
 	}
-	ret = print_field(pretty, main_field,
-			pretty->options.print_payload_field_names);
+
+	if (members) {
+		ret = print_payload_members(pretty, main_field, members);
+	} else {
+		ret = print_field(pretty, main_field,
+				pretty->options.print_payload_field_names);
+	}
 
 end:
 	return ret;
@@ -1151,12 +1866,32 @@ int flush_buf(FILE *stream, struct pretty_component *pretty)
 		ret = -1;
 	}
 
+	g_string_truncate(pretty->string, 0);
+
 end:
 	return ret;
 }
 
 BT_HIDDEN
-int pretty_print_event(struct pretty_component *pretty,
+int pretty_flush(struct pretty_component *pretty)
+{
+	int ret;
+
+	ret = flush_buf(pretty->out, pretty);
+	if (ret) {
+		goto end;
+	}
+
+	if (fflush(pretty->out)) {
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_format_event(struct pretty_component *pretty,
 		const bt_message *event_msg)
 {
 	int ret;
@@ -1165,7 +1900,6 @@ int pretty_print_event(struct pretty_component *pretty,
 
 	BT_ASSERT_DBG(event);
 	pretty->start_line = true;
-	g_string_assign(pretty->string, "");
 	ret = print_event_header(pretty, event_msg);
 	if (ret != 0) {
 		goto end;
@@ -1192,11 +1926,47 @@ int pretty_print_event(struct pretty_component *pretty,
 	}
 
 	bt_common_g_string_append_c(pretty->string, '\n');
-	if (flush_buf(pretty->out, pretty)) {
-		ret = -1;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_flush_if_full(struct pretty_component *pretty)
+{
+	int ret = 0;
+
+	/*
+	 * Keep accumulating the printed events into the same buffer
+	 * until it reaches the configured size: pretty_consume() writes
+	 * whatever remains when the upstream iterator has nothing more
+	 * to offer for now.
+	 */
+	if (pretty->string->len >= pretty->options.output_buffer_size) {
+		ret = flush_buf(pretty->out, pretty);
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+int pretty_print_event(struct pretty_component *pretty,
+		const bt_message *event_msg)
+{
+	int ret;
+
+	ret = pretty_prepare_event(pretty, event_msg);
+	if (ret) {
+		goto end;
+	}
+
+	ret = pretty_format_event(pretty, event_msg);
+	if (ret) {
 		goto end;
 	}
 
+	ret = pretty_flush_if_full(pretty);
+
 end:
 	return ret;
 }
@@ -1243,8 +2013,16 @@ int print_discarded_elements_msg(struct pretty_component *pretty,
 	/* Trace UUID */
 	trace_uuid = bt_trace_get_uuid(trace);
 
+	/*
+	 * Write the events printed so far first to keep the warning
+	 * where it belongs relative to them.
+	 */
+	if (flush_buf(pretty->out, pretty)) {
+		ret = -1;
+		goto end;
+	}
+
 	/* Format message */
-	g_string_assign(pretty->string, "");
 
 	if (count == UINT64_C(-1)) {
 		init_msg = "Tracer may have discarded";
@@ -1311,6 +2089,7 @@ int print_discarded_elements_msg(struct pretty_component *pretty,
 		ret = -1;
 	}
 
+end:
 	return ret;
 }
 
@@ -0,0 +1,1037 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (aggregate->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (aggregate->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.UTILS.AGGREGATE"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/common.h"
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "aggregate.h"
+
+/* Field path of `struct common_field_path` for a given event class */
+struct aggregate_resolved_field_path {
+	/* False if the field path doesn't exist for this event class */
+	bool exists;
+
+	struct common_resolved_field_path path;
+};
+
+/* Cached properties of an event class */
+struct aggregate_event_class {
+	/* Owned by this */
+	const bt_event_class *ec;
+
+	/*
+	 * Arrays of `struct aggregate_resolved_field_path`, one element
+	 * per element of `aggregate->group_by` and of
+	 * `aggregate->value_fields`
+	 */
+	GArray *group_by;
+	GArray *value_fields;
+
+	/*
+	 * Index, within `aggregate->latency_pairs`, of the first pair
+	 * of which this event class is the entry or the exit, or -1
+	 */
+	gint entry_pair_index;
+	gint exit_pair_index;
+};
+
+static
+const char * const in_port_name = "in";
+
+static
+void destroy_field_paths(GArray *field_paths)
+{
+	guint i;
+
+	if (!field_paths) {
+		return;
+	}
+
+	for (i = 0; i < field_paths->len; i++) {
+		common_field_path_fini(&g_array_index(field_paths,
+			struct common_field_path, i));
+	}
+
+	g_array_free(field_paths, TRUE);
+}
+
+static
+void destroy_latency_pairs(GArray *latency_pairs)
+{
+	guint i;
+
+	if (!latency_pairs) {
+		return;
+	}
+
+	for (i = 0; i < latency_pairs->len; i++) {
+		struct aggregate_latency_pair *pair = &g_array_index(
+			latency_pairs, struct aggregate_latency_pair, i);
+
+		g_free(pair->entry_name);
+		g_free(pair->exit_name);
+	}
+
+	g_array_free(latency_pairs, TRUE);
+}
+
+static
+void destroy_resolved_field_paths(GArray *resolved_paths)
+{
+	guint i;
+
+	for (i = 0; i < resolved_paths->len; i++) {
+		common_resolved_field_path_fini(&g_array_index(
+			resolved_paths, struct aggregate_resolved_field_path,
+			i).path);
+	}
+
+	g_array_free(resolved_paths, TRUE);
+}
+
+static
+void destroy_aggregate_event_class(struct aggregate_event_class *agg_ec)
+{
+	bt_event_class_put_ref(agg_ec->ec);
+	destroy_resolved_field_paths(agg_ec->group_by);
+	destroy_resolved_field_paths(agg_ec->value_fields);
+	g_free(agg_ec);
+}
+
+static
+void destroy_entry(struct aggregate_entry *entry)
+{
+	uint64_t i;
+
+	for (i = 0; i < entry->hist_count; i++) {
+		g_free(entry->hists[i].buckets);
+	}
+
+	g_free(entry->hists);
+	g_free(entry);
+}
+
+static
+void destroy_private_aggregate_data(struct aggregate *aggregate)
+{
+	bt_message_iterator_put_ref(aggregate->msg_iter);
+	destroy_field_paths(aggregate->group_by);
+	destroy_field_paths(aggregate->value_fields);
+	destroy_latency_pairs(aggregate->latency_pairs);
+
+	if (aggregate->event_classes) {
+		g_hash_table_destroy(aggregate->event_classes);
+	}
+
+	if (aggregate->event_entries) {
+		g_hash_table_destroy(aggregate->event_entries);
+	}
+
+	if (aggregate->latency_entries) {
+		g_hash_table_destroy(aggregate->latency_entries);
+	}
+
+	if (aggregate->pending_entries) {
+		g_hash_table_destroy(aggregate->pending_entries);
+	}
+
+	if (aggregate->key_buf) {
+		g_string_free(aggregate->key_buf, TRUE);
+	}
+
+	if (aggregate->group_buf) {
+		g_string_free(aggregate->group_buf, TRUE);
+	}
+
+	g_free(aggregate);
+}
+
+static inline
+uint64_t hist_bucket_index(uint64_t value)
+{
+	unsigned int shift;
+
+	if (value < AGGREGATE_HIST_SUB_BUCKET_COUNT) {
+		return value;
+	}
+
+	shift = 63 - __builtin_clzll(value) - AGGREGATE_HIST_SUB_BUCKET_BITS;
+	return (uint64_t) (shift + 1) * AGGREGATE_HIST_SUB_BUCKET_COUNT +
+		((value >> shift) & (AGGREGATE_HIST_SUB_BUCKET_COUNT - 1));
+}
+
+/* Returns the greatest value of which the bucket is `index` */
+static
+uint64_t hist_bucket_max_value(uint64_t index)
+{
+	uint64_t next = index + 1;
+	unsigned int shift;
+
+	if (next == AGGREGATE_HIST_BUCKET_COUNT) {
+		return UINT64_MAX;
+	}
+
+	if (next < AGGREGATE_HIST_SUB_BUCKET_COUNT) {
+		return index;
+	}
+
+	shift = next / AGGREGATE_HIST_SUB_BUCKET_COUNT - 1;
+	return ((AGGREGATE_HIST_SUB_BUCKET_COUNT +
+		next % AGGREGATE_HIST_SUB_BUCKET_COUNT) << shift) - 1;
+}
+
+static inline
+void hist_record(struct aggregate_histogram *hist, double value)
+{
+	uint64_t index;
+
+	if (hist->count == 0) {
+		hist->min = value;
+		hist->max = value;
+	} else if (value < hist->min) {
+		hist->min = value;
+	} else if (value > hist->max) {
+		hist->max = value;
+	}
+
+	hist->count++;
+	hist->sum += value;
+
+	/* Buckets are for the integral part of nonnegative values */
+	if (!(value > 0)) {
+		index = 0;
+	} else if (value >= 18446744073709551615.0) {
+		index = AGGREGATE_HIST_BUCKET_COUNT - 1;
+	} else {
+		index = hist_bucket_index((uint64_t) value);
+	}
+
+	if (G_UNLIKELY(index >= hist->bucket_count)) {
+		hist->buckets = g_renew(uint64_t, hist->buckets, index + 1);
+		memset(&hist->buckets[hist->bucket_count], 0,
+			(index + 1 - hist->bucket_count) * sizeof(uint64_t));
+		hist->bucket_count = index + 1;
+	}
+
+	hist->buckets[index]++;
+}
+
+/*
+ * Returns the value under which (inclusively) `quantile` (0 to 1) of
+ * the values of `hist` are, within the precision of its buckets.
+ */
+static
+double hist_quantile(const struct aggregate_histogram *hist, double quantile)
+{
+	double exact_target = quantile * (double) hist->count;
+	uint64_t target = (uint64_t) exact_target;
+	uint64_t total = 0;
+	double value = hist->max;
+	uint64_t i;
+
+	if ((double) target < exact_target || target == 0) {
+		target++;
+	}
+
+	for (i = 0; i < hist->bucket_count; i++) {
+		total += hist->buckets[i];
+
+		if (total >= target) {
+			value = (double) hist_bucket_max_value(i);
+			break;
+		}
+	}
+
+	if (value > hist->max) {
+		value = hist->max;
+	} else if (value < hist->min) {
+		value = hist->min;
+	}
+
+	return value;
+}
+
+static
+struct bt_param_validation_value_descr field_path_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
+static
+struct bt_param_validation_value_descr latency_pair_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
+static
+struct bt_param_validation_value_descr latency_pairs_elem_descr = {
+	BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 2,
+		.max_length = 2,
+		.element_type = &latency_pair_elem_descr,
+	}
+};
+
+static
+struct bt_param_validation_map_value_entry_descr aggregate_params[] = {
+	{ "group-by", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &field_path_elem_descr,
+	} } },
+	{ "value-fields", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &field_path_elem_descr,
+	} } },
+	{ "latency-pairs", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &latency_pairs_elem_descr,
+	} } },
+	{ "period", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+int parse_field_paths(struct aggregate *aggregate, const bt_value *value,
+		GArray **field_paths)
+{
+	int ret = 0;
+	uint64_t i;
+
+	*field_paths = g_array_new(FALSE, TRUE,
+		sizeof(struct common_field_path));
+
+	if (!value) {
+		goto end;
+	}
+
+	for (i = 0; i < bt_value_array_get_length(value); i++) {
+		const char *str = bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(value, i));
+		struct common_field_path field_path = { 0 };
+
+		if (!common_field_path_parse(str, &field_path)) {
+			BT_COMP_LOGE_APPEND_CAUSE(aggregate->self_comp,
+				"Invalid field path: path=\"%s\"", str);
+			ret = -1;
+			goto end;
+		}
+
+		g_array_append_val(*field_paths, field_path);
+	}
+
+end:
+	return ret;
+}
+
+static
+bt_component_class_initialize_method_status handle_params(
+		struct aggregate *aggregate, const bt_value *params)
+{
+	bt_component_class_initialize_method_status status =
+		BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	const bt_value *value;
+	uint64_t i;
+
+	if (parse_field_paths(aggregate,
+			bt_value_map_borrow_entry_value_const(params, "group-by"),
+			&aggregate->group_by)) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (parse_field_paths(aggregate,
+			bt_value_map_borrow_entry_value_const(params,
+				"value-fields"), &aggregate->value_fields)) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	aggregate->latency_pairs = g_array_new(FALSE, TRUE,
+		sizeof(struct aggregate_latency_pair));
+	value = bt_value_map_borrow_entry_value_const(params, "latency-pairs");
+	if (value) {
+		for (i = 0; i < bt_value_array_get_length(value); i++) {
+			const bt_value *pair_value =
+				bt_value_array_borrow_element_by_index_const(
+					value, i);
+			struct aggregate_latency_pair pair;
+
+			pair.entry_name = g_strdup(bt_value_string_get(
+				bt_value_array_borrow_element_by_index_const(
+					pair_value, 0)));
+			pair.exit_name = g_strdup(bt_value_string_get(
+				bt_value_array_borrow_element_by_index_const(
+					pair_value, 1)));
+			g_array_append_val(aggregate->latency_pairs, pair);
+		}
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "period");
+	if (value) {
+		aggregate->period = bt_value_integer_unsigned_get(value);
+	}
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status aggregate_init(
+		bt_self_component_sink *self_comp_sink,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params,
+		__attribute__((unused)) void *init_method_data)
+{
+	bt_component_class_initialize_method_status status;
+	bt_self_component_add_port_status add_port_status;
+	struct aggregate *aggregate = g_new0(struct aggregate, 1);
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+
+	if (!aggregate) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	aggregate->self_comp =
+		bt_self_component_sink_as_self_component(self_comp_sink);
+	aggregate->log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(aggregate->self_comp));
+	add_port_status = bt_self_component_sink_add_input_port(
+		self_comp_sink, in_port_name, NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	validation_status = bt_param_validation_validate(params,
+		aggregate_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(aggregate->self_comp,
+			"%s", validate_error);
+		goto error;
+	}
+
+	status = handle_params(aggregate, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
+	aggregate->event_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL,
+		(GDestroyNotify) destroy_aggregate_event_class);
+	aggregate->event_entries = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, (GDestroyNotify) destroy_entry);
+	aggregate->latency_entries = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, (GDestroyNotify) destroy_entry);
+	aggregate->pending_entries = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, (GDestroyNotify) g_hash_table_destroy);
+	aggregate->key_buf = g_string_new(NULL);
+	aggregate->group_buf = g_string_new(NULL);
+	bt_self_component_set_data(aggregate->self_comp, aggregate);
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_private_aggregate_data(aggregate);
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+aggregate_graph_is_configured(bt_self_component_sink *comp)
+{
+	bt_component_class_sink_graph_is_configured_method_status status;
+	bt_message_iterator_create_from_sink_component_status
+		msg_iter_status;
+	struct aggregate *aggregate;
+	bt_message_iterator *iterator;
+
+	aggregate = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT(aggregate);
+	msg_iter_status = bt_message_iterator_create_from_sink_component(
+		comp, bt_self_component_sink_borrow_input_port_by_name(comp,
+			in_port_name), &iterator);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_SINK_COMPONENT_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto end;
+	}
+
+	BT_MESSAGE_ITERATOR_MOVE_REF(aggregate->msg_iter, iterator);
+	status = BT_COMPONENT_CLASS_SINK_GRAPH_IS_CONFIGURED_METHOD_STATUS_OK;
+
+end:
+	return status;
+}
+
+/*
+ * Resolves the field paths `field_paths` for the event class `ec`.
+ */
+static
+GArray *resolve_field_paths(const bt_event_class *ec, GArray *field_paths)
+{
+	GArray *resolved_paths = g_array_new(FALSE, FALSE,
+		sizeof(struct aggregate_resolved_field_path));
+	guint i;
+
+	for (i = 0; i < field_paths->len; i++) {
+		struct aggregate_resolved_field_path resolved_path;
+
+		resolved_path.exists = common_field_path_resolve(
+			&g_array_index(field_paths, struct common_field_path, i),
+			ec, &resolved_path.path);
+		g_array_append_val(resolved_paths, resolved_path);
+	}
+
+	return resolved_paths;
+}
+
+static
+gint find_latency_pair(struct aggregate *aggregate, const char *name,
+		bool entry)
+{
+	guint i;
+
+	if (!name) {
+		goto end;
+	}
+
+	for (i = 0; i < aggregate->latency_pairs->len; i++) {
+		struct aggregate_latency_pair *pair = &g_array_index(
+			aggregate->latency_pairs,
+			struct aggregate_latency_pair, i);
+
+		if (strcmp(entry ? pair->entry_name : pair->exit_name,
+				name) == 0) {
+			return (gint) i;
+		}
+	}
+
+end:
+	return -1;
+}
+
+static
+struct aggregate_event_class *borrow_aggregate_event_class(
+		struct aggregate *aggregate, const bt_event_class *ec)
+{
+	struct aggregate_event_class *agg_ec;
+
+	if (G_LIKELY(ec == aggregate->last_ec)) {
+		agg_ec = aggregate->last_agg_ec;
+		goto end;
+	}
+
+	agg_ec = g_hash_table_lookup(aggregate->event_classes, ec);
+	if (!agg_ec) {
+		const char *name = bt_event_class_get_name(ec);
+
+		agg_ec = g_new0(struct aggregate_event_class, 1);
+		agg_ec->ec = ec;
+		bt_event_class_get_ref(ec);
+		agg_ec->group_by = resolve_field_paths(ec,
+			aggregate->group_by);
+		agg_ec->value_fields = resolve_field_paths(ec,
+			aggregate->value_fields);
+		agg_ec->entry_pair_index = find_latency_pair(aggregate, name,
+			true);
+		agg_ec->exit_pair_index = find_latency_pair(aggregate, name,
+			false);
+		g_hash_table_insert(aggregate->event_classes, (gpointer) ec,
+			agg_ec);
+	}
+
+	/* The entry owns its event class, so comparing addresses is safe */
+	aggregate->last_ec = ec;
+	aggregate->last_agg_ec = agg_ec;
+
+end:
+	return agg_ec;
+}
+
+static
+const bt_field *borrow_field(const bt_event *event,
+		const struct aggregate_resolved_field_path *resolved_path)
+{
+	if (!resolved_path->exists) {
+		return NULL;
+	}
+
+	return common_field_path_borrow_field(event, &resolved_path->path);
+}
+
+static
+void append_field_value(GString *str, const bt_field *field)
+{
+	bt_field_class_type type;
+
+	if (!field) {
+		g_string_append(str, "(none)");
+		return;
+	}
+
+	type = bt_field_get_class_type(field);
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		g_string_append(str, bt_field_bool_get_value(field) ?
+			"true" : "false");
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		g_string_append_printf(str, "0x%" PRIx64,
+			bt_field_bit_array_get_value_as_integer(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		g_string_append_printf(str, "%" PRIu64,
+			bt_field_integer_unsigned_get_value(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		g_string_append_printf(str, "%" PRId64,
+			bt_field_integer_signed_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		g_string_append_printf(str, "%g",
+			(double) bt_field_real_single_precision_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		g_string_append_printf(str, "%g",
+			bt_field_real_double_precision_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		g_string_append_printf(str, "\"%s\"",
+			bt_field_string_get_value(field));
+	} else {
+		g_string_append(str, "(unsupported)");
+	}
+}
+
+/*
+ * Returns whether or not `field` is a numeric field, setting `*value`
+ * to its value if so.
+ */
+static
+bool get_numeric_field_value(const bt_field *field, double *value)
+{
+	bt_field_class_type type;
+
+	if (!field) {
+		return false;
+	}
+
+	type = bt_field_get_class_type(field);
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		*value = bt_field_bool_get_value(field) ? 1 : 0;
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		*value = (double) bt_field_integer_unsigned_get_value(field);
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		*value = (double) bt_field_integer_signed_get_value(field);
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		*value = bt_field_real_single_precision_get_value(field);
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		*value = bt_field_real_double_precision_get_value(field);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Sets `aggregate->group_buf` to the printable group of `event`, from
+ * the `group-by` parameter.
+ */
+static
+void build_group(struct aggregate *aggregate,
+		struct aggregate_event_class *agg_ec, const bt_event *event)
+{
+	GString *group = aggregate->group_buf;
+	guint i;
+
+	g_string_truncate(group, 0);
+
+	if (agg_ec->group_by->len == 0) {
+		return;
+	}
+
+	g_string_append(group, " {");
+
+	for (i = 0; i < agg_ec->group_by->len; i++) {
+		if (i > 0) {
+			g_string_append(group, ", ");
+		}
+
+		g_string_append_printf(group, "%s=",
+			g_array_index(aggregate->group_by,
+				struct common_field_path, i).str);
+		append_field_value(group, borrow_field(event,
+			&g_array_index(agg_ec->group_by,
+				struct aggregate_resolved_field_path, i)));
+	}
+
+	g_string_append_c(group, '}');
+}
+
+static
+struct aggregate_entry *borrow_entry(GHashTable *entries, const gchar *key,
+		uint64_t hist_count)
+{
+	struct aggregate_entry *entry = g_hash_table_lookup(entries, key);
+
+	if (!entry) {
+		gchar *owned_key = g_strdup(key);
+
+		entry = g_new0(struct aggregate_entry, 1);
+		entry->key = owned_key;
+		entry->hists = g_new0(struct aggregate_histogram, hist_count);
+		entry->hist_count = hist_count;
+		g_hash_table_insert(entries, owned_key, entry);
+	}
+
+	return entry;
+}
+
+/*
+ * Records the entry event `event` of the latency pair
+ * `pair_index`, or, for an exit event, the latency since the last
+ * matching entry event.
+ */
+static
+void handle_latency(struct aggregate *aggregate, const bt_message *msg,
+		const bt_event *event, gint pair_index, bool entry)
+{
+	const bt_stream *stream = bt_event_borrow_stream_const(event);
+	struct aggregate_latency_pair *pair = &g_array_index(
+		aggregate->latency_pairs, struct aggregate_latency_pair,
+		pair_index);
+	GHashTable *pending;
+	int64_t ns_from_origin;
+	int64_t *entry_ns;
+
+	if (!bt_message_event_borrow_stream_class_default_clock_class_const(
+			msg)) {
+		return;
+	}
+
+	if (bt_clock_snapshot_get_ns_from_origin(
+			bt_message_event_borrow_default_clock_snapshot_const(msg),
+			&ns_from_origin) !=
+			BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+		return;
+	}
+
+	/* Pending key: pair index and group */
+	g_string_printf(aggregate->key_buf, "%d%s", pair_index,
+		aggregate->group_buf->str);
+	pending = g_hash_table_lookup(aggregate->pending_entries, stream);
+
+	if (entry) {
+		if (!pending) {
+			pending = g_hash_table_new_full(g_str_hash,
+				g_str_equal, g_free, g_free);
+			g_hash_table_insert(aggregate->pending_entries,
+				(gpointer) stream, pending);
+		}
+
+		entry_ns = g_hash_table_lookup(pending,
+			aggregate->key_buf->str);
+		if (!entry_ns) {
+			entry_ns = g_new(int64_t, 1);
+			g_hash_table_insert(pending,
+				g_strdup(aggregate->key_buf->str), entry_ns);
+		}
+
+		/* A new entry event replaces an unmatched one */
+		*entry_ns = ns_from_origin;
+	} else {
+		struct aggregate_entry *agg_entry;
+		int64_t latency;
+
+		if (!pending) {
+			return;
+		}
+
+		entry_ns = g_hash_table_lookup(pending,
+			aggregate->key_buf->str);
+		if (!entry_ns) {
+			/* No matching entry event */
+			return;
+		}
+
+		latency = ns_from_origin - *entry_ns;
+		g_hash_table_remove(pending, aggregate->key_buf->str);
+		g_string_printf(aggregate->key_buf, "`%s` -> `%s`%s",
+			pair->entry_name, pair->exit_name,
+			aggregate->group_buf->str);
+		agg_entry = borrow_entry(aggregate->latency_entries,
+			aggregate->key_buf->str, 1);
+		agg_entry->count++;
+		hist_record(&agg_entry->hists[0], (double) latency);
+	}
+}
+
+static
+void handle_event_msg(struct aggregate *aggregate, const bt_message *msg)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_event_class *ec = bt_event_borrow_class_const(event);
+	struct aggregate_event_class *agg_ec =
+		borrow_aggregate_event_class(aggregate, ec);
+	struct aggregate_entry *entry;
+	const char *name = bt_event_class_get_name(ec);
+	guint i;
+
+	build_group(aggregate, agg_ec, event);
+
+	if (name) {
+		g_string_printf(aggregate->key_buf, "`%s`%s", name,
+			aggregate->group_buf->str);
+	} else {
+		g_string_printf(aggregate->key_buf,
+			"unnamed (event class ID %" PRIu64 ", stream class ID %" PRIu64 ")%s",
+			bt_event_class_get_id(ec),
+			bt_stream_class_get_id(
+				bt_event_class_borrow_stream_class_const(ec)),
+			aggregate->group_buf->str);
+	}
+
+	entry = borrow_entry(aggregate->event_entries,
+		aggregate->key_buf->str, agg_ec->value_fields->len);
+	entry->count++;
+
+	for (i = 0; i < agg_ec->value_fields->len; i++) {
+		double value;
+
+		if (get_numeric_field_value(borrow_field(event,
+				&g_array_index(agg_ec->value_fields,
+					struct aggregate_resolved_field_path, i)),
+				&value)) {
+			hist_record(&entry->hists[i], value);
+		}
+	}
+
+	if (agg_ec->exit_pair_index >= 0) {
+		handle_latency(aggregate, msg, event, agg_ec->exit_pair_index,
+			false);
+	}
+
+	if (agg_ec->entry_pair_index >= 0) {
+		handle_latency(aggregate, msg, event,
+			agg_ec->entry_pair_index, true);
+	}
+}
+
+static
+void print_value(const char *name, double value)
+{
+	if (value > -1e18 && value < 1e18 &&
+			(double) (int64_t) value == value) {
+		printf(" %s=%.0f", name, value);
+	} else {
+		printf(" %s=%g", name, value);
+	}
+}
+
+static
+void print_hist(const struct aggregate_histogram *hist)
+{
+	printf(" count=%" PRIu64, hist->count);
+	print_value("min", hist->min);
+	print_value("mean", hist->sum / (double) hist->count);
+	print_value("max", hist->max);
+	print_value("p50", hist_quantile(hist, 0.5));
+	print_value("p90", hist_quantile(hist, 0.9));
+	print_value("p99", hist_quantile(hist, 0.99));
+	print_value("p99.9", hist_quantile(hist, 0.999));
+	putchar('\n');
+}
+
+static
+gint compare_entries(gconstpointer a, gconstpointer b)
+{
+	const struct aggregate_entry *entry_a =
+		*(const struct aggregate_entry **) a;
+	const struct aggregate_entry *entry_b =
+		*(const struct aggregate_entry **) b;
+
+	return strcmp(entry_a->key, entry_b->key);
+}
+
+/* Returns the entries of `entries`, sorted by key */
+static
+GPtrArray *sorted_entries(GHashTable *entries)
+{
+	GPtrArray *array = g_ptr_array_sized_new(g_hash_table_size(entries));
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init(&iter, entries);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		g_ptr_array_add(array, value);
+	}
+
+	g_ptr_array_sort(array, compare_entries);
+	return array;
+}
+
+static
+void print_results(struct aggregate *aggregate)
+{
+	GPtrArray *entries;
+	guint i;
+	uint64_t j;
+
+	entries = sorted_entries(aggregate->event_entries);
+	printf("Events\n");
+
+	for (i = 0; i < entries->len; i++) {
+		const struct aggregate_entry *entry = entries->pdata[i];
+
+		printf("%15" PRIu64 " %s\n", entry->count, entry->key);
+
+		for (j = 0; j < entry->hist_count; j++) {
+			if (entry->hists[j].count == 0) {
+				continue;
+			}
+
+			printf("                    %s:",
+				g_array_index(aggregate->value_fields,
+					struct common_field_path, j).str);
+			print_hist(&entry->hists[j]);
+		}
+	}
+
+	g_ptr_array_free(entries, TRUE);
+
+	if (aggregate->latency_pairs->len == 0) {
+		goto end;
+	}
+
+	entries = sorted_entries(aggregate->latency_entries);
+	printf("\nLatencies (ns)\n");
+
+	for (i = 0; i < entries->len; i++) {
+		const struct aggregate_entry *entry = entries->pdata[i];
+
+		printf("%15s %s:", "", entry->key);
+		print_hist(&entry->hists[0]);
+	}
+
+	g_ptr_array_free(entries, TRUE);
+
+end:
+	fflush(stdout);
+}
+
+static
+void try_print_last(struct aggregate *aggregate)
+{
+	if (!aggregate->printed_last) {
+		print_results(aggregate);
+		aggregate->printed_last = true;
+	}
+}
+
+BT_HIDDEN
+void aggregate_finalize(bt_self_component_sink *comp)
+{
+	struct aggregate *aggregate;
+
+	BT_ASSERT(comp);
+	aggregate = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT(aggregate);
+	try_print_last(aggregate);
+	destroy_private_aggregate_data(aggregate);
+}
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status aggregate_consume(
+		bt_self_component_sink *comp)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	struct aggregate *aggregate;
+	bt_message_iterator_next_status next_status;
+	uint64_t msg_count;
+	bt_message_array_const msgs;
+	uint64_t i;
+
+	aggregate = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT_DBG(aggregate);
+
+	if (G_UNLIKELY(!aggregate->msg_iter)) {
+		try_print_last(aggregate);
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
+		goto end;
+	}
+
+	next_status = bt_message_iterator_next(aggregate->msg_iter, &msgs,
+		&msg_count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		try_print_last(aggregate);
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
+		goto end;
+	default:
+		status = (int) next_status;
+		goto end;
+	}
+
+	for (i = 0; i < msg_count; i++) {
+		const bt_message *msg = msgs[i];
+
+		switch (bt_message_get_type(msg)) {
+		case BT_MESSAGE_TYPE_EVENT:
+			handle_event_msg(aggregate, msg);
+
+			if (aggregate->period > 0) {
+				aggregate->at++;
+
+				if (aggregate->at >= aggregate->period) {
+					print_results(aggregate);
+					putchar('\n');
+					aggregate->at = 0;
+				}
+			}
+
+			break;
+		case BT_MESSAGE_TYPE_STREAM_END:
+			/* Forget the unmatched entry events of this stream */
+			g_hash_table_remove(aggregate->pending_entries,
+				bt_message_stream_end_borrow_stream_const(msg));
+			break;
+		default:
+			break;
+		}
+
+		bt_message_put_ref(msg);
+	}
+
+end:
+	return status;
+}
@@ -0,0 +1,133 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_UTILS_AGGREGATE_H
+#define BABELTRACE_PLUGINS_UTILS_AGGREGATE_H
+
+#include <glib.h>
+#include <babeltrace2/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "common/macros.h"
+#include "plugins/common/field-path/field-path.h"
+
+/*
+ * Histograms are log-linear (HDR-style): the values under
+ * 2^AGGREGATE_HIST_SUB_BUCKET_BITS have their own bucket, and each
+ * following power of two range is split into
+ * 2^AGGREGATE_HIST_SUB_BUCKET_BITS buckets, so that the relative error
+ * of a bucket is at most 1/2^AGGREGATE_HIST_SUB_BUCKET_BITS.
+ */
+#define AGGREGATE_HIST_SUB_BUCKET_BITS	4
+#define AGGREGATE_HIST_SUB_BUCKET_COUNT	(1 << AGGREGATE_HIST_SUB_BUCKET_BITS)
+#define AGGREGATE_HIST_BUCKET_COUNT	\
+	((64 - AGGREGATE_HIST_SUB_BUCKET_BITS + 1) * AGGREGATE_HIST_SUB_BUCKET_COUNT)
+
+/* Entry and exit event class names, as given with `latency-pairs` */
+struct aggregate_latency_pair {
+	gchar *entry_name;
+	gchar *exit_name;
+};
+
+struct aggregate_histogram {
+	uint64_t count;
+	double min;
+	double max;
+	double sum;
+
+	/*
+	 * Counts of the buckets, allocated up to the last nonempty
+	 * bucket only (`bucket_count` elements), or `NULL` if `count`
+	 * is 0
+	 */
+	uint64_t *buckets;
+	uint64_t bucket_count;
+};
+
+/* Results for one key (event class or latency pair, and group) */
+struct aggregate_entry {
+	/* Printable key (owned by the hash table) */
+	const gchar *key;
+
+	/* Number of events or of entry/exit pairs */
+	uint64_t count;
+
+	/*
+	 * One histogram per value field for an event class entry, or
+	 * a single latency (ns) histogram for a latency pair entry
+	 */
+	struct aggregate_histogram *hists;
+	uint64_t hist_count;
+};
+
+struct aggregate {
+	bt_message_iterator *msg_iter;
+
+	/*
+	 * Arrays of `struct common_field_path`, as given with the
+	 * `group-by` and `value-fields` parameters
+	 */
+	GArray *group_by;
+	GArray *value_fields;
+
+	/* Array of `struct aggregate_latency_pair` */
+	GArray *latency_pairs;
+
+	/* Print the results every `period` events if not 0, and at end */
+	uint64_t period;
+	uint64_t at;
+	bool printed_last;
+
+	/*
+	 * Event class (owned) -> `struct aggregate_event_class *`
+	 * (owned): resolved field paths and latency pair roles
+	 */
+	GHashTable *event_classes;
+
+	/* Last looked up event class and its entry (weak) */
+	const bt_event_class *last_ec;
+	struct aggregate_event_class *last_agg_ec;
+
+	/*
+	 * `gchar *` key (owned) -> `struct aggregate_entry *` (owned),
+	 * for event classes and for latency pairs
+	 */
+	GHashTable *event_entries;
+	GHashTable *latency_entries;
+
+	/*
+	 * Stream (weak, removed at stream end) -> `GHashTable *` of
+	 * pending entry events: `gchar *` key (owned) -> `int64_t *`
+	 * time (ns from origin, owned)
+	 */
+	GHashTable *pending_entries;
+
+	/* Reused to build keys */
+	GString *key_buf;
+	GString *group_buf;
+
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+};
+
+BT_HIDDEN
+bt_component_class_initialize_method_status aggregate_init(
+		bt_self_component_sink *component,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void aggregate_finalize(bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status aggregate_graph_is_configured(
+		bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status aggregate_consume(
+		bt_self_component_sink *component);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_AGGREGATE_H */
@@ -0,0 +1,239 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_FORMAT_H
+#define BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_FORMAT_H
+
+/*
+ * Message cache file format, written by `sink.utils.cache` and read
+ * by `source.utils.cache`.
+ *
+ * A cache file is the `CACHE_FORMAT_MAGIC` bytes, the format version
+ * (`CACHE_FORMAT_VERSION`, one byte), and then a sequence of records.
+ *
+ * A record is its type (`enum cache_record_type`, one byte), the size
+ * of its payload (unsigned LEB128), and its payload. Knowing the size
+ * of each record makes it possible to skip the metadata records
+ * without decoding them when replaying the file again.
+ *
+ * Within a payload:
+ *
+ * * Unsigned integers are unsigned LEB128 ("uvarint").
+ *
+ * * Signed integers are zigzag-encoded, then unsigned LEB128
+ *   ("svarint").
+ *
+ * * Flags and booleans are single bytes.
+ *
+ * * Real numbers are their IEEE 754 bits, little-endian (4 bytes for
+ *   single precision, 8 bytes for double precision).
+ *
+ * * A string is its length in bytes (uvarint), its bytes, and a null
+ *   byte, so that the reader can use it in place.
+ *
+ * * An optional string or field class is a presence flag followed,
+ *   if it's 1, by the string or field class.
+ *
+ * * A UUID is 16 raw bytes.
+ *
+ * Metadata objects (clock classes, trace classes, traces, stream
+ * classes, event classes, and streams) are written once, before the
+ * first record which refers to them, with a per-type ID which is the
+ * number of objects of this type defined before. Message records refer
+ * to metadata objects by ID.
+ *
+ * The last record of a complete file is `CACHE_RECORD_TYPE_END`.
+ */
+
+#define CACHE_FORMAT_MAGIC		"BTMC"
+#define CACHE_FORMAT_MAGIC_LEN		4
+#define CACHE_FORMAT_VERSION		1
+
+enum cache_record_type {
+	/*
+	 * Optional name (string), optional description (string),
+	 * frequency (uvarint), offset in seconds (svarint), offset in
+	 * cycles (uvarint), precision (uvarint), origin is Unix epoch
+	 * (flag), has UUID (flag) and UUID.
+	 */
+	CACHE_RECORD_TYPE_CLOCK_CLASS = 1,
+
+	/* Empty */
+	CACHE_RECORD_TYPE_TRACE_CLASS,
+
+	/*
+	 * Trace class ID, optional name (string), has UUID (flag) and
+	 * UUID, environment entry count (uvarint), and, for each
+	 * entry, its name (string), type (`enum cache_env_entry_type`,
+	 * one byte), and value (svarint or string).
+	 */
+	CACHE_RECORD_TYPE_TRACE,
+
+	/*
+	 * Trace class ID, stream class ID within its trace class
+	 * (uvarint), optional name (string), has default clock class
+	 * (flag) and clock class ID, `enum cache_stream_class_flag`
+	 * flags (one byte), optional packet context field class,
+	 * optional event common context field class.
+	 */
+	CACHE_RECORD_TYPE_STREAM_CLASS,
+
+	/*
+	 * Stream class ID, event class ID within its stream class
+	 * (uvarint), optional name (string), has log level (flag) and
+	 * log level (uvarint), optional EMF URI (string), optional
+	 * specific context field class, optional payload field class.
+	 */
+	CACHE_RECORD_TYPE_EVENT_CLASS,
+
+	/*
+	 * Trace ID, stream class ID, stream ID within its trace
+	 * (uvarint), optional name (string).
+	 */
+	CACHE_RECORD_TYPE_STREAM,
+
+	/*
+	 * Stream ID, has default clock snapshot (flag) and clock
+	 * snapshot value (uvarint).
+	 */
+	CACHE_RECORD_TYPE_MSG_STREAM_BEGINNING,
+	CACHE_RECORD_TYPE_MSG_STREAM_END,
+
+	/*
+	 * Stream ID, default clock snapshot value (uvarint) if the
+	 * packets of the stream class have one, and packet context
+	 * field if the stream class has a packet context field class
+	 * (beginning only).
+	 */
+	CACHE_RECORD_TYPE_MSG_PACKET_BEGINNING,
+	CACHE_RECORD_TYPE_MSG_PACKET_END,
+
+	/*
+	 * Stream ID, event class ID, default clock snapshot value
+	 * (uvarint) if the stream class has a default clock class, and
+	 * the common context, specific context, and payload fields,
+	 * for the scopes which have a field class.
+	 *
+	 * The event belongs to the current packet of its stream if the
+	 * stream class supports packets.
+	 */
+	CACHE_RECORD_TYPE_MSG_EVENT,
+
+	/*
+	 * Stream ID, beginning and end default clock snapshot values
+	 * (uvarint) if the discarded items messages of the stream
+	 * class have them, has count (flag) and count (uvarint).
+	 */
+	CACHE_RECORD_TYPE_MSG_DISCARDED_EVENTS,
+	CACHE_RECORD_TYPE_MSG_DISCARDED_PACKETS,
+
+	/* Clock class ID, clock snapshot value (uvarint) */
+	CACHE_RECORD_TYPE_MSG_MESSAGE_ITERATOR_INACTIVITY,
+
+	/* Empty */
+	CACHE_RECORD_TYPE_END,
+};
+
+enum cache_env_entry_type {
+	CACHE_ENV_ENTRY_TYPE_INTEGER = 0,
+	CACHE_ENV_ENTRY_TYPE_STRING = 1,
+};
+
+enum cache_stream_class_flag {
+	CACHE_STREAM_CLASS_FLAG_SUPPORTS_PACKETS			= 1 << 0,
+	CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_BEGINNING_CS		= 1 << 1,
+	CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_END_CS			= 1 << 2,
+	CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_EVENTS		= 1 << 3,
+	CACHE_STREAM_CLASS_FLAG_DISCARDED_EVENTS_HAVE_CS		= 1 << 4,
+	CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_PACKETS		= 1 << 5,
+	CACHE_STREAM_CLASS_FLAG_DISCARDED_PACKETS_HAVE_CS		= 1 << 6,
+};
+
+/*
+ * Field class types, one byte, followed by:
+ *
+ * `CACHE_FIELD_CLASS_TYPE_BIT_ARRAY`:
+ *     Length (uvarint).
+ *
+ * `CACHE_FIELD_CLASS_TYPE_UNSIGNED_INTEGER`,
+ * `CACHE_FIELD_CLASS_TYPE_SIGNED_INTEGER`:
+ *     Field value range (uvarint), preferred display base (uvarint).
+ *
+ * `CACHE_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION`,
+ * `CACHE_FIELD_CLASS_TYPE_SIGNED_ENUMERATION`:
+ *     Same as the integer field classes, then the mapping count
+ *     (uvarint), and, for each mapping, its label (string), its range
+ *     count (uvarint), and the lower and upper values of each range
+ *     (uvarint or svarint).
+ *
+ * `CACHE_FIELD_CLASS_TYPE_STATIC_ARRAY`:
+ *     Length (uvarint), element field class.
+ *
+ * `CACHE_FIELD_CLASS_TYPE_DYNAMIC_ARRAY`:
+ *     Element field class.
+ *
+ * `CACHE_FIELD_CLASS_TYPE_OPTION`:
+ *     Content field class.
+ *
+ * `CACHE_FIELD_CLASS_TYPE_VARIANT`,
+ * `CACHE_FIELD_CLASS_TYPE_STRUCTURE`:
+ *     Option or member count (uvarint), and, for each option or
+ *     member, its name (string) and its field class.
+ *
+ * Dynamic arrays, options, and variants are replayed without a
+ * length or selector field: the field values carry the length, the
+ * presence of the content, and the selected option.
+ *
+ * The encoding of a field depends on its class:
+ *
+ * Boolean:
+ *     Flag.
+ *
+ * Bit array, unsigned integer and enumeration:
+ *     Uvarint.
+ *
+ * Signed integer and enumeration:
+ *     Svarint.
+ *
+ * Real:
+ *     4 or 8 bytes.
+ *
+ * String:
+ *     String.
+ *
+ * Static array:
+ *     Elements.
+ *
+ * Dynamic array:
+ *     Length (uvarint), elements.
+ *
+ * Option:
+ *     Has content (flag), content.
+ *
+ * Variant:
+ *     Selected option index (uvarint), selected option's field.
+ *
+ * Structure:
+ *     Members.
+ */
+enum cache_field_class_type {
+	CACHE_FIELD_CLASS_TYPE_BOOL = 0,
+	CACHE_FIELD_CLASS_TYPE_BIT_ARRAY,
+	CACHE_FIELD_CLASS_TYPE_UNSIGNED_INTEGER,
+	CACHE_FIELD_CLASS_TYPE_SIGNED_INTEGER,
+	CACHE_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION,
+	CACHE_FIELD_CLASS_TYPE_SIGNED_ENUMERATION,
+	CACHE_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL,
+	CACHE_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL,
+	CACHE_FIELD_CLASS_TYPE_STRING,
+	CACHE_FIELD_CLASS_TYPE_STATIC_ARRAY,
+	CACHE_FIELD_CLASS_TYPE_DYNAMIC_ARRAY,
+	CACHE_FIELD_CLASS_TYPE_OPTION,
+	CACHE_FIELD_CLASS_TYPE_VARIANT,
+	CACHE_FIELD_CLASS_TYPE_STRUCTURE,
+};
+
+#endif /* BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_FORMAT_H */
@@ -0,0 +1,1221 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (cache_sink->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (cache_sink->log_level)
+#define BT_LOG_TAG "PLUGIN/SINK.UTILS.CACHE"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/common.h"
+#include "common/uuid.h"
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "cache-format.h"
+#include "cache-sink.h"
+
+static
+const char * const in_port_name = "in";
+
+static
+struct bt_param_validation_map_value_entry_descr cache_sink_params[] = {
+	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { .type = BT_VALUE_TYPE_STRING } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static inline
+void put_u8(GByteArray *buf, uint8_t val)
+{
+	g_byte_array_append(buf, &val, 1);
+}
+
+static inline
+void put_bool(GByteArray *buf, bt_bool val)
+{
+	put_u8(buf, val ? 1 : 0);
+}
+
+/*
+ * Encodes `val` as unsigned LEB128 into `bytes` (at least 10 bytes),
+ * returning the number of written bytes.
+ */
+static inline
+guint encode_uvarint(uint8_t *bytes, uint64_t val)
+{
+	guint len = 0;
+
+	do {
+		bytes[len] = val & 0x7f;
+		val >>= 7;
+
+		if (val) {
+			bytes[len] |= 0x80;
+		}
+
+		len++;
+	} while (val);
+
+	return len;
+}
+
+static inline
+void put_uvarint(GByteArray *buf, uint64_t val)
+{
+	uint8_t bytes[10];
+
+	g_byte_array_append(buf, bytes, encode_uvarint(bytes, val));
+}
+
+static inline
+void put_svarint(GByteArray *buf, int64_t val)
+{
+	put_uvarint(buf, ((uint64_t) val << 1) ^ (uint64_t) (val >> 63));
+}
+
+static inline
+void put_le(GByteArray *buf, uint64_t val, guint len)
+{
+	uint8_t bytes[8];
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		bytes[i] = (uint8_t) (val >> (i * 8));
+	}
+
+	g_byte_array_append(buf, bytes, len);
+}
+
+static inline
+void put_str_with_len(GByteArray *buf, const char *str, uint64_t len)
+{
+	put_uvarint(buf, len);
+	g_byte_array_append(buf, (const guint8 *) str, (guint) len + 1);
+}
+
+static inline
+void put_str(GByteArray *buf, const char *str)
+{
+	put_str_with_len(buf, str, strlen(str));
+}
+
+static
+void put_opt_str(GByteArray *buf, const char *str)
+{
+	put_bool(buf, str != NULL);
+
+	if (str) {
+		put_str(buf, str);
+	}
+}
+
+static
+void put_opt_uuid(GByteArray *buf, bt_uuid uuid)
+{
+	put_bool(buf, uuid != NULL);
+
+	if (uuid) {
+		g_byte_array_append(buf, uuid, BT_UUID_LEN);
+	}
+}
+
+/*
+ * Writes a record of type `type` with the current contents of
+ * `cache_sink->buf` as its payload, and clears the buffer.
+ */
+static
+int write_record(struct cache_sink *cache_sink, enum cache_record_type type)
+{
+	uint8_t header[11];
+	guint header_len;
+	int ret = 0;
+
+	header[0] = (uint8_t) type;
+	header_len = 1 + encode_uvarint(&header[1], cache_sink->buf->len);
+
+	if (fwrite(header, header_len, 1, cache_sink->fp) != 1 ||
+			(cache_sink->buf->len > 0 &&
+				fwrite(cache_sink->buf->data,
+					cache_sink->buf->len, 1,
+					cache_sink->fp) != 1)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(cache_sink->self_comp,
+			"Cannot write record to cache file", ": path=\"%s\"",
+			cache_sink->path);
+		ret = -1;
+	}
+
+	g_byte_array_set_size(cache_sink->buf, 0);
+	return ret;
+}
+
+static
+void put_integer_field_class(GByteArray *buf, const bt_field_class *fc)
+{
+	put_uvarint(buf, bt_field_class_integer_get_field_value_range(fc));
+	put_uvarint(buf,
+		bt_field_class_integer_get_preferred_display_base(fc));
+}
+
+static
+void put_unsigned_enumeration_mappings(GByteArray *buf,
+		const bt_field_class *fc)
+{
+	uint64_t count = bt_field_class_enumeration_get_mapping_count(fc);
+	uint64_t i;
+
+	put_uvarint(buf, count);
+
+	for (i = 0; i < count; i++) {
+		const bt_field_class_enumeration_unsigned_mapping *mapping =
+			bt_field_class_enumeration_unsigned_borrow_mapping_by_index_const(
+				fc, i);
+		const bt_integer_range_set_unsigned *ranges =
+			bt_field_class_enumeration_unsigned_mapping_borrow_ranges_const(
+				mapping);
+		uint64_t range_count = bt_integer_range_set_get_range_count(
+			bt_integer_range_set_unsigned_as_range_set_const(ranges));
+		uint64_t j;
+
+		put_str(buf, bt_field_class_enumeration_mapping_get_label(
+			bt_field_class_enumeration_unsigned_mapping_as_mapping_const(
+				mapping)));
+		put_uvarint(buf, range_count);
+
+		for (j = 0; j < range_count; j++) {
+			const bt_integer_range_unsigned *range =
+				bt_integer_range_set_unsigned_borrow_range_by_index_const(
+					ranges, j);
+
+			put_uvarint(buf,
+				bt_integer_range_unsigned_get_lower(range));
+			put_uvarint(buf,
+				bt_integer_range_unsigned_get_upper(range));
+		}
+	}
+}
+
+static
+void put_signed_enumeration_mappings(GByteArray *buf,
+		const bt_field_class *fc)
+{
+	uint64_t count = bt_field_class_enumeration_get_mapping_count(fc);
+	uint64_t i;
+
+	put_uvarint(buf, count);
+
+	for (i = 0; i < count; i++) {
+		const bt_field_class_enumeration_signed_mapping *mapping =
+			bt_field_class_enumeration_signed_borrow_mapping_by_index_const(
+				fc, i);
+		const bt_integer_range_set_signed *ranges =
+			bt_field_class_enumeration_signed_mapping_borrow_ranges_const(
+				mapping);
+		uint64_t range_count = bt_integer_range_set_get_range_count(
+			bt_integer_range_set_signed_as_range_set_const(ranges));
+		uint64_t j;
+
+		put_str(buf, bt_field_class_enumeration_mapping_get_label(
+			bt_field_class_enumeration_signed_mapping_as_mapping_const(
+				mapping)));
+		put_uvarint(buf, range_count);
+
+		for (j = 0; j < range_count; j++) {
+			const bt_integer_range_signed *range =
+				bt_integer_range_set_signed_borrow_range_by_index_const(
+					ranges, j);
+
+			put_svarint(buf,
+				bt_integer_range_signed_get_lower(range));
+			put_svarint(buf,
+				bt_integer_range_signed_get_upper(range));
+		}
+	}
+}
+
+static
+void put_field_class(GByteArray *buf, const bt_field_class *fc)
+{
+	bt_field_class_type type = bt_field_class_get_type(fc);
+	uint64_t count;
+	uint64_t i;
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_BOOL);
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_BIT_ARRAY);
+		put_uvarint(buf, bt_field_class_bit_array_get_length(fc));
+	} else if (type == BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_UNSIGNED_INTEGER);
+		put_integer_field_class(buf, fc);
+	} else if (type == BT_FIELD_CLASS_TYPE_SIGNED_INTEGER) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_SIGNED_INTEGER);
+		put_integer_field_class(buf, fc);
+	} else if (type == BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION);
+		put_integer_field_class(buf, fc);
+		put_unsigned_enumeration_mappings(buf, fc);
+	} else if (type == BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_SIGNED_ENUMERATION);
+		put_integer_field_class(buf, fc);
+		put_signed_enumeration_mappings(buf, fc);
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL);
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL);
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_STRING);
+	} else if (type == BT_FIELD_CLASS_TYPE_STATIC_ARRAY) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_STATIC_ARRAY);
+		put_uvarint(buf, bt_field_class_array_static_get_length(fc));
+		put_field_class(buf,
+			bt_field_class_array_borrow_element_field_class_const(
+				fc));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY)) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_DYNAMIC_ARRAY);
+		put_field_class(buf,
+			bt_field_class_array_borrow_element_field_class_const(
+				fc));
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_OPTION)) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_OPTION);
+		put_field_class(buf,
+			bt_field_class_option_borrow_field_class_const(fc));
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_VARIANT)) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_VARIANT);
+		count = bt_field_class_variant_get_option_count(fc);
+		put_uvarint(buf, count);
+
+		for (i = 0; i < count; i++) {
+			const bt_field_class_variant_option *option =
+				bt_field_class_variant_borrow_option_by_index_const(
+					fc, i);
+
+			put_str(buf,
+				bt_field_class_variant_option_get_name(option));
+			put_field_class(buf,
+				bt_field_class_variant_option_borrow_field_class_const(
+					option));
+		}
+	} else if (type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		put_u8(buf, CACHE_FIELD_CLASS_TYPE_STRUCTURE);
+		count = bt_field_class_structure_get_member_count(fc);
+		put_uvarint(buf, count);
+
+		for (i = 0; i < count; i++) {
+			const bt_field_class_structure_member *member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc, i);
+
+			put_str(buf,
+				bt_field_class_structure_member_get_name(member));
+			put_field_class(buf,
+				bt_field_class_structure_member_borrow_field_class_const(
+					member));
+		}
+	} else {
+		bt_common_abort();
+	}
+}
+
+static
+void put_opt_field_class(GByteArray *buf, const bt_field_class *fc)
+{
+	put_bool(buf, fc != NULL);
+
+	if (fc) {
+		put_field_class(buf, fc);
+	}
+}
+
+static
+void put_field(GByteArray *buf, const bt_field *field)
+{
+	bt_field_class_type type = bt_field_get_class_type(field);
+	uint64_t count;
+	uint64_t i;
+
+	if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		put_uvarint(buf, bt_field_integer_unsigned_get_value(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		put_svarint(buf, bt_field_integer_signed_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		put_str_with_len(buf, bt_field_string_get_value(field),
+			bt_field_string_get_length(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		count = bt_field_class_structure_get_member_count(
+			bt_field_borrow_class_const(field));
+
+		for (i = 0; i < count; i++) {
+			put_field(buf,
+				bt_field_structure_borrow_member_field_by_index_const(
+					field, i));
+		}
+	} else if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		put_bool(buf, bt_field_bool_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		put_uvarint(buf,
+			bt_field_bit_array_get_value_as_integer(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		float val = bt_field_real_single_precision_get_value(field);
+		uint32_t bits;
+
+		memcpy(&bits, &val, sizeof(bits));
+		put_le(buf, bits, 4);
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		double val = bt_field_real_double_precision_get_value(field);
+		uint64_t bits;
+
+		memcpy(&bits, &val, sizeof(bits));
+		put_le(buf, bits, 8);
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_ARRAY)) {
+		count = bt_field_array_get_length(field);
+
+		if (type != BT_FIELD_CLASS_TYPE_STATIC_ARRAY) {
+			put_uvarint(buf, count);
+		}
+
+		for (i = 0; i < count; i++) {
+			put_field(buf,
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i));
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_OPTION)) {
+		const bt_field *content_field =
+			bt_field_option_borrow_field_const(field);
+
+		put_bool(buf, content_field != NULL);
+
+		if (content_field) {
+			put_field(buf, content_field);
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_VARIANT)) {
+		put_uvarint(buf,
+			bt_field_variant_get_selected_option_index(field));
+		put_field(buf,
+			bt_field_variant_borrow_selected_option_field_const(
+				field));
+	} else {
+		bt_common_abort();
+	}
+}
+
+static inline
+void put_opt_field(GByteArray *buf, const bt_field *field)
+{
+	if (field) {
+		put_field(buf, field);
+	}
+}
+
+/*
+ * Sets `*id` to the ID of `obj` within `objects`, returning true, or
+ * returns false if `obj` isn't written yet.
+ */
+static inline
+bool lookup_object(GHashTable *objects, const void *obj, uint64_t *id)
+{
+	gpointer value = g_hash_table_lookup(objects, obj);
+
+	if (!value) {
+		return false;
+	}
+
+	*id = GPOINTER_TO_UINT(value) - 1;
+	return true;
+}
+
+static
+uint64_t add_object(GHashTable *objects, const void *obj, uint64_t id)
+{
+	g_hash_table_insert(objects, (gpointer) obj,
+		GUINT_TO_POINTER((guint) id + 1));
+	return id;
+}
+
+static
+int write_clock_class(struct cache_sink *cache_sink,
+		const bt_clock_class *cc, uint64_t *id)
+{
+	GByteArray *buf = cache_sink->buf;
+	int64_t offset_seconds;
+	uint64_t offset_cycles;
+	int ret = 0;
+
+	if (lookup_object(cache_sink->clock_classes, cc, id)) {
+		goto end;
+	}
+
+	put_opt_str(buf, bt_clock_class_get_name(cc));
+	put_opt_str(buf, bt_clock_class_get_description(cc));
+	put_uvarint(buf, bt_clock_class_get_frequency(cc));
+	bt_clock_class_get_offset(cc, &offset_seconds, &offset_cycles);
+	put_svarint(buf, offset_seconds);
+	put_uvarint(buf, offset_cycles);
+	put_uvarint(buf, bt_clock_class_get_precision(cc));
+	put_bool(buf, bt_clock_class_origin_is_unix_epoch(cc));
+	put_opt_uuid(buf, bt_clock_class_get_uuid(cc));
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_CLOCK_CLASS);
+	if (ret) {
+		goto end;
+	}
+
+	bt_clock_class_get_ref(cc);
+	*id = add_object(cache_sink->clock_classes, cc,
+		g_hash_table_size(cache_sink->clock_classes));
+
+end:
+	return ret;
+}
+
+static
+int write_trace_class(struct cache_sink *cache_sink,
+		const bt_trace_class *tc, uint64_t *id)
+{
+	int ret = 0;
+
+	if (lookup_object(cache_sink->trace_classes, tc, id)) {
+		goto end;
+	}
+
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_TRACE_CLASS);
+	if (ret) {
+		goto end;
+	}
+
+	bt_trace_class_get_ref(tc);
+	*id = add_object(cache_sink->trace_classes, tc,
+		g_hash_table_size(cache_sink->trace_classes));
+
+end:
+	return ret;
+}
+
+static
+int write_trace(struct cache_sink *cache_sink, const bt_trace *trace,
+		uint64_t *id)
+{
+	GByteArray *buf = cache_sink->buf;
+	uint64_t tc_id;
+	uint64_t count;
+	uint64_t i;
+	int ret = 0;
+
+	if (lookup_object(cache_sink->traces, trace, id)) {
+		goto end;
+	}
+
+	ret = write_trace_class(cache_sink, bt_trace_borrow_class_const(trace),
+		&tc_id);
+	if (ret) {
+		goto end;
+	}
+
+	put_uvarint(buf, tc_id);
+	put_opt_str(buf, bt_trace_get_name(trace));
+	put_opt_uuid(buf, bt_trace_get_uuid(trace));
+	count = bt_trace_get_environment_entry_count(trace);
+	put_uvarint(buf, count);
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+		const bt_value *value;
+
+		bt_trace_borrow_environment_entry_by_index_const(trace, i,
+			&name, &value);
+		put_str(buf, name);
+
+		if (bt_value_is_signed_integer(value)) {
+			put_u8(buf, CACHE_ENV_ENTRY_TYPE_INTEGER);
+			put_svarint(buf, bt_value_integer_signed_get(value));
+		} else {
+			BT_ASSERT(bt_value_is_string(value));
+			put_u8(buf, CACHE_ENV_ENTRY_TYPE_STRING);
+			put_str(buf, bt_value_string_get(value));
+		}
+	}
+
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_TRACE);
+	if (ret) {
+		goto end;
+	}
+
+	bt_trace_get_ref(trace);
+	*id = add_object(cache_sink->traces, trace,
+		g_hash_table_size(cache_sink->traces));
+
+end:
+	return ret;
+}
+
+static
+int write_stream_class(struct cache_sink *cache_sink,
+		const bt_stream_class *sc, uint64_t *id)
+{
+	GByteArray *buf = cache_sink->buf;
+	const bt_clock_class *cc;
+	uint64_t tc_id;
+	uint64_t cc_id = 0;
+	uint8_t flags = 0;
+	int ret = 0;
+
+	if (lookup_object(cache_sink->stream_classes, sc, id)) {
+		goto end;
+	}
+
+	ret = write_trace_class(cache_sink,
+		bt_stream_class_borrow_trace_class_const(sc), &tc_id);
+	if (ret) {
+		goto end;
+	}
+
+	cc = bt_stream_class_borrow_default_clock_class_const(sc);
+	if (cc) {
+		ret = write_clock_class(cache_sink, cc, &cc_id);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	if (bt_stream_class_supports_packets(sc)) {
+		flags |= CACHE_STREAM_CLASS_FLAG_SUPPORTS_PACKETS;
+
+		if (bt_stream_class_packets_have_beginning_default_clock_snapshot(sc)) {
+			flags |= CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_BEGINNING_CS;
+		}
+
+		if (bt_stream_class_packets_have_end_default_clock_snapshot(sc)) {
+			flags |= CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_END_CS;
+		}
+	}
+
+	if (bt_stream_class_supports_discarded_events(sc)) {
+		flags |= CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_EVENTS;
+
+		if (bt_stream_class_discarded_events_have_default_clock_snapshots(sc)) {
+			flags |= CACHE_STREAM_CLASS_FLAG_DISCARDED_EVENTS_HAVE_CS;
+		}
+	}
+
+	if (bt_stream_class_supports_discarded_packets(sc)) {
+		flags |= CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_PACKETS;
+
+		if (bt_stream_class_discarded_packets_have_default_clock_snapshots(sc)) {
+			flags |= CACHE_STREAM_CLASS_FLAG_DISCARDED_PACKETS_HAVE_CS;
+		}
+	}
+
+	put_uvarint(buf, tc_id);
+	put_uvarint(buf, bt_stream_class_get_id(sc));
+	put_opt_str(buf, bt_stream_class_get_name(sc));
+	put_bool(buf, cc != NULL);
+
+	if (cc) {
+		put_uvarint(buf, cc_id);
+	}
+
+	put_u8(buf, flags);
+	put_opt_field_class(buf,
+		bt_stream_class_borrow_packet_context_field_class_const(sc));
+	put_opt_field_class(buf,
+		bt_stream_class_borrow_event_common_context_field_class_const(sc));
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_STREAM_CLASS);
+	if (ret) {
+		goto end;
+	}
+
+	bt_stream_class_get_ref(sc);
+	*id = add_object(cache_sink->stream_classes, sc,
+		g_hash_table_size(cache_sink->stream_classes));
+
+end:
+	return ret;
+}
+
+static
+int write_event_class(struct cache_sink *cache_sink,
+		const bt_event_class *ec, uint64_t *id)
+{
+	GByteArray *buf = cache_sink->buf;
+	bt_event_class_log_level log_level;
+	uint64_t sc_id;
+	int ret = 0;
+
+	if (ec == cache_sink->last_ec) {
+		*id = cache_sink->last_ec_id;
+		goto end;
+	}
+
+	if (lookup_object(cache_sink->event_classes, ec, id)) {
+		goto update_last;
+	}
+
+	ret = write_stream_class(cache_sink,
+		bt_event_class_borrow_stream_class_const(ec), &sc_id);
+	if (ret) {
+		goto end;
+	}
+
+	put_uvarint(buf, sc_id);
+	put_uvarint(buf, bt_event_class_get_id(ec));
+	put_opt_str(buf, bt_event_class_get_name(ec));
+
+	if (bt_event_class_get_log_level(ec, &log_level) ==
+			BT_PROPERTY_AVAILABILITY_AVAILABLE) {
+		put_bool(buf, BT_TRUE);
+		put_uvarint(buf, (uint64_t) log_level);
+	} else {
+		put_bool(buf, BT_FALSE);
+	}
+
+	put_opt_str(buf, bt_event_class_get_emf_uri(ec));
+	put_opt_field_class(buf,
+		bt_event_class_borrow_specific_context_field_class_const(ec));
+	put_opt_field_class(buf,
+		bt_event_class_borrow_payload_field_class_const(ec));
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_EVENT_CLASS);
+	if (ret) {
+		goto end;
+	}
+
+	bt_event_class_get_ref(ec);
+	*id = add_object(cache_sink->event_classes, ec,
+		g_hash_table_size(cache_sink->event_classes));
+
+update_last:
+	cache_sink->last_ec = ec;
+	cache_sink->last_ec_id = *id;
+
+end:
+	return ret;
+}
+
+static
+int write_stream(struct cache_sink *cache_sink, const bt_stream *stream,
+		uint64_t *id)
+{
+	GByteArray *buf = cache_sink->buf;
+	uint64_t trace_id;
+	uint64_t sc_id;
+	int ret = 0;
+
+	if (lookup_object(cache_sink->streams, stream, id)) {
+		goto end;
+	}
+
+	ret = write_trace(cache_sink, bt_stream_borrow_trace_const(stream),
+		&trace_id);
+	if (ret) {
+		goto end;
+	}
+
+	ret = write_stream_class(cache_sink,
+		bt_stream_borrow_class_const(stream), &sc_id);
+	if (ret) {
+		goto end;
+	}
+
+	put_uvarint(buf, trace_id);
+	put_uvarint(buf, sc_id);
+	put_uvarint(buf, bt_stream_get_id(stream));
+	put_opt_str(buf, bt_stream_get_name(stream));
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_STREAM);
+	if (ret) {
+		goto end;
+	}
+
+	bt_stream_get_ref(stream);
+	*id = add_object(cache_sink->streams, stream,
+		cache_sink->next_stream_id);
+	cache_sink->next_stream_id++;
+
+end:
+	return ret;
+}
+
+static inline
+void put_clock_snapshot(GByteArray *buf, const bt_clock_snapshot *cs)
+{
+	put_uvarint(buf, bt_clock_snapshot_get_value(cs));
+}
+
+static
+void put_stream_clock_snapshot(GByteArray *buf,
+		bt_message_stream_clock_snapshot_state state,
+		const bt_clock_snapshot *cs)
+{
+	if (state == BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
+		put_bool(buf, BT_TRUE);
+		put_clock_snapshot(buf, cs);
+	} else {
+		put_bool(buf, BT_FALSE);
+	}
+}
+
+static
+void put_opt_count(GByteArray *buf, bt_property_availability avail,
+		uint64_t count)
+{
+	if (avail == BT_PROPERTY_AVAILABILITY_AVAILABLE) {
+		put_bool(buf, BT_TRUE);
+		put_uvarint(buf, count);
+	} else {
+		put_bool(buf, BT_FALSE);
+	}
+}
+
+static
+int write_event_msg(struct cache_sink *cache_sink, const bt_message *msg)
+{
+	GByteArray *buf = cache_sink->buf;
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_stream *stream = bt_event_borrow_stream_const(event);
+	uint64_t stream_id;
+	uint64_t ec_id;
+	int ret;
+
+	ret = write_stream(cache_sink, stream, &stream_id);
+	if (ret) {
+		goto end;
+	}
+
+	ret = write_event_class(cache_sink,
+		bt_event_borrow_class_const(event), &ec_id);
+	if (ret) {
+		goto end;
+	}
+
+	put_uvarint(buf, stream_id);
+	put_uvarint(buf, ec_id);
+
+	if (bt_stream_class_borrow_default_clock_class_const(
+			bt_stream_borrow_class_const(stream))) {
+		put_clock_snapshot(buf,
+			bt_message_event_borrow_default_clock_snapshot_const(
+				msg));
+	}
+
+	put_opt_field(buf, bt_event_borrow_common_context_field_const(event));
+	put_opt_field(buf,
+		bt_event_borrow_specific_context_field_const(event));
+	put_opt_field(buf, bt_event_borrow_payload_field_const(event));
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_MSG_EVENT);
+
+end:
+	return ret;
+}
+
+static
+int write_msg(struct cache_sink *cache_sink, const bt_message *msg)
+{
+	GByteArray *buf = cache_sink->buf;
+	const bt_clock_snapshot *cs = NULL;
+	const bt_clock_snapshot *end_cs;
+	const bt_stream *stream;
+	const bt_stream_class *sc;
+	enum cache_record_type record_type;
+	bt_message_stream_clock_snapshot_state cs_state;
+	bt_property_availability avail;
+	uint64_t stream_id;
+	uint64_t id;
+	uint64_t count = 0;
+	int ret;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		ret = write_event_msg(cache_sink, msg);
+		goto end;
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+		cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+			msg);
+		ret = write_clock_class(cache_sink,
+			bt_clock_snapshot_borrow_clock_class_const(cs), &id);
+		if (ret) {
+			goto end;
+		}
+
+		put_uvarint(buf, id);
+		put_clock_snapshot(buf, cs);
+		ret = write_record(cache_sink,
+			CACHE_RECORD_TYPE_MSG_MESSAGE_ITERATOR_INACTIVITY);
+		goto end;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		stream = bt_message_stream_beginning_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		stream = bt_message_stream_end_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		stream = bt_packet_borrow_stream_const(
+			bt_message_packet_beginning_borrow_packet_const(msg));
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		stream = bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg));
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		stream = bt_message_discarded_events_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		stream = bt_message_discarded_packets_borrow_stream_const(msg);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	/* Stream message: write the stream (and its classes) first */
+	ret = write_stream(cache_sink, stream, &stream_id);
+	if (ret) {
+		goto end;
+	}
+
+	sc = bt_stream_borrow_class_const(stream);
+	put_uvarint(buf, stream_id);
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		cs_state = bt_message_stream_beginning_borrow_default_clock_snapshot_const(
+			msg, &cs);
+		put_stream_clock_snapshot(buf, cs_state, cs);
+		record_type = CACHE_RECORD_TYPE_MSG_STREAM_BEGINNING;
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		cs_state = bt_message_stream_end_borrow_default_clock_snapshot_const(
+			msg, &cs);
+		put_stream_clock_snapshot(buf, cs_state, cs);
+		record_type = CACHE_RECORD_TYPE_MSG_STREAM_END;
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		if (bt_stream_class_packets_have_beginning_default_clock_snapshot(sc)) {
+			put_clock_snapshot(buf,
+				bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+					msg));
+		}
+
+		put_opt_field(buf, bt_packet_borrow_context_field_const(
+			bt_message_packet_beginning_borrow_packet_const(msg)));
+		record_type = CACHE_RECORD_TYPE_MSG_PACKET_BEGINNING;
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		if (bt_stream_class_packets_have_end_default_clock_snapshot(sc)) {
+			put_clock_snapshot(buf,
+				bt_message_packet_end_borrow_default_clock_snapshot_const(
+					msg));
+		}
+
+		record_type = CACHE_RECORD_TYPE_MSG_PACKET_END;
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		if (bt_stream_class_discarded_events_have_default_clock_snapshots(sc)) {
+			cs = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+				msg);
+			end_cs = bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
+				msg);
+			put_clock_snapshot(buf, cs);
+			put_clock_snapshot(buf, end_cs);
+		}
+
+		avail = bt_message_discarded_events_get_count(msg, &count);
+		put_opt_count(buf, avail, count);
+		record_type = CACHE_RECORD_TYPE_MSG_DISCARDED_EVENTS;
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		if (bt_stream_class_discarded_packets_have_default_clock_snapshots(sc)) {
+			cs = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+				msg);
+			end_cs = bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
+				msg);
+			put_clock_snapshot(buf, cs);
+			put_clock_snapshot(buf, end_cs);
+		}
+
+		avail = bt_message_discarded_packets_get_count(msg, &count);
+		put_opt_count(buf, avail, count);
+		record_type = CACHE_RECORD_TYPE_MSG_DISCARDED_PACKETS;
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	ret = write_record(cache_sink, record_type);
+	if (ret) {
+		goto end;
+	}
+
+	if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_STREAM_END) {
+		/* A stream can't begin again: forget it */
+		g_hash_table_remove(cache_sink->streams, stream);
+	}
+
+end:
+	return ret;
+}
+
+static
+int write_end(struct cache_sink *cache_sink)
+{
+	int ret;
+
+	ret = write_record(cache_sink, CACHE_RECORD_TYPE_END);
+	if (ret) {
+		goto end;
+	}
+
+	if (fflush(cache_sink->fp)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(cache_sink->self_comp,
+			"Cannot flush cache file", ": path=\"%s\"",
+			cache_sink->path);
+		ret = -1;
+		goto end;
+	}
+
+	cache_sink->ended = true;
+	BT_COMP_LOGI("Wrote cache file: path=\"%s\"", cache_sink->path);
+
+end:
+	return ret;
+}
+
+static
+void destroy_cache_sink(struct cache_sink *cache_sink)
+{
+	if (!cache_sink) {
+		return;
+	}
+
+	if (cache_sink->fp) {
+		if (fclose(cache_sink->fp)) {
+			BT_COMP_LOGE_ERRNO("Cannot close cache file",
+				": path=\"%s\"", cache_sink->path);
+		}
+	}
+
+	if (cache_sink->streams) {
+		g_hash_table_destroy(cache_sink->streams);
+	}
+
+	if (cache_sink->event_classes) {
+		g_hash_table_destroy(cache_sink->event_classes);
+	}
+
+	if (cache_sink->stream_classes) {
+		g_hash_table_destroy(cache_sink->stream_classes);
+	}
+
+	if (cache_sink->traces) {
+		g_hash_table_destroy(cache_sink->traces);
+	}
+
+	if (cache_sink->trace_classes) {
+		g_hash_table_destroy(cache_sink->trace_classes);
+	}
+
+	if (cache_sink->clock_classes) {
+		g_hash_table_destroy(cache_sink->clock_classes);
+	}
+
+	if (cache_sink->buf) {
+		g_byte_array_free(cache_sink->buf, TRUE);
+	}
+
+	g_free(cache_sink->path);
+	bt_message_iterator_put_ref(cache_sink->msg_iter);
+	g_free(cache_sink);
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status cache_sink_init(
+		bt_self_component_sink *self_comp_sink,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params,
+		__attribute__((unused)) void *init_method_data)
+{
+	bt_component_class_initialize_method_status status;
+	bt_self_component_add_port_status add_port_status;
+	struct cache_sink *cache_sink = g_new0(struct cache_sink, 1);
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+	uint8_t version = CACHE_FORMAT_VERSION;
+
+	if (!cache_sink) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	cache_sink->self_comp =
+		bt_self_component_sink_as_self_component(self_comp_sink);
+	cache_sink->log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(cache_sink->self_comp));
+	add_port_status = bt_self_component_sink_add_input_port(
+		self_comp_sink, in_port_name, NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	validation_status = bt_param_validation_validate(params,
+		cache_sink_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(cache_sink->self_comp,
+			"%s", validate_error);
+		goto error;
+	}
+
+	cache_sink->path = g_strdup(bt_value_string_get(
+		bt_value_map_borrow_entry_value_const(params, "path")));
+	cache_sink->fp = fopen(cache_sink->path, "wb");
+	if (!cache_sink->fp) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(cache_sink->self_comp,
+			"Cannot open cache file for writing", ": path=\"%s\"",
+			cache_sink->path);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto error;
+	}
+
+	if (fwrite(CACHE_FORMAT_MAGIC, CACHE_FORMAT_MAGIC_LEN, 1,
+			cache_sink->fp) != 1 ||
+			fwrite(&version, 1, 1, cache_sink->fp) != 1) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(cache_sink->self_comp,
+			"Cannot write cache file header", ": path=\"%s\"",
+			cache_sink->path);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto error;
+	}
+
+	cache_sink->buf = g_byte_array_new();
+	cache_sink->clock_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_clock_class_put_ref, NULL);
+	cache_sink->trace_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_trace_class_put_ref, NULL);
+	cache_sink->traces = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_trace_put_ref, NULL);
+	cache_sink->stream_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_stream_class_put_ref, NULL);
+	cache_sink->event_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_event_class_put_ref, NULL);
+	cache_sink->streams = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_stream_put_ref, NULL);
+	bt_self_component_set_data(cache_sink->self_comp, cache_sink);
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_cache_sink(cache_sink);
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+cache_sink_graph_is_configured(bt_self_component_sink *comp)
+{
+	bt_component_class_sink_graph_is_configured_method_status status;
+	bt_message_iterator_create_from_sink_component_status
+		msg_iter_status;
+	struct cache_sink *cache_sink;
+	bt_message_iterator *iterator;
+
+	cache_sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT(cache_sink);
+	msg_iter_status = bt_message_iterator_create_from_sink_component(
+		comp, bt_self_component_sink_borrow_input_port_by_name(comp,
+			in_port_name), &iterator);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_SINK_COMPONENT_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto end;
+	}
+
+	BT_MESSAGE_ITERATOR_MOVE_REF(cache_sink->msg_iter, iterator);
+	status = BT_COMPONENT_CLASS_SINK_GRAPH_IS_CONFIGURED_METHOD_STATUS_OK;
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void cache_sink_finalize(bt_self_component_sink *comp)
+{
+	struct cache_sink *cache_sink;
+
+	BT_ASSERT(comp);
+	cache_sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT(cache_sink);
+
+	if (!cache_sink->ended) {
+		/*
+		 * Without an end record, `source.utils.cache` rejects the
+		 * file instead of replaying part of the messages.
+		 */
+		BT_COMP_LOGW("Cache file is incomplete: path=\"%s\"",
+			cache_sink->path);
+	}
+
+	destroy_cache_sink(cache_sink);
+}
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status cache_sink_consume(
+		bt_self_component_sink *comp)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	struct cache_sink *cache_sink;
+	bt_message_iterator_next_status next_status;
+	uint64_t msg_count;
+	bt_message_array_const msgs;
+	uint64_t i;
+
+	cache_sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(comp));
+	BT_ASSERT_DBG(cache_sink);
+	next_status = bt_message_iterator_next(cache_sink->msg_iter, &msgs,
+		&msg_count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		if (write_end(cache_sink)) {
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		BT_MESSAGE_ITERATOR_PUT_REF_AND_RESET(cache_sink->msg_iter);
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
+		goto end;
+	default:
+		status = (int) next_status;
+		goto end;
+	}
+
+	for (i = 0; i < msg_count; i++) {
+		if (status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK &&
+				write_msg(cache_sink, msgs[i])) {
+			BT_COMP_LOGE_APPEND_CAUSE(cache_sink->self_comp,
+				"Cannot write message to cache file: "
+				"path=\"%s\"", cache_sink->path);
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		}
+
+		bt_message_put_ref(msgs[i]);
+	}
+
+end:
+	return status;
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SINK_H
+#define BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SINK_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+
+struct cache_sink {
+	bt_message_iterator *msg_iter;
+
+	/* Output file path and stream */
+	gchar *path;
+	FILE *fp;
+
+	/* True once the end record is written */
+	bool ended;
+
+	/* Payload of the record being built */
+	GByteArray *buf;
+
+	/*
+	 * Metadata object (owned) -> ID + 1 (`GUINT_TO_POINTER()`) of
+	 * the objects already written to the file
+	 */
+	GHashTable *clock_classes;
+	GHashTable *trace_classes;
+	GHashTable *traces;
+	GHashTable *stream_classes;
+	GHashTable *event_classes;
+
+	/* Stream (owned, removed at stream end) -> ID + 1 */
+	GHashTable *streams;
+
+	/* Next stream ID (streams are removed from `streams`) */
+	uint64_t next_stream_id;
+
+	/* Last looked up event class (weak) and its ID */
+	const bt_event_class *last_ec;
+	uint64_t last_ec_id;
+
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+};
+
+BT_HIDDEN
+bt_component_class_initialize_method_status cache_sink_init(
+		bt_self_component_sink *component,
+		bt_self_component_sink_configuration *config,
+		const bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void cache_sink_finalize(bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_graph_is_configured_method_status
+cache_sink_graph_is_configured(bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_component_class_sink_consume_method_status cache_sink_consume(
+		bt_self_component_sink *component);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SINK_H */
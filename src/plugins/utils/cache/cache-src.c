@@ -0,0 +1,1958 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (src_comp->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (src_comp->log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.UTILS.CACHE"
+#include "logging/comp-logging.h"
+
+#include "cache-src.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include "common/common.h"
+#include "common/assert.h"
+#include "common/uuid.h"
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "cache-format.h"
+
+#define HEADER_LEN	(CACHE_FORMAT_MAGIC_LEN + 1)
+
+struct cache_src_comp {
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+
+	gchar *path;
+
+	/* Mapped cache file */
+	GMappedFile *mapped_file;
+	const uint8_t *data;
+	gsize size;
+
+	/*
+	 * Arrays of metadata objects (owned), indexed by ID, created
+	 * while replaying the file and shared by all the message
+	 * iterators
+	 */
+	GPtrArray *clock_classes;
+	GPtrArray *trace_classes;
+	GPtrArray *stream_classes;
+	GPtrArray *event_classes;
+};
+
+struct cache_src_stream {
+	/* Owned by this */
+	bt_stream *stream;
+
+	/* Current packet (owned by this) */
+	bt_packet *packet;
+};
+
+struct cache_src_msg_iter {
+	struct cache_src_comp *src_comp;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	/* Offset of the next record within the file */
+	gsize offset;
+
+	/* True once the end record is read */
+	bool done;
+
+	/* Array of `bt_trace *` (owned), indexed by ID */
+	GPtrArray *traces;
+
+	/* Array of `struct cache_src_stream *` (owned), indexed by ID */
+	GPtrArray *streams;
+
+	/*
+	 * Number of metadata records of each type read since the
+	 * beginning of the file, that is, the ID of the next one
+	 */
+	uint64_t def_counts[CACHE_RECORD_TYPE_STREAM + 1];
+};
+
+/* Bytes of a record payload left to read */
+struct cache_cursor {
+	const uint8_t *at;
+	const uint8_t *end;
+};
+
+static
+struct bt_param_validation_map_value_entry_descr cache_src_params[] = {
+	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { .type = BT_VALUE_TYPE_STRING } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static inline
+int get_u8(struct cache_cursor *cursor, uint8_t *val)
+{
+	if (cursor->at == cursor->end) {
+		return -1;
+	}
+
+	*val = *cursor->at;
+	cursor->at++;
+	return 0;
+}
+
+static inline
+int get_bool(struct cache_cursor *cursor, bool *val)
+{
+	uint8_t byte;
+
+	if (get_u8(cursor, &byte) || byte > 1) {
+		return -1;
+	}
+
+	*val = byte;
+	return 0;
+}
+
+static inline
+int get_uvarint(struct cache_cursor *cursor, uint64_t *val)
+{
+	unsigned int shift = 0;
+	uint64_t res = 0;
+	uint8_t byte;
+
+	do {
+		if (shift >= 64 || get_u8(cursor, &byte)) {
+			return -1;
+		}
+
+		res |= (uint64_t) (byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	*val = res;
+	return 0;
+}
+
+static inline
+int get_svarint(struct cache_cursor *cursor, int64_t *val)
+{
+	uint64_t uval;
+
+	if (get_uvarint(cursor, &uval)) {
+		return -1;
+	}
+
+	*val = (int64_t) ((uval >> 1) ^ -(uval & 1));
+	return 0;
+}
+
+static inline
+int get_le(struct cache_cursor *cursor, unsigned int len, uint64_t *val)
+{
+	unsigned int i;
+
+	if ((uint64_t) (cursor->end - cursor->at) < len) {
+		return -1;
+	}
+
+	*val = 0;
+
+	for (i = 0; i < len; i++) {
+		*val |= (uint64_t) cursor->at[i] << (i * 8);
+	}
+
+	cursor->at += len;
+	return 0;
+}
+
+/*
+ * Sets `*str` to the null-terminated string at the cursor, within the
+ * mapped file.
+ */
+static inline
+int get_str(struct cache_cursor *cursor, const char **str)
+{
+	uint64_t len;
+
+	if (get_uvarint(cursor, &len) ||
+			len >= (uint64_t) (cursor->end - cursor->at) ||
+			cursor->at[len] != '\0') {
+		return -1;
+	}
+
+	*str = (const char *) cursor->at;
+	cursor->at += len + 1;
+	return 0;
+}
+
+static
+int get_opt_str(struct cache_cursor *cursor, const char **str)
+{
+	bool has_str;
+
+	if (get_bool(cursor, &has_str)) {
+		return -1;
+	}
+
+	if (!has_str) {
+		*str = NULL;
+		return 0;
+	}
+
+	return get_str(cursor, str);
+}
+
+static
+int get_opt_uuid(struct cache_cursor *cursor, bt_uuid *uuid)
+{
+	bool has_uuid;
+
+	if (get_bool(cursor, &has_uuid)) {
+		return -1;
+	}
+
+	if (!has_uuid) {
+		*uuid = NULL;
+		return 0;
+	}
+
+	if (cursor->end - cursor->at < BT_UUID_LEN) {
+		return -1;
+	}
+
+	*uuid = cursor->at;
+	cursor->at += BT_UUID_LEN;
+	return 0;
+}
+
+/* Returns the object with the ID `id` within `objects`, or `NULL` */
+static inline
+void *borrow_object(GPtrArray *objects, uint64_t id)
+{
+	if (id >= objects->len) {
+		return NULL;
+	}
+
+	return g_ptr_array_index(objects, id);
+}
+
+static
+int get_object(struct cache_cursor *cursor, GPtrArray *objects,
+		void **obj)
+{
+	uint64_t id;
+
+	if (get_uvarint(cursor, &id)) {
+		return -1;
+	}
+
+	*obj = borrow_object(objects, id);
+	return *obj ? 0 : -1;
+}
+
+static
+bt_field_class *create_field_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor, bt_trace_class *tc);
+
+static
+int set_integer_field_class_props(struct cache_cursor *cursor,
+		bt_field_class *fc)
+{
+	uint64_t range;
+	uint64_t base;
+
+	if (get_uvarint(cursor, &range) || range == 0 || range > 64 ||
+			get_uvarint(cursor, &base) ||
+			(base != BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_BINARY &&
+				base != BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_OCTAL &&
+				base != BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_DECIMAL &&
+				base != BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_HEXADECIMAL)) {
+		return -1;
+	}
+
+	bt_field_class_integer_set_field_value_range(fc, range);
+	bt_field_class_integer_set_preferred_display_base(fc,
+		(bt_field_class_integer_preferred_display_base) base);
+	return 0;
+}
+
+static
+int add_unsigned_enumeration_mappings(struct cache_cursor *cursor,
+		bt_field_class *fc)
+{
+	bt_integer_range_set_unsigned *ranges = NULL;
+	uint64_t count;
+	uint64_t i;
+	int ret = -1;
+
+	if (get_uvarint(cursor, &count)) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *label;
+		uint64_t range_count;
+		uint64_t j;
+
+		if (get_str(cursor, &label) ||
+				get_uvarint(cursor, &range_count) ||
+				range_count == 0) {
+			goto end;
+		}
+
+		ranges = bt_integer_range_set_unsigned_create();
+		if (!ranges) {
+			goto end;
+		}
+
+		for (j = 0; j < range_count; j++) {
+			uint64_t lower;
+			uint64_t upper;
+
+			if (get_uvarint(cursor, &lower) ||
+					get_uvarint(cursor, &upper) ||
+					lower > upper ||
+					bt_integer_range_set_unsigned_add_range(
+						ranges, lower, upper) !=
+						BT_INTEGER_RANGE_SET_ADD_RANGE_STATUS_OK) {
+				goto end;
+			}
+		}
+
+		if (bt_field_class_enumeration_unsigned_add_mapping(fc, label,
+				ranges) !=
+				BT_FIELD_CLASS_ENUMERATION_ADD_MAPPING_STATUS_OK) {
+			goto end;
+		}
+
+		BT_INTEGER_RANGE_SET_UNSIGNED_PUT_REF_AND_RESET(ranges);
+	}
+
+	ret = 0;
+
+end:
+	bt_integer_range_set_unsigned_put_ref(ranges);
+	return ret;
+}
+
+static
+int add_signed_enumeration_mappings(struct cache_cursor *cursor,
+		bt_field_class *fc)
+{
+	bt_integer_range_set_signed *ranges = NULL;
+	uint64_t count;
+	uint64_t i;
+	int ret = -1;
+
+	if (get_uvarint(cursor, &count)) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *label;
+		uint64_t range_count;
+		uint64_t j;
+
+		if (get_str(cursor, &label) ||
+				get_uvarint(cursor, &range_count) ||
+				range_count == 0) {
+			goto end;
+		}
+
+		ranges = bt_integer_range_set_signed_create();
+		if (!ranges) {
+			goto end;
+		}
+
+		for (j = 0; j < range_count; j++) {
+			int64_t lower;
+			int64_t upper;
+
+			if (get_svarint(cursor, &lower) ||
+					get_svarint(cursor, &upper) ||
+					lower > upper ||
+					bt_integer_range_set_signed_add_range(
+						ranges, lower, upper) !=
+						BT_INTEGER_RANGE_SET_ADD_RANGE_STATUS_OK) {
+				goto end;
+			}
+		}
+
+		if (bt_field_class_enumeration_signed_add_mapping(fc, label,
+				ranges) !=
+				BT_FIELD_CLASS_ENUMERATION_ADD_MAPPING_STATUS_OK) {
+			goto end;
+		}
+
+		BT_INTEGER_RANGE_SET_SIGNED_PUT_REF_AND_RESET(ranges);
+	}
+
+	ret = 0;
+
+end:
+	bt_integer_range_set_signed_put_ref(ranges);
+	return ret;
+}
+
+/*
+ * Appends the named members (`is_variant` is false) or options
+ * (`is_variant` is true) at the cursor to `fc`.
+ */
+static
+int append_named_field_classes(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor, bt_trace_class *tc,
+		bt_field_class *fc, bool is_variant)
+{
+	bt_field_class *child_fc = NULL;
+	uint64_t count;
+	uint64_t i;
+	int ret = -1;
+
+	if (get_uvarint(cursor, &count)) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+
+		if (get_str(cursor, &name)) {
+			goto end;
+		}
+
+		child_fc = create_field_class(src_comp, cursor, tc);
+		if (!child_fc) {
+			goto end;
+		}
+
+		if (is_variant) {
+			if (bt_field_class_variant_without_selector_append_option(
+					fc, name, child_fc) !=
+					BT_FIELD_CLASS_VARIANT_WITHOUT_SELECTOR_FIELD_APPEND_OPTION_STATUS_OK) {
+				BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+					"Cannot append option to variant field class: "
+					"name=\"%s\"", name);
+				goto end;
+			}
+		} else {
+			if (bt_field_class_structure_append_member(fc, name,
+					child_fc) !=
+					BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK) {
+				BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+					"Cannot append member to structure field class: "
+					"name=\"%s\"", name);
+				goto end;
+			}
+		}
+
+		BT_FIELD_CLASS_PUT_REF_AND_RESET(child_fc);
+	}
+
+	ret = 0;
+
+end:
+	bt_field_class_put_ref(child_fc);
+	return ret;
+}
+
+static
+bt_field_class *create_field_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor, bt_trace_class *tc)
+{
+	bt_field_class *fc = NULL;
+	bt_field_class *child_fc = NULL;
+	uint8_t type;
+	uint64_t len;
+	int ret = 0;
+
+	if (get_u8(cursor, &type)) {
+		goto error;
+	}
+
+	switch (type) {
+	case CACHE_FIELD_CLASS_TYPE_BOOL:
+		fc = bt_field_class_bool_create(tc);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_BIT_ARRAY:
+		if (get_uvarint(cursor, &len) || len == 0 || len > 64) {
+			goto error;
+		}
+
+		fc = bt_field_class_bit_array_create(tc, len);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+		fc = bt_field_class_integer_unsigned_create(tc);
+		if (fc) {
+			ret = set_integer_field_class_props(cursor, fc);
+		}
+
+		break;
+	case CACHE_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+		fc = bt_field_class_integer_signed_create(tc);
+		if (fc) {
+			ret = set_integer_field_class_props(cursor, fc);
+		}
+
+		break;
+	case CACHE_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+		fc = bt_field_class_enumeration_unsigned_create(tc);
+		if (fc) {
+			ret = set_integer_field_class_props(cursor, fc) ||
+				add_unsigned_enumeration_mappings(cursor, fc);
+		}
+
+		break;
+	case CACHE_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		fc = bt_field_class_enumeration_signed_create(tc);
+		if (fc) {
+			ret = set_integer_field_class_props(cursor, fc) ||
+				add_signed_enumeration_mappings(cursor, fc);
+		}
+
+		break;
+	case CACHE_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+		fc = bt_field_class_real_single_precision_create(tc);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+		fc = bt_field_class_real_double_precision_create(tc);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_STRING:
+		fc = bt_field_class_string_create(tc);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_STATIC_ARRAY:
+		if (get_uvarint(cursor, &len)) {
+			goto error;
+		}
+
+		child_fc = create_field_class(src_comp, cursor, tc);
+		if (!child_fc) {
+			goto error;
+		}
+
+		fc = bt_field_class_array_static_create(tc, child_fc, len);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_DYNAMIC_ARRAY:
+		child_fc = create_field_class(src_comp, cursor, tc);
+		if (!child_fc) {
+			goto error;
+		}
+
+		fc = bt_field_class_array_dynamic_create(tc, child_fc, NULL);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_OPTION:
+		child_fc = create_field_class(src_comp, cursor, tc);
+		if (!child_fc) {
+			goto error;
+		}
+
+		fc = bt_field_class_option_without_selector_create(tc,
+			child_fc);
+		break;
+	case CACHE_FIELD_CLASS_TYPE_VARIANT:
+		fc = bt_field_class_variant_create(tc, NULL);
+		if (fc) {
+			ret = append_named_field_classes(src_comp, cursor, tc,
+				fc, true);
+		}
+
+		break;
+	case CACHE_FIELD_CLASS_TYPE_STRUCTURE:
+		fc = bt_field_class_structure_create(tc);
+		if (fc) {
+			ret = append_named_field_classes(src_comp, cursor, tc,
+				fc, false);
+		}
+
+		break;
+	default:
+		BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+			"Unknown field class type: type=%u", (unsigned int) type);
+		goto error;
+	}
+
+	if (!fc) {
+		BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+			"Cannot create field class: type=%u",
+			(unsigned int) type);
+		goto error;
+	}
+
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_FIELD_CLASS_PUT_REF_AND_RESET(fc);
+
+end:
+	bt_field_class_put_ref(child_fc);
+	return fc;
+}
+
+/*
+ * Sets `*fc` to a new field class if the optional field class at the
+ * cursor is present, or to `NULL` otherwise.
+ */
+static
+int create_opt_field_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor, bt_trace_class *tc,
+		bt_field_class **fc)
+{
+	bool has_fc;
+
+	*fc = NULL;
+
+	if (get_bool(cursor, &has_fc)) {
+		return -1;
+	}
+
+	if (!has_fc) {
+		return 0;
+	}
+
+	*fc = create_field_class(src_comp, cursor, tc);
+	return *fc ? 0 : -1;
+}
+
+static
+int read_field(struct cache_cursor *cursor, bt_field *field)
+{
+	bt_field_class_type type = bt_field_get_class_type(field);
+	uint64_t count;
+	uint64_t i;
+
+	if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		uint64_t val;
+
+		if (get_uvarint(cursor, &val)) {
+			return -1;
+		}
+
+		bt_field_integer_unsigned_set_value(field, val);
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		int64_t val;
+
+		if (get_svarint(cursor, &val)) {
+			return -1;
+		}
+
+		bt_field_integer_signed_set_value(field, val);
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		const char *val;
+
+		if (get_str(cursor, &val) ||
+				bt_field_string_set_value(field, val) !=
+					BT_FIELD_STRING_SET_VALUE_STATUS_OK) {
+			return -1;
+		}
+	} else if (type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		count = bt_field_class_structure_get_member_count(
+			bt_field_borrow_class_const(field));
+
+		for (i = 0; i < count; i++) {
+			if (read_field(cursor,
+					bt_field_structure_borrow_member_field_by_index(
+						field, i))) {
+				return -1;
+			}
+		}
+	} else if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		bool val;
+
+		if (get_bool(cursor, &val)) {
+			return -1;
+		}
+
+		bt_field_bool_set_value(field, (bt_bool) val);
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		uint64_t val;
+
+		if (get_uvarint(cursor, &val)) {
+			return -1;
+		}
+
+		bt_field_bit_array_set_value_as_integer(field, val);
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		uint64_t bits;
+		uint32_t bits32;
+		float val;
+
+		if (get_le(cursor, 4, &bits)) {
+			return -1;
+		}
+
+		bits32 = (uint32_t) bits;
+		memcpy(&val, &bits32, sizeof(val));
+		bt_field_real_single_precision_set_value(field, val);
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		uint64_t bits;
+		double val;
+
+		if (get_le(cursor, 8, &bits)) {
+			return -1;
+		}
+
+		memcpy(&val, &bits, sizeof(val));
+		bt_field_real_double_precision_set_value(field, val);
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_ARRAY)) {
+		if (type == BT_FIELD_CLASS_TYPE_STATIC_ARRAY) {
+			count = bt_field_array_get_length(field);
+		} else if (get_uvarint(cursor, &count) ||
+				bt_field_array_dynamic_set_length(field, count) !=
+					BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK) {
+			return -1;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (read_field(cursor,
+					bt_field_array_borrow_element_field_by_index(
+						field, i))) {
+				return -1;
+			}
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_OPTION)) {
+		bool has_field;
+
+		if (get_bool(cursor, &has_field)) {
+			return -1;
+		}
+
+		bt_field_option_set_has_field(field, (bt_bool) has_field);
+
+		if (has_field && read_field(cursor,
+				bt_field_option_borrow_field(field))) {
+			return -1;
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_VARIANT)) {
+		uint64_t index;
+
+		if (get_uvarint(cursor, &index) ||
+				index >= bt_field_class_variant_get_option_count(
+					bt_field_borrow_class_const(field)) ||
+				bt_field_variant_select_option_by_index(field,
+					index) !=
+					BT_FIELD_VARIANT_SELECT_OPTION_STATUS_OK ||
+				read_field(cursor,
+					bt_field_variant_borrow_selected_option_field(
+						field))) {
+			return -1;
+		}
+	} else {
+		bt_common_abort();
+	}
+
+	return 0;
+}
+
+static inline
+int read_opt_field(struct cache_cursor *cursor, bt_field *field)
+{
+	return field ? read_field(cursor, field) : 0;
+}
+
+static
+int read_clock_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor)
+{
+	bt_clock_class *cc;
+	const char *name;
+	const char *description;
+	uint64_t frequency;
+	int64_t offset_seconds;
+	uint64_t offset_cycles;
+	uint64_t precision;
+	bool origin_is_unix_epoch;
+	bt_uuid uuid;
+	int ret = -1;
+
+	cc = bt_clock_class_create(src_comp->self_comp);
+	if (!cc) {
+		goto end;
+	}
+
+	if (get_opt_str(cursor, &name) ||
+			get_opt_str(cursor, &description) ||
+			get_uvarint(cursor, &frequency) || frequency == 0 ||
+			get_svarint(cursor, &offset_seconds) ||
+			get_uvarint(cursor, &offset_cycles) ||
+			offset_cycles >= frequency ||
+			get_uvarint(cursor, &precision) ||
+			get_bool(cursor, &origin_is_unix_epoch) ||
+			get_opt_uuid(cursor, &uuid)) {
+		goto end;
+	}
+
+	if ((name && bt_clock_class_set_name(cc, name) !=
+				BT_CLOCK_CLASS_SET_NAME_STATUS_OK) ||
+			(description && bt_clock_class_set_description(cc,
+				description) !=
+				BT_CLOCK_CLASS_SET_DESCRIPTION_STATUS_OK)) {
+		goto end;
+	}
+
+	bt_clock_class_set_frequency(cc, frequency);
+	bt_clock_class_set_offset(cc, offset_seconds, offset_cycles);
+	bt_clock_class_set_precision(cc, precision);
+	bt_clock_class_set_origin_is_unix_epoch(cc,
+		(bt_bool) origin_is_unix_epoch);
+
+	if (uuid) {
+		bt_clock_class_set_uuid(cc, uuid);
+	}
+
+	g_ptr_array_add(src_comp->clock_classes, cc);
+	cc = NULL;
+	ret = 0;
+
+end:
+	bt_clock_class_put_ref(cc);
+	return ret;
+}
+
+static
+int read_trace_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor)
+{
+	bt_trace_class *tc = bt_trace_class_create(src_comp->self_comp);
+
+	if (!tc) {
+		return -1;
+	}
+
+	/* Keep the original stream class IDs */
+	bt_trace_class_set_assigns_automatic_stream_class_id(tc, BT_FALSE);
+	g_ptr_array_add(src_comp->trace_classes, tc);
+	return 0;
+}
+
+static
+int read_trace(struct cache_src_msg_iter *msg_iter,
+		struct cache_cursor *cursor)
+{
+	struct cache_src_comp *src_comp = msg_iter->src_comp;
+	bt_trace_class *tc;
+	bt_trace *trace = NULL;
+	const char *name;
+	bt_uuid uuid;
+	uint64_t count;
+	uint64_t i;
+	int ret = -1;
+
+	if (get_object(cursor, src_comp->trace_classes, (void **) &tc)) {
+		goto end;
+	}
+
+	trace = bt_trace_create(tc);
+	if (!trace) {
+		goto end;
+	}
+
+	if (get_opt_str(cursor, &name) || get_opt_uuid(cursor, &uuid) ||
+			get_uvarint(cursor, &count)) {
+		goto end;
+	}
+
+	if (name && bt_trace_set_name(trace, name) !=
+			BT_TRACE_SET_NAME_STATUS_OK) {
+		goto end;
+	}
+
+	if (uuid) {
+		bt_trace_set_uuid(trace, uuid);
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_trace_set_environment_entry_status set_status;
+		const char *entry_name;
+		uint8_t type;
+
+		if (get_str(cursor, &entry_name) || get_u8(cursor, &type)) {
+			goto end;
+		}
+
+		if (type == CACHE_ENV_ENTRY_TYPE_INTEGER) {
+			int64_t val;
+
+			if (get_svarint(cursor, &val)) {
+				goto end;
+			}
+
+			set_status = bt_trace_set_environment_entry_integer(
+				trace, entry_name, val);
+		} else if (type == CACHE_ENV_ENTRY_TYPE_STRING) {
+			const char *val;
+
+			if (get_str(cursor, &val)) {
+				goto end;
+			}
+
+			set_status = bt_trace_set_environment_entry_string(
+				trace, entry_name, val);
+		} else {
+			goto end;
+		}
+
+		if (set_status != BT_TRACE_SET_ENVIRONMENT_ENTRY_STATUS_OK) {
+			goto end;
+		}
+	}
+
+	g_ptr_array_add(msg_iter->traces, trace);
+	trace = NULL;
+	ret = 0;
+
+end:
+	bt_trace_put_ref(trace);
+	return ret;
+}
+
+static
+int read_stream_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor)
+{
+	bt_trace_class *tc;
+	bt_stream_class *sc = NULL;
+	bt_clock_class *cc = NULL;
+	bt_field_class *fc = NULL;
+	const char *name;
+	uint64_t id;
+	bool has_cc;
+	uint8_t flags;
+	bool supports_packets;
+	bool supports_discarded_events;
+	bool supports_discarded_packets;
+	bool flag_needs_cs;
+	int ret = -1;
+
+	if (get_object(cursor, src_comp->trace_classes, (void **) &tc) ||
+			get_uvarint(cursor, &id) ||
+			get_opt_str(cursor, &name) ||
+			get_bool(cursor, &has_cc) ||
+			(has_cc && get_object(cursor, src_comp->clock_classes,
+				(void **) &cc)) ||
+			get_u8(cursor, &flags)) {
+		goto end;
+	}
+
+	supports_packets = flags & CACHE_STREAM_CLASS_FLAG_SUPPORTS_PACKETS;
+	supports_discarded_events =
+		flags & CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_EVENTS;
+	supports_discarded_packets =
+		flags & CACHE_STREAM_CLASS_FLAG_SUPPORTS_DISCARDED_PACKETS;
+	flag_needs_cs = flags &
+		(CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_BEGINNING_CS |
+		CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_END_CS |
+		CACHE_STREAM_CLASS_FLAG_DISCARDED_EVENTS_HAVE_CS |
+		CACHE_STREAM_CLASS_FLAG_DISCARDED_PACKETS_HAVE_CS);
+	if ((flag_needs_cs && !cc) ||
+			(supports_discarded_packets && !supports_packets)) {
+		goto end;
+	}
+
+	sc = bt_stream_class_create_with_id(tc, id);
+	if (!sc) {
+		goto end;
+	}
+
+	/* Keep the original event class and stream IDs */
+	bt_stream_class_set_assigns_automatic_event_class_id(sc, BT_FALSE);
+	bt_stream_class_set_assigns_automatic_stream_id(sc, BT_FALSE);
+
+	if (name && bt_stream_class_set_name(sc, name) !=
+			BT_STREAM_CLASS_SET_NAME_STATUS_OK) {
+		goto end;
+	}
+
+	if (cc && bt_stream_class_set_default_clock_class(sc, cc) !=
+			BT_STREAM_CLASS_SET_DEFAULT_CLOCK_CLASS_STATUS_OK) {
+		goto end;
+	}
+
+	bt_stream_class_set_supports_packets(sc, supports_packets,
+		!!(flags & CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_BEGINNING_CS),
+		!!(flags & CACHE_STREAM_CLASS_FLAG_PACKETS_HAVE_END_CS));
+	bt_stream_class_set_supports_discarded_events(sc,
+		supports_discarded_events,
+		!!(flags & CACHE_STREAM_CLASS_FLAG_DISCARDED_EVENTS_HAVE_CS));
+	bt_stream_class_set_supports_discarded_packets(sc,
+		supports_discarded_packets,
+		!!(flags & CACHE_STREAM_CLASS_FLAG_DISCARDED_PACKETS_HAVE_CS));
+
+	if (create_opt_field_class(src_comp, cursor, tc, &fc)) {
+		goto end;
+	}
+
+	if (fc) {
+		if (!supports_packets ||
+				bt_stream_class_set_packet_context_field_class(
+					sc, fc) !=
+					BT_STREAM_CLASS_SET_FIELD_CLASS_STATUS_OK) {
+			goto end;
+		}
+
+		BT_FIELD_CLASS_PUT_REF_AND_RESET(fc);
+	}
+
+	if (create_opt_field_class(src_comp, cursor, tc, &fc)) {
+		goto end;
+	}
+
+	if (fc && bt_stream_class_set_event_common_context_field_class(sc,
+			fc) != BT_STREAM_CLASS_SET_FIELD_CLASS_STATUS_OK) {
+		goto end;
+	}
+
+	g_ptr_array_add(src_comp->stream_classes, sc);
+	sc = NULL;
+	ret = 0;
+
+end:
+	bt_field_class_put_ref(fc);
+	bt_stream_class_put_ref(sc);
+	return ret;
+}
+
+static
+int read_event_class(struct cache_src_comp *src_comp,
+		struct cache_cursor *cursor)
+{
+	bt_stream_class *sc;
+	bt_event_class *ec = NULL;
+	bt_field_class *fc = NULL;
+	const char *name;
+	const char *emf_uri;
+	uint64_t id;
+	bool has_log_level;
+	uint64_t log_level = 0;
+	int ret = -1;
+
+	if (get_object(cursor, src_comp->stream_classes, (void **) &sc) ||
+			get_uvarint(cursor, &id) ||
+			get_opt_str(cursor, &name) ||
+			get_bool(cursor, &has_log_level) ||
+			(has_log_level && (get_uvarint(cursor, &log_level) ||
+				log_level > BT_EVENT_CLASS_LOG_LEVEL_DEBUG)) ||
+			get_opt_str(cursor, &emf_uri)) {
+		goto end;
+	}
+
+	ec = bt_event_class_create_with_id(sc, id);
+	if (!ec) {
+		goto end;
+	}
+
+	if (name && bt_event_class_set_name(ec, name) !=
+			BT_EVENT_CLASS_SET_NAME_STATUS_OK) {
+		goto end;
+	}
+
+	if (has_log_level) {
+		bt_event_class_set_log_level(ec,
+			(bt_event_class_log_level) log_level);
+	}
+
+	if (emf_uri && bt_event_class_set_emf_uri(ec, emf_uri) !=
+			BT_EVENT_CLASS_SET_EMF_URI_STATUS_OK) {
+		goto end;
+	}
+
+	if (create_opt_field_class(src_comp, cursor,
+			bt_stream_class_borrow_trace_class(sc), &fc)) {
+		goto end;
+	}
+
+	if (fc) {
+		if (bt_event_class_set_specific_context_field_class(ec, fc) !=
+				BT_EVENT_CLASS_SET_FIELD_CLASS_STATUS_OK) {
+			goto end;
+		}
+
+		BT_FIELD_CLASS_PUT_REF_AND_RESET(fc);
+	}
+
+	if (create_opt_field_class(src_comp, cursor,
+			bt_stream_class_borrow_trace_class(sc), &fc)) {
+		goto end;
+	}
+
+	if (fc && bt_event_class_set_payload_field_class(ec, fc) !=
+			BT_EVENT_CLASS_SET_FIELD_CLASS_STATUS_OK) {
+		goto end;
+	}
+
+	g_ptr_array_add(src_comp->event_classes, ec);
+	ec = NULL;
+	ret = 0;
+
+end:
+	bt_field_class_put_ref(fc);
+	bt_event_class_put_ref(ec);
+	return ret;
+}
+
+static
+void destroy_cache_src_stream(struct cache_src_stream *src_stream)
+{
+	if (!src_stream) {
+		return;
+	}
+
+	bt_packet_put_ref(src_stream->packet);
+	bt_stream_put_ref(src_stream->stream);
+	g_free(src_stream);
+}
+
+static
+int read_stream(struct cache_src_msg_iter *msg_iter,
+		struct cache_cursor *cursor)
+{
+	struct cache_src_comp *src_comp = msg_iter->src_comp;
+	struct cache_src_stream *src_stream = NULL;
+	bt_trace *trace;
+	bt_stream_class *sc;
+	const char *name;
+	uint64_t id;
+	int ret = -1;
+
+	if (get_object(cursor, msg_iter->traces, (void **) &trace) ||
+			get_object(cursor, src_comp->stream_classes,
+				(void **) &sc) ||
+			get_uvarint(cursor, &id) ||
+			get_opt_str(cursor, &name) ||
+			bt_stream_class_borrow_trace_class(sc) !=
+				bt_trace_borrow_class(trace)) {
+		goto end;
+	}
+
+	src_stream = g_new0(struct cache_src_stream, 1);
+	if (!src_stream) {
+		goto end;
+	}
+
+	src_stream->stream = bt_stream_create_with_id(sc, trace, id);
+	if (!src_stream->stream) {
+		goto end;
+	}
+
+	if (name && bt_stream_set_name(src_stream->stream, name) !=
+			BT_STREAM_SET_NAME_STATUS_OK) {
+		goto end;
+	}
+
+	g_ptr_array_add(msg_iter->streams, src_stream);
+	src_stream = NULL;
+	ret = 0;
+
+end:
+	destroy_cache_src_stream(src_stream);
+	return ret;
+}
+
+/*
+ * Reads the metadata record of type `type` at the cursor, creating
+ * its object unless a previous pass over the file already did.
+ */
+static
+int read_def_record(struct cache_src_msg_iter *msg_iter,
+		enum cache_record_type type, struct cache_cursor *cursor)
+{
+	struct cache_src_comp *src_comp = msg_iter->src_comp;
+	uint64_t id = msg_iter->def_counts[type];
+	GPtrArray *objects;
+	int ret;
+
+	switch (type) {
+	case CACHE_RECORD_TYPE_CLOCK_CLASS:
+		objects = src_comp->clock_classes;
+		break;
+	case CACHE_RECORD_TYPE_TRACE_CLASS:
+		objects = src_comp->trace_classes;
+		break;
+	case CACHE_RECORD_TYPE_TRACE:
+		objects = msg_iter->traces;
+		break;
+	case CACHE_RECORD_TYPE_STREAM_CLASS:
+		objects = src_comp->stream_classes;
+		break;
+	case CACHE_RECORD_TYPE_EVENT_CLASS:
+		objects = src_comp->event_classes;
+		break;
+	case CACHE_RECORD_TYPE_STREAM:
+		objects = msg_iter->streams;
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	if (id < objects->len) {
+		/* Already created */
+		ret = 0;
+		goto end;
+	}
+
+	BT_ASSERT(id == objects->len);
+
+	switch (type) {
+	case CACHE_RECORD_TYPE_CLOCK_CLASS:
+		ret = read_clock_class(src_comp, cursor);
+		break;
+	case CACHE_RECORD_TYPE_TRACE_CLASS:
+		ret = read_trace_class(src_comp, cursor);
+		break;
+	case CACHE_RECORD_TYPE_TRACE:
+		ret = read_trace(msg_iter, cursor);
+		break;
+	case CACHE_RECORD_TYPE_STREAM_CLASS:
+		ret = read_stream_class(src_comp, cursor);
+		break;
+	case CACHE_RECORD_TYPE_EVENT_CLASS:
+		ret = read_event_class(src_comp, cursor);
+		break;
+	case CACHE_RECORD_TYPE_STREAM:
+		ret = read_stream(msg_iter, cursor);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+end:
+	if (ret == 0) {
+		msg_iter->def_counts[type]++;
+	}
+
+	return ret;
+}
+
+static
+bt_message *read_event_msg(struct cache_src_msg_iter *msg_iter,
+		struct cache_cursor *cursor)
+{
+	struct cache_src_comp *src_comp = msg_iter->src_comp;
+	struct cache_src_stream *src_stream;
+	bt_event_class *ec;
+	bt_stream_class *sc;
+	bt_message *msg = NULL;
+	bt_event *event;
+	uint64_t cs = 0;
+
+	if (get_object(cursor, msg_iter->streams, (void **) &src_stream) ||
+			get_object(cursor, src_comp->event_classes,
+				(void **) &ec)) {
+		goto error;
+	}
+
+	sc = bt_stream_borrow_class(src_stream->stream);
+	if (bt_event_class_borrow_stream_class(ec) != sc) {
+		goto error;
+	}
+
+	if (bt_stream_class_borrow_default_clock_class_const(sc) &&
+			get_uvarint(cursor, &cs)) {
+		goto error;
+	}
+
+	if (bt_stream_class_supports_packets(sc)) {
+		if (!src_stream->packet) {
+			goto error;
+		}
+
+		if (bt_stream_class_borrow_default_clock_class_const(sc)) {
+			msg = bt_message_event_create_with_packet_and_default_clock_snapshot(
+				msg_iter->self_msg_iter, ec,
+				src_stream->packet, cs);
+		} else {
+			msg = bt_message_event_create_with_packet(
+				msg_iter->self_msg_iter, ec,
+				src_stream->packet);
+		}
+	} else {
+		if (bt_stream_class_borrow_default_clock_class_const(sc)) {
+			msg = bt_message_event_create_with_default_clock_snapshot(
+				msg_iter->self_msg_iter, ec,
+				src_stream->stream, cs);
+		} else {
+			msg = bt_message_event_create(msg_iter->self_msg_iter,
+				ec, src_stream->stream);
+		}
+	}
+
+	if (!msg) {
+		goto error;
+	}
+
+	event = bt_message_event_borrow_event(msg);
+	if (read_opt_field(cursor,
+				bt_event_borrow_common_context_field(event)) ||
+			read_opt_field(cursor,
+				bt_event_borrow_specific_context_field(event)) ||
+			read_opt_field(cursor,
+				bt_event_borrow_payload_field(event))) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_MESSAGE_PUT_REF_AND_RESET(msg);
+
+end:
+	return msg;
+}
+
+static
+bt_message *read_packet_beginning_msg(struct cache_src_msg_iter *msg_iter,
+		struct cache_src_stream *src_stream,
+		struct cache_cursor *cursor)
+{
+	bt_stream_class *sc = bt_stream_borrow_class(src_stream->stream);
+	bt_packet *packet = NULL;
+	bt_message *msg = NULL;
+	uint64_t cs = 0;
+
+	if (!bt_stream_class_supports_packets(sc) || src_stream->packet) {
+		goto end;
+	}
+
+	if (bt_stream_class_packets_have_beginning_default_clock_snapshot(sc) &&
+			get_uvarint(cursor, &cs)) {
+		goto end;
+	}
+
+	packet = bt_packet_create(src_stream->stream);
+	if (!packet) {
+		goto end;
+	}
+
+	if (read_opt_field(cursor, bt_packet_borrow_context_field(packet))) {
+		goto end;
+	}
+
+	if (bt_stream_class_packets_have_beginning_default_clock_snapshot(sc)) {
+		msg = bt_message_packet_beginning_create_with_default_clock_snapshot(
+			msg_iter->self_msg_iter, packet, cs);
+	} else {
+		msg = bt_message_packet_beginning_create(
+			msg_iter->self_msg_iter, packet);
+	}
+
+	if (msg) {
+		BT_PACKET_MOVE_REF(src_stream->packet, packet);
+	}
+
+end:
+	bt_packet_put_ref(packet);
+	return msg;
+}
+
+static
+bt_message *read_packet_end_msg(struct cache_src_msg_iter *msg_iter,
+		struct cache_src_stream *src_stream,
+		struct cache_cursor *cursor)
+{
+	bt_stream_class *sc = bt_stream_borrow_class(src_stream->stream);
+	bt_message *msg = NULL;
+	uint64_t cs = 0;
+
+	if (!src_stream->packet) {
+		goto end;
+	}
+
+	if (bt_stream_class_packets_have_end_default_clock_snapshot(sc)) {
+		if (get_uvarint(cursor, &cs)) {
+			goto end;
+		}
+
+		msg = bt_message_packet_end_create_with_default_clock_snapshot(
+			msg_iter->self_msg_iter, src_stream->packet, cs);
+	} else {
+		msg = bt_message_packet_end_create(msg_iter->self_msg_iter,
+			src_stream->packet);
+	}
+
+	if (msg) {
+		BT_PACKET_PUT_REF_AND_RESET(src_stream->packet);
+	}
+
+end:
+	return msg;
+}
+
+static
+bt_message *read_discarded_items_msg(struct cache_src_msg_iter *msg_iter,
+		struct cache_src_stream *src_stream,
+		struct cache_cursor *cursor, bool is_events)
+{
+	bt_stream_class *sc = bt_stream_borrow_class(src_stream->stream);
+	bt_message *msg = NULL;
+	bool has_cs;
+	uint64_t beginning_cs = 0;
+	uint64_t end_cs = 0;
+	bool has_count;
+	uint64_t count = 0;
+
+	if (is_events) {
+		if (!bt_stream_class_supports_discarded_events(sc)) {
+			goto end;
+		}
+
+		has_cs = bt_stream_class_discarded_events_have_default_clock_snapshots(
+			sc);
+	} else {
+		if (!bt_stream_class_supports_discarded_packets(sc)) {
+			goto end;
+		}
+
+		has_cs = bt_stream_class_discarded_packets_have_default_clock_snapshots(
+			sc);
+	}
+
+	if ((has_cs && (get_uvarint(cursor, &beginning_cs) ||
+				get_uvarint(cursor, &end_cs) ||
+				beginning_cs > end_cs)) ||
+			get_bool(cursor, &has_count) ||
+			(has_count && (get_uvarint(cursor, &count) ||
+				count == 0))) {
+		goto end;
+	}
+
+	if (is_events) {
+		if (has_cs) {
+			msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+				msg_iter->self_msg_iter, src_stream->stream,
+				beginning_cs, end_cs);
+		} else {
+			msg = bt_message_discarded_events_create(
+				msg_iter->self_msg_iter, src_stream->stream);
+		}
+
+		if (msg && has_count) {
+			bt_message_discarded_events_set_count(msg, count);
+		}
+	} else {
+		if (has_cs) {
+			msg = bt_message_discarded_packets_create_with_default_clock_snapshots(
+				msg_iter->self_msg_iter, src_stream->stream,
+				beginning_cs, end_cs);
+		} else {
+			msg = bt_message_discarded_packets_create(
+				msg_iter->self_msg_iter, src_stream->stream);
+		}
+
+		if (msg && has_count) {
+			bt_message_discarded_packets_set_count(msg, count);
+		}
+	}
+
+end:
+	return msg;
+}
+
+static
+bt_message *read_stream_msg(struct cache_src_msg_iter *msg_iter,
+		enum cache_record_type type, struct cache_cursor *cursor)
+{
+	struct cache_src_stream *src_stream;
+	bt_message *msg = NULL;
+	bool has_cs;
+	uint64_t cs = 0;
+
+	if (get_object(cursor, msg_iter->streams, (void **) &src_stream)) {
+		goto end;
+	}
+
+	switch (type) {
+	case CACHE_RECORD_TYPE_MSG_STREAM_BEGINNING:
+	case CACHE_RECORD_TYPE_MSG_STREAM_END:
+		if (get_bool(cursor, &has_cs) ||
+				(has_cs && get_uvarint(cursor, &cs)) ||
+				(has_cs && !bt_stream_class_borrow_default_clock_class_const(
+					bt_stream_borrow_class(
+						src_stream->stream)))) {
+			goto end;
+		}
+
+		if (type == CACHE_RECORD_TYPE_MSG_STREAM_BEGINNING) {
+			msg = bt_message_stream_beginning_create(
+				msg_iter->self_msg_iter, src_stream->stream);
+			if (msg && has_cs) {
+				bt_message_stream_beginning_set_default_clock_snapshot(
+					msg, cs);
+			}
+		} else {
+			msg = bt_message_stream_end_create(
+				msg_iter->self_msg_iter, src_stream->stream);
+			if (msg && has_cs) {
+				bt_message_stream_end_set_default_clock_snapshot(
+					msg, cs);
+			}
+		}
+
+		break;
+	case CACHE_RECORD_TYPE_MSG_PACKET_BEGINNING:
+		msg = read_packet_beginning_msg(msg_iter, src_stream, cursor);
+		break;
+	case CACHE_RECORD_TYPE_MSG_PACKET_END:
+		msg = read_packet_end_msg(msg_iter, src_stream, cursor);
+		break;
+	case CACHE_RECORD_TYPE_MSG_DISCARDED_EVENTS:
+		msg = read_discarded_items_msg(msg_iter, src_stream, cursor,
+			true);
+		break;
+	case CACHE_RECORD_TYPE_MSG_DISCARDED_PACKETS:
+		msg = read_discarded_items_msg(msg_iter, src_stream, cursor,
+			false);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+end:
+	return msg;
+}
+
+static
+bt_message *read_inactivity_msg(struct cache_src_msg_iter *msg_iter,
+		struct cache_cursor *cursor)
+{
+	bt_clock_class *cc;
+	uint64_t cs;
+
+	if (get_object(cursor, msg_iter->src_comp->clock_classes,
+				(void **) &cc) ||
+			get_uvarint(cursor, &cs)) {
+		return NULL;
+	}
+
+	return bt_message_message_iterator_inactivity_create(
+		msg_iter->self_msg_iter, cc, cs);
+}
+
+/*
+ * Reads the records from the current offset until a message record,
+ * setting `*msg` to the new message, or until the end record.
+ */
+static
+bt_message_iterator_class_next_method_status cache_src_msg_iter_next_one(
+		struct cache_src_msg_iter *msg_iter, bt_message **msg)
+{
+	struct cache_src_comp *src_comp = msg_iter->src_comp;
+	bt_message_iterator_class_next_method_status status;
+
+	*msg = NULL;
+
+	while (!*msg) {
+		struct cache_cursor cursor;
+		uint8_t type;
+		uint64_t size;
+
+		if (msg_iter->done) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+			goto end;
+		}
+
+		if (msg_iter->offset == src_comp->size) {
+			BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+				"Cache file is incomplete (no end record): "
+				"path=\"%s\"", src_comp->path);
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		cursor.at = &src_comp->data[msg_iter->offset];
+		cursor.end = &src_comp->data[src_comp->size];
+		if (get_u8(&cursor, &type) || get_uvarint(&cursor, &size) ||
+				size > (uint64_t) (cursor.end - cursor.at)) {
+			goto invalid_record;
+		}
+
+		cursor.end = cursor.at + size;
+
+		switch (type) {
+		case CACHE_RECORD_TYPE_CLOCK_CLASS:
+		case CACHE_RECORD_TYPE_TRACE_CLASS:
+		case CACHE_RECORD_TYPE_TRACE:
+		case CACHE_RECORD_TYPE_STREAM_CLASS:
+		case CACHE_RECORD_TYPE_EVENT_CLASS:
+		case CACHE_RECORD_TYPE_STREAM:
+			if (read_def_record(msg_iter, type, &cursor)) {
+				goto invalid_record;
+			}
+
+			break;
+		case CACHE_RECORD_TYPE_MSG_EVENT:
+			*msg = read_event_msg(msg_iter, &cursor);
+			if (!*msg) {
+				goto invalid_record;
+			}
+
+			break;
+		case CACHE_RECORD_TYPE_MSG_STREAM_BEGINNING:
+		case CACHE_RECORD_TYPE_MSG_STREAM_END:
+		case CACHE_RECORD_TYPE_MSG_PACKET_BEGINNING:
+		case CACHE_RECORD_TYPE_MSG_PACKET_END:
+		case CACHE_RECORD_TYPE_MSG_DISCARDED_EVENTS:
+		case CACHE_RECORD_TYPE_MSG_DISCARDED_PACKETS:
+			*msg = read_stream_msg(msg_iter, type, &cursor);
+			if (!*msg) {
+				goto invalid_record;
+			}
+
+			break;
+		case CACHE_RECORD_TYPE_MSG_MESSAGE_ITERATOR_INACTIVITY:
+			*msg = read_inactivity_msg(msg_iter, &cursor);
+			if (!*msg) {
+				goto invalid_record;
+			}
+
+			break;
+		case CACHE_RECORD_TYPE_END:
+			msg_iter->done = true;
+			break;
+		default:
+			goto invalid_record;
+		}
+
+		msg_iter->offset = cursor.end - src_comp->data;
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	goto end;
+
+invalid_record:
+	BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+		"Cannot read cache file record: path=\"%s\", offset=%" G_GSIZE_FORMAT,
+		src_comp->path, msg_iter->offset);
+	BT_MESSAGE_PUT_REF_AND_RESET(*msg);
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_next_method_status cache_src_msg_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct cache_src_msg_iter *msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	uint64_t i = 0;
+
+	while (i < capacity &&
+			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		bt_message *msg = NULL;
+
+		status = cache_src_msg_iter_next_one(msg_iter, &msg);
+		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			msgs[i] = msg;
+			i++;
+		}
+	}
+
+	if (i > 0) {
+		/*
+		 * Even if cache_src_msg_iter_next_one() returned
+		 * something else than
+		 * BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK, we
+		 * accumulated message objects in the output message
+		 * array, so we need to return
+		 * BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK so
+		 * that they are transfered to downstream. This other
+		 * status occurs again the next time
+		 * cache_src_msg_iter_next() is called, possibly without
+		 * any accumulated message, in which case we'll return
+		 * it.
+		 */
+		*count = i;
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	}
+
+	return status;
+}
+
+static
+void reset_cache_src_msg_iter(struct cache_src_msg_iter *msg_iter)
+{
+	guint i;
+
+	for (i = 0; i < msg_iter->streams->len; i++) {
+		struct cache_src_stream *src_stream =
+			g_ptr_array_index(msg_iter->streams, i);
+
+		BT_PACKET_PUT_REF_AND_RESET(src_stream->packet);
+	}
+
+	memset(msg_iter->def_counts, 0, sizeof(msg_iter->def_counts));
+	msg_iter->offset = HEADER_LEN;
+	msg_iter->done = false;
+}
+
+static
+void destroy_cache_src_msg_iter(struct cache_src_msg_iter *msg_iter)
+{
+	if (!msg_iter) {
+		return;
+	}
+
+	if (msg_iter->streams) {
+		g_ptr_array_free(msg_iter->streams, TRUE);
+	}
+
+	if (msg_iter->traces) {
+		g_ptr_array_free(msg_iter->traces, TRUE);
+	}
+
+	g_free(msg_iter);
+}
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status cache_src_msg_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *self_port)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	struct cache_src_comp *src_comp = bt_self_component_get_data(self_comp);
+	struct cache_src_msg_iter *msg_iter =
+		g_new0(struct cache_src_msg_iter, 1);
+	bt_message_iterator_class_initialize_method_status status;
+
+	if (!msg_iter) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate one cache message iterator structure.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	BT_ASSERT(src_comp);
+	msg_iter->src_comp = src_comp;
+	msg_iter->self_msg_iter = self_msg_iter;
+	msg_iter->traces = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_trace_put_ref);
+	msg_iter->streams = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_cache_src_stream);
+	if (!msg_iter->traces || !msg_iter->streams) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a GPtrArray.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	reset_cache_src_msg_iter(msg_iter);
+	bt_self_message_iterator_set_data(self_msg_iter, msg_iter);
+	status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_cache_src_msg_iter(msg_iter);
+	bt_self_message_iterator_set_data(self_msg_iter, NULL);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void cache_src_msg_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	destroy_cache_src_msg_iter(bt_self_message_iterator_get_data(
+		self_msg_iter));
+}
+
+BT_HIDDEN
+bt_message_iterator_class_seek_beginning_method_status
+cache_src_msg_iter_seek_beginning(bt_self_message_iterator *self_msg_iter)
+{
+	reset_cache_src_msg_iter(bt_self_message_iterator_get_data(
+		self_msg_iter));
+	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
+}
+
+static
+void destroy_cache_src_comp(struct cache_src_comp *src_comp)
+{
+	if (!src_comp) {
+		return;
+	}
+
+	if (src_comp->event_classes) {
+		g_ptr_array_free(src_comp->event_classes, TRUE);
+	}
+
+	if (src_comp->stream_classes) {
+		g_ptr_array_free(src_comp->stream_classes, TRUE);
+	}
+
+	if (src_comp->trace_classes) {
+		g_ptr_array_free(src_comp->trace_classes, TRUE);
+	}
+
+	if (src_comp->clock_classes) {
+		g_ptr_array_free(src_comp->clock_classes, TRUE);
+	}
+
+	if (src_comp->mapped_file) {
+		g_mapped_file_unref(src_comp->mapped_file);
+	}
+
+	g_free(src_comp->path);
+	g_free(src_comp);
+}
+
+static
+bt_component_class_initialize_method_status open_cache_file(
+		struct cache_src_comp *src_comp)
+{
+	bt_component_class_initialize_method_status status;
+	GError *error = NULL;
+
+	src_comp->mapped_file = g_mapped_file_new(src_comp->path, FALSE,
+		&error);
+	if (!src_comp->mapped_file) {
+		BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+			"Cannot map cache file: path=\"%s\", error=\"%s\"",
+			src_comp->path, error->message);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	src_comp->data = (const uint8_t *) g_mapped_file_get_contents(
+		src_comp->mapped_file);
+	src_comp->size = g_mapped_file_get_length(src_comp->mapped_file);
+	if (src_comp->size < HEADER_LEN ||
+			memcmp(src_comp->data, CACHE_FORMAT_MAGIC,
+				CACHE_FORMAT_MAGIC_LEN) != 0) {
+		BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+			"File is not a message cache file: path=\"%s\"",
+			src_comp->path);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (src_comp->data[CACHE_FORMAT_MAGIC_LEN] != CACHE_FORMAT_VERSION) {
+		BT_COMP_LOGE_APPEND_CAUSE(src_comp->self_comp,
+			"Unsupported message cache file version: "
+			"path=\"%s\", version=%u, expected-version=%u",
+			src_comp->path,
+			(unsigned int) src_comp->data[CACHE_FORMAT_MAGIC_LEN],
+			(unsigned int) CACHE_FORMAT_VERSION);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status cache_src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	struct cache_src_comp *src_comp = g_new0(struct cache_src_comp, 1);
+	bt_component_class_initialize_method_status status;
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	const bt_component *comp = bt_self_component_as_component(self_comp);
+	bt_logging_level log_level = bt_component_get_logging_level(comp);
+	bt_self_component_add_port_status add_port_status;
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+
+	if (!src_comp) {
+		/*
+		 * Don't use BT_COMP_LOGE_APPEND_CAUSE, as `src_comp` is
+		 * not initialized.
+		 */
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+			"Failed to allocate one cache component structure.");
+		BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_FROM_COMPONENT(self_comp,
+			"Failed to allocate one cache component structure.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	src_comp->log_level = log_level;
+	src_comp->self_comp = self_comp;
+	validation_status = bt_param_validation_validate(params,
+		cache_src_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "%s", validate_error);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto error;
+	}
+
+	src_comp->path = g_strdup(bt_value_string_get(
+		bt_value_map_borrow_entry_value_const(params, "path")));
+	src_comp->clock_classes = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_clock_class_put_ref);
+	src_comp->trace_classes = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_trace_class_put_ref);
+	src_comp->stream_classes = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_stream_class_put_ref);
+	src_comp->event_classes = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_event_class_put_ref);
+	if (!src_comp->clock_classes || !src_comp->trace_classes ||
+			!src_comp->stream_classes ||
+			!src_comp->event_classes) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a GPtrArray.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	status = open_cache_file(src_comp);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to add output port.");
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	bt_self_component_set_data(self_comp, src_comp);
+	BT_COMP_LOGI("Component initialized: path=\"%s\", size=%" G_GSIZE_FORMAT,
+		src_comp->path, src_comp->size);
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_cache_src_comp(src_comp);
+	bt_self_component_set_data(self_comp, NULL);
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+void cache_src_finalize(bt_self_component_source *self_comp)
+{
+	destroy_cache_src_comp(bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp)));
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SRC_H
+#define BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SRC_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+BT_HIDDEN
+bt_component_class_initialize_method_status cache_src_init(
+		bt_self_component_source *self_comp,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void cache_src_finalize(bt_self_component_source *self_comp);
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status cache_src_msg_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *self_port);
+
+BT_HIDDEN
+void cache_src_msg_iter_finalize(bt_self_message_iterator *self_msg_iter);
+
+BT_HIDDEN
+bt_message_iterator_class_next_method_status cache_src_msg_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count);
+
+BT_HIDDEN
+bt_message_iterator_class_seek_beginning_method_status
+cache_src_msg_iter_seek_beginning(bt_self_message_iterator *self_msg_iter);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_CACHE_CACHE_SRC_H */
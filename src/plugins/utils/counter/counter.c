@@ -47,6 +47,51 @@ uint64_t get_total_count(struct counter *counter)
 		counter->count.other;
 }
 
+static
+void print_rates(struct counter *counter, uint64_t total)
+{
+	int64_t now = counter->rates.last_time;
+	double elapsed_s;
+
+	if (counter->rates.begin_time < 0 ||
+			now <= counter->rates.begin_time) {
+		/* Not enough time to compute anything */
+		goto end;
+	}
+
+	if (now > counter->rates.last_printed_time) {
+		printf("%15.0f messages/s (since last block)\n",
+			(double) (total - counter->rates.last_printed_total) *
+				G_USEC_PER_SEC /
+				(double) (now - counter->rates.last_printed_time));
+	}
+
+	elapsed_s = (double) (now - counter->rates.begin_time) /
+		G_USEC_PER_SEC;
+	printf("%15.0f messages/s (average)\n", (double) total / elapsed_s);
+
+	if (counter->rates.packet_bits > 0) {
+		printf("%15.0f packet bytes/s (average)\n",
+			(double) counter->rates.packet_bits / 8 / elapsed_s);
+	}
+
+	if (counter->rates.has_ns_from_origin &&
+			counter->rates.origin_is_unix_epoch) {
+		/* Wall clock time (µs) -> ns */
+		int64_t lag_ns = g_get_real_time() * 1000 -
+			counter->rates.last_ns_from_origin;
+
+		printf("%15.3f s of lag behind wall clock time\n",
+			(double) lag_ns / 1e9);
+	}
+
+	counter->rates.last_printed_time = now;
+	counter->rates.last_printed_total = total;
+
+end:
+	return;
+}
+
 static
 void print_count(struct counter *counter)
 {
@@ -69,6 +114,176 @@ void print_count(struct counter *counter)
 		bt_common_color_bold(), total, total == 1 ? "" : "s",
 		bt_common_color_reset());
 	counter->last_printed_total = total;
+
+	if (counter->with_rates) {
+		print_rates(counter, total);
+	}
+}
+
+struct ec_row {
+	const bt_stream_class *sc;
+	uint64_t ec_id;
+	uint64_t count;
+};
+
+struct stream_row {
+	const bt_stream *stream;
+	uint64_t count;
+};
+
+static
+gint compare_ec_rows(gconstpointer a, gconstpointer b)
+{
+	const struct ec_row *row_a = a;
+	const struct ec_row *row_b = b;
+	uint64_t sc_id_a = bt_stream_class_get_id(row_a->sc);
+	uint64_t sc_id_b = bt_stream_class_get_id(row_b->sc);
+
+	/* Largest count first, then by IDs */
+	if (row_a->count != row_b->count) {
+		return row_a->count > row_b->count ? -1 : 1;
+	} else if (sc_id_a != sc_id_b) {
+		return sc_id_a < sc_id_b ? -1 : 1;
+	} else if (row_a->ec_id != row_b->ec_id) {
+		return row_a->ec_id < row_b->ec_id ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static
+gint compare_stream_rows(gconstpointer a, gconstpointer b)
+{
+	const struct stream_row *row_a = a;
+	const struct stream_row *row_b = b;
+	uint64_t id_a = bt_stream_get_id(row_a->stream);
+	uint64_t id_b = bt_stream_get_id(row_b->stream);
+
+	/* Largest count first, then by ID */
+	if (row_a->count != row_b->count) {
+		return row_a->count > row_b->count ? -1 : 1;
+	} else if (id_a != id_b) {
+		return id_a < id_b ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static
+void print_ec_table(struct counter *counter)
+{
+	GArray *rows = g_array_new(FALSE, FALSE, sizeof(struct ec_row));
+	GHashTableIter iter;
+	gpointer key, value;
+	uint64_t i;
+
+	/* Gather non-zero counts */
+	g_hash_table_iter_init(&iter, counter->stream_classes);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		struct counter_stream_class *counter_sc = value;
+		struct ec_row row = { .sc = counter_sc->sc };
+
+		for (i = 0; i < counter_sc->counts->len; i++) {
+			row.ec_id = i;
+			row.count = g_array_index(counter_sc->counts,
+				uint64_t, i);
+			if (row.count > 0) {
+				g_array_append_val(rows, row);
+			}
+		}
+
+		if (counter_sc->sparse_counts) {
+			GHashTableIter sparse_iter;
+			gpointer sparse_key, sparse_value;
+
+			g_hash_table_iter_init(&sparse_iter,
+				counter_sc->sparse_counts);
+
+			while (g_hash_table_iter_next(&sparse_iter,
+					&sparse_key, &sparse_value)) {
+				row.ec_id = *(uint64_t *) sparse_key;
+				row.count = *(uint64_t *) sparse_value;
+				g_array_append_val(rows, row);
+			}
+		}
+	}
+
+	g_array_sort(rows, compare_ec_rows);
+	printf("\n%sTop %" PRIu64 " event classes%s\n",
+		bt_common_color_bold(), counter->top,
+		bt_common_color_reset());
+
+	/* Resolve names only now */
+	for (i = 0; i < rows->len && i < counter->top; i++) {
+		const struct ec_row *row = &g_array_index(rows,
+			struct ec_row, i);
+		const bt_event_class *ec =
+			bt_stream_class_borrow_event_class_by_id_const(
+				row->sc, row->ec_id);
+		const char *name = ec ? bt_event_class_get_name(ec) : NULL;
+
+		if (name) {
+			printf("%15" PRIu64 " `%s` event%s", row->count,
+				name, row->count == 1 ? "" : "s");
+		} else {
+			printf("%15" PRIu64 " unnamed event%s", row->count,
+				row->count == 1 ? "" : "s");
+		}
+
+		printf(" (event class ID %" PRIu64 ", stream class ID %" PRIu64 ")\n",
+			row->ec_id, bt_stream_class_get_id(row->sc));
+	}
+
+	g_array_free(rows, TRUE);
+}
+
+static
+void print_stream_table(struct counter *counter)
+{
+	GArray *rows = g_array_new(FALSE, FALSE, sizeof(struct stream_row));
+	GHashTableIter iter;
+	gpointer key, value;
+	uint64_t i;
+
+	g_hash_table_iter_init(&iter, counter->streams);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		struct counter_stream *counter_stream = value;
+		struct stream_row row = {
+			.stream = counter_stream->stream,
+			.count = counter_stream->count,
+		};
+
+		g_array_append_val(rows, row);
+	}
+
+	g_array_sort(rows, compare_stream_rows);
+	printf("\n%sTop %" PRIu64 " streams%s\n",
+		bt_common_color_bold(), counter->top,
+		bt_common_color_reset());
+
+	for (i = 0; i < rows->len && i < counter->top; i++) {
+		const struct stream_row *row = &g_array_index(rows,
+			struct stream_row, i);
+		const char *name = bt_stream_get_name(row->stream);
+
+		printf("%15" PRIu64 " event%s in stream ", row->count,
+			row->count == 1 ? "" : "s");
+
+		if (name) {
+			printf("`%s` (stream ID %" PRIu64 ", ", name,
+				bt_stream_get_id(row->stream));
+		} else {
+			printf("ID %" PRIu64 " (", bt_stream_get_id(row->stream));
+		}
+
+		printf("stream class ID %" PRIu64 ")\n",
+			bt_stream_class_get_id(
+				bt_stream_borrow_class_const(row->stream)));
+	}
+
+	g_array_free(rows, TRUE);
 }
 
 static
@@ -96,6 +311,309 @@ void try_print_last(struct counter *counter)
 	if (total != counter->last_printed_total) {
 		print_count(counter);
 	}
+
+	if (counter->top > 0 && !counter->printed_tables) {
+		print_ec_table(counter);
+		print_stream_table(counter);
+		counter->printed_tables = true;
+	}
+}
+
+static
+void destroy_counter_stream_class(struct counter_stream_class *counter_sc)
+{
+	if (!counter_sc) {
+		return;
+	}
+
+	bt_stream_class_put_ref(counter_sc->sc);
+
+	if (counter_sc->counts) {
+		g_array_free(counter_sc->counts, TRUE);
+	}
+
+	if (counter_sc->sparse_counts) {
+		g_hash_table_destroy(counter_sc->sparse_counts);
+	}
+
+	g_free(counter_sc);
+}
+
+static
+void destroy_counter_stream(struct counter_stream *counter_stream)
+{
+	if (!counter_stream) {
+		return;
+	}
+
+	bt_stream_put_ref(counter_stream->stream);
+	g_free(counter_stream);
+}
+
+static
+struct counter_stream_class *borrow_counter_stream_class(
+		struct counter *counter, const bt_stream_class *sc)
+{
+	struct counter_stream_class *counter_sc =
+		g_hash_table_lookup(counter->stream_classes, sc);
+
+	if (!counter_sc) {
+		counter_sc = g_new0(struct counter_stream_class, 1);
+		counter_sc->sc = sc;
+		bt_stream_class_get_ref(sc);
+		counter_sc->counts = g_array_new(FALSE, TRUE,
+			sizeof(uint64_t));
+		g_hash_table_insert(counter->stream_classes, (gpointer) sc,
+			counter_sc);
+	}
+
+	return counter_sc;
+}
+
+static
+struct counter_stream *borrow_counter_stream(struct counter *counter,
+		const bt_stream *stream)
+{
+	struct counter_stream *counter_stream =
+		g_hash_table_lookup(counter->streams, stream);
+
+	if (!counter_stream) {
+		counter_stream = g_new0(struct counter_stream, 1);
+		counter_stream->stream = stream;
+		bt_stream_get_ref(stream);
+		g_hash_table_insert(counter->streams, (gpointer) stream,
+			counter_stream);
+	}
+
+	return counter_stream;
+}
+
+static
+void count_sparse_ec_id(struct counter_stream_class *counter_sc,
+		uint64_t ec_id, uint64_t event_count)
+{
+	uint64_t *count;
+
+	if (!counter_sc->sparse_counts) {
+		counter_sc->sparse_counts = g_hash_table_new_full(
+			g_int64_hash, g_int64_equal, g_free, g_free);
+	}
+
+	count = g_hash_table_lookup(counter_sc->sparse_counts, &ec_id);
+	if (!count) {
+		uint64_t *key = g_new(uint64_t, 1);
+
+		*key = ec_id;
+		count = g_new0(uint64_t, 1);
+		g_hash_table_insert(counter_sc->sparse_counts, key, count);
+	}
+
+	*count += event_count;
+}
+
+/*
+ * Returns the default clock snapshot of `msg`, or `NULL` if it has
+ * none.
+ */
+static
+const bt_clock_snapshot *borrow_default_clock_snapshot(const bt_message *msg)
+{
+	const bt_clock_snapshot *cs = NULL;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		if (bt_message_event_borrow_stream_class_default_clock_class_const(
+				msg)) {
+			cs = bt_message_event_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+	{
+		const bt_stream_class *sc = bt_stream_borrow_class_const(
+			bt_packet_borrow_stream_const(
+				bt_message_packet_beginning_borrow_packet_const(
+					msg)));
+
+		if (bt_stream_class_packets_have_beginning_default_clock_snapshot(
+				sc)) {
+			cs = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	}
+	case BT_MESSAGE_TYPE_PACKET_END:
+	{
+		const bt_stream_class *sc = bt_stream_borrow_class_const(
+			bt_packet_borrow_stream_const(
+				bt_message_packet_end_borrow_packet_const(
+					msg)));
+
+		if (bt_stream_class_packets_have_end_default_clock_snapshot(
+				sc)) {
+			cs = bt_message_packet_end_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		break;
+	}
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+		cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+			msg);
+		break;
+	default:
+		break;
+	}
+
+	return cs;
+}
+
+/* Adds the `packet_size` packet context field of `msg`, if any */
+static
+void count_packet_size(struct counter *counter, const bt_message *msg)
+{
+	const bt_field *ctx_field = bt_packet_borrow_context_field_const(
+		bt_message_packet_beginning_borrow_packet_const(msg));
+	const bt_field *size_field;
+
+	if (!ctx_field) {
+		return;
+	}
+
+	size_field = bt_field_structure_borrow_member_field_by_name_const(
+		ctx_field, "packet_size");
+	if (size_field && bt_field_class_type_is(
+			bt_field_get_class_type(size_field),
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		counter->rates.packet_bits +=
+			bt_field_integer_unsigned_get_value(size_field);
+	}
+}
+
+/*
+ * Samples the time of the last event of the event batch message `msg`.
+ *
+ * Returns whether or not `msg` has a time.
+ */
+static
+bool sample_event_batch_time(struct counter *counter, const bt_message *msg)
+{
+	const bt_clock_class *cc =
+		bt_stream_class_borrow_default_clock_class_const(
+			bt_stream_borrow_class_const(
+				bt_message_event_batch_borrow_stream_const(msg)));
+	uint64_t event_count = bt_message_event_batch_get_event_count(msg);
+	int64_t ns_from_origin;
+
+	if (!cc || event_count == 0) {
+		return false;
+	}
+
+	if (bt_clock_class_cycles_to_ns_from_origin(cc,
+			bt_message_event_batch_borrow_default_clock_snapshot_values_const(
+				msg)[event_count - 1], &ns_from_origin) ==
+			BT_CLOCK_CLASS_CYCLES_TO_NS_FROM_ORIGIN_STATUS_OK) {
+		counter->rates.has_ns_from_origin = true;
+		counter->rates.last_ns_from_origin = ns_from_origin;
+		counter->rates.origin_is_unix_epoch =
+			bt_clock_class_origin_is_unix_epoch(cc);
+	}
+
+	return true;
+}
+
+/*
+ * Samples the monotonic clock and the time of the last message of the
+ * consumed batch `msgs`.
+ */
+static
+void sample_batch(struct counter *counter, bt_message_array_const msgs,
+		uint64_t msg_count)
+{
+	uint64_t i;
+
+	counter->rates.last_time = g_get_monotonic_time();
+
+	if (counter->rates.begin_time < 0) {
+		counter->rates.begin_time = counter->rates.last_time;
+		counter->rates.last_printed_time = counter->rates.last_time;
+	}
+
+	/* Last message having a time */
+	for (i = msg_count; i > 0; i--) {
+		const bt_clock_snapshot *cs;
+		int64_t ns_from_origin;
+
+		if (bt_message_get_type(msgs[i - 1]) ==
+				BT_MESSAGE_TYPE_EVENT_BATCH) {
+			if (sample_event_batch_time(counter, msgs[i - 1])) {
+				break;
+			}
+
+			continue;
+		}
+
+		cs = borrow_default_clock_snapshot(msgs[i - 1]);
+		if (!cs) {
+			continue;
+		}
+
+		if (bt_clock_snapshot_get_ns_from_origin(cs,
+				&ns_from_origin) ==
+				BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+			counter->rates.has_ns_from_origin = true;
+			counter->rates.last_ns_from_origin = ns_from_origin;
+			counter->rates.origin_is_unix_epoch =
+				bt_clock_class_origin_is_unix_epoch(
+					bt_clock_snapshot_borrow_clock_class_const(
+						cs));
+		}
+
+		break;
+	}
+}
+
+/*
+ * Counts `count` events of the class `ec` in the stream `stream` per
+ * event class and per stream.
+ */
+static inline
+void count_events(struct counter *counter, const bt_stream *stream,
+		const bt_event_class *ec, uint64_t count)
+{
+	const bt_stream_class *sc = bt_stream_borrow_class_const(stream);
+	uint64_t ec_id = bt_event_class_get_id(ec);
+	struct counter_stream_class *counter_sc = counter->last_sc;
+	struct counter_stream *counter_stream = counter->last_stream;
+
+	/*
+	 * The entries own their stream and stream class, so comparing
+	 * addresses is safe.
+	 */
+	if (G_UNLIKELY(!counter_stream || counter_stream->stream != stream)) {
+		counter_stream = borrow_counter_stream(counter, stream);
+		counter->last_stream = counter_stream;
+	}
+
+	counter_stream->count += count;
+
+	if (G_UNLIKELY(!counter_sc || counter_sc->sc != sc)) {
+		counter_sc = borrow_counter_stream_class(counter, sc);
+		counter->last_sc = counter_sc;
+	}
+
+	if (G_LIKELY(ec_id < COUNTER_MAX_DENSE_EC_ID)) {
+		if (G_UNLIKELY(ec_id >= counter_sc->counts->len)) {
+			/* New elements are cleared */
+			g_array_set_size(counter_sc->counts, ec_id + 1);
+		}
+
+		g_array_index(counter_sc->counts, uint64_t, ec_id) += count;
+	} else {
+		count_sparse_ec_id(counter_sc, ec_id, count);
+	}
 }
 
 static
@@ -104,6 +622,15 @@ void destroy_private_counter_data(struct counter *counter)
 	if (counter) {
 		bt_message_iterator_put_ref(
 			counter->msg_iter);
+
+		if (counter->stream_classes) {
+			g_hash_table_destroy(counter->stream_classes);
+		}
+
+		if (counter->streams) {
+			g_hash_table_destroy(counter->streams);
+		}
+
 		g_free(counter);
 	}
 }
@@ -118,14 +645,29 @@ void counter_finalize(bt_self_component_sink *comp)
 			bt_self_component_sink_as_self_component(comp));
 	BT_ASSERT(counter);
 	try_print_last(counter);
-	bt_message_iterator_put_ref(counter->msg_iter);
-	g_free(counter);
+	destroy_private_counter_data(counter);
+}
+
+/* MIP version 1 adds event batch messages, which this sink counts */
+BT_HIDDEN
+bt_component_class_get_supported_mip_versions_method_status
+counter_get_supported_mip_versions(
+		__attribute__((unused)) bt_self_component_class_sink *self_component_class,
+		__attribute__((unused)) const bt_value *params,
+		__attribute__((unused)) void *initialize_method_data,
+		__attribute__((unused)) bt_logging_level logging_level,
+		bt_integer_range_set_unsigned *supported_versions)
+{
+	return (int) bt_integer_range_set_unsigned_add_range(
+		supported_versions, 0, 1);
 }
 
 static
 struct bt_param_validation_map_value_entry_descr counter_params[] = {
 	{ "step", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	{ "hide-zero", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "top", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "with-rates", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -141,6 +683,8 @@ bt_component_class_initialize_method_status counter_init(
 	struct counter *counter = g_new0(struct counter, 1);
 	const bt_value *step = NULL;
 	const bt_value *hide_zero = NULL;
+	const bt_value *top = NULL;
+	const bt_value *with_rates = NULL;
 	enum bt_param_validation_status validation_status;
 	gchar *validate_error = NULL;
 
@@ -184,6 +728,29 @@ bt_component_class_initialize_method_status counter_init(
 		counter->hide_zero = (bool) bt_value_bool_get(hide_zero);
 	}
 
+	top = bt_value_map_borrow_entry_value_const(params, "top");
+	if (top) {
+		counter->top = bt_value_integer_unsigned_get(top);
+	}
+
+	with_rates = bt_value_map_borrow_entry_value_const(params,
+		"with-rates");
+	if (with_rates) {
+		counter->with_rates = (bool) bt_value_bool_get(with_rates);
+	}
+
+	counter->rates.begin_time = -1;
+	counter->rates.last_time = -1;
+
+	if (counter->top > 0) {
+		counter->stream_classes = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal, NULL,
+			(GDestroyNotify) destroy_counter_stream_class);
+		counter->streams = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal, NULL,
+			(GDestroyNotify) destroy_counter_stream);
+	}
+
 	bt_self_component_set_data(
 		bt_self_component_sink_as_self_component(component),
 		counter);
@@ -264,6 +831,10 @@ bt_component_class_sink_consume_method_status counter_consume(
 	{
 		uint64_t i;
 
+		if (counter->with_rates) {
+			sample_batch(counter, msgs, msg_count);
+		}
+
 		for (i = 0; i < msg_count; i++) {
 			const bt_message *msg = msgs[i];
 
@@ -271,9 +842,40 @@ bt_component_class_sink_consume_method_status counter_consume(
 			switch (bt_message_get_type(msg)) {
 			case BT_MESSAGE_TYPE_EVENT:
 				counter->count.event++;
+
+				if (counter->top > 0) {
+					const bt_event *event =
+						bt_message_event_borrow_event_const(msg);
+
+					count_events(counter,
+						bt_event_borrow_stream_const(event),
+						bt_event_borrow_class_const(event), 1);
+				}
+
 				break;
+			case BT_MESSAGE_TYPE_EVENT_BATCH:
+			{
+				uint64_t event_count =
+					bt_message_event_batch_get_event_count(msg);
+
+				counter->count.event += event_count;
+
+				if (counter->top > 0 && event_count > 0) {
+					count_events(counter,
+						bt_message_event_batch_borrow_stream_const(msg),
+						bt_message_event_batch_borrow_event_class_const(msg),
+						event_count);
+				}
+
+				break;
+			}
 			case BT_MESSAGE_TYPE_PACKET_BEGINNING:
 				counter->count.packet_begin++;
+
+				if (counter->with_rates) {
+					count_packet_size(counter, msg);
+				}
+
 				break;
 			case BT_MESSAGE_TYPE_PACKET_END:
 				counter->count.packet_end++;
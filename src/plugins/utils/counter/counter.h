@@ -13,6 +13,35 @@
 #include <stdint.h>
 #include "common/macros.h"
 
+/* Event class IDs under this are counted in a dense array */
+#define COUNTER_MAX_DENSE_EC_ID	(UINT64_C(1) << 16)
+
+/* Event counts of the event classes of a stream class */
+struct counter_stream_class {
+	/* Owned by this */
+	const bt_stream_class *sc;
+
+	/*
+	 * `uint64_t` counts indexed by event class ID, for the IDs under
+	 * `COUNTER_MAX_DENSE_EC_ID`
+	 */
+	GArray *counts;
+
+	/*
+	 * `uint64_t *` (owned by this) event class ID -> `uint64_t *`
+	 * count (owned by this), for the other IDs; `NULL` until needed
+	 */
+	GHashTable *sparse_counts;
+};
+
+/* Event count of a stream */
+struct counter_stream {
+	/* Owned by this */
+	const bt_stream *stream;
+
+	uint64_t count;
+};
+
 struct counter {
 	bt_message_iterator *msg_iter;
 	struct {
@@ -30,10 +59,76 @@ struct counter {
 	uint64_t at;
 	uint64_t step;
 	bool hide_zero;
+
+	/*
+	 * Number of rows of the per event class and per stream tables
+	 * (`top` parameter),
+	 * or 0 to not count events per event class and per stream
+	 */
+	uint64_t top;
+
+	/*
+	 * `const bt_stream_class *` (weak: owned by the value) ->
+	 * `struct counter_stream_class *` (owned by this)
+	 */
+	GHashTable *stream_classes;
+
+	/*
+	 * `const bt_stream *` (weak: owned by the value) ->
+	 * `struct counter_stream *` (owned by this)
+	 */
+	GHashTable *streams;
+
+	/*
+	 * Entries of the last event's stream class and stream (weak),
+	 * as consecutive events very often share them
+	 */
+	struct counter_stream_class *last_sc;
+	struct counter_stream *last_stream;
+
+	/* True if the tables above were printed */
+	bool printed_tables;
+
+	/* Rate and lag reporting (`with-rates` parameter) */
+	bool with_rates;
+	struct {
+		/*
+		 * Monotonic times (µs), sampled once per consumed
+		 * batch, of the first batch and of the last one, or -1
+		 * before the first batch
+		 */
+		int64_t begin_time;
+		int64_t last_time;
+
+		/* Monotonic time (µs) and total count of the last block */
+		int64_t last_printed_time;
+		uint64_t last_printed_total;
+
+		/* Sum of the `packet_size` packet context fields (bits) */
+		uint64_t packet_bits;
+
+		/*
+		 * Nanoseconds from origin of the last consumed message
+		 * having a default clock snapshot, if
+		 * `has_ns_from_origin` is true, and whether or not its
+		 * clock class's origin is the Unix epoch
+		 */
+		bool has_ns_from_origin;
+		int64_t last_ns_from_origin;
+		bool origin_is_unix_epoch;
+	} rates;
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
 };
 
+BT_HIDDEN
+bt_component_class_get_supported_mip_versions_method_status
+counter_get_supported_mip_versions(
+		bt_self_component_class_sink *self_component_class,
+		const bt_value *params, void *initialize_method_data,
+		bt_logging_level logging_level,
+		bt_integer_range_set_unsigned *supported_versions);
+
 BT_HIDDEN
 bt_component_class_initialize_method_status counter_init(
 		bt_self_component_sink *component,
@@ -10,18 +10,54 @@
 #include "logging/comp-logging.h"
 
 #include <babeltrace2/babeltrace.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 #include "common/macros.h"
 #include "common/assert.h"
+#include "common/common.h"
 #include "dummy.h"
 #include "plugins/common/param-validation/param-validation.h"
 
+#define FNV_PRIME	UINT64_C(0x100000001b3)
+
 static
 const char * const in_port_name = "in";
 
+static
+void destroy_resolved_field_paths(gpointer data)
+{
+	GArray *resolved_paths = data;
+	guint i;
+
+	for (i = 0; i < resolved_paths->len; i++) {
+		common_resolved_field_path_fini(&g_array_index(
+			resolved_paths, struct common_resolved_field_path, i));
+	}
+
+	g_array_free(resolved_paths, TRUE);
+}
+
 static
 void destroy_private_dummy_data(struct dummy *dummy)
 {
 	bt_message_iterator_put_ref(dummy->msg_iter);
+
+	if (dummy->field_paths) {
+		guint i;
+
+		for (i = 0; i < dummy->field_paths->len; i++) {
+			common_field_path_fini(&g_array_index(
+				dummy->field_paths, struct common_field_path, i));
+		}
+
+		g_array_free(dummy->field_paths, TRUE);
+	}
+
+	if (dummy->resolved_field_paths) {
+		g_hash_table_destroy(dummy->resolved_field_paths);
+	}
+
 	g_free(dummy);
 
 }
@@ -38,11 +74,116 @@ void dummy_finalize(bt_self_component_sink *comp)
 	destroy_private_dummy_data(dummy);
 }
 
+/*
+ * A dummy sink discards any message: it supports all the MIP versions
+ * of the library.
+ */
+BT_HIDDEN
+bt_component_class_get_supported_mip_versions_method_status
+dummy_get_supported_mip_versions(
+		__attribute__((unused)) bt_self_component_class_sink *self_component_class,
+		__attribute__((unused)) const bt_value *params,
+		__attribute__((unused)) void *initialize_method_data,
+		__attribute__((unused)) bt_logging_level logging_level,
+		bt_integer_range_set_unsigned *supported_versions)
+{
+	return (int) bt_integer_range_set_unsigned_add_range(
+		supported_versions, 0, bt_get_maximal_mip_version());
+}
+
+static const char *touch_choices[] = {
+	"none", "timestamps", "all-fields", "field-paths", NULL
+};
+
+static
+struct bt_param_validation_value_descr field_paths_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
 static
 struct bt_param_validation_map_value_entry_descr dummy_params[] = {
+	{ "touch", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
+		.choices = touch_choices,
+	} } },
+	{ "field-paths", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 1,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &field_paths_elem_descr,
+	} } },
+	{ "with-stats", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
+static
+bt_component_class_initialize_method_status handle_params(
+		struct dummy *dummy, bt_self_component *self_comp,
+		bt_logging_level log_level, const bt_value *params)
+{
+	bt_component_class_initialize_method_status status =
+		BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	const bt_value *value;
+
+	value = bt_value_map_borrow_entry_value_const(params, "touch");
+	if (value) {
+		const char *str = bt_value_string_get(value);
+
+		if (strcmp(str, "timestamps") == 0) {
+			dummy->touch_mode = DUMMY_TOUCH_MODE_TIMESTAMPS;
+		} else if (strcmp(str, "all-fields") == 0) {
+			dummy->touch_mode = DUMMY_TOUCH_MODE_ALL_FIELDS;
+		} else if (strcmp(str, "field-paths") == 0) {
+			dummy->touch_mode = DUMMY_TOUCH_MODE_FIELD_PATHS;
+		} else {
+			dummy->touch_mode = DUMMY_TOUCH_MODE_NONE;
+		}
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "field-paths");
+	if ((bool) value !=
+			(dummy->touch_mode == DUMMY_TOUCH_MODE_FIELD_PATHS)) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"The `field-paths` parameter is required with, and only "
+			"with, the `touch=field-paths` parameter.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (value) {
+		uint64_t i;
+
+		dummy->field_paths = g_array_new(FALSE, TRUE,
+			sizeof(struct common_field_path));
+		dummy->resolved_field_paths = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal,
+			(GDestroyNotify) bt_event_class_put_ref,
+			destroy_resolved_field_paths);
+
+		for (i = 0; i < bt_value_array_get_length(value); i++) {
+			const char *str = bt_value_string_get(
+				bt_value_array_borrow_element_by_index_const(
+					value, i));
+			struct common_field_path field_path = { 0 };
+
+			if (!common_field_path_parse(str, &field_path)) {
+				BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+					"Invalid field path: path=\"%s\"", str);
+				status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			g_array_append_val(dummy->field_paths, field_path);
+		}
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "with-stats");
+	if (value) {
+		dummy->with_stats = bt_value_bool_get(value);
+	}
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 bt_component_class_initialize_method_status dummy_init(
 		bt_self_component_sink *self_comp_sink,
@@ -76,6 +217,11 @@ bt_component_class_initialize_method_status dummy_init(
 		goto error;
 	}
 
+	status = handle_params(dummy, self_comp, log_level, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
 	add_port_status = bt_self_component_sink_add_input_port(self_comp_sink,
 		"in", NULL, NULL);
 	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
@@ -127,6 +273,335 @@ end:
 	return status;
 }
 
+static inline
+void mix(struct dummy *dummy, uint64_t value)
+{
+	dummy->checksum = (dummy->checksum ^ value) * FNV_PRIME;
+}
+
+static
+void touch_string(struct dummy *dummy, const char *str)
+{
+	uint64_t hash = 0;
+
+	for (; *str; str++) {
+		hash = (hash ^ (uint8_t) *str) * FNV_PRIME;
+	}
+
+	mix(dummy, hash);
+}
+
+static
+void touch_field(struct dummy *dummy, const bt_field *field)
+{
+	bt_field_class_type type = bt_field_get_class_type(field);
+	uint64_t i;
+
+	if (type == BT_FIELD_CLASS_TYPE_BOOL) {
+		mix(dummy, (uint64_t) bt_field_bool_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
+		mix(dummy, bt_field_bit_array_get_value_as_integer(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		mix(dummy, bt_field_integer_unsigned_get_value(field));
+	} else if (bt_field_class_type_is(type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		mix(dummy, (uint64_t) bt_field_integer_signed_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		float value = bt_field_real_single_precision_get_value(field);
+		uint32_t bits;
+
+		memcpy(&bits, &value, sizeof(bits));
+		mix(dummy, bits);
+	} else if (type == BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL) {
+		double value = bt_field_real_double_precision_get_value(field);
+		uint64_t bits;
+
+		memcpy(&bits, &value, sizeof(bits));
+		mix(dummy, bits);
+	} else if (type == BT_FIELD_CLASS_TYPE_STRING) {
+		touch_string(dummy, bt_field_string_get_value(field));
+	} else if (type == BT_FIELD_CLASS_TYPE_STRUCTURE) {
+		const bt_field_class *fc = bt_field_borrow_class_const(field);
+		uint64_t count = bt_field_class_structure_get_member_count(fc);
+
+		for (i = 0; i < count; i++) {
+			touch_field(dummy,
+				bt_field_structure_borrow_member_field_by_index_const(
+					field, i));
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_ARRAY)) {
+		uint64_t length = bt_field_array_get_length(field);
+
+		for (i = 0; i < length; i++) {
+			touch_field(dummy,
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i));
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_OPTION)) {
+		const bt_field *content_field =
+			bt_field_option_borrow_field_const(field);
+
+		if (content_field) {
+			touch_field(dummy, content_field);
+		}
+	} else if (bt_field_class_type_is(type, BT_FIELD_CLASS_TYPE_VARIANT)) {
+		touch_field(dummy,
+			bt_field_variant_borrow_selected_option_field_const(
+				field));
+	}
+}
+
+/*
+ * Returns the field paths of `dummy` which exist for the event class
+ * `ec`, resolving (and caching) them the first time.
+ */
+static
+GArray *borrow_resolved_field_paths(struct dummy *dummy,
+		const bt_event_class *ec)
+{
+	GArray *resolved_paths = g_hash_table_lookup(
+		dummy->resolved_field_paths, ec);
+	guint i;
+
+	if (G_LIKELY(resolved_paths)) {
+		goto end;
+	}
+
+	resolved_paths = g_array_new(FALSE, FALSE,
+		sizeof(struct common_resolved_field_path));
+
+	for (i = 0; i < dummy->field_paths->len; i++) {
+		struct common_resolved_field_path resolved_path;
+
+		if (!common_field_path_resolve(&g_array_index(
+				dummy->field_paths, struct common_field_path, i),
+				ec, &resolved_path)) {
+			/* Doesn't exist for this event class */
+			common_resolved_field_path_fini(&resolved_path);
+			continue;
+		}
+
+		g_array_append_val(resolved_paths, resolved_path);
+	}
+
+	bt_event_class_get_ref(ec);
+	g_hash_table_insert(dummy->resolved_field_paths, (gpointer) ec,
+		resolved_paths);
+
+end:
+	return resolved_paths;
+}
+
+static
+void touch_field_paths(struct dummy *dummy, const bt_event *event)
+{
+	GArray *resolved_paths = borrow_resolved_field_paths(dummy,
+		bt_event_borrow_class_const(event));
+	guint i;
+
+	for (i = 0; i < resolved_paths->len; i++) {
+		touch_field(dummy, common_field_path_borrow_field(event,
+			&g_array_index(resolved_paths,
+				struct common_resolved_field_path, i)));
+	}
+}
+
+static
+void touch_event_msg(struct dummy *dummy, const bt_message *msg)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+	const bt_field *field;
+
+	if (dummy->touch_mode == DUMMY_TOUCH_MODE_FIELD_PATHS) {
+		touch_field_paths(dummy, event);
+		return;
+	}
+
+	if (bt_message_event_borrow_stream_class_default_clock_class_const(
+			msg)) {
+		mix(dummy, bt_clock_snapshot_get_value(
+			bt_message_event_borrow_default_clock_snapshot_const(
+				msg)));
+	}
+
+	if (dummy->touch_mode != DUMMY_TOUCH_MODE_ALL_FIELDS) {
+		return;
+	}
+
+	field = bt_event_borrow_common_context_field_const(event);
+	if (field) {
+		touch_field(dummy, field);
+	}
+
+	field = bt_event_borrow_specific_context_field_const(event);
+	if (field) {
+		touch_field(dummy, field);
+	}
+
+	field = bt_event_borrow_payload_field_const(event);
+	if (field) {
+		touch_field(dummy, field);
+	}
+}
+
+/*
+ * Reads the payload column of the member at index `member_index` of
+ * the event batch message `msg`.
+ */
+static
+void touch_event_batch_msg_column(struct dummy *dummy, const bt_message *msg,
+		const bt_field_class *payload_fc, uint64_t member_index,
+		uint64_t event_count)
+{
+	const bt_field_class *member_fc =
+		bt_field_class_structure_member_borrow_field_class_const(
+			bt_field_class_structure_borrow_member_by_index_const(
+				payload_fc, member_index));
+	uint64_t i;
+
+	if (bt_field_class_get_type(member_fc) == BT_FIELD_CLASS_TYPE_STRING) {
+		for (i = 0; i < event_count; i++) {
+			touch_string(dummy,
+				bt_message_event_batch_get_payload_string(msg,
+					member_index, i));
+		}
+	} else {
+		const uint64_t *column =
+			bt_message_event_batch_borrow_payload_column_const(
+				msg, member_index);
+
+		for (i = 0; i < event_count; i++) {
+			mix(dummy, column[i]);
+		}
+	}
+}
+
+static
+void touch_event_batch_msg(struct dummy *dummy, const bt_message *msg)
+{
+	const bt_event_class *ec =
+		bt_message_event_batch_borrow_event_class_const(msg);
+	const bt_field_class *payload_fc =
+		bt_event_class_borrow_payload_field_class_const(ec);
+	uint64_t event_count = bt_message_event_batch_get_event_count(msg);
+	uint64_t i;
+
+	if (dummy->touch_mode == DUMMY_TOUCH_MODE_FIELD_PATHS) {
+		GArray *resolved_paths = borrow_resolved_field_paths(dummy,
+			ec);
+
+		/*
+		 * An event batch message only has payload columns:
+		 * resolved paths are single payload member indexes.
+		 */
+		for (i = 0; i < resolved_paths->len; i++) {
+			struct common_resolved_field_path *resolved_path =
+				&g_array_index(resolved_paths,
+					struct common_resolved_field_path, i);
+
+			if (resolved_path->scope == COMMON_FIELD_PATH_SCOPE_PAYLOAD &&
+					resolved_path->indexes->len == 1) {
+				touch_event_batch_msg_column(dummy, msg,
+					payload_fc,
+					g_array_index(resolved_path->indexes,
+						uint64_t, 0),
+					event_count);
+			}
+		}
+
+		return;
+	}
+
+	if (bt_stream_class_borrow_default_clock_class_const(
+			bt_event_class_borrow_stream_class_const(ec))) {
+		const uint64_t *values =
+			bt_message_event_batch_borrow_default_clock_snapshot_values_const(
+				msg);
+
+		for (i = 0; i < event_count; i++) {
+			mix(dummy, values[i]);
+		}
+	}
+
+	if (dummy->touch_mode != DUMMY_TOUCH_MODE_ALL_FIELDS || !payload_fc) {
+		return;
+	}
+
+	for (i = 0; i < bt_field_class_structure_get_member_count(payload_fc);
+			i++) {
+		touch_event_batch_msg_column(dummy, msg, payload_fc, i,
+			event_count);
+	}
+}
+
+static
+void touch_msg(struct dummy *dummy, const bt_message *msg)
+{
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		dummy->stats.event_count++;
+
+		if (dummy->touch_mode != DUMMY_TOUCH_MODE_NONE) {
+			touch_event_msg(dummy, msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_EVENT_BATCH:
+		dummy->stats.event_count +=
+			bt_message_event_batch_get_event_count(msg);
+
+		if (dummy->touch_mode != DUMMY_TOUCH_MODE_NONE) {
+			touch_event_batch_msg(dummy, msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		if (dummy->touch_mode == DUMMY_TOUCH_MODE_ALL_FIELDS) {
+			const bt_field *field =
+				bt_packet_borrow_context_field_const(
+					bt_message_packet_beginning_borrow_packet_const(
+						msg));
+
+			if (field) {
+				touch_field(dummy, field);
+			}
+		}
+
+		break;
+	default:
+		break;
+	}
+}
+
+static
+void print_stats(struct dummy *dummy)
+{
+	static const char *mode_names[] = {
+		[DUMMY_TOUCH_MODE_NONE] = "none",
+		[DUMMY_TOUCH_MODE_TIMESTAMPS] = "timestamps",
+		[DUMMY_TOUCH_MODE_ALL_FIELDS] = "all-fields",
+		[DUMMY_TOUCH_MODE_FIELD_PATHS] = "field-paths",
+	};
+	double elapsed_s = (double) (dummy->stats.end_time -
+		dummy->stats.begin_time) / G_USEC_PER_SEC;
+
+	printf("Touch mode: %s\n", mode_names[dummy->touch_mode]);
+	printf("%15" PRIu64 " messages\n", dummy->stats.msg_count);
+	printf("%15" PRIu64 " events\n", dummy->stats.event_count);
+	printf("%15.3f seconds\n", elapsed_s);
+
+	if (elapsed_s > 0) {
+		printf("%15.0f messages/s\n",
+			(double) dummy->stats.msg_count / elapsed_s);
+		printf("%15.0f events/s\n",
+			(double) dummy->stats.event_count / elapsed_s);
+	}
+
+	printf("Checksum: 0x%016" PRIx64 "\n", dummy->checksum);
+	fflush(stdout);
+}
+
 BT_HIDDEN
 bt_component_class_sink_consume_method_status dummy_consume(
 		bt_self_component_sink *component)
@@ -148,6 +623,10 @@ bt_component_class_sink_consume_method_status dummy_consume(
 		goto end;
 	}
 
+	if (G_UNLIKELY(dummy->with_stats && dummy->stats.begin_time == 0)) {
+		dummy->stats.begin_time = g_get_monotonic_time();
+	}
+
 	/* Consume one message  */
 	next_status = bt_message_iterator_next(
 		dummy->msg_iter, &msgs, &count);
@@ -155,7 +634,10 @@ bt_component_class_sink_consume_method_status dummy_consume(
 	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
 
+		dummy->stats.msg_count += count;
+
 		for (i = 0; i < count; i++) {
+			touch_msg(dummy, msgs[i]);
 			bt_message_put_ref(msgs[i]);
 		}
 
@@ -164,6 +646,11 @@ bt_component_class_sink_consume_method_status dummy_consume(
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_AGAIN;
 		goto end;
 	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		if (dummy->with_stats) {
+			dummy->stats.end_time = g_get_monotonic_time();
+			print_stats(dummy);
+		}
+
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
 		goto end;
 	case BT_MESSAGE_ITERATOR_NEXT_STATUS_ERROR:
@@ -8,13 +8,67 @@
 #define BABELTRACE_PLUGINS_UTILS_DUMMY_H
 
 #include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <babeltrace2/babeltrace.h>
 #include "common/macros.h"
+#include "plugins/common/field-path/field-path.h"
+
+enum dummy_touch_mode {
+	/* Discard messages without looking at them */
+	DUMMY_TOUCH_MODE_NONE,
+
+	/* Read the default clock snapshot values of events */
+	DUMMY_TOUCH_MODE_TIMESTAMPS,
+
+	/* Read all the event and packet context fields (and timestamps) */
+	DUMMY_TOUCH_MODE_ALL_FIELDS,
+
+	/* Read the fields of `field_paths` only */
+	DUMMY_TOUCH_MODE_FIELD_PATHS,
+};
 
 struct dummy {
 	bt_message_iterator *msg_iter;
+
+	enum dummy_touch_mode touch_mode;
+
+	/*
+	 * Array of `struct common_field_path`, as given with the
+	 * `field-paths` parameter
+	 */
+	GArray *field_paths;
+
+	/*
+	 * Event class (owned) -> `GArray *` of
+	 * `struct common_resolved_field_path`: the entries of
+	 * `field_paths` which exist for this event class.
+	 */
+	GHashTable *resolved_field_paths;
+
+	/* Mix of everything which this sink read */
+	uint64_t checksum;
+
+	bool with_stats;
+
+	struct {
+		uint64_t msg_count;
+		uint64_t event_count;
+
+		/* Monotonic times (µs) of the first and last consume calls */
+		gint64 begin_time;
+		gint64 end_time;
+	} stats;
 };
 
+BT_HIDDEN
+bt_component_class_get_supported_mip_versions_method_status
+dummy_get_supported_mip_versions(
+		bt_self_component_class_sink *self_component_class,
+		const bt_value *params, void *initialize_method_data,
+		bt_logging_level logging_level,
+		bt_integer_range_set_unsigned *supported_versions);
+
 BT_HIDDEN
 bt_component_class_initialize_method_status dummy_init(
 		bt_self_component_sink *component,
@@ -0,0 +1,990 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (gen_comp->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (gen_comp->log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.UTILS.GEN"
+#include "logging/comp-logging.h"
+
+#include "gen.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include "common/common.h"
+#include "common/assert.h"
+#include <babeltrace2/babeltrace.h>
+#include <glib.h>
+#include "plugins/common/param-validation/param-validation.h"
+
+struct gen_component {
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+
+	struct {
+		uint64_t stream_count;
+		uint64_t event_count;
+		uint64_t event_class_count;
+		uint64_t packet_event_count;
+		uint64_t uint_field_count;
+		uint64_t string_field_len;
+		uint64_t clock_increment;
+		bt_bool no_clock;
+		uint64_t discarded_events_period;
+		uint64_t discarded_event_count;
+	} params;
+
+	/* Payload value of the string field (`string_field_len` bytes) */
+	char *string_value;
+
+	bt_trace_class *trace_class;
+	bt_stream_class *stream_class;
+	bt_clock_class *clock_class;
+
+	/* Array of `bt_event_class *` (owned by `stream_class`) */
+	GPtrArray *event_classes;
+};
+
+enum gen_stream_state {
+	GEN_STREAM_STATE_EMIT_STREAM_BEGINNING,
+	GEN_STREAM_STATE_EMIT_PACKET_BEGINNING,
+	GEN_STREAM_STATE_EMIT_EVENT,
+	GEN_STREAM_STATE_EMIT_DISCARDED_EVENTS,
+	GEN_STREAM_STATE_EMIT_PACKET_END,
+	GEN_STREAM_STATE_EMIT_STREAM_END,
+	GEN_STREAM_STATE_DONE,
+};
+
+struct gen_stream {
+	/* Owned by this */
+	bt_stream *stream;
+
+	/* Current packet (owned by this) */
+	bt_packet *packet;
+
+	enum gen_stream_state state;
+
+	/* Number of event messages emitted for this stream */
+	uint64_t event_count;
+
+	/* Number of event messages emitted within the current packet */
+	uint64_t packet_event_count;
+
+	/*
+	 * True if a discarded events message is due after the current
+	 * packet (or immediately without packets).
+	 */
+	bool discarded_events_due;
+};
+
+struct gen_msg_iter {
+	struct gen_component *gen_comp;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	/* Owned by this */
+	bt_trace *trace;
+
+	/* Array of `struct gen_stream` */
+	GArray *streams;
+
+	/* Index, within `streams`, of the stream to emit from next */
+	guint cur_stream_index;
+
+	/* Number of streams which are not done */
+	guint active_stream_count;
+
+	/*
+	 * Current clock value, shared by all the streams so that the
+	 * messages of this iterator are ordered by time.
+	 */
+	uint64_t clock_value;
+};
+
+static
+struct bt_param_validation_map_value_entry_descr gen_params[] = {
+	{ "stream-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "event-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "event-class-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "packet-event-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "uint-field-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "string-field-length", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "clock-increment", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "no-clock", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "discarded-events-period", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "discarded-event-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+void get_uint_param(const bt_value *params, const char *name,
+		uint64_t *value)
+{
+	const bt_value *value_obj =
+		bt_value_map_borrow_entry_value_const(params, name);
+
+	if (value_obj) {
+		*value = bt_value_integer_unsigned_get(value_obj);
+	}
+}
+
+static
+bt_component_class_initialize_method_status handle_params(
+		struct gen_component *gen_comp, const bt_value *params)
+{
+	const bt_value *no_clock;
+	bt_component_class_initialize_method_status status;
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+
+	validation_status = bt_param_validation_validate(params,
+		gen_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"%s", validate_error);
+		goto end;
+	}
+
+	gen_comp->params.stream_count = 1;
+	gen_comp->params.event_count = 1000000;
+	gen_comp->params.event_class_count = 1;
+	gen_comp->params.packet_event_count = 1000;
+	gen_comp->params.uint_field_count = 4;
+	gen_comp->params.string_field_len = 0;
+	gen_comp->params.clock_increment = 1000;
+	gen_comp->params.discarded_events_period = 0;
+	gen_comp->params.discarded_event_count = 1;
+	get_uint_param(params, "stream-count",
+		&gen_comp->params.stream_count);
+	get_uint_param(params, "event-count",
+		&gen_comp->params.event_count);
+	get_uint_param(params, "event-class-count",
+		&gen_comp->params.event_class_count);
+	get_uint_param(params, "packet-event-count",
+		&gen_comp->params.packet_event_count);
+	get_uint_param(params, "uint-field-count",
+		&gen_comp->params.uint_field_count);
+	get_uint_param(params, "string-field-length",
+		&gen_comp->params.string_field_len);
+	get_uint_param(params, "clock-increment",
+		&gen_comp->params.clock_increment);
+	get_uint_param(params, "discarded-events-period",
+		&gen_comp->params.discarded_events_period);
+	get_uint_param(params, "discarded-event-count",
+		&gen_comp->params.discarded_event_count);
+	no_clock = bt_value_map_borrow_entry_value_const(params, "no-clock");
+	if (no_clock) {
+		gen_comp->params.no_clock = bt_value_bool_get(no_clock);
+	}
+
+	if (gen_comp->params.stream_count == 0 ||
+			gen_comp->params.stream_count > G_MAXUINT) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Invalid `stream-count` parameter: value=%" PRIu64,
+			gen_comp->params.stream_count);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (gen_comp->params.event_class_count == 0 ||
+			gen_comp->params.event_class_count > G_MAXUINT) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Invalid `event-class-count` parameter: value=%" PRIu64,
+			gen_comp->params.event_class_count);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (gen_comp->params.string_field_len >= G_MAXSIZE) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Invalid `string-field-length` parameter: value=%" PRIu64,
+			gen_comp->params.string_field_len);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+static
+bt_field_class *create_event_payload_fc(struct gen_component *gen_comp)
+{
+	bt_field_class *root_fc = NULL;
+	bt_field_class *fc = NULL;
+	bt_field_class_structure_append_member_status append_member_status;
+	GString *name = NULL;
+	uint64_t i;
+
+	root_fc = bt_field_class_structure_create(gen_comp->trace_class);
+	if (!root_fc) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create an empty structure field class object.");
+		goto error;
+	}
+
+	name = g_string_new(NULL);
+	if (!name) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Failed to allocate a GString.");
+		goto error;
+	}
+
+	for (i = 0; i < gen_comp->params.uint_field_count; i++) {
+		fc = bt_field_class_integer_unsigned_create(
+			gen_comp->trace_class);
+		if (!fc) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot create an unsigned integer field class object.");
+			goto error;
+		}
+
+		g_string_printf(name, "u%" PRIu64, i);
+		append_member_status = bt_field_class_structure_append_member(
+			root_fc, name->str, fc);
+		if (append_member_status != BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot add `%s` member to structure field class: ret=%d",
+				name->str, append_member_status);
+			goto error;
+		}
+
+		BT_FIELD_CLASS_PUT_REF_AND_RESET(fc);
+	}
+
+	if (gen_comp->params.string_field_len > 0) {
+		fc = bt_field_class_string_create(gen_comp->trace_class);
+		if (!fc) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot create a string field class object.");
+			goto error;
+		}
+
+		append_member_status = bt_field_class_structure_append_member(
+			root_fc, "str", fc);
+		if (append_member_status != BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot add `str` member to structure field class: ret=%d",
+				append_member_status);
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_FIELD_CLASS_PUT_REF_AND_RESET(root_fc);
+
+end:
+	if (name) {
+		g_string_free(name, TRUE);
+	}
+
+	bt_field_class_put_ref(fc);
+	return root_fc;
+}
+
+static
+int create_meta(struct gen_component *gen_comp)
+{
+	bt_field_class *fc = NULL;
+	bool has_clock = !gen_comp->params.no_clock;
+	bool has_packets = gen_comp->params.packet_event_count > 0;
+	GString *name = NULL;
+	uint64_t i;
+	int ret = 0;
+
+	gen_comp->trace_class = bt_trace_class_create(gen_comp->self_comp);
+	if (!gen_comp->trace_class) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create an empty trace class object.");
+		goto error;
+	}
+
+	gen_comp->stream_class = bt_stream_class_create(gen_comp->trace_class);
+	if (!gen_comp->stream_class) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create a stream class object.");
+		goto error;
+	}
+
+	if (has_clock) {
+		gen_comp->clock_class = bt_clock_class_create(
+			gen_comp->self_comp);
+		if (!gen_comp->clock_class) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot create clock class.");
+			goto error;
+		}
+
+		/* Generated time isn't related to the wall clock */
+		bt_clock_class_set_origin_is_unix_epoch(gen_comp->clock_class,
+			BT_FALSE);
+
+		ret = bt_stream_class_set_default_clock_class(
+			gen_comp->stream_class, gen_comp->clock_class);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot set stream class's default clock class.");
+			goto error;
+		}
+	}
+
+	if (has_packets) {
+		bt_stream_class_set_supports_packets(gen_comp->stream_class,
+			BT_TRUE, has_clock, has_clock);
+	}
+
+	if (gen_comp->params.discarded_events_period > 0) {
+		bt_stream_class_set_supports_discarded_events(
+			gen_comp->stream_class, BT_TRUE, has_clock);
+	}
+
+	fc = create_event_payload_fc(gen_comp);
+	if (!fc) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create event payload field class.");
+		goto error;
+	}
+
+	name = g_string_new(NULL);
+	if (!name) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Failed to allocate a GString.");
+		goto error;
+	}
+
+	for (i = 0; i < gen_comp->params.event_class_count; i++) {
+		bt_event_class *ec = bt_event_class_create(
+			gen_comp->stream_class);
+
+		if (!ec) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot create an event class object.");
+			goto error;
+		}
+
+		/* The stream class keeps a reference */
+		g_ptr_array_add(gen_comp->event_classes, ec);
+		bt_event_class_put_ref(ec);
+		g_string_printf(name, "event%" PRIu64, i);
+		ret = bt_event_class_set_name(ec, name->str);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot set event class's name.");
+			goto error;
+		}
+
+		ret = bt_event_class_set_payload_field_class(ec, fc);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot set event class's event payload field class.");
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (name) {
+		g_string_free(name, TRUE);
+	}
+
+	bt_field_class_put_ref(fc);
+	return ret;
+}
+
+static
+void destroy_gen_component(struct gen_component *gen_comp)
+{
+	if (!gen_comp) {
+		return;
+	}
+
+	if (gen_comp->event_classes) {
+		g_ptr_array_free(gen_comp->event_classes, TRUE);
+	}
+
+	g_free(gen_comp->string_value);
+	bt_clock_class_put_ref(gen_comp->clock_class);
+	bt_stream_class_put_ref(gen_comp->stream_class);
+	bt_trace_class_put_ref(gen_comp->trace_class);
+	g_free(gen_comp);
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status gen_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	struct gen_component *gen_comp = g_new0(struct gen_component, 1);
+	bt_component_class_initialize_method_status status;
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	const bt_component *comp = bt_self_component_as_component(self_comp);
+	bt_logging_level log_level = bt_component_get_logging_level(comp);
+	bt_self_component_add_port_status add_port_status;
+
+	if (!gen_comp) {
+		/*
+		 * Don't use BT_COMP_LOGE_APPEND_CAUSE, as `gen_comp` is not
+		 * initialized.
+		 */
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
+			"Failed to allocate one gen component structure.");
+		BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_FROM_COMPONENT(self_comp,
+			"Failed to allocate one gen component structure.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	gen_comp->log_level = log_level;
+	gen_comp->self_comp = self_comp;
+	gen_comp->event_classes = g_ptr_array_new();
+	if (!gen_comp->event_classes) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a GPtrArray.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	status = handle_params(gen_comp, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Invalid parameters: comp-addr=%p", self_comp);
+		goto error;
+	}
+
+	/* Build the string field's value once for all the events */
+	gen_comp->string_value = g_malloc(
+		(gsize) gen_comp->params.string_field_len + 1);
+	if (!gen_comp->string_value) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate the string field value.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	memset(gen_comp->string_value, 'x',
+		(size_t) gen_comp->params.string_field_len);
+	gen_comp->string_value[gen_comp->params.string_field_len] = '\0';
+
+	if (create_meta(gen_comp)) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot create metadata objects: gen-comp-addr=%p",
+			gen_comp);
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto error;
+	}
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to add output port.");
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	bt_self_component_set_data(self_comp, gen_comp);
+	BT_COMP_LOGI_STR("Component initialized.");
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_gen_component(gen_comp);
+	bt_self_component_set_data(self_comp, NULL);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void gen_finalize(bt_self_component_source *self_comp)
+{
+	destroy_gen_component(bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp)));
+}
+
+static
+void reset_gen_msg_iter(struct gen_msg_iter *gen_msg_iter)
+{
+	guint i;
+
+	for (i = 0; i < gen_msg_iter->streams->len; i++) {
+		struct gen_stream *gen_stream = &g_array_index(
+			gen_msg_iter->streams, struct gen_stream, i);
+
+		BT_PACKET_PUT_REF_AND_RESET(gen_stream->packet);
+		gen_stream->state = GEN_STREAM_STATE_EMIT_STREAM_BEGINNING;
+		gen_stream->event_count = 0;
+		gen_stream->packet_event_count = 0;
+		gen_stream->discarded_events_due = false;
+	}
+
+	gen_msg_iter->cur_stream_index = 0;
+	gen_msg_iter->active_stream_count = gen_msg_iter->streams->len;
+	gen_msg_iter->clock_value = 0;
+}
+
+static
+void destroy_gen_msg_iter(struct gen_msg_iter *gen_msg_iter)
+{
+	guint i;
+
+	if (!gen_msg_iter) {
+		return;
+	}
+
+	if (gen_msg_iter->streams) {
+		for (i = 0; i < gen_msg_iter->streams->len; i++) {
+			struct gen_stream *gen_stream = &g_array_index(
+				gen_msg_iter->streams, struct gen_stream, i);
+
+			bt_packet_put_ref(gen_stream->packet);
+			bt_stream_put_ref(gen_stream->stream);
+		}
+
+		g_array_free(gen_msg_iter->streams, TRUE);
+	}
+
+	bt_trace_put_ref(gen_msg_iter->trace);
+	g_free(gen_msg_iter);
+}
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status gen_msg_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *self_port)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	struct gen_component *gen_comp = bt_self_component_get_data(self_comp);
+	struct gen_msg_iter *gen_msg_iter = g_new0(struct gen_msg_iter, 1);
+	bt_message_iterator_class_initialize_method_status status;
+	uint64_t i;
+
+	if (!gen_msg_iter) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate one gen message iterator structure.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	BT_ASSERT(gen_comp);
+	gen_msg_iter->gen_comp = gen_comp;
+	gen_msg_iter->self_msg_iter = self_msg_iter;
+	gen_msg_iter->trace = bt_trace_create(gen_comp->trace_class);
+	if (!gen_msg_iter->trace) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot create trace object.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	gen_msg_iter->streams = g_array_sized_new(FALSE, TRUE,
+		sizeof(struct gen_stream),
+		(guint) gen_comp->params.stream_count);
+	if (!gen_msg_iter->streams) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a GArray.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	for (i = 0; i < gen_comp->params.stream_count; i++) {
+		struct gen_stream gen_stream = { 0 };
+
+		gen_stream.stream = bt_stream_create(gen_comp->stream_class,
+			gen_msg_iter->trace);
+		if (!gen_stream.stream) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot create stream object.");
+			status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+
+		g_array_append_val(gen_msg_iter->streams, gen_stream);
+	}
+
+	reset_gen_msg_iter(gen_msg_iter);
+	bt_self_message_iterator_set_data(self_msg_iter, gen_msg_iter);
+	status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_gen_msg_iter(gen_msg_iter);
+	bt_self_message_iterator_set_data(self_msg_iter, NULL);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void gen_msg_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	destroy_gen_msg_iter(bt_self_message_iterator_get_data(
+		self_msg_iter));
+}
+
+/*
+ * Sets the payload field values of the event of the event message
+ * `msg`, the `event_index`th event of its stream.
+ */
+static inline
+int fill_event_payload(struct gen_component *gen_comp, bt_message *msg,
+		uint64_t event_index)
+{
+	bt_field *payload_field = bt_event_borrow_payload_field(
+		bt_message_event_borrow_event(msg));
+	uint64_t i;
+	int ret = 0;
+
+	for (i = 0; i < gen_comp->params.uint_field_count; i++) {
+		bt_field_integer_unsigned_set_value(
+			bt_field_structure_borrow_member_field_by_index(
+				payload_field, i), event_index + i);
+	}
+
+	if (gen_comp->params.string_field_len > 0) {
+		bt_field_string_set_value_status set_status =
+			bt_field_string_set_value(
+				bt_field_structure_borrow_member_field_by_index(
+					payload_field, i),
+				gen_comp->string_value);
+
+		if (set_status != BT_FIELD_STRING_SET_VALUE_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot set string field's value: status=%d",
+				set_status);
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
+
+static
+bt_message *create_event_msg(struct gen_msg_iter *gen_msg_iter,
+		struct gen_stream *gen_stream)
+{
+	struct gen_component *gen_comp = gen_msg_iter->gen_comp;
+	bt_event_class *ec = g_ptr_array_index(gen_comp->event_classes,
+		gen_stream->event_count % gen_comp->event_classes->len);
+	bt_message *msg;
+
+	if (gen_stream->packet) {
+		if (gen_comp->clock_class) {
+			msg = bt_message_event_create_with_packet_and_default_clock_snapshot(
+				gen_msg_iter->self_msg_iter, ec,
+				gen_stream->packet, gen_msg_iter->clock_value);
+		} else {
+			msg = bt_message_event_create_with_packet(
+				gen_msg_iter->self_msg_iter, ec,
+				gen_stream->packet);
+		}
+	} else {
+		if (gen_comp->clock_class) {
+			msg = bt_message_event_create_with_default_clock_snapshot(
+				gen_msg_iter->self_msg_iter, ec,
+				gen_stream->stream, gen_msg_iter->clock_value);
+		} else {
+			msg = bt_message_event_create(
+				gen_msg_iter->self_msg_iter, ec,
+				gen_stream->stream);
+		}
+	}
+
+	if (!msg) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create event message.");
+		goto end;
+	}
+
+	if (fill_event_payload(gen_comp, msg, gen_stream->event_count)) {
+		BT_MESSAGE_PUT_REF_AND_RESET(msg);
+		goto end;
+	}
+
+end:
+	return msg;
+}
+
+static
+bt_message *create_discarded_events_msg(struct gen_msg_iter *gen_msg_iter,
+		struct gen_stream *gen_stream)
+{
+	struct gen_component *gen_comp = gen_msg_iter->gen_comp;
+	bt_message *msg;
+
+	if (gen_comp->clock_class) {
+		msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+			gen_msg_iter->self_msg_iter, gen_stream->stream,
+			gen_msg_iter->clock_value, gen_msg_iter->clock_value);
+	} else {
+		msg = bt_message_discarded_events_create(
+			gen_msg_iter->self_msg_iter, gen_stream->stream);
+	}
+
+	if (!msg) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create discarded events message.");
+		goto end;
+	}
+
+	if (gen_comp->params.discarded_event_count > 0) {
+		bt_message_discarded_events_set_count(msg,
+			gen_comp->params.discarded_event_count);
+	}
+
+end:
+	return msg;
+}
+
+/*
+ * Returns the state of a stream which just ended a packet (or emitted
+ * an event without packets).
+ */
+static inline
+enum gen_stream_state next_state_after_packet(struct gen_component *gen_comp,
+		struct gen_stream *gen_stream)
+{
+	if (gen_stream->discarded_events_due) {
+		return GEN_STREAM_STATE_EMIT_DISCARDED_EVENTS;
+	} else if (gen_stream->event_count == gen_comp->params.event_count) {
+		return GEN_STREAM_STATE_EMIT_STREAM_END;
+	} else if (gen_comp->params.packet_event_count > 0) {
+		return GEN_STREAM_STATE_EMIT_PACKET_BEGINNING;
+	} else {
+		return GEN_STREAM_STATE_EMIT_EVENT;
+	}
+}
+
+/*
+ * Makes the next stream which isn't done, in a round-robin fashion,
+ * the current stream.
+ */
+static inline
+void go_to_next_stream(struct gen_msg_iter *gen_msg_iter)
+{
+	if (gen_msg_iter->active_stream_count == 0) {
+		return;
+	}
+
+	do {
+		gen_msg_iter->cur_stream_index++;
+
+		if (gen_msg_iter->cur_stream_index ==
+				gen_msg_iter->streams->len) {
+			gen_msg_iter->cur_stream_index = 0;
+		}
+	} while (g_array_index(gen_msg_iter->streams, struct gen_stream,
+			gen_msg_iter->cur_stream_index).state ==
+			GEN_STREAM_STATE_DONE);
+}
+
+static
+bt_message_iterator_class_next_method_status gen_msg_iter_next_one(
+		struct gen_msg_iter *gen_msg_iter, bt_message **msg)
+{
+	struct gen_component *gen_comp = gen_msg_iter->gen_comp;
+	struct gen_stream *gen_stream;
+	bt_message_iterator_class_next_method_status status;
+
+	if (gen_msg_iter->active_stream_count == 0) {
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+		goto end;
+	}
+
+	gen_stream = &g_array_index(gen_msg_iter->streams, struct gen_stream,
+		gen_msg_iter->cur_stream_index);
+
+	switch (gen_stream->state) {
+	case GEN_STREAM_STATE_EMIT_STREAM_BEGINNING:
+		*msg = bt_message_stream_beginning_create(
+			gen_msg_iter->self_msg_iter, gen_stream->stream);
+
+		if (gen_comp->params.event_count == 0) {
+			gen_stream->state = GEN_STREAM_STATE_EMIT_STREAM_END;
+		} else if (gen_comp->params.packet_event_count > 0) {
+			gen_stream->state =
+				GEN_STREAM_STATE_EMIT_PACKET_BEGINNING;
+		} else {
+			gen_stream->state = GEN_STREAM_STATE_EMIT_EVENT;
+		}
+
+		break;
+	case GEN_STREAM_STATE_EMIT_PACKET_BEGINNING:
+		BT_ASSERT_DBG(!gen_stream->packet);
+		gen_stream->packet = bt_packet_create(gen_stream->stream);
+		if (!gen_stream->packet) {
+			BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+				"Cannot create packet object.");
+			*msg = NULL;
+			break;
+		}
+
+		if (gen_comp->clock_class) {
+			*msg = bt_message_packet_beginning_create_with_default_clock_snapshot(
+				gen_msg_iter->self_msg_iter,
+				gen_stream->packet, gen_msg_iter->clock_value);
+		} else {
+			*msg = bt_message_packet_beginning_create(
+				gen_msg_iter->self_msg_iter,
+				gen_stream->packet);
+		}
+
+		gen_stream->packet_event_count = 0;
+		gen_stream->state = GEN_STREAM_STATE_EMIT_EVENT;
+		break;
+	case GEN_STREAM_STATE_EMIT_EVENT:
+		*msg = create_event_msg(gen_msg_iter, gen_stream);
+		gen_stream->event_count++;
+		gen_stream->packet_event_count++;
+		gen_msg_iter->clock_value += gen_comp->params.clock_increment;
+
+		if (gen_comp->params.discarded_events_period > 0 &&
+				gen_stream->event_count %
+					gen_comp->params.discarded_events_period == 0 &&
+				gen_stream->event_count <
+					gen_comp->params.event_count) {
+			gen_stream->discarded_events_due = true;
+		}
+
+		if (gen_stream->packet) {
+			if (gen_stream->event_count ==
+					gen_comp->params.event_count ||
+					gen_stream->packet_event_count ==
+						gen_comp->params.packet_event_count ||
+					gen_stream->discarded_events_due) {
+				gen_stream->state =
+					GEN_STREAM_STATE_EMIT_PACKET_END;
+			}
+		} else {
+			gen_stream->state = next_state_after_packet(gen_comp,
+				gen_stream);
+		}
+
+		/* Interleave the events of the streams */
+		go_to_next_stream(gen_msg_iter);
+		break;
+	case GEN_STREAM_STATE_EMIT_DISCARDED_EVENTS:
+		*msg = create_discarded_events_msg(gen_msg_iter, gen_stream);
+		gen_stream->discarded_events_due = false;
+		gen_stream->state = next_state_after_packet(gen_comp,
+			gen_stream);
+		break;
+	case GEN_STREAM_STATE_EMIT_PACKET_END:
+		if (gen_comp->clock_class) {
+			*msg = bt_message_packet_end_create_with_default_clock_snapshot(
+				gen_msg_iter->self_msg_iter,
+				gen_stream->packet, gen_msg_iter->clock_value);
+		} else {
+			*msg = bt_message_packet_end_create(
+				gen_msg_iter->self_msg_iter,
+				gen_stream->packet);
+		}
+
+		BT_PACKET_PUT_REF_AND_RESET(gen_stream->packet);
+		gen_stream->state = next_state_after_packet(gen_comp,
+			gen_stream);
+		break;
+	case GEN_STREAM_STATE_EMIT_STREAM_END:
+		*msg = bt_message_stream_end_create(
+			gen_msg_iter->self_msg_iter, gen_stream->stream);
+		gen_stream->state = GEN_STREAM_STATE_DONE;
+		gen_msg_iter->active_stream_count--;
+		go_to_next_stream(gen_msg_iter);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	if (!*msg) {
+		BT_COMP_LOGE_APPEND_CAUSE(gen_comp->self_comp,
+			"Cannot create message: gen-comp-addr=%p", gen_comp);
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_next_method_status gen_msg_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct gen_msg_iter *gen_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	uint64_t i = 0;
+
+	while (i < capacity &&
+			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		bt_message *msg = NULL;
+
+		status = gen_msg_iter_next_one(gen_msg_iter, &msg);
+		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			msgs[i] = msg;
+			i++;
+		}
+	}
+
+	if (i > 0) {
+		/*
+		 * Even if gen_msg_iter_next_one() returned something
+		 * else than
+		 * BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK, we
+		 * accumulated message objects in the output message
+		 * array, so we need to return
+		 * BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK so
+		 * that they are transfered to downstream. This other
+		 * status occurs again the next time
+		 * gen_msg_iter_next() is called, possibly without any
+		 * accumulated message, in which case we'll return it.
+		 */
+		*count = i;
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	}
+
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_beginning_method_status
+gen_msg_iter_can_seek_beginning(
+		bt_self_message_iterator *self_msg_iter, bt_bool *can_seek)
+{
+	*can_seek = BT_TRUE;
+	return BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_BEGINNING_METHOD_STATUS_OK;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_seek_beginning_method_status
+gen_msg_iter_seek_beginning(bt_self_message_iterator *self_msg_iter)
+{
+	reset_gen_msg_iter(bt_self_message_iterator_get_data(self_msg_iter));
+	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
+}
@@ -17,14 +17,20 @@
 #include <inttypes.h>
 #include "common/assert.h"
 #include "common/common.h"
+#include "common/probes.h"
+#include "compat/glib.h"
 #include <stdlib.h>
 #include <string.h>
 
 #include "plugins/common/muxing/muxing.h"
 #include "plugins/common/param-validation/param-validation.h"
+#include "lib/prio-heap/prio-heap.h"
 
 #include "muxer.h"
 
+/* Maximum message batch size requested by a muxer message iterator */
+#define MUXER_MSG_ITER_MAX_BATCH_SIZE	1024
+
 struct muxer_comp {
 	/* Weak refs */
 	bt_self_component_filter *self_comp_flt;
@@ -36,14 +42,32 @@ struct muxer_comp {
 	bt_logging_level log_level;
 };
 
+struct muxer_msg_iter;
+
 struct muxer_upstream_msg_iter {
 	struct muxer_comp *muxer_comp;
 
+	/* Weak */
+	struct muxer_msg_iter *muxer_msg_iter;
+
 	/* Owned by this, NULL if ended */
 	bt_message_iterator *msg_iter;
 
 	/* Contains `const bt_message *`, owned by this */
 	GQueue *msgs;
+
+	/*
+	 * Timestamp (ns from origin) of the head message of `msgs`,
+	 * valid when this upstream message iterator wrapper is part of
+	 * its muxer message iterator's heap.
+	 *
+	 * If `head_ts_is_last_returned` is true, the head message has
+	 * no usable timestamp and its timestamp is the muxer message
+	 * iterator's current last returned timestamp instead of
+	 * `head_ts_ns`.
+	 */
+	int64_t head_ts_ns;
+	bool head_ts_is_last_returned;
 };
 
 enum muxer_msg_iter_clock_class_expectation {
@@ -63,13 +87,35 @@ struct muxer_msg_iter {
 	/*
 	 * Array of struct muxer_upstream_msg_iter * (owned by this).
 	 *
-	 * NOTE: This array is searched in linearly to find the youngest
-	 * current message. Keep this until benchmarks confirm that
-	 * another data structure is faster than this for our typical
-	 * use cases.
+	 * Each active upstream message iterator wrapper is either in
+	 * `heap` (its message queue is not empty) or in
+	 * `pending_muxer_upstream_msg_iters` (we need to call its
+	 * upstream message iterator's "next" method).
 	 */
 	GPtrArray *active_muxer_upstream_msg_iters;
 
+	/*
+	 * Priority heap of struct muxer_upstream_msg_iter * (weak), the
+	 * maximum being the wrapper of which the head message is the
+	 * youngest one according to muxer_upstream_msg_iter_gt().
+	 */
+	struct ptr_heap heap;
+
+	/*
+	 * Array of struct muxer_upstream_msg_iter * (weak): active
+	 * upstream message iterator wrappers with an empty message
+	 * queue.
+	 */
+	GPtrArray *pending_muxer_upstream_msg_iters;
+
+	/*
+	 * Upstream message iterator wrapper (weak) at the top of `heap`
+	 * from which muxer_msg_iter_do_next_one() last popped a
+	 * message: its position within `heap` needs to be updated
+	 * before finding the next youngest message.
+	 */
+	struct muxer_upstream_msg_iter *stale_top_muxer_upstream_msg_iter;
+
 	/*
 	 * Array of struct muxer_upstream_msg_iter * (owned by this).
 	 *
@@ -92,6 +138,16 @@ struct muxer_msg_iter {
 	 */
 	bt_uuid_t expected_clock_class_uuid;
 
+	/*
+	 * Set of clock classes (owned by this) which validate_clock_class()
+	 * already validated against the current clock class expectation.
+	 *
+	 * A clock class is frozen once a stream or clock snapshot uses it,
+	 * and the expectation doesn't change once set, so a validated clock
+	 * class remains valid until the expectation is reset.
+	 */
+	GHashTable *validated_clock_classes;
+
 	/*
 	 * Saved error.  If we hit an error in the _next method, but have some
 	 * messages ready to return, we save the error here and return it on
@@ -154,6 +210,7 @@ int muxer_msg_iter_add_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
 	}
 
 	muxer_upstream_msg_iter->muxer_comp = muxer_comp;
+	muxer_upstream_msg_iter->muxer_msg_iter = muxer_msg_iter;
 	muxer_upstream_msg_iter->msg_iter = self_msg_iter;
 	bt_message_iterator_get_ref(muxer_upstream_msg_iter->msg_iter);
 	muxer_upstream_msg_iter->msgs = g_queue_new();
@@ -165,6 +222,8 @@ int muxer_msg_iter_add_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
 
 	g_ptr_array_add(muxer_msg_iter->active_muxer_upstream_msg_iters,
 		muxer_upstream_msg_iter);
+	g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
 	BT_COMP_LOGD("Added muxer's upstream message iterator wrapper: "
 		"addr=%p, muxer-msg-iter-addr=%p, msg-iter-addr=%p",
 		muxer_upstream_msg_iter, muxer_msg_iter,
@@ -464,7 +523,7 @@ static
 int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		struct muxer_msg_iter *muxer_msg_iter,
 		const bt_message *msg, int64_t last_returned_ts_ns,
-		int64_t *ts_ns)
+		int64_t *ts_ns, bool *ts_is_last_returned)
 {
 	const bt_clock_snapshot *clock_snapshot = NULL;
 	int ret = 0;
@@ -473,6 +532,8 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 
 	BT_ASSERT_DBG(msg);
 	BT_ASSERT_DBG(ts_ns);
+	BT_ASSERT_DBG(ts_is_last_returned);
+	*ts_is_last_returned = false;
 	BT_COMP_LOGD("Getting message's timestamp: "
 		"muxer-msg-iter-addr=%p, msg-addr=%p, "
 		"last-returned-ts=%" PRId64,
@@ -481,6 +542,7 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 	if (G_UNLIKELY(muxer_msg_iter->clock_class_expectation ==
 			MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_NONE)) {
 		*ts_ns = last_returned_ts_ns;
+		*ts_is_last_returned = true;
 		goto end;
 	}
 
@@ -581,6 +643,7 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		/* All the other messages have a higher priority */
 		BT_COMP_LOGD_STR("Message has no timestamp: using the last returned timestamp.");
 		*ts_ns = last_returned_ts_ns;
+		*ts_is_last_returned = true;
 		goto end;
 	}
 
@@ -598,6 +661,7 @@ no_clock_snapshot:
 	BT_COMP_LOGD_STR("Message's default clock snapshot is missing: "
 		"using the last returned timestamp.");
 	*ts_ns = last_returned_ts_ns;
+	*ts_is_last_returned = true;
 	goto end;
 
 error:
@@ -625,6 +689,12 @@ int validate_clock_class(struct muxer_msg_iter *muxer_msg_iter,
 	const char *cc_name;
 
 	BT_ASSERT_DBG(clock_class);
+
+	if (G_LIKELY(bt_g_hash_table_contains(
+			muxer_msg_iter->validated_clock_classes, clock_class))) {
+		goto end;
+	}
+
 	cc_uuid = bt_clock_class_get_uuid(clock_class);
 	cc_name = bt_clock_class_get_name(clock_class);
 
@@ -736,6 +806,9 @@ int validate_clock_class(struct muxer_msg_iter *muxer_msg_iter,
 		bt_common_abort();
 	}
 
+	bt_clock_class_get_ref(clock_class);
+	g_hash_table_insert(muxer_msg_iter->validated_clock_classes,
+		(gpointer) clock_class, (gpointer) clock_class);
 	goto end;
 
 error:
@@ -745,6 +818,12 @@ end:
 	return ret;
 }
 
+static
+void put_validated_clock_class(gpointer data)
+{
+	bt_clock_class_put_ref(data);
+}
+
 static inline
 int validate_new_stream_clock_class(struct muxer_msg_iter *muxer_msg_iter,
 		struct muxer_comp *muxer_comp, const bt_stream *stream)
@@ -782,9 +861,112 @@ end:
 }
 
 /*
- * This function finds the youngest available message amongst the
- * non-ended upstream message iterators and returns the upstream
- * message iterator which has it, or
+ * Returns the effective timestamp of the head message of
+ * `muxer_upstream_msg_iter`.
+ */
+static inline
+int64_t muxer_upstream_msg_iter_head_ts_ns(
+		const struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	return muxer_upstream_msg_iter->head_ts_is_last_returned ?
+		muxer_upstream_msg_iter->muxer_msg_iter->last_returned_ts_ns :
+		muxer_upstream_msg_iter->head_ts_ns;
+}
+
+/*
+ * Heap comparison function: returns whether or not the head message of
+ * the upstream message iterator wrapper `a` must go before the head
+ * message of the upstream message iterator wrapper `b`.
+ *
+ * When both head messages have the same timestamp, this function
+ * orders them in an arbitrary but deterministic way with
+ * common_muxing_compare_messages().
+ *
+ * A head message without a usable timestamp uses the current last
+ * returned timestamp, which is less than or equal to the timestamp of
+ * any other message of the heap: updating the last returned timestamp
+ * therefore never breaks the heap property.
+ */
+static
+int muxer_upstream_msg_iter_gt(void *a, void *b)
+{
+	const struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_a = a;
+	const struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_b = b;
+	int64_t ts_ns_a = muxer_upstream_msg_iter_head_ts_ns(
+		muxer_upstream_msg_iter_a);
+	int64_t ts_ns_b = muxer_upstream_msg_iter_head_ts_ns(
+		muxer_upstream_msg_iter_b);
+
+	if (ts_ns_a != ts_ns_b) {
+		return ts_ns_a < ts_ns_b;
+	}
+
+	return common_muxing_compare_messages(
+		g_queue_peek_head(muxer_upstream_msg_iter_a->msgs),
+		g_queue_peek_head(muxer_upstream_msg_iter_b->msgs)) < 0;
+}
+
+/*
+ * Validates the clock class of the head message of
+ * `muxer_upstream_msg_iter` and updates its cached timestamp.
+ *
+ * `muxer_upstream_msg_iter` must not be part of the heap, or must be
+ * its maximum and be followed by a call to bt_heap_replace_max().
+ */
+static
+int update_muxer_upstream_msg_iter_head(
+		struct muxer_comp *muxer_comp,
+		struct muxer_msg_iter *muxer_msg_iter,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	const bt_message *msg;
+	int ret;
+
+	BT_ASSERT_DBG(muxer_upstream_msg_iter->msgs->length > 0);
+	msg = g_queue_peek_head(muxer_upstream_msg_iter->msgs);
+	BT_ASSERT_DBG(msg);
+
+	if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
+		ret = validate_new_stream_clock_class(
+			muxer_msg_iter, muxer_comp,
+			bt_message_stream_beginning_borrow_stream_const(
+				msg));
+		if (ret) {
+			/*
+			 * validate_new_stream_clock_class() logs
+			 * errors.
+			 */
+			goto end;
+		}
+	} else if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
+		const bt_clock_snapshot *cs;
+
+		cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+			msg);
+		ret = validate_clock_class(muxer_msg_iter, muxer_comp,
+			bt_clock_snapshot_borrow_clock_class_const(cs));
+		if (ret) {
+			/* validate_clock_class() logs errors */
+			goto end;
+		}
+	}
+
+	/* get_msg_ts_ns() logs errors */
+	ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
+		muxer_msg_iter->last_returned_ts_ns,
+		&muxer_upstream_msg_iter->head_ts_ns,
+		&muxer_upstream_msg_iter->head_ts_is_last_returned);
+
+end:
+	return ret;
+}
+
+/*
+ * This function returns the upstream message iterator wrapper of which
+ * the head message is the youngest available message amongst the
+ * non-ended upstream message iterators, or
  * BT_MESSAGE_ITERATOR_STATUS_END if there's no available
  * message.
  *
@@ -805,128 +987,23 @@ muxer_msg_iter_youngest_upstream_msg_iter(
 		struct muxer_upstream_msg_iter **muxer_upstream_msg_iter,
 		int64_t *ts_ns)
 {
-	size_t i;
-	int ret;
-	int64_t youngest_ts_ns = INT64_MAX;
 	bt_message_iterator_class_next_method_status status =
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
 	BT_ASSERT_DBG(muxer_comp);
 	BT_ASSERT_DBG(muxer_msg_iter);
 	BT_ASSERT_DBG(muxer_upstream_msg_iter);
-	*muxer_upstream_msg_iter = NULL;
-
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
-		const bt_message *msg;
-		struct muxer_upstream_msg_iter *cur_muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-		int64_t msg_ts_ns;
-
-		if (!cur_muxer_upstream_msg_iter->msg_iter) {
-			/* This upstream message iterator is ended */
-			BT_COMP_LOGT("Skipping ended upstream message iterator: "
-				"muxer-upstream-msg-iter-wrap-addr=%p",
-				cur_muxer_upstream_msg_iter);
-			continue;
-		}
-
-		BT_ASSERT_DBG(cur_muxer_upstream_msg_iter->msgs->length > 0);
-		msg = g_queue_peek_head(cur_muxer_upstream_msg_iter->msgs);
-		BT_ASSERT_DBG(msg);
-
-		if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
-			ret = validate_new_stream_clock_class(
-				muxer_msg_iter, muxer_comp,
-				bt_message_stream_beginning_borrow_stream_const(
-					msg));
-			if (ret) {
-				/*
-				 * validate_new_stream_clock_class() logs
-				 * errors.
-				 */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		} else if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
-			const bt_clock_snapshot *cs;
-
-			cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
-				msg);
-			ret = validate_clock_class(muxer_msg_iter, muxer_comp,
-				bt_clock_snapshot_borrow_clock_class_const(cs));
-			if (ret) {
-				/* validate_clock_class() logs errors */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		}
-
-		ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
-			muxer_msg_iter->last_returned_ts_ns, &msg_ts_ns);
-		if (ret) {
-			/* get_msg_ts_ns() logs errors */
-			*muxer_upstream_msg_iter = NULL;
-			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-			goto end;
-		}
-
-		/*
-		 * Update the current message iterator if it has not been set
-		 * yet, or if its current message has a timestamp smaller than
-		 * the previously selected youngest message.
-		 */
-		if (G_UNLIKELY(*muxer_upstream_msg_iter == NULL) ||
-				msg_ts_ns < youngest_ts_ns) {
-			*muxer_upstream_msg_iter =
-				cur_muxer_upstream_msg_iter;
-			youngest_ts_ns = msg_ts_ns;
-			*ts_ns = youngest_ts_ns;
-		} else if (msg_ts_ns == youngest_ts_ns) {
-			/*
-			 * The currently selected message to be sent downstream
-			 * next has the exact same timestamp that of the
-			 * current candidate message. We must break the tie
-			 * in a predictable manner.
-			 */
-			const bt_message *selected_msg = g_queue_peek_head(
-				(*muxer_upstream_msg_iter)->msgs);
-			BT_COMP_LOGD_STR("Two of the next message candidates have the same timestamps, pick one deterministically.");
-
-			/*
-			 * Order the messages in an arbitrary but determinitic
-			 * way.
-			 */
-			ret = common_muxing_compare_messages(msg, selected_msg);
-			if (ret < 0) {
-				/*
-				 * The `msg` should go first. Update the next
-				 * iterator and the current timestamp.
-				 */
-				*muxer_upstream_msg_iter =
-					cur_muxer_upstream_msg_iter;
-				youngest_ts_ns = msg_ts_ns;
-				*ts_ns = youngest_ts_ns;
-			} else if (ret == 0) {
-				/* Unable to pick which one should go first. */
-				BT_COMP_LOGW("Cannot deterministically pick next upstream message iterator because they have identical next messages: "
-					"muxer-upstream-msg-iter-wrap-addr=%p"
-					"cur-muxer-upstream-msg-iter-wrap-addr=%p",
-					*muxer_upstream_msg_iter,
-					cur_muxer_upstream_msg_iter);
-			}
-		}
-	}
+	BT_ASSERT_DBG(!muxer_msg_iter->stale_top_muxer_upstream_msg_iter);
+	*muxer_upstream_msg_iter = bt_heap_maximum(&muxer_msg_iter->heap);
 
 	if (!*muxer_upstream_msg_iter) {
 		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
 		*ts_ns = INT64_MIN;
+		goto end;
 	}
 
+	*ts_ns = muxer_upstream_msg_iter_head_ts_ns(*muxer_upstream_msg_iter);
+
 end:
 	return status;
 }
@@ -962,25 +1039,100 @@ end:
 	return status;
 }
 
+/*
+ * Moves the active upstream message iterator wrapper
+ * `muxer_upstream_msg_iter` to the array of ended upstream message
+ * iterator wrappers of `muxer_msg_iter`.
+ */
+static
+void make_muxer_upstream_msg_iter_ended(
+		struct muxer_msg_iter *muxer_msg_iter,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	GPtrArray *active = muxer_msg_iter->active_muxer_upstream_msg_iters;
+	guint i;
+
+	for (i = 0; i < active->len; i++) {
+		if (active->pdata[i] == muxer_upstream_msg_iter) {
+			break;
+		}
+	}
+
+	BT_ASSERT(i < active->len);
+	g_ptr_array_add(muxer_msg_iter->ended_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
+	active->pdata[i] = NULL;
+
+	/*
+	 * Use g_ptr_array_remove_fast() because the order of those
+	 * elements is not important.
+	 */
+	g_ptr_array_remove_index_fast(active, i);
+}
+
+/*
+ * Updates the position, within the heap, of the upstream message
+ * iterator wrapper from which muxer_msg_iter_do_next_one() last popped
+ * a message, or moves it to the pending upstream message iterator
+ * wrappers if its queue is now empty.
+ */
+static
+bt_message_iterator_class_next_method_status
+update_stale_top_muxer_upstream_msg_iter(
+		struct muxer_msg_iter *muxer_msg_iter)
+{
+	struct muxer_comp *muxer_comp = muxer_msg_iter->muxer_comp;
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
+		muxer_msg_iter->stale_top_muxer_upstream_msg_iter;
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+	if (!muxer_upstream_msg_iter) {
+		goto end;
+	}
+
+	BT_ASSERT_DBG(bt_heap_maximum(&muxer_msg_iter->heap) ==
+		muxer_upstream_msg_iter);
+
+	if (muxer_upstream_msg_iter->msgs->length == 0) {
+		(void) bt_heap_remove(&muxer_msg_iter->heap);
+		g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+			muxer_upstream_msg_iter);
+	} else {
+		if (update_muxer_upstream_msg_iter_head(muxer_comp,
+				muxer_msg_iter, muxer_upstream_msg_iter)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		/* Same maximum, new head message: rebalance the heap */
+		(void) bt_heap_replace_max(&muxer_msg_iter->heap,
+			muxer_upstream_msg_iter);
+	}
+
+	muxer_msg_iter->stale_top_muxer_upstream_msg_iter = NULL;
+
+end:
+	return status;
+}
+
 static
 bt_message_iterator_class_next_method_status
 validate_muxer_upstream_msg_iters(
 		struct muxer_msg_iter *muxer_msg_iter)
 {
 	struct muxer_comp *muxer_comp = muxer_msg_iter->muxer_comp;
+	GPtrArray *pending = muxer_msg_iter->pending_muxer_upstream_msg_iters;
 	bt_message_iterator_class_next_method_status status;
 	size_t i;
 
 	BT_COMP_LOGD("Validating muxer's upstream message iterator wrappers: "
 		"muxer-msg-iter-addr=%p", muxer_msg_iter);
 
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
+	for (i = 0; i < pending->len; i++) {
 		bool is_ended = false;
 		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
+			g_ptr_array_index(pending, i);
 
 		status = validate_muxer_upstream_msg_iter(
 			muxer_upstream_msg_iter, &is_ended);
@@ -1012,25 +1164,48 @@ validate_muxer_upstream_msg_iters(
 				"muxer-msg-iter-addr=%p, "
 				"muxer-upstream-msg-iter-wrap-addr=%p",
 				muxer_msg_iter, muxer_upstream_msg_iter);
-			g_ptr_array_add(
-				muxer_msg_iter->ended_muxer_upstream_msg_iters,
+			make_muxer_upstream_msg_iter_ended(muxer_msg_iter,
 				muxer_upstream_msg_iter);
-			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i] = NULL;
+			continue;
+		}
 
-			/*
-			 * Use g_ptr_array_remove_fast() because the
-			 * order of those elements is not important.
-			 */
-			g_ptr_array_remove_index_fast(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-			i--;
+		/*
+		 * A valid wrapper which isn't ended has at least one
+		 * queued message.
+		 */
+		BT_ASSERT_DBG(muxer_upstream_msg_iter->msgs->length > 0);
+
+		if (update_muxer_upstream_msg_iter_head(muxer_comp,
+				muxer_msg_iter, muxer_upstream_msg_iter)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (bt_heap_insert(&muxer_msg_iter->heap,
+				muxer_upstream_msg_iter)) {
+			BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+				"Failed to insert muxer's upstream message iterator wrapper into priority heap: "
+				"muxer-msg-iter-addr=%p, "
+				"muxer-upstream-msg-iter-wrap-addr=%p",
+				muxer_msg_iter, muxer_upstream_msg_iter);
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
 		}
 	}
 
 	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
 end:
+	/*
+	 * Remove the processed upstream message iterator wrappers.
+	 *
+	 * GLib < 2.48.0 asserts when g_ptr_array_remove_range() is
+	 * called on an empty array.
+	 */
+	if (i > 0) {
+		g_ptr_array_remove_range(pending, 0, i);
+	}
+
 	return status;
 }
 
@@ -1045,6 +1220,12 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 	/* Initialize to avoid -Wmaybe-uninitialized warning with gcc 4.8. */
 	int64_t next_return_ts = 0;
 
+	status = update_stale_top_muxer_upstream_msg_iter(muxer_msg_iter);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		/* update_stale_top_muxer_upstream_msg_iter() logs errors */
+		goto end;
+	}
+
 	status = validate_muxer_upstream_msg_iters(muxer_msg_iter);
 	if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
 		/* validate_muxer_upstream_msg_iters() logs details */
@@ -1091,6 +1272,8 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 		"muxer-upstream-msg-iter-wrap-addr=%p, "
 		"ts=%" PRId64,
 		muxer_msg_iter, muxer_upstream_msg_iter, next_return_ts);
+	BT_PROBE3(muxer_select, muxer_msg_iter, muxer_upstream_msg_iter,
+		next_return_ts);
 	BT_ASSERT_DBG(status ==
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
 	BT_ASSERT_DBG(muxer_upstream_msg_iter);
@@ -1103,6 +1286,179 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 	BT_ASSERT_DBG(*msg);
 	muxer_msg_iter->last_returned_ts_ns = next_return_ts;
 
+	/*
+	 * The head message of this upstream message iterator wrapper
+	 * changed: update its position within the heap the next time.
+	 */
+	muxer_msg_iter->stale_top_muxer_upstream_msg_iter =
+		muxer_upstream_msg_iter;
+
+end:
+	return status;
+}
+
+/*
+ * Appends to `msgs` the next messages of the upstream message iterator
+ * wrapper from which muxer_msg_iter_do_next_one() last popped a message
+ * as long as they go before the head messages of all the other upstream
+ * message iterator wrappers, setting `*count` to the number of appended
+ * messages (at most `capacity`).
+ *
+ * This only needs a comparison with the runner-up of the heap per
+ * message instead of a whole selection: consecutive messages of a
+ * single upstream message iterator are common (for example, bursts of
+ * events from a single CPU).
+ *
+ * This function stops as soon as it would need to call an upstream
+ * message iterator, leaving the general case, including error
+ * reporting, to muxer_msg_iter_do_next_one().
+ */
+static
+bt_message_iterator_class_next_method_status muxer_msg_iter_drain_top_run(
+		struct muxer_comp *muxer_comp,
+		struct muxer_msg_iter *muxer_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
+		muxer_msg_iter->stale_top_muxer_upstream_msg_iter;
+	struct ptr_heap *heap = &muxer_msg_iter->heap;
+	struct muxer_upstream_msg_iter *runner_up = NULL;
+
+	*count = 0;
+
+	if (!muxer_upstream_msg_iter ||
+			muxer_msg_iter->pending_muxer_upstream_msg_iters->len > 0) {
+		goto end;
+	}
+
+	BT_ASSERT_DBG(bt_heap_maximum(heap) == muxer_upstream_msg_iter);
+
+	/* The runner-up is the greatest child of the top of the heap */
+	if (heap->len >= 2) {
+		runner_up = heap->ptrs[1];
+	}
+
+	if (heap->len >= 3 && muxer_upstream_msg_iter_gt(heap->ptrs[2],
+			runner_up)) {
+		runner_up = heap->ptrs[2];
+	}
+
+	while (*count < capacity && muxer_upstream_msg_iter->msgs->length > 0) {
+		int64_t ts_ns;
+
+		if (update_muxer_upstream_msg_iter_head(muxer_comp,
+				muxer_msg_iter, muxer_upstream_msg_iter)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (runner_up && !muxer_upstream_msg_iter_gt(
+				muxer_upstream_msg_iter, runner_up)) {
+			break;
+		}
+
+		ts_ns = muxer_upstream_msg_iter_head_ts_ns(
+			muxer_upstream_msg_iter);
+		if (ts_ns < muxer_msg_iter->last_returned_ts_ns) {
+			/* muxer_msg_iter_do_next_one() reports this */
+			break;
+		}
+
+		/*
+		 * The top of the heap remains the top: its position
+		 * within the heap doesn't change.
+		 */
+		msgs[*count] = g_queue_pop_head(muxer_upstream_msg_iter->msgs);
+		BT_ASSERT_DBG(msgs[*count]);
+		(*count)++;
+		muxer_msg_iter->last_returned_ts_ns = ts_ns;
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Appends to `msgs` the queued messages of the single active upstream
+ * message iterator wrapper of `muxer_msg_iter`, setting `*count` to
+ * the number of appended messages (at most `capacity`).
+ *
+ * With a single active upstream message iterator (a single input port,
+ * or all the other ones ended), there's nothing to order: this function
+ * forwards the upstream messages as is, without getting their
+ * timestamps. It only validates the clock classes of the messages which
+ * can introduce a new one (stream beginning and message iterator
+ * inactivity), like update_muxer_upstream_msg_iter_head() does.
+ *
+ * The set of active upstream message iterators only grows back when
+ * seeking, which resets the last returned timestamp anyway.
+ */
+static
+bt_message_iterator_class_next_method_status
+muxer_msg_iter_forward_single_upstream(
+		struct muxer_comp *muxer_comp,
+		struct muxer_msg_iter *muxer_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	bt_message_iterator_class_next_method_status status;
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter;
+
+	*count = 0;
+	status = update_stale_top_muxer_upstream_msg_iter(muxer_msg_iter);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		/* update_stale_top_muxer_upstream_msg_iter() logs errors */
+		goto end;
+	}
+
+	/* This validates the head message, if any */
+	status = validate_muxer_upstream_msg_iters(muxer_msg_iter);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		/* validate_muxer_upstream_msg_iters() logs details */
+		goto end;
+	}
+
+	muxer_upstream_msg_iter = bt_heap_maximum(&muxer_msg_iter->heap);
+	if (!muxer_upstream_msg_iter) {
+		/* The upstream message iterator ended */
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+		goto end;
+	}
+
+	BT_ASSERT_DBG(muxer_msg_iter->heap.len == 1);
+	BT_ASSERT_DBG(muxer_upstream_msg_iter->msgs->length > 0);
+
+	while (*count < capacity && muxer_upstream_msg_iter->msgs->length > 0) {
+		const bt_message *msg =
+			g_queue_peek_head(muxer_upstream_msg_iter->msgs);
+
+		if (*count > 0 && G_UNLIKELY(
+				bt_message_get_type(msg) ==
+					BT_MESSAGE_TYPE_STREAM_BEGINNING ||
+				bt_message_get_type(msg) ==
+					BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
+			if (update_muxer_upstream_msg_iter_head(muxer_comp,
+					muxer_msg_iter,
+					muxer_upstream_msg_iter)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+				break;
+			}
+		}
+
+		msgs[*count] = g_queue_pop_head(muxer_upstream_msg_iter->msgs);
+		(*count)++;
+	}
+
+	/*
+	 * The head message of this upstream message iterator wrapper
+	 * changed: update its position within the heap the next time.
+	 */
+	muxer_msg_iter->stale_top_muxer_upstream_msg_iter =
+		muxer_upstream_msg_iter;
+
 end:
 	return status;
 }
@@ -1128,14 +1484,30 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next(
 		goto end;
 	}
 
+	if (muxer_msg_iter->active_muxer_upstream_msg_iters->len == 1) {
+		status = muxer_msg_iter_forward_single_upstream(muxer_comp,
+			muxer_msg_iter, msgs, capacity, &i);
+		goto check_count;
+	}
+
 	do {
+		uint64_t run_count;
+
 		status = muxer_msg_iter_do_next_one(muxer_comp,
 			muxer_msg_iter, &msgs[i]);
-		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
-			i++;
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			break;
 		}
+
+		i++;
+
+		/* Append the rest of the run of this upstream, if any */
+		status = muxer_msg_iter_drain_top_run(muxer_comp,
+			muxer_msg_iter, &msgs[i], capacity - i, &run_count);
+		i += run_count;
 	} while (i < capacity && status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
 
+check_count:
 	if (i > 0) {
 		/*
 		 * Even if muxer_msg_iter_do_next_one() returned
@@ -1194,6 +1566,17 @@ void destroy_muxer_msg_iter(struct muxer_msg_iter *muxer_msg_iter)
 			muxer_msg_iter->ended_muxer_upstream_msg_iters, TRUE);
 	}
 
+	if (muxer_msg_iter->pending_muxer_upstream_msg_iters) {
+		g_ptr_array_free(
+			muxer_msg_iter->pending_muxer_upstream_msg_iters, TRUE);
+	}
+
+	if (muxer_msg_iter->validated_clock_classes) {
+		g_hash_table_destroy(muxer_msg_iter->validated_clock_classes);
+	}
+
+	bt_heap_free(&muxer_msg_iter->heap);
+
 	g_free(muxer_msg_iter);
 }
 
@@ -1269,6 +1652,8 @@ muxer_msg_iter_init_upstream_iterators(struct muxer_comp *muxer_comp,
 	 */
 	bt_self_message_iterator_configuration_set_can_seek_forward(
 		config, can_seek_forward);
+	bt_self_message_iterator_configuration_set_max_batch_size(
+		config, MUXER_MSG_ITER_MAX_BATCH_SIZE);
 
 	status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
@@ -1338,6 +1723,29 @@ bt_message_iterator_class_initialize_method_status muxer_msg_iter_init(
 		goto error;
 	}
 
+	muxer_msg_iter->pending_muxer_upstream_msg_iters = g_ptr_array_new();
+	if (!muxer_msg_iter->pending_muxer_upstream_msg_iters) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp, "Failed to allocate a GPtrArray.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	muxer_msg_iter->validated_clock_classes = g_hash_table_new_full(
+		g_direct_hash, g_direct_equal, put_validated_clock_class, NULL);
+	if (!muxer_msg_iter->validated_clock_classes) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp, "Failed to allocate a GHashTable.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	if (bt_heap_init(&muxer_msg_iter->heap, 0,
+			muxer_upstream_msg_iter_gt)) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+			"Failed to initialize a priority heap.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	status = muxer_msg_iter_init_upstream_iterators(muxer_comp,
 		muxer_msg_iter, config);
 	if (status) {
@@ -1522,27 +1930,61 @@ end:
 	return status;
 }
 
-BT_HIDDEN
-bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_beginning(
-		bt_self_message_iterator *self_msg_iter)
+/*
+ * Seeks the beginning (if `beginning` is true) or `ns_from_origin` of
+ * the upstream message iterator of `upstream_msg_iter`.
+ *
+ * Returns a seek method status.
+ */
+static inline
+int seek_muxer_upstream_msg_iter(
+		struct muxer_upstream_msg_iter *upstream_msg_iter,
+		bool beginning, int64_t ns_from_origin)
 {
-	struct muxer_msg_iter *muxer_msg_iter =
-		bt_self_message_iterator_get_data(self_msg_iter);
-	bt_message_iterator_class_seek_beginning_method_status status =
-		BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
-	bt_message_iterator_seek_beginning_status seek_beg_status;
+	if (beginning) {
+		return (int) bt_message_iterator_seek_beginning(
+			upstream_msg_iter->msg_iter);
+	} else {
+		return (int) bt_message_iterator_seek_ns_from_origin(
+			upstream_msg_iter->msg_iter, ns_from_origin);
+	}
+}
+
+/*
+ * Seeks the beginning (if `beginning` is true) or `ns_from_origin` of
+ * all the upstream message iterators of `muxer_msg_iter`, and resets
+ * its state.
+ *
+ * Returns a seek method status.
+ */
+static
+int muxer_msg_iter_seek(struct muxer_msg_iter *muxer_msg_iter,
+		bool beginning, int64_t ns_from_origin)
+{
+	int status = BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
+	int seek_status;
 	uint64_t i;
 
+	/*
+	 * Empty the heap first: the comparison function needs the
+	 * message queues which we're about to empty.
+	 */
+	while (bt_heap_remove(&muxer_msg_iter->heap)) {
+		continue;
+	}
+
+	muxer_msg_iter->stale_top_muxer_upstream_msg_iter = NULL;
+
 	/* Seek all ended upstream iterators first */
 	for (i = 0; i < muxer_msg_iter->ended_muxer_upstream_msg_iters->len;
 			i++) {
 		struct muxer_upstream_msg_iter *upstream_msg_iter =
 			muxer_msg_iter->ended_muxer_upstream_msg_iters->pdata[i];
 
-		seek_beg_status = bt_message_iterator_seek_beginning(
-			upstream_msg_iter->msg_iter);
-		if (seek_beg_status != BT_MESSAGE_ITERATOR_SEEK_BEGINNING_STATUS_OK) {
-			status = (int) seek_beg_status;
+		seek_status = seek_muxer_upstream_msg_iter(upstream_msg_iter,
+			beginning, ns_from_origin);
+		if (seek_status != BT_MESSAGE_ITERATOR_SEEK_BEGINNING_STATUS_OK) {
+			status = seek_status;
 			goto end;
 		}
 
@@ -1555,10 +1997,10 @@ bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_begin
 		struct muxer_upstream_msg_iter *upstream_msg_iter =
 			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i];
 
-		seek_beg_status = bt_message_iterator_seek_beginning(
-			upstream_msg_iter->msg_iter);
-		if (seek_beg_status != BT_MESSAGE_ITERATOR_SEEK_BEGINNING_STATUS_OK) {
-			status = (int) seek_beg_status;
+		seek_status = seek_muxer_upstream_msg_iter(upstream_msg_iter,
+			beginning, ns_from_origin);
+		if (seek_status != BT_MESSAGE_ITERATOR_SEEK_BEGINNING_STATUS_OK) {
+			status = seek_status;
 			goto end;
 		}
 
@@ -1584,10 +2026,116 @@ bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_begin
 		g_ptr_array_remove_range(muxer_msg_iter->ended_muxer_upstream_msg_iters,
 			0, muxer_msg_iter->ended_muxer_upstream_msg_iters->len);
 	}
+
+	/* All the active upstream message iterators need a "next" call */
+	g_ptr_array_set_size(muxer_msg_iter->pending_muxer_upstream_msg_iters, 0);
+
+	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
+			i++) {
+		g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i]);
+	}
+
 	muxer_msg_iter->last_returned_ts_ns = INT64_MIN;
 	muxer_msg_iter->clock_class_expectation =
 		MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_ANY;
+	g_hash_table_remove_all(muxer_msg_iter->validated_clock_classes);
 
 end:
 	return status;
 }
+
+BT_HIDDEN
+bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_beginning(
+		bt_self_message_iterator *self_msg_iter)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	return (int) muxer_msg_iter_seek(muxer_msg_iter, true, 0);
+}
+
+static inline
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+		struct muxer_comp *muxer_comp,
+		GPtrArray *muxer_upstream_msg_iters, int64_t ns_from_origin,
+		bt_bool *can_seek)
+{
+	bt_message_iterator_class_can_seek_ns_from_origin_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+	uint64_t i;
+
+	for (i = 0; i < muxer_upstream_msg_iters->len; i++) {
+		struct muxer_upstream_msg_iter *upstream_msg_iter =
+			muxer_upstream_msg_iters->pdata[i];
+		status = (int) bt_message_iterator_can_seek_ns_from_origin(
+			upstream_msg_iter->msg_iter, ns_from_origin, can_seek);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+				"Failed to determine whether upstream message iterator can seek: "
+				"msg-iter-addr=%p, seek-ns-from-origin=%" PRId64,
+				upstream_msg_iter->msg_iter, ns_from_origin);
+			goto end;
+		}
+
+		if (!*can_seek) {
+			goto end;
+		}
+	}
+
+	*can_seek = BT_TRUE;
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+muxer_msg_iter_can_seek_ns_from_origin(
+		bt_self_message_iterator *self_msg_iter,
+		int64_t ns_from_origin, bt_bool *can_seek)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	bt_message_iterator_class_can_seek_ns_from_origin_method_status status;
+
+	status = muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+		muxer_msg_iter->muxer_comp,
+		muxer_msg_iter->active_muxer_upstream_msg_iters,
+		ns_from_origin, can_seek);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK) {
+		goto end;
+	}
+
+	if (!*can_seek) {
+		goto end;
+	}
+
+	status = muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+		muxer_msg_iter->muxer_comp,
+		muxer_msg_iter->ended_muxer_upstream_msg_iters,
+		ns_from_origin, can_seek);
+
+end:
+	return status;
+}
+
+/*
+ * Seeking all the upstream message iterators to `ns_from_origin` is
+ * enough: the first message of each one is then the first one at or
+ * after `ns_from_origin`, so that the first message of the muxed
+ * sequence also is.
+ */
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+muxer_msg_iter_seek_ns_from_origin(
+		bt_self_message_iterator *self_msg_iter,
+		int64_t ns_from_origin)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	return (int) muxer_msg_iter_seek(muxer_msg_iter, false,
+		ns_from_origin);
+}
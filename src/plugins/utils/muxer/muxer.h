@@ -52,4 +52,16 @@ BT_HIDDEN
 bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_beginning(
 		bt_self_message_iterator *message_iterator);
 
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+muxer_msg_iter_can_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin, bt_bool *can_seek);
+
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+muxer_msg_iter_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
 #endif /* BABELTRACE_PLUGINS_UTILS_MUXER_H */
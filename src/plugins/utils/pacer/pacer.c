@@ -0,0 +1,600 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (pacer_comp->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (pacer_comp->log_level)
+#define BT_LOG_TAG "PLUGIN/FLT.UTILS.PACER"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include "common/common.h"
+#include "common/assert.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <glib.h>
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "pacer.h"
+
+static const char * const in_port_name = "in";
+
+struct pacer_comp {
+	/* Replay speed factor (2 means twice as fast as recorded) */
+	double speed;
+
+	/*
+	 * Minimum wall clock time (µs) between two message iterator
+	 * inactivity messages while a message is held (0: never emit
+	 * inactivity messages).
+	 */
+	gint64 inactivity_period_us;
+
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+	bt_self_component_filter *self_comp_filter;
+};
+
+struct pacer_iterator {
+	/* Weak */
+	struct pacer_comp *pacer_comp;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	/* Owned by this */
+	bt_message_iterator *upstream_iter;
+
+	/* Messages received from upstream, not released yet (owned) */
+	GQueue *msgs;
+
+	/* True when the upstream message iterator ended */
+	bool upstream_ended;
+
+	/*
+	 * Time of the first message which has a time (nanoseconds from
+	 * origin) and wall clock (monotonic) time (µs) at which this
+	 * iterator released it: both times advance together, at the
+	 * `speed` factor.
+	 */
+	bool has_ref;
+	int64_t ref_ns_from_origin;
+	gint64 ref_wall_time;
+
+	/* Time (nanoseconds from origin) of the last released message */
+	int64_t last_ns_from_origin;
+
+	/* Wall clock time (µs) of the last inactivity message */
+	gint64 last_inactivity_wall_time;
+};
+
+static
+enum bt_param_validation_status validate_speed_type(
+		const bt_value *value,
+		struct bt_param_validation_context *context)
+{
+	enum bt_param_validation_status status = BT_PARAM_VALIDATION_STATUS_OK;
+
+	if (!bt_value_is_real(value) && !bt_value_is_unsigned_integer(value) &&
+			!bt_value_is_signed_integer(value)) {
+		status = bt_param_validation_error(context,
+			"unexpected type: expected-types=[%s, %s, %s], actual-type=%s",
+			bt_common_value_type_string(BT_VALUE_TYPE_REAL),
+			bt_common_value_type_string(BT_VALUE_TYPE_UNSIGNED_INTEGER),
+			bt_common_value_type_string(BT_VALUE_TYPE_SIGNED_INTEGER),
+			bt_common_value_type_string(bt_value_get_type(value)));
+	}
+
+	return status;
+}
+
+static
+struct bt_param_validation_map_value_entry_descr pacer_params[] = {
+	{ "speed", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .validation_func = validate_speed_type } },
+	{ "inactivity-period", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+bt_component_class_initialize_method_status init_pacer_comp_from_params(
+		struct pacer_comp *pacer_comp, const bt_value *params)
+{
+	const bt_value *value;
+	bt_component_class_initialize_method_status status;
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+
+	validation_status = bt_param_validation_validate(params,
+		pacer_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(pacer_comp->self_comp, "%s",
+			validate_error);
+		goto end;
+	}
+
+	pacer_comp->speed = 1.;
+	value = bt_value_map_borrow_entry_value_const(params, "speed");
+	if (value) {
+		if (bt_value_is_real(value)) {
+			pacer_comp->speed = bt_value_real_get(value);
+		} else if (bt_value_is_unsigned_integer(value)) {
+			pacer_comp->speed =
+				(double) bt_value_integer_unsigned_get(value);
+		} else {
+			pacer_comp->speed =
+				(double) bt_value_integer_signed_get(value);
+		}
+
+		if (!(pacer_comp->speed > 0)) {
+			BT_COMP_LOGE_APPEND_CAUSE(pacer_comp->self_comp,
+				"Invalid `speed` parameter: must be greater than 0: "
+				"speed=%f", pacer_comp->speed);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	pacer_comp->inactivity_period_us = 100 * 1000;
+	value = bt_value_map_borrow_entry_value_const(params,
+		"inactivity-period");
+	if (value) {
+		uint64_t period_ms = bt_value_integer_unsigned_get(value);
+
+		if (period_ms > G_MAXINT64 / 1000) {
+			BT_COMP_LOGE_APPEND_CAUSE(pacer_comp->self_comp,
+				"Invalid `inactivity-period` parameter: "
+				"value=%" PRIu64, period_ms);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		pacer_comp->inactivity_period_us = (gint64) period_ms * 1000;
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status pacer_init(
+		bt_self_component_filter *self_comp_flt,
+		bt_self_component_filter_configuration *config,
+		const bt_value *params, void *init_data)
+{
+	bt_component_class_initialize_method_status status;
+	bt_self_component_add_port_status add_port_status;
+	struct pacer_comp *pacer_comp = g_new0(struct pacer_comp, 1);
+	bt_self_component *self_comp =
+		bt_self_component_filter_as_self_component(self_comp_flt);
+
+	if (!pacer_comp) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	pacer_comp->log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(self_comp));
+	pacer_comp->self_comp = self_comp;
+	pacer_comp->self_comp_filter = self_comp_flt;
+	status = init_pacer_comp_from_params(pacer_comp, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
+	add_port_status = bt_self_component_filter_add_input_port(
+		self_comp_flt, in_port_name, NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	add_port_status = bt_self_component_filter_add_output_port(
+		self_comp_flt, "out", NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	bt_self_component_set_data(self_comp, pacer_comp);
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	g_free(pacer_comp);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void pacer_finalize(bt_self_component_filter *self_comp)
+{
+	g_free(bt_self_component_get_data(
+		bt_self_component_filter_as_self_component(self_comp)));
+}
+
+static
+void destroy_pacer_iterator(struct pacer_iterator *pacer_it)
+{
+	if (!pacer_it) {
+		goto end;
+	}
+
+	bt_message_iterator_put_ref(pacer_it->upstream_iter);
+
+	if (pacer_it->msgs) {
+		bt_message *msg;
+
+		while ((msg = g_queue_pop_head(pacer_it->msgs))) {
+			bt_message_put_ref(msg);
+		}
+
+		g_queue_free(pacer_it->msgs);
+	}
+
+	g_free(pacer_it);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status pacer_msg_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	bt_message_iterator_class_initialize_method_status status;
+	bt_message_iterator_create_from_message_iterator_status
+		msg_iter_status;
+	struct pacer_iterator *pacer_it;
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+
+	pacer_it = g_new0(struct pacer_iterator, 1);
+	if (!pacer_it) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	pacer_it->pacer_comp = bt_self_component_get_data(self_comp);
+	BT_ASSERT(pacer_it->pacer_comp);
+	msg_iter_status = bt_message_iterator_create_from_message_iterator(
+		self_msg_iter,
+		bt_self_component_filter_borrow_input_port_by_name(
+			pacer_it->pacer_comp->self_comp_filter, in_port_name),
+		&pacer_it->upstream_iter);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_MESSAGE_ITERATOR_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto error;
+	}
+
+	pacer_it->msgs = g_queue_new();
+	if (!pacer_it->msgs) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	pacer_it->last_ns_from_origin = INT64_MIN;
+	pacer_it->self_msg_iter = self_msg_iter;
+	bt_self_message_iterator_set_data(self_msg_iter, pacer_it);
+	status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_pacer_iterator(pacer_it);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void pacer_msg_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	destroy_pacer_iterator(bt_self_message_iterator_get_data(
+		self_msg_iter));
+}
+
+/*
+ * Borrows the default clock snapshot of `msg`, if any.
+ *
+ * Returns `NULL` if `msg` has no (known) default clock snapshot.
+ */
+static
+const bt_clock_snapshot *borrow_msg_clock_snapshot(const bt_message *msg)
+{
+	const bt_clock_snapshot *clock_snapshot = NULL;
+	const bt_stream_class *sc;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		if (bt_message_event_borrow_stream_class_default_clock_class_const(
+				msg)) {
+			clock_snapshot =
+				bt_message_event_borrow_default_clock_snapshot_const(
+					msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		sc = bt_stream_borrow_class_const(bt_packet_borrow_stream_const(
+			bt_message_packet_beginning_borrow_packet_const(msg)));
+
+		if (bt_stream_class_packets_have_beginning_default_clock_snapshot(
+				sc)) {
+			clock_snapshot =
+				bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+					msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		sc = bt_stream_borrow_class_const(bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg)));
+
+		if (bt_stream_class_packets_have_end_default_clock_snapshot(
+				sc)) {
+			clock_snapshot =
+				bt_message_packet_end_borrow_default_clock_snapshot_const(
+					msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		sc = bt_stream_borrow_class_const(
+			bt_message_discarded_events_borrow_stream_const(msg));
+
+		if (bt_stream_class_discarded_events_have_default_clock_snapshots(
+				sc)) {
+			clock_snapshot =
+				bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+					msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		sc = bt_stream_borrow_class_const(
+			bt_message_discarded_packets_borrow_stream_const(msg));
+
+		if (bt_stream_class_discarded_packets_have_default_clock_snapshots(
+				sc)) {
+			clock_snapshot =
+				bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+					msg);
+		}
+
+		break;
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+		clock_snapshot =
+			bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+				msg);
+		break;
+	default:
+		/* Stream beginning/end: released as soon as possible */
+		break;
+	}
+
+	return clock_snapshot;
+}
+
+/*
+ * Returns the wall clock (monotonic) time (µs) at which to release a
+ * message of which the time is `ns_from_origin`.
+ */
+static inline
+gint64 release_wall_time(struct pacer_iterator *pacer_it,
+		int64_t ns_from_origin)
+{
+	double delta_us =
+		(double) (ns_from_origin - pacer_it->ref_ns_from_origin) /
+		1000. / pacer_it->pacer_comp->speed;
+
+	return pacer_it->ref_wall_time + (gint64) delta_us;
+}
+
+/*
+ * Creates a message iterator inactivity message, with a snapshot of the
+ * clock class of `held_clock_snapshot`, for the current replay time
+ * (from the wall clock time `now`).
+ *
+ * Returns `NULL` if there's no such time after the last released
+ * message.
+ */
+static
+bt_message *create_inactivity_msg(struct pacer_iterator *pacer_it,
+		const bt_clock_snapshot *held_clock_snapshot, gint64 now)
+{
+	const bt_clock_class *clock_class =
+		bt_clock_snapshot_borrow_clock_class_const(
+			held_clock_snapshot);
+	int64_t ns_from_origin = pacer_it->ref_ns_from_origin + (int64_t)
+		((double) (now - pacer_it->ref_wall_time) * 1000. *
+			pacer_it->pacer_comp->speed);
+	int64_t offset_seconds;
+	uint64_t offset_cycles;
+	uint64_t raw_value;
+	int64_t check_ns_from_origin;
+	bt_message *msg = NULL;
+
+	bt_clock_class_get_offset(clock_class, &offset_seconds,
+		&offset_cycles);
+
+	if (bt_common_clock_value_from_ns_from_origin(offset_seconds,
+			offset_cycles, bt_clock_class_get_frequency(clock_class),
+			ns_from_origin, &raw_value)) {
+		goto end;
+	}
+
+	/* Rounding to cycles must not go back in time */
+	if (bt_clock_class_cycles_to_ns_from_origin(clock_class, raw_value,
+			&check_ns_from_origin) !=
+			BT_CLOCK_CLASS_CYCLES_TO_NS_FROM_ORIGIN_STATUS_OK ||
+			check_ns_from_origin <= pacer_it->last_ns_from_origin ||
+			raw_value >= bt_clock_snapshot_get_value(
+				held_clock_snapshot)) {
+		goto end;
+	}
+
+	msg = bt_message_message_iterator_inactivity_create(
+		pacer_it->self_msg_iter, clock_class, raw_value);
+	if (msg) {
+		pacer_it->last_ns_from_origin = check_ns_from_origin;
+	}
+
+end:
+	return msg;
+}
+
+static
+bt_message_iterator_class_next_method_status get_upstream_msgs(
+		struct pacer_iterator *pacer_it)
+{
+	struct pacer_comp *pacer_comp = pacer_it->pacer_comp;
+	bt_message_iterator_class_next_method_status status;
+	bt_message_iterator_next_status upstream_status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	upstream_status = bt_message_iterator_next(pacer_it->upstream_iter,
+		&msgs, &count);
+	switch (upstream_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		for (i = 0; i < count; i++) {
+			g_queue_push_tail(pacer_it->msgs, (gpointer) msgs[i]);
+		}
+
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		pacer_it->upstream_ended = true;
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_ERROR:
+		BT_COMP_LOGE_APPEND_CAUSE(pacer_comp->self_comp,
+			"Upstream iterator's next method returned an error: "
+			"status=%s",
+			bt_common_func_status_string(upstream_status));
+		/* Fall through */
+	default:
+		status = (int) upstream_status;
+		break;
+	}
+
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_next_method_status pacer_msg_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct pacer_iterator *pacer_it =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct pacer_comp *pacer_comp = pacer_it->pacer_comp;
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	const bt_clock_snapshot *held_clock_snapshot = NULL;
+	gint64 now;
+	uint64_t i = 0;
+
+	if (g_queue_is_empty(pacer_it->msgs) && !pacer_it->upstream_ended) {
+		status = get_upstream_msgs(pacer_it);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			goto end;
+		}
+	}
+
+	now = g_get_monotonic_time();
+
+	while (i < capacity && !g_queue_is_empty(pacer_it->msgs)) {
+		const bt_message *msg = g_queue_peek_head(pacer_it->msgs);
+		const bt_clock_snapshot *clock_snapshot =
+			borrow_msg_clock_snapshot(msg);
+
+		if (clock_snapshot) {
+			int64_t ns_from_origin;
+
+			if (bt_clock_snapshot_get_ns_from_origin(clock_snapshot,
+					&ns_from_origin)) {
+				BT_COMP_LOGE_APPEND_CAUSE(pacer_comp->self_comp,
+					"Cannot compute nanoseconds from origin of clock snapshot: "
+					"msg-addr=%p", msg);
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (G_UNLIKELY(!pacer_it->has_ref)) {
+				pacer_it->ref_ns_from_origin = ns_from_origin;
+				pacer_it->ref_wall_time = now;
+				pacer_it->last_inactivity_wall_time = now;
+				pacer_it->has_ref = true;
+			}
+
+			if (release_wall_time(pacer_it, ns_from_origin) > now) {
+				/* Too early: hold it */
+				held_clock_snapshot = clock_snapshot;
+				break;
+			}
+
+			if (ns_from_origin > pacer_it->last_ns_from_origin) {
+				pacer_it->last_ns_from_origin = ns_from_origin;
+			}
+		}
+
+		msgs[i] = g_queue_pop_head(pacer_it->msgs);
+		i++;
+	}
+
+	if (i > 0) {
+		*count = i;
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+		goto end;
+	}
+
+	if (g_queue_is_empty(pacer_it->msgs)) {
+		BT_ASSERT_DBG(pacer_it->upstream_ended);
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+		goto end;
+	}
+
+	/*
+	 * Holding a message which is too early: like a live source
+	 * waiting for data, tell downstream that there's no message
+	 * until the current replay time, from time to time, and try
+	 * again later otherwise.
+	 */
+	BT_ASSERT_DBG(held_clock_snapshot);
+
+	if (pacer_comp->inactivity_period_us > 0 &&
+			now - pacer_it->last_inactivity_wall_time >=
+				pacer_comp->inactivity_period_us) {
+		bt_message *inactivity_msg = create_inactivity_msg(pacer_it,
+			held_clock_snapshot, now);
+
+		pacer_it->last_inactivity_wall_time = now;
+
+		if (inactivity_msg) {
+			msgs[0] = inactivity_msg;
+			*count = 1;
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+			goto end;
+		}
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+
+end:
+	return status;
+}
@@ -9,6 +9,12 @@
 #include "counter/counter.h"
 #include "muxer/muxer.h"
 #include "trimmer/trimmer.h"
+#include "gen/gen.h"
+#include "pacer/pacer.h"
+#include "sample/sample.h"
+#include "aggregate/aggregate.h"
+#include "cache/cache-sink.h"
+#include "cache/cache-src.h"
 
 #ifndef BT_BUILT_IN_PLUGINS
 BT_PLUGIN_MODULE();
@@ -21,6 +27,8 @@ BT_PLUGIN_LICENSE("MIT");
 
 /* sink.utils.dummy */
 BT_PLUGIN_SINK_COMPONENT_CLASS(dummy, dummy_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GET_SUPPORTED_MIP_VERSIONS_METHOD(dummy,
+	dummy_get_supported_mip_versions);
 BT_PLUGIN_SINK_COMPONENT_CLASS_INITIALIZE_METHOD(dummy, dummy_init);
 BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(dummy, dummy_finalize);
 BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(dummy,
@@ -32,6 +40,8 @@ BT_PLUGIN_SINK_COMPONENT_CLASS_HELP(dummy,
 
 /* sink.utils.counter */
 BT_PLUGIN_SINK_COMPONENT_CLASS(counter, counter_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GET_SUPPORTED_MIP_VERSIONS_METHOD(counter,
+	counter_get_supported_mip_versions);
 BT_PLUGIN_SINK_COMPONENT_CLASS_INITIALIZE_METHOD(counter, counter_init);
 BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(counter, counter_finalize);
 BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(counter,
@@ -41,6 +51,21 @@ BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(counter,
 BT_PLUGIN_SINK_COMPONENT_CLASS_HELP(counter,
 	"See the babeltrace2-sink.utils.counter(7) manual page.");
 
+/* src.utils.gen */
+BT_PLUGIN_SOURCE_COMPONENT_CLASS(gen, gen_msg_iter_next);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESCRIPTION(gen,
+	"Generate synthetic streams, packets, and events.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_HELP(gen,
+	"See the babeltrace2-source.utils.gen(7) manual page.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_INITIALIZE_METHOD(gen, gen_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_FINALIZE_METHOD(gen, gen_finalize);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD(gen,
+	gen_msg_iter_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(gen,
+	gen_msg_iter_finalize);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHODS(gen,
+	gen_msg_iter_seek_beginning, gen_msg_iter_can_seek_beginning);
+
 /* flt.utils.trimmer */
 BT_PLUGIN_FILTER_COMPONENT_CLASS(trimmer, trimmer_msg_iter_next);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(trimmer,
@@ -54,6 +79,69 @@ BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD(trimme
 BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(trimmer,
 	trimmer_msg_iter_finalize);
 
+/* flt.utils.pacer */
+BT_PLUGIN_FILTER_COMPONENT_CLASS(pacer, pacer_msg_iter_next);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(pacer,
+	"Release messages at the pace of their time, like a live source.");
+BT_PLUGIN_FILTER_COMPONENT_CLASS_HELP(pacer,
+	"See the babeltrace2-filter.utils.pacer(7) manual page.");
+BT_PLUGIN_FILTER_COMPONENT_CLASS_INITIALIZE_METHOD(pacer, pacer_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_FINALIZE_METHOD(pacer, pacer_finalize);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD(pacer,
+	pacer_msg_iter_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(pacer,
+	pacer_msg_iter_finalize);
+
+/* flt.utils.sample */
+BT_PLUGIN_FILTER_COMPONENT_CLASS(sample, sample_msg_iter_next);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(sample,
+	"Keep a subset of the events, replacing the other ones with discarded events messages.");
+BT_PLUGIN_FILTER_COMPONENT_CLASS_HELP(sample,
+	"See the babeltrace2-filter.utils.sample(7) manual page.");
+BT_PLUGIN_FILTER_COMPONENT_CLASS_INITIALIZE_METHOD(sample, sample_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_FINALIZE_METHOD(sample, sample_finalize);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD(sample,
+	sample_msg_iter_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(sample,
+	sample_msg_iter_finalize);
+
+/* sink.utils.aggregate */
+BT_PLUGIN_SINK_COMPONENT_CLASS(aggregate, aggregate_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_INITIALIZE_METHOD(aggregate, aggregate_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(aggregate, aggregate_finalize);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(aggregate,
+	aggregate_graph_is_configured);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(aggregate,
+	"Compute and print event counts and value and latency histograms.");
+BT_PLUGIN_SINK_COMPONENT_CLASS_HELP(aggregate,
+	"See the babeltrace2-sink.utils.aggregate(7) manual page.");
+
+/* sink.utils.cache */
+BT_PLUGIN_SINK_COMPONENT_CLASS(cache, cache_sink_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_INITIALIZE_METHOD(cache, cache_sink_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(cache, cache_sink_finalize);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(cache,
+	cache_sink_graph_is_configured);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(cache,
+	"Write messages to a message cache file.");
+BT_PLUGIN_SINK_COMPONENT_CLASS_HELP(cache,
+	"See the babeltrace2-sink.utils.cache(7) manual page.");
+
+/* src.utils.cache */
+BT_PLUGIN_SOURCE_COMPONENT_CLASS(cache, cache_src_msg_iter_next);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_DESCRIPTION(cache,
+	"Replay the messages of a message cache file.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_HELP(cache,
+	"See the babeltrace2-source.utils.cache(7) manual page.");
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_INITIALIZE_METHOD(cache, cache_src_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_FINALIZE_METHOD(cache, cache_src_finalize);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD(cache,
+	cache_src_msg_iter_init);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(cache,
+	cache_src_msg_iter_finalize);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHODS(cache,
+	cache_src_msg_iter_seek_beginning, NULL);
+
 /* flt.utils.muxer */
 BT_PLUGIN_FILTER_COMPONENT_CLASS(muxer, muxer_msg_iter_next);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(muxer,
@@ -70,3 +158,5 @@ BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(muxer,
 	muxer_msg_iter_finalize);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHODS(muxer,
 	muxer_msg_iter_seek_beginning, muxer_msg_iter_can_seek_beginning);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHODS(muxer,
+	muxer_msg_iter_seek_ns_from_origin, muxer_msg_iter_can_seek_ns_from_origin);
@@ -0,0 +1,610 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright 2019 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (sample_comp->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (sample_comp->log_level)
+#define BT_LOG_TAG "PLUGIN/FLT.UTILS.SAMPLE"
+#include "logging/comp-logging.h"
+
+#include <babeltrace2/babeltrace.h>
+#include "common/common.h"
+#include "common/assert.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <glib.h>
+#include "plugins/common/param-validation/param-validation.h"
+
+#include "sample.h"
+
+static const char * const in_port_name = "in";
+
+struct sample_comp {
+	/* Keep one event out of `every` events of each stream */
+	uint64_t every;
+
+	/* Fraction of the streams of which to keep the events */
+	double stream_fraction;
+
+	/* Probability to keep each event */
+	double fraction;
+
+	/* Initial state of the pseudorandom number generator */
+	uint64_t seed;
+
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+	bt_self_component_filter *self_comp_filter;
+};
+
+struct sample_stream_state {
+	/* True if the events of this stream can be kept at all */
+	bool is_selected;
+
+	/* Number of events of this stream so far */
+	uint64_t event_count;
+
+	/*
+	 * Number of events dropped since the last kept event and times
+	 * (raw clock values) of the first and last of them.
+	 */
+	uint64_t dropped_count;
+	uint64_t first_dropped_raw_value;
+	uint64_t last_dropped_raw_value;
+};
+
+struct sample_iterator {
+	/* Weak */
+	struct sample_comp *sample_comp;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	/* Owned by this */
+	bt_message_iterator *upstream_iter;
+
+	/* Messages to send downstream (owned) */
+	GQueue *output_msgs;
+
+	/* `const bt_stream *` (weak) -> `struct sample_stream_state *` */
+	GHashTable *stream_states;
+
+	/* State of the pseudorandom number generator (xorshift64*) */
+	uint64_t rand_state;
+};
+
+static
+enum bt_param_validation_status validate_fraction(
+		const bt_value *value,
+		struct bt_param_validation_context *context)
+{
+	enum bt_param_validation_status status = BT_PARAM_VALIDATION_STATUS_OK;
+	double fraction;
+
+	if (!bt_value_is_real(value)) {
+		status = bt_param_validation_error(context,
+			"unexpected type: expected-type=%s, actual-type=%s",
+			bt_common_value_type_string(BT_VALUE_TYPE_REAL),
+			bt_common_value_type_string(bt_value_get_type(value)));
+		goto end;
+	}
+
+	fraction = bt_value_real_get(value);
+	if (!(fraction >= 0 && fraction <= 1)) {
+		status = bt_param_validation_error(context,
+			"fraction is not between 0 and 1: fraction=%f",
+			fraction);
+	}
+
+end:
+	return status;
+}
+
+static
+struct bt_param_validation_map_value_entry_descr sample_params[] = {
+	{ "every", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "stream-fraction", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .validation_func = validate_fraction } },
+	{ "fraction", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .validation_func = validate_fraction } },
+	{ "seed", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
+};
+
+static
+bt_component_class_initialize_method_status init_sample_comp_from_params(
+		struct sample_comp *sample_comp, const bt_value *params)
+{
+	const bt_value *value;
+	bt_component_class_initialize_method_status status;
+	enum bt_param_validation_status validation_status;
+	gchar *validate_error = NULL;
+
+	validation_status = bt_param_validation_validate(params,
+		sample_params, &validate_error);
+	if (validation_status == BT_PARAM_VALIDATION_STATUS_MEMORY_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	} else if (validation_status == BT_PARAM_VALIDATION_STATUS_VALIDATION_ERROR) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		BT_COMP_LOGE_APPEND_CAUSE(sample_comp->self_comp, "%s",
+			validate_error);
+		goto end;
+	}
+
+	sample_comp->every = 1;
+	value = bt_value_map_borrow_entry_value_const(params, "every");
+	if (value) {
+		sample_comp->every = bt_value_integer_unsigned_get(value);
+
+		if (sample_comp->every == 0) {
+			BT_COMP_LOGE_APPEND_CAUSE(sample_comp->self_comp,
+				"Invalid `every` parameter: must be greater than 0.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	sample_comp->stream_fraction = 1.;
+	value = bt_value_map_borrow_entry_value_const(params,
+		"stream-fraction");
+	if (value) {
+		sample_comp->stream_fraction = bt_value_real_get(value);
+	}
+
+	sample_comp->fraction = 1.;
+	value = bt_value_map_borrow_entry_value_const(params, "fraction");
+	if (value) {
+		sample_comp->fraction = bt_value_real_get(value);
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params, "seed");
+	if (value) {
+		sample_comp->seed = bt_value_integer_unsigned_get(value);
+	}
+
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+
+end:
+	g_free(validate_error);
+	return status;
+}
+
+BT_HIDDEN
+bt_component_class_initialize_method_status sample_init(
+		bt_self_component_filter *self_comp_flt,
+		bt_self_component_filter_configuration *config,
+		const bt_value *params, void *init_data)
+{
+	bt_component_class_initialize_method_status status;
+	bt_self_component_add_port_status add_port_status;
+	struct sample_comp *sample_comp = g_new0(struct sample_comp, 1);
+	bt_self_component *self_comp =
+		bt_self_component_filter_as_self_component(self_comp_flt);
+
+	if (!sample_comp) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	sample_comp->log_level = bt_component_get_logging_level(
+		bt_self_component_as_component(self_comp));
+	sample_comp->self_comp = self_comp;
+	sample_comp->self_comp_filter = self_comp_flt;
+	status = init_sample_comp_from_params(sample_comp, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		goto error;
+	}
+
+	add_port_status = bt_self_component_filter_add_input_port(
+		self_comp_flt, in_port_name, NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	add_port_status = bt_self_component_filter_add_output_port(
+		self_comp_flt, "out", NULL, NULL);
+	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+		status = (int) add_port_status;
+		goto error;
+	}
+
+	bt_self_component_set_data(self_comp, sample_comp);
+	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	g_free(sample_comp);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void sample_finalize(bt_self_component_filter *self_comp)
+{
+	g_free(bt_self_component_get_data(
+		bt_self_component_filter_as_self_component(self_comp)));
+}
+
+static
+void destroy_sample_iterator(struct sample_iterator *sample_it)
+{
+	if (!sample_it) {
+		goto end;
+	}
+
+	bt_message_iterator_put_ref(sample_it->upstream_iter);
+
+	if (sample_it->output_msgs) {
+		bt_message *msg;
+
+		while ((msg = g_queue_pop_head(sample_it->output_msgs))) {
+			bt_message_put_ref(msg);
+		}
+
+		g_queue_free(sample_it->output_msgs);
+	}
+
+	if (sample_it->stream_states) {
+		g_hash_table_destroy(sample_it->stream_states);
+	}
+
+	g_free(sample_it);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_initialize_method_status sample_msg_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	bt_message_iterator_class_initialize_method_status status;
+	bt_message_iterator_create_from_message_iterator_status
+		msg_iter_status;
+	struct sample_iterator *sample_it;
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+
+	sample_it = g_new0(struct sample_iterator, 1);
+	if (!sample_it) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	sample_it->sample_comp = bt_self_component_get_data(self_comp);
+	BT_ASSERT(sample_it->sample_comp);
+	msg_iter_status = bt_message_iterator_create_from_message_iterator(
+		self_msg_iter,
+		bt_self_component_filter_borrow_input_port_by_name(
+			sample_it->sample_comp->self_comp_filter, in_port_name),
+		&sample_it->upstream_iter);
+	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_MESSAGE_ITERATOR_STATUS_OK) {
+		status = (int) msg_iter_status;
+		goto error;
+	}
+
+	sample_it->output_msgs = g_queue_new();
+	if (!sample_it->output_msgs) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	sample_it->stream_states = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, g_free);
+	if (!sample_it->stream_states) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	/* xorshift64* requires a non-zero state */
+	sample_it->rand_state = sample_it->sample_comp->seed ^
+		UINT64_C(0x9e3779b97f4a7c15);
+	if (sample_it->rand_state == 0) {
+		sample_it->rand_state = 1;
+	}
+
+	sample_it->self_msg_iter = self_msg_iter;
+	bt_self_message_iterator_set_data(self_msg_iter, sample_it);
+	status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	goto end;
+
+error:
+	destroy_sample_iterator(sample_it);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void sample_msg_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	destroy_sample_iterator(bt_self_message_iterator_get_data(
+		self_msg_iter));
+}
+
+/* Returns a pseudorandom number within [0, 1). */
+static inline
+double next_rand(struct sample_iterator *sample_it)
+{
+	uint64_t x = sample_it->rand_state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	sample_it->rand_state = x;
+	return (double) ((x * UINT64_C(0x2545f4914f6cdd1d)) >> 11) /
+		(double) (UINT64_C(1) << 53);
+}
+
+/*
+ * Returns whether or not the events of `stream` can be kept, from a
+ * hash of its class's and its own IDs, so that the selected streams
+ * are the same from one run to the other.
+ */
+static
+bool stream_is_selected(struct sample_comp *sample_comp,
+		const bt_stream *stream)
+{
+	uint64_t hash;
+
+	if (sample_comp->stream_fraction >= 1) {
+		return true;
+	}
+
+	/* splitmix64 finalizer */
+	hash = bt_stream_class_get_id(bt_stream_borrow_class_const(stream)) *
+		UINT64_C(0x9e3779b97f4a7c15) + bt_stream_get_id(stream);
+	hash = (hash ^ (hash >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	hash = (hash ^ (hash >> 27)) * UINT64_C(0x94d049bb133111eb);
+	hash ^= hash >> 31;
+	return (double) (hash >> 11) / (double) (UINT64_C(1) << 53) <
+		sample_comp->stream_fraction;
+}
+
+static inline
+bool keep_event(struct sample_iterator *sample_it,
+		struct sample_stream_state *stream_state)
+{
+	struct sample_comp *sample_comp = sample_it->sample_comp;
+	uint64_t index = stream_state->event_count;
+
+	stream_state->event_count++;
+
+	if (!stream_state->is_selected) {
+		return false;
+	}
+
+	if (index % sample_comp->every != 0) {
+		return false;
+	}
+
+	if (sample_comp->fraction < 1 &&
+			next_rand(sample_it) >= sample_comp->fraction) {
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Appends a discarded events message for the events of `stream` which
+ * this iterator dropped since the last kept one, if its class supports
+ * discarded events.
+ */
+static
+int flush_dropped_events(struct sample_iterator *sample_it,
+		const bt_stream *stream,
+		struct sample_stream_state *stream_state)
+{
+	struct sample_comp *sample_comp = sample_it->sample_comp;
+	const bt_stream_class *sc = bt_stream_borrow_class_const(stream);
+	bt_message *msg;
+	int ret = 0;
+
+	if (stream_state->dropped_count == 0) {
+		goto end;
+	}
+
+	if (!bt_stream_class_supports_discarded_events(sc)) {
+		goto reset;
+	}
+
+	if (bt_stream_class_discarded_events_have_default_clock_snapshots(sc)) {
+		msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+			sample_it->self_msg_iter, stream,
+			stream_state->first_dropped_raw_value,
+			stream_state->last_dropped_raw_value);
+	} else {
+		msg = bt_message_discarded_events_create(
+			sample_it->self_msg_iter, stream);
+	}
+
+	if (!msg) {
+		BT_COMP_LOGE_APPEND_CAUSE(sample_comp->self_comp,
+			"Cannot create discarded events message.");
+		ret = -1;
+		goto end;
+	}
+
+	bt_message_discarded_events_set_count(msg,
+		stream_state->dropped_count);
+	g_queue_push_tail(sample_it->output_msgs, msg);
+
+reset:
+	stream_state->dropped_count = 0;
+
+end:
+	return ret;
+}
+
+static
+struct sample_stream_state *borrow_stream_state(
+		struct sample_iterator *sample_it, const bt_stream *stream)
+{
+	struct sample_stream_state *stream_state =
+		g_hash_table_lookup(sample_it->stream_states, stream);
+
+	BT_ASSERT_DBG(stream_state);
+	return stream_state;
+}
+
+/*
+ * Handles the upstream message `msg` (reference moved), appending
+ * zero, one, or two messages to the output queue.
+ */
+static
+int handle_msg(struct sample_iterator *sample_it, const bt_message *msg)
+{
+	struct sample_comp *sample_comp = sample_it->sample_comp;
+	struct sample_stream_state *stream_state;
+	const bt_stream *stream;
+	int ret = 0;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		stream = bt_event_borrow_stream_const(
+			bt_message_event_borrow_event_const(msg));
+		stream_state = borrow_stream_state(sample_it, stream);
+
+		if (!keep_event(sample_it, stream_state)) {
+			/* Never look at the payload of a dropped event */
+			if (bt_message_event_borrow_stream_class_default_clock_class_const(
+					msg)) {
+				uint64_t raw_value = bt_clock_snapshot_get_value(
+					bt_message_event_borrow_default_clock_snapshot_const(
+						msg));
+
+				if (stream_state->dropped_count == 0) {
+					stream_state->first_dropped_raw_value =
+						raw_value;
+				}
+
+				stream_state->last_dropped_raw_value = raw_value;
+			}
+
+			stream_state->dropped_count++;
+			bt_message_put_ref(msg);
+			goto end;
+		}
+
+		ret = flush_dropped_events(sample_it, stream, stream_state);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		stream = bt_message_stream_beginning_borrow_stream_const(msg);
+		stream_state = g_new0(struct sample_stream_state, 1);
+		if (!stream_state) {
+			BT_COMP_LOGE_APPEND_CAUSE(sample_comp->self_comp,
+				"Failed to allocate one stream state.");
+			ret = -1;
+			break;
+		}
+
+		stream_state->is_selected = stream_is_selected(sample_comp,
+			stream);
+		g_hash_table_insert(sample_it->stream_states, (gpointer) stream,
+			stream_state);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		stream = bt_message_stream_end_borrow_stream_const(msg);
+		ret = flush_dropped_events(sample_it, stream,
+			borrow_stream_state(sample_it, stream));
+		g_hash_table_remove(sample_it->stream_states, stream);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		stream = bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg));
+		ret = flush_dropped_events(sample_it, stream,
+			borrow_stream_state(sample_it, stream));
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		stream = bt_message_discarded_events_borrow_stream_const(msg);
+		ret = flush_dropped_events(sample_it, stream,
+			borrow_stream_state(sample_it, stream));
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		stream = bt_message_discarded_packets_borrow_stream_const(msg);
+		ret = flush_dropped_events(sample_it, stream,
+			borrow_stream_state(sample_it, stream));
+		break;
+	default:
+		break;
+	}
+
+	if (ret) {
+		bt_message_put_ref(msg);
+		goto end;
+	}
+
+	g_queue_push_tail(sample_it->output_msgs, (gpointer) msg);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_next_method_status sample_msg_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct sample_iterator *sample_it =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct sample_comp *sample_comp = sample_it->sample_comp;
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	uint64_t i = 0;
+
+	/*
+	 * Most upstream batches can be entirely dropped: keep consuming
+	 * until there's at least one message to send downstream.
+	 */
+	while (g_queue_is_empty(sample_it->output_msgs)) {
+		bt_message_iterator_next_status upstream_status;
+		bt_message_array_const upstream_msgs;
+		uint64_t upstream_count;
+		uint64_t j;
+
+		upstream_status = bt_message_iterator_next(
+			sample_it->upstream_iter, &upstream_msgs,
+			&upstream_count);
+		if (upstream_status != BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
+			if (upstream_status < 0) {
+				BT_COMP_LOGE_APPEND_CAUSE(sample_comp->self_comp,
+					"Upstream iterator's next method returned an error: "
+					"status=%s",
+					bt_common_func_status_string(upstream_status));
+			}
+
+			status = (int) upstream_status;
+			goto end;
+		}
+
+		for (j = 0; j < upstream_count; j++) {
+			if (handle_msg(sample_it, upstream_msgs[j])) {
+				/* handle_msg() put this message */
+				for (j++; j < upstream_count; j++) {
+					bt_message_put_ref(upstream_msgs[j]);
+				}
+
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+				goto end;
+			}
+		}
+	}
+
+	while (i < capacity && !g_queue_is_empty(sample_it->output_msgs)) {
+		msgs[i] = g_queue_pop_head(sample_it->output_msgs);
+		i++;
+	}
+
+	*count = i;
+
+end:
+	return status;
+}
@@ -55,9 +55,29 @@ struct trimmer_bound {
 	struct trimmer_time time;
 };
 
-struct trimmer_comp {
+struct trimmer_range {
 	struct trimmer_bound begin, end;
+};
+
+struct trimmer_comp {
+	/*
+	 * Array of `struct trimmer_range`, sorted and disjoint, with at
+	 * least one range.
+	 *
+	 * Only the beginning of the first range and the end of the last
+	 * range can be infinite.
+	 */
+	GArray *ranges;
+
 	bool is_gmt;
+
+	/*
+	 * Number of input/output port pairs: each output port's message
+	 * iterator trims the messages of the input port having the same
+	 * index.
+	 */
+	uint64_t port_count;
+
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
 	bt_self_component_filter *self_comp_filter;
@@ -78,6 +98,10 @@ enum trimmer_iterator_state {
 	/*
 	 * Fill the output message queue for as long as received input
 	 * messages are within the trimming time range.
+	 *
+	 * When an input message is after the end of a trimming time
+	 * range which isn't the last one, end the current packets and
+	 * seek the beginning of the next range.
 	 */
 	TRIMMER_ITERATOR_STATE_TRIM,
 
@@ -99,6 +123,18 @@ struct trimmer_iterator {
 
 	/* Owned by this */
 	bt_message_iterator *upstream_iter;
+
+	/*
+	 * Array of `struct trimmer_range` (copy of the component's
+	 * ranges, of which this message iterator sets the bounds having
+	 * no date).
+	 */
+	GArray *ranges;
+
+	/* Index of the current range within `ranges` */
+	guint cur_range;
+
+	/* Bounds of the current range */
 	struct trimmer_bound begin, end;
 
 	/*
@@ -114,6 +150,44 @@ struct trimmer_iterator {
 	 * `struct trimmer_iterator_stream_state *` (owned by the HT).
 	 */
 	GHashTable *stream_states;
+
+	/*
+	 * Number of stream states of `stream_states` of which
+	 * `seen_clock_snapshot` is false.
+	 */
+	uint64_t unseen_clock_snapshot_stream_count;
+
+	/*
+	 * Hash table of `const bt_clock_class *` (owned by the HT) to
+	 * `struct trimmer_iterator_raw_end_bound *` (owned by the HT).
+	 */
+	GHashTable *raw_end_bounds;
+
+	/*
+	 * Last clock class (weak) which borrow_raw_end_bound() looked up
+	 * and its raw end bound (weak, owned by `raw_end_bounds`).
+	 */
+	const bt_clock_class *last_raw_end_bound_clock_class;
+	struct trimmer_iterator_raw_end_bound *last_raw_end_bound;
+};
+
+/*
+ * End bound of a trimmer message iterator as a raw value of a given
+ * clock class, so that checking whether or not a clock snapshot is
+ * after the end bound doesn't need any conversion.
+ */
+struct trimmer_iterator_raw_end_bound {
+	/*
+	 * False if we couldn't express the end bound as a raw value of
+	 * this clock class: compare nanoseconds from origin instead.
+	 */
+	bool is_set;
+
+	/*
+	 * Greatest raw value of this clock class of which the time is
+	 * not after the end bound.
+	 */
+	uint64_t raw_value;
 };
 
 struct trimmer_iterator_stream_state {
@@ -131,6 +205,11 @@ static
 void destroy_trimmer_comp(struct trimmer_comp *trimmer_comp)
 {
 	BT_ASSERT(trimmer_comp);
+
+	if (trimmer_comp->ranges) {
+		g_array_free(trimmer_comp->ranges, TRUE);
+	}
+
 	g_free(trimmer_comp);
 }
 
@@ -495,6 +574,117 @@ end:
 	return ret;
 }
 
+static inline
+bool trimmer_ranges_are_set(const GArray *ranges)
+{
+	bool are_set = true;
+	guint i;
+
+	for (i = 0; i < ranges->len; i++) {
+		const struct trimmer_range *range =
+			&g_array_index(ranges, struct trimmer_range, i);
+
+		if (!range->begin.is_set || !range->end.is_set) {
+			are_set = false;
+			break;
+		}
+	}
+
+	return are_set;
+}
+
+/*
+ * Validates the bounds of each range of `ranges` (all set), and that
+ * those ranges are sorted and disjoint.
+ *
+ * Returns a negative value if anything goes wrong.
+ */
+static
+int validate_trimmer_ranges(struct trimmer_comp *trimmer_comp,
+		GArray *ranges)
+{
+	int ret = 0;
+	guint i;
+
+	for (i = 0; i < ranges->len; i++) {
+		struct trimmer_range *range =
+			&g_array_index(ranges, struct trimmer_range, i);
+		const struct trimmer_range *prev_range;
+
+		ret = validate_trimmer_bounds(trimmer_comp, &range->begin,
+			&range->end);
+		if (ret) {
+			goto end;
+		}
+
+		if (i == 0) {
+			continue;
+		}
+
+		prev_range = &g_array_index(ranges, struct trimmer_range, i - 1);
+		BT_ASSERT(!prev_range->end.is_infinite);
+		BT_ASSERT(!range->begin.is_infinite);
+
+		if (range->begin.ns_from_origin <=
+				prev_range->end.ns_from_origin) {
+			BT_COMP_LOGE_APPEND_CAUSE(trimmer_comp->self_comp,
+				"Trimming time range's beginning time is not greater than the previous range's end time: "
+				"range-index=%u, "
+				"begin-ns-from-origin=%" PRId64 ", "
+				"prev-end-ns-from-origin=%" PRId64,
+				i, range->begin.ns_from_origin,
+				prev_range->end.ns_from_origin);
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Appends the trimming time ranges of the `ranges` parameter to the
+ * ranges of `trimmer_comp`.
+ *
+ * Returns a negative value if anything goes wrong.
+ */
+static
+int set_ranges_from_param(struct trimmer_comp *trimmer_comp,
+		const bt_value *param)
+{
+	int ret = 0;
+	uint64_t i;
+
+	for (i = 0; i < bt_value_array_get_length(param); i++) {
+		const bt_value *range_param =
+			bt_value_array_borrow_element_by_index_const(param, i);
+		struct trimmer_range range = { 0 };
+
+		/* set_bound_from_param() logs errors */
+		ret = set_bound_from_param(trimmer_comp, "ranges",
+			bt_value_array_borrow_element_by_index_const(
+				range_param, 0),
+			&range.begin, trimmer_comp->is_gmt);
+		if (ret) {
+			goto end;
+		}
+
+		ret = set_bound_from_param(trimmer_comp, "ranges",
+			bt_value_array_borrow_element_by_index_const(
+				range_param, 1),
+			&range.end, trimmer_comp->is_gmt);
+		if (ret) {
+			goto end;
+		}
+
+		g_array_append_val(trimmer_comp->ranges, range);
+	}
+
+end:
+	return ret;
+}
+
 static
 enum bt_param_validation_status validate_bound_type(
 		const bt_value *value,
@@ -514,11 +704,32 @@ enum bt_param_validation_status validate_bound_type(
 	return status;
 }
 
+static
+struct bt_param_validation_value_descr range_bound_descr = {
+	.validation_func = validate_bound_type,
+};
+
+static
+struct bt_param_validation_value_descr range_descr = {
+	.type = BT_VALUE_TYPE_ARRAY,
+	.array = {
+		.min_length = 2,
+		.max_length = 2,
+		.element_type = &range_bound_descr,
+	},
+};
+
 static
 struct bt_param_validation_map_value_entry_descr trimmer_params[] = {
 	{ "gmt", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "begin", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .validation_func = validate_bound_type } },
 	{ "end", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .validation_func = validate_bound_type } },
+	{ "ranges", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 1,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &range_descr,
+	} } },
+	{ "port-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -544,42 +755,82 @@ bt_component_class_initialize_method_status init_trimmer_comp_from_params(
 		goto end;
 	}
 
+	trimmer_comp->ranges = g_array_new(FALSE, TRUE,
+		sizeof(struct trimmer_range));
+	if (!trimmer_comp->ranges) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
 	BT_ASSERT(params);
         value = bt_value_map_borrow_entry_value_const(params, "gmt");
 	if (value) {
 		trimmer_comp->is_gmt = (bool) bt_value_bool_get(value);
 	}
 
-        value = bt_value_map_borrow_entry_value_const(params, "begin");
+	value = bt_value_map_borrow_entry_value_const(params, "ranges");
 	if (value) {
-		if (set_bound_from_param(trimmer_comp, "begin", value,
-				&trimmer_comp->begin, trimmer_comp->is_gmt)) {
-			/* set_bound_from_param() logs errors */
+		if (bt_value_map_has_entry(params, "begin") ||
+				bt_value_map_has_entry(params, "end")) {
+			BT_COMP_LOGE_APPEND_CAUSE(trimmer_comp->self_comp,
+				"The `ranges` parameter is mutually exclusive with the `begin` and `end` parameters.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (set_ranges_from_param(trimmer_comp, value)) {
+			/* set_ranges_from_param() logs errors */
 			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
 			goto end;
 		}
 	} else {
-		trimmer_comp->begin.is_infinite = true;
-		trimmer_comp->begin.is_set = true;
+		struct trimmer_range range = { 0 };
+
+		value = bt_value_map_borrow_entry_value_const(params, "begin");
+		if (value) {
+			if (set_bound_from_param(trimmer_comp, "begin", value,
+					&range.begin, trimmer_comp->is_gmt)) {
+				/* set_bound_from_param() logs errors */
+				status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+				goto end;
+			}
+		} else {
+			range.begin.is_infinite = true;
+			range.begin.is_set = true;
+		}
+
+		value = bt_value_map_borrow_entry_value_const(params, "end");
+		if (value) {
+			if (set_bound_from_param(trimmer_comp, "end", value,
+					&range.end, trimmer_comp->is_gmt)) {
+				/* set_bound_from_param() logs errors */
+				status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+				goto end;
+			}
+		} else {
+			range.end.is_infinite = true;
+			range.end.is_set = true;
+		}
+
+		g_array_append_val(trimmer_comp->ranges, range);
 	}
 
-        value = bt_value_map_borrow_entry_value_const(params, "end");
+	trimmer_comp->port_count = 1;
+	value = bt_value_map_borrow_entry_value_const(params, "port-count");
 	if (value) {
-		if (set_bound_from_param(trimmer_comp, "end", value,
-				&trimmer_comp->end, trimmer_comp->is_gmt)) {
-			/* set_bound_from_param() logs errors */
+		trimmer_comp->port_count = bt_value_integer_unsigned_get(value);
+		if (trimmer_comp->port_count == 0) {
+			BT_COMP_LOGE_APPEND_CAUSE(trimmer_comp->self_comp,
+				"Invalid `port-count` parameter: expecting at least one port.");
 			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
 			goto end;
 		}
-	} else {
-		trimmer_comp->end.is_infinite = true;
-		trimmer_comp->end.is_set = true;
 	}
 
-	if (trimmer_comp->begin.is_set && trimmer_comp->end.is_set) {
-		/* validate_trimmer_bounds() logs errors */
-		if (validate_trimmer_bounds(trimmer_comp,
-			&trimmer_comp->begin, &trimmer_comp->end)) {
+	if (trimmer_ranges_are_set(trimmer_comp->ranges)) {
+		/* validate_trimmer_ranges() logs errors */
+		if (validate_trimmer_ranges(trimmer_comp,
+				trimmer_comp->ranges)) {
 			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
 			goto end;
 		}
@@ -593,13 +844,72 @@ end:
 	return status;
 }
 
+/*
+ * Adds the `in` and `out` ports, or the `inN` and `outN` ports (N being
+ * the port pair index) if there's more than one port pair.
+ *
+ * The user data of an output port is the index of its port pair.
+ */
+static
+bt_component_class_initialize_method_status add_trimmer_ports(
+		struct trimmer_comp *trimmer_comp)
+{
+	bt_component_class_initialize_method_status status =
+		BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	bt_self_component_add_port_status add_port_status;
+	GString *port_name = g_string_new(NULL);
+	uint64_t i;
+
+	if (!port_name) {
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < trimmer_comp->port_count; i++) {
+		if (trimmer_comp->port_count == 1) {
+			g_string_assign(port_name, in_port_name);
+		} else {
+			g_string_printf(port_name, "%s%" PRIu64, in_port_name,
+				i);
+		}
+
+		add_port_status = bt_self_component_filter_add_input_port(
+			trimmer_comp->self_comp_filter, port_name->str, NULL,
+			NULL);
+		if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+			status = (int) add_port_status;
+			goto end;
+		}
+
+		if (trimmer_comp->port_count == 1) {
+			g_string_assign(port_name, "out");
+		} else {
+			g_string_printf(port_name, "out%" PRIu64, i);
+		}
+
+		add_port_status = bt_self_component_filter_add_output_port(
+			trimmer_comp->self_comp_filter, port_name->str,
+			(void *) (uintptr_t) i, NULL);
+		if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
+			status = (int) add_port_status;
+			goto end;
+		}
+	}
+
+end:
+	if (port_name) {
+		g_string_free(port_name, TRUE);
+	}
+
+	return status;
+}
+
 bt_component_class_initialize_method_status trimmer_init(
 		bt_self_component_filter *self_comp_flt,
 		bt_self_component_filter_configuration *config,
 		const bt_value *params, void *init_data)
 {
 	bt_component_class_initialize_method_status status;
-	bt_self_component_add_port_status add_port_status;
 	struct trimmer_comp *trimmer_comp = create_trimmer_comp();
 	bt_self_component *self_comp =
 		bt_self_component_filter_as_self_component(self_comp_flt);
@@ -614,21 +924,12 @@ bt_component_class_initialize_method_status trimmer_init(
 	trimmer_comp->self_comp = self_comp;
 	trimmer_comp->self_comp_filter = self_comp_flt;
 
-	add_port_status = bt_self_component_filter_add_input_port(
-		self_comp_flt, in_port_name, NULL, NULL);
-	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
-		status = (int) add_port_status;
-		goto error;
-	}
-
-	add_port_status = bt_self_component_filter_add_output_port(
-		self_comp_flt, "out", NULL, NULL);
-	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
-		status = (int) add_port_status;
+	status = init_trimmer_comp_from_params(trimmer_comp, params);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
 		goto error;
 	}
 
-	status = init_trimmer_comp_from_params(trimmer_comp, params);
+	status = add_trimmer_ports(trimmer_comp);
 	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
 		goto error;
 	}
@@ -665,6 +966,14 @@ void destroy_trimmer_iterator(struct trimmer_iterator *trimmer_it)
 		g_hash_table_destroy(trimmer_it->stream_states);
 	}
 
+	if (trimmer_it->raw_end_bounds) {
+		g_hash_table_destroy(trimmer_it->raw_end_bounds);
+	}
+
+	if (trimmer_it->ranges) {
+		g_array_free(trimmer_it->ranges, TRUE);
+	}
+
 	g_free(trimmer_it);
 end:
 	return;
@@ -679,6 +988,12 @@ void destroy_trimmer_iterator_stream_state(
 	g_free(sstate);
 }
 
+static
+void put_raw_end_bound_clock_class(gpointer data)
+{
+	bt_clock_class_put_ref(data);
+}
+
 BT_HIDDEN
 bt_message_iterator_class_initialize_method_status trimmer_msg_iter_init(
 		bt_self_message_iterator *self_msg_iter,
@@ -689,6 +1004,7 @@ bt_message_iterator_class_initialize_method_status trimmer_msg_iter_init(
 	bt_message_iterator_create_from_message_iterator_status
 		msg_iter_status;
 	struct trimmer_iterator *trimmer_it;
+	struct trimmer_comp *trimmer_comp;
 	bt_self_component *self_comp =
 		bt_self_message_iterator_borrow_component(self_msg_iter);
 
@@ -698,27 +1014,41 @@ bt_message_iterator_class_initialize_method_status trimmer_msg_iter_init(
 		goto error;
 	}
 
-	trimmer_it->trimmer_comp = bt_self_component_get_data(self_comp);
-	BT_ASSERT(trimmer_it->trimmer_comp);
+	trimmer_comp = bt_self_component_get_data(self_comp);
+	BT_ASSERT(trimmer_comp);
+	trimmer_it->trimmer_comp = trimmer_comp;
 
-	if (trimmer_it->trimmer_comp->begin.is_set &&
-			trimmer_it->trimmer_comp->end.is_set) {
+	if (trimmer_ranges_are_set(trimmer_comp->ranges)) {
 		/*
-		 * Both trimming time range's bounds are set, so skip
-		 * the
+		 * All the trimming time ranges' bounds are set, so
+		 * skip the
 		 * `TRIMMER_ITERATOR_STATE_SET_BOUNDS_NS_FROM_ORIGIN`
 		 * phase.
 		 */
 		trimmer_it->state = TRIMMER_ITERATOR_STATE_SEEK_INITIALLY;
 	}
 
-	trimmer_it->begin = trimmer_it->trimmer_comp->begin;
-	trimmer_it->end = trimmer_it->trimmer_comp->end;
+	trimmer_it->ranges = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct trimmer_range), trimmer_comp->ranges->len);
+	if (!trimmer_it->ranges) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	g_array_append_vals(trimmer_it->ranges, trimmer_comp->ranges->data,
+		trimmer_comp->ranges->len);
+	trimmer_it->begin = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).begin;
+	trimmer_it->end = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).end;
 	msg_iter_status =
 		bt_message_iterator_create_from_message_iterator(
 			self_msg_iter,
-			bt_self_component_filter_borrow_input_port_by_name(
-				trimmer_it->trimmer_comp->self_comp_filter, in_port_name),
+			bt_self_component_filter_borrow_input_port_by_index(
+				trimmer_it->trimmer_comp->self_comp_filter,
+				(uint64_t) (uintptr_t) bt_self_component_port_get_data(
+					bt_self_component_port_output_as_self_component_port(
+						port))),
 			&trimmer_it->upstream_iter);
 	if (msg_iter_status != BT_MESSAGE_ITERATOR_CREATE_FROM_MESSAGE_ITERATOR_STATUS_OK) {
 		status = (int) msg_iter_status;
@@ -739,6 +1069,13 @@ bt_message_iterator_class_initialize_method_status trimmer_msg_iter_init(
 		goto error;
 	}
 
+	trimmer_it->raw_end_bounds = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, put_raw_end_bound_clock_class, g_free);
+	if (!trimmer_it->raw_end_bounds) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	/*
 	 * The trimmer requires upstream messages to have times, so it can
 	 * always seek forward.
@@ -759,17 +1096,23 @@ end:
 	return status;
 }
 
+/*
+ * Borrows the default clock snapshot of `msg`, setting
+ * `*clock_snapshot` to `NULL` if `msg` has no clock snapshot.
+ *
+ * Returns -1 if `msg` is associated to a stream class without a default
+ * clock class.
+ */
 static inline
-int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
-		bool *has_clock_snapshot)
+int borrow_msg_clock_snapshot(const bt_message *msg,
+		const bt_clock_snapshot **clock_snapshot)
 {
 	const bt_clock_class *clock_class = NULL;
-	const bt_clock_snapshot *clock_snapshot = NULL;
 	int ret = 0;
 
 	BT_ASSERT_DBG(msg);
-	BT_ASSERT_DBG(ns_from_origin);
-	BT_ASSERT_DBG(has_clock_snapshot);
+	BT_ASSERT_DBG(clock_snapshot);
+	*clock_snapshot = NULL;
 
 	switch (bt_message_get_type(msg)) {
 	case BT_MESSAGE_TYPE_EVENT:
@@ -780,7 +1123,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		clock_snapshot = bt_message_event_borrow_default_clock_snapshot_const(
+		*clock_snapshot = bt_message_event_borrow_default_clock_snapshot_const(
 			msg);
 		break;
 	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
@@ -791,7 +1134,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		clock_snapshot = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+		*clock_snapshot = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
 			msg);
 		break;
 	case BT_MESSAGE_TYPE_PACKET_END:
@@ -802,7 +1145,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		clock_snapshot = bt_message_packet_end_borrow_default_clock_snapshot_const(
+		*clock_snapshot = bt_message_packet_end_borrow_default_clock_snapshot_const(
 			msg);
 		break;
 	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
@@ -815,7 +1158,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		cs_state = bt_message_stream_beginning_borrow_default_clock_snapshot_const(msg, &clock_snapshot);
+		cs_state = bt_message_stream_beginning_borrow_default_clock_snapshot_const(msg, clock_snapshot);
 		if (cs_state != BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
 			goto no_clock_snapshot;
 		}
@@ -832,7 +1175,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		cs_state = bt_message_stream_end_borrow_default_clock_snapshot_const(msg, &clock_snapshot);
+		cs_state = bt_message_stream_end_borrow_default_clock_snapshot_const(msg, clock_snapshot);
 		if (cs_state != BT_MESSAGE_STREAM_CLOCK_SNAPSHOT_STATE_KNOWN) {
 			goto no_clock_snapshot;
 		}
@@ -847,7 +1190,7 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		clock_snapshot = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+		*clock_snapshot = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
 			msg);
 		break;
 	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
@@ -858,11 +1201,11 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 			goto error;
 		}
 
-		clock_snapshot = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+		*clock_snapshot = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
 			msg);
 		break;
 	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
-		clock_snapshot =
+		*clock_snapshot =
 			bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
 				msg);
 		break;
@@ -870,17 +1213,10 @@ int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
 		goto no_clock_snapshot;
 	}
 
-	ret = bt_clock_snapshot_get_ns_from_origin(clock_snapshot,
-		ns_from_origin);
-	if (G_UNLIKELY(ret)) {
-		goto error;
-	}
-
-	*has_clock_snapshot = true;
 	goto end;
 
 no_clock_snapshot:
-	*has_clock_snapshot = false;
+	*clock_snapshot = NULL;
 	goto end;
 
 error:
@@ -890,6 +1226,39 @@ end:
 	return ret;
 }
 
+static inline
+int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
+		bool *has_clock_snapshot)
+{
+	const bt_clock_snapshot *clock_snapshot;
+	int ret;
+
+	BT_ASSERT_DBG(ns_from_origin);
+	BT_ASSERT_DBG(has_clock_snapshot);
+
+	ret = borrow_msg_clock_snapshot(msg, &clock_snapshot);
+	if (G_UNLIKELY(ret)) {
+		goto end;
+	}
+
+	if (!clock_snapshot) {
+		*has_clock_snapshot = false;
+		goto end;
+	}
+
+	ret = bt_clock_snapshot_get_ns_from_origin(clock_snapshot,
+		ns_from_origin);
+	if (G_UNLIKELY(ret)) {
+		ret = -1;
+		goto end;
+	}
+
+	*has_clock_snapshot = true;
+
+end:
+	return ret;
+}
+
 static inline
 void put_messages(bt_message_array_const msgs, uint64_t count)
 {
@@ -948,11 +1317,11 @@ state_set_trimmer_iterator_bounds(
 	bt_message_array_const msgs;
 	uint64_t count = 0;
 	int64_t ns_from_origin = INT64_MIN;
+	struct trimmer_range *first_range;
 	uint64_t i;
 	int ret;
 
-	BT_ASSERT(!trimmer_it->begin.is_set ||
-		!trimmer_it->end.is_set);
+	BT_ASSERT(!trimmer_ranges_are_set(trimmer_it->ranges));
 
 	while (true) {
 		upstream_iter_status =
@@ -985,30 +1354,41 @@ state_set_trimmer_iterator_bounds(
 	}
 
 found:
-	if (!trimmer_it->begin.is_set) {
-		BT_ASSERT(!trimmer_it->begin.is_infinite);
-		ret = set_trimmer_iterator_bound(trimmer_it, &trimmer_it->begin,
-			ns_from_origin, trimmer_comp->is_gmt);
-		if (ret) {
-			goto error;
+	for (i = 0; i < trimmer_it->ranges->len; i++) {
+		struct trimmer_range *range = &g_array_index(
+			trimmer_it->ranges, struct trimmer_range, i);
+
+		if (!range->begin.is_set) {
+			BT_ASSERT(!range->begin.is_infinite);
+			ret = set_trimmer_iterator_bound(trimmer_it,
+				&range->begin, ns_from_origin,
+				trimmer_comp->is_gmt);
+			if (ret) {
+				goto error;
+			}
 		}
-	}
 
-	if (!trimmer_it->end.is_set) {
-		BT_ASSERT(!trimmer_it->end.is_infinite);
-		ret = set_trimmer_iterator_bound(trimmer_it, &trimmer_it->end,
-			ns_from_origin, trimmer_comp->is_gmt);
-		if (ret) {
-			goto error;
+		if (!range->end.is_set) {
+			BT_ASSERT(!range->end.is_infinite);
+			ret = set_trimmer_iterator_bound(trimmer_it,
+				&range->end, ns_from_origin,
+				trimmer_comp->is_gmt);
+			if (ret) {
+				goto error;
+			}
 		}
 	}
 
-	ret = validate_trimmer_bounds(trimmer_it->trimmer_comp,
-		&trimmer_it->begin, &trimmer_it->end);
+	ret = validate_trimmer_ranges(trimmer_it->trimmer_comp,
+		trimmer_it->ranges);
 	if (ret) {
 		goto error;
 	}
 
+	first_range = &g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0);
+	trimmer_it->begin = first_range->begin;
+	trimmer_it->end = first_range->end;
 	goto end;
 
 error:
@@ -1115,10 +1495,163 @@ int clock_raw_value_from_ns_from_origin(const bt_clock_class *clock_class,
 		cc_offset_cycles, cc_freq, ns_from_origin, raw_value);
 }
 
+/*
+ * Converts the end bound of `trimmer_it` to the greatest raw value of
+ * `clock_class` of which the time is not after it.
+ *
+ * Leaves `raw_end_bound->is_set` false if that's not possible.
+ */
+static
+void init_raw_end_bound(struct trimmer_iterator *trimmer_it,
+		const bt_clock_class *clock_class,
+		struct trimmer_iterator_raw_end_bound *raw_end_bound)
+{
+	const int64_t end_ns_from_origin = trimmer_it->end.ns_from_origin;
+	uint64_t raw_value;
+	uint64_t max_steps;
+	int64_t ns_from_origin;
+
+	if (trimmer_it->end.is_infinite) {
+		raw_end_bound->raw_value = UINT64_MAX;
+		raw_end_bound->is_set = true;
+		goto end;
+	}
+
+	if (clock_raw_value_from_ns_from_origin(clock_class,
+			end_ns_from_origin, &raw_value)) {
+		goto end;
+	}
+
+	if (bt_clock_class_cycles_to_ns_from_origin(clock_class, raw_value,
+			&ns_from_origin) !=
+			BT_CLOCK_CLASS_CYCLES_TO_NS_FROM_ORIGIN_STATUS_OK) {
+		bt_current_thread_clear_error();
+		goto end;
+	}
+
+	if (ns_from_origin > end_ns_from_origin) {
+		goto end;
+	}
+
+	/*
+	 * Both conversions round down: with a frequency greater than
+	 * 1 GHz, more than one raw value can map to the end bound's
+	 * nanosecond.
+	 */
+	max_steps = bt_clock_class_get_frequency(clock_class) / NS_PER_S + 1;
+
+	while (raw_value < UINT64_MAX) {
+		if (max_steps == 0) {
+			goto end;
+		}
+
+		if (bt_clock_class_cycles_to_ns_from_origin(clock_class,
+				raw_value + 1, &ns_from_origin) !=
+				BT_CLOCK_CLASS_CYCLES_TO_NS_FROM_ORIGIN_STATUS_OK) {
+			/* Next raw value is way after the end bound */
+			bt_current_thread_clear_error();
+			break;
+		}
+
+		if (ns_from_origin > end_ns_from_origin) {
+			break;
+		}
+
+		raw_value++;
+		max_steps--;
+	}
+
+	raw_end_bound->raw_value = raw_value;
+	raw_end_bound->is_set = true;
+
+end:
+	return;
+}
+
+static inline
+struct trimmer_iterator_raw_end_bound *borrow_raw_end_bound(
+		struct trimmer_iterator *trimmer_it,
+		const bt_clock_class *clock_class)
+{
+	struct trimmer_iterator_raw_end_bound *raw_end_bound;
+
+	if (G_LIKELY(clock_class ==
+			trimmer_it->last_raw_end_bound_clock_class)) {
+		raw_end_bound = trimmer_it->last_raw_end_bound;
+		goto end;
+	}
+
+	raw_end_bound = g_hash_table_lookup(trimmer_it->raw_end_bounds,
+		clock_class);
+	if (!raw_end_bound) {
+		raw_end_bound = g_new0(struct trimmer_iterator_raw_end_bound, 1);
+		if (!raw_end_bound) {
+			goto end;
+		}
+
+		init_raw_end_bound(trimmer_it, clock_class, raw_end_bound);
+		bt_clock_class_get_ref(clock_class);
+		g_hash_table_insert(trimmer_it->raw_end_bounds,
+			(gpointer) clock_class, raw_end_bound);
+	}
+
+	trimmer_it->last_raw_end_bound_clock_class = clock_class;
+	trimmer_it->last_raw_end_bound = raw_end_bound;
+
+end:
+	return raw_end_bound;
+}
+
+/*
+ * Sets `*is_after_end` to whether or not the time of `clock_snapshot`
+ * is after the end bound of `trimmer_it`.
+ */
+static inline
+bt_message_iterator_class_next_method_status clock_snapshot_is_after_end(
+		struct trimmer_iterator *trimmer_it,
+		const bt_clock_snapshot *clock_snapshot, bool *is_after_end)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	struct trimmer_iterator_raw_end_bound *raw_end_bound;
+	int64_t ns_from_origin;
+
+	raw_end_bound = borrow_raw_end_bound(trimmer_it,
+		bt_clock_snapshot_borrow_clock_class_const(clock_snapshot));
+	if (G_UNLIKELY(!raw_end_bound)) {
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	if (G_LIKELY(raw_end_bound->is_set)) {
+		*is_after_end = bt_clock_snapshot_get_value(clock_snapshot) >
+			raw_end_bound->raw_value;
+		goto end;
+	}
+
+	if (bt_clock_snapshot_get_ns_from_origin(clock_snapshot,
+			&ns_from_origin)) {
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	*is_after_end = ns_from_origin > trimmer_it->end.ns_from_origin;
+
+end:
+	return status;
+}
+
+/*
+ * Ends the current packet, if any, and then the stream of `sstate` at
+ * the end of the current trimming time range.
+ *
+ * If `keep_stream` is true, only ends the current packet: the stream
+ * continues within the next trimming time range.
+ */
 static inline
 bt_message_iterator_class_next_method_status
 end_stream(struct trimmer_iterator *trimmer_it,
-		struct trimmer_iterator_stream_state *sstate)
+		struct trimmer_iterator_stream_state *sstate, bool keep_stream)
 {
 	bt_message_iterator_class_next_method_status status =
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
@@ -1129,6 +1662,10 @@ end_stream(struct trimmer_iterator *trimmer_it,
 	BT_ASSERT(!trimmer_it->end.is_infinite);
 	BT_ASSERT(sstate->stream);
 
+	if (keep_stream && !sstate->cur_packet) {
+		goto end;
+	}
+
 	/*
 	 * If we haven't seen a message with a clock snapshot, we don't know if the trimmer's end bound is within
 	 * the clock's range, so it wouldn't be safe to try to convert ns_from_origin to a clock value.
@@ -1179,6 +1716,10 @@ end_stream(struct trimmer_iterator *trimmer_it,
 		BT_PACKET_PUT_REF_AND_RESET(sstate->cur_packet);
 	}
 
+	if (keep_stream) {
+		goto end;
+	}
+
 	/* Create and push a stream end message. */
 	msg = bt_message_stream_end_create(trimmer_it->self_msg_iter,
 		sstate->stream);
@@ -1230,14 +1771,66 @@ bt_message_iterator_class_next_method_status end_iterator_streams(
 	g_hash_table_iter_init(&iter, trimmer_it->stream_states);
 
 	while (g_hash_table_iter_next(&iter, &key, &sstate)) {
-		status = end_stream(trimmer_it, sstate);
+		status = end_stream(trimmer_it, sstate, false);
 		if (status) {
 			goto end;
 		}
 	}
 
 remove_all:
+	/*
+	 * The streams keep their (now dangling) data slots, but this
+	 * message iterator is ending: it won't get their data again.
+	 */
 	g_hash_table_remove_all(trimmer_it->stream_states);
+	trimmer_it->unseen_clock_snapshot_stream_count = 0;
+
+end:
+	return status;
+}
+
+/*
+ * Ends the current packet of each stream at the end of the current
+ * trimming time range, makes the next range the current one, and makes
+ * the upstream message iterator seek its beginning.
+ *
+ * The streams continue: when the upstream message iterator emits a
+ * stream beginning message for a known stream after seeking, the
+ * trimmer discards it. A known stream which doesn't exist anymore
+ * within the next range ends when this message iterator ends.
+ */
+static
+bt_message_iterator_class_next_method_status end_range(
+		struct trimmer_iterator *trimmer_it)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	const struct trimmer_range *next_range;
+	GHashTableIter iter;
+	gpointer key, sstate;
+
+	BT_ASSERT(trimmer_it->cur_range + 1 < trimmer_it->ranges->len);
+	g_hash_table_iter_init(&iter, trimmer_it->stream_states);
+
+	while (g_hash_table_iter_next(&iter, &key, &sstate)) {
+		status = end_stream(trimmer_it, sstate, true);
+		if (status) {
+			goto end;
+		}
+	}
+
+	trimmer_it->cur_range++;
+	next_range = &g_array_index(trimmer_it->ranges,
+		struct trimmer_range, trimmer_it->cur_range);
+	trimmer_it->begin = next_range->begin;
+	trimmer_it->end = next_range->end;
+
+	/* The raw end bounds are the ones of the previous range */
+	g_hash_table_remove_all(trimmer_it->raw_end_bounds);
+	trimmer_it->last_raw_end_bound_clock_class = NULL;
+	trimmer_it->last_raw_end_bound = NULL;
+
+	status = state_seek_initially(trimmer_it);
 
 end:
 	return status;
@@ -1352,6 +1945,9 @@ create_stream_state_entry(
 	sstate->stream = stream;
 
 	g_hash_table_insert(trimmer_it->stream_states, (void *) stream, sstate);
+	bt_self_message_iterator_set_stream_data(trimmer_it->self_msg_iter,
+		stream, sstate);
+	trimmer_it->unseen_clock_snapshot_stream_count++;
 
 	*stream_state = sstate;
 
@@ -1361,6 +1957,17 @@ end:
 	return status;
 }
 
+static inline
+void set_stream_state_seen_clock_snapshot(struct trimmer_iterator *trimmer_it,
+		struct trimmer_iterator_stream_state *sstate)
+{
+	if (G_UNLIKELY(!sstate->seen_clock_snapshot)) {
+		sstate->seen_clock_snapshot = true;
+		BT_ASSERT_DBG(trimmer_it->unseen_clock_snapshot_stream_count > 0);
+		trimmer_it->unseen_clock_snapshot_stream_count--;
+	}
+}
+
 static
 struct trimmer_iterator_stream_state *get_stream_state_entry(
 		struct trimmer_iterator *trimmer_it,
@@ -1369,8 +1976,11 @@ struct trimmer_iterator_stream_state *get_stream_state_entry(
 	struct trimmer_iterator_stream_state *sstate;
 
 	BT_ASSERT_DBG(stream);
-	sstate = g_hash_table_lookup(trimmer_it->stream_states, stream);
+	sstate = bt_self_message_iterator_get_stream_data(
+		trimmer_it->self_msg_iter, stream);
 	BT_ASSERT_DBG(sstate);
+	BT_ASSERT_DBG(sstate ==
+		g_hash_table_lookup(trimmer_it->stream_states, stream));
 
 	return sstate;
 }
@@ -1383,19 +1993,22 @@ struct trimmer_iterator_stream_state *get_stream_state_entry(
  *
  * This function consumes the `msg` reference, _whatever the outcome_.
  *
- * If non-NULL, `ns_from_origin` is the message's time, as given by
- * get_msg_ns_from_origin().  If NULL, the message doesn't have a time.
+ * If non-NULL, `clock_snapshot` is the message's clock snapshot, as
+ * given by borrow_msg_clock_snapshot(), and `is_after_end` indicates
+ * whether or not its time is after the trimming range's end. If NULL,
+ * the message doesn't have a time.
  *
- * This function sets `reached_end` if handling this message made the
- * iterator reach the end of the trimming range. Note that the output
- * message queue could contain messages even if this function sets
- * `reached_end`.
+ * This function sets `reached_end`, without consuming the message, if
+ * the message is after the end of the current trimming range: the
+ * caller then ends the range. Note that the output message queue could
+ * contain messages even if this function sets `reached_end`.
  */
 static
 bt_message_iterator_class_next_method_status
 handle_message_with_stream(
 		struct trimmer_iterator *trimmer_it, const bt_message *msg,
-		const struct bt_stream *stream, const int64_t *ns_from_origin,
+		const struct bt_stream *stream,
+		const bt_clock_snapshot *clock_snapshot, bool is_after_end,
 		bool *reached_end)
 {
 	bt_message_iterator_class_next_method_status status =
@@ -1419,16 +2032,14 @@ handle_message_with_stream(
 		 * class has a clock class. And we know it has, otherwise we
 		 * couldn't be using the trimmer component.
 		 */
-		BT_ASSERT_DBG(ns_from_origin);
+		BT_ASSERT_DBG(clock_snapshot);
 
-		if (G_UNLIKELY(!trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+		if (G_UNLIKELY(is_after_end)) {
 			*reached_end = true;
 			break;
 		}
 
-		sstate->seen_clock_snapshot = true;
+		set_stream_state_seen_clock_snapshot(trimmer_it, sstate);
 
 		push_message(trimmer_it, msg);
 		msg = NULL;
@@ -1440,12 +2051,10 @@ handle_message_with_stream(
 		 * stream_class->packets_have_beginning_default_clock_snapshot
 		 * is false.  But for now, assume they always do.
 		 */
-		BT_ASSERT(ns_from_origin);
+		BT_ASSERT(clock_snapshot);
 		BT_ASSERT(!sstate->cur_packet);
 
-		if (G_UNLIKELY(!trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+		if (G_UNLIKELY(is_after_end)) {
 			*reached_end = true;
 			break;
 		}
@@ -1454,7 +2063,7 @@ handle_message_with_stream(
 			bt_message_packet_beginning_borrow_packet_const(msg);
 		bt_packet_get_ref(sstate->cur_packet);
 
-		sstate->seen_clock_snapshot = true;
+		set_stream_state_seen_clock_snapshot(trimmer_it, sstate);
 
 		push_message(trimmer_it, msg);
 		msg = NULL;
@@ -1466,19 +2075,17 @@ handle_message_with_stream(
 		 * stream_class->packets_have_end_default_clock_snapshot
 		 * is false.  But for now, assume they always do.
 		 */
-		BT_ASSERT(ns_from_origin);
+		BT_ASSERT(clock_snapshot);
 		BT_ASSERT(sstate->cur_packet);
 
-		if (G_UNLIKELY(!trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+		if (G_UNLIKELY(is_after_end)) {
 			*reached_end = true;
 			break;
 		}
 
 		BT_PACKET_PUT_REF_AND_RESET(sstate->cur_packet);
 
-		sstate->seen_clock_snapshot = true;
+		set_stream_state_seen_clock_snapshot(trimmer_it, sstate);
 
 		push_message(trimmer_it, msg);
 		msg = NULL;
@@ -1488,15 +2095,15 @@ handle_message_with_stream(
 	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
 	{
 		/*
-		 * `ns_from_origin` is the message's time range's
-		 * beginning time here.
+		 * `clock_snapshot` is the message's time range's
+		 * beginning clock snapshot here.
 		 */
-		int64_t end_ns_from_origin;
+		bool end_is_after_end;
 		const bt_clock_snapshot *end_cs;
 
-		BT_ASSERT(ns_from_origin);
+		BT_ASSERT(clock_snapshot);
 
-		sstate->seen_clock_snapshot = true;
+		set_stream_state_seen_clock_snapshot(trimmer_it, sstate);
 
 		if (bt_message_get_type(msg) ==
 				BT_MESSAGE_TYPE_DISCARDED_EVENTS) {
@@ -1517,21 +2124,18 @@ handle_message_with_stream(
 				msg);
 		}
 
-		if (bt_clock_snapshot_get_ns_from_origin(end_cs,
-				&end_ns_from_origin)) {
-			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		status = clock_snapshot_is_after_end(trimmer_it, end_cs,
+			&end_is_after_end);
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
 			goto end;
 		}
 
-		if (!trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin) {
-			status = end_iterator_streams(trimmer_it);
+		if (is_after_end) {
 			*reached_end = true;
 			break;
 		}
 
-		if (!trimmer_it->end.is_infinite &&
-				end_ns_from_origin > trimmer_it->end.ns_from_origin) {
+		if (end_is_after_end) {
 			/*
 			 * This message's end time is outside the
 			 * trimming time range: replace it with a new
@@ -1590,21 +2194,31 @@ handle_message_with_stream(
 		 * If this message has a time and this time is greater than the
 		 * trimmer's end bound, it triggers the end of the trim window.
 		 */
-		if (G_UNLIKELY(ns_from_origin && !trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+		if (G_UNLIKELY(clock_snapshot && is_after_end)) {
 			*reached_end = true;
 			break;
 		}
 
+		/*
+		 * After seeking the beginning of a trimming time range
+		 * which isn't the first one, the upstream message
+		 * iterator begins the streams again: this message
+		 * iterator already began the known ones.
+		 */
+		if (G_UNLIKELY(trimmer_it->cur_range > 0 &&
+				bt_g_hash_table_contains(
+					trimmer_it->stream_states, stream))) {
+			break;
+		}
+
 		/* Learn about this stream. */
 		status = create_stream_state_entry(trimmer_it, stream, &sstate);
 		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
 			goto end;
 		}
 
-		if (ns_from_origin) {
-			sstate->seen_clock_snapshot = true;
+		if (clock_snapshot) {
+			set_stream_state_seen_clock_snapshot(trimmer_it, sstate);
 		}
 
 		push_message(trimmer_it,  msg);
@@ -1618,9 +2232,7 @@ handle_message_with_stream(
 		 * If this message has a time and this time is greater than the
 		 * trimmer's end bound, it triggers the end of the trim window.
 		 */
-		if (G_UNLIKELY(ns_from_origin && !trimmer_it->end.is_infinite &&
-				*ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+		if (G_UNLIKELY(clock_snapshot && is_after_end)) {
 			*reached_end = true;
 			break;
 		}
@@ -1634,6 +2246,13 @@ handle_message_with_stream(
 		msg = NULL;
 
 		/* Forget about this stream. */
+		if (!sstate->seen_clock_snapshot) {
+			BT_ASSERT_DBG(trimmer_it->unseen_clock_snapshot_stream_count > 0);
+			trimmer_it->unseen_clock_snapshot_stream_count--;
+		}
+
+		bt_self_message_iterator_set_stream_data(
+			trimmer_it->self_msg_iter, stream, NULL);
 		removed = g_hash_table_remove(trimmer_it->stream_states, sstate->stream);
 		BT_ASSERT(removed);
 		break;
@@ -1655,10 +2274,10 @@ end:
  *
  * This function consumes the `msg` reference, _whatever the outcome_.
  *
- * This function sets `reached_end` if handling this message made the
- * iterator reach the end of the trimming range. Note that the output
- * message queue could contain messages even if this function sets
- * `reached_end`.
+ * This function sets `reached_end`, without consuming the message, if
+ * the message is after the end of the current trimming range: the
+ * caller then ends the range. Note that the output message queue could
+ * contain messages even if this function sets `reached_end`.
  */
 static inline
 bt_message_iterator_class_next_method_status handle_message(
@@ -1667,8 +2286,8 @@ bt_message_iterator_class_next_method_status handle_message(
 {
 	bt_message_iterator_class_next_method_status status;
 	const bt_stream *stream = NULL;
-	int64_t ns_from_origin = INT64_MIN;
-	bool has_ns_from_origin = false;
+	const bt_clock_snapshot *clock_snapshot;
+	bool is_after_end = false;
 	int ret;
 
 	/* Find message's associated stream */
@@ -1702,16 +2321,25 @@ bt_message_iterator_class_next_method_status handle_message(
 	}
 
 	/* Retrieve the message's time */
-	ret = get_msg_ns_from_origin(msg, &ns_from_origin, &has_ns_from_origin);
+	ret = borrow_msg_clock_snapshot(msg, &clock_snapshot);
 	if (G_UNLIKELY(ret)) {
 		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
 		goto end;
 	}
 
+	if (G_LIKELY(clock_snapshot)) {
+		status = clock_snapshot_is_after_end(trimmer_it,
+			clock_snapshot, &is_after_end);
+		if (G_UNLIKELY(status !=
+				BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK)) {
+			goto end;
+		}
+	}
+
 	if (G_LIKELY(stream)) {
 		/* Message associated to a stream */
 		status = handle_message_with_stream(trimmer_it, msg,
-			stream, has_ns_from_origin ? &ns_from_origin : NULL, reached_end);
+			stream, clock_snapshot, is_after_end, reached_end);
 
 		/*
 		 * handle_message_with_stream_state() unconditionally
@@ -1723,9 +2351,9 @@ bt_message_iterator_class_next_method_status handle_message(
 		 * Message not associated to a stream (message iterator
 		 * inactivity).
 		 */
-		if (G_UNLIKELY(ns_from_origin > trimmer_it->end.ns_from_origin)) {
+		if (G_UNLIKELY(is_after_end)) {
 			BT_MESSAGE_PUT_REF_AND_RESET(msg);
-			status = end_iterator_streams(trimmer_it);
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 			*reached_end = true;
 		} else {
 			push_message(trimmer_it, msg);
@@ -1782,6 +2410,52 @@ end:
 	return status;
 }
 
+/*
+ * Sets `*can_forward` to whether or not state_trim() can forward the
+ * upstream messages `msgs` as is.
+ *
+ * This is the case when all the messages are events, when all the
+ * current streams already saw a clock snapshot (handling an event
+ * wouldn't modify any stream state), and when the last event isn't
+ * after the trimming range's end: upstream messages are ordered, so
+ * none of the other events is either.
+ */
+static inline
+bt_message_iterator_class_next_method_status can_forward_messages(
+		struct trimmer_iterator *trimmer_it,
+		bt_message_array_const msgs, uint64_t count, bool *can_forward)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	bool is_after_end;
+	uint64_t i;
+
+	*can_forward = false;
+
+	if (trimmer_it->unseen_clock_snapshot_stream_count > 0) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (bt_message_get_type(msgs[i]) != BT_MESSAGE_TYPE_EVENT) {
+			goto end;
+		}
+	}
+
+	status = clock_snapshot_is_after_end(trimmer_it,
+		bt_message_event_borrow_default_clock_snapshot_const(
+			msgs[count - 1]),
+		&is_after_end);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		goto end;
+	}
+
+	*can_forward = !is_after_end;
+
+end:
+	return status;
+}
+
 static inline
 bt_message_iterator_class_next_method_status
 state_trim(struct trimmer_iterator *trimmer_it,
@@ -1816,6 +2490,33 @@ state_trim(struct trimmer_iterator *trimmer_it,
 
 		BT_ASSERT_DBG(my_count > 0);
 
+		if (G_LIKELY(my_count <= capacity)) {
+			bool can_forward;
+
+			status = can_forward_messages(trimmer_it, my_msgs,
+				my_count, &can_forward);
+			if (G_UNLIKELY(status !=
+					BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK)) {
+				put_messages(my_msgs, my_count);
+				goto end;
+			}
+
+			if (G_LIKELY(can_forward)) {
+				/*
+				 * The whole upstream message array is
+				 * within the trimming time range: move
+				 * its messages to the output message
+				 * array as is.
+				 */
+				for (i = 0; i < my_count; i++) {
+					msgs[i] = my_msgs[i];
+				}
+
+				*count = my_count;
+				goto end;
+			}
+		}
+
 		for (i = 0; i < my_count; i++) {
 			status = handle_message(trimmer_it, my_msgs[i],
 				&reached_end);
@@ -1833,17 +2534,42 @@ state_trim(struct trimmer_iterator *trimmer_it,
 			}
 
 			if (G_UNLIKELY(reached_end)) {
+				put_messages(my_msgs, my_count);
+
+				if (trimmer_it->cur_range + 1 <
+						trimmer_it->ranges->len) {
+					/*
+					 * This message's time was passed
+					 * the current trimming time
+					 * range's end time: continue with
+					 * the next range, from the
+					 * upstream messages after seeking
+					 * its beginning.
+					 */
+					status = end_range(trimmer_it);
+					if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+						goto end;
+					}
+
+					reached_end = false;
+					break;
+				}
+
 				/*
 				 * This message's time was passed the
-				 * trimming time range's end time: we
-				 * are done. Their might still be
+				 * last trimming time range's end time:
+				 * we are done. Their might still be
 				 * messages in the output message queue,
 				 * so move to the "ending" state and
 				 * apply it immediately since
 				 * state_trim() is called within the
 				 * "next" method.
 				 */
-				put_messages(my_msgs, my_count);
+				status = end_iterator_streams(trimmer_it);
+				if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+					goto end;
+				}
+
 				trimmer_it->state =
 					TRIMMER_ITERATOR_STATE_ENDING;
 				status = state_ending(trimmer_it, msgs,
@@ -30,6 +30,7 @@
 #define PYTHON_PLUGIN_FILE_PREFIX_LEN	(sizeof(PYTHON_PLUGIN_FILE_PREFIX) - 1)
 #define PYTHON_PLUGIN_FILE_EXT		".py"
 #define PYTHON_PLUGIN_FILE_EXT_LEN	(sizeof(PYTHON_PLUGIN_FILE_EXT) - 1)
+#define PYTHON_PLUGIN_REGISTER_FUNC_NAME	"register_plugin"
 
 static enum python_state {
 	/* init_python() not called yet */
@@ -208,6 +209,32 @@ void fini_python(void) {
 	python_state = PYTHON_STATE_NOT_INITED;
 }
 
+/*
+ * Returns whether or not the file `path` contains
+ * `PYTHON_PLUGIN_REGISTER_FUNC_NAME`.
+ *
+ * Returns `true` if the file can't be read: the Python loader reports
+ * any actual error.
+ */
+static
+bool file_contains_register_plugin(const char *path)
+{
+	gchar *contents = NULL;
+	gsize length;
+	bool ret = true;
+
+	if (!g_file_get_contents(path, &contents, &length, NULL)) {
+		goto end;
+	}
+
+	ret = g_strstr_len(contents, length,
+		PYTHON_PLUGIN_REGISTER_FUNC_NAME) != NULL;
+
+end:
+	g_free(contents);
+	return ret;
+}
+
 static
 int bt_plugin_from_python_plugin_info(PyObject *plugin_info,
 		bool fail_on_load_error, bt_plugin **plugin_out)
@@ -661,6 +688,19 @@ int bt_plugin_python_create_all_from_file(const char *path,
 		goto error;
 	}
 
+	/*
+	 * A Python plugin file needs to call bt2.register_plugin(): if
+	 * the file doesn't even contain this function name, then don't
+	 * bother initializing the Python interpreter (and importing the
+	 * `bt2` package) to find out that it's not a plugin.
+	 */
+	if (!file_contains_register_plugin(path)) {
+		BT_LOGI("Skipping Python file which doesn't register any plugin: "
+			"path=\"%s\"", path);
+		status = BT_FUNC_STATUS_NOT_FOUND;
+		goto error;
+	}
+
 	/*
 	 * Initialize Python now.
 	 *
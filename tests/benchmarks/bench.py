@@ -0,0 +1,377 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+#
+
+# Benchmarks of standard `babeltrace2` pipelines on synthetic CTF traces.
+#
+# For each trace shape, this script generates a trace with
+# `gen_trace.py` and then, for each pipeline, runs the `babeltrace2` CLI
+# a few times to measure its throughput (messages/s) and its peak
+# resident set size.
+#
+# The results are a JSON document (see the "Benchmarks" section of
+# `CONTRIBUTING.adoc`) so that they can be tracked over time.
+
+import argparse
+import datetime
+import json
+import os
+import os.path
+import platform
+import re
+import shutil
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+import gen_trace
+
+
+_RESULTS_FORMAT_VERSION = 1
+
+# Standard trace shapes: `events` is a multiplier of `--events`.
+_SHAPES = {
+    'ints': {'events': 1, 'streams': 4, 'payload-mix': 'ints', 'packet-size': 65536},
+    'strings': {
+        'events': 1,
+        'streams': 4,
+        'payload-mix': 'string',
+        'packet-size': 65536,
+    },
+    'mixed': {
+        'events': 1,
+        'streams': 4,
+        'payload-mix': 'ints=2,string=1,mixed=2,seq=1',
+        'packet-size': 65536,
+    },
+    'many-streams': {
+        'events': 1,
+        'streams': 64,
+        'payload-mix': 'ints=1,mixed=1',
+        'packet-size': 16384,
+    },
+    'small-packets': {
+        'events': 1,
+        'streams': 4,
+        'payload-mix': 'ints=1,mixed=1',
+        'packet-size': 1024,
+    },
+}
+
+_PIPELINES = [
+    'ctf-fs-counter',
+    'ctf-fs-muxer-pretty',
+    'ctf-fs-sink-ctf-fs',
+    'lttng-live-counter',
+]
+
+
+def _tests_srcdir():
+    srcdir = os.environ.get('BT_TESTS_SRCDIR')
+
+    if srcdir:
+        return srcdir
+
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+
+# Result of running the CLI once.
+class _Run:
+    def __init__(self, elapsed_s, peak_rss_kib, stdout):
+        self.elapsed_s = elapsed_s
+        self.peak_rss_kib = peak_rss_kib
+        self.stdout = stdout
+
+
+# Runs the CLI with the arguments `args` and returns a `_Run` object.
+#
+# Uses os.wait4() to get the peak RSS of this specific child process.
+def _run_cli(cli, args, capture_stdout=False):
+    with tempfile.TemporaryFile() as stdout_file, tempfile.TemporaryFile() as err_file:
+        begin = time.monotonic()
+        proc = subprocess.Popen(
+            [cli] + args,
+            stdin=subprocess.DEVNULL,
+            stdout=stdout_file if capture_stdout else subprocess.DEVNULL,
+            stderr=err_file,
+        )
+        _, status, rusage = os.wait4(proc.pid, 0)
+        elapsed_s = time.monotonic() - begin
+
+        if os.WIFEXITED(status):
+            proc.returncode = os.WEXITSTATUS(status)
+        else:
+            proc.returncode = -os.WTERMSIG(status)
+
+        if proc.returncode != 0:
+            err_file.seek(0)
+            raise RuntimeError(
+                '`{}` failed with exit status {}:\n{}'.format(
+                    ' '.join([cli] + args),
+                    proc.returncode,
+                    err_file.read().decode(errors='replace'),
+                )
+            )
+
+        stdout = None
+
+        if capture_stdout:
+            stdout_file.seek(0)
+            stdout = stdout_file.read().decode(errors='replace')
+
+    # `ru_maxrss` is in kibibytes on Linux, but in bytes on macOS.
+    peak_rss_kib = rusage.ru_maxrss
+
+    if sys.platform == 'darwin':
+        peak_rss_kib //= 1024
+
+    return _Run(elapsed_s, peak_rss_kib, stdout)
+
+
+# Returns the total message count of a `sink.utils.counter` output.
+def _counter_total(stdout):
+    match = re.search(r'(\d+) messages? \(TOTAL\)', stdout)
+
+    if match is None:
+        raise RuntimeError('Cannot find the total message count:\n' + stdout)
+
+    return int(match.group(1))
+
+
+def _counter_args():
+    return ['-c', 'sink.utils.counter', '-p', 'step=0']
+
+
+# Starts the LTTng live server mockup to serve the trace `trace_dir`
+# and returns its `subprocess.Popen` object and its port.
+def _start_live_server(python, trace_dir, port_filename):
+    server = os.path.join(
+        _tests_srcdir(), 'data', 'plugins', 'src.ctf.lttng-live', 'lttng_live_server.py'
+    )
+    proc = subprocess.Popen(
+        [
+            python,
+            server,
+            '--port-filename',
+            port_filename,
+            'bench,0,hostname,1,0,{}'.format(trace_dir),
+        ],
+        stdin=subprocess.DEVNULL,
+        stdout=subprocess.DEVNULL,
+    )
+    deadline = time.monotonic() + 30
+
+    while not os.path.exists(port_filename) or os.path.getsize(port_filename) == 0:
+        if proc.poll() is not None:
+            raise RuntimeError('LTTng live server mockup exited prematurely')
+
+        if time.monotonic() > deadline:
+            proc.kill()
+            proc.wait()
+            raise RuntimeError('Timeout waiting for the LTTng live server mockup')
+
+        time.sleep(0.05)
+
+    with open(port_filename) as f:
+        return proc, int(f.read())
+
+
+def _stop_live_server(proc):
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGTERM)
+
+    proc.wait()
+
+
+# Runs the pipeline `pipeline` once on the trace which `trace_info`
+# describes and returns a (`_Run` object, message count) pair.
+def _run_pipeline_once(args, pipeline, trace_info, tmp_dir):
+    trace_dir = trace_info['path']
+
+    if pipeline == 'ctf-fs-counter':
+        run = _run_cli(args.cli, [trace_dir] + _counter_args(), True)
+        return run, _counter_total(run.stdout)
+
+    if pipeline == 'ctf-fs-muxer-pretty':
+        run = _run_cli(args.cli, [trace_dir, '-c', 'sink.text.pretty'])
+        return run, trace_info['message-count']
+
+    if pipeline == 'ctf-fs-sink-ctf-fs':
+        out_dir = os.path.join(tmp_dir, 'out')
+
+        try:
+            sink_args = ['-c', 'sink.ctf.fs', '-p', 'path="{}"'.format(out_dir)]
+            run = _run_cli(args.cli, [trace_dir] + sink_args)
+        finally:
+            shutil.rmtree(out_dir, ignore_errors=True)
+
+        return run, trace_info['message-count']
+
+    assert pipeline == 'lttng-live-counter'
+    port_filename = os.path.join(tmp_dir, 'port')
+    server, port = _start_live_server(args.python, trace_dir, port_filename)
+
+    try:
+        url = 'net://localhost:{}/host/hostname/bench'.format(port)
+        run = _run_cli(args.cli, ['-i', 'lttng-live', url] + _counter_args(), True)
+    finally:
+        _stop_live_server(server)
+        os.remove(port_filename)
+
+    # The counter also counts message iterator inactivity messages.
+    return run, _counter_total(run.stdout)
+
+
+def _bench_pipeline(args, pipeline, trace_info, tmp_dir):
+    runs = []
+    msg_count = None
+
+    for _ in range(args.repeat):
+        run, msg_count = _run_pipeline_once(args, pipeline, trace_info, tmp_dir)
+        runs.append(run)
+
+    elapsed = [run.elapsed_s for run in runs]
+    median_s = statistics.median(elapsed)
+    return {
+        'pipeline': pipeline,
+        'message-count': msg_count,
+        'runs': [
+            {'elapsed-s': run.elapsed_s, 'peak-rss-kib': run.peak_rss_kib}
+            for run in runs
+        ],
+        'median-elapsed-s': median_s,
+        'min-elapsed-s': min(elapsed),
+        'messages-per-second': msg_count / median_s if median_s > 0 else None,
+        'events-per-second': trace_info['event-count'] / median_s
+        if median_s > 0
+        else None,
+        'peak-rss-kib': max(run.peak_rss_kib for run in runs),
+    }
+
+
+def _cli_version(cli):
+    out = subprocess.run([cli, '--version'], stdout=subprocess.PIPE, check=True)
+    lines = out.stdout.decode(errors='replace').splitlines()
+    return lines[0] if lines else None
+
+
+def _log(msg):
+    print('# ' + msg, file=sys.stderr, flush=True)
+
+
+def _parse_args(argv):
+    parser = argparse.ArgumentParser(
+        description='Benchmark standard babeltrace2 pipelines on synthetic CTF traces.'
+    )
+    parser.add_argument(
+        '--cli',
+        default=os.environ.get('BT_TESTS_BT2_BIN', 'babeltrace2'),
+        help='Path to the babeltrace2 CLI (default: $BT_TESTS_BT2_BIN or babeltrace2).',
+    )
+    parser.add_argument(
+        '--python',
+        default=os.environ.get('BT_TESTS_PYTHON_BIN', sys.executable),
+        help='Python interpreter to run the LTTng live server mockup.',
+    )
+    parser.add_argument(
+        '--shape',
+        action='append',
+        choices=sorted(_SHAPES),
+        help='Trace shape to benchmark (repeatable; default: all).',
+    )
+    parser.add_argument(
+        '--pipeline',
+        action='append',
+        choices=_PIPELINES,
+        help='Pipeline to benchmark (repeatable; default: all).',
+    )
+    parser.add_argument(
+        '--events',
+        type=int,
+        default=1000000,
+        help='Event count of each trace (default: 1000000).',
+    )
+    parser.add_argument(
+        '--repeat',
+        type=int,
+        default=3,
+        help='Number of runs of each pipeline (default: 3).',
+    )
+    parser.add_argument(
+        '--output',
+        '-o',
+        help='Write the JSON results to this file instead of the standard output.',
+    )
+    args = parser.parse_args(argv)
+
+    if args.repeat < 1:
+        parser.error('--repeat must be at least 1')
+
+    if args.events < 1:
+        parser.error('--events must be at least 1')
+
+    return args
+
+
+def main(argv):
+    args = _parse_args(argv)
+    shapes = args.shape or sorted(_SHAPES)
+    pipelines = args.pipeline or _PIPELINES
+    results = {
+        'version': _RESULTS_FORMAT_VERSION,
+        'date': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        'host': platform.node(),
+        'machine': platform.machine(),
+        'cpu-count': os.cpu_count(),
+        'babeltrace2-version': _cli_version(args.cli),
+        'repeat': args.repeat,
+        'shapes': [],
+    }
+
+    for shape_name in shapes:
+        shape = _SHAPES[shape_name]
+
+        with tempfile.TemporaryDirectory(prefix='bt-bench-') as tmp_dir:
+            trace_dir = os.path.join(tmp_dir, 'trace')
+            os.mkdir(trace_dir)
+            _log('Generating `{}` trace'.format(shape_name))
+            trace_info = gen_trace.generate(
+                trace_dir,
+                shape['events'] * args.events,
+                shape['streams'],
+                gen_trace.parse_payload_mix(shape['payload-mix']),
+                shape['packet-size'],
+            )
+            shape_results = {
+                'name': shape_name,
+                'trace': {k: v for k, v in trace_info.items() if k != 'path'},
+                'pipelines': [],
+            }
+
+            for pipeline in pipelines:
+                _log('Running `{}` on `{}` trace'.format(pipeline, shape_name))
+                result = _bench_pipeline(args, pipeline, trace_info, tmp_dir)
+                _log(
+                    '  {:.0f} msg/s, peak RSS {} KiB'.format(
+                        result['messages-per-second'] or 0, result['peak-rss-kib']
+                    )
+                )
+                shape_results['pipelines'].append(result)
+
+            results['shapes'].append(shape_results)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+            f.write('\n')
+    else:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,479 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+#
+
+# Benchmarks of the per-message overhead of the `bt2` Python bindings.
+#
+# Each benchmark runs a given operation for a given number of messages a
+# few times, within this process, and reports its median duration per
+# message.
+#
+# The results are a JSON document (see the "Benchmarks" section of
+# `CONTRIBUTING.adoc`) so that they can be compared between releases.
+
+import argparse
+import array
+import datetime
+import gc
+import json
+import os
+import platform
+import statistics
+import sys
+import tempfile
+import time
+
+import bt2
+import gen_trace
+
+
+_RESULTS_FORMAT_VERSION = 1
+
+# Event count of each column reader call.
+_COLUMN_READER_CHUNK_SIZE = 4096
+
+
+# Trace of which the benchmarks which need actual CTF event messages
+# read the messages, with the `ints` payload (`u64`, `s64`, `u32`,
+# `s32`, and `u16` members).
+class _Trace:
+    def __init__(self, path, info):
+        self.path = path
+        self.info = info
+        self._event_msgs = None
+
+    # Returns the event messages of the trace, reading them the first
+    # time.
+    @property
+    def event_msgs(self):
+        if self._event_msgs is None:
+            self._event_msgs = [
+                msg
+                for msg in bt2.TraceCollectionMessageIterator(self.path)
+                if type(msg) is bt2._EventMessageConst
+            ]
+
+        return self._event_msgs
+
+
+# `TraceCollectionMessageIterator` benchmarks.
+
+
+def _bench_tcmi_iterate(trace):
+    count = 0
+
+    for _ in bt2.TraceCollectionMessageIterator(trace.path):
+        count += 1
+
+    return count
+
+
+def _bench_tcmi_column_reader(trace):
+    reader = bt2.TraceCollectionMessageIterator(trace.path).column_reader(
+        ['timestamp', (bt2.FieldPathScope.EVENT_PAYLOAD, 'u64')]
+    )
+    buffers = [
+        array.array('q', [0] * _COLUMN_READER_CHUNK_SIZE)
+        for _ in range(reader.column_count)
+    ]
+    count = 0
+
+    while True:
+        chunk_count = reader.read(buffers)
+        count += chunk_count
+
+        if chunk_count < _COLUMN_READER_CHUNK_SIZE:
+            return count
+
+
+# Field access benchmarks (event messages already read).
+
+
+def _bench_field_payload_by_name(trace):
+    msgs = trace.event_msgs
+
+    for msg in msgs:
+        int(msg.event.payload_field['u64'])
+
+    return len(msgs)
+
+
+def _bench_field_event_by_name(trace):
+    msgs = trace.event_msgs
+
+    for msg in msgs:
+        int(msg.event['u64'])
+
+    return len(msgs)
+
+
+def _bench_field_compiled_path(trace):
+    msgs = trace.event_msgs
+    path = bt2.CompiledFieldPath(
+        msgs[0].event.cls, bt2.FieldPathScope.EVENT_PAYLOAD, 'u64'
+    )
+    path.values(msgs)
+    return len(msgs)
+
+
+# Wrapper creation benchmark: the bindings create a new Python object
+# for each access to a property which returns a library object.
+
+
+def _bench_wrappers(trace):
+    msgs = trace.event_msgs
+
+    for msg in msgs:
+        event = msg.event
+        event.cls
+        event.stream
+        event.payload_field
+        msg.default_clock_snapshot
+
+    return len(msgs)
+
+
+# User component benchmarks.
+#
+# The user source creates one stream and its event messages (empty
+# payload), one per call to `__next__()` or up to the requested capacity
+# per call to `_user_next_batch()`.
+
+
+class _BenchSourceIterBase(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        ec, stream, count = self._component._objs
+        self._ec = ec
+        self._stream = stream
+        self._remaining = count
+        self._at_beginning = True
+        self._at_end = False
+
+    def _create_msg(self):
+        if self._at_beginning:
+            self._at_beginning = False
+            return self._create_stream_beginning_message(self._stream)
+
+        if self._remaining > 0:
+            self._remaining -= 1
+            return self._create_event_message(self._ec, self._stream)
+
+        if not self._at_end:
+            self._at_end = True
+            return self._create_stream_end_message(self._stream)
+
+        raise bt2.Stop
+
+
+class _BenchSourceIter(_BenchSourceIterBase):
+    def __next__(self):
+        return self._create_msg()
+
+
+class _BenchBatchSourceIter(_BenchSourceIterBase):
+    def _user_next_batch(self, capacity):
+        msgs = []
+
+        try:
+            while len(msgs) < capacity:
+                msgs.append(self._create_msg())
+        except bt2.Stop:
+            if not msgs:
+                raise
+
+        return msgs
+
+
+def _init_bench_source(comp, count):
+    tc = comp._create_trace_class()
+    sc = tc.create_stream_class()
+    ec = sc.create_event_class(name='ev')
+    comp._objs = (ec, tc().create_stream(sc), count)
+    comp._add_output_port('out')
+
+
+class _BenchSource(bt2._UserSourceComponent, message_iterator_class=_BenchSourceIter):
+    def __init__(self, config, params, count):
+        _init_bench_source(self, count)
+
+
+class _BenchBatchSource(
+    bt2._UserSourceComponent, message_iterator_class=_BenchBatchSourceIter
+):
+    def __init__(self, config, params, count):
+        _init_bench_source(self, count)
+
+
+class _BenchFilterIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        self._upstream_it = self._create_message_iterator(
+            self._component._input_ports['in']
+        )
+
+    def __next__(self):
+        return next(self._upstream_it)
+
+
+class _BenchFilter(bt2._UserFilterComponent, message_iterator_class=_BenchFilterIter):
+    def __init__(self, config, params, obj):
+        self._add_input_port('in')
+        self._add_output_port('out')
+
+
+class _BenchSinkBase(bt2._UserSinkComponent):
+    def __init__(self, config, params, obj):
+        self._port = self._add_input_port('in')
+
+    def _user_graph_is_configured(self):
+        self._it = self._create_message_iterator(self._port)
+
+
+class _BenchSink(_BenchSinkBase):
+    def _user_consume(self):
+        next(self._it)
+
+
+class _BenchBatchSink(_BenchSinkBase):
+    def _user_consume(self):
+        len(self._it.next_batch())
+
+
+def _dummy_sink_cc():
+    plugin = bt2.find_plugin('utils')
+
+    if plugin is None:
+        raise RuntimeError('cannot find "utils" plugin (needed for the dummy sink)')
+
+    return plugin.sink_component_classes['dummy']
+
+
+# Runs a graph of which the source is `src_cls`, followed by the
+# filters of `filter_classes`, and of which the sink is `sink_cls`
+# (`sink.utils.dummy` if `None`), the source emitting `count` event
+# messages.
+#
+# Returns the message count.
+def _run_user_graph(count, src_cls, filter_classes=(), sink_cls=None):
+    graph = bt2.Graph()
+    port = graph.add_component(src_cls, 'src', obj=count).output_ports['out']
+
+    for i, filter_cls in enumerate(filter_classes):
+        flt = graph.add_component(filter_cls, 'flt{}'.format(i))
+        graph.connect_ports(port, flt.input_ports['in'])
+        port = flt.output_ports['out']
+
+    if sink_cls is None:
+        sink_cls = _dummy_sink_cc()
+
+    sink = graph.add_component(sink_cls, 'sink')
+    graph.connect_ports(port, sink.input_ports['in'])
+    graph.run()
+
+    # Stream beginning and end messages.
+    return count + 2
+
+
+def _bench_user_source(trace):
+    return _run_user_graph(trace.info['event-count'], _BenchSource)
+
+
+def _bench_user_source_batch(trace):
+    return _run_user_graph(trace.info['event-count'], _BenchBatchSource)
+
+
+def _bench_user_filter(trace):
+    return _run_user_graph(
+        trace.info['event-count'], _BenchBatchSource, [_BenchFilter]
+    )
+
+
+def _bench_user_sink(trace):
+    return _run_user_graph(
+        trace.info['event-count'], _BenchBatchSource, sink_cls=_BenchSink
+    )
+
+
+def _bench_user_sink_batch(trace):
+    return _run_user_graph(
+        trace.info['event-count'], _BenchBatchSource, sink_cls=_BenchBatchSink
+    )
+
+
+# Name, function, and description of each benchmark.
+#
+# A benchmark function accepts a `_Trace` object and returns the number
+# of messages it processed.
+_BENCHMARKS = [
+    (
+        'tcmi-iterate',
+        _bench_tcmi_iterate,
+        'TraceCollectionMessageIterator: iterate all the messages',
+    ),
+    (
+        'tcmi-column-reader',
+        _bench_tcmi_column_reader,
+        'TraceCollectionMessageIterator: read the timestamp and one payload '
+        'field with a column reader',
+    ),
+    (
+        'field-payload-by-name',
+        _bench_field_payload_by_name,
+        'msg.event.payload_field[NAME] as an int',
+    ),
+    ('field-event-by-name', _bench_field_event_by_name, 'msg.event[NAME] as an int'),
+    (
+        'field-compiled-path',
+        _bench_field_compiled_path,
+        'CompiledFieldPath.values() on all the event messages',
+    ),
+    (
+        'wrappers',
+        _bench_wrappers,
+        'get the event, event class, stream, payload field, and default clock '
+        'snapshot wrappers of an event message',
+    ),
+    (
+        'user-source',
+        _bench_user_source,
+        'user source (__next__(), message creation) -> sink.utils.dummy',
+    ),
+    (
+        'user-source-batch',
+        _bench_user_source_batch,
+        'user source (_user_next_batch(), message creation) -> sink.utils.dummy',
+    ),
+    (
+        'user-filter',
+        _bench_user_filter,
+        'user batch source -> user filter (__next__()) -> sink.utils.dummy',
+    ),
+    (
+        'user-sink',
+        _bench_user_sink,
+        'user batch source -> user sink (_user_consume(), next())',
+    ),
+    (
+        'user-sink-batch',
+        _bench_user_sink_batch,
+        'user batch source -> user sink (_user_consume(), next_batch())',
+    ),
+]
+
+
+def _run_bench(args, name, func, descr, trace):
+    # Warm-up run, which also reads the event messages of the trace
+    # for the field and wrapper benchmarks.
+    func(trace)
+    runs = []
+    msg_count = None
+
+    for _ in range(args.repeat):
+        gc.collect()
+        begin = time.perf_counter()
+        msg_count = func(trace)
+        runs.append(time.perf_counter() - begin)
+
+    median_s = statistics.median(runs)
+    return {
+        'name': name,
+        'description': descr,
+        'message-count': msg_count,
+        'runs': [{'elapsed-s': elapsed_s} for elapsed_s in runs],
+        'median-elapsed-s': median_s,
+        'min-elapsed-s': min(runs),
+        'ns-per-message': median_s * 1e9 / msg_count if msg_count else None,
+        'messages-per-second': msg_count / median_s if median_s > 0 else None,
+    }
+
+
+def _log(msg):
+    print('# ' + msg, file=sys.stderr, flush=True)
+
+
+def _parse_args(argv):
+    parser = argparse.ArgumentParser(
+        description='Benchmark the per-message overhead of the bt2 Python bindings.'
+    )
+    parser.add_argument(
+        '--bench',
+        action='append',
+        choices=[name for name, _, _ in _BENCHMARKS],
+        help='Benchmark to run (repeatable; default: all).',
+    )
+    parser.add_argument(
+        '--events',
+        type=int,
+        default=200000,
+        help='Event count of each benchmark (default: 200000).',
+    )
+    parser.add_argument(
+        '--repeat',
+        type=int,
+        default=3,
+        help='Number of runs of each benchmark (default: 3).',
+    )
+    parser.add_argument(
+        '--output',
+        '-o',
+        help='Write the JSON results to this file instead of the standard output.',
+    )
+    args = parser.parse_args(argv)
+
+    if args.repeat < 1:
+        parser.error('--repeat must be at least 1')
+
+    if args.events < 1:
+        parser.error('--events must be at least 1')
+
+    return args
+
+
+def main(argv):
+    args = _parse_args(argv)
+    names = args.bench or [name for name, _, _ in _BENCHMARKS]
+    results = {
+        'version': _RESULTS_FORMAT_VERSION,
+        'date': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        'host': platform.node(),
+        'machine': platform.machine(),
+        'cpu-count': os.cpu_count(),
+        'python-version': platform.python_version(),
+        'bt2-version': bt2.__version__,
+        'repeat': args.repeat,
+        'event-count': args.events,
+        'benchmarks': [],
+    }
+
+    with tempfile.TemporaryDirectory(prefix='bt-bench-bt2-') as tmp_dir:
+        trace_dir = os.path.join(tmp_dir, 'trace')
+        os.mkdir(trace_dir)
+        _log('Generating trace')
+        trace = _Trace(
+            trace_dir, gen_trace.generate(trace_dir, args.events, 1, {'ints': 1})
+        )
+
+        for name, func, descr in _BENCHMARKS:
+            if name not in names:
+                continue
+
+            _log('Running `{}`'.format(name))
+            result = _run_bench(args, name, func, descr, trace)
+            _log(
+                '  {:.0f} ns/msg, {:.0f} msg/s'.format(
+                    result['ns-per-message'] or 0, result['messages-per-second'] or 0
+                )
+            )
+            results['benchmarks'].append(result)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+            f.write('\n')
+    else:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,470 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+#
+
+# Synthetic CTF 1.8 trace generator for the benchmarks.
+#
+# The generated trace has a configurable shape (event count, stream
+# count, payload mix, packet size) and comes with LTTng index files so
+# that both `src.ctf.fs` and the LTTng live server mockup
+# (`tests/data/plugins/src.ctf.lttng-live/lttng_live_server.py`) can
+# read it.
+#
+# The generator is deterministic: the same arguments always produce the
+# same trace.
+
+import argparse
+import json
+import os
+import os.path
+import random
+import struct
+import sys
+import uuid
+
+
+_PACKET_MAGIC = 0xC1FC1FC1
+_INDEX_MAGIC = 0xC1F1DCC1
+_INDEX_MAJOR = 1
+_INDEX_MINOR = 1
+
+# Packet header and context (see the metadata below), without padding.
+_PACKET_HEADER_FMT = '<I16sIQ'
+_PACKET_CONTEXT_FMT = '<QQQQQQI'
+_PACKET_PREAMBLE_SIZE = struct.calcsize(_PACKET_HEADER_FMT) + struct.calcsize(
+    _PACKET_CONTEXT_FMT
+)
+
+# Event header: ID and 64-bit timestamp.
+_EVENT_HEADER_FMT = '<IQ'
+
+# Index entry (CTF index 1.1, big-endian).
+_INDEX_HEADER_FMT = '>IIII'
+_INDEX_ENTRY_FMT = '>QQQQQQQQQ'
+
+_CLOCK_FREQ = 1000000000
+_CLOCK_OFFSET_S = 1600000000
+
+_METADATA_HEAD = '''/* CTF 1.8 */
+
+typealias integer {{ size = 8; align = 8; signed = false; }} := uint8_t;
+typealias integer {{ size = 16; align = 8; signed = false; }} := uint16_t;
+typealias integer {{ size = 32; align = 8; signed = false; }} := uint32_t;
+typealias integer {{ size = 64; align = 8; signed = false; }} := uint64_t;
+typealias integer {{ size = 16; align = 8; signed = true; }} := int16_t;
+typealias integer {{ size = 32; align = 8; signed = true; }} := int32_t;
+typealias integer {{ size = 64; align = 8; signed = true; }} := int64_t;
+typealias floating_point {{
+	exp_dig = 11; mant_dig = 53; byte_order = le; align = 8;
+}} := double;
+
+trace {{
+	major = 1;
+	minor = 8;
+	uuid = "{uuid}";
+	byte_order = le;
+	packet.header := struct {{
+		uint32_t magic;
+		uint8_t uuid[16];
+		uint32_t stream_id;
+		uint64_t stream_instance_id;
+	}};
+}};
+
+env {{
+	hostname = "bench";
+	domain = "ust";
+	tracer_name = "lttng-ust";
+	tracer_major = 2;
+	tracer_minor = 12;
+}};
+
+clock {{
+	name = "monotonic";
+	freq = {freq};
+	offset_s = {offset_s};
+}};
+
+typealias integer {{
+	size = 64; align = 8; signed = false;
+	map = clock.monotonic.value;
+}} := uint64_clock_monotonic_t;
+
+stream {{
+	id = 0;
+	packet.context := struct {{
+		uint64_clock_monotonic_t timestamp_begin;
+		uint64_clock_monotonic_t timestamp_end;
+		uint64_t content_size;
+		uint64_t packet_size;
+		uint64_t packet_seq_num;
+		uint64_t events_discarded;
+		uint32_t cpu_id;
+	}};
+	event.header := struct {{
+		uint32_t id;
+		uint64_clock_monotonic_t timestamp;
+	}};
+}};
+'''
+
+
+# An event class of the generated trace.
+#
+# `fields` is the TSDL of the payload structure members and `gen` is a
+# function which, given a `random.Random` object, returns the
+# serialized payload.
+class _EventClass:
+    def __init__(self, name, fields, gen):
+        self.name = name
+        self.fields = fields
+        self.gen = gen
+
+
+def _gen_str(rng, max_len):
+    length = rng.randint(0, max_len)
+    return bytes(rng.choice(b'abcdefghijklmnopqrstuvwxyz ') for _ in range(length))
+
+
+def _gen_ints(rng):
+    return struct.pack(
+        '<QqIiH',
+        rng.getrandbits(64),
+        rng.randint(-(2 ** 63), 2 ** 63 - 1),
+        rng.getrandbits(32),
+        rng.randint(-(2 ** 31), 2 ** 31 - 1),
+        rng.getrandbits(16),
+    )
+
+
+def _gen_string(rng):
+    return _gen_str(rng, 64) + b'\0'
+
+
+def _gen_mixed(rng):
+    return (
+        struct.pack(
+            '<BhId',
+            rng.getrandbits(8),
+            rng.randint(-500, 500),
+            rng.getrandbits(32),
+            rng.random(),
+        )
+        + _gen_str(rng, 24)
+        + b'\0'
+        + struct.pack('<4H', *(rng.getrandbits(16) for _ in range(4)))
+        + struct.pack('<B', rng.randint(0, 2))
+    )
+
+
+def _gen_seq(rng):
+    length = rng.randint(0, 16)
+    return struct.pack('<B', length) + struct.pack(
+        '<{}I'.format(length), *(rng.getrandbits(32) for _ in range(length))
+    )
+
+
+_EVENT_CLASSES = {
+    'ints': _EventClass(
+        'bench:ints',
+        '''		uint64_t u64;
+		int64_t s64;
+		uint32_t u32;
+		int32_t s32;
+		uint16_t u16;''',
+        _gen_ints,
+    ),
+    'string': _EventClass(
+        'bench:string',
+        '''		string msg;''',
+        _gen_string,
+    ),
+    'mixed': _EventClass(
+        'bench:mixed',
+        '''		uint8_t u8;
+		int16_t s16;
+		uint32_t u32;
+		double dbl;
+		string str;
+		uint16_t arr[4];
+		enum : uint8_t { RED, GREEN, BLUE } color;''',
+        _gen_mixed,
+    ),
+    'seq': _EventClass(
+        'bench:seq',
+        '''		uint8_t len;
+		uint32_t seq[len];''',
+        _gen_seq,
+    ),
+}
+
+
+# Parses a payload mix string such as `ints=2,string=1`.
+def parse_payload_mix(string):
+    mix = {}
+
+    for part in string.split(','):
+        name, _, weight = part.partition('=')
+
+        if name not in _EVENT_CLASSES:
+            raise argparse.ArgumentTypeError(
+                'unknown event class `{}` (expecting one of {})'.format(
+                    name, ', '.join(sorted(_EVENT_CLASSES))
+                )
+            )
+
+        try:
+            weight = int(weight) if weight else 1
+        except ValueError:
+            raise argparse.ArgumentTypeError('invalid weight `{}`'.format(weight))
+
+        if weight < 0:
+            raise argparse.ArgumentTypeError('negative weight `{}`'.format(weight))
+
+        mix[name] = weight
+
+    if sum(mix.values()) == 0:
+        raise argparse.ArgumentTypeError('all weights are zero')
+
+    return mix
+
+
+def _metadata(trace_uuid, ec_names):
+    metadata = _METADATA_HEAD.format(
+        uuid=str(trace_uuid), freq=_CLOCK_FREQ, offset_s=_CLOCK_OFFSET_S
+    )
+
+    for ec_id, name in enumerate(ec_names):
+        ec = _EVENT_CLASSES[name]
+        metadata += '''
+event {{
+	name = "{name}";
+	id = {id};
+	stream_id = 0;
+	fields := struct {{
+{fields}
+	}};
+}};
+'''.format(
+            name=ec.name, id=ec_id, fields=ec.fields
+        )
+
+    return metadata
+
+
+# Data stream file and index writer.
+class _StreamWriter:
+    def __init__(self, trace_dir, trace_uuid, stream_index, packet_size):
+        self._name = 'stream_{}'.format(stream_index)
+        self._file = open(os.path.join(trace_dir, self._name), 'wb')
+        self._index_file = open(
+            os.path.join(trace_dir, 'index', self._name + '.idx'), 'wb'
+        )
+        self._index_file.write(
+            struct.pack(
+                _INDEX_HEADER_FMT,
+                _INDEX_MAGIC,
+                _INDEX_MAJOR,
+                _INDEX_MINOR,
+                struct.calcsize(_INDEX_ENTRY_FMT),
+            )
+        )
+        self._trace_uuid = trace_uuid
+        self._stream_index = stream_index
+        self._packet_size = packet_size
+        self._packet_seq_num = 0
+        self._events = []
+        self._content_size = _PACKET_PREAMBLE_SIZE
+        self.packet_count = 0
+        self.event_count = 0
+        self.size = 0
+
+    # Appends one serialized event with the timestamp `ts`.
+    def append_event(self, ts, data):
+        if len(data) + _PACKET_PREAMBLE_SIZE > self._packet_size:
+            raise ValueError(
+                'packet size {} is too small for an event of {} bytes'.format(
+                    self._packet_size, len(data)
+                )
+            )
+
+        if self._content_size + len(data) > self._packet_size:
+            self._flush()
+
+        self._events.append((ts, data))
+        self._content_size += len(data)
+        self.event_count += 1
+
+    def _flush(self):
+        if not self._events:
+            return
+
+        header = struct.pack(
+            _PACKET_HEADER_FMT,
+            _PACKET_MAGIC,
+            self._trace_uuid.bytes,
+            0,
+            self._stream_index,
+        )
+        ts_begin = self._events[0][0]
+        ts_end = self._events[-1][0]
+        context = struct.pack(
+            _PACKET_CONTEXT_FMT,
+            ts_begin,
+            ts_end,
+            self._content_size * 8,
+            self._packet_size * 8,
+            self._packet_seq_num,
+            0,
+            self._stream_index,
+        )
+        offset = self._file.tell()
+        self._file.write(header)
+        self._file.write(context)
+
+        for _, data in self._events:
+            self._file.write(data)
+
+        self._file.write(b'\0' * (self._packet_size - self._content_size))
+        self._index_file.write(
+            struct.pack(
+                _INDEX_ENTRY_FMT,
+                offset,
+                self._packet_size * 8,
+                self._content_size * 8,
+                ts_begin,
+                ts_end,
+                0,
+                0,
+                self._stream_index,
+                self._packet_seq_num,
+            )
+        )
+        self._packet_seq_num += 1
+        self.packet_count += 1
+        self.size += self._packet_size
+        self._events = []
+        self._content_size = _PACKET_PREAMBLE_SIZE
+
+    def close(self):
+        self._flush()
+        self._file.close()
+        self._index_file.close()
+
+
+# Generates a trace in the existing, empty directory `trace_dir`.
+#
+# Returns a dictionary which describes the generated trace, including
+# its expected message count.
+def generate(
+    trace_dir,
+    event_count,
+    stream_count=1,
+    payload_mix=None,
+    packet_size=65536,
+    seed=0,
+):
+    if payload_mix is None:
+        payload_mix = {'ints': 1}
+
+    if stream_count < 1:
+        raise ValueError('stream count must be at least 1')
+
+    if packet_size % 8 != 0:
+        raise ValueError('packet size must be a multiple of 8 bytes')
+
+    rng = random.Random(seed)
+    trace_uuid = uuid.UUID(int=rng.getrandbits(128))
+    ec_names = sorted(name for name, weight in payload_mix.items() if weight > 0)
+    ec_weights = [payload_mix[name] for name in ec_names]
+
+    with open(os.path.join(trace_dir, 'metadata'), 'w') as f:
+        f.write(_metadata(trace_uuid, ec_names))
+
+    os.mkdir(os.path.join(trace_dir, 'index'))
+    writers = [
+        _StreamWriter(trace_dir, trace_uuid, i, packet_size)
+        for i in range(stream_count)
+    ]
+    ts = 0
+
+    try:
+        # Spread the events over the streams with a bit of randomness so
+        # that a downstream muxer has actual work to do.
+        for _ in range(event_count):
+            ts += rng.randint(1, 1000)
+            writer = writers[rng.randrange(stream_count)]
+            ec_id = rng.choices(range(len(ec_names)), ec_weights)[0]
+            payload = _EVENT_CLASSES[ec_names[ec_id]].gen(rng)
+            writer.append_event(ts, struct.pack(_EVENT_HEADER_FMT, ec_id, ts) + payload)
+    finally:
+        for writer in writers:
+            writer.close()
+
+    packet_count = sum(w.packet_count for w in writers)
+    nonempty_stream_count = sum(1 for w in writers if w.event_count > 0)
+
+    return {
+        'path': trace_dir,
+        'event-count': event_count,
+        'stream-count': stream_count,
+        'packet-count': packet_count,
+        'packet-size': packet_size,
+        'payload-mix': payload_mix,
+        'size': sum(w.size for w in writers),
+        # Events, packet beginnings and ends, and stream beginnings and
+        # ends (`src.ctf.fs` doesn't create empty streams).
+        'message-count': event_count + 2 * packet_count + 2 * nonempty_stream_count,
+    }
+
+
+def _parse_args(argv):
+    parser = argparse.ArgumentParser(description='Generate a synthetic CTF trace.')
+    parser.add_argument(
+        'trace_dir', metavar='DIR', help='Output directory (must not exist).'
+    )
+    parser.add_argument(
+        '--events', type=int, default=1000000, help='Event count (default: 1000000).'
+    )
+    parser.add_argument(
+        '--streams', type=int, default=4, help='Data stream count (default: 4).'
+    )
+    parser.add_argument(
+        '--payload-mix',
+        type=parse_payload_mix,
+        default='ints=1',
+        help='Comma-separated list of NAME[=WEIGHT] event class weights, where '
+        'NAME is one of {} (default: ints=1).'.format(
+            ', '.join(sorted(_EVENT_CLASSES))
+        ),
+    )
+    parser.add_argument(
+        '--packet-size',
+        type=int,
+        default=65536,
+        help='Packet size in bytes (default: 65536).',
+    )
+    parser.add_argument(
+        '--seed', type=int, default=0, help='Random seed (default: 0).'
+    )
+    return parser.parse_args(argv)
+
+
+def main(argv):
+    args = _parse_args(argv)
+    os.mkdir(args.trace_dir)
+    info = generate(
+        args.trace_dir,
+        args.events,
+        args.streams,
+        args.payload_mix,
+        args.packet_size,
+        args.seed,
+    )
+    json.dump(info, sys.stdout, indent=2)
+    print()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -315,5 +315,201 @@ class ClockSnapshotTestCase(unittest.TestCase):
         self.assertFalse(self._msg.default_clock_snapshot <= 100)
 
 
+# Messages with default clock snapshots from two streams of which the
+# default clock classes have different frequencies and offsets, the
+# library recycling the event and packet messages as they're released.
+class MessageClockSnapshotRecycleTestCase(unittest.TestCase):
+    # Number of interleaved event messages
+    _EVENT_COUNT = 80
+
+    @staticmethod
+    def _ns_from_origin(stream_name, value):
+        if stream_name == 'a':
+            # 1000 Hz, offset: 45 s and 354 cycles
+            return 45 * 10 ** 9 + (354 + value) * 10 ** 6
+        else:
+            # 1 GHz, offset: 45 s
+            return 45 * 10 ** 9 + value
+
+    # Returns the raw value of the slot `k`: the slots of stream `b`
+    # come just after the ones of stream `a`.
+    @staticmethod
+    def _slot_value(stream_name, k):
+        if stream_name == 'a':
+            return 10 * k
+        else:
+            return (354 + 10 * k) * 10 ** 6 + 1
+
+    # Returns a list of (message type name, stream name, raw value) for
+    # the source to create.
+    def _msg_specs(self):
+        specs = [
+            ('stream-beginning', 'a', None),
+            ('stream-beginning', 'b', None),
+            ('packet-beginning', 'a', self._slot_value('a', 0)),
+            ('packet-beginning', 'b', self._slot_value('b', 1)),
+        ]
+
+        for k in range(2, 2 + self._EVENT_COUNT):
+            stream_name = 'a' if k % 2 == 0 else 'b'
+            specs.append(('event', stream_name, self._slot_value(stream_name, k)))
+
+        specs += [
+            (
+                'packet-end',
+                'b',
+                self._slot_value('b', 2 + self._EVENT_COUNT),
+            ),
+            ('event', 'a', 2 ** 63),
+            ('packet-end', 'a', None),
+            ('stream-end', 'a', None),
+            ('stream-end', 'b', None),
+        ]
+        return specs
+
+    def _expected_descr(self, spec):
+        msg_type, stream_name, value = spec
+
+        if value is None:
+            return (msg_type, stream_name, None, None)
+
+        ns_from_origin = self._ns_from_origin(stream_name, value)
+
+        if ns_from_origin >= 2 ** 63:
+            ns_from_origin = 'overflow'
+
+        return (msg_type, stream_name, value, ns_from_origin)
+
+    def setUp(self):
+        specs = self._msg_specs()
+
+        def f(comp_self):
+            cc_a = comp_self._create_clock_class(
+                1000, 'a', offset=bt2.ClockClassOffset(45, 354)
+            )
+            cc_b = comp_self._create_clock_class(
+                10 ** 9, 'b', offset=bt2.ClockClassOffset(45, 0)
+            )
+            tc = comp_self._create_trace_class()
+            return (cc_a, cc_b, tc)
+
+        cc_a, cc_b, tc = run_in_component_init(f)
+        trace = tc()
+        sc_a = tc.create_stream_class(
+            default_clock_class=cc_a,
+            supports_packets=True,
+            packets_have_beginning_default_clock_snapshot=True,
+        )
+        sc_b = tc.create_stream_class(
+            default_clock_class=cc_b,
+            supports_packets=True,
+            packets_have_beginning_default_clock_snapshot=True,
+            packets_have_end_default_clock_snapshot=True,
+        )
+        streams = {
+            'a': trace.create_stream(sc_a, name='a'),
+            'b': trace.create_stream(sc_b, name='b'),
+        }
+        packets = {name: stream.create_packet() for name, stream in streams.items()}
+        ecs = {'a': sc_a.create_event_class(), 'b': sc_b.create_event_class()}
+
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, self_port_output):
+                self._at = 0
+
+            def __next__(self):
+                if self._at == len(specs):
+                    raise bt2.Stop
+
+                msg_type, stream_name, value = specs[self._at]
+                self._at += 1
+
+                if msg_type == 'stream-beginning':
+                    return self._create_stream_beginning_message(streams[stream_name])
+                elif msg_type == 'stream-end':
+                    return self._create_stream_end_message(streams[stream_name])
+                elif msg_type == 'packet-beginning':
+                    return self._create_packet_beginning_message(
+                        packets[stream_name], value
+                    )
+                elif msg_type == 'packet-end':
+                    return self._create_packet_end_message(packets[stream_name], value)
+                else:
+                    return self._create_event_message(
+                        ecs[stream_name], packets[stream_name], value
+                    )
+
+        class MySrc(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        self._specs = specs
+        self._graph = bt2.Graph()
+        src_comp = self._graph.add_component(MySrc, 'my_source')
+        self._msg_iter = TestOutputPortMessageIterator(
+            self._graph, src_comp.output_ports['out']
+        )
+
+    def tearDown(self):
+        del self._msg_iter
+        del self._graph
+
+    @staticmethod
+    def _describe_cs(msg_type, stream_name, cs):
+        if cs is None:
+            return (msg_type, stream_name, None, None)
+
+        try:
+            ns_from_origin = cs.ns_from_origin
+        except bt2._OverflowError:
+            ns_from_origin = 'overflow'
+
+        return (msg_type, stream_name, cs.value, ns_from_origin)
+
+    def _describe_msg(self, msg):
+        if type(msg) is bt2._EventMessageConst:
+            return self._describe_cs(
+                'event', msg.event.stream.name, msg.default_clock_snapshot
+            )
+        elif type(msg) is bt2._PacketBeginningMessageConst:
+            return self._describe_cs(
+                'packet-beginning', msg.packet.stream.name, msg.default_clock_snapshot
+            )
+        elif type(msg) is bt2._PacketEndMessageConst:
+            cs = None
+
+            if msg.packet.stream.cls.packets_have_end_default_clock_snapshot:
+                cs = msg.default_clock_snapshot
+
+            return self._describe_cs('packet-end', msg.packet.stream.name, cs)
+        elif type(msg) is bt2._StreamBeginningMessageConst:
+            return ('stream-beginning', msg.stream.name, None, None)
+        else:
+            self.assertIs(type(msg), bt2._StreamEndMessageConst)
+            return ('stream-end', msg.stream.name, None, None)
+
+    def test_recycled_msgs(self):
+        descrs = [self._describe_msg(msg) for msg in self._msg_iter]
+        self.assertEqual(descrs, [self._expected_descr(spec) for spec in self._specs])
+
+    def test_kept_clock_snapshots(self):
+        # Keep some clock snapshots, and therefore their messages,
+        # while the other messages get recycled.
+        kept = []
+
+        for i, msg in enumerate(self._msg_iter):
+            if i % 7 == 0 and type(msg) is bt2._EventMessageConst:
+                kept.append((i, msg.event.stream.name, msg.default_clock_snapshot))
+
+        self.assertGreater(len(kept), 0)
+
+        for i, stream_name, cs in kept:
+            self.assertEqual(
+                self._describe_cs('event', stream_name, cs),
+                self._expected_descr(self._specs[i]),
+            )
+            self.assertEqual(cs.clock_class.name, stream_name)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,125 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+#
+
+import unittest
+import bt2
+from utils import TestOutputPortMessageIterator
+
+
+class CompiledFieldPathTestCase(unittest.TestCase):
+    def setUp(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, self_output_port):
+                ec, other_ec, stream = self._component._objs
+                self._msgs = [self._create_stream_beginning_message(stream)]
+
+                for i in range(4):
+                    msg = self._create_event_message(ec, stream)
+                    payload = msg.event.payload_field
+                    payload['fd'] = i
+                    payload['name'] = 'file-{}'.format(i)
+                    payload['inner']['x'] = -i
+                    payload['inner']['ratio'] = i / 2
+                    payload['inner']['flag'] = bool(i % 2)
+                    self._msgs.append(msg)
+
+                self._msgs.append(self._create_event_message(other_ec, stream))
+                self._msgs.append(self._create_stream_end_message(stream))
+
+            def __next__(self):
+                if not self._msgs:
+                    raise bt2.Stop
+
+                return self._msgs.pop(0)
+
+        class MySrc(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                tc = self._create_trace_class()
+                sc = tc.create_stream_class()
+                inner_fc = tc.create_structure_field_class()
+                inner_fc += [
+                    ('x', tc.create_signed_integer_field_class(32)),
+                    ('ratio', tc.create_double_precision_real_field_class()),
+                    ('flag', tc.create_bool_field_class()),
+                ]
+                payload_fc = tc.create_structure_field_class()
+                payload_fc += [
+                    ('fd', tc.create_unsigned_integer_field_class(32)),
+                    ('name', tc.create_string_field_class()),
+                    ('inner', inner_fc),
+                    (
+                        'arr',
+                        tc.create_static_array_field_class(
+                            tc.create_string_field_class(), 0
+                        ),
+                    ),
+                ]
+                ec = sc.create_event_class(name='open', payload_field_class=payload_fc)
+                other_ec = sc.create_event_class(name='close')
+                self._objs = (ec, other_ec, tc().create_stream(sc))
+                self._add_output_port('out')
+
+        graph = bt2.Graph()
+        src = graph.add_component(MySrc, 'src')
+        self._msgs = list(TestOutputPortMessageIterator(graph, src.output_ports['out']))
+        self._ec = self._msgs[1].event.cls
+
+    def tearDown(self):
+        del self._msgs
+        del self._ec
+
+    def _compile(self, *names):
+        return bt2.CompiledFieldPath(self._ec, bt2.FieldPathScope.EVENT_PAYLOAD, *names)
+
+    def test_values(self):
+        fd = self._compile('fd')
+        self.assertEqual(fd.values(self._msgs), [None, 0, 1, 2, 3, None, None])
+
+    def test_values_nested(self):
+        self.assertEqual(
+            self._compile('inner', 'x').values(self._msgs[1:5]), [0, -1, -2, -3]
+        )
+        self.assertEqual(
+            self._compile('inner', 'ratio').values(self._msgs[1:5]),
+            [0.0, 0.5, 1.0, 1.5],
+        )
+        self.assertEqual(
+            self._compile('inner', 'flag').values(self._msgs[1:5]),
+            [False, True, False, True],
+        )
+
+    def test_value(self):
+        name = self._compile('name')
+        self.assertEqual(name.value(self._msgs[3]), 'file-2')
+        self.assertIsNone(name.value(self._msgs[5]))
+
+    def test_event_class(self):
+        self.assertEqual(self._compile('fd').event_class.addr, self._ec.addr)
+
+    def test_unknown_member_raises(self):
+        with self.assertRaises(KeyError):
+            self._compile('inner', 'y')
+
+    def test_non_structure_raises(self):
+        with self.assertRaises(TypeError):
+            self._compile('fd', 'x')
+
+    def test_unsupported_field_class_raises(self):
+        with self.assertRaises(TypeError):
+            self._compile('arr')
+
+    def test_no_root_field_class_raises(self):
+        with self.assertRaises(ValueError):
+            bt2.CompiledFieldPath(
+                self._ec, bt2.FieldPathScope.EVENT_SPECIFIC_CONTEXT, 'fd'
+            )
+
+    def test_wrong_message_type_raises(self):
+        with self.assertRaises(TypeError):
+            self._compile('fd').values([self._msgs[1], 23])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -164,6 +164,16 @@ class EventTestCase(unittest.TestCase):
         self.assertEqual(msg.event.cls.addr, self.event_class.addr)
         self.assertIs(type(msg.event.cls), bt2_event_class._EventClassConst)
 
+    def test_const_attr_event_class_is_cached(self):
+        msg = self._create_test_const_event_message()
+        self.assertIs(msg.event.cls, msg.event.cls)
+        self.assertEqual(msg.event.cls.name, self.event_class.name)
+
+    def test_const_attr_stream_class_is_cached(self):
+        msg = self._create_test_const_event_message()
+        self.assertIs(msg.event.stream.cls, msg.event.stream.cls)
+        self.assertEqual(msg.event.stream.cls.addr, self.stream.cls.addr)
+
     def test_attr_event_class(self):
         msg = utils.get_event_message()
         self.assertIs(type(msg.event.cls), bt2_event_class._EventClass)
@@ -1658,6 +1658,55 @@ class StringFieldTestCase(unittest.TestCase):
         my_dict[self._def_const] = 'my_value'
         self.assertEqual(my_dict[self._def_value], 'my_value')
 
+    @staticmethod
+    def _make_value(length):
+        return ''.join(chr(ord('a') + i % 26) for i in range(length))
+
+    # Values around the size of the inline buffer of a string field (32
+    # bytes, including the terminating null byte).
+    def test_assign_lengths(self):
+        for length in (0, 1, 30, 31, 32, 33, 64, 1000):
+            field = _create_string_field(self._tc)
+            value = self._make_value(length)
+            field.value = value
+            self.assertEqual(field, value)
+            self.assertEqual(len(field), length)
+
+    def test_append_across_inline_buf(self):
+        field = _create_string_field(self._tc)
+        value = ''
+
+        for length in (20, 11, 1, 40, 1000, 3):
+            to_append = self._make_value(length)
+            field += to_append
+            value += to_append
+            self.assertEqual(field, value)
+
+    def test_assign_after_long_value(self):
+        field = _create_string_field(self._tc)
+        long_value = self._make_value(100)
+        field.value = long_value
+        field.value = 'short'
+        self.assertEqual(field, 'short')
+        self.assertEqual(len(field), 5)
+        field.value = ''
+        self.assertEqual(field, '')
+        field += 'meow'
+        self.assertEqual(field, 'meow')
+        field.value = long_value * 3
+        self.assertEqual(field, long_value * 3)
+
+    def test_assign_multibyte_across_inline_buf(self):
+        # 2-byte UTF-8 sequences: 15 of them fit the inline buffer
+        for length in (15, 16, 17):
+            field = _create_string_field(self._tc)
+            value = 'é' * length
+            field.value = value
+            self.assertEqual(field, value)
+
+            # The length of a string field is in bytes
+            self.assertEqual(len(field), 2 * length)
+
 
 class _TestArrayFieldCommon:
     def _modify_def(self):
@@ -1867,6 +1916,54 @@ class DynamicArrayFieldTestCase(_TestArrayFieldCommon, unittest.TestCase):
         with self.assertRaises(TypeError):
             self._def.length = 'cheval'
 
+    def test_grow_keeps_elements(self):
+        values = list(self._def_value)
+
+        # Many growth steps, some of them within the same block
+        for length in (4, 5, 7, 12, 13, 50, 51, 300, 1000):
+            self._def.length = length
+
+            for i in range(len(values), length):
+                self._def[i] = i * 3
+                values.append(i * 3)
+
+            self.assertEqual(self._def, values)
+
+    def test_shrink_then_grow(self):
+        values = list(range(100))
+        self._def.value = values
+        self._def.length = 10
+        self.assertEqual(self._def, values[:10])
+        self._def.length = 100
+        self.assertEqual([self._def[i] for i in range(10)], values[:10])
+        values = list(range(200, 400))
+        self._def.value = values
+        self.assertEqual(self._def, values)
+
+    def test_grow_compound_elements(self):
+        inner_fc = self._tc.create_dynamic_array_field_class(
+            self._tc.create_signed_integer_field_class(32)
+        )
+        elem_fc = self._tc.create_structure_field_class()
+        elem_fc.append_member('x', self._tc.create_signed_integer_field_class(32))
+        elem_fc.append_member('s', self._tc.create_string_field_class())
+        elem_fc.append_member('inner', inner_fc)
+        field = _create_field(
+            self._tc, self._tc.create_dynamic_array_field_class(elem_fc)
+        )
+
+        for length in (1, 2, 3, 17, 64):
+            values = [
+                {
+                    'x': -i,
+                    's': 'elem {}'.format(i) * (i % 5),
+                    'inner': list(range(i)),
+                }
+                for i in range(length)
+            ]
+            field.value = values
+            self.assertEqual(field, values)
+
 
 class StructureFieldTestCase(unittest.TestCase):
     @staticmethod
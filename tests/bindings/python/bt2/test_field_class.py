@@ -387,6 +387,74 @@ class _EnumerationFieldClassTestCase(_TestIntegerFieldClassProps):
         expected_labels = set(['a', 'c'])
         self.assertEqual(labels, expected_labels)
 
+    # Adds the mappings `mappings`, a list of (label, list of (lower,
+    # upper)), to the field class under test.
+    def _add_mappings(self, mappings):
+        for label, ranges in mappings:
+            self._fc.add_mapping(label, self._RANGE_SET_CLASS(ranges))
+
+    # Checks that the labels of the mappings for each value of `values`
+    # are the ones of `mappings`, in mapping order.
+    def _check_mappings_for_values(self, mappings, values):
+        for value in values:
+            expected_labels = [
+                label
+                for label, ranges in mappings
+                if any(lower <= value <= upper for lower, upper in ranges)
+            ]
+            labels = [mapping.label for mapping in self._fc.mappings_for_value(value)]
+            self.assertEqual(labels, expected_labels, 'value {}'.format(value))
+
+    def _spec_mappings(self):
+        return [
+            ('c', [(r.lower, r.upper) for r in self._ranges3]),
+            ('a', [(r.lower, r.upper) for r in self._ranges1]),
+            ('b', [(r.lower, r.upper) for r in self._ranges2]),
+        ]
+
+    def test_find_by_value_mapping_order(self):
+        mappings = self._spec_mappings()
+        self._add_mappings(mappings)
+        self._check_mappings_for_values(mappings, self._lookup_values)
+
+    def test_find_by_value_after_add_mapping(self):
+        mappings = self._spec_mappings()
+        self._add_mappings(mappings[:2])
+        self._check_mappings_for_values(mappings[:2], self._lookup_values)
+        self._add_mappings(mappings[2:])
+        self._check_mappings_for_values(mappings, self._lookup_values)
+
+    def test_find_by_value_no_mappings(self):
+        self.assertEqual(self._fc.mappings_for_value(self._lookup_values[0]), [])
+
+    def test_find_by_value_domain_bounds(self):
+        dmin, dmax = self._DOMAIN_MIN, self._DOMAIN_MAX
+        mappings = [
+            ('min', [(dmin, dmin)]),
+            ('all', [(dmin, dmax)]),
+            ('max', [(dmax, dmax)]),
+            ('low', [(dmin, dmin + 10)]),
+            ('high', [(dmax - 10, dmax)]),
+        ]
+        self._add_mappings(mappings)
+        self._check_mappings_for_values(
+            mappings,
+            [dmin, dmin + 1, dmin + 10, dmin + 11, 0, dmax - 11, dmax - 10, dmax - 1, dmax],
+        )
+
+    def test_find_by_value_many_overlapping(self):
+        # Enough overlapping mappings for the lookup to fall back to
+        # scanning the mappings.
+        first = self._lookup_values[0]
+        mappings = [
+            ('m{}'.format(i), [(first + i, first + i + 300)]) for i in range(300)
+        ]
+        self._add_mappings(mappings)
+        self._check_mappings_for_values(mappings, range(first, first + 602, 7))
+        self._check_mappings_for_values(
+            mappings, [first, first + 299, first + 300, first + 599, first + 600, first + 601]
+        )
+
 
 class UnsignedEnumerationFieldClassTestCase(
     _EnumerationFieldClassTestCase, _TestFieldClass, unittest.TestCase
@@ -394,6 +462,8 @@ class UnsignedEnumerationFieldClassTestCase(
     _MAPPING_CLASS = bt2_field_class._UnsignedEnumerationFieldClassMappingConst
     _RANGE_SET_CLASS = bt2.UnsignedIntegerRangeSet
     _CONST_RANGE_SET_CLASS = bt2._UnsignedIntegerRangeSetConst
+    _DOMAIN_MIN = 0
+    _DOMAIN_MAX = 2 ** 64 - 1
 
     def _spec_set_up(self):
         self._ranges1 = bt2.UnsignedIntegerRangeSet([(1, 4), (18, 47)])
@@ -401,6 +471,7 @@ class UnsignedEnumerationFieldClassTestCase(
         self._ranges3 = bt2.UnsignedIntegerRangeSet([(8, 22), (48, 99)])
         self._inval_ranges = bt2.SignedIntegerRangeSet([(-8, -5), (48, 1928)])
         self._value_in_range_1_and_3 = 20
+        self._lookup_values = list(range(0, 110))
 
     @staticmethod
     def _const_value_setter(field):
@@ -424,6 +495,8 @@ class SignedEnumerationFieldClassTestCase(
     _MAPPING_CLASS = bt2_field_class._SignedEnumerationFieldClassMappingConst
     _RANGE_SET_CLASS = bt2.SignedIntegerRangeSet
     _CONST_RANGE_SET_CLASS = bt2._SignedIntegerRangeSetConst
+    _DOMAIN_MIN = -(2 ** 63)
+    _DOMAIN_MAX = 2 ** 63 - 1
 
     def _spec_set_up(self):
         self._ranges1 = bt2.SignedIntegerRangeSet([(-10, -4), (18, 47)])
@@ -431,6 +504,7 @@ class SignedEnumerationFieldClassTestCase(
         self._ranges3 = bt2.SignedIntegerRangeSet([(-100, -1), (8, 16), (48, 99)])
         self._inval_ranges = bt2.UnsignedIntegerRangeSet([(8, 16), (48, 99)])
         self._value_in_range_1_and_3 = -7
+        self._lookup_values = list(range(-110, 110))
 
     @staticmethod
     def _const_value_setter(field):
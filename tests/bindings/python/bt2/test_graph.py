@@ -3,6 +3,7 @@
 # Copyright (C) 2019 EfficiOS Inc.
 #
 
+import threading
 import unittest
 import bt2
 
@@ -43,6 +44,7 @@ class GraphTestCase(unittest.TestCase):
 
     def test_create_known_mip_version(self):
         bt2.Graph(0)
+        bt2.Graph(1)
 
     def test_create_invalid_mip_version_type(self):
         with self.assertRaises(TypeError):
@@ -50,7 +52,7 @@ class GraphTestCase(unittest.TestCase):
 
     def test_create_unknown_mip_version(self):
         with self.assertRaisesRegex(ValueError, 'unknown MIP version'):
-            bt2.Graph(1)
+            bt2.Graph(2)
 
     def test_default_interrupter(self):
         interrupter = self._graph.default_interrupter
@@ -374,6 +376,157 @@ class GraphTestCase(unittest.TestCase):
         self._graph.connect_ports(src.output_ports['out'], sink.input_ports['in'])
         self._graph.run()
 
+    def _add_profiled_components(self):
+        class MyIter(_MyIter):
+            def __next__(self):
+                if self._at == 9:
+                    raise StopIteration
+
+                if self._at == 0:
+                    msg = self._create_stream_beginning_message(self._stream)
+                elif self._at == 1:
+                    msg = self._create_packet_beginning_message(self._packet)
+                elif self._at == 7:
+                    msg = self._create_packet_end_message(self._packet)
+                elif self._at == 8:
+                    msg = self._create_stream_end_message(self._stream)
+                else:
+                    msg = self._create_event_message(self._ec, self._packet)
+
+                self._at += 1
+                return msg
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._input_port = self._add_input_port('in')
+
+            def _user_consume(comp_self):
+                next(comp_self._msg_iter)
+
+            def _user_graph_is_configured(self):
+                self._msg_iter = self._create_message_iterator(self._input_port)
+
+        src = self._graph.add_component(MySource, 'src')
+        sink = self._graph.add_component(MySink, 'sink')
+        self._graph.connect_ports(src.output_ports['out'], sink.input_ports['in'])
+
+    def test_profile(self):
+        self._add_profiled_components()
+        self._graph.enable_profiling()
+        self._graph.run()
+        profile = self._graph.profile
+        self.assertEqual(len(profile), 2)
+        entries = {str(entry['type']): entry for entry in profile}
+
+        iter_entry = entries['message-iterator']
+        self.assertEqual(iter_entry['component-name'], 'src')
+        self.assertEqual(iter_entry['port-name'], 'out')
+        self.assertEqual(iter_entry['message-count'], 9)
+        self.assertGreater(iter_entry['call-count'], 0)
+        self.assertEqual(
+            iter_entry['sampled-call-count'], iter_entry['call-count']
+        )
+        self.assertLessEqual(
+            iter_entry['self-wall-time-ns'], iter_entry['wall-time-ns']
+        )
+
+        sink_entry = entries['sink']
+        self.assertEqual(sink_entry['component-name'], 'sink')
+        self.assertNotIn('port-name', sink_entry)
+
+        # one call per message, plus the one which ends
+        self.assertEqual(sink_entry['call-count'], 10)
+        self.assertEqual(sink_entry['sampled-call-count'], 10)
+        self.assertLessEqual(
+            sink_entry['self-wall-time-ns'], sink_entry['wall-time-ns']
+        )
+
+    def test_profile_sampled(self):
+        self._add_profiled_components()
+        self._graph.enable_profiling(4)
+        self._graph.run()
+        entries = {str(entry['type']): entry for entry in self._graph.profile}
+        sink_entry = entries['sink']
+        self.assertEqual(sink_entry['call-count'], 10)
+
+        # calls 0, 4, and 8
+        self.assertEqual(sink_entry['sampled-call-count'], 3)
+
+    def test_profile_not_enabled(self):
+        with self.assertRaisesRegex(RuntimeError, 'not enabled'):
+            self._graph.profile
+
+    def test_enable_profiling_invalid_sampling_period(self):
+        with self.assertRaises(ValueError):
+            self._graph.enable_profiling(0)
+
+    def test_enable_profiling_after_run(self):
+        self._add_profiled_components()
+        self._graph.run()
+
+        with self.assertRaisesRegex(RuntimeError, 'already ran'):
+            self._graph.enable_profiling()
+
+    def test_run_in_threads(self):
+        # The graph releases the GIL while running: Python component
+        # methods, called from other threads, must reacquire it.
+        class MyIter(_MyIter):
+            def __next__(self):
+                if self._at == 1000:
+                    raise StopIteration
+
+                if self._at == 0:
+                    msg = self._create_stream_beginning_message(self._stream)
+                elif self._at == 1:
+                    msg = self._create_packet_beginning_message(self._packet)
+                elif self._at == 998:
+                    msg = self._create_packet_end_message(self._packet)
+                elif self._at == 999:
+                    msg = self._create_stream_end_message(self._stream)
+                else:
+                    msg = self._create_event_message(self._ec, self._packet)
+
+                self._at += 1
+                return msg
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._input_port = self._add_input_port('in')
+                self._counts = obj
+
+            def _user_consume(self):
+                next(self._msg_iter)
+                self._counts[0] += 1
+
+            def _user_graph_is_configured(self):
+                self._msg_iter = self._create_message_iterator(self._input_port)
+
+        def run(counts):
+            graph = bt2.Graph()
+            src = graph.add_component(MySource, 'src')
+            sink = graph.add_component(MySink, 'sink', obj=counts)
+            graph.connect_ports(src.output_ports['out'], sink.input_ports['in'])
+            graph.run()
+
+        all_counts = [[0] for _ in range(4)]
+        threads = [threading.Thread(target=run, args=(c,)) for c in all_counts]
+
+        for thread in threads:
+            thread.start()
+
+        for thread in threads:
+            thread.join()
+
+        self.assertEqual(all_counts, [[1000]] * 4)
+
     def test_run_once(self):
         class MyIter(_MyIter):
             pass
@@ -401,6 +554,74 @@ class GraphTestCase(unittest.TestCase):
 
         self.assertEqual(run_count, 1)
 
+    def test_run_for(self):
+        class MyIter(_MyIter):
+            pass
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._input_port = self._add_input_port('in')
+
+            def _user_consume(comp_self):
+                nonlocal run_count
+                run_count += 1
+
+        run_count = 0
+        src = self._graph.add_component(MySource, 'src')
+        sink = self._graph.add_component(MySink, 'sink')
+        self._graph.connect_ports(src.output_ports['out'], sink.input_ports['in'])
+
+        with self.assertRaises(bt2.TryAgain):
+            self._graph.run_for(1000)
+
+        self.assertGreater(run_count, 0)
+
+    def test_sink_component_consume_weight(self):
+        class MyIter(_MyIter):
+            pass
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+                self._add_output_port('out2')
+
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._input_port = self._add_input_port('in')
+
+            def _user_consume(comp_self):
+                consumed.append(comp_self.name)
+
+        consumed = []
+        src = self._graph.add_component(MySource, 'src')
+        sink_a = self._graph.add_component(MySink, 'a')
+        sink_b = self._graph.add_component(MySink, 'b')
+        self._graph.connect_ports(src.output_ports['out'], sink_a.input_ports['in'])
+        self._graph.connect_ports(src.output_ports['out2'], sink_b.input_ports['in'])
+        self._graph.set_sink_component_consume_weight(sink_a, 3)
+
+        for _ in range(8):
+            self._graph.run_once()
+
+        self.assertEqual(consumed, ['a', 'a', 'a', 'b', 'a', 'a', 'a', 'b'])
+
+    def test_sink_component_consume_weight_zero(self):
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._add_input_port('in')
+
+            def _user_consume(comp_self):
+                pass
+
+        sink = self._graph.add_component(MySink, 'sink')
+
+        with self.assertRaises(ValueError):
+            self._graph.set_sink_component_consume_weight(sink, 0)
+
     def test_run_once_stops(self):
         class MyIter(_MyIter):
             pass
@@ -277,6 +277,50 @@ class UserMessageIteratorTestCase(unittest.TestCase):
         root_cause = ctx.exception[0]
         self.assertIn("TypeError: 'int' is not a 'bool' object", root_cause.message)
 
+    def test_config_max_batch_size(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, port):
+                config.max_batch_size = 1024
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        graph = _create_graph(MySource, SimpleSink)
+        graph.run()
+
+    def test_config_max_batch_size_wrong_type(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, port):
+                config.max_batch_size = 'salut'
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        graph = _create_graph(MySource, SimpleSink)
+        with self.assertRaises(bt2._Error) as ctx:
+            graph.run()
+
+        root_cause = ctx.exception[0]
+        self.assertIn("TypeError", root_cause.message)
+
+    def test_config_max_batch_size_out_of_range(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, port):
+                config.max_batch_size = 0
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                self._add_output_port('out')
+
+        graph = _create_graph(MySource, SimpleSink)
+        with self.assertRaises(bt2._Error) as ctx:
+            graph.run()
+
+        root_cause = ctx.exception[0]
+        self.assertIn("ValueError", root_cause.message)
+
     def test_component(self):
         class MyIter(bt2._UserMessageIterator):
             def __init__(self, config, self_port_output):
@@ -375,6 +419,147 @@ class UserMessageIteratorTestCase(unittest.TestCase):
         self.assertIs(type(msg_ev2), bt2._EventMessageConst)
         self.assertEqual(msg_ev1.addr, msg_ev2.addr)
 
+    @staticmethod
+    def _create_batch_source(next_batch):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self, config, port):
+                tc, sc, ec = port.user_data
+                stream = tc().create_stream(sc)
+                self._msgs = [self._create_stream_beginning_message(stream)]
+                self._msgs += [self._create_event_message(ec, stream) for _ in range(5)]
+                self._msgs.append(self._create_stream_end_message(stream))
+
+            def _user_next_batch(self, capacity):
+                return next_batch(self, capacity)
+
+        class MySource(bt2._UserSourceComponent, message_iterator_class=MyIter):
+            def __init__(self, config, params, obj):
+                tc = self._create_trace_class()
+                sc = tc.create_stream_class()
+                ec = sc.create_event_class()
+                self._add_output_port('out', (tc, sc, ec))
+
+        return MySource
+
+    def test_next_batch(self):
+        capacities = []
+
+        def next_batch(it, capacity):
+            capacities.append(capacity)
+
+            if not it._msgs:
+                raise StopIteration
+
+            # Return a tuple to check that any sequence works.
+            msgs = tuple(it._msgs[:2])
+            del it._msgs[:2]
+            return msgs
+
+        graph = bt2.Graph()
+        src = graph.add_component(self._create_batch_source(next_batch), 'src')
+        it = TestOutputPortMessageIterator(graph, src.output_ports['out'])
+        types = [type(msg) for msg in it]
+
+        self.assertEqual(
+            types,
+            [bt2._StreamBeginningMessageConst]
+            + [bt2._EventMessageConst] * 5
+            + [bt2._StreamEndMessageConst],
+        )
+
+        # 7 messages, 2 per batch, and the last call which stops
+        self.assertEqual(len(capacities), 5)
+
+        for capacity in capacities:
+            self.assertGreater(capacity, 0)
+
+    def test_next_batch_wrong_type_raises(self):
+        def next_batch(it, capacity):
+            return [it._msgs.pop(0), 23]
+
+        graph = bt2.Graph()
+        src = graph.add_component(self._create_batch_source(next_batch), 'src')
+        it = TestOutputPortMessageIterator(graph, src.output_ports['out'])
+
+        with self.assertRaises(bt2._Error) as ctx:
+            next(it)
+
+        self.assertIn(
+            '`_user_next_batch()` returned a `int` object at index 1',
+            ctx.exception[0].message,
+        )
+
+    def test_next_batch_empty_raises(self):
+        def next_batch(it, capacity):
+            return []
+
+        graph = bt2.Graph()
+        src = graph.add_component(self._create_batch_source(next_batch), 'src')
+        it = TestOutputPortMessageIterator(graph, src.output_ports['out'])
+
+        with self.assertRaises(bt2._Error) as ctx:
+            next(it)
+
+        self.assertIn(
+            '`_user_next_batch()` returned 0 messages', ctx.exception[0].message
+        )
+
+    def test_input_port_next_batch(self):
+        def next_batch(it, capacity):
+            if not it._msgs:
+                raise StopIteration
+
+            msgs = it._msgs[:3]
+            del it._msgs[:3]
+            return msgs
+
+        batches = []
+        res = {'types': []}
+
+        class MySink(bt2._UserSinkComponent):
+            def __init__(self, config, params, obj):
+                self._add_input_port('in')
+
+            def _user_graph_is_configured(self):
+                self._msg_iter = self._create_message_iterator(self._input_ports['in'])
+
+            def _user_consume(self):
+                batch = self._msg_iter.next_batch()
+                batches.append(batch)
+                res['types'].append([type(msg) for msg in batch])
+
+                if len(batches) == 2:
+                    # Previous batch is not valid anymore
+                    res['first_batch_valid'] = True
+
+                    try:
+                        batches[0][0]
+                    except RuntimeError:
+                        res['first_batch_valid'] = False
+
+                    # Negative index and slice
+                    res['last'] = type(batch[-1])
+                    res['slice_types'] = [type(msg) for msg in batch[1:]]
+
+        graph = bt2.Graph()
+        src = graph.add_component(self._create_batch_source(next_batch), 'src')
+        snk = graph.add_component(MySink, 'snk')
+        graph.connect_ports(src.output_ports['out'], snk.input_ports['in'])
+        graph.run()
+
+        self.assertEqual(
+            res['types'],
+            [
+                [bt2._StreamBeginningMessageConst] + [bt2._EventMessageConst] * 2,
+                [bt2._EventMessageConst] * 3,
+                [bt2._StreamEndMessageConst],
+            ],
+        )
+        self.assertFalse(res['first_batch_valid'])
+        self.assertIs(res['last'], bt2._EventMessageConst)
+        self.assertEqual(res['slice_types'], [bt2._EventMessageConst] * 2)
+        self.assertEqual(len(batches[1]), 3)
+
     # Try consuming many times from an iterator that always returns TryAgain.
     # This verifies that we are not missing an incref of Py_None, making the
     # refcount of Py_None reach 0.
@@ -1112,5 +1297,201 @@ class UserMessageIteratorSeekNsFromOriginTestCase(unittest.TestCase):
         self.assertEqual(actual_ns_from_origin, 17)
 
 
+# Sets up a graph of which the sink calls `scenario` with its message
+# iterator once, the upstream message iterator being able to seek its
+# beginning and forward, but not a given time by itself.
+#
+# The source message iterator returns a stream beginning message, 100
+# event messages with the default clock snapshots 10, 20, ..., 1000,
+# and a stream end message.
+#
+# Returns the graph and a list of which the single element is the
+# number of times the library called the "seek beginning" method.
+def _setup_auto_seek_test(scenario):
+    seek_beginning_count = [0]
+
+    class MySourceIter(bt2._UserMessageIterator):
+        def __init__(self, config, port):
+            sc, ec = port.user_data
+            trace = sc.trace_class()
+            stream = trace.create_stream(sc)
+            self._msgs = [self._create_stream_beginning_message(stream)]
+
+            for i in range(1, 101):
+                self._msgs.append(
+                    self._create_event_message(ec, stream, default_clock_snapshot=i * 10)
+                )
+
+            self._msgs.append(self._create_stream_end_message(stream))
+            self._at = 0
+            config.can_seek_forward = True
+
+        def __next__(self):
+            if self._at < len(self._msgs):
+                msg = self._msgs[self._at]
+                self._at += 1
+                return msg
+            else:
+                raise StopIteration
+
+        def _user_seek_beginning(self):
+            seek_beginning_count[0] += 1
+            self._at = 0
+
+    class MySource(bt2._UserSourceComponent, message_iterator_class=MySourceIter):
+        def __init__(self, config, params, obj):
+            tc = self._create_trace_class()
+            cc = self._create_clock_class()
+            sc = tc.create_stream_class(default_clock_class=cc)
+            ec = sc.create_event_class()
+            self._add_output_port('out', (sc, ec))
+
+    class MySink(bt2._UserSinkComponent):
+        def __init__(self, config, params, obj):
+            self._add_input_port('in')
+
+        def _user_graph_is_configured(self):
+            self._msg_iter = self._create_message_iterator(self._input_ports['in'])
+
+        def _user_consume(self):
+            scenario(self._msg_iter)
+            raise bt2.Stop
+
+    return _create_graph(MySource, MySink), seek_beginning_count
+
+
+# Returns a description of the messages `msgs`: their type name and,
+# for an event message, its default clock snapshot value.
+def _describe_msgs(msgs):
+    descrs = []
+
+    for msg in msgs:
+        if type(msg) is bt2._EventMessageConst:
+            descrs.append(('event', msg.default_clock_snapshot.value))
+        elif type(msg) is bt2._StreamBeginningMessageConst:
+            descrs.append(('stream-beginning',))
+        elif type(msg) is bt2._StreamEndMessageConst:
+            descrs.append(('stream-end',))
+        else:
+            descrs.append((type(msg).__name__,))
+
+    return descrs
+
+
+def _expected_msgs_after_seek(ns_from_origin):
+    return (
+        [('stream-beginning',)]
+        + [('event', i * 10) for i in range(1, 101) if i * 10 >= ns_from_origin]
+        + [('stream-end',)]
+    )
+
+
+class UserMessageIteratorAutoSeekTestCase(unittest.TestCase):
+    def _run(self, scenario):
+        graph, seek_beginning_count = _setup_auto_seek_test(scenario)
+        graph.run()
+        return seek_beginning_count[0]
+
+    def test_seek_forward_from_current_position(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(300)
+
+            for _ in range(5):
+                next(msg_iter)
+
+            msg_iter.seek_ns_from_origin(800)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 1)
+        self.assertEqual(msgs, _expected_msgs_after_seek(800))
+
+    def test_seek_same_time_again(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(300)
+            msg_iter.seek_ns_from_origin(300)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 1)
+        self.assertEqual(msgs, _expected_msgs_after_seek(300))
+
+    def test_seek_forward_without_getting_messages(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(300)
+            msg_iter.seek_ns_from_origin(600)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 1)
+        self.assertEqual(msgs, _expected_msgs_after_seek(600))
+
+    def test_seek_backward_seeks_beginning(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(800)
+
+            for _ in range(3):
+                next(msg_iter)
+
+            msg_iter.seek_ns_from_origin(300)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 2)
+        self.assertEqual(msgs, _expected_msgs_after_seek(300))
+
+    def test_seek_forward_after_seek_beginning(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(300)
+            next(msg_iter)
+            msg_iter.seek_beginning()
+
+            for _ in range(5):
+                next(msg_iter)
+
+            msg_iter.seek_ns_from_origin(700)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 2)
+        self.assertEqual(msgs, _expected_msgs_after_seek(700))
+
+    def test_seek_forward_many_times(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+
+            for ns_from_origin in range(250, 1001, 250):
+                msg_iter.seek_ns_from_origin(ns_from_origin)
+                msgs += _describe_msgs([next(msg_iter), next(msg_iter)])
+
+        msgs = []
+        self.assertEqual(self._run(scenario), 1)
+        self.assertEqual(
+            msgs,
+            [
+                descr
+                for ns in range(250, 1001, 250)
+                for descr in [('stream-beginning',), ('event', ns)]
+            ],
+        )
+
+    def test_seek_after_last_message(self):
+        def scenario(msg_iter):
+            nonlocal msgs
+            msg_iter.seek_ns_from_origin(300)
+            next(msg_iter)
+            msg_iter.seek_ns_from_origin(5000)
+            msgs = _describe_msgs(msg_iter)
+
+        msgs = None
+        self.assertEqual(self._run(scenario), 1)
+        self.assertEqual(msgs, [])
+
+
 if __name__ == '__main__':
     unittest.main()
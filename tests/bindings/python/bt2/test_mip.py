@@ -36,6 +36,28 @@ class MipTestCase(unittest.TestCase):
         version = bt2.get_greatest_operative_mip_version(descriptors)
         self.assertEqual(version, 0)
 
+    def test_get_greatest_operative_mip_version_1(self):
+        class Source1(
+            bt2._UserSourceComponent, message_iterator_class=bt2._UserMessageIterator
+        ):
+            @classmethod
+            def _user_get_supported_mip_versions(cls, params, obj, log_level):
+                return [0, 1]
+
+        class Source2(
+            bt2._UserSourceComponent, message_iterator_class=bt2._UserMessageIterator
+        ):
+            @classmethod
+            def _user_get_supported_mip_versions(cls, params, obj, log_level):
+                return [[0, 5]]
+
+        descriptors = [
+            bt2.ComponentDescriptor(Source1),
+            bt2.ComponentDescriptor(Source2),
+        ]
+        version = bt2.get_greatest_operative_mip_version(descriptors)
+        self.assertEqual(version, 1)
+
     def test_get_greatest_operative_mip_version_no_match(self):
         class Source1(
             bt2._UserSourceComponent, message_iterator_class=bt2._UserMessageIterator
@@ -99,7 +121,7 @@ class MipTestCase(unittest.TestCase):
             bt2.get_greatest_operative_mip_version(descriptors, 12345)
 
     def test_get_maximal_mip_version(self):
-        self.assertEqual(bt2.get_maximal_mip_version(), 0)
+        self.assertEqual(bt2.get_maximal_mip_version(), 1)
 
 
 if __name__ == '__main__':
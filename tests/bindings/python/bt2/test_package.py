@@ -155,6 +155,7 @@ _public_names = [
     'AutoSourceComponentSpec',
     'BoolValue',
     'ClockClassOffset',
+    'CompiledFieldPath',
     'ComponentClassType',
     'ComponentDescriptor',
     'ComponentSpec',
@@ -173,6 +174,7 @@ _public_names = [
     'MapValue',
     'plugin_component_class',
     'QueryExecutor',
+    'read_columns_sharded',
     'RealValue',
     'register_plugin',
     'set_global_logging_level',
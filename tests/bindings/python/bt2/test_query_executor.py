@@ -3,6 +3,8 @@
 # Copyright (C) 2019 EfficiOS Inc.
 #
 
+import os
+import tempfile
 import unittest
 import bt2
 import re
@@ -285,6 +287,104 @@ class QueryExecutorTestCase(unittest.TestCase):
 
         del test_priv_query_exec
 
+    def test_uses_result_cache(self):
+        class MySink(bt2._UserSinkComponent):
+            def _user_consume(self):
+                pass
+
+        query_exec = bt2.QueryExecutor(MySink, 'obj')
+        self.assertFalse(query_exec.uses_result_cache)
+        query_exec.uses_result_cache = True
+        self.assertTrue(query_exec.uses_result_cache)
+
+    def test_uses_result_cache_invalid_type(self):
+        class MySink(bt2._UserSinkComponent):
+            def _user_consume(self):
+                pass
+
+        query_exec = bt2.QueryExecutor(MySink, 'obj')
+
+        with self.assertRaises(TypeError):
+            query_exec.uses_result_cache = 1
+
+    @staticmethod
+    def _create_cacheable_sink_cls(query_count, dep_path=None, cacheable=True):
+        class MySink(bt2._UserSinkComponent):
+            def _user_consume(self):
+                pass
+
+            @classmethod
+            def _user_query(cls, priv_query_exec, obj, params, method_obj):
+                query_count[0] += 1
+
+                if cacheable:
+                    priv_query_exec.set_result_is_cacheable()
+
+                if dep_path is not None:
+                    priv_query_exec.add_result_dependency_path(dep_path)
+
+                return [obj, query_count[0]]
+
+        return MySink
+
+    @staticmethod
+    def _query(comp_cls, obj, params, uses_result_cache=True):
+        query_exec = bt2.QueryExecutor(comp_cls, obj, params)
+        query_exec.uses_result_cache = uses_result_cache
+        return query_exec.query()
+
+    def test_query_result_cache(self):
+        query_count = [0]
+        comp_cls = self._create_cacheable_sink_cls(query_count)
+        self.assertEqual(self._query(comp_cls, 'obj', {'a': [1, 2]}), ['obj', 1])
+        self.assertEqual(self._query(comp_cls, 'obj', {'a': [1, 2]}), ['obj', 1])
+        self.assertEqual(query_count[0], 1)
+
+        # Different object name and parameters
+        self.assertEqual(self._query(comp_cls, 'other', {'a': [1, 2]}), ['other', 2])
+        self.assertEqual(self._query(comp_cls, 'obj', {'a': [1, 3]}), ['obj', 3])
+        self.assertEqual(query_count[0], 3)
+
+    def test_query_result_cache_not_used(self):
+        query_count = [0]
+        comp_cls = self._create_cacheable_sink_cls(query_count)
+        self._query(comp_cls, 'obj', None)
+        self._query(comp_cls, 'obj', None, False)
+        self.assertEqual(query_count[0], 2)
+
+    def test_query_result_cache_not_cacheable(self):
+        query_count = [0]
+        comp_cls = self._create_cacheable_sink_cls(query_count, cacheable=False)
+        self._query(comp_cls, 'obj', None)
+        self._query(comp_cls, 'obj', None)
+        self.assertEqual(query_count[0], 2)
+
+    def test_query_result_cache_dependency_path(self):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            path = os.path.join(tmp_dir, 'dep')
+
+            with open(path, 'w') as f:
+                f.write('hello')
+
+            # Results with recently modified dependencies are not cached.
+            os.utime(path, (0, 0))
+            query_count = [0]
+            comp_cls = self._create_cacheable_sink_cls(query_count, path)
+            self._query(comp_cls, 'obj', None)
+            self._query(comp_cls, 'obj', None)
+            self.assertEqual(query_count[0], 1)
+
+            with open(path, 'a') as f:
+                f.write(' world')
+
+            os.utime(path, (0, 0))
+            self._query(comp_cls, 'obj', None)
+            self.assertEqual(query_count[0], 2)
+
+            os.remove(path)
+            self._query(comp_cls, 'obj', None)
+            self.assertEqual(query_count[0], 3)
+
 
 if __name__ == '__main__':
     unittest.main()
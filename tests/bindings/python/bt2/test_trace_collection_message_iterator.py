@@ -3,6 +3,7 @@
 # Copyright (C) 2019 EfficiOS Inc.
 #
 
+import array
 import unittest
 import datetime
 import bt2
@@ -394,6 +395,155 @@ class TraceCollectionMessageIteratorTestCase(unittest.TestCase):
             )
 
 
+class _ColumnsIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        comp = self._component
+        tc = comp._create_trace_class()
+        cc = comp._create_clock_class(frequency=1000)
+        sc = tc.create_stream_class(default_clock_class=cc)
+        payload_fc = tc.create_structure_field_class()
+        payload_fc += [
+            ('my_int', tc.create_signed_integer_field_class(32)),
+            ('my_bool', tc.create_bool_field_class()),
+        ]
+        inner_fc = tc.create_structure_field_class()
+        inner_fc += [('my_uint', tc.create_unsigned_integer_field_class(16))]
+        other_payload_fc = tc.create_structure_field_class()
+        other_payload_fc += [('inner', inner_fc)]
+        ec = sc.create_event_class(
+            name='my-event', id=7, payload_field_class=payload_fc
+        )
+        other_ec = sc.create_event_class(
+            name='other-event', id=9, payload_field_class=other_payload_fc
+        )
+        stream = tc().create_stream(sc, id=3)
+        self._msgs = [self._create_stream_beginning_message(stream)]
+
+        for i in range(comp._event_count):
+            msg = self._create_event_message(ec, stream, i)
+            msg.event.payload_field['my_int'] = -i
+            msg.event.payload_field['my_bool'] = i % 2 == 1
+            self._msgs.append(msg)
+
+            if i % 10 == 0:
+                msg = self._create_event_message(other_ec, stream, i)
+                msg.event.payload_field['inner']['my_uint'] = i
+                self._msgs.append(msg)
+
+        self._msgs.append(self._create_stream_end_message(stream))
+        self._msgs.reverse()
+
+    def __next__(self):
+        if not self._msgs:
+            raise StopIteration
+
+        return self._msgs.pop()
+
+
+class _ColumnsSrc(bt2._UserSourceComponent, message_iterator_class=_ColumnsIter):
+    def __init__(self, config, params, obj):
+        self._event_count = obj
+        self._add_output_port('out')
+
+
+class TraceCollectionColumnReaderTestCase(unittest.TestCase):
+    @staticmethod
+    def _create_msg_iter(event_count):
+        return bt2.TraceCollectionMessageIterator(
+            bt2.ComponentSpec(_ColumnsSrc, obj=event_count)
+        )
+
+    @staticmethod
+    def _read_all(reader, chunk_size):
+        columns = [[] for _ in range(reader.column_count)]
+
+        while True:
+            buffers = [array.array('q', [0] * chunk_size) for _ in columns]
+            count = reader.read(buffers)
+
+            for column, buf in zip(columns, buffers):
+                column += buf[:count]
+
+            if count < chunk_size:
+                return columns
+
+    def test_read(self):
+        reader = self._create_msg_iter(250).column_reader(
+            [
+                'timestamp',
+                'event_class_id',
+                'stream_id',
+                (bt2.FieldPathScope.EVENT_PAYLOAD, 'my_int'),
+                (bt2.FieldPathScope.EVENT_PAYLOAD, 'my_bool'),
+            ]
+        )
+        columns = self._read_all(reader, 64)
+        self.assertEqual(columns[0], [i * 1000000 for i in range(250)])
+        self.assertEqual(columns[1], [7] * 250)
+        self.assertEqual(columns[2], [3] * 250)
+        self.assertEqual(columns[3], [-i for i in range(250)])
+        self.assertEqual(columns[4], [i % 2 for i in range(250)])
+
+        # Ended
+        self.assertEqual(reader.read([array.array('q', [0])] * 5), 0)
+
+    def test_read_nested_field(self):
+        reader = self._create_msg_iter(250).column_reader(
+            [
+                'event_class_id',
+                (bt2.FieldPathScope.EVENT_PAYLOAD, 'inner', 'my_uint'),
+            ]
+        )
+        columns = self._read_all(reader, 7)
+        self.assertEqual(columns[0], [9] * 25)
+        self.assertEqual(columns[1], list(range(0, 250, 10)))
+
+    def test_read_event_class_names(self):
+        reader = self._create_msg_iter(250).column_reader(
+            ['timestamp'], event_class_names=['other-event']
+        )
+        columns = self._read_all(reader, 100)
+        self.assertEqual(columns[0], [i * 1000000 for i in range(0, 250, 10)])
+
+    def test_read_unsigned_buffer(self):
+        reader = self._create_msg_iter(3).column_reader(['event_class_id'])
+        buf = array.array('Q', [0] * 8)
+        self.assertEqual(reader.read([buf]), 4)
+        self.assertEqual(buf[:4].tolist(), [7, 9, 7, 7])
+
+    def test_read_wrong_buffer_type(self):
+        reader = self._create_msg_iter(3).column_reader(['timestamp'])
+
+        with self.assertRaisesRegex(
+            TypeError, 'expecting a buffer of 64-bit integers'
+        ):
+            reader.read([array.array('i', [0] * 8)])
+
+    def test_read_wrong_buffer_count(self):
+        reader = self._create_msg_iter(3).column_reader(['timestamp'])
+
+        with self.assertRaisesRegex(ValueError, 'expecting 1 buffers, got 2'):
+            reader.read([array.array('q', [0] * 8)] * 2)
+
+    def test_unknown_column(self):
+        with self.assertRaisesRegex(ValueError, "unknown column: 'lol'"):
+            self._create_msg_iter(3).column_reader(['lol'])
+
+    def test_next_after_column_reader(self):
+        msg_iter = self._create_msg_iter(3)
+        msg_iter.column_reader(['timestamp'])
+
+        with self.assertRaisesRegex(RuntimeError, 'with a column reader'):
+            next(msg_iter)
+
+    def test_column_reader_after_next(self):
+        msg_iter = self._create_msg_iter(3)
+        next(msg_iter)
+
+        with self.assertRaisesRegex(RuntimeError, 'after iterating messages'):
+            msg_iter.column_reader(['timestamp'])
+
+
 class _TestAutoDiscoverSourceComponentSpecs(unittest.TestCase):
     def setUp(self):
         self._saved_babeltrace_plugin_path = os.environ['BABELTRACE_PLUGIN_PATH']
@@ -709,5 +859,67 @@ class TestAutoDiscoverSourceComponentSpecsParamsObjLogLevel(
         self.assertEqual(msgs[1].stream.name, "TestSourceB: deore")
 
 
+class ReadColumnsShardedTestCase(unittest.TestCase):
+    @staticmethod
+    def _read_unsharded(specs, columns):
+        reader = bt2.TraceCollectionMessageIterator(specs).column_reader(columns)
+        result = [[] for _ in columns]
+
+        while True:
+            buffers = [array.array('q', [0] * 64) for _ in columns]
+            count = reader.read(buffers)
+
+            if count == 0:
+                return result
+
+            for column, buf in zip(result, buffers):
+                column += buf[:count]
+
+    def _test_ctf(self, shard_count):
+        specs = [
+            bt2.ComponentSpec.from_named_plugin_and_component_class(
+                'ctf', 'fs', _3EVENTS_INTERSECT_TRACE_PATH
+            ),
+            bt2.ComponentSpec.from_named_plugin_and_component_class(
+                'ctf', 'fs', _NOINTERSECT_TRACE_PATH
+            ),
+        ]
+        columns = ['timestamp', 'event_class_id', 'stream_id']
+        result = bt2.read_columns_sharded(specs, columns, shard_count)
+        expected = self._read_unsharded(specs, columns)
+        self.assertEqual([column.tolist() for column in result], expected)
+        self.assertEqual(result[0].tolist(), sorted(result[0]))
+
+    def test_ctf_one_shard(self):
+        self._test_ctf(1)
+
+    def test_ctf_two_shards(self):
+        self._test_ctf(2)
+
+    def test_ctf_many_shards(self):
+        self._test_ctf(7)
+
+    def test_no_trace_infos_query(self):
+        # `_ColumnsSrc` doesn't support the `babeltrace.trace-infos`
+        # query: a single worker reads everything.
+        spec = bt2.ComponentSpec(_ColumnsSrc, obj=30)
+        result = bt2.read_columns_sharded(
+            spec, ['timestamp'], 4, event_class_names=['my-event']
+        )
+        self.assertEqual(result[0].tolist(), [i * 1000000 for i in range(30)])
+
+    def test_worker_error(self):
+        spec = bt2.ComponentSpec(_ColumnsSrc, obj=30)
+
+        with self.assertRaisesRegex(RuntimeError, "unknown column: 'lol'"):
+            bt2.read_columns_sharded(spec, ['lol'], 2)
+
+    def test_zero_shards(self):
+        spec = bt2.ComponentSpec(_ColumnsSrc, obj=30)
+
+        with self.assertRaisesRegex(ValueError, 'expecting at least one shard'):
+            bt2.read_columns_sharded(spec, ['timestamp'], 0)
+
+
 if __name__ == '__main__':
     unittest.main()
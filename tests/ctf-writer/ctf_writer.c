@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include "compat/limits.h"
 #include "compat/stdio.h"
+#include <stdbool.h>
 #include <string.h>
 #include "common/assert.h"
 #include "common/uuid.h"
@@ -42,7 +43,7 @@
 #define DEFAULT_CLOCK_TIME 0
 #define DEFAULT_CLOCK_VALUE 0
 
-#define NR_TESTS 325
+#define NR_TESTS 338
 
 struct bt_utsname {
 	char sysname[BABELTRACE_HOST_NAME_MAX];
@@ -1540,6 +1541,341 @@ void append_existing_event_class(struct bt_ctf_stream_class *stream_class)
 	bt_ctf_object_put_ref(event_class);
 }
 
+static
+void set_packed_payload_uint(uint8_t *payload, int64_t offset,
+		uint64_t value, unsigned int size)
+{
+	unsigned int i;
+
+	BT_ASSERT(offset >= 0);
+
+	/* Little-endian */
+	for (i = 0; i < size / 8; i++) {
+		payload[offset + i] = (uint8_t) (value >> (i * 8));
+	}
+}
+
+static
+void test_packed_events(struct bt_ctf_writer *writer,
+		struct bt_ctf_clock *clock)
+{
+	int ret;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class, *string_event_class;
+	struct bt_ctf_field_type *uint_32_type, *uint_8_type, *uint_64_type,
+		*string_type;
+	struct bt_ctf_event *event;
+	struct bt_ctf_field *field;
+	int64_t a_offset, b_offset, c_offset;
+	const uint64_t timestamps[] = { 1000, 1001, 1002 };
+	uint8_t payloads[3 * 16] = { 0 };
+	unsigned int i;
+
+	stream_class = bt_ctf_stream_class_create("packed_stream");
+	BT_ASSERT(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	BT_ASSERT(ret == 0);
+
+	uint_32_type = bt_ctf_field_type_integer_create(32);
+	BT_ASSERT(uint_32_type);
+	uint_8_type = bt_ctf_field_type_integer_create(8);
+	BT_ASSERT(uint_8_type);
+	uint_64_type = bt_ctf_field_type_integer_create(64);
+	BT_ASSERT(uint_64_type);
+	ret = bt_ctf_field_type_set_alignment(uint_64_type, 64);
+	BT_ASSERT(ret == 0);
+	string_type = bt_ctf_field_type_string_create();
+	BT_ASSERT(string_type);
+	ret = bt_ctf_field_type_set_byte_order(uint_32_type,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_set_byte_order(uint_64_type,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+
+	event_class = bt_ctf_event_class_create("packed_event");
+	BT_ASSERT(event_class);
+	ret = bt_ctf_event_class_add_field(event_class, uint_32_type, "a");
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_event_class_add_field(event_class, uint_8_type, "b");
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_event_class_add_field(event_class, uint_64_type, "c");
+	BT_ASSERT(ret == 0);
+	string_event_class = bt_ctf_event_class_create("string_event");
+	BT_ASSERT(string_event_class);
+	ret = bt_ctf_event_class_add_field(string_event_class, string_type,
+		"str");
+	BT_ASSERT(ret == 0);
+
+	ok(bt_ctf_event_class_get_packed_payload_size(event_class) < 0,
+		"bt_ctf_event_class_get_packed_payload_size fails with an event class which is not part of a stream class");
+
+	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(stream_class,
+		string_event_class);
+	BT_ASSERT(ret == 0);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	BT_ASSERT(stream);
+
+	ok(bt_ctf_event_class_get_packed_payload_size(event_class) == 16,
+		"bt_ctf_event_class_get_packed_payload_size returns the correct size");
+	ok(bt_ctf_event_class_get_packed_payload_size(string_event_class) < 0,
+		"bt_ctf_event_class_get_packed_payload_size fails with a payload which has a string field");
+	a_offset = bt_ctf_event_class_get_packed_payload_field_offset(
+		event_class, "a");
+	b_offset = bt_ctf_event_class_get_packed_payload_field_offset(
+		event_class, "b");
+	c_offset = bt_ctf_event_class_get_packed_payload_field_offset(
+		event_class, "c");
+	ok(a_offset == 0 && b_offset == 4 && c_offset == 8,
+		"bt_ctf_event_class_get_packed_payload_field_offset returns the correct offsets");
+	ok(bt_ctf_event_class_get_packed_payload_field_offset(event_class,
+		"nope") < 0,
+		"bt_ctf_event_class_get_packed_payload_field_offset fails with an unknown field name");
+
+	for (i = 0; i < 3; i++) {
+		uint8_t *payload = &payloads[i * 16];
+
+		set_packed_payload_uint(payload, a_offset, 23 + i, 32);
+		set_packed_payload_uint(payload, b_offset, i, 8);
+		set_packed_payload_uint(payload, c_offset,
+			UINT64_C(0x1122334455667788) + i, 64);
+	}
+
+	ok(bt_ctf_stream_append_packed_events(stream, string_event_class,
+		payloads, NULL, 1) < 0,
+		"bt_ctf_stream_append_packed_events rejects an event class without a packed payload layout");
+	ok(bt_ctf_stream_append_packed_events(stream, event_class,
+		payloads, timestamps, 2) == 0,
+		"Append packed events with timestamps");
+
+	/* Regular event between packed events */
+	event = bt_ctf_event_create(event_class);
+	BT_ASSERT(event);
+	field = bt_ctf_event_get_payload(event, "a");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_integer_unsigned_set_value(field, 42);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+	field = bt_ctf_event_get_payload(event, "b");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_integer_unsigned_set_value(field, 43);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+	field = bt_ctf_event_get_payload(event, "c");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_integer_unsigned_set_value(field, 44);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+	ret = bt_ctf_clock_set_time(clock, 1003);
+	BT_ASSERT(ret == 0);
+	ok(bt_ctf_stream_append_event(stream, event) == 0,
+		"Append a regular event after packed events");
+	bt_ctf_object_put_ref(event);
+
+	ret = bt_ctf_clock_set_time(clock, 1004);
+	BT_ASSERT(ret == 0);
+	ok(bt_ctf_stream_append_packed_events(stream, event_class,
+		&payloads[2 * 16], NULL, 1) == 0,
+		"Append a packed event with the stream's clock value");
+	ok(bt_ctf_stream_flush(stream) == 0,
+		"Flush a stream with packed events");
+
+	bt_ctf_object_put_ref(stream);
+	bt_ctf_object_put_ref(event_class);
+	bt_ctf_object_put_ref(string_event_class);
+	bt_ctf_object_put_ref(uint_32_type);
+	bt_ctf_object_put_ref(uint_8_type);
+	bt_ctf_object_put_ref(uint_64_type);
+	bt_ctf_object_put_ref(string_type);
+	bt_ctf_object_put_ref(stream_class);
+}
+
+static
+void test_event_recycling(struct bt_ctf_writer *writer,
+		struct bt_ctf_clock *clock)
+{
+	int ret;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class;
+	struct bt_ctf_field_type *string_type;
+	struct bt_ctf_event *event, *recycled_event;
+	struct bt_ctf_field *field;
+	const char *value;
+
+	stream_class = bt_ctf_stream_class_create("recycling_stream");
+	BT_ASSERT(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	BT_ASSERT(ret == 0);
+	string_type = bt_ctf_field_type_string_create();
+	BT_ASSERT(string_type);
+	event_class = bt_ctf_event_class_create("recycling_event");
+	BT_ASSERT(event_class);
+	ret = bt_ctf_event_class_add_field(event_class, string_type, "str");
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
+	BT_ASSERT(ret == 0);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	BT_ASSERT(stream);
+
+	event = bt_ctf_event_create(event_class);
+	BT_ASSERT(event);
+	field = bt_ctf_event_get_payload(event, "str");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_string_append(field, "first");
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+	bt_ctf_object_put_ref(event);
+
+	recycled_event = bt_ctf_event_create(event_class);
+	BT_ASSERT(recycled_event);
+	ok(recycled_event == event,
+		"bt_ctf_event_create reuses a released event of the same class");
+	field = bt_ctf_event_get_payload(recycled_event, "str");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_string_append(field, "second");
+	BT_ASSERT(ret == 0);
+	value = bt_ctf_field_string_get_value(field);
+	ok(value && strcmp(value, "second") == 0,
+		"A reused event's fields are reset");
+	bt_ctf_object_put_ref(field);
+	ret = bt_ctf_stream_append_event(stream, recycled_event);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(recycled_event);
+	ret = bt_ctf_stream_flush(stream);
+	BT_ASSERT(ret == 0);
+
+	bt_ctf_object_put_ref(stream);
+	bt_ctf_object_put_ref(event_class);
+	bt_ctf_object_put_ref(string_type);
+	bt_ctf_object_put_ref(stream_class);
+}
+
+#define PACKED_THREAD_COUNT		4
+#define PACKED_THREAD_EVENT_COUNT	1000
+#define PACKED_THREAD_BATCH_SIZE	50
+
+struct packed_thread_data {
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *event_class;
+	unsigned int index;
+};
+
+static
+gpointer packed_thread_func(gpointer user_data)
+{
+	struct packed_thread_data *data = user_data;
+	uint8_t payloads[PACKED_THREAD_BATCH_SIZE * 4];
+	uint64_t timestamps[PACKED_THREAD_BATCH_SIZE];
+	int64_t offset;
+	unsigned int i, j;
+	int ret = -1;
+
+	/* The first call computes the event class's layout */
+	if (bt_ctf_event_class_get_packed_payload_size(data->event_class) != 4) {
+		goto end;
+	}
+
+	offset = bt_ctf_event_class_get_packed_payload_field_offset(
+		data->event_class, "value");
+	if (offset != 0) {
+		goto end;
+	}
+
+	for (i = 0; i < PACKED_THREAD_EVENT_COUNT;
+			i += PACKED_THREAD_BATCH_SIZE) {
+		for (j = 0; j < PACKED_THREAD_BATCH_SIZE; j++) {
+			set_packed_payload_uint(&payloads[j * 4], offset,
+				data->index * PACKED_THREAD_EVENT_COUNT + i + j,
+				32);
+			timestamps[j] = 2000 + i + j;
+		}
+
+		ret = bt_ctf_stream_append_packed_events(data->stream,
+			data->event_class, payloads, timestamps,
+			PACKED_THREAD_BATCH_SIZE);
+		if (ret) {
+			goto end;
+		}
+
+		if ((i / PACKED_THREAD_BATCH_SIZE) % 4 == 3) {
+			ret = bt_ctf_stream_flush(data->stream);
+			if (ret) {
+				goto end;
+			}
+		}
+	}
+
+	ret = bt_ctf_stream_flush(data->stream);
+
+end:
+	return GINT_TO_POINTER(ret);
+}
+
+static
+void test_packed_events_threads(struct bt_ctf_writer *writer,
+		struct bt_ctf_clock *clock)
+{
+	int ret;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_event_class *event_class;
+	struct bt_ctf_field_type *uint_32_type;
+	struct packed_thread_data data[PACKED_THREAD_COUNT];
+	GThread *threads[PACKED_THREAD_COUNT];
+	bool all_ok = true;
+	unsigned int i;
+
+	stream_class = bt_ctf_stream_class_create("threaded_packed_stream");
+	BT_ASSERT(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	BT_ASSERT(ret == 0);
+	uint_32_type = bt_ctf_field_type_integer_create(32);
+	BT_ASSERT(uint_32_type);
+	ret = bt_ctf_field_type_set_byte_order(uint_32_type,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+	event_class = bt_ctf_event_class_create("threaded_packed_event");
+	BT_ASSERT(event_class);
+	ret = bt_ctf_event_class_add_field(event_class, uint_32_type, "value");
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
+	BT_ASSERT(ret == 0);
+
+	/* One stream per thread, created beforehand */
+	for (i = 0; i < PACKED_THREAD_COUNT; i++) {
+		data[i].stream = bt_ctf_writer_create_stream(writer,
+			stream_class);
+		BT_ASSERT(data[i].stream);
+		data[i].event_class = event_class;
+		data[i].index = i;
+	}
+
+	bt_ctf_writer_flush_metadata(writer);
+
+	for (i = 0; i < PACKED_THREAD_COUNT; i++) {
+		threads[i] = g_thread_new("packed-events", packed_thread_func,
+			&data[i]);
+		BT_ASSERT(threads[i]);
+	}
+
+	for (i = 0; i < PACKED_THREAD_COUNT; i++) {
+		if (GPOINTER_TO_INT(g_thread_join(threads[i])) != 0) {
+			all_ok = false;
+		}
+
+		bt_ctf_object_put_ref(data[i].stream);
+	}
+
+	ok(all_ok, "Append packed events to distinct streams from several threads");
+
+	bt_ctf_object_put_ref(event_class);
+	bt_ctf_object_put_ref(uint_32_type);
+	bt_ctf_object_put_ref(stream_class);
+}
+
 static
 void test_clock_utils(void)
 {
@@ -2030,6 +2366,12 @@ int main(int argc, char **argv)
 
 	test_custom_event_header_stream(writer, clock);
 
+	test_packed_events(writer, clock);
+
+	test_packed_events_threads(writer, clock);
+
+	test_event_recycling(writer, clock);
+
 	metadata_string = bt_ctf_writer_get_metadata_string(writer);
 	ok(metadata_string, "Get metadata string");
 
@@ -729,33 +729,69 @@ class _LttngDataStream:
 
 
 # An LTTng metadata stream.
+#
+# If `update_path` is not `None`, it's the path of a file containing
+# metadata which the tracer appends to the metadata stream after the
+# viewer starts reading the data streams of the trace.
 class _LttngMetadataStream:
-    def __init__(self, path):
+    def __init__(self, path, update_path=None):
         self._path = path
-        logging.info('Built metadata stream: path="{}"'.format(path))
+        self._update_path = update_path
+        logging.info(
+            'Built metadata stream: path="{}", update-path="{}"'.format(
+                path, update_path
+            )
+        )
 
     @property
     def path(self):
         return self._path
 
-    @property
-    def data(self):
-        assert os.path.isfile(self._path)
+    @staticmethod
+    def _read(path):
+        assert os.path.isfile(path)
 
-        with open(self._path, 'rb') as f:
+        with open(path, 'rb') as f:
             return f.read()
 
+    # Sections of the metadata stream, in the order in which the tracer
+    # makes them available.
+    @property
+    def sections(self):
+        sections = [self._read(self._path)]
+
+        if self._update_path is not None:
+            sections.append(self._read(self._update_path))
+
+        return sections
+
 
 # An LTTng trace, a sequence of LTTng data streams.
+#
+# If the trace directory contains a `metadata-update` file, the metadata
+# stream of the trace gets its content as an update (see
+# `_LttngMetadataStream`).
+#
+# If `is_late` is true, the streams of the trace only become available
+# after the viewer starts reading the data streams of the other traces
+# of its tracing session.
 class LttngTrace(collections.abc.Sequence):
-    def __init__(self, trace_dir):
+    def __init__(self, trace_dir, is_late=False):
         assert os.path.isdir(trace_dir)
         self._path = trace_dir
+        self._is_late = is_late
+        update_path = os.path.join(trace_dir, 'metadata-update')
+
+        if not os.path.isfile(update_path):
+            update_path = None
+
         self._metadata_stream = _LttngMetadataStream(
-            os.path.join(trace_dir, 'metadata')
+            os.path.join(trace_dir, 'metadata'), update_path
         )
         self._create_data_streams(trace_dir)
-        logging.info('Built trace: path="{}"'.format(trace_dir))
+        logging.info(
+            'Built trace: path="{}", is-late={}'.format(trace_dir, is_late)
+        )
 
     def _create_data_streams(self, trace_dir):
         data_stream_paths = []
@@ -769,7 +805,7 @@ class LttngTrace(collections.abc.Sequence):
             if filename.startswith('.'):
                 continue
 
-            if filename == 'metadata':
+            if filename in ('metadata', 'metadata-update'):
                 continue
 
             data_stream_paths.append(path)
@@ -788,6 +824,10 @@ class LttngTrace(collections.abc.Sequence):
     def metadata_stream(self):
         return self._metadata_stream
 
+    @property
+    def is_late(self):
+        return self._is_late
+
     def __getitem__(self, index):
         return self._data_streams[index]
 
@@ -797,10 +837,11 @@ class LttngTrace(collections.abc.Sequence):
 
 # The state of a single data stream.
 class _LttngLiveViewerSessionDataStreamState:
-    def __init__(self, ts_state, info, data_stream):
+    def __init__(self, ts_state, info, data_stream, ms_state):
         self._ts_state = ts_state
         self._info = info
         self._data_stream = data_stream
+        self._ms_state = ms_state
         self._cur_index_entry_index = 0
         fmt = 'Built data stream state: id={}, ts-id={}, ts-name="{}", path="{}"'
         logging.info(
@@ -824,6 +865,11 @@ class _LttngLiveViewerSessionDataStreamState:
     def data_stream(self):
         return self._data_stream
 
+    # State of the metadata stream of the trace of this data stream
+    @property
+    def metadata_stream_state(self):
+        return self._ms_state
+
     @property
     def cur_index_entry(self):
         if self._cur_index_entry_index == len(self._data_stream.index):
@@ -841,7 +887,9 @@ class _LttngLiveViewerSessionMetadataStreamState:
         self._ts_state = ts_state
         self._info = info
         self._metadata_stream = metadata_stream
-        self._is_sent = False
+        self._sections = metadata_stream.sections
+        self._next_section_index = 0
+        self._index_entry_sent_since_section = False
         fmt = 'Built metadata stream state: id={}, ts-id={}, ts-name="{}", path="{}"'
         logging.info(
             fmt.format(
@@ -864,13 +912,29 @@ class _LttngLiveViewerSessionMetadataStreamState:
     def metadata_stream(self):
         return self._metadata_stream
 
+    # True if the next section of the metadata stream is available and
+    # not sent yet.
+    #
+    # The first section is available from the beginning. The next ones
+    # become available once the viewer received an index entry of a
+    # data stream of the trace after the previous section.
     @property
-    def is_sent(self):
-        return self._is_sent
+    def has_new_data(self):
+        if self._next_section_index == len(self._sections):
+            return False
 
-    @is_sent.setter
-    def is_sent(self, value):
-        self._is_sent = value
+        return self._next_section_index == 0 or self._index_entry_sent_since_section
+
+    # Returns the next available section, marking it as sent.
+    def take_next_section(self):
+        assert self.has_new_data
+        section = self._sections[self._next_section_index]
+        self._next_section_index += 1
+        self._index_entry_sent_since_section = False
+        return section
+
+    def index_entry_sent(self):
+        self._index_entry_sent_since_section = True
 
 
 # The state of a tracing session.
@@ -878,12 +942,26 @@ class _LttngLiveViewerSessionTracingSessionState:
     def __init__(self, tc_descr, base_stream_id):
         self._tc_descr = tc_descr
         self._stream_infos = []
+        self._late_stream_infos = []
         self._ds_states = {}
         self._ms_states = {}
         stream_id = base_stream_id
 
         for trace in tc_descr.traces:
             trace_id = stream_id * 1000
+            stream_infos = (
+                self._late_stream_infos if trace.is_late else self._stream_infos
+            )
+
+            # Metadata stream -> stream info and metadata stream state
+            ms_stream_id = stream_id + len(trace)
+            info = _LttngLiveViewerStreamInfo(
+                ms_stream_id, trace_id, True, trace.metadata_stream.path, 'metadata'
+            )
+            ms_state = _LttngLiveViewerSessionMetadataStreamState(
+                self, info, trace.metadata_stream
+            )
+            self._ms_states[ms_stream_id] = ms_state
 
             # Data streams -> stream infos and data stream states
             for data_stream in trace:
@@ -894,22 +972,16 @@ class _LttngLiveViewerSessionTracingSessionState:
                     data_stream.path,
                     data_stream.channel_name,
                 )
-                self._stream_infos.append(info)
+                stream_infos.append(info)
                 self._ds_states[stream_id] = _LttngLiveViewerSessionDataStreamState(
-                    self, info, data_stream
+                    self, info, data_stream, ms_state
                 )
                 stream_id += 1
 
-            # Metadata stream -> stream info and metadata stream state
-            info = _LttngLiveViewerStreamInfo(
-                stream_id, trace_id, True, trace.metadata_stream.path, 'metadata'
-            )
-            self._stream_infos.append(info)
-            self._ms_states[stream_id] = _LttngLiveViewerSessionMetadataStreamState(
-                self, info, trace.metadata_stream
-            )
+            stream_infos.append(ms_state.info)
             stream_id += 1
 
+        self._are_late_stream_infos_sent = False
         self._is_attached = False
         fmt = 'Built tracing session state: id={}, name="{}"'
         logging.info(fmt.format(tc_descr.info.tracing_session_id, tc_descr.info.name))
@@ -930,9 +1002,15 @@ class _LttngLiveViewerSessionTracingSessionState:
     def stream_infos(self):
         return self._stream_infos
 
+    # True if the stream infos of late traces exist and are not sent yet
     @property
-    def has_new_metadata(self):
-        return any([not ms.is_sent for ms in self._ms_states.values()])
+    def has_new_stream_infos(self):
+        return len(self._late_stream_infos) > 0 and not self._are_late_stream_infos_sent
+
+    # Returns the stream infos of late traces, marking them as sent.
+    def take_new_stream_infos(self):
+        self._are_late_stream_infos_sent = True
+        return self._late_stream_infos
 
     @property
     def is_attached(self):
@@ -951,11 +1029,13 @@ class _LttngLiveViewerSession:
         viewer_session_id,
         tracing_session_descriptors,
         max_query_data_response_size,
+        expected_seek_type,
     ):
         self._viewer_session_id = viewer_session_id
         self._ts_states = {}
         self._stream_states = {}
         self._max_query_data_response_size = max_query_data_response_size
+        self._expected_seek_type = expected_seek_type
         total_stream_infos = 0
 
         for ts_descr in tracing_session_descriptors:
@@ -1020,6 +1100,16 @@ class _LttngLiveViewerSession:
         ts_state = self._get_tracing_session_state(cmd.tracing_session_id)
         info = ts_state.tracing_session_descriptor.info
 
+        if (
+            self._expected_seek_type is not None
+            and cmd.seek_type != self._expected_seek_type
+        ):
+            raise UnexpectedInput(
+                'Unexpected seek type to attach to tracing session `{}`: expected {}, got {}'.format(
+                    info.name, self._expected_seek_type, cmd.seek_type
+                )
+            )
+
         if ts_state.is_attached:
             raise UnexpectedInput(
                 'Cannot attach to tracing session `{}`: viewer is already attached'.format(
@@ -1072,14 +1162,21 @@ class _LttngLiveViewerSession:
                 status, index_entry, False, False
             )
 
-        # The viewer only checks the `has_new_metadata` flag if the
-        # reply's status is `OK`, so we need to provide an index here
-        has_new_metadata = stream_state.tracing_session_state.has_new_metadata
+        # The viewer only checks the `has_new_metadata` and
+        # `has_new_data_stream` flags if the reply's status is `OK`, so
+        # we need to provide an index here
+        ms_state = stream_state.metadata_stream_state
+        has_new_metadata = ms_state.has_new_data
+        has_new_data_stream = stream_state.tracing_session_state.has_new_stream_infos
         status = _LttngLiveViewerGetNextDataStreamIndexEntryReply.Status.OK
         reply = _LttngLiveViewerGetNextDataStreamIndexEntryReply(
-            status, stream_state.cur_index_entry, has_new_metadata, False
+            status,
+            stream_state.cur_index_entry,
+            has_new_metadata,
+            has_new_data_stream,
         )
         stream_state.goto_next_index_entry()
+        ms_state.index_entry_sent()
         return reply
 
     def _handle_get_data_stream_packet_data_command(self, cmd):
@@ -1093,7 +1190,7 @@ class _LttngLiveViewerSession:
                 'Stream with ID {} is not a data stream'.format(cmd.stream_id)
             )
 
-        if stream_state.tracing_session_state.has_new_metadata:
+        if stream_state.metadata_stream_state.has_new_data:
             status = _LttngLiveViewerGetDataStreamPacketDataReply.Status.ERROR
             return _LttngLiveViewerGetDataStreamPacketDataReply(
                 status, bytes(), True, False
@@ -1123,25 +1220,32 @@ class _LttngLiveViewerSession:
                 'Stream with ID {} is not a metadata stream'.format(cmd.stream_id)
             )
 
-        if stream_state.is_sent:
+        if not stream_state.has_new_data:
             status = _LttngLiveViewerGetMetadataStreamDataContentReply.Status.NO_NEW
             return _LttngLiveViewerGetMetadataStreamDataContentReply(status, bytes())
 
-        stream_state.is_sent = True
         status = _LttngLiveViewerGetMetadataStreamDataContentReply.Status.OK
         return _LttngLiveViewerGetMetadataStreamDataContentReply(
-            status, stream_state.metadata_stream.data
+            status, stream_state.take_next_section()
         )
 
     def _handle_get_new_stream_infos_command(self, cmd):
         fmt = 'Handling "get new stream infos" command: ts-id={}'
         logging.info(fmt.format(cmd.tracing_session_id))
+        ts_state = self._get_tracing_session_state(cmd.tracing_session_id)
+
+        if ts_state.has_new_stream_infos:
+            # Streams of the late traces
+            status = _LttngLiveViewerGetNewStreamInfosReply.Status.OK
+            return _LttngLiveViewerGetNewStreamInfosReply(
+                status, ts_state.take_new_stream_infos()
+            )
 
-        # As of this version, all the tracing session's stream infos are
-        # always given to the viewer when sending the "attach to tracing
-        # session" reply, so there's nothing new here. Return the `HUP`
-        # status as, if we're handling this command, the viewer consumed
-        # all the existing data streams.
+        # Apart from the streams of the late traces, all the tracing
+        # session's stream infos are given to the viewer when sending
+        # the "attach to tracing session" reply, so there's nothing new
+        # here. Return the `HUP` status as, if we're handling this
+        # command, the viewer consumed all the existing data streams.
         status = _LttngLiveViewerGetNewStreamInfosReply.Status.HUP
         return _LttngLiveViewerGetNewStreamInfosReply(status, [])
 
@@ -1173,11 +1277,19 @@ class _LttngLiveViewerSession:
 #
 # This server accepts a single viewer (client).
 #
+# If `expected_seek_type` is not `None`, the server fails when the viewer
+# attaches to a tracing session with another seek type
+# (`_LttngLiveViewerAttachToTracingSessionCommand.SeekType`).
+#
 # When the viewer closes the connection, the server's constructor
 # returns.
 class LttngLiveServer:
     def __init__(
-        self, port_filename, tracing_session_descriptors, max_query_data_response_size
+        self,
+        port_filename,
+        tracing_session_descriptors,
+        max_query_data_response_size,
+        expected_seek_type=None,
     ):
         logging.info('Server configuration:')
 
@@ -1190,6 +1302,9 @@ class LttngLiveServer:
                 )
             )
 
+        if expected_seek_type is not None:
+            logging.info('  Expected seek type: `{}`'.format(expected_seek_type))
+
         for ts_descr in tracing_session_descriptors:
             info = ts_descr.info
             fmt = '  TS descriptor: name="{}", id={}, hostname="{}", live-timer-freq={}, client-count={}, stream-count={}:'
@@ -1209,6 +1324,7 @@ class LttngLiveServer:
 
         self._ts_descriptors = tracing_session_descriptors
         self._max_query_data_response_size = max_query_data_response_size
+        self._expected_seek_type = expected_seek_type
         self._sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
         self._codec = _LttngLiveViewerProtocolCodec()
 
@@ -1288,7 +1404,10 @@ class LttngLiveServer:
             'LTTng live viewer connected: version={}.{}'.format(cmd.major, cmd.minor)
         )
         viewer_session = _LttngLiveViewerSession(
-            23, self._ts_descriptors, self._max_query_data_response_size
+            23,
+            self._ts_descriptors,
+            self._max_query_data_response_size,
+            self._expected_seek_type,
         )
 
         # Send "connect" reply
@@ -1369,21 +1488,45 @@ class LttngTracingSessionDescriptor:
         return self._info
 
 
+def _trace_from_arg(string):
+    # Format is:
+    #     [late:]TRACEPATH
+    prefix = 'late:'
+
+    if string.startswith(prefix):
+        return LttngTrace(string[len(prefix) :], True)
+
+    return LttngTrace(string)
+
+
 def _tracing_session_descriptors_from_arg(string):
     # Format is:
-    #     NAME,ID,HOSTNAME,FREQ,CLIENTS,TRACEPATH[,TRACEPATH]...
+    #     NAME,ID,HOSTNAME,FREQ,CLIENTS,TRACE[,TRACE]...
+    #
+    # See _trace_from_arg() for the format of TRACE.
     parts = string.split(',')
     name = parts[0]
     tracing_session_id = int(parts[1])
     hostname = parts[2]
     live_timer_freq = int(parts[3])
     client_count = int(parts[4])
-    traces = [LttngTrace(path) for path in parts[5:]]
+    traces = [_trace_from_arg(part) for part in parts[5:]]
     return LttngTracingSessionDescriptor(
         name, tracing_session_id, hostname, live_timer_freq, client_count, traces
     )
 
 
+def _seek_type_parser(string):
+    seek_types = {
+        'beginning': _LttngLiveViewerAttachToTracingSessionCommand.SeekType.BEGINNING,
+        'last': _LttngLiveViewerAttachToTracingSessionCommand.SeekType.LAST,
+    }
+    if string not in seek_types:
+        msg = "{} is not a valid seek type".format(string)
+        raise argparse.ArgumentTypeError(msg)
+    return seek_types[string]
+
+
 def _loglevel_parser(string):
     loglevels = {'info': logging.INFO, 'warning': logging.WARNING}
     if string not in loglevels:
@@ -1417,12 +1560,17 @@ if __name__ == '__main__':
         type=int,
         help='The maximum size of control data response in bytes',
     )
+    parser.add_argument(
+        '--expected-seek-type',
+        type=_seek_type_parser,
+        help='The seek type (`beginning` or `last`) with which the viewer must attach to the tracing sessions',
+    )
     parser.add_argument(
         'sessions',
         nargs="+",
         metavar="SESSION",
         type=_tracing_session_descriptors_from_arg,
-        help='A session configuration. There is no space after comma. Format is: NAME,ID,HOSTNAME,FREQ,CLIENTS,TRACEPATH[,TRACEPATH]....',
+        help='A session configuration. There is no space after comma. Format is: NAME,ID,HOSTNAME,FREQ,CLIENTS,TRACE[,TRACE]..., where TRACE is [late:]TRACEPATH (`late:`: the streams of the trace become available after the viewer starts reading the other ones).',
     )
     parser.add_argument(
         '-h',
@@ -1435,7 +1583,10 @@ if __name__ == '__main__':
     args = parser.parse_args(args=remaining_args)
     try:
         LttngLiveServer(
-            args.port_filename, args.sessions, args.max_query_data_response_size
+            args.port_filename,
+            args.sessions,
+            args.max_query_data_response_size,
+            args.expected_seek_type,
         )
     except UnexpectedInput as exc:
         logging.error(str(exc))
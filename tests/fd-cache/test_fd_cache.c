@@ -0,0 +1,347 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "common/assert.h"
+#include "fd-cache/fd-cache.h"
+#include "tap/tap.h"
+
+#define NR_TESTS	21
+
+#define FILE_COUNT	4
+
+static gchar *tmp_dir;
+static gchar *file_paths[FILE_COUNT];
+
+static
+void write_file(const char *path, const char *contents)
+{
+	gboolean ret;
+
+	ret = g_file_set_contents(path, contents, -1, NULL);
+	BT_ASSERT(ret);
+}
+
+/*
+ * Replaces the file at `path` with a new file (new inode) by renaming a
+ * file over it.
+ */
+static
+void replace_file(const char *path, const char *contents)
+{
+	gchar *new_path = g_strdup_printf("%s.new", path);
+	int ret;
+
+	write_file(new_path, contents);
+	ret = rename(new_path, path);
+	BT_ASSERT(ret == 0);
+	g_free(new_path);
+}
+
+static
+void append_to_file(const char *path, const char *contents)
+{
+	FILE *fp = fopen(path, "a");
+	int ret;
+
+	BT_ASSERT(fp);
+	ret = fputs(contents, fp);
+	BT_ASSERT(ret >= 0);
+	ret = fclose(fp);
+	BT_ASSERT(ret == 0);
+}
+
+/*
+ * Returns whether or not the file descriptor `fd` is open and refers to
+ * the current file at `path`.
+ *
+ * Comparing device and inode numbers instead of only checking that
+ * `fd` is open makes this check reliable even when the cache closed
+ * `fd` and a later open() call reused its number.
+ */
+static
+bool fd_refers_to(int fd, const char *path)
+{
+	struct stat fd_stat, path_stat;
+
+	if (fstat(fd, &fd_stat) != 0) {
+		BT_ASSERT(errno == EBADF);
+		return false;
+	}
+
+	if (stat(path, &path_stat) != 0) {
+		return false;
+	}
+
+	return fd_stat.st_dev == path_stat.st_dev &&
+		fd_stat.st_ino == path_stat.st_ino;
+}
+
+static
+void init_cache(struct bt_fd_cache *fdc)
+{
+	int ret;
+
+	ret = bt_fd_cache_init(fdc, BT_LOGGING_LEVEL_NONE);
+	BT_ASSERT(ret == 0);
+}
+
+/* Gets and puts a handle of `path` to make it the most recent idle one. */
+static
+int get_put_handle(struct bt_fd_cache *fdc, const char *path)
+{
+	struct bt_fd_cache_handle *handle;
+	int fd;
+
+	handle = bt_fd_cache_get_handle(fdc, path);
+	BT_ASSERT(handle);
+	fd = bt_fd_cache_handle_get_fd(handle);
+	bt_fd_cache_put_handle(fdc, handle);
+	return fd;
+}
+
+static
+void test_same_file(void)
+{
+	struct bt_fd_cache fdc;
+	struct bt_fd_cache_handle *handle1, *handle2;
+	int fd;
+
+	init_cache(&fdc);
+	handle1 = bt_fd_cache_get_handle(&fdc, file_paths[0]);
+	handle2 = bt_fd_cache_get_handle(&fdc, file_paths[0]);
+	ok(handle1 && handle1 == handle2,
+		"Getting a handle of the same file twice gives the same handle");
+	fd = bt_fd_cache_handle_get_fd(handle1);
+	bt_fd_cache_put_handle(&fdc, handle1);
+	bt_fd_cache_put_handle(&fdc, handle2);
+	ok(fd_refers_to(fd, file_paths[0]) && fdc.idle_handles->length == 1,
+		"File descriptor stays open when its last handle is put back");
+	handle1 = bt_fd_cache_get_handle(&fdc, file_paths[0]);
+	ok(handle1 && bt_fd_cache_handle_get_fd(handle1) == fd &&
+		fdc.idle_handles->length == 0,
+		"Getting a handle of an idle file reuses its file descriptor");
+	bt_fd_cache_put_handle(&fdc, handle1);
+	ok(!bt_fd_cache_get_handle(&fdc, "/this/file/does/not/exist"),
+		"Getting a handle of a file which doesn't exist fails");
+
+	/* Finalizing with idle handles closes their file descriptors */
+	bt_fd_cache_fini(&fdc);
+	ok(!fd_refers_to(fd, file_paths[0]),
+		"Finalizing the cache closes its idle file descriptors");
+}
+
+static
+void test_max_idle_count(void)
+{
+	struct bt_fd_cache fdc;
+	struct bt_fd_cache_handle *held;
+	int fds[FILE_COUNT];
+	int held_fd;
+	int i;
+
+	init_cache(&fdc);
+	bt_fd_cache_set_max_idle_count(&fdc, 2);
+
+	for (i = 0; i < FILE_COUNT; i++) {
+		fds[i] = get_put_handle(&fdc, file_paths[i]);
+	}
+
+	ok(fdc.idle_handles->length == 2,
+		"Cache keeps at most the maximum number of idle file descriptors");
+	ok(!fd_refers_to(fds[0], file_paths[0]) &&
+		!fd_refers_to(fds[1], file_paths[1]) &&
+		fd_refers_to(fds[2], file_paths[2]) &&
+		fd_refers_to(fds[3], file_paths[3]),
+		"Cache closes the least recently used idle file descriptors");
+
+	/* Make file 2 the most recently used one, then add file 0 */
+	ok(get_put_handle(&fdc, file_paths[2]) == fds[2],
+		"Getting a handle of an idle file keeps its file descriptor");
+	fds[0] = get_put_handle(&fdc, file_paths[0]);
+	ok(fd_refers_to(fds[0], file_paths[0]) &&
+		fd_refers_to(fds[2], file_paths[2]) &&
+		!fd_refers_to(fds[3], file_paths[3]),
+		"Reusing an idle file descriptor makes it the most recently used one");
+
+	/* Handles in use are never closed */
+	held = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	BT_ASSERT(held);
+	held_fd = bt_fd_cache_handle_get_fd(held);
+	bt_fd_cache_set_max_idle_count(&fdc, 0);
+	ok(fdc.idle_handles->length == 0 &&
+		!fd_refers_to(fds[0], file_paths[0]) &&
+		!fd_refers_to(fds[2], file_paths[2]),
+		"Lowering the maximum idle count closes the idle file descriptors");
+	ok(fd_refers_to(held_fd, file_paths[1]),
+		"Lowering the maximum idle count keeps the file descriptors in use");
+	bt_fd_cache_put_handle(&fdc, held);
+	ok(!fd_refers_to(held_fd, file_paths[1]) &&
+		fdc.idle_handles->length == 0,
+		"Maximum idle count 0 closes a file descriptor when its last handle is put back");
+	bt_fd_cache_fini(&fdc);
+}
+
+static
+void test_replaced_file(void)
+{
+	struct bt_fd_cache fdc;
+	struct bt_fd_cache_handle *old_handle, *new_handle;
+
+	init_cache(&fdc);
+	old_handle = bt_fd_cache_get_handle(&fdc, file_paths[0]);
+	BT_ASSERT(old_handle);
+	replace_file(file_paths[0], "replaced");
+	new_handle = bt_fd_cache_get_handle(&fdc, file_paths[0]);
+	ok(new_handle && new_handle != old_handle &&
+		fd_refers_to(bt_fd_cache_handle_get_fd(new_handle),
+			file_paths[0]),
+		"Getting a handle of a replaced file opens the new file");
+	bt_fd_cache_put_handle(&fdc, old_handle);
+	bt_fd_cache_put_handle(&fdc, new_handle);
+	bt_fd_cache_fini(&fdc);
+}
+
+static
+void test_no_revalidate_paths(void)
+{
+	struct bt_fd_cache fdc;
+	struct bt_fd_cache_handle *handle1, *handle2;
+	gchar *moved_path = g_build_filename(tmp_dir, "moved", NULL);
+	int fd;
+	int ret;
+
+	init_cache(&fdc);
+	bt_fd_cache_set_revalidate_paths(&fdc, false);
+	handle1 = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	BT_ASSERT(handle1);
+	fd = bt_fd_cache_handle_get_fd(handle1);
+
+	/* The memoized key of the path doesn't need stat() */
+	ret = rename(file_paths[1], moved_path);
+	BT_ASSERT(ret == 0);
+	handle2 = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	ok(handle2 == handle1,
+		"Without path revalidation, a known path gives its handle without stat()'ing it");
+	bt_fd_cache_put_handle(&fdc, handle2);
+
+	/* An idle handle is still in the cache */
+	bt_fd_cache_put_handle(&fdc, handle1);
+	handle1 = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	ok(handle1 && bt_fd_cache_handle_get_fd(handle1) == fd,
+		"Without path revalidation, a known path gives its idle handle");
+	bt_fd_cache_put_handle(&fdc, handle1);
+
+	/* Once the handle is closed, the path is stat()'ed again */
+	bt_fd_cache_set_max_idle_count(&fdc, 0);
+	ok(!bt_fd_cache_get_handle(&fdc, file_paths[1]),
+		"Without path revalidation, a path of which the handle is closed is stat()'ed again");
+	ret = rename(moved_path, file_paths[1]);
+	BT_ASSERT(ret == 0);
+	handle1 = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	ok(handle1 && fd_refers_to(bt_fd_cache_handle_get_fd(handle1),
+			file_paths[1]),
+		"Without path revalidation, a path which exists again gives a new handle");
+
+	/* Enabling path revalidation forgets the memoized keys */
+	replace_file(file_paths[1], "replaced");
+	bt_fd_cache_set_revalidate_paths(&fdc, true);
+	handle2 = bt_fd_cache_get_handle(&fdc, file_paths[1]);
+	ok(handle2 && handle2 != handle1 &&
+		fd_refers_to(bt_fd_cache_handle_get_fd(handle2),
+			file_paths[1]),
+		"Enabling path revalidation detects replaced files again");
+	bt_fd_cache_put_handle(&fdc, handle1);
+	bt_fd_cache_put_handle(&fdc, handle2);
+	bt_fd_cache_fini(&fdc);
+	g_free(moved_path);
+}
+
+static
+void test_checksums(void)
+{
+	struct bt_fd_cache fdc;
+	struct bt_fd_cache_handle *handle;
+	uint32_t checksum = 0;
+	bool found;
+
+	init_cache(&fdc);
+	handle = bt_fd_cache_get_handle(&fdc, file_paths[2]);
+	BT_ASSERT(handle);
+	ok(!bt_fd_cache_handle_get_checksum(&fdc, handle, &checksum),
+		"A file has no memoized checksum initially");
+	bt_fd_cache_handle_set_checksum(&fdc, handle, 0xc0ffee);
+	bt_fd_cache_put_handle(&fdc, handle);
+
+	/* The memoized checksum outlives the file descriptor */
+	bt_fd_cache_set_max_idle_count(&fdc, 0);
+	handle = bt_fd_cache_get_handle(&fdc, file_paths[2]);
+	BT_ASSERT(handle);
+	found = bt_fd_cache_handle_get_checksum(&fdc, handle, &checksum);
+	ok(found && checksum == 0xc0ffee,
+		"Memoized checksum is kept after the file descriptor is closed");
+	bt_fd_cache_put_handle(&fdc, handle);
+
+	/* Modifying the file in place (same inode) invalidates it */
+	bt_fd_cache_set_max_idle_count(&fdc, BT_FD_CACHE_DEFAULT_MAX_IDLE_COUNT);
+	handle = bt_fd_cache_get_handle(&fdc, file_paths[2]);
+	BT_ASSERT(handle);
+	bt_fd_cache_put_handle(&fdc, handle);
+	append_to_file(file_paths[2], "more contents");
+	handle = bt_fd_cache_get_handle(&fdc, file_paths[2]);
+	BT_ASSERT(handle);
+	ok(!bt_fd_cache_handle_get_checksum(&fdc, handle, &checksum),
+		"Modifying an idle file in place invalidates its memoized checksum");
+	bt_fd_cache_put_handle(&fdc, handle);
+	bt_fd_cache_fini(&fdc);
+}
+
+int main(void)
+{
+	int i;
+
+	plan_tests(NR_TESTS);
+
+	tmp_dir = g_dir_make_tmp("test_fd_cache-XXXXXX", NULL);
+	BT_ASSERT(tmp_dir);
+
+	for (i = 0; i < FILE_COUNT; i++) {
+		gchar *name = g_strdup_printf("file%d", i);
+		gchar *contents = g_strdup_printf("contents of file %d", i);
+
+		file_paths[i] = g_build_filename(tmp_dir, name, NULL);
+		write_file(file_paths[i], contents);
+		g_free(contents);
+		g_free(name);
+	}
+
+	test_same_file();
+	test_max_idle_count();
+	test_replaced_file();
+	test_no_revalidate_paths();
+	test_checksums();
+
+	for (i = 0; i < FILE_COUNT; i++) {
+		unlink(file_paths[i]);
+		g_free(file_paths[i]);
+	}
+
+	rmdir(tmp_dir);
+	g_free(tmp_dir);
+	return exit_status();
+}
@@ -0,0 +1,418 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ *
+ * Multi-graph throughput benchmark
+ *
+ * Runs 1, 2, 4, ... independent graphs concurrently, each one within
+ * its own thread, and reports the total message throughput as well as
+ * the scaling compared to a single graph. As independent graphs don't
+ * share any library state, the throughput should scale linearly with
+ * the number of threads, up to the number of available CPUs.
+ *
+ * This isn't part of `make check`: build and run it with
+ * `make -C tests/lib bench`.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <glib.h>
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+
+struct src_iter_data {
+	bt_stream *stream;
+	bt_event_class *ec;
+	uint64_t ts;
+	uint64_t remaining_count;
+	bool emitted_stream_beginning;
+	bool emitted_stream_end;
+};
+
+/* Gate to start running all the graphs at the same time */
+struct start_gate {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned int waiting_count;
+	unsigned int thread_count;
+};
+
+struct thread_data {
+	pthread_t thread;
+
+	/* Number of event messages to produce and consume */
+	uint64_t msg_count;
+
+	struct start_gate *gate;
+
+	/* Elapsed time of bt_graph_run() */
+	uint64_t elapsed_ns;
+};
+
+static
+uint64_t now_ns(void)
+{
+	struct timespec ts;
+	int ret;
+
+	ret = clock_gettime(CLOCK_MONOTONIC, &ts);
+	BT_ASSERT(ret == 0);
+	return (uint64_t) ts.tv_sec * UINT64_C(1000000000) +
+		(uint64_t) ts.tv_nsec;
+}
+
+static
+void start_gate_wait(struct start_gate *gate)
+{
+	pthread_mutex_lock(&gate->lock);
+	gate->waiting_count++;
+
+	if (gate->waiting_count == gate->thread_count) {
+		pthread_cond_broadcast(&gate->cond);
+	} else {
+		while (gate->waiting_count < gate->thread_count) {
+			pthread_cond_wait(&gate->cond, &gate->lock);
+		}
+	}
+
+	pthread_mutex_unlock(&gate->lock);
+}
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *self_port)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	struct src_iter_data *data = g_new0(struct src_iter_data, 1);
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_clock_class *cc;
+	bt_field_class *payload_fc;
+	bt_field_class *fc;
+	bt_trace *trace;
+	int ret;
+
+	BT_ASSERT(data);
+	data->remaining_count = *(uint64_t *) bt_self_component_get_data(
+		self_comp);
+	tc = bt_trace_class_create(self_comp);
+	BT_ASSERT(tc);
+	cc = bt_clock_class_create(self_comp);
+	BT_ASSERT(cc);
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	ret = bt_stream_class_set_default_clock_class(sc, cc);
+	BT_ASSERT(ret == 0);
+	data->ec = bt_event_class_create(sc);
+	BT_ASSERT(data->ec);
+	payload_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(payload_fc);
+	fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "value", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_string_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "msg", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	ret = bt_event_class_set_payload_field_class(data->ec, payload_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(payload_fc);
+	trace = bt_trace_create(tc);
+	BT_ASSERT(trace);
+	data->stream = bt_stream_create(sc, trace);
+	BT_ASSERT(data->stream);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(sc);
+	bt_clock_class_put_ref(cc);
+	bt_trace_class_put_ref(tc);
+	bt_self_message_iterator_set_data(self_msg_iter, data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_fini(bt_self_message_iterator *self_msg_iter)
+{
+	struct src_iter_data *data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	bt_stream_put_ref(data->stream);
+	bt_event_class_put_ref(data->ec);
+	g_free(data);
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	uint64_t i = 0;
+
+	if (data->emitted_stream_end) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	if (!data->emitted_stream_beginning) {
+		msgs[i] = bt_message_stream_beginning_create(self_msg_iter,
+			data->stream);
+		BT_ASSERT(msgs[i]);
+		data->emitted_stream_beginning = true;
+		i++;
+	}
+
+	for (; i < capacity && data->remaining_count > 0; i++) {
+		bt_message *msg =
+			bt_message_event_create_with_default_clock_snapshot(
+				self_msg_iter, data->ec, data->stream,
+				data->ts++);
+		bt_field *payload;
+		bt_field_string_set_value_status status;
+
+		BT_ASSERT(msg);
+		payload = bt_event_borrow_payload_field(
+			bt_message_event_borrow_event(msg));
+		bt_field_integer_unsigned_set_value(
+			bt_field_structure_borrow_member_field_by_index(
+				payload, 0), data->ts);
+		status = bt_field_string_set_value(
+			bt_field_structure_borrow_member_field_by_index(
+				payload, 1), "hello, world");
+		BT_ASSERT(status == BT_FIELD_STRING_SET_VALUE_STATUS_OK);
+		msgs[i] = msg;
+		data->remaining_count--;
+	}
+
+	if (i < capacity && data->remaining_count == 0) {
+		msgs[i] = bt_message_stream_end_create(self_msg_iter,
+			data->stream);
+		BT_ASSERT(msgs[i]);
+		data->emitted_stream_end = true;
+		i++;
+	}
+
+	*count = i;
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component_add_port_status status;
+
+	bt_self_component_set_data(
+		bt_self_component_source_as_self_component(self_comp),
+		init_method_data);
+	status = bt_self_component_source_add_output_port(self_comp,
+		"out", NULL, NULL);
+	BT_ASSERT(status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+	bt_message_iterator_next_status status;
+
+	status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	switch (status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	default:
+		abort();
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_message_put_ref(msgs[i]);
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+/*
+ * Creates, runs, and destroys one graph (and its own component classes:
+ * threads don't share any library object).
+ */
+static
+void *thread_func(void *arg)
+{
+	struct thread_data *thread_data = arg;
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph *graph;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	uint64_t begin_ns;
+	int ret;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	ret = bt_message_iterator_class_set_initialize_method(msg_iter_cls,
+		src_iter_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_message_iterator_class_set_finalize_method(msg_iter_cls,
+		src_iter_fini);
+	BT_ASSERT(ret == 0);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	ret = bt_component_class_source_set_initialize_method(src_comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	add_comp_status = bt_graph_add_source_component_with_initialize_method_data(
+		graph, src_comp_cls, "src", NULL, &thread_data->msg_count,
+		BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(graph, "sink",
+		NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0), NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+	start_gate_wait(thread_data->gate);
+	begin_ns = now_ns();
+	run_status = bt_graph_run(graph);
+	thread_data->elapsed_ns = now_ns() - begin_ns;
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return NULL;
+}
+
+/*
+ * Runs `thread_count` graphs concurrently and returns the total
+ * throughput, in messages/s.
+ */
+static
+double run_graphs(unsigned int thread_count, uint64_t msg_count)
+{
+	struct thread_data *threads = g_new0(struct thread_data,
+		thread_count);
+	struct start_gate gate = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.cond = PTHREAD_COND_INITIALIZER,
+		.thread_count = thread_count,
+	};
+	uint64_t max_elapsed_ns = 0;
+	unsigned int i;
+	int ret;
+
+	BT_ASSERT(threads);
+
+	for (i = 0; i < thread_count; i++) {
+		threads[i].msg_count = msg_count;
+		threads[i].gate = &gate;
+		ret = pthread_create(&threads[i].thread, NULL, thread_func,
+			&threads[i]);
+		BT_ASSERT(ret == 0);
+	}
+
+	for (i = 0; i < thread_count; i++) {
+		ret = pthread_join(threads[i].thread, NULL);
+		BT_ASSERT(ret == 0);
+		max_elapsed_ns = MAX(max_elapsed_ns, threads[i].elapsed_ns);
+	}
+
+	g_free(threads);
+	return (double) msg_count * thread_count /
+		((double) max_elapsed_ns / 1000000000.);
+}
+
+static
+void print_usage(FILE *fp)
+{
+	fprintf(fp, "Usage: bench_multi_graph [-t MAX-THREADS] [-n COUNT]\n\n"
+		"  -t MAX-THREADS  Run up to MAX-THREADS graphs concurrently "
+		"(default: CPU count)\n"
+		"  -n COUNT        Make each graph process COUNT messages "
+		"(default: 2000000)\n");
+}
+
+int main(int argc, char **argv)
+{
+	long max_thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+	uint64_t msg_count = 2000000;
+	double single_rate = 0;
+	unsigned int thread_count;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "ht:n:")) != -1) {
+		switch (opt) {
+		case 't':
+			max_thread_count = strtol(optarg, NULL, 10);
+			break;
+		case 'n':
+			msg_count = g_ascii_strtoull(optarg, NULL, 10);
+			break;
+		case 'h':
+			print_usage(stdout);
+			return 0;
+		default:
+			print_usage(stderr);
+			return 1;
+		}
+	}
+
+	if (max_thread_count < 1 || msg_count == 0) {
+		print_usage(stderr);
+		return 1;
+	}
+
+	printf("%8s %16s %16s %10s\n", "graphs", "total msg/s",
+		"msg/s/graph", "scaling");
+
+	thread_count = 1;
+
+	while (true) {
+		double rate = run_graphs(thread_count, msg_count);
+
+		if (thread_count == 1) {
+			single_rate = rate;
+		}
+
+		printf("%8u %16.0f %16.0f %9.2fx\n", thread_count, rate,
+			rate / thread_count, rate / single_rate);
+		fflush(stdout);
+
+		if (thread_count == max_thread_count) {
+			break;
+		}
+
+		/* Powers of two, then exactly `max_thread_count` */
+		thread_count = MIN(thread_count * 2,
+			(unsigned int) max_thread_count);
+	}
+
+	return 0;
+}
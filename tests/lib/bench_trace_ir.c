@@ -0,0 +1,677 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ *
+ * Trace IR and value object microbenchmarks
+ *
+ * Each benchmark repeats a single library operation a given number of
+ * times and reports its mean duration. This isn't part of `make check`:
+ * build and run it with `make -C tests/lib bench`.
+ */
+
+#define BT_LOG_TAG "BENCH/TRACE-IR"
+#include "lib/logging.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "lib/object-pool.h"
+#include "lib/trace-ir/event-class.h"
+#include "lib/graph/graph.h"
+#include "lib/graph/message/iterator.h"
+#include "lib/graph/message/pools.h"
+
+#define PAYLOAD_INT_MEMBER_COUNT	16
+
+struct bench_ctx {
+	bt_graph *graph;
+	bt_self_message_iterator *self_msg_iter;
+	bt_clock_class *cc;
+	bt_clock_class *odd_cc;
+	bt_event_class *ec;
+	bt_stream *stream;
+
+	/* Payload field of a message which this context owns */
+	bt_message *msg;
+	bt_field *payload;
+};
+
+struct bench {
+	const char *name;
+
+	/* Default iteration count */
+	uint64_t iter_count;
+
+	void (*func)(struct bench_ctx *ctx, uint64_t iter_count);
+
+	/*
+	 * Whether or not this benchmark needs the context of a message
+	 * iterator (`ctx` members other than `graph`)
+	 */
+	bool needs_msg_iter;
+};
+
+/* Multiplier of the default iteration counts (`-f` option) */
+static double iter_count_factor = 1.;
+
+/* Benchmark name patterns (command-line arguments), or `NULL` for all */
+static char **patterns;
+
+static
+uint64_t now_ns(void)
+{
+	struct timespec ts;
+	int ret;
+
+	ret = clock_gettime(CLOCK_MONOTONIC, &ts);
+	BT_ASSERT(ret == 0);
+	return (uint64_t) ts.tv_sec * UINT64_C(1000000000) +
+		(uint64_t) ts.tv_nsec;
+}
+
+/*
+ * The stream class has a default clock class: all the event messages
+ * have a default clock snapshot.
+ */
+static
+void bench_event_msg_create(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_message *msg =
+			bt_message_event_create_with_default_clock_snapshot(
+				ctx->self_msg_iter, ctx->ec, ctx->stream, i);
+
+		BT_ASSERT(msg);
+		bt_message_put_ref(msg);
+	}
+}
+
+/*
+ * Keeps `burst` event messages alive at the same time to also exercise
+ * the pools beyond a single recycled object.
+ */
+static
+void bench_event_msg_create_burst(struct bench_ctx *ctx,
+		uint64_t iter_count)
+{
+	bt_message *msgs[64];
+	uint64_t i;
+	const uint64_t burst = G_N_ELEMENTS(msgs);
+
+	for (i = 0; i < iter_count; i += burst) {
+		uint64_t j;
+
+		for (j = 0; j < burst; j++) {
+			msgs[j] = bt_message_event_create_with_default_clock_snapshot(
+				ctx->self_msg_iter, ctx->ec, ctx->stream, i + j);
+			BT_ASSERT(msgs[j]);
+		}
+
+		for (j = 0; j < burst; j++) {
+			bt_message_put_ref(msgs[j]);
+		}
+	}
+}
+
+static
+void bench_field_uint_set(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_field *field = bt_field_structure_borrow_member_field_by_index(
+		ctx->payload, 0);
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field_integer_unsigned_set_value(field, i);
+	}
+}
+
+static
+void bench_field_sint_set(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_field *field = bt_field_structure_borrow_member_field_by_name(
+		ctx->payload, "sint");
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field_integer_signed_set_value(field, -(int64_t) i);
+	}
+}
+
+static
+void bench_field_real_set(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_field *field = bt_field_structure_borrow_member_field_by_name(
+		ctx->payload, "real");
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field_real_double_precision_set_value(field, (double) i);
+	}
+}
+
+static
+void bench_field_string_set(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_field *field = bt_field_structure_borrow_member_field_by_name(
+		ctx->payload, "str");
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field_string_set_value_status status =
+			bt_field_string_set_value(field,
+				"sched_switch: prev_comm=swapper/0");
+
+		BT_ASSERT(status == BT_FIELD_STRING_SET_VALUE_STATUS_OK);
+	}
+}
+
+/*
+ * Clears the string field and appends chunks to it, the first
+ * iteration growing its buffer.
+ */
+static
+void bench_field_string_append(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	static const char chunk[] = "0123456789abcdef";
+	bt_field *field = bt_field_structure_borrow_member_field_by_name(
+		ctx->payload, "str");
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		unsigned int j;
+
+		bt_field_string_clear(field);
+
+		for (j = 0; j < 16; j++) {
+			bt_field_string_append_status status =
+				bt_field_string_append_with_length(field,
+					chunk, sizeof(chunk) - 1);
+
+			BT_ASSERT(status == BT_FIELD_STRING_APPEND_STATUS_OK);
+		}
+	}
+}
+
+static
+void bench_field_struct_borrow_by_index(struct bench_ctx *ctx,
+		uint64_t iter_count)
+{
+	uint64_t member_count = bt_field_class_structure_get_member_count(
+		bt_field_borrow_class_const(ctx->payload));
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field *field = bt_field_structure_borrow_member_field_by_index(
+			ctx->payload, i % member_count);
+
+		BT_ASSERT(field);
+	}
+}
+
+static
+void bench_field_struct_borrow_by_name(struct bench_ctx *ctx,
+		uint64_t iter_count)
+{
+	char names[PAYLOAD_INT_MEMBER_COUNT][16];
+	uint64_t i;
+
+	for (i = 0; i < PAYLOAD_INT_MEMBER_COUNT; i++) {
+		sprintf(names[i], "int%" PRIu64, i);
+	}
+
+	for (i = 0; i < iter_count; i++) {
+		bt_field *field = bt_field_structure_borrow_member_field_by_name(
+			ctx->payload, names[i % PAYLOAD_INT_MEMBER_COUNT]);
+
+		BT_ASSERT(field);
+	}
+}
+
+static
+void bench_clock_snapshot_get_ns(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_message *msg =
+		bt_message_event_create_with_default_clock_snapshot(
+			ctx->self_msg_iter, ctx->ec, ctx->stream, 1234567890);
+	const bt_clock_snapshot *cs;
+	uint64_t i;
+
+	BT_ASSERT(msg);
+	cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+
+	for (i = 0; i < iter_count; i++) {
+		int64_t ns;
+		bt_clock_snapshot_get_ns_from_origin_status status =
+			bt_clock_snapshot_get_ns_from_origin(cs, &ns);
+
+		BT_ASSERT(status == BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK);
+	}
+
+	bt_message_put_ref(msg);
+}
+
+static
+void bench_clock_class_cycles_to_ns(struct bench_ctx *ctx,
+		uint64_t iter_count)
+{
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		int64_t ns;
+		bt_clock_class_cycles_to_ns_from_origin_status status =
+			bt_clock_class_cycles_to_ns_from_origin(ctx->odd_cc,
+				i * 1000, &ns);
+
+		BT_ASSERT(status ==
+			BT_CLOCK_CLASS_CYCLES_TO_NS_FROM_ORIGIN_STATUS_OK);
+	}
+}
+
+static const char * const value_map_keys[] = {
+	"inputs", "clock-class-offset-s", "clock-class-offset-ns",
+	"force-clock-class-origin-unix-epoch", "trace-name", "path",
+	"assume-single-trace", "ignore-discarded-events",
+	"ignore-discarded-packets", "quiet", "single-trace", "color",
+	"field-names", "field-trace:hostname", "name-default", "verbose",
+};
+
+static
+bt_value *create_value_map(void)
+{
+	bt_value *map = bt_value_map_create();
+	size_t i;
+
+	BT_ASSERT(map);
+
+	for (i = 0; i < G_N_ELEMENTS(value_map_keys); i++) {
+		bt_value_map_insert_entry_status status =
+			bt_value_map_insert_unsigned_integer_entry(map,
+				value_map_keys[i], i);
+
+		BT_ASSERT(status == BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK);
+	}
+
+	return map;
+}
+
+static
+void bench_value_map_create_fill(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_value *map = create_value_map();
+
+		bt_value_put_ref(map);
+	}
+}
+
+static
+void bench_value_map_borrow(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_value *map = create_value_map();
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		const bt_value *entry = bt_value_map_borrow_entry_value_const(
+			map, value_map_keys[i % G_N_ELEMENTS(value_map_keys)]);
+
+		BT_ASSERT(entry);
+	}
+
+	bt_value_put_ref(map);
+}
+
+static
+void bench_value_map_copy(struct bench_ctx *ctx, uint64_t iter_count)
+{
+	bt_value *map = create_value_map();
+	uint64_t i;
+
+	for (i = 0; i < iter_count; i++) {
+		bt_value *copy = NULL;
+		bt_value_copy_status status = bt_value_copy(map, &copy);
+
+		BT_ASSERT(status == BT_VALUE_COPY_STATUS_OK);
+		bt_value_put_ref(copy);
+	}
+
+	bt_value_put_ref(map);
+}
+
+static const struct bench benches[] = {
+	{ "event-msg-create", 2000000, bench_event_msg_create, true },
+	{ "event-msg-create-burst", 2000000, bench_event_msg_create_burst, true },
+	{ "field-uint-set", 50000000, bench_field_uint_set, true },
+	{ "field-sint-set", 50000000, bench_field_sint_set, true },
+	{ "field-real-set", 50000000, bench_field_real_set, true },
+	{ "field-string-set", 10000000, bench_field_string_set, true },
+	{ "field-string-append", 1000000, bench_field_string_append, true },
+	{ "field-struct-borrow-by-index", 50000000, bench_field_struct_borrow_by_index, true },
+	{ "field-struct-borrow-by-name", 10000000, bench_field_struct_borrow_by_name, true },
+	{ "clock-snapshot-get-ns", 50000000, bench_clock_snapshot_get_ns, true },
+	{ "clock-class-cycles-to-ns", 50000000, bench_clock_class_cycles_to_ns, true },
+	{ "value-map-create-fill", 500000, bench_value_map_create_fill, false },
+	{ "value-map-borrow", 20000000, bench_value_map_borrow, false },
+	{ "value-map-copy", 500000, bench_value_map_copy, false },
+};
+
+static
+bool bench_is_selected(const struct bench *bench)
+{
+	char **pattern;
+
+	if (!patterns || !*patterns) {
+		return true;
+	}
+
+	for (pattern = patterns; *pattern; pattern++) {
+		if (strstr(bench->name, *pattern)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static
+void print_pool_stats(const char *name, const struct bt_object_pool *pool)
+{
+	printf("  %-28s hits=%" PRIu64 " misses=%" PRIu64
+		" discarded=%" PRIu64 " peak-size=%zu\n",
+		name, pool->stats.hits, pool->stats.misses,
+		pool->stats.discarded, pool->stats.peak_size);
+}
+
+static
+void run_bench(struct bench_ctx *ctx, const struct bench *bench)
+{
+	uint64_t iter_count = (uint64_t) ((double) bench->iter_count *
+		iter_count_factor);
+	uint64_t begin_ns, elapsed_ns;
+
+	if (iter_count == 0) {
+		iter_count = 1;
+	}
+
+	/* Warm up: fill the pools and the caches */
+	bench->func(ctx, MIN(iter_count, 1000));
+
+	begin_ns = now_ns();
+	bench->func(ctx, iter_count);
+	elapsed_ns = now_ns() - begin_ns;
+	printf("%-32s %12" PRIu64 " iterations %12.3f ms %10.2f ns/iteration\n",
+		bench->name, iter_count, (double) elapsed_ns / 1000000.,
+		(double) elapsed_ns / (double) iter_count);
+	fflush(stdout);
+
+	if (bench->needs_msg_iter && strstr(bench->name, "event-msg")) {
+		print_pool_stats("event class event pool",
+			&((const struct bt_event_class *) ctx->ec)->event_pool);
+		print_pool_stats("iterator event message pool",
+			&((const struct bt_message_iterator *)
+				ctx->self_msg_iter)->msg_pools->event_msg_pool);
+	}
+}
+
+static
+void run_benches(struct bench_ctx *ctx, bool needs_msg_iter)
+{
+	size_t i;
+
+	for (i = 0; i < G_N_ELEMENTS(benches); i++) {
+		const struct bench *bench = &benches[i];
+
+		if (bench->needs_msg_iter == needs_msg_iter &&
+				bench_is_selected(bench)) {
+			run_bench(ctx, bench);
+		}
+	}
+}
+
+static
+bt_field_class *create_payload_fc(bt_trace_class *tc)
+{
+	bt_field_class *payload_fc = bt_field_class_structure_create(tc);
+	bt_field_class *fc;
+	unsigned int i;
+	int ret;
+
+	BT_ASSERT(payload_fc);
+	fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "uint", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_integer_signed_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "sint", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_real_double_precision_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "real", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_string_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "str", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+
+	for (i = 0; i < PAYLOAD_INT_MEMBER_COUNT; i++) {
+		char name[16];
+
+		sprintf(name, "int%u", i);
+		fc = bt_field_class_integer_unsigned_create(tc);
+		BT_ASSERT(fc);
+		ret = bt_field_class_structure_append_member(payload_fc,
+			name, fc);
+		BT_ASSERT(ret == 0);
+		bt_field_class_put_ref(fc);
+	}
+
+	return payload_fc;
+}
+
+static
+void init_msg_iter_ctx(struct bench_ctx *ctx,
+		bt_self_message_iterator *self_msg_iter)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_field_class *payload_fc;
+	bt_trace *trace;
+	int ret;
+
+	ctx->self_msg_iter = self_msg_iter;
+	tc = bt_trace_class_create(self_comp);
+	BT_ASSERT(tc);
+	ctx->cc = bt_clock_class_create(self_comp);
+	BT_ASSERT(ctx->cc);
+	ctx->odd_cc = bt_clock_class_create(self_comp);
+	BT_ASSERT(ctx->odd_cc);
+	bt_clock_class_set_frequency(ctx->odd_cc, UINT64_C(2400000000));
+	bt_clock_class_set_offset(ctx->odd_cc, 1600000000, 12345);
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	ret = bt_stream_class_set_default_clock_class(sc, ctx->cc);
+	BT_ASSERT(ret == 0);
+	ctx->ec = bt_event_class_create(sc);
+	BT_ASSERT(ctx->ec);
+	payload_fc = create_payload_fc(tc);
+	ret = bt_event_class_set_payload_field_class(ctx->ec, payload_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(payload_fc);
+	trace = bt_trace_create(tc);
+	BT_ASSERT(trace);
+	ctx->stream = bt_stream_create(sc, trace);
+	BT_ASSERT(ctx->stream);
+	ctx->msg = bt_message_event_create_with_default_clock_snapshot(
+		self_msg_iter, ctx->ec, ctx->stream, 0);
+	BT_ASSERT(ctx->msg);
+	ctx->payload = bt_event_borrow_payload_field(
+		bt_message_event_borrow_event(ctx->msg));
+	BT_ASSERT(ctx->payload);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(sc);
+	bt_trace_class_put_ref(tc);
+}
+
+static
+void fini_msg_iter_ctx(struct bench_ctx *ctx)
+{
+	BT_MESSAGE_PUT_REF_AND_RESET(ctx->msg);
+	BT_STREAM_PUT_REF_AND_RESET(ctx->stream);
+	BT_EVENT_CLASS_PUT_REF_AND_RESET(ctx->ec);
+	BT_CLOCK_CLASS_PUT_REF_AND_RESET(ctx->odd_cc);
+	BT_CLOCK_CLASS_PUT_REF_AND_RESET(ctx->cc);
+	ctx->payload = NULL;
+	ctx->self_msg_iter = NULL;
+}
+
+/*
+ * Runs all the selected benchmarks which need a message iterator on
+ * the first call, then ends.
+ */
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct bench_ctx *ctx = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+
+	init_msg_iter_ctx(ctx, self_msg_iter);
+	run_benches(ctx, true);
+	fini_msg_iter_ctx(ctx);
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component_add_port_status status;
+
+	bt_self_component_set_data(
+		bt_self_component_source_as_self_component(self_comp),
+		init_method_data);
+	status = bt_self_component_source_add_output_port(self_comp,
+		"out", NULL, NULL);
+	BT_ASSERT(status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_array_const msgs;
+	uint64_t count;
+	bt_message_iterator_next_status status;
+
+	status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	BT_ASSERT(status == BT_MESSAGE_ITERATOR_NEXT_STATUS_END);
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+}
+
+static
+void run_graph_benches(struct bench_ctx *ctx)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	int ret;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	ret = bt_component_class_source_set_initialize_method(src_comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	ctx->graph = bt_graph_create(0);
+	BT_ASSERT(ctx->graph);
+	add_comp_status = bt_graph_add_source_component_with_initialize_method_data(
+		ctx->graph, src_comp_cls, "src", NULL, ctx,
+		BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(ctx->graph,
+		"sink", NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(ctx->graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0), NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+	run_status = bt_graph_run(ctx->graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	BT_GRAPH_PUT_REF_AND_RESET(ctx->graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+}
+
+static
+void print_usage(FILE *fp)
+{
+	size_t i;
+
+	fprintf(fp, "Usage: bench_trace_ir [-f FACTOR] [PATTERN]...\n\n"
+		"Runs the benchmarks of which the name contains any PATTERN "
+		"(all by default).\n\n"
+		"  -f FACTOR  Multiply the default iteration counts by FACTOR\n\n"
+		"Benchmarks:\n\n");
+
+	for (i = 0; i < G_N_ELEMENTS(benches); i++) {
+		fprintf(fp, "  %s\n", benches[i].name);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct bench_ctx ctx = { 0 };
+	int i = 1;
+
+	if (argc > 1 && (strcmp(argv[1], "-h") == 0 ||
+			strcmp(argv[1], "--help") == 0)) {
+		print_usage(stdout);
+		return 0;
+	}
+
+	if (argc > 2 && strcmp(argv[1], "-f") == 0) {
+		char *end;
+
+		iter_count_factor = g_ascii_strtod(argv[2], &end);
+		if (*end != '\0' || iter_count_factor <= 0) {
+			print_usage(stderr);
+			return 1;
+		}
+
+		i = 3;
+	}
+
+	patterns = &argv[i];
+	run_graph_benches(&ctx);
+	run_benches(&ctx, false);
+	return 0;
+}
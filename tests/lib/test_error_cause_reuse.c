@@ -0,0 +1,408 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 9
+
+/* More than the number of released error causes a thread keeps */
+#define CAUSE_COUNT	12
+
+#define THREAD_COUNT	4
+#define CYCLES_PER_THREAD	1000
+
+/* Longer than the message of an error cause which a thread keeps */
+#define HUGE_MSG_LEN	5000
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+static
+bt_component_class_sink_consume_method_status sink_consume(
+		bt_self_component_sink *self_comp)
+{
+	return BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
+}
+
+/*
+ * Returns the message of the error cause `index` of the round `round`:
+ * the rounds alternate between long, short, and huge messages so that
+ * reused error causes get both shorter and longer messages.
+ */
+static
+GString *create_msg(unsigned int round, unsigned int index)
+{
+	GString *msg = g_string_new(NULL);
+
+	BT_ASSERT(msg);
+
+	switch (round % 3) {
+	case 0:
+		g_string_append_printf(msg,
+			"This is a rather long error cause message, longer than the next one: round=%u, index=%u",
+			round, index);
+		break;
+	case 1:
+		g_string_append_printf(msg, "%u:%u", round, index);
+		break;
+	default:
+		g_string_append_printf(msg, "%u:%u:", round, index);
+
+		while (msg->len < HUGE_MSG_LEN) {
+			g_string_append_c(msg, 'x');
+		}
+
+		break;
+	}
+
+	return msg;
+}
+
+/*
+ * Appends `CAUSE_COUNT` error causes from an unknown actor for the
+ * round `round` to the current thread's error.
+ */
+static
+void append_unknown_causes(unsigned int round)
+{
+	unsigned int i;
+
+	for (i = 0; i < CAUSE_COUNT; i++) {
+		GString *module_name = g_string_new(NULL);
+		GString *file_name = g_string_new(NULL);
+		GString *msg = create_msg(round, i);
+
+		BT_ASSERT(module_name);
+		BT_ASSERT(file_name);
+		g_string_printf(module_name, "module-%u-%u", round, i);
+		g_string_printf(file_name, "file-%u-%u.c", round, i);
+		BT_ASSERT(bt_current_thread_error_append_cause_from_unknown(
+			module_name->str, file_name->str, round * 100 + i,
+			"%s", msg->str) ==
+			BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_STATUS_OK);
+		g_string_free(module_name, TRUE);
+		g_string_free(file_name, TRUE);
+		g_string_free(msg, TRUE);
+	}
+}
+
+/*
+ * Returns whether or not the error `error` contains exactly the error
+ * causes which append_unknown_causes() appends for the round `round`.
+ */
+static
+bool check_unknown_causes(const bt_error *error, unsigned int round)
+{
+	bool is_ok = bt_error_get_cause_count(error) == CAUSE_COUNT;
+	unsigned int i;
+
+	for (i = 0; is_ok && i < CAUSE_COUNT; i++) {
+		const bt_error_cause *cause =
+			bt_error_borrow_cause_by_index(error, i);
+		GString *module_name = g_string_new(NULL);
+		GString *file_name = g_string_new(NULL);
+		GString *msg = create_msg(round, i);
+
+		BT_ASSERT(module_name);
+		BT_ASSERT(file_name);
+		g_string_printf(module_name, "module-%u-%u", round, i);
+		g_string_printf(file_name, "file-%u-%u.c", round, i);
+		is_ok = bt_error_cause_get_actor_type(cause) ==
+				BT_ERROR_CAUSE_ACTOR_TYPE_UNKNOWN &&
+			strcmp(bt_error_cause_get_module_name(cause),
+				module_name->str) == 0 &&
+			strcmp(bt_error_cause_get_file_name(cause),
+				file_name->str) == 0 &&
+			bt_error_cause_get_line_number(cause) ==
+				round * 100 + i &&
+			strcmp(bt_error_cause_get_message(cause),
+				msg->str) == 0;
+		g_string_free(module_name, TRUE);
+		g_string_free(file_name, TRUE);
+		g_string_free(msg, TRUE);
+	}
+
+	return is_ok;
+}
+
+static
+void test_unknown_actor(void)
+{
+	unsigned int round;
+
+	/* Each round reuses the error causes which the previous one released */
+	for (round = 0; round < 4; round++) {
+		const bt_error *error;
+
+		append_unknown_causes(round);
+		error = bt_current_thread_take_error();
+		BT_ASSERT(error);
+		ok(check_unknown_causes(error, round),
+			"error causes from an unknown actor have the expected properties (round %u)",
+			round);
+		bt_error_release(error);
+	}
+}
+
+static
+bool check_comp_cls_cause(const bt_error_cause *cause,
+		const char *comp_cls_name, bt_component_class_type type,
+		uint64_t line_no, const char *msg)
+{
+	return bt_error_cause_get_actor_type(cause) ==
+			BT_ERROR_CAUSE_ACTOR_TYPE_COMPONENT_CLASS &&
+		strcmp(bt_error_cause_component_class_actor_get_component_class_name(
+			cause), comp_cls_name) == 0 &&
+		bt_error_cause_component_class_actor_get_component_class_type(
+			cause) == type &&
+		!bt_error_cause_component_class_actor_get_plugin_name(cause) &&
+		strstr(bt_error_cause_get_module_name(cause), comp_cls_name) &&
+		strcmp(bt_error_cause_get_file_name(cause), "comp-cls.c") == 0 &&
+		bt_error_cause_get_line_number(cause) == line_no &&
+		strcmp(bt_error_cause_get_message(cause), msg) == 0;
+}
+
+/*
+ * Appends error causes from two alternating component classes, and
+ * from an unknown actor in between, to the current thread's error.
+ */
+static
+void test_component_class_actor(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_sink *sink_comp_cls;
+	unsigned int round;
+	const bt_error *error;
+	bool mixed_ok = true;
+	unsigned int i;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src-comp-cls",
+		msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	sink_comp_cls = bt_component_class_sink_create("sink-comp-cls",
+		sink_consume);
+	BT_ASSERT(sink_comp_cls);
+
+	for (round = 0; round < 2; round++) {
+		bool is_ok = true;
+
+		for (i = 0; i < CAUSE_COUNT; i++) {
+			BT_ASSERT(bt_current_thread_error_append_cause_from_component_class(
+				(void *) (i % 2 == round ?
+					(void *) src_comp_cls :
+					(void *) sink_comp_cls),
+				"comp-cls.c", i, "%u", i) ==
+				BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_STATUS_OK);
+		}
+
+		error = bt_current_thread_take_error();
+		BT_ASSERT(error);
+		is_ok = bt_error_get_cause_count(error) == CAUSE_COUNT;
+
+		for (i = 0; is_ok && i < CAUSE_COUNT; i++) {
+			char msg[16];
+
+			sprintf(msg, "%u", i);
+			is_ok = i % 2 == round ?
+				check_comp_cls_cause(
+					bt_error_borrow_cause_by_index(error, i),
+					"src-comp-cls",
+					BT_COMPONENT_CLASS_TYPE_SOURCE, i, msg) :
+				check_comp_cls_cause(
+					bt_error_borrow_cause_by_index(error, i),
+					"sink-comp-cls",
+					BT_COMPONENT_CLASS_TYPE_SINK, i, msg);
+		}
+
+		ok(is_ok,
+			"error causes from component classes have the expected properties (round %u)",
+			round);
+		bt_error_release(error);
+	}
+
+	/* Both caches are now full: mix the actor types */
+	for (i = 0; i < CAUSE_COUNT; i++) {
+		if (i % 2 == 0) {
+			BT_ASSERT(bt_current_thread_error_append_cause_from_unknown(
+				"module", "unknown.c", i, "%u", i) ==
+				BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_STATUS_OK);
+		} else {
+			BT_ASSERT(bt_current_thread_error_append_cause_from_component_class(
+				(void *) src_comp_cls, "comp-cls.c", i,
+				"%u", i) ==
+				BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_STATUS_OK);
+		}
+	}
+
+	error = bt_current_thread_take_error();
+	BT_ASSERT(error);
+
+	for (i = 0; mixed_ok && i < CAUSE_COUNT; i++) {
+		const bt_error_cause *cause =
+			bt_error_borrow_cause_by_index(error, i);
+		char msg[16];
+
+		sprintf(msg, "%u", i);
+
+		if (i % 2 == 0) {
+			mixed_ok = bt_error_cause_get_actor_type(cause) ==
+					BT_ERROR_CAUSE_ACTOR_TYPE_UNKNOWN &&
+				strcmp(bt_error_cause_get_module_name(cause),
+					"module") == 0 &&
+				strcmp(bt_error_cause_get_file_name(cause),
+					"unknown.c") == 0 &&
+				strcmp(bt_error_cause_get_message(cause),
+					msg) == 0;
+		} else {
+			mixed_ok = check_comp_cls_cause(cause, "src-comp-cls",
+				BT_COMPONENT_CLASS_TYPE_SOURCE, i, msg);
+		}
+	}
+
+	ok(mixed_ok, "error causes from different actor types have the expected properties");
+	bt_error_release(error);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_component_class_sink_put_ref(sink_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+}
+
+struct thread_data {
+	pthread_t thread;
+	unsigned int index;
+	uint64_t mismatch_count;
+	const bt_error *error;
+};
+
+static
+void *cycle_thread_func(void *data)
+{
+	struct thread_data *thread_data = data;
+	unsigned int i;
+
+	for (i = 0; i < CYCLES_PER_THREAD; i++) {
+		const bt_error *error;
+		unsigned int round = thread_data->index * CYCLES_PER_THREAD + i;
+
+		append_unknown_causes(round);
+		error = bt_current_thread_take_error();
+
+		if (!error || !check_unknown_causes(error, round)) {
+			thread_data->mismatch_count++;
+		}
+
+		bt_error_release(error);
+	}
+
+	return NULL;
+}
+
+/*
+ * Several threads append error causes and release their errors at the
+ * same time, each one with its own released error causes, until they
+ * exit.
+ */
+static
+void test_concurrent_threads(void)
+{
+	struct thread_data threads[THREAD_COUNT] = { 0 };
+	uint64_t mismatch_count = 0;
+	unsigned int created_count;
+	bool join_ok = true;
+	unsigned int i;
+
+	for (created_count = 0; created_count < THREAD_COUNT;
+			created_count++) {
+		threads[created_count].index = created_count + 1;
+
+		if (pthread_create(&threads[created_count].thread, NULL,
+				cycle_thread_func, &threads[created_count])) {
+			break;
+		}
+	}
+
+	for (i = 0; i < created_count; i++) {
+		if (pthread_join(threads[i].thread, NULL)) {
+			join_ok = false;
+		}
+
+		mismatch_count += threads[i].mismatch_count;
+	}
+
+	ok(created_count == THREAD_COUNT && join_ok && mismatch_count == 0,
+		"concurrent threads get error causes with the expected properties");
+}
+
+static
+void *take_thread_func(void *data)
+{
+	struct thread_data *thread_data = data;
+
+	append_unknown_causes(thread_data->index);
+	thread_data->error = bt_current_thread_take_error();
+	return NULL;
+}
+
+/*
+ * Releases, in this thread, an error of which another thread, which
+ * exited since, created the error causes, and then reuses them.
+ */
+static
+void test_release_other_thread_error(void)
+{
+	struct thread_data thread_data = { .index = 10 };
+	bool is_ok = false;
+	const bt_error *error;
+
+	if (pthread_create(&thread_data.thread, NULL, take_thread_func,
+			&thread_data) ||
+			pthread_join(thread_data.thread, NULL)) {
+		goto end;
+	}
+
+	if (!thread_data.error ||
+			!check_unknown_causes(thread_data.error,
+				thread_data.index)) {
+		goto end;
+	}
+
+	bt_error_release(thread_data.error);
+	append_unknown_causes(11);
+	error = bt_current_thread_take_error();
+	is_ok = error && check_unknown_causes(error, 11);
+	bt_error_release(error);
+
+end:
+	ok(is_ok, "error causes of another thread's error are reusable");
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+
+	test_unknown_actor();
+	test_component_class_actor();
+	test_concurrent_threads();
+	test_release_other_thread_error();
+
+	return exit_status();
+}
@@ -0,0 +1,572 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 9
+
+/* Number of messages which the source message iterator returns */
+#define MSG_COUNT	5000
+
+enum filter_mode {
+	/* Always call bt_self_message_iterator_forward_next() */
+	FILTER_MODE_FORWARD,
+
+	/*
+	 * Alternate between bt_self_message_iterator_forward_next() and
+	 * bt_message_iterator_next(), copying the messages, and
+	 * buffering the ones which don't fit, in the latter case.
+	 */
+	FILTER_MODE_ALTERNATE,
+};
+
+struct filter_config {
+	enum filter_mode mode;
+
+	/* 0 means to keep the default maximum batch size */
+	uint64_t max_batch_size;
+};
+
+struct src_comp_data {
+	bt_clock_class *clock_class;
+
+	/* Index of the message at which to fail, or `UINT64_MAX` */
+	uint64_t fail_at;
+};
+
+struct src_iter_data {
+	const struct src_comp_data *comp_data;
+	uint64_t next_value;
+	uint64_t call_count;
+};
+
+struct flt_comp_data {
+	bt_self_component_filter *self_comp;
+	struct filter_config config;
+};
+
+struct flt_iter_data {
+	const struct flt_comp_data *comp_data;
+	bt_message_iterator *upstream_iter;
+	uint64_t call_count;
+
+	/* Messages (owned) which bt_message_iterator_next() returned */
+	GQueue *pending_msgs;
+};
+
+struct sink_data {
+	uint64_t next_value;
+	bool in_order;
+};
+
+/* Number of forwarded batches which exceeded the "next" capacity */
+static uint64_t capacity_exceeded_count;
+
+/* Number of successful bt_self_message_iterator_forward_next() calls */
+static uint64_t forward_count;
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	struct src_comp_data *comp_data = g_new0(struct src_comp_data, 1);
+	bt_self_component_add_port_status status;
+
+	BT_ASSERT(comp_data);
+	comp_data->clock_class = bt_clock_class_create(
+		bt_self_component_source_as_self_component(self_comp));
+	BT_ASSERT(comp_data->clock_class);
+	comp_data->fail_at = init_method_data ?
+		*(const uint64_t *) init_method_data : UINT64_MAX;
+	bt_self_component_set_data(
+		bt_self_component_source_as_self_component(self_comp),
+		comp_data);
+	status = bt_self_component_source_add_output_port(self_comp,
+		"out", NULL, NULL);
+	BT_ASSERT(status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp)
+{
+	struct src_comp_data *comp_data = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+
+	bt_clock_class_put_ref(comp_data->clock_class);
+	g_free(comp_data);
+}
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct src_iter_data *iter_data = g_new0(struct src_iter_data, 1);
+
+	BT_ASSERT(iter_data);
+	iter_data->comp_data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	bt_self_message_iterator_set_data(self_msg_iter, iter_data);
+
+	/* Let the source's batches grow larger than the filters' ones */
+	bt_self_message_iterator_configuration_set_max_batch_size(config,
+		1024);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	g_free(bt_self_message_iterator_get_data(self_msg_iter));
+}
+
+/*
+ * Returns message iterator inactivity messages of which the clock
+ * snapshot values are 0, 1, 2, and so on: full batches most of the
+ * time, so that the batch size grows, but also smaller ones and "try
+ * again" statuses.
+ */
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	uint64_t call_index = iter_data->call_count++;
+	uint64_t msg_count;
+	uint64_t i;
+
+	if (iter_data->next_value == MSG_COUNT) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	if (call_index % 11 == 10) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+	}
+
+	if (call_index % 8 < 5) {
+		msg_count = capacity;
+	} else {
+		msg_count = MIN(capacity, call_index % 8 - 4);
+	}
+
+	msg_count = MIN(msg_count, MSG_COUNT - iter_data->next_value);
+
+	if (iter_data->next_value <= iter_data->comp_data->fail_at &&
+			iter_data->comp_data->fail_at <
+				iter_data->next_value + msg_count) {
+		bt_current_thread_error_append_cause_from_message_iterator(
+			self_msg_iter, __FILE__, __LINE__,
+			"Failing on purpose: value=%" PRIu64,
+			iter_data->comp_data->fail_at);
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+	}
+
+	for (i = 0; i < msg_count; i++) {
+		msgs[i] = bt_message_message_iterator_inactivity_create(
+			self_msg_iter, iter_data->comp_data->clock_class,
+			iter_data->next_value);
+		BT_ASSERT(msgs[i]);
+		iter_data->next_value++;
+	}
+
+	*count = msg_count;
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_component_class_initialize_method_status flt_init(
+		bt_self_component_filter *self_comp,
+		bt_self_component_filter_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	struct flt_comp_data *comp_data = g_new0(struct flt_comp_data, 1);
+	bt_self_component_add_port_status status;
+
+	BT_ASSERT(comp_data);
+	BT_ASSERT(init_method_data);
+	comp_data->self_comp = self_comp;
+	comp_data->config = *(const struct filter_config *) init_method_data;
+	bt_self_component_set_data(
+		bt_self_component_filter_as_self_component(self_comp),
+		comp_data);
+	status = bt_self_component_filter_add_input_port(self_comp,
+		"in", NULL, NULL);
+	BT_ASSERT(status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	status = bt_self_component_filter_add_output_port(self_comp,
+		"out", NULL, NULL);
+	BT_ASSERT(status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void flt_finalize(bt_self_component_filter *self_comp)
+{
+	g_free(bt_self_component_get_data(
+		bt_self_component_filter_as_self_component(self_comp)));
+}
+
+static
+bt_message_iterator_class_initialize_method_status flt_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct flt_iter_data *iter_data = g_new0(struct flt_iter_data, 1);
+	bt_message_iterator_create_from_message_iterator_status status;
+
+	BT_ASSERT(iter_data);
+	iter_data->comp_data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	iter_data->pending_msgs = g_queue_new();
+	BT_ASSERT(iter_data->pending_msgs);
+	status = bt_message_iterator_create_from_message_iterator(
+		self_msg_iter,
+		bt_self_component_filter_borrow_input_port_by_name(
+			iter_data->comp_data->self_comp, "in"),
+		&iter_data->upstream_iter);
+	BT_ASSERT(status ==
+		BT_MESSAGE_ITERATOR_CREATE_FROM_MESSAGE_ITERATOR_STATUS_OK);
+	bt_self_message_iterator_set_data(self_msg_iter, iter_data);
+
+	if (iter_data->comp_data->config.max_batch_size > 0) {
+		bt_self_message_iterator_configuration_set_max_batch_size(
+			config, iter_data->comp_data->config.max_batch_size);
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void flt_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	struct flt_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	while (!g_queue_is_empty(iter_data->pending_msgs)) {
+		bt_message_put_ref(g_queue_pop_head(iter_data->pending_msgs));
+	}
+
+	g_queue_free(iter_data->pending_msgs);
+	bt_message_iterator_put_ref(iter_data->upstream_iter);
+	g_free(iter_data);
+}
+
+static
+bt_message_iterator_class_next_method_status next_status_from_iter_status(
+		bt_message_iterator_next_status status)
+{
+	switch (status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_MEMORY_ERROR:
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+	default:
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+	}
+}
+
+static
+bt_message_iterator_class_next_method_status flt_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct flt_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	uint64_t call_index = iter_data->call_count++;
+	bt_message_iterator_next_status status;
+	bt_message_array_const upstream_msgs;
+	uint64_t upstream_count;
+	uint64_t i;
+
+	/* Messages which didn't fit in a previous call go first */
+	if (!g_queue_is_empty(iter_data->pending_msgs)) {
+		for (i = 0; i < capacity &&
+				!g_queue_is_empty(iter_data->pending_msgs); i++) {
+			msgs[i] = g_queue_pop_head(iter_data->pending_msgs);
+		}
+
+		*count = i;
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	}
+
+	if (iter_data->comp_data->config.mode == FILTER_MODE_FORWARD ||
+			call_index % 2 == 0) {
+		status = bt_self_message_iterator_forward_next(self_msg_iter,
+			iter_data->upstream_iter, count);
+		if (status == BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
+			forward_count++;
+
+			if (*count == 0 || *count > capacity) {
+				capacity_exceeded_count++;
+			}
+
+			return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+		}
+
+		return next_status_from_iter_status(status);
+	}
+
+	status = bt_message_iterator_next(iter_data->upstream_iter,
+		&upstream_msgs, &upstream_count);
+	if (status != BT_MESSAGE_ITERATOR_NEXT_STATUS_OK) {
+		return next_status_from_iter_status(status);
+	}
+
+	for (i = 0; i < upstream_count; i++) {
+		if (i < capacity) {
+			msgs[i] = upstream_msgs[i];
+		} else {
+			g_queue_push_tail(iter_data->pending_msgs,
+				(void *) upstream_msgs[i]);
+		}
+	}
+
+	*count = MIN(upstream_count, capacity);
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *iterator, void *data)
+{
+	struct sink_data *sink_data = data;
+	bt_message_iterator_next_status status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	status = bt_message_iterator_next(iterator, &msgs, &count);
+	switch (status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_AGAIN;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_MEMORY_ERROR:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_MEMORY_ERROR;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		const bt_message *msg = msgs[i];
+
+		if (bt_message_get_type(msg) !=
+				BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY ||
+				bt_clock_snapshot_get_value(
+					bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(msg)) !=
+					sink_data->next_value) {
+			sink_data->in_order = false;
+		}
+
+		sink_data->next_value++;
+		bt_message_put_ref(msg);
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+/*
+ * Runs a graph of which a source message iterator returns `MSG_COUNT`
+ * messages, through filters configured with the `filter_count`
+ * configurations `filter_configs`, to a simple sink.
+ *
+ * If `fail_at` is not `UINT64_MAX`, the source message iterator fails
+ * when it would return the message having this index.
+ *
+ * Returns the graph's run status and sets `*sink_data`.
+ */
+static
+bt_graph_run_status run_graph(const struct filter_config *filter_configs,
+		unsigned int filter_count, uint64_t fail_at,
+		struct sink_data *sink_data)
+{
+	bt_message_iterator_class *src_msg_iter_cls;
+	bt_message_iterator_class *flt_msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_filter *flt_comp_cls;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	const bt_port_output *out_port;
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+	unsigned int i;
+
+	src_msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(src_msg_iter_cls);
+	BT_ASSERT(bt_message_iterator_class_set_initialize_method(
+		src_msg_iter_cls, src_iter_init) ==
+		BT_MESSAGE_ITERATOR_CLASS_SET_METHOD_STATUS_OK);
+	BT_ASSERT(bt_message_iterator_class_set_finalize_method(
+		src_msg_iter_cls, src_iter_finalize) ==
+		BT_MESSAGE_ITERATOR_CLASS_SET_METHOD_STATUS_OK);
+	src_comp_cls = bt_component_class_source_create("src",
+		src_msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	BT_ASSERT(bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init) ==
+		BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	BT_ASSERT(bt_component_class_source_set_finalize_method(
+		src_comp_cls, src_finalize) ==
+		BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+
+	flt_msg_iter_cls = bt_message_iterator_class_create(flt_iter_next);
+	BT_ASSERT(flt_msg_iter_cls);
+	BT_ASSERT(bt_message_iterator_class_set_initialize_method(
+		flt_msg_iter_cls, flt_iter_init) ==
+		BT_MESSAGE_ITERATOR_CLASS_SET_METHOD_STATUS_OK);
+	BT_ASSERT(bt_message_iterator_class_set_finalize_method(
+		flt_msg_iter_cls, flt_iter_finalize) ==
+		BT_MESSAGE_ITERATOR_CLASS_SET_METHOD_STATUS_OK);
+	flt_comp_cls = bt_component_class_filter_create("flt",
+		flt_msg_iter_cls);
+	BT_ASSERT(flt_comp_cls);
+	BT_ASSERT(bt_component_class_filter_set_initialize_method(
+		flt_comp_cls, flt_init) ==
+		BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	BT_ASSERT(bt_component_class_filter_set_finalize_method(
+		flt_comp_cls, flt_finalize) ==
+		BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	BT_ASSERT(bt_graph_add_source_component_with_initialize_method_data(
+		graph, src_comp_cls, "src", NULL,
+		fail_at == UINT64_MAX ? NULL : &fail_at,
+		BT_LOGGING_LEVEL_NONE, &src_comp) ==
+		BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	out_port = bt_component_source_borrow_output_port_by_index_const(
+		src_comp, 0);
+
+	for (i = 0; i < filter_count; i++) {
+		const bt_component_filter *flt_comp;
+		char name[16];
+
+		sprintf(name, "flt%u", i);
+		BT_ASSERT(bt_graph_add_filter_component_with_initialize_method_data(
+			graph, flt_comp_cls, name, NULL,
+			(void *) &filter_configs[i], BT_LOGGING_LEVEL_NONE,
+			&flt_comp) == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+		BT_ASSERT(bt_graph_connect_ports(graph, out_port,
+			bt_component_filter_borrow_input_port_by_index_const(
+				flt_comp, 0), NULL) ==
+			BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+		out_port = bt_component_filter_borrow_output_port_by_index_const(
+			flt_comp, 0);
+	}
+
+	sink_data->next_value = 0;
+	sink_data->in_order = true;
+	BT_ASSERT(bt_graph_add_simple_sink_component(graph, "sink", NULL,
+		sink_consume, NULL, sink_data, &sink_comp) ==
+		BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	BT_ASSERT(bt_graph_connect_ports(graph, out_port,
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0), NULL) == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+
+	do {
+		run_status = bt_graph_run(graph);
+	} while (run_status == BT_GRAPH_RUN_STATUS_AGAIN);
+
+	bt_graph_put_ref(graph);
+	bt_component_class_filter_put_ref(flt_comp_cls);
+	bt_message_iterator_class_put_ref(flt_msg_iter_cls);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(src_msg_iter_cls);
+	return run_status;
+}
+
+static
+void test_filters(const char *desc, const struct filter_config *filter_configs,
+		unsigned int filter_count)
+{
+	struct sink_data sink_data;
+	bt_graph_run_status run_status;
+
+	capacity_exceeded_count = 0;
+	forward_count = 0;
+	run_status = run_graph(filter_configs, filter_count, UINT64_MAX,
+		&sink_data);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK && sink_data.in_order &&
+		sink_data.next_value == MSG_COUNT,
+		"sink gets all the messages in order: %s", desc);
+	ok(forward_count > 0 && capacity_exceeded_count == 0,
+		"forwarded batches are within the \"next\" capacity: %s", desc);
+}
+
+static
+void test_upstream_error(void)
+{
+	static const struct filter_config filter_configs[] = {
+		{ FILTER_MODE_FORWARD, 0 },
+		{ FILTER_MODE_FORWARD, 0 },
+	};
+	struct sink_data sink_data;
+	bt_graph_run_status run_status;
+	const bt_error *error;
+
+	run_status = run_graph(filter_configs, 2, MSG_COUNT / 2, &sink_data);
+	error = bt_current_thread_take_error();
+	ok(run_status == BT_GRAPH_RUN_STATUS_ERROR && error &&
+		sink_data.in_order && sink_data.next_value <= MSG_COUNT / 2,
+		"upstream error goes through forwarding filters");
+
+	if (error) {
+		bt_error_release(error);
+	}
+}
+
+int main(void)
+{
+	static const struct filter_config forward[] = {
+		{ FILTER_MODE_FORWARD, 0 },
+	};
+	static const struct filter_config forward_forward[] = {
+		{ FILTER_MODE_FORWARD, 0 },
+		{ FILTER_MODE_FORWARD, 0 },
+	};
+	static const struct filter_config alternate_forward[] = {
+		{ FILTER_MODE_ALTERNATE, 0 },
+		{ FILTER_MODE_FORWARD, 0 },
+	};
+	static const struct filter_config mixed_batch_sizes[] = {
+		{ FILTER_MODE_FORWARD, 64 },
+		{ FILTER_MODE_ALTERNATE, 1024 },
+		{ FILTER_MODE_FORWARD, 0 },
+	};
+
+	plan_tests(NR_TESTS);
+
+	test_filters("one forwarding filter", forward,
+		G_N_ELEMENTS(forward));
+	test_filters("two forwarding filters", forward_forward,
+		G_N_ELEMENTS(forward_forward));
+	test_filters("alternating and forwarding filters", alternate_forward,
+		G_N_ELEMENTS(alternate_forward));
+	test_filters("filters with different maximum batch sizes",
+		mixed_batch_sizes, G_N_ELEMENTS(mixed_batch_sizes));
+	test_upstream_error();
+
+	return exit_status();
+}
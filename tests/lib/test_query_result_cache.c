@@ -0,0 +1,296 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 10
+
+/* More distinct parameters than the capacity of a result cache */
+#define PARAM_COUNT	80
+
+#define THREAD_COUNT	8
+#define QUERIES_PER_THREAD	500
+
+static gint query_method_call_count;
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+/*
+ * Creates the expected query result for the query parameters
+ * `{"index": index}`.
+ */
+static
+bt_value *create_expected_result(int64_t index)
+{
+	bt_value *result = bt_value_map_create();
+	bt_value *array;
+	int64_t i;
+
+	BT_ASSERT(result);
+	BT_ASSERT(bt_value_map_insert_signed_integer_entry(result, "index",
+		index) == BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK);
+	BT_ASSERT(bt_value_map_insert_string_entry(result, "name",
+		"query-result-cache") == BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK);
+	BT_ASSERT(bt_value_map_insert_empty_array_entry(result, "items",
+		&array) == BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK);
+
+	for (i = 0; i < 16; i++) {
+		BT_ASSERT(bt_value_array_append_signed_integer_element(array,
+			index * 16 + i) ==
+			BT_VALUE_ARRAY_APPEND_ELEMENT_STATUS_OK);
+	}
+
+	return result;
+}
+
+static
+bt_component_class_query_method_status src_query(
+		bt_self_component_class_source *self_comp_cls,
+		bt_private_query_executor *priv_query_exec,
+		const char *object, const bt_value *params,
+		void *method_data, const bt_value **result)
+{
+	const bt_value *index;
+
+	g_atomic_int_inc(&query_method_call_count);
+	BT_ASSERT(bt_value_is_map(params));
+	index = bt_value_map_borrow_entry_value_const(params, "index");
+	BT_ASSERT(index);
+	*result = create_expected_result(
+		bt_value_integer_signed_get(index));
+	bt_private_query_executor_set_result_is_cacheable(priv_query_exec);
+	return BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_OK;
+}
+
+static
+bt_component_class_source *create_comp_cls(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *comp_cls;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(comp_cls);
+	BT_ASSERT(bt_component_class_source_set_query_method(comp_cls,
+		src_query) == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return comp_cls;
+}
+
+/*
+ * Creates a query executor, using the result cache, to query the
+ * object `obj` of `comp_cls` with the parameters `{"index": index}`.
+ */
+static
+bt_query_executor *create_query_exec(
+		const bt_component_class_source *comp_cls, int64_t index)
+{
+	bt_value *params = bt_value_map_create();
+	bt_query_executor *query_exec;
+
+	BT_ASSERT(params);
+	BT_ASSERT(bt_value_map_insert_signed_integer_entry(params, "index",
+		index) == BT_VALUE_MAP_INSERT_ENTRY_STATUS_OK);
+	query_exec = bt_query_executor_create(
+		bt_component_class_source_as_component_class_const(comp_cls),
+		"obj", params);
+	BT_ASSERT(query_exec);
+	bt_query_executor_set_uses_result_cache(query_exec, BT_TRUE);
+	bt_value_put_ref(params);
+	return query_exec;
+}
+
+static
+const bt_value *run_query_exec(bt_query_executor *query_exec)
+{
+	const bt_value *result = NULL;
+	bt_query_executor_query_status status;
+
+	status = bt_query_executor_query(query_exec, &result);
+	BT_ASSERT(status == BT_QUERY_EXECUTOR_QUERY_STATUS_OK);
+	return result;
+}
+
+static
+const bt_value *query(const bt_component_class_source *comp_cls,
+		int64_t index)
+{
+	bt_query_executor *query_exec = create_query_exec(comp_cls, index);
+	const bt_value *result = run_query_exec(query_exec);
+
+	bt_query_executor_put_ref(query_exec);
+	return result;
+}
+
+static
+void test_cache_hit(const bt_component_class_source *comp_cls)
+{
+	const bt_value *result_a;
+	const bt_value *result_b;
+	bt_value *expected = create_expected_result(1000);
+	gint call_count;
+
+	g_atomic_int_set(&query_method_call_count, 0);
+	result_a = query(comp_cls, 1000);
+	result_b = query(comp_cls, 1000);
+	call_count = g_atomic_int_get(&query_method_call_count);
+	ok(call_count == 1,
+		"second identical query uses the cached result");
+	ok(bt_value_is_equal(result_a, expected),
+		"first result is the expected one");
+	ok(bt_value_is_equal(result_b, expected),
+		"cached result is the expected one");
+	ok(result_a != result_b,
+		"cached result is a copy");
+	bt_value_put_ref(result_a);
+
+	/* The cached result doesn't depend on the returned copies */
+	result_a = query(comp_cls, 1000);
+	ok(g_atomic_int_get(&query_method_call_count) == 1 &&
+		bt_value_is_equal(result_a, expected),
+		"cached result survives putting a returned copy");
+	bt_value_put_ref(result_a);
+	bt_value_put_ref(result_b);
+
+	result_a = query(comp_cls, 1001);
+	ok(g_atomic_int_get(&query_method_call_count) == 2,
+		"query with other parameters calls the query method");
+	bt_value_put_ref(result_a);
+	bt_value_put_ref(expected);
+}
+
+/*
+ * Like the CLI does for its `babeltrace.trace-infos` queries, the
+ * main thread creates the query executors, with their references on
+ * the component class and on the parameters, and the query threads
+ * only run them.
+ */
+struct thread_data {
+	pthread_t thread;
+	int64_t indexes[QUERIES_PER_THREAD];
+	bt_query_executor *query_execs[QUERIES_PER_THREAD];
+	uint64_t mismatch_count;
+};
+
+static
+void *thread_func(void *data)
+{
+	struct thread_data *thread_data = data;
+	bt_value *expected[PARAM_COUNT];
+	int64_t i;
+
+	for (i = 0; i < PARAM_COUNT; i++) {
+		expected[i] = create_expected_result(i);
+	}
+
+	for (i = 0; i < QUERIES_PER_THREAD; i++) {
+		const bt_value *result =
+			run_query_exec(thread_data->query_execs[i]);
+
+		if (!bt_value_is_equal(result,
+				expected[thread_data->indexes[i]])) {
+			thread_data->mismatch_count++;
+		}
+
+		bt_value_put_ref(result);
+	}
+
+	for (i = 0; i < PARAM_COUNT; i++) {
+		bt_value_put_ref(expected[i]);
+	}
+
+	return NULL;
+}
+
+static
+void test_concurrent_queries(const bt_component_class_source *comp_cls)
+{
+	struct thread_data *threads = g_new0(struct thread_data,
+		THREAD_COUNT);
+	unsigned int seed = 1;
+	uint64_t mismatch_count = 0;
+	bool create_ok = true;
+	bool join_ok = true;
+	gint call_count;
+	unsigned int i, j;
+
+	BT_ASSERT(threads);
+	g_atomic_int_set(&query_method_call_count, 0);
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		for (j = 0; j < QUERIES_PER_THREAD; j++) {
+			/*
+			 * With more distinct parameters than the
+			 * capacity of the cache, some queries also
+			 * empty the cache while other threads use its
+			 * results.
+			 */
+			threads[i].indexes[j] = rand_r(&seed) % PARAM_COUNT;
+			threads[i].query_execs[j] = create_query_exec(comp_cls,
+				threads[i].indexes[j]);
+		}
+	}
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		if (pthread_create(&threads[i].thread, NULL, thread_func,
+				&threads[i])) {
+			create_ok = false;
+			break;
+		}
+	}
+
+	ok(create_ok, "created %u query threads", THREAD_COUNT);
+	BT_ASSERT(create_ok);
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		if (pthread_join(threads[i].thread, NULL)) {
+			join_ok = false;
+		}
+
+		mismatch_count += threads[i].mismatch_count;
+
+		for (j = 0; j < QUERIES_PER_THREAD; j++) {
+			bt_query_executor_put_ref(threads[i].query_execs[j]);
+		}
+	}
+
+	ok(join_ok, "joined the query threads");
+	ok(mismatch_count == 0,
+		"all concurrent queries return the expected result");
+	call_count = g_atomic_int_get(&query_method_call_count);
+	ok(call_count > 0 &&
+		call_count < THREAD_COUNT * QUERIES_PER_THREAD,
+		"concurrent queries use cached results (query method "
+		"calls: %d)", call_count);
+	g_free(threads);
+}
+
+int main(void)
+{
+	bt_component_class_source *comp_cls;
+
+	plan_tests(NR_TESTS);
+	comp_cls = create_comp_cls();
+	test_cache_hit(comp_cls);
+	test_concurrent_queries(comp_cls);
+	bt_component_class_source_put_ref(comp_cls);
+	return exit_status();
+}
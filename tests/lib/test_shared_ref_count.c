@@ -0,0 +1,330 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2022 EfficiOS Inc.
+ *
+ * Concurrent reference counting of shared trace IR objects
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "lib/object.h"
+#include "common/assert.h"
+#include <glib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 7
+
+#define THREAD_COUNT	4
+#define CYCLES_PER_THREAD	100000
+
+/* Objects of which the threads get and put references */
+struct objects {
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_event_class *ec;
+	bt_clock_class *cc;
+	bt_field_class *fc;
+	bt_trace *trace;
+	bt_stream *stream;
+};
+
+static
+void get_put_objects(const struct objects *objs)
+{
+	bt_trace_class_get_ref(objs->tc);
+	bt_stream_class_get_ref(objs->sc);
+	bt_clock_class_get_ref(objs->cc);
+	bt_field_class_get_ref(objs->fc);
+	bt_trace_get_ref(objs->trace);
+	bt_stream_get_ref(objs->stream);
+	bt_stream_put_ref(objs->stream);
+	bt_trace_put_ref(objs->trace);
+	bt_field_class_put_ref(objs->fc);
+	bt_clock_class_put_ref(objs->cc);
+	bt_stream_class_put_ref(objs->sc);
+	bt_trace_class_put_ref(objs->tc);
+}
+
+static
+void *get_put_objects_thread_func(void *data)
+{
+	const struct objects *objs = data;
+	unsigned int i;
+
+	for (i = 0; i < CYCLES_PER_THREAD; i++) {
+		get_put_objects(objs);
+	}
+
+	return NULL;
+}
+
+/*
+ * Borrows the event class, which only its stream class owns, from its
+ * stream class, and takes and releases references to it: the thread
+ * which makes its reference count go from 0 to 1 takes a reference to
+ * its stream class.
+ */
+static
+void *revive_event_class_thread_func(void *data)
+{
+	const struct objects *objs = data;
+	unsigned int i;
+
+	for (i = 0; i < CYCLES_PER_THREAD; i++) {
+		bt_event_class *ec =
+			bt_stream_class_borrow_event_class_by_index(
+				objs->sc, 0);
+
+		bt_event_class_get_ref(ec);
+		bt_event_class_get_ref(ec);
+		bt_event_class_put_ref(ec);
+		bt_event_class_put_ref(ec);
+	}
+
+	return NULL;
+}
+
+static
+void run_threads(void *(*func)(void *), struct objects *objs)
+{
+	pthread_t threads[THREAD_COUNT];
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		ret = pthread_create(&threads[i], NULL, func, objs);
+		BT_ASSERT(ret == 0);
+	}
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		ret = pthread_join(threads[i], NULL);
+		BT_ASSERT(ret == 0);
+	}
+}
+
+static
+unsigned long long ref_count(const void *obj)
+{
+	return bt_object_get_ref_count(obj);
+}
+
+static
+void create_objects(bt_self_component *self_comp, struct objects *objs)
+{
+	int ret;
+
+	objs->tc = bt_trace_class_create(self_comp);
+	BT_ASSERT(objs->tc);
+	objs->cc = bt_clock_class_create(self_comp);
+	BT_ASSERT(objs->cc);
+	objs->sc = bt_stream_class_create(objs->tc);
+	BT_ASSERT(objs->sc);
+	ret = bt_stream_class_set_default_clock_class(objs->sc, objs->cc);
+	BT_ASSERT(ret == 0);
+	objs->ec = bt_event_class_create(objs->sc);
+	BT_ASSERT(objs->ec);
+	objs->fc = bt_field_class_structure_create(objs->tc);
+	BT_ASSERT(objs->fc);
+	ret = bt_event_class_set_payload_field_class(objs->ec, objs->fc);
+	BT_ASSERT(ret == 0);
+	objs->trace = bt_trace_create(objs->tc);
+	BT_ASSERT(objs->trace);
+	objs->stream = bt_stream_create(objs->sc, objs->trace);
+	BT_ASSERT(objs->stream);
+}
+
+/* Reference counts of the objects of a `struct objects` */
+struct ref_counts {
+	unsigned long long tc, sc, ec, cc, fc, trace, stream;
+};
+
+static
+void get_ref_counts(const struct objects *objs, struct ref_counts *counts)
+{
+	counts->tc = ref_count(objs->tc);
+	counts->sc = ref_count(objs->sc);
+	counts->ec = ref_count(objs->ec);
+	counts->cc = ref_count(objs->cc);
+	counts->fc = ref_count(objs->fc);
+	counts->trace = ref_count(objs->trace);
+	counts->stream = ref_count(objs->stream);
+}
+
+/*
+ * Returns whether or not the current reference counts of `objs` are
+ * `counts`.
+ */
+static
+bool ref_counts_are(const struct objects *objs,
+		const struct ref_counts *counts)
+{
+	struct ref_counts cur_counts;
+
+	get_ref_counts(objs, &cur_counts);
+	return cur_counts.tc == counts->tc && cur_counts.sc == counts->sc &&
+		cur_counts.ec == counts->ec && cur_counts.cc == counts->cc &&
+		cur_counts.fc == counts->fc &&
+		cur_counts.trace == counts->trace &&
+		cur_counts.stream == counts->stream;
+}
+
+struct destruction_data {
+	bool destroyed;
+	pthread_t thread;
+};
+
+static
+void trace_class_destroyed(const bt_trace_class *tc, void *data)
+{
+	struct destruction_data *destruction_data = data;
+
+	destruction_data->destroyed = true;
+	destruction_data->thread = pthread_self();
+}
+
+static
+void *put_trace_class_thread_func(void *data)
+{
+	bt_trace_class_put_ref(data);
+	return NULL;
+}
+
+/*
+ * Releases the last reference to a trace class, and therefore to its
+ * stream and event classes, from another thread than the one which
+ * created it.
+ */
+static
+void test_release_from_other_thread(bt_self_component *self_comp)
+{
+	struct objects objs;
+	struct destruction_data destruction_data = { 0 };
+	pthread_t thread;
+	bt_trace_class_add_listener_status status;
+	int ret;
+
+	create_objects(self_comp, &objs);
+	status = bt_trace_class_add_destruction_listener(objs.tc,
+		trace_class_destroyed, &destruction_data, NULL);
+	BT_ASSERT(status == BT_TRACE_CLASS_ADD_LISTENER_STATUS_OK);
+
+	/* The trace class is the last owner */
+	bt_stream_put_ref(objs.stream);
+	bt_trace_put_ref(objs.trace);
+	bt_field_class_put_ref(objs.fc);
+	bt_clock_class_put_ref(objs.cc);
+	bt_event_class_put_ref(objs.ec);
+	bt_stream_class_put_ref(objs.sc);
+
+	ret = pthread_create(&thread, NULL, put_trace_class_thread_func,
+		objs.tc);
+	BT_ASSERT(ret == 0);
+	ret = pthread_join(thread, NULL);
+	BT_ASSERT(ret == 0);
+	ok(destruction_data.destroyed &&
+		pthread_equal(destruction_data.thread, thread),
+		"Putting the last reference from another thread destroys the trace class in that thread");
+}
+
+static
+void test_concurrent_ref_counts(bt_self_component *self_comp)
+{
+	struct objects objs;
+	struct ref_counts counts;
+	pthread_t get_put_thread, revive_thread;
+	int ret;
+
+	create_objects(self_comp, &objs);
+
+	/* Own references to all the objects, except the event class */
+	bt_event_class_put_ref(objs.ec);
+	ok(ref_count(objs.ec) == 0,
+		"Event class is only owned by its stream class");
+	get_ref_counts(&objs, &counts);
+
+	run_threads(get_put_objects_thread_func, &objs);
+	ok(ref_counts_are(&objs, &counts),
+		"Concurrent reference updates give back the initial reference counts");
+
+	run_threads(revive_event_class_thread_func, &objs);
+	ok(ref_count(objs.ec) == 0,
+		"Concurrent revivals of a child object leave its reference count at 0");
+	ok(ref_count(objs.sc) == counts.sc,
+		"Concurrent revivals of a child object leave its parent's reference count intact");
+	ok(ref_counts_are(&objs, &counts),
+		"Concurrent revivals of a child object give back the initial reference counts");
+
+	/* Mix both kinds of concurrent updates */
+	ret = pthread_create(&get_put_thread, NULL,
+		get_put_objects_thread_func, &objs);
+	BT_ASSERT(ret == 0);
+	ret = pthread_create(&revive_thread, NULL,
+		revive_event_class_thread_func, &objs);
+	BT_ASSERT(ret == 0);
+	ret = pthread_join(get_put_thread, NULL);
+	BT_ASSERT(ret == 0);
+	ret = pthread_join(revive_thread, NULL);
+	BT_ASSERT(ret == 0);
+	ok(ref_counts_are(&objs, &counts),
+		"Concurrent revivals and reference updates of the parent give back the initial reference counts");
+
+	bt_stream_put_ref(objs.stream);
+	bt_trace_put_ref(objs.trace);
+	bt_field_class_put_ref(objs.fc);
+	bt_clock_class_put_ref(objs.cc);
+	bt_stream_class_put_ref(objs.sc);
+	bt_trace_class_put_ref(objs.tc);
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+	bt_self_component_source *self_comp,
+	bt_self_component_source_configuration *config,
+	const bt_value *params, void *init_method_data)
+{
+	test_concurrent_ref_counts(
+		bt_self_component_source_as_self_component(self_comp));
+	test_release_from_other_thread(
+		bt_self_component_source_as_self_component(self_comp));
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_iterator,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+}
+
+int main(int argc, char **argv)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *comp_cls;
+	bt_graph *graph;
+	int ret;
+
+	plan_tests(NR_TESTS);
+
+	/* The component's initialization method runs the tests */
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_initialize_method(comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component(graph, comp_cls, "src-comp",
+		NULL, BT_LOGGING_LEVEL_NONE, NULL);
+	BT_ASSERT(ret == 0);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return exit_status();
+}
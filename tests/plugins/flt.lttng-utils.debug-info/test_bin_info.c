@@ -24,7 +24,7 @@
 
 #include "tap/tap.h"
 
-#define NR_TESTS 57
+#define NR_TESTS 76
 
 #define SO_NAME "libhello_so"
 #define DEBUG_NAME "libhello_so.debug"
@@ -194,6 +194,7 @@ static
 void test_bin_info_build_id(const char *bin_info_dir)
 {
 	int ret;
+	char *_func_name;
 	char *data_dir, *bin_path;
 	struct bin_info *bin = NULL;
 	struct bt_fd_cache fdc;
@@ -218,7 +219,7 @@ void test_bin_info_build_id(const char *bin_info_dir)
 		exit(EXIT_FAILURE);
 	}
 
-	bin = bin_info_create(&fdc, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
+	bin = bin_info_create(&fdc, NULL, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
 			      data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
 	ok(bin, "bin_info_create successful (%s)", bin_path);
 
@@ -242,6 +243,31 @@ void test_bin_info_build_id(const char *bin_info_dir)
 				       opt_func_foo_printf_line_no,
 				       FUNC_FOO_FILENAME);
 
+	bin_info_destroy(bin);
+
+	bin = bin_info_create(&fdc, NULL, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
+			      data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
+	ok(bin, "bin_info_create successful (%s)", bin_path);
+
+	/* Test deferring an invalid build_id */
+	ret = bin_info_set_build_id_deferred(bin, invalid_build_id,
+		BUILD_ID_HEX_LEN);
+	ok(ret == 0, "bin_info_set_build_id_deferred successful");
+	ok(!bin->build_id, "bin_info_set_build_id_deferred - build_id not checked yet");
+	_func_name = NULL;
+	ret = bin_info_lookup_function_name(bin, func_foo_printf_addr,
+		&_func_name);
+	ok(ret == -1 && !_func_name,
+	   "bin_info_lookup_function_name - fail on deferred invalid build_id");
+
+	/* Test deferring the correct build_id */
+	ret = bin_info_set_build_id_deferred(bin, build_id, BUILD_ID_HEX_LEN);
+	ok(ret == 0, "bin_info_set_build_id_deferred successful");
+
+	/* Test function name lookup (with DWARF) */
+	subtest_lookup_function_name(bin, func_foo_printf_addr,
+				     func_foo_printf_name);
+
 	bin_info_destroy(bin);
 	bt_fd_cache_fini(&fdc);
 	g_free(data_dir);
@@ -272,7 +298,7 @@ void test_bin_info_debug_link(const char *bin_info_dir)
 		exit(EXIT_FAILURE);
 	}
 
-	bin = bin_info_create(&fdc, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
+	bin = bin_info_create(&fdc, NULL, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
 		data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
 	ok(bin, "bin_info_create successful (%s)", bin_path);
 
@@ -322,7 +348,7 @@ void test_bin_info_elf(const char *bin_info_dir)
 		exit(EXIT_FAILURE);
 	}
 
-	bin = bin_info_create(&fdc, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
+	bin = bin_info_create(&fdc, NULL, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
 		data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
 	ok(bin, "bin_info_create successful (%s)", bin_path);
 
@@ -370,7 +396,7 @@ void test_bin_info_bundled(const char *bin_info_dir)
 		exit(EXIT_FAILURE);
 	}
 
-	bin = bin_info_create(&fdc, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
+	bin = bin_info_create(&fdc, NULL, bin_path, SO_LOW_ADDR, SO_MEMSZ, true,
 		data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
 	ok(bin, "bin_info_create successful (%s)", bin_path);
 
@@ -397,6 +423,77 @@ void test_bin_info_bundled(const char *bin_info_dir)
 	g_free(bin_path);
 }
 
+static
+void test_bin_info_shared(const char *bin_info_dir)
+{
+	int ret;
+	char *data_dir, *bin_path;
+	char *_func_name = NULL;
+	struct source_location *src_loc = NULL;
+	struct bin_info *bin = NULL, *other_bin = NULL;
+	struct bin_info_registry *registry;
+	struct bt_fd_cache fdc;
+	const uint64_t other_offset = 2 * SO_MEMSZ;
+
+	diag("bin-info tests - executable shared by bin infos");
+
+	data_dir = g_build_filename(bin_info_dir, DWARF_DIR_NAME, NULL);
+	bin_path =
+		g_build_filename(bin_info_dir, DWARF_DIR_NAME, SO_NAME, NULL);
+
+	if (!data_dir || !bin_path) {
+		exit(EXIT_FAILURE);
+	}
+
+	ret = bt_fd_cache_init(&fdc, BT_LOG_OUTPUT_LEVEL);
+	if (ret != 0) {
+		diag("Failed to initialize FD cache");
+		exit(EXIT_FAILURE);
+	}
+
+	registry = bin_info_registry_create();
+	ok(registry, "bin_info_registry_create successful");
+
+	/* Same executable loaded at two base addresses */
+	bin = bin_info_create(&fdc, registry, bin_path, SO_LOW_ADDR, SO_MEMSZ,
+		true, data_dir, NULL, BT_LOG_OUTPUT_LEVEL, NULL);
+	ok(bin, "bin_info_create successful (%s)", bin_path);
+	other_bin = bin_info_create(&fdc, registry, bin_path,
+		SO_LOW_ADDR + other_offset, SO_MEMSZ, true, data_dir, NULL,
+		BT_LOG_OUTPUT_LEVEL, NULL);
+	ok(other_bin, "bin_info_create successful (%s, other base address)",
+	   bin_path);
+
+	/* Test function name lookup (with DWARF) */
+	subtest_lookup_function_name(bin, func_foo_printf_addr,
+				     func_foo_printf_name);
+
+	/* Test lookups relative to the other base address */
+	ret = bin_info_lookup_function_name(other_bin,
+		func_foo_printf_addr + other_offset, &_func_name);
+	ok(ret == 0, "bin_info_lookup_function_name successful (other base address)");
+	ok(_func_name && strcmp(_func_name, func_foo_printf_name) == 0,
+	   "bin_info_lookup_function_name - correct function name (other base address)");
+	free(_func_name);
+
+	ret = bin_info_lookup_source_location(other_bin,
+		func_foo_printf_addr + other_offset, &src_loc);
+	ok(ret == 0, "bin_info_lookup_source_location successful (other base address)");
+	ok(src_loc && src_loc->line_no == opt_func_foo_printf_line_no,
+	   "bin_info_lookup_source_location - correct line_no (other base address)");
+	source_location_destroy(src_loc);
+
+	ok(bin->image && bin->image == other_bin->image,
+	   "bin infos of the same executable share their image");
+
+	bin_info_destroy(bin);
+	bin_info_destroy(other_bin);
+	bin_info_registry_destroy(registry);
+	bt_fd_cache_fini(&fdc);
+	g_free(data_dir);
+	g_free(bin_path);
+}
+
 int main(int argc, char **argv)
 {
 	int ret;
@@ -434,6 +531,7 @@ int main(int argc, char **argv)
 	test_bin_info_bundled(opt_debug_info_dir);
 	test_bin_info_build_id(opt_debug_info_dir);
 	test_bin_info_debug_link(opt_debug_info_dir);
+	test_bin_info_shared(opt_debug_info_dir);
 
 	status = EXIT_SUCCESS;
 
@@ -0,0 +1,233 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+
+import os
+import struct
+import tempfile
+import unittest
+import bt2
+
+
+class _EventsIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        comp = self._component
+        tc = comp._create_trace_class()
+        cc = comp._create_clock_class(frequency=1000000000)
+        sc = tc.create_stream_class(default_clock_class=cc)
+        enum_fc = tc.create_unsigned_enumeration_field_class(8)
+        enum_fc.add_mapping('low', bt2.UnsignedIntegerRangeSet([(0, 3)]))
+        enum_fc.add_mapping('odd', bt2.UnsignedIntegerRangeSet([(1, 1), (3, 3)]))
+        payload_fc = tc.create_structure_field_class()
+        payload_fc += [
+            ('my_enum', enum_fc),
+            ('my_int', tc.create_signed_integer_field_class(32)),
+            ('my_str', tc.create_string_field_class()),
+            ('my_real', tc.create_double_precision_real_field_class()),
+            (
+                'my_opt',
+                tc.create_option_without_selector_field_class(
+                    tc.create_unsigned_integer_field_class(16)
+                ),
+            ),
+            (
+                'my_array',
+                tc.create_static_array_field_class(
+                    tc.create_unsigned_integer_field_class(8), 2
+                ),
+            ),
+        ]
+        ec = sc.create_event_class(name='my-event', payload_field_class=payload_fc)
+        stream = tc().create_stream(sc)
+        self._msgs = [self._create_stream_beginning_message(stream)]
+
+        for i in range(comp._event_count):
+            msg = self._create_event_message(ec, stream, 1000 * i)
+            payload = msg.event.payload_field
+            payload['my_enum'] = i % 6
+            payload['my_int'] = -i
+            payload['my_str'] = 'str-{}'.format(i % 10)
+            payload['my_real'] = i / 2
+            payload['my_array'] = [i % 256, 0]
+
+            if i % 2:
+                payload['my_opt'].value = i
+            else:
+                payload['my_opt'].has_field = False
+
+            self._msgs.append(msg)
+
+        self._msgs.append(self._create_stream_end_message(stream))
+        self._msgs.reverse()
+
+    def __next__(self):
+        if not self._msgs:
+            raise StopIteration
+
+        return self._msgs.pop()
+
+
+class _EventsSrc(bt2._UserSourceComponent, message_iterator_class=_EventsIter):
+    def __init__(self, config, params, obj):
+        self._event_count = obj
+        self._add_output_port('out')
+
+
+# Minimal FlatBuffers table reader, enough to walk the Arrow IPC
+# messages.
+class _Table:
+    def __init__(self, buf, pos):
+        self._buf = buf
+        self._pos = pos
+        self._vtable = pos - struct.unpack_from('<i', buf, pos)[0]
+        self._vtable_size = struct.unpack_from('<H', buf, self._vtable)[0]
+
+    def _field_pos(self, index):
+        offset = 4 + 2 * index
+
+        if offset >= self._vtable_size:
+            return None
+
+        offset = struct.unpack_from('<H', self._buf, self._vtable + offset)[0]
+        return self._pos + offset if offset else None
+
+    def scalar(self, index, fmt):
+        pos = self._field_pos(index)
+        return struct.unpack_from('<' + fmt, self._buf, pos)[0] if pos else 0
+
+    def _ref(self, index):
+        pos = self._field_pos(index)
+        return pos + struct.unpack_from('<I', self._buf, pos)[0]
+
+    def table(self, index):
+        return _Table(self._buf, self._ref(index))
+
+    def string(self, index):
+        pos = self._ref(index)
+        size = struct.unpack_from('<I', self._buf, pos)[0]
+        return self._buf[pos + 4 : pos + 4 + size].decode()
+
+    def tables(self, index):
+        pos = self._ref(index)
+        count = struct.unpack_from('<I', self._buf, pos)[0]
+        refs = [pos + 4 + 4 * i for i in range(count)]
+        return [
+            _Table(self._buf, ref + struct.unpack_from('<I', self._buf, ref)[0])
+            for ref in refs
+        ]
+
+
+_SCHEMA = 1
+_DICTIONARY_BATCH = 2
+_RECORD_BATCH = 3
+
+
+# Returns a list of (header type, header table) pairs for the
+# messages of the Arrow IPC stream `data`.
+def _read_messages(data):
+    msgs = []
+    pos = 0
+
+    while True:
+        marker, size = struct.unpack_from('<Ii', data, pos)
+        assert marker == 0xFFFFFFFF
+        pos += 8
+
+        if size == 0:
+            # End of stream
+            assert pos == len(data)
+            return msgs
+
+        assert (pos + size) % 8 == 0
+        metadata = data[pos : pos + size]
+        msg = _Table(metadata, struct.unpack_from('<I', metadata, 0)[0])
+        msgs.append((msg.scalar(1, 'B'), msg.table(2)))
+        pos += size + msg.scalar(3, 'q')
+
+
+class Test(unittest.TestCase):
+    def test_unconnected_port_raises(self):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            graph = bt2.Graph()
+            graph.add_component(
+                bt2.find_plugin('columnar').sink_component_classes['arrow'],
+                'snk',
+                params={'path': tmp_dir},
+            )
+
+            with self.assertRaisesRegex(
+                bt2._Error, 'Single input port is not connected: port-name="in"'
+            ):
+                graph.run()
+
+    def test_batch_size_zero_raises(self):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            graph = bt2.Graph()
+
+            with self.assertRaisesRegex(
+                bt2._Error, 'Invalid `batch-size` parameter'
+            ):
+                graph.add_component(
+                    bt2.find_plugin('columnar').sink_component_classes['arrow'],
+                    'snk',
+                    params={'path': tmp_dir, 'batch-size': 0},
+                )
+
+    @staticmethod
+    def _write(params, event_count):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            params = dict(params, path=tmp_dir)
+            graph = bt2.Graph()
+            src = graph.add_component(_EventsSrc, 'src', obj=event_count)
+            snk = graph.add_component(
+                bt2.find_plugin('columnar').sink_component_classes['arrow'],
+                'snk',
+                params=params,
+            )
+            graph.connect_ports(src.output_ports['out'], snk.input_ports['in'])
+            graph.run()
+            del graph
+
+            path = os.path.join(tmp_dir, 'trace', 'my-event-0-0.arrows')
+
+            with open(path, 'rb') as f:
+                return _read_messages(f.read())
+
+    def test_schema(self):
+        msgs = self._write({}, 10)
+        header_type, schema = msgs[0]
+        self.assertEqual(header_type, _SCHEMA)
+        self.assertEqual(
+            [field.string(0) for field in schema.tables(1)],
+            [
+                'timestamp',
+                'stream_id',
+                'payload.my_enum',
+                'payload.my_enum.label',
+                'payload.my_int',
+                'payload.my_str',
+                'payload.my_real',
+                'payload.my_opt',
+            ],
+        )
+
+    def test_batches(self):
+        msgs = self._write({'batch-size': 100}, 250)
+        types = [header_type for header_type, _ in msgs]
+
+        # Initial dictionaries before the first record batch
+        self.assertEqual(
+            types[:4],
+            [_SCHEMA, _DICTIONARY_BATCH, _DICTIONARY_BATCH, _RECORD_BATCH],
+        )
+
+        # No new dictionary entries after the first record batch
+        self.assertEqual(types[4:], [_RECORD_BATCH, _RECORD_BATCH])
+        self.assertEqual(
+            [header.scalar(0, 'q') for _, header in msgs[3:]],
+            [100, 100, 50],
+        )
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,149 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+
+import json
+import os
+import tempfile
+import unittest
+import bt2
+
+
+class _EventsIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        comp = self._component
+        tc = comp._create_trace_class()
+        cc = comp._create_clock_class(frequency=1000000000)
+        sc = tc.create_stream_class(default_clock_class=cc)
+        variant_fc = tc.create_variant_field_class()
+        variant_fc.append_option('an_int', tc.create_signed_integer_field_class(8))
+        variant_fc.append_option('a_str', tc.create_string_field_class())
+        payload_fc = tc.create_structure_field_class()
+        payload_fc += [
+            ('my_bool', tc.create_bool_field_class()),
+            ('my_int', tc.create_signed_integer_field_class(64)),
+            ('my_str', tc.create_string_field_class()),
+            ('my_real', tc.create_double_precision_real_field_class()),
+            (
+                'my_opt',
+                tc.create_option_without_selector_field_class(
+                    tc.create_unsigned_integer_field_class(16)
+                ),
+            ),
+            (
+                'my_array',
+                tc.create_static_array_field_class(
+                    tc.create_unsigned_integer_field_class(8), 2
+                ),
+            ),
+            ('my_variant', variant_fc),
+        ]
+        ec = sc.create_event_class(name='my "event"', payload_field_class=payload_fc)
+        stream = tc().create_stream(sc)
+        self._msgs = [self._create_stream_beginning_message(stream)]
+
+        for i in range(comp._event_count):
+            msg = self._create_event_message(ec, stream, 1000 * i)
+            payload = msg.event.payload_field
+            payload['my_bool'] = bool(i % 2)
+            payload['my_int'] = -(2 ** 63) if i == 0 else -i
+            payload['my_str'] = 'str "{}"\n\t\\\x01é'.format(i)
+            payload['my_real'] = float('nan') if i == 1 else i / 4
+            payload['my_array'] = [i % 256, 255]
+
+            if i % 2:
+                payload['my_opt'].value = i
+                payload['my_variant'].selected_option_index = 0
+                payload['my_variant'].value = -3
+            else:
+                payload['my_opt'].has_field = False
+                payload['my_variant'].selected_option_index = 1
+                payload['my_variant'].value = 'hello'
+
+            self._msgs.append(msg)
+
+        self._msgs.append(self._create_stream_end_message(stream))
+        self._msgs.reverse()
+
+    def __next__(self):
+        if not self._msgs:
+            raise StopIteration
+
+        return self._msgs.pop()
+
+
+class _EventsSrc(bt2._UserSourceComponent, message_iterator_class=_EventsIter):
+    def __init__(self, config, params, obj):
+        self._event_count = obj
+        self._add_output_port('out')
+
+
+class Test(unittest.TestCase):
+    def test_unconnected_port_raises(self):
+        graph = bt2.Graph()
+        graph.add_component(
+            bt2.find_plugin('text').sink_component_classes['jsonl'], 'snk'
+        )
+
+        with self.assertRaisesRegex(
+            bt2._Error, 'Single input port is not connected: port-name="in"'
+        ):
+            graph.run()
+
+    @staticmethod
+    def _write(params, event_count):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            path = os.path.join(tmp_dir, 'out.jsonl')
+            params = dict(params, path=path)
+            graph = bt2.Graph()
+            src = graph.add_component(_EventsSrc, 'src', obj=event_count)
+            snk = graph.add_component(
+                bt2.find_plugin('text').sink_component_classes['jsonl'],
+                'snk',
+                params=params,
+            )
+            graph.connect_ports(src.output_ports['out'], snk.input_ports['in'])
+            graph.run()
+            del graph
+
+            with open(path, encoding='utf-8') as f:
+                return f.read()
+
+    def test_events(self):
+        lines = self._write({}, 3).splitlines()
+        self.assertEqual(len(lines), 3)
+        events = [json.loads(line) for line in lines]
+        self.assertEqual(
+            events[0],
+            {
+                'name': 'my "event"',
+                'stream_class_id': 0,
+                'id': 0,
+                'timestamp': 0,
+                'stream_id': 0,
+                'payload': {
+                    'my_bool': False,
+                    'my_int': -(2 ** 63),
+                    'my_str': 'str "0"\n\t\\\x01é',
+                    'my_real': 0.0,
+                    'my_opt': None,
+                    'my_array': [0, 255],
+                    'my_variant': {'a_str': 'hello'},
+                },
+            },
+        )
+        self.assertEqual(events[1]['timestamp'], 1000)
+        self.assertEqual(events[1]['payload']['my_real'], None)
+        self.assertEqual(events[1]['payload']['my_opt'], 1)
+        self.assertEqual(events[1]['payload']['my_variant'], {'an_int': -3})
+        self.assertEqual(events[2]['payload']['my_real'], 0.5)
+
+    # Test that a small output buffer doesn't change the written lines.
+    def test_output_buffer_size_same_output(self):
+        expected = self._write({}, 100)
+        got = self._write({'output-buffer-size': 0}, 100)
+        self.assertEqual(got, expected)
+
+
+if __name__ == '__main__':
+    unittest.main()
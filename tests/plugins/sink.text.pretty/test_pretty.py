@@ -2,10 +2,126 @@
 #
 # Copyright (C) 2020 EfficiOS, Inc.
 
+import os
+import tempfile
 import unittest
 import bt2
 
 
+class _EventsIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        comp = self._component
+        tc = comp._create_trace_class()
+        cc = comp._create_clock_class(frequency=1000000000)
+        sc = tc.create_stream_class(default_clock_class=cc, supports_packets=True)
+        enum_fc = tc.create_unsigned_enumeration_field_class(8)
+        enum_fc.add_mapping('low', bt2.UnsignedIntegerRangeSet([(0, 3)]))
+        enum_fc.add_mapping('odd', bt2.UnsignedIntegerRangeSet([(1, 1), (3, 3), (5, 5), (7, 7)]))
+        payload_fc = tc.create_structure_field_class()
+        payload_fc += [
+            ('my_enum', enum_fc),
+            ('my_int', tc.create_signed_integer_field_class(32)),
+            ('my_str', tc.create_string_field_class()),
+        ]
+        ec = sc.create_event_class(name='my-event', payload_field_class=payload_fc)
+        stream = tc().create_stream(sc)
+        packet = stream.create_packet()
+        self._msgs = [
+            self._create_stream_beginning_message(stream),
+            self._create_packet_beginning_message(packet),
+        ]
+
+        for i in range(comp._event_count):
+            msg = self._create_event_message(ec, packet, 1000 * i * i)
+            msg.event.payload_field['my_enum'] = i % 9
+            msg.event.payload_field['my_int'] = -i
+            msg.event.payload_field['my_str'] = 'event "{}"\n'.format(i)
+            self._msgs.append(msg)
+
+        self._msgs += [
+            self._create_packet_end_message(packet),
+            self._create_stream_end_message(stream),
+        ]
+        self._msgs.reverse()
+
+    def __next__(self):
+        if not self._msgs:
+            raise StopIteration
+
+        return self._msgs.pop()
+
+
+class _EventsSrc(bt2._UserSourceComponent, message_iterator_class=_EventsIter):
+    def __init__(self, config, params, obj):
+        self._event_count = obj
+        self._add_output_port('out')
+
+
+class _ProjectionIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        comp = self._component
+        tc = comp._create_trace_class()
+        cc = comp._create_clock_class(frequency=1000000000)
+        sc = tc.create_stream_class(default_clock_class=cc)
+        deep_fc = tc.create_structure_field_class()
+        deep_fc += [('v', tc.create_signed_integer_field_class(32))]
+        st_fc = tc.create_structure_field_class()
+        st_fc += [
+            ('inner', tc.create_signed_integer_field_class(32)),
+            ('deep', deep_fc),
+        ]
+        a_payload_fc = tc.create_structure_field_class()
+        a_payload_fc += [
+            ('x', tc.create_signed_integer_field_class(32)),
+            ('s', tc.create_string_field_class()),
+            ('st', st_fc),
+        ]
+        b_payload_fc = tc.create_structure_field_class()
+        b_payload_fc += [
+            ('x', tc.create_signed_integer_field_class(32)),
+            ('y', tc.create_signed_integer_field_class(32)),
+        ]
+        ec_a = sc.create_event_class(name='ev-a', payload_field_class=a_payload_fc)
+
+        # Event class name with a colon, like LTTng event class names
+        ec_b = sc.create_event_class(name='ns:ev-b', payload_field_class=b_payload_fc)
+        stream = tc().create_stream(sc)
+        self._msgs = [self._create_stream_beginning_message(stream)]
+
+        for i in range(comp._event_count):
+            if i % 2 == 0:
+                msg = self._create_event_message(ec_a, stream, 1000 * i)
+                payload = msg.event.payload_field
+                payload['x'] = -i
+                payload['s'] = 'str {}'.format(i)
+                payload['st']['inner'] = 2 * i
+                payload['st']['deep']['v'] = 3 * i
+            else:
+                msg = self._create_event_message(ec_b, stream, 1000 * i)
+                payload = msg.event.payload_field
+                payload['x'] = i
+                payload['y'] = i + 100
+
+            self._msgs.append(msg)
+
+        self._msgs.append(self._create_stream_end_message(stream))
+        self._msgs.reverse()
+
+    def __next__(self):
+        if not self._msgs:
+            raise StopIteration
+
+        return self._msgs.pop()
+
+
+class _ProjectionSrc(
+    bt2._UserSourceComponent, message_iterator_class=_ProjectionIter
+):
+    def __init__(self, config, params, obj):
+        self._event_count = obj
+        self._add_output_port('out')
+
+
 class Test(unittest.TestCase):
     # Test that the component returns an error if the graph is configured while
     # the component's input port is left disconnected.
@@ -20,6 +136,155 @@ class Test(unittest.TestCase):
         ):
             graph.run()
 
+    @staticmethod
+    def _print(params, event_count, src_cls=_EventsSrc):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            path = os.path.join(tmp_dir, 'out.txt')
+            params = dict(params, path=path)
+            graph = bt2.Graph()
+            src = graph.add_component(src_cls, 'src', obj=event_count)
+            snk = graph.add_component(
+                bt2.find_plugin('text').sink_component_classes['pretty'],
+                'snk',
+                params=params,
+            )
+            graph.connect_ports(src.output_ports['out'], snk.input_ports['in'])
+            graph.run()
+            del graph
+
+            with open(path) as f:
+                return f.read()
+
+    # Test that formatting with worker threads prints the same text.
+    def test_format_threads_same_output(self):
+        for params in ({}, {'clock-cycles': True}, {'name-payload': False}):
+            expected = self._print(params, 2000)
+            self.assertEqual(len(expected.splitlines()), 2000)
+
+            for thread_count in (1, 4):
+                with self.subTest(params=params, thread_count=thread_count):
+                    got = self._print(
+                        dict(params, **{'format-threads': thread_count}), 2000
+                    )
+                    self.assertEqual(got, expected)
+
+    # Test that a small output buffer doesn't change the printed text.
+    def test_output_buffer_size_same_output(self):
+        expected = self._print({}, 100)
+        got = self._print({'output-buffer-size': 0}, 100)
+        self.assertEqual(got, expected)
+
+    _PROJECTION_EVENT_COUNT = 20
+
+    # Returns the lines of the `_ProjectionSrc` events printed without
+    # the `fields` parameter and with the parameters `params`, with
+    # their payload removed, and the payloads printed with them.
+    #
+    # The lines of the events without a payload are empty strings.
+    def _print_projection(self, params):
+        base_params = {
+            key: value for key, value in params.items() if key != 'fields'
+        }
+        full_lines = self._print(
+            base_params, self._PROJECTION_EVENT_COUNT, _ProjectionSrc
+        ).splitlines()
+        lines = self._print(
+            params, self._PROJECTION_EVENT_COUNT, _ProjectionSrc
+        ).splitlines()
+        self.assertEqual(len(lines), self._PROJECTION_EVENT_COUNT)
+        payloads = []
+
+        for full_line, line in zip(full_lines, lines):
+            # Everything before the payload is the same
+            prefix = full_line[: full_line.index(': {') + 2]
+
+            if line.rstrip() == prefix.rstrip():
+                payloads.append('')
+            else:
+                self.assertTrue(line.startswith(prefix))
+                payloads.append(line[len(prefix) :])
+
+        return payloads
+
+    def test_fields(self):
+        payloads = self._print_projection({'fields': ['st.inner', 'x']})
+
+        for i, payload in enumerate(payloads):
+            if i % 2 == 0:
+                self.assertEqual(
+                    payload, '{{ st.inner = {}, x = {} }}'.format(2 * i, -i)
+                )
+            else:
+                # `st.inner` doesn't exist in the payload of `ns:ev-b`
+                self.assertEqual(payload, '{{ x = {} }}'.format(i))
+
+    def test_fields_event_class_names(self):
+        payloads = self._print_projection(
+            {'fields': ['ev-a:st.deep', 'ns:ev-b:y', 'other:x']}
+        )
+
+        for i, payload in enumerate(payloads):
+            if i % 2 == 0:
+                self.assertEqual(
+                    payload, '{{ st.deep = {{ v = {} }} }}'.format(3 * i)
+                )
+            else:
+                self.assertEqual(payload, '{{ y = {} }}'.format(i + 100))
+
+    def test_fields_none_applies(self):
+        payloads = self._print_projection(
+            {'fields': ['ev-a:nope', 'ns:ev-b:x.sub', 'st.deep.v']}
+        )
+
+        for i, payload in enumerate(payloads):
+            if i % 2 == 0:
+                self.assertEqual(payload, '{{ st.deep.v = {} }}'.format(3 * i))
+            else:
+                self.assertEqual(payload, '')
+
+    def test_fields_no_names(self):
+        payloads = self._print_projection(
+            {'fields': ['x', 'st.inner'], 'name-payload': False}
+        )
+
+        for i, payload in enumerate(payloads):
+            if i % 2 == 0:
+                self.assertEqual(payload, '{{ {}, {} }}'.format(-i, 2 * i))
+            else:
+                self.assertEqual(payload, '{{ {} }}'.format(i))
+
+    def test_fields_format_threads_same_output(self):
+        params = {'fields': ['ev-a:s', 'x', 'st']}
+        expected = self._print(params, 2000, _ProjectionSrc)
+        got = self._print(dict(params, **{'format-threads': 4}), 2000, _ProjectionSrc)
+        self.assertEqual(got, expected)
+
+    def test_fields_invalid_entry_raises(self):
+        for entry in ('', 'a..b', 'a.', ':x', 'ev-a:'):
+            with self.subTest(entry=entry):
+                graph = bt2.Graph()
+
+                with self.assertRaisesRegex(
+                    bt2._Error, 'Invalid `fields` parameter entry'
+                ):
+                    graph.add_component(
+                        bt2.find_plugin('text').sink_component_classes['pretty'],
+                        'snk',
+                        params={'fields': [entry]},
+                    )
+
+    def test_format_threads_too_large_raises(self):
+        graph = bt2.Graph()
+
+        with self.assertRaisesRegex(
+            bt2._Error, 'Invalid `format-threads` parameter: value is too large'
+        ):
+            graph.add_component(
+                bt2.find_plugin('text').sink_component_classes['pretty'],
+                'snk',
+                params={'format-threads': 65},
+            )
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -83,6 +83,24 @@ class QuerySupportInfoTestCase(unittest.TestCase):
         do_one_query(trace_10353_2, '83656eb1-b131-40e7-9666-c04ae279b58c')
         do_one_query(trace_10353_3, '83656eb1-b131-40e7-9666-c04ae279b58c')
 
+    def test_support_info_file_type_is_not_supported(self):
+        fs = bt2.find_plugin('ctf').source_component_classes['fs']
+        qe = bt2.QueryExecutor(
+            fs,
+            'babeltrace.support-info',
+            {'input': os.path.join(trace_10352_1, 'metadata'), 'type': 'file'},
+        )
+        result = qe.query()
+        self.assertEqual(result['weight'], 0)
+        self.assertIs(result['type-is-supported'], False)
+
+    def test_support_info_directory_type_is_supported(self):
+        fs = bt2.find_plugin('ctf').source_component_classes['fs']
+        qe = bt2.QueryExecutor(
+            fs, 'babeltrace.support-info', {'input': trace_10352_1, 'type': 'directory'}
+        )
+        self.assertNotIn('type-is-supported', qe.query())
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,476 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2022 EfficiOS, Inc.
+#
+
+# Checks that seeking a time with the "seek ns from origin" method of
+# the `src.ctf.fs` message iterators, which uses the packet index, gives
+# the same messages as the library's auto-seeking, which seeks the
+# beginning and skips the messages before the seeking time.
+#
+# To get the library's auto-seeking, the messages go through a filter
+# of which the message iterators can only seek the beginning.
+
+import os
+import shutil
+import struct
+import tempfile
+import unittest
+import uuid
+
+import bt2
+
+
+test_ctf_traces_path = os.environ['BT_CTF_TRACES_PATH']
+
+_PACKET_MAGIC = 0xC1FC1FC1
+_TRACE_UUID = uuid.UUID('d3b6a2f4-4a4c-4f0e-9b1e-6ad8b7f0c2a1')
+
+_METADATA = '''/* CTF 1.8 */
+
+typealias integer {{ size = 8; align = 8; signed = false; }} := uint8_t;
+typealias integer {{ size = 32; align = 8; signed = false; }} := uint32_t;
+typealias integer {{ size = 64; align = 8; signed = false; }} := uint64_t;
+
+trace {{
+	major = 1;
+	minor = 8;
+	uuid = "{uuid}";
+	byte_order = le;
+	packet.header := struct {{
+		uint32_t magic;
+		uint8_t uuid[16];
+		uint32_t stream_id;
+		uint64_t stream_instance_id;
+	}};
+}};
+
+clock {{
+	name = "default";
+	freq = 1000000000;
+	offset_s = 0;
+}};
+
+typealias integer {{
+	size = 64; align = 8; signed = false;
+	map = clock.default.value;
+}} := uint64_clock_t;
+
+stream {{
+	id = 0;
+	packet.context := struct {{
+		uint64_clock_t timestamp_begin;
+		uint64_clock_t timestamp_end;
+		uint64_t content_size;
+		uint64_t packet_size;
+		uint64_t packet_seq_num;
+		uint64_t events_discarded;
+	}};
+	event.header := struct {{
+		uint32_t id;
+		uint64_clock_t timestamp;
+	}};
+}};
+
+event {{
+	name = "ev";
+	id = 0;
+	stream_id = 0;
+	fields := struct {{
+		uint32_t value;
+	}};
+}};
+'''
+
+# Data stream files of the generated trace: stream instance ID and
+# packets (sequence number, beginning and end times, event times, and
+# discarded event counter).
+#
+# Stream 0 has two data stream files, a gap without discarded events
+# between its third and fourth packets, and discarded events before its
+# second and fifth packets. Stream 1 has one discarded packet.
+_DS_FILES = {
+    'stream_0_0': (
+        0,
+        [
+            (0, 100, 300, [100, 200, 300], 0),
+            (1, 1000, 1200, [1000, 1100, 1200], 5),
+            (2, 2000, 2200, [2000, 2100, 2200], 5),
+        ],
+    ),
+    'stream_0_1': (
+        0,
+        [
+            (3, 3000, 3200, [3000, 3100, 3200], 5),
+            (4, 4000, 4200, [4000, 4100, 4200], 8),
+        ],
+    ),
+    'stream_1': (
+        1,
+        [
+            (0, 150, 250, [150, 250], 0),
+            (2, 2500, 2600, [2500, 2600], 0),
+        ],
+    ),
+}
+
+# Seeking times within the generated trace.
+_GEN_TRACE_SEEK_TIMES = {
+    'before-first-packet': 50,
+    'first-event': 100,
+    'inside-packet': 150,
+    'at-event': 200,
+    'at-packet-end': 300,
+    'right-after-packet': 301,
+    'inside-discarded-events': 600,
+    'at-packet-beginning': 1000,
+    'inside-packet-after-discarded-events': 1050,
+    'between-packets': 1500,
+    'between-files': 2500,
+    'inside-discarded-packets': 1700,
+    'right-before-second-file': 2999,
+    'inside-packet-of-second-file': 3100,
+    'inside-discarded-events-of-second-file': 3700,
+    'last-event': 4200,
+    'after-last-packet': 4201,
+    'far-after-last-packet': 100000,
+}
+
+
+def _write_packet(f, stream_instance_id, seq_num, ts_begin, ts_end, event_times, disc):
+    header = struct.pack(
+        '<I16sIQ', _PACKET_MAGIC, _TRACE_UUID.bytes, 0, stream_instance_id
+    )
+    events = b''.join(
+        struct.pack('<IQI', 0, ts, seq_num * 1000 + i)
+        for i, ts in enumerate(event_times)
+    )
+    size = len(header) + struct.calcsize('<6Q') + len(events)
+    context = struct.pack('<6Q', ts_begin, ts_end, size * 8, size * 8, seq_num, disc)
+    f.write(header + context + events)
+
+
+def _generate_trace(trace_dir):
+    with open(os.path.join(trace_dir, 'metadata'), 'w') as f:
+        f.write(_METADATA.format(uuid=str(_TRACE_UUID)))
+
+    for name, (stream_instance_id, packets) in _DS_FILES.items():
+        with open(os.path.join(trace_dir, name), 'wb') as f:
+            for packet in packets:
+                _write_packet(f, stream_instance_id, *packet)
+
+
+def _field_value(field):
+    if field is None:
+        return None
+
+    if isinstance(field, bt2._StructureFieldConst):
+        return {name: _field_value(member) for name, member in field.items()}
+
+    if isinstance(field, bt2._ArrayFieldConst):
+        return [_field_value(elem) for elem in field]
+
+    if isinstance(field, bt2._VariantFieldConst):
+        return (field.selected_option_index, _field_value(field.selected_option))
+
+    if isinstance(field, bt2._OptionFieldConst):
+        return _field_value(field.field)
+
+    if isinstance(field, bt2._StringFieldConst):
+        return str(field)
+
+    if isinstance(field, bt2._RealFieldConst):
+        return float(field)
+
+    return int(field)
+
+
+def _cs_ns(cs):
+    if isinstance(cs, bt2._UnknownClockSnapshot):
+        return 'unknown'
+
+    return cs.ns_from_origin
+
+
+# Returns a comparable representation of the message `msg`.
+def _msg_repr(msg):
+    if isinstance(msg, bt2._EventMessageConst):
+        event = msg.event
+        return (
+            'event',
+            event.stream.id,
+            _cs_ns(msg.default_clock_snapshot),
+            event.name,
+            _field_value(event.common_context_field),
+            _field_value(event.specific_context_field),
+            _field_value(event.payload_field),
+        )
+
+    if isinstance(
+        msg, (bt2._PacketBeginningMessageConst, bt2._PacketEndMessageConst)
+    ):
+        sc = msg.packet.stream.cls
+
+        if isinstance(msg, bt2._PacketBeginningMessageConst):
+            kind = 'packet-beginning'
+            has_cs = sc.packets_have_beginning_default_clock_snapshot
+        else:
+            kind = 'packet-end'
+            has_cs = sc.packets_have_end_default_clock_snapshot
+
+        return (
+            kind,
+            msg.packet.stream.id,
+            _cs_ns(msg.default_clock_snapshot) if has_cs else None,
+            _field_value(msg.packet.context_field),
+        )
+
+    if isinstance(
+        msg, (bt2._StreamBeginningMessageConst, bt2._StreamEndMessageConst)
+    ):
+        if isinstance(msg, bt2._StreamBeginningMessageConst):
+            kind = 'stream-beginning'
+        else:
+            kind = 'stream-end'
+
+        return (
+            kind,
+            msg.stream.id,
+            _cs_ns(msg.default_clock_snapshot)
+            if msg.stream.cls.default_clock_class
+            else None,
+        )
+
+    if isinstance(
+        msg, (bt2._DiscardedEventsMessageConst, bt2._DiscardedPacketsMessageConst)
+    ):
+        sc = msg.stream.cls
+
+        if isinstance(msg, bt2._DiscardedEventsMessageConst):
+            kind = 'discarded-events'
+            has_cs = sc.discarded_events_have_default_clock_snapshots
+        else:
+            kind = 'discarded-packets'
+            has_cs = sc.discarded_packets_have_default_clock_snapshots
+
+        if has_cs:
+            times = (
+                _cs_ns(msg.beginning_default_clock_snapshot),
+                _cs_ns(msg.end_default_clock_snapshot),
+            )
+        else:
+            times = None
+
+        return (kind, msg.stream.id, msg.count, times)
+
+    raise TypeError('unexpected message type: {}'.format(type(msg)))
+
+
+class _AutoSeekFilterIter(bt2._UserMessageIterator):
+    def __init__(self, config, self_output_port):
+        self._upstream_iter = self._create_message_iterator(
+            self_output_port.user_data
+        )
+
+    def __next__(self):
+        return next(self._upstream_iter)
+
+    def _user_can_seek_beginning(self):
+        return self._upstream_iter.can_seek_beginning()
+
+    def _user_seek_beginning(self):
+        self._upstream_iter.seek_beginning()
+
+
+# Filter which forwards the messages of its input port `inN` to its
+# output port `outN`, and of which the message iterators can only seek
+# the beginning.
+class _AutoSeekFilter(
+    bt2._UserFilterComponent, message_iterator_class=_AutoSeekFilterIter
+):
+    def __init__(self, config, params, port_count):
+        for i in range(port_count):
+            input_port = self._add_input_port('in{}'.format(i))
+            self._add_output_port('out{}'.format(i), input_port)
+
+
+# Sink which seeks `obj['ns']` (if not `None`) and then appends the
+# representations of all the messages of its upstream message iterator
+# to `obj['msgs']`.
+class _CollectSink(bt2._UserSinkComponent):
+    def __init__(self, config, params, obj):
+        self._obj = obj
+        self._add_input_port('in')
+        self._seeked = False
+
+    def _user_graph_is_configured(self):
+        self._msg_iter = self._create_message_iterator(self._input_ports['in'])
+
+    def _user_consume(self):
+        if not self._seeked:
+            self._seeked = True
+
+            if self._obj['ns'] is not None:
+                assert self._msg_iter.can_seek_ns_from_origin(self._obj['ns'])
+                self._msg_iter.seek_ns_from_origin(self._obj['ns'])
+
+        try:
+            msg = next(self._msg_iter)
+        except StopIteration:
+            raise bt2.Stop
+
+        self._obj['msgs'].append(_msg_repr(msg))
+
+
+def _ns_to_trimmer_time(ns):
+    return '{}.{:09}'.format(ns // 1000000000, ns % 1000000000)
+
+
+class _SeekTestCase:
+    def setUp(self):
+        self._fs_cc = bt2.find_plugin('ctf').source_component_classes['fs']
+        utils = bt2.find_plugin('utils')
+        self._muxer_cc = utils.filter_component_classes['muxer']
+        self._trimmer_cc = utils.filter_component_classes['trimmer']
+
+    # Creates a graph with a `src.ctf.fs` component reading the trace at
+    # `self._trace_dir`, adding a `_AutoSeekFilter` component after it
+    # if `auto_seek` is true.
+    #
+    # Returns the graph and the output ports to read.
+    def _create_graph(self, auto_seek):
+        graph = bt2.Graph()
+        src = graph.add_component(
+            self._fs_cc, 'src', params={'inputs': [self._trace_dir]}
+        )
+        ports = list(src.output_ports.values())
+
+        if auto_seek:
+            flt = graph.add_component(_AutoSeekFilter, 'flt', obj=len(ports))
+
+            for i, port in enumerate(ports):
+                graph.connect_ports(port, flt.input_ports['in{}'.format(i)])
+
+            ports = list(flt.output_ports.values())
+
+        return graph, ports
+
+    # Seeks `ns` with the message iterator of the output port `port_index`
+    # of the source, returning the representations of the messages
+    # after the seeking operation.
+    def _seek_port(self, port_index, ns, auto_seek):
+        graph, ports = self._create_graph(auto_seek)
+        obj = {'ns': ns, 'msgs': []}
+        sink = graph.add_component(_CollectSink, 'sink', obj=obj)
+        graph.connect_ports(ports[port_index], sink.input_ports['in'])
+        graph.run()
+        return obj['msgs']
+
+    # Returns the representations of the messages of a muxer and
+    # trimmer (beginning at `ns`) reading all the output ports of the
+    # source, like the CLI does with `--begin`.
+    def _trim(self, ns, auto_seek):
+        graph, ports = self._create_graph(auto_seek)
+        muxer = graph.add_component(self._muxer_cc, 'muxer')
+
+        for port in ports:
+            graph.connect_ports(
+                port,
+                next(p for p in muxer.input_ports.values() if not p.is_connected),
+            )
+
+        trimmer = graph.add_component(
+            self._trimmer_cc, 'trimmer', params={'begin': _ns_to_trimmer_time(ns)}
+        )
+        graph.connect_ports(muxer.output_ports['out'], trimmer.input_ports['in'])
+        obj = {'ns': None, 'msgs': []}
+        sink = graph.add_component(_CollectSink, 'sink', obj=obj)
+        graph.connect_ports(trimmer.output_ports['out'], sink.input_ports['in'])
+        graph.run()
+        return obj['msgs']
+
+    def _port_count(self):
+        graph, ports = self._create_graph(False)
+        return len(ports)
+
+    # Returns the index of the output port of the stream `stream_id`.
+    def _stream_port_index(self, stream_id):
+        for port_index in range(self._port_count()):
+            if self._seek_port(port_index, None, False)[0][1] == stream_id:
+                return port_index
+
+        raise ValueError('no output port for stream {}'.format(stream_id))
+
+    def test_seek_ports(self):
+        for port_index in range(self._port_count()):
+            for name, ns in self._seek_times.items():
+                with self.subTest(port_index=port_index, time=name, ns=ns):
+                    self.assertEqual(
+                        self._seek_port(port_index, ns, False),
+                        self._seek_port(port_index, ns, True),
+                    )
+
+    def test_begin(self):
+        for name, ns in self._seek_times.items():
+            with self.subTest(time=name, ns=ns):
+                msgs = self._trim(ns, False)
+                self.assertEqual(msgs, self._trim(ns, True))
+
+
+class GeneratedTraceSeekTestCase(_SeekTestCase, unittest.TestCase):
+    def setUp(self):
+        super().setUp()
+        self._trace_dir = tempfile.mkdtemp()
+        _generate_trace(self._trace_dir)
+        self._seek_times = _GEN_TRACE_SEEK_TIMES
+
+    def tearDown(self):
+        shutil.rmtree(self._trace_dir)
+
+    def test_multi_file_stream(self):
+        # Both files of stream 0 make a single output port
+        self.assertEqual(self._port_count(), 2)
+
+    def test_seek_inside_discarded_events(self):
+        ns = _GEN_TRACE_SEEK_TIMES['inside-discarded-events']
+        msgs = self._seek_port(self._stream_port_index(0), ns, False)
+        disc_msgs = [msg for msg in msgs if msg[0] == 'discarded-events']
+
+        # The first discarded events message begins at the seeking time
+        # and has an unknown count.
+        self.assertEqual(disc_msgs[0][2:], (None, (ns, 1200)))
+        self.assertEqual(disc_msgs[1][2:], (3, (3200, 4200)))
+
+    def test_seek_before_first_packet(self):
+        # Same messages as without seeking
+        port_index = self._stream_port_index(0)
+        self.assertEqual(
+            self._seek_port(
+                port_index, _GEN_TRACE_SEEK_TIMES['before-first-packet'], False
+            ),
+            self._seek_port(port_index, None, False),
+        )
+
+
+class LttngTracefileRotationSeekTestCase(_SeekTestCase, unittest.TestCase):
+    def setUp(self):
+        super().setUp()
+        self._trace_dir = os.path.join(
+            test_ctf_traces_path, 'succeed', 'lttng-tracefile-rotation', 'kernel'
+        )
+
+        # Times of some events, to seek around them
+        msgs = self._trim(0, False)
+        event_times = sorted({msg[2] for msg in msgs if msg[0] == 'event'})
+        self._seek_times = {
+            'before-first-event': event_times[0] - 1,
+            'first-event': event_times[0],
+            'middle-event': event_times[len(event_times) // 2],
+            'after-middle-event': event_times[len(event_times) // 2] + 1,
+            'last-event': event_times[-1],
+            'after-last-event': event_times[-1] + 1,
+        }
+
+
+if __name__ == '__main__':
+    unittest.main()